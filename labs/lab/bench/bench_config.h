@@ -0,0 +1,51 @@
+/**
+ * @file bench_config.h
+ * @brief Benchmark Runner — Iterations, Budgets and Pin Mapping
+ *
+ * Each case is timed over BENCH_SAMPLES individual calls. Its budget is
+ * the median it must not exceed, in CPU cycles (62.5 ns at 16 MHz); a
+ * case over budget is reported as FAIL, so a change that slows one of
+ * these paths shows up in the summary line. Budgets of 0 are not
+ * checked.
+ *
+ * The budgets below are generous first estimates from the float
+ * operation counts of each path (avr-libc: ~100 cycles per add or
+ * multiply, ~500 per divide, a few thousand per log()); once a board has
+ * run the benchmark, set each to its measured median plus ~20 %.
+ *
+ * Pin mapping (Arduino Mega 2560):
+ *   A0      = NTC divider midpoint (reads a floating pin if absent)
+ *   SDA(20) = LCD I2C data
+ *   SCL(21) = LCD I2C clock
+ */
+
+#ifndef BENCH_CONFIG_H
+#define BENCH_CONFIG_H
+
+#include <Arduino.h>
+
+// ── Sampling ───────────────────────────────────────────────────────
+/** Timed calls per case (each sample is one call). */
+static const uint8_t BENCH_SAMPLES     = 64;
+
+/** Untimed calls before sampling (fills filters, warms the LCD diff). */
+static const uint8_t BENCH_WARMUP      = 8;
+
+/** Bytes below the harness frame painted to measure stack use. */
+static const uint16_t BENCH_STACK_PAINT = 512;
+
+// ── Median budgets (cycles, 0 = unchecked) ─────────────────────────
+static const uint32_t BUDGET_SIGNAL_PROCESS = 3000;    // median-of-5 + EWMA + clamp
+static const uint32_t BUDGET_PID_UPDATE     = 4000;    // ~20 float ops + limits
+static const uint32_t BUDGET_NTC_LOG        = 10000;   // analogRead (~1800) + log()
+static const uint32_t BUDGET_NTC_LUT        = 3000;    // analogRead + interpolation
+static const uint32_t BUDGET_PARSE_COMMAND  = 2000;    // tokenise + table lookup
+static const uint32_t BUDGET_LCD_TWO_LINES  = 0;       // bus-bound: depends on the LCD
+
+// ── Hardware ───────────────────────────────────────────────────────
+static const uint8_t PIN_NTC      = A0;
+static const uint8_t LCD_I2C_ADDR = 0x27;
+static const uint8_t LCD_COLS     = 16;
+static const uint8_t LCD_ROWS     = 2;
+
+#endif // BENCH_CONFIG_H
@@ -0,0 +1,206 @@
+/**
+ * @file bench_harness.cpp
+ * @brief Benchmark Runner — Harness Implementation
+ *
+ * Timer1 registers (normal mode, free-running):
+ *   TCCR1A = 0, TCCR1B = CS10 (÷1), TIMSK1 = TOIE1 (overflow count)
+ *
+ * Timer1 belongs to the benchmark in this environment; none of the
+ * benchmarked libraries use it.
+ */
+
+#include "bench_harness.h"
+#include "bench_config.h"
+#include "FlashString.h"
+
+#include <stdio.h>
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Cycle timer
+// ──────────────────────────────────────────────────────────────────────────
+
+static volatile uint16_t s_overflows = 0;
+static uint32_t          s_overhead  = 0;
+
+#if defined(__AVR__)
+ISR(TIMER1_OVF_vect) {
+    s_overflows++;
+}
+#endif
+
+/** Current CPU cycle count (32-bit, wraps after ~268 s). */
+static inline uint32_t cyclesNow() {
+#if defined(__AVR__)
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t low = TCNT1;
+    uint16_t high = s_overflows;
+    // An overflow pending but not yet counted belongs to a low reading.
+    if ((TIFR1 & _BV(TOV1)) && low < 0x8000) {
+        high++;
+    }
+    SREG = sreg;
+    return ((uint32_t)high << 16) | low;
+#else
+    return (uint32_t)micros() * (F_CPU / 1000000UL);
+#endif
+}
+
+/** Target of the overhead calibration. */
+static void __attribute__((noinline)) benchEmpty() {
+    __asm__ __volatile__("" ::: "memory");
+}
+
+/** Time one call, overhead not yet removed. */
+static uint32_t __attribute__((noinline)) timeCall(BenchFunction fn) {
+    uint32_t start = cyclesNow();
+    fn();
+    return cyclesNow() - start;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Stack painting
+// ──────────────────────────────────────────────────────────────────────────
+
+static const uint8_t STACK_PAINT = 0xA5;
+
+#if defined(__AVR__)
+extern char  __heap_start;
+extern char *__brkval;
+#endif
+
+/** Paint below the current frame, make one call, return the bytes it used. */
+static uint16_t __attribute__((noinline)) measureStack(BenchFunction fn) {
+#if defined(__AVR__)
+    uint8_t *top = (uint8_t *)SP;       // Next free byte; the call pushes here first
+    uint8_t *heapEnd = (uint8_t *)((__brkval != NULL) ? __brkval : &__heap_start);
+    uint8_t *low = top - BENCH_STACK_PAINT;
+    if (low <= heapEnd) {
+        low = heapEnd + 1;
+    }
+
+    // Masked, so no ISR frame lands in the area before the call.
+    uint8_t sreg = SREG;
+    cli();
+    for (uint8_t *p = low; p <= top; p++) {
+        *p = STACK_PAINT;
+    }
+    SREG = sreg;
+
+    fn();
+
+    uint8_t *p = low;
+    while (p <= top && *p == STACK_PAINT) {
+        p++;
+    }
+    return (uint16_t)(top - p + 1);
+#else
+    fn();
+    return 0;
+#endif
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Statistics
+// ──────────────────────────────────────────────────────────────────────────
+
+static uint32_t s_samples[BENCH_SAMPLES];
+
+static void sortSamples(uint8_t n) {
+    for (uint8_t i = 1; i < n; i++) {
+        uint32_t v = s_samples[i];
+        uint8_t j = i;
+        while (j > 0 && s_samples[j - 1] > v) {
+            s_samples[j] = s_samples[j - 1];
+            j--;
+        }
+        s_samples[j] = v;
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+void benchInit() {
+#if defined(__AVR__)
+    uint8_t sreg = SREG;
+    cli();
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+    TCCR1B = _BV(CS10);
+    SREG = sreg;
+#endif
+
+    // The cheapest empty call is the fixed cost of a sample.
+    s_overhead = UINT32_MAX;
+    for (uint8_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t t = timeCall(benchEmpty);
+        if (t < s_overhead) {
+            s_overhead = t;
+        }
+    }
+}
+
+uint32_t benchOverheadCycles() {
+    return s_overhead;
+}
+
+bool benchRun(const BenchCase &bench, BenchResult *out) {
+    for (uint8_t i = 0; i < BENCH_WARMUP; i++) {
+        bench.fn();
+    }
+    out->stackBytes = measureStack(bench.fn);
+
+    for (uint8_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t t = timeCall(bench.fn);
+        s_samples[i] = (t > s_overhead) ? t - s_overhead : 0;
+    }
+    sortSamples(BENCH_SAMPLES);
+
+    out->samples      = BENCH_SAMPLES;
+    out->minCycles    = s_samples[0];
+    out->medianCycles = s_samples[BENCH_SAMPLES / 2];
+    out->maxCycles    = s_samples[BENCH_SAMPLES - 1];
+    out->pass         = (bench.budget == 0) || (out->medianCycles <= bench.budget);
+    return out->pass;
+}
+
+void benchPrintHeader() {
+    FLASH_PRINTF("%-16s %4s %9s %9s %9s %9s %6s %9s\r\n",
+                 "case", "n", "min", "median", "max", "med_us", "stack", "budget");
+}
+
+void benchPrintRow(const BenchCase &bench, const BenchResult &result) {
+    uint32_t medianUs = (result.medianCycles + (F_CPU / 2000000UL)) / (F_CPU / 1000000UL);
+    FLASH_PRINTF("%-16s %4u %9lu %9lu %9lu %9lu %6u %9lu %s\r\n",
+                 bench.name,
+                 (unsigned)result.samples,
+                 (unsigned long)result.minCycles,
+                 (unsigned long)result.medianCycles,
+                 (unsigned long)result.maxCycles,
+                 (unsigned long)medianUs,
+                 (unsigned)result.stackBytes,
+                 (unsigned long)bench.budget,
+                 (bench.budget == 0) ? "" : (result.pass ? "ok" : "FAIL"));
+}
+
+void benchPrintCsv(const BenchCase &bench, const BenchResult &result) {
+    FLASH_PRINTF("BENCH,%s,%u,%lu,%lu,%lu,%u,%lu,%s\r\n",
+                 bench.name,
+                 (unsigned)result.samples,
+                 (unsigned long)result.minCycles,
+                 (unsigned long)result.medianCycles,
+                 (unsigned long)result.maxCycles,
+                 (unsigned)result.stackBytes,
+                 (unsigned long)bench.budget,
+                 (bench.budget == 0) ? "NA" : (result.pass ? "PASS" : "FAIL"));
+}
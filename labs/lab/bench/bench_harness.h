@@ -0,0 +1,85 @@
+/**
+ * @file bench_harness.h
+ * @brief Benchmark Runner — Cycle Timer, Stack Painting and Reporting
+ *
+ * Times one call at a time with Timer1 running at the CPU clock
+ * (prescaler 1), extended to 32 bits by its overflow interrupt, so a
+ * sample is exact to the cycle up to ~268 s. The cost of the two timer
+ * reads and the indirect call is calibrated against an empty function
+ * at startup and subtracted from every sample.
+ *
+ * Interrupts stay enabled (millis(), Wire and Serial need them), so a
+ * sample may include an ISR that happened to run during the call: the
+ * minimum is the clean cost, the median the typical one, and the
+ * maximum the worst seen, ISRs included.
+ *
+ * Stack use is found by painting BENCH_STACK_PAINT bytes below the
+ * harness frame with a pattern (interrupts masked), making one call and
+ * scanning for the deepest overwritten byte. It includes the return
+ * address and any ISR frame that nested into the call, so it is an
+ * upper bound for the function itself.
+ *
+ * Usage:
+ *   benchInit();                                       // setup()
+ *   BenchResult r;
+ *   benchRun(s_cases[i], &r);
+ *   benchPrintRow(s_cases[i], r);
+ *   benchPrintCsv(s_cases[i], r);
+ */
+
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <Arduino.h>
+
+/** @brief One benchmarked call; reads and writes its own static state. */
+typedef void (*BenchFunction)();
+
+/**
+ * @struct BenchCase
+ * @brief One row of the benchmark table.
+ */
+typedef struct {
+    const char   *name;     /**< Short identifier, also the CSV key. */
+    BenchFunction fn;       /**< Hot path under test, one call per sample. */
+    uint32_t      budget;   /**< Median budget in cycles (0 = unchecked). */
+} BenchCase;
+
+/**
+ * @struct BenchResult
+ * @brief Cycle statistics and stack use of one case.
+ */
+typedef struct {
+    uint8_t  samples;       /**< Timed calls. */
+    uint32_t minCycles;
+    uint32_t medianCycles;
+    uint32_t maxCycles;
+    uint16_t stackBytes;    /**< Deepest stack use seen (0 if not measurable). */
+    bool     pass;          /**< Median within budget (or budget 0). */
+} BenchResult;
+
+/** @brief Start Timer1 at the CPU clock and calibrate the timing overhead. */
+void benchInit();
+
+/** @brief Cycles subtracted from every sample (timer reads + call). */
+uint32_t benchOverheadCycles();
+
+/**
+ * @brief Warm up, measure stack use, then time BENCH_SAMPLES calls.
+ * @return out->pass.
+ */
+bool benchRun(const BenchCase &bench, BenchResult *out);
+
+/** @brief Print the column header of benchPrintRow(). */
+void benchPrintHeader();
+
+/** @brief Print one human-readable row (cycles, median µs, stack, verdict). */
+void benchPrintRow(const BenchCase &bench, const BenchResult &result);
+
+/**
+ * @brief Print one machine-readable line:
+ *        BENCH,<name>,<n>,<min>,<median>,<max>,<stack>,<budget>,<PASS|FAIL|NA>
+ */
+void benchPrintCsv(const BenchCase &bench, const BenchResult &result);
+
+#endif // BENCH_HARNESS_H
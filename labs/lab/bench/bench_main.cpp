@@ -0,0 +1,166 @@
+/**
+ * @file bench_main.cpp
+ * @brief Library Benchmark — On-Target Timing of the Hot Paths
+ *
+ * Each case below makes one call of a library hot path with inputs that
+ * change from call to call (so caches such as the LCD diff or the median
+ * window do not make it trivially cheap), and writes the result to a
+ * volatile sink so the call cannot be optimised away.
+ *
+ * ┌──────────────────┬────────────────────────────────────────────────────┐
+ * │ Case             │ Call                                               │
+ * ├──────────────────┼────────────────────────────────────────────────────┤
+ * │ signal_process   │ SignalConditioner::process() (median 5, EWMA)      │
+ * │ pid_update       │ PidController::update() (D on measurement, filter) │
+ * │ ntc_read_log     │ AnalogTempSensor::readTemperatureC(), log() path   │
+ * │ ntc_read_lut     │ the same through the lookup table                  │
+ * │ parse_command    │ parseCommand() over hit and miss inputs            │
+ * │ lcd_two_lines    │ LcdDisplay::showTwoLines(), all 32 cells changed   │
+ * └──────────────────┴────────────────────────────────────────────────────┘
+ *
+ * The output ends with one BENCH,... line per case and a BENCH_SUMMARY
+ * line; capture it with "pio device monitor -e bench" and compare the
+ * lines of two builds to see what a change cost.
+ */
+
+#include "bench_main.h"
+#include "bench_config.h"
+#include "bench_harness.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#include "AnalogTempSensor.h"
+#include "CommandParser.h"
+#include "LcdDisplay.h"
+#include "PidController.h"
+#include "SignalConditioner.h"
+#include "StdioSerial.h"
+#include "FlashString.h"
+
+// ──────────────────────────────────────────────────────────────────────────
+// Objects under test
+// ──────────────────────────────────────────────────────────────────────────
+
+static SignalConditioner s_conditioner(5, 0.2f, -40.0f, 125.0f);
+static PidController     s_pid(2.0f, 0.5f, 0.1f, 0.0f, 255.0f);
+static AnalogTempSensor  s_ntcLog(PIN_NTC, 10000, 10000, 3950);
+static AnalogTempSensor  s_ntcLut(PIN_NTC, 10000, 10000, 3950);
+static int16_t           s_ntcTable[AnalogTempSensor::LUT_ENTRIES];
+static LcdDisplay        s_lcd(LCD_I2C_ADDR, LCD_COLS, LCD_ROWS);
+
+/** Result sink: keeps every call's value observable. */
+static volatile float    s_sink;
+
+/** Call counter; derives the varying inputs. */
+static uint8_t           s_step = 0;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Cases
+// ──────────────────────────────────────────────────────────────────────────
+
+static void benchSignalProcess() {
+    // A slow ramp with a spike every 8th sample for the median to reject.
+    float raw = 20.0f + (float)(s_step & 0x3F) * 0.1f;
+    if ((s_step & 0x07) == 0) {
+        raw += 30.0f;
+    }
+    s_sink = s_conditioner.process(raw);
+    s_step++;
+}
+
+static void benchPidUpdate() {
+    float measured = 20.0f + (float)(s_step & 0x1F) * 0.25f;
+    s_sink = s_pid.update(25.0f, measured, 0.1f);
+    s_step++;
+}
+
+static void benchNtcLog() {
+    s_sink = s_ntcLog.readTemperatureC();
+}
+
+static void benchNtcLut() {
+    s_sink = s_ntcLut.readTemperatureC();
+}
+
+static void benchParseCommand() {
+    static const char *const INPUTS[] = { "led on", "LED OFF", "  led   on ", "blink" };
+    s_sink = (float)parseCommand(INPUTS[s_step & 0x03]);
+    s_step++;
+}
+
+static void benchLcdTwoLines() {
+    if (s_step & 0x01) {
+        s_lcd.showTwoLines("T: 23.5C  SP:25", "PWM 128  HEAT ON");
+    } else {
+        s_lcd.showTwoLines("t=-12.0 sp=40.0", "pwm=255 heat=off");
+    }
+    s_step++;
+}
+
+static const BenchCase s_cases[] = {
+    { "signal_process", benchSignalProcess, BUDGET_SIGNAL_PROCESS },
+    { "pid_update",     benchPidUpdate,     BUDGET_PID_UPDATE     },
+    { "ntc_read_log",   benchNtcLog,        BUDGET_NTC_LOG        },
+    { "ntc_read_lut",   benchNtcLut,        BUDGET_NTC_LUT        },
+    { "parse_command",  benchParseCommand,  BUDGET_PARSE_COMMAND  },
+    { "lcd_two_lines",  benchLcdTwoLines,   BUDGET_LCD_TWO_LINES  },
+};
+
+static const uint8_t CASE_COUNT = sizeof(s_cases) / sizeof(s_cases[0]);
+
+static BenchResult s_results[CASE_COUNT];
+
+// ──────────────────────────────────────────────────────────────────────────
+// Benchmark public entry points
+// ──────────────────────────────────────────────────────────────────────────
+
+void benchSetup() {
+    stdioSerialInit(9600);
+
+    s_conditioner.reset();
+    s_pid.setDerivativeMode(PID_DERIVATIVE_ON_MEASUREMENT);
+    s_pid.setDerivativeFilter(10.0f);
+    s_pid.setAntiWindup(PID_ANTIWINDUP_CLAMP);
+    s_pid.init();
+    s_ntcLog.init();
+    s_ntcLut.useLookupTable(s_ntcTable);
+    s_ntcLut.init();
+    s_lcd.init();
+
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("  Library Benchmark — ATmega2560\r\n");
+    FLASH_PRINTF("  Timer1 at %lu MHz, %u samples per case\r\n",
+                 (unsigned long)(F_CPU / 1000000UL), (unsigned)BENCH_SAMPLES);
+    FLASH_PRINTF("========================================\r\n");
+
+    benchInit();
+    FLASH_PRINTF("Timing overhead: %lu cycles (subtracted)\r\n\r\n",
+                 (unsigned long)benchOverheadCycles());
+
+    // Let the banner drain, so the UART ISR does not inflate the first case.
+    Serial.flush();
+
+    benchPrintHeader();
+    uint8_t failures = 0;
+    for (uint8_t i = 0; i < CASE_COUNT; i++) {
+        if (!benchRun(s_cases[i], &s_results[i])) {
+            failures++;
+        }
+        benchPrintRow(s_cases[i], s_results[i]);
+        Serial.flush();
+    }
+
+    FLASH_PRINTF("\r\n");
+    for (uint8_t i = 0; i < CASE_COUNT; i++) {
+        benchPrintCsv(s_cases[i], s_results[i]);
+    }
+    FLASH_PRINTF("BENCH_SUMMARY,cases=%u,fail=%u,overhead=%lu\r\n",
+                 (unsigned)CASE_COUNT, (unsigned)failures,
+                 (unsigned long)benchOverheadCycles());
+}
+
+void benchLoop() {
+    // Single run at boot; reset the board to measure again.
+}
@@ -0,0 +1,25 @@
+/**
+ * @file bench_main.h
+ * @brief Library Benchmark Entry Point Interface
+ *
+ * Declares the setup and loop functions of the benchmark environment
+ * (env:bench), which times the libraries' hot paths on the ATmega2560
+ * itself: min/median/max CPU cycles and stack use per call, printed as
+ * a table and as BENCH,... lines for scripts to diff between builds.
+ */
+
+#ifndef BENCH_MAIN_H
+#define BENCH_MAIN_H
+
+/**
+ * @brief Bring up STDIO and the peripherals, then run every case once.
+ *
+ * Prints the table, the BENCH,... lines and a final
+ * BENCH_SUMMARY,cases=<n>,fail=<n>,overhead=<cycles> line.
+ */
+void benchSetup();
+
+/** @brief Nothing to do after the run; the results stay on the terminal. */
+void benchLoop();
+
+#endif // BENCH_MAIN_H
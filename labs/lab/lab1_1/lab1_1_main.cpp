@@ -9,8 +9,10 @@
  *   - "led on"  -> turns the LED ON
  *   - "led off" -> turns the LED OFF
  *
- * Communication is handled entirely through the C standard I/O library
- * (printf for output, fgets for input), redirected to the hardware UART.
+ * Output goes through the C standard I/O library (printf), redirected to
+ * the hardware UART. Input characters are fed one at a time from
+ * stdioSerialPollChar() into a streaming command parser, so loop() never
+ * blocks waiting for Enter and no separate line buffer is kept.
  *
  * Hardware Configuration:
  *   - MCU: Arduino Mega 2560
@@ -24,6 +26,7 @@
 #include "Led.h"
 #include "StdioSerial.h"
 #include "CommandParser.h"
+#include "FlashString.h"
 
 // ============================================================
 // Pin Configuration (single source of truth for hardware mapping)
@@ -42,58 +45,81 @@ static const unsigned long BAUD_RATE = 9600;
 /// LED driver instance, bound to LED_PIN.
 static Led led(LED_PIN);
 
-/// Input buffer for receiving serial commands.
-static char inputBuffer[64];
+/// True once the "> " prompt for the current line has been printed.
+static bool promptShown = false;
+
+// ============================================================
+// Command Table
+// ============================================================
+
+static void onLedOn(const CommandArg *args, uint8_t argc, void *context) {
+    led.turnOn();
+    FLASH_PRINTF("[OK] LED is now ON.\r\n");
+}
+
+static void onLedOff(const CommandArg *args, uint8_t argc, void *context) {
+    led.turnOff();
+    FLASH_PRINTF("[OK] LED is now OFF.\r\n");
+}
+
+/// Commands accepted on the serial terminal (stored in flash).
+static const CommandEntry COMMANDS[] PROGMEM = {
+    COMMAND_ENTRY("led on",  onLedOn,  ""),
+    COMMAND_ENTRY("led off", onLedOff, ""),
+};
+
+static const uint8_t COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+/// Streaming parser state: verbs are resolved as characters arrive.
+static CommandStream commandStream;
 
 // ============================================================
 // Public API Implementation
 // ============================================================
 
 void lab1_1Setup() {
-    // Initialize STDIO over Serial (redirects printf/fgets to UART)
+    // Initialize STDIO over Serial (redirects printf to UART)
     stdioSerialInit(BAUD_RATE);
 
     // Initialize the LED hardware (pin mode + default OFF state)
     led.init();
 
+    // Bind the streaming parser to the command table
+    commandStreamInit(&commandStream, COMMANDS, COMMAND_COUNT, NULL);
+
     // Display the welcome banner and usage instructions
-    printf("\r\n");
-    printf("========================================\r\n");
-    printf("  Lab 1.1: Serial LED Control (STDIO)\r\n");
-    printf("  MCU: Arduino Mega 2560\r\n");
-    printf("========================================\r\n");
-    printf("\r\n");
-    printf("Available commands:\r\n");
-    printf("  led on   - Turn the LED ON\r\n");
-    printf("  led off  - Turn the LED OFF\r\n");
-    printf("\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("  Lab 1.1: Serial LED Control (STDIO)\r\n");
+    FLASH_PRINTF("  MCU: Arduino Mega 2560\r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("Available commands:\r\n");
+    FLASH_PRINTF("  led on   - Turn the LED ON\r\n");
+    FLASH_PRINTF("  led off  - Turn the LED OFF\r\n");
+    FLASH_PRINTF("\r\n");
 }
 
 void lab1_1Loop() {
-    // Prompt the user for input
-    printf("> ");
-
-    // Read a line of text from stdin (blocks until Enter is pressed)
-    if (fgets(inputBuffer, sizeof(inputBuffer), stdin) != NULL) {
-        // Parse the received command string
-        CommandType cmd = parseCommand(inputBuffer);
-
-        // Execute the command and provide feedback
-        switch (cmd) {
-            case CMD_LED_ON:
-                led.turnOn();
-                printf("[OK] LED is now ON.\r\n");
-                break;
-
-            case CMD_LED_OFF:
-                led.turnOff();
-                printf("[OK] LED is now OFF.\r\n");
-                break;
-
-            case CMD_UNKNOWN:
-                printf("[ERROR] Unknown command.\r\n");
-                printf("Use 'led on' or 'led off'.\r\n");
-                break;
+    // Prompt the user for input once per line
+    if (!promptShown) {
+        FLASH_PRINTF("> ");
+        promptShown = true;
+    }
+
+    // Feed pending input to the parser; a handler runs when Enter arrives
+    int c;
+    while ((c = stdioSerialPollChar()) >= 0) {
+        CommandStatus status = commandStreamFeed(&commandStream, (char)c);
+        if (status == COMMAND_PENDING) {
+            continue;
+        }
+        promptShown = false;
+
+        if (status == COMMAND_NOT_FOUND || status == COMMAND_BAD_ARGS) {
+            FLASH_PRINTF("[ERROR] Unknown command.\r\n");
+            FLASH_PRINTF("Use 'led on' or 'led off'.\r\n");
         }
+        break;  // Show the prompt before handling the next line
     }
 }
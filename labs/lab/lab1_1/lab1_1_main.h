@@ -6,7 +6,8 @@
  * "User Interaction: STDIO - Serial Interface".
  *
  * This lab demonstrates serial communication using the STDIO library
- * (printf, fgets) to control an LED via text commands from a terminal.
+ * (printf) and non-blocking line input to control an LED via text
+ * commands from a terminal.
  */
 
 #ifndef LAB1_1_MAIN_H
@@ -23,9 +24,9 @@ void lab1_1Setup();
 /**
  * @brief Main application loop — read commands and control the LED.
  *
- * Waits for a line of text from the serial terminal (blocking I/O),
- * parses the received command, executes the corresponding LED action,
- * and sends a confirmation or error message back to the terminal.
+ * Polls for a complete line of text from the serial terminal (returns
+ * immediately while the line is incomplete), dispatches it through the
+ * command table, and sends a confirmation or error message back.
  */
 void lab1_1Loop();
 
@@ -14,6 +14,9 @@
  *   *2*old*new#  - Change password
  *   *3#          - Display current lock status
  *
+ * A changed password is kept in EEPROM (ConfigStore) and restored at
+ * startup; the write waits until no change has come for a few seconds.
+ *
  * Visual feedback is provided through:
  *   - LCD: context-aware menus and confirmation messages
  *   - Red LED: indicates LOCKED state
@@ -37,6 +40,9 @@
 #include "KeypadInput.h"
 #include "LockFSM.h"
 #include "StdioSerial.h"
+#include "Timeout.h"
+#include "ConfigStore.h"
+#include "FlashString.h"
 
 // ============================================================
 // Pin Configuration (single source of truth for hardware mapping)
@@ -66,6 +72,18 @@ static byte rowPins[4] = {22, 23, 24, 25};
 /// Keypad column GPIO pins (directly connected to membrane keypad columns).
 static byte colPins[4] = {26, 27, 28, 29};
 
+/// EEPROM region of the stored password (ConfigStore pages, round-robin).
+static const uint16_t SETTINGS_EEPROM_ADDR = 0;
+
+/// Pages in the region: each is written once per lap.
+static const uint8_t SETTINGS_EEPROM_PAGES = 4;
+
+/// Settings schema version; bump it to discard what older firmware stored.
+static const uint8_t SETTINGS_VERSION = 1;
+
+/// ConfigStore key of the password.
+static const uint8_t SETTINGS_KEY_PASSWORD = 1;
+
 // ============================================================
 // Module-level Objects
 // ============================================================
@@ -85,6 +103,9 @@ static KeypadInput keypad(rowPins, colPins);
 /// Lock finite state machine instance.
 static LockFSM lockFSM;
 
+/// Password kept across resets.
+static ConfigStore settings(SETTINGS_EEPROM_ADDR, SETTINGS_EEPROM_PAGES, SETTINGS_VERSION);
+
 /// Tracks the previous lock state to detect LED transitions.
 static bool prevLocked = true;
 
@@ -105,31 +126,39 @@ void lab1_2Setup() {
     // Initialize the lock FSM (starts in LOCKED state)
     lockFSM.init();
 
+    // Restore the password changed before the last reset, if any
+    char storedPassword[MAX_PWD_LEN + 1];
+    bool restored = settings.begin() &&
+                    settings.getString(SETTINGS_KEY_PASSWORD, storedPassword,
+                                       sizeof(storedPassword)) &&
+                    lockFSM.setPassword(storedPassword);
+
     // Set initial LED state: locked (red ON, green OFF)
     redLed.turnOn();
     greenLed.turnOff();
     prevLocked = true;
 
     // Display initial FSM state on LCD
-    const LockDisplay& disp = lockFSM.getDisplay();
+    LockDisplay disp;
+    lockFSM.renderDisplay(disp);
     lcd.showTwoLines(disp.line1, disp.line2);
     lockFSM.clearDisplayChanged();
 
     // Print welcome banner to serial terminal
-    printf("\r\n");
-    printf("========================================\r\n");
-    printf("  Lab 1.2: LCD + Keypad Lock System\r\n");
-    printf("  MCU: Arduino Mega 2560\r\n");
-    printf("========================================\r\n");
-    printf("\r\n");
-    printf("Commands (via keypad):\r\n");
-    printf("  *0#          - Lock\r\n");
-    printf("  *1*pwd#      - Unlock with password\r\n");
-    printf("  *2*old*new#  - Change password\r\n");
-    printf("  *3#          - Show lock status\r\n");
-    printf("\r\n");
-    printf("Default password: 1234\r\n");
-    printf("\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("  Lab 1.2: LCD + Keypad Lock System\r\n");
+    FLASH_PRINTF("  MCU: Arduino Mega 2560\r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("Commands (via keypad):\r\n");
+    FLASH_PRINTF("  *0#          - Lock\r\n");
+    FLASH_PRINTF("  *1*pwd#      - Unlock with password\r\n");
+    FLASH_PRINTF("  *2*old*new#  - Change password\r\n");
+    FLASH_PRINTF("  *3#          - Show lock status\r\n");
+    FLASH_PRINTF("\r\n");
+    printf_P(restored ? PSTR("Password: restored from EEPROM\r\n") : PSTR("Default password: 1234\r\n"));
+    FLASH_PRINTF("\r\n");
 }
 
 void lab1_2Loop() {
@@ -140,11 +169,12 @@ void lab1_2Loop() {
     }
 
     // --- 2. Handle timed transitions (result display timeout) ---
-    lockFSM.update();
+    Timeout::poll();
 
     // --- 3. Update LCD when display content changes ---
     if (lockFSM.displayChanged()) {
-        const LockDisplay& disp = lockFSM.getDisplay();
+        LockDisplay disp;
+        lockFSM.renderDisplay(disp);
         lcd.showTwoLines(disp.line1, disp.line2);
         lockFSM.clearDisplayChanged();
     }
@@ -155,12 +185,16 @@ void lab1_2Loop() {
         if (currentLocked) {
             redLed.turnOn();
             greenLed.turnOff();
-            printf("[LED] Red ON, Green OFF (LOCKED)\r\n");
+            FLASH_PRINTF("[LED] Red ON, Green OFF (LOCKED)\r\n");
         } else {
             redLed.turnOff();
             greenLed.turnOn();
-            printf("[LED] Red OFF, Green ON (UNLOCKED)\r\n");
+            FLASH_PRINTF("[LED] Red OFF, Green ON (UNLOCKED)\r\n");
         }
         prevLocked = currentLocked;
     }
+
+    // --- 5. Save a changed password (coalesced EEPROM write) ---
+    settings.setString(SETTINGS_KEY_PASSWORD, lockFSM.getPassword());
+    settings.service();
 }
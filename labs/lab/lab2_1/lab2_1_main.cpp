@@ -13,13 +13,15 @@
  * The application is built on the TaskScheduler library, which provides
  * non-preemptive bare-metal scheduling. Three TaskContext_t entries form a
  * flat array; on each loop() iteration schedulerRun() picks the most-overdue
- * due task and executes it — exactly one task per tick.
+ * due task and executes it — exactly one task per tick. Built with
+ * -DLAB2_1_RUN_BUDGET_US=<us>, schedulerRunFor() instead runs every task
+ * due together in the same pass, until the budget is spent.
  *
  * ┌─────────┬──────────┬────────────────────────────────────────────────┐
  * │ Task    │ Period   │ Responsibility                                 │
  * ├─────────┼──────────┼────────────────────────────────────────────────┤
- * │ Task 1  │  10 ms   │ Button debounce, duration measurement, LED     │
- * │ Task 2  │  50 ms   │ Statistics update, yellow LED blink sequencer  │
+ * │ Task 1  │  10 ms   │ Captured press events, indicator LEDs          │
+ * │ Task 2  │  50 ms   │ Statistics update, starts the yellow blinks    │
  * │ Task 3  │ 10000 ms │ STDIO statistics report + counter reset        │
  * └─────────┴──────────┴────────────────────────────────────────────────┘
  *
@@ -39,6 +41,32 @@
  *   g_shortPresses      – Short-press count (reset by Task 3).
  *   g_longPresses       – Long-press count (reset by Task 3).
  *   g_totalDurationMs   – Sum of all press durations in ms (reset by Task 3).
+ *   s_durationStats     – Duration histogram and p50/p95/p99 since boot
+ *                         (StreamStats); fed by Task 2, printed by Task 3.
+ *
+ * ──────────────────────────────────────────────────────────────────────────
+ * Press measurement
+ * ──────────────────────────────────────────────────────────────────────────
+ *
+ * Press and release edges are timestamped by the Timer5 input-capture
+ * unit (PressCapture library, 4 µs resolution, DEBOUNCE_MS glitch
+ * window), so durations no longer carry the ±10 ms polling error. Task 1
+ * only consumes the completed presses queued by the capture interrupt.
+ *
+ * The yellow blink sequence is played by the Led pattern engine from the
+ * Timer0 compare interrupt: Task 2 only starts it, and its 100 ms steps
+ * no longer depend on when the scheduler runs the task.
+ *
+ * ──────────────────────────────────────────────────────────────────────────
+ * Schedulability
+ * ──────────────────────────────────────────────────────────────────────────
+ *
+ * Tasks run to completion, so the report (Task 3, blocking on the UART)
+ * delays the next Task 1 and 2 jobs by its whole length. At boot the
+ * task table is checked against TASK_WCET_BUDGET_US and TASK_DEADLINE_MS
+ * (Schedulability library) and the response bounds are printed; with
+ * TASK_SCHEDULER_STATS every report repeats the check with the measured
+ * execution times of its window.
  */
 
 #include "lab2_1_main.h"
@@ -46,14 +74,24 @@
 #include <Arduino.h>
 #include <stdio.h>
 
+#include "Led.h"
+#include "PressCapture.h"
+#include "Schedulability.h"
 #include "TaskScheduler.h"
 #include "StdioSerial.h"
+#include "StreamStats.h"
+#include "Timeout.h"
+#include "FlashString.h"
+
+#if defined(LAB2_1_CYCLIC_EXECUTIVE)
+#include "CyclicExecutive.h"
+#endif
 
 // ──────────────────────────────────────────────────────────────────────────
 // Hardware pin mapping
 // ──────────────────────────────────────────────────────────────────────────
 
-static const uint8_t PIN_BUTTON     = 7;   /**< Push button (active-LOW, INPUT_PULLUP) */
+static const uint8_t PIN_BUTTON     = PRESS_CAPTURE_PIN;  /**< Push button on ICP5 = D48 (active-LOW) */
 static const uint8_t PIN_LED_GREEN  = 8;   /**< Green LED — short press (< 500 ms)     */
 static const uint8_t PIN_LED_RED    = 9;   /**< Red LED   — long press  (≥ 500 ms)     */
 static const uint8_t PIN_LED_YELLOW = 10;  /**< Yellow LED — activity blink sequencer  */
@@ -71,9 +109,12 @@ static const uint32_t LED_INDICATOR_DURATION_MS = 1500;
 /** Half-period for one yellow LED blink step (ms). On=100 ms, Off=100 ms. */
 static const uint32_t BLINK_HALF_PERIOD_MS = 100;
 
-/** Number of yellow LED half-cycles (ON+OFF = 2 steps) per blink count. */
-static const uint8_t BLINK_STEPS_SHORT = 10;   /**< 5 blinks × 2 half-cycles */
-static const uint8_t BLINK_STEPS_LONG  = 20;   /**< 10 blinks × 2 half-cycles */
+/** Number of yellow LED blinks (ON + OFF) per press class. */
+static const uint8_t BLINK_COUNT_SHORT = 5;
+static const uint8_t BLINK_COUNT_LONG  = 10;
+
+/** One blink: ON then OFF for BLINK_HALF_PERIOD_MS each. */
+static const uint16_t BLINK_PATTERN_MS[] = { BLINK_HALF_PERIOD_MS, BLINK_HALF_PERIOD_MS };
 
 // ──────────────────────────────────────────────────────────────────────────
 // Shared global state (inter-task communication)
@@ -100,44 +141,31 @@ static volatile uint32_t g_longPresses       = 0;
 /** Accumulated press duration in milliseconds since last Task 3 reset. */
 static volatile uint32_t g_totalDurationMs   = 0;
 
+/** Distribution of every press duration since boot (not reset by Task 3). */
+static StreamStats       s_durationStats;
+
 // ──────────────────────────────────────────────────────────────────────────
 // Task 1 — private state
 // ──────────────────────────────────────────────────────────────────────────
 
-/** Button finite state machine states. */
-typedef enum {
-    BTN_IDLE,           /**< No button activity detected.                        */
-    BTN_DEBOUNCE_DOWN,  /**< Button went LOW; waiting for debounce confirmation.  */
-    BTN_PRESSED,        /**< Button confirmed pressed; measuring duration.        */
-    BTN_DEBOUNCE_UP     /**< Button went HIGH; waiting for debounce confirmation. */
-} ButtonState_e;
-
-static ButtonState_e s_btnState      = BTN_IDLE;
-static uint32_t      s_debounceStart = 0;  /**< millis() when debounce began.         */
-static uint32_t      s_pressStart    = 0;  /**< millis() when press was confirmed.    */
-static uint32_t      s_pressEnd      = 0;  /**< millis() when release was detected.   */
-
-/** Absolute time (ms) when the green LED should be turned off. 0 = off. */
-static uint32_t s_greenLedOffAt = 0;
+/** Turn an indicator LED off; the context is its pin number. */
+static void ledOff(void *context) {
+    digitalWrite((uint8_t)(uintptr_t)context, LOW);
+}
 
-/** Absolute time (ms) when the red LED should be turned off. 0 = off. */
-static uint32_t s_redLedOffAt   = 0;
+/** One-shot turn-off of the green / red LED, fired from Timeout::poll(). */
+static Timeout s_greenLedOff(ledOff, (void *)(uintptr_t)PIN_LED_GREEN);
+static Timeout s_redLedOff(ledOff, (void *)(uintptr_t)PIN_LED_RED);
 
-/** Debounce duration: button must stay in new state for this many ms. */
-static const uint32_t DEBOUNCE_MS = 50;
+/** Glitch window: a new button level must stay stable this many ms. */
+static const uint16_t DEBOUNCE_MS = 50;
 
 // ──────────────────────────────────────────────────────────────────────────
-// Task 2 — private state (yellow LED blink sequencer)
+// Task 2 — private state
 // ──────────────────────────────────────────────────────────────────────────
 
-/** Remaining half-cycle steps for the yellow LED blink sequence. 0 = idle. */
-static uint8_t  s_blinkStepsRemaining = 0;
-
-/** millis() timestamp of the last yellow LED toggle. */
-static uint32_t s_blinkLastToggle     = 0;
-
-/** Current logical state of the yellow LED (true = ON). */
-static bool     s_yellowLedOn        = false;
+/** Yellow activity LED, blinked by the Led pattern engine (Timer0 ISR). */
+static Led s_yellowLed(PIN_LED_YELLOW);
 
 // ──────────────────────────────────────────────────────────────────────────
 // Task function prototypes
@@ -166,6 +194,78 @@ static TaskContext_t s_tasks[] = {
 
 static const uint8_t TASK_COUNT = sizeof(s_tasks) / sizeof(s_tasks[0]);
 
+/**
+ * Execution budgets (µs) of the s_tasks entries, checked at boot. Task 3
+ * prints up to ~600 characters per report; at 9600 baud through the
+ * 64-byte TX ring it blocks for about as many milliseconds.
+ */
+static const uint32_t TASK_WCET_BUDGET_US[] = { 200, 300, 600000 };
+
+/**
+ * Deadlines (ms) of the s_tasks entries. Tasks 1 and 2 may lag while the
+ * capture queue holds the presses meanwhile (each press is two edges at
+ * least DEBOUNCE_MS apart); Task 3 has its period.
+ */
+static const uint32_t PRESS_DEADLINE_MS = PRESS_CAPTURE_QUEUE_SIZE * 2UL * DEBOUNCE_MS;
+static const uint32_t TASK_DEADLINE_MS[] = { PRESS_DEADLINE_MS, PRESS_DEADLINE_MS, 10000 };
+
+static_assert(sizeof(TASK_WCET_BUDGET_US) / sizeof(TASK_WCET_BUDGET_US[0]) == 3 &&
+                  sizeof(TASK_DEADLINE_MS) / sizeof(TASK_DEADLINE_MS[0]) == 3,
+              "one budget and one deadline per task");
+
+#if defined(LAB2_1_CYCLIC_EXECUTIVE)
+/**
+ * Compile-time variant of the same task table. CyclicExecutive derives a
+ * 5 ms minor cycle and a 10 s hyperperiod from it and stores the dispatch
+ * table in flash; at most two tasks (1 and 3) share a slot.
+ */
+static constexpr CyclicTask s_cyclicTable[] = {
+    { task1ButtonAndLed,        10,     0  },
+    { task2StatisticsAndBlink,  50,     5  },
+    { task3PeriodicReport,   10000,  2000  },
+};
+
+static CyclicExecutive<s_cyclicTable, 3, 2> s_executive;
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Schedulability check
+// ──────────────────────────────────────────────────────────────────────────
+
+#if !defined(LAB2_1_CYCLIC_EXECUTIVE)
+/**
+ * @brief Worst-case response of every task under the cooperative scheduler.
+ *
+ * Uses the budgets, or with measured (TASK_SCHEDULER_STATS) the longest
+ * execution of each task that ran in this report window.
+ */
+static void checkSchedule(const char *title, bool measured) {
+    static const char *const NAMES[] = { "Task1", "Task2", "Task3" };
+    SchedTask set[3];
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        uint32_t wcet = TASK_WCET_BUDGET_US[i];
+#if TASK_SCHEDULER_STATS
+        if (measured && s_tasks[i].stats.runCount > 0) {
+            wcet = s_tasks[i].stats.maxExecUs;
+        }
+#else
+        (void)measured;
+#endif
+        set[i].name = NAMES[i];
+        set[i].periodUs = s_tasks[i].period * 1000UL;
+        set[i].deadlineUs = TASK_DEADLINE_MS[i] * 1000UL;
+        set[i].wcetUs = wcet;
+        set[i].blockingUs = 0;
+        set[i].priority = 0;
+    }
+
+    SchedResult results[3];
+    SchedSummary summary;
+    schedAnalyze(set, TASK_COUNT, SCHED_COOPERATIVE_FIFO, results, &summary);
+    schedPrint(title, set, results, &summary);
+}
+#endif
+
 // ──────────────────────────────────────────────────────────────────────────
 // Task 1 — Button Detection, Duration Measurement, Indicator LEDs
 // ──────────────────────────────────────────────────────────────────────────
@@ -173,95 +273,37 @@ static const uint8_t TASK_COUNT = sizeof(s_tasks) / sizeof(s_tasks[0]);
 /**
  * @brief Task 1 body — runs every 10 ms.
  *
- * Drives a four-state FSM to debounce the button and measure the duration
- * between the confirmed press edge and the confirmed release edge. On each
- * completed press:
+ * Takes the next press measured by the input-capture interrupt (once
+ * Task 2 has consumed the previous one; later presses wait in the
+ * capture queue). On each completed press:
  *   - Records duration and type in the shared global flags.
- *   - Turns on the green LED (short press) or red LED (long press) for
- *     LED_INDICATOR_DURATION_MS milliseconds.
- *   - Manages automatic LED turn-off based on a one-shot timer.
- *
- * FSM transitions:
- *   IDLE           → DEBOUNCE_DOWN : button read LOW
- *   DEBOUNCE_DOWN  → PRESSED       : still LOW after DEBOUNCE_MS
- *   DEBOUNCE_DOWN  → IDLE          : went HIGH before debounce expired
- *   PRESSED        → DEBOUNCE_UP   : button read HIGH
- *   DEBOUNCE_UP    → IDLE          : still HIGH after DEBOUNCE_MS (press complete)
- *   DEBOUNCE_UP    → PRESSED       : went LOW before debounce expired
+ *   - Turns on the green LED (short press) or red LED (long press) and
+ *     arms its one-shot Timeout, which turns it off
+ *     LED_INDICATOR_DURATION_MS later.
  */
 static void task1ButtonAndLed() {
-    uint32_t now       = millis();
-    bool     btnLow    = (digitalRead(PIN_BUTTON) == LOW);
-
-    // ── FSM update ─────────────────────────────────────────────────────
-    switch (s_btnState) {
-
-        case BTN_IDLE:
-            if (btnLow) {
-                s_debounceStart = now;
-                s_btnState      = BTN_DEBOUNCE_DOWN;
-            }
-            break;
-
-        case BTN_DEBOUNCE_DOWN:
-            if (!btnLow) {
-                // Spurious glitch — button released before debounce elapsed.
-                s_btnState = BTN_IDLE;
-            } else if ((now - s_debounceStart) >= DEBOUNCE_MS) {
-                // Confirmed press.
-                s_pressStart = now;
-                s_btnState   = BTN_PRESSED;
-            }
-            break;
-
-        case BTN_PRESSED:
-            if (!btnLow) {
-                // Button released — start release debounce.
-                s_pressEnd      = now;
-                s_debounceStart = now;
-                s_btnState      = BTN_DEBOUNCE_UP;
-            }
-            break;
-
-        case BTN_DEBOUNCE_UP:
-            if (btnLow) {
-                // Button went back down before debounce expired — still pressed.
-                s_btnState = BTN_PRESSED;
-            } else if ((now - s_debounceStart) >= DEBOUNCE_MS) {
-                // Confirmed release — compute duration and signal result.
-                uint32_t duration = s_pressEnd - s_pressStart;
-
-                g_lastPressDuration = duration;
-                g_isShortPress      = (duration < SHORT_PRESS_THRESHOLD_MS);
-                g_newPress          = true;   // Signal Task 2
-
-                // Light the appropriate indicator LED.
-                if (g_isShortPress) {
-                    digitalWrite(PIN_LED_GREEN, HIGH);
-                    s_greenLedOffAt = now + LED_INDICATOR_DURATION_MS;
-                } else {
-                    digitalWrite(PIN_LED_RED, HIGH);
-                    s_redLedOffAt = now + LED_INDICATOR_DURATION_MS;
-                }
-
-                s_btnState = BTN_IDLE;
-            }
-            break;
-    }
+    // ── Consume a captured press ───────────────────────────────────────
+    PressCaptureEvent_t press;
+    if (!g_newPress && pressCaptureRead(&press)) {
+        uint32_t duration = (press.durationUs + 500) / 1000;
 
-    // ── Auto-off for indicator LEDs ────────────────────────────────────
-    if (s_greenLedOffAt != 0 && now >= s_greenLedOffAt) {
-        digitalWrite(PIN_LED_GREEN, LOW);
-        s_greenLedOffAt = 0;
-    }
-    if (s_redLedOffAt != 0 && now >= s_redLedOffAt) {
-        digitalWrite(PIN_LED_RED, LOW);
-        s_redLedOffAt = 0;
+        g_lastPressDuration = duration;
+        g_isShortPress      = (duration < SHORT_PRESS_THRESHOLD_MS);
+        g_newPress          = true;   // Signal Task 2
+
+        // Light the indicator LED; its Timeout turns it off again.
+        if (g_isShortPress) {
+            digitalWrite(PIN_LED_GREEN, HIGH);
+            s_greenLedOff.start(LED_INDICATOR_DURATION_MS);
+        } else {
+            digitalWrite(PIN_LED_RED, HIGH);
+            s_redLedOff.start(LED_INDICATOR_DURATION_MS);
+        }
     }
 }
 
 // ──────────────────────────────────────────────────────────────────────────
-// Task 2 — Statistics Update & Yellow LED Blink Sequencer
+// Task 2 — Statistics Update & Yellow LED Blinks
 // ──────────────────────────────────────────────────────────────────────────
 
 /**
@@ -269,55 +311,35 @@ static void task1ButtonAndLed() {
  *
  * Checks the g_newPress flag set by Task 1. When a new press is available:
  *   - Increments global press counters and duration accumulator.
- *   - Arms the yellow LED blink sequencer: 5 blinks (10 half-cycles) for a
- *     short press, 10 blinks (20 half-cycles) for a long press.
+ *   - Starts the yellow LED pattern: 5 blinks for a short press, 10 blinks
+ *     for a long press (a running sequence restarts).
  *   - Clears the g_newPress flag.
  *
- * Independently of new presses, the blink sequencer advances each time
- * BLINK_HALF_PERIOD_MS has elapsed since the last toggle, driving the
- * yellow LED on and off until the sequence is complete.
+ * The blinks themselves are timed by the Timer0 compare interrupt, so the
+ * task does no work between presses.
  */
 static void task2StatisticsAndBlink() {
-    uint32_t now = millis();
-
-    // ── Consume new press event ─────────────────────────────────────────
-    if (g_newPress) {
-        g_newPress = false;
-
-        // Update statistics.
-        g_totalPresses++;
-        g_totalDurationMs += g_lastPressDuration;
-
-        if (g_isShortPress) {
-            g_shortPresses++;
-            s_blinkStepsRemaining = BLINK_STEPS_SHORT;
-        } else {
-            g_longPresses++;
-            s_blinkStepsRemaining = BLINK_STEPS_LONG;
-        }
-
-        // Start the blink sequence: turn LED on immediately.
-        digitalWrite(PIN_LED_YELLOW, HIGH);
-        s_yellowLedOn    = true;
-        s_blinkLastToggle = now;
+    if (!g_newPress) {
+        return;
     }
-
-    // ── Advance blink sequencer ─────────────────────────────────────────
-    if (s_blinkStepsRemaining > 0) {
-        if ((now - s_blinkLastToggle) >= BLINK_HALF_PERIOD_MS) {
-            // Toggle yellow LED.
-            s_yellowLedOn = !s_yellowLedOn;
-            digitalWrite(PIN_LED_YELLOW, s_yellowLedOn ? HIGH : LOW);
-            s_blinkLastToggle = now;
-            s_blinkStepsRemaining--;
-
-            // Ensure LED is OFF when sequence ends.
-            if (s_blinkStepsRemaining == 0) {
-                digitalWrite(PIN_LED_YELLOW, LOW);
-                s_yellowLedOn = false;
-            }
-        }
+    g_newPress = false;
+
+    // Update statistics.
+    g_totalPresses++;
+    g_totalDurationMs += g_lastPressDuration;
+    s_durationStats.add(g_lastPressDuration);
+
+    uint8_t blinks;
+    if (g_isShortPress) {
+        g_shortPresses++;
+        blinks = BLINK_COUNT_SHORT;
+    } else {
+        g_longPresses++;
+        blinks = BLINK_COUNT_LONG;
     }
+
+    // Starts ON at once; the ISR leaves the LED OFF after the last blink.
+    s_yellowLed.startPattern(BLINK_PATTERN_MS, 2, blinks);
 }
 
 // ──────────────────────────────────────────────────────────────────────────
@@ -347,12 +369,31 @@ static void task3PeriodicReport() {
 
     uint32_t avgMs = (total > 0) ? (totalMs / total) : 0;
 
-    printf("\r\n===== [10s Report] =====\r\n");
-    printf("Total presses    : %lu\r\n", total);
-    printf("Short presses    : %lu  (< %u ms)\r\n", shorts, (unsigned)SHORT_PRESS_THRESHOLD_MS);
-    printf("Long presses     : %lu  (>= %u ms)\r\n", longs, (unsigned)SHORT_PRESS_THRESHOLD_MS);
-    printf("Average duration : %lu ms\r\n", avgMs);
-    printf("========================\r\n");
+    FLASH_PRINTF("\r\n===== [10s Report] =====\r\n");
+    FLASH_PRINTF("Total presses    : %lu\r\n", total);
+    FLASH_PRINTF("Short presses    : %lu  (< %u ms)\r\n",
+                 shorts, (unsigned)SHORT_PRESS_THRESHOLD_MS);
+    FLASH_PRINTF("Long presses     : %lu  (>= %u ms)\r\n",
+                 longs, (unsigned)SHORT_PRESS_THRESHOLD_MS);
+    FLASH_PRINTF("Average duration : %lu ms\r\n", avgMs);
+    if (s_durationStats.count() > 0) {
+        s_durationStats.print("Since boot", "ms");
+        s_durationStats.printHistogram("ms");
+    }
+    FLASH_PRINTF("========================\r\n");
+
+#if TASK_SCHEDULER_STATS
+    // Per-task timing over the same window, used to size task periods,
+    // and the response bounds it gives.
+#if defined(LAB2_1_CYCLIC_EXECUTIVE)
+    s_executive.dumpStats();
+    s_executive.resetStats();
+#else
+    schedulerDumpStats(s_tasks, TASK_COUNT);
+    checkSchedule("Lab 2.1 measured", true);
+    schedulerResetStats(s_tasks, TASK_COUNT);
+#endif
+#endif
 
     // Reset accumulators for the next reporting window.
     g_totalPresses    = 0;
@@ -366,38 +407,69 @@ static void task3PeriodicReport() {
 // ──────────────────────────────────────────────────────────────────────────
 
 void lab2_1Setup() {
-    // Configure hardware pins.
-    pinMode(PIN_BUTTON,     INPUT_PULLUP);
+    // Configure hardware pins (the button pin is set up by PressCapture).
     pinMode(PIN_LED_GREEN,  OUTPUT);
     pinMode(PIN_LED_RED,    OUTPUT);
-    pinMode(PIN_LED_YELLOW, OUTPUT);
 
     // Ensure all LEDs start in the OFF state.
     digitalWrite(PIN_LED_GREEN,  LOW);
     digitalWrite(PIN_LED_RED,    LOW);
-    digitalWrite(PIN_LED_YELLOW, LOW);
+    s_yellowLed.init();
 
     // Initialize STDIO serial at 9600 baud.
     stdioSerialInit(9600);
 
     // Print startup banner.
-    printf("\r\n");
-    printf("========================================\r\n");
-    printf("  Lab 2.1 — Button Press Monitor        \r\n");
-    printf("  Non-Preemptive Task Scheduler Demo    \r\n");
-    printf("  Tasks: 3 | Tick base: 10 ms           \r\n");
-    printf("========================================\r\n");
-    printf("GREEN  LED  = short press (< %u ms)\r\n",   (unsigned)SHORT_PRESS_THRESHOLD_MS);
-    printf("RED    LED  = long press  (>= %u ms)\r\n",  (unsigned)SHORT_PRESS_THRESHOLD_MS);
-    printf("YELLOW LED  = activity blink\r\n");
-    printf("Report interval: 10 seconds\r\n");
-    printf("========================================\r\n\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("  Lab 2.1 — Button Press Monitor        \r\n");
+    FLASH_PRINTF("  Non-Preemptive Task Scheduler Demo    \r\n");
+    FLASH_PRINTF("  Tasks: 3 | Tick base: 10 ms           \r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("GREEN  LED  = short press (< %u ms)\r\n",   (unsigned)SHORT_PRESS_THRESHOLD_MS);
+    FLASH_PRINTF("RED    LED  = long press  (>= %u ms)\r\n",  (unsigned)SHORT_PRESS_THRESHOLD_MS);
+    FLASH_PRINTF("YELLOW LED  = activity blink\r\n");
+    FLASH_PRINTF("Report interval: 10 seconds\r\n");
+    FLASH_PRINTF("Button: D%u, Timer5 input capture\r\n", (unsigned)PIN_BUTTON);
+    FLASH_PRINTF("========================================\r\n\r\n");
+
+    // Start hardware press timestamping (Timer5, 50 ms glitch window).
+    if (!pressCaptureInit(DEBOUNCE_MS)) {
+        FLASH_PRINTF("[ERROR] Press capture init failed\r\n");
+    }
+
+#if defined(LAB2_1_CYCLIC_EXECUTIVE)
+    s_executive.init();
+#else
+    // Response bounds from the budgets, before the first task runs.
+    checkSchedule("Lab 2.1 budgets", false);
 
     // Initialize the scheduler (sets nextRun = millis() + offset for each task).
     schedulerInit(s_tasks, TASK_COUNT);
+#endif
 }
 
 void lab2_1Loop() {
-    // Each call to schedulerRun() executes at most one due task.
-    schedulerRun(s_tasks, TASK_COUNT);
+    // LED turn-off deadlines (one comparison while none is due).
+    Timeout::poll();
+
+#if defined(LAB2_1_CYCLIC_EXECUTIVE)
+    // Table lookup per 5 ms minor cycle; sleep between slots.
+    if (!s_executive.run()) {
+        schedulerSleepUntil(millis() + 1);
+    }
+#else
+#if defined(LAB2_1_RUN_BUDGET_US)
+    // Serve every task due together in this pass, for up to the budget.
+    if (schedulerRunFor(s_tasks, TASK_COUNT, LAB2_1_RUN_BUDGET_US) == 0) {
+        schedulerIdle(s_tasks, TASK_COUNT);
+    }
+#else
+    // Each call to schedulerRun() executes at most one due task. When
+    // nothing is due, sleep until the next Timer0 tick instead of spinning.
+    if (!schedulerRun(s_tasks, TASK_COUNT)) {
+        schedulerIdle(s_tasks, TASK_COUNT);
+    }
+#endif
+#endif
 }
@@ -15,8 +15,9 @@
  *
  *   Task 2 — Statistics & Yellow LED Blink (50 ms period):
  *     Consumes new-press events produced by Task 1, updates press counters and
- *     duration accumulators, and drives a yellow LED blink sequence: 5 rapid
- *     blinks for a short press, 10 rapid blinks for a long press.
+ *     duration accumulators, and starts a yellow LED blink sequence (played
+ *     by the Led pattern engine's timer interrupt): 5 rapid blinks for a
+ *     short press, 10 rapid blinks for a long press.
  *
  *   Task 3 — Periodic STDIO Reporting (10 000 ms period):
  *     Every 10 seconds, prints a statistics report (total presses, short/long
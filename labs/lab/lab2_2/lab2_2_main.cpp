@@ -3,8 +3,8 @@
  * @brief Lab 2.2 — Button Press Duration Monitoring with FreeRTOS Preemptive Tasks
  *
  * Entry point for Laboratory Work 2.2. This file initializes all hardware
- * peripherals, creates FreeRTOS synchronization primitives (binary semaphore
- * and mutex), and spawns three preemptive tasks that together implement the
+ * peripherals, creates FreeRTOS synchronization primitives (capture signal,
+ * queue and mutex), and spawns three preemptive tasks that together implement the
  * button press monitoring, statistics, and reporting system.
  *
  * ──────────────────────────────────────────────────────────────────────────
@@ -19,11 +19,11 @@
  * ┌──────────┬───────────┬──────┬──────────────────────────────────────────┐
  * │ Task     │ Trigger   │ Prio │ Responsibility                           │
  * ├──────────┼───────────┼──────┼──────────────────────────────────────────┤
- * │ Task 1   │ 10 ms     │  3   │ Button debounce, duration measurement    │
- * │ (Measure)│ vTaskDelay│      │ LED indicator, semaphore give            │
+ * │ Task 1   │ Capture   │  3   │ Forward captured presses (queue send),   │
+ * │ (Measure)│ notify    │      │ LED indicator                            │
  * ├──────────┼───────────┼──────┼──────────────────────────────────────────┤
- * │ Task 2   │ Semaphore │  2   │ Statistics update (mutex), yellow LED    │
- * │ (Stats)  │ event     │      │ blink sequence using blocking delays     │
+ * │ Task 2   │ Queue     │  2   │ Statistics update (mutex), starts the    │
+ * │ (Stats)  │ event     │      │ yellow LED pattern (timer ISR blinks it) │
  * ├──────────┼───────────┼──────┼──────────────────────────────────────────┤
  * │ Task 3   │ 10 s      │  1   │ STDIO report (mutex read + reset)       │
  * │ (Report) │ DelayUntil│      │ drift-free periodic output               │
@@ -33,15 +33,24 @@
  * Synchronization mechanisms
  * ──────────────────────────────────────────────────────────────────────────
  *
- *   Binary Semaphore (xNewPressSemaphore):
- *     Given by Task 1 when a complete press cycle is detected.
- *     Taken by Task 2 to wake up and process the event.
- *     Acts as a lightweight event flag with zero polling overhead.
+ *   Task notification (g_captureSignal, TaskSignal):
+ *     Given from the Timer5 input-capture interrupt (PressCapture) when
+ *     a press has been timestamped in hardware. Taken by Task 1, which
+ *     therefore no longer polls the button. Uses Task 1's notification
+ *     value instead of a heap-allocated binary semaphore.
+ *
+ *   Queue (xPressQueue):
+ *     Task 1 sends one PressInfo_t per press; Task 2 blocks on it.
  *
  *   Mutex (xSharedDataMutex):
- *     Protects g_pressInfo (Task 1 writes, Task 2 reads) and g_stats
- *     (Task 2 updates, Task 3 reads and resets). Provides priority
- *     inheritance to prevent priority inversion between tasks.
+ *     Protects g_stats (Task 2 updates, Task 3 reads and resets).
+ *     Provides priority inheritance to prevent priority inversion
+ *     between tasks.
+ *
+ *   Software timers (RtosTimeout):
+ *     One-shot timers armed by Task 1 turn the green and red LEDs off
+ *     from the kernel's timer task, LED_INDICATOR_DURATION_MS after the
+ *     last press of their class.
  */
 
 #include "lab2_2_main.h"
@@ -51,10 +60,25 @@
 #include "task_report.h"
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 #include <stdio.h>
 
 #include "StdioSerial.h"
+#include "StaticTaskSet.h"
+#include "FlashString.h"
+
+// ──────────────────────────────────────────────────────────────────────────
+// Task set — one row per task; TCBs and stacks reserved at link time
+// (StaticTaskSet)
+// ──────────────────────────────────────────────────────────────────────────
+
+static constexpr StaticTaskDesc TASKS[] PROGMEM = {
+    STATIC_TASK(vTaskMeasure, "Measure", TASK_MEASURE_STACK, TASK_MEASURE_PRIORITY, 0),
+    STATIC_TASK(vTaskStats,   "Stats",   TASK_STATS_STACK,   TASK_STATS_PRIORITY,   0),
+    STATIC_TASK(vTaskReport,  "Report",  TASK_REPORT_STACK,  TASK_REPORT_PRIORITY,
+                TASK_REPORT_PERIOD_MS),
+};
+static STATIC_TASK_SET(s_tasks, TASKS);
 
 // ──────────────────────────────────────────────────────────────────────────
 // Lab 2.2 public entry points
@@ -62,66 +86,52 @@
 
 void lab2_2Setup() {
     // ── Configure hardware pins ────────────────────────────────────────
-    pinMode(PIN_BUTTON,     INPUT_PULLUP);
+    // (The button pin is configured by pressCaptureInit().)
     pinMode(PIN_LED_GREEN,  OUTPUT);
     pinMode(PIN_LED_RED,    OUTPUT);
-    pinMode(PIN_LED_YELLOW, OUTPUT);
 
     // Ensure all LEDs start in the OFF state.
     digitalWrite(PIN_LED_GREEN,  LOW);
     digitalWrite(PIN_LED_RED,    LOW);
-    digitalWrite(PIN_LED_YELLOW, LOW);
 
     // ── Initialize STDIO serial at 9600 baud ──────────────────────────
     stdioSerialInit(9600);
 
     // ── Print startup banner ───────────────────────────────────────────
-    printf("\r\n");
-    printf("========================================\r\n");
-    printf("  Lab 2.2 — Button Press Monitor        \r\n");
-    printf("  FreeRTOS Preemptive Scheduler Demo    \r\n");
-    printf("  Tasks: 3 | Tick: %u Hz               \r\n",
-           (unsigned int)configTICK_RATE_HZ);
-    printf("========================================\r\n");
-    printf("GREEN  LED  = short press (< %u ms)\r\n",
-           (unsigned int)SHORT_PRESS_THRESHOLD_MS);
-    printf("RED    LED  = long press  (>= %u ms)\r\n",
-           (unsigned int)SHORT_PRESS_THRESHOLD_MS);
-    printf("YELLOW LED  = activity blink\r\n");
-    printf("Report interval: 10 seconds\r\n");
-    printf("Sync: binary semaphore + mutex\r\n");
-    printf("========================================\r\n\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("  Lab 2.2 — Button Press Monitor        \r\n");
+    FLASH_PRINTF("  FreeRTOS Preemptive Scheduler Demo    \r\n");
+    FLASH_PRINTF("  Tasks: 3 | Tick: %u Hz               \r\n",
+                 (unsigned int)configTICK_RATE_HZ);
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("GREEN  LED  = short press (< %u ms)\r\n",
+                 (unsigned int)SHORT_PRESS_THRESHOLD_MS);
+    FLASH_PRINTF("RED    LED  = long press  (>= %u ms)\r\n",
+                 (unsigned int)SHORT_PRESS_THRESHOLD_MS);
+    FLASH_PRINTF("YELLOW LED  = activity blink\r\n");
+    FLASH_PRINTF("Report interval: 10 seconds\r\n");
+    FLASH_PRINTF("Button: D%u, Timer5 input capture\r\n", (unsigned)PIN_BUTTON);
+    FLASH_PRINTF("Sync: capture notification + queue + mutex + timers\r\n");
+    FLASH_PRINTF("========================================\r\n\r\n");
 
     // ── Create synchronization primitives ──────────────────────────────
     sharedStateInit();
+    if (!measureLedTimeoutsInit()) {
+        FLASH_PRINTF("[ERROR] LED timer creation failed\r\n");
+    }
+
+    // ── Start hardware press timestamping (wakes Task 1) ──────────────
+    if (!pressCaptureInit(DEBOUNCE_MS, onPressCaptured)) {
+        FLASH_PRINTF("[ERROR] Press capture init failed\r\n");
+    }
 
     // ── Create FreeRTOS tasks ──────────────────────────────────────────
-    xTaskCreate(
-        vTaskMeasure,           // Task function
-        "Measure",              // Human-readable name (for debugging)
-        TASK_MEASURE_STACK,     // Stack size (bytes on AVR)
-        NULL,                   // Parameters (unused)
-        TASK_MEASURE_PRIORITY,  // Priority (3 = highest)
-        NULL                    // Task handle (not needed)
-    );
-
-    xTaskCreate(
-        vTaskStats,
-        "Stats",
-        TASK_STATS_STACK,
-        NULL,
-        TASK_STATS_PRIORITY,    // Priority (2 = medium)
-        NULL
-    );
-
-    xTaskCreate(
-        vTaskReport,
-        "Report",
-        TASK_REPORT_STACK,
-        NULL,
-        TASK_REPORT_PRIORITY,   // Priority (1 = lowest)
-        NULL
-    );
+    s_tasks.launch(TASKS);  // [ERROR] line per task that cannot be created
+
+    // Kernel tick on a 1 ms timer compare with -DRTOS_TICK_TIMER (RtosTick.h);
+    // last, as it keeps interrupts off until the scheduler starts.
+    rtosTickInit();
 
     // The FreeRTOS scheduler starts automatically after setup() returns
     // (handled by the Arduino_FreeRTOS library integration).
@@ -7,21 +7,21 @@
  *  Reporting using FreeRTOS Preemptive Scheduling".
  *
  * This lab ports the Lab 2.1 bare-metal cooperative application to FreeRTOS,
- * demonstrating preemptive multitasking with binary semaphores for event
- * signaling and mutexes for protecting shared variables.
+ * demonstrating preemptive multitasking with task notifications and queues
+ * for event signaling and mutexes for protecting shared variables.
  *
  * Three FreeRTOS tasks implement the same functionality as Lab 2.1:
  *
  *   Task 1 — Button Detection & LED Signaling (10 ms period, priority 3):
  *     Monitors a push button using a debounce FSM, measures press duration,
- *     and signals the result via green/red LEDs and a binary semaphore.
+ *     and signals the result via green/red LEDs and the press queue.
  *
  *   Task 2 — Statistics & Yellow LED Blink (event-driven, priority 2):
- *     Waits on the binary semaphore, updates press counters under mutex
- *     protection, and drives a blocking yellow LED blink sequence.
+ *     Waits on the press queue, updates press counters under mutex
+ *     protection, and starts the yellow LED blink sequence (timer ISR).
  *
  *   Task 3 — Periodic STDIO Reporting (10 s period, priority 1):
- *     Uses vTaskDelayUntil() for drift-free 10-second reporting, reads
+ *     Uses RtosPeriod for drift-free 10-second reporting, reads
  *     and resets statistics under mutex protection.
  *
  * Hardware pin mapping (Arduino Mega 2560):
@@ -38,7 +38,7 @@
  * @brief Initialize hardware, create synchronization primitives and FreeRTOS tasks.
  *
  * Configures GPIO pins, initializes the STDIO serial interface, creates
- * the binary semaphore and mutex, and spawns three FreeRTOS tasks. The
+ * the press queue and mutex, and spawns three FreeRTOS tasks. The
  * FreeRTOS scheduler starts automatically after setup() returns.
  */
 void lab2_2Setup();
@@ -8,29 +8,33 @@
  */
 
 #include "shared_state.h"
+#include "StaticRtos.h"
 
 // ──────────────────────────────────────────────────────────────────────────
 // Shared data — zero-initialized at startup
 // ──────────────────────────────────────────────────────────────────────────
 
-PressInfo_t g_pressInfo = { 0, false };
-
-Stats_t g_stats = { 0, 0, 0, 0 };
+Stats_t g_stats;
 
 // ──────────────────────────────────────────────────────────────────────────
-// Synchronization primitives — created at runtime in sharedStateInit()
+// Synchronization primitives — created in sharedStateInit() on storage
+// reserved at link time (StaticRtos)
 // ──────────────────────────────────────────────────────────────────────────
 
-SemaphoreHandle_t xNewPressSemaphore = NULL;
-SemaphoreHandle_t xSharedDataMutex   = NULL;
+static StaticQueue<PressInfo_t, PRESS_QUEUE_LENGTH> s_pressQueue;
+static StaticMutex                                  s_sharedDataMutex;
+
+TaskSignal        g_captureSignal;
+QueueHandle_t     xPressQueue       = NULL;
+SemaphoreHandle_t xSharedDataMutex  = NULL;
 
 void sharedStateInit() {
-    // Binary semaphore starts "empty" (not given) — Task 2 will block
-    // on xSemaphoreTake() until Task 1 gives it after a press event.
-    xNewPressSemaphore = xSemaphoreCreateBinary();
+    // Task 2 blocks on the queue; presses made while it is blinking are
+    // buffered instead of being merged into one event.
+    xPressQueue = s_pressQueue.create();
 
     // Mutex provides priority inheritance: if Task 3 (low priority) holds
     // the mutex and Task 1 (high priority) tries to acquire it, FreeRTOS
     // temporarily raises Task 3's priority to prevent priority inversion.
-    xSharedDataMutex = xSemaphoreCreateMutex();
+    xSharedDataMutex = s_sharedDataMutex.create();
 }
@@ -7,13 +7,15 @@
  * three FreeRTOS tasks in the button press monitoring system.
  *
  * Synchronization strategy:
- *   - Binary semaphore (xNewPressSemaphore): signals Task 2 that a new
- *     press event is available from Task 1.
+ *   - Task notification (g_captureSignal): given by the Timer5 capture
+ *     interrupt (PressCapture) when a press has been measured; wakes Task 1.
+ *   - Queue (xPressQueue): carries PressInfo_t events by value from Task 1
+ *     to Task 2; presses arriving during a blink sequence wait in it.
  *   - Mutex (xSharedDataMutex): protects concurrent read/write access to
- *     g_pressInfo and g_stats from Task 1, Task 2, and Task 3.
+ *     g_stats from Task 2 and Task 3.
  *
  * Data flow:
- *   Task 1 (measure) → [mutex + semaphore] → Task 2 (stats) → [mutex] → Task 3 (report)
+ *   Capture ISR → [notification] → Task 1 (measure) → [queue] → Task 2 (stats) → [mutex] → Task 3 (report)
  */
 
 #ifndef SHARED_STATE_H
@@ -21,13 +23,18 @@
 
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
+#include <queue.h>
 #include <semphr.h>
 
+#include "PressCapture.h"
+#include "StreamStats.h"
+#include "TaskSignal.h"
+
 // ──────────────────────────────────────────────────────────────────────────
 // Hardware Pin Mapping (Arduino Mega 2560)
 // ──────────────────────────────────────────────────────────────────────────
 
-static const uint8_t PIN_BUTTON     = 7;   /**< Push button (active-LOW, INPUT_PULLUP) */
+static const uint8_t PIN_BUTTON     = PRESS_CAPTURE_PIN;  /**< Push button on ICP5 = D48 (active-LOW) */
 static const uint8_t PIN_LED_GREEN  = 8;   /**< Green LED — short press indicator      */
 static const uint8_t PIN_LED_RED    = 9;   /**< Red LED   — long press indicator       */
 static const uint8_t PIN_LED_YELLOW = 10;  /**< Yellow LED — activity blink sequencer  */
@@ -51,19 +58,21 @@ static const uint8_t  BLINK_COUNT_SHORT          = 5;
 /** Number of complete on-off blinks for a long press. */
 static const uint8_t  BLINK_COUNT_LONG           = 10;
 
-/** Button debounce confirmation period (ms). */
-static const uint32_t DEBOUNCE_MS                = 50;
+/** Glitch window (ms): a new button level must stay stable this long. */
+static const uint16_t DEBOUNCE_MS                = 50;
+
+/** Press events buffered between Task 1 and Task 2 (overflow is folded, not lost). */
+static const UBaseType_t PRESS_QUEUE_LENGTH      = 4;
 
 // ──────────────────────────────────────────────────────────────────────────
 // FreeRTOS Task Configuration
 // ──────────────────────────────────────────────────────────────────────────
 
-/** Task 1 — Button measurement: 10 ms period, highest priority. */
-static const uint32_t TASK_MEASURE_PERIOD_MS = 10;
+/** Task 1 — Button measurement: event-driven (capture notification), highest priority. */
 static const UBaseType_t TASK_MEASURE_PRIORITY = 3;
 static const configSTACK_DEPTH_TYPE TASK_MEASURE_STACK = 200;
 
-/** Task 2 — Statistics and blink: event-driven (semaphore), medium priority. */
+/** Task 2 — Statistics and blink: event-driven (queue), medium priority. */
 static const UBaseType_t TASK_STATS_PRIORITY = 2;
 static const configSTACK_DEPTH_TYPE TASK_STATS_STACK = 200;
 
@@ -79,48 +88,59 @@ static const configSTACK_DEPTH_TYPE TASK_REPORT_STACK = 400;
 /**
  * @brief Press event information passed from Task 1 to Task 2.
  *
- * Written by Task 1 under mutex protection before giving the binary
- * semaphore. Read by Task 2 under mutex protection after taking the
- * semaphore.
+ * Copied by value through xPressQueue, so it needs no mutex. A press
+ * that meets a full queue is not lost: Task 1 folds it into a backlog
+ * event (backlog = true, counts and summed duration of the folded
+ * presses) that it sends as soon as the queue has room again.
  */
 typedef struct {
-    uint32_t duration;   /**< Duration of the completed press in ms. */
-    bool     isShort;    /**< True if duration < SHORT_PRESS_THRESHOLD_MS. */
+    uint32_t pressUs;      /**< Press edge time (pressCaptureMicros() base), latest press. */
+    uint32_t duration;     /**< Press duration in ms; the sum for a backlog event. */
+    uint16_t presses;      /**< Presses this event stands for (1 unless backlog). */
+    uint16_t shortPresses; /**< Of those, shorter than SHORT_PRESS_THRESHOLD_MS. */
+    bool     backlog;      /**< Presses that met a full queue: counted, not blinked. */
 } PressInfo_t;
 
 /**
  * @brief Cumulative statistics updated by Task 2 and read/reset by Task 3.
  *
  * All fields are protected by xSharedDataMutex. Task 2 increments
- * counters after each press; Task 3 reads and resets every 10 seconds.
+ * counters after each press; Task 3 reads and resets the counters every
+ * 10 seconds. The duration distribution is kept since boot.
  */
 typedef struct {
     uint32_t totalPresses;    /**< Total button presses since last reset. */
     uint32_t shortPresses;    /**< Count of short presses (< 500 ms). */
     uint32_t longPresses;     /**< Count of long presses (>= 500 ms). */
     uint32_t totalDurationMs; /**< Sum of all press durations in ms. */
+    uint32_t backlogPresses;  /**< Presses that met a full xPressQueue (counted late). */
+    StreamStats durations;    /**< Press durations (ms) since boot: histogram, p50/p95/p99. */
 } Stats_t;
 
 // ──────────────────────────────────────────────────────────────────────────
 // External Declarations
 // ──────────────────────────────────────────────────────────────────────────
 
-/** Press event info — written by Task 1, consumed by Task 2. */
-extern PressInfo_t g_pressInfo;
-
 /** Accumulated statistics — updated by Task 2, read/reset by Task 3. */
 extern Stats_t g_stats;
 
 /**
- * @brief Binary semaphore for event signaling (Task 1 → Task 2).
+ * @brief Event signal (capture ISR → Task 1) on Task 1's notification.
+ *
+ * Given from the PressCapture callback when a complete press cycle has
+ * been timestamped. Taken by Task 1 to wake up and forward the event.
+ */
+extern TaskSignal g_captureSignal;
+
+/**
+ * @brief Queue of PressInfo_t events (Task 1 → Task 2).
  *
- * Given by Task 1 when a complete press cycle is detected.
- * Taken by Task 2 to wake up and process the event.
+ * Sent by Task 1 for each measured press; Task 2 blocks on it.
  */
-extern SemaphoreHandle_t xNewPressSemaphore;
+extern QueueHandle_t xPressQueue;
 
 /**
- * @brief Mutex for protecting shared variables (g_pressInfo, g_stats).
+ * @brief Mutex for protecting shared variables (g_stats).
  *
  * Acquired by any task before reading or writing the shared data
  * structures. Provides priority inheritance to prevent priority
@@ -132,7 +152,7 @@ extern SemaphoreHandle_t xSharedDataMutex;
  * @brief Create and initialize all synchronization primitives.
  *
  * Must be called once from setup() before creating any FreeRTOS tasks.
- * Creates the binary semaphore and the mutex.
+ * Creates the press queue and the mutex (the capture signal needs no object).
  */
 void sharedStateInit();
 
@@ -1,140 +1,130 @@
 /**
  * @file task_measure.cpp
- * @brief Lab 2.2 — Task 1 Implementation: Button FSM and LED Signaling
+ * @brief Lab 2.2 — Task 1 Implementation: Press Events and LED Signaling
  *
- * Implements the highest-priority FreeRTOS task that polls the button every
- * 10 ms, debounces press and release edges using a four-state FSM, measures
- * the press duration in milliseconds, and signals the result to Task 2 via
- * a binary semaphore. Visual feedback is provided by lighting a green LED
- * (short press) or red LED (long press) for a configurable timeout.
+ * Implements the highest-priority FreeRTOS task that turns the presses
+ * measured by the PressCapture library into PressInfo_t events for Task 2
+ * and lights a green LED (short press) or red LED (long press) for a
+ * configurable timeout.
  *
- * The debounce FSM is identical to the bare-metal Lab 2.1 implementation,
- * demonstrating that the core application logic ports to FreeRTOS with
- * minimal changes — only the scheduling mechanism and inter-task
- * communication differ.
+ * Press and release edges are timestamped by the Timer5 input-capture
+ * unit and debounced with a DEBOUNCE_MS glitch window in its interrupts,
+ * so the measured duration no longer depends on the ~16 ms WDT tick. The
+ * task no longer polls: it sleeps on its notification (g_captureSignal),
+ * given from the capture callback. The indicator LEDs are turned off by
+ * one-shot software timers (RtosTimeout) in the kernel's timer task, so
+ * the task does not wake up for them either.
  *
- * FSM states:
- *   BTN_IDLE         → Button not pressed, waiting for LOW edge.
- *   BTN_DEBOUNCE_DOWN → Button read LOW, confirming for DEBOUNCE_MS.
- *   BTN_PRESSED      → Press confirmed, measuring duration until release.
- *   BTN_DEBOUNCE_UP  → Button read HIGH, confirming release for DEBOUNCE_MS.
+ * Task 1 never blocks on Task 2: a press that finds xPressQueue full is
+ * folded into a local backlog (count, short count, summed duration) and
+ * sent as one backlog event on a later wake (at most BACKLOG_RETRY_MS
+ * later). Every press is counted.
  */
 
 #include "task_measure.h"
 #include "shared_state.h"
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
-#include <semphr.h>
+#include "RtosTick.h"
+#include <queue.h>
+
+#include "RtosTimeout.h"
 
 // ──────────────────────────────────────────────────────────────────────────
-// Button FSM states
+// Capture callback
 // ──────────────────────────────────────────────────────────────────────────
 
-typedef enum {
-    BTN_IDLE,           /**< No button activity detected.                       */
-    BTN_DEBOUNCE_DOWN,  /**< Button went LOW; waiting for debounce confirmation. */
-    BTN_PRESSED,        /**< Button confirmed pressed; measuring duration.       */
-    BTN_DEBOUNCE_UP     /**< Button went HIGH; waiting for release confirmation. */
-} ButtonState_e;
+void onPressCaptured() {
+    g_captureSignal.giveFromIsr();
+}
 
 // ──────────────────────────────────────────────────────────────────────────
 // Task 1 implementation
 // ──────────────────────────────────────────────────────────────────────────
 
+/** Retry interval (ms) for a backlog the queue had no room for. */
+static const uint32_t BACKLOG_RETRY_MS = 100;
+
+/**
+ * @brief Send the backlog as one event if the queue has room.
+ * @return true if nothing remains to send.
+ */
+static bool flushBacklog(PressInfo_t *backlog) {
+    if (backlog->presses == 0) {
+        return true;
+    }
+    if (xQueueSend(xPressQueue, backlog, 0) != pdTRUE) {
+        return false;
+    }
+    backlog->presses = 0;
+    backlog->shortPresses = 0;
+    backlog->duration = 0;
+    return true;
+}
+
+/** Turn an indicator LED off; the context is its pin number. */
+static void ledOff(void *context) {
+    digitalWrite((uint8_t)(uintptr_t)context, LOW);
+}
+
+static RtosTimeout s_greenLedOff(ledOff, (void *)(uintptr_t)PIN_LED_GREEN);
+static RtosTimeout s_redLedOff(ledOff, (void *)(uintptr_t)PIN_LED_RED);
+
+bool measureLedTimeoutsInit() {
+    bool ok = s_greenLedOff.init("GreenOff");
+    ok = s_redLedOff.init("RedOff") && ok;
+    return ok;
+}
+
 void vTaskMeasure(void *pvParameters) {
     (void)pvParameters;  // Unused
 
     // ── Task-local state (private to this task — no sharing needed) ────
-    ButtonState_e btnState      = BTN_IDLE;
-    uint32_t      debounceStart = 0;
-    uint32_t      pressStart    = 0;
-    uint32_t      pressEnd      = 0;
-    uint32_t      greenLedOffAt = 0;  // millis() when green LED should turn off
-    uint32_t      redLedOffAt   = 0;  // millis() when red LED should turn off
-
-    for (;;) {
-        uint32_t now    = millis();
-        bool     btnLow = (digitalRead(PIN_BUTTON) == LOW);
+    PressInfo_t backlog = { 0, 0, 0, 0, true };  // Presses that met a full queue
 
-        // ── FSM update ─────────────────────────────────────────────────
-        switch (btnState) {
+    // Presses captured before this point wake the first take() at once.
+    g_captureSignal.bind();
 
-            case BTN_IDLE:
-                if (btnLow) {
-                    debounceStart = now;
-                    btnState      = BTN_DEBOUNCE_DOWN;
-                }
-                break;
-
-            case BTN_DEBOUNCE_DOWN:
-                if (!btnLow) {
-                    // Spurious glitch — button released before debounce expired.
-                    btnState = BTN_IDLE;
-                } else if ((now - debounceStart) >= DEBOUNCE_MS) {
-                    // Confirmed press — record start time.
-                    pressStart = now;
-                    btnState   = BTN_PRESSED;
-                }
-                break;
-
-            case BTN_PRESSED:
-                if (!btnLow) {
-                    // Button released — begin release debounce.
-                    pressEnd      = now;
-                    debounceStart = now;
-                    btnState      = BTN_DEBOUNCE_UP;
-                }
-                break;
-
-            case BTN_DEBOUNCE_UP:
-                if (btnLow) {
-                    // Bounce — button went back down, still considered pressed.
-                    btnState = BTN_PRESSED;
-                } else if ((now - debounceStart) >= DEBOUNCE_MS) {
-                    // Confirmed release — compute duration and signal result.
-                    uint32_t duration = pressEnd - pressStart;
-                    bool     isShort  = (duration < SHORT_PRESS_THRESHOLD_MS);
-
-                    // Write press info under mutex protection, then signal Task 2.
-                    if (xSemaphoreTake(xSharedDataMutex, portMAX_DELAY) == pdTRUE) {
-                        g_pressInfo.duration = duration;
-                        g_pressInfo.isShort  = isShort;
-                        xSemaphoreGive(xSharedDataMutex);
-                    }
-
-                    // Signal Task 2 that a new press event is available.
-                    xSemaphoreGive(xNewPressSemaphore);
-
-                    // Light the appropriate indicator LED.
-                    if (isShort) {
-                        digitalWrite(PIN_LED_GREEN, HIGH);
-                        greenLedOffAt = now + LED_INDICATOR_DURATION_MS;
-                    } else {
-                        digitalWrite(PIN_LED_RED, HIGH);
-                        redLedOffAt = now + LED_INDICATOR_DURATION_MS;
-                    }
-
-                    btnState = BTN_IDLE;
+    for (;;) {
+        // ── Sleep until a press is captured (or the backlog retry) ────
+        TickType_t wait = (backlog.presses != 0) ? pdMS_TO_TICKS(BACKLOG_RETRY_MS) + 1
+                                                 : portMAX_DELAY;
+        g_captureSignal.take(wait);
+
+        // ── Forward every measured press to Task 2 ─────────────────────
+        // The backlog goes first, so the counts stay in press order.
+        bool queueOpen = flushBacklog(&backlog);
+        PressCaptureEvent_t press;
+        while (pressCaptureRead(&press)) {
+            PressInfo_t info;
+            info.pressUs      = press.pressUs;
+            info.duration     = (press.durationUs + 500) / 1000;
+            info.presses      = 1;
+            bool isShort      = (info.duration < SHORT_PRESS_THRESHOLD_MS);
+            info.shortPresses = isShort ? 1 : 0;
+            info.backlog      = false;
+
+            // Never block here: if Task 2 is that far behind, fold the
+            // press into the backlog and send that once there is room.
+            if (!queueOpen || xQueueSend(xPressQueue, &info, 0) != pdTRUE) {
+                queueOpen = false;
+                if (backlog.presses < 0xFFFF) {
+                    backlog.pressUs = info.pressUs;
+                    backlog.presses++;
+                    backlog.shortPresses += info.shortPresses;
+                    backlog.duration += info.duration;
                 }
-                break;
-        }
-
-        // ── Auto-off for indicator LEDs ────────────────────────────────
-        if (greenLedOffAt != 0 && now >= greenLedOffAt) {
-            digitalWrite(PIN_LED_GREEN, LOW);
-            greenLedOffAt = 0;
-        }
-        if (redLedOffAt != 0 && now >= redLedOffAt) {
-            digitalWrite(PIN_LED_RED, LOW);
-            redLedOffAt = 0;
+            }
+
+            // Light the indicator LED; its timer turns it off again
+            // (a press while it is lit restarts the interval).
+            if (isShort) {
+                digitalWrite(PIN_LED_GREEN, HIGH);
+                s_greenLedOff.start(LED_INDICATOR_DURATION_MS);
+            } else {
+                digitalWrite(PIN_LED_RED, HIGH);
+                s_redLedOff.start(LED_INDICATOR_DURATION_MS);
+            }
         }
-
-        // ── Yield CPU until next tick (~16 ms with WDT at 62 Hz) ──────
-        // pdMS_TO_TICKS(10) evaluates to 0 because the WDT tick period
-        // is ~16 ms.  A delay of 0 ticks never yields to lower-priority
-        // tasks, so we always delay at least 1 tick.
-        const TickType_t xDelay = pdMS_TO_TICKS(TASK_MEASURE_PERIOD_MS);
-        vTaskDelay(xDelay > 0 ? xDelay : 1);
     }
 }
@@ -2,25 +2,42 @@
  * @file task_measure.h
  * @brief Lab 2.2 — Task 1: Button Detection and Duration Measurement
  *
- * Declares the FreeRTOS task function for Task 1, which monitors a push
- * button using a debounce FSM, measures press duration, and provides
- * visual feedback through green/red indicator LEDs.
+ * Declares the FreeRTOS task function for Task 1, which forwards the
+ * presses measured by the Timer5 input-capture unit and provides visual
+ * feedback through green/red indicator LEDs, and the capture callback
+ * that wakes it.
  */
 
 #ifndef TASK_MEASURE_H
 #define TASK_MEASURE_H
 
 /**
- * @brief FreeRTOS task function — Button detection and LED signaling.
+ * @brief PressCapture callback (interrupt context): gives g_captureSignal.
  *
- * Runs periodically every 10 ms using vTaskDelay(). On each iteration:
- *   1. Reads the button pin and advances a four-state debounce FSM.
- *   2. When a complete press cycle is detected (press + release confirmed),
- *      writes the duration and type into g_pressInfo under mutex protection,
- *      then gives the binary semaphore to wake Task 2.
+ * Pass to pressCaptureInit().
+ */
+void onPressCaptured();
+
+/**
+ * @brief Create the one-shot timers that turn the indicator LEDs off.
+ *
+ * Call from setup(), before the scheduler starts.
+ *
+ * @return false if a timer could not be created (heap fallback only).
+ */
+bool measureLedTimeoutsInit();
+
+/**
+ * @brief FreeRTOS task function — Press forwarding and LED signaling.
+ *
+ * Blocks on g_captureSignal (bounded only while a backlog is pending).
+ * On each wake-up:
+ *   1. Drains the completed presses queued by PressCapture; their edges
+ *      were timestamped in hardware, so durations are exact to 4 µs.
+ *   2. Sends each duration and type as a PressInfo_t to Task 2 through
+ *      xPressQueue.
  *   3. Lights the green LED (short press) or red LED (long press) for
- *      LED_INDICATOR_DURATION_MS, with automatic turn-off managed via
- *      a timestamp check on each tick.
+ *      LED_INDICATOR_DURATION_MS; a software timer turns it off.
  *
  * @param pvParameters Unused (NULL).
  */
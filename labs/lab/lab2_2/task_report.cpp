@@ -3,20 +3,25 @@
  * @brief Lab 2.2 — Task 3 Implementation: Periodic STDIO Report
  *
  * Implements the lowest-priority FreeRTOS task that produces a formatted
- * statistics report every 10 seconds. The task uses vTaskDelayUntil() for
- * precise, drift-free periodic execution — a direct FreeRTOS equivalent of
- * the bare-metal scheduler's deadline-relative advancement.
+ * statistics report every 10 seconds. The task waits on an RtosPeriod for
+ * precise, drift-free periodic execution (millisecond deadlines, slept
+ * in FreeRTOS ticks) — the equivalent of the bare-metal scheduler's
+ * deadline-relative advancement.
  *
  * The statistics (total presses, short/long counts, average duration) are
  * read and reset atomically under mutex protection. This ensures Task 2
  * cannot update g_stats while Task 3 is reading, preventing torn reads
- * and counter skew.
+ * and counter skew. The press-duration percentiles and histogram
+ * (StreamStats) cover every press since boot and are not reset.
  */
 
 #include "task_report.h"
 #include "shared_state.h"
 
 #include <Arduino.h>
+#include "PressCapture.h"
+#include "RtosTime.h"
+#include "FlashString.h"
 #include <Arduino_FreeRTOS.h>
 #include <semphr.h>
 #include <stdio.h>
@@ -29,14 +34,15 @@ void vTaskReport(void *pvParameters) {
     (void)pvParameters;  // Unused
 
     // Local snapshot of statistics — read under mutex, printed after release.
-    Stats_t snapshot;
+    // Static: the StreamStats inside is too large for this task's stack.
+    static Stats_t snapshot;
 
-    // Compute delay in ticks once (10 000 ms ≈ 620 ticks at 62 Hz WDT).
-    const TickType_t xReportPeriodTicks = pdMS_TO_TICKS(TASK_REPORT_PERIOD_MS);
+    // Deadlines in millis(): whole WDT ticks (~16 ms) would drift.
+    RtosPeriod period(TASK_REPORT_PERIOD_MS);
 
     for (;;) {
         // ── Wait for the next 10-second interval ───────────────────────
-        vTaskDelay(xReportPeriodTicks > 0 ? xReportPeriodTicks : 1);
+        period.wait();
 
         // ── Atomically read and reset statistics ───────────────────────
         if (xSemaphoreTake(xSharedDataMutex, portMAX_DELAY) == pdTRUE) {
@@ -48,6 +54,7 @@ void vTaskReport(void *pvParameters) {
             g_stats.shortPresses    = 0;
             g_stats.longPresses     = 0;
             g_stats.totalDurationMs = 0;
+            g_stats.backlogPresses  = 0;
 
             xSemaphoreGive(xSharedDataMutex);
         }
@@ -58,15 +65,23 @@ void vTaskReport(void *pvParameters) {
                          : 0;
 
         // ── Print formatted report ─────────────────────────────────────
-        printf("\r\n===== [10s Report] =====\r\n");
-        printf("Total presses    : %lu\r\n", (unsigned long)snapshot.totalPresses);
-        printf("Short presses    : %lu  (< %u ms)\r\n",
-               (unsigned long)snapshot.shortPresses,
-               (unsigned int)SHORT_PRESS_THRESHOLD_MS);
-        printf("Long presses     : %lu  (>= %u ms)\r\n",
-               (unsigned long)snapshot.longPresses,
-               (unsigned int)SHORT_PRESS_THRESHOLD_MS);
-        printf("Average duration : %lu ms\r\n", (unsigned long)avgMs);
-        printf("========================\r\n");
+        FLASH_PRINTF("\r\n===== [10s Report] =====\r\n");
+        FLASH_PRINTF("Total presses    : %lu\r\n", (unsigned long)snapshot.totalPresses);
+        FLASH_PRINTF("Short presses    : %lu  (< %u ms)\r\n",
+                     (unsigned long)snapshot.shortPresses,
+                     (unsigned int)SHORT_PRESS_THRESHOLD_MS);
+        FLASH_PRINTF("Long presses     : %lu  (>= %u ms)\r\n",
+                     (unsigned long)snapshot.longPresses,
+                     (unsigned int)SHORT_PRESS_THRESHOLD_MS);
+        FLASH_PRINTF("Average duration : %lu ms\r\n", (unsigned long)avgMs);
+        FLASH_PRINTF("Queue overflows  : %lu  (counted late)\r\n",
+                     (unsigned long)snapshot.backlogPresses);
+        FLASH_PRINTF("Capture drops    : %u  (total)\r\n",
+                     (unsigned int)pressCaptureDroppedCount());
+        if (snapshot.durations.count() > 0) {
+            snapshot.durations.print("Since boot", "ms");
+            snapshot.durations.printHistogram("ms");
+        }
+        FLASH_PRINTF("========================\r\n");
     }
 }
@@ -13,16 +13,17 @@
 /**
  * @brief FreeRTOS task function — Periodic statistics reporting.
  *
- * Runs with a strict 10-second period using vTaskDelayUntil() for
+ * Runs with a strict 10-second period using RtosPeriod for
  * drift-free scheduling (equivalent to the bare-metal scheduler's
  * absolute nextRun advancement). On each iteration:
  *   1. Acquires xSharedDataMutex to atomically read and reset g_stats.
  *   2. Computes average press duration (integer division).
  *   3. Prints a formatted report to the serial STDIO terminal.
  *
- * The use of vTaskDelayUntil() (vs vTaskDelay()) ensures that the report
- * period remains exactly 10 seconds regardless of how long the printf()
- * call takes, preventing cumulative drift.
+ * Waiting for absolute deadlines (vs vTaskDelay()) keeps the report
+ * period at exactly 10 seconds regardless of how long the printf() call
+ * takes, and keeping them in millis() rather than WDT ticks keeps the
+ * 10 s crystal-accurate.
  *
  * @param pvParameters Unused (NULL).
  */
@@ -7,27 +7,35 @@
  * blink sequence.
  *
  * This task demonstrates two key FreeRTOS synchronization mechanisms:
- *   - Binary semaphore (event signaling): Task 2 blocks on
- *     xSemaphoreTake(xNewPressSemaphore, ...) until Task 1 gives the
- *     semaphore after detecting a complete press cycle.
- *   - Mutex (shared resource protection): Before accessing g_pressInfo
- *     and g_stats, Task 2 acquires xSharedDataMutex. This prevents data
- *     corruption if Task 3 simultaneously reads the statistics.
+ *   - Queue (event passing): Task 2 blocks on
+ *     xQueueReceive(xPressQueue, ...) until Task 1 sends the PressInfo_t
+ *     of a completed press; the event arrives by value.
+ *   - Mutex (shared resource protection): Before accessing g_stats,
+ *     Task 2 acquires xSharedDataMutex. This prevents data corruption if
+ *     Task 3 simultaneously reads the statistics.
  *
- * The blink sequence is implemented as a simple blocking loop with
- * vTaskDelay(). This is dramatically simpler than the non-blocking
- * state-machine approach required in the bare-metal Lab 2.1 version,
- * showcasing a core advantage of preemptive multitasking: each task
- * can use blocking delays without affecting other tasks.
+ * The blink sequence is handed to the Led pattern engine, which plays it
+ * from the Timer0 compare interrupt: the task returns to its queue at
+ * once, so the next press is counted immediately instead of after the
+ * blinks, and the 100 ms steps do not depend on tick rounding or on
+ * higher-priority tasks.
  */
 
 #include "task_stats.h"
 #include "shared_state.h"
 
 #include <Arduino.h>
+#include "Led.h"
 #include <Arduino_FreeRTOS.h>
+#include <queue.h>
 #include <semphr.h>
 
+/** One blink: ON then OFF for BLINK_HALF_PERIOD_MS each. */
+static const uint16_t BLINK_PATTERN_MS[] = { BLINK_HALF_PERIOD_MS, BLINK_HALF_PERIOD_MS };
+
+/** Yellow activity LED (initialized when the task starts). */
+static Led s_yellowLed(PIN_LED_YELLOW);
+
 // ──────────────────────────────────────────────────────────────────────────
 // Task 2 implementation
 // ──────────────────────────────────────────────────────────────────────────
@@ -38,44 +46,41 @@ void vTaskStats(void *pvParameters) {
     PressInfo_t localInfo;
     uint8_t     blinkCount;
 
+    s_yellowLed.init();
+
     for (;;) {
-        // ── Block until Task 1 signals a new press event ───────────────
-        // The binary semaphore acts as an event flag: Task 2 sleeps here
-        // with zero CPU usage until Task 1 gives the semaphore.
-        xSemaphoreTake(xNewPressSemaphore, portMAX_DELAY);
+        // ── Block until Task 1 sends a new press event ─────────────────
+        // Task 2 sleeps here with zero CPU usage until a PressInfo_t is
+        // queued; the copy is private, so no lock is needed to read it.
+        if (xQueueReceive(xPressQueue, &localInfo, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
 
-        // ── Read press info and update statistics under mutex ──────────
+        // ── Update statistics under mutex ──────────────────────────────
         if (xSemaphoreTake(xSharedDataMutex, portMAX_DELAY) == pdTRUE) {
-            // Copy press info locally so we can release the mutex quickly.
-            localInfo = g_pressInfo;
-
             // Update cumulative statistics.
-            g_stats.totalPresses++;
+            g_stats.totalPresses    += localInfo.presses;
+            g_stats.shortPresses    += localInfo.shortPresses;
+            g_stats.longPresses     += localInfo.presses - localInfo.shortPresses;
             g_stats.totalDurationMs += localInfo.duration;
-
-            if (localInfo.isShort) {
-                g_stats.shortPresses++;
+            if (localInfo.backlog) {
+                // Only the sum is known: counted, not in the distribution.
+                g_stats.backlogPresses += localInfo.presses;
             } else {
-                g_stats.longPresses++;
+                g_stats.durations.add(localInfo.duration);
             }
 
             xSemaphoreGive(xSharedDataMutex);
         }
 
         // ── Yellow LED blink sequence ──────────────────────────────────
-        // 5 blinks for short press, 10 blinks for long press.
-        // Each blink = LED ON for BLINK_HALF_PERIOD_MS, then OFF for
-        // BLINK_HALF_PERIOD_MS. Using vTaskDelay() releases the CPU to
-        // other tasks during the wait — this is a key advantage over
-        // the bare-metal polling approach.
-        blinkCount = localInfo.isShort ? BLINK_COUNT_SHORT : BLINK_COUNT_LONG;
-
-        for (uint8_t i = 0; i < blinkCount; i++) {
-            digitalWrite(PIN_LED_YELLOW, HIGH);
-            vTaskDelay(pdMS_TO_TICKS(BLINK_HALF_PERIOD_MS));
-
-            digitalWrite(PIN_LED_YELLOW, LOW);
-            vTaskDelay(pdMS_TO_TICKS(BLINK_HALF_PERIOD_MS));
+        // 5 blinks for short press, 10 blinks for long press, each ON for
+        // BLINK_HALF_PERIOD_MS then OFF for BLINK_HALF_PERIOD_MS. Played
+        // by the Timer0 compare ISR; a new press restarts the sequence.
+        if (localInfo.backlog) {
+            continue;
         }
+        blinkCount = (localInfo.shortPresses != 0) ? BLINK_COUNT_SHORT : BLINK_COUNT_LONG;
+        s_yellowLed.startPattern(BLINK_PATTERN_MS, 2, blinkCount);
     }
 }
@@ -23,9 +23,9 @@
  * │ Task         │ Trigger    │ Prio │ Responsibility                       │
  * ├──────────────┼────────────┼──────┼──────────────────────────────────────┤
  * │ Acquisition  │ 50 ms      │  3   │ Read NTC (ADC) + DS18B20 (OneWire)  │
- * │              │ DelayUntil │      │ Store in shared data, give semaphore │
+ * │              │ DelayUntil │      │ Store in shared data + reading queue │
  * ├──────────────┼────────────┼──────┼──────────────────────────────────────┤
- * │ Conditioning │ Semaphore  │  2   │ Hysteresis threshold + debounce     │
+ * │ Conditioning │ Queue      │  2   │ Hysteresis threshold + debounce     │
  * │              │ event      │      │ Alert FSM, LED control              │
  * ├──────────────┼────────────┼──────┼──────────────────────────────────────┤
  * │ Display      │ 500 ms     │  1   │ LCD update + STDIO structured report│
@@ -36,9 +36,9 @@
  * Synchronization mechanisms
  * ──────────────────────────────────────────────────────────────────────────
  *
- *   Binary Semaphore (xNewReadingSemaphore):
- *     Given by Task 1 after each acquisition cycle.
- *     Taken by Task 2 to process the new readings.
+ *   Queue (xReadingQueue):
+ *     Sent by Task 1 after each acquisition cycle (a copy of the readings).
+ *     Received by Task 2, in order; a full queue counts an overrun.
  *
  *   Mutex (xSensorMutex):
  *     Protects g_sensorData (Task 1 writes, Task 2/3 read) and
@@ -53,12 +53,29 @@
 #include "task_display.h"
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 #include <stdio.h>
 
+#include "StaticTaskSet.h"
 #include "StdioSerial.h"
+#include "FlashString.h"
 #include <stdlib.h>  // for dtostrf on AVR
 
+// ──────────────────────────────────────────────────────────────────────────
+// Task set — one row per task; TCBs and stacks reserved at link time
+// (StaticTaskSet)
+// ──────────────────────────────────────────────────────────────────────────
+
+static constexpr StaticTaskDesc TASKS[] PROGMEM = {
+    STATIC_TASK(vTaskAcquisition,  "Acquire", TASK_ACQUISITION_STACK,  TASK_ACQUISITION_PRIORITY,
+                TASK_ACQUISITION_PERIOD_MS),
+    STATIC_TASK(vTaskConditioning, "Cond",    TASK_CONDITIONING_STACK, TASK_CONDITIONING_PRIORITY,
+                0),
+    STATIC_TASK(vTaskDisplay,      "Display", TASK_DISPLAY_STACK,      TASK_DISPLAY_PRIORITY,
+                TASK_DISPLAY_PERIOD_MS),
+};
+static STATIC_TASK_SET(s_tasks, TASKS);
+
 // ──────────────────────────────────────────────────────────────────────────
 // Lab 3.1 public entry points
 // ──────────────────────────────────────────────────────────────────────────
@@ -68,69 +85,48 @@ void lab3_1Setup() {
     stdioSerialInit(9600);
 
     // ── Print startup banner ───────────────────────────────────────────
-    printf("\r\n");
-    printf("================================================\r\n");
-    printf("  Lab 3.1 — Dual-Sensor Temperature Monitor\r\n");
-    printf("  FreeRTOS Preemptive Scheduler\r\n");
-    printf("  Tasks: 3 | Tick: %u Hz\r\n",
-           (unsigned int)configTICK_RATE_HZ);
-    printf("================================================\r\n");
-    printf("SENSORS:\r\n");
-    printf("  Analog:  NTC Thermistor (A0, 10K, Beta=3950)\r\n");
-    printf("  Digital: DS18B20 (Pin 2, OneWire, 10-bit)\r\n");
-    printf("THRESHOLDS:\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("  Lab 3.1 — Dual-Sensor Temperature Monitor\r\n");
+    FLASH_PRINTF("  FreeRTOS Preemptive Scheduler\r\n");
+    FLASH_PRINTF("  Tasks: 3 | Tick: %u Hz\r\n",
+                 (unsigned int)configTICK_RATE_HZ);
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("SENSORS:\r\n");
+    FLASH_PRINTF("  Analog:  NTC Thermistor (A0, 10K, Beta=3950)\r\n");
+    FLASH_PRINTF("  Digital: DS18B20 (Pin 2, OneWire, 10-bit)\r\n");
+    FLASH_PRINTF("THRESHOLDS:\r\n");
     // AVR printf does NOT support %f — use dtostrf + %s.
     char ahBuf[8], alBuf[8], dhBuf[8], dlBuf[8];
     dtostrf(ANALOG_THRESHOLD_HIGH,  4, 1, ahBuf);
     dtostrf(ANALOG_THRESHOLD_LOW,   4, 1, alBuf);
     dtostrf(DIGITAL_THRESHOLD_HIGH, 4, 1, dhBuf);
     dtostrf(DIGITAL_THRESHOLD_LOW,  4, 1, dlBuf);
-    printf("  Analog:  HIGH=%sC  LOW=%sC\r\n", ahBuf, alBuf);
-    printf("  Digital: HIGH=%sC  LOW=%sC\r\n", dhBuf, dlBuf);
-    printf("  Debounce: %u confirmations\r\n",
-           (unsigned int)ALERT_DEBOUNCE_COUNT);
-    printf("LEDs:\r\n");
-    printf("  GREEN  = system normal (no alerts)\r\n");
-    printf("  RED    = analog sensor alert\r\n");
-    printf("  YELLOW = digital sensor alert\r\n");
-    printf("TIMING:\r\n");
-    printf("  Acquisition:   %u ms\r\n",
-           (unsigned int)TASK_ACQUISITION_PERIOD_MS);
-    printf("  Display/Report: %u ms\r\n",
-           (unsigned int)TASK_DISPLAY_PERIOD_MS);
-    printf("  STDIO Report:  every 2 seconds\r\n");
-    printf("================================================\r\n\r\n");
+    FLASH_PRINTF("  Analog:  HIGH=%sC  LOW=%sC\r\n", ahBuf, alBuf);
+    FLASH_PRINTF("  Digital: HIGH=%sC  LOW=%sC\r\n", dhBuf, dlBuf);
+    FLASH_PRINTF("  Debounce: %u confirmations\r\n",
+                 (unsigned int)ALERT_DEBOUNCE_COUNT);
+    FLASH_PRINTF("LEDs:\r\n");
+    FLASH_PRINTF("  GREEN  = system normal (no alerts)\r\n");
+    FLASH_PRINTF("  RED    = analog sensor alert\r\n");
+    FLASH_PRINTF("  YELLOW = digital sensor alert\r\n");
+    FLASH_PRINTF("TIMING:\r\n");
+    FLASH_PRINTF("  Acquisition:   %u ms\r\n",
+                 (unsigned int)TASK_ACQUISITION_PERIOD_MS);
+    FLASH_PRINTF("  Display/Report: %u ms\r\n",
+                 (unsigned int)TASK_DISPLAY_PERIOD_MS);
+    FLASH_PRINTF("  STDIO Report:  every 2 seconds\r\n");
+    FLASH_PRINTF("================================================\r\n\r\n");
 
     // ── Create synchronization primitives ──────────────────────────────
     sensorDataInit();
 
     // ── Create FreeRTOS tasks ──────────────────────────────────────────
-    xTaskCreate(
-        vTaskAcquisition,
-        "Acquire",
-        TASK_ACQUISITION_STACK,
-        NULL,
-        TASK_ACQUISITION_PRIORITY,
-        NULL
-    );
-
-    xTaskCreate(
-        vTaskConditioning,
-        "Cond",
-        TASK_CONDITIONING_STACK,
-        NULL,
-        TASK_CONDITIONING_PRIORITY,
-        NULL
-    );
+    s_tasks.launch(TASKS);  // [ERROR] line per task that cannot be created
 
-    xTaskCreate(
-        vTaskDisplay,
-        "Display",
-        TASK_DISPLAY_STACK,
-        NULL,
-        TASK_DISPLAY_PRIORITY,
-        NULL
-    );
+    // Kernel tick on a 1 ms timer compare with -DRTOS_TICK_TIMER (RtosTick.h);
+    // last, as it keeps interrupts off until the scheduler starts.
+    rtosTickInit();
 
     // The FreeRTOS scheduler starts automatically after setup() returns
     // (handled by the Arduino_FreeRTOS library integration).
@@ -16,10 +16,10 @@
  *   Task 1 — Sensor Acquisition (50 ms period, priority 3):
  *     Reads both temperature sensors at 20 Hz, converts raw readings
  *     to degrees Celsius, and stores results in shared memory with
- *     mutex protection and semaphore signaling.
+ *     mutex protection, and queues each reading to Task 2.
  *
  *   Task 2 — Signal Conditioning & Alerting (event-driven, priority 2):
- *     Waits on the acquisition semaphore, applies hysteresis-based
+ *     Receives every queued reading, applies hysteresis-based
  *     threshold detection for both sensors independently, tracks
  *     debounce state, and controls LED indicators.
  *
@@ -44,7 +44,7 @@
  * @brief Initialize hardware, create FreeRTOS tasks and start the scheduler.
  *
  * Configures STDIO serial, creates synchronization primitives (mutex
- * and binary semaphore), prints the startup banner, and spawns three
+ * and reading queue), prints the startup banner, and spawns three
  * FreeRTOS tasks for sensor acquisition, conditioning, and display.
  */
 void lab3_1Setup();
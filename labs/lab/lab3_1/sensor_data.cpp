@@ -8,48 +8,70 @@
  */
 
 #include "sensor_data.h"
+#include "StaticRtos.h"
+#include "AnalogTempSensor.h"
+#include "DigitalTempSensor.h"
 
 // ──────────────────────────────────────────────────────────────────────────
-// Shared data — zero-initialized at startup
+// Sensor channels — drivers, LEDs and the table that binds them
 // ──────────────────────────────────────────────────────────────────────────
 
-SensorReadings_t g_sensorData = {
-    0,      // analogRaw
-    0.0f,   // analogResistance
-    0.0f,   // analogTempC
-    false,  // analogValid
-    0.0f,   // digitalTempC
-    false,  // digitalValid
-    0,      // readingCount
-    0       // timestamp
-};
+static AnalogTempSensor  s_ntcSensor(PIN_ANALOG_SENSOR,
+                                     NTC_SERIES_RESISTANCE,
+                                     NTC_NOMINAL_RESISTANCE,
+                                     NTC_BETA_COEFFICIENT,
+                                     NTC_NOMINAL_TEMP_C);
+
+/** ADC → °C table for the NTC (filled by its init()). */
+static int16_t s_ntcLut[AnalogTempSensor::LUT_ENTRIES];
 
-AlertStatus_t g_alertData = {
-    ALERT_NORMAL,  // analogAlertState
-    0,             // analogDebounceCount
-    0.0f,          // analogFilteredTemp
-    ALERT_NORMAL,  // digitalAlertState
-    0,             // digitalDebounceCount
-    0.0f,          // digitalFilteredTemp
-    0,             // analogAlertCount
-    0,             // digitalAlertCount
-    0              // conditioningCycles
+static DigitalTempSensor s_ds18b20(PIN_DIGITAL_SENSOR, DS18B20_RESOLUTION);
+
+Led g_normalLed(PIN_LED_GREEN);
+static Led s_redLed(PIN_LED_RED);
+static Led s_yellowLed(PIN_LED_YELLOW);
+
+const SensorChannel SENSOR_CHANNELS[SENSOR_CHANNEL_COUNT] = {
+    // name, NTC, DS18B20,
+    // conditioner { alpha, min, max, One-Euro minCutoff (0 = off), beta, dCutoff },
+    // alert { high, low, debounce, raise / clear dwell, hold on invalid },
+    // NTC table, LED
+    { "Analog", &s_ntcSensor, NULL,
+      { 1.0f, -40.0f, 125.0f, 0.0f, 0.0f, 0.0f },
+      { ANALOG_THRESHOLD_HIGH, ANALOG_THRESHOLD_LOW, ALERT_DEBOUNCE_COUNT, 0, 0, true },
+      NTC_USE_LOOKUP_TABLE ? s_ntcLut : NULL, &s_redLed },
+    { "Digital", NULL, &s_ds18b20,
+      { 1.0f, -40.0f, 125.0f, 0.0f, 0.0f, 0.0f },
+      { DIGITAL_THRESHOLD_HIGH, DIGITAL_THRESHOLD_LOW, ALERT_DEBOUNCE_COUNT, 0, 0, true },
+      NULL, &s_yellowLed },
 };
 
 // ──────────────────────────────────────────────────────────────────────────
-// Synchronization primitives — created at runtime
+// Shared data — zero-initialized at startup
+// ──────────────────────────────────────────────────────────────────────────
+
+SensorReadings_t g_sensorData;
+
+AlertStatus_t g_alertData;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Synchronization primitives — created in sensorDataInit() on storage
+// reserved at link time (StaticRtos)
 // ──────────────────────────────────────────────────────────────────────────
 
-SemaphoreHandle_t xNewReadingSemaphore = NULL;
-SemaphoreHandle_t xSensorMutex         = NULL;
+static StaticQueue<SensorReadings_t, READING_QUEUE_LENGTH> s_readingQueue;
+static StaticMutex s_sensorMutex;
+
+QueueHandle_t     xReadingQueue = NULL;
+SemaphoreHandle_t xSensorMutex  = NULL;
 
 void sensorDataInit() {
-    // Binary semaphore starts "empty" — Task 2 will block until
-    // Task 1 gives it after completing a sensor acquisition cycle.
-    xNewReadingSemaphore = xSemaphoreCreateBinary();
+    // Queue starts empty — Task 2 blocks until Task 1 queues the
+    // readings of its first acquisition cycle.
+    xReadingQueue = s_readingQueue.create();
 
     // Mutex with priority inheritance — prevents priority inversion
     // when Task 3 (low priority) holds the mutex and Task 1 (high
     // priority) attempts to acquire it.
-    xSensorMutex = xSemaphoreCreateMutex();
+    xSensorMutex = s_sensorMutex.create();
 }
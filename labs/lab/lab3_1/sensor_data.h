@@ -13,24 +13,38 @@
  *   Mutex (xSensorMutex): protects concurrent read/write access to
  *   g_sensorData and g_alertData across all three tasks.
  *
- *   Binary Semaphore (xNewReadingSemaphore): signals from the acquisition
- *   task to the conditioning task that a new sensor reading is available.
+ *   Queue (xReadingQueue): carries a timestamped copy of every reading
+ *   from the acquisition task to the conditioning task, so a late
+ *   conditioning cycle works off the backlog instead of losing samples.
  *
  * ──────────────────────────────────────────────────────────────────────────
  * Data flow
  * ──────────────────────────────────────────────────────────────────────────
  *
- *   Task 1 (Acquisition) ──[mutex + semaphore]──> Task 2 (Conditioning)
+ *   Task 1 (Acquisition) ──[queue]──> Task 2 (Conditioning)
  *   Task 2 (Conditioning) ──[mutex]──> Task 3 (Display & Report)
+ *
+ * ──────────────────────────────────────────────────────────────────────────
+ * Channel table
+ * ──────────────────────────────────────────────────────────────────────────
+ *
+ *   SENSOR_CHANNELS (sensor_data.cpp) has one row per sensor: driver,
+ *   conditioner and alert settings, LED (SensorPipeline.h). Tasks 1 and 2
+ *   run every row; the shared structs hold one array entry per channel.
+ *   This lab alerts on the raw readings: its conditioner is a pass-through
+ *   (1-sample window, alpha 1), and an invalid reading keeps the alert
+ *   state.
  */
 
 #ifndef SENSOR_DATA_H
 #define SENSOR_DATA_H
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 #include <semphr.h>
+#include <queue.h>
 #include "ThresholdAlert.h"
+#include "SensorPipeline.h"
 
 // ══════════════════════════════════════════════════════════════════════════
 // Hardware Pin Mapping (Arduino Mega 2560)
@@ -72,6 +86,12 @@ static const uint16_t NTC_BETA_COEFFICIENT = 3950;
 /** NTC nominal temperature (°C). */
 static const float NTC_NOMINAL_TEMP_C = 25.0f;
 
+/**
+ * Convert ADC counts through a table built in init() (linear interpolation,
+ * < 0.1 °C error over -20..80 °C) instead of log() per sample.
+ */
+static const bool NTC_USE_LOOKUP_TABLE = true;
+
 // ══════════════════════════════════════════════════════════════════════════
 // DS18B20 Parameters
 // ══════════════════════════════════════════════════════════════════════════
@@ -79,6 +99,27 @@ static const float NTC_NOMINAL_TEMP_C = 25.0f;
 /** DS18B20 measurement resolution (9–12 bits). */
 static const uint8_t DS18B20_RESOLUTION = 10;
 
+/**
+ * Task 1 times each DS18B20 request so the conversion, plus the bus work
+ * of the cycle that issues the next one, is done by the release that
+ * reads it (AcquisitionScheduler): DS18B20_READ_MS per device (Match ROM
+ * + scratchpad read, Convert T) and ACQUISITION_GUARD_MS for the release
+ * wake-up, which is only within one tick of its time.
+ */
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+static const uint16_t DS18B20_READ_MS = 18;   // ~14 ms read, asleep for >= a tick
+#else
+static const uint16_t DS18B20_READ_MS = 12;
+#endif
+static const uint16_t ACQUISITION_GUARD_MS = portTICK_PERIOD_MS;
+
+/**
+ * With -DDIGITAL_TEMP_UART_ONEWIRE, 1-Wire transfers expected to take at
+ * least half a tick (the addressed scratchpad read) sleep instead of
+ * spinning; shorter ones (Convert T, the fast read) are spun out.
+ */
+static const uint16_t ONEWIRE_SLEEP_MIN_US = portTICK_PERIOD_MS * 500U;
+
 // ══════════════════════════════════════════════════════════════════════════
 // Threshold Alert Parameters
 // ══════════════════════════════════════════════════════════════════════════
@@ -98,6 +139,20 @@ static const float DIGITAL_THRESHOLD_LOW = 28.0f;
 /** Number of consecutive readings to confirm a state transition. */
 static const uint8_t ALERT_DEBOUNCE_COUNT = 5;
 
+// ══════════════════════════════════════════════════════════════════════════
+// Sensor Channels
+// ══════════════════════════════════════════════════════════════════════════
+
+/** Rows of SENSOR_CHANNELS (index into every per-channel array). */
+enum SensorChannelIndex {
+    CH_ANALOG = 0,        /**< NTC thermistor.                              */
+    CH_DIGITAL = 1,       /**< DS18B20.                                     */
+    SENSOR_CHANNEL_COUNT
+};
+
+/** Pass-through conditioning: one-sample window (readings alerted raw). */
+static const uint8_t MEDIAN_WINDOW_SIZE = 1;
+
 // ══════════════════════════════════════════════════════════════════════════
 // FreeRTOS Task Configuration
 // ══════════════════════════════════════════════════════════════════════════
@@ -117,31 +172,21 @@ static const uint32_t TASK_DISPLAY_PERIOD_MS = 500;
 static const UBaseType_t TASK_DISPLAY_PRIORITY = 1;
 static const configSTACK_DEPTH_TYPE TASK_DISPLAY_STACK = 512;
 
+/** Readings buffered between Task 1 and Task 2 (4 × 50 ms of slack). */
+static const UBaseType_t READING_QUEUE_LENGTH = 4;
+
 // ══════════════════════════════════════════════════════════════════════════
 // Shared Data Structures
 // ══════════════════════════════════════════════════════════════════════════
 
 /**
- * @brief Sensor readings shared between Task 1 and Task 2.
+ * @brief Sensor readings of one acquisition cycle, per channel.
  *
- * Written by Task 1 (Acquisition) under mutex protection.
- * Read by Task 2 (Conditioning) after semaphore notification.
+ * Task 1 (Acquisition) writes the latest one to g_sensorData under mutex
+ * protection for the display, and queues a copy to Task 2 (Conditioning).
+ * sequence counts the acquisition cycles.
  */
-typedef struct {
-    // ── Analog sensor (NTC thermistor) ─────────────────────────────────
-    uint16_t analogRaw;          /**< Raw ADC value (0–1023).              */
-    float    analogResistance;   /**< Calculated NTC resistance (ohms).    */
-    float    analogTempC;        /**< Converted temperature (°C).          */
-    bool     analogValid;        /**< True if reading is valid.            */
-
-    // ── Digital sensor (DS18B20) ───────────────────────────────────────
-    float    digitalTempC;       /**< DS18B20 temperature (°C).            */
-    bool     digitalValid;       /**< True if reading is valid.            */
-
-    // ── Metadata ───────────────────────────────────────────────────────
-    uint32_t readingCount;       /**< Total number of acquisition cycles.  */
-    TickType_t timestamp;        /**< Tick count at last acquisition.      */
-} SensorReadings_t;
+typedef SensorSample<SENSOR_CHANNEL_COUNT> SensorReadings_t;
 
 /**
  * @brief Alert status shared between Task 2 and Task 3.
@@ -150,39 +195,34 @@ typedef struct {
  * Read by Task 3 (Display & Report) under mutex protection.
  */
 typedef struct {
-    // ── Analog sensor alert ────────────────────────────────────────────
-    AlertState analogAlertState;     /**< Current FSM state.               */
-    uint8_t    analogDebounceCount;  /**< Current debounce counter.        */
-    float      analogFilteredTemp;   /**< Last filtered temperature (°C).  */
-
-    // ── Digital sensor alert ───────────────────────────────────────────
-    AlertState digitalAlertState;    /**< Current FSM state.               */
-    uint8_t    digitalDebounceCount; /**< Current debounce counter.        */
-    float      digitalFilteredTemp;  /**< Last filtered temperature (°C).  */
-
-    // ── System status ──────────────────────────────────────────────────
-    uint32_t analogAlertCount;       /**< Total analog alert activations.  */
-    uint32_t digitalAlertCount;      /**< Total digital alert activations. */
-    uint32_t conditioningCycles;     /**< Total conditioning cycles.       */
+    SensorAlerts<SENSOR_CHANNEL_COUNT> channel;  /**< Per-channel FSM status. */
+    uint32_t conditioningCycles;                 /**< Total conditioning cycles. */
 } AlertStatus_t;
 
 // ══════════════════════════════════════════════════════════════════════════
 // External Declarations
 // ══════════════════════════════════════════════════════════════════════════
 
-/** Sensor readings — written by Task 1, consumed by Task 2. */
+/** Latest sensor readings — written by Task 1, read by Task 3. */
 extern SensorReadings_t g_sensorData;
 
 /** Alert status — written by Task 2, read by Task 3. */
 extern AlertStatus_t g_alertData;
 
+/** One row per sensor (drivers and LEDs are defined with it). */
+extern const SensorChannel SENSOR_CHANNELS[SENSOR_CHANNEL_COUNT];
+
+/** Lit while every channel is NORMAL (Task 2). */
+extern Led g_normalLed;
+
 /**
- * @brief Binary semaphore for new-reading notification (Task 1 → Task 2).
+ * @brief Queue of SensorReadings_t (Task 1 → Task 2).
  *
- * Given by Task 1 after each acquisition cycle completes.
- * Taken by Task 2 to wake up and process the new readings.
+ * Sent by Task 1 after each acquisition cycle without waiting; a full
+ * queue drops the reading and counts it in overruns.
+ * Received by Task 2, which blocks on it.
  */
-extern SemaphoreHandle_t xNewReadingSemaphore;
+extern QueueHandle_t xReadingQueue;
 
 /**
  * @brief Mutex for protecting shared data (g_sensorData, g_alertData).
@@ -12,33 +12,51 @@
  * ──────────────────────────────────────────────────────────────────────────
  *
  *   1. Read NTC thermistor via analogRead() → convert to °C (Beta eq.)
- *   2. Read DS18B20 via DallasTemperature → get °C directly
+ *   2. If the schedule says the DS18B20 conversion is due, read it by
+ *      cached ROM address; otherwise keep the last known value
+ *      (both: SensorAcquisition over the SENSOR_CHANNELS rows)
  *   3. Acquire mutex → write to g_sensorData → release mutex
- *   4. Give binary semaphore → wake up Task 2
+ *   4. Queue a copy of the readings → wake up Task 2 (never waits; a
+ *      full queue drops it and counts an overrun)
+ *   5. Sleep to the offset the schedule gives and start the next
+ *      DS18B20 conversion, if one is due this period
  *
- * The DS18B20 conversion is handled in blocking mode within the task;
- * at 10-bit resolution, conversion takes ~188 ms but the DallasTemperature
- * library manages this internally. For the 50 ms task period, we request
- * conversions and read the previous result on the next cycle.
+ * The DS18B20 converts in the background (non-blocking, deadline-based):
+ * at 10-bit resolution a conversion takes ~188 ms, several 50 ms periods.
+ * AcquisitionScheduler times each request backwards from the release
+ * that reads it, so every reading arrives on a fixed release, the same
+ * age each time (conversion + DS18B20_READ_MS + ACQUISITION_GUARD_MS:
+ * every 5th release at 10 bits). The first conversion is started at
+ * task start and counts as the first period's request.
  */
 
 #include "task_acquisition.h"
 #include "sensor_data.h"
 
-#include "AnalogTempSensor.h"
-#include "DigitalTempSensor.h"
+#include "SensorAcquisition.h"
+#include "RtosTime.h"
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+#include "UartOneWire.h"
+#endif
 
 // ──────────────────────────────────────────────────────────────────────────
-// Local sensor instances (owned by this task — no sharing needed)
+// Acquisition stage (owned by this task — the drivers are table rows)
 // ──────────────────────────────────────────────────────────────────────────
 
-static AnalogTempSensor  s_ntcSensor(PIN_ANALOG_SENSOR,
-                                     NTC_SERIES_RESISTANCE,
-                                     NTC_NOMINAL_RESISTANCE,
-                                     NTC_BETA_COEFFICIENT,
-                                     NTC_NOMINAL_TEMP_C);
-
-static DigitalTempSensor s_ds18b20(PIN_DIGITAL_SENSOR, DS18B20_RESOLUTION);
+/** Reads SENSOR_CHANNELS (static: keeps the sample off the task stack). */
+static SensorAcquisition<SENSOR_CHANNEL_COUNT> s_acquisition(SENSOR_CHANNELS,
+                                                             (uint16_t)TASK_ACQUISITION_PERIOD_MS,
+                                                             ACQUISITION_GUARD_MS,
+                                                             DS18B20_READ_MS);
+
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+/** UartOneWire wait hook: sleep through long transfers (this task only). */
+static void oneWireWait(uint16_t expectedUs) {
+    if (expectedUs >= ONEWIRE_SLEEP_MIN_US) {
+        vTaskDelay(rtosMsToTicks(expectedUs / 1000U));
+    }
+}
+#endif
 
 // ──────────────────────────────────────────────────────────────────────────
 // Task function
@@ -46,88 +64,38 @@ static DigitalTempSensor s_ds18b20(PIN_DIGITAL_SENSOR, DS18B20_RESOLUTION);
 
 void vTaskAcquisition(void *pvParameters) {
     (void)pvParameters;
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+    uartOneWireSetWait(oneWireWait);  // Only this task uses the bus
+#endif
 
-    // Initialize sensor hardware.
-    s_ntcSensor.init();
-    bool ds18b20Found = s_ds18b20.init();
-
-    // Kick off the first DS18B20 conversion so the next read has data.
-    if (ds18b20Found) {
-        s_ds18b20.requestConversion();
-    }
-
-    // Track whether the first DS18B20 conversion is still pending.
-    bool firstConversion = true;
+    // Initialize the sensors; the first DS18B20 conversion starts here
+    // and counts as the first period's request.
+    s_acquisition.begin();
+    s_acquisition.start();
 
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(TASK_ACQUISITION_PERIOD_MS);
-
-    // Local variables for readings (avoid holding mutex during I/O).
-    uint16_t rawAdc;
-    float    resistance;
-    float    analogTemp;
-    bool     analogOk;
-    float    digitalTemp;
-    bool     digitalOk;
+    RtosPeriod period(TASK_ACQUISITION_PERIOD_MS);
 
     for (;;) {
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);
-
-        // ── 1. Read analog sensor (NTC thermistor) ────────────────────
-        // readTemperatureC() internally calls readResistance() → readRaw().
-        // Cache all results from that single ADC acquisition to avoid a
-        // second analogRead() (which could return a different value).
-        analogTemp  = s_ntcSensor.readTemperatureC();
-        rawAdc      = s_ntcSensor.getLastRaw();
-        resistance  = s_ntcSensor.getLastResistance();
-        analogOk    = s_ntcSensor.isValid();
+        period.wait();
 
-        // ── 2. Read digital sensor (DS18B20) ──────────────────────────
-        if (ds18b20Found) {
-            if (firstConversion) {
-                // Wait for the initial conversion to complete.
-                while (!s_ds18b20.isConversionComplete()) {
-                    vTaskDelay(pdMS_TO_TICKS(10));
-                }
-                firstConversion = false;
-            }
-
-            if (s_ds18b20.isConversionComplete()) {
-                // Read the result of the already-completed conversion.
-                // readLastConversionC() does NOT trigger a new conversion,
-                // avoiding a ~188ms blocking stall inside this task.
-                digitalTemp = s_ds18b20.readLastConversionC();
-                digitalOk   = s_ds18b20.isValid();
-            } else {
-                // Conversion not yet complete — use last known value.
-                digitalTemp = s_ds18b20.getLastTemperatureC();
-                digitalOk   = s_ds18b20.isValid();
-            }
-
-            // Start the next conversion (non-blocking).
-            s_ds18b20.requestConversion();
-        } else {
-            digitalTemp = NAN;
-            digitalOk   = false;
-        }
+        // ── 1–2. Read every channel (no lock held during I/O) ─────────
+        const SensorReadings_t &reading = s_acquisition.acquire();
 
         // ── 3. Write to shared data under mutex protection ────────────
-        if (xSemaphoreTake(xSensorMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            g_sensorData.analogRaw        = rawAdc;
-            g_sensorData.analogResistance = resistance;
-            g_sensorData.analogTempC      = analogTemp;
-            g_sensorData.analogValid      = analogOk;
-
-            g_sensorData.digitalTempC     = digitalTemp;
-            g_sensorData.digitalValid     = digitalOk;
-
-            g_sensorData.readingCount++;
-            g_sensorData.timestamp = xTaskGetTickCount();
-
+        bool written = false;
+        if (xSemaphoreTake(xSensorMutex, rtosMsToTicks(10)) == pdTRUE) {
+            g_sensorData = reading;
+            written = true;
             xSemaphoreGive(xSensorMutex);
         }
 
-        // ── 4. Notify Task 2 that new data is available ───────────────
-        xSemaphoreGive(xNewReadingSemaphore);
+        // ── 4. Queue the readings for Task 2 ──────────────────────────
+        // The overrun shows in the next sample.
+        if (written && xQueueSend(xReadingQueue, &reading, 0) != pdTRUE) {
+            s_acquisition.countOverrun();
+        }
+
+        // ── 5. Start the DS18B20 conversion due in this period ────────
+        s_acquisition.requestDue(period);
     }
 }
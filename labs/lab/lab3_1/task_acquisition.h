@@ -7,7 +7,7 @@
  * NTC thermistor (via ADC) and the digital DS18B20 sensor (via OneWire).
  *
  * Data flow:
- *   ADC / OneWire → sensor drivers → g_sensorData (mutex) → semaphore give
+ *   ADC / OneWire → sensor drivers → g_sensorData (mutex) → reading queue
  *
  * Task characteristics:
  *   Period:   50 ms (configurable via TASK_ACQUISITION_PERIOD_MS)
@@ -24,8 +24,8 @@
  * @brief FreeRTOS task function for sensor acquisition.
  *
  * Periodically reads both temperature sensors, stores the raw and
- * converted values in g_sensorData under mutex protection, and gives
- * the binary semaphore to notify Task 2 (conditioning).
+ * converted values in g_sensorData under mutex protection, and queues
+ * a copy for Task 2 (conditioning).
  *
  * @param pvParameters Unused (NULL).
  */
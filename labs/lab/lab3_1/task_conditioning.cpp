@@ -4,16 +4,17 @@
  *
  * Implements the threshold-based signal conditioning and alert management
  * for both analog and digital temperature sensors. Uses the ThresholdAlert
- * module for hysteresis detection and debounce filtering.
+ * bank for hysteresis detection and debounce filtering.
  *
  * ──────────────────────────────────────────────────────────────────────────
  * Processing sequence (each event)
  * ──────────────────────────────────────────────────────────────────────────
  *
- *   1. Take binary semaphore (block until Task 1 signals)
- *   2. Acquire mutex → read g_sensorData → release mutex
- *   3. Feed analog temperature into ThresholdAlert FSM
- *   4. Feed digital temperature into ThresholdAlert FSM
+ *   1. Receive the next reading from the queue (block until Task 1
+ *      sends one)
+ *   2. Take the temperatures from the received copy (no lock needed)
+ *   3–4. Feed both temperatures into their alert FSMs in one
+ *      ThresholdAlertBank call (SensorConditioning over SENSOR_CHANNELS)
  *   5. Acquire mutex → write g_alertData → release mutex
  *   6. Update LED indicators based on alert states
  *
@@ -25,28 +26,15 @@
 
 #include "task_conditioning.h"
 #include "sensor_data.h"
-#include "ThresholdAlert.h"
-#include "Led.h"
+#include "RtosTime.h"
 
 // ──────────────────────────────────────────────────────────────────────────
-// Local alert instances (owned by this task)
+// Conditioning stage (owned by this task)
 // ──────────────────────────────────────────────────────────────────────────
 
-static ThresholdAlert s_analogAlert(ANALOG_THRESHOLD_HIGH,
-                                    ANALOG_THRESHOLD_LOW,
-                                    ALERT_DEBOUNCE_COUNT);
-
-static ThresholdAlert s_digitalAlert(DIGITAL_THRESHOLD_HIGH,
-                                     DIGITAL_THRESHOLD_LOW,
-                                     ALERT_DEBOUNCE_COUNT);
-
-// ──────────────────────────────────────────────────────────────────────────
-// Local LED instances
-// ──────────────────────────────────────────────────────────────────────────
-
-static Led s_greenLed(PIN_LED_GREEN);
-static Led s_redLed(PIN_LED_RED);
-static Led s_yellowLed(PIN_LED_YELLOW);
+/** Alert FSMs and LEDs of SENSOR_CHANNELS; pass-through conditioner. */
+static SensorConditioning<SENSOR_CHANNEL_COUNT, MEDIAN_WINDOW_SIZE> s_conditioning(SENSOR_CHANNELS,
+                                                                                   &g_normalLed);
 
 // ──────────────────────────────────────────────────────────────────────────
 // Task function
@@ -55,119 +43,36 @@ static Led s_yellowLed(PIN_LED_YELLOW);
 void vTaskConditioning(void *pvParameters) {
     (void)pvParameters;
 
-    // Initialize alert modules and LEDs.
-    s_analogAlert.init();
-    s_digitalAlert.init();
-    s_greenLed.init();
-    s_redLed.init();
-    s_yellowLed.init();
-
-    // Start with green LED on (system normal).
-    s_greenLed.turnOn();
-    s_redLed.turnOff();
-    s_yellowLed.turnOff();
-
-    // Local copies of sensor readings (avoid holding mutex during processing).
-    float analogTemp;
-    float digitalTemp;
-    bool  analogValid;
-    bool  digitalValid;
+    // Configure the alert FSMs from the table; green LED on (system normal).
+    s_conditioning.init(TASK_ACQUISITION_PERIOD_MS / 1000.0f);
 
-    // Track previous alert states for transition counting.
-    AlertState prevAnalogState  = ALERT_NORMAL;
-    AlertState prevDigitalState = ALERT_NORMAL;
+    SensorReadings_t reading;
 
     for (;;) {
-        // ── 1. Wait for new sensor data ───────────────────────────────
-        if (xSemaphoreTake(xNewReadingSemaphore, portMAX_DELAY) != pdTRUE) {
+        // ── 1. Wait for the next reading ──────────────────────────────
+        if (xQueueReceive(xReadingQueue, &reading, portMAX_DELAY) != pdTRUE) {
             continue;
         }
 
-        // ── 2. Read sensor data under mutex ───────────────────────────
-        if (xSemaphoreTake(xSensorMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            analogTemp   = g_sensorData.analogTempC;
-            digitalTemp  = g_sensorData.digitalTempC;
-            analogValid  = g_sensorData.analogValid;
-            digitalValid = g_sensorData.digitalValid;
-            xSemaphoreGive(xSensorMutex);
-        } else {
-            continue;  // Could not acquire mutex — skip this cycle.
-        }
-
-        // ── 3. Apply threshold detection with hysteresis ──────────────
-        // If reading is invalid, preserve the FSM's current state rather
-        // than defaulting to ALERT_NORMAL (which would cause false green
-        // flicker when the DS18B20 is mid-conversion and returns NAN).
-        AlertState analogState  = s_analogAlert.getState();
-        AlertState digitalState = s_digitalAlert.getState();
-
-        if (analogValid && !isnan(analogTemp)) {
-            analogState = s_analogAlert.update(analogTemp);
-        }
-
-        if (digitalValid && !isnan(digitalTemp)) {
-            digitalState = s_digitalAlert.update(digitalTemp);
-        }
-
-        // ── 4. Write alert status under mutex ─────────────────────────
-        if (xSemaphoreTake(xSensorMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            g_alertData.analogAlertState    = analogState;
-            g_alertData.analogDebounceCount = s_analogAlert.getDebounceCounter();
-            g_alertData.analogFilteredTemp  = analogTemp;
-
-            g_alertData.digitalAlertState    = digitalState;
-            g_alertData.digitalDebounceCount = s_digitalAlert.getDebounceCounter();
-            g_alertData.digitalFilteredTemp  = digitalTemp;
-
-            // Count new alert activations.
-            if (analogState == ALERT_ACTIVE && prevAnalogState != ALERT_ACTIVE) {
-                g_alertData.analogAlertCount++;
-            }
-            if (digitalState == ALERT_ACTIVE && prevDigitalState != ALERT_ACTIVE) {
-                g_alertData.digitalAlertCount++;
-            }
-
+        // ── 2–4. Threshold detection with hysteresis ──────────────────
+        // An invalid reading preserves its FSM's state (holdOnInvalid)
+        // rather than defaulting to ALERT_NORMAL, which would cause a
+        // false green flicker while the DS18B20 has no value yet.
+        s_conditioning.condition(reading);
+        s_conditioning.alertAll(s_conditioning.conditioned(),
+                                (uint32_t)(reading.timestamp * portTICK_PERIOD_MS));
+
+        // ── 5. Write alert status under mutex ─────────────────────────
+        if (xSemaphoreTake(xSensorMutex, rtosMsToTicks(10)) == pdTRUE) {
+            s_conditioning.storeAlerts(&g_alertData.channel);
             g_alertData.conditioningCycles++;
-
             xSemaphoreGive(xSensorMutex);
         }
 
-        // Remember current states for next-cycle transition detection.
-        prevAnalogState  = analogState;
-        prevDigitalState = digitalState;
-
-        // ── 5. Update LED indicators ──────────────────────────────────
+        // ── 6. Update LED indicators ──────────────────────────────────
         // Green turns off as soon as any sensor leaves NORMAL (including
-        // during DEBOUNCE_HIGH / DEBOUNCE_LOW), not just when ALERT_ACTIVE.
-        bool anyNonNormal = (analogState  != ALERT_NORMAL) ||
-                            (digitalState != ALERT_NORMAL);
-
-        // Green LED: ON only when both sensors are fully NORMAL.
-        if (anyNonNormal) {
-            s_greenLed.turnOff();
-        } else {
-            s_greenLed.turnOn();
-        }
-
-        // Red LED: ON when analog sensor alert is active.
-        if (analogState == ALERT_ACTIVE) {
-            s_redLed.turnOn();
-        } else if (analogState == ALERT_DEBOUNCE_HIGH ||
-                   analogState == ALERT_DEBOUNCE_LOW) {
-            // Blink during debounce to indicate transitioning state.
-            s_redLed.toggle();
-        } else {
-            s_redLed.turnOff();
-        }
-
-        // Yellow LED: ON when digital sensor alert is active.
-        if (digitalState == ALERT_ACTIVE) {
-            s_yellowLed.turnOn();
-        } else if (digitalState == ALERT_DEBOUNCE_HIGH ||
-                   digitalState == ALERT_DEBOUNCE_LOW) {
-            s_yellowLed.toggle();
-        } else {
-            s_yellowLed.turnOff();
-        }
+        // during DEBOUNCE_HIGH / DEBOUNCE_LOW); a sensor's LED is on while
+        // its alert is active and blinks while it debounces.
+        s_conditioning.updateLeds();
     }
 }
@@ -4,15 +4,15 @@
  *
  * Declares the FreeRTOS task function for threshold-based signal
  * conditioning and alert management. This task wakes on new sensor
- * data (via semaphore), applies hysteresis-based threshold detection
+ * data (via the reading queue), applies hysteresis-based threshold detection
  * with debounce filtering, and controls the alert LEDs.
  *
  * Data flow:
- *   semaphore take → g_sensorData (mutex read) → ThresholdAlert FSM
+ *   queue receive → ThresholdAlert FSM
  *   → g_alertData (mutex write) → LED control
  *
  * Task characteristics:
- *   Trigger:  Binary semaphore from Task 1
+ *   Trigger:  Reading queue from Task 1
  *   Priority: 2 (medium — responds to acquisition events)
  *   Stack:    256 bytes
  */
@@ -25,7 +25,7 @@
 /**
  * @brief FreeRTOS task function for signal conditioning and alerting.
  *
- * Waits on the binary semaphore from Task 1, reads sensor data,
+ * Receives each reading queued by Task 1 (in order, none skipped),
  * applies threshold detection with hysteresis and debounce, updates
  * alert status, and drives the LED indicators.
  *
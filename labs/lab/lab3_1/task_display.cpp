@@ -37,6 +37,8 @@
 #include "sensor_data.h"
 
 #include "LcdDisplay.h"
+#include "RtosTime.h"
+#include "FlashString.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
@@ -93,13 +95,12 @@ void vTaskDisplay(void *pvParameters) {
     // Initialize the LCD display.
     s_lcd.init();
     s_lcd.backlight(true);
-    s_lcd.showTwoLines("Lab 3.1 Sensors", "Initializing...");
+    s_lcd.showTwoLines_P(PSTR("Lab 3.1 Sensors"), PSTR("Initializing..."));
 
     // Allow sensors to stabilize before first report.
     vTaskDelay(pdMS_TO_TICKS(1000));
 
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS);
+    RtosPeriod period(TASK_DISPLAY_PERIOD_MS);
 
     // LCD page alternation counter (switch every 4 cycles = 2 seconds).
     uint8_t displayCycle = 0;
@@ -116,11 +117,11 @@ void vTaskDisplay(void *pvParameters) {
     char line1[17];
 
     for (;;) {
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);
+        period.wait();
         displayCycle++;
 
         // ── Read shared data under mutex ──────────────────────────────
-        if (xSemaphoreTake(xSensorMutex, pdMS_TO_TICKS(20)) == pdTRUE) {
+        if (xSemaphoreTake(xSensorMutex, rtosMsToTicks(20)) == pdTRUE) {
             memcpy(&localSensor, &g_sensorData, sizeof(SensorReadings_t));
             memcpy(&localAlert,  &g_alertData,  sizeof(AlertStatus_t));
             xSemaphoreGive(xSensorMutex);
@@ -134,22 +135,22 @@ void vTaskDisplay(void *pvParameters) {
         if (page == 0) {
             // Page 0: Current sensor readings and alert status.
             char aTemp[8], dTemp[8];
-            formatTemp(aTemp, sizeof(aTemp), localSensor.analogTempC);
-            formatTemp(dTemp, sizeof(dTemp), localSensor.digitalTempC);
+            formatTemp(aTemp, sizeof(aTemp), localSensor.tempC[CH_ANALOG]);
+            formatTemp(dTemp, sizeof(dTemp), localSensor.tempC[CH_DIGITAL]);
 
-            snprintf(line0, sizeof(line0), "A:%sC D:%sC", aTemp, dTemp);
+            FLASH_SNPRINTF(line0, sizeof(line0), "A:%sC D:%sC", aTemp, dTemp);
 
-            bool aAlert = (localAlert.analogAlertState == ALERT_ACTIVE);
-            bool dAlert = (localAlert.digitalAlertState == ALERT_ACTIVE);
+            bool aAlert = (localAlert.channel.state[CH_ANALOG] == ALERT_ACTIVE);
+            bool dAlert = (localAlert.channel.state[CH_DIGITAL] == ALERT_ACTIVE);
 
             if (aAlert && dAlert) {
-                snprintf(line1, sizeof(line1), "ALERT: A+D");
+                FLASH_SNPRINTF(line1, sizeof(line1), "ALERT: A+D");
             } else if (aAlert) {
-                snprintf(line1, sizeof(line1), "ALERT: Analog");
+                FLASH_SNPRINTF(line1, sizeof(line1), "ALERT: Analog");
             } else if (dAlert) {
-                snprintf(line1, sizeof(line1), "ALERT: Digital");
+                FLASH_SNPRINTF(line1, sizeof(line1), "ALERT: Digital");
             } else {
-                snprintf(line1, sizeof(line1), "System: OK");
+                FLASH_SNPRINTF(line1, sizeof(line1), "System: OK");
             }
         } else {
             // Page 1: Threshold settings.
@@ -159,8 +160,8 @@ void vTaskDisplay(void *pvParameters) {
             dtostrf(ANALOG_THRESHOLD_LOW,   3, 0, alStr);
             dtostrf(DIGITAL_THRESHOLD_HIGH, 3, 0, dhStr);
             dtostrf(DIGITAL_THRESHOLD_LOW,  3, 0, dlStr);
-            snprintf(line0, sizeof(line0), "AH:%s AL:%s C", ahStr, alStr);
-            snprintf(line1, sizeof(line1), "DH:%s DL:%s C", dhStr, dlStr);
+            FLASH_SNPRINTF(line0, sizeof(line0), "AH:%s AL:%s C", ahStr, alStr);
+            FLASH_SNPRINTF(line1, sizeof(line1), "DH:%s DL:%s C", dhStr, dlStr);
         }
 
         s_lcd.showTwoLines(line0, line1);
@@ -170,61 +171,63 @@ void vTaskDisplay(void *pvParameters) {
             reportNumber++;
 
             char aTempStr[8], dTempStr[8];
-            formatTemp(aTempStr, sizeof(aTempStr), localSensor.analogTempC);
-            formatTemp(dTempStr, sizeof(dTempStr), localSensor.digitalTempC);
-
-            printf("\r\n");
-            printf("====== SENSOR REPORT #%lu ======\r\n",
-                   (unsigned long)reportNumber);
-            printf("--- Analog (NTC) ---\r\n");
-            printf("  Raw ADC:     %u\r\n", localSensor.analogRaw);
+            formatTemp(aTempStr, sizeof(aTempStr), localSensor.tempC[CH_ANALOG]);
+            formatTemp(dTempStr, sizeof(dTempStr), localSensor.tempC[CH_DIGITAL]);
+
+            FLASH_PRINTF("\r\n");
+            FLASH_PRINTF("====== SENSOR REPORT #%lu ======\r\n",
+                         (unsigned long)reportNumber);
+            FLASH_PRINTF("--- Analog (NTC) ---\r\n");
+            FLASH_PRINTF("  Raw ADC:     %u\r\n", localSensor.raw[CH_ANALOG]);
             char resStr[10];
-            dtostrf(localSensor.analogResistance, 1, 0, resStr);
-            printf("  Resistance:  %s ohm\r\n", resStr);
-            printf("  Temperature: %s C\r\n", aTempStr);
-            printf("  Valid:       %s\r\n",
-                   localSensor.analogValid ? "YES" : "NO");
-            printf("  Alert State: %s",
-                   alertFullLabel(localAlert.analogAlertState));
-            if (localAlert.analogAlertState == ALERT_DEBOUNCE_HIGH ||
-                localAlert.analogAlertState == ALERT_DEBOUNCE_LOW) {
-                printf(" (%u/%u)",
-                       localAlert.analogDebounceCount, ALERT_DEBOUNCE_COUNT);
+            dtostrf(localSensor.resistance[CH_ANALOG], 1, 0, resStr);
+            FLASH_PRINTF("  Resistance:  %s ohm\r\n", resStr);
+            FLASH_PRINTF("  Temperature: %s C\r\n", aTempStr);
+            FLASH_PRINTF("  Valid:       %s\r\n",
+                         localSensor.valid[CH_ANALOG] ? "YES" : "NO");
+            FLASH_PRINTF("  Alert State: %s",
+                         alertFullLabel(localAlert.channel.state[CH_ANALOG]));
+            if (localAlert.channel.state[CH_ANALOG] == ALERT_DEBOUNCE_HIGH ||
+                localAlert.channel.state[CH_ANALOG] == ALERT_DEBOUNCE_LOW) {
+                FLASH_PRINTF(" (%u/%u)",
+                             localAlert.channel.debounce[CH_ANALOG], ALERT_DEBOUNCE_COUNT);
             }
-            printf("\r\n");
-
-            printf("--- Digital (DS18B20) ---\r\n");
-            printf("  Temperature: %s C\r\n", dTempStr);
-            printf("  Valid:       %s\r\n",
-                   localSensor.digitalValid ? "YES" : "NO");
-            printf("  Alert State: %s",
-                   alertFullLabel(localAlert.digitalAlertState));
-            if (localAlert.digitalAlertState == ALERT_DEBOUNCE_HIGH ||
-                localAlert.digitalAlertState == ALERT_DEBOUNCE_LOW) {
-                printf(" (%u/%u)",
-                       localAlert.digitalDebounceCount, ALERT_DEBOUNCE_COUNT);
+            FLASH_PRINTF("\r\n");
+
+            FLASH_PRINTF("--- Digital (DS18B20) ---\r\n");
+            FLASH_PRINTF("  Temperature: %s C\r\n", dTempStr);
+            FLASH_PRINTF("  Valid:       %s\r\n",
+                         localSensor.valid[CH_DIGITAL] ? "YES" : "NO");
+            FLASH_PRINTF("  Alert State: %s",
+                         alertFullLabel(localAlert.channel.state[CH_DIGITAL]));
+            if (localAlert.channel.state[CH_DIGITAL] == ALERT_DEBOUNCE_HIGH ||
+                localAlert.channel.state[CH_DIGITAL] == ALERT_DEBOUNCE_LOW) {
+                FLASH_PRINTF(" (%u/%u)",
+                             localAlert.channel.debounce[CH_DIGITAL], ALERT_DEBOUNCE_COUNT);
             }
-            printf("\r\n");
+            FLASH_PRINTF("\r\n");
 
-            printf("--- Thresholds ---\r\n");
+            FLASH_PRINTF("--- Thresholds ---\r\n");
             char thAH[8], thAL[8], thDH[8], thDL[8];
             dtostrf(ANALOG_THRESHOLD_HIGH,  4, 1, thAH);
             dtostrf(ANALOG_THRESHOLD_LOW,   4, 1, thAL);
             dtostrf(DIGITAL_THRESHOLD_HIGH, 4, 1, thDH);
             dtostrf(DIGITAL_THRESHOLD_LOW,  4, 1, thDL);
-            printf("  Analog:  HIGH=%sC  LOW=%sC\r\n", thAH, thAL);
-            printf("  Digital: HIGH=%sC  LOW=%sC\r\n", thDH, thDL);
-
-            printf("--- Statistics ---\r\n");
-            printf("  Readings:        %lu\r\n",
-                   (unsigned long)localSensor.readingCount);
-            printf("  Conditioning:    %lu cycles\r\n",
-                   (unsigned long)localAlert.conditioningCycles);
-            printf("  Analog Alerts:   %lu\r\n",
-                   (unsigned long)localAlert.analogAlertCount);
-            printf("  Digital Alerts:  %lu\r\n",
-                   (unsigned long)localAlert.digitalAlertCount);
-            printf("================================\r\n");
+            FLASH_PRINTF("  Analog:  HIGH=%sC  LOW=%sC\r\n", thAH, thAL);
+            FLASH_PRINTF("  Digital: HIGH=%sC  LOW=%sC\r\n", thDH, thDL);
+
+            FLASH_PRINTF("--- Statistics ---\r\n");
+            FLASH_PRINTF("  Readings:        %lu\r\n",
+                         (unsigned long)localSensor.sequence);
+            FLASH_PRINTF("  Queue overruns:  %lu\r\n",
+                         (unsigned long)localSensor.overruns);
+            FLASH_PRINTF("  Conditioning:    %lu cycles\r\n",
+                         (unsigned long)localAlert.conditioningCycles);
+            FLASH_PRINTF("  Analog Alerts:   %lu\r\n",
+                         (unsigned long)localAlert.channel.count[CH_ANALOG]);
+            FLASH_PRINTF("  Digital Alerts:  %lu\r\n",
+                         (unsigned long)localAlert.channel.count[CH_DIGITAL]);
+            FLASH_PRINTF("================================\r\n");
         }
     }
 }
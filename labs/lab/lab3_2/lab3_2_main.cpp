@@ -27,13 +27,13 @@
  * │ Task         │ Trigger    │ Prio │ Responsibility                       │
  * ├──────────────┼────────────┼──────┼──────────────────────────────────────┤
  * │ Acquisition  │ 50 ms      │  3   │ Read NTC (ADC) + DS18B20 (OneWire)  │
- * │              │ DelayUntil │      │ Store raw data, give semaphore       │
+ * │              │ DelayUntil │      │ Queue timestamped raw sample         │
  * ├──────────────┼────────────┼──────┼──────────────────────────────────────┤
- * │ Conditioning │ Semaphore  │  2   │ Saturate → Median → EWMA pipeline   │
+ * │ Conditioning │ Queue      │  2   │ Saturate → Median → EWMA pipeline   │
  * │              │ event      │      │ Threshold alert FSM, LED control     │
  * ├──────────────┼────────────┼──────┼──────────────────────────────────────┤
- * │ Display      │ 500 ms     │  1   │ LCD update + STDIO structured report │
- * │              │ DelayUntil │      │ Raw + conditioned values, statistics │
+ * │ Display      │ On change  │  1   │ LCD update + STDIO structured report │
+ * │              │ + 2 s beat │      │ Raw + conditioned values, statistics │
  * └──────────────┴────────────┴──────┴──────────────────────────────────────┘
  */
 
@@ -42,101 +42,199 @@
 #include "task_acquisition.h"
 #include "task_conditioning.h"
 #include "task_display.h"
+#include "task_telemetry.h"
+#include "sensor_trace.h"
+#include "task_modbus.h"
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 #include <stdio.h>
 
+#include "AdcEngine.h"
+#if defined(LAB3_2_ADC_ALERTS)
+#include "AnalogTempSensor.h"
+#endif
+#include "StaticTaskSet.h"
 #include "StdioSerial.h"
+#include "FlashString.h"
 #include <stdlib.h>  // for dtostrf on AVR
 
+// ──────────────────────────────────────────────────────────────────────────
+// Task set — one row per task; TCBs and stacks reserved at link time
+// (StaticTaskSet)
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(LAB3_2_MODBUS)
+/** @brief Init hook of the Modbus row: register table and USART. */
+static bool modbusStart() {
+    taskModbusInit();
+    return true;
+}
+#endif
+
+static constexpr StaticTaskDesc TASKS[] PROGMEM = {
+    STATIC_TASK(vTaskAcquisition,  "Acquire", TASK_ACQUISITION_STACK,  TASK_ACQUISITION_PRIORITY,
+                TASK_ACQUISITION_PERIOD_MS),
+    STATIC_TASK(vTaskConditioning, "Cond",    TASK_CONDITIONING_STACK, TASK_CONDITIONING_PRIORITY,
+                0),
+    STATIC_TASK(vTaskDisplay,      "Display", TASK_DISPLAY_STACK,      TASK_DISPLAY_PRIORITY,
+                DISPLAY_HEARTBEAT_MS),
+    STATIC_TASK(vTaskTelemetry,    "Telem",   TASK_TELEMETRY_STACK,    TASK_TELEMETRY_PRIORITY,
+                TASK_TELEMETRY_PERIOD_MS),
+#if defined(LAB3_2_MODBUS)
+    STATIC_TASK_INIT(vTaskModbus,  "Modbus",  TASK_MODBUS_STACK,       TASK_MODBUS_PRIORITY,
+                     0, modbusStart),
+#endif
+};
+static STATIC_TASK_SET(s_tasks, TASKS);
+
 // ──────────────────────────────────────────────────────────────────────────
 // Lab 3.2 public entry points
 // ──────────────────────────────────────────────────────────────────────────
 
-void lab3_2Setup() {
-    // ── Initialize STDIO serial at 9600 baud ────────────────────────────
-    stdioSerialInit(9600);
+void lab3_2PrintBanner() {
+    // Byte-exact: wait for the UART rather than drop banner text.
+    stdioSerialSetTxPolicy(STDIO_TX_BLOCK);
 
-    // ── Print startup banner ────────────────────────────────────────────
-    printf("\r\n");
-    printf("================================================\r\n");
-    printf("  Lab 3.2 — Signal Conditioning Pipeline\r\n");
-    printf("  Dual-Sensor Temperature Monitor\r\n");
-    printf("  FreeRTOS Preemptive Scheduler\r\n");
-    printf("  Tasks: 3 | Tick: %u Hz\r\n",
-           (unsigned int)configTICK_RATE_HZ);
-    printf("================================================\r\n");
-    printf("SENSORS:\r\n");
-    printf("  Analog:  NTC Thermistor (A0, 10K, Beta=3950)\r\n");
-    printf("  Digital: DS18B20 (Pin 2, OneWire, 10-bit)\r\n");
-    printf("CONDITIONING PIPELINE:\r\n");
-    printf("  1. Saturation: [");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("  Lab 3.2 — Signal Conditioning Pipeline\r\n");
+    FLASH_PRINTF("  Dual-Sensor Temperature Monitor\r\n");
+    FLASH_PRINTF("  FreeRTOS Preemptive Scheduler\r\n");
+    FLASH_PRINTF("  Tasks: 3 | Tick: %u Hz\r\n",
+                 (unsigned int)configTICK_RATE_HZ);
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("SENSORS:\r\n");
+#if defined(LAB3_2_NTC_BRIDGE)
+    FLASH_PRINTF("  Analog:  NTC Thermistor (A1-A0 bridge, %ux, %u-bit, offset %d)\r\n",
+                 (unsigned)NTC_BRIDGE_GAIN, (unsigned)(10 + NTC_BRIDGE_OVERSAMPLE_LOG2),
+                 (int)SENSOR_CHANNELS[CH_ANALOG].ntc->getBridgeOffset());
+#else
+    FLASH_PRINTF("  Analog:  NTC Thermistor (A0, 10K, Beta=3950)\r\n");
+#endif
+    FLASH_PRINTF("  Digital: DS18B20 (Pin 2, OneWire, 10-bit)\r\n");
+    FLASH_PRINTF("CONDITIONING PIPELINE:\r\n");
+    FLASH_PRINTF("  1. Saturation: [");
     char satMinStr[8], satMaxStr[8];
     dtostrf(SATURATION_MIN, 4, 1, satMinStr);
     dtostrf(SATURATION_MAX, 5, 1, satMaxStr);
-    printf("%s, %s] C\r\n", satMinStr, satMaxStr);
-    printf("  2. Median Filter: %u samples\r\n",
-           (unsigned int)MEDIAN_WINDOW_SIZE);
-    printf("  3. EWMA Alpha: ");
+    FLASH_PRINTF("%s, %s] C\r\n", satMinStr, satMaxStr);
+    FLASH_PRINTF("  2. Median Filter: %u samples\r\n",
+                 (unsigned int)MEDIAN_WINDOW_SIZE);
+    FLASH_PRINTF("  3. EWMA Alpha: ");
     char alphaStr[6];
     dtostrf(EWMA_ALPHA, 3, 1, alphaStr);
-    printf("%s\r\n", alphaStr);
-    printf("THRESHOLDS:\r\n");
+    FLASH_PRINTF("%s\r\n", alphaStr);
+    FLASH_PRINTF("THRESHOLDS:\r\n");
     char ahBuf[8], alBuf[8];
     dtostrf(ANALOG_THRESHOLD_HIGH, 4, 1, ahBuf);
     dtostrf(ANALOG_THRESHOLD_LOW,  4, 1, alBuf);
-    printf("  HIGH=%sC  LOW=%sC\r\n", ahBuf, alBuf);
-    printf("  Debounce: %u confirmations\r\n",
-           (unsigned int)ALERT_DEBOUNCE_COUNT);
-    printf("LEDs:\r\n");
-    printf("  GREEN  = system normal (no alerts)\r\n");
-    printf("  RED    = analog sensor alert\r\n");
-    printf("  YELLOW = digital sensor alert\r\n");
-    printf("TIMING:\r\n");
-    printf("  Acquisition:    %u ms\r\n",
-           (unsigned int)TASK_ACQUISITION_PERIOD_MS);
-    printf("  Display/LCD:    %u ms\r\n",
-           (unsigned int)TASK_DISPLAY_PERIOD_MS);
-    printf("  STDIO Report:   every 2 seconds\r\n");
-    printf("================================================\r\n\r\n");
+    FLASH_PRINTF("  HIGH=%sC  LOW=%sC\r\n", ahBuf, alBuf);
+    FLASH_PRINTF("  Dwell: raise %lu ms, clear %lu ms\r\n",
+                 (unsigned long)ALERT_RAISE_DWELL_MS, (unsigned long)ALERT_CLEAR_DWELL_MS);
+#if defined(LAB3_2_ADC_ALERTS)
+    const AnalogTempSensor &ntc = *SENSOR_CHANNELS[CH_ANALOG].ntc;
+    FLASH_PRINTF("  Analog in ADC counts: raise < %u, clear > %u (datasheet Beta)\r\n",
+                 (unsigned)ntc.rawAtTemperatureC(ANALOG_THRESHOLD_HIGH),
+                 (unsigned)ntc.rawAtTemperatureC(ANALOG_THRESHOLD_LOW));
+#endif
+    FLASH_PRINTF("LEDs:\r\n");
+    FLASH_PRINTF("  GREEN  = system normal (no alerts)\r\n");
+    FLASH_PRINTF("  RED    = analog sensor alert\r\n");
+    FLASH_PRINTF("  YELLOW = digital sensor alert\r\n");
+    FLASH_PRINTF("TIMING:\r\n");
+    FLASH_PRINTF("  Acquisition:    %u ms\r\n",
+                 (unsigned int)TASK_ACQUISITION_PERIOD_MS);
+    FLASH_PRINTF("  Display/LCD:    on change, max every %u ms\r\n",
+                 (unsigned int)DISPLAY_REFRESH_MIN_MS);
+    if (TELEMETRY_BINARY) {
+        FLASH_PRINTF("  Telemetry:      binary, type 0x%02X every %u ms\r\n",
+                     (unsigned int)LAB3_2_TELEMETRY_TYPE,
+                     (unsigned int)TASK_TELEMETRY_PERIOD_MS);
+    } else {
+        FLASH_PRINTF("  STDIO Report:   every 2 seconds\r\n");
+    }
+#if defined(LAB3_2_TRACE_CAPTURE)
+    FLASH_PRINTF("TRACE CAPTURE: type 0x%02X per sample, text report off\r\n",
+                 (unsigned int)LAB3_2_TRACE_TYPE);
+#elif defined(LAB3_2_TRACE_REPLAY)
+    FLASH_PRINTF("TRACE REPLAY: send type 0x%02X frames, one per TRACE line\r\n",
+                 (unsigned int)LAB3_2_TRACE_TYPE);
+#endif
+#if defined(LAB3_2_MODBUS)
+    FLASH_PRINTF("MODBUS RTU: USART%u node %u %lu baud, RS-485 DE D%d\r\n",
+                 (unsigned)MODBUS_SLAVE_USART, (unsigned)MODBUS_NODE_ADDRESS,
+                 (unsigned long)MODBUS_BAUD, (int)PIN_MODBUS_DE);
+#endif
+#if defined(LAB3_2_TIME_SYNC)
+    FLASH_PRINTF("Time sync: sample times in the gateway's timebase (regs 22-25)\r\n");
+#endif
+#if defined(LAB3_2_SYNC_PULSE)
+    FLASH_PRINTF("Sync pulse: sampling on rising edges at D%u\r\n", (unsigned)PIN_SYNC_PULSE);
+#endif
+#if defined(LAB3_2_HARD_TRIP)
+    char tripBuf[8];
+    dtostrf(conditioningHardTripC(COMPARATOR_TRIP_BANDGAP_V), 4, 1, tripBuf);
+    FLASH_PRINTF("HARD TRIP: A%d -> D5 (AIN1) below 1.1 V (~%sC) cuts load D%d\r\n",
+                 (int)(PIN_ANALOG_SENSOR - A0), tripBuf, (int)PIN_LOAD_ENABLE);
+#endif
+    if (NTC_CAL_ENABLED) {
+        FLASH_PRINTF("NTC CALIBRATION: fit to DS18B20 when steady, DS18B20 every %u ms once done\r\n",
+                     (unsigned)NTC_CAL_DS18B20_INTERVAL_MS);
+    }
+    FLASH_PRINTF("SERIAL COMMANDS:\r\n");
+    FLASH_PRINTF("  sub <field> <ms> | unsub <field|all> | subs | fields\r\n");
+    FLASH_PRINTF("  log dump | log flush | log clear = alert event log (EEPROM)\r\n");
+    FLASH_PRINTF("  trace dump | trace clear = alert FSM transition trace\r\n");
+    FLASH_PRINTF("  hist | hist raw | hist clear = reading history every %u s (delta-compressed)\r\n",
+                 (unsigned)(HISTORY_INTERVAL_MS / 1000));
+    FLASH_PRINTF("  cal | cal reset = NTC calibration status / back to datasheet\r\n");
+    FLASH_PRINTF("  report | report full | report delta = STDIO report (default %s)\r\n",
+                 REPORT_COMPACT ? "delta" : "full");
+    FLASH_PRINTF("================================================\r\n\r\n");
+
+    // From here on a slow terminal must not stall tasks.
+    stdioSerialSetTxPolicy(STDIO_TX_DROP);
+}
+
+void lab3_2Setup() {
+    // ── Initialize STDIO serial at 9600 baud ────────────────────────────
+    stdioSerialInit(9600);
+
+    // ── Start the slow sensor conversions first ──────────────────────────
+    acquisitionStart();
+
+#if defined(LAB3_2_TRACE_CAPTURE) || defined(LAB3_2_TRACE_REPLAY)
+    // The trace owns the link from the first task cycle: banner first.
+    lab3_2PrintBanner();
+    sensorTraceBegin();
+#else
+    // The display task prints the banner after its LCD init, while the
+    // other tasks already run (about 1.3 s at 9600 baud).
+    stdioSerialSetTxPolicy(STDIO_TX_DROP);
+#endif
 
     // ── Create synchronization primitives ────────────────────────────────
     sensorDataInit();
+    g_alertLog.begin();  // Find the newest stored page
 
     // ── Create FreeRTOS tasks ────────────────────────────────────────────
-    xTaskCreate(
-        vTaskAcquisition,
-        "Acquire",
-        TASK_ACQUISITION_STACK,
-        NULL,
-        TASK_ACQUISITION_PRIORITY,
-        NULL
-    );
-
-    xTaskCreate(
-        vTaskConditioning,
-        "Cond",
-        TASK_CONDITIONING_STACK,
-        NULL,
-        TASK_CONDITIONING_PRIORITY,
-        NULL
-    );
-
-    xTaskCreate(
-        vTaskDisplay,
-        "Display",
-        TASK_DISPLAY_STACK,
-        NULL,
-        TASK_DISPLAY_PRIORITY,
-        NULL
-    );
+    s_tasks.launch(TASKS);  // [ERROR] line per task that cannot be created
+
+    // Kernel tick on a 1 ms timer compare with -DRTOS_TICK_TIMER (RtosTick.h);
+    // last, as it keeps interrupts off until the scheduler starts.
+    rtosTickInit();
 
     // The FreeRTOS scheduler starts automatically after setup() returns
     // (handled by the Arduino_FreeRTOS library integration).
 }
 
 void lab3_2Loop() {
-    // All application logic runs inside the three FreeRTOS tasks.
-    // This function intentionally does nothing.
+    // All application logic runs inside the FreeRTOS tasks. This runs
+    // from the idle hook, the one place where the CPU may sleep for a
+    // noise-reduced NTC conversion (no-op in timer-trigger mode).
+#if defined(LAB3_2_SYNC_PULSE)
+    acquisitionSyncYield();
+#endif
+    adcEngineIdle();
 }
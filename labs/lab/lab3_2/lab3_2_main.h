@@ -15,22 +15,24 @@
  *
  *   Task 1 — Sensor Acquisition (50 ms period, priority 3):
  *     Reads both temperature sensors at 20 Hz, converts raw readings
- *     to degrees Celsius, and stores results in shared memory with
- *     mutex protection and semaphore signaling.
+ *     to degrees Celsius, and queues each timestamped sample to Task 2
+ *     (overruns counted, never blocking).
  *
  *   Task 2 — Signal Conditioning & Alerting (event-driven, priority 2):
- *     Waits on the acquisition semaphore, applies the conditioning
+ *     Receives every queued sample, applies the conditioning
  *     pipeline (saturate → median → EWMA) to each sensor independently,
  *     feeds conditioned values into hysteresis threshold detection,
  *     and controls LED indicators.
  *
- *   Task 3 — Display & Reporting (500 ms period, priority 1):
+ *   Task 3 — Display & Reporting (on change, priority 1):
  *     Updates the LCD display with conditioned temperatures and alert
- *     status, and prints structured STDIO reports every 2 seconds
+ *     status when they change, and prints structured STDIO reports every 2 seconds
  *     showing all conditioning pipeline intermediate values.
  *
  * Hardware pin mapping (Arduino Mega 2560):
- *   A0  = NTC thermistor analog output (voltage divider with 10K series R)
+ *   A0  = NTC thermistor analog output (voltage divider with 10K series R);
+ *         with -DLAB3_2_NTC_BRIDGE the NTC is on A1 and A0 is the midpoint
+ *         of a 10K / 10K reference divider
  *   D2  = DS18B20 OneWire data pin (4.7K pull-up to VCC)
  *   D8  = Green LED (system normal indicator)
  *   D9  = Red LED (analog sensor alert)
@@ -45,18 +47,30 @@
 /**
  * @brief Initialize hardware, create FreeRTOS tasks and start the scheduler.
  *
- * Configures STDIO serial, creates synchronization primitives (mutex
- * and binary semaphore), prints the startup banner with conditioning
- * configuration, and spawns three FreeRTOS tasks for sensor acquisition,
- * conditioning, and display.
+ * Configures STDIO serial, starts the first sensor conversions
+ * (acquisitionStart()), creates synchronization primitives (mutex and
+ * reading queue), and spawns the FreeRTOS tasks for sensor acquisition,
+ * conditioning, display and telemetry. The banner is left to the
+ * display task (lab3_2PrintBanner()).
  */
 void lab3_2Setup();
 
+/**
+ * @brief Print the startup banner (blocking on the UART until it is queued).
+ *
+ * Called by the display task after its LCD init, so setup() and the
+ * first samples do not wait ~1.3 s for 9600 baud; from setup() itself in
+ * the trace modes, which own the link from the first cycle. Leaves
+ * stdout in STDIO_TX_DROP.
+ */
+void lab3_2PrintBanner();
+
 /**
  * @brief Main loop — idle when all FreeRTOS tasks are blocked.
  *
- * All application logic runs inside the three FreeRTOS tasks.
- * This function intentionally does nothing.
+ * All application logic runs inside the FreeRTOS tasks. Called from
+ * the idle hook, it only drives AdcEngine's noise-reduction conversions
+ * (ADC_NOISE_REDUCTION).
  */
 void lab3_2Loop();
 
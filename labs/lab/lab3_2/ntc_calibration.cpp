@@ -0,0 +1,185 @@
+/**
+ * @file ntc_calibration.cpp
+ * @brief Lab 3.2 — Online NTC Calibration Implementation
+ *
+ * Task 1 owns s_calibrator and the NTC constants; s_config is only used
+ * by setup() and Task 4. The reset request is the one value Task 4 writes
+ * for Task 1 (a volatile flag, taken at the next release).
+ */
+
+#include "ntc_calibration.h"
+
+#include "NtcCalibrator.h"
+#include "ConfigStore.h"
+#include "SharedSnapshot.h"
+#include "FlashString.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>  // for dtostrf on AVR
+
+static_assert(NTC_CAL_EEPROM_ADDR >= EVENT_LOG_EEPROM_ADDR +
+                  (uint32_t)EVENT_LOG_EEPROM_PAGES * EVENT_LOG_PAGE_BYTES,
+              "NTC calibration overlaps the alert log");
+static_assert(NTC_CAL_EEPROM_ADDR + (uint32_t)NTC_CAL_EEPROM_PAGES * CONFIG_STORE_PAGE_BYTES <= 4096,
+              "NTC calibration exceeds the ATmega2560 EEPROM");
+
+// Keys: never reuse one for another meaning without bumping NTC_CAL_VERSION.
+static const uint8_t KEY_BETA = 1;
+static const uint8_t KEY_NOMINAL_R = 2;
+
+static ConfigStore s_config(NTC_CAL_EEPROM_ADDR, NTC_CAL_EEPROM_PAGES, NTC_CAL_VERSION);
+static NtcCalibrator s_calibrator(NTC_NOMINAL_TEMP_C, NTC_CAL_STEADY_BAND_C, NTC_CAL_STEADY_TAU_S);
+static SharedSnapshot<NtcCalStatus_t> s_status;
+
+// ── Task 1 ──────────────────────────────────────────────────────────────
+static NtcCalStatus_t s_live;
+static uint32_t s_lastApplyMs = 0;
+
+// ── Task 4 → Task 1 ─────────────────────────────────────────────────────
+static volatile bool s_resetRequested = false;
+
+// ── Task 4 ──────────────────────────────────────────────────────────────
+static uint16_t s_storedApplies = 0;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Task 1 side
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Restart the fit from the constants the NTC uses now. */
+static void seedFit(const AnalogTempSensor &ntc) {
+    s_calibrator.reset(ntc.getBeta(), ntc.getNominalResistance(),
+                       NTC_CAL_BETA_SIGMA_K, NTC_CAL_OFFSET_SIGMA_C);
+    s_live.beta = ntc.getBeta();
+    s_live.nominalR = ntc.getNominalResistance();
+    s_live.sigmaC = s_calibrator.getSigmaC();
+    s_live.residualC = 0.0f;
+    s_live.samples = 0;
+    s_live.rejects = 0;
+    s_live.converged = false;
+}
+
+void ntcCalibrationLoad(AnalogTempSensor &ntc) {
+    memset(&s_live, 0, sizeof(s_live));
+    if (NTC_CAL_ENABLED && s_config.begin()) {
+        float beta, nominalR;
+        if (s_config.getFloat(KEY_BETA, &beta) && s_config.getFloat(KEY_NOMINAL_R, &nominalR)) {
+            // Outside the prior's 3σ the stored values are not trusted.
+            bool plausible = fabsf(beta - NTC_BETA_COEFFICIENT) < 3.0f * NTC_CAL_BETA_SIGMA_K &&
+                             nominalR > 0.5f * NTC_NOMINAL_RESISTANCE &&
+                             nominalR < 2.0f * NTC_NOMINAL_RESISTANCE;
+            s_live.restored = plausible && ntc.setCalibration(beta, nominalR);
+        }
+    }
+    seedFit(ntc);
+    s_status.publish(s_live);
+}
+
+/** @brief True when the fit differs enough from the constants in use. */
+static bool fitMoved(const AnalogTempSensor &ntc) {
+    float r0 = ntc.getNominalResistance();
+    return fabsf(s_calibrator.getBeta() - ntc.getBeta()) >= NTC_CAL_APPLY_BETA_STEP_K ||
+           fabsf(s_calibrator.getNominalResistance() - r0) >= NTC_CAL_APPLY_R0_STEP * r0;
+}
+
+uint16_t ntcCalibrationUpdate(AnalogTempSensor &ntc, const RawSample_t &sample, bool quiet) {
+    if (!NTC_CAL_ENABLED) {
+        return 0;
+    }
+
+    if (s_resetRequested) {
+        ntc.setCalibration(NTC_BETA_COEFFICIENT, NTC_NOMINAL_RESISTANCE);
+        s_live.restored = false;
+        seedFit(ntc);
+        s_resetRequested = false;
+    }
+
+    bool changed = false;
+    if (sample.fresh[CH_DIGITAL] && sample.valid[CH_DIGITAL] && sample.valid[CH_ANALOG]) {
+        uint32_t nowMs = millis();
+        if (s_calibrator.addSample(sample.resistance[CH_ANALOG], sample.tempC[CH_DIGITAL], nowMs)) {
+            s_live.residualC = s_calibrator.getLastResidualC();
+        }
+        s_live.sigmaC = s_calibrator.getSigmaC();
+        s_live.samples = s_calibrator.getSampleCount();
+        s_live.rejects = s_calibrator.getRejectCount();
+        s_live.converged = s_calibrator.isConverged();
+
+        bool due = s_live.applies == 0 ||
+                   (uint32_t)(nowMs - s_lastApplyMs) >= NTC_CAL_APPLY_INTERVAL_MS;
+        if (s_live.converged && due && fitMoved(ntc) &&
+            ntc.setCalibration(s_calibrator.getBeta(), s_calibrator.getNominalResistance())) {
+            s_live.beta = ntc.getBeta();
+            s_live.nominalR = ntc.getNominalResistance();
+            s_live.applies++;
+            s_lastApplyMs = nowMs;
+        }
+        changed = true;
+    }
+
+    // Calibrated: constants from EEPROM, or a fit applied (or confirmed)
+    // since boot.
+    bool calibrated = s_live.restored || s_live.applies > 0 || s_live.converged;
+    bool relaxed = calibrated && quiet;
+    if (changed || relaxed != s_live.relaxed) {
+        s_live.relaxed = relaxed;
+        s_status.publish(s_live);
+    }
+    return relaxed ? NTC_CAL_DS18B20_INTERVAL_MS : 0;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Task 4 side
+// ──────────────────────────────────────────────────────────────────────────
+
+void ntcCalibrationService() {
+    if (!NTC_CAL_ENABLED) {
+        return;
+    }
+    NtcCalStatus_t status;
+    s_status.read(status);
+    // Only constants Task 1 applied are stored; none while a reset waits.
+    if (!s_resetRequested && status.applies != s_storedApplies) {
+        s_config.setFloat(KEY_BETA, status.beta);
+        s_config.setFloat(KEY_NOMINAL_R, status.nominalR);
+        s_storedApplies = status.applies;
+    }
+    s_config.service();
+}
+
+void ntcCalibrationReset() {
+    NtcCalStatus_t status;
+    s_status.read(status);
+    s_storedApplies = status.applies;  // Nothing applied so far is stored again
+    s_config.clear();
+    s_resetRequested = true;
+}
+
+void ntcCalibrationStatus(NtcCalStatus_t *out) {
+    s_status.read(*out);
+}
+
+void ntcCalibrationReport() {
+    if (!NTC_CAL_ENABLED) {
+        FLASH_PRINTF("[CAL] NTC calibration off (datasheet constants)\r\n");
+        return;
+    }
+    NtcCalStatus_t status;
+    s_status.read(status);
+    char betaStr[10], r0Str[10], sigmaStr[8], residualStr[8];
+    dtostrf(status.beta, 1, 1, betaStr);
+    dtostrf(status.nominalR, 1, 0, r0Str);
+    dtostrf(status.sigmaC, 1, 3, sigmaStr);
+    dtostrf(status.residualC, 1, 3, residualStr);
+    FLASH_PRINTF("[CAL] beta=%s R0=%s ohm (%s at boot), %u applied\r\n",
+                 betaStr, r0Str, status.restored ? "restored" : "datasheet",
+                 (unsigned)status.applies);
+    FLASH_PRINTF("[CAL] fit: %u pairs, %u rejected, sigma=%sC, last residual=%sC, %s\r\n",
+                 (unsigned)status.samples, (unsigned)status.rejects, sigmaStr, residualStr,
+                 status.converged ? "converged" : "converging");
+    FLASH_PRINTF("[CAL] DS18B20 %s; %u of %u pages valid%s\r\n",
+                 status.relaxed ? "relaxed" : "at full rate",
+                 (unsigned)s_config.getStoredPages(), (unsigned)NTC_CAL_EEPROM_PAGES,
+                 s_config.isDirty() ? ", change pending" : "");
+}
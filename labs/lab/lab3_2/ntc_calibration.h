@@ -0,0 +1,88 @@
+/**
+ * @file ntc_calibration.h
+ * @brief Lab 3.2 — Online NTC Calibration Against the DS18B20
+ *
+ * The NTC is converted with datasheet constants (β 3950, 10 kΩ), which
+ * a real part misses by up to a degree or so; the DS18B20 next to it is
+ * accurate but slow. While both read valid values Task 1 hands each
+ * fresh pair to an NtcCalibrator, which fits Beta and R0 on steady
+ * stretches only, and applies a converged fit to the NTC conversion:
+ *
+ *   Task 1: fresh DS18B20 + valid NTC ─► NtcCalibrator ─► ntc.setCalibration()
+ *                                               │
+ *                                        status snapshot
+ *                                               ▼
+ *   Task 4: ntcCalibrationService() ─► ConfigStore (EEPROM, coalesced)
+ *
+ * The applied constants survive a reset: setup() loads them before the
+ * first conversion, and the fit restarts from them. Once calibrated, the
+ * DS18B20 is polled only every NTC_CAL_DS18B20_INTERVAL_MS while the
+ * signal is quiet; the NTC, now as accurate where it was fitted, carries
+ * the fast path.
+ *
+ * Threads: the calibrator and the NTC constants belong to Task 1, the
+ * store to Task 4 (and setup() before the scheduler); the status crosses
+ * through a SharedSnapshot. "cal reset" (Task 4) empties the store and
+ * asks Task 1 to return to the datasheet constants.
+ *
+ * Usage:
+ *   ntcCalibrationLoad(ntc);                                 // setup()
+ *   uint16_t ms = ntcCalibrationUpdate(ntc, sample, quiet);  // Task 1
+ *   acquisition.setMinIntervalMs(CH_DIGITAL, ms);
+ *   ntcCalibrationService();                                 // Task 4
+ */
+
+#ifndef NTC_CALIBRATION_H
+#define NTC_CALIBRATION_H
+
+#include "sensor_data.h"
+#include "AnalogTempSensor.h"
+
+/** @brief Calibration state, as published by Task 1. */
+typedef struct {
+    float    beta;          /**< Beta in use (K).                          */
+    float    nominalR;      /**< R0 in use (Ω at NTC_NOMINAL_TEMP_C).      */
+    float    sigmaC;        /**< Fit uncertainty at the last pair (°C).    */
+    float    residualC;     /**< Last accepted pair: NTC − DS18B20 (°C).   */
+    uint16_t samples;       /**< Pairs used since boot / reset.            */
+    uint16_t rejects;       /**< Pairs rejected as outliers.               */
+    uint16_t applies;       /**< Fits applied to the NTC since boot.       */
+    bool     restored;      /**< Constants loaded from EEPROM at boot.     */
+    bool     converged;     /**< The fit is usable.                        */
+    bool     relaxed;       /**< DS18B20 polled at the relaxed interval.   */
+} NtcCalStatus_t;
+
+/**
+ * @brief Load the stored constants into the NTC and seed the fit (setup()).
+ *
+ * Call before the first conversion (the lookup table is rebuilt). Prints
+ * nothing; ntcCalibrationReport() says what was restored.
+ */
+void ntcCalibrationLoad(AnalogTempSensor &ntc);
+
+/**
+ * @brief Offer this release's sample to the fit (Task 1, every release).
+ *
+ * Uses the pair when the DS18B20 value is fresh and both are valid;
+ * applies a converged fit (rate-limited) and publishes the status.
+ *
+ * @param ntc    The NTC of the sample.
+ * @param sample This release's raw sample.
+ * @param quiet  The signal allows the relaxed DS18B20 interval.
+ * @return Least time between DS18B20 readings (ms, 0: as fast as it converts).
+ */
+uint16_t ntcCalibrationUpdate(AnalogTempSensor &ntc, const RawSample_t &sample, bool quiet);
+
+/** @brief Store newly applied constants and write if due (Task 4, every period). */
+void ntcCalibrationService();
+
+/** @brief Forget the fit and the stored constants ("cal reset", Task 4). */
+void ntcCalibrationReset();
+
+/** @brief Latest status (any task, never blocks). */
+void ntcCalibrationStatus(NtcCalStatus_t *out);
+
+/** @brief Print the calibration status ("cal", Task 4). */
+void ntcCalibrationReport();
+
+#endif // NTC_CALIBRATION_H
@@ -8,54 +8,93 @@
  */
 
 #include "sensor_data.h"
+#include "StaticRtos.h"
+#include "task_display.h"
+#include "AnalogTempSensor.h"
+#include "DigitalTempSensor.h"
 
 // ──────────────────────────────────────────────────────────────────────────
-// Shared data — zero-initialized at startup
+// Sensor channels — drivers, LEDs and the table that binds them
 // ──────────────────────────────────────────────────────────────────────────
 
-SensorReadings_t g_sensorData = {
-    0,      // analogRaw
-    0.0f,   // analogResistance
-    0.0f,   // analogTempRaw
-    false,  // analogValid
-    0.0f,   // analogMedian
-    0.0f,   // analogEwma
-    false,  // analogConditioned
-    0.0f,   // digitalTempRaw
-    false,  // digitalValid
-    0.0f,   // digitalMedian
-    0.0f,   // digitalEwma
-    false,  // digitalConditioned
-    0,      // readingCount
-    0       // timestamp
-};
+static AnalogTempSensor  s_ntcSensor(PIN_ANALOG_SENSOR,
+                                     NTC_SERIES_RESISTANCE,
+                                     NTC_NOMINAL_RESISTANCE,
+                                     NTC_BETA_COEFFICIENT,
+                                     NTC_NOMINAL_TEMP_C);
+
+/** ADC → °C table for the NTC (filled by its init()). */
+static int16_t s_ntcLut[AnalogTempSensor::LUT_ENTRIES];
+
+static DigitalTempSensor s_ds18b20(PIN_DIGITAL_SENSOR, DS18B20_RESOLUTION);
+
+Led g_normalLed(PIN_LED_GREEN);
+static Led s_redLed(PIN_LED_RED);
+static Led s_yellowLed(PIN_LED_YELLOW);
+
+/** EWMA_ADAPTIVE: One-Euro alpha (AdaptiveEwma.h), else the fixed EWMA_ALPHA. */
+#define LAB3_2_CONDITIONER { EWMA_ALPHA, SATURATION_MIN, SATURATION_MAX, \
+                             EWMA_ADAPTIVE ? EWMA_MIN_CUTOFF_HZ : 0.0f,  \
+                             EWMA_BETA, EWMA_DCUTOFF_HZ }
 
-AlertStatus_t g_alertData = {
-    ALERT_NORMAL,  // analogAlertState
-    0,             // analogDebounceCount
-    0.0f,          // analogCondTemp
-    ALERT_NORMAL,  // digitalAlertState
-    0,             // digitalDebounceCount
-    0.0f,          // digitalCondTemp
-    0,             // analogAlertCount
-    0,             // digitalAlertCount
-    0              // conditioningCycles
+const SensorChannel SENSOR_CHANNELS[SENSOR_CHANNEL_COUNT] = {
+    // name, NTC, DS18B20, conditioner,
+    // alert { high, low, debounce, raise / clear dwell, hold on invalid },
+    // NTC table, LED
+    { "Analog", &s_ntcSensor, NULL, LAB3_2_CONDITIONER,
+      { ANALOG_THRESHOLD_HIGH, ANALOG_THRESHOLD_LOW, ALERT_DEBOUNCE_COUNT,
+        ALERT_RAISE_DWELL_MS, ALERT_CLEAR_DWELL_MS, false },
+      NTC_USE_LOOKUP_TABLE ? s_ntcLut : NULL, &s_redLed },
+    { "Digital", NULL, &s_ds18b20, LAB3_2_CONDITIONER,
+      { DIGITAL_THRESHOLD_HIGH, DIGITAL_THRESHOLD_LOW, ALERT_DEBOUNCE_COUNT,
+        ALERT_RAISE_DWELL_MS, ALERT_CLEAR_DWELL_MS, false },
+      NULL, &s_yellowLed },
 };
 
 // ──────────────────────────────────────────────────────────────────────────
-// Synchronization primitives — created at runtime
+// Shared data — zero-initialized at startup (set in sensorDataInit())
 // ──────────────────────────────────────────────────────────────────────────
 
-SemaphoreHandle_t xNewReadingSemaphore = NULL;
-SemaphoreHandle_t xSensorMutex         = NULL;
+SensorReadings_t g_sensorData;
+
+AlertStatus_t g_alertData;
+
+SharedSnapshot<SensorSnapshot_t> g_sensorSnapshot;
+
+EventLog g_alertLog(EVENT_LOG_EEPROM_ADDR, EVENT_LOG_EEPROM_PAGES);
+
+// ──────────────────────────────────────────────────────────────────────────
+// Synchronization primitives — created in sensorDataInit() on storage
+// reserved at link time (StaticRtos)
+// ──────────────────────────────────────────────────────────────────────────
+
+static StaticQueue<RawSample_t *, READING_POOL_BLOCKS> s_readingQueue;
+static StaticMutex s_sensorMutex;
+
+QueueHandle_t     xReadingQueue = NULL;
+BlockPool<RawSample_t, READING_POOL_BLOCKS> g_samplePool;
+SemaphoreHandle_t xSensorMutex  = NULL;
 
 void sensorDataInit() {
-    // Binary semaphore starts "empty" — Task 2 will block until
-    // Task 1 gives it after completing a sensor acquisition cycle.
-    xNewReadingSemaphore = xSemaphoreCreateBinary();
+    // Starts empty — Task 2 blocks until Task 1 queues its first sample.
+    xReadingQueue = s_readingQueue.create();
 
     // Mutex with priority inheritance — prevents priority inversion
     // when Task 3 (low priority) holds the mutex and Task 1 (high
     // priority) attempts to acquire it.
-    xSensorMutex = xSemaphoreCreateMutex();
+    xSensorMutex = s_sensorMutex.create();
+
+    g_sensorData.sample.resolution[CH_DIGITAL] = DS18B20_RESOLUTION;
+    g_alertData.fusedTemp = NAN;
+
+    // Readers see the initial values until the first conditioning cycle.
+    sensorSnapshotPublish();
+}
+
+void sensorSnapshotPublish() {
+    SensorSnapshot_t snap;
+    snap.sensor = g_sensorData;
+    snap.alert  = g_alertData;
+    g_sensorSnapshot.publish(snap);
+    taskDisplayNoteSnapshot(snap);
 }
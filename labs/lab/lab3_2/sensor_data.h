@@ -12,36 +12,69 @@
  * ──────────────────────────────────────────────────────────────────────────
  *
  *   Mutex (xSensorMutex): protects concurrent read/write access to
- *   g_sensorData and g_alertData across all three tasks.
+ *   g_sensorData and g_alertData between the writers (Tasks 1 and 2).
  *
- *   Binary Semaphore (xNewReadingSemaphore): signals from the acquisition
- *   task to the conditioning task that a new sensor reading is available.
+ *   Snapshot (g_sensorSnapshot): Task 2 publishes both structs at the end
+ *   of each conditioning cycle; the display and telemetry tasks read it
+ *   lock-free and never delay the writers.
+ *
+ *   Queue (xReadingQueue): carries every timestamped RawSample_t from the
+ *   acquisition task to the conditioning task, as a pointer to a block of
+ *   g_samplePool (BlockPool.h): the sample is written once and never
+ *   copied through the queue. Nothing is lost while the conditioning task
+ *   lags by less than READING_QUEUE_LENGTH samples; with no free block
+ *   the new sample is dropped and counted in its overrun field.
  *
  * ──────────────────────────────────────────────────────────────────────────
  * Data flow
  * ──────────────────────────────────────────────────────────────────────────
  *
- *   Task 1 (Acquisition) ──[mutex + semaphore]──> Task 2 (Conditioning)
- *   Task 2 (Conditioning) ──[mutex]──> Task 3 (Display & Report)
+ *   Task 1 (Acquisition) ──[queue]──> Task 2 (Conditioning)
+ *   Task 2 (Conditioning) ──[snapshot]──> Task 3 (Display), Task 4 (Telemetry)
  *
  *   Unlike Lab 3.1, Task 2 applies a signal conditioning pipeline
  *   (saturation → median filter → EWMA) before threshold alerting.
+ *
+ * ──────────────────────────────────────────────────────────────────────────
+ * Channel table
+ * ──────────────────────────────────────────────────────────────────────────
+ *
+ *   SENSOR_CHANNELS (sensor_data.cpp) has one row per sensor: driver,
+ *   conditioner and alert settings, LED (SensorPipeline.h), the same
+ *   pipeline as Lab 3.1 with this lab's settings. Task 2 adds the fused
+ *   estimate as alert channel ALERT_CH_FUSED, after the sensors.
  */
 
 #ifndef SENSOR_DATA_H
 #define SENSOR_DATA_H
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 #include <semphr.h>
+#include <queue.h>
 #include "ThresholdAlert.h"
+#include "SensorPipeline.h"
+#include "EventLog.h"
+#include "SharedSnapshot.h"
+#include "BlockPool.h"
+#if defined(LAB3_2_MODBUS)
+#include "ModbusSlave.h"
+#endif
 
 // ══════════════════════════════════════════════════════════════════════════
 // Hardware Pin Mapping (Arduino Mega 2560)
 // ══════════════════════════════════════════════════════════════════════════
 
+#if defined(LAB3_2_NTC_BRIDGE)
+/** NTC divider midpoint, on the bridge's positive input (ADC1). */
+static const uint8_t PIN_ANALOG_SENSOR = A1;
+
+/** Reference divider midpoint (two matched 10K from 5V), negative input (ADC0). */
+static const uint8_t PIN_NTC_BRIDGE_REF = A0;
+#else
 /** NTC thermistor analog input (voltage divider midpoint). */
 static const uint8_t PIN_ANALOG_SENSOR = A0;
+#endif
 
 /** DS18B20 OneWire data pin. */
 static const uint8_t PIN_DIGITAL_SENSOR = 2;
@@ -76,6 +109,49 @@ static const uint16_t NTC_BETA_COEFFICIENT = 3950;
 /** NTC nominal temperature (°C). */
 static const float NTC_NOMINAL_TEMP_C = 25.0f;
 
+/**
+ * Convert ADC counts through a table built in init() (linear interpolation,
+ * < 0.1 °C error over -20..80 °C) instead of log() per sample.
+ */
+static const bool NTC_USE_LOOKUP_TABLE = true;
+
+#if defined(LAB3_2_NTC_BRIDGE)
+/**
+ * -DLAB3_2_NTC_BRIDGE: the NTC divider against the reference divider
+ * through the differential ADC (AnalogTempSensor::useBridge()), AVCC
+ * reference. At 10× the counts span the divider ratio 0.5 ± 0.1, about
+ * 16..34 °C around the thresholds; 4 conversions summed per reading give
+ * 12-bit counts of ≈ 0.005 °C (single-ended: ≈ 0.09 °C).
+ */
+static const uint8_t NTC_BRIDGE_GAIN = 10;
+static const float NTC_BRIDGE_REF_RATIO = 0.5f;
+static const uint8_t NTC_BRIDGE_OVERSAMPLE_LOG2 = 2;
+
+/** The AdcEngine scans single-ended channels: Task 1 converts the bridge itself (~0.5 ms). */
+static const bool ADC_ENGINE_ENABLED = false;
+#else
+/**
+ * Sample the NTC with the timer-triggered AdcEngine (no blocking
+ * analogRead() in Task 1) instead of one conversion per cycle.
+ */
+static const bool ADC_ENGINE_ENABLED = true;
+#endif
+
+/** AdcEngine oversampling: 2^4 = 16 conversions per result (~61 Hz). */
+static const uint8_t ADC_OVERSAMPLE_LOG2 = 4;
+
+/**
+ * Convert in ADC Noise Reduction sleep from the idle hook instead of on
+ * the Timer0 trigger: the CPU and I/O clocks are stopped during each
+ * conversion. This lab reads nothing from the UART, and millis() only
+ * stamps telemetry, so the ~5 % millis() slip at a 2 ms pace is accepted.
+ * 16 conversions at one per 2 ms → ~31 Hz, above the 20 Hz acquisition.
+ */
+static const bool ADC_NOISE_REDUCTION = true;
+
+/** Minimum time between noise-reduced conversions (ms). */
+static const uint8_t ADC_NOISE_REDUCTION_INTERVAL_MS = 2;
+
 // ══════════════════════════════════════════════════════════════════════════
 // DS18B20 Parameters
 // ══════════════════════════════════════════════════════════════════════════
@@ -83,15 +159,128 @@ static const float NTC_NOMINAL_TEMP_C = 25.0f;
 /** DS18B20 measurement resolution (9–12 bits). */
 static const uint8_t DS18B20_RESOLUTION = 10;
 
+/**
+ * Task 1 times each DS18B20 request so the conversion, plus the bus work
+ * of the cycle that issues the next one, is done by the release that
+ * reads it (AcquisitionScheduler). DS18B20_READ_MS is that bus work per
+ * device (Match ROM + scratchpad read ≈ 10 ms bit-banged, and the Convert
+ * T); ACQUISITION_GUARD_MS covers the release wake-up, which is only
+ * within one tick of its time. 10 bit: 188 + 12 + 16 ms → a reading
+ * every 5th release, its request 34 ms into the period.
+ */
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+static const uint16_t DS18B20_READ_MS = 18;   // ~14 ms read, asleep for >= a tick
+#else
+static const uint16_t DS18B20_READ_MS = 12;
+#endif
+static const uint16_t ACQUISITION_GUARD_MS = portTICK_PERIOD_MS;
+
+/**
+ * With -DDIGITAL_TEMP_UART_ONEWIRE, 1-Wire transfers expected to take at
+ * least half a tick (the addressed scratchpad read) sleep instead of
+ * spinning; shorter ones (Convert T, the fast read) are spun out.
+ */
+static const uint16_t ONEWIRE_SLEEP_MIN_US = portTICK_PERIOD_MS * 500U;
+
+/**
+ * Switch the DS18B20 resolution with the signal (see DigitalTempSensor.h):
+ * 9 bit while changing fast or debouncing an alert, 12 bit while stable
+ * near a threshold, DS18B20_RESOLUTION otherwise.
+ */
+static const bool DS18B20_ADAPTIVE_RESOLUTION = true;
+
+/** Fused rate (°C/s) from which 9-bit (94 ms) conversions are used. */
+static const float DS18B20_FAST_RATE_C_PER_S = 0.2f;
+
+/** Distance to a digital threshold (°C) that selects 12 bit when stable. */
+static const float DS18B20_NEAR_BAND_C = 1.0f;
+
+// ══════════════════════════════════════════════════════════════════════════
+// NTC Calibration Against the DS18B20 (see ntc_calibration.h)
+// ══════════════════════════════════════════════════════════════════════════
+
+/**
+ * Fit the NTC Beta and R0 to the DS18B20 while both read valid values
+ * (NtcCalibrator), apply the fit to the conversion and keep it in EEPROM.
+ * false: the datasheet constants above, DS18B20 polled as fast as it
+ * converts.
+ */
+static const bool NTC_CAL_ENABLED = true;
+
+/**
+ * Pairs are used while the DS18B20 stays within NTC_CAL_STEADY_BAND_C of
+ * its 30 s average for 30 s: the two probes lag differently, so they
+ * only agree on a steady temperature. 0.15 °C ≈ two 12-bit LSB of noise.
+ */
+static const float NTC_CAL_STEADY_BAND_C = 0.15f;
+static const float NTC_CAL_STEADY_TAU_S = 30.0f;
+
+/** Prior of the fit: datasheet tolerance (±150 K Beta, ±3 °C at 25 °C). */
+static const float NTC_CAL_BETA_SIGMA_K = 150.0f;
+static const float NTC_CAL_OFFSET_SIGMA_C = 3.0f;
+
+/**
+ * A converged fit replaces the conversion constants at most every
+ * NTC_CAL_APPLY_INTERVAL_MS, and only when it moved by a Beta step or an
+ * R0 step (0.05 % ≈ 0.01 °C): each apply rebuilds the NTC table (65
+ * log() in Task 1, a few ms) and may cost an EEPROM page.
+ */
+static const uint32_t NTC_CAL_APPLY_INTERVAL_MS = 60000;
+static const float NTC_CAL_APPLY_BETA_STEP_K = 2.0f;
+static const float NTC_CAL_APPLY_R0_STEP = 0.0005f;
+
+/** Applied constants, after the alert log (ConfigStore, 4 pages = 288 B). */
+static const uint16_t NTC_CAL_EEPROM_ADDR = 2304;
+static const uint8_t  NTC_CAL_EEPROM_PAGES = 4;
+static const uint8_t  NTC_CAL_VERSION = 1;
+
+/**
+ * Once the NTC is calibrated the DS18B20 is read only every
+ * NTC_CAL_DS18B20_INTERVAL_MS while the signal is quiet (fused rate below
+ * DS18B20_FAST_RATE_C_PER_S, no digital alert debouncing, not within
+ * DS18B20_NEAR_BAND_C of a digital threshold); otherwise as fast as it
+ * converts. Fewer conversions: less self-heating and bus time.
+ */
+static const uint16_t NTC_CAL_DS18B20_INTERVAL_MS = 10000;
+
 // ══════════════════════════════════════════════════════════════════════════
 // Signal Conditioning Parameters
 // ══════════════════════════════════════════════════════════════════════════
 
+#if defined(LAB3_2_NTC_BRIDGE)
+/**
+ * The bridge counts carry far less quantization and supply noise per °C,
+ * so less filtering reaches the same smoothness with less lag: a
+ * 3-sample median and a faster EWMA (rest cutoff 1 Hz when adaptive).
+ */
+static const uint8_t MEDIAN_WINDOW_SIZE = 3;
+static const float EWMA_ALPHA = 0.5f;
+static const float EWMA_MIN_CUTOFF_HZ = 1.0f;
+#else
 /** Median filter window size (number of samples, must be odd). */
 static const uint8_t MEDIAN_WINDOW_SIZE = 5;
 
 /** EWMA smoothing factor (0.0–1.0). Higher = more responsive. */
 static const float EWMA_ALPHA = 0.3f;
+#endif
+
+/**
+ * true: the EWMA alpha adapts to the temperature slope (One-Euro filter,
+ * see AdaptiveEwma.h) — heavy smoothing at rest, little lag during fast
+ * changes, so alerts fire sooner. false: the fixed EWMA_ALPHA above.
+ */
+static const bool EWMA_ADAPTIVE = true;
+
+#if !defined(LAB3_2_NTC_BRIDGE)
+/** Adaptive EWMA cutoff at rest (Hz); 0.5 Hz at 20 Hz gives alpha ≈ 0.14. */
+static const float EWMA_MIN_CUTOFF_HZ = 0.5f;
+#endif
+
+/** Adaptive EWMA cutoff increase per °C/s of slope (Hz·s/°C). */
+static const float EWMA_BETA = 1.0f;
+
+/** Cutoff of the slope estimate (Hz). */
+static const float EWMA_DCUTOFF_HZ = 1.0f;
 
 /** Saturation lower bound (°C). */
 static const float SATURATION_MIN = -40.0f;
@@ -118,6 +307,140 @@ static const float DIGITAL_THRESHOLD_LOW = 28.0f;
 /** Number of consecutive readings to confirm a state transition. */
 static const uint8_t ALERT_DEBOUNCE_COUNT = 5;
 
+/**
+ * Time a condition must hold to raise / clear an alert (ms), measured
+ * on the sample timestamps so it does not change with the acquisition
+ * period (0 = count ALERT_DEBOUNCE_COUNT readings instead).
+ */
+static const uint32_t ALERT_RAISE_DWELL_MS = 250;
+static const uint32_t ALERT_CLEAR_DWELL_MS = 1000;
+
+#if defined(LAB3_2_ADC_ALERTS)
+// ══════════════════════════════════════════════════════════════════════════
+// ADC-Domain Analog Alert (-DLAB3_2_ADC_ALERTS)
+// ══════════════════════════════════════════════════════════════════════════
+
+/**
+ * The analog alert FSM judges the raw count, conditioned in integer math
+ * (FixedSignalConditioner: saturate → median → shift EWMA), against
+ * ANALOG_THRESHOLD_HIGH / LOW mapped to counts through the Beta equation
+ * when Task 2 starts and whenever the NTC calibration moves. The NTC
+ * pulls A0 down as it warms: the alert raises below the high count.
+ * Around 30 °C one count is ≈ 0.09 °C (≈ 0.005 °C on the bridge). The °C values still feed the
+ * fusion, the display and the alert log.
+ */
+static const uint8_t ADC_ALERT_ALPHA_SHIFT = 2;    // EWMA alpha 1/4 (≈ EWMA_ALPHA)
+
+/** Saturation bounds (counts): the rails are a shorted / open NTC. */
+static const int32_t ADC_ALERT_MIN_COUNTS = 1;
+#if defined(LAB3_2_NTC_BRIDGE)
+static const int32_t ADC_ALERT_MAX_COUNTS = (1024L << NTC_BRIDGE_OVERSAMPLE_LOG2) - 2;
+#else
+static const int32_t ADC_ALERT_MAX_COUNTS = 1022;
+#endif
+#endif
+
+// ══════════════════════════════════════════════════════════════════════════
+// Sensor Fusion Parameters (Kalman, see KalmanFusion.h)
+// ══════════════════════════════════════════════════════════════════════════
+
+/** Process noise: rate random walk (°C²/s³). Larger = tracks faster. */
+static const float FUSION_PROCESS_NOISE = 0.05f;
+
+/** Rate variance assumed when the filter is seeded ((°C/s)²). */
+static const float FUSION_INIT_RATE_VAR = 1.0f;
+
+/** Conditioned NTC variance (°C²): σ ≈ 0.2 °C after median + EWMA. */
+static const float FUSION_ANALOG_VARIANCE = 0.04f;
+
+/**
+ * DS18B20 read noise (°C²). The quantization term LSB²/12 of the
+ * resolution in use is added (10 bit: 0.005 + 0.0052 ≈ 0.01).
+ */
+static const float FUSION_DIGITAL_NOISE_VAR = 0.005f;
+
+/*
+ * Age of a fresh DS18B20 reading: the sample reflects the middle of its
+ * conversion window; Task 1 measures it at the release that reads it
+ * (RawSample_t::ageMs, 10 bit: 94 + 12 + 16 ≈ 122 ms, steady), and
+ * Task 2 ages the reading by it.
+ */
+
+/** Fused estimate high threshold (°C) — alert triggers above this. */
+static const float FUSED_THRESHOLD_HIGH = 30.0f;
+
+/** Fused estimate low threshold (°C) — alert clears below this. */
+static const float FUSED_THRESHOLD_LOW = 28.0f;
+
+/**
+ * Fused rate-of-rise trigger: above FUSED_RATE_ARM_C a rise faster than
+ * FUSED_RATE_TRIGGER_C_PER_S (measured over FUSED_RATE_WINDOW_MS) raises
+ * the fused alert before the high threshold is reached. 0 disables.
+ */
+static const float FUSED_RATE_TRIGGER_C_PER_S = 0.2f;
+static const float FUSED_RATE_ARM_C = 27.0f;
+static const uint32_t FUSED_RATE_WINDOW_MS = 2000;
+
+#if defined(LAB3_2_HARD_TRIP)
+// ══════════════════════════════════════════════════════════════════════════
+// Hard Over-Temperature Trip (-DLAB3_2_HARD_TRIP, see ComparatorTrip.h)
+// ══════════════════════════════════════════════════════════════════════════
+
+/**
+ * The NTC divider node (A0; A1 with -DLAB3_2_NTC_BRIDGE) is also wired
+ * to AIN1 (D5). The analog comparator holds it against the 1.1 V
+ * bandgap and, in its ISR, switches the load off and the red LED on,
+ * microseconds after the divider drops
+ * through R_ntc = 0.282 · NTC_SERIES_RESISTANCE: ≈ 56 °C for this NTC
+ * (53..60 °C over the bandgap tolerance), far above the soft thresholds.
+ * Task 2 then logs the trip and keeps the load off until the analog alert
+ * FSM is NORMAL again, HARD_TRIP_HOLDOFF_MS after the trip at the earliest.
+ */
+static const uint8_t PIN_LOAD_ENABLE = 11;   // Heater / load switch, active HIGH
+
+/** Least time the load stays off after a trip (the soft path catches up). */
+static const uint32_t HARD_TRIP_HOLDOFF_MS = 10000;
+
+/** Alert log channel of trip / re-arm records (after the alert channels). */
+static const uint8_t ALERT_LOG_CH_HARD_TRIP = 3;
+#endif
+
+// ══════════════════════════════════════════════════════════════════════════
+// Alert Event Log (see EventLog.h)
+// ══════════════════════════════════════════════════════════════════════════
+
+/**
+ * Every alert state change is logged (time, channel, from/to state,
+ * value) and spilled to EEPROM by Task 4: in 4-record pages, and at once
+ * when an alert is raised or cleared. 64 pages × 36 bytes = 2304 bytes
+ * hold the last 256 transitions across resets.
+ */
+static const uint16_t EVENT_LOG_EEPROM_ADDR = 0;
+static const uint8_t  EVENT_LOG_EEPROM_PAGES = 64;
+
+/**
+ * FsmTrace id of the analog alert channel (-DFSM_TRACE_ENABLED, set in
+ * the lab3_2 env); digital and fused follow as +1 and +2. "trace dump"
+ * lists the last transitions and per-transition counts (states:
+ * 0 NORMAL, 1 DEBOUNCE_HIGH, 2 ACTIVE, 3 DEBOUNCE_LOW).
+ */
+static const uint8_t ALERT_TRACE_ID_BASE = 1;
+
+// ══════════════════════════════════════════════════════════════════════════
+// Reading History (see DeltaSeries.h)
+// ══════════════════════════════════════════════════════════════════════════
+
+/**
+ * Task 4 keeps the analog and digital EWMA and the fused estimate every
+ * HISTORY_INTERVAL_MS, in hundredths, with the time in intervals: about
+ * 4 bytes per sample where a u32 and three floats take 16, so 512 bytes
+ * hold the last ~10 minutes. "hist" prints them, "hist raw" sends the
+ * encoded bytes (a quarter of the CSV's size).
+ */
+static const uint16_t HISTORY_INTERVAL_MS = 5000;
+static const uint16_t HISTORY_BYTES = 512;
+static const int32_t  HISTORY_TEMP_SCALE = 100;
+
 // ══════════════════════════════════════════════════════════════════════════
 // FreeRTOS Task Configuration
 // ══════════════════════════════════════════════════════════════════════════
@@ -125,53 +448,137 @@ static const uint8_t ALERT_DEBOUNCE_COUNT = 5;
 /** Task 1 — Sensor acquisition: 50 ms period, highest priority. */
 static const uint32_t TASK_ACQUISITION_PERIOD_MS = 50;
 static const UBaseType_t TASK_ACQUISITION_PRIORITY = 3;
-static const configSTACK_DEPTH_TYPE TASK_ACQUISITION_STACK = 256;
+static const configSTACK_DEPTH_TYPE TASK_ACQUISITION_STACK = 320;   // + NTC calibration
 
 /** Task 2 — Signal conditioning & alerting: event-driven, medium priority. */
 static const uint32_t TASK_CONDITIONING_PERIOD_MS = 100;
 static const UBaseType_t TASK_CONDITIONING_PRIORITY = 2;
+#if defined(LAB3_2_TRACE_REPLAY)
+static const configSTACK_DEPTH_TYPE TASK_CONDITIONING_STACK = 384;  // + TRACE line printf
+#else
 static const configSTACK_DEPTH_TYPE TASK_CONDITIONING_STACK = 256;
+#endif
 
-/** Task 3 — Display & reporting: 500 ms period, lowest priority. */
-static const uint32_t TASK_DISPLAY_PERIOD_MS = 500;
+/**
+ * Task 3 — Display & reporting: on change, lowest priority. The LCD is
+ * redrawn when a published snapshot changes what it shows, at most every
+ * DISPLAY_REFRESH_MIN_MS; the heartbeat steps the sparkline and brings
+ * the STDIO report.
+ */
+static const uint16_t DISPLAY_REFRESH_MIN_MS = 250;
+static const uint16_t DISPLAY_HEARTBEAT_MS = 2000;
 static const UBaseType_t TASK_DISPLAY_PRIORITY = 1;
 static const configSTACK_DEPTH_TYPE TASK_DISPLAY_STACK = 512;
 
+/** Task 4 — Serial commands + telemetry: 100 ms period, lowest priority. */
+static const uint32_t TASK_TELEMETRY_PERIOD_MS = 100;
+static const UBaseType_t TASK_TELEMETRY_PRIORITY = 1;
+static const configSTACK_DEPTH_TYPE TASK_TELEMETRY_STACK = 448;   // + event log page buffers
+
+/** Task 5 — Modbus RTU slave (-DLAB3_2_MODBUS): per request frame. */
+static const UBaseType_t TASK_MODBUS_PRIORITY = 2;
+static const configSTACK_DEPTH_TYPE TASK_MODBUS_STACK = 256;
+
+/**
+ * Samples buffered between Task 1 and Task 2 (RawSample_t, ~48 bytes
+ * each): 4 × 50 ms lets conditioning fall 200 ms behind without a loss.
+ */
+static const UBaseType_t READING_QUEUE_LENGTH = 4;
+
+/** Sample blocks: the queued ones plus the one Task 2 is working on. */
+static const uint8_t READING_POOL_BLOCKS = READING_QUEUE_LENGTH + 1;
+
+// ══════════════════════════════════════════════════════════════════════════
+// Serial Output Mode
+// ══════════════════════════════════════════════════════════════════════════
+
+/**
+ * false: multi-line text report every 2 s (human terminal).
+ * true:  COBS-framed binary record every TASK_TELEMETRY_PERIOD_MS instead
+ *        (see task_telemetry.h for the layout). The LCD is unaffected.
+ * Fields subscribed with "sub <field> <period_ms>" are printed as text
+ * in either mode and suppress the text report while active.
+ */
+static const bool TELEMETRY_BINARY = false;
+
+/**
+ * Text report form (the "report full" / "report delta" commands switch
+ * it at runtime).
+ * false: the full multi-section report every 2 s.
+ * true:  configuration once, then one key=value line per 2 s with only
+ *        the fields that changed beyond their epsilon (task_display.cpp).
+ */
+static const bool REPORT_COMPACT = true;
+
+#if defined(LAB3_2_MODBUS)
+// ══════════════════════════════════════════════════════════════════════════
+// Modbus RTU Slave (-DLAB3_2_MODBUS, register map in task_modbus.h)
+// ══════════════════════════════════════════════════════════════════════════
+
+/** RS-485 transceiver on USART3 (TX3 D14 / RX3 D15), DE and /RE on D26. */
+static const uint8_t MODBUS_NODE_ADDRESS = 3;
+static const uint32_t MODBUS_BAUD = 19200UL;
+static const ModbusParity MODBUS_PARITY = MODBUS_PARITY_EVEN;
+static const int8_t PIN_MODBUS_DE = 26;
+#endif
+
+#if defined(LAB3_2_TIME_SYNC) && !defined(LAB3_2_MODBUS)
+#error "LAB3_2_TIME_SYNC needs LAB3_2_MODBUS: the sync broadcasts arrive on the bus"
+#endif
+
+#if defined(LAB3_2_SYNC_PULSE)
+// ══════════════════════════════════════════════════════════════════════════
+// Sync Pulse (-DLAB3_2_SYNC_PULSE)
+// ══════════════════════════════════════════════════════════════════════════
+
+/**
+ * Each rising edge from the gateway's sync line (lab 7.1,
+ * -DLAB7_1_SYNC_PULSE, one per TASK_ACQUISITION_PERIOD_MS) releases Task 1,
+ * so every node on the line samples at the same instant instead of on
+ * its own clock. D18 = INT3: its edges are seen in every sleep mode
+ * (INT7:4 are not in ADC noise reduction). Shared ground with the gateway.
+ */
+static const uint8_t PIN_SYNC_PULSE = 18;
+
+/** An edge this late puts Task 1 back on its own period until the next edge. */
+static const uint32_t SYNC_PULSE_TIMEOUT_MS = 2 * TASK_ACQUISITION_PERIOD_MS;
+#endif
+
 // ══════════════════════════════════════════════════════════════════════════
 // Shared Data Structures
 // ══════════════════════════════════════════════════════════════════════════
 
+/** Rows of SENSOR_CHANNELS (index into every per-channel array). */
+enum SensorChannelIndex {
+    CH_ANALOG = 0,        /**< NTC thermistor.                              */
+    CH_DIGITAL = 1,       /**< DS18B20.                                     */
+    SENSOR_CHANNEL_COUNT
+};
+
+/** Alert channels: the sensors, then the fused estimate. */
+enum AlertChannelIndex {
+    ALERT_CH_FUSED = SENSOR_CHANNEL_COUNT,   /**< Kalman estimate.          */
+    ALERT_CHANNEL_COUNT
+};
+
 /**
- * @brief Sensor readings shared between Task 1, Task 2, and Task 3.
+ * @brief One acquisition cycle, queued from Task 1 to Task 2.
  *
- * Raw fields are written by Task 1 (Acquisition) under mutex.
- * Conditioning fields are written by Task 2 (Conditioning) under mutex.
- * All fields are read by Task 3 (Display & Report) under mutex.
+ * Carries its own timestamp, the release it was taken at, so
+ * conditioning runs on acquisition time however late it dequeues the
+ * sample.
+ */
+typedef SensorSample<SENSOR_CHANNEL_COUNT> RawSample_t;
+
+/**
+ * @brief Sensor readings shared between Task 2 and the readers.
+ *
+ * Written by Task 2 (Conditioning) under mutex: the dequeued RawSample_t,
+ * then the conditioned values. Read through g_sensorSnapshot.
  */
 typedef struct {
-    // ── Analog sensor (NTC thermistor) — raw from Task 1 ────────────
-    uint16_t analogRaw;          /**< Raw ADC value (0–1023).              */
-    float    analogResistance;   /**< Calculated NTC resistance (ohms).    */
-    float    analogTempRaw;      /**< Raw converted temperature (°C).      */
-    bool     analogValid;        /**< True if raw reading is valid.        */
-
-    // ── Analog sensor — conditioned by Task 2 ───────────────────────
-    float    analogMedian;       /**< After median filter (°C).            */
-    float    analogEwma;         /**< After EWMA — final conditioned (°C). */
-    bool     analogConditioned;  /**< True once median window is full.     */
-
-    // ── Digital sensor (DS18B20) — raw from Task 1 ──────────────────
-    float    digitalTempRaw;     /**< Raw DS18B20 temperature (°C).        */
-    bool     digitalValid;       /**< True if raw reading is valid.        */
-
-    // ── Digital sensor — conditioned by Task 2 ──────────────────────
-    float    digitalMedian;      /**< After median filter (°C).            */
-    float    digitalEwma;        /**< After EWMA — final conditioned (°C). */
-    bool     digitalConditioned; /**< True once median window is full.     */
-
-    // ── Metadata ────────────────────────────────────────────────────
-    uint32_t readingCount;       /**< Total number of acquisition cycles.  */
-    TickType_t timestamp;        /**< Tick count at last acquisition.      */
+    RawSample_t                             sample;  /**< Last raw sample.       */
+    SensorConditioned<SENSOR_CHANNEL_COUNT> cond;    /**< Its conditioned values. */
 } SensorReadings_t;
 
 /**
@@ -181,39 +588,72 @@ typedef struct {
  * Read by Task 3 (Display & Report) under mutex protection.
  */
 typedef struct {
-    // ── Analog sensor alert ─────────────────────────────────────────
-    AlertState analogAlertState;     /**< Current FSM state.               */
-    uint8_t    analogDebounceCount;  /**< Current debounce counter.        */
-    float      analogCondTemp;       /**< Conditioned temp fed to alert.   */
-
-    // ── Digital sensor alert ────────────────────────────────────────
-    AlertState digitalAlertState;    /**< Current FSM state.               */
-    uint8_t    digitalDebounceCount; /**< Current debounce counter.        */
-    float      digitalCondTemp;      /**< Conditioned temp fed to alert.   */
-
-    // ── System status ───────────────────────────────────────────────
-    uint32_t analogAlertCount;       /**< Total analog alert activations.  */
-    uint32_t digitalAlertCount;      /**< Total digital alert activations. */
+    SensorAlerts<ALERT_CHANNEL_COUNT> channel;  /**< Per-channel FSM status.       */
+
+    // ── Fused (Kalman) estimate ─────────────────────────────────────
+    float      fusedTemp;            /**< Best estimate (°C), NAN if none. */
+    float      fusedVariance;        /**< Estimate variance (°C²).         */
+    float      fusedRate;            /**< Estimated slope (°C/s).          */
+
     uint32_t conditioningCycles;     /**< Total conditioning cycles.       */
+#if defined(LAB3_2_HARD_TRIP)
+    bool     hardTripped;            /**< Load cut by the comparator trip. */
+    uint16_t hardTrips;              /**< Comparator trips since boot.     */
+#endif
 } AlertStatus_t;
 
+/** Both shared structs as of one conditioning cycle (see g_sensorSnapshot). */
+typedef struct {
+    SensorReadings_t sensor;
+    AlertStatus_t    alert;
+} SensorSnapshot_t;
+
 // ══════════════════════════════════════════════════════════════════════════
 // External Declarations
 // ══════════════════════════════════════════════════════════════════════════
 
-/** Sensor readings — written by Task 1 (raw) and Task 2 (conditioned). */
+/** Sensor readings — written by Task 2 (raw sample + conditioned). */
 extern SensorReadings_t g_sensorData;
 
 /** Alert status — written by Task 2, read by Task 3. */
 extern AlertStatus_t g_alertData;
 
 /**
- * @brief Binary semaphore for new-reading notification (Task 1 → Task 2).
+ * Copy of g_sensorData and g_alertData for the readers — published by
+ * Task 2 (sensorSnapshotPublish()), read lock-free by Tasks 3 and 4.
+ */
+extern SharedSnapshot<SensorSnapshot_t> g_sensorSnapshot;
+
+/**
+ * Alert transition log — records added by Task 2 (lock-free, no mutex),
+ * spilled and dumped by Task 4. EventRecord::code is
+ * (from state << 4) | to state.
+ */
+extern EventLog g_alertLog;
+
+/** One row per sensor (drivers and LEDs are defined with it). */
+extern const SensorChannel SENSOR_CHANNELS[SENSOR_CHANNEL_COUNT];
+
+/** Lit while every sensor channel is NORMAL (Task 2). */
+extern Led g_normalLed;
+
+/**
+ * @brief Queue of RawSample_t * (Task 1 → Task 2), one slot per pool block.
+ */
+extern QueueHandle_t xReadingQueue;
+
+/**
+ * @brief Blocks the queued samples live in.
+ *
+ * Task 1 allocates and fills one per sample; Task 2 releases it once the
+ * sample is stored. highWater() is the deepest backlog so far.
  */
-extern SemaphoreHandle_t xNewReadingSemaphore;
+extern BlockPool<RawSample_t, READING_POOL_BLOCKS> g_samplePool;
 
 /**
  * @brief Mutex for protecting shared data (g_sensorData, g_alertData).
+ *
+ * Task 1 only takes it to read the alert state for its DS18B20 policy.
  */
 extern SemaphoreHandle_t xSensorMutex;
 
@@ -224,4 +664,11 @@ extern SemaphoreHandle_t xSensorMutex;
  */
 void sensorDataInit();
 
+/**
+ * @brief Publish g_sensorData and g_alertData to g_sensorSnapshot.
+ *
+ * Call with xSensorMutex held, which also serializes the publishers.
+ */
+void sensorSnapshotPublish();
+
 #endif // SENSOR_DATA_H
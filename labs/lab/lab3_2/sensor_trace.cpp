@@ -0,0 +1,217 @@
+/**
+ * @file sensor_trace.cpp
+ * @brief Lab 3.2 — Sensor Trace Capture and Replay Implementation
+ *        (-DLAB3_2_TRACE_CAPTURE / -DLAB3_2_TRACE_REPLAY only)
+ *
+ * Capture sends from Task 1 only, so TelemetryFrame keeps its single
+ * sender; binary telemetry from Task 4 would be a second one and is
+ * rejected at compile time. In replay the sample's overruns field
+ * carries the frames lost from the trace instead of queue overruns.
+ */
+
+#if defined(LAB3_2_TRACE_CAPTURE) || defined(LAB3_2_TRACE_REPLAY)
+
+#include "sensor_trace.h"
+
+#include "FixedFormat.h"
+#include "RtosTime.h"
+#include "StdioSerial.h"
+#include "TelemetryFrame.h"
+#include "FlashString.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Record layout (must match the table in sensor_trace.h)
+// ──────────────────────────────────────────────────────────────────────────
+
+typedef struct __attribute__((packed)) {
+    uint32_t timeMs;
+    uint32_t sequence;
+    uint16_t analogRaw;
+    int16_t  digitalTemp;
+    uint16_t digitalConversionMs;
+    uint8_t  digitalResolution;
+    uint8_t  flags;
+} Lab3_2Trace_t;
+
+/// DS18B20 scale: its LSB is 1/16 °C, so the value is carried exactly.
+static const int16_t DIGITAL_SCALE = 16;
+
+static const uint8_t FLAG_ANALOG_VALID  = 0x01;
+static const uint8_t FLAG_DIGITAL_VALID = 0x02;
+static const uint8_t FLAG_DIGITAL_FRESH = 0x04;
+
+#if defined(LAB3_2_TRACE_CAPTURE)
+
+static_assert(!TELEMETRY_BINARY, "trace capture owns TelemetryFrame; disable TELEMETRY_BINARY");
+
+// ──────────────────────────────────────────────────────────────────────────
+// Capture
+// ──────────────────────────────────────────────────────────────────────────
+
+void sensorTraceBegin() {
+    putchar(0x00);
+}
+
+void sensorTraceCapture(const RawSample_t &sample) {
+    Lab3_2Trace_t rec;
+    rec.timeMs              = (uint32_t)sample.timestamp * portTICK_PERIOD_MS;
+    rec.sequence            = sample.sequence;
+    rec.analogRaw           = sample.raw[CH_ANALOG];
+    rec.digitalTemp         = telemetryPackFloat(sample.tempC[CH_DIGITAL], DIGITAL_SCALE);
+    rec.digitalConversionMs = sample.conversionMs[CH_DIGITAL];
+    rec.digitalResolution   = sample.resolution[CH_DIGITAL];
+    rec.flags = (uint8_t)((sample.valid[CH_ANALOG]  ? FLAG_ANALOG_VALID  : 0) |
+                          (sample.valid[CH_DIGITAL] ? FLAG_DIGITAL_VALID : 0) |
+                          (sample.fresh[CH_DIGITAL] ? FLAG_DIGITAL_FRESH : 0));
+
+    telemetrySend(LAB3_2_TRACE_TYPE, &rec, sizeof(rec));
+}
+
+#else  // LAB3_2_TRACE_REPLAY
+
+// ──────────────────────────────────────────────────────────────────────────
+// Replay — Task 1 side
+// ──────────────────────────────────────────────────────────────────────────
+
+/// Encoded frame of the largest record, without its delimiter.
+static const uint8_t FRAME_MAX = sizeof(Lab3_2Trace_t) + 5;
+
+static uint8_t s_frame[FRAME_MAX];
+
+void sensorTraceBegin() {
+    // Task 2 waits on the UART rather than lose a TRACE line.
+    stdioSerialSetTxPolicy(STDIO_TX_BLOCK);
+
+    char alpha[FMT_FIXED_BUF_SIZE];
+    fmtFixed(alpha, EWMA_ALPHA, 1, 3);
+    FLASH_PRINTF("TRACE_CONFIG,median=%u,alpha=%s,adaptive=%u,lut=%u\r\n",
+                 (unsigned)MEDIAN_WINDOW_SIZE, alpha, (unsigned)EWMA_ADAPTIVE,
+                 (unsigned)NTC_USE_LOOKUP_TABLE);
+}
+
+/** @brief Turn a decoded record into the sample Task 1 would have queued. */
+static void toSample(const Lab3_2Trace_t &rec, const AnalogTempSensor &ntc,
+                     RawSample_t *sample) {
+    memset(sample, 0, sizeof(*sample));   // NTC: no conversion window or age
+    sample->timestamp                = (TickType_t)(rec.timeMs / portTICK_PERIOD_MS);
+    sample->sequence                 = rec.sequence;
+    sample->raw[CH_ANALOG]           = rec.analogRaw;
+    sample->resistance[CH_ANALOG]    = -1.0f;  // Not recorded
+    sample->valid[CH_ANALOG]         = (rec.flags & FLAG_ANALOG_VALID) != 0;
+    sample->fresh[CH_ANALOG]         = sample->valid[CH_ANALOG];
+    sample->tempC[CH_ANALOG]         = sample->valid[CH_ANALOG] ? ntc.convertRawC(rec.analogRaw)
+                                                                : NAN;
+    sample->tempC[CH_DIGITAL]        = (rec.digitalTemp == TELEMETRY_INVALID_I16)
+                                           ? NAN : (float)rec.digitalTemp / DIGITAL_SCALE;
+    sample->valid[CH_DIGITAL]        = (rec.flags & FLAG_DIGITAL_VALID) != 0;
+    sample->fresh[CH_DIGITAL]        = (rec.flags & FLAG_DIGITAL_FRESH) != 0;
+    sample->resolution[CH_DIGITAL]   = rec.digitalResolution;
+    sample->conversionMs[CH_DIGITAL] = rec.digitalConversionMs;
+    // Not recorded: the age a live run schedules (sensor_data.h).
+    sample->ageMs[CH_DIGITAL]        = (uint16_t)(rec.digitalConversionMs / 2 + DS18B20_READ_MS +
+                                                  ACQUISITION_GUARD_MS);
+}
+
+void sensorTraceReplay(const AnalogTempSensor &ntc) {
+    uint8_t frameLen = 0;
+    bool    overflow = false;   // Discarding up to the next delimiter
+    bool    first    = true;
+    uint8_t expectedSeq = 0;
+    uint32_t lost = 0;
+
+    for (;;) {
+        int c = stdioSerialPollChar();
+        if (c < 0) {
+            vTaskDelay(1);  // <= 16 ms, ~15 bytes at 9600 baud: well within the RX ring
+            continue;
+        }
+
+        if (c != 0x00) {
+            if (frameLen < FRAME_MAX) {
+                s_frame[frameLen++] = (uint8_t)c;
+            } else {
+                overflow = true;
+            }
+            continue;
+        }
+
+        // Delimiter: decode what came before it.
+        if (frameLen == 0 && !overflow) {
+            continue;  // Back-to-back delimiters
+        }
+        Lab3_2Trace_t rec;
+        uint8_t type;
+        uint8_t seq;
+        bool ok = !overflow &&
+                  telemetryDecode(s_frame, frameLen, &type, &seq, &rec, sizeof(rec)) ==
+                      (int)sizeof(rec) &&
+                  type == LAB3_2_TRACE_TYPE;
+        frameLen = 0;
+        overflow = false;
+        if (!ok) {
+            // Still answered, so the host moves on; the gap in seq counts it.
+            FLASH_PRINTF("[ERROR] trace frame rejected\r\n");
+            continue;
+        }
+
+        if (!first) {
+            lost += (uint8_t)(seq - expectedSeq);
+        }
+        first = false;
+        expectedSeq = (uint8_t)(seq + 1);
+
+        // Wait for a block rather than drop a record, as a live run never would.
+        RawSample_t *block;
+        while ((block = g_samplePool.allocate()) == NULL) {
+            vTaskDelay(1);
+        }
+        toSample(rec, ntc, block);
+        block->overruns = lost;
+        xQueueSend(xReadingQueue, &block, 0);
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Replay — Task 2 side
+// ──────────────────────────────────────────────────────────────────────────
+
+// Static: Task 2 is the only caller, and its stack stays small.
+static SensorSnapshot_t s_snapshot;
+static char s_text[9][FMT_FIXED_BUF_SIZE];
+
+void sensorTraceReport(uint32_t sequence) {
+    g_sensorSnapshot.read(s_snapshot);
+    const SensorReadings_t &s = s_snapshot.sensor;
+    const AlertStatus_t    &a = s_snapshot.alert;
+    if (s.sample.sequence != sequence) {
+        FLASH_PRINTF("[ERROR] trace sample %lu not published\r\n", (unsigned long)sequence);
+        return;
+    }
+
+    fmtFixed(s_text[0], s.sample.tempC[CH_ANALOG],  1, 2);
+    fmtFixed(s_text[1], s.cond.median[CH_ANALOG],   1, 2);
+    fmtFixed(s_text[2], s.cond.ewma[CH_ANALOG],     1, 2);
+    fmtFixed(s_text[3], s.cond.alpha[CH_ANALOG],    1, 3);
+    fmtFixed(s_text[4], s.sample.tempC[CH_DIGITAL], 1, 4);
+    fmtFixed(s_text[5], s.cond.median[CH_DIGITAL],  1, 2);
+    fmtFixed(s_text[6], s.cond.ewma[CH_DIGITAL],    1, 2);
+    fmtFixed(s_text[7], s.cond.alpha[CH_DIGITAL],   1, 3);
+    fmtFixed(s_text[8], a.fusedTemp,      1, 2);
+    FLASH_PRINTF("TRACE,%lu,%lu,%u,%s,%s,%s,%s,%s,%s,%s,%s,%s,%u,%u,%u,%lu\r\n",
+                 (unsigned long)sequence,
+                 (unsigned long)((uint32_t)s.sample.timestamp * portTICK_PERIOD_MS),
+                 (unsigned)s.sample.raw[CH_ANALOG],
+                 s_text[0], s_text[1], s_text[2], s_text[3],
+                 s_text[4], s_text[5], s_text[6], s_text[7], s_text[8],
+                 (unsigned)a.channel.state[CH_ANALOG], (unsigned)a.channel.state[CH_DIGITAL],
+                 (unsigned)a.channel.state[ALERT_CH_FUSED],
+                 (unsigned long)s.sample.overruns);
+}
+
+#endif // LAB3_2_TRACE_CAPTURE
+
+#endif // LAB3_2_TRACE_CAPTURE || LAB3_2_TRACE_REPLAY
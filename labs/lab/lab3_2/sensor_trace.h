@@ -0,0 +1,110 @@
+/**
+ * @file sensor_trace.h
+ * @brief Lab 3.2 — Sensor Trace Capture and Replay (-DLAB3_2_TRACE_*)
+ *
+ * Records what the two sensors delivered during a live run, then feeds
+ * that trace back through the unchanged conditioning task, so different
+ * MEDIAN_WINDOW_SIZE / EWMA_* settings can be compared on the same noise.
+ *
+ * ──────────────────────────────────────────────────────────────────────────
+ * Capture (-DLAB3_2_TRACE_CAPTURE)
+ * ──────────────────────────────────────────────────────────────────────────
+ *
+ *   Task 1 sends every acquired sample as one TelemetryFrame record (COBS
+ *   + CRC-16, 0x00 delimiter), ~22 bytes per 50 ms. The text report is
+ *   off; save the raw serial bytes to a file. A lost frame shows as a gap
+ *   in the frame sequence number.
+ *
+ *   Record type LAB3_2_TRACE_TYPE, 16 bytes, little-endian:
+ *
+ *     off  type   field
+ *     0    u32    timeMs             acquisition tick × portTICK_PERIOD_MS
+ *     4    u32    sequence           acquisition cycle number
+ *     8    u16    analogRaw          NTC ADC counts (0–1023)
+ *     10   i16    digitalTemp        DS18B20 value in 1/16 C (its LSB)
+ *     12   u16    digitalConversionMs
+ *     14   u8     digitalResolution  bits
+ *     15   u8     flags              bit0 analogValid, bit1 digitalValid,
+ *                                    bit2 digitalFresh
+ *
+ *   digitalTemp equal to -32768 marks NaN (no reading).
+ *
+ * ──────────────────────────────────────────────────────────────────────────
+ * Replay (-DLAB3_2_TRACE_REPLAY)
+ * ──────────────────────────────────────────────────────────────────────────
+ *
+ *   Task 1 touches no sensor: it reads the captured frames back from the
+ *   serial port, converts the ADC counts with the build's NTC settings
+ *   and queues each as a RawSample_t on the recorded timestamp, waiting
+ *   for queue space instead of dropping. Task 2 processes it unchanged
+ *   and prints one line per sample (blocking, never dropped):
+ *
+ *     TRACE,<seq>,<t_ms>,<araw>,<atemp>,<amed>,<aewma>,<aalpha>,
+ *           <dtemp>,<dmed>,<dewma>,<dalpha>,<ftemp>,<astate>,<dstate>,
+ *           <fstate>,<lost>
+ *
+ *   preceded by a TRACE_CONFIG line with the conditioner settings. lost
+ *   counts frames missing from the trace so far. Every frame sent is
+ *   answered by one line, its TRACE line or "[ERROR] trace frame
+ *   rejected"; the serial RX ring holds only a few frames, so send the
+ *   next one when that line has arrived. The pipeline then runs as fast
+ *   as the link allows, whatever the recorded sample period.
+ *
+ *   The serial commands and the EEPROM spill of the alert log are off,
+ *   so replayed alerts never mix with the live history.
+ *
+ * Usage (lab3_2Setup(), after the banner):
+ *   sensorTraceBegin();
+ */
+
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include "sensor_data.h"
+#include "AnalogTempSensor.h"
+
+#if defined(LAB3_2_TRACE_CAPTURE) && defined(LAB3_2_TRACE_REPLAY)
+#error "LAB3_2_TRACE_CAPTURE and LAB3_2_TRACE_REPLAY are exclusive"
+#endif
+
+/** @brief TelemetryFrame record type id of a trace sample. */
+static const uint8_t LAB3_2_TRACE_TYPE = 0x33;
+
+/** @brief True when a trace mode owns the serial link (no text report). */
+#if defined(LAB3_2_TRACE_CAPTURE) || defined(LAB3_2_TRACE_REPLAY)
+static const bool SENSOR_TRACE_ACTIVE = true;
+#else
+static const bool SENSOR_TRACE_ACTIVE = false;
+#endif
+
+/**
+ * @brief Start the trace mode.
+ *
+ * Capture: sends a lone delimiter, so the first frame does not merge
+ * with the banner. Replay: switches STDIO to blocking TX and prints the
+ * TRACE_CONFIG line.
+ */
+void sensorTraceBegin();
+
+/** @brief Send one acquired sample as a trace record (capture, Task 1). */
+void sensorTraceCapture(const RawSample_t &sample);
+
+/**
+ * @brief Feed received trace records to xReadingQueue (replay, Task 1).
+ *
+ * @param ntc The Task 1 sensor, configured as for a live run; only its
+ *            ADC → °C conversion is used.
+ * @note Never returns.
+ */
+void sensorTraceReplay(const AnalogTempSensor &ntc);
+
+/**
+ * @brief Print the TRACE line of the sample just conditioned (replay, Task 2).
+ *
+ * Call after the snapshot has been published, without the mutex held.
+ *
+ * @param sequence Sequence number of the sample.
+ */
+void sensorTraceReport(uint32_t sequence);
+
+#endif // SENSOR_TRACE_H
@@ -11,114 +11,261 @@
  * Acquisition sequence (each 50 ms cycle)
  * ──────────────────────────────────────────────────────────────────────────
  *
- *   1. Read NTC thermistor via analogRead() → convert to °C (Beta eq.)
- *   2. Read DS18B20 via DallasTemperature → get °C directly
- *   3. Acquire mutex → write raw values to g_sensorData → release mutex
- *   4. Give binary semaphore → wake up Task 2 (conditioning)
+ *   1. Timestamp the release: every value below belongs to this sample set
+ *   2. Read NTC thermistor → convert to °C (Beta eq. / lookup table).
+ *      With ADC_ENGINE_ENABLED the count is the latest 16× oversampled
+ *      AdcEngine result, so the read never waits on the ADC; with
+ *      -DLAB3_2_NTC_BRIDGE it is the differential bridge count, summed
+ *      over 4 conversions while Task 1 waits (~0.5 ms)
+ *   3. If the schedule says the DS18B20 conversion is due, read it by
+ *      cached ROM address; otherwise no bus traffic at all
+ *   4. Acquire mutex → read the alert state for the DS18B20 policy
+ *   5. Copy the RawSample_t into a pool block and queue its pointer for
+ *      Task 2 (conditioning); never waits, with no free block the sample
+ *      is dropped and counted as an overrun
+ *   6. Offer a fresh pair to the NTC calibration (ntc_calibration.h),
+ *      which also sets how often the DS18B20 is needed
+ *   7. Sleep to the offset the schedule gives and start the next
+ *      DS18B20 conversion, if one is due this period
  *
- * This task writes only raw sensor values. Signal conditioning
+ * The DS18B20 requests are timed backwards from the release that reads
+ * them (AcquisitionScheduler): conversion time of the resolution in use
+ * + DS18B20_READ_MS per device + ACQUISITION_GUARD_MS before it. Each
+ * reading thus arrives on a fixed release, the same age every time, and
+ * the period's other work never pushes it past a release. Both sensors
+ * are initialized, and the first conversion started, by
+ * acquisitionStart() from setup(); SensorAcquisition runs the
+ * SENSOR_CHANNELS rows.
+ *
+ * This task produces only raw samples. Signal conditioning
  * (saturation, median filter, EWMA) is handled by Task 2.
+ *
+ * With -DLAB3_2_SYNC_PULSE each cycle is released by an edge of the
+ * gateway's sync line instead of the task's own clock, on every node at
+ * once; the idle hook switches to the task on the edge rather than at
+ * the next tick (acquisitionSyncYield()). Without edges for
+ * SYNC_PULSE_TIMEOUT_MS the task runs on its period until they return.
+ *
+ * With -DLAB3_2_TRACE_CAPTURE each queued sample is also sent as a trace
+ * record; with -DLAB3_2_TRACE_REPLAY the samples come from a received
+ * trace instead of the sensors (sensor_trace.h).
  */
 
 #include "task_acquisition.h"
 #include "sensor_data.h"
+#include "sensor_trace.h"
+#include "ntc_calibration.h"
+
+#include "SensorAcquisition.h"
+#include "RtosTime.h"
+#include "FlashString.h"
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+#include "UartOneWire.h"
+#endif
+#if defined(LAB3_2_SYNC_PULSE)
+#include "TaskSignal.h"
+#endif
+
+#include <stdio.h>
 
-#include "AnalogTempSensor.h"
-#include "DigitalTempSensor.h"
+// ──────────────────────────────────────────────────────────────────────────
+// Acquisition stage (owned by this task — the drivers are table rows)
+// ──────────────────────────────────────────────────────────────────────────
+
+/** Reads SENSOR_CHANNELS (static: keeps the sample off the task stack). */
+static SensorAcquisition<SENSOR_CHANNEL_COUNT> s_acquisition(SENSOR_CHANNELS,
+                                                             (uint16_t)TASK_ACQUISITION_PERIOD_MS,
+                                                             ACQUISITION_GUARD_MS,
+                                                             DS18B20_READ_MS);
 
+#if defined(LAB3_2_SYNC_PULSE)
 // ──────────────────────────────────────────────────────────────────────────
-// Local sensor instances (owned by this task — no sharing needed)
+// Sync pulse release
 // ──────────────────────────────────────────────────────────────────────────
 
-static AnalogTempSensor  s_ntcSensor(PIN_ANALOG_SENSOR,
-                                     NTC_SERIES_RESISTANCE,
-                                     NTC_NOMINAL_RESISTANCE,
-                                     NTC_BETA_COEFFICIENT,
-                                     NTC_NOMINAL_TEMP_C);
+static TaskSignal s_syncPulse;
+static volatile uint32_t s_syncPulseMs = 0;      ///< millis() of the last edge
+static volatile bool     s_syncPulseReady = false;   ///< Given, not yet switched to
+
+static void onSyncPulse() {
+    s_syncPulseMs = millis();
+    s_syncPulseReady = true;
+    s_syncPulse.giveFromIsr();
+}
+
+void acquisitionSyncYield() {
+    if (s_syncPulseReady) {
+        s_syncPulseReady = false;
+        taskYIELD();
+    }
+}
+
+/**
+ * @brief Block until the next release: the next edge while they arrive,
+ *        the period's clock otherwise.
+ * @return Whether the release after this one waits for an edge.
+ */
+static bool waitRelease(RtosPeriod &period, bool pulsed) {
+    if (pulsed && s_syncPulse.take(rtosMsToTicks(SYNC_PULSE_TIMEOUT_MS)) > 0) {
+        period.trigger(s_syncPulseMs);
+        return true;
+    }
+    period.wait();
+    return s_syncPulse.take(0) > 0;   // An edge meanwhile: back on the line
+}
+#endif
 
-static DigitalTempSensor s_ds18b20(PIN_DIGITAL_SENSOR, DS18B20_RESOLUTION);
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+/** UartOneWire wait hook: sleep through long transfers (this task only). */
+static void oneWireWait(uint16_t expectedUs) {
+    if (expectedUs >= ONEWIRE_SLEEP_MIN_US) {
+        vTaskDelay(rtosMsToTicks(expectedUs / 1000U));
+    }
+}
+#endif
 
 // ──────────────────────────────────────────────────────────────────────────
 // Task function
 // ──────────────────────────────────────────────────────────────────────────
 
+void acquisitionStart() {
+#if defined(LAB3_2_NTC_BRIDGE)
+    // Before the NTC's init(), which zeroes the bridge offset and builds
+    // the table on the bridge counts.
+    if (!SENSOR_CHANNELS[CH_ANALOG].ntc->useBridge(PIN_NTC_BRIDGE_REF, NTC_BRIDGE_GAIN,
+                                                   NTC_BRIDGE_REF_RATIO,
+                                                   NTC_BRIDGE_OVERSAMPLE_LOG2)) {
+        FLASH_PRINTF("[ERROR] NTC bridge not supported, reading single-ended\r\n");
+    }
+#endif
+#if !defined(LAB3_2_TRACE_REPLAY)
+    // Initialize both sensors and start the first DS18B20 conversion now,
+    // so it runs while the remaining setup, the LCD init and the banner do.
+    s_acquisition.begin();
+
+    // Stored NTC constants replace the datasheet ones before the first
+    // conversion (rebuilds the lookup table begin() filled).
+    ntcCalibrationLoad(*SENSOR_CHANNELS[CH_ANALOG].ntc);
+
+    // Move the NTC onto the background ADC engine; on failure the sensor
+    // keeps using analogRead(). With ADC_NOISE_REDUCTION the conversions
+    // run from lab3_2Loop() (idle hook).
+    if (ADC_ENGINE_ENABLED &&
+        !s_acquisition.useAdcEngine(ADC_OVERSAMPLE_LOG2,
+                                    ADC_NOISE_REDUCTION ? ADC_ENGINE_TRIGGER_SLEEP
+                                                        : ADC_ENGINE_TRIGGER_TIMER,
+                                    ADC_NOISE_REDUCTION_INTERVAL_MS)) {
+        FLASH_PRINTF("[ERROR] ADC engine init failed, using analogRead()\r\n");
+    }
+
+    if (DS18B20_ADAPTIVE_RESOLUTION) {
+        SENSOR_CHANNELS[CH_DIGITAL].ds18b20->setAdaptiveResolution(DS18B20_FAST_RATE_C_PER_S,
+                                                                  DS18B20_NEAR_BAND_C);
+    }
+#if defined(LAB3_2_SYNC_PULSE)
+    pinMode(PIN_SYNC_PULSE, INPUT);
+    attachInterrupt(digitalPinToInterrupt(PIN_SYNC_PULSE), onSyncPulse, RISING);
+#endif
+#else
+    // Replay uses the NTC conversion only.
+    AnalogTempSensor &ntc = *SENSOR_CHANNELS[CH_ANALOG].ntc;
+    if (SENSOR_CHANNELS[CH_ANALOG].ntcLut != NULL) {
+        ntc.useLookupTable(SENSOR_CHANNELS[CH_ANALOG].ntcLut);
+    }
+    ntc.init();
+#endif
+}
+
 void vTaskAcquisition(void *pvParameters) {
     (void)pvParameters;
+    DigitalTempSensor &ds18b20 = *SENSOR_CHANNELS[CH_DIGITAL].ds18b20;
+    AnalogTempSensor  &ntc     = *SENSOR_CHANNELS[CH_ANALOG].ntc;
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+    uartOneWireSetWait(oneWireWait);  // Set up in setup() by spinning; only this task now
+#endif
 
-    // Initialize sensor hardware.
-    s_ntcSensor.init();
-    bool ds18b20Found = s_ds18b20.init();
+#if defined(LAB3_2_TRACE_REPLAY)
+    sensorTraceReplay(ntc);  // Never returns; no sensor is read
+#endif
 
-    // Kick off the first DS18B20 conversion so the next read has data.
-    if (ds18b20Found) {
-        s_ds18b20.requestConversion();
+    // The first decimated NTC result is a few ms away (the engine was
+    // started in acquisitionStart()).
+    if (ADC_ENGINE_ENABLED) {
+        while (adcEngineRunning() && adcEngineSequence() == 0) {
+            vTaskDelay(rtosMsToTicks(10));
+        }
     }
+    bool ds18b20Found = (s_acquisition.foundMask() & (1U << CH_DIGITAL)) != 0;
+    s_acquisition.start();
 
-    // Track whether the first DS18B20 conversion is still pending.
-    bool firstConversion = true;
+    RtosPeriod period(TASK_ACQUISITION_PERIOD_MS);
+#if defined(LAB3_2_SYNC_PULSE)
+    s_syncPulse.bind();
+    bool pulsed = true;
+#endif
 
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(TASK_ACQUISITION_PERIOD_MS);
-
-    // Local variables for readings (avoid holding mutex during I/O).
-    uint16_t rawAdc;
-    float    resistance;
-    float    analogTemp;
-    bool     analogOk;
-    float    digitalTemp;
-    bool     digitalOk;
+    // Resolution policy inputs, refreshed from Task 2's results each cycle.
+    float policyRate     = 0.0f;
+    float policyDistance = NAN;
+    bool  policyPending  = false;
 
     for (;;) {
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);
-
-        // ── 1. Read analog sensor (NTC thermistor) ──────────────────────
-        analogTemp  = s_ntcSensor.readTemperatureC();
-        rawAdc      = s_ntcSensor.getLastRaw();
-        resistance  = s_ntcSensor.getLastResistance();
-        analogOk    = s_ntcSensor.isValid();
+#if defined(LAB3_2_SYNC_PULSE)
+        pulsed = waitRelease(period, pulsed);
+#else
+        period.wait();
+#endif
 
-        // ── 2. Read digital sensor (DS18B20) ────────────────────────────
+        // ── 1–3. Timestamp the sample set and read every channel ────────
+        // The DS18B20 is read only when its result is due; until the first
+        // conversion is read the sample carries no digital value (valid
+        // false), and the NTC is already conditioned on its own. The
+        // resolution policy runs first, so the read switches it for the
+        // next conversion.
         if (ds18b20Found) {
-            if (firstConversion) {
-                // Wait for the initial conversion to complete.
-                while (!s_ds18b20.isConversionComplete()) {
-                    vTaskDelay(pdMS_TO_TICKS(10));
-                }
-                firstConversion = false;
-            }
-
-            if (s_ds18b20.isConversionComplete()) {
-                digitalTemp = s_ds18b20.readLastConversionC();
-                digitalOk   = s_ds18b20.isValid();
-                // Conversion is done — start the next one.
-                s_ds18b20.requestConversion();
-            } else {
-                // Still converting — keep last known-good value, don't restart.
-                digitalTemp = s_ds18b20.getLastTemperatureC();
-                digitalOk   = s_ds18b20.isValid();
-            }
-        } else {
-            digitalTemp = NAN;
-            digitalOk   = false;
+            ds18b20.updateResolutionPolicy(policyRate, policyDistance,
+                                           policyPending);
         }
+        const RawSample_t &sample = s_acquisition.acquire();
 
-        // ── 3. Write raw values to shared data under mutex ──────────────
-        if (xSemaphoreTake(xSensorMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            g_sensorData.analogRaw        = rawAdc;
-            g_sensorData.analogResistance = resistance;
-            g_sensorData.analogTempRaw    = analogTemp;
-            g_sensorData.analogValid      = analogOk;
-
-            g_sensorData.digitalTempRaw   = digitalTemp;
-            g_sensorData.digitalValid     = digitalOk;
+        // ── 4. Read the resolution policy inputs under mutex ────────────
+        // Signal dynamics from Task 2's last cycle; stale values are
+        // kept if the mutex is busy.
+        if (xSemaphoreTake(xSensorMutex, rtosMsToTicks(10)) == pdTRUE) {
+            float digitalCond = g_alertData.channel.value[CH_DIGITAL];
+            policyRate    = g_alertData.fusedRate;
+            policyPending = g_alertData.channel.debounce[CH_DIGITAL] > 0;
+            float dHigh = fabsf(digitalCond - DIGITAL_THRESHOLD_HIGH);
+            float dLow  = fabsf(digitalCond - DIGITAL_THRESHOLD_LOW);
+            policyDistance = (dHigh < dLow) ? dHigh : dLow;
+            xSemaphoreGive(xSensorMutex);
+        }
 
-            g_sensorData.readingCount++;
-            g_sensorData.timestamp = xTaskGetTickCount();
+        // ── 5. Queue the sample for Task 2 ──────────────────────────────
+        // Filled once into a block; the queue has a slot for every block.
+        RawSample_t *block = g_samplePool.allocate();
+        if (block != NULL) {
+            *block = sample;
+            xQueueSend(xReadingQueue, &block, 0);
+        } else {
+            s_acquisition.countOverrun();  // Reported with the next queued sample
+        }
+#if defined(LAB3_2_TRACE_CAPTURE)
+        sensorTraceCapture(sample);  // Dropped samples too: the trace is what the sensors gave
+#endif
 
-            xSemaphoreGive(xSensorMutex);
+        // ── 6. NTC calibration and the DS18B20 interval ─────────────────
+        // Pairs only when the DS18B20 value is new. A quiet signal lets a
+        // calibrated NTC carry it alone between rarer DS18B20 readings;
+        // any movement, a pending digital alert or a nearby threshold
+        // brings the full rate back at once.
+        if (ds18b20Found) {
+            bool quiet = fabsf(policyRate) < DS18B20_FAST_RATE_C_PER_S && !policyPending &&
+                         !(policyDistance < DS18B20_NEAR_BAND_C);
+            s_acquisition.setMinIntervalMs(CH_DIGITAL, ntcCalibrationUpdate(ntc, sample, quiet));
         }
 
-        // ── 4. Notify Task 2 that new data is available ─────────────────
-        xSemaphoreGive(xNewReadingSemaphore);
+        // ── 7. Start the conversions due in this period ─────────────────
+        s_acquisition.requestDue(period);
     }
 }
@@ -7,12 +7,12 @@
  * NTC thermistor (via ADC) and the digital DS18B20 sensor (via OneWire).
  *
  * Data flow:
- *   ADC / OneWire → sensor drivers → g_sensorData (mutex) → semaphore give
+ *   ADC / OneWire → sensor drivers → RawSample_t → reading queue
  *
  * Task characteristics:
  *   Period:   50 ms (configurable via TASK_ACQUISITION_PERIOD_MS)
  *   Priority: 3 (highest — sensor reading must not be starved)
- *   Stack:    256 bytes
+ *   Stack:    320 bytes
  */
 
 #ifndef TASK_ACQUISITION_H
@@ -20,15 +20,36 @@
 
 #include <Arduino_FreeRTOS.h>
 
+/**
+ * @brief Initialize both sensors and start their first conversions.
+ *
+ * Call from setup() before the tasks are created: the DS18B20's first
+ * conversion (up to 750 ms at 12 bits) and the ADC engine then run while
+ * setup finishes and the display task initializes the LCD, and Task 1
+ * starts sampling without waiting for either. With -DLAB3_2_TRACE_REPLAY
+ * only the NTC conversion settings are initialized.
+ */
+void acquisitionStart();
+
 /**
  * @brief FreeRTOS task function for sensor acquisition.
  *
- * Periodically reads both temperature sensors, stores the raw and
- * converted values in g_sensorData under mutex protection, and gives
- * the binary semaphore to notify Task 2 (conditioning).
+ * Periodically reads both temperature sensors and queues the raw and
+ * converted values, timestamped, to Task 2 (conditioning); a full queue
+ * drops the sample and counts an overrun.
  *
  * @param pvParameters Unused (NULL).
  */
 void vTaskAcquisition(void *pvParameters);
 
+#if defined(LAB3_2_SYNC_PULSE)
+/**
+ * @brief Switch to Task 1 now if a sync edge released it (idle hook).
+ *
+ * The edge's ISR only readies the task, which would otherwise run at the
+ * next tick, up to 16 ms later and at a different moment on each node.
+ */
+void acquisitionSyncYield();
+#endif
+
 #endif // TASK_ACQUISITION_H
@@ -11,15 +11,37 @@
  * Processing sequence (each event)
  * ──────────────────────────────────────────────────────────────────────────
  *
- *   1. Take binary semaphore (block until Task 1 signals)
- *   2. Acquire mutex → read raw temperatures from g_sensorData → release
- *   3. For each valid sensor:
- *      a. Run SignalConditioner.process(rawTemp) → conditioned value
- *         Pipeline: saturate → median filter → EWMA
- *      b. Feed conditioned value into ThresholdAlert.update()
- *   4. Acquire mutex → write conditioned values + alert states → release
+ *   1. Receive the next RawSample_t block from xReadingQueue (blocks
+ *      until Task 1 queues one; a backlog is worked off sample by sample)
+ *   2. Unpack the raw temperatures (no lock: the sample is a private copy)
+ *   3. Condition both sensors (SensorConditioning over SENSOR_CHANNELS):
+ *      a. One ConditionerBank.processAll() call runs every channel,
+ *         saturate → median filter → EWMA; invalid channels are reset.
+ *         With EWMA_ADAPTIVE the alpha follows the temperature slope
+ *         (One-Euro), so fast changes reach the alert FSM with less lag
+ *      b. Fuse both conditioned streams in a Kalman filter (the DS18B20
+ *         only when a new conversion arrived, aged by its latency)
+ *      c. One ThresholdAlertBank.updateAllAt() call runs the alert FSMs of
+ *         the analog, digital and fused values; its raised mask counts
+ *         new activations; every state change goes to the event log
+ *   4. Acquire mutex → write raw + conditioned values and alert states,
+ *      publish the reader snapshot → release; the block goes back to
+ *      g_samplePool
  *   5. Update LED indicators based on alert states
  *
+ * With -DLAB3_2_TRACE_REPLAY, step 4 is followed by the sample's TRACE
+ * line (sensor_trace.h); nothing else changes.
+ *
+ * With -DLAB3_2_HARD_TRIP, the analog comparator (ComparatorTrip.h) cuts
+ * the load and lights the red LED from its ISR; after step 3c this task
+ * logs the trip and, once the analog alert is NORMAL and the hold-off
+ * has passed, re-arms the comparator and switches the load back on.
+ *
+ * With -DLAB3_2_ADC_ALERTS, step 3c judges the analog channel on its raw
+ * ADC count, conditioned in integer math, against the thresholds mapped
+ * to counts (re-mapped when the NTC calibration changes); the °C value
+ * is still logged and fused.
+ *
  * LED mapping:
  *   GREEN LED  = system normal (both sensors below threshold)
  *   RED LED    = analog sensor alert active
@@ -28,193 +50,266 @@
 
 #include "task_conditioning.h"
 #include "sensor_data.h"
-#include "SignalConditioner.h"
-#include "ThresholdAlert.h"
-#include "Led.h"
+#include "sensor_trace.h"
+#include "KalmanFusion.h"
+#include "RtosTime.h"
+#if defined(LAB3_2_HARD_TRIP)
+#include "ComparatorTrip.h"
+#include <math.h>
+#endif
+#if defined(LAB3_2_ADC_ALERTS)
+#include "AnalogTempSensor.h"
+#include "FixedSignalConditioner.h"
+#endif
 
 // ──────────────────────────────────────────────────────────────────────────
-// Local signal conditioner instances (owned by this task)
+// Conditioning stage (owned by this task)
 // ──────────────────────────────────────────────────────────────────────────
 
-static SignalConditioner s_analogConditioner(MEDIAN_WINDOW_SIZE, EWMA_ALPHA,
-                                             SATURATION_MIN, SATURATION_MAX);
-
-static SignalConditioner s_digitalConditioner(MEDIAN_WINDOW_SIZE, EWMA_ALPHA,
-                                              SATURATION_MIN, SATURATION_MAX);
+// Both sensors share one structure-of-arrays conditioner bank and, with
+// the fused channel, one alert bank, each updated in one call.
+static SensorConditioning<SENSOR_CHANNEL_COUNT, MEDIAN_WINDOW_SIZE, ALERT_CHANNEL_COUNT>
+    s_conditioning(SENSOR_CHANNELS, &g_normalLed);
 
 // ──────────────────────────────────────────────────────────────────────────
-// Local alert instances (owned by this task)
+// Local sensor fusion (owned by this task)
 // ──────────────────────────────────────────────────────────────────────────
 
-static ThresholdAlert s_analogAlert(ANALOG_THRESHOLD_HIGH,
-                                    ANALOG_THRESHOLD_LOW,
-                                    ALERT_DEBOUNCE_COUNT);
-
-static ThresholdAlert s_digitalAlert(DIGITAL_THRESHOLD_HIGH,
-                                     DIGITAL_THRESHOLD_LOW,
-                                     ALERT_DEBOUNCE_COUNT);
+static KalmanFusion s_fusion(FUSION_PROCESS_NOISE, FUSION_INIT_RATE_VAR);
 
+#if defined(LAB3_2_ADC_ALERTS)
 // ──────────────────────────────────────────────────────────────────────────
-// Local LED instances
+// ADC-domain analog alert (integer conditioning, limits in counts)
 // ──────────────────────────────────────────────────────────────────────────
 
-static Led s_greenLed(PIN_LED_GREEN);
-static Led s_redLed(PIN_LED_RED);
-static Led s_yellowLed(PIN_LED_YELLOW);
+static FixedSignalConditioner s_adcConditioner(MEDIAN_WINDOW_SIZE, ADC_ALERT_ALPHA_SHIFT,
+                                               ADC_ALERT_MIN_COUNTS, ADC_ALERT_MAX_COUNTS);
+static float s_adcBeta = 0.0f;       ///< Calibration the count limits were mapped with
+static float s_adcNominalR = 0.0f;
+
+/**
+ * @brief Map the analog thresholds to counts if the calibration changed.
+ *
+ * Task 1 recalibrates; a value torn by that is mapped again on the next
+ * sample. The FSM keeps its state across a re-map.
+ */
+static void adcAlertLimits() {
+    const AnalogTempSensor &ntc = *SENSOR_CHANNELS[CH_ANALOG].ntc;
+    float beta = ntc.getBeta();
+    float nominalR = ntc.getNominalResistance();
+    if (beta == s_adcBeta && nominalR == s_adcNominalR) {
+        return;
+    }
+    s_adcBeta = beta;
+    s_adcNominalR = nominalR;
+    s_conditioning.alerts().configureCounts(CH_ANALOG,
+                                            ntc.rawAtTemperatureC(ANALOG_THRESHOLD_HIGH),
+                                            ntc.rawAtTemperatureC(ANALOG_THRESHOLD_LOW));
+}
+
+/** @brief Conditioned count of the analog channel (its window reset while invalid). */
+static int32_t adcAlertCounts(const RawSample_t &sample) {
+    if (!sample.valid[CH_ANALOG]) {
+        s_adcConditioner.reset();
+        return 0;   // Not judged: the NaN °C value resets the channel
+    }
+    return s_adcConditioner.process(sample.raw[CH_ANALOG]);
+}
+#endif
 
+#if defined(LAB3_2_HARD_TRIP)
 // ──────────────────────────────────────────────────────────────────────────
-// Task function
+// Hard over-temperature trip (the comparator ISR cuts, this task hands back)
 // ──────────────────────────────────────────────────────────────────────────
 
-void vTaskConditioning(void *pvParameters) {
-    (void)pvParameters;
-
-    // Initialize alert modules and LEDs.
-    s_analogAlert.init();
-    s_digitalAlert.init();
-    s_greenLed.init();
-    s_redLed.init();
-    s_yellowLed.init();
+static_assert(ALERT_LOG_CH_HARD_TRIP == ALERT_CHANNEL_COUNT,
+              "the trip log channel follows the alert channels");
 
-    // Start with green LED on (system normal).
-    s_greenLed.turnOn();
-    s_redLed.turnOff();
-    s_yellowLed.turnOff();
+/** The load off, the red LED on. */
+static const ComparatorTripOutput HARD_TRIP_OUTPUTS[] = {
+    { PIN_LOAD_ENABLE, LOW },
+    { PIN_LED_RED,     HIGH },
+};
 
-    // Local copies of sensor readings (avoid holding mutex during processing).
-    float analogTemp;
-    float digitalTemp;
-    bool  analogValid;
-    bool  digitalValid;
+static bool s_tripLogged = false;   ///< The current trip has been logged.
 
-    // Track previous alert states for transition counting.
-    AlertState prevAnalogState  = ALERT_NORMAL;
-    AlertState prevDigitalState = ALERT_NORMAL;
+float conditioningHardTripC(float referenceV) {
+    float rNtc = (float)NTC_SERIES_RESISTANCE * referenceV / (5.0f - referenceV);
+    float invT = 1.0f / (NTC_NOMINAL_TEMP_C + 273.15f) +
+                 logf(rNtc / (float)NTC_NOMINAL_RESISTANCE) / (float)NTC_BETA_COEFFICIENT;
+    return 1.0f / invT - 273.15f;
+}
 
-    // Conditioning pipeline intermediate results.
-    float analogConditioned  = 0.0f;
-    float digitalConditioned = 0.0f;
+static void hardTripInit() {
+    comparatorTripInit(HARD_TRIP_OUTPUTS, 2, COMPARATOR_TRIP_REF_BANDGAP,
+                       COMPARATOR_TRIP_BELOW);
+    if (!comparatorTripped()) {
+        digitalWrite(PIN_LOAD_ENABLE, HIGH);
+    }
+}
 
-    for (;;) {
-        // ── 1. Wait for new sensor data ─────────────────────────────────
-        if (xSemaphoreTake(xNewReadingSemaphore, portMAX_DELAY) != pdTRUE) {
-            continue;
-        }
+/**
+ * @brief Log a new trip; re-arm and restore the load once it is over.
+ *
+ * Re-arming waits for the soft path: the hold-off gives the analog alert
+ * FSM time to see the excursion, and the load stays off until that FSM
+ * is NORMAL and the comparator no longer sees the limit.
+ */
+static void hardTripService(uint32_t sampleMs, float analogC) {
+    if (!comparatorTripped()) {
+        return;
+    }
+    if (!s_tripLogged) {
+        s_tripLogged = true;
+        g_alertLog.record(sampleMs, ALERT_LOG_CH_HARD_TRIP,
+                          (uint8_t)((ALERT_NORMAL << 4) | ALERT_ACTIVE), analogC, true);
+        return;
+    }
+    if ((uint32_t)(millis() - comparatorTripTimeMs()) < HARD_TRIP_HOLDOFF_MS ||
+        s_conditioning.getState(CH_ANALOG) != ALERT_NORMAL || !comparatorTripArm()) {
+        return;
+    }
+    s_tripLogged = false;
+    digitalWrite(PIN_LOAD_ENABLE, HIGH);
+    g_alertLog.record(sampleMs, ALERT_LOG_CH_HARD_TRIP,
+                      (uint8_t)((ALERT_ACTIVE << 4) | ALERT_NORMAL), analogC, true);
+}
+#endif
 
-        // ── 2. Read raw sensor data under mutex ─────────────────────────
-        if (xSemaphoreTake(xSensorMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            analogTemp   = g_sensorData.analogTempRaw;
-            digitalTemp  = g_sensorData.digitalTempRaw;
-            analogValid  = g_sensorData.analogValid;
-            digitalValid = g_sensorData.digitalValid;
-            xSemaphoreGive(xSensorMutex);
-        } else {
-            continue;  // Could not acquire mutex — skip this cycle.
-        }
+// ──────────────────────────────────────────────────────────────────────────
+// Task function
+// ──────────────────────────────────────────────────────────────────────────
 
-        // ── 3. Apply signal conditioning pipeline ───────────────────────
-        AlertState analogState  = ALERT_NORMAL;
-        AlertState digitalState = ALERT_NORMAL;
+void vTaskConditioning(void *pvParameters) {
+    (void)pvParameters;
 
-        if (analogValid && !isnan(analogTemp)) {
-            analogConditioned = s_analogConditioner.process(analogTemp);
-            analogState = s_analogAlert.update(analogConditioned);
-        } else {
-            // Sensor invalid: flush stale window and reset alert FSM.
-            s_analogConditioner.reset();
-            s_analogAlert.init();
-            analogConditioned = NAN;
-        }
+    // Sensor channels from the table (per-sample adaptive alpha: the sample
+    // period is the acquisition period); green LED on (system normal).
+    s_conditioning.init(TASK_ACQUISITION_PERIOD_MS / 1000.0f);
+
+    // The fused channel, fed by this task.
+    ThresholdAlertBank<ALERT_CHANNEL_COUNT> &alerts = s_conditioning.alerts();
+    alerts.configure(ALERT_CH_FUSED, FUSED_THRESHOLD_HIGH, FUSED_THRESHOLD_LOW,
+                     ALERT_DEBOUNCE_COUNT);
+    alerts.configureDwell(ALERT_CH_FUSED, ALERT_RAISE_DWELL_MS, ALERT_CLEAR_DWELL_MS);
+    alerts.configureRate(ALERT_CH_FUSED, FUSED_RATE_TRIGGER_C_PER_S, FUSED_RATE_ARM_C,
+                         FUSED_RATE_WINDOW_MS);
+    alerts.setTraceId(ALERT_TRACE_ID_BASE);
+#if defined(LAB3_2_HARD_TRIP)
+    hardTripInit();
+#endif
+
+    RawSample_t *block = NULL;
+    TickType_t prevSampleTick = 0;
 
-        if (digitalValid && !isnan(digitalTemp)) {
-            digitalConditioned = s_digitalConditioner.process(digitalTemp);
-            digitalState = s_digitalAlert.update(digitalConditioned);
-        } else {
-            // Sensor invalid: flush stale window and reset alert FSM.
-            s_digitalConditioner.reset();
-            s_digitalAlert.init();
-            digitalConditioned = NAN;
+    for (;;) {
+        // ── 1. Wait for the next sample ─────────────────────────────────
+        // Worked on in its pool block, released after step 4.
+        if (xQueueReceive(xReadingQueue, &block, portMAX_DELAY) != pdTRUE) {
+            continue;
         }
-
-        // ── 4. Write conditioned values and alert status under mutex ────
-        if (xSemaphoreTake(xSensorMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            // Conditioning intermediates for analog sensor.
+        const RawSample_t &sample = *block;
+
+        // ── 2–3a. Apply signal conditioning pipeline ────────────────────
+        // Invalid (or NaN) channels are reset inside the bank and come
+        // back as NaN, flushing their stale window.
+        ChannelMask conditioned = s_conditioning.condition(sample);
+        const float *condOut = s_conditioning.conditioned();
+        bool analogValid  = (conditioned & (1U << CH_ANALOG)) != 0;
+        bool digitalValid = (conditioned & (1U << CH_DIGITAL)) != 0;
+        TickType_t sampleTick = sample.timestamp;
+
+        // ── 3b. Fuse both channels into one estimate ────────────────────
+        // Predict over the real time between acquisitions, then fold in
+        // each reading; the DS18B20 repeats its value between conversions,
+        // so only a fresh one is used, aged by its conversion latency.
+        if (analogValid || digitalValid) {
+            if (s_fusion.isInitialized()) {
+                TickType_t deltaTicks = sampleTick - prevSampleTick;
+                float dtS = ((float)deltaTicks * (float)portTICK_PERIOD_MS) / 1000.0f;
+                s_fusion.predict(dtS);
+            }
             if (analogValid) {
-                g_sensorData.analogMedian      = s_analogConditioner.getLastMedian();
-                g_sensorData.analogEwma        = s_analogConditioner.getLastEwma();
-                g_sensorData.analogConditioned = s_analogConditioner.isValid();
-            } else {
-                g_sensorData.analogMedian      = NAN;
-                g_sensorData.analogEwma        = NAN;
-                g_sensorData.analogConditioned = false;
+                s_fusion.update(condOut[CH_ANALOG], FUSION_ANALOG_VARIANCE);
             }
-
-            // Conditioning intermediates for digital sensor.
-            if (digitalValid) {
-                g_sensorData.digitalMedian      = s_digitalConditioner.getLastMedian();
-                g_sensorData.digitalEwma        = s_digitalConditioner.getLastEwma();
-                g_sensorData.digitalConditioned = s_digitalConditioner.isValid();
-            } else {
-                g_sensorData.digitalMedian      = NAN;
-                g_sensorData.digitalEwma        = NAN;
-                g_sensorData.digitalConditioned = false;
+            if (digitalValid && sample.fresh[CH_DIGITAL]) {
+                // Variance and age follow the resolution it was taken at
+                // (limited to the DS18B20's 9..12 bits: an unreported 0 reads as 9).
+                uint8_t bits = sample.resolution[CH_DIGITAL];
+                if (bits < 9) bits = 9;
+                if (bits > 12) bits = 12;
+                float lsb = 0.5f / (float)(1U << (bits - 9));
+                float variance = FUSION_DIGITAL_NOISE_VAR + lsb * lsb / 12.0f;
+                float ageS = sample.ageMs[CH_DIGITAL] / 1000.0f;
+                s_fusion.update(condOut[CH_DIGITAL], variance, ageS);
             }
-
-            // Alert status.
-            g_alertData.analogAlertState    = analogState;
-            g_alertData.analogDebounceCount = s_analogAlert.getDebounceCounter();
-            g_alertData.analogCondTemp      = analogConditioned;
-
-            g_alertData.digitalAlertState    = digitalState;
-            g_alertData.digitalDebounceCount = s_digitalAlert.getDebounceCounter();
-            g_alertData.digitalCondTemp      = digitalConditioned;
-
-            // Count new alert activations.
-            if (analogState == ALERT_ACTIVE && prevAnalogState != ALERT_ACTIVE) {
-                g_alertData.analogAlertCount++;
-            }
-            if (digitalState == ALERT_ACTIVE && prevDigitalState != ALERT_ACTIVE) {
-                g_alertData.digitalAlertCount++;
+        } else {
+            s_fusion.reset();  // No source left: restart from the next reading.
+        }
+        prevSampleTick = sampleTick;
+
+        // ── 3c. Alert FSMs of every channel in one pass ─────────────────
+        // NaN (invalid sensor, no estimate yet) resets that channel. Dwell
+        // times and the fused slope run on the acquisition timestamp.
+        float alertIn[ALERT_CHANNEL_COUNT] = { condOut[CH_ANALOG], condOut[CH_DIGITAL],
+                                               s_fusion.getEstimate() };
+        uint32_t sampleMs = (uint32_t)sampleTick * portTICK_PERIOD_MS;
+#if defined(LAB3_2_ADC_ALERTS)
+        adcAlertLimits();
+        int32_t alertCounts[ALERT_CHANNEL_COUNT] = { adcAlertCounts(sample), 0, 0 };
+        AlertBankMasks edges = s_conditioning.alertAll(alertIn, sampleMs, alertCounts);
+#else
+        AlertBankMasks edges = s_conditioning.alertAll(alertIn, sampleMs);
+#endif
+
+        // Log every state change; raising or clearing spills to EEPROM.
+        AlertMask changed = s_conditioning.changedMask();
+        for (uint8_t ch = 0; ch < ALERT_CHANNEL_COUNT; ch++) {
+            if (changed & (1U << ch)) {
+                bool edge = ((edges.raised | edges.cleared) & (1U << ch)) != 0;
+                g_alertLog.record(sampleMs, ch,
+                                  (uint8_t)((s_conditioning.getPreviousState(ch) << 4) |
+                                            s_conditioning.getState(ch)),
+                                  alertIn[ch], edge);
             }
-
+        }
+#if defined(LAB3_2_HARD_TRIP)
+        hardTripService(sampleMs, alertIn[CH_ANALOG]);
+#endif
+
+        // ── 4. Write sample, conditioned values and alerts under mutex ──
+        if (xSemaphoreTake(xSensorMutex, rtosMsToTicks(10)) == pdTRUE) {
+            g_sensorData.sample = sample;
+            s_conditioning.store(&g_sensorData.cond);
+
+            s_conditioning.storeAlerts(&g_alertData.channel);
+            g_alertData.fusedTemp     = alertIn[ALERT_CH_FUSED];
+            g_alertData.fusedVariance = s_fusion.getVariance();
+            g_alertData.fusedRate     = s_fusion.getRate();
             g_alertData.conditioningCycles++;
+#if defined(LAB3_2_HARD_TRIP)
+            g_alertData.hardTripped = comparatorTripped();
+            g_alertData.hardTrips   = comparatorTripCount();
+#endif
 
+            sensorSnapshotPublish();
             xSemaphoreGive(xSensorMutex);
         }
 
-        // Remember current states for next-cycle transition detection.
-        prevAnalogState  = analogState;
-        prevDigitalState = digitalState;
+#if defined(LAB3_2_TRACE_REPLAY)
+        sensorTraceReport(sample.sequence);
+#endif
+        g_samplePool.release(block);
 
         // ── 5. Update LED indicators ────────────────────────────────────
-        bool anyNonNormal = (analogState  != ALERT_NORMAL) ||
-                            (digitalState != ALERT_NORMAL);
-
-        // Green LED: ON only when both sensors are fully NORMAL.
-        if (anyNonNormal) {
-            s_greenLed.turnOff();
-        } else {
-            s_greenLed.turnOn();
-        }
-
-        // Red LED: ON when analog sensor alert is active.
-        if (analogState == ALERT_ACTIVE) {
-            s_redLed.turnOn();
-        } else if (analogState == ALERT_DEBOUNCE_HIGH ||
-                   analogState == ALERT_DEBOUNCE_LOW) {
-            s_redLed.toggle();
-        } else {
-            s_redLed.turnOff();
-        }
-
-        // Yellow LED: ON when digital sensor alert is active.
-        if (digitalState == ALERT_ACTIVE) {
-            s_yellowLed.turnOn();
-        } else if (digitalState == ALERT_DEBOUNCE_HIGH ||
-                   digitalState == ALERT_DEBOUNCE_LOW) {
-            s_yellowLed.toggle();
-        } else {
-            s_yellowLed.turnOff();
+        // Green: ON only when both sensors are fully NORMAL. Red / yellow:
+        // ON while the analog / digital alert is active, blinking while
+        // it debounces.
+        s_conditioning.updateLeds();
+#if defined(LAB3_2_HARD_TRIP)
+        if (comparatorTripped()) {
+            SENSOR_CHANNELS[CH_ANALOG].led->turnOn();   // As the ISR left it
         }
+#endif
     }
 }
@@ -3,17 +3,17 @@
  * @brief Lab 3.2 — Signal Conditioning & Alert Task Interface (Task 2)
  *
  * Declares the FreeRTOS task function for signal conditioning and alert
- * management. This task wakes on new sensor data (via semaphore), applies
+ * management. This task wakes on each queued sensor sample, applies
  * a three-stage conditioning pipeline (saturation → median → EWMA), then
  * feeds the conditioned values into the threshold alert FSM.
  *
  * Data flow:
- *   semaphore take → g_sensorData raw (mutex read) → SignalConditioner
- *   → ThresholdAlert FSM → g_sensorData conditioned + g_alertData (mutex write)
+ *   queue receive (RawSample_t) → SignalConditioner → ThresholdAlertBank
+ *   → g_sensorData raw + conditioned, g_alertData (mutex write), snapshot
  *   → LED control
  *
  * Task characteristics:
- *   Trigger:  Binary semaphore from Task 1
+ *   Trigger:  Reading queue from Task 1
  *   Priority: 2 (medium — responds to acquisition events)
  *   Stack:    256 bytes
  */
@@ -22,18 +22,31 @@
 #define TASK_CONDITIONING_H
 
 #include <Arduino_FreeRTOS.h>
+#if defined(LAB3_2_HARD_TRIP)
+#include "ComparatorTrip.h"
+#endif
 
 /**
  * @brief FreeRTOS task function for signal conditioning and alerting.
  *
- * Waits on the binary semaphore from Task 1, reads raw sensor data,
+ * Receives each sample queued by Task 1 (in order, none skipped),
  * applies the SignalConditioner pipeline (saturation, median filter,
- * EWMA) to each sensor independently, feeds the conditioned values
- * into the ThresholdAlert FSM, updates alert status, and drives
+ * EWMA) to each sensor independently, feeds the conditioned and fused
+ * values into one ThresholdAlertBank, updates alert status, and drives
  * the LED indicators.
  *
  * @param pvParameters Unused (NULL).
  */
 void vTaskConditioning(void *pvParameters);
 
+#if defined(LAB3_2_HARD_TRIP)
+/**
+ * @brief Temperature (°C) at which the NTC divider reaches referenceV.
+ *
+ * The hard trip point for the bandgap voltage (COMPARATOR_TRIP_BANDGAP_V,
+ * or its 1.0 / 1.2 V limits for the tolerance band).
+ */
+float conditioningHardTripC(float referenceV);
+#endif
+
 #endif // TASK_CONDITIONING_H
@@ -2,46 +2,102 @@
  * @file task_display.cpp
  * @brief Lab 3.2 — Display & Reporting Task Implementation (Task 3)
  *
- * Implements the periodic display and reporting task. Every 500 ms,
- * this task reads sensor data and alert status, updates the LCD with
- * a summary, and prints a structured report to the serial terminal
- * via STDIO printf that exposes all conditioning pipeline stages.
+ * Implements the display and reporting task. It sleeps until a
+ * published snapshot changes what the LCD shows (an EWMA value at the
+ * 0.1 °C shown, an alert cell), then redraws, at most every
+ * DISPLAY_REFRESH_MIN_MS; a steady temperature costs no wake-ups. Every
+ * 2 s the heartbeat steps the sparkline and prints a structured report to
+ * the serial terminal via STDIO printf that exposes all conditioning
+ * pipeline stages.
  *
  * ──────────────────────────────────────────────────────────────────────────
  * Display strategy
  * ──────────────────────────────────────────────────────────────────────────
  *
- * The 16x2 LCD alternates between two information pages every 2 seconds:
+ * A single page, so every value is visible at every refresh:
  *
- *   Page 0 — Current readings (conditioned EWMA values):
- *     Line 0: "A:25.3C  D:24.8C"
- *     Line 1: "System: OK" or "ALERT: Analog" / "ALERT: Digital" / "ALERT: A+D"
+ *     Line 0: "A:25.3 D:24.8 OK"    conditioned EWMA values; the last two
+ *                                   cells show "OK", or a bell glyph and
+ *                                   A / D / * (both) for active alerts
+ *     Line 1: "▂▃▃▄▅▆▆▇▇█▇ H 30"    sparkline of the fused estimate, one
+ *                                   bar per report (2 s, 22 s in view),
+ *                                   scaled from TL - 4 °C to TH (H 30)
  *
- *   Page 1 — Conditioning and threshold configuration:
- *     Line 0: "Med:5 Alpha:0.3"
- *     Line 1: "TH:30 TL:28 C"
+ * The bars use CGRAM slots 0..6 and the bell slot 7; LcdDisplay only
+ * rewrites CGRAM when a bitmap changes, so reloading them on every
+ * redraw is free. Line 0 is formatted only when the conditioning task
+ * marks a shown change, line 1 only on the heartbeat; a steady room
+ * costs one sparkline line per 2 s. The conditioning configuration
+ * formerly on a second page is in the STDIO report.
  *
  * ──────────────────────────────────────────────────────────────────────────
- * STDIO report format (every 2 seconds = every 4th display cycle)
+ * STDIO report format (every 2 seconds, the heartbeat)
  * ──────────────────────────────────────────────────────────────────────────
  *
- * Shows raw, median-filtered, and EWMA values for both sensors,
- * conditioning configuration, threshold settings, and statistics.
+ * Full (REPORT_COMPACT false, or "report full"): raw, median-filtered,
+ * and EWMA values for both sensors, conditioning configuration,
+ * threshold settings, and statistics, ~1.1 kB every report — most of
+ * 9600 baud for a report that rarely changes.
+ *
+ * Compact (REPORT_COMPACT true, or "report delta"): the configuration
+ * and thresholds once, then one DeltaReport line per heartbeat with the
+ * fields that moved beyond their epsilon, e.g.
+ *
+ *     aewma=25.36 readings=1240 ccycles=1240
+ *
+ * In a steady room that is the counters, ~40 bytes. "report" prints the
+ * configuration again and restates every field on the next line.
  */
 
 #include "task_display.h"
+#include "lab3_2_main.h"
 #include "sensor_data.h"
+#include "task_telemetry.h"
+#include "sensor_trace.h"
 
 #include "LcdDisplay.h"
+#include "FixedFormat.h"
+#include "StdioSerial.h"
+#include "DisplayRefresh.h"
+#include "DeltaReport.h"
+#include "FlashString.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#if defined(LAB3_2_HARD_TRIP)
+#include "task_conditioning.h"
+#endif
 
 // ──────────────────────────────────────────────────────────────────────────
 // Local LCD instance (owned by this task)
 // ──────────────────────────────────────────────────────────────────────────
 
 static LcdDisplay s_lcd(LCD_I2C_ADDRESS, LCD_COLS, LCD_ROWS);
+static DisplayRefresh s_refresh(DISPLAY_REFRESH_MIN_MS, DISPLAY_HEARTBEAT_MS);
+
+/** Wake-up reasons besides the heartbeat. */
+static const uint8_t DISPLAY_DIRTY_LCD    = 0x01;   ///< Line 0 changed
+static const uint8_t DISPLAY_DIRTY_REPORT = 0x02;   ///< "report" command
+
+/** Line 0 as shown; only taskDisplayNoteSnapshot() touches it. */
+struct ShownValues {
+    int16_t analogDeci;
+    int16_t digitalDeci;
+    bool analogAlert;
+    bool digitalAlert;
+};
+static ShownValues s_shown;
+
+/** CGRAM slot of the alert bell (slots 0..6 hold the sparkline bars). */
+static const uint8_t GLYPH_BELL = 7;
+static const uint8_t BELL_BITMAP[8] = {0x04, 0x0E, 0x0E, 0x0E, 0x1F, 0x00, 0x04, 0x00};
+
+/** Sparkline cells, one fused sample per STDIO report interval. */
+static const uint8_t SPARK_CELLS = 11;
+
+/** Sparkline scale: warning band in the upper part of the bar. */
+static const float SPARK_LOW_C = ANALOG_THRESHOLD_LOW - 4.0f;
+static const float SPARK_HIGH_C = ANALOG_THRESHOLD_HIGH;
 
 // ──────────────────────────────────────────────────────────────────────────
 // Helper: format a float temperature for LCD (5 chars: "XX.X" or "-X.X")
@@ -51,7 +107,29 @@ static void formatTemp(char *buf, size_t bufLen, float temp) {
     if (isnan(temp)) {
         strncpy(buf, " -- ", bufLen);
     } else {
-        dtostrf(temp, 4, 1, buf);
+        fmtFixed(buf, temp, 4, 1);
+    }
+}
+
+// Helper: alert cells for the LCD ("OK", or the bell and which channel).
+static void formatAlertCells(char *buf, const AlertStatus_t *alert) {
+    bool aAlert = (alert->channel.state[CH_ANALOG] == ALERT_ACTIVE);
+    bool dAlert = (alert->channel.state[CH_DIGITAL] == ALERT_ACTIVE);
+    if (!aAlert && !dAlert) {
+        strcpy(buf, "OK");
+        return;
+    }
+    buf[0] = LCD_GLYPH(GLYPH_BELL);
+    buf[1] = (aAlert && dAlert) ? '*' : (aAlert ? 'A' : 'D');
+    buf[2] = '\0';
+}
+
+// Helper: format an EWMA alpha ("0.14"), or "--" when the channel is invalid.
+static void formatAlpha(char *buf, size_t bufLen, float alpha) {
+    if (isnan(alpha)) {
+        strncpy(buf, "--", bufLen);
+    } else {
+        fmtFixed(buf, alpha, 4, 2);
     }
 }
 
@@ -69,6 +147,246 @@ static const char* alertFullLabel(AlertState state) {
     }
 }
 
+// ──────────────────────────────────────────────────────────────────────────
+// STDIO report sections
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Analog, digital and fused sections of the full report. */
+static void printReadings(const SensorSnapshot_t &snapshot) {
+    const SensorReadings_t &localSensor = snapshot.sensor;
+    const AlertStatus_t    &localAlert  = snapshot.alert;
+
+    // Format temperature strings (AVR printf does not support %f).
+    char aRawStr[8], aMedianStr[8], aEwmaStr[8];
+    char dRawStr[8], dMedianStr[8], dEwmaStr[8];
+    char aAlphaStr[8], dAlphaStr[8];
+    formatTemp(aRawStr,    sizeof(aRawStr),    localSensor.sample.tempC[CH_ANALOG]);
+    formatTemp(aMedianStr, sizeof(aMedianStr), localSensor.cond.median[CH_ANALOG]);
+    formatTemp(aEwmaStr,   sizeof(aEwmaStr),   localSensor.cond.ewma[CH_ANALOG]);
+    formatTemp(dRawStr,    sizeof(dRawStr),    localSensor.sample.tempC[CH_DIGITAL]);
+    formatTemp(dMedianStr, sizeof(dMedianStr), localSensor.cond.median[CH_DIGITAL]);
+    formatTemp(dEwmaStr,   sizeof(dEwmaStr),   localSensor.cond.ewma[CH_DIGITAL]);
+    formatAlpha(aAlphaStr, sizeof(aAlphaStr), localSensor.cond.alpha[CH_ANALOG]);
+    formatAlpha(dAlphaStr, sizeof(dAlphaStr), localSensor.cond.alpha[CH_DIGITAL]);
+
+    // ── Analog sensor section ───────────────────────────────────────────
+    FLASH_PRINTF("--- Analog (NTC) ---\r\n");
+    FLASH_PRINTF("  Raw ADC:     %u\r\n", localSensor.sample.raw[CH_ANALOG]);
+    char resStr[FMT_FIXED_BUF_SIZE];
+    fmtFixed(resStr, localSensor.sample.resistance[CH_ANALOG], 1, 0);
+    FLASH_PRINTF("  Resistance:  %s ohm\r\n", resStr);
+    FLASH_PRINTF("  Temperature: %s C (raw)\r\n", aRawStr);
+    FLASH_PRINTF("  After Median: %s C\r\n", aMedianStr);
+    FLASH_PRINTF("  After EWMA:  %s C (final)\r\n", aEwmaStr);
+    FLASH_PRINTF("  EWMA alpha:  %s\r\n", aAlphaStr);
+    FLASH_PRINTF("  Valid:       %s\r\n",
+                 localSensor.sample.valid[CH_ANALOG] ? "YES" : "NO");
+    FLASH_PRINTF("  Conditioned: %s\r\n",
+                 localSensor.cond.conditioned[CH_ANALOG] ? "YES" : "FILLING");
+    FLASH_PRINTF("  Alert State: %s",
+                 alertFullLabel(localAlert.channel.state[CH_ANALOG]));
+    if (localAlert.channel.state[CH_ANALOG] == ALERT_DEBOUNCE_HIGH ||
+        localAlert.channel.state[CH_ANALOG] == ALERT_DEBOUNCE_LOW) {
+        FLASH_PRINTF(" (%u readings)", localAlert.channel.debounce[CH_ANALOG]);
+    }
+    FLASH_PRINTF("\r\n");
+
+    // ── Digital sensor section ──────────────────────────────────────────
+    FLASH_PRINTF("--- Digital (DS18B20) ---\r\n");
+    FLASH_PRINTF("  Temperature: %s C (raw)\r\n", dRawStr);
+    FLASH_PRINTF("  After Median: %s C\r\n", dMedianStr);
+    FLASH_PRINTF("  After EWMA:  %s C (final)\r\n", dEwmaStr);
+    FLASH_PRINTF("  EWMA alpha:  %s\r\n", dAlphaStr);
+    FLASH_PRINTF("  Resolution:  %u bit (%u ms)\r\n",
+                 (unsigned)localSensor.sample.resolution[CH_DIGITAL],
+                 (unsigned)localSensor.sample.conversionMs[CH_DIGITAL]);
+    FLASH_PRINTF("  Valid:       %s\r\n",
+                 localSensor.sample.valid[CH_DIGITAL] ? "YES" : "NO");
+    FLASH_PRINTF("  Conditioned: %s\r\n",
+                 localSensor.cond.conditioned[CH_DIGITAL] ? "YES" : "FILLING");
+    FLASH_PRINTF("  Alert State: %s",
+                 alertFullLabel(localAlert.channel.state[CH_DIGITAL]));
+    if (localAlert.channel.state[CH_DIGITAL] == ALERT_DEBOUNCE_HIGH ||
+        localAlert.channel.state[CH_DIGITAL] == ALERT_DEBOUNCE_LOW) {
+        FLASH_PRINTF(" (%u readings)", localAlert.channel.debounce[CH_DIGITAL]);
+    }
+    FLASH_PRINTF("\r\n");
+
+    // ── Fused estimate section ──────────────────────────────────────────
+    FLASH_PRINTF("--- Fused (Kalman) ---\r\n");
+    char fTempStr[8], fSigmaStr[8], fRateStr[8];
+    formatTemp(fTempStr, sizeof(fTempStr), localAlert.fusedTemp);
+    fmtFixed(fSigmaStr, sqrtf(localAlert.fusedVariance), 4, 2);
+    fmtFixed(fRateStr, localAlert.fusedRate, 5, 2);
+    FLASH_PRINTF("  Estimate:    %s C (sigma %s)\r\n", fTempStr, fSigmaStr);
+    FLASH_PRINTF("  Slope:       %s C/s\r\n", fRateStr);
+    FLASH_PRINTF("  Alert State: %s",
+                 alertFullLabel(localAlert.channel.state[ALERT_CH_FUSED]));
+    if (localAlert.channel.state[ALERT_CH_FUSED] == ALERT_DEBOUNCE_HIGH ||
+        localAlert.channel.state[ALERT_CH_FUSED] == ALERT_DEBOUNCE_LOW) {
+        FLASH_PRINTF(" (%u readings)", localAlert.channel.debounce[ALERT_CH_FUSED]);
+    }
+    FLASH_PRINTF("\r\n");
+}
+
+/** @brief Conditioning configuration and thresholds (build constants). */
+static void printConfig() {
+    // ── Conditioning configuration ──────────────────────────────────────
+    FLASH_PRINTF("--- Conditioning Config ---\r\n");
+    FLASH_PRINTF("  Median Window: %u samples\r\n",
+                 (unsigned int)MEDIAN_WINDOW_SIZE);
+    if (EWMA_ADAPTIVE) {
+        char fcStr[8], betaStr[8];
+        fmtFixed(fcStr, EWMA_MIN_CUTOFF_HZ, 4, 2);
+        fmtFixed(betaStr, EWMA_BETA, 4, 2);
+        FLASH_PRINTF("  EWMA Alpha:   adaptive (fc %s Hz, beta %s)\r\n",
+                     fcStr, betaStr);
+    } else {
+        char alphaStr[6];
+        formatAlpha(alphaStr, sizeof(alphaStr), EWMA_ALPHA);
+        FLASH_PRINTF("  EWMA Alpha:   %s\r\n", alphaStr);
+    }
+    char satMinStr[8], satMaxStr[8];
+    fmtFixed(satMinStr, SATURATION_MIN, 4, 1);
+    fmtFixed(satMaxStr, SATURATION_MAX, 5, 1);
+    FLASH_PRINTF("  Saturation:   [%s, %s] C\r\n", satMinStr, satMaxStr);
+
+    // ── Thresholds ──────────────────────────────────────────────────────
+    FLASH_PRINTF("--- Thresholds ---\r\n");
+    char thAH[8], thAL[8];
+    fmtFixed(thAH, ANALOG_THRESHOLD_HIGH, 4, 1);
+    fmtFixed(thAL, ANALOG_THRESHOLD_LOW, 4, 1);
+    FLASH_PRINTF("  HIGH: %s C   LOW: %s C\r\n", thAH, thAL);
+    FLASH_PRINTF("  Dwell: raise %lu ms, clear %lu ms\r\n",
+                 (unsigned long)ALERT_RAISE_DWELL_MS,
+                 (unsigned long)ALERT_CLEAR_DWELL_MS);
+    if (FUSED_RATE_TRIGGER_C_PER_S > 0.0f) {
+        char rateStr[8], armStr[8];
+        fmtFixed(rateStr, FUSED_RATE_TRIGGER_C_PER_S, 4, 2);
+        fmtFixed(armStr, FUSED_RATE_ARM_C, 4, 1);
+        FLASH_PRINTF("  Fused rate trigger: > %s C/s above %s C\r\n", rateStr, armStr);
+    }
+#if defined(LAB3_2_HARD_TRIP)
+    char tripStr[8], tripLoStr[8], tripHiStr[8];
+    fmtFixed(tripStr, conditioningHardTripC(COMPARATOR_TRIP_BANDGAP_V), 4, 1);
+    fmtFixed(tripLoStr, conditioningHardTripC(1.2f), 4, 1);
+    fmtFixed(tripHiStr, conditioningHardTripC(1.0f), 4, 1);
+    FLASH_PRINTF("  Hard trip: %s C (%s..%s C), hold-off %lu ms\r\n", tripStr, tripLoStr,
+                 tripHiStr, (unsigned long)HARD_TRIP_HOLDOFF_MS);
+#endif
+}
+
+/** @brief Counters section of the full report. */
+static void printStatistics(const SensorSnapshot_t &snapshot) {
+    const SensorReadings_t &localSensor = snapshot.sensor;
+    const AlertStatus_t    &localAlert  = snapshot.alert;
+
+    // ── Statistics ──────────────────────────────────────────────────────
+    FLASH_PRINTF("--- Statistics ---\r\n");
+    FLASH_PRINTF("  Readings:        %lu\r\n",
+                 (unsigned long)localSensor.sample.sequence);
+    FLASH_PRINTF("  Queue overruns:  %lu\r\n",
+                 (unsigned long)localSensor.sample.overruns);
+    FLASH_PRINTF("  Sample pool:     %u of %u blocks at most\r\n",
+                 (unsigned)g_samplePool.highWater(), (unsigned)g_samplePool.capacity());
+    FLASH_PRINTF("  Conditioning:    %lu cycles\r\n",
+                 (unsigned long)localAlert.conditioningCycles);
+    FLASH_PRINTF("  Analog Alerts:   %lu\r\n",
+                 (unsigned long)localAlert.channel.count[CH_ANALOG]);
+    FLASH_PRINTF("  Digital Alerts:  %lu\r\n",
+                 (unsigned long)localAlert.channel.count[CH_DIGITAL]);
+    FLASH_PRINTF("  Fused Alerts:    %lu\r\n",
+                 (unsigned long)localAlert.channel.count[ALERT_CH_FUSED]);
+#if defined(LAB3_2_HARD_TRIP)
+    FLASH_PRINTF("  Hard Trips:      %u%s\r\n", (unsigned int)localAlert.hardTrips,
+                 localAlert.hardTripped ? " (load off)" : "");
+#endif
+    FLASH_PRINTF("  TX Dropped:      %lu chars\r\n",
+                 (unsigned long)stdioSerialGetTxDropped());
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Compact report (REPORT_COMPACT): changed fields only
+// ──────────────────────────────────────────────────────────────────────────
+
+/** What the compact report compares: the snapshot plus the serial counter. */
+struct ReportImage {
+    SensorSnapshot_t snapshot;
+    uint32_t         txDropped;
+};
+
+// States are AlertState values (0 NORMAL, 1 DEB_HI, 2 ALERT, 3 DEB_LO);
+// FIELD_U8 reads their low byte. Epsilons sit just above the noise of a
+// steady room, so a quiet report line is the counters.
+static const DeltaField REPORT_FIELDS[] PROGMEM = {
+    DELTA_FIELD("araw",     ReportImage, snapshot.sensor.sample.raw[CH_ANALOG],        FIELD_U16,   0, 2.0f),
+    DELTA_FIELD("ares",     ReportImage, snapshot.sensor.sample.resistance[CH_ANALOG], FIELD_FLOAT, 0, 50.0f),
+    DELTA_FIELD("atemp",    ReportImage, snapshot.sensor.sample.tempC[CH_ANALOG],      FIELD_FLOAT, 2, 0.1f),
+    DELTA_FIELD("amed",     ReportImage, snapshot.sensor.cond.median[CH_ANALOG],       FIELD_FLOAT, 2, 0.05f),
+    DELTA_FIELD("aewma",    ReportImage, snapshot.sensor.cond.ewma[CH_ANALOG],         FIELD_FLOAT, 2, 0.05f),
+    DELTA_FIELD("aalpha",   ReportImage, snapshot.sensor.cond.alpha[CH_ANALOG],        FIELD_FLOAT, 2, 0.02f),
+    DELTA_FIELD("avalid",   ReportImage, snapshot.sensor.sample.valid[CH_ANALOG],      FIELD_BOOL,  0, 0.0f),
+    DELTA_FIELD("acond",    ReportImage, snapshot.sensor.cond.conditioned[CH_ANALOG],  FIELD_BOOL,  0, 0.0f),
+    DELTA_FIELD("astate",   ReportImage, snapshot.alert.channel.state[CH_ANALOG],      FIELD_U8,    0, 0.0f),
+    DELTA_FIELD("adeb",     ReportImage, snapshot.alert.channel.debounce[CH_ANALOG],   FIELD_U8,    0, 0.0f),
+    DELTA_FIELD("dtemp",    ReportImage, snapshot.sensor.sample.tempC[CH_DIGITAL],     FIELD_FLOAT, 2, 0.1f),
+    DELTA_FIELD("dmed",     ReportImage, snapshot.sensor.cond.median[CH_DIGITAL],      FIELD_FLOAT, 2, 0.05f),
+    DELTA_FIELD("dewma",    ReportImage, snapshot.sensor.cond.ewma[CH_DIGITAL],        FIELD_FLOAT, 2, 0.05f),
+    DELTA_FIELD("dalpha",   ReportImage, snapshot.sensor.cond.alpha[CH_DIGITAL],       FIELD_FLOAT, 2, 0.02f),
+    DELTA_FIELD("dbits",    ReportImage, snapshot.sensor.sample.resolution[CH_DIGITAL], FIELD_U8,   0, 0.0f),
+    DELTA_FIELD("dvalid",   ReportImage, snapshot.sensor.sample.valid[CH_DIGITAL],     FIELD_BOOL,  0, 0.0f),
+    DELTA_FIELD("dcond",    ReportImage, snapshot.sensor.cond.conditioned[CH_DIGITAL], FIELD_BOOL,  0, 0.0f),
+    DELTA_FIELD("dstate",   ReportImage, snapshot.alert.channel.state[CH_DIGITAL],     FIELD_U8,    0, 0.0f),
+    DELTA_FIELD("ddeb",     ReportImage, snapshot.alert.channel.debounce[CH_DIGITAL],  FIELD_U8,    0, 0.0f),
+    DELTA_FIELD("ftemp",    ReportImage, snapshot.alert.fusedTemp,                     FIELD_FLOAT, 2, 0.05f),
+    DELTA_FIELD("fvar",     ReportImage, snapshot.alert.fusedVariance,                 FIELD_FLOAT, 4, 0.001f),
+    DELTA_FIELD("frate",    ReportImage, snapshot.alert.fusedRate,                     FIELD_FLOAT, 2, 0.01f),
+    DELTA_FIELD("fstate",   ReportImage, snapshot.alert.channel.state[ALERT_CH_FUSED], FIELD_U8,    0, 0.0f),
+    DELTA_FIELD("fdeb",     ReportImage, snapshot.alert.channel.debounce[ALERT_CH_FUSED], FIELD_U8, 0, 0.0f),
+    DELTA_FIELD("readings", ReportImage, snapshot.sensor.sample.sequence,              FIELD_U32,   0, 0.0f),
+    DELTA_FIELD("overruns", ReportImage, snapshot.sensor.sample.overruns,              FIELD_U32,   0, 0.0f),
+    DELTA_FIELD("ccycles",  ReportImage, snapshot.alert.conditioningCycles,            FIELD_U32,   0, 0.0f),
+    DELTA_FIELD("acnt",     ReportImage, snapshot.alert.channel.count[CH_ANALOG],      FIELD_U32,   0, 0.0f),
+    DELTA_FIELD("dcnt",     ReportImage, snapshot.alert.channel.count[CH_DIGITAL],     FIELD_U32,   0, 0.0f),
+    DELTA_FIELD("fcnt",     ReportImage, snapshot.alert.channel.count[ALERT_CH_FUSED], FIELD_U32,   0, 0.0f),
+    DELTA_FIELD("txdrop",   ReportImage, txDropped,                                    FIELD_U32,   0, 0.0f),
+#if defined(LAB3_2_HARD_TRIP)
+    DELTA_FIELD("trip",     ReportImage, snapshot.alert.hardTripped,                   FIELD_BOOL,  0, 0.0f),
+    DELTA_FIELD("trips",    ReportImage, snapshot.alert.hardTrips,                     FIELD_U16,   0, 0.0f),
+#endif
+};
+
+static DeltaReport s_delta;
+
+/** Compact or full heartbeat report; written by taskDisplaySetCompact(). */
+static volatile bool s_compact = REPORT_COMPACT;
+
+void taskDisplayRequestReport() {
+    s_refresh.mark(DISPLAY_DIRTY_REPORT);
+}
+
+void taskDisplaySetCompact(bool compact) {
+    s_compact = compact;
+    s_refresh.mark(DISPLAY_DIRTY_REPORT);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Change detection (conditioning task)
+// ──────────────────────────────────────────────────────────────────────────
+
+void taskDisplayNoteSnapshot(const SensorSnapshot_t &snap) {
+    ShownValues now;
+    now.analogDeci = displayRefreshQuantize(snap.sensor.cond.ewma[CH_ANALOG], 0.1f);
+    now.digitalDeci = displayRefreshQuantize(snap.sensor.cond.ewma[CH_DIGITAL], 0.1f);
+    now.analogAlert = (snap.alert.channel.state[CH_ANALOG] == ALERT_ACTIVE);
+    now.digitalAlert = (snap.alert.channel.state[CH_DIGITAL] == ALERT_ACTIVE);
+    if (now.analogDeci != s_shown.analogDeci || now.digitalDeci != s_shown.digitalDeci ||
+        now.analogAlert != s_shown.analogAlert || now.digitalAlert != s_shown.digitalAlert) {
+        s_shown = now;
+        s_refresh.mark(DISPLAY_DIRTY_LCD);
+    }
+}
+
 // ──────────────────────────────────────────────────────────────────────────
 // Task function
 // ──────────────────────────────────────────────────────────────────────────
@@ -79,169 +397,115 @@ void vTaskDisplay(void *pvParameters) {
     // Initialize the LCD display.
     s_lcd.init();
     s_lcd.backlight(true);
-    s_lcd.showTwoLines("Lab 3.2 CondPipe", "Initializing...");
-
-    // Allow sensors and conditioning pipeline to stabilize.
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    s_lcd.showTwoLines_P(PSTR("Lab 3.2 CondPipe"), PSTR("Initializing..."));
 
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS);
+    // The sensors have been converting since setup(), and Tasks 1 and 2
+    // run while the banner drains; the first report follows it.
+    if (!SENSOR_TRACE_ACTIVE) {
+        lab3_2PrintBanner();
+    }
 
-    // LCD page alternation counter (switch every 4 cycles = 2 seconds).
-    uint8_t displayCycle = 0;
+    s_refresh.bind();
+    deltaReportInit(&s_delta, REPORT_FIELDS, sizeof(REPORT_FIELDS) / sizeof(REPORT_FIELDS[0]));
     uint32_t reportNumber = 0;
+    bool configShown = false;
 
-    // STDIO report interval: every 4 display cycles (2 seconds).
-    static const uint8_t REPORT_INTERVAL = 4;
-
-    // Local copies of shared data.
-    SensorReadings_t localSensor;
-    AlertStatus_t    localAlert;
+    // Local copy of shared data (inside the compact report image).
+    ReportImage image;
+    SensorSnapshot_t &snapshot = image.snapshot;
+    const SensorReadings_t &localSensor = snapshot.sensor;
+    const AlertStatus_t    &localAlert  = snapshot.alert;
 
+    // Render cache: each line is formatted only when its inputs change,
+    // line 0 on a DISPLAY_DIRTY_LCD mark, line 1 (the sparkline) on the
+    // heartbeat; a wake-up for the report alone leaves the LCD alone.
     char line0[17];  // LCD line buffer (16 chars + null)
     char line1[17];
+    bool line0Rendered = false;
+
+    // Fused-estimate history for the sparkline, oldest first.
+    float sparkHistory[SPARK_CELLS];
+    for (uint8_t i = 0; i < SPARK_CELLS; i++) {
+        sparkHistory[i] = NAN;
+    }
+
+    char thH[6];
+    fmtFixed(thH, SPARK_HIGH_C, 3, 0);
 
     for (;;) {
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);
-        displayCycle++;
-
-        // ── Read shared data under mutex ────────────────────────────────
-        if (xSemaphoreTake(xSensorMutex, pdMS_TO_TICKS(20)) == pdTRUE) {
-            memcpy(&localSensor, &g_sensorData, sizeof(SensorReadings_t));
-            memcpy(&localAlert,  &g_alertData,  sizeof(AlertStatus_t));
-            xSemaphoreGive(xSensorMutex);
-        } else {
-            continue;  // Skip this cycle if mutex unavailable.
+        // The first heartbeat comes at once: the initial draw, sparkline
+        // step and report.
+        uint8_t why = s_refresh.wait();
+        bool heartbeat = (why & DISPLAY_REFRESH_HEARTBEAT) != 0;
+        bool requested = (why & DISPLAY_DIRTY_REPORT) != 0;
+
+        // ── Read shared data (lock-free snapshot) ───────────────────────
+        g_sensorSnapshot.read(snapshot);
+
+        // ── Update LCD display (render cache) ───────────────────────────
+        bool renderLine0 = !line0Rendered || (why & DISPLAY_DIRTY_LCD) != 0;
+        if (renderLine0) {
+            char aTemp[8], dTemp[8], alertCells[3];
+            formatTemp(aTemp, sizeof(aTemp), localSensor.cond.ewma[CH_ANALOG]);
+            formatTemp(dTemp, sizeof(dTemp), localSensor.cond.ewma[CH_DIGITAL]);
+            formatAlertCells(alertCells, &localAlert);
+            FLASH_SNPRINTF(line0, sizeof(line0), "A:%s D:%s %s", aTemp, dTemp, alertCells);
+            line0Rendered = true;
         }
 
-        // ── Update LCD display ──────────────────────────────────────────
-        uint8_t page = (displayCycle / 4) % 2;
-
-        if (page == 0) {
-            // Page 0: Current conditioned readings and alert status.
-            char aTemp[8], dTemp[8];
-            formatTemp(aTemp, sizeof(aTemp), localSensor.analogEwma);
-            formatTemp(dTemp, sizeof(dTemp), localSensor.digitalEwma);
-
-            snprintf(line0, sizeof(line0), "A:%sC D:%sC", aTemp, dTemp);
-
-            bool aAlert = (localAlert.analogAlertState == ALERT_ACTIVE);
-            bool dAlert = (localAlert.digitalAlertState == ALERT_ACTIVE);
-
-            if (aAlert && dAlert) {
-                snprintf(line1, sizeof(line1), "ALERT: A+D");
-            } else if (aAlert) {
-                snprintf(line1, sizeof(line1), "ALERT: Analog");
-            } else if (dAlert) {
-                snprintf(line1, sizeof(line1), "ALERT: Digital");
-            } else {
-                snprintf(line1, sizeof(line1), "System: OK");
-            }
-        } else {
-            // Page 1: Conditioning config and thresholds.
-            char alphaStr[6];
-            dtostrf(EWMA_ALPHA, 3, 1, alphaStr);
-            snprintf(line0, sizeof(line0), "Med:%u Alpha:%s",
-                     (unsigned int)MEDIAN_WINDOW_SIZE, alphaStr);
-
-            char thH[6], thL[6];
-            dtostrf(ANALOG_THRESHOLD_HIGH, 3, 0, thH);
-            dtostrf(ANALOG_THRESHOLD_LOW,  3, 0, thL);
-            snprintf(line1, sizeof(line1), "TH:%s TL:%s C", thH, thL);
+        if (heartbeat) {
+            memmove(&sparkHistory[0], &sparkHistory[1],
+                    (SPARK_CELLS - 1) * sizeof(sparkHistory[0]));
+            sparkHistory[SPARK_CELLS - 1] = localAlert.fusedTemp;
+
+            char spark[SPARK_CELLS + 1];
+            LcdDisplay::formatSparkline(spark, sparkHistory, SPARK_CELLS,
+                                        SPARK_LOW_C, SPARK_HIGH_C);
+            FLASH_SNPRINTF(line1, sizeof(line1), "%s H%s", spark, thH);
+        }
+
+        if (renderLine0 || heartbeat) {
+            s_lcd.loadVBarGlyphs();
+            s_lcd.setGlyph(GLYPH_BELL, BELL_BITMAP);
+            s_lcd.showTwoLines(line0, line1);
+        }
+
+        // ── STDIO report (heartbeat, or the "report" commands) ────────
+        // In binary mode the telemetry task owns the serial link instead,
+        // in a trace mode the sensor trace (sensor_trace.h). Subscribed
+        // fields replace the periodic report, not a requested one.
+        if (TELEMETRY_BINARY || SENSOR_TRACE_ACTIVE) {
+            continue;
+        }
+        bool periodic = heartbeat && !taskTelemetryHasSubscribers();
+        if (!periodic && !requested) {
+            continue;
+        }
+        reportNumber++;
+
+        if (!s_compact) {
+            FLASH_PRINTF("\r\n");
+            FLASH_PRINTF("====== SENSOR REPORT #%lu ======\r\n",
+                         (unsigned long)reportNumber);
+            printReadings(snapshot);
+            printConfig();
+            printStatistics(snapshot);
+            FLASH_PRINTF("================================\r\n");
+            deltaReportForce(&s_delta);
+            continue;
         }
 
-        s_lcd.showTwoLines(line0, line1);
-
-        // ── Structured STDIO report (every 2 seconds) ──────────────────
-        if ((displayCycle % REPORT_INTERVAL) == 0) {
-            reportNumber++;
-
-            // Format temperature strings (AVR printf does not support %f).
-            char aRawStr[8], aMedianStr[8], aEwmaStr[8];
-            char dRawStr[8], dMedianStr[8], dEwmaStr[8];
-            formatTemp(aRawStr,    sizeof(aRawStr),    localSensor.analogTempRaw);
-            formatTemp(aMedianStr, sizeof(aMedianStr), localSensor.analogMedian);
-            formatTemp(aEwmaStr,   sizeof(aEwmaStr),   localSensor.analogEwma);
-            formatTemp(dRawStr,    sizeof(dRawStr),    localSensor.digitalTempRaw);
-            formatTemp(dMedianStr, sizeof(dMedianStr), localSensor.digitalMedian);
-            formatTemp(dEwmaStr,   sizeof(dEwmaStr),   localSensor.digitalEwma);
-
-            printf("\r\n");
-            printf("====== SENSOR REPORT #%lu ======\r\n",
-                   (unsigned long)reportNumber);
-
-            // ── Analog sensor section ───────────────────────────────────
-            printf("--- Analog (NTC) ---\r\n");
-            printf("  Raw ADC:     %u\r\n", localSensor.analogRaw);
-            char resStr[10];
-            dtostrf(localSensor.analogResistance, 1, 0, resStr);
-            printf("  Resistance:  %s ohm\r\n", resStr);
-            printf("  Temperature: %s C (raw)\r\n", aRawStr);
-            printf("  After Median: %s C\r\n", aMedianStr);
-            printf("  After EWMA:  %s C (final)\r\n", aEwmaStr);
-            printf("  Valid:       %s\r\n",
-                   localSensor.analogValid ? "YES" : "NO");
-            printf("  Conditioned: %s\r\n",
-                   localSensor.analogConditioned ? "YES" : "FILLING");
-            printf("  Alert State: %s",
-                   alertFullLabel(localAlert.analogAlertState));
-            if (localAlert.analogAlertState == ALERT_DEBOUNCE_HIGH ||
-                localAlert.analogAlertState == ALERT_DEBOUNCE_LOW) {
-                printf(" (%u/%u)",
-                       localAlert.analogDebounceCount, ALERT_DEBOUNCE_COUNT);
-            }
-            printf("\r\n");
-
-            // ── Digital sensor section ──────────────────────────────────
-            printf("--- Digital (DS18B20) ---\r\n");
-            printf("  Temperature: %s C (raw)\r\n", dRawStr);
-            printf("  After Median: %s C\r\n", dMedianStr);
-            printf("  After EWMA:  %s C (final)\r\n", dEwmaStr);
-            printf("  Valid:       %s\r\n",
-                   localSensor.digitalValid ? "YES" : "NO");
-            printf("  Conditioned: %s\r\n",
-                   localSensor.digitalConditioned ? "YES" : "FILLING");
-            printf("  Alert State: %s",
-                   alertFullLabel(localAlert.digitalAlertState));
-            if (localAlert.digitalAlertState == ALERT_DEBOUNCE_HIGH ||
-                localAlert.digitalAlertState == ALERT_DEBOUNCE_LOW) {
-                printf(" (%u/%u)",
-                       localAlert.digitalDebounceCount, ALERT_DEBOUNCE_COUNT);
-            }
-            printf("\r\n");
-
-            // ── Conditioning configuration ──────────────────────────────
-            printf("--- Conditioning Config ---\r\n");
-            printf("  Median Window: %u samples\r\n",
-                   (unsigned int)MEDIAN_WINDOW_SIZE);
-            char alphaStr[6];
-            dtostrf(EWMA_ALPHA, 3, 1, alphaStr);
-            printf("  EWMA Alpha:   %s\r\n", alphaStr);
-            char satMinStr[8], satMaxStr[8];
-            dtostrf(SATURATION_MIN, 4, 1, satMinStr);
-            dtostrf(SATURATION_MAX, 5, 1, satMaxStr);
-            printf("  Saturation:   [%s, %s] C\r\n", satMinStr, satMaxStr);
-
-            // ── Thresholds ──────────────────────────────────────────────
-            printf("--- Thresholds ---\r\n");
-            char thAH[8], thAL[8];
-            dtostrf(ANALOG_THRESHOLD_HIGH, 4, 1, thAH);
-            dtostrf(ANALOG_THRESHOLD_LOW,  4, 1, thAL);
-            printf("  HIGH: %s C   LOW: %s C\r\n", thAH, thAL);
-            printf("  Debounce: %u confirmations\r\n",
-                   (unsigned int)ALERT_DEBOUNCE_COUNT);
-
-            // ── Statistics ──────────────────────────────────────────────
-            printf("--- Statistics ---\r\n");
-            printf("  Readings:        %lu\r\n",
-                   (unsigned long)localSensor.readingCount);
-            printf("  Conditioning:    %lu cycles\r\n",
-                   (unsigned long)localAlert.conditioningCycles);
-            printf("  Analog Alerts:   %lu\r\n",
-                   (unsigned long)localAlert.analogAlertCount);
-            printf("  Digital Alerts:  %lu\r\n",
-                   (unsigned long)localAlert.digitalAlertCount);
-            printf("================================\r\n");
+        // Compact: the configuration only at start and on request, then
+        // the fields that moved since they were last printed.
+        if (requested || !configShown) {
+            configShown = true;
+            FLASH_PRINTF("\r\n====== SENSOR CONFIG ======\r\n");
+            printConfig();
+            FLASH_PRINTF("  States: 0 NORMAL, 1 DEB_HI, 2 ALERT, 3 DEB_LO\r\n");
+            FLASH_PRINTF("===========================\r\n");
+            deltaReportForce(&s_delta);
         }
+        image.txDropped = stdioSerialGetTxDropped();
+        deltaReportPoll(&s_delta, &image);
     }
 }
@@ -3,16 +3,17 @@
  * @brief Lab 3.2 — Display & Reporting Task Interface (Task 3)
  *
  * Declares the FreeRTOS task function for periodic display update and
- * structured STDIO reporting. This task runs at 500 ms intervals and
- * presents temperature readings (raw and conditioned), alert states,
+ * structured STDIO reporting. This task sleeps until the snapshot
+ * changes what the LCD shows (DisplayRefresh), and presents temperature readings (raw and conditioned), alert states,
  * conditioning configuration, and system statistics on both the LCD
  * display and the serial terminal.
  *
  * Data flow:
- *   g_sensorData + g_alertData (mutex read) → LCD display + STDIO printf
+ *   g_sensorSnapshot (lock-free read) → LCD display + STDIO printf
  *
  * Task characteristics:
- *   Period:   500 ms (configurable via TASK_DISPLAY_PERIOD_MS)
+ *   Trigger:  a shown change (at most every DISPLAY_REFRESH_MIN_MS),
+ *             and a DISPLAY_HEARTBEAT_MS heartbeat for the report
  *   Priority: 1 (lowest — display can tolerate jitter)
  *   Stack:    512 bytes (printf requires more stack)
  */
@@ -21,21 +22,44 @@
 #define TASK_DISPLAY_H
 
 #include <Arduino_FreeRTOS.h>
+#include "sensor_data.h"
+
+/**
+ * @brief Wake the display task if @p snap changes what the LCD shows
+ *        (EWMA values at 0.1 °C, alert cells).
+ *
+ * Called by sensorSnapshotPublish(), i.e. by its single writer.
+ */
+void taskDisplayNoteSnapshot(const SensorSnapshot_t &snap);
+
+/**
+ * @brief Print a report now: the full one, or in compact mode the
+ *        configuration followed by every field (task context).
+ */
+void taskDisplayRequestReport();
+
+/**
+ * @brief Switch the heartbeat report between compact (changed fields
+ *        only) and full, and print one in the new mode (task context).
+ */
+void taskDisplaySetCompact(bool compact);
 
 /**
  * @brief FreeRTOS task function for display and reporting.
  *
- * Periodically reads sensor data and alert status under mutex,
- * formats the data for the LCD (2 lines alternating), and prints
+ * On each change reads sensor data and alert status under mutex,
+ * formats the data for the LCD (one page), and prints
  * a structured report to STDIO via printf that includes all
  * conditioning pipeline intermediate values.
  *
- * LCD display alternates between:
- *   Page 0: "A:XX.XC D:XX.XC" / "System: OK" or alerts
- *   Page 1: "Med:5 Alpha:0.3" / "TH:30 TL:28"
+ * LCD page:
+ *   "A:XX.X D:XX.X OK" (or bell + A, D or * on alert)
+ *   fused-temperature sparkline (CGRAM bars) + high threshold
  *
  * STDIO report includes raw values, median-filtered values, EWMA
- * values, conditioning configuration, alert states, and statistics.
+ * values, conditioning configuration, alert states, and statistics;
+ * in compact mode (REPORT_COMPACT) only the values that changed, with
+ * the configuration printed once and on request.
  *
  * @param pvParameters Unused (NULL).
  */
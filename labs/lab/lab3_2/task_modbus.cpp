@@ -0,0 +1,119 @@
+/**
+ * @file task_modbus.cpp
+ * @brief Lab 3.2 — Modbus RTU Slave Task Implementation
+ *
+ * The snapshot is read into a static copy (like sensor_trace.cpp's), so
+ * the ~150-byte struct is not on this task's stack. With
+ * -DLAB3_2_TIME_SYNC the copy also carries the sample's time converted
+ * to the gateway's timebase at the request.
+ */
+
+#include "task_modbus.h"
+#include "FlashString.h"
+
+#if defined(LAB3_2_MODBUS)
+
+#include "sensor_data.h"
+#include "TaskSignal.h"
+#if defined(LAB3_2_TIME_SYNC)
+#include "TimeSync.h"
+#endif
+#include <stdio.h>
+
+/** Register image: the snapshot, and what the node knows of the gateway's clock. */
+typedef struct {
+    SensorSnapshot_t snap;
+#if defined(LAB3_2_TIME_SYNC)
+    uint32_t sampleSharedUs;   /**< snap sample time, gateway micros(). */
+    uint8_t  syncState;        /**< TimeSyncState.                      */
+    float    driftPpm;         /**< Gateway clock vs this node's.       */
+#endif
+} ModbusImage_t;
+
+#define SNAP_INPUT(address, member, type, scale) \
+    MODBUS_INPUT(address, ModbusImage_t, snap.member, type, scale)
+
+static const ModbusRegister REGISTERS[] PROGMEM = {
+    SNAP_INPUT(0,  sensor.sample.tempC[CH_ANALOG],       MODBUS_FLOAT, 100),
+    SNAP_INPUT(1,  sensor.cond.ewma[CH_ANALOG],          MODBUS_FLOAT, 100),
+    SNAP_INPUT(2,  sensor.sample.valid[CH_ANALOG],       MODBUS_BOOL,  1),
+    SNAP_INPUT(3,  sensor.sample.raw[CH_ANALOG],         MODBUS_U16,   1),
+    SNAP_INPUT(4,  sensor.sample.tempC[CH_DIGITAL],      MODBUS_FLOAT, 100),
+    SNAP_INPUT(5,  sensor.cond.ewma[CH_DIGITAL],         MODBUS_FLOAT, 100),
+    SNAP_INPUT(6,  sensor.sample.valid[CH_DIGITAL],      MODBUS_BOOL,  1),
+    SNAP_INPUT(7,  alert.fusedTemp,                      MODBUS_FLOAT, 100),
+    SNAP_INPUT(8,  alert.fusedRate,                      MODBUS_FLOAT, 1000),
+    SNAP_INPUT(9,  alert.channel.state[CH_ANALOG],       MODBUS_ENUM,  1),
+    SNAP_INPUT(10, alert.channel.state[CH_DIGITAL],      MODBUS_ENUM,  1),
+    SNAP_INPUT(11, alert.channel.state[ALERT_CH_FUSED],  MODBUS_ENUM,  1),
+    SNAP_INPUT(12, sensor.sample.sequence,               MODBUS_U32,   1),
+    SNAP_INPUT(14, sensor.sample.overruns,               MODBUS_U32,   1),
+    SNAP_INPUT(16, alert.channel.count[CH_ANALOG],       MODBUS_U32,   1),
+    SNAP_INPUT(18, alert.channel.count[CH_DIGITAL],      MODBUS_U32,   1),
+    SNAP_INPUT(20, alert.channel.count[ALERT_CH_FUSED],  MODBUS_U32,   1),
+#if defined(LAB3_2_TIME_SYNC)
+    MODBUS_INPUT(22, ModbusImage_t, sampleSharedUs,     MODBUS_U32,   1),
+    MODBUS_INPUT(24, ModbusImage_t, syncState,          MODBUS_U8,    1),
+    MODBUS_INPUT(25, ModbusImage_t, driftPpm,           MODBUS_FLOAT, 1),
+#endif
+};
+static const uint8_t REGISTER_COUNT = sizeof(REGISTERS) / sizeof(REGISTERS[0]);
+
+static ModbusRtu s_modbus;
+static TaskSignal s_frame;
+static ModbusImage_t s_image;
+#if defined(LAB3_2_TIME_SYNC)
+static TimeSyncSlave s_sync;
+#endif
+
+static void onFrame() {
+    s_frame.giveFromIsr();
+}
+
+void taskModbusInit() {
+#if defined(LAB3_2_TIME_SYNC)
+    timeSyncSlaveInit(&s_sync);
+#endif
+    modbusRtuInit(&s_modbus, REGISTERS, REGISTER_COUNT, MODBUS_NODE_ADDRESS, NULL, NULL);
+    if (!modbusSlaveBegin(MODBUS_BAUD, MODBUS_PARITY, MODBUS_NODE_ADDRESS, PIN_MODBUS_DE,
+                          onFrame)) {
+        FLASH_PRINTF("[ERROR] Modbus: %lu baud not available on USART%u\r\n",
+                     (unsigned long)MODBUS_BAUD, (unsigned)MODBUS_SLAVE_USART);
+    }
+}
+
+void vTaskModbus(void *pvParameters) {
+    (void)pvParameters;
+
+    s_frame.bind();
+
+    for (;;) {
+        // A frame the header cannot size is polled for its silence per tick.
+        s_frame.take(modbusSlaveReceiving() ? 1 : portMAX_DELAY);
+        uint8_t len = modbusSlaveFrame();
+        if (len == 0) {
+            continue;
+        }
+#if defined(LAB3_2_TIME_SYNC)
+        // Stamped by the RX ISR on the frame's last byte, however late this runs
+        if (timeSyncSlaveFrame(&s_sync, modbusSlaveBuffer(), len, modbusSlaveFrameUs())) {
+            modbusSlaveRelease();
+            continue;
+        }
+#endif
+        g_sensorSnapshot.read(s_image.snap);
+#if defined(LAB3_2_TIME_SYNC)
+        timeSyncToMaster(&s_sync, s_image.snap.sensor.sample.timeUs, &s_image.sampleSharedUs);
+        s_image.syncState = s_sync.state;
+        s_image.driftPpm = timeSyncDriftPpm(&s_sync);
+#endif
+        uint8_t reply = modbusRtuHandle(&s_modbus, modbusSlaveBuffer(), len, &s_image);
+        if (reply > 0) {
+            modbusSlaveSend(reply);
+        } else {
+            modbusSlaveRelease();
+        }
+    }
+}
+
+#endif // LAB3_2_MODBUS
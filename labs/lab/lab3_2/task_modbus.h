@@ -0,0 +1,59 @@
+/**
+ * @file task_modbus.h
+ * @brief Lab 3.2 — Modbus RTU Slave Task Interface (-DLAB3_2_MODBUS)
+ *
+ * Serves the sensor and alert snapshot to an RS-485 master at node
+ * MODBUS_NODE_ADDRESS, 19200 8E1 on USART3 (sensor_data.h). Each request
+ * is answered from one g_sensorSnapshot read (lock-free, as Tasks 3 and
+ * 4 read it), so the registers of a request all come from the same
+ * conditioning cycle. The thresholds are compile-time: no holding
+ * registers (writes answer exception 02).
+ *
+ * Input registers (0x04):
+ *
+ *   addr  field                          unit
+ *   0     sample.tempC[CH_ANALOG]        0.01 C (-32768 = invalid)
+ *   1     cond.ewma[CH_ANALOG]           0.01 C
+ *   2     sample.valid[CH_ANALOG]        0/1
+ *   3     sample.raw[CH_ANALOG]          ADC counts
+ *   4     sample.tempC[CH_DIGITAL]       0.01 C
+ *   5     cond.ewma[CH_DIGITAL]          0.01 C
+ *   6     sample.valid[CH_DIGITAL]       0/1
+ *   7     alert.fusedTemp                0.01 C
+ *   8     alert.fusedRate                0.001 C/s
+ *   9-11  alert state: analog, digital,  AlertState (0 normal,
+ *         fused                          1 debounce high, 2 alert,
+ *                                        3 debounce low)
+ *   12-13 sample.sequence                u32, high word first
+ *   14-15 sample.overruns                u32
+ *   16-21 alerts raised: analog,         u32 each
+ *         digital, fused
+ *
+ * With -DLAB3_2_TIME_SYNC the node follows the gateway's sync broadcasts
+ * (TimeSync.h; consumed here, never answered) and adds:
+ *
+ *   22-23 sample time                    u32 µs, the gateway's micros()
+ *                                        (this node's while unsynced)
+ *   24    sync state                     TimeSyncState (0 none,
+ *                                        1 offset, 2 offset and drift)
+ *   25    clock drift, gateway vs node   1 ppm
+ *
+ * Task characteristics:
+ *   Period:   none, woken by the USART ISR per request frame
+ *   Priority: 2 (TASK_MODBUS_PRIORITY)
+ */
+
+#ifndef TASK_MODBUS_H
+#define TASK_MODBUS_H
+
+#if defined(LAB3_2_MODBUS)
+
+/** @brief Bind the register table and start the USART (setup()). */
+void taskModbusInit();
+
+/** @brief FreeRTOS task function answering Modbus requests. */
+void vTaskModbus(void *pvParameters);
+
+#endif // LAB3_2_MODBUS
+
+#endif // TASK_MODBUS_H
@@ -0,0 +1,407 @@
+/**
+ * @file task_telemetry.cpp
+ * @brief Lab 3.2 — Telemetry Task Implementation
+ *
+ * Reads the shared sensor and alert snapshot (lock-free), prints the
+ * subscribed fields, and in binary mode packs the record listed in
+ * task_telemetry.h and hands it to telemetrySend(), which never blocks
+ * on the UART.
+ *
+ * The alert event log is serviced here as well: its EEPROM page writes
+ * busy-wait (~3.4 ms per changed byte), which only this lowest-priority
+ * task can afford. The NTC calibration store (ntc_calibration.h) is
+ * written from here for the same reason.
+ *
+ * In trace replay the serial input is the trace, so commands are not
+ * read, and the log is not spilled (replayed alerts stay out of EEPROM).
+ */
+
+#include "task_telemetry.h"
+#include "sensor_data.h"
+#include "sensor_trace.h"
+#include "task_display.h"
+#include "ntc_calibration.h"
+
+#include "TelemetryFrame.h"
+#include "FieldTelemetry.h"
+#include "CommandParser.h"
+#include "DeltaSeries.h"
+#include "FsmTrace.h"
+#include "StdioSerial.h"
+#include "RtosTime.h"
+#include "FlashString.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Record layout (must match the table in task_telemetry.h)
+// ──────────────────────────────────────────────────────────────────────────
+
+typedef struct __attribute__((packed)) {
+    uint32_t timeMs;
+    uint32_t readingCount;
+    uint16_t analogRaw;
+    int16_t  analogTempRaw;
+    int16_t  analogMedian;
+    int16_t  analogEwma;
+    int16_t  digitalTempRaw;
+    int16_t  digitalMedian;
+    int16_t  digitalEwma;
+    uint8_t  flags;
+    uint8_t  alertStates;
+    uint16_t conditioningCycles;
+} Lab3_2Telemetry_t;
+
+/// Fixed-point scale for temperatures (hundredths of a degree).
+static const int16_t TEMP_SCALE = 100;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Field subscriptions
+// ──────────────────────────────────────────────────────────────────────────
+
+static const FieldDesc FIELDS[] PROGMEM = {
+    FIELD_DESC("araw",     SensorSnapshot_t, sensor.sample.raw[CH_ANALOG],        FIELD_U16,   0),
+    FIELD_DESC("ares",     SensorSnapshot_t, sensor.sample.resistance[CH_ANALOG], FIELD_FLOAT, 0),
+    FIELD_DESC("atemp",    SensorSnapshot_t, sensor.sample.tempC[CH_ANALOG],      FIELD_FLOAT, 2),
+    FIELD_DESC("amed",     SensorSnapshot_t, sensor.cond.median[CH_ANALOG],       FIELD_FLOAT, 2),
+    FIELD_DESC("aewma",    SensorSnapshot_t, sensor.cond.ewma[CH_ANALOG],         FIELD_FLOAT, 2),
+    FIELD_DESC("aalpha",   SensorSnapshot_t, sensor.cond.alpha[CH_ANALOG],        FIELD_FLOAT, 3),
+    FIELD_DESC("avalid",   SensorSnapshot_t, sensor.sample.valid[CH_ANALOG],      FIELD_BOOL,  0),
+    FIELD_DESC("acond",    SensorSnapshot_t, sensor.cond.conditioned[CH_ANALOG],  FIELD_BOOL,  0),
+    FIELD_DESC("dtemp",    SensorSnapshot_t, sensor.sample.tempC[CH_DIGITAL],     FIELD_FLOAT, 2),
+    FIELD_DESC("dmed",     SensorSnapshot_t, sensor.cond.median[CH_DIGITAL],      FIELD_FLOAT, 2),
+    FIELD_DESC("dewma",    SensorSnapshot_t, sensor.cond.ewma[CH_DIGITAL],        FIELD_FLOAT, 2),
+    FIELD_DESC("dalpha",   SensorSnapshot_t, sensor.cond.alpha[CH_DIGITAL],       FIELD_FLOAT, 3),
+    FIELD_DESC("dvalid",   SensorSnapshot_t, sensor.sample.valid[CH_DIGITAL],     FIELD_BOOL,  0),
+    FIELD_DESC("dcond",    SensorSnapshot_t, sensor.cond.conditioned[CH_DIGITAL], FIELD_BOOL,  0),
+    FIELD_DESC("ftemp",    SensorSnapshot_t, alert.fusedTemp,                     FIELD_FLOAT, 2),
+    FIELD_DESC("fvar",     SensorSnapshot_t, alert.fusedVariance,                 FIELD_FLOAT, 4),
+    FIELD_DESC("frate",    SensorSnapshot_t, alert.fusedRate,                     FIELD_FLOAT, 3),
+    FIELD_DESC("readings", SensorSnapshot_t, sensor.sample.sequence,              FIELD_U32,   0),
+    FIELD_DESC("overruns", SensorSnapshot_t, sensor.sample.overruns,              FIELD_U32,   0),
+    FIELD_DESC("acnt",     SensorSnapshot_t, alert.channel.count[CH_ANALOG],      FIELD_U32,   0),
+    FIELD_DESC("dcnt",     SensorSnapshot_t, alert.channel.count[CH_DIGITAL],     FIELD_U32,   0),
+    FIELD_DESC("fcnt",     SensorSnapshot_t, alert.channel.count[ALERT_CH_FUSED], FIELD_U32,   0),
+    FIELD_DESC("ccycles",  SensorSnapshot_t, alert.conditioningCycles,            FIELD_U32,   0),
+#if defined(LAB3_2_HARD_TRIP)
+    FIELD_DESC("trip",     SensorSnapshot_t, alert.hardTripped,                   FIELD_BOOL,  0),
+    FIELD_DESC("trips",    SensorSnapshot_t, alert.hardTrips,                     FIELD_U16,   0),
+#endif
+};
+
+// ──────────────────────────────────────────────────────────────────────────
+// Alert event log commands
+// ──────────────────────────────────────────────────────────────────────────
+
+static const char *const LOG_CHANNEL_NAMES[] = { "analog", "digital", "fused",
+#if defined(LAB3_2_HARD_TRIP)
+                                                 "trip",
+#endif
+};
+static const uint8_t LOG_CHANNEL_COUNT = sizeof(LOG_CHANNEL_NAMES) / sizeof(LOG_CHANNEL_NAMES[0]);
+static const char *const LOG_STATE_NAMES[] = { "NORMAL", "DEB_HI", "ALERT", "DEB_LO" };
+
+static const char *logStateName(uint8_t state) {
+    return state < 4 ? LOG_STATE_NAMES[state] : "?";
+}
+
+static void printLogRecord(const EventRecord &record, bool stored, void *context) {
+    (void)context;
+    char valueStr[9];
+    float value = EventLog::valueOf(record);
+    if (isnan(value)) {
+        strcpy(valueStr, "---");
+    } else {
+        dtostrf(value, 1, 2, valueStr);
+    }
+    FLASH_PRINTF("%c %10lu %-7s %s>%s %s\r\n",
+                 stored ? 'E' : 'R',
+                 (unsigned long)record.timeMs,
+                 record.channel < LOG_CHANNEL_COUNT ? LOG_CHANNEL_NAMES[record.channel] : "?",
+                 logStateName(record.code >> 4),
+                 logStateName(record.code & 0x0F),
+                 valueStr);
+}
+
+static void onLogDump(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    FLASH_PRINTF("[LOG] src time_ms channel from>to value (E=EEPROM, R=RAM)\r\n");
+    uint16_t n = g_alertLog.forEach(printLogRecord, NULL);
+    FLASH_PRINTF("[LOG] %u events, %u pages stored, %u pending, %u lost\r\n",
+                 (unsigned)n, (unsigned)g_alertLog.getStoredPages(),
+                 (unsigned)g_alertLog.getPendingCount(), (unsigned)g_alertLog.getLostCount());
+}
+
+static void onLogFlush(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    g_alertLog.flush();
+    FLASH_PRINTF("[LOG] Flushed, %u pages stored\r\n", (unsigned)g_alertLog.getStoredPages());
+}
+
+static void onLogClear(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    g_alertLog.clear();
+    FLASH_PRINTF("[LOG] Cleared\r\n");
+}
+
+static void onTraceDump(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    fsmTraceDump();
+}
+
+static void onTraceClear(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    fsmTraceClear();
+    FLASH_PRINTF("[TRACE] Cleared\r\n");
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Reading history (sensor_data.h, HISTORY_*)
+// ──────────────────────────────────────────────────────────────────────────
+
+/** Columns of a history sample. */
+enum HistoryColumn {
+    HIST_TIME = 0,   ///< millis() / HISTORY_INTERVAL_MS
+    HIST_ANALOG,     ///< Analog EWMA × HISTORY_TEMP_SCALE
+    HIST_DIGITAL,    ///< Digital EWMA × HISTORY_TEMP_SCALE
+    HIST_FUSED,      ///< Fused estimate × HISTORY_TEMP_SCALE
+    HIST_COLUMNS
+};
+
+static DeltaSeries<HIST_COLUMNS, HISTORY_BYTES> s_history;
+
+static void recordHistory(const SensorSnapshot_t &snapshot) {
+    int32_t q[HIST_COLUMNS];
+    q[HIST_TIME] = (int32_t)(millis() / HISTORY_INTERVAL_MS);
+    q[HIST_ANALOG] = deltaSeriesQuantize(snapshot.sensor.cond.ewma[CH_ANALOG], HISTORY_TEMP_SCALE);
+    q[HIST_DIGITAL] = deltaSeriesQuantize(snapshot.sensor.cond.ewma[CH_DIGITAL], HISTORY_TEMP_SCALE);
+    q[HIST_FUSED] = deltaSeriesQuantize(snapshot.alert.fusedTemp, HISTORY_TEMP_SCALE);
+    s_history.append(q);
+}
+
+static void printHistorySample(const int32_t *q, void *context) {
+    (void)context;
+    char temps[3][9];
+    for (uint8_t c = 0; c < 3; c++) {
+        float value = deltaSeriesValue(q[HIST_ANALOG + c], HISTORY_TEMP_SCALE);
+        if (isnan(value)) {
+            strcpy(temps[c], "---");
+        } else {
+            dtostrf(value, 1, 2, temps[c]);
+        }
+    }
+    FLASH_PRINTF("%10lu %7s %7s %7s\r\n", (unsigned long)q[HIST_TIME] * HISTORY_INTERVAL_MS,
+                 temps[0], temps[1], temps[2]);
+}
+
+static void printHistorySummary() {
+    uint16_t n = s_history.count();
+    uint16_t bytes = s_history.bytesUsed();
+    // Tenths of a byte per sample, against u32 time + 3 floats
+    uint16_t tenths = n > 0 ? (uint16_t)(((uint32_t)bytes * 10 + n / 2) / n) : 0;
+    FLASH_PRINTF("[HIST] %u samples in %u/%u bytes (%u.%u B/sample, raw 16), %lu dropped\r\n",
+                 (unsigned)n, (unsigned)bytes, (unsigned)s_history.capacity(),
+                 (unsigned)(tenths / 10), (unsigned)(tenths % 10),
+                 (unsigned long)s_history.getDropped());
+}
+
+static void onHistory(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    stdioSerialSetTxPolicy(STDIO_TX_BLOCK);
+    FLASH_PRINTF("[HIST] time_ms analog digital fused (EWMA, EWMA, Kalman)\r\n");
+    s_history.forEach(printHistorySample, NULL);
+    printHistorySummary();
+    stdioSerialSetTxPolicy(STDIO_TX_DROP);
+}
+
+/**
+ * "hist raw": the encoded stream as hex. HISTRAW,BASE,<t>,<a>,<d>,<f>
+ * gives the values before the first sample; each sample then follows as
+ * four zig-zag varint deltas (DeltaSeries.h) across the HISTRAW lines.
+ */
+static void onHistoryRaw(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    stdioSerialSetTxPolicy(STDIO_TX_BLOCK);
+    int32_t base[HIST_COLUMNS];
+    s_history.getBase(base);
+    FLASH_PRINTF("HISTRAW,BASE,%ld,%ld,%ld,%ld\r\n", (long)base[HIST_TIME], (long)base[HIST_ANALOG],
+                 (long)base[HIST_DIGITAL], (long)base[HIST_FUSED]);
+    uint8_t chunk[32];
+    uint16_t offset = 0;
+    uint16_t n;
+    while ((n = s_history.copyBytes(offset, chunk, sizeof(chunk))) > 0) {
+        FLASH_PRINTF("HISTRAW,");
+        for (uint16_t i = 0; i < n; i++) {
+            FLASH_PRINTF("%02X", (unsigned)chunk[i]);
+        }
+        FLASH_PRINTF("\r\n");
+        offset = (uint16_t)(offset + n);
+    }
+    FLASH_PRINTF("HISTRAW,END,%u,%u\r\n",
+                 (unsigned)s_history.count(), (unsigned)HISTORY_INTERVAL_MS);
+    stdioSerialSetTxPolicy(STDIO_TX_DROP);
+}
+
+static void onHistoryClear(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    s_history.clear();
+    FLASH_PRINTF("[HIST] Cleared\r\n");
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// NTC calibration commands
+// ──────────────────────────────────────────────────────────────────────────
+
+static void onCal(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    ntcCalibrationReport();
+}
+
+static void onCalReset(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    ntcCalibrationReset();
+    FLASH_PRINTF("[CAL] Reset to the datasheet constants, store cleared\r\n");
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Report commands (printed by the display task)
+// ──────────────────────────────────────────────────────────────────────────
+
+static void onReportFull(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    taskDisplaySetCompact(false);
+}
+
+static void onReportDelta(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    taskDisplaySetCompact(true);
+}
+
+static void onReport(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    taskDisplayRequestReport();
+}
+
+static const CommandEntry COMMANDS[] PROGMEM = {
+    FIELD_TELEMETRY_COMMANDS,
+    COMMAND_ENTRY("log dump",  onLogDump,  ""),
+    COMMAND_ENTRY("log flush", onLogFlush, ""),
+    COMMAND_ENTRY("log clear", onLogClear, ""),
+    COMMAND_ENTRY("trace dump",  onTraceDump,  ""),
+    COMMAND_ENTRY("trace clear", onTraceClear, ""),
+    COMMAND_ENTRY("hist raw",   onHistoryRaw,   ""),
+    COMMAND_ENTRY("hist clear", onHistoryClear, ""),
+    COMMAND_ENTRY("hist",       onHistory,      ""),
+    COMMAND_ENTRY("cal reset", onCalReset, ""),
+    COMMAND_ENTRY("cal",       onCal,      ""),
+    COMMAND_ENTRY("report full",  onReportFull,  ""),
+    COMMAND_ENTRY("report delta", onReportDelta, ""),
+    COMMAND_ENTRY("report",       onReport,      "")
+};
+
+static FieldTelemetry s_fields;
+static CommandStream  s_cli;
+
+bool taskTelemetryHasSubscribers() {
+    return fieldTelemetryActive(&s_fields) > 0;
+}
+
+/** @brief Feed pending serial input to the command parser. */
+static void serviceCommands() {
+    int c;
+    while ((c = stdioSerialPollChar()) >= 0) {
+        CommandStatus status = commandStreamFeed(&s_cli, (char)c);
+        if (status == COMMAND_NOT_FOUND || status == COMMAND_BAD_ARGS) {
+            FLASH_PRINTF("[ERROR] Unknown command. ");
+            fieldTelemetryPrintHelp();
+        }
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Task function
+// ──────────────────────────────────────────────────────────────────────────
+
+void vTaskTelemetry(void *pvParameters) {
+    (void)pvParameters;
+
+    fieldTelemetryInit(&s_fields, FIELDS, sizeof(FIELDS) / sizeof(FIELDS[0]));
+    commandStreamInit(&s_cli, COMMANDS, sizeof(COMMANDS) / sizeof(COMMANDS[0]), &s_fields);
+
+    RtosPeriod period(TASK_TELEMETRY_PERIOD_MS);
+    uint32_t lastHistoryMs = millis() - HISTORY_INTERVAL_MS;
+
+    SensorSnapshot_t snapshot;
+    const SensorReadings_t &localSensor = snapshot.sensor;
+    const AlertStatus_t    &localAlert  = snapshot.alert;
+    Lab3_2Telemetry_t rec;
+
+    for (;;) {
+        period.wait();
+
+#if !defined(LAB3_2_TRACE_REPLAY)
+        serviceCommands();
+        g_alertLog.service();
+        ntcCalibrationService();
+#endif
+
+        g_sensorSnapshot.read(snapshot);
+
+        fieldTelemetryPoll(&s_fields, &snapshot, millis());
+
+        if (millis() - lastHistoryMs >= HISTORY_INTERVAL_MS) {
+            lastHistoryMs += HISTORY_INTERVAL_MS;
+            recordHistory(snapshot);
+        }
+
+        if (!TELEMETRY_BINARY) {
+            continue;
+        }
+
+        rec.timeMs         = millis();
+        rec.readingCount   = localSensor.sample.sequence;
+        rec.analogRaw      = localSensor.sample.raw[CH_ANALOG];
+        rec.analogTempRaw  = telemetryPackFloat(localSensor.sample.tempC[CH_ANALOG],  TEMP_SCALE);
+        rec.analogMedian   = telemetryPackFloat(localSensor.cond.median[CH_ANALOG],   TEMP_SCALE);
+        rec.analogEwma     = telemetryPackFloat(localSensor.cond.ewma[CH_ANALOG],     TEMP_SCALE);
+        rec.digitalTempRaw = telemetryPackFloat(localSensor.sample.tempC[CH_DIGITAL], TEMP_SCALE);
+        rec.digitalMedian  = telemetryPackFloat(localSensor.cond.median[CH_DIGITAL],  TEMP_SCALE);
+        rec.digitalEwma    = telemetryPackFloat(localSensor.cond.ewma[CH_DIGITAL],    TEMP_SCALE);
+        rec.flags = (uint8_t)((localSensor.sample.valid[CH_ANALOG]      ? 0x01 : 0) |
+                              (localSensor.cond.conditioned[CH_ANALOG]  ? 0x02 : 0) |
+                              (localSensor.sample.valid[CH_DIGITAL]     ? 0x04 : 0) |
+                              (localSensor.cond.conditioned[CH_DIGITAL] ? 0x08 : 0));
+        rec.alertStates = (uint8_t)(((uint8_t)localAlert.channel.state[CH_ANALOG] & 0x0F) |
+                                    (((uint8_t)localAlert.channel.state[CH_DIGITAL] & 0x0F) << 4));
+        rec.conditioningCycles = (uint16_t)localAlert.conditioningCycles;
+
+        telemetrySend(LAB3_2_TELEMETRY_TYPE, &rec, sizeof(rec));
+    }
+}
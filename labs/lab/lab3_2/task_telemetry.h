@@ -0,0 +1,67 @@
+/**
+ * @file task_telemetry.h
+ * @brief Lab 3.2 — Telemetry Task Interface
+ *
+ * Each period the task reads serial commands and prints the fields an
+ * operator subscribed to with "sub <field> <period_ms>" (FieldTelemetry).
+ * While any field is subscribed the display task skips its text report.
+ * It also spills the alert event log to EEPROM (g_alertLog.service())
+ * and serves "log dump", "log flush" and "log clear", plus "trace dump"
+ * and "trace clear" for the alert FSMs' transition trace (FsmTrace).
+ * Every HISTORY_INTERVAL_MS it adds the conditioned readings to a
+ * delta-compressed RAM history (DeltaSeries): "hist" prints it, "hist
+ * raw" sends the encoded bytes as hex, "hist clear" empties it.
+ * "report", "report full" and "report delta" are passed on to the
+ * display task, which prints the STDIO report.
+ *
+ * Fields: araw ares atemp amed aewma avalid acond dtemp dmed dewma
+ *         dvalid dcond readings acnt dcnt ccycles
+ *
+ * When TELEMETRY_BINARY is enabled, this task also replaces the text
+ * report with one fixed-layout record per TASK_TELEMETRY_PERIOD_MS, framed
+ * by the TelemetryFrame library (COBS + CRC-16, 0x00 delimiter).
+ *
+ * Record type LAB3_2_TELEMETRY_TYPE, 26 bytes, little-endian:
+ *
+ *   off  type   field
+ *   0    u32    timeMs             millis() at send time
+ *   4    u32    readingCount       acquisition cycles
+ *   8    u16    analogRaw          ADC counts
+ *   10   i16    analogTempRaw      0.01 C
+ *   12   i16    analogMedian       0.01 C
+ *   14   i16    analogEwma         0.01 C
+ *   16   i16    digitalTempRaw     0.01 C
+ *   18   i16    digitalMedian      0.01 C
+ *   20   i16    digitalEwma        0.01 C
+ *   22   u8     flags              bit0 analogValid, bit1 analogConditioned,
+ *                                  bit2 digitalValid, bit3 digitalConditioned
+ *   23   u8     alertStates        low nibble analog, high nibble digital
+ *   24   u16    conditioningCycles low 16 bits
+ *
+ * Temperatures equal to -32768 mark NaN (no valid reading).
+ *
+ * Task characteristics:
+ *   Period:   100 ms (TASK_TELEMETRY_PERIOD_MS)
+ *   Priority: 1 (same as display)
+ */
+
+#ifndef TASK_TELEMETRY_H
+#define TASK_TELEMETRY_H
+
+#include <Arduino_FreeRTOS.h>
+
+/** @brief TelemetryFrame record type id for the Lab 3.2 record. */
+static const uint8_t LAB3_2_TELEMETRY_TYPE = 0x32;
+
+/**
+ * @brief FreeRTOS task function: serial commands, field subscriptions
+ *        and (optionally) binary telemetry.
+ *
+ * @param pvParameters Unused (NULL).
+ */
+void vTaskTelemetry(void *pvParameters);
+
+/** @brief True while at least one field subscription is active. */
+bool taskTelemetryHasSubscribers();
+
+#endif // TASK_TELEMETRY_H
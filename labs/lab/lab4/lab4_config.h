@@ -21,6 +21,9 @@
 #define LAB4_CONFIG_H
 
 #include <Arduino.h>
+#if defined(LAB4_MODBUS)
+#include "ModbusSlave.h"
+#endif
 
 // ── Pin assignments ─────────────────────────────────────────────────
 static const uint8_t PIN_RELAY       = 7;   // Binary actuator relay
@@ -28,9 +31,10 @@ static const uint8_t PIN_PWM_ACT     = 3;   // Analog actuator (PWM)
 static const uint8_t PIN_LED_GREEN   = 8;   // System normal indicator
 static const uint8_t PIN_LED_RED     = 9;   // Alert indicator
 
-// Keypad pins (4x4 matrix)
+// Keypad pins (4x4 matrix). Columns on PK0..PK3 (PCINT16..19) so that a
+// press wakes the input task (KEYPAD_INPUT_DIRECT backend).
 static byte KEYPAD_ROW_PINS[4] = {22, 23, 24, 25};
-static byte KEYPAD_COL_PINS[4] = {26, 27, 28, 29};
+static byte KEYPAD_COL_PINS[4] = {A8, A9, A10, A11};
 
 // LCD I2C
 static const uint8_t LCD_I2C_ADDR = 0x27;
@@ -38,17 +42,45 @@ static const uint8_t LCD_COLS     = 16;
 static const uint8_t LCD_ROWS     = 2;
 
 // ── Timing (milliseconds) ──────────────────────────────────────────
-static const uint16_t TASK_INPUT_PERIOD_MS      = 50;   // Keypad scan
 static const uint16_t TASK_CONTROL_PERIOD_MS    = 100;  // Actuator control
-static const uint16_t TASK_DISPLAY_PERIOD_MS    = 500;  // LCD + serial
+static const uint16_t TASK_TELEMETRY_PERIOD_MS  = 100;  // Serial commands + subscriptions
+
+// Display (DisplayRefresh): redrawn when the state it shows changes, at
+// most every DISPLAY_REFRESH_MIN_MS; the heartbeat brings the periodic
+// serial report (and a full redraw) whether or not anything changed.
+static const uint16_t DISPLAY_REFRESH_MIN_MS    = 100;
+static const uint16_t DISPLAY_HEARTBEAT_MS      = 2000;
+
+// Periodic report: true = one key=value line of the outputs that changed
+// (quiet when steady), false = the full report. "report full" / "report
+// delta" switch it at runtime; key D always prints the full report.
+static const bool     REPORT_COMPACT            = true;
+
+#if defined(LAB4_MODBUS)
+// ── Modbus RTU slave (-DLAB4_MODBUS, register map in task_modbus.h) ─
+// RS-485 transceiver on USART3 (TX3 D14 / RX3 D15), DE and /RE on D26.
+static const uint8_t      MODBUS_NODE_ADDRESS = 4;
+static const uint32_t     MODBUS_BAUD         = 19200UL;
+static const ModbusParity MODBUS_PARITY       = MODBUS_PARITY_EVEN;
+static const int8_t       PIN_MODBUS_DE       = 26;
+#endif
 
 // ── FreeRTOS task configuration ────────────────────────────────────
 static const uint16_t TASK_INPUT_STACK      = 256;
 static const uint16_t TASK_CONTROL_STACK    = 256;
 static const uint16_t TASK_DISPLAY_STACK    = 512;
+static const uint16_t TASK_LOG_STACK        = 320;
+static const uint16_t TASK_TELEMETRY_STACK  = 320;
+static const uint16_t TASK_MODBUS_STACK     = 256;
 static const uint8_t TASK_INPUT_PRIORITY   = 3;
 static const uint8_t TASK_CONTROL_PRIORITY = 2;
 static const uint8_t TASK_DISPLAY_PRIORITY = 1;
+static const uint8_t TASK_LOG_PRIORITY     = 1;
+static const uint8_t TASK_TELEMETRY_PRIORITY = 1;
+static const uint8_t TASK_MODBUS_PRIORITY  = 2;
+
+// ── Deferred logging ────────────────────────────────────────────────
+static const uint8_t LOG_QUEUE_DEPTH = 8;  // Pending [INPUT] messages
 
 // ── Binary actuator debounce ────────────────────────────────────────
 static const uint8_t RELAY_DEBOUNCE_COUNT = 3; // Consecutive confirmations
@@ -58,7 +90,15 @@ static const uint8_t  ACT_MEDIAN_WINDOW = 5;
 static const float    ACT_EWMA_ALPHA    = 0.4f;
 static const float    ACT_MIN_CLAMP     = 0.0f;
 static const float    ACT_MAX_CLAMP     = 100.0f;
-static const float    ACT_RAMP_STEP     = 5.0f;  // Max % change per cycle
+static const float    ACT_RAMP_STEP     = 5.0f;  // Max % change per call (untimed fallback)
+// Timed ramp: the control task passes the measured cycle time, so a late
+// cycle does not slow the ramp down. 50 %/s equals 5 % per 100 ms cycle.
+static const float    ACT_RAMP_RATE     = 50.0f;  // Max %/s
+static const float    ACT_RAMP_ACCEL    = 200.0f; // %/s² for an S-curve, 0 = linear
+
+// D3 is OC3C: Timer3 phase-correct PWM, TOP = 8000 (~13 bit) so the
+// EWMA/ramp output is not quantized to analogWrite()'s 256 steps.
+static const uint32_t ACT_PWM_FREQUENCY_HZ = 1000UL;
 
 // ── Alert thresholds for analog actuator ────────────────────────────
 static const float    OVERLOAD_THRESHOLD_HIGH = 90.0f;
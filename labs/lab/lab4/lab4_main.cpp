@@ -2,9 +2,9 @@
  * @file lab4_main.cpp
  * @brief Lab 4 — Dual Actuator Control System Entry Point
  *
- * Initializes STDIO serial, shared state, and spawns three FreeRTOS
- * tasks for keypad input, actuator control with conditioning, and
- * LCD/serial display reporting.
+ * Initializes STDIO serial, shared state, and spawns FreeRTOS tasks for
+ * keypad input, actuator control with conditioning, LCD/serial display
+ * reporting, and serial field-subscription telemetry.
  */
 
 #include "lab4_main.h"
@@ -13,61 +13,113 @@
 #include "task_input.h"
 #include "task_control.h"
 #include "task_display.h"
+#include "task_telemetry.h"
+#include "task_modbus.h"
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 #include <stdio.h>
 
 #include "StdioSerial.h"
+#include "DeferredLog.h"
+#include "StaticTaskSet.h"
+#include "IdleSleep.h"
+#include "FlashString.h"
+
+#if defined(LAB4_MODBUS)
+// Init hook of the Modbus row: register table and USART
+static bool modbusStart() {
+    taskModbusInit();
+    return true;
+}
+#endif
+
+// Task set, one row per task; TCBs and stacks reserved at link time (StaticTaskSet)
+static constexpr StaticTaskDesc TASKS[] PROGMEM = {
+    STATIC_TASK(vTaskInput,       "Input",   TASK_INPUT_STACK,     TASK_INPUT_PRIORITY,     0),
+    STATIC_TASK(vTaskControl,     "Control", TASK_CONTROL_STACK,   TASK_CONTROL_PRIORITY,
+                TASK_CONTROL_PERIOD_MS),
+    STATIC_TASK(vTaskDisplay,     "Display", TASK_DISPLAY_STACK,   TASK_DISPLAY_PRIORITY,
+                DISPLAY_HEARTBEAT_MS),
+    STATIC_TASK(vTaskDeferredLog, "Log",     TASK_LOG_STACK,       TASK_LOG_PRIORITY,       0),
+    STATIC_TASK(vTaskTelemetry,   "Telem",   TASK_TELEMETRY_STACK, TASK_TELEMETRY_PRIORITY,
+                TASK_TELEMETRY_PERIOD_MS),
+#if defined(LAB4_MODBUS)
+    STATIC_TASK_INIT(vTaskModbus, "Modbus",  TASK_MODBUS_STACK,    TASK_MODBUS_PRIORITY,
+                     0, modbusStart),
+#endif
+};
+static STATIC_TASK_SET(s_tasks, TASKS);
 
 void lab4Setup() {
     // Initialize STDIO serial
     stdioSerialInit(9600);
 
     // Print startup banner
-    printf("\r\n");
-    printf("================================================\r\n");
-    printf("  Lab 4 — Dual Actuator Control System\r\n");
-    printf("  Binary (Relay) + Analog (PWM)\r\n");
-    printf("  Keypad Interface | FreeRTOS\r\n");
-    printf("  Varianta C (100%%)\r\n");
-    printf("================================================\r\n");
-    printf("COMMANDS (Keypad):\r\n");
-    printf("  A = Toggle relay ON/OFF\r\n");
-    printf("  B = Enter PWM value mode\r\n");
-    printf("  0-9 = Digit entry (PWM %%)\r\n");
-    printf("  # = Confirm PWM value\r\n");
-    printf("  * = Cancel input\r\n");
-    printf("  C = Emergency stop (all OFF)\r\n");
-    printf("  D = Print status report\r\n");
-    printf("HARDWARE:\r\n");
-    printf("  Relay:    pin D%d\r\n", PIN_RELAY);
-    printf("  PWM out:  pin D%d\r\n", PIN_PWM_ACT);
-    printf("  LED grn:  pin D%d\r\n", PIN_LED_GREEN);
-    printf("  LED red:  pin D%d\r\n", PIN_LED_RED);
-    printf("CONDITIONING:\r\n");
-    printf("  Median=%u, EWMA=0.4, Ramp=5%%/cycle\r\n",
-           (unsigned)ACT_MEDIAN_WINDOW);
-    printf("  Overload: >90%% alert, <80%% clear\r\n");
-    printf("================================================\r\n\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("  Lab 4 — Dual Actuator Control System\r\n");
+    FLASH_PRINTF("  Binary (Relay) + Analog (PWM)\r\n");
+    FLASH_PRINTF("  Keypad Interface | FreeRTOS\r\n");
+    FLASH_PRINTF("  Varianta C (100%%)\r\n");
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("COMMANDS (Keypad):\r\n");
+    FLASH_PRINTF("  A = Toggle relay ON/OFF\r\n");
+    FLASH_PRINTF("  B = Enter PWM value mode\r\n");
+    FLASH_PRINTF("  0-9 = Digit entry (PWM %%)\r\n");
+    FLASH_PRINTF("  # = Confirm PWM value\r\n");
+    FLASH_PRINTF("  * = Cancel input\r\n");
+    FLASH_PRINTF("  C = Emergency stop (all OFF)\r\n");
+    FLASH_PRINTF("  D = Print status report\r\n");
+    FLASH_PRINTF("COMMANDS (Serial):\r\n");
+    FLASH_PRINTF("  sub <field> <ms> | unsub <field|all> | subs | fields\r\n");
+    FLASH_PRINTF("  report | report full | report delta = 2 s report (default %s)\r\n",
+                 REPORT_COMPACT ? "delta" : "full");
+    FLASH_PRINTF("HARDWARE:\r\n");
+    FLASH_PRINTF("  Relay:    pin D%d\r\n", PIN_RELAY);
+    FLASH_PRINTF("  PWM out:  pin D%d\r\n", PIN_PWM_ACT);
+    FLASH_PRINTF("  LED grn:  pin D%d\r\n", PIN_LED_GREEN);
+    FLASH_PRINTF("  LED red:  pin D%d\r\n", PIN_LED_RED);
+#if defined(LAB4_MODBUS)
+    FLASH_PRINTF("  Modbus:   USART%u node %u %lu baud, RS-485 DE D%d\r\n",
+                 (unsigned)MODBUS_SLAVE_USART, (unsigned)MODBUS_NODE_ADDRESS,
+                 (unsigned long)MODBUS_BAUD, (int)PIN_MODBUS_DE);
+#endif
+    FLASH_PRINTF("CONDITIONING:\r\n");
+    FLASH_PRINTF("  Median=%u, EWMA=0.4, Ramp=5%%/cycle\r\n",
+                 (unsigned)ACT_MEDIAN_WINDOW);
+    FLASH_PRINTF("  Overload: >90%% alert, <80%% clear\r\n");
+    FLASH_PRINTF("================================================\r\n\r\n");
 
     // Initialize shared state + mutex
     sharedStateInit();
 
-    // Create FreeRTOS tasks (report creation failures explicitly)
-    BaseType_t okInput = xTaskCreate(vTaskInput, "Input", TASK_INPUT_STACK,
-                                     NULL, TASK_INPUT_PRIORITY, NULL);
-    BaseType_t okControl = xTaskCreate(vTaskControl, "Control", TASK_CONTROL_STACK,
-                                       NULL, TASK_CONTROL_PRIORITY, NULL);
-    BaseType_t okDisplay = xTaskCreate(vTaskDisplay, "Display", TASK_DISPLAY_STACK,
-                                       NULL, TASK_DISPLAY_PRIORITY, NULL);
+    // Console messages from tasks are queued and printed by the logger task
+    deferredLogInit(LOG_QUEUE_DEPTH);
+
+    // Create FreeRTOS tasks (an [ERROR] line per task that cannot be created)
+    s_tasks.launch(TASKS);
+
+    // Modules lab 4 never uses: PWM stays on Timer3 (D3), the LEDs and
+    // relay are plain GPIO, the console is USART0 (the Modbus USART of
+    // -DLAB4_MODBUS stays on too).
+#if defined(LAB4_MODBUS)
+    const uint16_t spareUsarts = IDLE_SLEEP_GATE_SPARE_USARTS & ~LAB4_MODBUS_IDLE_GATE;
+#else
+    const uint16_t spareUsarts = IDLE_SLEEP_GATE_SPARE_USARTS;
+#endif
+    idleSleepInit(spareUsarts | IDLE_SLEEP_GATE_SPI |
+                  IDLE_SLEEP_GATE_TIMER1 | IDLE_SLEEP_GATE_TIMER2 |
+                  IDLE_SLEEP_GATE_TIMER4 | IDLE_SLEEP_GATE_TIMER5 |
+                  IDLE_SLEEP_GATE_ANALOG_COMP);
 
-    if (okInput != pdPASS || okControl != pdPASS || okDisplay != pdPASS) {
-        printf("[ERROR] Task creation failed: Input=%ld Control=%ld Display=%ld\r\n",
-               (long)okInput, (long)okControl, (long)okDisplay);
-    }
+    // Kernel tick on a 1 ms timer compare with -DRTOS_TICK_TIMER (RtosTick.h);
+    // last, as it keeps interrupts off until the scheduler starts.
+    rtosTickInit();
 }
 
 void lab4Loop() {
-    // All logic runs in FreeRTOS tasks
+    // All logic runs in FreeRTOS tasks. This is the idle hook: sleep
+    // until the next interrupt instead of spinning (IdleSleep).
+    idleSleep();
 }
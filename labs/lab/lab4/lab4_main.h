@@ -13,7 +13,7 @@
  * Three FreeRTOS tasks:
  *   Task 1 — Input (50ms, prio 3): keypad scanning & command parsing
  *   Task 2 — Control (100ms, prio 2): debounce, conditioning, hardware
- *   Task 3 — Display (500ms, prio 1): LCD + structured serial reports
+ *   Task 3 — Display (on change, prio 1): LCD + structured serial reports
  *
  * Hardware (Arduino Mega 2560):
  *   D3  = PWM analog actuator (LED simulating motor)
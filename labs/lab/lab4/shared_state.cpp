@@ -4,30 +4,21 @@
  */
 
 #include "shared_state.h"
+#include "task_display.h"
 #include <string.h>
 
-static ActuatorState _state;
-static SemaphoreHandle_t _mutex = NULL;
+ActuatorShared g_actuatorState;
 
 void sharedStateInit() {
-    memset(&_state, 0, sizeof(_state));
-    _state.relayCommandOn = false;
-    _state.relayActualOn = false;
-    _state.pwmCommandPercent = 0.0f;
-    _state.inputModeAnalog = false;
-    _state.inputBufferLen = 0;
-    _state.reportRequested = false;
-    _mutex = xSemaphoreCreateMutex();
-}
-
-void sharedStateLock() {
-    xSemaphoreTake(_mutex, portMAX_DELAY);
-}
-
-void sharedStateUnlock() {
-    xSemaphoreGive(_mutex);
-}
-
-ActuatorState* sharedStateGet() {
-    return &_state;
+    ActuatorState initial;
+    memset(&initial, 0, sizeof(initial));
+    initial.relayCommandOn = false;
+    initial.relayActualOn = false;
+    initial.pwmCommandPercent = 0.0f;
+    initial.inputModeAnalog = false;
+    initial.inputBufferLen = 0;
+    initial.reportRequested = false;
+    g_actuatorState.init(initial);
+    // Control-cycle releases mark the display when a shown output moves.
+    g_actuatorState.setReleaseHook(displayStateReleased);
 }
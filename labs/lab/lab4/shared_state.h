@@ -2,59 +2,69 @@
  * @file shared_state.h
  * @brief Lab 4 — Shared State and Synchronization
  *
- * Defines the shared data structure for inter-task communication
- * and provides mutex-protected access functions. All tasks exchange
- * actuator commands and status through this module.
+ * Defines the shared data structure for inter-task communication,
+ * guarded by SharedState's scoped locks. All tasks exchange actuator
+ * commands and status through this module.
  */
 
 #ifndef SHARED_STATE_H
 #define SHARED_STATE_H
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
-#include <semphr.h>
+#include "SharedState.h"
+
+/**
+ * @brief Field groups of ActuatorState, each with its own sub-lock.
+ *
+ * COMMAND is what the operator asks for (input task), OUTPUT what the
+ * control cycle did about it. An ordinary key only needs COMMAND, so it
+ * is not held up by a control cycle in progress; the control cycle and
+ * the emergency stop read commands and drive outputs in one step, under
+ * both.
+ */
+enum ActuatorGroup {
+    ACTUATOR_GROUP_COMMAND = 0x01,
+    ACTUATOR_GROUP_OUTPUT  = 0x02
+};
 
 /**
  * @struct ActuatorState
  * @brief Shared data exchanged between input, control, and display tasks.
  */
 struct ActuatorState {
-    // Binary actuator (relay)
+    // ── ACTUATOR_GROUP_COMMAND ──────────────────────────────────────
     bool relayCommandOn;       // Desired relay state from user
+    float pwmCommandPercent;   // Raw target from user input (0-100)
+
+    // Input mode tracking
+    bool inputModeAnalog;      // True = editing analog value, false = binary
+    char inputBuffer[4];       // Numeric input buffer for PWM %
+    uint8_t inputBufferLen;    // Current length of input buffer
+
+    // Reporting control
+    bool reportRequested;      // One-shot request for immediate serial report
+
+    // ── ACTUATOR_GROUP_OUTPUT ───────────────────────────────────────
+    // Binary actuator (relay)
     bool relayActualOn;        // Actual relay state after debounce
     uint8_t relayDebounceCount; // Current debounce counter
 
     // Analog actuator (PWM)
-    float pwmCommandPercent;   // Raw target from user input (0-100)
     float pwmConditioned;      // After conditioning pipeline
     float pwmRamped;           // After ramping (actual output)
     uint8_t pwmRawValue;       // PWM register value (0-255)
 
     // Alert state
     bool overloadAlert;        // True if analog actuator overloaded
-
-    // Input mode tracking
-    bool inputModeAnalog;      // True = editing analog value, false = binary
-    char inputBuffer[4];       // Numeric input buffer for PWM %
-    uint8_t inputBufferLen;    // Current length of input buffer
-
-    // Reporting control
-    bool reportRequested;      // One-shot request for immediate serial report
 };
 
-/** @brief Initialize shared state and create the mutex. */
-void sharedStateInit();
+/** @brief ActuatorState behind its two sub-locks. */
+typedef SharedState<ActuatorState, 2> ActuatorShared;
 
-/**
- * @brief Lock the shared state mutex (blocking).
- * Must be followed by sharedStateUnlock().
- */
-void sharedStateLock();
-
-/** @brief Unlock the shared state mutex. */
-void sharedStateUnlock();
+/** @brief The shared state; lock with ActuatorShared::Lock. */
+extern ActuatorShared g_actuatorState;
 
-/** @brief Get a pointer to the shared state (only access while locked). */
-ActuatorState* sharedStateGet();
+/** @brief Initialize shared state and create its mutexes. */
+void sharedStateInit();
 
 #endif // SHARED_STATE_H
@@ -5,7 +5,10 @@
  * Runs at 100ms period. Applies debouncing to the binary relay command
  * to prevent false toggles. Processes the analog PWM command through
  * a 4-stage conditioning pipeline (saturate -> median -> EWMA -> ramp)
- * before applying it to the PWM output. Evaluates an overload threshold
+ * before applying it to the PWM output. The ramp is timed: it is stepped
+ * by the measured time since the previous cycle (S-curve, ACT_RAMP_RATE
+ * / ACT_RAMP_ACCEL). An emergency stop skips all of this: see
+ * controlEmergencyStop(). Evaluates an overload threshold
  * alert FSM on the conditioned analog value.
  */
 
@@ -18,6 +21,8 @@
 #include "ActuatorConditioner.h"
 #include "ThresholdAlert.h"
 #include "Led.h"
+#include "RtosTime.h"
+#include "FlashString.h"
 #include <stdio.h>
 
 // Hardware instances
@@ -26,9 +31,9 @@ static PwmActuator pwmAct(PIN_PWM_ACT);
 static Led ledGreen(PIN_LED_GREEN);
 static Led ledRed(PIN_LED_RED);
 
-// Signal conditioning for analog actuator
-static ActuatorConditioner conditioner(
-    ACT_MEDIAN_WINDOW, ACT_EWMA_ALPHA,
+// Signal conditioning for analog actuator (window sized at compile time)
+static StaticActuatorConditioner<ACT_MEDIAN_WINDOW> conditioner(
+    ACT_EWMA_ALPHA,
     ACT_MIN_CLAMP, ACT_MAX_CLAMP,
     ACT_RAMP_STEP
 );
@@ -43,62 +48,93 @@ static ThresholdAlert overloadAlert(
 static bool lastRelayCmd = false;
 static uint8_t relayDebounceCounter = 0;
 
+void controlEmergencyStop(ActuatorState *s) {
+    relay.setState(false);
+    pwmAct.setDuty(conditioner.force(0.0f));
+
+    // Debounce already settled on "off": a stale count cannot re-close it.
+    lastRelayCmd = false;
+    relayDebounceCounter = RELAY_DEBOUNCE_COUNT;
+
+    s->relayCommandOn = false;
+    s->relayActualOn = relay.isOn();
+    s->relayDebounceCount = relayDebounceCounter;
+    s->pwmCommandPercent = 0.0f;
+    s->pwmConditioned = conditioner.getConditionedTarget();
+    s->pwmRamped = conditioner.getRampedOutput();
+    s->pwmRawValue = pwmAct.getRawPwm();
+}
+
 void vTaskControl(void *pvParameters) {
     (void)pvParameters;
 
     relay.init();
     pwmAct.init();
+    if (!pwmAct.enableTimerPwm(ACT_PWM_FREQUENCY_HZ)) {
+        FLASH_PRINTF("[ERROR] PWM: no 16-bit timer on D%d, using analogWrite\r\n", PIN_PWM_ACT);
+    }
     ledGreen.init();
     ledRed.init();
     overloadAlert.init();
+    conditioner.setRampRate(ACT_RAMP_RATE, ACT_RAMP_ACCEL);
     ledGreen.turnOn();
 
-    TickType_t xLastWake = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(TASK_CONTROL_PERIOD_MS);
+    RtosPeriod period(TASK_CONTROL_PERIOD_MS);
+    uint32_t lastRunMs = millis();
 
     for (;;) {
-        sharedStateLock();
-        ActuatorState *s = sharedStateGet();
+        {
+            ActuatorShared::Lock s(g_actuatorState);
+
+            // ── Binary actuator: debounced relay control ────────────────
+            if (s->relayCommandOn == lastRelayCmd) {
+                if (relayDebounceCounter < RELAY_DEBOUNCE_COUNT) {
+                    relayDebounceCounter++;
+                }
+            } else {
+                relayDebounceCounter = 0;
+                lastRelayCmd = s->relayCommandOn;
+            }
 
-        // ── Binary actuator: debounced relay control ────────────────
-        if (s->relayCommandOn == lastRelayCmd) {
-            if (relayDebounceCounter < RELAY_DEBOUNCE_COUNT) {
-                relayDebounceCounter++;
+            if (relayDebounceCounter >= RELAY_DEBOUNCE_COUNT) {
+                relay.setState(lastRelayCmd);
+            }
+            s->relayActualOn = relay.isOn();
+            s->relayDebounceCount = relayDebounceCounter;
+
+            // ── Analog actuator: conditioning pipeline ──────────────────
+            // Ramp over the actual elapsed time (a held lock or a missed
+            // period makes dt longer than the nominal cycle).
+            uint32_t nowMs = millis();
+            float dt = (nowMs - lastRunMs) / 1000.0f;
+            lastRunMs = nowMs;
+            if (dt <= 0.0f) {
+                dt = TASK_CONTROL_PERIOD_MS / 1000.0f;  // First cycle
+            } else if (dt > 1.0f) {
+                dt = 1.0f;                              // Stalled: no jump
             }
-        } else {
-            relayDebounceCounter = 0;
-            lastRelayCmd = s->relayCommandOn;
-        }
 
-        if (relayDebounceCounter >= RELAY_DEBOUNCE_COUNT) {
-            relay.setState(lastRelayCmd);
-        }
-        s->relayActualOn = relay.isOn();
-        s->relayDebounceCount = relayDebounceCounter;
-
-        // ── Analog actuator: conditioning pipeline ──────────────────
-        float rawCmd = s->pwmCommandPercent;
-        float output = conditioner.process(rawCmd);
-        pwmAct.setDuty(output);
-
-        s->pwmConditioned = conditioner.getConditionedTarget();
-        s->pwmRamped = conditioner.getRampedOutput();
-        s->pwmRawValue = pwmAct.getRawPwm();
-
-        // ── Overload alert evaluation ───────────────────────────────
-        overloadAlert.update(output);
-        s->overloadAlert = overloadAlert.isAlertActive();
-
-        // ── LED indicators ──────────────────────────────────────────
-        if (s->overloadAlert) {
-            ledRed.turnOn();
-            ledGreen.turnOff();
-        } else {
-            ledRed.turnOff();
-            ledGreen.turnOn();
+            float rawCmd = s->pwmCommandPercent;
+            float output = conditioner.process(rawCmd, dt);
+            pwmAct.setDuty(output);
+
+            s->pwmConditioned = conditioner.getConditionedTarget();
+            s->pwmRamped = conditioner.getRampedOutput();
+            s->pwmRawValue = pwmAct.getRawPwm();
+
+            // ── Overload alert evaluation ───────────────────────────────
+            overloadAlert.update(output);
+            s->overloadAlert = overloadAlert.isAlertActive();
+
+            // ── LED indicators ──────────────────────────────────────────
+            if (s->overloadAlert) {
+                ledRed.turnOn();
+                ledGreen.turnOff();
+            } else {
+                ledRed.turnOff();
+                ledGreen.turnOn();
+            }
         }
-
-        sharedStateUnlock();
-        vTaskDelayUntil(&xLastWake, xPeriod);
+        period.wait();
     }
 }
@@ -8,6 +8,10 @@
  *     (saturation, median filter, EWMA, ramping)
  *   - Controls relay and PWM hardware outputs
  *   - Evaluates overload threshold alerts
+ *
+ * controlEmergencyStop() is the bypass for keypad 'C': it is called from
+ * the input task and switches both outputs off without waiting for the
+ * next control cycle or the conditioning pipeline.
  */
 
 #ifndef TASK_CONTROL_H
@@ -15,7 +19,21 @@
 
 #include <Arduino_FreeRTOS.h>
 
+struct ActuatorState;
+
 /** @brief FreeRTOS task function for actuator control and conditioning. */
 void vTaskControl(void *pvParameters);
 
+/**
+ * @brief Switch relay and PWM off immediately and resynchronize the
+ *        pipeline and the relay debounce to the stopped state.
+ *
+ * Call with both groups of the shared state locked (that is what
+ * serializes this with the control cycle); s is written as if a control
+ * cycle had just run.
+ *
+ * @param s Shared state, from an ActuatorShared::Lock on SHARED_STATE_ALL.
+ */
+void controlEmergencyStop(ActuatorState *s);
+
 #endif // TASK_CONTROL_H
@@ -6,99 +6,176 @@
  *   Line 1: "Relay:ON  PWM:75%"
  *   Line 2: "Ramp:72% ALR:NO"
  *
- * Every 2 seconds, prints a structured report to the serial terminal
- * with full pipeline diagnostics (raw, conditioned, ramped, alert).
+ * The task sleeps until the LCD would change: the input task marks every
+ * key, and the g_actuatorState release hook marks when the control cycle
+ * moves a shown value (a ramp shows at most every DISPLAY_REFRESH_MIN_MS);
+ * only those marks format the LCD lines again.
+ * Every 2 seconds the heartbeat prints a structured report to the serial
+ * terminal with full pipeline diagnostics (raw, conditioned, ramped,
+ * alert), unless fields are subscribed through the telemetry task. With
+ * REPORT_COMPACT (or "report delta") the heartbeat prints one key=value
+ * line of the fields that changed instead (DeltaReport), nothing when
+ * the outputs are steady; key D and "report" still print the full one.
  */
 
 #include "task_display.h"
 #include "shared_state.h"
 #include "lab4_config.h"
+#include "task_telemetry.h"
 
 #include "LcdDisplay.h"
+#include "DisplayRefresh.h"
+#include "DeltaReport.h"
+#include "FlashString.h"
 #include <stdio.h>
 #include <stdlib.h>  // dtostrf
 
 static LcdDisplay lcd(LCD_I2C_ADDR, LCD_COLS, LCD_ROWS);
+static DisplayRefresh s_refresh(DISPLAY_REFRESH_MIN_MS, DISPLAY_HEARTBEAT_MS);
+
+/** Outputs as the LCD shows them; only the release hook touches it. */
+struct ShownOutputs {
+    bool relayOn;
+    bool alert;
+    int16_t pwmPercent;
+    int16_t rampPercent;
+};
+static ShownOutputs s_shown;
+
+// ── Compact report (REPORT_COMPACT): changed fields only ────────────
+static const DeltaField REPORT_FIELDS[] PROGMEM = {
+    DELTA_FIELD("relaycmd", ActuatorState, relayCommandOn,     FIELD_BOOL,  0, 0.0f),
+    DELTA_FIELD("relay",    ActuatorState, relayActualOn,      FIELD_BOOL,  0, 0.0f),
+    DELTA_FIELD("debounce", ActuatorState, relayDebounceCount, FIELD_U8,    0, 0.0f),
+    DELTA_FIELD("cmd",      ActuatorState, pwmCommandPercent,  FIELD_FLOAT, 1, 0.5f),
+    DELTA_FIELD("cond",     ActuatorState, pwmConditioned,     FIELD_FLOAT, 1, 0.5f),
+    DELTA_FIELD("ramp",     ActuatorState, pwmRamped,          FIELD_FLOAT, 1, 0.5f),
+    DELTA_FIELD("raw",      ActuatorState, pwmRawValue,        FIELD_U8,    0, 1.0f),
+    DELTA_FIELD("alert",    ActuatorState, overloadAlert,      FIELD_BOOL,  0, 0.0f),
+    DELTA_FIELD("mode",     ActuatorState, inputModeAnalog,    FIELD_BOOL,  0, 0.0f),
+};
+static DeltaReport s_delta;
+
+/** Compact or full periodic report; written by displaySetCompact(). */
+static volatile bool s_compact = REPORT_COMPACT;
+
+void displaySetCompact(bool compact) {
+    s_compact = compact;
+    s_refresh.mark(DISPLAY_DIRTY_REPORT);
+}
+
+void displayMark(uint8_t bits) {
+    s_refresh.mark(bits);
+}
+
+void displayStateReleased(const ActuatorState &state, void *context) {
+    (void)context;
+    ShownOutputs now;
+    now.relayOn = state.relayActualOn;
+    now.alert = state.overloadAlert;
+    now.pwmPercent = displayRefreshQuantize(state.pwmCommandPercent, 1.0f);
+    now.rampPercent = displayRefreshQuantize(state.pwmRamped, 1.0f);
+    if (now.relayOn != s_shown.relayOn || now.alert != s_shown.alert ||
+        now.pwmPercent != s_shown.pwmPercent || now.rampPercent != s_shown.rampPercent) {
+        s_shown = now;
+        s_refresh.mark(DISPLAY_DIRTY_LCD);
+    }
+}
 
 void vTaskDisplay(void *pvParameters) {
     (void)pvParameters;
     lcd.init();
 
-    TickType_t xLastWake = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS);
-
-    uint8_t reportCounter = 0;
+    s_refresh.bind();
+    deltaReportInit(&s_delta, REPORT_FIELDS, sizeof(REPORT_FIELDS) / sizeof(REPORT_FIELDS[0]));
+    bool lcdDrawn = false;
 
     for (;;) {
-        sharedStateLock();
-        ActuatorState *s = sharedStateGet();
-
-        // Snapshot values while locked
-        bool relayOn = s->relayActualOn;
-        float pwmCmd = s->pwmCommandPercent;
-        float pwmCond = s->pwmConditioned;
-        float pwmRamp = s->pwmRamped;
-        uint8_t pwmRaw = s->pwmRawValue;
-        bool alert = s->overloadAlert;
-        bool inputMode = s->inputModeAnalog;
-        bool reportRequested = s->reportRequested;
-        s->reportRequested = false;  // consume one-shot request
+        uint8_t why = s_refresh.wait();
+
+        // Copy out under the lock and consume the one-shot request;
+        // everything below works on the copy.
+        ActuatorState s;
+        g_actuatorState.update([&s](ActuatorState &live) {
+            s = live;
+            live.reportRequested = false;
+        });
+
+        bool relayOn = s.relayActualOn;
+        float pwmCmd = s.pwmCommandPercent;
+        float pwmCond = s.pwmConditioned;
+        float pwmRamp = s.pwmRamped;
+        uint8_t pwmRaw = s.pwmRawValue;
+        bool alert = s.overloadAlert;
+        bool inputMode = s.inputModeAnalog;
+        bool reportRequested = s.reportRequested;
         char inputBuf[4];
-        uint8_t inputLen = s->inputBufferLen;
+        uint8_t inputLen = s.inputBufferLen;
         if (inputLen > 3) inputLen = 3;
         for (uint8_t i = 0; i < inputLen && i < 3; i++)
-            inputBuf[i] = s->inputBuffer[i];
+            inputBuf[i] = s.inputBuffer[i];
         inputBuf[inputLen] = '\0';
 
-        sharedStateUnlock();
-
         // ── LCD update ──────────────────────────────────────────────
-        char line1[17], line2[17];
-
-        if (inputMode) {
-            snprintf(line1, 17, "Relay:%-3s [EDIT]",
-                     relayOn ? "ON" : "OFF");
-            snprintf(line2, 17, "PWM=%-3s%%  *=CLR", inputBuf);
-        } else {
-            int rampInt = (int)(pwmRamp + 0.5f);
-            snprintf(line1, 17, "Relay:%-3s PWM%3d%%",
-                     relayOn ? "ON" : "OFF", (int)(pwmCmd + 0.5f));
-            snprintf(line2, 17, "Out:%3d%% %s",
-                     rampInt, alert ? "!ALERT" : "  OK  ");
+        // Render cache: the lines are formatted only for a DISPLAY_DIRTY_LCD
+        // mark (a key, or a shown output moved); the heartbeat and report
+        // wake-ups leave the LCD as drawn.
+        if (!lcdDrawn || (why & DISPLAY_DIRTY_LCD) != 0) {
+            char line1[17], line2[17];
+
+            if (inputMode) {
+                FLASH_SNPRINTF(line1, 17, "Relay:%-3s [EDIT]",
+                               relayOn ? "ON" : "OFF");
+                FLASH_SNPRINTF(line2, 17, "PWM=%-3s%%  *=CLR", inputBuf);
+            } else {
+                int rampInt = (int)(pwmRamp + 0.5f);
+                FLASH_SNPRINTF(line1, 17, "Relay:%-3s PWM%3d%%",
+                               relayOn ? "ON" : "OFF", (int)(pwmCmd + 0.5f));
+                FLASH_SNPRINTF(line2, 17, "Out:%3d%% %s",
+                               rampInt, alert ? "!ALERT" : "  OK  ");
+            }
+
+            lcd.showTwoLines(line1, line2);
+            lcdDrawn = true;
         }
 
-        lcd.showTwoLines(line1, line2);
+        // ── Serial report every 2 seconds (heartbeat) ──────────────
+        // Subscribed fields replace the fixed report on the serial link
+        bool periodicReport = (why & DISPLAY_REFRESH_HEARTBEAT) != 0 &&
+                              !taskTelemetryHasSubscribers();
+
+        bool onDemand = reportRequested || (why & DISPLAY_DIRTY_REPORT) != 0;
 
-        // ── Serial report every 2 seconds (4 x 500ms) ──────────────
-        reportCounter++;
-        bool periodicReport = (reportCounter >= 4);
-        if (periodicReport) {
-            reportCounter = 0;
+        // Compact: the heartbeat prints only what moved since it was last
+        // printed (the configuration is in the banner); key D, "report"
+        // and a mode switch still bring the full report below.
+        if (s_compact && periodicReport && !onDemand) {
+            deltaReportPoll(&s_delta, &s);
+            continue;
         }
 
-        if (periodicReport || reportRequested) {
+        if (periodicReport || onDemand) {
             char cmdBuf[8], condBuf[8], rampBuf[8];
             dtostrf(pwmCmd, 5, 1, cmdBuf);
             dtostrf(pwmCond, 5, 1, condBuf);
             dtostrf(pwmRamp, 5, 1, rampBuf);
 
-            printf("\r\n--- Actuator Status Report ---\r\n");
-            if (reportRequested && !periodicReport) {
-                printf("Trigger: keypad D (on-demand)\r\n");
+            FLASH_PRINTF("\r\n--- Actuator Status Report ---\r\n");
+            if (onDemand && !periodicReport) {
+                FLASH_PRINTF("Trigger: keypad D / report (on-demand)\r\n");
             } else {
-                printf("Trigger: periodic 2s timer\r\n");
+                FLASH_PRINTF("Trigger: periodic 2s timer\r\n");
             }
-            printf("BINARY ACTUATOR (Relay):\r\n");
-            printf("  State: %s\r\n", relayOn ? "ON" : "OFF");
-            printf("ANALOG ACTUATOR (PWM):\r\n");
-            printf("  Command:      %s %%\r\n", cmdBuf);
-            printf("  Conditioned:  %s %%\r\n", condBuf);
-            printf("  Ramped (out): %s %%\r\n", rampBuf);
-            printf("  PWM register: %u / 255\r\n", (unsigned)pwmRaw);
-            printf("ALERT: %s\r\n", alert ? "OVERLOAD ACTIVE" : "Normal");
-            printf("------------------------------\r\n");
+            FLASH_PRINTF("BINARY ACTUATOR (Relay):\r\n");
+            FLASH_PRINTF("  State: %s\r\n", relayOn ? "ON" : "OFF");
+            FLASH_PRINTF("ANALOG ACTUATOR (PWM):\r\n");
+            FLASH_PRINTF("  Command:      %s %%\r\n", cmdBuf);
+            FLASH_PRINTF("  Conditioned:  %s %%\r\n", condBuf);
+            FLASH_PRINTF("  Ramped (out): %s %%\r\n", rampBuf);
+            FLASH_PRINTF("  PWM register: %u / 255\r\n", (unsigned)pwmRaw);
+            FLASH_PRINTF("ALERT: %s\r\n", alert ? "OVERLOAD ACTIVE" : "Normal");
+            FLASH_PRINTF("------------------------------\r\n");
+            deltaReportForce(&s_delta);
         }
-
-        vTaskDelayUntil(&xLastWake, xPeriod);
     }
 }
@@ -2,14 +2,38 @@
  * @file task_display.h
  * @brief Lab 4 — Display & Reporting Task Interface
  *
- * FreeRTOS task running at 500ms that updates the LCD with actuator
- * status and periodically prints a structured serial report.
+ * FreeRTOS task that redraws the LCD when the actuator status it shows
+ * changes (DisplayRefresh) and prints a structured serial report every
+ * 2 seconds or on request; in compact mode (REPORT_COMPACT) the 2 s
+ * report is only the fields that changed.
  */
 
 #ifndef TASK_DISPLAY_H
 #define TASK_DISPLAY_H
 
 #include <Arduino_FreeRTOS.h>
+#include "shared_state.h"
+
+/** @brief Reasons to wake the display task (displayMark()). */
+enum DisplayDirty {
+    DISPLAY_DIRTY_LCD    = 0x01,   ///< Something on the LCD changed
+    DISPLAY_DIRTY_REPORT = 0x02    ///< On-demand serial report (key D, "report")
+};
+
+/** @brief Wake the display task for @p bits (task context). */
+void displayMark(uint8_t bits);
+
+/**
+ * @brief g_actuatorState release hook: marks the LCD when a shown output
+ *        (relay, PWM %, ramp %, alert) changed at the resolution shown.
+ */
+void displayStateReleased(const ActuatorState &state, void *context);
+
+/**
+ * @brief Switch the periodic report between compact (changed fields
+ *        only) and full, and print a full one now (task context).
+ */
+void displaySetCompact(bool compact);
 
 /** @brief FreeRTOS task function for LCD display and serial reporting. */
 void vTaskDisplay(void *pvParameters);
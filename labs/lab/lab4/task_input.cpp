@@ -11,39 +11,67 @@
  *   * = Cancel current input / clear
  *   C = Emergency stop (both actuators off)
  *   D = Request serial status report
+ *
+ * With -DLATENCY_PROBE_ENABLED the emergency stop is timed from the key
+ * read: state lock taken (stop_lock), PWM at zero (stop_pwm). The scan
+ * and debounce before the read are seen only by the loopback ("lat loop",
+ * D46 through an analog switch across the 'C' key, and
+ * -DLATENCY_PROBE_RESPONSE_PIN wired to D48).
  */
 
 #include "task_input.h"
+#include "task_control.h"
+#include "task_display.h"
 #include "shared_state.h"
 #include "lab4_config.h"
 
 #include "KeypadInput.h"
-#include <stdio.h>
+#include "KeypadInputRtos.h"
+#include "DeferredLog.h"
+#include "LatencyProbe.h"
 #include <stdlib.h>
 
 static KeypadInput keypad(KEYPAD_ROW_PINS, KEYPAD_COL_PINS);
 
+#if defined(LATENCY_PROBE_ENABLED)
+// Emergency stop: key read → state lock taken → PWM written.
+static LatencyPath   s_stopPath;
+static PerfHistogram s_stopLockUs;
+static PerfHistogram s_stopPwmUs;
+
+static const PerfDesc LATENCY[] PROGMEM = {
+    PERF_HISTOGRAM("stop_lock", s_stopLockUs),
+    PERF_HISTOGRAM("stop_pwm",  s_stopPwmUs),
+};
+#endif
+
 void vTaskInput(void *pvParameters) {
     (void)pvParameters;
     keypad.init();
-
-    TickType_t xLastWake = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(TASK_INPUT_PERIOD_MS);
+#if defined(LATENCY_PROBE_ENABLED)
+    latencyProbeInit(LATENCY, sizeof(LATENCY) / sizeof(LATENCY[0]));
+#endif
 
     for (;;) {
-        char key = keypad.getKey();
-
-        if (key != 0) {
-            sharedStateLock();
-            ActuatorState *s = sharedStateGet();
+        // Sleeps until a key is pressed (column pin-change wake) or, without
+        // wake-capable columns, re-checks the idle keypad every 50 ms.
+        char key = 0;
+        if (keypadInputWaitKey(keypad, &key, portMAX_DELAY)) {
+            if (key == 'C') {
+                LATENCY_START(s_stopPath);
+            }
+            // Emergency stop drives the outputs too; other keys only
+            // edit commands and do not wait for a control cycle.
+            ActuatorShared::Lock s(g_actuatorState,
+                                   key == 'C' ? SHARED_STATE_ALL : ACTUATOR_GROUP_COMMAND);
 
             switch (key) {
                 case 'A':
                     // Toggle relay command
                     s->relayCommandOn = !s->relayCommandOn;
                     s->inputModeAnalog = false;
-                    printf("[INPUT] Relay cmd: %s\r\n",
-                           s->relayCommandOn ? "ON" : "OFF");
+                    DEFERRED_LOG_PRINTF("[INPUT] Relay cmd: %s\r\n",
+                                        s->relayCommandOn ? "ON" : "OFF");
                     break;
 
                 case 'B':
@@ -51,22 +79,23 @@ void vTaskInput(void *pvParameters) {
                     s->inputModeAnalog = true;
                     s->inputBufferLen = 0;
                     s->inputBuffer[0] = '\0';
-                    printf("[INPUT] Analog mode — enter 0-100 then #\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Analog mode — enter 0-100 then #\r\n");
                     break;
 
                 case 'C':
-                    // Emergency stop
-                    s->relayCommandOn = false;
-                    s->pwmCommandPercent = 0.0f;
+                    // Emergency stop: outputs off now, not after the filters
+                    LATENCY_STAGE(s_stopPath, s_stopLockUs);
+                    controlEmergencyStop(s.get());
+                    LATENCY_END(s_stopPath, s_stopPwmUs);
                     s->inputModeAnalog = false;
                     s->inputBufferLen = 0;
-                    printf("[INPUT] EMERGENCY STOP\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] EMERGENCY STOP\r\n");
                     break;
 
                 case 'D':
                     // One-shot status report request (handled by display task)
                     s->reportRequested = true;
-                    printf("[INPUT] Status report requested\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Status report requested\r\n");
                     break;
 
                 case '#':
@@ -77,7 +106,7 @@ void vTaskInput(void *pvParameters) {
                         if (val < 0) val = 0;
                         if (val > 100) val = 100;
                         s->pwmCommandPercent = (float)val;
-                        printf("[INPUT] PWM set to %d%%\r\n", val);
+                        DEFERRED_LOG_PRINTF("[INPUT] PWM set to %d%%\r\n", val);
                         s->inputBufferLen = 0;
                         s->inputModeAnalog = false;
                     }
@@ -87,7 +116,7 @@ void vTaskInput(void *pvParameters) {
                     // Cancel input
                     s->inputBufferLen = 0;
                     s->inputModeAnalog = false;
-                    printf("[INPUT] Input cancelled\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Input cancelled\r\n");
                     break;
 
                 default:
@@ -96,15 +125,14 @@ void vTaskInput(void *pvParameters) {
                         if (s->inputBufferLen < 3) {
                             s->inputBuffer[s->inputBufferLen++] = key;
                             s->inputBuffer[s->inputBufferLen] = '\0';
-                            printf("[INPUT] Entering: %s%%\r\n", s->inputBuffer);
+                            DEFERRED_LOG_PRINTF("[INPUT] Entering: %s%%\r\n", s->inputBuffer);
                         }
                     }
                     break;
             }
 
-            sharedStateUnlock();
+            // Every key shows (edit buffer, mode, relay); D asks for the report.
+            displayMark(key == 'D' ? DISPLAY_DIRTY_REPORT : DISPLAY_DIRTY_LCD);
         }
-
-        vTaskDelayUntil(&xLastWake, xPeriod);
     }
 }
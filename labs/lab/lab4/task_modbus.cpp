@@ -0,0 +1,87 @@
+/**
+ * @file task_modbus.cpp
+ * @brief Lab 4 — Modbus RTU Slave Task Implementation
+ *
+ * Woken by the USART ISR per request frame; the relay and PWM commands
+ * are stored as the keypad stores them, and the control task picks them
+ * up on its next cycle.
+ */
+
+#include "task_modbus.h"
+#include "FlashString.h"
+
+#if defined(LAB4_MODBUS)
+
+#include "shared_state.h"
+#include "lab4_config.h"
+#include "TaskSignal.h"
+#include <stdio.h>
+
+static const ModbusRegister REGISTERS[] PROGMEM = {
+    MODBUS_INPUT(0, ActuatorState, relayActualOn,       MODBUS_BOOL,  1),
+    MODBUS_INPUT(1, ActuatorState, pwmConditioned,      MODBUS_FLOAT, 100),
+    MODBUS_INPUT(2, ActuatorState, pwmRamped,           MODBUS_FLOAT, 100),
+    MODBUS_INPUT(3, ActuatorState, pwmRawValue,         MODBUS_U8,    1),
+    MODBUS_INPUT(4, ActuatorState, overloadAlert,       MODBUS_BOOL,  1),
+
+    MODBUS_HOLDING(0, ActuatorState, relayCommandOn,    MODBUS_BOOL,  1),
+    MODBUS_HOLDING(1, ActuatorState, pwmCommandPercent, MODBUS_FLOAT, 100),
+};
+static const uint8_t REGISTER_COUNT = sizeof(REGISTERS) / sizeof(REGISTERS[0]);
+
+static ModbusRtu s_modbus;
+static TaskSignal s_frame;
+
+static void onFrame() {
+    s_frame.giveFromIsr();
+}
+
+/** PWM command limited to the clamp range; the rest stored as decoded. */
+static bool onWrite(void *image, const ModbusRegister &reg, float value, bool apply,
+                    void *context) {
+    (void)context;
+    if (reg.offset == offsetof(ActuatorState, pwmCommandPercent) &&
+        (value < ACT_MIN_CLAMP || value > ACT_MAX_CLAMP)) {
+        return false;
+    }
+    if (apply) {
+        modbusRtuStore(image, reg, value);
+    }
+    return true;
+}
+
+void taskModbusInit() {
+    modbusRtuInit(&s_modbus, REGISTERS, REGISTER_COUNT, MODBUS_NODE_ADDRESS, onWrite, NULL);
+    if (!modbusSlaveBegin(MODBUS_BAUD, MODBUS_PARITY, MODBUS_NODE_ADDRESS, PIN_MODBUS_DE,
+                          onFrame)) {
+        FLASH_PRINTF("[ERROR] Modbus: %lu baud not available on USART%u\r\n",
+                     (unsigned long)MODBUS_BAUD, (unsigned)MODBUS_SLAVE_USART);
+    }
+}
+
+void vTaskModbus(void *pvParameters) {
+    (void)pvParameters;
+
+    s_frame.bind();
+
+    for (;;) {
+        // A frame the header cannot size is polled for its silence per tick.
+        s_frame.take(modbusSlaveReceiving() ? 1 : portMAX_DELAY);
+        uint8_t len = modbusSlaveFrame();
+        if (len == 0) {
+            continue;
+        }
+        uint8_t reply;
+        {
+            ActuatorShared::Lock s(g_actuatorState);
+            reply = modbusRtuHandle(&s_modbus, modbusSlaveBuffer(), len, s.get());
+        }
+        if (reply > 0) {
+            modbusSlaveSend(reply);
+        } else {
+            modbusSlaveRelease();
+        }
+    }
+}
+
+#endif // LAB4_MODBUS
@@ -0,0 +1,49 @@
+/**
+ * @file task_modbus.h
+ * @brief Lab 4 — Modbus RTU Slave Task Interface (-DLAB4_MODBUS)
+ *
+ * Serves ActuatorState to an RS-485 master at node MODBUS_NODE_ADDRESS,
+ * 19200 8E1 on USART3 (lab4_config.h). Each request is answered under
+ * the state lock straight from g_actuatorState (ModbusRtu register
+ * table, no copy).
+ *
+ * Input registers (0x04, read-only):
+ *
+ *   addr  field               unit
+ *   0     relayActualOn       0/1 (after debounce)
+ *   1     pwmConditioned      0.01 %
+ *   2     pwmRamped           0.01 % (the output)
+ *   3     pwmRawValue         0..255
+ *   4     overloadAlert       0/1
+ *
+ * Holding registers (0x03 read, 0x06 / 0x10 write):
+ *
+ *   0     relayCommandOn      0/1
+ *   1     pwmCommandPercent   0.01 %, 0..100
+ *
+ * Commands go through the same conditioning, debounce and ramp as the
+ * keypad's; a value out of range answers exception 03.
+ */
+
+#ifndef TASK_MODBUS_H
+#define TASK_MODBUS_H
+
+#if defined(LAB4_MODBUS)
+
+#include "ModbusSlave.h"
+#include "IdleSleep.h"
+
+/** @brief The idle gate of the Modbus USART, kept running by the lab. */
+static const uint16_t LAB4_MODBUS_IDLE_GATE =
+    (MODBUS_SLAVE_USART == 1) ? IDLE_SLEEP_GATE_USART1 :
+    (MODBUS_SLAVE_USART == 2) ? IDLE_SLEEP_GATE_USART2 : IDLE_SLEEP_GATE_USART3;
+
+/** @brief Bind the register table and start the USART (setup()). */
+void taskModbusInit();
+
+/** @brief FreeRTOS task function answering Modbus requests. */
+void vTaskModbus(void *pvParameters);
+
+#endif // LAB4_MODBUS
+
+#endif // TASK_MODBUS_H
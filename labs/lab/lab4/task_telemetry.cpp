@@ -0,0 +1,103 @@
+/**
+ * @file task_telemetry.cpp
+ * @brief Lab 4 — Serial Telemetry Task Implementation
+ *
+ * Runs at 100ms period. Feeds received characters to a CommandStream
+ * bound to the FieldTelemetry commands (and "report", which the display
+ * task prints), then copies the shared state under the mutex and streams
+ * only the fields an operator subscribed to, each at its own decimation
+ * period. The "lat" commands (LatencyProbe) print the emergency-stop
+ * latency histograms.
+ */
+
+#include "task_telemetry.h"
+#include "shared_state.h"
+#include "lab4_config.h"
+#include "task_display.h"
+
+#include "FieldTelemetry.h"
+#include "CommandParser.h"
+#include "LatencyProbe.h"
+#include "StdioSerial.h"
+#include "RtosTime.h"
+#include "FlashString.h"
+#include <stdio.h>
+
+static const FieldDesc FIELDS[] PROGMEM = {
+    FIELD_DESC("relaycmd", ActuatorState, relayCommandOn,     FIELD_BOOL,  0),
+    FIELD_DESC("relay",    ActuatorState, relayActualOn,      FIELD_BOOL,  0),
+    FIELD_DESC("debounce", ActuatorState, relayDebounceCount, FIELD_U8,    0),
+    FIELD_DESC("cmd",      ActuatorState, pwmCommandPercent,  FIELD_FLOAT, 1),
+    FIELD_DESC("cond",     ActuatorState, pwmConditioned,     FIELD_FLOAT, 1),
+    FIELD_DESC("ramp",     ActuatorState, pwmRamped,          FIELD_FLOAT, 1),
+    FIELD_DESC("raw",      ActuatorState, pwmRawValue,        FIELD_U8,    0),
+    FIELD_DESC("alert",    ActuatorState, overloadAlert,      FIELD_BOOL,  0),
+    FIELD_DESC("mode",     ActuatorState, inputModeAnalog,    FIELD_BOOL,  0),
+};
+
+// ── Report commands (printed by the display task) ──────────────────
+
+static void onReportFull(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    displaySetCompact(false);
+}
+
+static void onReportDelta(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    displaySetCompact(true);
+}
+
+static void onReport(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    displayMark(DISPLAY_DIRTY_REPORT);
+}
+
+static const CommandEntry COMMANDS[] PROGMEM = {
+    FIELD_TELEMETRY_COMMANDS,
+    LATENCY_PROBE_COMMANDS,
+    COMMAND_ENTRY("report full",  onReportFull,  ""),
+    COMMAND_ENTRY("report delta", onReportDelta, ""),
+    COMMAND_ENTRY("report",       onReport,      "")
+};
+
+static FieldTelemetry s_fields;
+static CommandStream s_cli;
+
+bool taskTelemetryHasSubscribers() {
+    return fieldTelemetryActive(&s_fields) > 0;
+}
+
+void vTaskTelemetry(void *pvParameters) {
+    (void)pvParameters;
+
+    fieldTelemetryInit(&s_fields, FIELDS, sizeof(FIELDS) / sizeof(FIELDS[0]));
+    commandStreamInit(&s_cli, COMMANDS, sizeof(COMMANDS) / sizeof(COMMANDS[0]), &s_fields);
+
+    RtosPeriod period(TASK_TELEMETRY_PERIOD_MS);
+
+    for (;;) {
+        int c;
+        while ((c = stdioSerialPollChar()) >= 0) {
+            CommandStatus status = commandStreamFeed(&s_cli, (char)c);
+            if (status == COMMAND_NOT_FOUND || status == COMMAND_BAD_ARGS) {
+                FLASH_PRINTF("[ERROR] Unknown command. ");
+                fieldTelemetryPrintHelp();
+            }
+        }
+
+        if (fieldTelemetryActive(&s_fields) > 0) {
+            ActuatorState snapshot;
+            g_actuatorState.snapshot(&snapshot);
+
+            fieldTelemetryPoll(&s_fields, &snapshot, millis());
+        }
+
+        period.wait();
+    }
+}
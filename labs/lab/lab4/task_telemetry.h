@@ -0,0 +1,28 @@
+/**
+ * @file task_telemetry.h
+ * @brief Lab 4 — Serial Telemetry Task Interface
+ *
+ * FreeRTOS task running at 100ms (the control period) that:
+ *   - Reads serial commands: sub <field> <ms>, unsub <field|all>,
+ *     subs, fields (FieldTelemetry)
+ *   - Snapshots ActuatorState and prints the subscribed fields that
+ *     are due, one Serial Plotter line per cycle
+ *
+ * Fields: relaycmd relay debounce cmd cond ramp raw alert mode
+ *
+ * While any field is subscribed the display task skips its periodic
+ * 2 s report (keypad D still prints one on demand).
+ */
+
+#ifndef TASK_TELEMETRY_H
+#define TASK_TELEMETRY_H
+
+#include <Arduino_FreeRTOS.h>
+
+/** @brief FreeRTOS task function for serial field subscriptions. */
+void vTaskTelemetry(void *pvParameters);
+
+/** @brief True while at least one field subscription is active. */
+bool taskTelemetryHasSubscribers();
+
+#endif // TASK_TELEMETRY_H
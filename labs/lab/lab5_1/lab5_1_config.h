@@ -8,6 +8,7 @@
 
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
+#include "ThermalPlant.h"
 
 // Hardware pin mapping from the provided Arduino Mega wiring.
 static const uint8_t PIN_DHT22 = 2;
@@ -30,17 +31,100 @@ static const float SETPOINT_MAX_C = 35.0f;
 static const float SETPOINT_DEFAULT_C = 25.0f;
 static const float SETPOINT_STEP_C = 0.5f;
 
+// Setpoint pot: 2^SETPOINT_POT_OVERSAMPLE_LOG2 reads per sample, snapped
+// to SETPOINT_STEP_C, and moved only once the wiper is this far (% of a
+// step) past the half-step boundary, so ADC noise cannot toggle it.
+static const uint8_t SETPOINT_POT_OVERSAMPLE_LOG2 = 3;
+static const uint8_t SETPOINT_POT_DEAD_BAND_PERCENT = 25;
+
 static const float HYSTERESIS_MIN_C = 0.5f;
 static const float HYSTERESIS_MAX_C = 5.0f;
 static const float HYSTERESIS_DEFAULT_C = 2.0f;
 static const float HYSTERESIS_STEP_C = 0.5f;
 
+// Overshoot anticipation: the controller learns how far the temperature
+// keeps moving after each relay switch and switches that much earlier
+// (at most HYSTERESIS_MAX_LEAD_C, and 40 % of the band), so the room
+// stays inside the band instead of overshooting it every cycle.
+static const bool HYSTERESIS_ANTICIPATE = true;
+static const float HYSTERESIS_MAX_LEAD_C = 1.5f;
+
 static const uint8_t SETPOINT_INPUT_MAX_DIGITS = 3;
 
+// Loop figures (LoopMetrics): IAE, ISE, demand travel and relay switch
+// rate over the last LOOP_METRICS_WINDOW_MS, plus overshoot and settling
+// time of each setpoint step of at least LOOP_METRICS_STEP_C (settled
+// within half the hysteresis band plus LOOP_METRICS_SETTLE_MARGIN_C).
+// A LOOP,... line reports them every LOOP_METRICS_REPORT_MS (0: never).
+static const uint32_t LOOP_METRICS_WINDOW_MS = 3600000UL;
+static const float LOOP_METRICS_STEP_C = 0.5f * SETPOINT_STEP_C;
+static const float LOOP_METRICS_SETTLE_MARGIN_C = 0.5f;
+static const uint32_t LOOP_METRICS_REPORT_MS = 60000UL;
+
+// Settings kept across resets (ConfigStore, settings.h): manual setpoint,
+// setpoint source and hysteresis band, written by the display task once
+// they have not changed for CONFIG_STORE_COALESCE_MS. Bump
+// SETTINGS_VERSION when a key changes meaning: older pages are then ignored.
+static const uint16_t SETTINGS_EEPROM_ADDR = 0;
+static const uint8_t SETTINGS_EEPROM_PAGES = 8;    // 8 x CONFIG_STORE_PAGE_BYTES (576 B)
+static const uint8_t SETTINGS_VERSION = 1;
+
+// Time-proportional heater control (-DLAB5_1_TIME_PROPORTIONAL): a PID
+// demand (%) is turned into the relay's ON share of each window; the
+// minimum ON/OFF times protect the contacts. The hysteresis band is not
+// used in this mode.
+static const uint32_t RELAY_WINDOW_MS = 10000;
+static const uint32_t RELAY_MIN_ON_MS = 1000;
+static const uint32_t RELAY_MIN_OFF_MS = 1000;
+static const uint16_t RELAY_UPDATE_PERIOD_MS = 100;
+static const float HEATER_PID_KP = 25.0f;   // % per °C
+static const float HEATER_PID_KI = 0.3f;    // % per °C·s
+static const float HEATER_PID_KD = 0.0f;
+
+// Staged heater (-DLAB5_1_STAGED_HEATER): STAGED_HEATER_STAGES relays,
+// stage 1 on PIN_RELAY. Stage k is centred STAGED_HEATER_STEP_C × k below
+// the setpoint, each with the keypad's hysteresis band; stage changes
+// are at least STAGED_HEATER_INTER_STAGE_MS apart and the relays rotate
+// so they share the run time.
+static const uint8_t STAGED_HEATER_STAGES = 2;
+static const uint8_t PIN_RELAY_STAGES[STAGED_HEATER_STAGES] = {PIN_RELAY, 22};
+static const float STAGED_HEATER_STEP_C = 1.5f;
+static const uint32_t STAGED_HEATER_MIN_ON_MS = 60000;
+static const uint32_t STAGED_HEATER_MIN_OFF_MS = 60000;
+static const uint32_t STAGED_HEATER_INTER_STAGE_MS = 30000;
+
+// Simulated room (-DLAB5_SIM): acquisition reads a ThermalPlant heated
+// by the relay(s) instead of the DHT11, so bands, anticipation and the
+// heater PID can be tried on a bare board. The plant runs in real time
+// (the controllers time themselves with millis()); the native suite
+// test_thermal_plant runs the same loops in simulated time. Every
+// SIM_REPORT_PERIOD_MS a SIM,... line scores the present setpoint step;
+// it settles inside the hysteresis band plus SIM_SETTLE_MARGIN_C. With
+// nothing on A0, press A for the manual setpoint.
+static const ThermalPlantConfig SIM_PLANT = {
+    22.0f,    // Ambient (°C)
+    14.0f,    // Rise with every stage on (°C)
+    0.0f,     // No fan
+    300.0f,   // τ (s)
+    20.0f,    // Dead time (s)
+    0.1f,     // Reading resolution (°C)
+    0.1f,     // Noise peak (°C)
+};
+static const float SIM_INITIAL_C = 22.0f;
+static const float SIM_HUMIDITY_PERCENT = 45.0f;
+static const float SIM_SETTLE_MARGIN_C = 0.5f;
+static const uint32_t SIM_REPORT_PERIOD_MS = 30000;
+
 // FreeRTOS task periods.
-static const uint16_t TASK_INPUT_PERIOD_MS = 50;
 static const uint16_t TASK_ACQUISITION_PERIOD_MS = 2000;
-static const uint16_t TASK_DISPLAY_PERIOD_MS = 500;
+
+// Display (DisplayRefresh): the LCD is redrawn when a shown value changes,
+// at most every DISPLAY_REFRESH_MIN_MS (a key press shows at once); the
+// heartbeat paces the Serial Plotter line, the settings save and the page
+// flip (every DISPLAY_PAGE_BEATS beats).
+static const uint16_t DISPLAY_REFRESH_MIN_MS = 100;
+static const uint16_t DISPLAY_HEARTBEAT_MS = 500;
+static const uint8_t DISPLAY_PAGE_BEATS = 4;
 
 // FreeRTOS task stack sizes and priorities.
 // Increased for AVR stability with printf/sensor/keypad workloads.
@@ -49,11 +133,19 @@ static const configSTACK_DEPTH_TYPE TASK_ACQUISITION_STACK = 448;
 static const configSTACK_DEPTH_TYPE TASK_CONTROL_STACK = 384;
 static const configSTACK_DEPTH_TYPE TASK_ACTUATION_STACK = 320;
 static const configSTACK_DEPTH_TYPE TASK_DISPLAY_STACK = 896;
+static const configSTACK_DEPTH_TYPE TASK_LOG_STACK = 320;
 
 static const UBaseType_t TASK_INPUT_PRIORITY = 3;
 static const UBaseType_t TASK_ACQUISITION_PRIORITY = 3;
 static const UBaseType_t TASK_CONTROL_PRIORITY = 2;
 static const UBaseType_t TASK_ACTUATION_PRIORITY = 2;
 static const UBaseType_t TASK_DISPLAY_PRIORITY = 1;
+static const UBaseType_t TASK_LOG_PRIORITY = 1;
+
+// Deferred logging: pending keypad messages held for the logger task.
+static const UBaseType_t LOG_QUEUE_DEPTH = 8;
+
+// Acquisition → control: samples buffered while the control task lags.
+static const UBaseType_t SAMPLE_QUEUE_DEPTH = 2;
 
 #endif // LAB5_1_CONFIG_H
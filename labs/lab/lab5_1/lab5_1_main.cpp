@@ -11,111 +11,109 @@
 #include "task_control.h"
 #include "task_actuation.h"
 #include "task_display.h"
+#include "settings.h"
+#include "FlashString.h"
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 #include <stdio.h>
 
 extern "C" void vApplicationStackOverflowHook(TaskHandle_t xTask,
                                                  char *pcTaskName) {
     (void)xTask;
-    printf("[FATAL] Stack overflow in task: %s\r\n",
-           pcTaskName != NULL ? pcTaskName : "<unknown>");
+    FLASH_PRINTF("[FATAL] Stack overflow in task: %s\r\n",
+                 pcTaskName != NULL ? pcTaskName : "<unknown>");
     taskDISABLE_INTERRUPTS();
     for (;;) {}
 }
 
+// Kernel objects are static (StaticRtos); this still catches the heap
+// fallback without configSUPPORT_STATIC_ALLOCATION and any library malloc.
 extern "C" void vApplicationMallocFailedHook(void) {
-    printf("[FATAL] FreeRTOS malloc failed\r\n");
+    FLASH_PRINTF("[FATAL] FreeRTOS malloc failed\r\n");
     taskDISABLE_INTERRUPTS();
     for (;;) {}
 }
 
 #include "StdioSerial.h"
+#include "DeferredLog.h"
+#include "StaticTaskSet.h"
+#include "IdleSleep.h"
 
-void lab5_1Setup() {
-    stdioSerialInit(9600);
+// ──────────────────────────────────────────────────────────────────────────
+// Task set — one row per task; TCBs and stacks reserved at link time
+// (StaticTaskSet)
+// ──────────────────────────────────────────────────────────────────────────
 
-    printf("\r\n");
-    printf("================================================\r\n");
-    printf("  Lab 5.1 - ON-OFF Control with Hysteresis\r\n");
-    printf("  Variant A: DHT11 temperature + relay actuator\r\n");
-    printf("  Arduino Mega | FreeRTOS | LCD | Keypad\r\n");
-    printf("================================================\r\n");
-    printf("KEYPAD:\r\n");
-    printf("  A = toggle setpoint source POT/MANUAL\r\n");
-    printf("  B/C = decrease/increase manual setpoint by 0.5 C\r\n");
-    printf("  D = cycle hysteresis band 0.5..5.0 C\r\n");
-    printf("  digits + # = enter integer manual setpoint\r\n");
-    printf("  * = cancel numeric entry\r\n");
-    printf("PINS:\r\n");
-    printf("  DHT11 data: D%u\r\n", (unsigned)PIN_DHT22);
-    printf("  Relay IN:   D%u\r\n", (unsigned)PIN_RELAY);
-    printf("  Pot SIG:    A0\r\n");
-    printf("  LCD:        SDA/SCL\r\n");
-    printf("PLOTTER LINE:\r\n");
-    printf("  SetPoint:<C> Value:<C> Output:<0/1> Low:<C> High:<C>\r\n");
-    printf("================================================\r\n\r\n");
+static constexpr StaticTaskDesc TASKS[] PROGMEM = {
+    STATIC_TASK(vTaskLab5Input,       "Input",   TASK_INPUT_STACK,       TASK_INPUT_PRIORITY,       0),
+    STATIC_TASK(vTaskLab5Acquisition, "Acquire", TASK_ACQUISITION_STACK, TASK_ACQUISITION_PRIORITY,
+                TASK_ACQUISITION_PERIOD_MS),
+    STATIC_TASK(vTaskLab5Control,     "Control", TASK_CONTROL_STACK,     TASK_CONTROL_PRIORITY,     0),
+    STATIC_TASK(vTaskLab5Actuation,   "Actuate", TASK_ACTUATION_STACK,   TASK_ACTUATION_PRIORITY,   0),
+    STATIC_TASK(vTaskLab5Display,     "Display", TASK_DISPLAY_STACK,     TASK_DISPLAY_PRIORITY,
+                DISPLAY_HEARTBEAT_MS),
+    STATIC_TASK(vTaskDeferredLog,     "Log",     TASK_LOG_STACK,         TASK_LOG_PRIORITY,         0),
+};
+static STATIC_TASK_SET(s_tasks, TASKS);
 
-    lab5StateInit();
-
-    BaseType_t okInput = xTaskCreate(
-        vTaskLab5Input,
-        "Input",
-        TASK_INPUT_STACK,
-        NULL,
-        TASK_INPUT_PRIORITY,
-        NULL
-    );
+/**
+ * @brief Startup banner, printed by the logger task before its first record.
+ *
+ * Over a second at 9600 baud through the 64-byte TX ring: from setup()
+ * it held back every task, as the DeferredLog preamble the sensor and
+ * control tasks start at once.
+ */
+static void printBanner() {
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("  Lab 5.1 - ON-OFF Control with Hysteresis\r\n");
+    FLASH_PRINTF("  Variant A: DHT11 temperature + relay actuator\r\n");
+    FLASH_PRINTF("  Arduino Mega | FreeRTOS | LCD | Keypad\r\n");
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("KEYPAD:\r\n");
+    FLASH_PRINTF("  A = toggle setpoint source POT/MANUAL\r\n");
+    FLASH_PRINTF("  B/C = decrease/increase manual setpoint by 0.5 C\r\n");
+    FLASH_PRINTF("  D = cycle hysteresis band 0.5..5.0 C\r\n");
+    FLASH_PRINTF("  digits + # = enter integer manual setpoint\r\n");
+    FLASH_PRINTF("  * = cancel numeric entry\r\n");
+    FLASH_PRINTF("PINS:\r\n");
+    FLASH_PRINTF("  DHT11 data: D%u\r\n", (unsigned)PIN_DHT22);
+    FLASH_PRINTF("  Relay IN:   D%u\r\n", (unsigned)PIN_RELAY);
+    FLASH_PRINTF("  Pot SIG:    A0\r\n");
+    FLASH_PRINTF("  LCD:        SDA/SCL\r\n");
+    FLASH_PRINTF("PLOTTER LINE:\r\n");
+    FLASH_PRINTF("  SetPoint:<C> Value:<C> Output:<0/1> Low:<C> High:<C> OverH:<C> OverL:<C>\r\n");
+    FLASH_PRINTF("  LOOP,... every %lus: IAE/ISE/travel/switches, step figures\r\n",
+                 (unsigned long)(LOOP_METRICS_REPORT_MS / 1000UL));
+    FLASH_PRINTF("================================================\r\n");
+    lab5SettingsReport();
+    FLASH_PRINTF("\r\n");
+}
 
-    BaseType_t okAcquisition = xTaskCreate(
-        vTaskLab5Acquisition,
-        "Acquire",
-        TASK_ACQUISITION_STACK,
-        NULL,
-        TASK_ACQUISITION_PRIORITY,
-        NULL
-    );
+void lab5_1Setup() {
+    stdioSerialInit(9600);
 
-    BaseType_t okControl = xTaskCreate(
-        vTaskLab5Control,
-        "Control",
-        TASK_CONTROL_STACK,
-        NULL,
-        TASK_CONTROL_PRIORITY,
-        NULL
-    );
+    lab5StateInit();
+    deferredLogInit(LOG_QUEUE_DEPTH);
+    deferredLogSetPreamble(printBanner);
 
-    BaseType_t okActuation = xTaskCreate(
-        vTaskLab5Actuation,
-        "Actuate",
-        TASK_ACTUATION_STACK,
-        NULL,
-        TASK_ACTUATION_PRIORITY,
-        NULL
-    );
+    s_tasks.launch(TASKS);  // [ERROR] line per task that cannot be created
 
-    BaseType_t okDisplay = xTaskCreate(
-        vTaskLab5Display,
-        "Display",
-        TASK_DISPLAY_STACK,
-        NULL,
-        TASK_DISPLAY_PRIORITY,
-        NULL
-    );
+    // Modules lab 5.1 never uses: the relays are plain GPIO (time-
+    // proportional windows run on millis()), the DHT22 is INT4 + micros().
+    idleSleepInit(IDLE_SLEEP_GATE_SPARE_USARTS | IDLE_SLEEP_GATE_SPI |
+                  IDLE_SLEEP_GATE_TIMER1 | IDLE_SLEEP_GATE_TIMER2 |
+                  IDLE_SLEEP_GATE_TIMER3 | IDLE_SLEEP_GATE_TIMER4 |
+                  IDLE_SLEEP_GATE_TIMER5 | IDLE_SLEEP_GATE_ANALOG_COMP);
 
-    if (okInput != pdPASS || okAcquisition != pdPASS ||
-        okControl != pdPASS || okActuation != pdPASS ||
-        okDisplay != pdPASS) {
-        printf("[ERROR] Task creation failed: I=%ld A=%ld C=%ld R=%ld D=%ld\r\n",
-               (long)okInput,
-               (long)okAcquisition,
-               (long)okControl,
-               (long)okActuation,
-               (long)okDisplay);
-    }
+    // Kernel tick on a 1 ms timer compare with -DRTOS_TICK_TIMER (RtosTick.h);
+    // last, as it keeps interrupts off until the scheduler starts.
+    rtosTickInit();
 }
 
 void lab5_1Loop() {
-    // All application logic runs in FreeRTOS tasks.
+    // All logic runs in FreeRTOS tasks. This is the idle hook: sleep
+    // until the next interrupt instead of spinning (IdleSleep).
+    idleSleep();
 }
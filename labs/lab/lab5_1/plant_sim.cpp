@@ -0,0 +1,107 @@
+/**
+ * @file plant_sim.cpp
+ * @brief Lab 5.1 simulated room implementation (-DLAB5_SIM only).
+ */
+
+#if defined(LAB5_SIM)
+
+#include "plant_sim.h"
+#include "lab5_1_config.h"
+#include "shared_state.h"
+#include "StepMetrics.h"
+#include "ThermalPlant.h"
+#include "FlashString.h"
+
+#include <Arduino_FreeRTOS.h>
+#include <math.h>
+#include <stdio.h>
+
+static ThermalPlant s_plant(SIM_PLANT);
+static StepMetrics s_metrics;
+static float s_heaterPercent = 0.0f;   // Posted by the actuation task
+static uint32_t s_heaterSinceMs = 0;   // When it last changed
+static uint32_t s_lastMs = 0;
+static uint32_t s_nextReportMs = 0;
+
+static void report(float temperature) {
+    char sp[10], t[10], settle[10], over[10], iae[12];
+    dtostrf(s_metrics.getSetpoint(), 1, 1, sp);
+    dtostrf(temperature, 1, 2, t);
+    dtostrf(s_metrics.getOvershoot(), 1, 2, over);
+    dtostrf(s_metrics.getIae(), 1, 1, iae);
+    if (s_metrics.isSettled()) {
+        dtostrf(s_metrics.getSettlingTimeMs() / 1000.0f, 1, 0, settle);
+    } else {
+        settle[0] = '-';
+        settle[1] = '\0';
+    }
+    FLASH_PRINTF("SIM,step=%lu,sp=%s,T=%s,heat=%u,settle=%s,over=%s,iae=%s\r\n",
+                 (unsigned long)(s_metrics.getElapsedMs() / 1000UL), sp, t,
+                 (unsigned)(s_plant.getHeater() + 0.5f), settle, over, iae);
+}
+
+/** @brief Restart the score on a setpoint change, otherwise extend it. */
+static void score(uint32_t now) {
+    float setpoint = 0.0f;
+    float band = 0.0f;
+    g_lab5State.read([&setpoint, &band](const Lab5ControlState &s) {
+        setpoint = s.activeSetpointC;
+        band = s.hysteresisBandC;
+    });
+
+    float temperature = s_plant.getTemperatureC();
+    if (!s_metrics.isActive() ||
+        fabsf(setpoint - s_metrics.getSetpoint()) >= 0.5f * SETPOINT_STEP_C) {
+        s_metrics.begin(setpoint, temperature, now, 0.5f * band + SIM_SETTLE_MARGIN_C);
+        s_nextReportMs = now;
+    } else {
+        s_metrics.update(temperature, now);
+    }
+
+    if ((int32_t)(now - s_nextReportMs) >= 0) {
+        report(temperature);
+        s_nextReportMs = now + SIM_REPORT_PERIOD_MS;
+    }
+}
+
+void lab5SimInit() {
+    s_plant.init(SIM_INITIAL_C);
+    s_lastMs = millis();
+    FLASH_PRINTF("SIM: simulated room, tau=%us dead=%us (DHT11 not read)\r\n",
+                 (unsigned)SIM_PLANT.timeConstantS, (unsigned)SIM_PLANT.deadTimeS);
+}
+
+float lab5SimRead() {
+    float heater;
+    uint32_t since;
+    taskENTER_CRITICAL();
+    heater = s_heaterPercent;
+    since = s_heaterSinceMs;
+    taskEXIT_CRITICAL();
+
+    // The old input up to the (last) switch, the new one after it.
+    uint32_t now = millis();
+    if (heater != s_plant.getHeater() && (int32_t)(since - s_lastMs) > 0) {
+        s_plant.advance(since - s_lastMs);
+        s_lastMs = since;
+    }
+    s_plant.setHeater(heater);
+    s_plant.advance(now - s_lastMs);
+    s_lastMs = now;
+
+    float reading = s_plant.read();
+    score(now);
+    return reading;
+}
+
+void lab5SimSetHeater(float percent) {
+    uint32_t now = millis();
+    taskENTER_CRITICAL();
+    if (percent != s_heaterPercent) {
+        s_heaterPercent = percent;
+        s_heaterSinceMs = now;
+    }
+    taskEXIT_CRITICAL();
+}
+
+#endif // LAB5_SIM
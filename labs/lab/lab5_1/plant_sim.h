@@ -0,0 +1,31 @@
+/**
+ * @file plant_sim.h
+ * @brief Lab 5.1 simulated room (-DLAB5_SIM).
+ *
+ * Replaces the DHT11 reading with a ThermalPlant (SIM_PLANT) whose heater
+ * input follows the relays, and scores every setpoint step with
+ * StepMetrics. The acquisition task owns the plant; the actuation task
+ * only posts the heater input.
+ */
+
+#ifndef LAB5_1_PLANT_SIM_H
+#define LAB5_1_PLANT_SIM_H
+
+/** @brief Start the plant at SIM_INITIAL_C (acquisition task, before the first read). */
+void lab5SimInit();
+
+/**
+ * @brief Advance the plant to now and take a sensor reading.
+ *
+ * Also scores the active setpoint's step and prints a
+ * SIM,step=<s>,sp=<C>,T=<C>,heat=<%>,settle=<s|->,over=<C>,iae=<C*s> line
+ * every SIM_REPORT_PERIOD_MS and at each new step.
+ *
+ * @return The reading, quantized and noisy like the DHT's.
+ */
+float lab5SimRead();
+
+/** @brief Heater input of the plant (0..100 %, share of the stages on). */
+void lab5SimSetHeater(float percent);
+
+#endif // LAB5_1_PLANT_SIM_H
@@ -0,0 +1,62 @@
+/**
+ * @file settings.cpp
+ * @brief Lab 5.1 settings implementation.
+ */
+
+#include "settings.h"
+#include "lab5_1_config.h"
+#include "ConfigStore.h"
+#include "FlashString.h"
+
+#include <stdio.h>
+
+static_assert(SETTINGS_EEPROM_ADDR + (uint32_t)SETTINGS_EEPROM_PAGES * CONFIG_STORE_PAGE_BYTES <= 4096,
+              "settings exceed the ATmega2560 EEPROM");
+
+// Keys: never reuse one for another meaning without bumping SETTINGS_VERSION.
+static const uint8_t KEY_MANUAL_SETPOINT = 1;
+static const uint8_t KEY_SETPOINT_SOURCE = 2;
+static const uint8_t KEY_HYSTERESIS_BAND = 3;
+
+static ConfigStore s_config(SETTINGS_EEPROM_ADDR, SETTINGS_EEPROM_PAGES, SETTINGS_VERSION);
+static bool s_restored = false;
+
+void lab5SettingsLoad(Lab5ControlState *state) {
+    // Silent: the banner, printed later by the logger, reports it.
+    s_restored = s_config.begin();
+    if (!s_restored) {
+        return;
+    }
+
+    float value;
+    if (s_config.getFloat(KEY_MANUAL_SETPOINT, &value) &&
+        value >= SETPOINT_MIN_C && value <= SETPOINT_MAX_C) {
+        state->manualSetpointC = value;
+    }
+    uint8_t source;
+    if (s_config.getU8(KEY_SETPOINT_SOURCE, &source) && source == SETPOINT_SOURCE_MANUAL) {
+        state->setpointSource = SETPOINT_SOURCE_MANUAL;
+        state->activeSetpointC = state->manualSetpointC;
+    }
+    if (s_config.getFloat(KEY_HYSTERESIS_BAND, &value) &&
+        value >= HYSTERESIS_MIN_C && value <= HYSTERESIS_MAX_C) {
+        state->hysteresisBandC = value;
+    }
+    state->lowerThresholdC = state->activeSetpointC - state->hysteresisBandC * 0.5f;
+    state->upperThresholdC = state->activeSetpointC + state->hysteresisBandC * 0.5f;
+}
+
+void lab5SettingsService(const Lab5ControlState &snapshot) {
+    // Unchanged values cost nothing; a change restarts the quiet time.
+    s_config.setFloat(KEY_MANUAL_SETPOINT, snapshot.manualSetpointC);
+    s_config.setU8(KEY_SETPOINT_SOURCE, (uint8_t)snapshot.setpointSource);
+    s_config.setFloat(KEY_HYSTERESIS_BAND, snapshot.hysteresisBandC);
+    s_config.service();
+}
+
+void lab5SettingsReport() {
+    FLASH_PRINTF("[CFG] %s at boot; %u of %u pages valid, %u written since boot%s\r\n",
+                 s_restored ? "restored" : "defaults",
+                 (unsigned)s_config.getStoredPages(), (unsigned)SETTINGS_EEPROM_PAGES,
+                 (unsigned)s_config.getWriteCount(), s_config.isDirty() ? ", change pending" : "");
+}
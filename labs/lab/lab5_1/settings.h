@@ -0,0 +1,37 @@
+/**
+ * @file settings.h
+ * @brief Lab 5.1 settings kept across resets (ConfigStore).
+ *
+ * The manual setpoint, the setpoint source and the hysteresis band
+ * survive a reset. They are loaded once, at startup, and saved by the
+ * display task: every period it hands the current values to the store,
+ * which writes one wear-levelled EEPROM page once they have been
+ * unchanged for CONFIG_STORE_COALESCE_MS. The keypad and control tasks
+ * never wait for the EEPROM.
+ *
+ * Usage:
+ *   lab5SettingsLoad(&initial);        // lab5StateInit()
+ *   lab5SettingsService(snapshot);     // display task, every period
+ *   lab5SettingsReport();              // banner
+ */
+
+#ifndef LAB5_1_SETTINGS_H
+#define LAB5_1_SETTINGS_H
+
+#include "shared_state.h"
+
+/**
+ * @brief Load the store and apply the stored values to @p state.
+ *
+ * Prints nothing (it runs in setup()); lab5SettingsReport() says whether
+ * values were restored.
+ */
+void lab5SettingsLoad(Lab5ControlState *state);
+
+/** @brief Hand the current values to the store and write if due (display task). */
+void lab5SettingsService(const Lab5ControlState &snapshot);
+
+/** @brief Print the store status line (banner). */
+void lab5SettingsReport();
+
+#endif // LAB5_1_SETTINGS_H
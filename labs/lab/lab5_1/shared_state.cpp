@@ -4,47 +4,54 @@
  */
 
 #include "shared_state.h"
+#include "StaticRtos.h"
 #include "lab5_1_config.h"
+#include "settings.h"
+#include "task_display.h"
 #include <string.h>
 
-Lab5ControlState g_lab5State;
-SemaphoreHandle_t xLab5StateMutex = NULL;
-SemaphoreHandle_t xLab5NewSampleSemaphore = NULL;
-SemaphoreHandle_t xLab5ActuatorSemaphore = NULL;
+Lab5Shared g_lab5State;
+QueueHandle_t xLab5SampleQueue = NULL;
+QueueHandle_t xLab5CommandQueue = NULL;
 
-void lab5StateInit() {
-    memset(&g_lab5State, 0, sizeof(g_lab5State));
-
-    g_lab5State.measuredTempC = NAN;
-    g_lab5State.measuredHumidityPercent = NAN;
-    g_lab5State.sensorValid = false;
-    g_lab5State.manualSetpointC = SETPOINT_DEFAULT_C;
-    g_lab5State.activeSetpointC = SETPOINT_DEFAULT_C;
-    g_lab5State.potSetpointC = SETPOINT_DEFAULT_C;
-    g_lab5State.setpointSource = SETPOINT_SOURCE_POT;
-    g_lab5State.hysteresisBandC = HYSTERESIS_DEFAULT_C;
-    g_lab5State.lowerThresholdC = SETPOINT_DEFAULT_C - HYSTERESIS_DEFAULT_C * 0.5f;
-    g_lab5State.upperThresholdC = SETPOINT_DEFAULT_C + HYSTERESIS_DEFAULT_C * 0.5f;
-    g_lab5State.controlCommandOn = false;
-    g_lab5State.actuatorOn = false;
-    g_lab5State.controllerState = HYSTERESIS_OUTPUT_OFF;
-    g_lab5State.editingSetpoint = false;
-    g_lab5State.inputBuffer[0] = '\0';
-    g_lab5State.inputBufferLen = 0;
+// Kernel objects on storage reserved at link time (StaticRtos)
+static StaticQueue<Lab5Sample, SAMPLE_QUEUE_DEPTH> s_sampleQueue;
+static StaticQueue<Lab5Command, 1> s_commandQueue;
 
-    xLab5StateMutex = xSemaphoreCreateMutex();
-    xLab5NewSampleSemaphore = xSemaphoreCreateBinary();
-    xLab5ActuatorSemaphore = xSemaphoreCreateBinary();
-}
-
-void lab5StateLock() {
-    xSemaphoreTake(xLab5StateMutex, portMAX_DELAY);
-}
-
-void lab5StateUnlock() {
-    xSemaphoreGive(xLab5StateMutex);
-}
-
-Lab5ControlState* lab5StateGet() {
-    return &g_lab5State;
+void lab5StateInit() {
+    Lab5ControlState initial;
+    memset(&initial, 0, sizeof(initial));
+
+    initial.measuredTempC = NAN;
+    initial.measuredHumidityPercent = NAN;
+    initial.sensorValid = false;
+    initial.manualSetpointC = SETPOINT_DEFAULT_C;
+    initial.activeSetpointC = SETPOINT_DEFAULT_C;
+    initial.potSetpointC = SETPOINT_DEFAULT_C;
+    initial.setpointSource = SETPOINT_SOURCE_POT;
+    initial.hysteresisBandC = HYSTERESIS_DEFAULT_C;
+    initial.lowerThresholdC = SETPOINT_DEFAULT_C - HYSTERESIS_DEFAULT_C * 0.5f;
+    initial.upperThresholdC = SETPOINT_DEFAULT_C + HYSTERESIS_DEFAULT_C * 0.5f;
+    initial.overshootHighC = 0.0f;
+    initial.overshootLowC = 0.0f;
+    initial.controlCommandOn = false;
+    initial.demandPercent = 0.0f;
+    initial.stageMask = 0;
+    initial.stagesDemanded = 0;
+    initial.actuatorOn = false;
+    initial.controllerState = HYSTERESIS_OUTPUT_OFF;
+    initial.editingSetpoint = false;
+    initial.inputBuffer[0] = '\0';
+    initial.inputBufferLen = 0;
+    initial.loop.stepSettleS = NAN;
+    initial.loop.lastOvershoot = NAN;
+    initial.loop.lastSettleS = NAN;
+    initial.loop.lastIae = NAN;
+
+    lab5SettingsLoad(&initial);
+
+    g_lab5State.init(initial);
+    g_lab5State.setReleaseHook(lab5DisplayStateReleased);
+    xLab5SampleQueue = s_sampleQueue.create();
+    xLab5CommandQueue = s_commandQueue.create();
 }
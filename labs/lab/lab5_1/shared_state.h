@@ -8,9 +8,11 @@
 
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
-#include <semphr.h>
+#include <queue.h>
 #include "lab5_1_config.h"
+#include "LoopMetrics.h"
 #include "OnOffHysteresisController.h"
+#include "SharedState.h"
 
 enum SetpointSource {
     SETPOINT_SOURCE_POT = 0,
@@ -30,7 +32,12 @@ struct Lab5ControlState {
     float hysteresisBandC;
     float lowerThresholdC;
     float upperThresholdC;
+    float overshootHighC;         ///< Learned rise after switching OFF
+    float overshootLowC;          ///< Learned fall after switching ON
     bool controlCommandOn;
+    float demandPercent;          ///< Time-proportional mode: relay duty
+    uint8_t stageMask;            ///< Staged mode: relay bit mask
+    uint8_t stagesDemanded;       ///< Staged mode: stages the error calls for
     bool actuatorOn;
     HysteresisOutputState controllerState;
 
@@ -41,17 +48,44 @@ struct Lab5ControlState {
     uint32_t sampleCount;
     uint32_t controlCycles;
     uint32_t actuatorSwitches;
+    uint32_t sampleOverruns;      ///< Samples dropped on a full sample queue
+    uint32_t commandOverruns;     ///< Commands replaced before actuation ran
+    LoopMetricsReport loop;       ///< Loop figures (control task)
     TickType_t lastSampleTick;
 };
 
-extern Lab5ControlState g_lab5State;
-extern SemaphoreHandle_t xLab5StateMutex;
-extern SemaphoreHandle_t xLab5NewSampleSemaphore;
-extern SemaphoreHandle_t xLab5ActuatorSemaphore;
+/** @brief One acquisition, queued to the control task (xLab5SampleQueue). */
+struct Lab5Sample {
+    TickType_t tick;              ///< Acquisition time
+    float temperatureC;
+    float setpointC;              ///< Active setpoint at acquisition
+    bool valid;
+};
+
+/** @brief Latest control decision (xLab5CommandQueue mailbox). */
+struct Lab5Command {
+    TickType_t sampleTick;        ///< Sample the decision was made on
+    bool commandOn;
+    float demandPercent;          ///< Time-proportional mode
+    uint8_t stageMask;            ///< Staged mode
+};
+
+/** @brief Lab5ControlState behind one mutex. */
+typedef SharedState<Lab5ControlState> Lab5Shared;
+
+/** @brief The shared state; lock with Lab5Shared::Lock or use read()/update()/snapshot(). */
+extern Lab5Shared g_lab5State;
+
+/** @brief Acquisition → control, SAMPLE_QUEUE_DEPTH samples, never waits. */
+extern QueueHandle_t xLab5SampleQueue;
+
+/**
+ * @brief Control → actuation, one-slot mailbox: only the latest command
+ *        matters for the relay, so a newer one overwrites a pending one
+ *        (counted in commandOverruns).
+ */
+extern QueueHandle_t xLab5CommandQueue;
 
 void lab5StateInit();
-void lab5StateLock();
-void lab5StateUnlock();
-Lab5ControlState* lab5StateGet();
 
 #endif // LAB5_1_SHARED_STATE_H
@@ -1,17 +1,23 @@
 /**
  * @file task_acquisition.cpp
  * @brief Lab 5.1 DHT11 and potentiometer acquisition task.
+ *
+ * With -DLAB5_SIM the temperature comes from the simulated room
+ * (plant_sim.h) instead of the DHT11.
  */
 
 #include "task_acquisition.h"
 #include "lab5_1_config.h"
 #include "shared_state.h"
 
+#include "plant_sim.h"
+
 #include "DhtSensor.h"
+#include "DhtSensorRtos.h"
 #include "AnalogSetpointInput.h"
+#include "RtosTime.h"
 
 #include <Arduino_FreeRTOS.h>
-#include <DHT.h>
 
 static DhtSensor s_dht(PIN_DHT22, DHT11);
 static AnalogSetpointInput s_setpointPot(
@@ -23,40 +29,60 @@ static AnalogSetpointInput s_setpointPot(
 void vTaskLab5Acquisition(void *pvParameters) {
     (void)pvParameters;
 
+#if defined(LAB5_SIM)
+    lab5SimInit();
+#else
     s_dht.init();
+#endif
     s_setpointPot.init();
+    s_setpointPot.setQuantization(SETPOINT_STEP_C, SETPOINT_POT_OVERSAMPLE_LOG2,
+                                  SETPOINT_POT_DEAD_BAND_PERCENT);
 
-    TickType_t lastWake = xTaskGetTickCount();
-    const TickType_t period = pdMS_TO_TICKS(TASK_ACQUISITION_PERIOD_MS);
+    RtosPeriod period(TASK_ACQUISITION_PERIOD_MS);
 
     for (;;) {
-        bool sensorOk = s_dht.read();
+#if defined(LAB5_SIM)
+        bool sensorOk = true;
+        float temperature = lab5SimRead();
+        float humidity = SIM_HUMIDITY_PERCENT;
+#else
+        // Sleeps through the start pulse, then waits on the edge ISR's
+        // notification: interrupts stay enabled for the whole read.
+        bool sensorOk = dhtSensorReadRtos(s_dht);
         float temperature = s_dht.getTemperatureC();
         float humidity = s_dht.getHumidityPercent();
+#endif
         float potSetpoint = s_setpointPot.readValue();
         uint16_t potRaw = s_setpointPot.getLastRaw();
 
-        lab5StateLock();
-        Lab5ControlState *state = lab5StateGet();
+        {
+            Lab5Shared::Lock state(g_lab5State);
 
-        state->sensorValid = sensorOk;
-        state->measuredTempC = temperature;
-        state->measuredHumidityPercent = humidity;
-        state->potRaw = potRaw;
-        state->potSetpointC = potSetpoint;
+            state->sensorValid = sensorOk;
+            state->measuredTempC = temperature;
+            state->measuredHumidityPercent = humidity;
+            state->potRaw = potRaw;
+            state->potSetpointC = potSetpoint;
 
-        if (state->setpointSource == SETPOINT_SOURCE_POT) {
-            state->activeSetpointC = potSetpoint;
-        } else {
-            state->activeSetpointC = state->manualSetpointC;
-        }
+            if (state->setpointSource == SETPOINT_SOURCE_POT) {
+                state->activeSetpointC = potSetpoint;
+            } else {
+                state->activeSetpointC = state->manualSetpointC;
+            }
 
-        state->sampleCount++;
-        state->lastSampleTick = xTaskGetTickCount();
+            state->sampleCount++;
+            state->lastSampleTick = xTaskGetTickCount();
 
-        lab5StateUnlock();
-        xSemaphoreGive(xLab5NewSampleSemaphore);
+            Lab5Sample sample;
+            sample.tick = state->lastSampleTick;
+            sample.temperatureC = temperature;
+            sample.setpointC = state->activeSetpointC;
+            sample.valid = sensorOk;
+            if (xQueueSend(xLab5SampleQueue, &sample, 0) != pdTRUE) {
+                state->sampleOverruns++;  // Control is a whole queue behind
+            }
+        }
 
-        vTaskDelayUntil(&lastWake, period);
+        period.wait();
     }
 }
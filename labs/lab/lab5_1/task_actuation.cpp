@@ -1,44 +1,127 @@
 /**
  * @file task_actuation.cpp
  * @brief Lab 5.1 relay actuation task implementation.
+ *
+ * With -DLAB5_1_TIME_PROPORTIONAL the relay runs in time-proportional
+ * mode: each control command only updates the demand, and the task wakes
+ * every RELAY_UPDATE_PERIOD_MS to switch it within the window.
+ *
+ * With -DLAB5_1_STAGED_HEATER each command carries a stage bit mask and
+ * the task drives one relay per stage (PIN_RELAY_STAGES); the controller
+ * already enforces the minimum ON/OFF times.
+ *
+ * With -DLAB5_SIM the relay states also drive the simulated room's
+ * heater (plant_sim.h); the relays still switch.
  */
 
 #include "task_actuation.h"
 #include "lab5_1_config.h"
 #include "shared_state.h"
 #include "Relay.h"
+#include "plant_sim.h"
 
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 
 static Relay s_relay(PIN_RELAY, RELAY_ACTIVE_HIGH);
 
+#if defined(LAB5_1_STAGED_HEATER)
+static Relay s_stageRelays[STAGED_HEATER_STAGES - 1] = {
+    Relay(PIN_RELAY_STAGES[1], RELAY_ACTIVE_HIGH),
+};
+
+/** @brief Relay of stage output @p i (stage 1 is s_relay on PIN_RELAY). */
+static Relay &stageRelay(uint8_t i) {
+    return (i == 0) ? s_relay : s_stageRelays[i - 1];
+}
+
+/** @brief Drive every stage relay from a bit mask; returns the live mask. */
+static uint8_t applyStageMask(uint8_t mask) {
+    uint8_t live = 0;
+    for (uint8_t i = 0; i < STAGED_HEATER_STAGES; i++) {
+        stageRelay(i).setState((mask & (1U << i)) != 0);
+        if (stageRelay(i).isOn()) {
+            live |= (uint8_t)(1U << i);
+        }
+    }
+    return live;
+}
+#endif
+
 void vTaskLab5Actuation(void *pvParameters) {
     (void)pvParameters;
 
     s_relay.init();
+#if defined(LAB5_1_STAGED_HEATER)
+    for (uint8_t i = 1; i < STAGED_HEATER_STAGES; i++) {
+        stageRelay(i).init();
+    }
+#endif
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+    s_relay.setTimeProportional(RELAY_WINDOW_MS, RELAY_MIN_ON_MS, RELAY_MIN_OFF_MS);
+    const TickType_t waitTicks = pdMS_TO_TICKS(RELAY_UPDATE_PERIOD_MS);
+#else
+    const TickType_t waitTicks = portMAX_DELAY;
+#endif
 
-    lab5StateLock();
-    lab5StateGet()->actuatorOn = s_relay.isOn();
-    lab5StateUnlock();
+    g_lab5State.update([](Lab5ControlState &s) { s.actuatorOn = s_relay.isOn(); });
 
+    Lab5Command command = { 0, false, 0.0f, 0 };  // Until the first one
     for (;;) {
-        if (xSemaphoreTake(xLab5ActuatorSemaphore, portMAX_DELAY) != pdTRUE) {
+        bool newCommand = xQueueReceive(xLab5CommandQueue, &command, waitTicks) == pdTRUE;
+#if !defined(LAB5_1_TIME_PROPORTIONAL)
+        if (!newCommand) {
             continue;
         }
+#endif
 
-        lab5StateLock();
-        bool commandOn = lab5StateGet()->controlCommandOn;
-        bool previousOn = lab5StateGet()->actuatorOn;
-        lab5StateUnlock();
+        bool previousOn = false;
+        g_lab5State.read([&previousOn](const Lab5ControlState &s) {
+            previousOn = s.actuatorOn;
+        });
+        bool commandOn = command.commandOn;
+        float demand = command.demandPercent;
+#if defined(LAB5_1_STAGED_HEATER)
+        uint8_t stageMask = command.stageMask;
+#endif
 
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+        (void)commandOn;
+        if (newCommand) {
+            s_relay.setDemand(demand);
+        }
+        s_relay.update();
+        if (!newCommand && s_relay.isOn() == previousOn) {
+            continue;  // Nothing to publish
+        }
+#elif defined(LAB5_1_STAGED_HEATER)
+        (void)commandOn;
+        (void)demand;
+        stageMask = applyStageMask(stageMask);
+#else
+        (void)demand;
         s_relay.setState(commandOn);
+#endif
+
+#if defined(LAB5_SIM) && defined(LAB5_1_STAGED_HEATER)
+        uint8_t stagesOn = 0;
+        for (uint8_t i = 0; i < STAGED_HEATER_STAGES; i++) {
+            stagesOn += (stageMask >> i) & 1U;
+        }
+        lab5SimSetHeater(100.0f * stagesOn / STAGED_HEATER_STAGES);
+#elif defined(LAB5_SIM)
+        lab5SimSetHeater(s_relay.isOn() ? 100.0f : 0.0f);
+#endif
 
-        lab5StateLock();
-        Lab5ControlState *state = lab5StateGet();
-        state->actuatorOn = s_relay.isOn();
-        if (state->actuatorOn != previousOn) {
-            state->actuatorSwitches++;
+        {
+            Lab5Shared::Lock state(g_lab5State);
+#if defined(LAB5_1_STAGED_HEATER)
+            state->actuatorOn = stageMask != 0;
+#else
+            state->actuatorOn = s_relay.isOn();
+#endif
+            if (state->actuatorOn != previousOn) {
+                state->actuatorSwitches++;
+            }
         }
-        lab5StateUnlock();
     }
 }
@@ -1,38 +1,101 @@
 /**
  * @file task_control.cpp
  * @brief Lab 5.1 ON-OFF hysteresis control task implementation.
+ *
+ * With -DLAB5_1_TIME_PROPORTIONAL the relay command is a PID demand
+ * (0–100 %) instead, played by the relay's time-proportional mode.
+ * With -DLAB5_1_STAGED_HEATER a StagedHysteresisController switches a
+ * bank of heater relays, one stage per STAGED_HEATER_STEP_C of error.
+ *
+ * Every cycle also feeds LoopMetrics with the error, the heat demand
+ * (0/100 %, the PID demand, or the share of stages on) and the actuation
+ * task's relay switch count; the display task prints the figures.
  */
 
 #include "task_control.h"
 #include "lab5_1_config.h"
 #include "shared_state.h"
 #include "OnOffHysteresisController.h"
+#include "LoopMetrics.h"
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+#include "PidController.h"
+#elif defined(LAB5_1_STAGED_HEATER)
+#include "StagedHysteresisController.h"
+#endif
 
 #include <Arduino_FreeRTOS.h>
 #include <math.h>
 
+#if defined(LAB5_1_TIME_PROPORTIONAL) && defined(LAB5_1_STAGED_HEATER)
+#error "LAB5_1_TIME_PROPORTIONAL and LAB5_1_STAGED_HEATER are exclusive"
+#endif
+
 static OnOffHysteresisController s_controller(
     SETPOINT_DEFAULT_C,
     HYSTERESIS_DEFAULT_C
 );
 
+static LoopMetrics s_loopMetrics(LOOP_METRICS_WINDOW_MS, LOOP_METRICS_STEP_C);
+
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+static PidController s_pid(
+    HEATER_PID_KP,
+    HEATER_PID_KI,
+    HEATER_PID_KD,
+    0.0f,
+    100.0f,
+    PID_DIRECT
+);
+#elif defined(LAB5_1_STAGED_HEATER)
+static StagedHysteresisController s_staged(
+    STAGED_HEATER_STAGES,
+    SETPOINT_DEFAULT_C,
+    STAGED_HEATING
+);
+
+/** @brief Stage k centred k steps below the setpoint, keypad band each. */
+static void configureStages(float hysteresis) {
+    for (uint8_t i = 0; i < STAGED_HEATER_STAGES; i++) {
+        s_staged.setStage(i, STAGED_HEATER_STEP_C * (float)i, hysteresis);
+    }
+}
+
+static uint8_t stageCount(uint8_t mask) {
+    uint8_t n = 0;
+    for (; mask != 0; mask >>= 1) {
+        n += mask & 1U;
+    }
+    return n;
+}
+#endif
+
 void vTaskLab5Control(void *pvParameters) {
     (void)pvParameters;
 
     s_controller.init();
+    s_controller.setAnticipation(HYSTERESIS_ANTICIPATE, HYSTERESIS_MAX_LEAD_C);
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+    s_pid.init();
+    const float dtSeconds = (float)TASK_ACQUISITION_PERIOD_MS / 1000.0f;
+#elif defined(LAB5_1_STAGED_HEATER)
+    s_staged.init();
+    s_staged.setTimers(STAGED_HEATER_MIN_ON_MS, STAGED_HEATER_MIN_OFF_MS,
+                       STAGED_HEATER_INTER_STAGE_MS);
+#endif
 
     for (;;) {
-        if (xSemaphoreTake(xLab5NewSampleSemaphore, portMAX_DELAY) != pdTRUE) {
+        Lab5Sample sample;
+        if (xQueueReceive(xLab5SampleQueue, &sample, portMAX_DELAY) != pdTRUE) {
             continue;
         }
 
-        lab5StateLock();
-        Lab5ControlState *state = lab5StateGet();
-        float temperature = state->measuredTempC;
-        float setpoint = state->activeSetpointC;
-        float hysteresis = state->hysteresisBandC;
-        bool valid = state->sensorValid && !isnan(temperature);
-        lab5StateUnlock();
+        float temperature = sample.temperatureC;
+        float setpoint = sample.setpointC;
+        bool valid = sample.valid && !isnan(temperature);
+        float hysteresis = 0.0f;
+        g_lab5State.read([&hysteresis](const Lab5ControlState &s) {
+            hysteresis = s.hysteresisBandC;
+        });
 
         s_controller.setConfig(setpoint, hysteresis);
 
@@ -45,15 +108,77 @@ void vTaskLab5Control(void *pvParameters) {
             commandOn = false;
         }
 
-        lab5StateLock();
-        state = lab5StateGet();
-        state->controlCommandOn = commandOn;
-        state->controllerState = s_controller.getState();
-        state->lowerThresholdC = s_controller.getLowerThreshold();
-        state->upperThresholdC = s_controller.getUpperThreshold();
-        state->controlCycles++;
-        lab5StateUnlock();
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+        // One PID step per sample; invalid data resets it and cuts the heat.
+        float demand = 0.0f;
+        if (valid) {
+            demand = s_pid.update(setpoint, temperature, dtSeconds);
+        } else {
+            s_pid.reset();
+        }
+        commandOn = demand > 0.0f;
+#elif defined(LAB5_1_STAGED_HEATER)
+        s_staged.setSetpoint(setpoint);
+        configureStages(hysteresis);
+        uint8_t stageMask = 0;
+        if (valid) {
+            stageMask = s_staged.update(temperature, millis());
+        } else {
+            s_staged.forceAllOff(millis());
+        }
+        commandOn = stageMask != 0;
+#endif
+
+        {
+            Lab5Shared::Lock state(g_lab5State);
+            state->controlCommandOn = commandOn;
+            state->controllerState = s_controller.getState();
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+            state->demandPercent = demand;
+            state->lowerThresholdC = setpoint;
+            state->upperThresholdC = setpoint;
+#elif defined(LAB5_1_STAGED_HEATER)
+            state->stageMask = stageMask;
+            state->stagesDemanded = s_staged.getDemandedStages();
+            state->lowerThresholdC = setpoint - 0.5f * hysteresis;
+            state->upperThresholdC = setpoint + 0.5f * hysteresis;
+#else
+            state->lowerThresholdC = s_controller.getLowerThreshold();
+            state->upperThresholdC = s_controller.getUpperThreshold();
+            state->overshootHighC = s_controller.getOvershootHigh();
+            state->overshootLowC = s_controller.getOvershootLow();
+#endif
+            state->controlCycles++;
 
-        xSemaphoreGive(xLab5ActuatorSemaphore);
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+            float heatPercent = demand;
+#elif defined(LAB5_1_STAGED_HEATER)
+            float heatPercent = 100.0f * stageCount(stageMask) / STAGED_HEATER_STAGES;
+#else
+            float heatPercent = commandOn ? 100.0f : 0.0f;
+#endif
+            s_loopMetrics.setSettleBand(0.5f * hysteresis + LOOP_METRICS_SETTLE_MARGIN_C);
+            s_loopMetrics.update(setpoint, valid ? temperature : NAN, heatPercent,
+                                 state->actuatorSwitches, millis());
+            s_loopMetrics.getReport(&state->loop);
+
+            Lab5Command command;
+            command.sampleTick = sample.tick;
+            command.commandOn = commandOn;
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+            command.demandPercent = demand;
+#else
+            command.demandPercent = 0.0f;
+#endif
+#if defined(LAB5_1_STAGED_HEATER)
+            command.stageMask = stageMask;
+#else
+            command.stageMask = 0;
+#endif
+            if (uxQueueMessagesWaiting(xLab5CommandQueue) != 0) {
+                state->commandOverruns++;  // Actuation has not taken the last one
+            }
+            xQueueOverwrite(xLab5CommandQueue, &command);
+        }
     }
 }
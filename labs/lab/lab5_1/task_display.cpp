@@ -1,12 +1,27 @@
 /**
  * @file task_display.cpp
  * @brief Lab 5.1 LCD and Serial Plotter reporting task.
+ *
+ * The LCD is redrawn when the g_lab5State release hook sees a shown value
+ * change (any writer: a key, a sample, a relay switch) or the page flips;
+ * the Serial Plotter line and the settings save follow the heartbeat.
+ * A render cache compares the snapshot's shown values with those last
+ * drawn, so a heartbeat with nothing new on the page formats nothing,
+ * and only the values of the visible page are formatted.
+ *
+ * Every LOOP_METRICS_REPORT_MS a heartbeat also prints the control task's
+ * LoopMetrics figures as one LOOP,... line.
  */
 
 #include "task_display.h"
 #include "lab5_1_config.h"
 #include "shared_state.h"
+#include "settings.h"
 #include "LcdDisplay.h"
+#include "DisplayRefresh.h"
+#include "DeferredLog.h"
+#include "StdioSerial.h"
+#include "FlashString.h"
 
 #include <Arduino_FreeRTOS.h>
 #include <stdio.h>
@@ -14,6 +29,56 @@
 #include <math.h>
 
 static LcdDisplay s_lcd(LCD_I2C_ADDRESS, LCD_COLS, LCD_ROWS);
+static DisplayRefresh s_refresh(DISPLAY_REFRESH_MIN_MS, DISPLAY_HEARTBEAT_MS);
+
+/** Wake-up reason besides the heartbeat: a shown value changed. */
+static const uint8_t DISPLAY_DIRTY_LCD = 0x01;
+
+/** State as the LCD pages show it; only the release hook touches s_shown. */
+struct ShownState {
+    int16_t tempDeci;
+    int16_t humidity;
+    int16_t setpointDeci;
+    int16_t bandDeci;
+    int16_t lowDeci;
+    int16_t highDeci;
+    int16_t demandPercent;
+    uint8_t stageMask;
+    uint8_t stagesDemanded;
+    uint8_t flags;
+    char input[SETPOINT_INPUT_MAX_DIGITS + 1];
+};
+static ShownState s_shown;
+
+/** @brief The shown values of @p state (release hook and render cache). */
+static void shownStateOf(const Lab5ControlState &state, ShownState *now) {
+    memset(now, 0, sizeof(*now));
+    now->tempDeci = displayRefreshQuantize(state.measuredTempC, 0.1f);
+    now->humidity = displayRefreshQuantize(state.measuredHumidityPercent, 1.0f);
+    now->setpointDeci = displayRefreshQuantize(state.activeSetpointC, 0.1f);
+    now->bandDeci = displayRefreshQuantize(state.hysteresisBandC, 0.1f);
+    now->lowDeci = displayRefreshQuantize(state.lowerThresholdC, 0.1f);
+    now->highDeci = displayRefreshQuantize(state.upperThresholdC, 0.1f);
+    now->demandPercent = displayRefreshQuantize(state.demandPercent, 1.0f);
+    now->stageMask = state.stageMask;
+    now->stagesDemanded = state.stagesDemanded;
+    now->flags = (uint8_t)((state.actuatorOn ? 0x01 : 0) | (state.sensorValid ? 0x02 : 0) |
+                           (state.editingSetpoint ? 0x04 : 0) |
+                           (state.setpointSource == SETPOINT_SOURCE_POT ? 0x08 : 0));
+    if (state.editingSetpoint) {
+        strncpy(now->input, state.inputBuffer, sizeof(now->input) - 1);
+    }
+}
+
+void lab5DisplayStateReleased(const Lab5ControlState &state, void *context) {
+    (void)context;
+    ShownState now;
+    shownStateOf(state, &now);
+    if (memcmp(&now, &s_shown, sizeof(now)) != 0) {
+        s_shown = now;
+        s_refresh.mark(DISPLAY_DIRTY_LCD);
+    }
+}
 
 static void formatFloat(char *buffer, size_t size, float value,
                         signed char width, unsigned char precision,
@@ -30,64 +95,133 @@ static float plotValueOrZero(float value) {
     return isnan(value) ? 0.0f : value;
 }
 
+#if defined(LAB5_1_STAGED_HEATER)
+static uint8_t stageCount(uint8_t mask) {
+    uint8_t n = 0;
+    for (; mask != 0; mask >>= 1) {
+        n += mask & 1U;
+    }
+    return n;
+}
+#endif
+
+/**
+ * @brief Format the LCD lines of @p page (or of the setpoint entry).
+ *
+ * Only the values the chosen screen shows are formatted.
+ */
+static void renderPage(const Lab5ControlState &snapshot, uint8_t page,
+                       char *line0, char *line1, size_t size) {
+    if (snapshot.editingSetpoint) {
+        FLASH_SNPRINTF(line0, size, "Set SP:%-3s C", snapshot.inputBuffer);
+        FLASH_SNPRINTF(line1, size, "#=OK *=CLR");
+    } else if (page == 0) {
+        char tempStr[8];
+        char spStr[8];
+        formatFloat(tempStr, sizeof(tempStr), snapshot.measuredTempC, 4, 1, "--.-");
+        formatFloat(spStr, sizeof(spStr), snapshot.activeSetpointC, 4, 1, "--.-");
+        FLASH_SNPRINTF(line0, size, "T:%s SP:%s", tempStr, spStr);
+#if defined(LAB5_1_TIME_PROPORTIONAL)
+        FLASH_SNPRINTF(line1, size, "R:%-3s D:%3u%% %s",
+                       snapshot.actuatorOn ? "ON" : "OFF",
+                       (unsigned)(snapshot.demandPercent + 0.5f),
+                       snapshot.sensorValid ? "OK" : "SE");
+#elif defined(LAB5_1_STAGED_HEATER)
+        FLASH_SNPRINTF(line1, size, "Stg:%u/%u D:%u %s",
+                       (unsigned)stageCount(snapshot.stageMask),
+                       (unsigned)STAGED_HEATER_STAGES,
+                       (unsigned)snapshot.stagesDemanded,
+                       snapshot.sensorValid ? "OK" : "SE");
+#else
+        FLASH_SNPRINTF(line1, size, "Relay:%-3s %s",
+                       snapshot.actuatorOn ? "ON" : "OFF",
+                       snapshot.sensorValid ? "OK" : "SERR");
+#endif
+    } else {
+        char humStr[8];
+        char hystStr[8];
+        char lowStr[8];
+        char highStr[8];
+        formatFloat(humStr, sizeof(humStr), snapshot.measuredHumidityPercent, 4, 0, "---");
+        formatFloat(hystStr, sizeof(hystStr), snapshot.hysteresisBandC, 3, 1, "-.-");
+        formatFloat(lowStr, sizeof(lowStr), snapshot.lowerThresholdC, 4, 1, "--.-");
+        formatFloat(highStr, sizeof(highStr), snapshot.upperThresholdC, 4, 1, "--.-");
+        const char *source =
+            snapshot.setpointSource == SETPOINT_SOURCE_POT ? "POT" : "MAN";
+        FLASH_SNPRINTF(line0, size, "H:%s Hum:%s%%", hystStr, humStr);
+        FLASH_SNPRINTF(line1, size, "%s %s-%s", source, lowStr, highStr);
+    }
+}
+
+/** @brief One LOOP,... line: the window, then the present and the last step. */
+static void reportLoop(const LoopMetricsReport &loop) {
+    char win[10], iae[12], ise[12], travel[10], rate[10];
+    char over[10], settle[10], lastOver[10], lastSettle[10], lastIae[12];
+    dtostrf(loop.windowS, 1, 0, win);
+    dtostrf(loop.iae, 1, 1, iae);
+    dtostrf(loop.ise, 1, 1, ise);
+    dtostrf(loop.travel, 1, 0, travel);
+    dtostrf(loop.switchesPerHour, 1, 1, rate);
+    dtostrf(loop.stepOvershoot, 1, 2, over);
+    formatFloat(settle, sizeof(settle), loop.stepSettleS, 1, 0, "-");
+    formatFloat(lastOver, sizeof(lastOver), loop.lastOvershoot, 1, 2, "-");
+    formatFloat(lastSettle, sizeof(lastSettle), loop.lastSettleS, 1, 0, "-");
+    formatFloat(lastIae, sizeof(lastIae), loop.lastIae, 1, 1, "-");
+    FLASH_PRINTF("LOOP,win=%s,iae=%s,ise=%s,travel=%s,sw_h=%s,steps=%u,over=%s,settle=%s,"
+                 "last_over=%s,last_settle=%s,last_iae=%s\r\n",
+                 win, iae, ise, travel, rate, (unsigned)loop.steps, over, settle,
+                 lastOver, lastSettle, lastIae);
+}
+
 void vTaskLab5Display(void *pvParameters) {
     (void)pvParameters;
 
     s_lcd.init();
     s_lcd.backlight(true);
-    s_lcd.showTwoLines("Lab 5.1 ONOFF", "DHT11 + Relay");
+    s_lcd.showTwoLines_P(PSTR("Lab 5.1 ONOFF"), PSTR("DHT11 + Relay"));
 
-    TickType_t lastWake = xTaskGetTickCount();
-    const TickType_t period = pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS);
-    uint8_t displayCycle = 0;
+    s_refresh.bind();
+    uint8_t beat = 0;
+    uint8_t shownPage = 0xFF;
+    ShownState drawn;
+    uint32_t nextLoopReportMs = millis() + LOOP_METRICS_REPORT_MS;
 
     for (;;) {
-        vTaskDelayUntil(&lastWake, period);
-        displayCycle++;
-
-        lab5StateLock();
-        Lab5ControlState snapshot = *lab5StateGet();
-        lab5StateUnlock();
+        uint8_t why = s_refresh.wait();
+        bool heartbeat = (why & DISPLAY_REFRESH_HEARTBEAT) != 0;
+        if (heartbeat) {
+            beat++;
+        }
+        uint8_t page = (uint8_t)((beat / DISPLAY_PAGE_BEATS) % 2);
 
-        char tempStr[8];
-        char humStr[8];
-        char spStr[8];
-        char hystStr[8];
-        char lowStr[8];
-        char highStr[8];
+        Lab5ControlState snapshot;
+        g_lab5State.snapshot(&snapshot);
+        if (heartbeat) {
+            lab5SettingsService(snapshot);
+        }
+        if (!heartbeat && page == shownPage && !(why & DISPLAY_DIRTY_LCD)) {
+            continue;
+        }
 
-        formatFloat(tempStr, sizeof(tempStr), snapshot.measuredTempC,
-                    4, 1, "--.-");
-        formatFloat(humStr, sizeof(humStr), snapshot.measuredHumidityPercent,
-                    4, 0, "---");
-        formatFloat(spStr, sizeof(spStr), snapshot.activeSetpointC,
-                    4, 1, "--.-");
-        formatFloat(hystStr, sizeof(hystStr), snapshot.hysteresisBandC,
-                    3, 1, "-.-");
-        formatFloat(lowStr, sizeof(lowStr), snapshot.lowerThresholdC,
-                    4, 1, "--.-");
-        formatFloat(highStr, sizeof(highStr), snapshot.upperThresholdC,
-                    4, 1, "--.-");
-
-        char line0[17];
-        char line1[17];
-
-        if (snapshot.editingSetpoint) {
-            snprintf(line0, sizeof(line0), "Set SP:%-3s C", snapshot.inputBuffer);
-            snprintf(line1, sizeof(line1), "#=OK *=CLR");
-        } else if (((displayCycle / 4) % 2) == 0) {
-            snprintf(line0, sizeof(line0), "T:%s SP:%s", tempStr, spStr);
-            snprintf(line1, sizeof(line1), "Relay:%-3s %s",
-                     snapshot.actuatorOn ? "ON" : "OFF",
-                     snapshot.sensorValid ? "OK" : "SERR");
-        } else {
-            const char *source =
-                snapshot.setpointSource == SETPOINT_SOURCE_POT ? "POT" : "MAN";
-            snprintf(line0, sizeof(line0), "H:%s Hum:%s%%", hystStr, humStr);
-            snprintf(line1, sizeof(line1), "%s %s-%s", source, lowStr, highStr);
+        // Render cache: the page is formatted again only when it flips
+        // or a value it shows moved; a heartbeat alone leaves the LCD.
+        ShownState key;
+        shownStateOf(snapshot, &key);
+        if (page != shownPage || memcmp(&key, &drawn, sizeof(key)) != 0) {
+            char line0[17];
+            char line1[17];
+            renderPage(snapshot, page, line0, line1, sizeof(line0));
+            s_lcd.showTwoLines(line0, line1);
+            drawn = key;
+            shownPage = page;
         }
 
-        s_lcd.showTwoLines(line0, line1);
+        if (!heartbeat) {
+            continue;  // A change between two plotter lines.
+        }
+        if (!deferredLogPreambleDone()) {
+            continue;  // The logger is still printing the banner.
+        }
 
         char plotSetpoint[10];
         char plotValue[10];
@@ -97,13 +231,31 @@ void vTaskLab5Display(void *pvParameters) {
         dtostrf(plotValueOrZero(snapshot.measuredTempC), 1, 1, plotValue);
         dtostrf(plotValueOrZero(snapshot.lowerThresholdC), 1, 1, plotLow);
         dtostrf(plotValueOrZero(snapshot.upperThresholdC), 1, 1, plotHigh);
+        char plotOverHigh[10];
+        char plotOverLow[10];
+        dtostrf(snapshot.overshootHighC, 1, 2, plotOverHigh);
+        dtostrf(snapshot.overshootLowC, 1, 2, plotOverLow);
 
-        printf("SetPoint:%s Value:%s Output:%u Low:%s High:%s Valid:%u\r\n",
-               plotSetpoint,
-               plotValue,
-               snapshot.actuatorOn ? 1U : 0U,
-               plotLow,
-               plotHigh,
-               snapshot.sensorValid ? 1U : 0U);
+        // Plotter data: the telemetry route (its own USART with -DSTDIO_TELEMETRY_PORT)
+        fprintf_P(stdioSerialStream(STDIO_ROUTE_TELEMETRY),
+                  PSTR("SetPoint:%s Value:%s Output:%u Low:%s High:%s "
+                       "OverH:%s OverL:%s Valid:%u\r\n"),
+                  plotSetpoint,
+                  plotValue,
+#if defined(LAB5_1_STAGED_HEATER)
+                  (unsigned)stageCount(snapshot.stageMask),
+#else
+                  snapshot.actuatorOn ? 1U : 0U,
+#endif
+                  plotLow,
+                  plotHigh,
+                  plotOverHigh,
+                  plotOverLow,
+                  snapshot.sensorValid ? 1U : 0U);
+
+        if (LOOP_METRICS_REPORT_MS != 0 && (int32_t)(millis() - nextLoopReportMs) >= 0) {
+            nextLoopReportMs = millis() + LOOP_METRICS_REPORT_MS;
+            reportLoop(snapshot.loop);
+        }
     }
 }
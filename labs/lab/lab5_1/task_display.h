@@ -6,6 +6,14 @@
 #ifndef LAB5_1_TASK_DISPLAY_H
 #define LAB5_1_TASK_DISPLAY_H
 
+#include "shared_state.h"
+
+/**
+ * @brief g_lab5State release hook: wakes the display task when a value
+ *        the LCD shows changed at the resolution shown.
+ */
+void lab5DisplayStateReleased(const Lab5ControlState &state, void *context);
+
 void vTaskLab5Display(void *pvParameters);
 
 #endif // LAB5_1_TASK_DISPLAY_H
@@ -7,10 +7,11 @@
 #include "lab5_1_config.h"
 #include "shared_state.h"
 #include "KeypadInput.h"
+#include "KeypadInputRtos.h"
+#include "DeferredLog.h"
 
 #include <Arduino_FreeRTOS.h>
 #include <stdlib.h>
-#include <stdio.h>
 
 static KeypadInput s_keypad(KEYPAD_ROW_PINS, KEYPAD_COL_PINS);
 
@@ -33,25 +34,22 @@ void vTaskLab5Input(void *pvParameters) {
 
     s_keypad.init();
 
-    TickType_t lastWake = xTaskGetTickCount();
-    const TickType_t period = pdMS_TO_TICKS(TASK_INPUT_PERIOD_MS);
-
     for (;;) {
-        char key = s_keypad.getKey();
-
-        if (key != 0) {
-            lab5StateLock();
-            Lab5ControlState *state = lab5StateGet();
+        // Sleeps until a key is pressed (column pin-change wake) or, without
+        // wake-capable columns, re-checks the idle keypad every 50 ms.
+        char key = 0;
+        if (keypadInputWaitKey(s_keypad, &key, portMAX_DELAY)) {
+            Lab5Shared::Lock state(g_lab5State);
 
             switch (key) {
                 case 'A':
                     if (state->setpointSource == SETPOINT_SOURCE_POT) {
-                        enterManualMode(state);
-                        printf("[INPUT] Setpoint source: MANUAL\r\n");
+                        enterManualMode(state.get());
+                        DEFERRED_LOG_PRINTF("[INPUT] Setpoint source: MANUAL\r\n");
                     } else {
                         state->setpointSource = SETPOINT_SOURCE_POT;
                         state->activeSetpointC = state->potSetpointC;
-                        printf("[INPUT] Setpoint source: POT\r\n");
+                        DEFERRED_LOG_PRINTF("[INPUT] Setpoint source: POT\r\n");
                     }
                     state->editingSetpoint = false;
                     state->inputBufferLen = 0;
@@ -59,25 +57,25 @@ void vTaskLab5Input(void *pvParameters) {
                     break;
 
                 case 'B':
-                    enterManualMode(state);
+                    enterManualMode(state.get());
                     state->manualSetpointC = clampFloat(
                         state->manualSetpointC - SETPOINT_STEP_C,
                         SETPOINT_MIN_C,
                         SETPOINT_MAX_C
                     );
                     state->activeSetpointC = state->manualSetpointC;
-                    printf("[INPUT] Manual setpoint decreased\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Manual setpoint decreased\r\n");
                     break;
 
                 case 'C':
-                    enterManualMode(state);
+                    enterManualMode(state.get());
                     state->manualSetpointC = clampFloat(
                         state->manualSetpointC + SETPOINT_STEP_C,
                         SETPOINT_MIN_C,
                         SETPOINT_MAX_C
                     );
                     state->activeSetpointC = state->manualSetpointC;
-                    printf("[INPUT] Manual setpoint increased\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Manual setpoint increased\r\n");
                     break;
 
                 case 'D':
@@ -85,14 +83,14 @@ void vTaskLab5Input(void *pvParameters) {
                     if (state->hysteresisBandC > HYSTERESIS_MAX_C) {
                         state->hysteresisBandC = HYSTERESIS_MIN_C;
                     }
-                    printf("[INPUT] Hysteresis band changed\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Hysteresis band changed\r\n");
                     break;
 
                 case '*':
                     state->editingSetpoint = false;
                     state->inputBufferLen = 0;
                     state->inputBuffer[0] = '\0';
-                    printf("[INPUT] Numeric setpoint entry cancelled\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Numeric setpoint entry cancelled\r\n");
                     break;
 
                 case '#':
@@ -109,7 +107,7 @@ void vTaskLab5Input(void *pvParameters) {
                         state->editingSetpoint = false;
                         state->inputBufferLen = 0;
                         state->inputBuffer[0] = '\0';
-                        printf("[INPUT] Manual setpoint confirmed\r\n");
+                        DEFERRED_LOG_PRINTF("[INPUT] Manual setpoint confirmed\r\n");
                     }
                     break;
 
@@ -124,16 +122,12 @@ void vTaskLab5Input(void *pvParameters) {
                         if (state->inputBufferLen < SETPOINT_INPUT_MAX_DIGITS) {
                             state->inputBuffer[state->inputBufferLen++] = key;
                             state->inputBuffer[state->inputBufferLen] = '\0';
-                            printf("[INPUT] Entering setpoint: %s\r\n",
-                                   state->inputBuffer);
+                            DEFERRED_LOG_PRINTF("[INPUT] Entering setpoint: %s\r\n",
+                                                state->inputBuffer);
                         }
                     }
                     break;
             }
-
-            lab5StateUnlock();
         }
-
-        vTaskDelayUntil(&lastWake, period);
     }
 }
@@ -13,3 +13,53 @@ const PidPreset PID_PRESETS[PID_PRESET_COUNT] = {
     {"NORM", PID_DEFAULT_KP, PID_DEFAULT_KI, PID_DEFAULT_KD},
     {"FAST", 18.0f, 0.30f, 3.0f}
 };
+
+const PidGainPoint PID_GAIN_SCHEDULE[PID_GAIN_SCHEDULE_POINTS] PROGMEM = {
+    {0.0f, 0.8f, 1.0f, 0.8f},
+    {1.0f, 1.0f, 1.0f, 1.0f},
+    {4.0f, 1.3f, 0.7f, 1.0f}
+};
+
+static_assert(PID_ZONE_COUNT >= 1 && PID_ZONE_COUNT <= PID_ZONE_TABLE_ROWS,
+              "LAB5_2_ZONES must be 1..PID_ZONE_TABLE_ROWS");
+
+// Satellite fans on Timer5 (OC5C/OC5B/OC5A), NTCs on A1..A3.
+const PidZoneConfig PID_ZONES[PID_ZONE_TABLE_ROWS] = {
+    {"Z0", PIN_DHT_SENSOR, PIN_FAN_PWM, 1, SETPOINT_DEFAULT_C},
+    {"Z1", A1, 44, 1, SETPOINT_DEFAULT_C},
+    {"Z2", A2, 45, 1, SETPOINT_DEFAULT_C},
+    {"Z3", A3, 46, 1, SETPOINT_DEFAULT_C}
+};
+
+#if defined(LAB5_2_STRESS)
+static_assert(STRESS_MAX_CHANNELS >= 1, "the stress channels need at least one slot");
+
+// Lightest first. Load per task: (cpu + lock) / period; level 0 is the
+// lab alone, the last one is meant to be past what the board sustains.
+const StressLevel STRESS_LEVELS[STRESS_LEVEL_COUNT] PROGMEM = {
+    // loads period  cpu_us lock_us chars channels channel_ms
+    {0, 100,     0,    0,  0, 0, 1000},
+    {1, 100,  2000,  100, 16, 1,  500},
+    {2, 100,  4000,  200, 16, 2,  250},
+    {3, 100,  6000,  300, 24, 3,  250},
+    {3,  50,  6000,  400, 24, 3,  100},
+    {3,  50,  9000,  600, 32, 6,  100},
+    {3,  50, 12000,  800, 32, 6,   50},
+    {3,  32, 12000, 1000, 48, 6,   50}
+};
+#endif
+
+const char *lab5PidPresetName(uint8_t index) {
+    if (index == PID_PRESET_AUTO) {
+        return "AUTO";
+    }
+    return (index < PID_PRESET_COUNT) ? PID_PRESETS[index].name : "?";
+}
+
+// Speed proportional to duty above 30 %: dutyForDemand() = 30 + 0.7 · demand.
+// The CRC is not checked for PROGMEM tables.
+const FanCurveTable FAN_CURVE_DEFAULT PROGMEM = {
+    FAN_CURVE_MAGIC, 30, 30,
+    {0, 0, 0, 0, 300, 600, 900, 1200, 1500, 1800, 2100},
+    0
+};
@@ -8,17 +8,61 @@
 
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
-#include <DHT.h>
+#include "DhtSensor.h"
+#include "HBridgeMotor.h"
+#include "FanCurve.h"
+#include "PidAutotuner.h"
+#include "PidGainScheduler.h"
+#include "ThermalPlant.h"
+#if defined(LAB5_2_MODBUS)
+#include "ModbusSlave.h"
+#endif
+#if defined(LAB5_2_STRESS)
+#include "StressRamp.h"
+#endif
 
 static const uint8_t PIN_DHT_SENSOR = 2;
 static const uint8_t DHT_SENSOR_TYPE = DHT11;
 static const uint8_t PIN_SETPOINT_POT = A0;
 
+// Setpoint pot sampled by the timer-triggered AdcEngine (non-blocking),
+// 2^ADC_OVERSAMPLE_LOG2 conversions per result.
+static const bool ADC_ENGINE_ENABLED = true;
+static const uint8_t ADC_OVERSAMPLE_LOG2 = 4;
+
 // Reference physical fan branch: L293D/L298-style H-bridge.
 static const uint8_t PIN_FAN_PWM = 3;
 static const uint8_t PIN_FAN_IN1 = 16;
 static const uint8_t PIN_FAN_IN2 = 17;
 
+// D3 is OC3C: Timer3 phase-correct PWM above the audible range
+// (TOP = 320 steps) instead of analogWrite()'s 490 Hz whine.
+static const uint32_t FAN_PWM_FREQUENCY_HZ = 25000UL;
+
+// Fan motion profile (HBridgeMotor, stepped from the Timer0 compare ISR):
+// soft start at 50 %/s, 200 ms coast between driven states, coast to stop.
+static const float FAN_RAMP_PERCENT_PER_S = 50.0f;
+static const uint16_t FAN_DEAD_TIME_MS = 200;
+static const HBridgeStopMode FAN_STOP_MODE = HBRIDGE_COAST;
+
+// Fan tachometer: open-collector output on D18 (INT3), 2 pulses per
+// revolution, read every FAN_TACH_UPDATE_PERIOD_MS by the actuation task.
+static const uint8_t PIN_FAN_TACH = 18;
+static const uint8_t FAN_TACH_PULSES_PER_REV = 2;
+static const uint16_t FAN_TACH_UPDATE_PERIOD_MS = 100;
+static const uint16_t FAN_STALL_TIMEOUT_MS = 1000;
+
+// Inner speed loop: the temperature PID (outer loop of a PidCascade,
+// every DHT sample) demands 0..100 % of FAN_MAX_RPM and a PI loop on the
+// tach (inner loop, every FAN_TACH_UPDATE_PERIOD_MS) sets the duty, so
+// the thermal gain no longer depends on the fan's duty/speed curve or
+// supply voltage, and an obstructed fan is corrected within ~1 s.
+// false = open loop through the fan curve below.
+static const bool FAN_SPEED_LOOP_ENABLED = false;
+static const float FAN_MAX_RPM = 3000.0f;
+static const float FAN_SPEED_KP = 0.3f;    // % duty per % speed
+static const float FAN_SPEED_KI = 0.6f;    // % duty per % speed·s
+
 extern byte KEYPAD_ROW_PINS[4];
 extern byte KEYPAD_COL_PINS[4];
 
@@ -32,15 +76,73 @@ static const float SETPOINT_DEFAULT_C = 25.0f;
 static const float SETPOINT_STEP_C = 0.5f;
 static const uint8_t SETPOINT_INPUT_MAX_DIGITS = 3;
 
+// Setpoint pot: snapped to SETPOINT_STEP_C and moved only once the wiper
+// is this far (% of a step) past the half-step boundary, so ADC noise
+// never reaches the PID error and derivative. Oversampled by the
+// AdcEngine, or 2^SETPOINT_POT_OVERSAMPLE_LOG2 reads without it.
+static const uint8_t SETPOINT_POT_OVERSAMPLE_LOG2 = 3;
+static const uint8_t SETPOINT_POT_DEAD_BAND_PERCENT = 25;
+
 static const float PID_OUTPUT_MIN_PERCENT = 0.0f;
 static const float PID_OUTPUT_MAX_PERCENT = 100.0f;
-static const float FAN_MIN_RUNNING_DUTY_PERCENT = 30.0f;
 static const float FAN_STOP_THRESHOLD_PERCENT = 1.0f;
 
+// Open-loop duty curve (FanCurve): PID output = share of the fan's usable
+// speed range. Measured by the "fan cal" sweep and kept in EEPROM; until
+// then FAN_CURVE_DEFAULT (PROGMEM) reproduces the plain linear map from
+// 30 % duty up. With FAN_CURVE_CALIBRATE_IF_MISSING the sweep runs at
+// boot when the EEPROM holds no curve.
+static const uint16_t FAN_CURVE_EEPROM_ADDR = 0;
+static const bool FAN_CURVE_CALIBRATE_IF_MISSING = true;
+extern const FanCurveTable FAN_CURVE_DEFAULT;
+
 static const float PID_DEFAULT_KP = 12.0f;
 static const float PID_DEFAULT_KI = 0.18f;
 static const float PID_DEFAULT_KD = 2.0f;
 
+// Derivative on the measurement (no kick on keypad/pot setpoint steps),
+// filtered with N = 10, and back-calculation anti-windup so the integral
+// unwinds while the fan is pinned at 0 % or 100 %.
+static const float PID_DERIVATIVE_FILTER_N = 10.0f;
+
+// Velocity (incremental) PID: preset switches and sensor dropouts
+// continue from the present fan demand instead of stepping it. An
+// invalid sample holds the demand for up to PID_INVALID_HOLD_MS, then the
+// fan stops and the PID resets (the positional form stops at once).
+static const PidForm PID_FORM = PID_FORM_VELOCITY;
+static const bool PID_HOLD_ON_INVALID_SAMPLE = (PID_FORM == PID_FORM_VELOCITY);
+static const uint32_t PID_INVALID_HOLD_MS = 10000;
+
+// Loop figures (LoopMetrics, "loop" and the l* fields): IAE, ISE, fan
+// demand travel and fan start/stop rate over the last
+// LOOP_METRICS_WINDOW_MS, plus overshoot and settling time (within
+// ±LOOP_METRICS_SETTLE_BAND_C) of each setpoint step of at least
+// LOOP_METRICS_STEP_C.
+static const uint32_t LOOP_METRICS_WINDOW_MS = 600000UL;
+static const float LOOP_METRICS_STEP_C = 0.5f * SETPOINT_STEP_C;
+static const float LOOP_METRICS_SETTLE_BAND_C = 0.5f;
+
+// Two-degree-of-freedom response: P sees 0.7·SP − T, so pot/keypad
+// setpoint steps move the fan gently while a load change (T moving) gets
+// the full gain. D is already on the measurement (c = 0).
+static const float PID_SETPOINT_WEIGHT_P = 0.7f;
+
+// Steady-state feed-forward: duty ≈ gain · (reference − setpoint), the
+// fan demand of holding the setpoint below the no-fan temperature of the
+// plant. 0 disables it; measure the duty at two setpoints to set it.
+static const float PID_FEEDFORWARD_REFERENCE_C = 35.0f;
+static const float PID_FEEDFORWARD_PERCENT_PER_C = 0.0f;
+
+// Gain schedule applied on top of the selected preset: factors for
+// (kp, ki, kd) interpolated on |setpoint - temperature|. Within ~1 °C the
+// loop is softened against DHT quantization; far off it pushes harder on
+// P and eases I so a large step does not wind the integral up.
+// PidController::setTuningsBumpless() keeps the fan duty continuous.
+static const bool PID_GAIN_SCHEDULE_ENABLED = true;
+static const PidScheduleKey PID_GAIN_SCHEDULE_KEY = PID_SCHEDULE_ERROR_MAGNITUDE;
+static const uint8_t PID_GAIN_SCHEDULE_POINTS = 3;
+extern const PidGainPoint PID_GAIN_SCHEDULE[PID_GAIN_SCHEDULE_POINTS];
+
 struct PidPreset {
     const char *name;
     float kp;
@@ -51,21 +153,274 @@ struct PidPreset {
 static const uint8_t PID_PRESET_COUNT = 3;
 extern const PidPreset PID_PRESETS[PID_PRESET_COUNT];
 
-static const uint16_t TASK_INPUT_PERIOD_MS = 50;
+// Preset index of the autotuned gains (selectable once a tune exists).
+static const uint8_t PID_PRESET_AUTO = PID_PRESET_COUNT;
+
+/** @brief Display name of a preset index, including "AUTO". */
+const char *lab5PidPresetName(uint8_t index);
+
+// Relay autotune ("pid tune"): the fan switches between the two outputs
+// around the active setpoint until the oscillation settles (typically
+// 3–5 thermal periods), then the gains become the AUTO preset and are
+// kept in EEPROM next to the fan curve.
+static const float PID_AUTOTUNE_OUTPUT_LOW = 0.0f;
+static const float PID_AUTOTUNE_OUTPUT_HIGH = 80.0f;
+static const float PID_AUTOTUNE_HYSTERESIS_C = 0.3f;
+static const uint32_t PID_AUTOTUNE_TIMEOUT_MS = 45UL * 60UL * 1000UL;
+static const PidTuningRule PID_AUTOTUNE_RULE = PID_TUNE_TYREUS_LUYBEN;
+static const uint16_t PID_TUNING_EEPROM_ADDR = 64;   // FanCurveTable is 28 bytes at 0
+
+// Settings kept across resets (ConfigStore, settings.h): manual setpoint,
+// setpoint source and PID preset, written by the telemetry task once they
+// have not changed for CONFIG_STORE_COALESCE_MS. Bump SETTINGS_VERSION
+// when a key changes meaning: older pages are then ignored.
+static const uint16_t SETTINGS_EEPROM_ADDR = 128;  // PidTuningRecord is 24 bytes at 64
+static const uint8_t SETTINGS_EEPROM_PAGES = 8;    // 8 x CONFIG_STORE_PAGE_BYTES (576 B)
+static const uint8_t SETTINGS_VERSION = 1;
+
+// Command macros ("macro def <name> <a; b; ...>", "run <name>";
+// CommandMacros): named serial batches, one 64-byte record per slot
+// after the settings pages.
+static const uint16_t MACRO_EEPROM_ADDR = 1024;    // Settings end at 704
+static const uint8_t MACRO_SLOTS = 8;              // 8 x COMMAND_MACRO_RECORD_BYTES (512 B)
+
+// First-order plant model shared by the observer and the Smith
+// predictor. The gain is plant specific: hold two fan demands until the
+// temperature settles and divide the temperature change by the demand
+// change; τ is the time to 63 % of that change.
+static const float PLANT_GAIN_C_PER_PERCENT = -0.1f;
+static const float PLANT_TIME_CONSTANT_S = 120.0f;
+
+// Smith predictor around the temperature PID: an FOPDT model built from
+// the stored autotune (Ku, Pu) and PLANT_GAIN_C_PER_PERCENT compensates
+// the room's transport delay, so the faster presets stop oscillating.
+// The delay line holds SMITH_MAX_DELAY_STEPS control periods (16 s at
+// 500 ms); raise it with -DSMITH_MAX_DELAY_STEPS for a slower room.
+static const bool PID_SMITH_ENABLED = false;
+
+// Inter-sample estimation: the control task runs every
+// PID_CONTROL_PERIOD_MS on a ThermalObserver prediction driven by the fan
+// demand and corrected by each DHT sample (every 2 s), instead of only
+// once per sample. The observer's equilibrium state absorbs ambient and
+// load, so only τ and roughly the gain need to be right.
+static const bool PID_ESTIMATOR_ENABLED = true;
+static const uint16_t PID_CONTROL_PERIOD_MS = 500;
+static const float ESTIMATOR_TEMP_NOISE = 0.01f;         // °C²/s
+static const float ESTIMATOR_EQUILIBRIUM_NOISE = 0.0005f; // °C²/s
+static const float ESTIMATOR_SAMPLE_VARIANCE = 0.04f;    // °C², DHT 0.1 °C steps + noise
+
+// Simulated room (-DLAB5_SIM): acquisition reads a ThermalPlant cooled by
+// the applied fan duty instead of the DHT11, so PID_PRESETS, the gain
+// schedule and the estimator can be tried on a bare board. Its gain and
+// τ are the model's above; the ambient is the no-fan temperature. The
+// plant runs in real time (control dt comes from micros()); the native
+// suite test_thermal_plant runs the same loops in simulated time. Every
+// SIM_REPORT_PERIOD_MS a SIM,... line scores the present setpoint step
+// against ±SIM_SETTLE_BAND_C. The fan curve is not calibrated at boot in
+// this mode. With nothing on A0, press A for the manual setpoint.
+static const ThermalPlantConfig SIM_PLANT = {
+    32.0f,                               // Ambient, fan off (°C)
+    0.0f,                                // No heater
+    -PLANT_GAIN_C_PER_PERCENT * 100.0f,  // Drop at 100 % fan (°C)
+    PLANT_TIME_CONSTANT_S,               // τ (s)
+    10.0f,                               // Dead time (s)
+    0.1f,                                // Reading resolution (°C)
+    0.1f,                                // Noise peak (°C)
+};
+static const bool SIM_PLANT_ENABLED =
+#if defined(LAB5_SIM)
+    true;
+#else
+    false;
+#endif
+static const float SIM_INITIAL_C = 30.0f;
+static const float SIM_HUMIDITY_PERCENT = 45.0f;
+static const float SIM_SETTLE_BAND_C = 0.5f;
+static const uint32_t SIM_REPORT_PERIOD_MS = 30000;
+
+// Zones (-DLAB5_2_ZONES=<n>, 1..PID_ZONE_TABLE_ROWS): the first n rows
+// of PID_ZONES run on one board, in the same tasks. Zone 0 is the loop
+// above (DHT, pot and keypad setpoint, H-bridge fan with tach, cascade,
+// autotune, estimator). Zones 1.. are satellite loops: an NTC on an
+// analog pin (AdcEngine slot = zone number; the DHT driver needs an
+// external interrupt and the wiring has none spare), a velocity PID on
+// a PID_PRESETS row and a low-side MOSFET fan on a Timer5 pin at
+// ZONE_FAN_PWM_FREQUENCY_HZ. Zone z is read z/n of the way into each
+// TASK_ACQUISITION_PERIOD_MS, so the reads and PID steps spread
+// over the period instead of meeting zone 0's DHT transfer. Setpoints
+// and presets of the satellites start from the table and are set with
+// "zone sp" / "zone preset"; "zone <n>" selects the zone the z* fields
+// report.
+#ifndef LAB5_2_ZONES
+#define LAB5_2_ZONES 1
+#endif
+static const uint8_t PID_ZONE_COUNT = LAB5_2_ZONES;
+static const uint8_t PID_ZONE_TABLE_ROWS = 4;
+
+struct PidZoneConfig {
+    const char *name;
+    uint8_t sensorPin;         // Zone 0: the DHT; satellites: an NTC (A1..A15)
+    uint8_t fanPwmPin;         // Zone 0: the H-bridge enable; satellites: a MOSFET gate
+    uint8_t presetIndex;       // PID_PRESETS row at boot
+    float setpointC;           // Setpoint at boot
+};
+extern const PidZoneConfig PID_ZONES[PID_ZONE_TABLE_ROWS];
+
+// Satellite NTCs: 10 kΩ / β 3950 to GND, 10 kΩ series resistor to 5 V.
+static const uint32_t ZONE_NTC_SERIES_OHMS = 10000UL;
+static const uint32_t ZONE_NTC_NOMINAL_OHMS = 10000UL;
+static const uint16_t ZONE_NTC_BETA = 3950;
+
+// Satellite fans: demand above FAN_STOP_THRESHOLD_PERCENT maps linearly
+// onto ZONE_FAN_START_DUTY_PERCENT..100 % duty (no tach, no calibration).
+static const uint32_t ZONE_FAN_PWM_FREQUENCY_HZ = 25000UL;
+static const float ZONE_FAN_START_DUTY_PERCENT = 30.0f;
+
 static const uint16_t TASK_ACQUISITION_PERIOD_MS = 2000;
-static const uint16_t TASK_DISPLAY_PERIOD_MS = 500;
+static const uint16_t TASK_TELEMETRY_PERIOD_MS = 250;
+
+// Display (DisplayRefresh): the LCD is redrawn when a shown value changes,
+// at most every DISPLAY_REFRESH_MIN_MS (a key press shows at once); the
+// heartbeat paces the Serial Plotter line and the page flip (every
+// DISPLAY_PAGE_BEATS beats).
+static const uint16_t DISPLAY_REFRESH_MIN_MS = 100;
+static const uint16_t DISPLAY_HEARTBEAT_MS = 500;
+static const uint8_t DISPLAY_PAGE_BEATS = 4;
+
+// Fused pipeline (-DLAB5_2_FUSED_PIPELINE): one task runs acquisition,
+// control and actuation inline, at the tach period; control and DHT
+// reads run on every PID_CONTROL_PERIOD_MS / TASK_ACQUISITION_PERIOD_MS
+// multiple of it. Saves two task stacks and the queue hand-offs.
+static const uint16_t PIPELINE_PERIOD_MS = FAN_TACH_UPDATE_PERIOD_MS;
+
+// Serial output: false = text plotter line, true = COBS-framed binary
+// records from the telemetry task (layout in task_telemetry.h). Fields
+// subscribed with "sub" are streamed as text in either mode.
+static const bool TELEMETRY_BINARY = false;
+
+#if defined(LAB5_2_SD_LOG)
+// SD card log (-DLAB5_2_SD_LOG, SdLogger): every telemetry record is also
+// appended to a pre-allocated, contiguous LOG.BIN on a FAT32 card (SPI:
+// MISO D50, MOSI D51, SCK D52, CS D53), in the binary telemetry format
+// whether or not TELEMETRY_BINARY is set. Costs ~1.1 KB of SRAM: the two
+// 512-byte blocks and the writer's stack.
+static const uint8_t PIN_SD_CS = 53;
+static const char SD_LOG_FILE_NAME[] = "LOG.BIN";
+#endif
+
+#if defined(LAB5_2_MODBUS)
+// Modbus RTU slave (-DLAB5_2_MODBUS, register map in task_modbus.h): an
+// RS-485 transceiver on USART3 (TX3 D14 / RX3 D15), DE and /RE on D26.
+static const uint8_t MODBUS_NODE_ADDRESS = 5;
+static const uint32_t MODBUS_BAUD = 19200UL;
+static const ModbusParity MODBUS_PARITY = MODBUS_PARITY_EVEN;
+static const int8_t PIN_MODBUS_DE = 26;
+#endif
+
+#if defined(LAB5_2_STRESS)
+// Stress mode (-DLAB5_2_STRESS, env:lab5_2_stress; stress.h): up to
+// LAB5_2_STRESS_LOADS synthetic load tasks (busy time, busy time under
+// the state lock, console lines) and STRESS_MAX_CHANNELS synthetic
+// sensor channels, which queue samples for the satellite zones like
+// their NTCs, next to the lab's own tasks. "stress run" steps through
+// STRESS_LEVELS (lab5_2_config.cpp): settle, then STRESS_REPEATS
+// windows per level, each scored by TaskMonitor's deadline and CPU
+// totals; the run stops at the first level that misses a deadline,
+// drops a sample or leaves less than the CPU headroom.
+#if LAB5_2_ZONES < 2
+#error "-DLAB5_2_STRESS feeds the satellite zones: add -DLAB5_2_ZONES=<2..4>"
+#endif
+#if defined(LAB5_2_FUSED_PIPELINE)
+#error "-DLAB5_2_STRESS feeds the sample queue, which -DLAB5_2_FUSED_PIPELINE does not have"
+#endif
+#ifndef LAB5_2_STRESS_LOADS
+#define LAB5_2_STRESS_LOADS 3
+#endif
+static const uint8_t STRESS_MAX_CHANNELS = 6;
+static const uint8_t STRESS_LEVEL_COUNT = 8;
+extern const StressLevel STRESS_LEVELS[STRESS_LEVEL_COUNT];   // PROGMEM
+
+static const uint32_t STRESS_SETTLE_MS = 3000;
+static const uint32_t STRESS_WINDOW_MS = 15000;
+static const uint8_t STRESS_REPEATS = 2;
+static const uint16_t STRESS_MAX_BUSY_PERMILLE = 900;  // 10 % headroom
+static const uint16_t STRESS_IDLE_PERIOD_MS = 100;     // Driver period without channels
+static const uint32_t STRESS_DRAIN_MS = 2000;          // TX ring empties before the report
+
+// Channel c feeds satellite 1 + c % (PID_ZONE_COUNT - 1): its setpoint
+// ± a triangle wave, plus noise; seeded per channel, so every run reads
+// the same values at the same times.
+static const float STRESS_CHANNEL_AMPLITUDE_C = 1.0f;
+static const float STRESS_CHANNEL_NOISE_C = 0.1f;
+static const uint32_t STRESS_CHANNEL_WAVE_MS = 60000UL;
+
+// The driver runs with acquisition (it produces samples); the load tasks
+// compete with control and actuation.
+static const configSTACK_DEPTH_TYPE TASK_STRESS_STACK = 448;
+static const configSTACK_DEPTH_TYPE TASK_STRESS_LOAD_STACK = 256;
+static const UBaseType_t TASK_STRESS_PRIORITY = 3;
+static const UBaseType_t TASK_STRESS_LOAD_PRIORITY = 2;
+#endif
+
+// Serial "mon" prints per-task CPU load and free stack (TaskMonitor); a
+// non-zero period also prints it unprompted from the telemetry task.
+static const uint32_t TASK_MONITOR_REPORT_MS = 0;
+
+// Schedulability (schedule.cpp): setup() checks the task set against
+// these execution budgets (µs) with preemptive response-time analysis;
+// "sched" repeats it with the acq_us / ctl_us / act_us maxima where a
+// stage has run. Event-driven tasks use their least inter-arrival time
+// as period (Log's deadline: LOG_QUEUE_DEPTH of them, the records its
+// queue holds); the kernel tick is a task above all others. Lock hold is
+// the longest Lab5PidShared section of a lower-priority task.
+static const uint32_t SCHED_TICK_WCET_US = 40;
+static const uint32_t SCHED_INPUT_WCET_US = 600;
+static const uint32_t SCHED_ACQUISITION_WCET_US = 25000;   // DHT11 transfer + pot read
+static const uint32_t SCHED_CONTROL_WCET_US = 4000;
+static const uint32_t SCHED_ACTUATION_WCET_US = 1500;
+static const uint32_t SCHED_DISPLAY_WCET_US = 15000;       // LCD page + plotter line
+static const uint32_t SCHED_LOG_WCET_US = 2000;
+static const uint32_t SCHED_TELEMETRY_WCET_US = 5000;
+static const uint32_t SCHED_MODBUS_WCET_US = 2000;
+static const uint32_t SCHED_SD_LOG_WCET_US = 3000;        // One block + stop token at 8 MHz
+static const uint32_t SCHED_LOCK_HOLD_US = 300;
+static const uint16_t SCHED_KEY_MIN_INTERVAL_MS = 50;      // Input and Log jobs
+static const uint16_t SCHED_MODBUS_MIN_INTERVAL_MS = 20;   // Request + reply at 19200 baud
 
 // Increased stack headroom for AVR + FreeRTOS + LCD/serial formatting paths.
+// Check them against "mon" (free stack = high-water mark since reset).
 static const configSTACK_DEPTH_TYPE TASK_INPUT_STACK = 384;
 static const configSTACK_DEPTH_TYPE TASK_ACQUISITION_STACK = 512;
-static const configSTACK_DEPTH_TYPE TASK_CONTROL_STACK = 512;
-static const configSTACK_DEPTH_TYPE TASK_ACTUATION_STACK = 320;
+static const configSTACK_DEPTH_TYPE TASK_CONTROL_STACK = 640;
+static const configSTACK_DEPTH_TYPE TASK_ACTUATION_STACK = 448;
 static const configSTACK_DEPTH_TYPE TASK_DISPLAY_STACK = 1024;
+static const configSTACK_DEPTH_TYPE TASK_LOG_STACK = 320;
+static const configSTACK_DEPTH_TYPE TASK_TELEMETRY_STACK = 512;  // "run": macro text + batch under the handler
+static const configSTACK_DEPTH_TYPE TASK_PIPELINE_STACK = 768;
+static const configSTACK_DEPTH_TYPE TASK_MODBUS_STACK = 320;
+static const configSTACK_DEPTH_TYPE TASK_SD_LOG_STACK = 256;
 
 static const UBaseType_t TASK_INPUT_PRIORITY = 3;
 static const UBaseType_t TASK_ACQUISITION_PRIORITY = 3;
 static const UBaseType_t TASK_CONTROL_PRIORITY = 2;
 static const UBaseType_t TASK_ACTUATION_PRIORITY = 2;
 static const UBaseType_t TASK_DISPLAY_PRIORITY = 1;
+static const UBaseType_t TASK_LOG_PRIORITY = 1;
+static const UBaseType_t TASK_TELEMETRY_PRIORITY = 1;
+static const UBaseType_t TASK_PIPELINE_PRIORITY = 2;
+static const UBaseType_t TASK_MODBUS_PRIORITY = 2;
+static const UBaseType_t TASK_SD_LOG_PRIORITY = 1;
+
+// Deferred logging: pending keypad messages held for the logger task.
+static const UBaseType_t LOG_QUEUE_DEPTH = 8;
+
+// Acquisition → control: samples buffered while the control task lags
+// (one more per satellite zone, which share the queue, and two for the
+// stress channels, which are staggered over their period).
+#if defined(LAB5_2_STRESS)
+static const UBaseType_t SAMPLE_QUEUE_DEPTH = 1 + PID_ZONE_COUNT + 2;
+#else
+static const UBaseType_t SAMPLE_QUEUE_DEPTH = 1 + PID_ZONE_COUNT;
+#endif
 
 #endif // LAB5_2_CONFIG_H
@@ -10,114 +10,285 @@
 #include "task_acquisition.h"
 #include "task_control.h"
 #include "task_actuation.h"
+#include "task_pipeline.h"
 #include "task_display.h"
+#include "task_telemetry.h"
+#include "task_modbus.h"
+#include "settings.h"
+#include "schedule.h"
+#include "perf.h"
+#include "stress.h"
+#include "FlashString.h"
 
 #include <Arduino.h>
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 #include <stdio.h>
 
 extern "C" void vApplicationStackOverflowHook(TaskHandle_t xTask,
                                                  char *pcTaskName) {
     (void)xTask;
-    printf("[FATAL] Stack overflow in task: %s\r\n",
-           pcTaskName != NULL ? pcTaskName : "<unknown>");
+    FLASH_PRINTF("[FATAL] Stack overflow in task: %s\r\n",
+                 pcTaskName != NULL ? pcTaskName : "<unknown>");
     taskDISABLE_INTERRUPTS();
     for (;;) {}
 }
 
+// Kernel objects are static (StaticRtos); this still catches the heap
+// fallback without configSUPPORT_STATIC_ALLOCATION and any library malloc.
 extern "C" void vApplicationMallocFailedHook(void) {
-    printf("[FATAL] FreeRTOS malloc failed\r\n");
+    FLASH_PRINTF("[FATAL] FreeRTOS malloc failed\r\n");
     taskDISABLE_INTERRUPTS();
     for (;;) {}
 }
 
 #include "StdioSerial.h"
+#include "DeferredLog.h"
+#include "StaticTaskSet.h"
+#include "IdleSleep.h"
+#include "TaskMonitor.h"
+#include "PcProfiler.h"
+#include "MemoryMonitor.h"
+#if defined(LAB5_2_SD_LOG)
+#include "SdLogger.h"
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Task set — one row per task; TCBs and stacks reserved at link time
+// (StaticTaskSet)
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(LAB5_2_MODBUS)
+/** @brief Init hook of the Modbus row: register table and USART. */
+static bool modbusStart() {
+    lab5PidModbusInit();
+    return true;
+}
+#endif
+
+#if defined(LAB5_2_SD_LOG)
+/** @brief Init hook of the SD log row; without a card the task is left out. */
+static bool sdLogStart() {
+    // Card init and the resume search spin on the SPI, before any task runs.
+    if (sdLogBegin(PIN_SD_CS, SD_LOG_FILE_NAME)) {
+        return true;
+    }
+    FLASH_PRINTF("[ERROR] SD log: no card on CS D%u or no contiguous %s\r\n",
+                 (unsigned)PIN_SD_CS, SD_LOG_FILE_NAME);
+    return false;
+}
+#endif
+
+static constexpr StaticTaskDesc TASKS[] PROGMEM = {
+    STATIC_TASK(vTaskLab5PidInput,       "Input",   TASK_INPUT_STACK,       TASK_INPUT_PRIORITY,
+                0),
+#if defined(LAB5_2_FUSED_PIPELINE)
+    STATIC_TASK(vTaskLab5PidPipeline,    "Pipe",    TASK_PIPELINE_STACK,    TASK_PIPELINE_PRIORITY,
+                PIPELINE_PERIOD_MS),
+#else
+    STATIC_TASK(vTaskLab5PidAcquisition, "Acquire", TASK_ACQUISITION_STACK, TASK_ACQUISITION_PRIORITY,
+                TASK_ACQUISITION_PERIOD_MS),
+    STATIC_TASK(vTaskLab5PidControl,     "Control", TASK_CONTROL_STACK,     TASK_CONTROL_PRIORITY,
+                PID_ESTIMATOR_ENABLED ? PID_CONTROL_PERIOD_MS : 0),
+    STATIC_TASK(vTaskLab5PidActuation,   "Actuate", TASK_ACTUATION_STACK,   TASK_ACTUATION_PRIORITY,
+                FAN_TACH_UPDATE_PERIOD_MS),
+#endif
+    STATIC_TASK(vTaskLab5PidDisplay,     "Display", TASK_DISPLAY_STACK,     TASK_DISPLAY_PRIORITY,
+                DISPLAY_HEARTBEAT_MS),
+    STATIC_TASK(vTaskDeferredLog,        "Log",     TASK_LOG_STACK,         TASK_LOG_PRIORITY,
+                0),
+    STATIC_TASK(vTaskLab5PidTelemetry,   "Telem",   TASK_TELEMETRY_STACK,   TASK_TELEMETRY_PRIORITY,
+                TASK_TELEMETRY_PERIOD_MS),
+#if defined(LAB5_2_MODBUS)
+    STATIC_TASK_INIT(vTaskLab5PidModbus, "Modbus",  TASK_MODBUS_STACK,      TASK_MODBUS_PRIORITY,
+                     0, modbusStart),
+#endif
+#if defined(LAB5_2_SD_LOG)
+    STATIC_TASK_INIT(vTaskSdLog,         "SdLog",   TASK_SD_LOG_STACK,      TASK_SD_LOG_PRIORITY,
+                     0, sdLogStart),
+#endif
+#if defined(LAB5_2_STRESS)
+    // Periods follow the stress level; the load tasks are parked at boot.
+    STATIC_TASK(vTaskLab5Stress,         "Stress",  TASK_STRESS_STACK,      TASK_STRESS_PRIORITY,
+                STRESS_IDLE_PERIOD_MS),
+    STATIC_TASK(vTaskLab5StressLoad,     "Load1",   TASK_STRESS_LOAD_STACK, TASK_STRESS_LOAD_PRIORITY,
+                0),
+#if LAB5_2_STRESS_LOADS > 1
+    STATIC_TASK(vTaskLab5StressLoad,     "Load2",   TASK_STRESS_LOAD_STACK, TASK_STRESS_LOAD_PRIORITY,
+                0),
+#endif
+#if LAB5_2_STRESS_LOADS > 2
+    STATIC_TASK(vTaskLab5StressLoad,     "Load3",   TASK_STRESS_LOAD_STACK, TASK_STRESS_LOAD_PRIORITY,
+                0),
+#endif
+#if LAB5_2_STRESS_LOADS > 3
+    STATIC_TASK(vTaskLab5StressLoad,     "Load4",   TASK_STRESS_LOAD_STACK, TASK_STRESS_LOAD_PRIORITY,
+                0),
+#endif
+#endif
+};
+static STATIC_TASK_SET(s_tasks, TASKS);
+
+/**
+ * @brief Startup banner, printed by the logger task before its first record.
+ *
+ * About 1.5 KB, over a second at 9600 baud: from setup() it held back
+ * every task, as the DeferredLog preamble the sensor and control tasks
+ * start at once. It exceeds the TX ring, so it is written blocking.
+ */
+static void printBanner() {
+    stdioSerialSetTxPolicy(STDIO_TX_BLOCK);
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("  Lab 5.2 - PID Control\r\n");
+    FLASH_PRINTF("  Variant: DHT11 temperature + PWM fan via L293D\r\n");
+    FLASH_PRINTF("  Arduino Mega | FreeRTOS | LCD | Keypad\r\n");
+#if defined(LAB5_2_FUSED_PIPELINE)
+    FLASH_PRINTF("  Fused pipeline: acquire/control/actuate every %u ms\r\n",
+                 (unsigned)PIPELINE_PERIOD_MS);
+#endif
+    FLASH_PRINTF("================================================\r\n");
+    FLASH_PRINTF("KEYPAD:\r\n");
+    FLASH_PRINTF("  A = toggle setpoint source POT/MANUAL\r\n");
+    FLASH_PRINTF("  B/C = decrease/increase manual setpoint by 0.5 C\r\n");
+    FLASH_PRINTF("  D = cycle PID preset SOFT/NORM/FAST (+AUTO once tuned)\r\n");
+    FLASH_PRINTF("  digits + # = enter integer manual setpoint\r\n");
+    FLASH_PRINTF("  * = cancel numeric entry\r\n");
+    FLASH_PRINTF("PINS:\r\n");
+    FLASH_PRINTF("  DHT11 data: D%u\r\n", (unsigned)PIN_DHT_SENSOR);
+    FLASH_PRINTF("  Fan EN/PWM: D%u\r\n", (unsigned)PIN_FAN_PWM);
+    FLASH_PRINTF("  Fan IN1:    D%u\r\n", (unsigned)PIN_FAN_IN1);
+    FLASH_PRINTF("  Fan IN2:    D%u\r\n", (unsigned)PIN_FAN_IN2);
+    FLASH_PRINTF("  Fan TACH:   D%u\r\n", (unsigned)PIN_FAN_TACH);
+    FLASH_PRINTF("  Pot SIG:    A0\r\n");
+#if LAB5_2_ZONES > 1
+    for (uint8_t z = 1; z < PID_ZONE_COUNT; z++) {
+        FLASH_PRINTF("  Zone %s:    NTC A%u, fan D%u, preset %u, sp %.1f C\r\n", PID_ZONES[z].name,
+                     (unsigned)(PID_ZONES[z].sensorPin - A0), (unsigned)PID_ZONES[z].fanPwmPin,
+                     (unsigned)PID_ZONES[z].presetIndex, (double)PID_ZONES[z].setpointC);
+    }
+#endif
+#if defined(LAB5_2_MODBUS)
+    FLASH_PRINTF("  Modbus:     USART%u node %u %lu baud, RS-485 DE D%d\r\n",
+                 (unsigned)MODBUS_SLAVE_USART, (unsigned)MODBUS_NODE_ADDRESS,
+                 (unsigned long)MODBUS_BAUD, (int)PIN_MODBUS_DE);
+#endif
+#if defined(LAB5_2_SD_LOG)
+    FLASH_PRINTF("  SD card:    CS D%u, SPI D50-D52, %s\r\n",
+                 (unsigned)PIN_SD_CS, SD_LOG_FILE_NAME);
+#endif
+#if defined(LAB5_2_STRESS)
+    FLASH_PRINTF("  Stress:     %u load tasks, %u channels on zones 1..%u, %u levels\r\n",
+                 (unsigned)LAB5_2_STRESS_LOADS, (unsigned)STRESS_MAX_CHANNELS,
+                 (unsigned)(PID_ZONE_COUNT - 1), (unsigned)STRESS_LEVEL_COUNT);
+#endif
+    FLASH_PRINTF("  LCD:        SDA/SCL\r\n");
+    FLASH_PRINTF("SERIAL COMMANDS:\r\n");
+    FLASH_PRINTF("  sub <field> <ms> | unsub <field|all> | subs | fields\r\n");
+    FLASH_PRINTF("  fan cal = measure the fan duty/speed curve (~40 s, EEPROM)\r\n");
+    FLASH_PRINTF("  pid tune | pid cancel = relay autotune -> AUTO preset (EEPROM)\r\n");
+    FLASH_PRINTF("  mon = per-task CPU load and minimum free stack\r\n");
+    FLASH_PRINTF("  mem = static / heap / free-gap SRAM bytes (fields ramgap ramleast heap)\r\n");
+    FLASH_PRINTF("  perf | perf clear = stage timing histograms (acq/ctl/act/age us) | zero\r\n");
+    FLASH_PRINTF("  sched = task-set response bounds with the measured stage times\r\n");
+    FLASH_PRINTF("  ktrace | ktrace clear = kernel task-switch/give/take trace as CSV | restart\r\n");
+    FLASH_PRINTF("  prof | prof clear | prof zoom <lo> <hi> | prof all = PC-sample histogram\r\n");
+    FLASH_PRINTF("    (tools/pc_profile.py) | zero | byte range [lo, hi) only | whole program\r\n");
+    FLASH_PRINTF("  lat | lat clear | lat loop <period> <hold> | lat stop = sample-to-fan latency\r\n");
+    FLASH_PRINTF("  stress run | stress level <i> | stress off | stress = synthetic load ramp\r\n");
+    FLASH_PRINTF("    -> max sustainable level | hold one | park it | table (-DLAB5_2_STRESS)\r\n");
+    FLASH_PRINTF("  cfg | cfg save = settings store status | write now (setpoint, source, preset)\r\n");
+    FLASH_PRINTF("  sp <C> | sp pot | preset <i> | pid gains <kp> <ki> <kd>\r\n");
+    FLASH_PRINTF("  <cmd>; <cmd>; ... = one batch, run only if every command is valid\r\n");
+    FLASH_PRINTF("  macro def <name> <batch> | macro del <name> | macro list | run <name> (EEPROM)\r\n");
+#if defined(LAB5_2_SD_LOG)
+    FLASH_PRINTF("  sdlog | sdlog flush = SD log counters | commit the partial block now\r\n");
+#endif
+#if LAB5_2_ZONES > 1
+    FLASH_PRINTF("  zone <n> | zones | zone sp <n> <C> | zone preset <n> <i> (fields z*)\r\n");
+#endif
+    FLASH_PRINTF("PLOTTER LINE:\r\n");
+    if (TELEMETRY_BINARY) {
+        FLASH_PRINTF("  binary telemetry: type 0x%02X every %u ms (COBS + CRC-16)\r\n",
+                     (unsigned)LAB5_2_TELEMETRY_TYPE, (unsigned)TASK_TELEMETRY_PERIOD_MS);
+    } else {
+        FLASH_PRINTF("  SetPoint:<C> Value:<C> Output:<%%> Duty:<%%> Error:<C> Kp Ki Kd Valid\r\n");
+    }
+    FLASH_PRINTF("================================================\r\n");
+    // Task storage is static (StaticTaskSet), so this is the layout they run in.
+    s_tasks.report(TASKS);
+    memoryMonitorReport();
+    lab5SettingsReport();
+#if defined(LAB5_2_SD_LOG)
+    sdLogReport();
+#endif
+    lab5ScheduleReport(false);
+    FLASH_PRINTF("\r\n");
+
+    stdioSerialSetTxPolicy(STDIO_TX_DROP);
+}
 
 void lab5_2Setup() {
+    memoryMonitorInit();  // Before setup() uses any main stack below here
     stdioSerialInit(9600);
-
-    printf("\r\n");
-    printf("================================================\r\n");
-    printf("  Lab 5.2 - PID Control\r\n");
-    printf("  Variant: DHT11 temperature + PWM fan via L293D\r\n");
-    printf("  Arduino Mega | FreeRTOS | LCD | Keypad\r\n");
-    printf("================================================\r\n");
-    printf("KEYPAD:\r\n");
-    printf("  A = toggle setpoint source POT/MANUAL\r\n");
-    printf("  B/C = decrease/increase manual setpoint by 0.5 C\r\n");
-    printf("  D = cycle PID preset SOFT/NORM/FAST\r\n");
-    printf("  digits + # = enter integer manual setpoint\r\n");
-    printf("  * = cancel numeric entry\r\n");
-    printf("PINS:\r\n");
-    printf("  DHT11 data: D%u\r\n", (unsigned)PIN_DHT_SENSOR);
-    printf("  Fan EN/PWM: D%u\r\n", (unsigned)PIN_FAN_PWM);
-    printf("  Fan IN1:    D%u\r\n", (unsigned)PIN_FAN_IN1);
-    printf("  Fan IN2:    D%u\r\n", (unsigned)PIN_FAN_IN2);
-    printf("  Pot SIG:    A0\r\n");
-    printf("  LCD:        SDA/SCL\r\n");
-    printf("PLOTTER LINE:\r\n");
-    printf("  SetPoint:<C> Value:<C> Output:<%%> Duty:<%%> Error:<C> Kp Ki Kd Valid\r\n");
-    printf("================================================\r\n\r\n");
+    // A slow terminal must never stall a task; the banner switches to
+    // blocking only while the logger prints it.
+    stdioSerialSetTxPolicy(STDIO_TX_DROP);
 
     lab5PidStateInit();
+    deferredLogInit(LOG_QUEUE_DEPTH);
+    deferredLogSetPreamble(printBanner);
 
-    BaseType_t okInput = xTaskCreate(
-        vTaskLab5PidInput,
-        "Input",
-        TASK_INPUT_STACK,
-        NULL,
-        TASK_INPUT_PRIORITY,
-        NULL
-    );
-
-    BaseType_t okAcquisition = xTaskCreate(
-        vTaskLab5PidAcquisition,
-        "Acquire",
-        TASK_ACQUISITION_STACK,
-        NULL,
-        TASK_ACQUISITION_PRIORITY,
-        NULL
-    );
-
-    BaseType_t okControl = xTaskCreate(
-        vTaskLab5PidControl,
-        "Control",
-        TASK_CONTROL_STACK,
-        NULL,
-        TASK_CONTROL_PRIORITY,
-        NULL
-    );
-
-    BaseType_t okActuation = xTaskCreate(
-        vTaskLab5PidActuation,
-        "Actuate",
-        TASK_ACTUATION_STACK,
-        NULL,
-        TASK_ACTUATION_PRIORITY,
-        NULL
-    );
-
-    BaseType_t okDisplay = xTaskCreate(
-        vTaskLab5PidDisplay,
-        "Display",
-        TASK_DISPLAY_STACK,
-        NULL,
-        TASK_DISPLAY_PRIORITY,
-        NULL
-    );
-
-    if (okInput != pdPASS || okAcquisition != pdPASS ||
-        okControl != pdPASS || okActuation != pdPASS ||
-        okDisplay != pdPASS) {
-        printf("[ERROR] Task creation failed: I=%ld A=%ld C=%ld M=%ld D=%ld\r\n",
-               (long)okInput,
-               (long)okAcquisition,
-               (long)okControl,
-               (long)okActuation,
-               (long)okDisplay);
+    s_tasks.launch(TASKS);  // [ERROR] line per task that cannot be created
+
+    taskMonitorInit();
+    for (uint8_t i = 0; i < s_tasks.count(); i++) {
+        if (s_tasks.handle(i) != NULL) {  // The SD log without a card
+            taskMonitorAdd(s_tasks.handle(i), s_tasks.stackDepth(TASKS, i));
+        }
     }
+    pcProfilerBegin();  // -DPC_PROFILER_ENABLED: samples from here on ("prof")
+    lab5LatencyInit();  // -DLATENCY_PROBE_ENABLED: sample-to-fan latency ("lat")
+
+    // Response bounds from the budgets; the banner prints them.
+    lab5ScheduleAnalyze(false);
+
+    // Modules lab 5.2 never uses: Timer3 drives the fan (D3) and Timer2
+    // samples for TaskMonitor, so only those two timers stay on (and
+    // Timer5, for the satellite zone fans on D44..D46). The Modbus USART
+    // (-DLAB5_2_MODBUS) is not a spare one, nor is the SPI with the SD
+    // log (-DLAB5_2_SD_LOG), nor the profiler's timer (-DPC_PROFILER_ENABLED).
+#if defined(PC_PROFILER_ENABLED)
+    const uint16_t profilerTimer = (PC_PROFILER_TIMER == 1)   ? IDLE_SLEEP_GATE_TIMER1
+                                   : (PC_PROFILER_TIMER == 4) ? IDLE_SLEEP_GATE_TIMER4
+                                   : (PC_PROFILER_TIMER == 5) ? IDLE_SLEEP_GATE_TIMER5
+                                                              : 0;
+#else
+    const uint16_t profilerTimer = 0;
+#endif
+#if defined(LAB5_2_MODBUS)
+    const uint16_t spareUsarts = IDLE_SLEEP_GATE_SPARE_USARTS & ~LAB5_2_MODBUS_IDLE_GATE;
+#else
+    const uint16_t spareUsarts = IDLE_SLEEP_GATE_SPARE_USARTS;
+#endif
+#if defined(LAB5_2_SD_LOG)
+    const uint16_t spareSpi = 0;
+#else
+    const uint16_t spareSpi = IDLE_SLEEP_GATE_SPI;
+#endif
+    idleSleepInit((spareUsarts | spareSpi |
+                   IDLE_SLEEP_GATE_TIMER1 | IDLE_SLEEP_GATE_TIMER4 |
+#if LAB5_2_ZONES <= 1
+                   IDLE_SLEEP_GATE_TIMER5 |
+#endif
+                   IDLE_SLEEP_GATE_ANALOG_COMP) & ~profilerTimer);
+
+    // Kernel tick on a 1 ms timer compare with -DRTOS_TICK_TIMER (RtosTick.h);
+    // last, as it keeps interrupts off until the scheduler starts.
+    rtosTickInit();
 }
 
 void lab5_2Loop() {
-    // All application logic runs in FreeRTOS tasks.
+    // All logic runs in FreeRTOS tasks. This is the idle hook: sleep
+    // until the next interrupt instead of spinning (IdleSleep).
+    idleSleep();
 }
@@ -0,0 +1,49 @@
+/**
+ * @file perf.cpp
+ * @brief Lab 5.2 hot-path instruments and their registry.
+ */
+
+#include "perf.h"
+
+PerfHistogram g_lab5PerfAcquireUs;
+PerfHistogram g_lab5PerfControlUs;
+PerfHistogram g_lab5PerfActuateUs;
+PerfHistogram g_lab5PerfSampleAgeUs;
+PerfCounter32 g_lab5PerfControlSteps;
+PerfCounter16 g_lab5PerfBadReads;
+
+static const PerfDesc PERF[] PROGMEM = {
+    PERF_HISTOGRAM("acq_us",    g_lab5PerfAcquireUs),
+    PERF_HISTOGRAM("ctl_us",    g_lab5PerfControlUs),
+    PERF_HISTOGRAM("act_us",    g_lab5PerfActuateUs),
+    PERF_HISTOGRAM("age_us",    g_lab5PerfSampleAgeUs),
+    PERF_COUNTER32("steps",     g_lab5PerfControlSteps),
+    PERF_COUNTER16("bad_reads", g_lab5PerfBadReads),
+};
+
+static const uint8_t PERF_COUNT = sizeof(PERF) / sizeof(PERF[0]);
+
+#if defined(LATENCY_PROBE_ENABLED)
+LatencyPath   g_lab5LatencySample;
+PerfHistogram g_lab5LatencyControlUs;
+PerfHistogram g_lab5LatencyFanUs;
+
+static const PerfDesc LATENCY[] PROGMEM = {
+    PERF_HISTOGRAM("lat_ctl", g_lab5LatencyControlUs),
+    PERF_HISTOGRAM("lat_fan", g_lab5LatencyFanUs),
+};
+#endif
+
+void lab5PerfReport() {
+    perfReport(PERF, PERF_COUNT);
+}
+
+void lab5PerfClear() {
+    perfClear(PERF, PERF_COUNT);
+}
+
+void lab5LatencyInit() {
+#if defined(LATENCY_PROBE_ENABLED)
+    latencyProbeInit(LATENCY, sizeof(LATENCY) / sizeof(LATENCY[0]));
+#endif
+}
@@ -0,0 +1,52 @@
+/**
+ * @file perf.h
+ * @brief Lab 5.2 hot-path instruments (PerfCounter).
+ *
+ * The stage functions time themselves, so the task pipeline and the
+ * fused pipeline report the same instruments:
+ *
+ *   acq_us    lab5PidAcquire() duration (DHT read, pot read)
+ *   ctl_us    lab5PidControlCompute() duration
+ *   act_us    lab5PidActuate() duration
+ *   age_us    sensor capture to control step, for each new valid sample
+ *   steps     control steps (samples and estimator cycles)
+ *   bad_reads acquisitions without a valid reading
+ *
+ * With -DLATENCY_PROBE_ENABLED, the sample-to-fan path (LatencyProbe,
+ * "lat"): sensor capture → control output (lat_ctl) → fan duty written
+ * (lat_fan), once per new valid sample.
+ *
+ * Usage:
+ *   perfRecord(&g_lab5PerfControlUs, micros() - startUs);   // stage code
+ *   lab5PerfReport();                                        // "perf"
+ */
+
+#ifndef LAB5_2_PERF_H
+#define LAB5_2_PERF_H
+
+#include "PerfCounter.h"
+#include "LatencyProbe.h"
+
+extern PerfHistogram g_lab5PerfAcquireUs;
+extern PerfHistogram g_lab5PerfControlUs;
+extern PerfHistogram g_lab5PerfActuateUs;
+extern PerfHistogram g_lab5PerfSampleAgeUs;
+extern PerfCounter32 g_lab5PerfControlSteps;
+extern PerfCounter16 g_lab5PerfBadReads;
+
+#if defined(LATENCY_PROBE_ENABLED)
+extern LatencyPath   g_lab5LatencySample;
+extern PerfHistogram g_lab5LatencyControlUs;
+extern PerfHistogram g_lab5LatencyFanUs;
+#endif
+
+/** @brief Print every instrument ("perf", telemetry task). */
+void lab5PerfReport();
+
+/** @brief Zero every instrument ("perf clear"). */
+void lab5PerfClear();
+
+/** @brief Register the latency histograms for "lat" (setup()). */
+void lab5LatencyInit();
+
+#endif // LAB5_2_PERF_H
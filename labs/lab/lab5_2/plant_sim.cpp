@@ -0,0 +1,144 @@
+/**
+ * @file plant_sim.cpp
+ * @brief Lab 5.2 simulated room implementation (-DLAB5_SIM only).
+ */
+
+#if defined(LAB5_SIM)
+
+#include "plant_sim.h"
+#include "lab5_2_config.h"
+#include "shared_state.h"
+#include "FixedFormat.h"
+#include "StepMetrics.h"
+#include "ThermalPlant.h"
+#include "FlashString.h"
+
+#include <Arduino_FreeRTOS.h>
+#include <math.h>
+#include <stdio.h>
+
+static ThermalPlant s_plant(SIM_PLANT);
+static StepMetrics s_metrics;
+static float s_fanPercent = 0.0f;      // Posted by the actuation stage
+static uint32_t s_fanSinceMs = 0;      // When it last changed
+static uint32_t s_lastMs = 0;
+static uint32_t s_nextReportMs = 0;
+
+#if LAB5_2_ZONES > 1
+// Satellite rooms, entry = zone (0 unused: zone 0 is s_plant).
+static float s_zoneTempC[PID_ZONE_COUNT];
+static float s_zoneFanPercent[PID_ZONE_COUNT];
+static uint32_t s_zoneLastMs[PID_ZONE_COUNT];
+#endif
+
+static void report(float temperature) {
+    char sp[10], t[10], settle[10], over[10], iae[12];
+    fmtFixed(sp, s_metrics.getSetpoint(), 1, 1);
+    fmtFixed(t, temperature, 1, 2);
+    fmtFixed(over, s_metrics.getOvershoot(), 1, 2);
+    fmtFixed(iae, s_metrics.getIae(), 1, 1);
+    if (s_metrics.isSettled()) {
+        fmtFixed(settle, s_metrics.getSettlingTimeMs() / 1000.0f, 1, 0);
+    } else {
+        settle[0] = '-';
+        settle[1] = '\0';
+    }
+    FLASH_PRINTF("SIM,step=%lu,sp=%s,T=%s,fan=%u,settle=%s,over=%s,iae=%s\r\n",
+                 (unsigned long)(s_metrics.getElapsedMs() / 1000UL), sp, t,
+                 (unsigned)(s_plant.getFan() + 0.5f), settle, over, iae);
+}
+
+/** @brief Restart the score on a setpoint change, otherwise extend it. */
+static void score(uint32_t now) {
+    float setpoint = 0.0f;
+    g_lab5PidState.read([&setpoint](const Lab5PidState &s) {
+        setpoint = s.activeSetpointC;
+    });
+
+    float temperature = s_plant.getTemperatureC();
+    if (!s_metrics.isActive() ||
+        fabsf(setpoint - s_metrics.getSetpoint()) >= 0.5f * SETPOINT_STEP_C) {
+        s_metrics.begin(setpoint, temperature, now, SIM_SETTLE_BAND_C);
+        s_nextReportMs = now;
+    } else {
+        s_metrics.update(temperature, now);
+    }
+
+    if ((int32_t)(now - s_nextReportMs) >= 0) {
+        report(temperature);
+        s_nextReportMs = now + SIM_REPORT_PERIOD_MS;
+    }
+}
+
+void lab5PidSimInit() {
+    s_plant.init(SIM_INITIAL_C);
+    s_lastMs = millis();
+#if LAB5_2_ZONES > 1
+    for (uint8_t z = 1; z < PID_ZONE_COUNT; z++) {
+        s_zoneTempC[z] = SIM_INITIAL_C;
+        s_zoneFanPercent[z] = 0.0f;
+        s_zoneLastMs[z] = s_lastMs;
+    }
+#endif
+    FLASH_PRINTF("SIM: simulated room, tau=%us dead=%us (DHT11 not read)\r\n",
+                 (unsigned)SIM_PLANT.timeConstantS, (unsigned)SIM_PLANT.deadTimeS);
+}
+
+float lab5PidSimRead() {
+    float fan;
+    uint32_t since;
+    taskENTER_CRITICAL();
+    fan = s_fanPercent;
+    since = s_fanSinceMs;
+    taskEXIT_CRITICAL();
+
+    // The old input up to the (last) change, the new one after it.
+    uint32_t now = millis();
+    if (fan != s_plant.getFan() && (int32_t)(since - s_lastMs) > 0) {
+        s_plant.advance(since - s_lastMs);
+        s_lastMs = since;
+    }
+    s_plant.setFan(fan);
+    s_plant.advance(now - s_lastMs);
+    s_lastMs = now;
+
+    float reading = s_plant.read();
+    score(now);
+    return reading;
+}
+
+void lab5PidSimSetFan(float percent) {
+    uint32_t now = millis();
+    taskENTER_CRITICAL();
+    if (percent != s_fanPercent) {
+        s_fanPercent = percent;
+        s_fanSinceMs = now;
+    }
+    taskEXIT_CRITICAL();
+}
+
+#if LAB5_2_ZONES > 1
+float lab5PidSimZoneRead(uint8_t zone) {
+    float fan;
+    taskENTER_CRITICAL();
+    fan = s_zoneFanPercent[zone];
+    taskEXIT_CRITICAL();
+
+    // The duty is set once per sample, so it held over the whole interval.
+    uint32_t now = millis();
+    float dtSeconds = (now - s_zoneLastMs[zone]) / 1000.0f;
+    s_zoneLastMs[zone] = now;
+    float equilibrium = SIM_PLANT.ambientC - SIM_PLANT.fanDropC * fan / 100.0f;
+    float alpha = 1.0f - expf(-dtSeconds / SIM_PLANT.timeConstantS);
+    s_zoneTempC[zone] += alpha * (equilibrium - s_zoneTempC[zone]);
+    return s_zoneTempC[zone];
+}
+
+void lab5PidSimZoneSetFan(uint8_t zone, float percent) {
+    taskENTER_CRITICAL();
+    s_zoneFanPercent[zone] = percent;
+    taskEXIT_CRITICAL();
+}
+#endif
+
+#endif // LAB5_SIM
@@ -0,0 +1,47 @@
+/**
+ * @file plant_sim.h
+ * @brief Lab 5.2 simulated room (-DLAB5_SIM).
+ *
+ * Replaces the DHT11 reading with a ThermalPlant (SIM_PLANT) whose fan
+ * input follows the applied fan duty, and scores every setpoint step
+ * with StepMetrics. The acquisition stage owns the plant; the actuation
+ * stage only posts the fan input, so the separate tasks and the fused
+ * pipeline use it alike.
+ *
+ * With satellite zones (-DLAB5_2_ZONES) each satellite has a room of
+ * its own in place of its NTC: first order with SIM_PLANT's ambient,
+ * fan drop and τ, without dead time or sensor noise, and not scored.
+ */
+
+#ifndef LAB5_2_PLANT_SIM_H
+#define LAB5_2_PLANT_SIM_H
+
+#include "lab5_2_config.h"
+
+/** @brief Start the plant at SIM_INITIAL_C (before the first read). */
+void lab5PidSimInit();
+
+/**
+ * @brief Advance the plant to now and take a sensor reading.
+ *
+ * Also scores the active setpoint's step and prints a
+ * SIM,step=<s>,sp=<C>,T=<C>,fan=<%>,settle=<s|->,over=<C>,iae=<C*s> line
+ * every SIM_REPORT_PERIOD_MS and at each new step. Call without the
+ * state lock held.
+ *
+ * @return The reading, quantized and noisy like the DHT's.
+ */
+float lab5PidSimRead();
+
+/** @brief Fan input of the plant (applied duty, 0..100 %). */
+void lab5PidSimSetFan(float percent);
+
+#if LAB5_2_ZONES > 1
+/** @brief Advance satellite @p zone's room to now and return its temperature. */
+float lab5PidSimZoneRead(uint8_t zone);
+
+/** @brief Fan input of satellite @p zone's room (applied duty, 0..100 %). */
+void lab5PidSimZoneSetFan(uint8_t zone, float percent);
+#endif
+
+#endif // LAB5_2_PLANT_SIM_H
@@ -0,0 +1,101 @@
+/**
+ * @file schedule.cpp
+ * @brief Lab 5.2 task table for the schedulability check.
+ */
+
+#include "schedule.h"
+#include "lab5_2_config.h"
+#include "perf.h"
+#include "task_control.h"
+
+#include "RtosTick.h"
+
+#include "Schedulability.h"
+
+// Kernel tick, the tasks of the largest build, and Modbus.
+static const uint8_t SCHED_MAX_TASKS = 10;
+
+static SchedTask    s_set[SCHED_MAX_TASKS];
+static SchedResult  s_results[SCHED_MAX_TASKS];
+static SchedSummary s_summary;
+static uint8_t      s_count = 0;
+static bool         s_measured = false;
+
+/**
+ * @brief Append a task; tasks above the lowest priority can wait for one lock.
+ *
+ * @param deadlineMs 0: the period.
+ */
+static void addTask(const char *name, uint32_t periodMs, uint32_t wcetUs, UBaseType_t priority,
+                    uint32_t deadlineMs = 0) {
+    if (s_count >= SCHED_MAX_TASKS) {
+        return;
+    }
+    SchedTask &task = s_set[s_count++];
+    task.name = name;
+    task.periodUs = periodMs * 1000UL;
+    task.deadlineUs = deadlineMs * 1000UL;
+    task.wcetUs = wcetUs;
+    task.blockingUs = priority > TASK_LOG_PRIORITY ? SCHED_LOCK_HOLD_US : 0;
+    task.priority = (uint8_t)priority;
+}
+
+/** @brief Largest recorded value of a stage, or its budget if it never ran. */
+static uint32_t stageUs(const PerfHistogram *stage, uint32_t budgetUs, bool measured) {
+    if (!measured) {
+        return budgetUs;
+    }
+    PerfHistogram copy;
+    perfSnapshot(stage, &copy);
+    return perfHistogramTotal(&copy) > 0 ? copy.max : budgetUs;
+}
+
+bool lab5ScheduleAnalyze(bool measured) {
+    uint32_t acquireUs = stageUs(&g_lab5PerfAcquireUs, SCHED_ACQUISITION_WCET_US, measured);
+    uint32_t controlUs = stageUs(&g_lab5PerfControlUs, SCHED_CONTROL_WCET_US, measured);
+    uint32_t actuateUs = stageUs(&g_lab5PerfActuateUs, SCHED_ACTUATION_WCET_US, measured);
+
+    // Each satellite zone is read, and its PID stepped, once per period.
+    uint32_t zoneMs = TASK_ACQUISITION_PERIOD_MS / PID_ZONE_COUNT;
+    uint32_t controlMs = lab5PidControlPeriodMs();
+    if (PID_ZONE_COUNT > 1 && zoneMs < controlMs) {
+        controlMs = zoneMs;
+    }
+
+    s_count = 0;
+    addTask("Tick", portTICK_PERIOD_MS, SCHED_TICK_WCET_US, configMAX_PRIORITIES);
+    addTask("Input", SCHED_KEY_MIN_INTERVAL_MS, SCHED_INPUT_WCET_US, TASK_INPUT_PRIORITY);
+#if defined(LAB5_2_FUSED_PIPELINE)
+    (void)zoneMs;
+    (void)controlMs;
+    addTask("Pipe", PIPELINE_PERIOD_MS, acquireUs + controlUs + actuateUs, TASK_PIPELINE_PRIORITY);
+#else
+    addTask("Acquire", zoneMs, acquireUs, TASK_ACQUISITION_PRIORITY);
+    addTask("Control", controlMs, controlUs, TASK_CONTROL_PRIORITY);
+    addTask("Actuate", FAN_TACH_UPDATE_PERIOD_MS, actuateUs, TASK_ACTUATION_PRIORITY);
+#endif
+    addTask("Display", DISPLAY_REFRESH_MIN_MS, SCHED_DISPLAY_WCET_US, TASK_DISPLAY_PRIORITY);
+    // A record may wait while the log queue holds the ones behind it.
+    addTask("Log", SCHED_KEY_MIN_INTERVAL_MS, SCHED_LOG_WCET_US, TASK_LOG_PRIORITY,
+            (uint32_t)LOG_QUEUE_DEPTH * SCHED_KEY_MIN_INTERVAL_MS);
+    addTask("Telem", TASK_TELEMETRY_PERIOD_MS, SCHED_TELEMETRY_WCET_US, TASK_TELEMETRY_PRIORITY);
+#if defined(LAB5_2_SD_LOG)
+    // At most one block per telemetry record, usually one per second.
+    addTask("SdLog", TASK_TELEMETRY_PERIOD_MS, SCHED_SD_LOG_WCET_US, TASK_SD_LOG_PRIORITY);
+#endif
+#if defined(LAB5_2_MODBUS)
+    addTask("Modbus", SCHED_MODBUS_MIN_INTERVAL_MS, SCHED_MODBUS_WCET_US, TASK_MODBUS_PRIORITY);
+#endif
+
+    s_measured = measured;
+    return schedAnalyze(s_set, s_count, SCHED_PREEMPTIVE_FP, s_results, &s_summary);
+}
+
+void lab5ScheduleReport(bool full) {
+    const char *title = s_measured ? "Lab 5.2 measured" : "Lab 5.2 budgets";
+    if (full || !s_summary.schedulable) {
+        schedPrint(title, s_set, s_results, &s_summary);
+    } else {
+        schedPrintSummary(title, &s_summary);
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * @file schedule.h
+ * @brief Lab 5.2 task-set schedulability check (Schedulability).
+ *
+ * The task table is rebuilt from the lab5_2_config.h periods and
+ * priorities (the tasks the build creates: fused pipeline or not,
+ * satellite zones, Modbus) with the SCHED_*_WCET_US budgets, and run
+ * through preemptive fixed-priority response-time analysis:
+ *
+ *   [SCHED] Lab 5.2 budgets (preemptive, fixed priority): U 26.1 %, 8 tasks schedulable
+ *
+ * setup() analyses the budgets before the scheduler starts; the banner
+ * prints that line, or the whole table and an [ERROR] per task that can
+ * miss its deadline. "sched" analyses again with the largest acq_us,
+ * ctl_us and act_us recorded so far (perf.h) in place of those budgets
+ * and prints the table; compare it with "mon", which shows the response
+ * times the tasks actually had.
+ *
+ * The table and its results are static: setup(), the banner (logger
+ * task) and "sched" (telemetry task, after the banner) never overlap.
+ *
+ * Usage:
+ *   lab5ScheduleAnalyze(false);   // setup()
+ *   lab5ScheduleReport(false);    // banner
+ *   lab5ScheduleAnalyze(true);    // "sched"
+ *   lab5ScheduleReport(true);
+ */
+
+#ifndef LAB5_2_SCHEDULE_H
+#define LAB5_2_SCHEDULE_H
+
+/**
+ * @brief Build the task table and analyse it.
+ *
+ * @param measured Use the perf stage maxima where a stage has run.
+ * @return true if every task meets its deadline.
+ */
+bool lab5ScheduleAnalyze(bool measured);
+
+/**
+ * @brief Print the last analysis.
+ *
+ * @param full The table even when every task is schedulable.
+ */
+void lab5ScheduleReport(bool full);
+
+#endif // LAB5_2_SCHEDULE_H
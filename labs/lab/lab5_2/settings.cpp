@@ -0,0 +1,71 @@
+/**
+ * @file settings.cpp
+ * @brief Lab 5.2 settings implementation.
+ */
+
+#include "settings.h"
+#include "lab5_2_config.h"
+#include "ConfigStore.h"
+#include "FlashString.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static_assert(SETTINGS_EEPROM_ADDR >= PID_TUNING_EEPROM_ADDR + sizeof(PidTuningRecord),
+              "settings overlap the PID tuning record");
+static_assert(SETTINGS_EEPROM_ADDR + (uint32_t)SETTINGS_EEPROM_PAGES * CONFIG_STORE_PAGE_BYTES <= 4096,
+              "settings exceed the ATmega2560 EEPROM");
+
+// Keys: never reuse one for another meaning without bumping SETTINGS_VERSION.
+static const uint8_t KEY_MANUAL_SETPOINT = 1;
+static const uint8_t KEY_SETPOINT_SOURCE = 2;
+static const uint8_t KEY_PID_PRESET = 3;
+
+static ConfigStore s_config(SETTINGS_EEPROM_ADDR, SETTINGS_EEPROM_PAGES, SETTINGS_VERSION);
+static bool s_restored = false;
+static bool s_presetStored = false;
+static uint8_t s_preset = 0;
+
+void lab5SettingsLoad(Lab5PidState *state) {
+    // Silent: the banner, printed later by the logger, reports it.
+    s_restored = s_config.begin();
+    if (!s_restored) {
+        return;
+    }
+
+    float setpoint;
+    if (s_config.getFloat(KEY_MANUAL_SETPOINT, &setpoint) &&
+        setpoint >= SETPOINT_MIN_C && setpoint <= SETPOINT_MAX_C) {
+        state->manualSetpointC = setpoint;
+    }
+    uint8_t source;
+    if (s_config.getU8(KEY_SETPOINT_SOURCE, &source) && source == SETPOINT_SOURCE_MANUAL) {
+        state->setpointSource = SETPOINT_SOURCE_MANUAL;
+        state->activeSetpointC = state->manualSetpointC;
+    }
+    s_presetStored = s_config.getU8(KEY_PID_PRESET, &s_preset);
+}
+
+bool lab5SettingsStoredPreset(uint8_t *preset) {
+    *preset = s_preset;
+    return s_presetStored;
+}
+
+void lab5SettingsService(const Lab5PidState &snapshot) {
+    // Unchanged values cost nothing; a change restarts the quiet time.
+    s_config.setFloat(KEY_MANUAL_SETPOINT, snapshot.manualSetpointC);
+    s_config.setU8(KEY_SETPOINT_SOURCE, (uint8_t)snapshot.setpointSource);
+    s_config.setU8(KEY_PID_PRESET, snapshot.pidPresetIndex);
+    s_config.service();
+}
+
+void lab5SettingsFlush() {
+    s_config.flush();
+}
+
+void lab5SettingsReport() {
+    FLASH_PRINTF("[CFG] %s at boot; %u of %u pages valid, %u written since boot%s\r\n",
+                 s_restored ? "restored" : "defaults",
+                 (unsigned)s_config.getStoredPages(), (unsigned)SETTINGS_EEPROM_PAGES,
+                 (unsigned)s_config.getWriteCount(), s_config.isDirty() ? ", change pending" : "");
+}
@@ -0,0 +1,46 @@
+/**
+ * @file settings.h
+ * @brief Lab 5.2 settings kept across resets (ConfigStore).
+ *
+ * The manual setpoint, the setpoint source and the PID preset survive a
+ * reset. They are loaded once, at startup, and saved by the telemetry
+ * task: every period it hands the current values to the store, which
+ * writes one wear-levelled EEPROM page once they have been unchanged for
+ * CONFIG_STORE_COALESCE_MS. The keypad and control tasks never wait for
+ * the EEPROM.
+ *
+ * The autotuned gains stay in their own PidTuningRecord; a stored AUTO
+ * preset selects them again once the control task has loaded it.
+ *
+ * Usage:
+ *   lab5SettingsLoad(&initial);            // lab5PidStateInit()
+ *   lab5SettingsStoredPreset(&preset);     // lab5PidControlInit()
+ *   lab5SettingsService(snapshot);         // telemetry task, every period
+ */
+
+#ifndef LAB5_2_SETTINGS_H
+#define LAB5_2_SETTINGS_H
+
+#include "shared_state.h"
+
+/**
+ * @brief Load the store and apply the stored setpoint and source to @p state.
+ *
+ * Prints nothing (it runs in setup()); lab5SettingsReport() says whether
+ * values were restored.
+ */
+void lab5SettingsLoad(Lab5PidState *state);
+
+/** @brief The PID preset stored at startup. @return False if none. */
+bool lab5SettingsStoredPreset(uint8_t *preset);
+
+/** @brief Hand the current values to the store and write if due (telemetry task). */
+void lab5SettingsService(const Lab5PidState &snapshot);
+
+/** @brief Write pending changes now ("cfg save", telemetry task). */
+void lab5SettingsFlush();
+
+/** @brief Print the store status line ("cfg" and the banner). */
+void lab5SettingsReport();
+
+#endif // LAB5_2_SETTINGS_H
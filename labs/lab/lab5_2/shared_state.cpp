@@ -4,54 +4,126 @@
  */
 
 #include "shared_state.h"
+#include "StaticRtos.h"
+#include "settings.h"
+#include "task_display.h"
 #include <math.h>
 #include <string.h>
 
-Lab5PidState g_lab5PidState;
-SemaphoreHandle_t xLab5PidStateMutex = NULL;
-SemaphoreHandle_t xLab5PidNewSampleSemaphore = NULL;
-SemaphoreHandle_t xLab5PidActuatorSemaphore = NULL;
+Lab5PidShared g_lab5PidState;
+static SharedSnapshot<Lab5PidState> s_snapshot;
+QueueHandle_t xLab5PidSampleQueue = NULL;
+QueueHandle_t xLab5PidCommandQueue = NULL;
+
+// Kernel objects on storage reserved at link time (StaticRtos)
+static StaticQueue<Lab5PidSample, SAMPLE_QUEUE_DEPTH> s_sampleQueue;
+static StaticQueue<Lab5PidCommand, 1> s_commandQueue;
+
+// Outer: temperature → speed demand (% of FAN_MAX_RPM), reverse acting.
+// Inner: speed → duty. Outer gains come from the preset every cycle.
+static PidCascade s_cascade(PID_OUTPUT_MIN_PERCENT, PID_OUTPUT_MAX_PERCENT, PID_REVERSE,
+                            0.0f, 100.0f, PID_DIRECT);
+
+// The state mutex serializes the writers, as SharedSnapshot requires.
+static void publishSnapshot(const Lab5PidState &state, void *) {
+    s_snapshot.publish(state);
+    lab5PidDisplayStateReleased(state);
+}
 
 void lab5PidStateInit() {
-    memset(&g_lab5PidState, 0, sizeof(g_lab5PidState));
-
-    g_lab5PidState.measuredTempC = NAN;
-    g_lab5PidState.measuredHumidityPercent = NAN;
-    g_lab5PidState.sensorValid = false;
-    g_lab5PidState.potRaw = 0;
-    g_lab5PidState.potSetpointC = SETPOINT_DEFAULT_C;
-    g_lab5PidState.manualSetpointC = SETPOINT_DEFAULT_C;
-    g_lab5PidState.activeSetpointC = SETPOINT_DEFAULT_C;
-    g_lab5PidState.setpointSource = SETPOINT_SOURCE_POT;
-
-    g_lab5PidState.pidPresetIndex = 1;
-    g_lab5PidState.kp = PID_PRESETS[g_lab5PidState.pidPresetIndex].kp;
-    g_lab5PidState.ki = PID_PRESETS[g_lab5PidState.pidPresetIndex].ki;
-    g_lab5PidState.kd = PID_PRESETS[g_lab5PidState.pidPresetIndex].kd;
-
-    g_lab5PidState.errorC = 0.0f;
-    g_lab5PidState.pidIntegral = 0.0f;
-    g_lab5PidState.pidDerivative = 0.0f;
-    g_lab5PidState.controlOutputPercent = 0.0f;
-    g_lab5PidState.appliedDutyPercent = 0.0f;
-    g_lab5PidState.fanRunning = false;
-    g_lab5PidState.editingSetpoint = false;
-    g_lab5PidState.inputBuffer[0] = '\0';
-    g_lab5PidState.inputBufferLen = 0;
-
-    xLab5PidStateMutex = xSemaphoreCreateMutex();
-    xLab5PidNewSampleSemaphore = xSemaphoreCreateBinary();
-    xLab5PidActuatorSemaphore = xSemaphoreCreateBinary();
+    Lab5PidState initial;
+    memset(&initial, 0, sizeof(initial));
+
+    initial.measuredTempC = NAN;
+    initial.measuredHumidityPercent = NAN;
+    initial.sensorValid = false;
+    initial.potRaw = 0;
+    initial.potSetpointC = PID_ZONES[0].setpointC;
+    initial.manualSetpointC = PID_ZONES[0].setpointC;
+    initial.activeSetpointC = PID_ZONES[0].setpointC;
+    initial.setpointSource = SETPOINT_SOURCE_POT;
+    initial.sampleAgeMs = UINT32_MAX;
+
+    initial.pidPresetIndex = PID_ZONES[0].presetIndex;
+    initial.kp = PID_PRESETS[initial.pidPresetIndex].kp;
+    initial.ki = PID_PRESETS[initial.pidPresetIndex].ki;
+    initial.kd = PID_PRESETS[initial.pidPresetIndex].kd;
+    initial.tunedValid = false;
+    initial.pidAutotuneRequested = false;
+    initial.pidAutotuneCancelRequested = false;
+    initial.pidAutotuning = false;
+    initial.pidAutotuneCycles = 0;
+
+    initial.errorC = 0.0f;
+    initial.pidIntegral = 0.0f;
+    initial.pidDerivative = 0.0f;
+    initial.smithCorrectionC = 0.0f;
+    initial.estimatedTempC = NAN;
+    initial.controlOutputPercent = 0.0f;
+    initial.appliedDutyPercent = 0.0f;
+    initial.fanRunning = false;
+    initial.fanRpm = 0.0f;
+    initial.fanTargetRpm = 0.0f;
+    initial.fanStalled = false;
+    initial.fanSpeedIntegral = 0.0f;
+    initial.cascadeLimited = false;
+    initial.fanCalibrationRequested = false;
+    initial.fanCalibrating = false;
+    initial.fanCalibrationProgress = 0;
+    initial.loop.stepSettleS = NAN;
+    initial.loop.lastOvershoot = NAN;
+    initial.loop.lastSettleS = NAN;
+    initial.loop.lastIae = NAN;
+    initial.editingSetpoint = false;
+    initial.inputBuffer[0] = '\0';
+    initial.inputBufferLen = 0;
+
+    // Stored setpoint and source (the preset waits for the stored tuning).
+    lab5SettingsLoad(&initial);
+
+#if LAB5_2_ZONES > 1
+    for (uint8_t z = 0; z < PID_ZONE_COUNT; z++) {
+        initial.zones.temperatureC[z] = NAN;
+        initial.zones.setpointC[z] = PID_ZONES[z].setpointC;
+        initial.zones.presetIndex[z] = PID_ZONES[z].presetIndex;
+    }
+    initial.zones.setpointC[0] = initial.activeSetpointC;
+    initial.zones.presetIndex[0] = initial.pidPresetIndex;
+#endif
+
+    s_cascade.outer().setTunings(initial.kp, initial.ki, initial.kd);
+    s_cascade.inner().setTunings(FAN_SPEED_KP, FAN_SPEED_KI, 0.0f);
+    s_cascade.init();
+    s_snapshot.publish(initial);
+
+    g_lab5PidState.init(initial);
+    g_lab5PidState.setReleaseHook(publishSnapshot);
+    xLab5PidSampleQueue = s_sampleQueue.create();
+    xLab5PidCommandQueue = s_commandQueue.create();
 }
 
-void lab5PidStateLock() {
-    xSemaphoreTake(xLab5PidStateMutex, portMAX_DELAY);
+void lab5PidApplyPreset(Lab5PidState *state, uint8_t presetIndex) {
+    if (presetIndex == PID_PRESET_AUTO && state->tunedValid) {
+        state->pidPresetIndex = PID_PRESET_AUTO;
+        state->kp = state->tunedKp;
+        state->ki = state->tunedKi;
+        state->kd = state->tunedKd;
+        return;
+    }
+    if (presetIndex >= PID_PRESET_COUNT) {
+        presetIndex = 0;
+    }
+
+    state->pidPresetIndex = presetIndex;
+    state->kp = PID_PRESETS[presetIndex].kp;
+    state->ki = PID_PRESETS[presetIndex].ki;
+    state->kd = PID_PRESETS[presetIndex].kd;
 }
 
-void lab5PidStateUnlock() {
-    xSemaphoreGive(xLab5PidStateMutex);
+void lab5PidStateSnapshot(Lab5PidState *out) {
+    s_snapshot.read(*out);
 }
 
-Lab5PidState* lab5PidStateGet() {
-    return &g_lab5PidState;
+PidCascade* lab5PidCascadeGet() {
+    return &s_cascade;
 }
@@ -8,14 +8,35 @@
 
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
-#include <semphr.h>
+#include <queue.h>
 #include "lab5_2_config.h"
+#include "LoopMetrics.h"
+#include "PidCascade.h"
+#include "SharedState.h"
+#include "SharedSnapshot.h"
 
 enum SetpointSource {
     SETPOINT_SOURCE_POT = 0,
     SETPOINT_SOURCE_MANUAL = 1
 };
 
+#if LAB5_2_ZONES > 1
+/**
+ * @brief Every zone's loop at a glance, one array entry per zone (SoA:
+ *        the telemetry and the zone commands index one field across
+ *        zones). Entry 0 mirrors the primary loop's own fields.
+ */
+struct Lab5PidZones {
+    float temperatureC[PID_ZONE_COUNT];
+    float setpointC[PID_ZONE_COUNT];
+    float outputPercent[PID_ZONE_COUNT];
+    float dutyPercent[PID_ZONE_COUNT];
+    uint8_t presetIndex[PID_ZONE_COUNT];
+    uint32_t samples[PID_ZONE_COUNT];
+    uint8_t validMask;         // Bit z: zone z's last sample was valid
+};
+#endif
+
 struct Lab5PidState {
     float measuredTempC;
     float measuredHumidityPercent;
@@ -31,12 +52,35 @@ struct Lab5PidState {
     float kd;
     uint8_t pidPresetIndex;
 
+    bool tunedValid;           // Autotuned gains available (AUTO preset)
+    float tunedKp;
+    float tunedKi;
+    float tunedKd;
+    bool pidAutotuneRequested;
+    bool pidAutotuneCancelRequested;
+    bool pidAutotuning;
+    uint8_t pidAutotuneCycles;
+
     float errorC;
     float pidIntegral;
     float pidDerivative;
+    float smithCorrectionC;    // Dead-time compensation added to the PV
+    float estimatedTempC;      // Observer estimate the PID runs on (NAN if off)
     float controlOutputPercent;
     float appliedDutyPercent;
     bool fanRunning;
+    float fanRpm;
+    float fanTargetRpm;        // Speed loop demand (0 in open loop)
+    float fanSpeedIntegral;    // Inner (speed) loop integral
+    bool cascadeLimited;       // Outer output capped by a saturated speed loop
+    bool fanStalled;           // Driven but no tach edges
+    bool fanCalibrationRequested;
+    bool fanCalibrating;
+    uint8_t fanCalibrationProgress;  // Percent of the sweep done
+    uint32_t fanSwitches;      // Fan starts and stops (actuation task)
+
+    LoopMetricsReport loop;    // Loop figures (control task)
+    bool loopMetricsClearRequested;
 
     bool editingSetpoint;
     char inputBuffer[SETPOINT_INPUT_MAX_DIGITS + 1];
@@ -45,17 +89,105 @@ struct Lab5PidState {
     uint32_t sampleCount;
     uint32_t controlCycles;
     uint32_t actuatorUpdates;
+    uint32_t sampleOverruns;   // Samples dropped on a full sample queue
+    uint32_t commandOverruns;  // Outputs replaced before actuation took them
     TickType_t lastSampleTick;
+    uint32_t sampleAgeMs;      // Age of the cached DHT sample at lastSampleTick
+
+#if LAB5_2_ZONES > 1
+    Lab5PidZones zones;
+#endif
+
+    // Filled in by the telemetry task in its own snapshot (MemoryMonitor),
+    // never in the shared state.
+    uint16_t ramGapBytes;
+    uint16_t ramGapMinBytes;
+    uint16_t heapBytes;
+#if LAB5_2_ZONES > 1
+    // Likewise: the zone selected with "zone <n>", for the z* fields.
+    uint8_t zoneIndex;
+    float zoneTempC;
+    float zoneSetpointC;
+    float zoneOutputPercent;
+    float zoneDutyPercent;
+    bool zoneValid;
+    uint8_t zonePresetIndex;
+    uint32_t zoneSamples;
+#endif
 };
 
-extern Lab5PidState g_lab5PidState;
-extern SemaphoreHandle_t xLab5PidStateMutex;
-extern SemaphoreHandle_t xLab5PidNewSampleSemaphore;
-extern SemaphoreHandle_t xLab5PidActuatorSemaphore;
+/** @brief One acquisition, queued to the control task (xLab5PidSampleQueue). */
+struct Lab5PidSample {
+    TickType_t tick;           // Acquisition time
+    float temperatureC;
+    bool valid;
+    uint32_t ageMs;            // Age of the cached DHT sample at tick
+    uint32_t captureUs;        // micros() when the sensor took it (PID/observer dt)
+    uint8_t zone;              // PID_ZONES row (0: the primary loop)
+};
+
+/** @brief Latest control output (xLab5PidCommandQueue mailbox). */
+struct Lab5PidCommand {
+    TickType_t tick;           // Control cycle that produced it
+    float outputPercent;
+    bool sensorValid;
+};
+
+typedef SharedState<Lab5PidState> Lab5PidShared;
+
+/**
+ * @brief The state, reachable only through a Lab5PidShared::Lock or
+ *        update()/read(). Every release publishes the reader snapshot,
+ *        so it always matches the state as the last lock holder left it.
+ */
+extern Lab5PidShared g_lab5PidState;
+
+/** @brief Acquisition → control, SAMPLE_QUEUE_DEPTH samples, never waits. */
+extern QueueHandle_t xLab5PidSampleQueue;
+
+/**
+ * @brief Control → actuation, one-slot mailbox: the fan only needs the
+ *        latest output, so a newer one overwrites a pending one (counted
+ *        in commandOverruns).
+ */
+extern QueueHandle_t xLab5PidCommandQueue;
 
 void lab5PidStateInit();
-void lab5PidStateLock();
-void lab5PidStateUnlock();
-Lab5PidState* lab5PidStateGet();
+
+/**
+ * @brief Select a PID preset (index PID_PRESET_AUTO: the autotuned gains,
+ *        if any; an unknown index selects preset 0). Lock held.
+ */
+void lab5PidApplyPreset(Lab5PidState *state, uint8_t presetIndex);
+
+/**
+ * @brief Lock-free consistent copy of the state for tasks that only read it
+ *        (display, telemetry); never waits for or delays a lock holder.
+ */
+void lab5PidStateSnapshot(Lab5PidState *out);
+
+/**
+ * @brief Temperature → fan speed cascade: outer loop in the control task,
+ *        inner loop in the actuation task. Use with a Lab5PidShared::Lock
+ *        or a Lab5PidCascadeLock held.
+ */
+PidCascade* lab5PidCascadeGet();
+
+/**
+ * @brief Scoped guard for the cascade alone: the state lock while the
+ *        control and actuation tasks share it, nothing in the fused
+ *        pipeline (-DLAB5_2_FUSED_PIPELINE), where one task runs both loops.
+ */
+class Lab5PidCascadeLock {
+public:
+#if defined(LAB5_2_FUSED_PIPELINE)
+    Lab5PidCascadeLock() {}
+#else
+    Lab5PidCascadeLock() : _lock(g_lab5PidState) {}
+
+private:
+    Lab5PidShared::Lock _lock;
+#endif
+};
 
 #endif // LAB5_2_SHARED_STATE_H
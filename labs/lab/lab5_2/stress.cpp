@@ -0,0 +1,411 @@
+/**
+ * @file stress.cpp
+ * @brief Lab 5.2 stress mode implementation (-DLAB5_2_STRESS).
+ *
+ * The commands only post a request; the driver task takes it at its next
+ * job, so the ramp, the active level and the results have one writer.
+ * The load tasks read the active level in a critical section (a few
+ * bytes) and block on a notification while parked.
+ */
+
+#include "stress.h"
+#include "lab5_2_config.h"
+#include "FlashString.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#if defined(LAB5_2_STRESS)
+
+#include "shared_state.h"
+#include "zones.h"
+#include "SyntheticLoad.h"
+#include "StressRamp.h"
+#include "StdioSerial.h"
+#include "TaskMonitor.h"
+#include "RtosTime.h"
+
+#include <Arduino_FreeRTOS.h>
+#include <string.h>
+
+static_assert(LAB5_2_STRESS_LOADS >= 1 && LAB5_2_STRESS_LOADS <= 4,
+              "LAB5_2_STRESS_LOADS must be 1..4 (task table rows)");
+
+// ──────────────────────────────────────────────────────────────────────────
+// State
+// ──────────────────────────────────────────────────────────────────────────
+
+enum Lab5StressRequest {
+    STRESS_REQUEST_NONE = 0,
+    STRESS_REQUEST_RUN,
+    STRESS_REQUEST_HOLD,
+    STRESS_REQUEST_OFF
+};
+
+/** @brief What one level's last window showed. */
+struct Lab5StressResult {
+    StressWindow window;
+    uint32_t txDropped;   // Console bytes dropped (printf load; not scored)
+    bool scored;
+    bool passed;
+};
+
+/** @brief Monitor totals at a window's start. */
+struct Lab5StressTotals {
+    TaskMonitorTotals monitor;
+    uint32_t ms;
+    uint32_t sampleOverruns;
+    uint32_t txDropped;
+};
+
+static const StressLevel STRESS_OFF = {0, STRESS_IDLE_PERIOD_MS, 0, 0, 0, 0, STRESS_IDLE_PERIOD_MS};
+
+static volatile uint8_t s_request = STRESS_REQUEST_NONE;
+static volatile uint8_t s_requestLevel = 0;
+
+static StressLevel s_active = STRESS_OFF;   // Read by the load tasks (critical section)
+static int8_t s_activeIndex = -1;           // STRESS_LEVELS row, -1: off
+static bool s_holding = false;
+
+static TaskHandle_t s_loadTasks[LAB5_2_STRESS_LOADS];
+static uint8_t s_loadCount = 0;
+
+static StressRamp s_ramp(STRESS_SETTLE_MS, STRESS_WINDOW_MS, STRESS_REPEATS,
+                         STRESS_MAX_BUSY_PERMILLE);
+static Lab5StressResult s_results[STRESS_LEVEL_COUNT];
+static Lab5StressTotals s_start;
+static bool s_reportDue = false;
+static uint32_t s_reportAtMs = 0;
+
+static SyntheticChannel s_channels[STRESS_MAX_CHANNELS];
+
+static void readLevel(uint8_t index, StressLevel *out) {
+    memcpy_P(out, &STRESS_LEVELS[index], sizeof(*out));
+}
+
+/** @brief The level the tasks run now. */
+static void activeLevel(StressLevel *out) {
+    taskENTER_CRITICAL();
+    *out = s_active;
+    taskEXIT_CRITICAL();
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Load tasks
+// ──────────────────────────────────────────────────────────────────────────
+
+void vTaskLab5StressLoad(void *pvParameters) {
+    (void)pvParameters;
+
+    taskENTER_CRITICAL();
+    uint8_t index = s_loadCount;
+    s_loadTasks[index] = xTaskGetCurrentTaskHandle();
+    s_loadCount = (uint8_t)(s_loadCount + 1);
+    taskEXIT_CRITICAL();
+
+    RtosPeriod period(STRESS_IDLE_PERIOD_MS);
+    taskMonitorWatch(&period);
+
+    bool parked = true;
+    uint16_t seq = 0;
+    for (;;) {
+        StressLevel level;
+        activeLevel(&level);
+        if (index >= level.loadTasks) {
+            // Keeps the record of the last level for "mon".
+            parked = true;
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        if (parked || period.periodMs() != level.loadPeriodMs) {
+            // A fresh release grid: a stale one would count the parked time as drops.
+            period = RtosPeriod(level.loadPeriodMs);
+            parked = false;
+        }
+
+        syntheticBusyUs(level.cpuUs);
+        if (level.lockUs > 0) {
+            Lab5PidShared::Lock hold(g_lab5PidState);
+            syntheticBusyUs(level.lockUs);
+        }
+        syntheticPrint((uint8_t)(index + 1), seq++, level.printChars);
+
+        period.wait();
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Driver
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Switch to STRESS_LEVELS row @p index (-1: off) and wake the load tasks. */
+static void applyLevel(int8_t index, RtosPeriod *period) {
+    StressLevel level = STRESS_OFF;
+    if (index >= 0) {
+        readLevel((uint8_t)index, &level);
+        if (level.loadTasks > LAB5_2_STRESS_LOADS) {
+            level.loadTasks = LAB5_2_STRESS_LOADS;
+        }
+        if (level.channels > STRESS_MAX_CHANNELS) {
+            level.channels = STRESS_MAX_CHANNELS;
+        }
+        if (level.loadPeriodMs == 0) {
+            level.loadPeriodMs = STRESS_IDLE_PERIOD_MS;
+        }
+    }
+    taskENTER_CRITICAL();
+    s_active = level;
+    taskEXIT_CRITICAL();
+    s_activeIndex = index;
+
+    for (uint8_t i = 0; i < s_loadCount; i++) {
+        xTaskNotifyGive(s_loadTasks[i]);
+    }
+
+    uint16_t periodMs = (level.channels > 0 && level.channelPeriodMs > 0) ? level.channelPeriodMs
+                                                                          : STRESS_IDLE_PERIOD_MS;
+    if (period->periodMs() != periodMs) {
+        *period = RtosPeriod(periodMs);
+    }
+}
+
+/** @brief Queue channel @p c's sample for its satellite zone, as acquisition does. */
+static void feedChannel(uint8_t c) {
+    Lab5PidSample sample;
+    sample.zone = (uint8_t)(1 + c % (PID_ZONE_COUNT - 1));
+    sample.tick = xTaskGetTickCount();
+    sample.valid = true;
+    sample.ageMs = 0;
+    sample.captureUs = micros();
+
+    Lab5PidShared::Lock state(g_lab5PidState);
+    sample.temperatureC = syntheticChannelRead(&s_channels[c], state->zones.setpointC[sample.zone],
+                                               STRESS_CHANNEL_AMPLITUDE_C, STRESS_CHANNEL_NOISE_C,
+                                               STRESS_CHANNEL_WAVE_MS, millis());
+    lab5PidZoneAcquisitionStore(state.get(), sample);
+    if (xQueueSend(xLab5PidSampleQueue, &sample, 0) != pdTRUE) {
+        state->sampleOverruns++;
+    }
+}
+
+static void takeTotals(Lab5StressTotals *out) {
+    taskMonitorTotals(&out->monitor);
+    out->ms = millis();
+    out->txDropped = stdioSerialGetTxDropped();
+    Lab5PidShared::Lock state(g_lab5PidState);
+    out->sampleOverruns = state->sampleOverruns;
+}
+
+/** @brief Differences from @p start to now. */
+static void windowSince(const Lab5StressTotals &start, StressWindow *out, uint32_t *txDropped) {
+    Lab5StressTotals end;
+    takeTotals(&end);
+    out->windowMs = end.ms - start.ms;
+    uint32_t busy = end.monitor.busySamples - start.monitor.busySamples;
+    uint32_t permille = (out->windowMs > 0) ? busy * TASK_MONITOR_SAMPLE_US / out->windowMs : 0;
+    out->busyPermille = (uint16_t)((permille > 1000) ? 1000 : permille);
+    out->misses = end.monitor.misses - start.monitor.misses;
+    out->overruns = end.monitor.overruns - start.monitor.overruns;
+    out->queueDrops = end.sampleOverruns - start.sampleOverruns;
+    *txDropped = end.txDropped - start.txDropped;
+}
+
+static void takeRequest(RtosPeriod *period) {
+    uint8_t request = s_request;
+    if (request == STRESS_REQUEST_NONE) {
+        return;
+    }
+    s_request = STRESS_REQUEST_NONE;
+    s_ramp.stop();
+    s_reportDue = false;
+    s_holding = false;
+
+    if (request == STRESS_REQUEST_RUN) {
+        memset(s_results, 0, sizeof(s_results));
+        s_ramp.begin(STRESS_LEVEL_COUNT, millis());
+        FLASH_PRINTF("[STRESS] Ramp: %u levels, %lu ms settle + %u x %lu ms windows each\r\n",
+                     (unsigned)STRESS_LEVEL_COUNT, (unsigned long)STRESS_SETTLE_MS,
+                     (unsigned)STRESS_REPEATS, (unsigned long)STRESS_WINDOW_MS);
+    } else if (request == STRESS_REQUEST_HOLD) {
+        s_holding = true;
+        applyLevel((int8_t)s_requestLevel, period);
+        FLASH_PRINTF("[STRESS] Holding level %u\r\n", (unsigned)s_requestLevel);
+    } else {
+        applyLevel(-1, period);
+        FLASH_PRINTF("[STRESS] Off\r\n");
+    }
+}
+
+/** @brief One line per level of the table, with its last result. */
+static void printResults() {
+    FLASH_PRINTF("STRESS,level,loads,load_ms,cpu_us,lock_us,chars,channels,channel_ms,"
+                 "busy_pm,miss,drop,qdrop,txdrop,result\r\n");
+    for (uint8_t i = 0; i < STRESS_LEVEL_COUNT; i++) {
+        StressLevel level;
+        readLevel(i, &level);
+        const Lab5StressResult &r = s_results[i];
+        FLASH_PRINTF("STRESS,%u,%u,%u,%u,%u,%u,%u,%u,", (unsigned)i, (unsigned)level.loadTasks,
+                     (unsigned)level.loadPeriodMs, (unsigned)level.cpuUs, (unsigned)level.lockUs,
+                     (unsigned)level.printChars, (unsigned)level.channels,
+                     (unsigned)level.channelPeriodMs);
+        if (r.scored) {
+            FLASH_PRINTF("%u,%lu,%lu,%lu,%lu,%s\r\n", (unsigned)r.window.busyPermille,
+                         (unsigned long)r.window.misses, (unsigned long)r.window.overruns,
+                         (unsigned long)r.window.queueDrops, (unsigned long)r.txDropped,
+                         r.passed ? "PASS" : "FAIL");
+        } else {
+            FLASH_PRINTF(",,,,,-\r\n");
+        }
+    }
+}
+
+static void printVerdict() {
+    int16_t best = s_ramp.best();
+    if (best < 0) {
+        FLASH_PRINTF("[STRESS] Max sustainable: none (level 0, the lab alone, fails)\r\n");
+        return;
+    }
+    StressLevel level;
+    readLevel((uint8_t)best, &level);
+    FLASH_PRINTF("[STRESS] Max sustainable: level %d (%u loads x %u us / %u ms, %u chars; "
+                 "%u channels / %u ms)%s\r\n",
+                 (int)best, (unsigned)level.loadTasks,
+                 (unsigned)(level.cpuUs + level.lockUs), (unsigned)level.loadPeriodMs,
+                 (unsigned)level.printChars, (unsigned)level.channels,
+                 (unsigned)level.channelPeriodMs,
+                 s_ramp.exhausted() ? ", the whole table: add heavier levels" : "");
+}
+
+static void stepRamp(RtosPeriod *period) {
+    switch (s_ramp.poll(millis())) {
+    case STRESS_STEP_APPLY:
+        applyLevel((int8_t)s_ramp.level(), period);
+        FLASH_PRINTF("[STRESS] Level %u\r\n", (unsigned)s_ramp.level());
+        break;
+    case STRESS_STEP_BASELINE:
+        takeTotals(&s_start);
+        break;
+    case STRESS_STEP_SCORE: {
+        Lab5StressResult &r = s_results[s_ramp.level()];
+        windowSince(s_start, &r.window, &r.txDropped);
+        r.scored = true;
+        r.passed = s_ramp.score(r.window);
+        // Also dropped, with the line, while the printf load fills the TX ring.
+        FLASH_PRINTF("[STRESS] Level %u window: busy %u pm, %lu missed, %s\r\n",
+                     (unsigned)s_ramp.level(), (unsigned)r.window.busyPermille,
+                     (unsigned long)r.window.misses, r.passed ? "PASS" : "FAIL");
+        break;
+    }
+    case STRESS_STEP_DONE:
+        applyLevel(-1, period);
+        s_reportDue = true;
+        s_reportAtMs = millis() + STRESS_DRAIN_MS;
+        break;
+    default:
+        break;
+    }
+
+    if (s_reportDue && (int32_t)(millis() - s_reportAtMs) >= 0) {
+        s_reportDue = false;
+        // Load off and the ring drained: now every line matters.
+        stdioSerialSetTxPolicy(STDIO_TX_BLOCK);
+        printResults();
+        printVerdict();
+        taskMonitorReport();
+        stdioSerialSetTxPolicy(STDIO_TX_DROP);
+    }
+}
+
+void vTaskLab5Stress(void *pvParameters) {
+    (void)pvParameters;
+
+    // Seeded and spread over the wave per channel: a repeat run reads the same.
+    for (uint8_t c = 0; c < STRESS_MAX_CHANNELS; c++) {
+        syntheticChannelInit(&s_channels[c], (uint32_t)c + 1,
+                             STRESS_CHANNEL_WAVE_MS / STRESS_MAX_CHANNELS * c);
+    }
+
+    RtosPeriod period(STRESS_IDLE_PERIOD_MS);
+    taskMonitorWatch(&period);
+
+    for (;;) {
+        takeRequest(&period);
+
+        StressLevel level;
+        activeLevel(&level);
+        // Channels staggered over the period, as the satellites are.
+        for (uint8_t c = 0; c < level.channels; c++) {
+            period.waitOffset((uint32_t)level.channelPeriodMs * c / level.channels);
+            feedChannel(c);
+        }
+
+        stepRamp(&period);
+        period.wait();
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Commands
+// ──────────────────────────────────────────────────────────────────────────
+
+bool lab5StressRun() {
+    s_request = STRESS_REQUEST_RUN;
+    return true;
+}
+
+bool lab5StressHold(uint8_t level) {
+    if (level >= STRESS_LEVEL_COUNT) {
+        FLASH_PRINTF("[ERROR] Stress level: 0..%u\r\n", (unsigned)(STRESS_LEVEL_COUNT - 1));
+        return false;
+    }
+    s_requestLevel = level;
+    s_request = STRESS_REQUEST_HOLD;
+    return true;
+}
+
+void lab5StressOff() {
+    s_request = STRESS_REQUEST_OFF;
+}
+
+void lab5StressReport() {
+    if (s_ramp.running()) {
+        FLASH_PRINTF("[STRESS] Running: level %u, window %u of %u\r\n", (unsigned)s_ramp.level(),
+                     (unsigned)(s_ramp.run() + 1), (unsigned)s_ramp.repeats());
+    } else if (s_holding) {
+        FLASH_PRINTF("[STRESS] Holding level %d\r\n", (int)s_activeIndex);
+    } else {
+        FLASH_PRINTF("[STRESS] Off (%u load tasks, %u channels available)\r\n",
+                     (unsigned)s_loadCount, (unsigned)STRESS_MAX_CHANNELS);
+    }
+    printResults();
+    if (!s_ramp.running() && s_results[0].scored) {
+        printVerdict();
+    }
+}
+
+#else  // !LAB5_2_STRESS
+
+static void printDisabled() {
+    FLASH_PRINTF("[STRESS] Disabled (build with -DLAB5_2_STRESS, env:lab5_2_stress)\r\n");
+}
+
+bool lab5StressRun() {
+    printDisabled();
+    return false;
+}
+
+bool lab5StressHold(uint8_t level) {
+    (void)level;
+    printDisabled();
+    return false;
+}
+
+void lab5StressOff() {
+    printDisabled();
+}
+
+void lab5StressReport() {
+    printDisabled();
+}
+
+#endif // LAB5_2_STRESS
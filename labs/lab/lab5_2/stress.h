@@ -0,0 +1,66 @@
+/**
+ * @file stress.h
+ * @brief Lab 5.2 stress mode (-DLAB5_2_STRESS): synthetic load, synthetic
+ *        sensor channels and the scaling benchmark.
+ *
+ * Two kinds of task join the lab's own (task table in lab5_2_main.cpp):
+ *
+ *   Stress   the driver, at acquisition priority: feeds each synthetic
+ *            channel's sample (SyntheticChannel) through the same path
+ *            as a satellite NTC's (zone store under the lock, sample
+ *            queue, zone PID in the control task), takes the commands
+ *            and steps the StressRamp
+ *   LoadN    LAB5_2_STRESS_LOADS load tasks: per job, busy time, busy
+ *            time holding the state lock (contending with the lab's
+ *            tasks) and one console line; parked unless the level
+ *            runs them
+ *
+ * Every one of them registers its RtosPeriod with TaskMonitor, so the
+ * synthetic jobs' deadlines count with the real ones. A window scores
+ * the differences of taskMonitorTotals() (busy CPU, deadlines missed,
+ * releases dropped) and of the sample-queue overruns; StressRamp.h has
+ * the pass rule. The results wait for the end of the run, when the load
+ * is off and the TX ring has drained (the printf load drops output):
+ *
+ *   STRESS,level,loads,load_ms,cpu_us,lock_us,chars,channels,channel_ms,busy_pm,miss,drop,qdrop,txdrop,result
+ *   STRESS,3,3,100,6000,300,24,3,250,742,0,0,0,0,PASS
+ *   STRESS,4,3,50,6000,400,24,3,100,911,0,0,0,1733,FAIL
+ *   [STRESS] Max sustainable: level 3 (3 loads x 6300 us / 100 ms, 24 chars; 3 channels / 250 ms)
+ *
+ * followed by the "mon" table, which names the tasks that missed.
+ *
+ * Serial commands:
+ *   stress run          Ramp through STRESS_LEVELS (about a minute per level)
+ *   stress level <i>    Hold level i (watch it with "mon"); ends a run
+ *   stress off          Park the load tasks and channels; ends a run
+ *   stress              Mode, level table and the last run's results
+ *
+ * Without -DLAB5_2_STRESS the commands say how to build it.
+ */
+
+#ifndef LAB5_2_STRESS_H
+#define LAB5_2_STRESS_H
+
+#include <stdint.h>
+
+#if defined(LAB5_2_STRESS)
+/** @brief Driver task: channels, commands, ramp. */
+void vTaskLab5Stress(void *pvParameters);
+
+/** @brief Load task; each instance takes the next index as it starts. */
+void vTaskLab5StressLoad(void *pvParameters);
+#endif
+
+/** @brief Start a ramp from level 0 ("stress run"). @return false (and says so) if not built. */
+bool lab5StressRun();
+
+/** @brief Hold STRESS_LEVELS row @p level. @return false (and says why) if out of range or not built. */
+bool lab5StressHold(uint8_t level);
+
+/** @brief Park the load ("stress off"). */
+void lab5StressOff();
+
+/** @brief Mode, level table and last results ("stress"). */
+void lab5StressReport();
+
+#endif // LAB5_2_STRESS_H
@@ -1,17 +1,33 @@
 /**
  * @file task_acquisition.cpp
  * @brief Lab 5.2 DHT11 and potentiometer acquisition task.
+ *
+ * With -DLAB5_SIM the temperature comes from the simulated room
+ * (plant_sim.h) instead of the DHT11.
+ *
+ * With satellite zones (zones.h) each period also reads zone z at
+ * lab5PidZoneOffsetMs(z) and queues its sample, tagged with the zone,
+ * behind zone 0's.
  */
 
 #include "task_acquisition.h"
 #include "lab5_2_config.h"
 #include "shared_state.h"
 
+#include "plant_sim.h"
+#include "zones.h"
+#include "perf.h"
+
 #include "DhtSensor.h"
+#include "DhtSensorRtos.h"
 #include "AnalogSetpointInput.h"
+#include "AdcEngine.h"
+#include "RtosTime.h"
+#include "TaskMonitor.h"
+#include "FlashString.h"
 
 #include <Arduino_FreeRTOS.h>
-#include <DHT.h>
+#include <stdio.h>
 
 static DhtSensor s_dht(PIN_DHT_SENSOR, DHT_SENSOR_TYPE);
 static AnalogSetpointInput s_setpointPot(
@@ -20,43 +36,127 @@ static AnalogSetpointInput s_setpointPot(
     SETPOINT_MAX_C
 );
 
-void vTaskLab5PidAcquisition(void *pvParameters) {
-    (void)pvParameters;
+// The pot in slot 0, then zone z's NTC in slot z.
+static uint8_t s_adcEnginePins[PID_ZONE_COUNT];
 
+void lab5PidAcquisitionInit() {
+#if defined(LAB5_SIM)
+    lab5PidSimInit();
+#else
     s_dht.init();
+#endif
     s_setpointPot.init();
+    s_setpointPot.setQuantization(SETPOINT_STEP_C, SETPOINT_POT_OVERSAMPLE_LOG2,
+                                  SETPOINT_POT_DEAD_BAND_PERCENT);
+#if LAB5_2_ZONES > 1
+    lab5PidZoneAcquisitionInit();
+#endif
+
+    s_adcEnginePins[0] = PIN_SETPOINT_POT;
+    for (uint8_t z = 1; z < PID_ZONE_COUNT; z++) {
+        s_adcEnginePins[z] = PID_ZONES[z].sensorPin;
+    }
+    if (ADC_ENGINE_ENABLED) {
+        if (adcEngineInit(s_adcEnginePins, PID_ZONE_COUNT, ADC_OVERSAMPLE_LOG2)) {
+            adcEngineStart();
+            s_setpointPot.useAdcEngine(0);
+            while (adcEngineSequence() == 0) {
+                vTaskDelay(rtosMsToTicks(10));
+            }
+        } else {
+            FLASH_PRINTF("[ERROR] ADC engine init failed, using analogRead()\r\n");
+        }
+    }
+}
+
+void lab5PidAcquire(Lab5PidAcquisition *out) {
+    uint32_t startUs = micros();
+#if defined(LAB5_SIM)
+    out->sample.valid = true;
+    out->sample.tick = xTaskGetTickCount();
+    out->sample.ageMs = 0;
+    out->sample.captureUs = micros();
+    out->sample.temperatureC = lab5PidSimRead();
+    out->humidityPercent = SIM_HUMIDITY_PERCENT;
+#else
+    // Sleeps through the start pulse, then waits on the edge ISR's
+    // notification: interrupts stay enabled for the whole read. The
+    // driver rate-limits the bus, so the caller's period no longer has
+    // to match the DHT's; between reads the cached sample and its age
+    // are returned.
+    out->sample.valid = dhtSensorReadRtos(s_dht);
+    out->sample.tick = xTaskGetTickCount();
+    out->sample.ageMs = s_dht.getSampleAgeMs();
+    out->sample.captureUs = s_dht.getSampleTimeUs();
+    out->sample.temperatureC = s_dht.getTemperatureC();
+    out->humidityPercent = s_dht.getHumidityPercent();
+#endif
+    out->sample.zone = 0;
+    out->potSetpointC = s_setpointPot.readValue();
+    out->potRaw = s_setpointPot.getLastRaw();
+
+    if (!out->sample.valid) {
+        perfCount(&g_lab5PerfBadReads);
+    }
+    perfRecord(&g_lab5PerfAcquireUs, micros() - startUs);
+}
 
-    TickType_t lastWake = xTaskGetTickCount();
-    const TickType_t period = pdMS_TO_TICKS(TASK_ACQUISITION_PERIOD_MS);
+void lab5PidAcquisitionStore(Lab5PidState *state, const Lab5PidAcquisition &in) {
+    state->sensorValid = in.sample.valid;
+    state->measuredTempC = in.sample.temperatureC;
+    state->measuredHumidityPercent = in.humidityPercent;
+    state->potRaw = in.potRaw;
+    state->potSetpointC = in.potSetpointC;
+
+    if (state->setpointSource == SETPOINT_SOURCE_POT) {
+        state->activeSetpointC = in.potSetpointC;
+    } else {
+        state->activeSetpointC = state->manualSetpointC;
+    }
+
+    state->sampleCount++;
+    state->lastSampleTick = in.sample.tick;
+    state->sampleAgeMs = in.sample.ageMs;
+#if LAB5_2_ZONES > 1
+    lab5PidZoneAcquisitionStore(state, in.sample);
+#endif
+}
+
+void vTaskLab5PidAcquisition(void *pvParameters) {
+    (void)pvParameters;
+
+    lab5PidAcquisitionInit();
+
+    RtosPeriod period(TASK_ACQUISITION_PERIOD_MS);
+    taskMonitorWatch(&period);
 
     for (;;) {
-        bool sensorOk = s_dht.read();
-        float temperature = s_dht.getTemperatureC();
-        float humidity = s_dht.getHumidityPercent();
-        float potSetpoint = s_setpointPot.readValue();
-        uint16_t potRaw = s_setpointPot.getLastRaw();
-
-        lab5PidStateLock();
-        Lab5PidState *state = lab5PidStateGet();
-
-        state->sensorValid = sensorOk;
-        state->measuredTempC = temperature;
-        state->measuredHumidityPercent = humidity;
-        state->potRaw = potRaw;
-        state->potSetpointC = potSetpoint;
-
-        if (state->setpointSource == SETPOINT_SOURCE_POT) {
-            state->activeSetpointC = potSetpoint;
-        } else {
-            state->activeSetpointC = state->manualSetpointC;
+        Lab5PidAcquisition reading;
+        lab5PidAcquire(&reading);
+
+        {
+            Lab5PidShared::Lock state(g_lab5PidState);
+            lab5PidAcquisitionStore(state.get(), reading);
+            if (xQueueSend(xLab5PidSampleQueue, &reading.sample, 0) != pdTRUE) {
+                state->sampleOverruns++;  // Control is a whole queue behind
+            }
         }
 
-        state->sampleCount++;
-        state->lastSampleTick = xTaskGetTickCount();
+#if LAB5_2_ZONES > 1
+        // Satellites spread over the period, clear of the DHT transfer.
+        for (uint8_t z = 1; z < PID_ZONE_COUNT; z++) {
+            period.waitOffset(lab5PidZoneOffsetMs(z));
+            Lab5PidSample zoneSample;
+            lab5PidZoneAcquire(z, &zoneSample);
 
-        lab5PidStateUnlock();
-        xSemaphoreGive(xLab5PidNewSampleSemaphore);
+            Lab5PidShared::Lock state(g_lab5PidState);
+            lab5PidZoneAcquisitionStore(state.get(), zoneSample);
+            if (xQueueSend(xLab5PidSampleQueue, &zoneSample, 0) != pdTRUE) {
+                state->sampleOverruns++;
+            }
+        }
+#endif
 
-        vTaskDelayUntil(&lastWake, period);
+        period.wait();
     }
 }
@@ -6,6 +6,27 @@
 #ifndef LAB5_2_TASK_ACQUISITION_H
 #define LAB5_2_TASK_ACQUISITION_H
 
+#include "shared_state.h"
+
+/** @brief One DHT + pot reading, before it is stored. */
+struct Lab5PidAcquisition {
+    Lab5PidSample sample;      // What the control stage gets
+    float humidityPercent;
+    float potSetpointC;
+    uint16_t potRaw;
+};
+
+// ── Stage API (used by the task below and by the fused pipeline) ─────
+
+/** @brief Set up the DHT and the pot (and the AdcEngine, if enabled). */
+void lab5PidAcquisitionInit();
+
+/** @brief Read the sensors; sleeps through the DHT transfer. */
+void lab5PidAcquire(Lab5PidAcquisition *out);
+
+/** @brief Store a reading in the state and pick the active setpoint (lock held). */
+void lab5PidAcquisitionStore(Lab5PidState *state, const Lab5PidAcquisition &in);
+
 void vTaskLab5PidAcquisition(void *pvParameters);
 
 #endif // LAB5_2_TASK_ACQUISITION_H
@@ -1,60 +1,262 @@
 /**
  * @file task_actuation.cpp
  * @brief Lab 5.2 fan actuation task implementation.
+ *
+ * Wakes on every new PID output and at least every
+ * FAN_TACH_UPDATE_PERIOD_MS to refresh the tachometer reading. With
+ * FAN_SPEED_LOOP_ENABLED the PID output is an RPM demand (0..FAN_MAX_RPM)
+ * and the inner PI loop of the shared PidCascade sets the duty from the
+ * tach at that period (its saturation caps the outer demand); otherwise the output maps to duty through the fan curve (FanCurve).
+ *
+ * Fan calibration ("fan cal", or at boot without a stored curve) takes
+ * the fan over for ~40 s: the FanCurveCalibrator sweep sets the duty
+ * from the tach reading, the PID output is ignored, and a successful
+ * curve is saved to EEPROM and used from then on.
+ *
+ * With -DLAB5_SIM the applied duty also drives the simulated room's fan
+ * (plant_sim.h), and no calibration runs at boot.
  */
 
 #include "task_actuation.h"
 #include "lab5_2_config.h"
 #include "shared_state.h"
 #include "HBridgeMotor.h"
+#include "FanTachometer.h"
+#include "PidCascade.h"
+#include "FanCurve.h"
+#include "plant_sim.h"
+#include "perf.h"
+#include "FlashString.h"
 
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
+#include <stdio.h>
 
 static HBridgeMotor s_fan(PIN_FAN_PWM, PIN_FAN_IN1, PIN_FAN_IN2);
+static FanTachometer s_tach(PIN_FAN_TACH, FAN_TACH_PULSES_PER_REV);
+static FanCurve s_curve;
+static FanCurveCalibrator s_calibrator;
+static Lab5PidState s_stateView;  // Static: too large for this task's stack
+
+static bool s_tachOk = false;
+static bool s_speedLoop = false;
+static bool s_calibrate = false;
+static uint32_t s_previousUs = 0;
+static TickType_t s_runningSince = 0;
+static bool s_commanded = false;
+
+// Results of the last lab5PidActuate() for lab5PidActuationStore().
+static float s_rpm = 0.0f;
+static float s_targetRpm = 0.0f;
+static bool s_stalled = false;
+static bool s_applied = false;
 
 static float mapPidOutputToFanDuty(float outputPercent) {
     if (outputPercent <= FAN_STOP_THRESHOLD_PERCENT) {
         return 0.0f;
     }
 
-    float usableRange = 100.0f - FAN_MIN_RUNNING_DUTY_PERCENT;
-    return FAN_MIN_RUNNING_DUTY_PERCENT +
-           (outputPercent * usableRange / 100.0f);
+    return s_curve.dutyForDemand(outputPercent);
 }
 
-void vTaskLab5PidActuation(void *pvParameters) {
-    (void)pvParameters;
+/** @return true if a calibrated curve was found in EEPROM. */
+static bool loadFanCurve() {
+    if (s_curve.loadEeprom(FAN_CURVE_EEPROM_ADDR)) {
+        FLASH_PRINTF("Fan curve: EEPROM, start %u%%\r\n", (unsigned)s_curve.table().startDuty);
+        return true;
+    }
+    s_curve.loadProgmem(&FAN_CURVE_DEFAULT);
+    FLASH_PRINTF("Fan curve: default (no calibration stored)\r\n");
+    return false;
+}
+
+/** @brief Adopt and store a finished sweep's curve. */
+static void finishCalibration() {
+    if (!s_calibrator.succeeded() || !s_curve.set(s_calibrator.result())) {
+        FLASH_PRINTF("[ERROR] Fan calibration failed, keeping the previous curve\r\n");
+        return;
+    }
+    s_curve.saveEeprom(FAN_CURVE_EEPROM_ADDR);
+    const FanCurveTable &t = s_curve.table();
+    FLASH_PRINTF("Fan curve: start %u%% stall %u%% max %u rpm (saved)\r\n",
+                 (unsigned)t.startDuty, (unsigned)t.stallDuty,
+                 (unsigned)t.rpm[FAN_CURVE_POINTS - 1]);
+}
+
+/**
+ * @brief Inner loop: duty that holds the cascade's speed demand.
+ *        Call with a Lab5PidCascadeLock held.
+ */
+static float speedLoopDuty(PidCascade *cascade, float rpm, float dtSeconds,
+                           float *targetRpm) {
+    float demandPercent = cascade->getInnerSetpoint();
+    if (demandPercent <= FAN_STOP_THRESHOLD_PERCENT) {
+        *targetRpm = 0.0f;
+        cascade->resetInner();
+        return 0.0f;
+    }
+    *targetRpm = demandPercent * FAN_MAX_RPM / 100.0f;
+    return cascade->updateInner(rpm * 100.0f / FAN_MAX_RPM, dtSeconds);
+}
 
+void lab5PidActuationInit() {
     s_fan.init();
+    if (!s_fan.enableTimerPwm(FAN_PWM_FREQUENCY_HZ)) {
+        FLASH_PRINTF("[ERROR] Fan PWM: no 16-bit timer on D%u, using analogWrite\r\n",
+                     (unsigned)PIN_FAN_PWM);
+    }
+    if (!s_fan.setRampRate(FAN_RAMP_PERCENT_PER_S) ||
+        !s_fan.setDeadTimeMs(FAN_DEAD_TIME_MS) ||
+        !s_fan.setStopMode(FAN_STOP_MODE)) {
+        FLASH_PRINTF("[ERROR] Fan profile unavailable, duty changes apply at once\r\n");
+    }
 
-    lab5PidStateLock();
-    lab5PidStateGet()->appliedDutyPercent = s_fan.getDuty();
-    lab5PidStateGet()->fanRunning = false;
-    lab5PidStateUnlock();
+    s_tachOk = s_tach.init();
+    if (!s_tachOk) {
+        FLASH_PRINTF("[ERROR] Fan tach: D%u has no external interrupt\r\n",
+                     (unsigned)PIN_FAN_TACH);
+    } else {
+        s_tach.setStallTimeoutMs(FAN_STALL_TIMEOUT_MS);
+    }
+    s_speedLoop = FAN_SPEED_LOOP_ENABLED && s_tachOk;
+    {
+        Lab5PidCascadeLock lock;
+        lab5PidCascadeGet()->inner().setAntiWindup(PID_ANTIWINDUP_BACK_CALCULATION);
+    }
 
-    for (;;) {
-        if (xSemaphoreTake(xLab5PidActuatorSemaphore, portMAX_DELAY) != pdTRUE) {
-            continue;
+    s_calibrate = !loadFanCurve() && FAN_CURVE_CALIBRATE_IF_MISSING && s_tachOk &&
+                  !SIM_PLANT_ENABLED;
+
+    g_lab5PidState.update([](Lab5PidState &state) {
+        state.appliedDutyPercent = s_fan.getDuty();
+        state.fanRunning = false;
+    });
+
+    s_previousUs = micros();
+    s_runningSince = xTaskGetTickCount();
+    s_commanded = false;
+}
+
+void lab5PidActuate(const Lab5PidCommand &command, bool newOutput, bool calibrationRequested) {
+    TickType_t now = xTaskGetTickCount();
+    uint32_t nowUs = micros();
+    float dtSeconds = (float)(uint32_t)(nowUs - s_previousUs) / 1000000.0f;
+    s_previousUs = nowUs;
+    float rpm = s_tachOk ? s_tach.update() : 0.0f;
+
+    float outputPercent = command.outputPercent;
+    if (calibrationRequested) {
+        s_calibrate = true;
+    }
+
+    if (s_calibrate) {
+        s_calibrate = false;
+        if (!s_tachOk) {
+            FLASH_PRINTF("[ERROR] Fan calibration needs the tach input\r\n");
+        } else if (!s_calibrator.isRunning()) {
+            s_fan.stop();
+            {
+                Lab5PidCascadeLock lock;
+                lab5PidCascadeGet()->resetInner();
+            }
+            s_calibrator.begin(millis());
+            FLASH_PRINTF("Fan calibration: sweeping, ~40 s\r\n");
         }
+    }
 
-        lab5PidStateLock();
-        Lab5PidState *state = lab5PidStateGet();
-        float outputPercent = state->controlOutputPercent;
-        bool sensorValid = state->sensorValid;
-        lab5PidStateUnlock();
+    if (!command.sensorValid && !PID_HOLD_ON_INVALID_SAMPLE) {
+        outputPercent = 0.0f;
+    }
+
+    float targetRpm = 0.0f;
+    bool calibrating = s_calibrator.isRunning();
+    bool apply = newOutput || s_speedLoop || calibrating;
+    if (apply) {
+        float dutyPercent;
+        if (calibrating) {
+            dutyPercent = s_calibrator.update(millis(), rpm, s_tach.isStalled());
+            if (!s_calibrator.isRunning()) {
+                finishCalibration();
+            }
+        } else if (s_speedLoop) {
+            Lab5PidCascadeLock lock;
+            dutyPercent = speedLoopDuty(lab5PidCascadeGet(), rpm, dtSeconds, &targetRpm);
+        } else {
+            dutyPercent = mapPidOutputToFanDuty(outputPercent);
+        }
 
-        float dutyPercent = sensorValid ? mapPidOutputToFanDuty(outputPercent) : 0.0f;
         if (dutyPercent > 0.0f) {
+            if (!s_commanded) {
+                s_runningSince = now;
+            }
+            s_commanded = true;
             s_fan.setForward(dutyPercent);
         } else {
+            s_commanded = false;
             s_fan.stop();
         }
+        LATENCY_END(g_lab5LatencySample, g_lab5LatencyFanUs);
+    }
+
+    // Stalled: driven for a full timeout without a single tach edge.
+    s_stalled = s_tachOk && s_commanded && s_tach.isStalled() &&
+                (now - s_runningSince) >= pdMS_TO_TICKS(FAN_STALL_TIMEOUT_MS);
+    s_rpm = rpm;
+    s_targetRpm = targetRpm;
+    s_applied = apply;
+
+#if defined(LAB5_SIM)
+    lab5PidSimSetFan(s_fan.getDuty());
+#endif
+    perfRecord(&g_lab5PerfActuateUs, micros() - nowUs);
+}
 
-        lab5PidStateLock();
-        state = lab5PidStateGet();
-        state->appliedDutyPercent = s_fan.getDuty();
-        state->fanRunning = s_fan.getDuty() > 0.0f;
+void lab5PidActuationStore(Lab5PidState *state) {
+    state->appliedDutyPercent = s_fan.getDuty();
+    bool running = s_fan.getDuty() > 0.0f;
+    if (running != state->fanRunning) {
+        state->fanSwitches++;
+    }
+    state->fanRunning = running;
+    state->fanRpm = s_rpm;
+    state->fanStalled = s_stalled && !s_calibrator.isRunning();
+    state->fanCalibrating = s_calibrator.isRunning();
+    state->fanCalibrationProgress = s_calibrator.progressPercent();
+    if (s_speedLoop && s_applied) {
+        state->fanTargetRpm = s_targetRpm;
+        state->fanSpeedIntegral = lab5PidCascadeGet()->inner().getIntegral();
+    }
+    if (s_applied) {
         state->actuatorUpdates++;
-        lab5PidStateUnlock();
+    }
+#if LAB5_2_ZONES > 1
+    state->zones.dutyPercent[0] = state->appliedDutyPercent;
+#endif
+}
+
+void vTaskLab5PidActuation(void *pvParameters) {
+    (void)pvParameters;
+
+    lab5PidActuationInit();
+
+    const TickType_t tachPeriod = pdMS_TO_TICKS(FAN_TACH_UPDATE_PERIOD_MS);
+    Lab5PidCommand command = { 0, 0.0f, false };  // Fan off until the first output
+    for (;;) {
+        bool newOutput =
+            xQueueReceive(xLab5PidCommandQueue, &command, tachPeriod) == pdTRUE;
+
+        lab5PidStateSnapshot(&s_stateView);
+        bool calibrationRequested = s_stateView.fanCalibrationRequested;
+        if (calibrationRequested) {
+            // Rare: only consuming the request needs the lock.
+            g_lab5PidState.update([](Lab5PidState &state) {
+                state.fanCalibrationRequested = false;
+            });
+        }
+
+        lab5PidActuate(command, newOutput, calibrationRequested);
+
+        g_lab5PidState.update([](Lab5PidState &state) {
+            lab5PidActuationStore(&state);
+        });
     }
 }
@@ -6,6 +6,23 @@
 #ifndef LAB5_2_TASK_ACTUATION_H
 #define LAB5_2_TASK_ACTUATION_H
 
+#include "shared_state.h"
+
+// ── Stage API (used by the task below and by the fused pipeline) ─────
+
+/** @brief Set up the fan driver and tach, load the fan curve. */
+void lab5PidActuationInit();
+
+/**
+ * @brief Refresh the tach and drive the fan for one pass (no state lock).
+ * @param newOutput            command is a fresh control output.
+ * @param calibrationRequested Start a fan curve sweep ("fan cal").
+ */
+void lab5PidActuate(const Lab5PidCommand &command, bool newOutput, bool calibrationRequested);
+
+/** @brief Store the fan's duty, speed and calibration status (lock held). */
+void lab5PidActuationStore(Lab5PidState *state);
+
 void vTaskLab5PidActuation(void *pvParameters);
 
 #endif // LAB5_2_TASK_ACTUATION_H
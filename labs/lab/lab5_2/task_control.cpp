@@ -1,77 +1,437 @@
 /**
  * @file task_control.cpp
  * @brief Lab 5.2 PID control task implementation.
+ *
+ * While a relay autotune runs ("pid tune") the PidAutotuner drives the
+ * output instead of the PID. On success the gains are stored in EEPROM,
+ * become the AUTO preset and are applied through the shared kp/ki/kd,
+ * which this task hands to setTunings() every cycle, or, with
+ * PID_GAIN_SCHEDULE_ENABLED, scales through the gain schedule first.
+ *
+ * The PID is the outer loop of the shared PidCascade; its output is the
+ * fan speed demand that the actuation task's inner loop follows (or maps
+ * through the fan curve when the speed loop is off).
+ *
+ * With PID_SMITH_ENABLED and a stored autotune, the PID sees the
+ * temperature corrected by a SmithPredictor (dead-time compensation).
+ *
+ * With PID_ESTIMATOR_ENABLED the task also wakes every
+ * PID_CONTROL_PERIOD_MS between samples and controls on the
+ * ThermalObserver estimate; the autotune relay still acts on real
+ * samples only.
+ *
+ * The cycle is split into stages (task_control.h) so the fused pipeline
+ * (-DLAB5_2_FUSED_PIPELINE) can run it inline between acquisition and
+ * actuation; this task runs the same stages around two state locks.
+ *
+ * Satellite zone samples (zones.h) come on the same queue; each runs
+ * that zone's cycle at once, without moving zone 0's estimator cycles.
+ *
+ * Every stored cycle also feeds LoopMetrics (the error the PID saw, its
+ * output and the actuation task's fan switch count); the figures go to
+ * the shared state for "loop" and the l* telemetry fields.
  */
 
 #include "task_control.h"
 #include "lab5_2_config.h"
 #include "shared_state.h"
+#include "settings.h"
 #include "PidController.h"
+#include "PidAutotuner.h"
+#include "PidGainScheduler.h"
+#include "SmithPredictor.h"
+#include "ThermalObserver.h"
+#include "FixedFormat.h"
+#include "LoopMetrics.h"
+#include "zones.h"
+#include "perf.h"
+#include "FlashString.h"
 
-#include <Arduino_FreeRTOS.h>
+#include "RtosTick.h"
 #include <math.h>
+#include <stdio.h>
 
-static PidController s_pid(
-    PID_DEFAULT_KP,
-    PID_DEFAULT_KI,
-    PID_DEFAULT_KD,
-    PID_OUTPUT_MIN_PERCENT,
-    PID_OUTPUT_MAX_PERCENT,
-    PID_REVERSE
-);
+// Only updateOuter()/setInnerSetpoint() touch state the actuation task
+// reads; the tuning calls on the outer PID need no lock.
+static PidController &s_pid = lab5PidCascadeGet()->outer();
 
-static float elapsedSeconds(TickType_t previousTick, TickType_t currentTick) {
-    if (previousTick == 0 || currentTick <= previousTick) {
-        return (float)TASK_ACQUISITION_PERIOD_MS / 1000.0f;
+static PidAutotuner s_tuner;
+static SmithPredictor s_smith;
+static ThermalObserver s_observer(PLANT_GAIN_C_PER_PERCENT, PLANT_TIME_CONSTANT_S,
+                                  ESTIMATOR_TEMP_NOISE, ESTIMATOR_EQUILIBRIUM_NOISE,
+                                  4.0f);
+static const PidGainScheduler s_schedule(PID_GAIN_SCHEDULE, PID_GAIN_SCHEDULE_POINTS,
+                                         PID_GAIN_SCHEDULE_KEY);
+static LoopMetrics s_loopMetrics(LOOP_METRICS_WINDOW_MS, LOOP_METRICS_STEP_C);
+
+/** @brief Publish tuned gains as the AUTO preset and select it (lock held). */
+static void adoptTuning(Lab5PidState *state, float kp, float ki, float kd) {
+    state->tunedKp = kp;
+    state->tunedKi = ki;
+    state->tunedKd = kd;
+    state->tunedValid = true;
+    state->pidPresetIndex = PID_PRESET_AUTO;
+    state->kp = kp;
+    state->ki = ki;
+    state->kd = kd;
+}
+
+uint16_t lab5PidControlPeriodMs() {
+    return PID_ESTIMATOR_ENABLED ? PID_CONTROL_PERIOD_MS : TASK_ACQUISITION_PERIOD_MS;
+}
+
+/** @brief Build the dead-time model from relay results (if enabled). */
+static void configureSmith(float ultimateGain, float ultimatePeriodS) {
+    if (!PID_SMITH_ENABLED) {
+        return;
+    }
+    if (!s_smith.setModelFromRelay(ultimateGain, ultimatePeriodS, PLANT_GAIN_C_PER_PERCENT,
+                                   lab5PidControlPeriodMs() / 1000.0f)) {
+        FLASH_PRINTF("[ERROR] Smith predictor: model does not fit the autotune, disabled\r\n");
+        return;
+    }
+    char tau[10], theta[10];
+    fmtFixed(tau, s_smith.getTimeConstantS(), 1, 1);
+    fmtFixed(theta, s_smith.getDeadTimeS(), 1, 1);
+    FLASH_PRINTF("Smith predictor: tau=%ss dead time=%ss\r\n", tau, theta);
+}
+
+/** @brief Report, store and apply a finished autotune. */
+static void finishAutotune() {
+    if (!s_tuner.succeeded()) {
+        FLASH_PRINTF("[ERROR] PID autotune failed or cancelled, gains unchanged\r\n");
+        return;
+    }
+
+    PidTuningRecord record;
+    s_tuner.computeTunings(PID_AUTOTUNE_RULE, &record.kp, &record.ki, &record.kd);
+    record.ultimateGain = s_tuner.getUltimateGain();
+    record.ultimatePeriodS = s_tuner.getUltimatePeriodS();
+    pidTuningSave(PID_TUNING_EEPROM_ADDR, record);
+
+    g_lab5PidState.update([&record](Lab5PidState &state) {
+        adoptTuning(&state, record.kp, record.ki, record.kd);
+    });
+    s_pid.reset();
+
+    char ku[10], pu[10], kp[10], ki[10], kd[10];
+    fmtFixed(ku, record.ultimateGain, 1, 2);
+    fmtFixed(pu, record.ultimatePeriodS, 1, 1);
+    fmtFixed(kp, record.kp, 1, 2);
+    fmtFixed(ki, record.ki, 1, 4);
+    fmtFixed(kd, record.kd, 1, 1);
+    FLASH_PRINTF("PID autotune: Ku=%s Pu=%ss -> Kp=%s Ki=%s Kd=%s (AUTO, saved)\r\n",
+                 ku, pu, kp, ki, kd);
+    configureSmith(record.ultimateGain, record.ultimatePeriodS);
+}
+
+/**
+ * @brief Seconds between two micros() readings (nominal period on the first).
+ *
+ * Timed with micros() rather than ticks: the ~16 ms WDT tick would
+ * quantize a 2 s PID step by almost 1 %.
+ */
+static float elapsedSeconds(uint32_t previousUs, uint32_t currentUs) {
+    if (previousUs == 0 || currentUs == previousUs) {
+        return (float)lab5PidControlPeriodMs() / 1000.0f;
+    }
+    return (float)(uint32_t)(currentUs - previousUs) / 1000000.0f;
+}
+
+/** @brief Model-based fan demand for holding @p setpoint (0 when disabled). */
+static float feedForwardFor(float setpoint) {
+    float ff = PID_FEEDFORWARD_PERCENT_PER_C * (PID_FEEDFORWARD_REFERENCE_C - setpoint);
+    if (ff < 0.0f) {
+        return 0.0f;
+    }
+    return (ff > PID_OUTPUT_MAX_PERCENT) ? PID_OUTPUT_MAX_PERCENT : ff;
+}
+
+/** @brief One control cycle, carried from compute to output and store. */
+struct ControlCycle {
+    TickType_t now;
+    float dtSeconds;
+    float setpointC;
+    float temperatureC;        // What the PID sees (observer estimate if enabled)
+    bool valid;
+    bool sampleValid;          // The sample's own flag, for the actuator
+    bool closedLoop;
+    float output;
+    float smithCorrectionC;
+};
+
+static ControlCycle s_cycle;
+static uint32_t s_previousControlUs = 0;
+static uint32_t s_previousCaptureUs = 0;
+static bool s_haveCapture = false;
+static TickType_t s_lastValidTick = 0;
+static float s_lastOutput = 0.0f;
+
+void lab5PidControlInit() {
+    s_pid.init();
+    s_pid.setDerivativeMode(PID_DERIVATIVE_ON_MEASUREMENT);
+    s_pid.setDerivativeFilter(PID_DERIVATIVE_FILTER_N);
+    s_pid.setAntiWindup(PID_ANTIWINDUP_BACK_CALCULATION);
+    s_pid.setSetpointWeights(PID_SETPOINT_WEIGHT_P, 0.0f);
+    s_pid.setForm(PID_FORM);
+    s_loopMetrics.setSettleBand(LOOP_METRICS_SETTLE_BAND_C);
+
+    PidTuningRecord stored;
+    bool tuned = pidTuningLoad(PID_TUNING_EEPROM_ADDR, &stored);
+    uint8_t preset;
+    bool presetStored = lab5SettingsStoredPreset(&preset);
+    // A stored tune selects AUTO unless another preset was saved since.
+    g_lab5PidState.update([&](Lab5PidState &state) {
+        if (tuned) {
+            adoptTuning(&state, stored.kp, stored.ki, stored.kd);
+        }
+        if (presetStored) {
+            lab5PidApplyPreset(&state, preset);
+        }
+    });
+    if (tuned) {
+        configureSmith(stored.ultimateGain, stored.ultimatePeriodS);
+    }
+#if LAB5_2_ZONES > 1
+    lab5PidZoneControlInit();
+#endif
+}
+
+void lab5PidControlTakeInputs(Lab5PidState *state, Lab5PidControlInputs *in) {
+    in->setpointC = state->activeSetpointC;
+    in->kp = state->kp;
+    in->ki = state->ki;
+    in->kd = state->kd;
+    in->tuneRequested = state->pidAutotuneRequested;
+    in->cancelRequested = state->pidAutotuneCancelRequested;
+    state->pidAutotuneRequested = false;
+    state->pidAutotuneCancelRequested = false;
+}
+
+void lab5PidControlCompute(const Lab5PidSample &sample, bool newSample,
+                           const Lab5PidControlInputs &in) {
+    TickType_t now = xTaskGetTickCount();
+    uint32_t nowUs = micros();
+    float dtSeconds = elapsedSeconds(s_previousControlUs, nowUs);
+    s_previousControlUs = nowUs;
+
+    float temperature = sample.temperatureC;
+    bool valid = sample.valid && !isnan(temperature);
+
+    // Stepped once per sample, the PID integrates over the time between
+    // the sensor's captures, not between this task's wake-ups: queue and
+    // bus-read jitter and a dropped sample then cost no dt error. A
+    // repeated capture (cached DHT value) keeps the wake-to-wake dt; a
+    // dropout restarts the chain.
+    if (!PID_ESTIMATOR_ENABLED && newSample) {
+        if (valid && s_haveCapture && sample.captureUs != s_previousCaptureUs) {
+            dtSeconds = elapsedSeconds(s_previousCaptureUs, sample.captureUs);
+        }
+        s_previousCaptureUs = sample.captureUs;
+        s_haveCapture = valid;
+    }
+    float setpoint = in.setpointC;
+
+    // Control on the observer between samples (and on its filtered
+    // value at samples); the relay below keeps using the raw reading.
+    float sampleTemp = temperature;
+    if (PID_ESTIMATOR_ENABLED) {
+        s_observer.predict(s_lastOutput, dtSeconds);
+        if (newSample && valid) {
+            // From capture to now: the cached age plus the queue wait.
+            float ageS = (sample.ageMs == UINT32_MAX)
+                             ? 0.0f
+                             : (float)(uint32_t)(nowUs - sample.captureUs) / 1000000.0f;
+            s_observer.update(temperature, ESTIMATOR_SAMPLE_VARIANCE, ageS);
+        }
+        if (!valid) {
+            s_observer.reset();
+        } else if (s_observer.isInitialized()) {
+            temperature = s_observer.getEstimate();
+        }
+    }
+
+    if (in.tuneRequested && valid && !s_tuner.isRunning()) {
+        s_tuner.begin(setpoint, PID_AUTOTUNE_OUTPUT_LOW, PID_AUTOTUNE_OUTPUT_HIGH,
+                      PID_AUTOTUNE_HYSTERESIS_C, PID_REVERSE, millis(),
+                      PID_AUTOTUNE_TIMEOUT_MS);
+        FLASH_PRINTF("PID autotune: relay %u/%u%% around the setpoint\r\n",
+                     (unsigned)PID_AUTOTUNE_OUTPUT_LOW, (unsigned)PID_AUTOTUNE_OUTPUT_HIGH);
+    } else if (in.tuneRequested && !valid) {
+        FLASH_PRINTF("[ERROR] PID autotune needs a valid temperature\r\n");
+    }
+    if (in.cancelRequested && s_tuner.isRunning()) {
+        s_tuner.cancel();
+        finishAutotune();
+    }
+
+    if (PID_GAIN_SCHEDULE_ENABLED && valid) {
+        s_schedule.applyScaled(s_pid, setpoint, temperature, in.kp, in.ki, in.kd);
+    } else {
+        s_pid.setTunings(in.kp, in.ki, in.kd);
+    }
+    s_pid.setFeedForward(feedForwardFor(setpoint));
+
+    float output = 0.0f;
+    bool closedLoop = false;
+    bool tuning = s_tuner.isRunning();
+    if (tuning && !newSample) {
+        output = s_lastOutput;        // Relay switches on real samples only
+    } else if (tuning) {
+        output = s_tuner.update(valid ? sampleTemp : NAN, millis());
+        if (!s_tuner.isRunning()) {
+            finishAutotune();
+            // PID takes over on the next sample from the relay's mean.
+            output = 0.5f * (PID_AUTOTUNE_OUTPUT_LOW + PID_AUTOTUNE_OUTPUT_HIGH);
+            s_pid.restart();
+            s_pid.setOutput(output);
+        }
+    } else if (valid) {
+        closedLoop = true;
+        s_lastValidTick = now;
+    } else if (PID_HOLD_ON_INVALID_SAMPLE &&
+               (now - s_lastValidTick) < pdMS_TO_TICKS(PID_INVALID_HOLD_MS)) {
+        s_pid.restart();
+        output = s_pid.getOutput();   // Hold the demand through a dropout
+    } else {
+        s_pid.reset();
+        s_smith.reset();
+    }
+
+    s_cycle.now = now;
+    s_cycle.dtSeconds = dtSeconds;
+    s_cycle.setpointC = setpoint;
+    s_cycle.temperatureC = temperature;
+    s_cycle.valid = valid;
+    s_cycle.sampleValid = sample.valid;
+    s_cycle.closedLoop = closedLoop;
+    s_cycle.output = output;
+
+    if (newSample && valid && sample.ageMs != UINT32_MAX) {
+        perfRecord(&g_lab5PerfSampleAgeUs, nowUs - sample.captureUs);
+        LATENCY_START_AT(g_lab5LatencySample, sample.captureUs);
     }
+    perfCount(&g_lab5PerfControlSteps);
+    perfRecord(&g_lab5PerfControlUs, micros() - nowUs);
+}
+
+Lab5PidCommand lab5PidControlOutput() {
+    PidCascade *cascade = lab5PidCascadeGet();
+    if (s_cycle.closedLoop) {
+        s_cycle.output = cascade->updateOuter(s_cycle.setpointC,
+                                              s_smith.feedback(s_cycle.temperatureC),
+                                              s_cycle.dtSeconds);
+    } else {
+        cascade->setInnerSetpoint(s_cycle.output);   // Relay output, or fan off
+    }
+    s_cycle.smithCorrectionC = s_smith.getCorrection();
+    s_smith.advance(s_cycle.output, s_cycle.dtSeconds);   // No-op without a model
+    s_lastOutput = s_cycle.output;
+    LATENCY_STAGE(g_lab5LatencySample, g_lab5LatencyControlUs);
+
+    Lab5PidCommand command;
+    command.tick = s_cycle.now;
+    command.outputPercent = s_cycle.output;
+    command.sensorValid = s_cycle.sampleValid;
+    return command;
+}
+
+void lab5PidControlStore(Lab5PidState *state) {
+    bool valid = s_cycle.valid;
+    state->cascadeLimited = lab5PidCascadeGet()->isOuterLimited();
+    state->smithCorrectionC = s_cycle.smithCorrectionC;
+    state->estimatedTempC = (PID_ESTIMATOR_ENABLED && valid) ? s_cycle.temperatureC : NAN;
+    state->controlOutputPercent = s_cycle.output;
+    state->errorC = valid ? s_pid.getError() : 0.0f;
+    state->pidIntegral = s_pid.getIntegral();
+    state->pidDerivative = s_pid.getDerivative();
+    state->controlCycles++;
+    state->pidAutotuning = s_tuner.isRunning();
+    state->pidAutotuneCycles = s_tuner.getCycles();
+    if (state->loopMetricsClearRequested) {
+        state->loopMetricsClearRequested = false;
+        s_loopMetrics.reset();
+    }
+    s_loopMetrics.update(s_cycle.setpointC, valid ? s_cycle.temperatureC : NAN, s_cycle.output,
+                         state->fanSwitches, millis());
+    s_loopMetrics.getReport(&state->loop);
+#if LAB5_2_ZONES > 1
+    state->zones.setpointC[0] = s_cycle.setpointC;
+    state->zones.outputPercent[0] = s_cycle.output;
+    state->zones.presetIndex[0] = state->pidPresetIndex;
+#endif
+}
 
-    TickType_t deltaTicks = currentTick - previousTick;
-    return ((float)deltaTicks * (float)portTICK_PERIOD_MS) / 1000.0f;
+#if LAB5_2_ZONES > 1
+/** @brief One satellite cycle on its sample: inputs, PID and fan, store. */
+static void controlZone(const Lab5PidSample &sample) {
+    Lab5PidZoneInputs inputs;
+    g_lab5PidState.read([&](const Lab5PidState &state) {
+        lab5PidZoneTakeInputs(&state, sample.zone, &inputs);
+    });
+    lab5PidZoneCompute(sample, inputs);
+    g_lab5PidState.update([&sample](Lab5PidState &state) {
+        lab5PidZoneStore(&state, sample.zone);
+    });
 }
+#endif
 
 void vTaskLab5PidControl(void *pvParameters) {
     (void)pvParameters;
 
-    s_pid.init();
-    TickType_t previousControlTick = 0;
+    lab5PidControlInit();
+    const TickType_t wakePeriod =
+        PID_ESTIMATOR_ENABLED ? pdMS_TO_TICKS(PID_CONTROL_PERIOD_MS) : portMAX_DELAY;
+
+    // Last sample received; estimator cycles between samples reuse it.
+    Lab5PidSample sample = { 0, NAN, false, UINT32_MAX, 0, 0 };
+#if LAB5_2_ZONES > 1
+    TickType_t lastCycle = xTaskGetTickCount();
+#endif
 
     for (;;) {
-        if (xSemaphoreTake(xLab5PidNewSampleSemaphore, portMAX_DELAY) != pdTRUE) {
+#if LAB5_2_ZONES > 1
+        // Satellite samples arrive in between: the wait runs from zone 0's
+        // last cycle, so they do not push its estimator cycles back.
+        TickType_t wait = wakePeriod;
+        if (PID_ESTIMATOR_ENABLED) {
+            TickType_t elapsed = (TickType_t)(xTaskGetTickCount() - lastCycle);
+            wait = (elapsed < wakePeriod) ? (TickType_t)(wakePeriod - elapsed) : 0;
+        }
+        Lab5PidSample received;
+        bool newSample = xQueueReceive(xLab5PidSampleQueue, &received, wait) == pdTRUE;
+        if (newSample && received.zone != 0) {
+            controlZone(received);
             continue;
         }
-
-        TickType_t now = xTaskGetTickCount();
-        float dtSeconds = elapsedSeconds(previousControlTick, now);
-        previousControlTick = now;
-
-        lab5PidStateLock();
-        Lab5PidState *state = lab5PidStateGet();
-        float temperature = state->measuredTempC;
-        float setpoint = state->activeSetpointC;
-        float kp = state->kp;
-        float ki = state->ki;
-        float kd = state->kd;
-        bool valid = state->sensorValid && !isnan(temperature);
-        lab5PidStateUnlock();
-
-        s_pid.setTunings(kp, ki, kd);
-
-        float output = 0.0f;
-        if (valid) {
-            output = s_pid.update(setpoint, temperature, dtSeconds);
-        } else {
-            s_pid.reset();
+        if (newSample) {
+            sample = received;
         }
+#else
+        bool newSample = xQueueReceive(xLab5PidSampleQueue, &sample, wakePeriod) == pdTRUE;
+#endif
+        if (!newSample && !PID_ESTIMATOR_ENABLED) {
+            continue;
+        }
+#if LAB5_2_ZONES > 1
+        lastCycle = xTaskGetTickCount();
+#endif
 
-        lab5PidStateLock();
-        state = lab5PidStateGet();
-        state->controlOutputPercent = output;
-        state->errorC = valid ? s_pid.getError() : 0.0f;
-        state->pidIntegral = s_pid.getIntegral();
-        state->pidDerivative = s_pid.getDerivative();
-        state->controlCycles++;
-        lab5PidStateUnlock();
+        Lab5PidControlInputs inputs;
+        g_lab5PidState.update([&inputs](Lab5PidState &state) {
+            lab5PidControlTakeInputs(&state, &inputs);
+        });
 
-        xSemaphoreGive(xLab5PidActuatorSemaphore);
+        lab5PidControlCompute(sample, newSample, inputs);
+
+        {
+            Lab5PidShared::Lock state(g_lab5PidState);
+            Lab5PidCommand command = lab5PidControlOutput();
+            lab5PidControlStore(state.get());
+            if (uxQueueMessagesWaiting(xLab5PidCommandQueue) != 0) {
+                state->commandOverruns++;  // Actuation has not taken the last one
+            }
+            xQueueOverwrite(xLab5PidCommandQueue, &command);
+        }
     }
 }
@@ -6,6 +6,46 @@
 #ifndef LAB5_2_TASK_CONTROL_H
 #define LAB5_2_TASK_CONTROL_H
 
+#include "shared_state.h"
+
+/** @brief What a control cycle takes from the state. */
+struct Lab5PidControlInputs {
+    float setpointC;
+    float kp;
+    float ki;
+    float kd;
+    bool tuneRequested;
+    bool cancelRequested;
+};
+
+// ── Stage API (used by the task below and by the fused pipeline) ─────
+//
+// One cycle: TakeInputs (state lock) → Compute (no lock) → Output
+// (cascade lock) → Store (state lock). The task holds one lock across
+// Output and Store.
+
+/** @brief Nominal control period: PID_CONTROL_PERIOD_MS with the estimator, else a sample period. */
+uint16_t lab5PidControlPeriodMs();
+
+/** @brief Configure the PID and adopt the stored autotune, if any. */
+void lab5PidControlInit();
+
+/** @brief Copy the setpoint, gains and autotune requests, consuming the requests (lock held). */
+void lab5PidControlTakeInputs(Lab5PidState *state, Lab5PidControlInputs *in);
+
+/**
+ * @brief Observer, autotune and PID update for one cycle (no lock).
+ * @param newSample false for an estimator cycle between samples.
+ */
+void lab5PidControlCompute(const Lab5PidSample &sample, bool newSample,
+                           const Lab5PidControlInputs &in);
+
+/** @brief Run the outer cascade loop on the cycle (cascade lock held). */
+Lab5PidCommand lab5PidControlOutput();
+
+/** @brief Store the cycle's results and diagnostics (lock held). */
+void lab5PidControlStore(Lab5PidState *state);
+
 void vTaskLab5PidControl(void *pvParameters);
 
 #endif // LAB5_2_TASK_CONTROL_H
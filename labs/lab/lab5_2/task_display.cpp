@@ -1,12 +1,39 @@
 /**
  * @file task_display.cpp
  * @brief Lab 5.2 LCD and Serial Plotter reporting task.
+ *
+ * LCD pages (2 s each):
+ *   Status, three slots out of four:
+ *     "T:23.5 SP:25.0 ✓"   measurement, setpoint, sensor state glyph
+ *     "██▌    36% E-1.5"   fan duty gauge (CGRAM bars), duty, PID error
+ *   Tuning, the fourth slot:
+ *     "P:12.0 I:0.18"  /  "D: 2.0 POT NORM"   gains, setpoint source, preset
+ *   During a fan calibration sweep:
+ *     "Fan calibration" / " 40%  2150 rpm"
+ *   During a PID autotune:
+ *     "PID tune cyc 2" / "T:25.3 SP:25.0"
+ *
+ * The gauge uses CGRAM slots 0..3 and the state glyphs slots 4..5;
+ * LcdDisplay only rewrites CGRAM when a bitmap changes.
+ *
+ * The LCD is redrawn when the state publisher sees a shown value change
+ * (any writer: a key, a sample, a duty step) or the page flips; the
+ * Serial Plotter line follows the heartbeat. A render cache compares the
+ * snapshot's shown values with those last drawn, so a heartbeat with
+ * nothing new on the page formats nothing, and only the values of the
+ * visible page are formatted.
  */
 
 #include "task_display.h"
 #include "lab5_2_config.h"
 #include "shared_state.h"
+#include "task_telemetry.h"
 #include "LcdDisplay.h"
+#include "FixedFormat.h"
+#include "DisplayRefresh.h"
+#include "DeferredLog.h"
+#include "StdioSerial.h"
+#include "FlashString.h"
 
 #include <Arduino_FreeRTOS.h>
 #include <math.h>
@@ -14,6 +41,19 @@
 #include <string.h>
 
 static LcdDisplay s_lcd(LCD_I2C_ADDRESS, LCD_COLS, LCD_ROWS);
+static DisplayRefresh s_refresh(DISPLAY_REFRESH_MIN_MS, DISPLAY_HEARTBEAT_MS);
+
+/** Wake-up reason besides the heartbeat: a shown value changed. */
+static const uint8_t DISPLAY_DIRTY_LCD = 0x01;
+
+/** CGRAM slots of the sensor state glyphs (0..3 hold the gauge). */
+static const uint8_t GLYPH_OK = 4;
+static const uint8_t GLYPH_FAULT = 5;
+static const uint8_t OK_BITMAP[8] = {0x00, 0x01, 0x03, 0x16, 0x1C, 0x08, 0x00, 0x00};
+static const uint8_t FAULT_BITMAP[8] = {0x04, 0x0E, 0x0E, 0x0E, 0x04, 0x00, 0x04, 0x00};
+
+/** Duty gauge width in cells (5 steps per cell). */
+static const uint8_t GAUGE_CELLS = 6;
 
 static void formatFloat(char *buffer, size_t size, float value,
                         signed char width, unsigned char precision,
@@ -22,7 +62,7 @@ static void formatFloat(char *buffer, size_t size, float value,
         strncpy(buffer, invalidText, size);
         buffer[size - 1] = '\0';
     } else {
-        dtostrf(value, width, precision, buffer);
+        fmtFixed(buffer, value, width, precision);
     }
 }
 
@@ -30,72 +70,171 @@ static float plotValueOrZero(float value) {
     return isnan(value) ? 0.0f : value;
 }
 
-void vTaskLab5PidDisplay(void *pvParameters) {
-    (void)pvParameters;
+/** State as the LCD pages show it; only the release hook touches s_shown. */
+struct ShownState {
+    int16_t tempDeci;
+    int16_t setpointDeci;
+    int16_t dutyPercent;
+    int16_t errorDeci;
+    int16_t kpDeci;
+    int16_t kiCenti;
+    int16_t kdDeci;
+    int16_t rpm;
+    uint8_t preset;
+    uint8_t tuneCycles;
+    uint8_t calibrationProgress;
+    uint8_t flags;
+    char input[SETPOINT_INPUT_MAX_DIGITS + 1];
+};
+static ShownState s_shown;
 
-    s_lcd.init();
-    s_lcd.backlight(true);
-    s_lcd.showTwoLines("Lab 5.2 PID", "DHT11 + Fan");
+/** @brief The shown values of @p state (release hook and render cache). */
+static void shownStateOf(const Lab5PidState &state, ShownState *now) {
+    memset(now, 0, sizeof(*now));
+    now->tempDeci = displayRefreshQuantize(state.measuredTempC, 0.1f);
+    now->setpointDeci = displayRefreshQuantize(state.activeSetpointC, 0.1f);
+    now->dutyPercent = displayRefreshQuantize(state.appliedDutyPercent, 1.0f);
+    now->errorDeci = displayRefreshQuantize(state.errorC, 0.1f);
+    now->kpDeci = displayRefreshQuantize(state.kp, 0.1f);
+    now->kiCenti = displayRefreshQuantize(state.ki, 0.01f);
+    now->kdDeci = displayRefreshQuantize(state.kd, 0.1f);
+    now->preset = state.pidPresetIndex;
+    now->flags = (uint8_t)((state.sensorValid ? 0x01 : 0) | (state.editingSetpoint ? 0x02 : 0) |
+                           (state.pidAutotuning ? 0x04 : 0) | (state.fanCalibrating ? 0x08 : 0) |
+                           (state.setpointSource == SETPOINT_SOURCE_POT ? 0x10 : 0));
+    if (state.editingSetpoint) {
+        strncpy(now->input, state.inputBuffer, sizeof(now->input) - 1);
+    }
+    if (state.pidAutotuning) {
+        now->tuneCycles = state.pidAutotuneCycles;
+    }
+    if (state.fanCalibrating) {
+        now->calibrationProgress = state.fanCalibrationProgress;
+        now->rpm = displayRefreshQuantize(state.fanRpm, 1.0f);   // Shown only then
+    }
+}
 
-    TickType_t lastWake = xTaskGetTickCount();
-    const TickType_t period = pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS);
-    uint8_t displayCycle = 0;
+void lab5PidDisplayStateReleased(const Lab5PidState &state) {
+    ShownState now;
+    shownStateOf(state, &now);
+    if (memcmp(&now, &s_shown, sizeof(now)) != 0) {
+        s_shown = now;
+        s_refresh.mark(DISPLAY_DIRTY_LCD);
+    }
+}
 
-    for (;;) {
-        vTaskDelayUntil(&lastWake, period);
-        displayCycle++;
+/**
+ * @brief Format the LCD lines of @p page (or of the override screen).
+ *
+ * Only the values the chosen screen shows are formatted.
+ */
+static void renderPage(const Lab5PidState &snapshot, uint8_t page,
+                       char *line0, char *line1, size_t size) {
+    char tempStr[8];
+    char spStr[8];
+
+    if (snapshot.editingSetpoint) {
+        FLASH_SNPRINTF(line0, size, "Set SP:%-3s C", snapshot.inputBuffer);
+        FLASH_SNPRINTF(line1, size, "#=OK *=CLR");
+    } else if (snapshot.pidAutotuning) {
+        formatFloat(tempStr, sizeof(tempStr), snapshot.measuredTempC, 4, 1, "--.-");
+        formatFloat(spStr, sizeof(spStr), snapshot.activeSetpointC, 4, 1, "--.-");
+        FLASH_SNPRINTF(line0, size, "PID tune cyc %u",
+                       (unsigned)snapshot.pidAutotuneCycles);
+        FLASH_SNPRINTF(line1, size, "T:%s SP:%s", tempStr, spStr);
+    } else if (snapshot.fanCalibrating) {
+        FLASH_SNPRINTF(line0, size, "Fan calibration");
+        FLASH_SNPRINTF(line1, size, "%3u%% %5u rpm",
+                       (unsigned)snapshot.fanCalibrationProgress,
+                       (unsigned)(snapshot.fanRpm + 0.5f));
+    } else if (page != 3) {
+        s_lcd.loadHBarGlyphs();
+        s_lcd.setGlyph(GLYPH_OK, OK_BITMAP);
+        s_lcd.setGlyph(GLYPH_FAULT, FAULT_BITMAP);
 
-        lab5PidStateLock();
-        Lab5PidState snapshot = *lab5PidStateGet();
-        lab5PidStateUnlock();
+        char gauge[GAUGE_CELLS + 1];
+        float duty = isnan(snapshot.appliedDutyPercent) ? 0.0f : snapshot.appliedDutyPercent;
+        LcdDisplay::formatHBar(gauge, GAUGE_CELLS, (uint16_t)(duty + 0.5f),
+                               (uint16_t)PID_OUTPUT_MAX_PERCENT);
 
-        char tempStr[8];
-        char spStr[8];
-        char outStr[8];
         char errStr[8];
+        char dutyStr[8];
+        formatFloat(tempStr, sizeof(tempStr), snapshot.measuredTempC, 4, 1, "--.-");
+        formatFloat(spStr, sizeof(spStr), snapshot.activeSetpointC, 4, 1, "--.-");
+        formatFloat(errStr, sizeof(errStr), snapshot.errorC, 4, 1, "-.-");
+        formatFloat(dutyStr, sizeof(dutyStr), snapshot.appliedDutyPercent, 3, 0, "---");
+        FLASH_SNPRINTF(line0, size, "T:%s SP:%s %c", tempStr, spStr,
+                       LCD_GLYPH(snapshot.sensorValid ? GLYPH_OK : GLYPH_FAULT));
+        FLASH_SNPRINTF(line1, size, "%s%s%% E%s", gauge, dutyStr, errStr);
+    } else {
         char kpStr[8];
         char kiStr[8];
         char kdStr[8];
+        formatFloat(kpStr, sizeof(kpStr), snapshot.kp, 4, 1, "-.-");
+        formatFloat(kiStr, sizeof(kiStr), snapshot.ki, 4, 2, "-.--");
+        formatFloat(kdStr, sizeof(kdStr), snapshot.kd, 4, 1, "-.-");
+        const char *source =
+            snapshot.setpointSource == SETPOINT_SOURCE_POT ? "POT" : "MAN";
+        FLASH_SNPRINTF(line0, size, "P:%s I:%s", kpStr, kiStr);
+        FLASH_SNPRINTF(line1, size, "D:%s %s %s", kdStr, source,
+                       lab5PidPresetName(snapshot.pidPresetIndex));
+    }
+}
+
+void vTaskLab5PidDisplay(void *pvParameters) {
+    (void)pvParameters;
+
+    s_lcd.init();
+    s_lcd.backlight(true);
+    s_lcd.showTwoLines_P(PSTR("Lab 5.2 PID"), PSTR("DHT11 + Fan"));
+
+    s_refresh.bind();
+    uint8_t beat = 0;
+    uint8_t shownPage = 0xFF;
+    ShownState drawn;
 
-        formatFloat(tempStr, sizeof(tempStr), snapshot.measuredTempC,
-                    4, 1, "--.-");
-        formatFloat(spStr, sizeof(spStr), snapshot.activeSetpointC,
-                    4, 1, "--.-");
-        formatFloat(outStr, sizeof(outStr), snapshot.appliedDutyPercent,
-                    4, 0, "---");
-        formatFloat(errStr, sizeof(errStr), snapshot.errorC,
-                    4, 1, "-.-");
-        formatFloat(kpStr, sizeof(kpStr), snapshot.kp,
-                    4, 1, "-.-");
-        formatFloat(kiStr, sizeof(kiStr), snapshot.ki,
-                    4, 2, "-.--");
-        formatFloat(kdStr, sizeof(kdStr), snapshot.kd,
-                    4, 1, "-.-");
-
-        char line0[17];
-        char line1[17];
-
-        if (snapshot.editingSetpoint) {
-            snprintf(line0, sizeof(line0), "Set SP:%-3s C", snapshot.inputBuffer);
-            snprintf(line1, sizeof(line1), "#=OK *=CLR");
-        } else if (((displayCycle / 4) % 3) == 0) {
-            snprintf(line0, sizeof(line0), "T:%s SP:%s", tempStr, spStr);
-            snprintf(line1, sizeof(line1), "Fan:%s%% %s",
-                     outStr,
-                     snapshot.sensorValid ? "OK" : "SERR");
-        } else if (((displayCycle / 4) % 3) == 1) {
-            const char *source =
-                snapshot.setpointSource == SETPOINT_SOURCE_POT ? "POT" : "MAN";
-            snprintf(line0, sizeof(line0), "Err:%s Out:%s", errStr, outStr);
-            snprintf(line1, sizeof(line1), "%s %s",
-                     source,
-                     PID_PRESETS[snapshot.pidPresetIndex].name);
-        } else {
-            snprintf(line0, sizeof(line0), "P:%s I:%s", kpStr, kiStr);
-            snprintf(line1, sizeof(line1), "D:%s Duty:%s", kdStr, outStr);
+    for (;;) {
+        uint8_t why = s_refresh.wait();
+        bool heartbeat = (why & DISPLAY_REFRESH_HEARTBEAT) != 0;
+        if (heartbeat) {
+            beat++;
+        }
+        uint8_t page = (uint8_t)((beat / DISPLAY_PAGE_BEATS) % 4);
+        if (!heartbeat && page == shownPage && !(why & DISPLAY_DIRTY_LCD)) {
+            continue;
         }
 
-        s_lcd.showTwoLines(line0, line1);
+        Lab5PidState snapshot;
+        lab5PidStateSnapshot(&snapshot);
+
+        // Render cache: the page is formatted again only when it flips
+        // or a value it shows moved; a heartbeat alone leaves the LCD.
+        ShownState key;
+        shownStateOf(snapshot, &key);
+        if (page != shownPage || memcmp(&key, &drawn, sizeof(key)) != 0) {
+            char line0[17];
+            char line1[17];
+            renderPage(snapshot, page, line0, line1, sizeof(line0));
+            s_lcd.showTwoLines(line0, line1);
+            drawn = key;
+            shownPage = page;
+        }
+
+        if (!heartbeat) {
+            continue;  // A change between two plotter lines.
+        }
+        if (TELEMETRY_BINARY) {
+            continue;  // Serial link carries binary frames from the telemetry task.
+        }
+        if (!deferredLogPreambleDone()) {
+            continue;  // The logger is still printing the banner.
+        }
+        if (lab5PidTelemetryHasSubscribers()) {
+            continue;  // Operator picked fields with "sub"; skip the fixed line.
+        }
+        if (s_refresh.getLateMs() >= DISPLAY_HEARTBEAT_MS) {
+            continue;  // A whole beat behind; let the UART catch up.
+        }
 
         char plotSetpoint[10];
         char plotValue[10];
@@ -106,24 +245,26 @@ void vTaskLab5PidDisplay(void *pvParameters) {
         char plotKi[10];
         char plotKd[10];
 
-        dtostrf(plotValueOrZero(snapshot.activeSetpointC), 1, 1, plotSetpoint);
-        dtostrf(plotValueOrZero(snapshot.measuredTempC), 1, 1, plotValue);
-        dtostrf(plotValueOrZero(snapshot.controlOutputPercent), 1, 1, plotOutput);
-        dtostrf(plotValueOrZero(snapshot.appliedDutyPercent), 1, 1, plotDuty);
-        dtostrf(plotValueOrZero(snapshot.errorC), 1, 1, plotError);
-        dtostrf(plotValueOrZero(snapshot.kp), 1, 1, plotKp);
-        dtostrf(plotValueOrZero(snapshot.ki), 1, 2, plotKi);
-        dtostrf(plotValueOrZero(snapshot.kd), 1, 1, plotKd);
-
-        printf("SetPoint:%s Value:%s Output:%s Duty:%s Error:%s Kp:%s Ki:%s Kd:%s Valid:%u\r\n",
-               plotSetpoint,
-               plotValue,
-               plotOutput,
-               plotDuty,
-               plotError,
-               plotKp,
-               plotKi,
-               plotKd,
-               snapshot.sensorValid ? 1U : 0U);
+        fmtFixed(plotSetpoint, plotValueOrZero(snapshot.activeSetpointC), 1, 1);
+        fmtFixed(plotValue, plotValueOrZero(snapshot.measuredTempC), 1, 1);
+        fmtFixed(plotOutput, plotValueOrZero(snapshot.controlOutputPercent), 1, 1);
+        fmtFixed(plotDuty, plotValueOrZero(snapshot.appliedDutyPercent), 1, 1);
+        fmtFixed(plotError, plotValueOrZero(snapshot.errorC), 1, 1);
+        fmtFixed(plotKp, plotValueOrZero(snapshot.kp), 1, 1);
+        fmtFixed(plotKi, plotValueOrZero(snapshot.ki), 1, 2);
+        fmtFixed(plotKd, plotValueOrZero(snapshot.kd), 1, 1);
+
+        // Plotter data: the telemetry route (its own USART with -DSTDIO_TELEMETRY_PORT)
+        FLASH_FPRINTF(stdioSerialStream(STDIO_ROUTE_TELEMETRY),
+                      "SetPoint:%s Value:%s Output:%s Duty:%s Error:%s Kp:%s Ki:%s Kd:%s Valid:%u\r\n",
+                      plotSetpoint,
+                      plotValue,
+                      plotOutput,
+                      plotDuty,
+                      plotError,
+                      plotKp,
+                      plotKi,
+                      plotKd,
+                      snapshot.sensorValid ? 1U : 0U);
     }
 }
@@ -6,6 +6,15 @@
 #ifndef LAB5_2_TASK_DISPLAY_H
 #define LAB5_2_TASK_DISPLAY_H
 
+#include "shared_state.h"
+
+/**
+ * @brief g_lab5PidState release hook (via the snapshot publisher): wakes
+ *        the display task when a value the LCD shows changed at the
+ *        resolution shown.
+ */
+void lab5PidDisplayStateReleased(const Lab5PidState &state);
+
 void vTaskLab5PidDisplay(void *pvParameters);
 
 #endif // LAB5_2_TASK_DISPLAY_H
@@ -7,10 +7,11 @@
 #include "lab5_2_config.h"
 #include "shared_state.h"
 #include "KeypadInput.h"
+#include "KeypadInputRtos.h"
+#include "DeferredLog.h"
 
 #include <Arduino_FreeRTOS.h>
 #include <stdlib.h>
-#include <stdio.h>
 
 static KeypadInput s_keypad(KEYPAD_ROW_PINS, KEYPAD_COL_PINS);
 
@@ -28,41 +29,27 @@ static void enterManualMode(Lab5PidState *state) {
     state->activeSetpointC = state->manualSetpointC;
 }
 
-static void applyPidPreset(Lab5PidState *state, uint8_t presetIndex) {
-    if (presetIndex >= PID_PRESET_COUNT) {
-        presetIndex = 0;
-    }
-
-    state->pidPresetIndex = presetIndex;
-    state->kp = PID_PRESETS[presetIndex].kp;
-    state->ki = PID_PRESETS[presetIndex].ki;
-    state->kd = PID_PRESETS[presetIndex].kd;
-}
-
 void vTaskLab5PidInput(void *pvParameters) {
     (void)pvParameters;
 
     s_keypad.init();
 
-    TickType_t lastWake = xTaskGetTickCount();
-    const TickType_t period = pdMS_TO_TICKS(TASK_INPUT_PERIOD_MS);
-
     for (;;) {
-        char key = s_keypad.getKey();
-
-        if (key != 0) {
-            lab5PidStateLock();
-            Lab5PidState *state = lab5PidStateGet();
+        // Sleeps until a key is pressed (column pin-change wake) or, without
+        // wake-capable columns, re-checks the idle keypad every 50 ms.
+        char key = 0;
+        if (keypadInputWaitKey(s_keypad, &key, portMAX_DELAY)) {
+            Lab5PidShared::Lock state(g_lab5PidState);
 
             switch (key) {
                 case 'A':
                     if (state->setpointSource == SETPOINT_SOURCE_POT) {
-                        enterManualMode(state);
-                        printf("[INPUT] Setpoint source: MANUAL\r\n");
+                        enterManualMode(state.get());
+                        DEFERRED_LOG_PRINTF("[INPUT] Setpoint source: MANUAL\r\n");
                     } else {
                         state->setpointSource = SETPOINT_SOURCE_POT;
                         state->activeSetpointC = state->potSetpointC;
-                        printf("[INPUT] Setpoint source: POT\r\n");
+                        DEFERRED_LOG_PRINTF("[INPUT] Setpoint source: POT\r\n");
                     }
                     state->editingSetpoint = false;
                     state->inputBufferLen = 0;
@@ -70,35 +57,37 @@ void vTaskLab5PidInput(void *pvParameters) {
                     break;
 
                 case 'B':
-                    enterManualMode(state);
+                    enterManualMode(state.get());
                     state->manualSetpointC = clampFloat(
                         state->manualSetpointC - SETPOINT_STEP_C,
                         SETPOINT_MIN_C,
                         SETPOINT_MAX_C
                     );
                     state->activeSetpointC = state->manualSetpointC;
-                    printf("[INPUT] Manual setpoint decreased\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Manual setpoint decreased\r\n");
                     break;
 
                 case 'C':
-                    enterManualMode(state);
+                    enterManualMode(state.get());
                     state->manualSetpointC = clampFloat(
                         state->manualSetpointC + SETPOINT_STEP_C,
                         SETPOINT_MIN_C,
                         SETPOINT_MAX_C
                     );
                     state->activeSetpointC = state->manualSetpointC;
-                    printf("[INPUT] Manual setpoint increased\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Manual setpoint increased\r\n");
                     break;
 
                 case 'D': {
                     uint8_t nextPreset = state->pidPresetIndex + 1;
-                    if (nextPreset >= PID_PRESET_COUNT) {
+                    uint8_t presetCount =
+                        state->tunedValid ? PID_PRESET_COUNT + 1 : PID_PRESET_COUNT;
+                    if (nextPreset >= presetCount) {
                         nextPreset = 0;
                     }
-                    applyPidPreset(state, nextPreset);
-                    printf("[INPUT] PID preset: %s\r\n",
-                           PID_PRESETS[nextPreset].name);
+                    lab5PidApplyPreset(state.get(), nextPreset);
+                    DEFERRED_LOG_PRINTF("[INPUT] PID preset: %s\r\n",
+                                        lab5PidPresetName(nextPreset));
                     break;
                 }
 
@@ -106,7 +95,7 @@ void vTaskLab5PidInput(void *pvParameters) {
                     state->editingSetpoint = false;
                     state->inputBufferLen = 0;
                     state->inputBuffer[0] = '\0';
-                    printf("[INPUT] Numeric setpoint entry cancelled\r\n");
+                    DEFERRED_LOG_PRINTF("[INPUT] Numeric setpoint entry cancelled\r\n");
                     break;
 
                 case '#':
@@ -123,7 +112,7 @@ void vTaskLab5PidInput(void *pvParameters) {
                         state->editingSetpoint = false;
                         state->inputBufferLen = 0;
                         state->inputBuffer[0] = '\0';
-                        printf("[INPUT] Manual setpoint confirmed\r\n");
+                        DEFERRED_LOG_PRINTF("[INPUT] Manual setpoint confirmed\r\n");
                     }
                     break;
 
@@ -138,16 +127,12 @@ void vTaskLab5PidInput(void *pvParameters) {
                         if (state->inputBufferLen < SETPOINT_INPUT_MAX_DIGITS) {
                             state->inputBuffer[state->inputBufferLen++] = key;
                             state->inputBuffer[state->inputBufferLen] = '\0';
-                            printf("[INPUT] Entering setpoint: %s\r\n",
-                                   state->inputBuffer);
+                            DEFERRED_LOG_PRINTF("[INPUT] Entering setpoint: %s\r\n",
+                                                state->inputBuffer);
                         }
                     }
                     break;
             }
-
-            lab5PidStateUnlock();
         }
-
-        vTaskDelayUntil(&lastWake, period);
     }
 }
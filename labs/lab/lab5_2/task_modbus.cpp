@@ -0,0 +1,150 @@
+/**
+ * @file task_modbus.cpp
+ * @brief Lab 5.2 Modbus RTU slave task implementation (-DLAB5_2_MODBUS).
+ */
+
+#include "task_modbus.h"
+#include "FlashString.h"
+
+#if defined(LAB5_2_MODBUS)
+
+#include "lab5_2_config.h"
+#include "shared_state.h"
+#include "TaskSignal.h"
+
+#include <Arduino_FreeRTOS.h>
+#include <stdio.h>
+
+static const ModbusRegister MODBUS_REGISTERS[] PROGMEM = {
+    MODBUS_INPUT(0,  Lab5PidState, measuredTempC,           MODBUS_FLOAT, 100),
+    MODBUS_INPUT(1,  Lab5PidState, measuredHumidityPercent, MODBUS_FLOAT, 10),
+    MODBUS_INPUT(2,  Lab5PidState, sensorValid,             MODBUS_BOOL,  1),
+    MODBUS_INPUT(3,  Lab5PidState, activeSetpointC,         MODBUS_FLOAT, 100),
+    MODBUS_INPUT(4,  Lab5PidState, potSetpointC,            MODBUS_FLOAT, 100),
+    MODBUS_INPUT(5,  Lab5PidState, errorC,                  MODBUS_FLOAT, 100),
+    MODBUS_INPUT(6,  Lab5PidState, controlOutputPercent,    MODBUS_FLOAT, 100),
+    MODBUS_INPUT(7,  Lab5PidState, appliedDutyPercent,      MODBUS_FLOAT, 100),
+    MODBUS_INPUT(8,  Lab5PidState, fanRunning,              MODBUS_BOOL,  1),
+    MODBUS_INPUT(9,  Lab5PidState, fanRpm,                  MODBUS_FLOAT, 1),
+    MODBUS_INPUT(10, Lab5PidState, fanTargetRpm,            MODBUS_FLOAT, 1),
+    MODBUS_INPUT(11, Lab5PidState, fanStalled,              MODBUS_BOOL,  1),
+    MODBUS_INPUT(12, Lab5PidState, cascadeLimited,          MODBUS_BOOL,  1),
+    MODBUS_INPUT(13, Lab5PidState, pidAutotuning,           MODBUS_BOOL,  1),
+    MODBUS_INPUT(14, Lab5PidState, sampleCount,             MODBUS_U32,   1),
+    MODBUS_INPUT(16, Lab5PidState, controlCycles,           MODBUS_U32,   1),
+    MODBUS_INPUT(18, Lab5PidState, actuatorUpdates,         MODBUS_U32,   1),
+    MODBUS_INPUT(20, Lab5PidState, sampleAgeMs,             MODBUS_U32,   1),
+
+    MODBUS_HOLDING(0, Lab5PidState, manualSetpointC,        MODBUS_FLOAT, 100),
+    MODBUS_HOLDING(1, Lab5PidState, setpointSource,         MODBUS_ENUM,  1),
+    MODBUS_HOLDING(2, Lab5PidState, pidPresetIndex,         MODBUS_U8,    1),
+    MODBUS_HOLDING(3, Lab5PidState, kp,                     MODBUS_FLOAT, 100),
+    MODBUS_HOLDING(4, Lab5PidState, ki,                     MODBUS_FLOAT, 1000),
+    MODBUS_HOLDING(5, Lab5PidState, kd,                     MODBUS_FLOAT, 100),
+};
+static const uint8_t MODBUS_REGISTER_COUNT =
+    sizeof(MODBUS_REGISTERS) / sizeof(MODBUS_REGISTERS[0]);
+
+static ModbusRtu s_modbus;
+static TaskSignal s_frame;
+
+static void onFrame() {
+    s_frame.giveFromIsr();
+}
+
+/** Range checks (apply false), then the store with its side effects (lock held). */
+static bool onWrite(void *image, const ModbusRegister &reg, float value, bool apply,
+                    void *context) {
+    (void)context;
+    Lab5PidState *state = (Lab5PidState *)image;
+    switch (reg.offset) {
+        case offsetof(Lab5PidState, manualSetpointC):
+            if (value < SETPOINT_MIN_C || value > SETPOINT_MAX_C) {
+                return false;
+            }
+            if (apply) {
+                state->manualSetpointC = value;
+                state->setpointSource = SETPOINT_SOURCE_MANUAL;
+                state->activeSetpointC = value;
+#if LAB5_2_ZONES > 1
+                state->zones.setpointC[0] = value;
+#endif
+            }
+            return true;
+
+        case offsetof(Lab5PidState, setpointSource):
+            if (value != SETPOINT_SOURCE_POT && value != SETPOINT_SOURCE_MANUAL) {
+                return false;
+            }
+            if (apply) {
+                bool manual = (value == SETPOINT_SOURCE_MANUAL);
+                state->setpointSource = manual ? SETPOINT_SOURCE_MANUAL : SETPOINT_SOURCE_POT;
+                state->activeSetpointC = manual ? state->manualSetpointC : state->potSetpointC;
+            }
+            return true;
+
+        case offsetof(Lab5PidState, pidPresetIndex):
+            if (value >= PID_PRESET_COUNT && !(value == PID_PRESET_AUTO && state->tunedValid)) {
+                return false;
+            }
+            if (apply) {
+                lab5PidApplyPreset(state, (uint8_t)value);
+#if LAB5_2_ZONES > 1
+                state->zones.presetIndex[0] = state->pidPresetIndex;
+#endif
+            }
+            return true;
+
+        case offsetof(Lab5PidState, kp):
+        case offsetof(Lab5PidState, ki):
+        case offsetof(Lab5PidState, kd):
+            if (value < 0.0f) {
+                return false;
+            }
+            if (apply) {
+                modbusRtuStore(image, reg, value);
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void lab5PidModbusInit() {
+    modbusRtuInit(&s_modbus, MODBUS_REGISTERS, MODBUS_REGISTER_COUNT, MODBUS_NODE_ADDRESS,
+                  onWrite, NULL);
+    if (!modbusSlaveBegin(MODBUS_BAUD, MODBUS_PARITY, MODBUS_NODE_ADDRESS, PIN_MODBUS_DE,
+                          onFrame)) {
+        FLASH_PRINTF("[ERROR] Modbus: %lu baud not available on USART%u\r\n",
+                     (unsigned long)MODBUS_BAUD, (unsigned)MODBUS_SLAVE_USART);
+    }
+}
+
+void vTaskLab5PidModbus(void *pvParameters) {
+    (void)pvParameters;
+
+    s_frame.bind();
+
+    for (;;) {
+        // Woken per frame; one the header cannot size is polled for its
+        // t3.5 silence every tick until it closes.
+        s_frame.take(modbusSlaveReceiving() ? 1 : portMAX_DELAY);
+        uint8_t len = modbusSlaveFrame();
+        if (len == 0) {
+            continue;
+        }
+        uint8_t reply;
+        {
+            Lab5PidShared::Lock state(g_lab5PidState);
+            reply = modbusRtuHandle(&s_modbus, modbusSlaveBuffer(), len, state.get());
+        }
+        if (reply > 0) {
+            modbusSlaveSend(reply);
+        } else {
+            modbusSlaveRelease();
+        }
+    }
+}
+
+#endif // LAB5_2_MODBUS
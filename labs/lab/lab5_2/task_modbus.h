@@ -0,0 +1,71 @@
+/**
+ * @file task_modbus.h
+ * @brief Lab 5.2 Modbus RTU slave task (-DLAB5_2_MODBUS).
+ *
+ * Serves the shared state to an RS-485 master (SCADA, PLC, a USB-RS485
+ * dongle with a Modbus poller) at node MODBUS_NODE_ADDRESS, 19200 8E1 on
+ * USART3 (lab5_2_config.h). Each request is answered under the state lock
+ * straight from g_lab5PidState (ModbusRtu register table, no copy), so a
+ * multi-register read or write is one consistent step.
+ *
+ * Input registers (0x04, read-only):
+ *
+ *   addr  field                    unit
+ *   0     measuredTempC            0.01 C  (-32768 = invalid)
+ *   1     measuredHumidityPercent  0.1 %   (-32768 = invalid)
+ *   2     sensorValid              0/1
+ *   3     activeSetpointC          0.01 C
+ *   4     potSetpointC             0.01 C
+ *   5     errorC                   0.01 C
+ *   6     controlOutputPercent     0.01 %
+ *   7     appliedDutyPercent       0.01 %
+ *   8     fanRunning               0/1
+ *   9     fanRpm                   1 rpm
+ *   10    fanTargetRpm             1 rpm   (0 in open loop)
+ *   11    fanStalled               0/1
+ *   12    cascadeLimited           0/1
+ *   13    pidAutotuning            0/1
+ *   14-15 sampleCount              u32, high word first
+ *   16-17 controlCycles            u32
+ *   18-19 actuatorUpdates          u32
+ *   20-21 sampleAgeMs              u32 ms
+ *
+ * Holding registers (0x03 read, 0x06 / 0x10 write):
+ *
+ *   0     manualSetpointC          0.01 C, SETPOINT_MIN_C..MAX_C;
+ *                                  a write selects the manual source
+ *   1     setpointSource           0 pot, 1 manual
+ *   2     pidPresetIndex           0..PID_PRESET_COUNT-1 (SOFT/NORM/FAST),
+ *                                  PID_PRESET_AUTO once autotuned
+ *   3     kp                       0.01
+ *   4     ki                       0.001
+ *   5     kd                       0.01    (gains >= 0; a preset write
+ *                                  replaces them)
+ *
+ * A value out of range answers exception 03 and, in a 0x10 request,
+ * leaves every register of it unchanged. The setpoint, source and preset
+ * are saved to EEPROM like keypad changes (settings.h); written gains
+ * hold until the next preset change or reset.
+ */
+
+#ifndef LAB5_2_TASK_MODBUS_H
+#define LAB5_2_TASK_MODBUS_H
+
+#if defined(LAB5_2_MODBUS)
+
+#include "ModbusSlave.h"
+#include "IdleSleep.h"
+
+/** @brief The idle gate of the Modbus USART, kept running by the lab. */
+static const uint16_t LAB5_2_MODBUS_IDLE_GATE =
+    (MODBUS_SLAVE_USART == 1) ? IDLE_SLEEP_GATE_USART1 :
+    (MODBUS_SLAVE_USART == 2) ? IDLE_SLEEP_GATE_USART2 : IDLE_SLEEP_GATE_USART3;
+
+/** @brief Bind the register table and start the USART (setup()). */
+void lab5PidModbusInit();
+
+void vTaskLab5PidModbus(void *pvParameters);
+
+#endif // LAB5_2_MODBUS
+
+#endif // LAB5_2_TASK_MODBUS_H
@@ -0,0 +1,151 @@
+/**
+ * @file task_pipeline.cpp
+ * @brief Lab 5.2 fused control pipeline (-DLAB5_2_FUSED_PIPELINE).
+ *
+ * Replaces the acquisition, control and actuation tasks with one
+ * periodic task that runs their stages inline, handing the sample and
+ * the fan command on in local variables instead of through the sample
+ * queue and the command mailbox:
+ *
+ *   every PIPELINE_PERIOD_MS          tach update + fan drive (inner loop)
+ *   every lab5PidControlPeriodMs()    control cycle, before the fan drive
+ *   every TASK_ACQUISITION_PERIOD_MS  DHT + pot read, before the control
+ *
+ * Satellite zones (zones.h) are read, controlled and driven in the pass
+ * at lab5PidZoneOffsetMs() into each sample interval.
+ *
+ * A new sample therefore reaches the fan in the same pass, with no task
+ * switch in between. Each pass ends with a single state lock that
+ * stores all the stages' results, takes the inputs (setpoint, gains,
+ * requests) for the next pass and publishes one reader snapshot. The
+ * cascade is owned by this task alone, so it needs no lock at all.
+ *
+ * The stages are the ones the separate tasks run, so both layouts
+ * behave the same; setpoint and keypad changes take effect up to one
+ * pass later here.
+ */
+
+#include "task_pipeline.h"
+#include "lab5_2_config.h"
+#include "shared_state.h"
+#include "task_acquisition.h"
+#include "task_control.h"
+#include "task_actuation.h"
+#include "zones.h"
+#include "RtosTime.h"
+#include "TaskMonitor.h"
+
+#include <Arduino_FreeRTOS.h>
+#include <math.h>
+
+/** @brief Passes per interval, at least one. */
+static uint16_t passesPer(uint16_t intervalMs) {
+    uint16_t passes = intervalMs / PIPELINE_PERIOD_MS;
+    return passes > 0 ? passes : 1;
+}
+
+void vTaskLab5PidPipeline(void *pvParameters) {
+    (void)pvParameters;
+
+    lab5PidAcquisitionInit();
+    lab5PidControlInit();
+    lab5PidActuationInit();
+
+    const uint16_t samplePasses = passesPer(TASK_ACQUISITION_PERIOD_MS);
+    const uint16_t controlPasses = passesPer(lab5PidControlPeriodMs());
+
+    Lab5PidControlInputs inputs;
+    bool calibrationRequested = false;
+#if LAB5_2_ZONES > 1
+    // Entry = zone; entry 0 is unused (zone 0 has inputs and reading).
+    Lab5PidZoneInputs zoneInputs[PID_ZONE_COUNT];
+    Lab5PidSample zoneSamples[PID_ZONE_COUNT];
+    uint16_t zonePhase[PID_ZONE_COUNT];
+    for (uint8_t z = 1; z < PID_ZONE_COUNT; z++) {
+        zonePhase[z] = lab5PidZoneOffsetMs(z) / PIPELINE_PERIOD_MS;
+    }
+#endif
+    g_lab5PidState.update([&](Lab5PidState &state) {
+        lab5PidControlTakeInputs(&state, &inputs);
+#if LAB5_2_ZONES > 1
+        for (uint8_t z = 1; z < PID_ZONE_COUNT; z++) {
+            lab5PidZoneTakeInputs(&state, z, &zoneInputs[z]);
+        }
+#endif
+    });
+
+    Lab5PidAcquisition reading;
+    reading.sample.tick = 0;
+    reading.sample.temperatureC = NAN;
+    reading.sample.valid = false;
+    reading.sample.ageMs = UINT32_MAX;
+    reading.sample.captureUs = 0;
+    reading.sample.zone = 0;
+    Lab5PidCommand command = { 0, 0.0f, false };  // Fan off until the first output
+
+    RtosPeriod period(PIPELINE_PERIOD_MS);
+    taskMonitorWatch(&period);
+    uint32_t pass = 0;
+
+    for (;;) {
+        uint16_t phase = pass % samplePasses;
+        bool newSample = phase == 0;
+        bool control = newSample || (PID_ESTIMATOR_ENABLED && (pass % controlPasses) == 0);
+        pass++;
+
+#if LAB5_2_ZONES > 1
+        uint8_t zonesDue = 0;   // Bit z: zone z ran this pass
+        for (uint8_t z = 1; z < PID_ZONE_COUNT; z++) {
+            if (phase == zonePhase[z]) {
+                lab5PidZoneAcquire(z, &zoneSamples[z]);
+                lab5PidZoneCompute(zoneSamples[z], zoneInputs[z]);
+                zonesDue |= (uint8_t)(1U << z);
+            }
+        }
+#endif
+
+        if (newSample) {
+            lab5PidAcquire(&reading);
+        }
+        if (control) {
+            lab5PidControlCompute(reading.sample, newSample, inputs);
+            command = lab5PidControlOutput();
+            inputs.tuneRequested = false;     // Consumed
+            inputs.cancelRequested = false;
+        }
+        lab5PidActuate(command, control, calibrationRequested);
+
+        {
+            // The pass's only lock: its release publishes the snapshot.
+            Lab5PidShared::Lock state(g_lab5PidState);
+            if (newSample) {
+                lab5PidAcquisitionStore(state.get(), reading);
+            }
+            if (control) {
+                lab5PidControlStore(state.get());
+            }
+            lab5PidActuationStore(state.get());
+
+            // Requests wait for the next control pass.
+            bool tune = inputs.tuneRequested;
+            bool cancel = inputs.cancelRequested;
+            lab5PidControlTakeInputs(state.get(), &inputs);
+            inputs.tuneRequested = inputs.tuneRequested || tune;
+            inputs.cancelRequested = inputs.cancelRequested || cancel;
+            calibrationRequested = state->fanCalibrationRequested;
+            state->fanCalibrationRequested = false;
+
+#if LAB5_2_ZONES > 1
+            for (uint8_t z = 1; z < PID_ZONE_COUNT; z++) {
+                if ((zonesDue & (1U << z)) != 0) {
+                    lab5PidZoneAcquisitionStore(state.get(), zoneSamples[z]);
+                    lab5PidZoneStore(state.get(), z);
+                }
+                lab5PidZoneTakeInputs(state.get(), z, &zoneInputs[z]);
+            }
+#endif
+        }
+
+        period.wait();
+    }
+}
@@ -0,0 +1,11 @@
+/**
+ * @file task_pipeline.h
+ * @brief Lab 5.2 fused acquire → control → actuate task (-DLAB5_2_FUSED_PIPELINE).
+ */
+
+#ifndef LAB5_2_TASK_PIPELINE_H
+#define LAB5_2_TASK_PIPELINE_H
+
+void vTaskLab5PidPipeline(void *pvParameters);
+
+#endif // LAB5_2_TASK_PIPELINE_H
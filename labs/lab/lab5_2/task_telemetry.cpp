@@ -0,0 +1,733 @@
+/**
+ * @file task_telemetry.cpp
+ * @brief Lab 5.2 telemetry task implementation.
+ */
+
+#include "task_telemetry.h"
+#include "lab5_2_config.h"
+#include "shared_state.h"
+#include "settings.h"
+#include "TelemetryFrame.h"
+#include "FieldTelemetry.h"
+#include "CommandParser.h"
+#include "CommandMacros.h"
+#include "ConfigStore.h"
+#include "StdioSerial.h"
+#include "TaskMonitor.h"
+#include "MemoryMonitor.h"
+#include "RtosTime.h"
+#include "DeferredLog.h"
+#include "FixedFormat.h"
+#include "KernelTrace.h"
+#include "PcProfiler.h"
+#include "perf.h"
+#include "schedule.h"
+#include "stress.h"
+#include "FlashString.h"
+#if defined(LAB5_2_SD_LOG)
+#include "SdLogger.h"
+#endif
+
+#include <Arduino_FreeRTOS.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+struct __attribute__((packed)) Lab5PidTelemetry {
+    uint32_t timeMs;
+    uint32_t sampleCount;
+    int16_t activeSetpointC;
+    int16_t measuredTempC;
+    int16_t measuredHumidity;
+    int16_t errorC;
+    int16_t controlOutputPercent;
+    int16_t appliedDutyPercent;
+    int16_t kp;
+    int16_t ki;
+    int16_t kd;
+    uint16_t controlCycles;
+    uint8_t flags;
+};
+
+static const FieldDesc FIELDS[] PROGMEM = {
+    FIELD_DESC("sp",      Lab5PidState, activeSetpointC,         FIELD_FLOAT, 2),
+    FIELD_DESC("temp",    Lab5PidState, measuredTempC,           FIELD_FLOAT, 2),
+    FIELD_DESC("est",     Lab5PidState, estimatedTempC,          FIELD_FLOAT, 2),
+    FIELD_DESC("hum",     Lab5PidState, measuredHumidityPercent, FIELD_FLOAT, 1),
+    FIELD_DESC("valid",   Lab5PidState, sensorValid,             FIELD_BOOL,  0),
+    FIELD_DESC("pot",     Lab5PidState, potRaw,                  FIELD_U16,   0),
+    FIELD_DESC("err",     Lab5PidState, errorC,                  FIELD_FLOAT, 2),
+    FIELD_DESC("integ",   Lab5PidState, pidIntegral,             FIELD_FLOAT, 2),
+    FIELD_DESC("deriv",   Lab5PidState, pidDerivative,           FIELD_FLOAT, 3),
+    FIELD_DESC("smithc",  Lab5PidState, smithCorrectionC,        FIELD_FLOAT, 2),
+    FIELD_DESC("out",     Lab5PidState, controlOutputPercent,    FIELD_FLOAT, 1),
+    FIELD_DESC("duty",    Lab5PidState, appliedDutyPercent,      FIELD_FLOAT, 1),
+    FIELD_DESC("fan",     Lab5PidState, fanRunning,              FIELD_BOOL,  0),
+    FIELD_DESC("rpm",     Lab5PidState, fanRpm,                  FIELD_FLOAT, 0),
+    FIELD_DESC("rpmsp",   Lab5PidState, fanTargetRpm,            FIELD_FLOAT, 0),
+    FIELD_DESC("spdint",  Lab5PidState, fanSpeedIntegral,        FIELD_FLOAT, 1),
+    FIELD_DESC("climit",  Lab5PidState, cascadeLimited,          FIELD_BOOL,  0),
+    FIELD_DESC("stall",   Lab5PidState, fanStalled,              FIELD_BOOL,  0),
+    FIELD_DESC("fancal",  Lab5PidState, fanCalibrationProgress,  FIELD_U8,    0),
+    FIELD_DESC("kp",      Lab5PidState, kp,                      FIELD_FLOAT, 3),
+    FIELD_DESC("ki",      Lab5PidState, ki,                      FIELD_FLOAT, 3),
+    FIELD_DESC("kd",      Lab5PidState, kd,                      FIELD_FLOAT, 3),
+    FIELD_DESC("preset",  Lab5PidState, pidPresetIndex,          FIELD_U8,    0),
+    FIELD_DESC("tuning",  Lab5PidState, pidAutotuning,           FIELD_BOOL,  0),
+    FIELD_DESC("tunecyc", Lab5PidState, pidAutotuneCycles,       FIELD_U8,    0),
+    FIELD_DESC("samples", Lab5PidState, sampleCount,             FIELD_U32,   0),
+    FIELD_DESC("age",     Lab5PidState, sampleAgeMs,             FIELD_U32,   0),
+    FIELD_DESC("cycles",  Lab5PidState, controlCycles,           FIELD_U32,   0),
+    FIELD_DESC("updates", Lab5PidState, actuatorUpdates,         FIELD_U32,   0),
+    FIELD_DESC("sovr",    Lab5PidState, sampleOverruns,          FIELD_U32,   0),
+    FIELD_DESC("covr",    Lab5PidState, commandOverruns,         FIELD_U32,   0),
+    FIELD_DESC("ramgap",  Lab5PidState, ramGapBytes,             FIELD_U16,   0),
+    FIELD_DESC("ramleast", Lab5PidState, ramGapMinBytes,         FIELD_U16,   0),
+    FIELD_DESC("heap",    Lab5PidState, heapBytes,               FIELD_U16,   0),
+    FIELD_DESC("liae",    Lab5PidState, loop.iae,                FIELD_FLOAT, 1),
+    FIELD_DESC("lise",    Lab5PidState, loop.ise,                FIELD_FLOAT, 1),
+    FIELD_DESC("ltravel", Lab5PidState, loop.travel,             FIELD_FLOAT, 0),
+    FIELD_DESC("lswitch", Lab5PidState, loop.switchesPerHour,    FIELD_FLOAT, 1),
+    FIELD_DESC("lsteps",  Lab5PidState, loop.steps,              FIELD_U16,   0),
+    FIELD_DESC("lover",   Lab5PidState, loop.stepOvershoot,      FIELD_FLOAT, 2),
+    FIELD_DESC("lsettle", Lab5PidState, loop.stepSettleS,        FIELD_FLOAT, 0),
+#if LAB5_2_ZONES > 1
+    FIELD_DESC("zone",    Lab5PidState, zoneIndex,               FIELD_U8,    0),
+    FIELD_DESC("ztemp",   Lab5PidState, zoneTempC,               FIELD_FLOAT, 2),
+    FIELD_DESC("zsp",     Lab5PidState, zoneSetpointC,           FIELD_FLOAT, 2),
+    FIELD_DESC("zout",    Lab5PidState, zoneOutputPercent,       FIELD_FLOAT, 1),
+    FIELD_DESC("zduty",   Lab5PidState, zoneDutyPercent,         FIELD_FLOAT, 1),
+    FIELD_DESC("zvalid",  Lab5PidState, zoneValid,               FIELD_BOOL,  0),
+    FIELD_DESC("zpreset", Lab5PidState, zonePresetIndex,         FIELD_U8,    0),
+    FIELD_DESC("zsamples", Lab5PidState, zoneSamples,            FIELD_U32,   0),
+#endif
+};
+
+/** "fan cal": hand the fan to the calibration sweep (actuation task). */
+static void onFanCal(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    g_lab5PidState.update([](Lab5PidState &state) { state.fanCalibrationRequested = true; });
+}
+
+/** "pid tune" / "pid cancel": start or abort the relay autotune (control task). */
+static void onPidTune(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    g_lab5PidState.update([](Lab5PidState &state) { state.pidAutotuneRequested = true; });
+}
+
+static void onPidCancel(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    g_lab5PidState.update([](Lab5PidState &state) { state.pidAutotuneCancelRequested = true; });
+}
+
+/** "mon": per-task CPU load, free stack and deadline record. */
+static void onMonitor(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    taskMonitorReport();
+}
+
+/** "mem": static, heap and free-gap SRAM (MemoryMonitor). */
+static void onMemory(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    memoryMonitorReport();
+}
+
+/** "ktrace": kernel event ring as CSV (KernelTrace); blocks so no line is dropped. */
+static void onKernelTrace(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    stdioSerialSetTxPolicy(STDIO_TX_BLOCK);
+    kernelTraceDump();
+    stdioSerialSetTxPolicy(STDIO_TX_DROP);
+}
+
+/** "ktrace clear": forget the recorded events and resume recording. */
+static void onKernelTraceClear(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    kernelTraceClear();
+}
+
+/** "prof": PC-sample histogram for tools/pc_profile.py (PcProfiler); blocks like "ktrace". */
+static void onProfile(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    stdioSerialSetTxPolicy(STDIO_TX_BLOCK);
+    pcProfilerDump();
+    stdioSerialSetTxPolicy(STDIO_TX_DROP);
+}
+
+/** "prof clear": zero the histogram, e.g. before a measurement run. */
+static void onProfileClear(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    pcProfilerClear();
+}
+
+/** "prof zoom <lo> <hi>": sample only the byte addresses [lo, hi), fine bins. */
+static void onProfileZoom(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    pcProfilerZoom((uint32_t)args[0].i, (uint32_t)args[1].i);
+}
+
+/** "prof all": back to the whole program. */
+static void onProfileAll(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    pcProfilerZoom(0, 0);
+}
+
+/** "perf": hot-path timing histograms and counters (perf.h). */
+static void onPerf(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    lab5PerfReport();
+}
+
+/** "perf clear": zero the instruments, e.g. before a measurement run. */
+static void onPerfClear(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    lab5PerfClear();
+}
+
+/** "sched": response-time analysis with the measured stage times (schedule.h). */
+static void onSchedule(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    lab5ScheduleAnalyze(true);
+    lab5ScheduleReport(true);
+}
+
+/** "stress run" / "stress level <i>" / "stress off" / "stress": synthetic load (stress.h). */
+static void onStressRun(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    lab5StressRun();
+}
+
+static void onStressLevel(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    int32_t level = args[0].i;
+    lab5StressHold((level >= 0 && level <= 0xFF) ? (uint8_t)level : 0xFF);
+}
+
+static void onStressOff(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    lab5StressOff();
+}
+
+static void onStress(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    lab5StressReport();
+}
+
+/** @brief Seconds as text, "-" for NAN (not settled). */
+static char *fmtSeconds(char *buf, float seconds) {
+    if (isnan(seconds)) {
+        buf[0] = '-';
+        buf[1] = '\0';
+        return buf;
+    }
+    return fmtFixed(buf, seconds, 1, 0);
+}
+
+/** "loop": rolling-window and setpoint-step figures (LoopMetrics). */
+static void onLoop(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    Lab5PidState snapshot;
+    lab5PidStateSnapshot(&snapshot);
+    const LoopMetricsReport &r = snapshot.loop;
+
+    char a[FMT_FIXED_BUF_SIZE], b[FMT_FIXED_BUF_SIZE], c[FMT_FIXED_BUF_SIZE];
+    char d[FMT_FIXED_BUF_SIZE], e[FMT_FIXED_BUF_SIZE];
+    FLASH_PRINTF("[LOOP] window=%ss iae=%s ise=%s travel=%s%% fan switches=%u (%s/h)\r\n",
+                 fmtFixed(a, r.windowS, 1, 0), fmtFixed(b, r.iae, 1, 1), fmtFixed(c, r.ise, 1, 1),
+                 fmtFixed(d, r.travel, 1, 0), (unsigned)r.switches,
+                 fmtFixed(e, r.switchesPerHour, 1, 1));
+    FLASH_PRINTF("[LOOP] step %u: %ss in, over=%s settle=%ss iae=%s\r\n",
+                 (unsigned)r.steps, fmtFixed(a, r.stepElapsedS, 1, 0),
+                 fmtFixed(b, r.stepOvershoot, 1, 2), fmtSeconds(c, r.stepSettleS),
+                 fmtFixed(d, r.stepIae, 1, 1));
+    if (!isnan(r.lastIae)) {
+        FLASH_PRINTF("[LOOP] last step: over=%s settle=%ss iae=%s\r\n",
+                     fmtFixed(a, r.lastOvershoot, 1, 2), fmtSeconds(b, r.lastSettleS),
+                     fmtFixed(c, r.lastIae, 1, 1));
+    }
+}
+
+/** "loop clear": restart the window and the step, e.g. after a tuning change. */
+static void onLoopClear(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    g_lab5PidState.update([](Lab5PidState &state) { state.loopMetricsClearRequested = true; });
+}
+
+#if defined(LAB5_2_SD_LOG)
+static void onSdLog(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    sdLogReport();
+}
+
+/** "sdlog flush": write the partial block and end the card write now. */
+static void onSdLogFlush(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    sdLogFlush();
+}
+#endif
+
+/** "cfg" / "cfg save": settings store status, or write pending changes now. */
+static void onConfig(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    lab5SettingsReport();
+}
+
+static void onConfigSave(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    lab5SettingsFlush();
+    lab5SettingsReport();
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Setpoint, gains and macros
+// ──────────────────────────────────────────────────────────────────────────
+
+static_assert(MACRO_EEPROM_ADDR >= SETTINGS_EEPROM_ADDR +
+                                       (uint32_t)SETTINGS_EEPROM_PAGES * CONFIG_STORE_PAGE_BYTES,
+              "macros overlap the settings pages");
+static_assert(MACRO_EEPROM_ADDR + (uint32_t)MACRO_SLOTS * COMMAND_MACRO_RECORD_BYTES <= 4096,
+              "macros exceed the ATmega2560 EEPROM");
+
+static CommandMacros s_macros(MACRO_EEPROM_ADDR, MACRO_SLOTS);
+static CommandStream s_cli;
+
+/** "sp <C>": manual setpoint (selects the manual source), as the keypad does. */
+static void onSetpoint(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    float setpoint = args[0].f;
+    if (!(setpoint >= SETPOINT_MIN_C && setpoint <= SETPOINT_MAX_C)) {
+        FLASH_PRINTF("[ERROR] Setpoint: %d..%d C\r\n", (int)SETPOINT_MIN_C, (int)SETPOINT_MAX_C);
+        return;
+    }
+    g_lab5PidState.update([setpoint](Lab5PidState &state) {
+        state.manualSetpointC = setpoint;
+        state.setpointSource = SETPOINT_SOURCE_MANUAL;
+        state.activeSetpointC = setpoint;
+#if LAB5_2_ZONES > 1
+        state.zones.setpointC[0] = setpoint;
+#endif
+    });
+}
+
+/** "sp pot": follow the potentiometer again. */
+static void onSetpointPot(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    g_lab5PidState.update([](Lab5PidState &state) {
+        state.setpointSource = SETPOINT_SOURCE_POT;
+        state.activeSetpointC = state.potSetpointC;
+    });
+}
+
+/** "preset <i>": PID_PRESETS row, or PID_PRESET_AUTO once autotuned. */
+static void onPreset(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    Lab5PidState snapshot;
+    lab5PidStateSnapshot(&snapshot);
+    int32_t index = args[0].i;
+    if (index < 0 || (index >= PID_PRESET_COUNT &&
+                      !(index == PID_PRESET_AUTO && snapshot.tunedValid))) {
+        FLASH_PRINTF("[ERROR] Preset %ld: 0..%u%s\r\n",
+                     (long)index, (unsigned)(PID_PRESET_COUNT - 1),
+                     snapshot.tunedValid ? " or AUTO" : "");
+        return;
+    }
+    uint8_t preset = (uint8_t)index;
+    g_lab5PidState.update([preset](Lab5PidState &state) {
+        lab5PidApplyPreset(&state, preset);
+#if LAB5_2_ZONES > 1
+        state.zones.presetIndex[0] = state.pidPresetIndex;
+#endif
+    });
+}
+
+/** "pid gains <kp> <ki> <kd>": gains until the next preset change (not stored). */
+static void onPidGains(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    float kp = args[0].f;
+    float ki = args[1].f;
+    float kd = args[2].f;
+    if (!(kp >= 0.0f && ki >= 0.0f && kd >= 0.0f)) {
+        FLASH_PRINTF("[ERROR] Gains must be >= 0\r\n");
+        return;
+    }
+    g_lab5PidState.update([kp, ki, kd](Lab5PidState &state) {
+        state.kp = kp;
+        state.ki = ki;
+        state.kd = kd;
+    });
+}
+
+/** @brief One [ERROR] line naming the failed command of a batch. */
+static void printBatchError(const char *what, CommandStatus status, uint8_t failedAt) {
+    FLASH_PRINTF("[ERROR] %s: command %u %s, nothing run\r\n", what, (unsigned)(failedAt + 1),
+                 status == COMMAND_NOT_FOUND ? "unknown" : "has bad arguments");
+}
+
+/** "macro def <name> <a; b; ...>": store a batch (checked first) under a name. */
+static void onMacroDefine(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    char text[COMMAND_MACRO_TEXT_MAX + 1];
+    if (args[1].len > COMMAND_MACRO_TEXT_MAX) {
+        FLASH_PRINTF("[ERROR] Macro text: at most %u characters\r\n",
+                     (unsigned)COMMAND_MACRO_TEXT_MAX);
+        return;
+    }
+    memcpy(text, args[1].text, args[1].len);
+    text[args[1].len] = '\0';
+    uint8_t failedAt = 0;
+    CommandStatus status = commandBatchCheck(s_cli.table, s_cli.count, text, &failedAt);
+    if (status != COMMAND_OK) {
+        printBatchError("Macro", status, failedAt);
+        return;
+    }
+    if (args[0].len > COMMAND_MACRO_NAME_MAX) {
+        FLASH_PRINTF("[ERROR] Macro name: at most %u characters\r\n",
+                     (unsigned)COMMAND_MACRO_NAME_MAX);
+        return;
+    }
+    if (!s_macros.define(args[0].text, args[0].len, text, args[1].len)) {
+        FLASH_PRINTF("[ERROR] Macro: all %u slots used (macro del <name>)\r\n",
+                     (unsigned)MACRO_SLOTS);
+        return;
+    }
+    FLASH_PRINTF("[MACRO] %.*s stored\r\n", (int)args[0].len, args[0].text);
+}
+
+/** "macro del <name>". */
+static void onMacroDelete(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    if (!s_macros.remove(args[0].text, args[0].len)) {
+        FLASH_PRINTF("[ERROR] No macro %.*s\r\n", (int)args[0].len, args[0].text);
+    }
+}
+
+/** "macro list". */
+static void onMacroList(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    s_macros.print();
+}
+
+/** "run <name>": a stored batch, all or nothing, like a typed one. */
+static void onMacroRun(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    uint8_t failedAt = 0;
+    CommandStatus status = s_macros.run(args[0].text, args[0].len, s_cli.table, s_cli.count,
+                                        context, &failedAt);
+    if (status == COMMAND_OK || status == COMMAND_EMPTY) {
+        return;
+    }
+    if (s_macros.isRunning()) {
+        FLASH_PRINTF("[ERROR] A macro cannot run a macro\r\n");
+    } else if (status == COMMAND_NOT_FOUND && !s_macros.contains(args[0].text, args[0].len)) {
+        FLASH_PRINTF("[ERROR] No macro %.*s\r\n", (int)args[0].len, args[0].text);
+    } else {
+        printBatchError("Macro", status, failedAt);
+    }
+}
+
+#if LAB5_2_ZONES > 1
+static uint8_t s_zone = 0;   // Zone shown by the z* fields
+
+/** @brief Fill the z* fields of @p snapshot from zone s_zone's entries. */
+static void fillZoneView(Lab5PidState *snapshot) {
+    const Lab5PidZones &zones = snapshot->zones;
+    snapshot->zoneIndex = s_zone;
+    snapshot->zoneTempC = zones.temperatureC[s_zone];
+    snapshot->zoneSetpointC = zones.setpointC[s_zone];
+    snapshot->zoneOutputPercent = zones.outputPercent[s_zone];
+    snapshot->zoneDutyPercent = zones.dutyPercent[s_zone];
+    snapshot->zoneValid = (zones.validMask & (1U << s_zone)) != 0;
+    snapshot->zonePresetIndex = zones.presetIndex[s_zone];
+    snapshot->zoneSamples = zones.samples[s_zone];
+}
+
+static void printZone(const Lab5PidZones &zones, uint8_t zone) {
+    FLASH_PRINTF("[ZONE] %u %s temp=%.2f sp=%.2f out=%.1f duty=%.1f preset=%u samples=%lu%s\r\n",
+                 (unsigned)zone, PID_ZONES[zone].name, (double)zones.temperatureC[zone],
+                 (double)zones.setpointC[zone], (double)zones.outputPercent[zone],
+                 (double)zones.dutyPercent[zone], (unsigned)zones.presetIndex[zone],
+                 (unsigned long)zones.samples[zone],
+                 (zones.validMask & (1U << zone)) != 0 ? "" : " INVALID");
+}
+
+static bool zoneArgValid(int32_t zone) {
+    if (zone < 0 || zone >= PID_ZONE_COUNT) {
+        FLASH_PRINTF("[ERROR] Zone %ld: 0..%u\r\n", (long)zone, (unsigned)(PID_ZONE_COUNT - 1));
+        return false;
+    }
+    return true;
+}
+
+/** "zone <n>": show zone n in the z* fields; "zones": print every zone. */
+static void onZone(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    if (!zoneArgValid(args[0].i)) {
+        return;
+    }
+    s_zone = (uint8_t)args[0].i;
+    Lab5PidState snapshot;
+    lab5PidStateSnapshot(&snapshot);
+    printZone(snapshot.zones, s_zone);
+}
+
+static void onZones(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    Lab5PidState snapshot;
+    lab5PidStateSnapshot(&snapshot);
+    for (uint8_t z = 0; z < PID_ZONE_COUNT; z++) {
+        printZone(snapshot.zones, z);
+    }
+}
+
+/** "zone sp <n> <C>": zone setpoint; zone 0's is the manual setpoint. */
+static void onZoneSetpoint(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    if (!zoneArgValid(args[0].i)) {
+        return;
+    }
+    uint8_t zone = (uint8_t)args[0].i;
+    float setpoint = args[1].f;
+    if (setpoint < SETPOINT_MIN_C) setpoint = SETPOINT_MIN_C;
+    if (setpoint > SETPOINT_MAX_C) setpoint = SETPOINT_MAX_C;
+    g_lab5PidState.update([zone, setpoint](Lab5PidState &state) {
+        if (zone == 0) {
+            state.manualSetpointC = setpoint;
+            state.setpointSource = SETPOINT_SOURCE_MANUAL;
+            state.activeSetpointC = setpoint;
+        }
+        state.zones.setpointC[zone] = setpoint;
+    });
+}
+
+/** "zone preset <n> <i>": zone PID_PRESETS row; zone 0's goes through lab5PidApplyPreset(). */
+static void onZonePreset(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    if (!zoneArgValid(args[0].i)) {
+        return;
+    }
+    uint8_t zone = (uint8_t)args[0].i;
+    if (args[1].i < 0 || (zone != 0 && args[1].i >= PID_PRESET_COUNT)) {
+        FLASH_PRINTF("[ERROR] Preset %ld: 0..%u\r\n",
+                     (long)args[1].i, (unsigned)(PID_PRESET_COUNT - 1));
+        return;
+    }
+    uint8_t preset = (uint8_t)args[1].i;
+    g_lab5PidState.update([zone, preset](Lab5PidState &state) {
+        if (zone == 0) {
+            lab5PidApplyPreset(&state, preset);
+            state.zones.presetIndex[0] = state.pidPresetIndex;
+        } else {
+            state.zones.presetIndex[zone] = preset;
+        }
+    });
+}
+#endif
+
+static const CommandEntry COMMANDS[] PROGMEM = {
+    FIELD_TELEMETRY_COMMANDS,
+    COMMAND_ENTRY("fan cal", onFanCal, ""),
+    COMMAND_ENTRY("pid tune", onPidTune, ""),
+    COMMAND_ENTRY("pid cancel", onPidCancel, ""),
+    COMMAND_ENTRY("mon", onMonitor, ""),
+    COMMAND_ENTRY("mem", onMemory, ""),
+    COMMAND_ENTRY("perf clear", onPerfClear, ""),
+    COMMAND_ENTRY("perf", onPerf, ""),
+    COMMAND_ENTRY("sched", onSchedule, ""),
+    COMMAND_ENTRY("loop clear", onLoopClear, ""),
+    COMMAND_ENTRY("loop", onLoop, ""),
+    COMMAND_ENTRY("ktrace clear", onKernelTraceClear, ""),
+    COMMAND_ENTRY("ktrace", onKernelTrace, ""),
+    COMMAND_ENTRY("prof clear", onProfileClear, ""),
+    COMMAND_ENTRY("prof zoom", onProfileZoom, "ii"),
+    COMMAND_ENTRY("prof all", onProfileAll, ""),
+    COMMAND_ENTRY("prof", onProfile, ""),
+    LATENCY_PROBE_COMMANDS,
+    COMMAND_ENTRY("stress run", onStressRun, ""),
+    COMMAND_ENTRY("stress level", onStressLevel, "i"),
+    COMMAND_ENTRY("stress off", onStressOff, ""),
+    COMMAND_ENTRY("stress", onStress, ""),
+    COMMAND_ENTRY("cfg save", onConfigSave, ""),
+    COMMAND_ENTRY("cfg", onConfig, ""),
+    COMMAND_ENTRY("sp pot", onSetpointPot, ""),
+    COMMAND_ENTRY("sp", onSetpoint, "f"),
+    COMMAND_ENTRY("preset", onPreset, "i"),
+    COMMAND_ENTRY("pid gains", onPidGains, "fff"),
+    COMMAND_ENTRY("macro def", onMacroDefine, "wr"),
+    COMMAND_ENTRY("macro del", onMacroDelete, "w"),
+    COMMAND_ENTRY("macro list", onMacroList, ""),
+    COMMAND_ENTRY("run", onMacroRun, "w"),
+#if defined(LAB5_2_SD_LOG)
+    COMMAND_ENTRY("sdlog flush", onSdLogFlush, ""),
+    COMMAND_ENTRY("sdlog", onSdLog, ""),
+#endif
+#if LAB5_2_ZONES > 1
+    COMMAND_ENTRY("zone sp", onZoneSetpoint, "if"),
+    COMMAND_ENTRY("zone preset", onZonePreset, "ii"),
+    COMMAND_ENTRY("zones", onZones, ""),
+    COMMAND_ENTRY("zone", onZone, "i"),
+#endif
+};
+
+static FieldTelemetry s_fields;
+
+bool lab5PidTelemetryHasSubscribers() {
+    return fieldTelemetryActive(&s_fields) > 0;
+}
+
+static void serviceCommands() {
+    int c;
+    while ((c = stdioSerialPollChar()) >= 0) {
+        CommandStatus status = commandStreamFeed(&s_cli, (char)c);
+        if ((status == COMMAND_NOT_FOUND || status == COMMAND_BAD_ARGS) &&
+            s_cli.lastCommands > 1) {
+            printBatchError("Batch", status, s_cli.lastFailedAt);
+        } else if (status == COMMAND_NOT_FOUND || status == COMMAND_BAD_ARGS) {
+            FLASH_PRINTF("[ERROR] Unknown command. ");
+            fieldTelemetryPrintHelp();
+            FLASH_PRINTF("          fan cal | pid tune | pid cancel | mon | mem | cfg [save]\r\n");
+            FLASH_PRINTF("          perf [clear] | loop [clear] | ktrace [clear] | sp <C> | sp pot\r\n");
+            FLASH_PRINTF("          prof [clear] | prof zoom <lo> <hi> | prof all\r\n");
+            FLASH_PRINTF("          lat [clear] | lat loop <period> <hold> | lat stop\r\n");
+            FLASH_PRINTF("          preset <i> | pid gains <kp> <ki> <kd> | macro def <name> <a; b>\r\n");
+            FLASH_PRINTF("          macro del <name> | macro list | run <name> | <a>; <b>; ... = all or none\r\n");
+#if defined(LAB5_2_SD_LOG)
+            FLASH_PRINTF("          sdlog | sdlog flush\r\n");
+#endif
+#if LAB5_2_ZONES > 1
+            FLASH_PRINTF("          zone <n> | zones | zone sp <n> <C> | zone preset <n> <i>\r\n");
+#endif
+        }
+    }
+}
+
+void vTaskLab5PidTelemetry(void *pvParameters) {
+    (void)pvParameters;
+
+    fieldTelemetryInit(&s_fields, FIELDS, sizeof(FIELDS) / sizeof(FIELDS[0]));
+    commandStreamInit(&s_cli, COMMANDS, sizeof(COMMANDS) / sizeof(COMMANDS[0]), &s_fields);
+
+    RtosPeriod period(TASK_TELEMETRY_PERIOD_MS);
+    taskMonitorWatch(&period);
+    Lab5PidTelemetry rec;
+    uint32_t lastMonitorMs = millis();
+
+    for (;;) {
+        period.wait();
+        if (!deferredLogPreambleDone()) {
+            continue;  // Command replies and frames wait for the banner.
+        }
+
+        serviceCommands();
+
+        if (TASK_MONITOR_REPORT_MS != 0 && millis() - lastMonitorMs >= TASK_MONITOR_REPORT_MS) {
+            lastMonitorMs = millis();
+            taskMonitorReport();
+        }
+
+        Lab5PidState snapshot;
+        lab5PidStateSnapshot(&snapshot);
+        lab5SettingsService(snapshot);
+        if (lab5PidTelemetryHasSubscribers()) {
+            MemoryStats memory;
+            memoryMonitorRead(&memory);
+            snapshot.ramGapBytes = memory.gapBytes;
+            snapshot.ramGapMinBytes = memory.gapMinBytes;
+            snapshot.heapBytes = memory.heapBytes;
+        }
+
+#if LAB5_2_ZONES > 1
+        fillZoneView(&snapshot);
+#endif
+        fieldTelemetryPoll(&s_fields, &snapshot, millis());
+
+#if !defined(LAB5_2_SD_LOG)
+        if (!TELEMETRY_BINARY) {
+            continue;
+        }
+#endif
+
+        rec.timeMs = millis();
+        rec.sampleCount = snapshot.sampleCount;
+        rec.activeSetpointC = telemetryPackFloat(snapshot.activeSetpointC, 100);
+        rec.measuredTempC = telemetryPackFloat(snapshot.measuredTempC, 100);
+        rec.measuredHumidity = telemetryPackFloat(snapshot.measuredHumidityPercent, 10);
+        rec.errorC = telemetryPackFloat(snapshot.errorC, 100);
+        rec.controlOutputPercent = telemetryPackFloat(snapshot.controlOutputPercent, 100);
+        rec.appliedDutyPercent = telemetryPackFloat(snapshot.appliedDutyPercent, 100);
+        rec.kp = telemetryPackFloat(snapshot.kp, 1000);
+        rec.ki = telemetryPackFloat(snapshot.ki, 1000);
+        rec.kd = telemetryPackFloat(snapshot.kd, 1000);
+        rec.controlCycles = (uint16_t)snapshot.controlCycles;
+        rec.flags = (uint8_t)((snapshot.sensorValid ? 0x01 : 0) |
+                              (snapshot.fanRunning ? 0x02 : 0) |
+                              (snapshot.setpointSource == SETPOINT_SOURCE_MANUAL ? 0x04 : 0) |
+                              ((snapshot.pidPresetIndex & 0x0F) << 4));
+
+        if (TELEMETRY_BINARY) {
+            telemetrySend(LAB5_2_TELEMETRY_TYPE, &rec, sizeof(rec));
+        }
+#if defined(LAB5_2_SD_LOG)
+        sdLogRecord(LAB5_2_TELEMETRY_TYPE, &rec, sizeof(rec));
+#endif
+    }
+}
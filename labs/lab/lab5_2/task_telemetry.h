@@ -0,0 +1,67 @@
+/**
+ * @file task_telemetry.h
+ * @brief Lab 5.2 telemetry task: field subscriptions and binary records.
+ *
+ * Every TASK_TELEMETRY_PERIOD_MS the task reads serial commands, snapshots
+ * the shared state and prints the fields subscribed with
+ * "sub <field> <period_ms>" (FieldTelemetry). While any field is
+ * subscribed the display task stops printing its fixed plotter line.
+ *
+ * Fields: sp temp hum valid pot err integ deriv out duty fan kp ki kd
+ *         preset samples cycles updates ramgap ramleast heap
+ *
+ * With -DLAB5_2_ZONES=<n> the fields zone ztemp zsp zout zduty zvalid
+ * zpreset zsamples show the zone picked with "zone <n>"; "zones" prints
+ * every zone, "zone sp <n> <C>" and "zone preset <n> <i>" set one
+ * (zone 0's setpoint is the manual setpoint).
+ *
+ * "mon" prints the TaskMonitor table, "mem" the MemoryMonitor lines; the
+ * ramgap / ramleast / heap fields are read only while a field is
+ * subscribed.
+ *
+ * Loop figures (LoopMetrics, fed by the control task): the fields liae
+ * lise ltravel lswitch (fan starts and stops per hour) over the last
+ * LOOP_METRICS_WINDOW_MS, lsteps, and lover / lsettle (s, nan until
+ * settled) of the present setpoint step. "loop" prints them with the
+ * last finished step's; "loop clear" starts over, e.g. after new gains.
+ *
+ * The task also saves the settings (settings.h) from its snapshot; "cfg"
+ * prints the store status and "cfg save" writes a pending change at once.
+ *
+ * With TELEMETRY_BINARY enabled it also sends one TelemetryFrame record
+ * (COBS + CRC-16) per period; with -DLAB5_2_SD_LOG the same frame is
+ * appended to LOG.BIN on the SD card (SdLogger; "sdlog" prints the
+ * counters, "sdlog flush" commits the partial block):
+ *
+ * Record type LAB5_2_TELEMETRY_TYPE, 29 bytes, little-endian:
+ *
+ *   off  type  field
+ *   0    u32   timeMs                millis() at send time
+ *   4    u32   sampleCount           DHT samples taken
+ *   8    i16   activeSetpointC       0.01 C
+ *   10   i16   measuredTempC         0.01 C (-32768 = invalid)
+ *   12   i16   measuredHumidity      0.1 %  (-32768 = invalid)
+ *   14   i16   errorC                0.01 C
+ *   16   i16   controlOutputPercent  0.01 %
+ *   18   i16   appliedDutyPercent    0.01 %
+ *   20   i16   kp                    0.001
+ *   22   i16   ki                    0.001
+ *   24   i16   kd                    0.001
+ *   26   u16   controlCycles         low 16 bits
+ *   28   u8    flags                 bit0 sensorValid, bit1 fanRunning,
+ *                                    bit2 manual setpoint, bits4-7 preset
+ */
+
+#ifndef LAB5_2_TASK_TELEMETRY_H
+#define LAB5_2_TASK_TELEMETRY_H
+
+#include <Arduino.h>
+
+static const uint8_t LAB5_2_TELEMETRY_TYPE = 0x52;
+
+void vTaskLab5PidTelemetry(void *pvParameters);
+
+/** @brief True while at least one field subscription is active. */
+bool lab5PidTelemetryHasSubscribers();
+
+#endif // LAB5_2_TASK_TELEMETRY_H
@@ -0,0 +1,179 @@
+/**
+ * @file zones.cpp
+ * @brief Lab 5.2 satellite zones implementation (-DLAB5_2_ZONES=<n>, n > 1).
+ *
+ * With -DLAB5_SIM the NTCs are replaced by the satellite rooms of
+ * plant_sim.h, cooled by each zone's fan duty.
+ */
+
+#include "zones.h"
+#include "FlashString.h"
+
+#if LAB5_2_ZONES > 1
+
+#include "lab5_2_config.h"
+#include "plant_sim.h"
+#include "AnalogTempSensor.h"
+#include "AdcEngine.h"
+#include "PidController.h"
+#include "PwmActuator.h"
+
+#include "RtosTick.h"
+#include <math.h>
+#include <stdio.h>
+
+/** Satellites: zone z is entry z - 1 of the arrays below. */
+static const uint8_t SATELLITES = PID_ZONE_COUNT - 1;
+
+// Conversion only: each zone's count comes from its AdcEngine slot or
+// pin, so one instance serves every NTC.
+static AnalogTempSensor s_ntc(PID_ZONES[1].sensorPin, ZONE_NTC_SERIES_OHMS,
+                              ZONE_NTC_NOMINAL_OHMS, ZONE_NTC_BETA);
+
+#define ZONE_PID { PID_DEFAULT_KP, PID_DEFAULT_KI, PID_DEFAULT_KD, \
+                   PID_OUTPUT_MIN_PERCENT, PID_OUTPUT_MAX_PERCENT, PID_REVERSE }
+
+static PidController s_pid[SATELLITES] = {
+    ZONE_PID,
+#if LAB5_2_ZONES > 2
+    ZONE_PID,
+#endif
+#if LAB5_2_ZONES > 3
+    ZONE_PID,
+#endif
+};
+
+static PwmActuator s_fan[SATELLITES] = {
+    { PID_ZONES[1].fanPwmPin },
+#if LAB5_2_ZONES > 2
+    { PID_ZONES[2].fanPwmPin },
+#endif
+#if LAB5_2_ZONES > 3
+    { PID_ZONES[3].fanPwmPin },
+#endif
+};
+
+static uint32_t s_previousCaptureUs[SATELLITES];
+static TickType_t s_lastValidTick[SATELLITES];
+static float s_output[SATELLITES];
+static uint8_t s_haveCapture = 0;      // Bit z - 1: previousCaptureUs is a valid sample's
+
+uint16_t lab5PidZoneOffsetMs(uint8_t zone) {
+    return (uint16_t)((uint32_t)TASK_ACQUISITION_PERIOD_MS * zone / PID_ZONE_COUNT);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Acquisition stage
+// ──────────────────────────────────────────────────────────────────────────
+
+void lab5PidZoneAcquisitionInit() {
+    for (uint8_t z = 1; z < PID_ZONE_COUNT; z++) {
+        pinMode(PID_ZONES[z].sensorPin, INPUT);
+    }
+}
+
+void lab5PidZoneAcquire(uint8_t zone, Lab5PidSample *out) {
+    out->zone = zone;
+    out->tick = xTaskGetTickCount();
+    out->captureUs = micros();
+    out->ageMs = 0;
+#if defined(LAB5_SIM)
+    out->temperatureC = lab5PidSimZoneRead(zone);
+#else
+    uint16_t raw = adcEngineRunning() ? adcEngineRead(zone)
+                                      : (uint16_t)analogRead(PID_ZONES[zone].sensorPin);
+    out->temperatureC = s_ntc.convertRawC(raw);   // NAN: shorted or open
+#endif
+    out->valid = !isnan(out->temperatureC);
+}
+
+void lab5PidZoneAcquisitionStore(Lab5PidState *state, const Lab5PidSample &sample) {
+    uint8_t zone = sample.zone;
+    uint8_t bit = (uint8_t)(1U << zone);
+    state->zones.temperatureC[zone] = sample.temperatureC;
+    state->zones.validMask = sample.valid ? (uint8_t)(state->zones.validMask | bit)
+                                          : (uint8_t)(state->zones.validMask & ~bit);
+    state->zones.samples[zone]++;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Control stage
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Demand → duty: off below the stop threshold, else start duty..100 %. */
+static float zoneFanDuty(float outputPercent) {
+    if (outputPercent <= FAN_STOP_THRESHOLD_PERCENT) {
+        return 0.0f;
+    }
+    return ZONE_FAN_START_DUTY_PERCENT +
+           (100.0f - ZONE_FAN_START_DUTY_PERCENT) * outputPercent / 100.0f;
+}
+
+void lab5PidZoneControlInit() {
+    for (uint8_t i = 0; i < SATELLITES; i++) {
+        PidController &pid = s_pid[i];
+        pid.init();
+        pid.setDerivativeMode(PID_DERIVATIVE_ON_MEASUREMENT);
+        pid.setDerivativeFilter(PID_DERIVATIVE_FILTER_N);
+        pid.setAntiWindup(PID_ANTIWINDUP_BACK_CALCULATION);
+        pid.setSetpointWeights(PID_SETPOINT_WEIGHT_P, 0.0f);
+        pid.setForm(PID_FORM);
+
+        s_fan[i].init();
+        if (!s_fan[i].enableTimerPwm(ZONE_FAN_PWM_FREQUENCY_HZ)) {
+            FLASH_PRINTF("[ERROR] Zone %s fan: no 16-bit timer on D%u, using analogWrite\r\n",
+                         PID_ZONES[i + 1].name, (unsigned)PID_ZONES[i + 1].fanPwmPin);
+        }
+        s_fan[i].setDuty(0.0f);
+        s_output[i] = 0.0f;
+    }
+}
+
+void lab5PidZoneTakeInputs(const Lab5PidState *state, uint8_t zone, Lab5PidZoneInputs *in) {
+    in->setpointC = state->zones.setpointC[zone];
+    in->presetIndex = state->zones.presetIndex[zone];
+}
+
+void lab5PidZoneCompute(const Lab5PidSample &sample, const Lab5PidZoneInputs &in) {
+    uint8_t i = sample.zone - 1;
+    uint8_t bit = (uint8_t)(1U << i);
+    bool valid = sample.valid;
+
+    float dtSeconds = TASK_ACQUISITION_PERIOD_MS / 1000.0f;
+    if (valid && (s_haveCapture & bit) != 0 && sample.captureUs != s_previousCaptureUs[i]) {
+        dtSeconds = (float)(uint32_t)(sample.captureUs - s_previousCaptureUs[i]) / 1000000.0f;
+    }
+    s_previousCaptureUs[i] = sample.captureUs;
+    s_haveCapture = valid ? (uint8_t)(s_haveCapture | bit) : (uint8_t)(s_haveCapture & ~bit);
+
+    const PidPreset &preset = PID_PRESETS[in.presetIndex < PID_PRESET_COUNT ? in.presetIndex : 0];
+    PidController &pid = s_pid[i];
+    pid.setTunings(preset.kp, preset.ki, preset.kd);
+
+    float output = 0.0f;
+    if (valid) {
+        s_lastValidTick[i] = sample.tick;
+        output = pid.update(in.setpointC, sample.temperatureC, dtSeconds);
+    } else if (PID_HOLD_ON_INVALID_SAMPLE &&
+               (TickType_t)(sample.tick - s_lastValidTick[i]) < pdMS_TO_TICKS(PID_INVALID_HOLD_MS)) {
+        pid.restart();
+        output = pid.getOutput();   // Hold the demand through a dropout
+    } else {
+        pid.reset();
+    }
+    s_output[i] = output;
+
+    float duty = zoneFanDuty(output);
+    s_fan[i].setDuty(duty);
+#if defined(LAB5_SIM)
+    lab5PidSimZoneSetFan(sample.zone, duty);
+#endif
+}
+
+void lab5PidZoneStore(Lab5PidState *state, uint8_t zone) {
+    uint8_t i = zone - 1;
+    state->zones.outputPercent[zone] = s_output[i];
+    state->zones.dutyPercent[zone] = s_fan[i].getDuty();
+}
+
+#endif // LAB5_2_ZONES > 1
@@ -0,0 +1,75 @@
+/**
+ * @file zones.h
+ * @brief Lab 5.2 satellite zones (-DLAB5_2_ZONES=<n>, n > 1).
+ *
+ * Zones 1..PID_ZONE_COUNT-1 of PID_ZONES: an NTC, a velocity PID on a
+ * PID_PRESETS row and a MOSFET fan each. The tasks that run zone 0 run
+ * them too, as stages:
+ *
+ *   acquisition  Acquire at lab5PidZoneOffsetMs() into the period (no
+ *                lock), AcquisitionStore (lock), then the sample goes
+ *                on the sample queue tagged with its zone
+ *   control      per zone sample: TakeInputs (lock) → Compute: PID and
+ *                fan duty (no lock) → Store (lock)
+ *
+ * The fused pipeline runs the same stages inline, in the pass a zone's
+ * sample is due. A satellite fan has no tach, speed loop or curve, so
+ * Compute sets its duty itself; the actuation stage keeps zone 0's fan.
+ *
+ * State: the zone arrays (Lab5PidZones) in the shared state for the
+ * readers, and one array entry per satellite here for the controller,
+ * the fan and the dt chain.
+ *
+ * Without -DLAB5_2_ZONES (one zone) none of this is built.
+ */
+
+#ifndef LAB5_2_ZONES_H
+#define LAB5_2_ZONES_H
+
+#include "shared_state.h"
+
+#if LAB5_2_ZONES > 1
+
+/** @brief What a satellite cycle takes from the state. */
+struct Lab5PidZoneInputs {
+    float setpointC;
+    uint8_t presetIndex;
+};
+
+/** @brief Where zone @p zone is read in each acquisition period (ms after zone 0). */
+uint16_t lab5PidZoneOffsetMs(uint8_t zone);
+
+/**
+ * @brief Set up the satellite NTC inputs (acquisition stage).
+ *
+ * The AdcEngine list is the acquisition stage's: slot z holds zone z's
+ * NTC, next to the pot in slot 0.
+ */
+void lab5PidZoneAcquisitionInit();
+
+/** @brief Read zone @p zone's NTC (AdcEngine slot, or analogRead()); never blocks. */
+void lab5PidZoneAcquire(uint8_t zone, Lab5PidSample *out);
+
+/** @brief Store a zone sample in the zone arrays (lock held); zone 0's too. */
+void lab5PidZoneAcquisitionStore(Lab5PidState *state, const Lab5PidSample &sample);
+
+/** @brief Configure the satellite PIDs and fans (control stage). */
+void lab5PidZoneControlInit();
+
+/** @brief Copy a satellite's setpoint and preset (lock held). */
+void lab5PidZoneTakeInputs(const Lab5PidState *state, uint8_t zone, Lab5PidZoneInputs *in);
+
+/**
+ * @brief PID update and fan duty for one satellite sample (no lock).
+ *
+ * dt runs from capture to capture; an invalid sample holds the demand
+ * for PID_INVALID_HOLD_MS (velocity form), then stops the fan.
+ */
+void lab5PidZoneCompute(const Lab5PidSample &sample, const Lab5PidZoneInputs &in);
+
+/** @brief Store a satellite's output and duty (lock held). */
+void lab5PidZoneStore(Lab5PidState *state, uint8_t zone);
+
+#endif // LAB5_2_ZONES > 1
+
+#endif // LAB5_2_ZONES_H
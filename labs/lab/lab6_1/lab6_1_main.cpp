@@ -16,7 +16,7 @@
  *   APP   -- lab6_1Setup() / lab6_1Loop()       (orchestration only)
  *   SRV   -- ButtonLedFsm                       (state table, transitions)
  *   ECAL  -- StdioSerial                        (printf -> UART)
- *   MCAL  -- Button (GPIO + debounce), Led      (GPIO write)
+ *   MCAL  -- Button (GPIO + debounce), FastLed  (compile-time GPIO write)
  *   HW    -- ATmega2560 GPIO peripherals
  *
  * No digitalRead/digitalWrite/Serial.* calls appear in this file: every
@@ -24,12 +24,23 @@
  *
  * Hardware Configuration:
  *   - MCU       : Arduino Mega 2560
- *   - Button    : digital pin 7, active-LOW (INPUT_PULLUP), debounce 30 ms
+ *   - Button    : digital pin 2 (INT4), active-LOW (INPUT_PULLUP), debounce 30 ms
  *   - LED       : digital pin 8, with 220 Ohm series resistor to ground
  *   - Serial    : UART0 at 9600 baud (USB-to-serial)
  *
- * The debounce window is comfortably below the 100 ms response budget
- * stated in the manual (RNF01).
+ * The button runs in interrupt mode: its edge ISR timestamps the raw
+ * edge and signals an event task, so a press is handled within one
+ * scheduler pass (leading-edge debounce, no polling latency) and the MCU
+ * sleeps in between. A slow periodic task settles the trailing edge of a
+ * bounce burst. If the pin has no interrupt the periodic task simply
+ * polls, as before. Either way the response stays well below the 100 ms
+ * budget stated in the manual (RNF01).
+ *
+ * With -DLATENCY_PROBE_ENABLED the press path is measured (LatencyProbe):
+ * edge ISR → press accepted (accept_us) → LED written (led_us), and the
+ * "lat" commands are read from the serial line. "lat loop 200 100" with
+ * D46 wired to the button pin and the LED pin wired to D48 measures the
+ * whole path, debounce included, in hardware (LatencyLoopback).
  */
 
 #include "lab6_1_main.h"
@@ -39,15 +50,19 @@
 
 #include "Button.h"
 #include "ButtonLedFsm.h"
-#include "Led.h"
+#include "FastLed.h"
 #include "StdioSerial.h"
+#include "TaskScheduler.h"
+#include "FlashString.h"
+#include "LatencyProbe.h"
 
 // ============================================================
 // Pin / configuration constants (single source of truth)
 // ============================================================
 
 /// GPIO pin connected to the push button (active-LOW with INPUT_PULLUP).
-static const uint8_t PIN_BUTTON = 7;
+/// D2 = INT4; D7 (used previously) has neither INTx nor PCINT on the Mega.
+static const uint8_t PIN_BUTTON = 2;
 
 /// GPIO pin driving the controlled LED (HIGH = on).
 static const uint8_t PIN_LED = 8;
@@ -59,21 +74,114 @@ static const unsigned long BAUD_RATE = 9600;
 static const uint16_t BUTTON_DEBOUNCE_MS = 30;
 
 /**
- * @brief Cooperative loop period (ms).
+ * @brief Button service period (ms) in interrupt mode.
  *
- * The loop polls the button at this cadence. With BUTTON_DEBOUNCE_MS = 30
- * and a poll period of 5 ms, the worst-case response from physical press
- * to confirmed FSM transition stays well under 100 ms.
+ * Only needed to accept the final level once a bounce burst has been
+ * quiet for BUTTON_DEBOUNCE_MS; presses themselves arrive as events.
  */
-static const uint16_t LOOP_TICK_MS = 5;
+static const uint16_t SERVICE_PERIOD_MS = BUTTON_DEBOUNCE_MS;
+
+/**
+ * @brief Button poll period (ms) without an interrupt-capable pin.
+ *
+ * With BUTTON_DEBOUNCE_MS = 30 and a poll period of 5 ms, the worst-case
+ * response from physical press to confirmed FSM transition stays well
+ * under 100 ms.
+ */
+static const uint16_t POLL_PERIOD_MS = 5;
+
+/// Event id of the button edge task.
+static const uint8_t EVENT_BUTTON = 0;
+
+#if defined(LATENCY_PROBE_ENABLED)
+/// Serial command poll period (ms); only with the latency probe.
+static const uint16_t COMMAND_PERIOD_MS = 50;
+#endif
 
 // ============================================================
 // Module-level driver instances
 // ============================================================
 
-static Button       button(PIN_BUTTON, /*activeLow=*/true, BUTTON_DEBOUNCE_MS);
-static Led          led(PIN_LED);
-static ButtonLedFsm fsm;
+static Button           button(PIN_BUTTON, /*activeLow=*/true, BUTTON_DEBOUNCE_MS);
+static FastLed<PIN_LED> led;
+static ButtonLedFsm     fsm;
+
+#if defined(LATENCY_PROBE_ENABLED)
+/// Press path: button edge (ISR time) → press accepted → LED written.
+static LatencyPath   s_pressPath;
+static PerfHistogram s_pressAcceptUs;
+static PerfHistogram s_pressLedUs;
+
+static const PerfDesc LATENCY[] PROGMEM = {
+    PERF_HISTOGRAM("accept_us", s_pressAcceptUs),
+    PERF_HISTOGRAM("led_us",    s_pressLedUs),
+};
+
+static const CommandEntry COMMANDS[] PROGMEM = { LATENCY_PROBE_COMMANDS };
+#endif
+
+// ============================================================
+// Tasks
+// ============================================================
+
+/**
+ * @brief Debounce the button, drive the FSM and apply its Moore output.
+ *
+ * Runs as the edge event task and as the periodic service/poll task.
+ */
+static void buttonTask() {
+    // Step 1 -- Read input (debounced) ---------------------------------
+    button.update();
+
+    // Step 2 -- Drive the FSM with confirmed press events --------------
+    if (button.wasPressed()) {
+        LATENCY_START_AT(s_pressPath, button.getLastEdgeUs());
+        LATENCY_STAGE(s_pressPath, s_pressAcceptUs);
+        fsm.processEvent();
+    }
+
+    // Step 3 -- Apply Moore output + report state changes --------------
+    if (fsm.changed()) {
+        led.set(fsm.getOutput() != 0);
+        LATENCY_END(s_pressPath, s_pressLedUs);
+        FLASH_PRINTF("[FSM] State -> %s (LED %s)\r\n",
+                     fsm.getStateName(),
+                     led.isOn() ? "ON" : "OFF");
+        fsm.clearChanged();
+    }
+}
+
+/// Edge callback, runs inside the button ISR.
+static void onButtonEdge() {
+    schedulerSignal(EVENT_BUTTON);
+}
+
+#if defined(LATENCY_PROBE_ENABLED)
+/// Serial commands: the "lat" set only.
+static void commandTask() {
+    char line[32];
+    if (stdioSerialPollLine(line, sizeof(line))) {
+        CommandStatus status = commandDispatch(COMMANDS, LATENCY_PROBE_COMMAND_COUNT, line, NULL);
+        if (status == COMMAND_NOT_FOUND || status == COMMAND_BAD_ARGS) {
+            FLASH_PRINTF("[ERROR] Commands: lat | lat clear | lat loop <period_ms> <hold_ms> | "
+                         "lat stop\r\n");
+        }
+    }
+}
+
+#define TASK_COUNT 2
+#else
+#define TASK_COUNT 1
+#endif
+
+static TaskContext_t s_tasks[TASK_COUNT] = {
+    { buttonTask, POLL_PERIOD_MS, 0 },
+#if defined(LATENCY_PROBE_ENABLED)
+    { commandTask, COMMAND_PERIOD_MS, 0 },
+#endif
+};
+
+static void (*const s_events[])() = { buttonTask };
 
 // ============================================================
 // Helpers
@@ -86,11 +194,11 @@ static ButtonLedFsm fsm;
  * on the user's own terminal, the deterministic behaviour of the FSM.
  */
 static void printFsmTable() {
-    printf("FSM state table (Moore, 2 states):\r\n");
-    printf("  Num | Name    | Out | In=0    | In=1    \r\n");
-    printf("  ----+---------+-----+---------+---------\r\n");
-    printf("  0   | LED_OFF |  0  | LED_OFF | LED_ON  \r\n");
-    printf("  1   | LED_ON  |  1  | LED_ON  | LED_OFF \r\n");
+    FLASH_PRINTF("FSM state table (Moore, 2 states):\r\n");
+    FLASH_PRINTF("  Num | Name    | Out | In=0    | In=1    \r\n");
+    FLASH_PRINTF("  ----+---------+-----+---------+---------\r\n");
+    FLASH_PRINTF("  0   | LED_OFF |  0  | LED_OFF | LED_ON  \r\n");
+    FLASH_PRINTF("  1   | LED_ON  |  1  | LED_ON  | LED_OFF \r\n");
 }
 
 // ============================================================
@@ -104,51 +212,52 @@ void lab6_1Setup() {
     // Initialize the hardware drivers (encapsulate all pinMode/digitalRead).
     button.init();
     led.init();
+    bool interruptMode = button.enableInterrupt(onButtonEdge);
+#if defined(LATENCY_PROBE_ENABLED)
+    latencyProbeInit(LATENCY, sizeof(LATENCY) / sizeof(LATENCY[0]));
+#endif
 
     // Reset the FSM to its initial state and apply the Moore output.
     fsm.init();
     led.set(fsm.getOutput() != 0);
 
-    printf("\r\n");
-    printf("========================================\r\n");
-    printf("  Lab 6.1: Button-LED Finite State       \r\n");
-    printf("           Machine (Moore, 2 states)    \r\n");
-    printf("  MCU: Arduino Mega 2560                 \r\n");
-    printf("========================================\r\n");
-    printf("Wiring:\r\n");
-    printf("  Button -> D%u (active-LOW, INPUT_PULLUP)\r\n", PIN_BUTTON);
-    printf("  LED    -> D%u (220 Ohm to GND)\r\n",            PIN_LED);
-    printf("Debounce window: %u ms\r\n", (unsigned)BUTTON_DEBOUNCE_MS);
-    printf("\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("  Lab 6.1: Button-LED Finite State       \r\n");
+    FLASH_PRINTF("           Machine (Moore, 2 states)    \r\n");
+    FLASH_PRINTF("  MCU: Arduino Mega 2560                 \r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("Wiring:\r\n");
+    FLASH_PRINTF("  Button -> D%u (active-LOW, INPUT_PULLUP)\r\n", PIN_BUTTON);
+    FLASH_PRINTF("  LED    -> D%u (220 Ohm to GND)\r\n",            PIN_LED);
+    FLASH_PRINTF("Debounce window: %u ms\r\n", (unsigned)BUTTON_DEBOUNCE_MS);
+    FLASH_PRINTF("Button input: %s\r\n",
+                 interruptMode ? "edge interrupt" : "polled (no interrupt on pin)");
+    FLASH_PRINTF("\r\n");
     printFsmTable();
-    printf("\r\n");
-    printf("[FSM] Initial state: %s\r\n", fsm.getStateName());
-    printf("Press the button to toggle the LED state.\r\n");
-    printf("\r\n");
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("[FSM] Initial state: %s\r\n", fsm.getStateName());
+    FLASH_PRINTF("Press the button to toggle the LED state.\r\n");
+#if defined(LATENCY_PROBE_ENABLED)
+    FLASH_PRINTF("Latency probe: lat | lat clear | lat loop <period_ms> <hold_ms> | lat stop\r\n");
+#endif
+    FLASH_PRINTF("\r\n");
 
     // The constructor sets _changed = true so the LED was synchronized
     // above; clear the flag to avoid re-printing on the first loop pass.
     fsm.clearChanged();
-}
 
-void lab6_1Loop() {
-    // Step 1 -- Read input (debounced) ---------------------------------
-    button.update();
-
-    // Step 2 -- Drive the FSM with confirmed press events --------------
-    if (button.wasPressed()) {
-        fsm.processEvent();
+    if (interruptMode) {
+        s_tasks[0].period = SERVICE_PERIOD_MS;
     }
+    schedulerInit(s_tasks, TASK_COUNT);
+    schedulerSetEvents(s_events, 1);
+}
 
-    // Step 3 -- Apply Moore output + report state changes --------------
-    if (fsm.changed()) {
-        led.set(fsm.getOutput() != 0);
-        printf("[FSM] State -> %s (LED %s)\r\n",
-               fsm.getStateName(),
-               led.isOn() ? "ON" : "OFF");
-        fsm.clearChanged();
+void lab6_1Loop() {
+    // Event task first (button edge), then the periodic service; sleep
+    // until the next deadline or interrupt when nothing is due.
+    if (!schedulerRun(s_tasks, TASK_COUNT)) {
+        schedulerIdle(s_tasks, TASK_COUNT);
     }
-
-    // Step 4 -- Cooperative wait so other software can share the CPU --
-    delay(LOOP_TICK_MS);
 }
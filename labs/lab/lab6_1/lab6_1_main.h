@@ -27,10 +27,11 @@ void lab6_1Setup();
 /**
  * @brief Periodic application step: drive button -> FSM -> LED -> STDIO.
  *
- * Each iteration polls the debounced Button driver, forwards confirmed
- * press edges to the FSM, applies the FSM's Moore output to the LED,
- * and prints a state-transition line to the serial terminal whenever
- * the state actually changes.
+ * Runs the button task when its edge interrupt signalled (or its
+ * service/poll period elapsed): debounces the Button driver, forwards
+ * confirmed press edges to the FSM, applies the FSM's Moore output to
+ * the LED, and prints a state-transition line to the serial terminal
+ * whenever the state actually changes. Sleeps when nothing is due.
  */
 void lab6_1Loop();
 
@@ -0,0 +1,69 @@
+/**
+ * @file lab7_1_config.h
+ * @brief Lab 7.1 — Gateway Configuration and Pin Mapping
+ *
+ * Centralizes the bus settings, pipeline limits and the aggregated
+ * frame timing of the Modbus RTU gateway. The poll table itself (which
+ * node registers are cached) is in lab7_1_main.cpp.
+ *
+ * Pin mapping (Arduino Mega 2560):
+ *   D0/D1   = USB serial to the PC (commands + aggregated frames)
+ *   D14/D15 = TX3 / RX3 to the RS-485 transceiver (DI / RO)
+ *   D26     = Transceiver DE and /RE (high while sending)
+ *   D27     = Sync pulse to the nodes (-DLAB7_1_SYNC_PULSE)
+ *
+ * The field nodes are the lab 3.2, 4 and 5.2 boards built with their
+ * -D<LAB>_MODBUS flag, wired on the same A/B pair (same 19200 8E1).
+ */
+
+#ifndef LAB7_1_CONFIG_H
+#define LAB7_1_CONFIG_H
+
+#include <Arduino.h>
+#include "ModbusMaster.h"
+
+// ── PC link ─────────────────────────────────────────────────────────
+// Faster than the other labs: one aggregated frame is ~120 bytes.
+static const uint32_t GATEWAY_PC_BAUD = 115200UL;
+
+// ── Modbus RTU master (USART3, see ModbusMaster.h) ──────────────────
+static const uint32_t     MODBUS_BAUD          = 19200UL;
+static const ModbusParity MODBUS_PARITY        = MODBUS_PARITY_EVEN;
+static const int8_t       PIN_MODBUS_DE        = 26;
+static const uint16_t     MODBUS_TIMEOUT_MS    = 50;    // Reply deadline after a request
+static const uint16_t     MODBUS_TIMEOUT_MIN_MS = 5;    // "timeout" command limits
+static const uint16_t     MODBUS_TIMEOUT_MAX_MS = 1000;
+
+// A row missing MODBUS_MISS_LIMIT replies in a row goes offline and is
+// probed once per MODBUS_HOLDOFF_CYCLES + 1 cycles until it answers.
+static const uint8_t MODBUS_MISS_LIMIT     = 3;
+static const uint8_t MODBUS_HOLDOFF_CYCLES = 10;
+
+// ── Aggregated frame (TelemetryFrame record) ────────────────────────
+static const uint8_t  GATEWAY_TELEMETRY_TYPE   = 0x71;
+static const uint16_t GATEWAY_FRAME_PERIOD_MS  = 250;   // Default; "rate <ms>", 0 = off
+static const uint16_t GATEWAY_FRAME_MIN_MS     = 50;
+
+#if defined(LAB7_1_TIME_SYNC)
+// ── Time sync broadcasts (-DLAB7_1_TIME_SYNC, TimeSync.h) ───────────
+// The nodes map their sample times onto this board's micros(); a
+// broadcast per second keeps them within a few µs of it (oscillator
+// drift is estimated, not just the offset).
+static const uint16_t TIME_SYNC_PERIOD_MS      = 1000;
+#endif
+
+#if defined(LAB7_1_SYNC_PULSE)
+// ── Sync pulse (-DLAB7_1_SYNC_PULSE) ────────────────────────────────
+// A rising edge per period on a line to every node's sync input (lab 3.2:
+// D18), releasing their acquisition at the same instant. The period is
+// the nodes' sampling period.
+static const uint8_t  PIN_SYNC_PULSE           = 27;
+static const uint32_t SYNC_PULSE_PERIOD_US     = 50000UL;   // Lab 3.2 Task 1
+static const uint16_t SYNC_PULSE_WIDTH_US      = 100;
+#endif
+
+// ── Cooperative tasks (TaskScheduler) ───────────────────────────────
+static const uint16_t TASK_COMMAND_PERIOD_MS   = 10;    // Serial commands
+static const uint16_t TASK_FRAME_PERIOD_MS     = 10;    // Frame deadline check
+
+#endif // LAB7_1_CONFIG_H
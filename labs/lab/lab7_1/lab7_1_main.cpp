@@ -0,0 +1,454 @@
+/**
+ * @file lab7_1_main.cpp
+ * @brief Lab 7.1 — Modbus RTU Gateway: Pipelined Polling + Aggregated Frames
+ *
+ * Polls the field nodes on the RS-485 bus and serves their latest values
+ * to the PC in one aggregated binary frame.
+ *
+ * ──────────────────────────────────────────────────────────────────────────
+ * System overview
+ * ──────────────────────────────────────────────────────────────────────────
+ *
+ *   loop() ── serviceBus()     every pass: link events → poller cache,
+ *          │                   next request → link queue
+ *          └─ schedulerRun() ─ Task 1 (10 ms) serial commands
+ *                              Task 2 (10 ms) aggregated frame when due
+ *
+ * The bus is pipelined: while a request is on the bus the next one is
+ * already built and queued in the link, which sends it t3.5 after the
+ * reply (or the timeout) with no loop() latency in between, and the
+ * previous reply is decoded meanwhile. One poll cycle costs the sum of its
+ * transactions, so it grows linearly with the rows of POLL_TABLE; a node
+ * that stops answering goes offline after MODBUS_MISS_LIMIT timeouts and
+ * then costs one timeout per MODBUS_HOLDOFF_CYCLES + 1 cycles.
+ *
+ * ──────────────────────────────────────────────────────────────────────────
+ * Aggregated frame (TelemetryFrame, type GATEWAY_TELEMETRY_TYPE)
+ * ──────────────────────────────────────────────────────────────────────────
+ *
+ * Little-endian. Header, 9 bytes:
+ *
+ *   off  type  field
+ *   0    u32   timeMs      millis() at send time
+ *   4    u16   cycles      completed poll cycles (wraps)
+ *   6    u16   cycleMs     duration of the last cycle
+ *   8    u8    rows        blocks that follow
+ *
+ * Then per POLL_TABLE row, 6 + 2n bytes:
+ *
+ *   0    u8    node        slave address
+ *   1    u8    function    0x03 holding / 0x04 input
+ *   2    u8    status      ModbusPollStatus (low nibble), last exception
+ *                          code (high nibble)
+ *   3    u8    n           registers that follow (0 until a first reply)
+ *   4    u16   ageMs       since the cached reply; 0xFFFF = none or older
+ *   6    u16×n registers   as the node encodes them (see its task_modbus.h)
+ *
+ * Text command replies are printed on the same port; the host drops them
+ * as frames failing the CRC.
+ *
+ * ──────────────────────────────────────────────────────────────────────────
+ * Shared timebase (-DLAB7_1_TIME_SYNC, -DLAB7_1_SYNC_PULSE)
+ * ──────────────────────────────────────────────────────────────────────────
+ *
+ * This board's micros() is the timebase of the bus. Every
+ * TIME_SYNC_PERIOD_MS a sync broadcast takes the place of one poll
+ * request; it carries the end time of the previous one, from which each
+ * node estimates its offset and drift (TimeSync.h) and reports its sample
+ * times in this board's micros() (lab 3.2: regs 22-23, polled by the
+ * extra row). The poller never sees the broadcasts.
+ *
+ * The sync pulse adds a rising edge on PIN_SYNC_PULSE every
+ * SYNC_PULSE_PERIOD_US, on a fixed grid: the nodes wired to it sample on
+ * the edge, all at the same instant.
+ */
+
+#include "lab7_1_main.h"
+#include "lab7_1_config.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "CommandParser.h"
+#include "ModbusMaster.h"
+#include "ModbusPoller.h"
+#include "StdioSerial.h"
+#include "TaskScheduler.h"
+#include "TelemetryFrame.h"
+#include "FlashString.h"
+#if defined(LAB7_1_TIME_SYNC)
+#include "TimeSync.h"
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Poll table
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * Register blocks polled, in round-robin order (register maps in each
+ * lab's task_modbus.h). Keep the aggregated frame within
+ * TELEMETRY_MAX_PAYLOAD: 9 + Σ (6 + 2n) bytes, checked at setup().
+ */
+static const ModbusPoll POLL_TABLE[] PROGMEM = {
+    { 3, MODBUS_FC_READ_INPUT,   0, 12 },   // Lab 3.2: temperatures, alert states
+    { 4, MODBUS_FC_READ_INPUT,   0, 5  },   // Lab 4: relay, PWM, overload
+    { 4, MODBUS_FC_READ_HOLDING, 0, 2  },   // Lab 4: relay / PWM commands
+    { 5, MODBUS_FC_READ_INPUT,   0, 14 },   // Lab 5.2: loop state
+    { 5, MODBUS_FC_READ_HOLDING, 0, 6  },   // Lab 5.2: setpoint, source, preset, gains
+#if defined(LAB7_1_TIME_SYNC)
+    { 3, MODBUS_FC_READ_INPUT,   22, 4 },   // Lab 3.2: sample time (our µs), sync state, drift
+#endif
+};
+static const uint8_t POLL_COUNT = sizeof(POLL_TABLE) / sizeof(POLL_TABLE[0]);
+
+static ModbusPollCache s_cache[POLL_COUNT];
+static ModbusPoller    s_poller;
+
+/** Period of the aggregated frame in ms, 0 = off ("rate"). */
+static uint16_t s_framePeriodMs = GATEWAY_FRAME_PERIOD_MS;
+static uint32_t s_lastFrameMs = 0;
+
+static const char *const POLL_STATUS_NAMES[] = {
+    "never", "ok", "timeout", "bad", "except", "offline"
+};
+
+#if defined(LAB7_1_TIME_SYNC)
+static TimeSyncMaster s_sync;
+static uint32_t       s_lastSyncMs = 0;
+#endif
+
+#if defined(LAB7_1_SYNC_PULSE)
+static uint32_t s_pulseDueUs = 0;      ///< Rising edge of the current / next pulse.
+static bool     s_pulseHigh = false;
+static uint32_t s_pulses = 0;
+static uint16_t s_pulsesLate = 0;      ///< Edges a whole period late (grid restarted).
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Bus service (every loop() pass)
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @brief Feed the link's outcome to the poller, then keep its queue full.
+ *
+ * The outcome always belongs to the oldest request in flight; the next
+ * request is built while the current one is on the bus. A sync broadcast
+ * due takes the queue instead of the next poll request.
+ */
+static void serviceBus() {
+    const uint8_t *reply;
+    uint8_t len;
+    switch (modbusMasterService(&reply, &len)) {
+    case MODBUS_MASTER_REPLY:
+        modbusPollerReply(&s_poller, reply, len, millis());
+        break;
+    case MODBUS_MASTER_CORRUPT:
+        modbusPollerReply(&s_poller, NULL, 0, millis());
+        break;
+    case MODBUS_MASTER_TIMEOUT:
+        modbusPollerTimeout(&s_poller);
+        break;
+    default:
+        break;
+    }
+
+#if defined(LAB7_1_TIME_SYNC)
+    uint32_t endUs;
+    if (modbusMasterBroadcastDone(&endUs)) {
+        timeSyncMasterSent(&s_sync, endUs);     // Carried by the next broadcast
+    }
+    if (modbusMasterCanQueue() && (uint32_t)(millis() - s_lastSyncMs) >= TIME_SYNC_PERIOD_MS) {
+        uint8_t sync[TIME_SYNC_FRAME_LEN];
+        s_lastSyncMs = millis();
+        modbusMasterQueue(sync, timeSyncMasterBuild(&s_sync, sync));
+        return;
+    }
+#endif
+
+    if (modbusMasterCanQueue()) {
+        uint8_t request[8];
+        uint8_t n = modbusPollerNext(&s_poller, micros(), request);
+        if (n > 0) {
+            modbusMasterQueue(request, n);
+        }
+    }
+}
+
+#if defined(LAB7_1_SYNC_PULSE)
+/**
+ * @brief Raise the sync line on each grid point, drop it after the width.
+ *
+ * The edges stay on the grid whatever the loop latency; a pass a whole
+ * period late restarts the grid instead of sending the missed edges.
+ */
+static void servicePulse() {
+    uint32_t now = micros();
+    if (s_pulseHigh) {
+        if ((uint32_t)(now - s_pulseDueUs) >= SYNC_PULSE_WIDTH_US) {
+            digitalWrite(PIN_SYNC_PULSE, LOW);
+            s_pulseHigh = false;
+            s_pulseDueUs += SYNC_PULSE_PERIOD_US;
+        }
+    } else if ((int32_t)(now - s_pulseDueUs) >= 0) {
+        digitalWrite(PIN_SYNC_PULSE, HIGH);
+        s_pulseHigh = true;
+        s_pulses++;
+        if ((uint32_t)(now - s_pulseDueUs) >= SYNC_PULSE_PERIOD_US) {
+            s_pulseDueUs = now;
+            s_pulsesLate++;
+        }
+    }
+}
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Aggregated frame
+// ──────────────────────────────────────────────────────────────────────────
+
+static uint8_t put16(uint8_t *p, uint8_t at, uint16_t v) {
+    p[at] = (uint8_t)v;
+    p[at + 1] = (uint8_t)(v >> 8);
+    return (uint8_t)(at + 2);
+}
+
+/** @brief Payload bytes of a frame with every row cached (the largest). */
+static uint16_t framePayloadMax() {
+    uint16_t size = 9;
+    for (uint8_t row = 0; row < POLL_COUNT; row++) {
+        size += 6 + 2 * modbusPollerRow(&s_poller, row).count;
+    }
+    return size;
+}
+
+/** @brief Build and send one aggregated frame from the cache. */
+static void sendFrame() {
+    static uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    uint32_t now = millis();
+    uint32_t cycleMs = s_poller.stats.lastCycleUs / 1000UL;
+
+    memcpy(&payload[0], &now, sizeof(now));
+    uint8_t at = put16(payload, 4, s_poller.stats.cycles);
+    at = put16(payload, at, (uint16_t)((cycleMs > 0xFFFFUL) ? 0xFFFFUL : cycleMs));
+    payload[at++] = POLL_COUNT;
+
+    for (uint8_t row = 0; row < POLL_COUNT; row++) {
+        ModbusPoll poll = modbusPollerRow(&s_poller, row);
+        const ModbusPollCache &c = s_cache[row];
+        uint8_t n = c.valid ? poll.count : 0;
+        if (at + 6 + 2 * n > TELEMETRY_MAX_PAYLOAD) {
+            break;                      // Reported by setup(); send what fits
+        }
+        uint32_t age = modbusPollerAgeMs(&s_poller, row, now);
+        payload[at++] = poll.node;
+        payload[at++] = poll.function;
+        payload[at++] = (uint8_t)((c.status & 0x0F) | (c.exception << 4));
+        payload[at++] = n;
+        at = put16(payload, at, (uint16_t)((age > 0xFFFFUL) ? 0xFFFFUL : age));
+        for (uint8_t i = 0; i < n; i++) {
+            at = put16(payload, at, c.regs[i]);
+        }
+    }
+    telemetrySend(GATEWAY_TELEMETRY_TYPE, payload, at);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Serial commands
+// ──────────────────────────────────────────────────────────────────────────
+
+static void printHelp() {
+    FLASH_PRINTF("Commands: nodes | stats | rate <ms> (0 = off) | timeout <ms> | help\r\n");
+}
+
+static void onNodes(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    uint32_t now = millis();
+    FLASH_PRINTF("[NODES] row node fn reg   n  status   age_ms  ok    tmo   err\r\n");
+    for (uint8_t row = 0; row < POLL_COUNT; row++) {
+        ModbusPoll poll = modbusPollerRow(&s_poller, row);
+        const ModbusPollCache &c = s_cache[row];
+        uint32_t age = modbusPollerAgeMs(&s_poller, row, now);
+        FLASH_PRINTF("[NODES] %-3u %-4u %02X %-5u %-2u %-8s %-7ld %-5u %-5u %u\r\n",
+                     (unsigned)row, (unsigned)poll.node, (unsigned)poll.function,
+                     (unsigned)poll.start, (unsigned)poll.count,
+                     c.status < 6 ? POLL_STATUS_NAMES[c.status] : "?",
+                     c.valid ? (long)age : -1L,
+                     (unsigned)c.replies, (unsigned)c.timeouts, (unsigned)c.errors);
+    }
+}
+
+static void onStats(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    ModbusMasterStats link = modbusMasterStats();
+    FLASH_PRINTF("[STATS] cycles %u, last %lu us, worst %lu us (%u rows)\r\n",
+                 (unsigned)s_poller.stats.cycles, (unsigned long)s_poller.stats.lastCycleUs,
+                 (unsigned long)s_poller.stats.worstCycleUs, (unsigned)POLL_COUNT);
+    FLASH_PRINTF("[STATS] link: %u requests, %u replies, %u timeouts, %u stray bytes\r\n",
+                 (unsigned)link.requests, (unsigned)link.replies, (unsigned)link.timeouts,
+                 (unsigned)link.stray);
+    FLASH_PRINTF("[STATS] frames every %u ms, %lu dropped; timeout %u ms\r\n",
+                 (unsigned)s_framePeriodMs, (unsigned long)telemetryGetDropped(),
+                 (unsigned)modbusMasterGetTimeout());
+#if defined(LAB7_1_TIME_SYNC)
+    FLASH_PRINTF("[STATS] time sync: %u broadcasts every %u ms (%u sent by the link)\r\n",
+                 (unsigned)s_sync.broadcasts, (unsigned)TIME_SYNC_PERIOD_MS,
+                 (unsigned)link.broadcasts);
+#endif
+#if defined(LAB7_1_SYNC_PULSE)
+    FLASH_PRINTF("[STATS] sync pulse: %lu edges every %lu us, %u late\r\n",
+                 (unsigned long)s_pulses, (unsigned long)SYNC_PULSE_PERIOD_US,
+                 (unsigned)s_pulsesLate);
+#endif
+}
+
+static void onRate(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    int32_t ms = args[0].i;
+    if (ms != 0 && (ms < GATEWAY_FRAME_MIN_MS || ms > 60000L)) {
+        FLASH_PRINTF("[ERROR] rate: 0 or %u..60000 ms\r\n", (unsigned)GATEWAY_FRAME_MIN_MS);
+        return;
+    }
+    s_framePeriodMs = (uint16_t)ms;
+    FLASH_PRINTF("[GATEWAY] Frames %s%ld ms\r\n", ms == 0 ? "off, " : "every ", (long)ms);
+}
+
+static void onTimeout(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    int32_t ms = args[0].i;
+    if (ms < MODBUS_TIMEOUT_MIN_MS || ms > MODBUS_TIMEOUT_MAX_MS) {
+        FLASH_PRINTF("[ERROR] timeout: %u..%u ms\r\n",
+                     (unsigned)MODBUS_TIMEOUT_MIN_MS, (unsigned)MODBUS_TIMEOUT_MAX_MS);
+        return;
+    }
+    modbusMasterSetTimeout((uint16_t)ms);
+    FLASH_PRINTF("[GATEWAY] Reply timeout %ld ms\r\n", (long)ms);
+}
+
+static void onHelp(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    printHelp();
+}
+
+static const CommandEntry COMMANDS[] PROGMEM = {
+    COMMAND_ENTRY("nodes",   onNodes,   ""),
+    COMMAND_ENTRY("stats",   onStats,   ""),
+    COMMAND_ENTRY("rate",    onRate,    "i"),
+    COMMAND_ENTRY("timeout", onTimeout, "i"),
+    COMMAND_ENTRY("help",    onHelp,    "")
+};
+
+static CommandStream s_cli;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Tasks
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Task 1 — feed pending serial input to the command parser. */
+static void task1Commands() {
+    int c;
+    while ((c = stdioSerialPollChar()) >= 0) {
+        CommandStatus status = commandStreamFeed(&s_cli, (char)c);
+        if (status == COMMAND_NOT_FOUND || status == COMMAND_BAD_ARGS) {
+            FLASH_PRINTF("[ERROR] Unknown command. ");
+            printHelp();
+        }
+    }
+}
+
+/** @brief Task 2 — send the aggregated frame when its period is due. */
+static void task2Frame() {
+    if (s_framePeriodMs == 0) {
+        return;
+    }
+    uint32_t now = millis();
+    if ((uint32_t)(now - s_lastFrameMs) < s_framePeriodMs) {
+        return;
+    }
+    s_lastFrameMs = now;
+    sendFrame();
+}
+
+static TaskContext_t s_tasks[] = {
+    { task1Commands, TASK_COMMAND_PERIOD_MS, 0 },   /**< Task 1: commands, 10 ms */
+    { task2Frame,    TASK_FRAME_PERIOD_MS,   5 },   /**< Task 2: frame check, 10 ms */
+};
+
+static const uint8_t TASK_COUNT = sizeof(s_tasks) / sizeof(s_tasks[0]);
+
+// ──────────────────────────────────────────────────────────────────────────
+// Lab 7.1 public entry points
+// ──────────────────────────────────────────────────────────────────────────
+
+void lab7_1Setup() {
+    stdioSerialInit(GATEWAY_PC_BAUD);
+
+    modbusPollerInit(&s_poller, POLL_TABLE, s_cache, POLL_COUNT,
+                     MODBUS_MISS_LIMIT, MODBUS_HOLDOFF_CYCLES);
+#if defined(LAB7_1_TIME_SYNC)
+    timeSyncMasterInit(&s_sync);
+#endif
+#if defined(LAB7_1_SYNC_PULSE)
+    pinMode(PIN_SYNC_PULSE, OUTPUT);
+    digitalWrite(PIN_SYNC_PULSE, LOW);
+#endif
+    commandStreamInit(&s_cli, COMMANDS, sizeof(COMMANDS) / sizeof(COMMANDS[0]), NULL);
+
+    FLASH_PRINTF("\r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("  Lab 7.1 — Modbus RTU Gateway          \r\n");
+    FLASH_PRINTF("  Pipelined multi-node polling          \r\n");
+    FLASH_PRINTF("========================================\r\n");
+    FLASH_PRINTF("Bus: USART%u %lu baud 8E1, RS-485 DE D%d, timeout %u ms\r\n",
+                 (unsigned)MODBUS_MASTER_USART, (unsigned long)MODBUS_BAUD,
+                 (int)PIN_MODBUS_DE, (unsigned)MODBUS_TIMEOUT_MS);
+    for (uint8_t row = 0; row < POLL_COUNT; row++) {
+        ModbusPoll poll = modbusPollerRow(&s_poller, row);
+        FLASH_PRINTF("  Row %u: node %u fn %02X regs %u..%u\r\n",
+                     (unsigned)row, (unsigned)poll.node, (unsigned)poll.function,
+                     (unsigned)poll.start, (unsigned)(poll.start + poll.count - 1));
+    }
+    FLASH_PRINTF("Frames: type 0x%02X every %u ms\r\n",
+                 (unsigned)GATEWAY_TELEMETRY_TYPE, (unsigned)s_framePeriodMs);
+#if defined(LAB7_1_TIME_SYNC)
+    FLASH_PRINTF("Time sync: broadcast every %u ms, timebase = this board's micros()\r\n",
+                 (unsigned)TIME_SYNC_PERIOD_MS);
+#endif
+#if defined(LAB7_1_SYNC_PULSE)
+    FLASH_PRINTF("Sync pulse: D%u, %lu us every %lu us\r\n", (unsigned)PIN_SYNC_PULSE,
+                 (unsigned long)SYNC_PULSE_WIDTH_US, (unsigned long)SYNC_PULSE_PERIOD_US);
+#endif
+    printHelp();
+    FLASH_PRINTF("========================================\r\n\r\n");
+
+    if (framePayloadMax() > TELEMETRY_MAX_PAYLOAD) {
+        FLASH_PRINTF("[ERROR] Aggregated frame needs %u bytes, TELEMETRY_MAX_PAYLOAD is %u\r\n",
+                     (unsigned)framePayloadMax(), (unsigned)TELEMETRY_MAX_PAYLOAD);
+    }
+    if (!modbusMasterBegin(MODBUS_BAUD, MODBUS_PARITY, PIN_MODBUS_DE, MODBUS_TIMEOUT_MS)) {
+        FLASH_PRINTF("[ERROR] Modbus: %lu baud not available on USART%u\r\n",
+                     (unsigned long)MODBUS_BAUD, (unsigned)MODBUS_MASTER_USART);
+    }
+
+    schedulerInit(s_tasks, TASK_COUNT);
+#if defined(LAB7_1_SYNC_PULSE)
+    s_pulseDueUs = micros();
+#endif
+}
+
+void lab7_1Loop() {
+    serviceBus();
+#if defined(LAB7_1_SYNC_PULSE)
+    servicePulse();
+#endif
+    // No schedulerIdle(): sleeping to the next millis() tick would delay
+    // each turnaround and timeout by up to 1 ms.
+    schedulerRun(s_tasks, TASK_COUNT);
+}
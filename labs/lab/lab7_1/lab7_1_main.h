@@ -0,0 +1,39 @@
+/**
+ * @file lab7_1_main.h
+ * @brief Lab 7.1 Entry Point Interface
+ *
+ * Declares the setup and loop functions for Laboratory Work 7.1:
+ * "Modbus RTU Gateway — Multi-Node Aggregation over a Shared RS-485 Bus".
+ *
+ * One Mega acts as the bus master for the field nodes (labs 3.2, 4 and
+ * 5.2 built as Modbus slaves). It polls their register blocks in a
+ * pipelined round robin (ModbusPoller + ModbusMaster), caches the latest
+ * values of each block with their age, and serves them to the PC over
+ * USB serial:
+ *
+ *   - one aggregated binary record per frame period (TelemetryFrame,
+ *     type GATEWAY_TELEMETRY_TYPE) with every block, its status and age;
+ *   - text commands (CommandParser): "nodes", "stats", "rate <ms>",
+ *     "timeout <ms>", "help".
+ *
+ * Bare-metal: the bus link is serviced on every loop() pass, the
+ * command and frame tasks run from the TaskScheduler.
+ */
+
+#ifndef LAB7_1_MAIN_H
+#define LAB7_1_MAIN_H
+
+/**
+ * @brief Initialize the PC serial link, the bus master, the poller and
+ *        the cooperative tasks, and print the startup banner.
+ */
+void lab7_1Setup();
+
+/**
+ * @brief Service the bus (replies, timeouts, next request), then run at
+ *        most one due task. Never sleeps: the turnaround and timeouts
+ *        are timed with micros() here.
+ */
+void lab7_1Loop();
+
+#endif // LAB7_1_MAIN_H
@@ -0,0 +1,149 @@
+/**
+ * @file AcquisitionScheduler.cpp
+ * @brief Acquisition scheduler implementation.
+ */
+
+#include "AcquisitionScheduler.h"
+
+AcquisitionScheduler::AcquisitionScheduler(uint16_t periodMs, uint16_t guardMs)
+    : _periodMs(periodMs > 0 ? periodMs : 1),
+      _guardMs(guardMs),
+      _cycle(0),
+      _count(0) {
+}
+
+int8_t AcquisitionScheduler::addSource(uint16_t latencyMs, uint16_t minIntervalMs) {
+    if (_count >= ACQ_SCHEDULER_MAX_SOURCES) {
+        return -1;
+    }
+    Source &s = _sources[_count];
+    s.latencyMs = latencyMs;
+    s.minIntervalMs = minIntervalMs;
+    s.nextRequest = _cycle + 1;
+    s.due = 0;
+    s.pending = false;
+    plan(s);
+    return (int8_t)_count++;
+}
+
+void AcquisitionScheduler::plan(Source &s) {
+    uint32_t ready = (uint32_t)s.latencyMs + _guardMs;
+    uint32_t lead = (ready + _periodMs - 1) / _periodMs;
+    if (lead == 0) {
+        lead = 1;   // Collected at the next release at the earliest
+    }
+    uint32_t spacing = ((uint32_t)s.minIntervalMs + _periodMs - 1) / _periodMs;
+    s.lead = (uint16_t)lead;
+    s.offsetMs = (uint16_t)(lead * _periodMs - ready);
+    s.every = (uint16_t)(spacing > lead ? spacing : lead);
+}
+
+void AcquisitionScheduler::setLatency(uint8_t source, uint16_t latencyMs) {
+    if (source >= _count || _sources[source].latencyMs == latencyMs) {
+        return;
+    }
+    _sources[source].latencyMs = latencyMs;
+    plan(_sources[source]);
+}
+
+void AcquisitionScheduler::setMinInterval(uint8_t source, uint16_t minIntervalMs) {
+    if (source >= _count || _sources[source].minIntervalMs == minIntervalMs) {
+        return;
+    }
+    Source &s = _sources[source];
+    uint32_t last = s.nextRequest - s.every;
+    s.minIntervalMs = minIntervalMs;
+    plan(s);
+    s.nextRequest = last + s.every;
+}
+
+void AcquisitionScheduler::markRequested(uint8_t source) {
+    if (source >= _count) {
+        return;
+    }
+    Source &s = _sources[source];
+    s.pending = true;
+    s.due = _cycle + s.lead;
+    s.nextRequest = _cycle + s.every;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Per cycle
+// ──────────────────────────────────────────────────────────────────────────
+
+bool AcquisitionScheduler::reached(uint32_t cycle) const {
+    return (int32_t)(_cycle - cycle) >= 0;
+}
+
+void AcquisitionScheduler::beginCycle() {
+    _cycle++;
+}
+
+bool AcquisitionScheduler::collect(uint8_t source) {
+    if (source >= _count) {
+        return false;
+    }
+    Source &s = _sources[source];
+    if (!s.pending || !reached(s.due)) {
+        return false;
+    }
+    s.pending = false;
+    return true;
+}
+
+void AcquisitionScheduler::postpone(uint8_t source) {
+    if (source >= _count) {
+        return;
+    }
+    Source &s = _sources[source];
+    s.pending = true;
+    s.due = _cycle + 1;
+}
+
+bool AcquisitionScheduler::nextRequest(uint8_t *source, uint16_t *offsetMs) {
+    int8_t best = -1;
+    for (uint8_t i = 0; i < _count; i++) {
+        const Source &s = _sources[i];
+        if (s.pending || !reached(s.nextRequest)) {
+            continue;
+        }
+        if (best < 0 || s.offsetMs < _sources[best].offsetMs) {
+            best = (int8_t)i;
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+
+    Source &s = _sources[best];
+    s.pending = true;
+    s.due = _cycle + s.lead;
+    s.nextRequest = _cycle + s.every;
+    *source = (uint8_t)best;
+    *offsetMs = s.offsetMs;
+    return true;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Accessors
+// ──────────────────────────────────────────────────────────────────────────
+
+uint16_t AcquisitionScheduler::getLeadPeriods(uint8_t source) const {
+    return source < _count ? _sources[source].lead : 0;
+}
+
+uint16_t AcquisitionScheduler::getOffsetMs(uint8_t source) const {
+    return source < _count ? _sources[source].offsetMs : 0;
+}
+
+uint16_t AcquisitionScheduler::getEveryPeriods(uint8_t source) const {
+    return source < _count ? _sources[source].every : 0;
+}
+
+uint32_t AcquisitionScheduler::getCycle() const {
+    return _cycle;
+}
+
+uint8_t AcquisitionScheduler::getSourceCount() const {
+    return _count;
+}
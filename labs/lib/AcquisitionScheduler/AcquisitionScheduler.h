@@ -0,0 +1,167 @@
+/**
+ * @file AcquisitionScheduler.h
+ * @brief Latency-Aware Request Timing for a Periodic Multi-Sensor Acquisition Task
+ *
+ * A periodic acquisition task reads its fast sensors (the ADC) at every
+ * release, but a slow sensor needs a request and then a wait: a DS18B20
+ * converts for 94–750 ms depending on resolution, and a DHT must not be
+ * read more often than every 1–2 s. Requested right after each read, the
+ * result becomes ready somewhere inside a later period and waits there
+ * for the next release, so its age in the sample set is whatever was
+ * left of that period; and any work done before the request (the NTC,
+ * the scratchpad read itself) pushes the deadline past a release and
+ * costs a whole period.
+ *
+ * The scheduler works backwards from the release instead. For each
+ * source it places the request so the result is ready guardMs before the
+ * release that collects it:
+ *
+ *   lead   = ceil((latency + guard) / period)        periods from request to result
+ *   offset = lead × period − (latency + guard)       request time after its release
+ *   every  = max(lead, ceil(minInterval / period))   periods between results
+ *
+ *   release   0          1          2          3          4
+ *             │  offset  │          │          │          │
+ *             ├────▶ request ─────── latency ───────▶│guard│ collect
+ *
+ * Every release then yields one complete sample set: the fast sensors
+ * read now, each slow one refreshed every `every` periods at the same
+ * small age (the guard, plus up to one tick of early request).
+ *
+ * Time is counted in periods: beginCycle() once per release. The task
+ * reads the sources collect() reports due, queues the sample, then
+ * issues the requests nextRequest() hands out, sleeping to each offset
+ * with RtosPeriod::waitOffset(), which wakes no later than asked. One
+ * request per source is outstanding at a time; a source that changes its
+ * latency (DS18B20 resolution) calls setLatency() before its next
+ * request.
+ *
+ * Pure bookkeeping: no clock, no I/O, so it runs natively in tests.
+ *
+ * Usage (in the acquisition task):
+ *   AcquisitionScheduler sched(TASK_ACQUISITION_PERIOD_MS, ACQ_GUARD_MS);
+ *   int8_t ds = sched.addSource(ds18b20.getConversionTimeMs());
+ *   for (;;) {
+ *       period.wait();
+ *       sched.beginCycle();
+ *       ...read the ADC...
+ *       if (sched.collect(ds) && !ds18b20.readConversion()) {
+ *           sched.postpone(ds);                // not ready yet: next release
+ *       }
+ *       ...queue the sample...
+ *       uint8_t source;
+ *       uint16_t offsetMs;
+ *       while (sched.nextRequest(&source, &offsetMs)) {
+ *           period.waitOffset(offsetMs);
+ *           ds18b20.requestConversion();
+ *       }
+ *   }
+ */
+
+#ifndef ACQUISITION_SCHEDULER_H
+#define ACQUISITION_SCHEDULER_H
+
+#include <Arduino.h>
+
+/** @brief Sources one scheduler holds. */
+#ifndef ACQ_SCHEDULER_MAX_SOURCES
+#define ACQ_SCHEDULER_MAX_SOURCES 4
+#endif
+
+class AcquisitionScheduler {
+public:
+    /**
+     * @param periodMs Release period of the acquisition task (> 0).
+     * @param guardMs  Margin between a result's deadline and the release
+     *                 that collects it (millis() granularity, clock skew).
+     */
+    AcquisitionScheduler(uint16_t periodMs, uint16_t guardMs = 0);
+
+    /**
+     * @brief Register a source; its first request goes in the first cycle.
+     *
+     * @param latencyMs     Request to result (conversion time).
+     * @param minIntervalMs Least time between two requests (0: none).
+     * @return Source index, or -1 if ACQ_SCHEDULER_MAX_SOURCES are in use.
+     */
+    int8_t addSource(uint16_t latencyMs, uint16_t minIntervalMs = 0);
+
+    /** @brief New latency for the next request (e.g. another resolution). */
+    void setLatency(uint8_t source, uint16_t latencyMs);
+
+    /**
+     * @brief New least time between two requests (0: none).
+     *
+     * The next request moves to the last one plus the new spacing; when
+     * that has passed, it goes out this cycle.
+     */
+    void setMinInterval(uint8_t source, uint16_t minIntervalMs);
+
+    /**
+     * @brief Record a request issued before the first beginCycle() (setup()).
+     *
+     * Its result is collected lead periods in, the next request follows.
+     */
+    void markRequested(uint8_t source);
+
+    /** @brief Start the next cycle; call once right after each release. */
+    void beginCycle();
+
+    /**
+     * @brief True once per request, in the cycle its result is ready.
+     *
+     * Read the source then; if it was not ready after all, postpone().
+     */
+    bool collect(uint8_t source);
+
+    /** @brief Collect the outstanding result again next cycle. */
+    void postpone(uint8_t source);
+
+    /**
+     * @brief Next request to issue this cycle, earliest offset first.
+     *
+     * Marks it issued, so each call returns another source until none is
+     * left. A source whose result has not been collected is skipped.
+     *
+     * @param source   Receives the source index.
+     * @param offsetMs Receives the request time after this cycle's release.
+     * @return False when no request is left this cycle.
+     */
+    bool nextRequest(uint8_t *source, uint16_t *offsetMs);
+
+    /** @name Schedule of a source (see the file comment) */
+    ///@{
+    uint16_t getLeadPeriods(uint8_t source) const;
+    uint16_t getOffsetMs(uint8_t source) const;
+    uint16_t getEveryPeriods(uint8_t source) const;
+    ///@}
+
+    /** @brief Cycles begun (0 before the first release). */
+    uint32_t getCycle() const;
+
+    /** @brief Sources registered. */
+    uint8_t getSourceCount() const;
+
+private:
+    struct Source {
+        uint16_t latencyMs;
+        uint16_t minIntervalMs;
+        uint16_t lead;
+        uint16_t offsetMs;
+        uint16_t every;
+        uint32_t nextRequest;   // Cycle of the next request
+        uint32_t due;           // Cycle the outstanding result is ready
+        bool     pending;       // A request awaits collect()
+    };
+
+    void plan(Source &s);
+    bool reached(uint32_t cycle) const;
+
+    uint16_t _periodMs;
+    uint16_t _guardMs;
+    uint32_t _cycle;
+    uint8_t  _count;
+    Source   _sources[ACQ_SCHEDULER_MAX_SOURCES];
+};
+
+#endif // ACQUISITION_SCHEDULER_H
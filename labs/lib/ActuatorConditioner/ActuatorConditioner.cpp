@@ -11,6 +11,9 @@ ActuatorConditioner::ActuatorConditioner(uint8_t medianWindow, float ewmaAlpha,
                                          float maxRampStep)
     : _conditioner(medianWindow, ewmaAlpha, minClamp, maxClamp),
       _maxRampStep(maxRampStep),
+      _rampRate(0.0f),
+      _rampAccel(0.0f),
+      _rampVelocity(0.0f),
       _rampedOutput(0.0f),
       _conditionedTarget(0.0f),
       _initialized(false) {}
@@ -24,19 +27,39 @@ float ActuatorConditioner::process(float rawCommand) {
         _rampedOutput = _conditionedTarget;
         _initialized = true;
     } else {
-        float diff = _conditionedTarget - _rampedOutput;
-        if (diff > _maxRampStep) {
-            _rampedOutput += _maxRampStep;
-        } else if (diff < -_maxRampStep) {
-            _rampedOutput -= _maxRampStep;
-        } else {
-            _rampedOutput = _conditionedTarget;
-        }
+        _rampedOutput = actuatorRampStep(_rampedOutput, _conditionedTarget,
+                                         _maxRampStep);
     }
 
     return _rampedOutput;
 }
 
+float ActuatorConditioner::process(float rawCommand, float dtSeconds) {
+    if (_rampRate <= 0.0f) {
+        return process(rawCommand);  // No rate set: per-call step
+    }
+
+    _conditionedTarget = _conditioner.process(rawCommand);
+    if (!_initialized) {
+        _rampedOutput = _conditionedTarget;
+        _rampVelocity = 0.0f;
+        _initialized = true;
+    } else {
+        _rampedOutput = actuatorSlewStep(_rampedOutput, _conditionedTarget, dtSeconds,
+                                         _rampRate, _rampAccel, &_rampVelocity);
+    }
+    return _rampedOutput;
+}
+
+void ActuatorConditioner::setRampRate(float unitsPerSecond, float unitsPerSecond2) {
+    _rampRate = (unitsPerSecond > 0.0f) ? unitsPerSecond : 0.0f;
+    _rampAccel = (unitsPerSecond2 > 0.0f) ? unitsPerSecond2 : 0.0f;
+}
+
+float ActuatorConditioner::getRampVelocity() const {
+    return _rampVelocity;
+}
+
 float ActuatorConditioner::getRampedOutput() const {
     return _rampedOutput;
 }
@@ -49,9 +72,22 @@ const SignalConditioner& ActuatorConditioner::getSignalConditioner() const {
     return _conditioner;
 }
 
+float ActuatorConditioner::force(float value) {
+    // Fill the median window so no older command survives in it.
+    _conditioner.reset();
+    for (uint8_t i = 0; i < _conditioner.getWindowSize(); i++) {
+        _conditionedTarget = _conditioner.process(value);
+    }
+    _rampedOutput = _conditionedTarget;
+    _rampVelocity = 0.0f;
+    _initialized = true;
+    return _rampedOutput;
+}
+
 void ActuatorConditioner::reset() {
     _conditioner.reset();
     _rampedOutput = 0.0f;
     _conditionedTarget = 0.0f;
+    _rampVelocity = 0.0f;
     _initialized = false;
 }
@@ -11,15 +11,102 @@
  * The first three stages reuse the SignalConditioner library.
  * The ramping stage is added on top to produce smooth transitions.
  *
+ * Ramping is either per call (maxRampStep per process(), the original
+ * behaviour) or, after setRampRate(), per second of measured time: pass
+ * the elapsed dt to process(raw, dt) and a late or shortened cycle moves
+ * the output by exactly rate × dt. With an acceleration limit the rate
+ * itself ramps up and is braked in time to stop on the target, so a step
+ * becomes an S-curve (no velocity jumps on the actuator):
+ *
+ *   linear      ____/‾‾‾‾      S-curve     ____⌒‾‾‾‾
+ *                  (constant rate)            (accelerate, cruise, brake)
+ *
+ * force() is the priority path (emergency stop): the output takes the
+ * value at once, and the median window, EWMA and ramp are refilled with
+ * it so the next process() continues from there instead of easing the
+ * filters' old history back in.
+ *
+ * StaticActuatorConditioner<N> is the same pipeline built on
+ * StaticSignalConditioner<N>, sized exactly for an N-sample window.
+ *
  * Usage:
  *   ActuatorConditioner cond(5, 0.4, 0.0, 100.0, 5.0);
  *   float output = cond.process(targetDuty);  // call at fixed rate
+ *
+ *   cond.setRampRate(50.0f, 200.0f);          // 50 %/s, 200 %/s² S-curve
+ *   float output = cond.process(targetDuty, dtSeconds);
+ *
+ *   float output = cond.force(0.0f);          // emergency stop: no filtering
+ *
+ *   StaticActuatorConditioner<5> cond(0.4, 0.0, 100.0, 5.0);
  */
 
 #ifndef ACTUATOR_CONDITIONER_H
 #define ACTUATOR_CONDITIONER_H
 
 #include "SignalConditioner.h"
+#include "StaticSignalConditioner.h"
+#include <math.h>
+
+/**
+ * @brief Move current toward target by at most maxStep (ramping stage).
+ * @return float The new ramped output.
+ */
+inline float actuatorRampStep(float current, float target, float maxStep) {
+    float diff = target - current;
+    if (diff > maxStep) {
+        return current + maxStep;
+    }
+    if (diff < -maxStep) {
+        return current - maxStep;
+    }
+    return target;
+}
+
+/**
+ * @brief Move current toward target over dt seconds (timed ramping stage).
+ *
+ * @param current  Present output.
+ * @param target   Conditioned target.
+ * @param dt       Elapsed time (s); <= 0 leaves the output unchanged.
+ * @param maxRate  Slew limit (units/s).
+ * @param maxAccel Limit on the change of the slew rate (units/s²);
+ *                 0 = plain rate limit.
+ * @param velocity In/out: slew rate of the previous step (units/s).
+ * @return float The new ramped output.
+ */
+inline float actuatorSlewStep(float current, float target, float dt,
+                              float maxRate, float maxAccel, float *velocity) {
+    if (!(dt > 0.0f)) {
+        return current;
+    }
+    if (maxAccel <= 0.0f) {
+        float next = actuatorRampStep(current, target, maxRate * dt);
+        *velocity = (next - current) / dt;
+        return next;
+    }
+
+    // Fastest rate from which the output can still brake onto the target
+    // in steps of dt (discrete form of v = sqrt(2·a·d)).
+    float error = target - current;
+    float dir = (error >= 0.0f) ? 1.0f : -1.0f;
+    float distance = fabsf(error);
+    float dv = maxAccel * dt;
+    float wanted = sqrtf(2.0f * maxAccel * distance + 0.25f * dv * dv) - 0.5f * dv;
+    if (wanted > maxRate) {
+        wanted = maxRate;
+    }
+    float v = actuatorRampStep(*velocity, dir * wanted, dv);
+    float next = current + v * dt;
+
+    // Arrived, or this step would cross the target: stop on it.
+    if (distance <= 0.5f * maxAccel * dt * dt || (target - next) * dir < 0.0f) {
+        *velocity = 0.0f;
+        return target;
+    }
+    *velocity = v;
+    return next;
+}
 
 /**
  * @class ActuatorConditioner
@@ -29,7 +116,7 @@ class ActuatorConditioner {
 public:
     /**
      * @brief Construct a new ActuatorConditioner.
-     * @param medianWindow Median filter window size (odd, <= 9).
+     * @param medianWindow Median filter window size (odd, <= 31).
      * @param ewmaAlpha EWMA smoothing factor (0.0-1.0).
      * @param minClamp Minimum valid command value.
      * @param maxClamp Maximum valid command value.
@@ -46,21 +133,162 @@ public:
      */
     float process(float rawCommand);
 
+    /**
+     * @brief Process a raw command, ramping over the measured time since
+     *        the previous call (see setRampRate()).
+     * @param rawCommand Raw target value from user input.
+     * @param dtSeconds  Time since the previous call (s).
+     * @return float Conditioned, ramped output value.
+     */
+    float process(float rawCommand, float dtSeconds);
+
+    /**
+     * @brief Express the ramp in time instead of calls.
+     * @param unitsPerSecond  Slew limit; 0 returns process(raw, dt) to
+     *                        the per-call maxRampStep.
+     * @param unitsPerSecond2 Acceleration limit for an S-curve; 0 = linear.
+     */
+    void setRampRate(float unitsPerSecond, float unitsPerSecond2 = 0.0f);
+
     /** @brief Get the current ramped output value. */
     float getRampedOutput() const;
 
+    /** @brief Slew rate of the last timed ramp step (units/s). */
+    float getRampVelocity() const;
+
     /** @brief Get the conditioned (pre-ramp) target value. */
     float getConditionedTarget() const;
 
     /** @brief Access the underlying SignalConditioner for diagnostics. */
     const SignalConditioner& getSignalConditioner() const;
 
+    /**
+     * @brief Bypass the pipeline: set the output to value (saturated) now.
+     *
+     * Every stage is resynchronized to the value, as if it had been the
+     * command for a full median window.
+     *
+     * @param value Output to apply (e.g. 0 for an emergency stop).
+     * @return float The new output.
+     */
+    float force(float value);
+
     /** @brief Reset the conditioner and ramp state. */
     void reset();
 
 private:
     SignalConditioner _conditioner;
     float _maxRampStep;
+    float _rampRate;
+    float _rampAccel;
+    float _rampVelocity;
+    float _rampedOutput;
+    float _conditionedTarget;
+    bool  _initialized;
+};
+
+/**
+ * @class StaticActuatorConditioner
+ * @brief ActuatorConditioner with a compile-time median window.
+ *
+ * @tparam N Median filter window size (odd).
+ */
+template <uint8_t N>
+class StaticActuatorConditioner {
+public:
+    /**
+     * @brief Construct a new StaticActuatorConditioner.
+     * @param ewmaAlpha EWMA smoothing factor (0.0-1.0).
+     * @param minClamp Minimum valid command value.
+     * @param maxClamp Maximum valid command value.
+     * @param maxRampStep Maximum change per process() call (for ramping).
+     */
+    StaticActuatorConditioner(float ewmaAlpha, float minClamp, float maxClamp,
+                              float maxRampStep)
+        : _conditioner(ewmaAlpha, minClamp, maxClamp),
+          _maxRampStep(maxRampStep),
+          _rampRate(0.0f),
+          _rampAccel(0.0f),
+          _rampVelocity(0.0f),
+          _rampedOutput(0.0f),
+          _conditionedTarget(0.0f),
+          _initialized(false) {}
+
+    /** @brief Process a raw command through the full pipeline. */
+    float process(float rawCommand) {
+        _conditionedTarget = _conditioner.process(rawCommand);
+        if (!_initialized) {
+            _rampedOutput = _conditionedTarget;
+            _initialized = true;
+        } else {
+            _rampedOutput = actuatorRampStep(_rampedOutput, _conditionedTarget,
+                                             _maxRampStep);
+        }
+        return _rampedOutput;
+    }
+
+    /** @brief Process a raw command, ramping over dtSeconds (see setRampRate()). */
+    float process(float rawCommand, float dtSeconds) {
+        if (_rampRate <= 0.0f) {
+            return process(rawCommand);
+        }
+        _conditionedTarget = _conditioner.process(rawCommand);
+        if (!_initialized) {
+            _rampedOutput = _conditionedTarget;
+            _rampVelocity = 0.0f;
+            _initialized = true;
+        } else {
+            _rampedOutput = actuatorSlewStep(_rampedOutput, _conditionedTarget, dtSeconds,
+                                             _rampRate, _rampAccel, &_rampVelocity);
+        }
+        return _rampedOutput;
+    }
+
+    /** @brief Slew limit (units/s) and optional S-curve acceleration (units/s²). */
+    void setRampRate(float unitsPerSecond, float unitsPerSecond2 = 0.0f) {
+        _rampRate = (unitsPerSecond > 0.0f) ? unitsPerSecond : 0.0f;
+        _rampAccel = (unitsPerSecond2 > 0.0f) ? unitsPerSecond2 : 0.0f;
+    }
+
+    /** @brief Get the current ramped output value. */
+    float getRampedOutput() const { return _rampedOutput; }
+
+    /** @brief Slew rate of the last timed ramp step (units/s). */
+    float getRampVelocity() const { return _rampVelocity; }
+
+    /** @brief Get the conditioned (pre-ramp) target value. */
+    float getConditionedTarget() const { return _conditionedTarget; }
+
+    /** @brief Access the underlying conditioner for diagnostics. */
+    const StaticSignalConditioner<N>& getSignalConditioner() const { return _conditioner; }
+
+    /** @brief Bypass the pipeline and resynchronize it (see ActuatorConditioner::force()). */
+    float force(float value) {
+        _conditioner.reset();
+        for (uint8_t i = 0; i < N; i++) {
+            _conditionedTarget = _conditioner.process(value);
+        }
+        _rampedOutput = _conditionedTarget;
+        _rampVelocity = 0.0f;
+        _initialized = true;
+        return _rampedOutput;
+    }
+
+    /** @brief Reset the conditioner and ramp state. */
+    void reset() {
+        _conditioner.reset();
+        _rampedOutput = 0.0f;
+        _conditionedTarget = 0.0f;
+        _rampVelocity = 0.0f;
+        _initialized = false;
+    }
+
+private:
+    StaticSignalConditioner<N> _conditioner;
+    float _maxRampStep;
+    float _rampRate;
+    float _rampAccel;
+    float _rampVelocity;
     float _rampedOutput;
     float _conditionedTarget;
     bool  _initialized;
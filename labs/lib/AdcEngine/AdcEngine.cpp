@@ -0,0 +1,332 @@
+/**
+ * @file AdcEngine.cpp
+ * @brief Interrupt-Driven, Timer-Triggered ADC Sampling Engine Implementation
+ *
+ * Register setup (ATmega2560):
+ *   ADMUX  = REFS0 | MUX4:0        AVcc reference, channel & 7
+ *   ADCSRB = MUX5 | ADTS2          channel bit 3, trigger = Timer0 overflow
+ *   ADCSRA = ADEN | ADATE | ADIE | ADPS2:0 (÷128)
+ *
+ * In ADC_ENGINE_TRIGGER_SLEEP mode ADATE stays clear: entering
+ * SLEEP_MODE_ADC with the ADC enabled and idle starts a single conversion,
+ * and the same ISR handles its completion.
+ *
+ * The multiplexer is switched inside the ADC ISR, after the conversion
+ * that just finished and well before the next Timer0 overflow (~1 ms
+ * later) starts the following one, so every conversion sees a settled
+ * channel selection.
+ */
+
+#include "AdcEngine.h"
+#if ADC_ENGINE_CIC
+#include "CicDecimator.h"
+#endif
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Engine state
+// ──────────────────────────────────────────────────────────────────────────
+
+static uint8_t s_channels[ADC_ENGINE_MAX_CHANNELS];  ///< ADC channel numbers (0..15).
+static uint8_t s_count = 0;                          ///< Channels in the list.
+static uint8_t s_oversampleLog2 = 0;                 ///< log2(conversions per result).
+static bool    s_running = false;
+static AdcEngineTrigger s_trigger = ADC_ENGINE_TRIGGER_TIMER;
+static uint8_t  s_minIntervalMs = 0;                 ///< Sleep mode pacing.
+#if defined(__AVR__)
+static uint32_t s_lastSleepMs = 0;                   ///< millis() at last sleep conversion.
+#endif
+
+// ISR-owned accumulation.
+#if ADC_ENGINE_CIC
+static CicDecimator<ADC_ENGINE_CIC_ORDER> s_cic[ADC_ENGINE_MAX_CHANNELS];
+#if defined(ADC_ENGINE_CIC_COMPENSATE)
+static const bool CIC_COMPENSATE = true;
+#else
+static const bool CIC_COMPENSATE = false;
+#endif
+#else
+static uint16_t         s_acc[ADC_ENGINE_MAX_CHANNELS];  ///< Running sums.
+static uint8_t          s_round = 0;                     ///< Completed passes in block.
+#endif
+static volatile uint8_t s_current = 0;                   ///< Slot being converted.
+
+// Double-buffered results: the ISR fills the back half, then flips s_front.
+static uint16_t         s_result[2][ADC_ENGINE_MAX_CHANNELS];
+static volatile uint8_t s_front = 0;
+static volatile uint16_t s_sequence = 0;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Hardware helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(__AVR__)
+/** @brief Point the multiplexer at an ADC channel (0..15), AVcc reference. */
+static inline void selectChannel(uint8_t channel) {
+    ADMUX = (uint8_t)(_BV(REFS0) | (channel & 0x07));
+#if defined(MUX5)
+    if (channel & 0x08) {
+        ADCSRB |= _BV(MUX5);
+    } else {
+        ADCSRB &= (uint8_t)~_BV(MUX5);
+    }
+#endif
+}
+
+/** @brief Disable the digital input buffer of an ADC pin. */
+static inline void disableDigitalInput(uint8_t channel) {
+#if defined(DIDR2)
+    if (channel & 0x08) {
+        DIDR2 |= _BV(channel & 0x07);
+        return;
+    }
+#endif
+    DIDR0 |= _BV(channel & 0x07);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Conversion-complete interrupt
+// ──────────────────────────────────────────────────────────────────────────
+
+#if ADC_ENGINE_CIC
+/** @brief CIC output at the block-sum scale, clamped to a uint16_t result. */
+static inline uint16_t cicResult(const CicDecimator<ADC_ENGINE_CIC_ORDER> &cic) {
+    int32_t value = cic.readScaled(s_oversampleLog2);
+    int32_t top = (int32_t)1023 << s_oversampleLog2;
+    if (value < 0) {
+        return 0;                 // Compensator undershoot after a falling step
+    }
+    return (uint16_t)(value > top ? top : value);
+}
+
+ISR(ADC_vect) {
+    uint8_t slot = s_current;
+    // Every channel decimates in step: the last one's output ends the block.
+    if (s_cic[slot].push(ADC) && slot + 1 >= s_count) {
+        uint8_t back = s_front ^ 1;
+        for (uint8_t i = 0; i < s_count; i++) {
+            s_result[back][i] = cicResult(s_cic[i]);
+        }
+        s_front = back;
+        s_sequence++;
+    }
+    if (++slot >= s_count) {
+        slot = 0;
+    }
+
+    s_current = slot;
+    selectChannel(s_channels[slot]);
+}
+#else
+ISR(ADC_vect) {
+    uint8_t slot = s_current;
+    s_acc[slot] += ADC;
+
+    if (++slot >= s_count) {
+        slot = 0;
+        if (++s_round >= (uint8_t)(1U << s_oversampleLog2)) {
+            // Block complete: publish every channel into the back buffer.
+            uint8_t back = s_front ^ 1;
+            for (uint8_t i = 0; i < s_count; i++) {
+                s_result[back][i] = s_acc[i];
+                s_acc[i] = 0;
+            }
+            s_front = back;
+            s_sequence++;
+            s_round = 0;
+        }
+    }
+
+    s_current = slot;
+    selectChannel(s_channels[slot]);
+}
+#endif
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Configuration
+// ──────────────────────────────────────────────────────────────────────────
+
+bool adcEngineInit(const uint8_t *pins, uint8_t count, uint8_t oversampleLog2) {
+    if (s_running || pins == NULL || count == 0 ||
+        count > ADC_ENGINE_MAX_CHANNELS ||
+        oversampleLog2 > ADC_ENGINE_MAX_OVERSAMPLE_LOG2) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t channel = pins[i];
+        if (channel >= A0) {
+            channel -= A0;  // Arduino pin number → ADC channel
+        }
+        if (channel > 15) {
+            return false;
+        }
+        s_channels[i] = channel;
+    }
+#if ADC_ENGINE_CIC
+    CicDecimator<ADC_ENGINE_CIC_ORDER> check;
+    if (!check.configure(oversampleLog2, CIC_COMPENSATE)) {
+        return false;
+    }
+#endif
+
+    s_count = count;
+    s_oversampleLog2 = oversampleLog2;
+    return true;
+}
+
+bool adcEngineSetTrigger(AdcEngineTrigger trigger, uint8_t minIntervalMs) {
+    if (s_running) {
+        return false;
+    }
+    s_trigger = trigger;
+    s_minIntervalMs = minIntervalMs;
+    return true;
+}
+
+void adcEngineStart() {
+    if (s_running || s_count == 0) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < s_count; i++) {
+#if ADC_ENGINE_CIC
+        s_cic[i].configure(s_oversampleLog2, CIC_COMPENSATE);
+#else
+        s_acc[i] = 0;
+#endif
+        s_result[0][i] = 0;
+        s_result[1][i] = 0;
+    }
+    s_current = 0;
+#if !ADC_ENGINE_CIC
+    s_round = 0;
+#endif
+    s_front = 0;
+    s_sequence = 0;
+
+#if defined(__AVR__)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < s_count; i++) {
+            disableDigitalInput(s_channels[i]);
+        }
+        selectChannel(s_channels[0]);
+        if (s_trigger == ADC_ENGINE_TRIGGER_TIMER) {
+            // Trigger source: Timer0 overflow (ADTS = 100), keeping MUX5.
+            ADCSRB = (uint8_t)((ADCSRB & ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) | _BV(ADTS2));
+            ADCSRA = (uint8_t)(_BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADIF) |
+                               _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0));
+        } else {
+            // Single conversions, started by adcEngineIdle()'s sleep.
+            ADCSRA = (uint8_t)(_BV(ADEN) | _BV(ADIE) | _BV(ADIF) |
+                               _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0));
+        }
+    }
+    s_lastSleepMs = millis();
+#endif
+    s_running = true;
+}
+
+void adcEngineStop() {
+    if (!s_running) {
+        return;
+    }
+#if defined(__AVR__)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Back to single conversions for analogRead() (ADEN and the
+        // prescaler stay as the Arduino core expects).
+        ADCSRA &= (uint8_t)~(_BV(ADATE) | _BV(ADIE));
+        ADCSRB &= (uint8_t)~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0));
+    }
+#endif
+    s_running = false;
+}
+
+void adcEngineIdle() {
+#if defined(__AVR__)
+    if (!s_running || s_trigger != ADC_ENGINE_TRIGGER_SLEEP) {
+        return;
+    }
+    if ((uint32_t)(millis() - s_lastSleepMs) < s_minIntervalMs) {
+        return;
+    }
+    if (ADCSRA & _BV(ADSC)) {
+        return;  // Previous conversion still running (woken early)
+    }
+#if defined(UCSR0A)
+    // The USART stops with clkI/O: wait until the TX ring is drained
+    // (UDRIE0 off) and the last frame has left the shift register.
+    if ((UCSR0B & _BV(UDRIE0)) || !(UCSR0A & _BV(TXC0))) {
+        return;
+    }
+#endif
+    s_lastSleepMs = millis();
+
+    // Same lost-wake-up guard as TaskScheduler's idle: SLEEP executes
+    // before any interrupt enabled by sei() can run.
+    set_sleep_mode(SLEEP_MODE_ADC);
+    cli();
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+#endif
+}
+
+bool adcEngineRunning() {
+    return s_running;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Results
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Latest published sum of a slot (atomic 16-bit copy). */
+static uint16_t readSum(uint8_t slot) {
+    uint16_t sum = 0;
+    if (slot >= s_count) {
+        return 0;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        sum = s_result[s_front][slot];
+    }
+    return sum;
+}
+
+uint16_t adcEngineRead(uint8_t slot) {
+    return (uint16_t)(readSum(slot) >> s_oversampleLog2);
+}
+
+uint16_t adcEngineReadEnhanced(uint8_t slot) {
+    return (uint16_t)(readSum(slot) >> (s_oversampleLog2 - s_oversampleLog2 / 2));
+}
+
+void adcEngineSnapshot(uint16_t *out) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        const uint16_t *front = s_result[s_front];
+        for (uint8_t i = 0; i < s_count; i++) {
+            out[i] = (uint16_t)(front[i] >> s_oversampleLog2);
+        }
+    }
+}
+
+uint8_t adcEngineResolutionBits() {
+    return (uint8_t)(10 + s_oversampleLog2 / 2);
+}
+
+uint16_t adcEngineSequence() {
+    uint16_t seq = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        seq = s_sequence;
+    }
+    return seq;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file AdcEngine.h
+ * @brief Interrupt-Driven, Timer-Triggered ADC Sampling Engine
+ *
+ * Replaces blocking analogRead() calls (~112 µs busy wait each) with a
+ * background engine:
+ *
+ *   - Conversions are auto-triggered by the Timer0 overflow that already
+ *     drives millis() (16 MHz / 64 / 256 ≈ 976.6 Hz), so no extra timer
+ *     is claimed and the core's timekeeping is untouched.
+ *   - The ADC ISR accumulates the result and switches the multiplexer to
+ *     the next channel in the configured list (round-robin).
+ *   - After 2^oversampleLog2 conversions of every channel, the sums are
+ *     published into the inactive half of a double buffer, which is then
+ *     made current. All channels of one publication come from the same
+ *     block of samples.
+ *
+ * Rates: each channel gets 976.6 / count conversions per second, and a
+ * new decimated result appears every count × 2^oversampleLog2 triggers
+ * (e.g. 1 channel, 16× → 61 Hz; 2 channels, 16× → 30.5 Hz).
+ *
+ * Results:
+ *   adcEngineRead()         average at the native 10-bit scale
+ *   adcEngineReadEnhanced() sum >> (n - n/2), n = oversampleLog2: 10 + n/2 bits
+ *                           (oversampling gains one bit per 4× samples,
+ *                           given at least 1 LSB of noise)
+ *
+ * CIC decimation (-DADC_ENGINE_CIC_ORDER=<2..4>):
+ *   The block sum is a first-order CIC filter; a higher order runs a
+ *   CicDecimator per channel in the ISR instead (N 32-bit additions per
+ *   conversion), so noise and hum aliased into the result are cut harder
+ *   at the same rate and resolution. Results keep the block-sum scale
+ *   (read functions unchanged); the first ORDER results are still
+ *   filling. -DADC_ENGINE_CIC_COMPENSATE adds the droop-compensating FIR
+ *   (one result of delay). 10 + ORDER·n bits must fit 31 (26 with the
+ *   compensator), else adcEngineInit() fails.
+ *
+ * Noise-reduction trigger (ADC_ENGINE_TRIGGER_SLEEP):
+ *   Instead of the timer, each conversion is started by entering
+ *   SLEEP_MODE_ADC from adcEngineIdle(), called when the system is idle
+ *   (FreeRTOS idle hook → loop()). The CPU and I/O clocks stop during
+ *   the ~104 µs conversion, which removes most digital switching noise;
+ *   the ADC interrupt wakes the CPU. Costs, hence opt-in:
+ *     - Timer0 is halted too, so millis()/micros() lose ~0.1 ms per
+ *       conversion (minIntervalMs paces the duty cycle; 4 ms ≈ 2.6 %).
+ *       The FreeRTOS tick runs from the watchdog and is unaffected.
+ *     - The USART is clocked from clkI/O: a conversion is skipped while
+ *       a byte is being transmitted, but a byte received during one may
+ *       be corrupted.
+ *   Conversions still accumulate and publish exactly as above.
+ *
+ * While the engine runs it owns the ADC: do not call analogRead(). Stop
+ * it with adcEngineStop() first. AnalogTempSensor and AnalogSetpointInput
+ * read from the engine after useAdcEngine(slot).
+ *
+ * Usage:
+ *   static const uint8_t ADC_PINS[] = { A0, A1 };
+ *   adcEngineInit(ADC_PINS, 2, 4);      // 16× oversampling
+ *   adcEngineStart();
+ *   ...
+ *   uint16_t ntc = adcEngineRead(0);    // never blocks
+ *
+ *   // Noise-reduction mode: convert from the idle loop instead.
+ *   adcEngineSetTrigger(ADC_ENGINE_TRIGGER_SLEEP, 4);
+ *   adcEngineStart();
+ *   void loop() { adcEngineIdle(); }
+ */
+
+#ifndef ADC_ENGINE_H
+#define ADC_ENGINE_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Maximum channels in the round-robin list.
+ * Override with -DADC_ENGINE_MAX_CHANNELS=<n>.
+ */
+#ifndef ADC_ENGINE_MAX_CHANNELS
+#define ADC_ENGINE_MAX_CHANNELS 8
+#endif
+
+/** Largest oversampling exponent: 2^6 × 1023 still fits a uint16_t sum. */
+#define ADC_ENGINE_MAX_OVERSAMPLE_LOG2 6
+
+/**
+ * @brief CIC order of the decimation (1 = block sum).
+ * Override with -DADC_ENGINE_CIC_ORDER=<1..4>.
+ */
+#ifndef ADC_ENGINE_CIC_ORDER
+#define ADC_ENGINE_CIC_ORDER 1
+#endif
+
+#if ADC_ENGINE_CIC_ORDER < 1 || ADC_ENGINE_CIC_ORDER > 4
+#error "ADC_ENGINE_CIC_ORDER must be 1..4"
+#endif
+
+/** @brief The ISR runs CicDecimators instead of the plain block sum. */
+#if ADC_ENGINE_CIC_ORDER > 1 || defined(ADC_ENGINE_CIC_COMPENSATE)
+#define ADC_ENGINE_CIC 1
+#else
+#define ADC_ENGINE_CIC 0
+#endif
+
+/**
+ * @enum AdcEngineTrigger
+ * @brief What starts each conversion.
+ */
+enum AdcEngineTrigger {
+    ADC_ENGINE_TRIGGER_TIMER = 0, /**< Timer0 overflow auto-trigger (~977 Hz).  */
+    ADC_ENGINE_TRIGGER_SLEEP = 1  /**< SLEEP_MODE_ADC entered by adcEngineIdle(). */
+};
+
+/**
+ * @brief Configure the channel list and oversampling (engine stopped).
+ *
+ * @param pins           Analog pins (A0..A15, or channel numbers 0..15).
+ * @param count          Number of pins (1..ADC_ENGINE_MAX_CHANNELS).
+ * @param oversampleLog2 Conversions per channel per result = 2^n (0..6).
+ * @return true on success; false for an invalid argument (or an n the
+ *         CIC registers cannot hold) or while the engine is running.
+ */
+bool adcEngineInit(const uint8_t *pins, uint8_t count, uint8_t oversampleLog2);
+
+/**
+ * @brief Select the conversion trigger (engine stopped).
+ *
+ * @param trigger       ADC_ENGINE_TRIGGER_TIMER (default) or _SLEEP.
+ * @param minIntervalMs Sleep trigger only: minimum time between
+ *                      conversions, bounding the millis() slip.
+ * @return true on success; false while the engine is running.
+ */
+bool adcEngineSetTrigger(AdcEngineTrigger trigger, uint8_t minIntervalMs);
+
+/**
+ * @brief Run one noise-reduced conversion if one is due.
+ *
+ * Call from the idle hook / loop(). Returns at once in timer mode, while
+ * a conversion is in progress, before minIntervalMs has elapsed, or while
+ * the UART is transmitting; otherwise sleeps in SLEEP_MODE_ADC until the
+ * conversion completes (or another interrupt wakes the CPU).
+ */
+void adcEngineIdle();
+
+/**
+ * @brief Start conversions (AVcc reference, ADC clock
+ *        16 MHz / 128 = 125 kHz, digital inputs on the used pins off),
+ *        triggered as selected by adcEngineSetTrigger().
+ */
+void adcEngineStart();
+
+/**
+ * @brief Stop the engine and hand the ADC back to analogRead().
+ */
+void adcEngineStop();
+
+/**
+ * @brief Check whether the engine is running.
+ * @return true between adcEngineStart() and adcEngineStop().
+ */
+bool adcEngineRunning();
+
+/**
+ * @brief Latest decimated value of a channel at the native 10-bit scale.
+ * @param slot Index into the pin list given to adcEngineInit().
+ * @return uint16_t Average of the last block (0 before the first result).
+ */
+uint16_t adcEngineRead(uint8_t slot);
+
+/**
+ * @brief Latest value of a channel with the oversampling resolution gain.
+ * @param slot Index into the pin list.
+ * @return uint16_t Value with adcEngineResolutionBits() bits.
+ */
+uint16_t adcEngineReadEnhanced(uint8_t slot);
+
+/**
+ * @brief Copy the latest value of every channel from one publication.
+ * @param out Buffer of at least count entries (native 10-bit scale).
+ */
+void adcEngineSnapshot(uint16_t *out);
+
+/**
+ * @brief Resolution of adcEngineReadEnhanced(): 10 + oversampleLog2 / 2.
+ */
+uint8_t adcEngineResolutionBits();
+
+/**
+ * @brief Number of results published since adcEngineStart().
+ *
+ * Compare with a previous value to detect a fresh result; 0 means no
+ * result yet.
+ */
+uint16_t adcEngineSequence();
+
+#endif // ADC_ENGINE_H
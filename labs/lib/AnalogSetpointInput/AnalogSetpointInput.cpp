@@ -4,37 +4,131 @@
  */
 
 #include "AnalogSetpointInput.h"
+#include "AdcEngine.h"
+
+/** Fixed-point fraction bits of the filtered reading (raw × 16). */
+static const uint8_t SCALE_BITS = 4;
 
 AnalogSetpointInput::AnalogSetpointInput(uint8_t adcPin, float minValue,
                                          float maxValue, uint8_t adcResolution)
     : _adcPin(adcPin),
+      _adcBits(adcResolution),
       _minValue(minValue),
       _maxValue(maxValue),
       _adcMax((1U << adcResolution) - 1U),
       _lastRaw(0),
-      _lastValue(minValue) {}
+      _engineSlot(-1),
+      _lastValue(minValue),
+      _stepValue(0.0f),
+      _steps(0),
+      _oversampleLog2(0),
+      _deadBandPercent(0),
+      _index(0),
+      _haveIndex(false) {}
 
 void AnalogSetpointInput::init() {
     pinMode(_adcPin, INPUT);
     _lastRaw = 0;
     _lastValue = _minValue;
+    _haveIndex = false;
 }
 
 uint16_t AnalogSetpointInput::readRaw() {
-    _lastRaw = analogRead(_adcPin);
+    if (_engineSlot >= 0) {
+        _lastRaw = adcEngineRead((uint8_t)_engineSlot);
+    } else {
+        _lastRaw = analogRead(_adcPin);
+    }
     return _lastRaw;
 }
 
+void AnalogSetpointInput::useAdcEngine(int8_t slot) {
+    _engineSlot = slot;
+}
+
+void AnalogSetpointInput::setQuantization(float stepValue, uint8_t oversampleLog2,
+                                          uint8_t deadBandPercent) {
+    _stepValue = stepValue > 0.0f ? stepValue : 0.0f;
+    _oversampleLog2 = oversampleLog2 <= SCALE_BITS ? oversampleLog2 : SCALE_BITS;
+    _deadBandPercent = deadBandPercent <= 100 ? deadBandPercent : 100;
+    planSteps();
+}
+
+void AnalogSetpointInput::planSteps() {
+    _steps = 0;
+    if (_stepValue > 0.0f && _maxValue > _minValue) {
+        float steps = (_maxValue - _minValue) / _stepValue + 0.5f;
+        _steps = steps < 65535.0f ? (uint16_t)steps : 65535U;
+    }
+    _haveIndex = false;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Reading
+// ──────────────────────────────────────────────────────────────────────────
+
+uint16_t AnalogSetpointInput::readScaled() {
+    if (_engineSlot >= 0) {
+        // Already oversampled in the background: take the extra bits.
+        _lastRaw = adcEngineRead((uint8_t)_engineSlot);
+        uint16_t enhanced = adcEngineReadEnhanced((uint8_t)_engineSlot);
+        uint8_t bits = adcEngineResolutionBits();
+        uint8_t target = (uint8_t)(_adcBits + SCALE_BITS);
+        return bits <= target ? (uint16_t)(enhanced << (target - bits))
+                              : (uint16_t)(enhanced >> (bits - target));
+    }
+
+    uint16_t sum = 0;
+    uint8_t count = (uint8_t)(1U << _oversampleLog2);
+    for (uint8_t i = 0; i < count; i++) {
+        sum += (uint16_t)analogRead(_adcPin);
+    }
+    _lastRaw = (uint16_t)((sum + (count >> 1)) >> _oversampleLog2);
+    return (uint16_t)(sum << (SCALE_BITS - _oversampleLog2));
+}
+
 float AnalogSetpointInput::readValue() {
-    uint16_t raw = readRaw();
-    float ratio = (float)raw / (float)_adcMax;
-    _lastValue = _minValue + ratio * (_maxValue - _minValue);
+    uint32_t scaled = readScaled();
+    uint32_t full = (uint32_t)_adcMax << SCALE_BITS;
+    if (scaled > full) {
+        scaled = full;      // Enhanced engine value: 4095 × 4 > 1023 × 16
+    }
+
+    if (_steps == 0) {
+        float ratio = (float)scaled / (float)full;
+        _lastValue = _minValue + ratio * (_maxValue - _minValue);
+        return _lastValue;
+    }
+
+    // Step k is centered at pos = k × full; leave it only past the
+    // half-step boundary plus the dead band.
+    uint32_t pos = scaled * _steps;
+    uint32_t nearest = (pos + full / 2) / full;
+    if (!_haveIndex) {
+        _index = (uint16_t)nearest;
+        _haveIndex = true;
+    } else {
+        uint32_t center = (uint32_t)_index * full;
+        uint32_t hold = full / 2 + full * _deadBandPercent / 100;
+        if (pos > center + hold || pos + hold < center) {
+            _index = (uint16_t)nearest;
+        }
+    }
+    if (_index > _steps) {
+        _index = _steps;
+    }
+
+    _lastValue = _minValue + (float)_index * _stepValue;
+    if (_lastValue > _maxValue) {
+        _lastValue = _maxValue;
+    }
     return _lastValue;
 }
 
 void AnalogSetpointInput::setRange(float minValue, float maxValue) {
     _minValue = minValue;
     _maxValue = maxValue;
+    planSteps();
 }
 
 uint16_t AnalogSetpointInput::getLastRaw() const {
@@ -4,6 +4,27 @@
  *
  * Encapsulates ADC reads and maps the raw value to a configurable
  * engineering range, such as a temperature setpoint in degrees Celsius.
+ *
+ * One raw conversion carries ±1–2 LSB of noise, so a plain linear map
+ * makes the setpoint jitter on every read, and a PID loop turns that
+ * into error and derivative kicks. setQuantization() turns the input
+ * into a setpoint knob instead:
+ *
+ *   - oversampling: 2^n analogRead() per readValue(), summed (the
+ *     AdcEngine already oversamples and supplies its enhanced value);
+ *   - quantized output: the value snaps to min + k × step;
+ *   - hysteresis: k only changes once the wiper is past the half-step
+ *     boundary by an extra dead band, so noise at a boundary cannot
+ *     toggle between two steps.
+ *
+ * The filtering and the step decision are integer math on the raw
+ * counts (×16 fixed point); one float multiply yields the value.
+ *
+ * Usage:
+ *   static AnalogSetpointInput pot(A0, SETPOINT_MIN_C, SETPOINT_MAX_C);
+ *   pot.init();
+ *   pot.setQuantization(SETPOINT_STEP_C, 3, 25);   // 8 reads, 25 % dead band
+ *   float setpoint = pot.readValue();               // 15.0, 15.5, ... 35.0
  */
 
 #ifndef ANALOG_SETPOINT_INPUT_H
@@ -26,28 +47,65 @@ public:
     /** @brief Configure the ADC pin. */
     void init();
 
-    /** @brief Read raw ADC value. */
+    /**
+     * @brief Read raw ADC value.
+     *
+     * Blocks on analogRead() unless useAdcEngine() selected an engine
+     * slot, in which case the latest decimated value is returned at once.
+     */
     uint16_t readRaw();
 
+    /**
+     * @brief Take raw values from the background AdcEngine.
+     * @param slot Index of this pin in the adcEngineInit() list, or -1
+     *             to return to analogRead().
+     */
+    void useAdcEngine(int8_t slot);
+
+    /**
+     * @brief Oversample, snap to steps and hold against noise.
+     *
+     * @param stepValue       Output step (e.g. SETPOINT_STEP_C); 0 keeps
+     *                        the continuous linear map.
+     * @param oversampleLog2  2^n analogRead() per readValue(), 0..4
+     *                        (the AdcEngine path oversamples already).
+     * @param deadBandPercent Travel past the half-step boundary, in % of
+     *                        a step, before the output moves (0..100).
+     */
+    void setQuantization(float stepValue, uint8_t oversampleLog2 = 3,
+                         uint8_t deadBandPercent = 25);
+
     /** @brief Read and map the current value to the configured range. */
     float readValue();
 
     /** @brief Update the mapped engineering range. */
     void setRange(float minValue, float maxValue);
 
-    /** @brief Return the last raw ADC sample. */
+    /** @brief Return the last raw ADC sample (the oversampled average). */
     uint16_t getLastRaw() const;
 
     /** @brief Return the last mapped setpoint value. */
     float getLastValue() const;
 
 private:
+    uint16_t readScaled();
+    void planSteps();
+
     uint8_t _adcPin;
+    uint8_t _adcBits;
     float _minValue;
     float _maxValue;
     uint16_t _adcMax;
     uint16_t _lastRaw;
+    int8_t _engineSlot;
     float _lastValue;
+
+    float _stepValue;           // 0: continuous
+    uint16_t _steps;            // Steps from min to max
+    uint8_t _oversampleLog2;
+    uint8_t _deadBandPercent;
+    uint16_t _index;            // Step shown
+    bool _haveIndex;
 };
 
 #endif // ANALOG_SETPOINT_INPUT_H
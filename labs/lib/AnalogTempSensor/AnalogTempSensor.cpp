@@ -10,11 +10,64 @@
  *   R_ntc = R_series * ADC / (ADC_MAX - ADC)
  *   1/T   = 1/T0 + (1/B) * ln(R_ntc / R0)
  *   T_C   = T_K - 273.15
+ *
+ * Lookup table (optional): entry i holds T_C × 100 at ADC = i * step,
+ * step = 2^(resolution - 6) (bridge mode: see below). A reading is interpolated between the two
+ * neighbouring entries in integer math, then scaled once to float.
+ *
+ * Inverse (rawAtTemperatureC()):
+ *   R_ntc = R0 * exp(B * (1/T - 1/T0))
+ *   ADC   = ADC_MAX * R_ntc / (R_series + R_ntc)
+ *
+ * Bridge mode: half = (ADC_MAX + 1) / 2 is the zero difference, G the gain,
+ * ref the reference divider ratio:
+ *   x     = ref + (ADC - half) / (half * G)          divider ratio
+ *   R_ntc = R_series * x / (1 - x)
+ *   ADC   = half + (x - ref) * half * G              inverse
+ * The table is then centred on the span's mid temperature, in units of
+ * 1 / scale °C with the largest scale (≤ 10000) that keeps the span in
+ * int16_t: ≈ 0.0003 °C for the 10× span.
+ *
+ * Register setup per bridge reading (ATmega2560):
+ *   ADMUX  = REFS0 | MUX4:0        AVcc reference, pair and gain
+ *   ADCSRB = MUX5                  pairs on ADC8..ADC11
+ * The result is 10-bit two's complement (−512..511).
  */
 
 #include "AnalogTempSensor.h"
+#include "AdcEngine.h"
 #include <math.h>
 
+// ──────────────────────────────────────────────────────────────────────────
+// Bridge channels (ATmega2560 MUX5:0, 10× gain, shorted pair; +1 = NTC
+// input against the reference, +2 = 200×)
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief MUX5:0 of the shorted pair on @p negativeChannel, or 0 if it has no gain pair. */
+static uint8_t bridgeMuxBase(uint8_t negativeChannel) {
+    switch (negativeChannel) {
+    case 0:  return 0x08;   // ADC1+ / ADC0−
+    case 2:  return 0x0C;   // ADC3+ / ADC2−
+    case 8:  return 0x28;   // ADC9+ / ADC8−
+    case 10: return 0x2C;   // ADC11+ / ADC10−
+    default: return 0;
+    }
+}
+
+#if defined(__AVR__)
+/** @brief One blocking conversion of the selected differential pair. */
+static int16_t convertDifferential() {
+    ADCSRA |= _BV(ADSC);
+    while (ADCSRA & _BV(ADSC)) {
+    }
+    int16_t value = (int16_t)ADC;
+    if (value & 0x200) {
+        value -= 0x400;   // Sign-extend the 10-bit result
+    }
+    return value;
+}
+#endif
+
 // ──────────────────────────────────────────────────────────────────────────
 // Constructor
 // ──────────────────────────────────────────────────────────────────────────
@@ -24,12 +77,22 @@ AnalogTempSensor::AnalogTempSensor(uint8_t adcPin, uint32_t seriesR,
                                    float nominalTempC, uint16_t adcResolution)
     : _adcPin(adcPin),
       _seriesR(seriesR),
-      _nominalR(nominalR),
-      _betaCoeff(betaCoeff),
+      _nominalR((float)nominalR),
+      _betaCoeff((float)betaCoeff),
       _nominalTempK(nominalTempC + 273.15f),
-      _adcMax((1 << adcResolution) - 1),
+      _adcMax((uint16_t)((1UL << adcResolution) - 1)),
+      _lutShift(adcResolution >= 6 ? (uint8_t)(adcResolution - 6) : 0),
+      _lut(NULL),
+      _lutBaseC(0.0f),
+      _lutStepC(0.01f),
+      _lutScale(100),
+      _bridgeMux(BRIDGE_NONE),
+      _bridgeGain(0),
+      _oversampleLog2(0),
+      _bridgeRef(0.0f),
+      _bridgeOffset(0),
       _lastRaw(0),
-      _lastResistance(-1.0f),
+      _engineSlot(-1),
       _lastTempC(NAN),
       _valid(false) {}
 
@@ -42,9 +105,172 @@ void AnalogTempSensor::init() {
     // is called, but we set the pin mode explicitly for clarity.
     pinMode(_adcPin, INPUT);
     _lastRaw        = 0;
-    _lastResistance = -1.0f;
     _lastTempC      = NAN;
     _valid          = false;
+
+    if (usesBridge()) {
+        calibrateBridgeOffset();
+    }
+    buildLookupTable();
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Bridge mode
+// ──────────────────────────────────────────────────────────────────────────
+
+bool AnalogTempSensor::useBridge(uint8_t negativePin, uint8_t gain, float referenceRatio,
+                                 uint8_t oversampleLog2) {
+    uint8_t negative = (negativePin >= A0) ? (uint8_t)(negativePin - A0) : negativePin;
+    uint8_t positive = (_adcPin >= A0) ? (uint8_t)(_adcPin - A0) : _adcPin;
+    uint8_t base = bridgeMuxBase(negative);
+    float span = (gain > 0) ? 1.0f / (float)gain : 0.0f;
+    if (base == 0 || positive != negative + 1 || (gain != 10 && gain != 200) ||
+        oversampleLog2 > 6 || !(referenceRatio - span > 0.0f) ||
+        !(referenceRatio + span < 1.0f)) {
+        return false;
+    }
+    _bridgeMux      = (uint8_t)(base + (gain == 200 ? 2 : 0));
+    _bridgeGain     = gain;
+    _bridgeRef      = referenceRatio;
+    _oversampleLog2 = oversampleLog2;
+    _bridgeOffset   = 0;
+    _adcMax         = (uint16_t)((1024UL << oversampleLog2) - 1);
+    _lutShift       = (uint8_t)(10 + oversampleLog2 - 6);
+    _engineSlot     = -1;
+    return true;
+}
+
+bool AnalogTempSensor::usesBridge() const {
+    return _bridgeMux != BRIDGE_NONE;
+}
+
+bool AnalogTempSensor::calibrateBridgeOffset() {
+    if (!usesBridge()) {
+        return false;
+    }
+#if defined(__AVR__)
+    _bridgeOffset = (int16_t)bridgeSum(_bridgeMux);
+#else
+    _bridgeOffset = 0;
+#endif
+    return true;
+}
+
+int16_t AnalogTempSensor::getBridgeOffset() const {
+    return _bridgeOffset;
+}
+
+int32_t AnalogTempSensor::bridgeSum(uint8_t mux) {
+#if defined(__AVR__)
+    uint8_t admux = (uint8_t)(_BV(REFS0) | (mux & 0x1F));
+    bool high = (mux & 0x20) != 0;
+    bool switched = ADMUX != admux || ((ADCSRB & _BV(MUX5)) != 0) != high;
+    ADMUX = admux;
+    if (high) {
+        ADCSRB |= _BV(MUX5);
+    } else {
+        ADCSRB &= (uint8_t)~_BV(MUX5);
+    }
+    if (switched) {
+        (void)convertDifferential();   // Gain stage settling after a switch
+    }
+    int32_t sum = 0;
+    for (uint8_t i = 0; i < (uint8_t)(1U << _oversampleLog2); i++) {
+        sum += convertDifferential();
+    }
+    return sum;
+#else
+    (void)mux;
+    return 0;
+#endif
+}
+
+uint16_t AnalogTempSensor::readBridge() {
+#if defined(__AVR__)
+    int32_t sum  = bridgeSum((uint8_t)(_bridgeMux + 1));
+    int32_t half = 512L << _oversampleLog2;
+    // Every conversion at a rail: beyond the span, reported like a short / open.
+    if (sum >= (511L << _oversampleLog2)) {
+        return _adcMax;
+    }
+    if (sum <= -half) {
+        return 0;
+    }
+    int32_t raw = sum - _bridgeOffset + half;
+    if (raw < 0) raw = 0;
+    if (raw > (int32_t)_adcMax) raw = _adcMax;
+    return (uint16_t)raw;
+#else
+    return (uint16_t)analogRead(_adcPin);
+#endif
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Calibration
+// ──────────────────────────────────────────────────────────────────────────
+
+bool AnalogTempSensor::setCalibration(float beta, float nominalR) {
+    if (!(beta > 0.0f) || !(nominalR > 0.0f) || isinf(beta) || isinf(nominalR)) {
+        return false;
+    }
+    _betaCoeff = beta;
+    _nominalR  = nominalR;
+    buildLookupTable();
+    return true;
+}
+
+float AnalogTempSensor::getBeta() const {
+    return _betaCoeff;
+}
+
+float AnalogTempSensor::getNominalResistance() const {
+    return _nominalR;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Lookup table
+// ──────────────────────────────────────────────────────────────────────────
+
+void AnalogTempSensor::useLookupTable(int16_t *table) {
+    _lut = table;
+}
+
+bool AnalogTempSensor::usesLookupTable() const {
+    return _lut != NULL && _adcMax >= 63;  // At least 6 bits
+}
+
+void AnalogTempSensor::buildLookupTable() {
+    if (!usesLookupTable()) {
+        return;
+    }
+    _lutBaseC = 0.0f;
+    _lutStepC = 0.01f;
+    _lutScale = 100;
+    if (usesBridge()) {
+        // The bridge spans a few tens of °C at most: centre the table on
+        // it and keep the resolution its finer counts carry.
+        float cold = betaTemperatureC((float)(_adcMax - 1));
+        float hot  = betaTemperatureC(1.0f);
+        float halfSpan = (hot - cold) * 0.5f;
+        _lutBaseC = cold + halfSpan;
+        float scale = (halfSpan > 0.0f) ? 32000.0f / halfSpan : 10000.0f;
+        if (scale > 10000.0f) scale = 10000.0f;
+        if (scale > 100.0f) {
+            _lutScale = (uint16_t)scale;
+            _lutStepC = 1.0f / (float)_lutScale;
+        }
+    }
+    // Entries at the two rails (ADC 0 and full scale) are undefined;
+    // evaluate them one count inside so the end segments stay finite.
+    for (uint8_t i = 0; i < LUT_ENTRIES; i++) {
+        uint32_t adc = (uint32_t)i << _lutShift;
+        if (adc < 1) adc = 1;
+        if (adc > (uint32_t)_adcMax - 1) adc = _adcMax - 1;
+        float units = (betaTemperatureC((float)adc) - _lutBaseC) * (float)_lutScale;
+        if (units > 32767.0f)  units = 32767.0f;
+        if (units < -32768.0f) units = -32768.0f;
+        _lut[i] = (int16_t)lroundf(units);
+    }
 }
 
 // ──────────────────────────────────────────────────────────────────────────
@@ -52,10 +278,20 @@ void AnalogTempSensor::init() {
 // ──────────────────────────────────────────────────────────────────────────
 
 uint16_t AnalogTempSensor::readRaw() {
-    _lastRaw = analogRead(_adcPin);
+    if (usesBridge()) {
+        _lastRaw = readBridge();
+    } else if (_engineSlot >= 0) {
+        _lastRaw = adcEngineRead((uint8_t)_engineSlot);
+    } else {
+        _lastRaw = analogRead(_adcPin);
+    }
     return _lastRaw;
 }
 
+void AnalogTempSensor::useAdcEngine(int8_t slot) {
+    _engineSlot = usesBridge() ? -1 : slot;
+}
+
 // ──────────────────────────────────────────────────────────────────────────
 // Resistance calculation from ADC
 // ──────────────────────────────────────────────────────────────────────────
@@ -67,18 +303,25 @@ float AnalogTempSensor::readResistance() {
     // ADC = 0 means NTC is shorted (R → 0).
     // ADC = ADC_MAX means NTC is open circuit (R → ∞).
     if (adc == 0 || adc >= _adcMax) {
-        _lastResistance = -1.0f;
         _valid = false;
         return -1.0f;
     }
 
+    _valid = true;
+    return resistanceFromRaw((float)adc);
+}
+
+float AnalogTempSensor::resistanceFromRaw(float adc) const {
     // Voltage divider: VCC ─ R_series ─ ADC_PIN ─ NTC ─ GND
     // V_adc / VCC = R_ntc / (R_series + R_ntc)
     // => R_ntc = R_series * ADC / (ADC_MAX - ADC)
-    float resistance = (float)_seriesR * (float)adc / (float)(_adcMax - adc);
-    _lastResistance = resistance;
-    _valid = true;
-    return resistance;
+    if (!usesBridge()) {
+        return (float)_seriesR * adc / ((float)_adcMax - adc);
+    }
+    // Bridge: the count is the offset from the reference, scaled by the gain
+    float half  = (float)_adcMax * 0.5f + 0.5f;
+    float ratio = _bridgeRef + (adc - half) / (half * (float)_bridgeGain);
+    return (float)_seriesR * ratio / (1.0f - ratio);
 }
 
 // ──────────────────────────────────────────────────────────────────────────
@@ -86,26 +329,64 @@ float AnalogTempSensor::readResistance() {
 // ──────────────────────────────────────────────────────────────────────────
 
 float AnalogTempSensor::readTemperatureC() {
-    float resistance = readResistance();
+    uint16_t adc = readRaw();
+    _lastTempC = convertRawC(adc);
+    _valid = !isnan(_lastTempC);
+    return _lastTempC;
+}
 
-    if (resistance < 0.0f) {
-        _lastTempC = NAN;
-        _valid = false;
+float AnalogTempSensor::convertRawC(uint16_t adc) const {
+    // ADC = 0 (short) and ADC = ADC_MAX (open) have no finite resistance.
+    if (adc == 0 || adc >= _adcMax) {
         return NAN;
     }
 
+    if (usesLookupTable()) {
+        // Linear interpolation between entries i and i + 1.
+        uint8_t i     = (uint8_t)(adc >> _lutShift);
+        int16_t frac  = (int16_t)(adc & ((1U << _lutShift) - 1));
+        int32_t a     = _lut[i];
+        int32_t delta = (int32_t)_lut[i + 1] - a;
+        int32_t units = a + ((delta * frac) >> _lutShift);
+        return _lutBaseC + (float)units * _lutStepC;
+    }
+
+    return betaTemperatureC((float)adc);
+}
+
+uint16_t AnalogTempSensor::rawAtTemperatureC(float tempC) const {
+    // R = R0 * exp(B * (1/T - 1/T0)), then the divider: ADC = ADC_MAX * R / (R_series + R)
+    float invT = 1.0f / (tempC + 273.15f) - 1.0f / _nominalTempK;
+    float resistance = _nominalR * expf(_betaCoeff * invT);
+    // The division by R first keeps R → ∞ (very cold) at full scale
+    float adc;
+    if (usesBridge()) {
+        float half  = (float)_adcMax * 0.5f + 0.5f;
+        float ratio = 1.0f / (1.0f + (float)_seriesR / resistance);
+        adc = half + (ratio - _bridgeRef) * half * (float)_bridgeGain + 0.5f;
+    } else {
+        adc = (float)_adcMax / (1.0f + (float)_seriesR / resistance) + 0.5f;
+    }
+    if (!(adc >= 1.0f)) {          // Also NaN
+        return 1;
+    }
+    if (adc > (float)(_adcMax - 1)) {
+        return (uint16_t)(_adcMax - 1);
+    }
+    return (uint16_t)adc;
+}
+
+float AnalogTempSensor::betaTemperatureC(float adc) const {
     // Steinhart-Hart simplified (Beta parameter equation):
     // 1/T = 1/T0 + (1/B) * ln(R / R0)
-    float steinhart = log(resistance / (float)_nominalR);  // ln(R / R0)
-    steinhart /= (float)_betaCoeff;                         // (1/B) * ln(R/R0)
-    steinhart += 1.0f / _nominalTempK;                      // + 1/T0
+    float resistance = resistanceFromRaw(adc);
+    float steinhart = log(resistance / _nominalR);  // ln(R / R0)
+    steinhart /= _betaCoeff;                         // (1/B) * ln(R/R0)
+    steinhart += 1.0f / _nominalTempK;               // + 1/T0
 
     // Convert from Kelvin to Celsius
     float tempK = 1.0f / steinhart;
-    _lastTempC = tempK - 273.15f;
-    _valid = true;
-
-    return _lastTempC;
+    return tempK - 273.15f;
 }
 
 // ──────────────────────────────────────────────────────────────────────────
@@ -130,10 +411,17 @@ uint16_t AnalogTempSensor::getLastRaw() const {
     return _lastRaw;
 }
 
+uint8_t AnalogTempSensor::getPin() const {
+    return _adcPin;
+}
+
 float AnalogTempSensor::getLastTemperatureC() const {
     return _lastTempC;
 }
 
 float AnalogTempSensor::getLastResistance() const {
-    return _lastResistance;
+    if (!_valid || _lastRaw == 0 || _lastRaw >= _adcMax) {
+        return -1.0f;
+    }
+    return resistanceFromRaw((float)_lastRaw);
 }
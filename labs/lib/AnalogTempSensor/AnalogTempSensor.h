@@ -14,10 +14,57 @@
  * converted to temperature using:
  *   1/T = 1/T0 + (1/B) * ln(R_ntc / R0)
  *
+ * Optional lookup table: the Beta equation costs a float division and a
+ * log() per sample. With useLookupTable(), init() precomputes the
+ * temperature at LUT_SEGMENTS + 1 evenly spaced ADC counts from the
+ * constructor parameters, and each conversion becomes a table read plus
+ * an integer linear interpolation. The table is built at run time (the
+ * parameters are constructor arguments), so it lives in a caller-owned
+ * RAM buffer rather than PROGMEM. For a 10 kΩ / β 3950 NTC on a 10-bit
+ * ADC the interpolation error is below 0.1 °C over -20..80 °C.
+ *
+ * The Beta and R0 given to the constructor are datasheet values;
+ * setCalibration() replaces them at run time with fitted ones (see
+ * NtcCalibrator) and rebuilds the table.
+ *
+ * rawAtTemperatureC() runs the equation the other way (°C → count), for
+ * callers that compare limits in the ADC domain.
+ *
+ * Bridge mode (useBridge(), ATmega2560): the divider becomes one half of
+ * a bridge whose other half is a fixed reference divider, both from AVCC:
+ *
+ *   AVCC ─ [R_series] ─ ADC_PIN (+) ─ [NTC] ─ GND
+ *   AVCC ─ [R_a] ──── REF_PIN (−) ─ [R_b] ─ GND      ratio = R_b / (R_a + R_b)
+ *
+ * and the ADC converts the difference through its 10× or 200× gain stage
+ * with AVCC as reference, so supply changes cancel (ratiometric). The
+ * counts span ±AVCC / gain around the reference instead of 0..AVCC: at
+ * 10× a 10 kΩ NTC against a 0.5 reference covers ≈ 16..34 °C at ≈ 0.02 °C
+ * per count, five times finer than single-ended. The signed result is
+ * summed over 2^oversampleLog2 conversions and shifted to offset binary
+ * (raw = sum + half scale, 10 + oversampleLog2 bits), so the rest of the
+ * API — rails invalid, counts falling as it warms, the lookup table —
+ * works on the finer counts unchanged. init() measures the gain stage
+ * offset on the shorted input pair (calibrateBridgeOffset()) and every
+ * reading subtracts it. The pairs with gain are (A1, A0), (A3, A2),
+ * (A9, A8) and (A11, A10), positive input first. Readings block on the
+ * ADC (≈ 104 µs per conversion at the Arduino prescaler, plus one
+ * discarded after a channel switch), so the AdcEngine is not used.
+ *
  * Usage:
  *   AnalogTempSensor ntc(A0, 10000, 10000, 3950);
  *   ntc.init();
  *   float tempC = ntc.readTemperatureC();
+ *
+ *   // With the lookup table (130 bytes):
+ *   static int16_t lut[AnalogTempSensor::LUT_ENTRIES];
+ *   ntc.useLookupTable(lut);
+ *   ntc.init();
+ *
+ *   // NTC on A1 against a 10k / 10k divider on A0, 10× gain, 12-bit counts:
+ *   AnalogTempSensor bridge(A1, 10000, 10000, 3950);
+ *   bridge.useBridge(A0, 10, 0.5f, 2);
+ *   bridge.init();
  */
 
 #ifndef ANALOG_TEMP_SENSOR_H
@@ -34,6 +81,12 @@
  */
 class AnalogTempSensor {
 public:
+    /** Number of interpolation segments in the lookup table. */
+    static const uint8_t LUT_SEGMENTS = 64;
+
+    /** Lookup table size (entries of int16_t, see buildLookupTable()). */
+    static const uint8_t LUT_ENTRIES = LUT_SEGMENTS + 1;
+
     /**
      * @brief Construct a new AnalogTempSensor object.
      *
@@ -50,15 +103,126 @@ public:
 
     /**
      * @brief Initialize the sensor (configures the ADC pin as input).
+     *
+     * Also fills the lookup table if one was set with useLookupTable(),
+     * and in bridge mode measures the offset (calibrateBridgeOffset()).
      */
     void init();
 
+    /**
+     * @brief Measure the NTC differentially against a reference divider.
+     *
+     * Call before init(). Replaces the constructor's ADC resolution with
+     * 10 + @p oversampleLog2 bits and ends useAdcEngine(). The full span
+     * must stay inside the divider: @p referenceRatio ± 1 / @p gain in
+     * (0, 1). On false the sensor stays single-ended.
+     *
+     * @param negativePin    Reference divider midpoint: A0, A2, A8 or A10,
+     *                       with the NTC on the next pin (A1, A3, A9, A11).
+     * @param gain           10 or 200.
+     * @param referenceRatio Reference divider output / AVCC.
+     * @param oversampleLog2 log2(conversions summed per reading), 0..6.
+     * @return true if the pair, gain and ratio are supported.
+     */
+    bool useBridge(uint8_t negativePin, uint8_t gain, float referenceRatio,
+                   uint8_t oversampleLog2 = 0);
+
+    /** @brief Check whether useBridge() is in effect. */
+    bool usesBridge() const;
+
+    /**
+     * @brief Re-measure the gain stage offset on the shorted input pair.
+     *
+     * init() does it once; call again (from the task that reads) after
+     * large changes of the board temperature. Off target there is no
+     * gain stage and the offset is 0.
+     *
+     * @return true in bridge mode.
+     */
+    bool calibrateBridgeOffset();
+
+    /** @brief Offset subtracted from each bridge reading (counts). */
+    int16_t getBridgeOffset() const;
+
+    /**
+     * @brief Convert through a precomputed table instead of log().
+     *
+     * Call before init(), which fills the table. Pass NULL to go back to
+     * the Beta equation. Ignored for ADC resolutions below 6 bits.
+     *
+     * @param table Buffer of LUT_ENTRIES int16_t, owned by the caller.
+     */
+    void useLookupTable(int16_t *table);
+
+    /**
+     * @brief Check whether conversions use the lookup table.
+     * @return true if a table is set and the ADC resolution supports it.
+     */
+    bool usesLookupTable() const;
+
+    /**
+     * @brief Convert an ADC count to °C without reading the pin.
+     *
+     * Uses the lookup table when enabled. Useful for averaged or
+     * oversampled counts taken elsewhere; does not update the last-value
+     * accessors.
+     *
+     * @param adc Raw ADC count.
+     * @return float Temperature in °C, or NAN for 0 / full-scale counts.
+     */
+    float convertRawC(uint16_t adc) const;
+
+    /**
+     * @brief ADC count at which a reading equals a temperature.
+     *
+     * Inverse of the Beta equation with the calibration in use, so
+     * thresholds can be mapped to counts once and each sample compared
+     * as an integer (ThresholdAlert::setCountThresholds()). The NTC is on
+     * the ground side of the divider: counts fall as the temperature
+     * rises, so "above 30 °C" is "below rawAtTemperatureC(30)".
+     *
+     * @param tempC Temperature in °C.
+     * @return uint16_t Nearest count, limited to 1 .. full scale − 1.
+     */
+    uint16_t rawAtTemperatureC(float tempC) const;
+
+    /**
+     * @brief Replace the Beta and R0 of the conversion.
+     *
+     * Rebuilds the lookup table when one is in use, so call it from the
+     * task that converts. Non-positive or non-finite values are ignored.
+     *
+     * @param beta     Beta coefficient (K).
+     * @param nominalR Resistance at the nominal temperature (ohms).
+     * @return true if the values were applied.
+     */
+    bool setCalibration(float beta, float nominalR);
+
+    /** @brief Beta coefficient in use (K). */
+    float getBeta() const;
+
+    /** @brief Resistance at the nominal temperature in use (ohms). */
+    float getNominalResistance() const;
+
     /**
      * @brief Read the raw ADC value from the sensor pin.
-     * @return uint16_t Raw ADC value (0 to 2^adcResolution - 1).
+     *
+     * Blocks on analogRead() unless useAdcEngine() selected an engine
+     * slot, in which case the latest decimated value is returned at once.
+     * In bridge mode, the oversampled differential count (off target:
+     * analogRead() of the pin, taken as that count).
+     *
+     * @return uint16_t Raw ADC value (0 to 2^resolution - 1).
      */
     uint16_t readRaw();
 
+    /**
+     * @brief Take raw values from the background AdcEngine.
+     * @param slot Index of this pin in the adcEngineInit() list, or -1
+     *             to return to analogRead(). Ignored in bridge mode.
+     */
+    void useAdcEngine(int8_t slot);
+
     /**
      * @brief Read the NTC resistance calculated from the ADC reading.
      * @return float Resistance in ohms. Returns -1.0 if reading is invalid.
@@ -105,19 +269,68 @@ public:
 
     /**
      * @brief Get the last computed resistance without performing a new reading.
+     *
+     * Derived from the last raw value on demand, so the table-based
+     * conversion does not pay for the division unless this is called.
+     *
      * @return float Last NTC resistance in ohms, or -1.0 if last read was invalid.
      */
     float getLastResistance() const;
 
+    /**
+     * @brief Get the analog pin given to the constructor.
+     * @return uint8_t Pin number (e.g. for an adcEngineInit() list).
+     */
+    uint8_t getPin() const;
+
 private:
+    /** @brief _bridgeMux while single-ended. */
+    static const uint8_t BRIDGE_NONE = 0xFF;
+
+    /**
+     * @brief Beta-equation temperature at a (possibly fractional) ADC count.
+     * @param adc ADC count, 0 < adc < _adcMax.
+     * @return float Temperature in °C.
+     */
+    float betaTemperatureC(float adc) const;
+
+    /**
+     * @brief Divider equation: NTC resistance at an ADC count.
+     * @param adc ADC count, 0 < adc < _adcMax.
+     * @return float Resistance in ohms.
+     */
+    float resistanceFromRaw(float adc) const;
+
+    /** @brief Fill the lookup table from the current Beta / R0. */
+    void buildLookupTable();
+
+    /**
+     * @brief Sum of 2^_oversampleLog2 signed differential conversions.
+     * @param mux MUX5:0 of the input pair and gain.
+     */
+    int32_t bridgeSum(uint8_t mux);
+
+    /** @brief Offset-binary bridge count, 0 / full scale when clipped. */
+    uint16_t readBridge();
+
     uint8_t  _adcPin;          /**< Analog input pin number.                */
     uint32_t _seriesR;         /**< Series resistor value (ohms).           */
-    uint32_t _nominalR;        /**< NTC nominal resistance at T0 (ohms).    */
-    uint16_t _betaCoeff;       /**< Beta coefficient of the NTC.            */
+    float    _nominalR;        /**< NTC nominal resistance at T0 (ohms).    */
+    float    _betaCoeff;       /**< Beta coefficient of the NTC.            */
     float    _nominalTempK;    /**< Nominal temperature in Kelvin.          */
     uint16_t _adcMax;          /**< Maximum ADC value (2^resolution - 1).   */
+    uint8_t  _lutShift;        /**< log2(ADC counts per table segment).     */
+    int16_t *_lut;             /**< Lookup table or NULL.                   */
+    float    _lutBaseC;        /**< Temperature of table value 0 (°C).      */
+    float    _lutStepC;        /**< Temperature per table unit (°C).        */
+    uint16_t _lutScale;        /**< Table units per °C (1 / _lutStepC).     */
+    uint8_t  _bridgeMux;       /**< Shorted-pair MUX5:0, or BRIDGE_NONE.    */
+    uint8_t  _bridgeGain;      /**< Differential gain (10 or 200).          */
+    uint8_t  _oversampleLog2;  /**< log2(conversions per bridge reading).   */
+    float    _bridgeRef;       /**< Reference divider ratio.                */
+    int16_t  _bridgeOffset;    /**< Shorted-pair sum (counts).              */
     uint16_t _lastRaw;         /**< Last raw ADC reading.                   */
-    float    _lastResistance;  /**< Last computed NTC resistance (ohms).    */
+    int8_t   _engineSlot;      /**< AdcEngine slot, or -1 for analogRead(). */
     float    _lastTempC;       /**< Last computed temperature (°C).         */
     bool     _valid;           /**< Validity flag for last reading.         */
 };
@@ -0,0 +1,200 @@
+/**
+ * @file BlockPool.h
+ * @brief Typed Fixed-Block Memory Pool with an O(1) Free List
+ *
+ * Records that live for a moment (a sample on its way to the next task,
+ * a log entry, a frame) are usually copied: into a FreeRTOS queue, out
+ * of it, into the consumer. With malloc()/free() or pvPortMalloc()
+ * instead, the heap fragments and each call takes as long as its search.
+ *
+ * A BlockPool<T, Blocks> reserves Blocks records of one type statically
+ * and chains the free ones through their own storage:
+ *
+ *   _free ─► [slot 3] ─► [slot 0] ─► [slot 4] ─► NULL     (in use: 1, 2)
+ *
+ * allocate() unlinks the head and release() pushes the block back, a few
+ * instructions each with interrupts masked, the same time every call and
+ * never blocking; an empty pool returns NULL and counts the failure. One
+ * pool is one size class; a lab keeps one per record type.
+ *
+ * Zero-copy hand-off: the producer fills the block in place and sends
+ * the pointer (2 bytes on AVR) through a queue of T *; the consumer works
+ * on the block and releases it. The record is never copied on the way,
+ * and the queue storage shrinks to the pointers. A pool with as many
+ * blocks as the queue is deep, plus one per block a consumer holds,
+ * never makes the producer wait on the queue.
+ *
+ * allocate() and release() may be called from tasks and ISRs alike
+ * (ATOMIC_BLOCK with the previous interrupt state restored). release()
+ * refuses pointers from elsewhere and blocks already free, so a double
+ * release cannot corrupt the list. inUse() / highWater() show how deep
+ * the pool really gets: size it from the high-water mark of a long run.
+ *
+ * T must be a plain struct (no constructor or destructor; blocks are
+ * handed out as they were left). Blocks hold at least a pointer.
+ *
+ * Usage:
+ *   static BlockPool<Sample_t, 5> s_pool;
+ *   static StaticQueue<Sample_t *, 5> s_queue;       // StaticRtos.h
+ *
+ *   Sample_t *s = s_pool.allocate();               // producer (task or ISR)
+ *   if (s != NULL) { fill(s); xQueueSend(xQueue, &s, 0); } else { dropped++; }
+ *
+ *   Sample_t *s;                                   // consumer
+ *   xQueueReceive(xQueue, &s, portMAX_DELAY);
+ *   process(*s);
+ *   s_pool.release(s);
+ */
+
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#else
+#ifndef ATOMIC_BLOCK
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+#endif
+
+/**
+ * @class BlockPool
+ * @brief Blocks fixed-size records of T behind an O(1) free list.
+ *
+ * @tparam T      Record type.
+ * @tparam Blocks Records reserved (1..255).
+ */
+template <typename T, uint8_t Blocks>
+class BlockPool {
+    static_assert(Blocks >= 1 && Blocks <= 255, "BlockPool holds 1..255 blocks");
+
+public:
+    BlockPool() { reset(); }
+
+    /**
+     * @brief Take a free block.
+     * @return The block (contents as last left), or NULL if none is free.
+     */
+    T *allocate() {
+        Slot *slot = NULL;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            slot = _free;
+            if (slot != NULL) {
+                _free = slot->next;
+                uint8_t i = (uint8_t)(slot - _slots);
+                _taken[i >> 3] |= (uint8_t)(1U << (i & 7));
+                _inUse++;
+                if (_inUse > _highWater) {
+                    _highWater = _inUse;
+                }
+            } else if (_failures < 0xFFFF) {
+                _failures++;
+            }
+        }
+        return (slot != NULL) ? &slot->item : NULL;
+    }
+
+    /**
+     * @brief Give a block back.
+     * @return false (and nothing changes) if item is NULL, not a block of
+     *         this pool, or already free.
+     */
+    bool release(T *item) {
+        int16_t i = indexOf(item);
+        if (i < 0) {
+            return false;
+        }
+        bool released = false;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            uint8_t bit = (uint8_t)(1U << (i & 7));
+            if (_taken[i >> 3] & bit) {
+                _taken[i >> 3] &= (uint8_t)~bit;
+                _slots[i].next = _free;
+                _free = &_slots[i];
+                _inUse--;
+                released = true;
+            }
+        }
+        return released;
+    }
+
+    /** @brief True if item is one of this pool's blocks (free or not). */
+    bool owns(const T *item) const { return indexOf(item) >= 0; }
+
+    /** @brief Blocks handed out now. */
+    uint8_t inUse() const { return _inUse; }
+
+    /** @brief Blocks free now. */
+    uint8_t available() const { return (uint8_t)(Blocks - _inUse); }
+
+    /** @brief Most blocks in use at once since reset() / resetHighWater(). */
+    uint8_t highWater() const { return _highWater; }
+
+    /** @brief allocate() calls that found the pool empty (saturates at 0xFFFF). */
+    uint16_t failures() const {
+        uint16_t count = 0;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            count = _failures;
+        }
+        return count;
+    }
+
+    /** @brief Restart the high-water mark and the failure count from now. */
+    void resetHighWater() {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            _highWater = _inUse;
+            _failures = 0;
+        }
+    }
+
+    /** @brief Free every block and zero the counters (nothing may hold a block). */
+    void reset() {
+        for (uint8_t i = 0; i < Blocks; i++) {
+            _slots[i].next = (i + 1 < Blocks) ? &_slots[i + 1] : NULL;
+        }
+        for (uint8_t i = 0; i < sizeof(_taken); i++) {
+            _taken[i] = 0;
+        }
+        _free = &_slots[0];
+        _inUse = 0;
+        _highWater = 0;
+        _failures = 0;
+    }
+
+    /** @brief Compile-time capacity. */
+    static constexpr uint8_t capacity() { return Blocks; }
+
+private:
+    /** A block: the record while in use, the free-list link while free. */
+    union Slot {
+        T     item;
+        Slot *next;
+    };
+
+    /** @return Block index of item, or -1 if it is not the start of a block. */
+    int16_t indexOf(const T *item) const {
+        const uint8_t *p = (const uint8_t *)item;
+        const uint8_t *base = (const uint8_t *)_slots;
+        if (p < base || p >= base + sizeof(_slots)) {
+            return -1;
+        }
+        size_t offset = (size_t)(p - base);
+        if (offset % sizeof(Slot) != 0) {
+            return -1;
+        }
+        return (int16_t)(offset / sizeof(Slot));
+    }
+
+    Slot             _slots[Blocks];
+    Slot *volatile   _free;                       ///< Head of the free list
+    uint8_t          _taken[(Blocks + 7) / 8];    ///< Bit per block handed out
+    volatile uint8_t _inUse;
+    volatile uint8_t _highWater;
+    volatile uint16_t _failures;
+};
+
+#endif // BLOCK_POOL_H
@@ -12,21 +12,92 @@
  *      it becomes the new "clean" state and the corresponding rising or
  *      falling edge flag is armed for the application to consume.
  *
- * The driver intentionally encapsulates @c pinMode and @c digitalRead so
+ * In interrupt mode the raw samples are the queued ISR edges instead, and
+ * an edge that follows a full stable window is accepted at once (see
+ * Button.h).
+ *
+ * Interrupt dispatch: attachInterrupt() callbacks take no argument, so
+ * each external interrupt number gets a template trampoline that looks up
+ * its Button; the PCINT vectors (one per 8-pin bank, all aliased to one
+ * handler) check every registered PCINT button for a level change.
+ *
+ * The driver intentionally encapsulates @c pinMode and the pin reads so
  * application/lab modules never call these functions directly.
  */
 
 #include "Button.h"
 
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// ISR dispatch tables
+// ──────────────────────────────────────────────────────────────────────────
+
+/** External interrupt numbers served (Mega: INT0..INT7). */
+static const uint8_t MAX_EXT_INTERRUPTS = 8;
+
+static Button *volatile s_extButtons[MAX_EXT_INTERRUPTS];
+
+template <uint8_t N>
+static void extTrampoline() {
+    Button *button = s_extButtons[N];
+    if (button != NULL) {
+        button->handleEdgeIsr();
+    }
+}
+
+static void (*const EXT_TRAMPOLINES[MAX_EXT_INTERRUPTS])() = {
+    extTrampoline<0>, extTrampoline<1>, extTrampoline<2>, extTrampoline<3>,
+    extTrampoline<4>, extTrampoline<5>, extTrampoline<6>, extTrampoline<7>
+};
+
+#if defined(__AVR__) && defined(PCICR) && !defined(BUTTON_NO_PCINT_ISR)
+#define BUTTON_HAS_PCINT 1
+
+/** Buttons served by the pin-change interrupts. */
+static const uint8_t MAX_PCINT_BUTTONS = 8;
+
+static Button *s_pcintButtons[MAX_PCINT_BUTTONS];
+static volatile uint8_t s_pcintCount = 0;
+
+ISR(PCINT0_vect) {
+    for (uint8_t i = 0; i < s_pcintCount; i++) {
+        s_pcintButtons[i]->handleEdgeIsr();
+    }
+}
+#if defined(PCINT1_vect)
+ISR(PCINT1_vect, ISR_ALIASOF(PCINT0_vect));
+#endif
+#if defined(PCINT2_vect)
+ISR(PCINT2_vect, ISR_ALIASOF(PCINT0_vect));
+#endif
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Construction / polling mode
+// ──────────────────────────────────────────────────────────────────────────
+
 Button::Button(uint8_t pin, bool activeLow, uint16_t debounceMs)
     : _pin(pin),
       _activeLow(activeLow),
       _debounceMs(debounceMs),
+      _debounceUs((uint32_t)debounceMs * 1000UL),
       _stableState(false),
       _lastRawState(false),
-      _lastChangeMs(0),
+      _lastChangeUs(0),
       _pressedFlag(false),
-      _releasedFlag(false) {}
+      _releasedFlag(false),
+      _edgeUs(0),
+      _listener(NULL),
+      _listenerArg(NULL),
+      _interrupt(false),
+      _onEdge(NULL),
+      _inputReg(NULL),
+      _bitMask(0),
+      _isrLevel(0),
+      _queueOverflow(false) {}
 
 void Button::init() {
     // Configure the pin direction and pull-up according to the wiring.
@@ -36,35 +107,43 @@ void Button::init() {
         pinMode(_pin, INPUT);
     }
 
+#if defined(__AVR__)
+    // Resolve PINx and the bit once: every poll is then a load and a mask
+    // instead of a digitalRead() table walk.
+    _inputReg = portInputRegister(digitalPinToPort(_pin));
+    _bitMask  = digitalPinToBitMask(_pin);
+#endif
+
     // Take an initial reading so the first update() does not generate a
     // spurious edge from an uninitialised "previous" state.
     _lastRawState  = readLogical();
     _stableState   = _lastRawState;
-    _lastChangeMs  = millis();
+    _lastChangeUs  = micros();
+    _edgeUs        = _lastChangeUs;
     _pressedFlag   = false;
     _releasedFlag  = false;
 }
 
 void Button::update() {
+    if (_interrupt) {
+        drainQueue();
+        return;
+    }
+
     bool raw = readLogical();
-    uint32_t now = millis();
+    uint32_t now = micros();
 
     // Detect a transition in the raw reading and (re)arm the debounce timer.
     if (raw != _lastRawState) {
         _lastRawState = raw;
-        _lastChangeMs = now;
+        _lastChangeUs = now;
         return;
     }
 
     // The raw level has been stable; commit it as the new debounced state
     // once the configured stable window has elapsed.
-    if (raw != _stableState && (now - _lastChangeMs) >= _debounceMs) {
-        _stableState = raw;
-        if (_stableState) {
-            _pressedFlag = true;     // rising edge: idle -> pressed
-        } else {
-            _releasedFlag = true;    // falling edge: pressed -> idle
-        }
+    if (raw != _stableState && (now - _lastChangeUs) >= _debounceUs) {
+        accept(raw);
     }
 }
 
@@ -73,20 +152,161 @@ bool Button::isPressed() const {
 }
 
 bool Button::wasPressed() {
+    if (_interrupt) {
+        drainQueue();
+    }
     bool flag = _pressedFlag;
     _pressedFlag = false;            // one-shot: consume the event
     return flag;
 }
 
 bool Button::wasReleased() {
+    if (_interrupt) {
+        drainQueue();
+    }
     bool flag = _releasedFlag;
     _releasedFlag = false;
     return flag;
 }
 
 bool Button::readLogical() const {
-    int level = digitalRead(_pin);
+    uint8_t level = readLevelFast();
     // Convert the electrical level into a logical "pressed = true" boolean
     // based on the configured polarity.
     return _activeLow ? (level == LOW) : (level == HIGH);
 }
+
+void Button::accept(bool state) {
+    _stableState = state;
+    _edgeUs = _lastChangeUs;         // Start of the level now accepted
+    if (_stableState) {
+        _pressedFlag = true;         // rising edge: idle -> pressed
+    } else {
+        _releasedFlag = true;        // falling edge: pressed -> idle
+    }
+    if (_listener != NULL) {
+        _listener(state, _edgeUs, _listenerArg);
+    }
+}
+
+uint32_t Button::getLastEdgeUs() const {
+    return _edgeUs;
+}
+
+void Button::setEdgeListener(EdgeListener listener, void *arg) {
+    _listener = listener;
+    _listenerArg = arg;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Interrupt mode
+// ──────────────────────────────────────────────────────────────────────────
+
+bool Button::enableInterrupt(void (*onEdge)()) {
+    if (_interrupt) {
+        return true;
+    }
+
+    _onEdge   = onEdge;
+    _isrLevel = readLevelFast();
+    _queue.clear();
+    _queueOverflow = false;
+
+    int irq = digitalPinToInterrupt(_pin);
+    if (irq != NOT_AN_INTERRUPT && irq < MAX_EXT_INTERRUPTS) {
+        s_extButtons[irq] = this;
+        _interrupt = true;
+        attachInterrupt(irq, EXT_TRAMPOLINES[irq], CHANGE);
+        return true;
+    }
+
+#if defined(BUTTON_HAS_PCINT)
+    volatile uint8_t *pcicr = digitalPinToPCICR(_pin);
+    if (pcicr != NULL && s_pcintCount < MAX_PCINT_BUTTONS) {
+        uint8_t oldSreg = SREG;
+        cli();
+        s_pcintButtons[s_pcintCount] = this;
+        s_pcintCount = s_pcintCount + 1;
+        _interrupt = true;
+        *digitalPinToPCMSK(_pin) |= _BV(digitalPinToPCMSKbit(_pin));
+        *pcicr |= _BV(digitalPinToPCICRbit(_pin));
+        SREG = oldSreg;
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+bool Button::isInterruptDriven() const {
+    return _interrupt;
+}
+
+uint16_t Button::getDroppedEdges() const {
+    return _queue.dropped();
+}
+
+uint8_t Button::readLevelFast() const {
+#if defined(__AVR__)
+    if (_inputReg != NULL) {
+        return (*_inputReg & _bitMask) ? HIGH : LOW;
+    }
+#endif
+    return (uint8_t)digitalRead(_pin);
+}
+
+void Button::handleEdgeIsr() {
+    // A PCINT fires for any pin of the bank, and contacts may bounce
+    // faster than the ISR: only queue actual level changes.
+    uint8_t level = readLevelFast();
+    if (level == _isrLevel) {
+        return;
+    }
+    _isrLevel = level;
+
+    QueuedEdge edge;
+    edge.us    = micros();
+    edge.level = level;
+    if (!_queue.push(edge)) {
+        _queueOverflow = true;       // Consumer re-reads the pin
+        return;
+    }
+
+    if (_onEdge != NULL) {
+        _onEdge();
+    }
+}
+
+void Button::drainQueue() {
+    QueuedEdge edge;
+    while (_queue.pop(&edge)) {
+        bool raw = _activeLow ? (edge.level == LOW) : (edge.level == HIGH);
+        applyEdge(raw, edge.us);
+    }
+
+    if (_queueOverflow) {
+        _queueOverflow = false;
+        applyEdge(readLogical(), micros());
+    }
+
+    // Trailing resync: bounce ended on a level other than the accepted one.
+    if (_lastRawState != _stableState &&
+        (micros() - _lastChangeUs) >= _debounceUs) {
+        accept(_lastRawState);
+    }
+}
+
+void Button::applyEdge(bool raw, uint32_t us) {
+    if (raw == _lastRawState) {
+        return;
+    }
+    bool quiet = (us - _lastChangeUs) >= _debounceUs;
+    _lastRawState = raw;
+    _lastChangeUs = us;
+
+    // Leading edge: the previous level held for a full window, so this
+    // edge is a real transition; respond without waiting for the bounce.
+    if (quiet && raw != _stableState) {
+        accept(raw);
+    }
+}
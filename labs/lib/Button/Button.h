@@ -14,6 +14,21 @@
  *   - Active-HIGH (external pull-down resistor; button drives the pin
  *     to VCC), selected via the optional constructor parameter.
  *
+ * Interrupt mode (optional, enableInterrupt()):
+ *   An INTx (attachInterrupt) or pin-change (PCINT) interrupt timestamps
+ *   every raw edge with micros() into a small lock-free single-producer /
+ *   single-consumer queue; update(), wasPressed() and wasReleased() drain
+ *   it and debounce on the timestamps:
+ *     - an edge after the level was stable for the debounce window is
+ *       accepted immediately (leading-edge debounce: no added latency),
+ *     - edges inside the window only track the raw level; if it ends
+ *       different from the accepted state, that level is accepted once it
+ *       has been stable for the window (update() must then be called
+ *       again, e.g. from a slow periodic task).
+ *   A press is never missed even if the application is busy for a while.
+ *   If bounce fills the queue, further edges are dropped and the pin is
+ *   re-read when the queue is drained, so the final level is still right.
+ *
  * Typical usage in an application loop:
  * @code
  *   Button btn(7);
@@ -24,6 +39,11 @@
  *           // handle a confirmed press edge
  *       }
  *   }
+ *
+ *   // Interrupt mode (pin with INTx or PCINT, e.g. D2):
+ *   Button btn2(2);
+ *   btn2.init();
+ *   btn2.enableInterrupt(onEdge);   // onEdge() runs in the ISR
  * @endcode
  */
 
@@ -32,6 +52,16 @@
 
 #include <Arduino.h>
 
+#include "SpscRing.h"
+
+/**
+ * @brief Raw edges buffered per button in interrupt mode (power of two, 2..128).
+ * Override with -DBUTTON_QUEUE_SIZE=<n>.
+ */
+#ifndef BUTTON_QUEUE_SIZE
+#define BUTTON_QUEUE_SIZE 16
+#endif
+
 /**
  * @class Button
  * @brief Debounced push-button reader.
@@ -43,6 +73,15 @@
  */
 class Button {
 public:
+    /**
+     * @brief Debounced-edge listener (task context, from update() /
+     *        wasPressed() / wasReleased()).
+     * @param pressed true for a press edge, false for a release edge.
+     * @param us      micros() at which the edge happened.
+     * @param arg     Argument given to setEdgeListener().
+     */
+    typedef void (*EdgeListener)(bool pressed, uint32_t us, void *arg);
+
     /**
      * @brief Construct a new Button driver.
      * @param pin           GPIO pin number wired to the button.
@@ -72,6 +111,39 @@ public:
      */
     void update();
 
+    /**
+     * @brief Switch to interrupt-driven sampling (call after init()).
+     *
+     * Uses the pin's external interrupt when it has one, otherwise its
+     * pin-change interrupt (PCINT). The PCINT vectors are defined by this
+     * driver unless built with -DBUTTON_NO_PCINT_ISR.
+     *
+     * @param onEdge Optional callback run in interrupt context after each
+     *               queued edge (e.g. schedulerSignal() of an event task).
+     * @return true on success; false if the pin has no usable interrupt
+     *         (the driver then keeps polling in update()).
+     */
+    bool enableInterrupt(void (*onEdge)() = NULL);
+
+    /**
+     * @brief Check whether the button is interrupt-driven.
+     * @return true after a successful enableInterrupt().
+     */
+    bool isInterruptDriven() const;
+
+    /**
+     * @brief Interrupt mode: edges dropped because the queue was full.
+     * @return uint16_t Dropped edge count (saturates).
+     */
+    uint16_t getDroppedEdges() const;
+
+    /**
+     * @brief Interrupt handler body: timestamp and queue one raw edge.
+     *
+     * Called by the driver's ISR trampolines; not for application use.
+     */
+    void handleEdgeIsr();
+
     /**
      * @brief Query the debounced (stable) button state.
      * @return true if the button is currently held pressed.
@@ -83,6 +155,7 @@ public:
      *
      * Returns true exactly once per confirmed press: the flag is consumed
      * by the call. Designed to be polled directly from an FSM driver.
+     * In interrupt mode the edge queue is drained first.
      *
      * @return true if a clean press edge was detected since the last call.
      */
@@ -94,23 +167,71 @@ public:
      */
     bool wasReleased();
 
+    /**
+     * @brief micros() of the last accepted (debounced) edge.
+     *
+     * In interrupt mode this is the ISR timestamp of the raw edge, not the
+     * time it was drained.
+     */
+    uint32_t getLastEdgeUs() const;
+
+    /**
+     * @brief Receive every accepted edge with its timestamp, in order
+     *        (e.g. ButtonGesture). The one-shot flags keep working.
+     * @param listener Callback, or NULL to remove it.
+     * @param arg      Passed to the callback.
+     */
+    void setEdgeListener(EdgeListener listener, void *arg);
+
 private:
     uint8_t  _pin;             ///< GPIO pin number
     bool     _activeLow;       ///< true if pressed = LOW, false if pressed = HIGH
     uint16_t _debounceMs;      ///< Debounce window in milliseconds
+    uint32_t _debounceUs;      ///< Debounce window in microseconds
 
     bool     _stableState;     ///< Last accepted (debounced) logical state (true = pressed)
     bool     _lastRawState;    ///< Last raw sample (logical, post-polarity correction)
-    uint32_t _lastChangeMs;    ///< Timestamp of the last raw transition
+    uint32_t _lastChangeUs;    ///< micros() of the last raw transition
 
     bool     _pressedFlag;     ///< Latched rising edge, cleared by wasPressed()
     bool     _releasedFlag;    ///< Latched falling edge, cleared by wasReleased()
+    uint32_t _edgeUs;          ///< micros() of the last accepted edge
+    EdgeListener _listener;    ///< Accepted-edge subscriber
+    void    *_listenerArg;     ///< Argument for _listener
+
+    // ── Interrupt mode ──────────────────────────────────────────────
+    bool     _interrupt;                     ///< true after enableInterrupt()
+    void   (*_onEdge)();                     ///< ISR-context edge callback
+    volatile uint8_t *_inputReg;             ///< PINx register of the pin (init())
+    uint8_t  _bitMask;                       ///< Pin bit in _inputReg
+    uint8_t  _isrLevel;                      ///< Last level seen by the ISR (PCINT)
+
+    /** @brief One raw edge, as queued by the ISR. */
+    typedef struct {
+        uint32_t us;                         ///< Timestamp (micros)
+        uint8_t  level;                      ///< Electrical level after the edge
+    } QueuedEdge;
+
+    SpscRing<QueuedEdge, BUTTON_QUEUE_SIZE> _queue;  ///< ISR → drainQueue()
+    volatile bool     _queueOverflow;        ///< An edge was dropped
 
     /**
      * @brief Read the pin and convert the electrical level into a logical
      *        "pressed/not-pressed" boolean according to the polarity setting.
      */
     bool readLogical() const;
+
+    /** @brief Interrupt mode: consume queued edges and debounce them. */
+    void drainQueue();
+
+    /** @brief Debounce one raw logical edge observed at time @p us. */
+    void applyEdge(bool raw, uint32_t us);
+
+    /** @brief Accept a new debounced state and arm the matching flag. */
+    void accept(bool state);
+
+    /** @brief Electrical level of the pin, read the fast way. */
+    uint8_t readLevelFast() const;
 };
 
 #endif // BUTTON_H
@@ -0,0 +1,106 @@
+/**
+ * @file ButtonBank.cpp
+ * @brief Parallel Debouncer Implementation
+ *
+ * See ButtonBank.h for the vertical-counter algorithm. Counters idle at
+ * 3 (ct1 = ct0 = 1) and count 3 → 2 → 1 → 0 → wrap on the fourth
+ * consecutive differing sample, which is when the state bit toggles.
+ */
+
+#include "ButtonBank.h"
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+ButtonBank::ButtonBank(volatile uint8_t *pinReg, uint8_t mask, bool activeLow)
+    : _pinReg(pinReg),
+      _mask(mask),
+      _activeLow(activeLow),
+      _state(0),
+      _ct0(0xFF),
+      _ct1(0xFF),
+      _pressed(0),
+      _released(0) {}
+
+void ButtonBank::init() {
+    // On AVR ports DDRx and PORTx follow PINx in the I/O space.
+    volatile uint8_t *ddr  = _pinReg + 1;
+    volatile uint8_t *port = _pinReg + 2;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        *ddr &= (uint8_t)~_mask;
+        if (_activeLow) {
+            *port |= _mask;                  // Enable pull-ups
+        } else {
+            *port &= (uint8_t)~_mask;
+        }
+    }
+
+    // Let the pull-ups charge the lines before the first sample.
+    delayMicroseconds(5);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _state    = sample();
+        _ct0      = 0xFF;
+        _ct1      = 0xFF;
+        _pressed  = 0;
+        _released = 0;
+    }
+}
+
+uint8_t ButtonBank::sample() const {
+    uint8_t raw = *_pinReg;                  // One load for the whole port
+    if (_activeLow) {
+        raw = (uint8_t)~raw;
+    }
+    return (uint8_t)(raw & _mask);
+}
+
+uint8_t ButtonBank::update() {
+    uint8_t toggle = 0;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t state = _state;
+        uint8_t delta = (uint8_t)(state ^ sample());
+
+        _ct0 = (uint8_t)~(_ct0 & delta);
+        _ct1 = (uint8_t)(_ct0 ^ (_ct1 & delta));
+        toggle = (uint8_t)(delta & _ct0 & _ct1);
+
+        state ^= toggle;
+        _state = state;
+        _pressed  |= (uint8_t)(toggle & state);
+        _released |= (uint8_t)(toggle & ~state);
+    }
+    return toggle;
+}
+
+uint8_t ButtonBank::getPressedMask() const {
+    return _state;
+}
+
+bool ButtonBank::isPressed(uint8_t bit) const {
+    return (_state >> (bit & 0x07)) & 0x01;
+}
+
+uint8_t ButtonBank::wasPressed() {
+    uint8_t edges = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        edges = _pressed;
+        _pressed = 0;
+    }
+    return edges;
+}
+
+uint8_t ButtonBank::wasReleased() {
+    uint8_t edges = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        edges = _released;
+        _released = 0;
+    }
+    return edges;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file ButtonBank.h
+ * @brief Parallel Debouncer for up to 8 Buttons on one GPIO Port
+ *
+ * Button reads and filters one pin per object. ButtonBank instead samples
+ * a whole AVR PINx register with a single load and debounces all eight
+ * bits at once with a 2-bit vertical counter: bit n of the two counter
+ * bytes (ct1:ct0) forms the counter of input n, so one scan is a handful
+ * of bitwise operations regardless of how many buttons are on the port.
+ *
+ * Algorithm (per scan, all bits in parallel):
+ *   delta  = state ^ sample        bits whose input differs from the state
+ *   ct0    = ~(ct0 & delta)        count down while different,
+ *   ct1    = ct0 ^ (ct1 & delta)   reset to 3 when equal again
+ *   toggle = delta & ct0 & ct1     counter wrapped: 4 consecutive samples
+ *   state ^= toggle
+ *
+ * A change is therefore accepted after 4 consecutive agreeing scans, and
+ * any single disagreeing scan restarts that bit's count. Debounce time =
+ * 4 × scan period (e.g. scan every 8 ms → 32 ms).
+ *
+ * Edge reporting: pressed/released masks accumulate per bit until read,
+ * so several buttons changing in the same scan, or between two reads,
+ * are all reported.
+ *
+ * Scan cost: ~20 cycles per bank, so a panel of dozens of buttons on a
+ * few ports costs about the same as a single Button::update(). update()
+ * may run from a timer ISR; the accessors are interrupt-safe.
+ *
+ * The port must be an AVR GPIO port (PINx, with DDRx and PORTx at the
+ * following two I/O addresses, as on every ATmega port).
+ *
+ * Usage:
+ *   // Mega pins 22..29 = PA0..PA7, active-LOW with pull-ups
+ *   ButtonBank panel(&PINA, 0xFF);
+ *   panel.init();
+ *   ...
+ *   panel.update();                       // every 8 ms
+ *   uint8_t pressed = panel.wasPressed(); // bit n = pin PAn pressed
+ *   if (pressed & _BV(3)) { ... }
+ */
+
+#ifndef BUTTON_BANK_H
+#define BUTTON_BANK_H
+
+#include <Arduino.h>
+
+/**
+ * @class ButtonBank
+ * @brief Vertical-counter debouncer over one 8-bit input port.
+ */
+class ButtonBank {
+public:
+    /**
+     * @brief Construct a bank over one input register.
+     * @param pinReg    Port input register (e.g. &PINA).
+     * @param mask      Bits of the port wired to buttons.
+     * @param activeLow true  -> pressed reads LOW (pull-ups enabled).
+     *                  false -> pressed reads HIGH (external pull-downs).
+     */
+    ButtonBank(volatile uint8_t *pinReg, uint8_t mask, bool activeLow = true);
+
+    /**
+     * @brief Configure the masked bits as inputs and reset the filter.
+     *
+     * The current level becomes the initial debounced state, so buttons
+     * already held at startup do not report a press.
+     */
+    void init();
+
+    /**
+     * @brief Sample the port once and advance every bit's debounce count.
+     * @return uint8_t Bits whose debounced state changed in this scan.
+     */
+    uint8_t update();
+
+    /** @brief Debounced state: bit n set while button n is pressed. */
+    uint8_t getPressedMask() const;
+
+    /** @brief True while the button on bit n is (debounced) pressed. */
+    bool isPressed(uint8_t bit) const;
+
+    /**
+     * @brief Consume the accumulated press edges.
+     * @return uint8_t Bits pressed since the previous call.
+     */
+    uint8_t wasPressed();
+
+    /**
+     * @brief Consume the accumulated release edges.
+     * @return uint8_t Bits released since the previous call.
+     */
+    uint8_t wasReleased();
+
+private:
+    /** @brief Masked, polarity-corrected sample (1 = pressed). */
+    uint8_t sample() const;
+
+    volatile uint8_t *_pinReg;         ///< PINx register
+    uint8_t _mask;                     ///< Bits in use
+    bool _activeLow;                   ///< Electrical polarity
+    volatile uint8_t _state;           ///< Debounced state (1 = pressed)
+    uint8_t _ct0;                      ///< Vertical counter, low bits
+    uint8_t _ct1;                      ///< Vertical counter, high bits
+    volatile uint8_t _pressed;         ///< Accumulated press edges
+    volatile uint8_t _released;        ///< Accumulated release edges
+};
+
+#endif // BUTTON_BANK_H
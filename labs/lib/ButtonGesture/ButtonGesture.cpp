@@ -0,0 +1,213 @@
+/**
+ * @file ButtonGesture.cpp
+ * @brief Click / Double-Click / Long-Press / Repeat Recognizer Implementation
+ *
+ * State machine (timeouts in parentheses):
+ *
+ *   IDLE         --press-->   DOWN          (longPress)
+ *   DOWN         --release--> WAIT_SECOND   (doubleClick) | CLICK, IDLE
+ *   DOWN         --timeout--> HOLD          LONG_PRESS    (repeat)
+ *   WAIT_SECOND  --press-->   DOWN_SECOND   (longPress)
+ *   WAIT_SECOND  --timeout--> IDLE          CLICK
+ *   DOWN_SECOND  --release--> IDLE          DOUBLE_CLICK
+ *   DOWN_SECOND  --timeout--> HOLD          CLICK, LONG_PRESS (repeat)
+ *   HOLD         --timeout--> HOLD          REPEAT        (repeat)
+ *   HOLD         --release--> IDLE
+ *
+ * An edge whose timestamp is at or past the armed deadline first runs the
+ * timeout, so the outcome depends only on the edge times even when edges
+ * and update() are processed late.
+ */
+
+#include "ButtonGesture.h"
+
+/** Queue index mask; BUTTON_GESTURE_QUEUE_SIZE must be a power of two. */
+static const uint8_t QUEUE_MASK = BUTTON_GESTURE_QUEUE_SIZE - 1;
+
+ButtonGesture::ButtonGesture(uint16_t longPressMs, uint16_t doubleClickMs,
+                             uint16_t repeatMs)
+    : _longPressUs((uint32_t)longPressMs * 1000UL),
+      _doubleClickUs((uint32_t)doubleClickMs * 1000UL),
+      _repeatUs((uint32_t)repeatMs * 1000UL),
+      _state(GS_IDLE),
+      _armed(false),
+      _deadlineUs(0),
+      _callback(NULL),
+      _callbackArg(NULL),
+      _head(0),
+      _tail(0),
+      _dropped(0) {}
+
+void ButtonGesture::attach(Button &button) {
+    _armed = false;
+    _state = GS_IDLE;
+    if (button.isPressed()) {
+        // Already held: time the long press from its real start.
+        _state = GS_DOWN;
+        _deadlineUs = button.getLastEdgeUs() + _longPressUs;
+        _armed = true;
+    }
+    button.setEdgeListener(onButtonEdge, this);
+}
+
+void ButtonGesture::setCallback(Callback callback, void *arg) {
+    _callback = callback;
+    _callbackArg = arg;
+}
+
+void ButtonGesture::onButtonEdge(bool pressed, uint32_t us, void *arg) {
+    static_cast<ButtonGesture *>(arg)->handleEdge(pressed, us);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// State machine
+// ──────────────────────────────────────────────────────────────────────────
+
+void ButtonGesture::handleEdge(bool pressed, uint32_t us) {
+    // A timeout that expired before this edge happened comes first
+    // (missed REPEATs of a stalled caller are not replayed).
+    if (_armed && (int32_t)(us - _deadlineUs) >= 0) {
+        expire();
+    }
+
+    switch (_state) {
+        case GS_IDLE:
+            if (pressed) {
+                _state = GS_DOWN;
+                _deadlineUs = us + _longPressUs;
+                _armed = true;
+            }
+            break;
+
+        case GS_DOWN:
+            if (!pressed) {
+                if (_doubleClickUs == 0) {
+                    _state = GS_IDLE;
+                    _armed = false;
+                    emit(GESTURE_CLICK);
+                } else {
+                    _state = GS_WAIT_SECOND;
+                    _deadlineUs = us + _doubleClickUs;
+                }
+            }
+            break;
+
+        case GS_WAIT_SECOND:
+            if (pressed) {
+                _state = GS_DOWN_SECOND;
+                _deadlineUs = us + _longPressUs;
+            }
+            break;
+
+        case GS_DOWN_SECOND:
+            if (!pressed) {
+                _state = GS_IDLE;
+                _armed = false;
+                emit(GESTURE_DOUBLE_CLICK);
+            }
+            break;
+
+        case GS_HOLD:
+            if (!pressed) {
+                _state = GS_IDLE;
+                _armed = false;
+            }
+            break;
+    }
+}
+
+void ButtonGesture::expire() {
+    switch (_state) {
+        case GS_DOWN_SECOND:
+            emit(GESTURE_CLICK);     // The first click stands on its own
+            // fall through
+        case GS_DOWN:
+            emit(GESTURE_LONG_PRESS);
+            _state = GS_HOLD;
+            if (_repeatUs != 0) {
+                _deadlineUs += _repeatUs;
+            } else {
+                _armed = false;
+            }
+            break;
+
+        case GS_WAIT_SECOND:
+            emit(GESTURE_CLICK);
+            _state = GS_IDLE;
+            _armed = false;
+            break;
+
+        case GS_HOLD:
+            emit(GESTURE_REPEAT);
+            _deadlineUs += _repeatUs;
+            break;
+
+        case GS_IDLE:
+            _armed = false;
+            break;
+    }
+}
+
+void ButtonGesture::update() {
+    if (!_armed) {
+        return;
+    }
+    uint32_t now = micros();
+    if ((int32_t)(now - _deadlineUs) < 0) {
+        return;
+    }
+    expire();
+
+    // After a long stall, report one REPEAT and resume from now instead
+    // of bursting every missed period.
+    if (_armed && (int32_t)(now - _deadlineUs) >= 0) {
+        _deadlineUs = now + _repeatUs;
+    }
+}
+
+bool ButtonGesture::isDeadlinePending() const {
+    return _armed;
+}
+
+uint32_t ButtonGesture::msUntilDeadline() const {
+    if (!_armed) {
+        return UINT32_MAX;
+    }
+    int32_t remaining = (int32_t)(_deadlineUs - micros());
+    if (remaining <= 0) {
+        return 0;
+    }
+    return ((uint32_t)remaining + 999UL) / 1000UL;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Event delivery
+// ──────────────────────────────────────────────────────────────────────────
+
+void ButtonGesture::emit(ButtonGestureEvent_e event) {
+    uint8_t next = (uint8_t)((_head + 1) & QUEUE_MASK);
+    if (next == _tail) {
+        if (_dropped < 0xFFFF) {
+            _dropped++;
+        }
+    } else {
+        _queue[_head] = event;
+        _head = next;
+    }
+    if (_callback != NULL) {
+        _callback(event, _callbackArg);
+    }
+}
+
+bool ButtonGesture::read(ButtonGestureEvent_e *event) {
+    if (_tail == _head) {
+        return false;
+    }
+    *event = _queue[_tail];
+    _tail = (uint8_t)((_tail + 1) & QUEUE_MASK);
+    return true;
+}
+
+uint16_t ButtonGesture::getDroppedEvents() const {
+    return _dropped;
+}
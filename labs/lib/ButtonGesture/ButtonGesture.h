@@ -0,0 +1,159 @@
+/**
+ * @file ButtonGesture.h
+ * @brief Click / Double-Click / Long-Press / Repeat Recognizer
+ *
+ * Turns the timestamped, debounced edges of one Button into gestures, so
+ * a few buttons can carry as many actions as a small keypad:
+ *
+ *   CLICK         press + release, no second press within doubleClickMs
+ *   DOUBLE_CLICK  two clicks, the second press within doubleClickMs
+ *   LONG_PRESS    held for longPressMs
+ *   REPEAT        every repeatMs while still held after a LONG_PRESS
+ *
+ * Cost model: edges are pushed in by the Button's edge listener (no
+ * polling). Only the timeouts (double-click window, long-press and repeat
+ * times) need a call to update(), and only while one is armed:
+ * isDeadlinePending() / msUntilDeadline() tell the caller when, e.g. to
+ * set a scheduler task's next run or a vTaskDelay(). Timing uses the edge
+ * timestamps, so a late update() does not shift the result.
+ *
+ * With doubleClickMs = 0 double-click detection is off and CLICK is
+ * reported on the release itself.
+ *
+ * Events are queued (read()) and, if set, also passed to a callback.
+ *
+ * Usage:
+ *   static Button btn(2);
+ *   static ButtonGesture gesture;                 // 800 / 300 / 200 ms
+ *   btn.init();
+ *   btn.enableInterrupt(onEdge);                  // or poll btn.update()
+ *   gesture.attach(btn);
+ *   ...
+ *   btn.update();                                  // delivers edges
+ *   gesture.update();                              // fires timeouts
+ *   ButtonGestureEvent_e ev;
+ *   while (gesture.read(&ev)) {
+ *       if (ev == GESTURE_DOUBLE_CLICK) { ... }
+ *   }
+ */
+
+#ifndef BUTTON_GESTURE_H
+#define BUTTON_GESTURE_H
+
+#include <Arduino.h>
+
+#include "Button.h"
+
+/**
+ * @brief Events buffered until read (power of two).
+ * Override with -DBUTTON_GESTURE_QUEUE_SIZE=<n>.
+ */
+#ifndef BUTTON_GESTURE_QUEUE_SIZE
+#define BUTTON_GESTURE_QUEUE_SIZE 4
+#endif
+
+/**
+ * @enum ButtonGestureEvent_e
+ * @brief Recognized gestures.
+ */
+typedef enum {
+    GESTURE_NONE = 0,
+    GESTURE_CLICK,          /**< Single short press.                    */
+    GESTURE_DOUBLE_CLICK,   /**< Two short presses in quick succession. */
+    GESTURE_LONG_PRESS,     /**< Held for the long-press time.          */
+    GESTURE_REPEAT          /**< Still held, once per repeat period.    */
+} ButtonGestureEvent_e;
+
+/**
+ * @class ButtonGesture
+ * @brief Gesture FSM over one button's debounced edges.
+ */
+class ButtonGesture {
+public:
+    /** @brief Event callback (task context). */
+    typedef void (*Callback)(ButtonGestureEvent_e event, void *arg);
+
+    /**
+     * @brief Construct a recognizer.
+     * @param longPressMs   Hold time for LONG_PRESS.
+     * @param doubleClickMs Second-press window (0 = no double-click).
+     * @param repeatMs      REPEAT period after LONG_PRESS (0 = no repeat).
+     */
+    ButtonGesture(uint16_t longPressMs = 800, uint16_t doubleClickMs = 300,
+                  uint16_t repeatMs = 200);
+
+    /**
+     * @brief Subscribe to a button's edges (replaces its edge listener).
+     *        The recognizer starts from the button's current state.
+     */
+    void attach(Button &button);
+
+    /** @brief Set the optional event callback (NULL removes it). */
+    void setCallback(Callback callback, void *arg);
+
+    /**
+     * @brief Feed one debounced edge (done by attach()'s listener).
+     * @param pressed true = press, false = release.
+     * @param us      micros() timestamp of the edge.
+     */
+    void handleEdge(bool pressed, uint32_t us);
+
+    /** @brief Fire an expired timeout, if any (cheap when none is armed). */
+    void update();
+
+    /** @brief True while a timeout is armed, i.e. update() is needed. */
+    bool isDeadlinePending() const;
+
+    /**
+     * @brief Time until update() has work to do.
+     * @return uint32_t ms (0 if already due); UINT32_MAX if none is armed.
+     */
+    uint32_t msUntilDeadline() const;
+
+    /**
+     * @brief Pop the oldest recognized gesture.
+     * @param event Receives the event.
+     * @return true if an event was returned.
+     */
+    bool read(ButtonGestureEvent_e *event);
+
+    /** @brief Events lost to a full queue (saturates). */
+    uint16_t getDroppedEvents() const;
+
+private:
+    /** @brief FSM states. */
+    typedef enum {
+        GS_IDLE,          /**< Released, nothing pending.               */
+        GS_DOWN,          /**< First press held, long-press timer armed. */
+        GS_WAIT_SECOND,   /**< Released, double-click window open.      */
+        GS_DOWN_SECOND,   /**< Second press held.                       */
+        GS_HOLD           /**< Long press reported, repeating.          */
+    } State_e;
+
+    /** @brief Button edge trampoline. */
+    static void onButtonEdge(bool pressed, uint32_t us, void *arg);
+
+    /** @brief Run the timeout of the current state (deadline reached). */
+    void expire();
+
+    /** @brief Queue an event and run the callback. */
+    void emit(ButtonGestureEvent_e event);
+
+    uint32_t _longPressUs;
+    uint32_t _doubleClickUs;
+    uint32_t _repeatUs;
+
+    State_e  _state;
+    bool     _armed;              ///< _deadlineUs is valid
+    uint32_t _deadlineUs;         ///< micros() of the pending timeout
+
+    Callback _callback;
+    void    *_callbackArg;
+
+    ButtonGestureEvent_e _queue[BUTTON_GESTURE_QUEUE_SIZE];
+    uint8_t  _head;
+    uint8_t  _tail;
+    uint16_t _dropped;
+};
+
+#endif // BUTTON_GESTURE_H
@@ -3,9 +3,10 @@
  * @brief Button-LED Finite State Machine Implementation
  *
  * Implements the two-state Moore automaton declared in ButtonLedFsm.h.
- * The whole behaviour is encoded in the @c _table constant: each row
- * carries the Moore output for the state and the next-state lookup
- * indexed by the input value (0 = no press, 1 = press detected).
+ * The whole behaviour is encoded in the BUTTON_LED_TABLE constant: each
+ * row carries the Moore output for the state and the next-state lookup
+ * indexed by the input value (0 = no press, 1 = press detected); the
+ * TableFsm engine only looks cells up.
  *
  * This mirrors one-to-one the table presented in the laboratory manual
  * (Listing 7.3), so the implementation is a direct realisation of the
@@ -14,50 +15,53 @@
 
 #include "ButtonLedFsm.h"
 
-// State transition / output table.
-// Row index = current state. Column "next[0]" is the next state when the
-// input is 0 (no press), "next[1]" when the input is 1 (press detected).
-const ButtonLedFsm::StateRow ButtonLedFsm::_table[BUTTON_LED_STATE_COUNT] = {
-    // LED_OFF_STATE: output 0; idle if input 0, switch ON if input 1.
-    { 0, { LED_OFF_STATE, LED_ON_STATE  } },
-    // LED_ON_STATE : output 1; idle if input 0, switch OFF if input 1.
-    { 1, { LED_ON_STATE,  LED_OFF_STATE } }
+// State transition / output table (Listing 7.3), stored in flash.
+// Moore row = output per state. Column BUTTON_LED_EVENT_IDLE is the next
+// state when the input is 0 (no press), BUTTON_LED_EVENT_PRESS when it is
+// 1 (press detected). No Mealy outputs, no guards.
+static constexpr ButtonLedTableFsm::Table BUTTON_LED_TABLE PROGMEM = {
+    // LED_OFF_STATE, LED_ON_STATE
+    { 0, 1 },
+    {
+        // LED_OFF_STATE: idle if input 0, switch ON if input 1.
+        { { LED_OFF_STATE, TABLE_FSM_NONE, TABLE_FSM_NONE },
+          { LED_ON_STATE,  TABLE_FSM_NONE, TABLE_FSM_NONE } },
+        // LED_ON_STATE : idle if input 0, switch OFF if input 1.
+        { { LED_ON_STATE,  TABLE_FSM_NONE, TABLE_FSM_NONE },
+          { LED_OFF_STATE, TABLE_FSM_NONE, TABLE_FSM_NONE } }
+    }
 };
+static_assert(tableFsmIsValid(BUTTON_LED_TABLE, 0), "Button-LED table out of range");
 
 ButtonLedFsm::ButtonLedFsm()
-    : _state(LED_OFF_STATE), _changed(true) {}
+    : _fsm(&BUTTON_LED_TABLE, LED_OFF_STATE) {}
 
 void ButtonLedFsm::init() {
-    _state   = LED_OFF_STATE;
-    _changed = true;            // request an initial refresh of the output
+    _fsm.init();                // back to OFF, requests an initial refresh
 }
 
 void ButtonLedFsm::processEvent() {
     // The Button driver delivers one-shot, debounced edges, so reaching
     // this function is equivalent to "input = 1" in the table.
-    ButtonLedState next = _table[_state].next[1];
-    if (next != _state) {
-        _state   = next;
-        _changed = true;
-    }
+    _fsm.dispatch(BUTTON_LED_EVENT_PRESS);
 }
 
 ButtonLedState ButtonLedFsm::getState() const {
-    return _state;
+    return (ButtonLedState)_fsm.getState();
 }
 
 uint8_t ButtonLedFsm::getOutput() const {
-    return _table[_state].output;
+    return _fsm.getMooreOutput();
 }
 
 const char *ButtonLedFsm::getStateName() const {
-    return (_state == LED_ON_STATE) ? "ON" : "OFF";
+    return (_fsm.getState() == LED_ON_STATE) ? "ON" : "OFF";
 }
 
 bool ButtonLedFsm::changed() const {
-    return _changed;
+    return _fsm.changed();
 }
 
 void ButtonLedFsm::clearChanged() {
-    _changed = false;
+    _fsm.clearChanged();
 }
@@ -21,6 +21,9 @@
  * and reusable across different output devices (digital LED, LCD line,
  * relay, serial log, etc.).
  *
+ * The table is run by the generic TableFsm engine (TableFsm.h): it lives
+ * in flash and each event is a single indexed lookup.
+ *
  * Example wiring at the application layer:
  * @code
  *   ButtonLedFsm fsm;
@@ -36,6 +39,7 @@
 #define BUTTON_LED_FSM_H
 
 #include <stdint.h>
+#include "TableFsm.h"
 
 /**
  * @enum ButtonLedState
@@ -51,6 +55,20 @@ enum ButtonLedState {
     BUTTON_LED_STATE_COUNT
 };
 
+/**
+ * @enum ButtonLedEvent
+ * @brief Input values of the automaton (table columns).
+ */
+enum ButtonLedEvent {
+    BUTTON_LED_EVENT_IDLE  = 0,  ///< Input 0: no press.
+    BUTTON_LED_EVENT_PRESS = 1,  ///< Input 1: confirmed press.
+
+    BUTTON_LED_EVENT_COUNT
+};
+
+/** @brief TableFsm instance type of the Button-LED automaton. */
+typedef TableFsm<BUTTON_LED_STATE_COUNT, BUTTON_LED_EVENT_COUNT> ButtonLedTableFsm;
+
 /**
  * @class ButtonLedFsm
  * @brief Two-state Moore FSM that toggles an output on each input event.
@@ -128,23 +146,12 @@ public:
      */
     void clearChanged();
 
-private:
-    /**
-     * @brief Compact state-table row mirroring Listing 7.3 of the manual.
-     *
-     * @c output : Moore output (0 = LED OFF, 1 = LED ON).
-     * @c next   : next-state lookup, indexed by input value (0 or 1).
-     */
-    struct StateRow {
-        uint8_t        output;
-        ButtonLedState next[2];
-    };
-
-    /// State transition / output table — single source of truth for the FSM.
-    static const StateRow _table[BUTTON_LED_STATE_COUNT];
+    /** @brief Record transitions in FsmTrace under id (-DFSM_TRACE_ENABLED). */
+    void setTraceId(uint8_t id) { _fsm.setTraceId(id); }
 
-    ButtonLedState _state;     ///< Current FSM state.
-    bool           _changed;   ///< Latched flag: state has changed since last clear.
+private:
+    /// Engine over the state table in ButtonLedFsm.cpp (state + changed flag).
+    ButtonLedTableFsm _fsm;
 };
 
 #endif // BUTTON_LED_FSM_H
@@ -0,0 +1,229 @@
+/**
+ * @file TableFsm.h
+ * @brief Table-Driven Finite State Machine Engine (PROGMEM tables)
+ *
+ * Generalizes the ButtonLedFsm state table: an FSM is described entirely
+ * by a constant table of S states × E events, and the engine only keeps
+ * the current state. Dispatch is one indexed lookup,
+ *
+ *   cell = table.cell[state][event]      (3 bytes read from flash)
+ *
+ * so every event costs the same time whatever the machine looks like,
+ * and the behaviour can be reviewed as a table instead of a switch.
+ *
+ * Each cell holds
+ *   next   next state (== the current state for "ignore this event")
+ *   output Mealy output of the transition (0 = none), see getMealyOutput()
+ *   guard  1-based index into the guard functions (0 = unguarded); a
+ *          guard returning false leaves state and outputs unchanged
+ *
+ * and each state row a Moore output (getMooreOutput()). Output codes are
+ * plain bytes: the application decides what they drive, which keeps the
+ * tables hardware-independent like ButtonLedFsm.
+ *
+ * Tables are constexpr, so tableFsmIsValid() can reject a next state or
+ * guard index out of range at compile time; on AVR they live in PROGMEM
+ * and cost no RAM.
+ *
+ * With -DFSM_TRACE_ENABLED, state changes of an FSM given a setTraceId()
+ * are recorded in FsmTrace (event = table column).
+ *
+ * Usage:
+ *   enum { DOOR_CLOSED, DOOR_OPEN, DOOR_STATES };
+ *   enum { EV_PUSH, EV_PULL, DOOR_EVENTS };
+ *   static constexpr TableFsmTable<DOOR_STATES, DOOR_EVENTS> DOOR PROGMEM = {
+ *       { 0, 1 },                                    // Moore outputs
+ *       { { { DOOR_CLOSED, 0, 0 }, { DOOR_OPEN,   1, 1 } },   // CLOSED
+ *         { { DOOR_CLOSED, 2, 0 }, { DOOR_OPEN,   0, 0 } } }  // OPEN
+ *   };
+ *   static_assert(tableFsmIsValid(DOOR, 1), "door table");
+ *
+ *   static const TableFsmGuard GUARDS[] = { unlocked };   // guard 1
+ *   TableFsm<DOOR_STATES, DOOR_EVENTS> door(&DOOR, DOOR_CLOSED, GUARDS, 1);
+ *   if (door.dispatch(EV_PULL)) { chime(door.getMealyOutput()); }
+ */
+
+#ifndef TABLE_FSM_H
+#define TABLE_FSM_H
+
+#include <stdint.h>
+#include <string.h>
+#include "FsmTrace.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#elif !defined(PROGMEM)
+#define PROGMEM
+#endif
+
+/** @brief No Mealy output / no guard (cell fields). */
+#define TABLE_FSM_NONE 0
+
+/** @brief One (state, event) cell of the transition table. */
+struct TableFsmCell {
+    uint8_t next;    /**< Next state.                             */
+    uint8_t output;  /**< Mealy output (TABLE_FSM_NONE = none).   */
+    uint8_t guard;   /**< 1-based guard index (TABLE_FSM_NONE).   */
+};
+
+/**
+ * @brief Complete FSM description: Moore outputs and transition cells.
+ * @tparam S Number of states.
+ * @tparam E Number of events.
+ */
+template <uint8_t S, uint8_t E>
+struct TableFsmTable {
+    uint8_t      moore[S];    /**< Moore output of each state. */
+    TableFsmCell cell[S][E];  /**< Row = state, column = event. */
+};
+
+/**
+ * @brief Guard: may the transition for (state, event) be taken?
+ * @param ctx Context pointer given to the TableFsm constructor.
+ */
+typedef bool (*TableFsmGuard)(uint8_t state, uint8_t event, void *ctx);
+
+/**
+ * @brief Compile-time check of every cell (next < S, guard <= guards).
+ *
+ * C++11 constexpr, hence recursive; use it in a static_assert.
+ *
+ * @param guards Number of guard functions the table may reference.
+ */
+template <uint8_t S, uint8_t E>
+constexpr bool tableFsmIsValid(const TableFsmTable<S, E> &table, uint8_t guards,
+                               uint16_t i = 0) {
+    return i >= (uint16_t)S * E
+        || (table.cell[i / E][i % E].next < S
+            && table.cell[i / E][i % E].guard <= guards
+            && tableFsmIsValid(table, guards, (uint16_t)(i + 1)));
+}
+
+/**
+ * @class TableFsm
+ * @brief Runs a TableFsmTable; holds only the state and the last outputs.
+ *
+ * @tparam S Number of states.
+ * @tparam E Number of events.
+ */
+template <uint8_t S, uint8_t E>
+class TableFsm {
+    static_assert(S >= 1 && E >= 1, "an FSM needs a state and an event");
+
+public:
+    typedef TableFsmTable<S, E> Table;
+
+    /**
+     * @param table   Transition table (PROGMEM on AVR).
+     * @param initial State after construction and init().
+     * @param guards  Guard functions referenced by the table (may be NULL).
+     * @param guardCount Number of entries in guards.
+     * @param ctx     Passed to every guard.
+     */
+    TableFsm(const Table *table, uint8_t initial,
+             const TableFsmGuard *guards = NULL, uint8_t guardCount = 0,
+             void *ctx = NULL)
+        : _table(table), _guards(guards), _ctx(ctx),
+          _initial(initial), _guardCount(guardCount) {
+#if defined(FSM_TRACE_ENABLED)
+        _traceId = FSM_TRACE_ID_NONE;
+#endif
+        init();
+    }
+
+    /** @brief Trace state changes under id (no-op without -DFSM_TRACE_ENABLED). */
+    void setTraceId(uint8_t id) {
+#if defined(FSM_TRACE_ENABLED)
+        _traceId = id;
+#else
+        (void)id;
+#endif
+    }
+
+    /** @brief Return to the initial state; flags a change for a first refresh. */
+    void init() {
+        _state = _initial;
+        _mealy = TABLE_FSM_NONE;
+        _changed = true;
+    }
+
+    /**
+     * @brief Feed one event.
+     *
+     * An out-of-range event, a failed guard and a self-loop without an
+     * output do nothing.
+     *
+     * @return true if a transition was taken (state or Mealy output).
+     */
+    bool dispatch(uint8_t event) {
+        if (event >= E) {
+            return false;
+        }
+        TableFsmCell c;
+        readCell(_state, event, &c);
+        if (c.next == _state && c.output == TABLE_FSM_NONE) {
+            return false;
+        }
+        if (c.guard != TABLE_FSM_NONE) {
+            if (_guards == NULL || c.guard > _guardCount
+                || !_guards[c.guard - 1](_state, event, _ctx)) {
+                return false;
+            }
+        }
+        if (c.next != _state) {
+            FSM_TRACE(_traceId, _state, c.next, event);
+            _state = c.next;
+            _changed = true;
+        }
+        _mealy = c.output;
+        return true;
+    }
+
+    /** @brief Current state. */
+    uint8_t getState() const { return _state; }
+
+    /** @brief Moore output of the current state. */
+    uint8_t getMooreOutput() const {
+#if defined(__AVR__)
+        return pgm_read_byte(&_table->moore[_state]);
+#else
+        return _table->moore[_state];
+#endif
+    }
+
+    /** @brief Mealy output of the last transition taken (TABLE_FSM_NONE after init()). */
+    uint8_t getMealyOutput() const { return _mealy; }
+
+    /** @brief True if the state changed since the last clearChanged(). */
+    bool changed() const { return _changed; }
+
+    /** @brief Acknowledge a state change. */
+    void clearChanged() { _changed = false; }
+
+    /** @brief Number of states / events (the template parameters). */
+    static constexpr uint8_t stateCount() { return S; }
+    static constexpr uint8_t eventCount() { return E; }
+
+private:
+    const Table         *_table;
+    const TableFsmGuard *_guards;
+    void                *_ctx;
+    uint8_t _initial;
+    uint8_t _guardCount;
+    uint8_t _state;
+    uint8_t _mealy;
+    bool    _changed;
+#if defined(FSM_TRACE_ENABLED)
+    uint8_t _traceId;
+#endif
+
+    void readCell(uint8_t state, uint8_t event, TableFsmCell *out) const {
+#if defined(__AVR__)
+        memcpy_P(out, &_table->cell[state][event], sizeof(*out));
+#else
+        memcpy(out, &_table->cell[state][event], sizeof(*out));
+#endif
+    }
+};
+
+#endif // TABLE_FSM_H
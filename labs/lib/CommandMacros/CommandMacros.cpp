@@ -0,0 +1,182 @@
+/**
+ * @file CommandMacros.cpp
+ * @brief Named Command Batch Store Implementation
+ */
+
+#include "CommandMacros.h"
+#include "TelemetryFrame.h"
+#include "FlashString.h"
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#else
+/** Host stand-in for the ATmega2560's 4 KB EEPROM. */
+static uint8_t s_hostEeprom[4096];
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Records
+// ──────────────────────────────────────────────────────────────────────────
+
+static uint16_t recordCrc(const CommandMacroRecord &r) {
+    return crc16Ccitt(0xFFFF, (const uint8_t *)&r, (uint8_t)offsetof(CommandMacroRecord, crc));
+}
+
+/** @brief Case-insensitive compare of a name with a stored (lowercase, padded) one. */
+static bool nameMatches(const CommandMacroRecord &r, const char *name, uint8_t nameLen) {
+    for (uint8_t i = 0; i < nameLen; i++) {
+        if (r.name[i] != (char)tolower((unsigned char)name[i])) {
+            return false;
+        }
+    }
+    return nameLen == COMMAND_MACRO_NAME_MAX || r.name[nameLen] == '\0';
+}
+
+CommandMacros::CommandMacros(uint16_t eepromAddress, uint8_t slots)
+    : _address(eepromAddress), _slots(slots), _running(false) {}
+
+bool CommandMacros::readSlot(uint8_t slot, CommandMacroRecord *record) const {
+    uint16_t address = (uint16_t)(_address + slot * COMMAND_MACRO_RECORD_BYTES);
+#if defined(__AVR__)
+    eeprom_read_block(record, (const void *)(uintptr_t)address, sizeof(*record));
+#else
+    memcpy(record, &s_hostEeprom[address], sizeof(*record));
+#endif
+    return record->magic == COMMAND_MACRO_MAGIC &&
+           record->textLen > 0 && record->textLen <= COMMAND_MACRO_TEXT_MAX &&
+           record->crc == recordCrc(*record);
+}
+
+void CommandMacros::writeSlot(uint8_t slot, CommandMacroRecord *record) {
+    uint16_t address = (uint16_t)(_address + slot * COMMAND_MACRO_RECORD_BYTES);
+    record->crc = recordCrc(*record);
+#if defined(__AVR__)
+    eeprom_update_block(record, (void *)(uintptr_t)address, sizeof(*record));
+#else
+    memcpy(&s_hostEeprom[address], record, sizeof(*record));
+#endif
+}
+
+/** @return The slot holding name (record filled in), or -1. */
+int16_t CommandMacros::findSlot(const char *name, uint8_t nameLen,
+                                CommandMacroRecord *record) const {
+    if (nameLen == 0 || nameLen > COMMAND_MACRO_NAME_MAX) {
+        return -1;
+    }
+    for (uint8_t slot = 0; slot < _slots; slot++) {
+        if (readSlot(slot, record) && nameMatches(*record, name, nameLen)) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool CommandMacros::define(const char *name, uint8_t nameLen, const char *text,
+                           uint8_t textLen) {
+    if (nameLen == 0 || nameLen > COMMAND_MACRO_NAME_MAX ||
+        textLen == 0 || textLen > COMMAND_MACRO_TEXT_MAX) {
+        return false;
+    }
+
+    // Same name first, else the first free slot
+    CommandMacroRecord record;
+    int16_t slot = findSlot(name, nameLen, &record);
+    for (uint8_t s = 0; slot < 0 && s < _slots; s++) {
+        if (!readSlot(s, &record)) {
+            slot = s;
+        }
+    }
+    if (slot < 0) {
+        return false;
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.magic = COMMAND_MACRO_MAGIC;
+    record.textLen = textLen;
+    for (uint8_t i = 0; i < nameLen; i++) {
+        record.name[i] = (char)tolower((unsigned char)name[i]);
+    }
+    memcpy(record.text, text, textLen);
+    writeSlot((uint8_t)slot, &record);
+    return true;
+}
+
+bool CommandMacros::remove(const char *name, uint8_t nameLen) {
+    CommandMacroRecord record;
+    int16_t slot = findSlot(name, nameLen, &record);
+    if (slot < 0) {
+        return false;
+    }
+    // Clearing the magic frees the slot: one byte written
+    uint16_t address = (uint16_t)(_address + slot * COMMAND_MACRO_RECORD_BYTES);
+#if defined(__AVR__)
+    eeprom_update_byte((uint8_t *)(uintptr_t)address, 0xFF);
+#else
+    s_hostEeprom[address] = 0xFF;
+#endif
+    return true;
+}
+
+bool CommandMacros::load(const char *name, uint8_t nameLen, char *text) const {
+    CommandMacroRecord record;
+    if (findSlot(name, nameLen, &record) < 0) {
+        return false;
+    }
+    memcpy(text, record.text, record.textLen);
+    text[record.textLen] = '\0';
+    return true;
+}
+
+bool CommandMacros::contains(const char *name, uint8_t nameLen) const {
+    CommandMacroRecord record;
+    return findSlot(name, nameLen, &record) >= 0;
+}
+
+CommandStatus CommandMacros::run(const char *name, uint8_t nameLen, const CommandEntry *table,
+                                 uint8_t count, void *context, uint8_t *failedAt) {
+    if (_running) {
+        return COMMAND_BAD_ARGS;  // No nesting
+    }
+    char text[COMMAND_MACRO_TEXT_MAX + 1];
+    if (!load(name, nameLen, text)) {
+        return COMMAND_NOT_FOUND;
+    }
+    _running = true;
+    CommandStatus status = commandBatchDispatch(table, count, text, context, failedAt);
+    _running = false;
+    return status;
+}
+
+uint8_t CommandMacros::getCount() const {
+    CommandMacroRecord record;
+    uint8_t used = 0;
+    for (uint8_t slot = 0; slot < _slots; slot++) {
+        if (readSlot(slot, &record)) {
+            used++;
+        }
+    }
+    return used;
+}
+
+void CommandMacros::print() const {
+    CommandMacroRecord record;
+    uint8_t used = 0;
+    for (uint8_t slot = 0; slot < _slots; slot++) {
+        if (!readSlot(slot, &record)) {
+            continue;
+        }
+        used++;
+        FLASH_PRINTF("[MACRO] %.*s: %.*s\r\n", (int)strnlen(record.name, COMMAND_MACRO_NAME_MAX),
+                     record.name, (int)record.textLen, record.text);
+    }
+    FLASH_PRINTF("[MACRO] %u of %u slots used\r\n", (unsigned)used, (unsigned)_slots);
+}
@@ -0,0 +1,135 @@
+/**
+ * @file CommandMacros.h
+ * @brief Named Command Batches Kept in EEPROM
+ *
+ * A macro is a ';'-separated CommandParser batch stored under a short
+ * name, so a bench setup typed once ("pid gains 2 0.5 0; sp 24; sub temp
+ * 1000") is replayed with one word after any reset. Each macro is one
+ * fixed-size EEPROM record:
+ *
+ *   magic (1) │ length (1) │ name (8) │ text (52) │ crc (2)   = 64 bytes
+ *
+ * A record with a bad magic or CRC is a free slot, so erased EEPROM
+ * reads as "no macros" and a reset during a write loses only the macro
+ * being written. Names are case-insensitive and stored in lowercase.
+ *
+ * run() reads the record into a stack buffer and hands it to
+ * commandBatchDispatch(): every command is matched first and the
+ * handlers only run if all of them fit. A macro cannot run another
+ * macro (the inner run() fails), which also rules out loops.
+ *
+ * define() and remove() write the EEPROM in the calling task, which
+ * busy-waits about 3.4 ms per changed byte (up to ~220 ms for a whole
+ * record); they are user commands, not something to call per cycle.
+ * Lookups read the EEPROM directly and keep nothing in RAM.
+ *
+ * Without an EEPROM (host builds) the records live in a RAM image of
+ * the EEPROM, shared by all instances, so a new instance at the same
+ * address sees what an earlier one stored, as after a reset.
+ *
+ * Not locked: use one instance from one task.
+ *
+ * Usage:
+ *   static CommandMacros s_macros(MACRO_EEPROM_ADDR, MACRO_SLOTS);
+ *
+ *   // "macro def <name> <commands>", entry spec "wr":
+ *   if (commandBatchCheck(COMMANDS, count, text, NULL) == COMMAND_OK) {
+ *       s_macros.define(name, nameLen, text, textLen);
+ *   }
+ *   s_macros.run(name, nameLen, COMMANDS, count, context, NULL);  // "run <name>"
+ *   s_macros.print();                                             // "macro list"
+ */
+
+#ifndef COMMAND_MACROS_H
+#define COMMAND_MACROS_H
+
+#include <stdint.h>
+#include "CommandParser.h"
+
+/** @brief Longest macro name. */
+#define COMMAND_MACRO_NAME_MAX 8
+
+/** @brief Longest macro text (the batch). */
+#define COMMAND_MACRO_TEXT_MAX 52
+
+/** @brief Marks a used record. */
+#define COMMAND_MACRO_MAGIC 0xA7
+
+/** @brief One macro as stored. */
+struct __attribute__((packed)) CommandMacroRecord {
+    uint8_t magic;                          ///< COMMAND_MACRO_MAGIC
+    uint8_t textLen;                        ///< Bytes used in text
+    char    name[COMMAND_MACRO_NAME_MAX];   ///< Lowercase, NUL-padded
+    char    text[COMMAND_MACRO_TEXT_MAX];   ///< Not terminated
+    uint16_t crc;                           ///< CRC-16/CCITT of the fields above
+};
+
+/** @brief EEPROM bytes per macro slot. */
+#define COMMAND_MACRO_RECORD_BYTES ((uint16_t)sizeof(CommandMacroRecord))
+
+class CommandMacros {
+public:
+    /**
+     * @param eepromAddress First EEPROM byte of the region.
+     * @param slots         Macros it holds; the region takes
+     *                      slots × COMMAND_MACRO_RECORD_BYTES bytes.
+     */
+    CommandMacros(uint16_t eepromAddress, uint8_t slots);
+
+    /**
+     * @brief Store a macro, replacing one of the same name.
+     *
+     * The text is stored as given; check it with commandBatchCheck() first.
+     *
+     * @return false if the name is empty or too long, the text empty or
+     *         too long, or every slot is used by another name.
+     */
+    bool define(const char *name, uint8_t nameLen, const char *text, uint8_t textLen);
+
+    /** @brief Delete a macro. @return false if there is none of that name. */
+    bool remove(const char *name, uint8_t nameLen);
+
+    /**
+     * @brief Copy a macro's text.
+     *
+     * @param text Receives the NUL-terminated text; COMMAND_MACRO_TEXT_MAX + 1 bytes.
+     * @return false if there is none of that name.
+     */
+    bool load(const char *name, uint8_t nameLen, char *text) const;
+
+    /** @brief True if a macro of that name is stored. */
+    bool contains(const char *name, uint8_t nameLen) const;
+
+    /**
+     * @brief Run a macro's batch against a command table.
+     *
+     * @return COMMAND_NOT_FOUND if there is no such macro, COMMAND_BAD_ARGS
+     *         when called from inside a running macro, else the
+     *         commandBatchDispatch() status (failedAt as there).
+     */
+    CommandStatus run(const char *name, uint8_t nameLen, const CommandEntry *table,
+                      uint8_t count, void *context, uint8_t *failedAt);
+
+    /** @brief Print one "[MACRO] name: text" line per macro and the slot use. */
+    void print() const;
+
+    /** @brief Macros stored. */
+    uint8_t getCount() const;
+
+    /** @brief Slots in the region. */
+    uint8_t getSlots() const { return _slots; }
+
+    /** @brief True while run() executes a macro (its handlers are running). */
+    bool isRunning() const { return _running; }
+
+private:
+    bool readSlot(uint8_t slot, CommandMacroRecord *record) const;
+    void writeSlot(uint8_t slot, CommandMacroRecord *record);
+    int16_t findSlot(const char *name, uint8_t nameLen, CommandMacroRecord *record) const;
+
+    uint16_t _address;
+    uint8_t  _slots;
+    bool     _running;
+};
+
+#endif // COMMAND_MACROS_H
@@ -2,85 +2,547 @@
  * @file CommandParser.cpp
  * @brief Serial Command Parser Implementation
  *
- * Implements command parsing logic with:
- * - Whitespace trimming (leading and trailing)
- * - Case-insensitive comparison
- * - Extensible command matching
+ * Implements table-driven command matching with:
+ * - In-place scanning: the input is never copied, trimmed or lowered
+ * - Case folding and whitespace collapsing inside the verb hash
+ * - Hash-first table scan; only a hash hit reads the verb from flash
+ * - Integer / float / word / rest-of-line argument tokenization
+ * - ';'-separated batches, matched in full before any handler runs
+ * - A character-fed variant (CommandStream) that resolves verbs at
+ *   each word boundary as input arrives
  */
 
 #include "CommandParser.h"
 #include <string.h>
 #include <ctype.h>
+#include <stdlib.h>
 
-/// Maximum length for internal string buffers during parsing.
-static const uint8_t PARSE_BUFFER_SIZE = 64;
+#if !defined(__AVR__)
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#endif
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Scanning helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+static const char *skipSpace(const char *p, const char *end) {
+    while (p < end && isspace((unsigned char)*p)) {
+        p++;
+    }
+    return p;
+}
+
+static const char *skipWord(const char *p, const char *end) {
+    while (p < end && !isspace((unsigned char)*p)) {
+        p++;
+    }
+    return p;
+}
 
 /**
- * @brief Convert a string to lowercase (in-place copy).
- *
- * Copies src into dest, converting each character to lowercase.
- * The result is null-terminated and limited to maxLen - 1 characters.
+ * @brief Compare a flash verb with input words in [in, inEnd).
  *
- * @param dest   Destination buffer.
- * @param src    Source string to convert.
- * @param maxLen Maximum size of the destination buffer.
+ * Input whitespace runs match the single space in the verb and letters
+ * are compared case-insensitively.
  */
-static void toLowerStr(char *dest, const char *src, size_t maxLen) {
-    size_t i = 0;
-    while (src[i] != '\0' && i < maxLen - 1) {
-        dest[i] = tolower((unsigned char)src[i]);
-        i++;
+static bool verbMatches(const char *verbP, const char *in, const char *inEnd) {
+    for (uint8_t i = 0; i < COMMAND_VERB_MAX; i++) {
+        char v = (char)pgm_read_byte(&verbP[i]);
+        if (v == '\0') {
+            return in == inEnd;
+        }
+        if (in == inEnd) {
+            return false;
+        }
+        if (v == ' ') {
+            if (!isspace((unsigned char)*in)) {
+                return false;
+            }
+            in = skipSpace(in, inEnd);
+            continue;
+        }
+        if (tolower((unsigned char)*in) != v) {
+            return false;
+        }
+        in++;
+    }
+    return false;
+}
+
+/** @brief Find the entry whose verb equals the input words in [start, end). */
+static int16_t findEntry(const CommandEntry *table, uint8_t count, uint16_t hash,
+                         const char *start, const char *end) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (pgm_read_word(&table[i].hash) == hash &&
+            verbMatches(table[i].verb, start, end)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/** @brief Parse one argument token of the given spec type. */
+static bool parseArg(char type, const char *start, const char *end, CommandArg *arg) {
+    arg->text = start;
+    arg->len  = (uint8_t)(end - start);
+
+    char *parsedEnd = NULL;
+    switch (type) {
+        case 'i':
+            arg->i = strtol(start, &parsedEnd, 10);
+            return parsedEnd == end;
+        case 'f':
+            arg->f = (float)strtod(start, &parsedEnd);
+            return parsedEnd == end;
+        case 'w':
+        case 'r':
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** @brief True if the entry's spec ends in an 'r' (rest of the input) argument. */
+static bool entryTakesRest(const CommandEntry *table, uint8_t index) {
+    char spec[COMMAND_MAX_ARGS + 1];
+    memcpy_P(spec, table[index].argSpec, sizeof(spec));
+    spec[COMMAND_MAX_ARGS] = '\0';
+    return strchr(spec, 'r') != NULL;
+}
+
+/** @brief commandLookup() over the input in [input, end). */
+static CommandStatus lookupRange(const CommandEntry *table, uint8_t count, const char *input,
+                                 const char *end, uint8_t *index, CommandArg *args,
+                                 uint8_t *argc) {
+    const char *verbStart = skipSpace(input, end);
+    if (verbStart == end) {
+        return COMMAND_EMPTY;
+    }
+
+    // Hash the verb word by word; keep the longest verb that matches
+    uint16_t hash = COMMAND_HASH_SEED;
+    const char *p = verbStart;
+    const char *verbEnd = NULL;
+    int16_t best = -1;
+
+    for (uint8_t word = 0; word < COMMAND_VERB_WORDS_MAX && p < end; word++) {
+        if (word > 0) {
+            hash = commandHashStep(hash, ' ');
+        }
+        const char *wordEnd = skipWord(p, end);
+        while (p < wordEnd) {
+            hash = commandHashStep(hash, *p++);
+        }
+
+        int16_t match = findEntry(table, count, hash, verbStart, wordEnd);
+        if (match >= 0) {
+            best = match;
+            verbEnd = wordEnd;
+        }
+        p = skipSpace(p, end);
+    }
+
+    if (best < 0) {
+        return COMMAND_NOT_FOUND;
+    }
+    *index = (uint8_t)best;
+
+    // Tokenize the arguments against the entry's spec
+    char spec[COMMAND_MAX_ARGS + 1];
+    memcpy_P(spec, table[best].argSpec, sizeof(spec));
+    spec[COMMAND_MAX_ARGS] = '\0';
+
+    uint8_t n = 0;
+    p = skipSpace(verbEnd, end);
+    while (p < end) {
+        if (spec[n] == '\0') {
+            *argc = n;
+            return COMMAND_BAD_ARGS;  // More tokens than the spec allows
+        }
+        const char *tokenEnd = skipWord(p, end);
+        if (spec[n] == 'r') {
+            // The rest of the input, trailing blanks trimmed
+            tokenEnd = end;
+            while (isspace((unsigned char)tokenEnd[-1])) {
+                tokenEnd--;
+            }
+        }
+        if (!parseArg(spec[n], p, tokenEnd, &args[n])) {
+            *argc = n;
+            return COMMAND_BAD_ARGS;
+        }
+        n++;
+        p = skipSpace(tokenEnd, end);
     }
-    dest[i] = '\0';
+
+    *argc = n;
+    return spec[n] == '\0' ? COMMAND_OK : COMMAND_BAD_ARGS;
 }
 
 /**
- * @brief Trim leading and trailing whitespace from a string.
+ * @brief Look up the batch command starting at input.
  *
- * Copies the trimmed content of src into dest, stripping all
- * leading and trailing whitespace characters (spaces, tabs,
- * newlines, carriage returns).
+ * The command ends at the next ';', or at the end of the input when its
+ * entry takes an 'r' argument. next receives where the following one starts.
+ */
+static CommandStatus lookupCommand(const CommandEntry *table, uint8_t count, const char *input,
+                                   const char **next, uint8_t *index, CommandArg *args,
+                                   uint8_t *argc) {
+    const char *inputEnd = input + strlen(input);
+    const char *end = strchr(input, ';');
+    if (end == NULL) {
+        end = inputEnd;
+    }
+    CommandStatus status = lookupRange(table, count, input, end, index, args, argc);
+    if (end != inputEnd && (status == COMMAND_OK || status == COMMAND_BAD_ARGS) &&
+        entryTakesRest(table, *index)) {
+        end = inputEnd;
+        status = lookupRange(table, count, input, end, index, args, argc);
+    }
+    *next = end == inputEnd ? end : end + 1;
+    return status;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+CommandStatus commandLookup(const CommandEntry *table, uint8_t count, const char *input,
+                            uint8_t *index, CommandArg *args, uint8_t *argc) {
+    return lookupRange(table, count, input, input + strlen(input), index, args, argc);
+}
+
+CommandStatus commandDispatch(const CommandEntry *table, uint8_t count,
+                              const char *input, void *context) {
+    CommandArg args[COMMAND_MAX_ARGS];
+    uint8_t index = 0;
+    uint8_t argc = 0;
+
+    CommandStatus status = commandLookup(table, count, input, &index, args, &argc);
+    if (status == COMMAND_OK) {
+        CommandHandler handler;
+        memcpy_P(&handler, &table[index].handler, sizeof(handler));
+        if (handler != NULL) {
+            handler(args, argc, context);
+        }
+    }
+    return status;
+}
+
+CommandStatus commandBatchCheck(const CommandEntry *table, uint8_t count,
+                                const char *input, uint8_t *failedAt) {
+    CommandStatus result = COMMAND_EMPTY;
+    uint8_t command = 0;
+    while (*input != '\0') {
+        CommandArg args[COMMAND_MAX_ARGS];
+        uint8_t index = 0;
+        uint8_t argc = 0;
+        CommandStatus status = lookupCommand(table, count, input, &input, &index, args, &argc);
+        if (status == COMMAND_EMPTY) {
+            continue;
+        }
+        if (status != COMMAND_OK) {
+            if (failedAt != NULL) {
+                *failedAt = command;
+            }
+            return status;
+        }
+        result = COMMAND_OK;
+        command++;
+    }
+    return result;
+}
+
+CommandStatus commandBatchDispatch(const CommandEntry *table, uint8_t count,
+                                   const char *input, void *context, uint8_t *failedAt) {
+    CommandStatus status = commandBatchCheck(table, count, input, failedAt);
+    if (status != COMMAND_OK) {
+        return status;
+    }
+    while (*input != '\0') {
+        CommandArg args[COMMAND_MAX_ARGS];
+        uint8_t index = 0;
+        uint8_t argc = 0;
+        if (lookupCommand(table, count, input, &input, &index, args, &argc) != COMMAND_OK) {
+            continue;  // Empty command
+        }
+        CommandHandler handler;
+        memcpy_P(&handler, &table[index].handler, sizeof(handler));
+        if (handler != NULL) {
+            handler(args, argc, context);
+        }
+    }
+    return COMMAND_OK;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Streaming parser
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @brief Compare a flash verb with the first n stream tokens.
  *
- * @param dest   Destination buffer for the trimmed string.
- * @param src    Source string to trim.
- * @param maxLen Maximum size of the destination buffer.
+ * @param prefixOnly If true, succeed when the tokens form a proper prefix
+ *                   of the verb ending at a word boundary.
  */
-static void trimStr(char *dest, const char *src, size_t maxLen) {
-    // Skip leading whitespace
-    while (*src && isspace((unsigned char)*src)) {
-        src++;
+static bool streamVerbMatches(const char *verbP, const CommandStream *s, uint8_t n,
+                              bool prefixOnly) {
+    uint8_t v = 0;
+    for (uint8_t t = 0; t < n; t++) {
+        if (t > 0 && pgm_read_byte(&verbP[v++]) != ' ') {
+            return false;
+        }
+        for (const char *p = &s->line[s->tokenOffset[t]]; *p != '\0'; p++) {
+            if (v >= COMMAND_VERB_MAX ||
+                (char)pgm_read_byte(&verbP[v++]) != (char)tolower((unsigned char)*p)) {
+                return false;
+            }
+        }
     }
+    char next = v < COMMAND_VERB_MAX ? (char)pgm_read_byte(&verbP[v]) : '\0';
+    return prefixOnly ? next == ' ' : next == '\0';
+}
+
+/** @brief Clear the token and verb state for the next command of the line. */
+static void streamResetCommand(CommandStream *s) {
+    s->tokenCount = 0;
+    s->inToken    = false;
+    s->verbOpen   = true;
+    s->overflow   = false;
+    s->verbHash   = COMMAND_HASH_SEED;
+    s->best       = -1;
+    s->bestTokens = 0;
+    s->raw        = false;
+}
+
+static void streamReset(CommandStream *s) {
+    s->len          = 0;
+    s->pendingCount = 0;
+    s->commandCount = 0;
+    s->lineStatus   = COMMAND_EMPTY;
+    streamResetCommand(s);
+}
+
+/** @brief Spec character for argument a of the best entry ('\0' past the end). */
+static char streamSpecAt(const CommandStream *s, uint8_t a) {
+    return a < COMMAND_MAX_ARGS ? (char)pgm_read_byte(&s->table[s->best].argSpec[a]) : '\0';
+}
 
-    // Find the end of meaningful content
-    size_t len = strlen(src);
-    while (len > 0 && isspace((unsigned char)src[len - 1])) {
-        len--;
+/** @brief Terminate the current token and advance verb resolution. */
+static void streamEndToken(CommandStream *s) {
+    s->inToken = false;
+    if (s->overflow) {
+        return;
     }
+    if (s->len >= COMMAND_STREAM_LINE_MAX) {
+        s->overflow = true;
+        return;
+    }
+    if (s->raw) {
+        while (isspace((unsigned char)s->line[s->len - 1])) {
+            s->len--;  // Trailing blanks of an 'r' argument
+        }
+    }
+    s->line[s->len++] = '\0';
+    uint8_t k = ++s->tokenCount;
+
+    if (s->verbOpen) {
+        // Extend the verb hash with this token
+        const char *token = &s->line[s->tokenOffset[k - 1]];
+        if (k > 1) {
+            s->verbHash = commandHashStep(s->verbHash, ' ');
+        }
+        for (const char *p = token; *p != '\0'; p++) {
+            s->verbHash = commandHashStep(s->verbHash, *p);
+        }
 
-    // Copy trimmed content
-    if (len >= maxLen) {
-        len = maxLen - 1;
+        bool longerPossible = false;
+        for (uint8_t i = 0; i < s->count; i++) {
+            if (pgm_read_word(&s->table[i].hash) == s->verbHash &&
+                streamVerbMatches(s->table[i].verb, s, k, false)) {
+                s->best = i;
+                s->bestTokens = k;
+            }
+            if (!longerPossible && k < COMMAND_VERB_WORDS_MAX &&
+                streamVerbMatches(s->table[i].verb, s, k, true)) {
+                longerPossible = true;
+            }
+        }
+        s->verbOpen = longerPossible;
     }
-    strncpy(dest, src, len);
-    dest[len] = '\0';
+
+    // Verb settled: the next argument may take the rest of the line
+    s->raw = !s->verbOpen && s->best >= 0 && k >= s->bestTokens &&
+             streamSpecAt(s, (uint8_t)(k - s->bestTokens)) == 'r';
 }
 
-CommandType parseCommand(const char *input) {
-    char trimmed[PARSE_BUFFER_SIZE];
-    char lower[PARSE_BUFFER_SIZE];
+/**
+ * @brief Parse the arguments of a matched command, NUL-separated tokens
+ *        from offset on.
+ */
+static bool streamParseArgs(const CommandStream *s, uint8_t entry, uint8_t offset,
+                            uint8_t argc, CommandArg *args) {
+    char spec[COMMAND_MAX_ARGS + 1];
+    memcpy_P(spec, s->table[entry].argSpec, sizeof(spec));
+    spec[COMMAND_MAX_ARGS] = '\0';
+    if (argc != strlen(spec)) {
+        return false;
+    }
+    for (uint8_t a = 0; a < argc; a++) {
+        const char *start = &s->line[offset];
+        uint8_t len = (uint8_t)strlen(start);
+        if (!parseArg(spec[a], start, start + len, &args[a])) {
+            return false;
+        }
+        offset = (uint8_t)(offset + len + 1);
+    }
+    return true;
+}
+
+/** @brief A ';' or the line end: check the command and add it to the batch. */
+static void streamEndCommand(CommandStream *s) {
+    if (s->inToken) {
+        streamEndToken(s);
+    }
+    if (s->tokenCount == 0 && !s->overflow) {
+        streamResetCommand(s);
+        return;  // Empty command
+    }
+
+    CommandStatus status;
+    if (s->best < 0) {
+        status = COMMAND_NOT_FOUND;
+    } else if (s->overflow || s->pendingCount >= COMMAND_BATCH_MAX) {
+        status = COMMAND_BAD_ARGS;
+    } else {
+        CommandStreamPending &p = s->pending[s->pendingCount];
+        CommandArg args[COMMAND_MAX_ARGS];
+        p.entry = (uint8_t)s->best;
+        p.argc = (uint8_t)(s->tokenCount - s->bestTokens);
+        p.argOffset = p.argc > 0 ? s->tokenOffset[s->bestTokens] : 0;
+        status = streamParseArgs(s, p.entry, p.argOffset, p.argc, args) ? COMMAND_OK
+                                                                        : COMMAND_BAD_ARGS;
+        if (status == COMMAND_OK) {
+            s->pendingCount++;
+        }
+    }
+
+    if (status == COMMAND_OK) {
+        if (s->lineStatus == COMMAND_EMPTY) {
+            s->lineStatus = COMMAND_OK;
+        }
+    } else if (s->lineStatus == COMMAND_EMPTY || s->lineStatus == COMMAND_OK) {
+        s->lineStatus = status;
+        s->lastFailedAt = s->commandCount;
+    }
+    s->commandCount++;
+    streamResetCommand(s);
+}
+
+void commandStreamInit(CommandStream *stream, const CommandEntry *table,
+                       uint8_t count, void *context) {
+    stream->table        = table;
+    stream->count        = count;
+    stream->context      = context;
+    stream->lastCommands = 0;
+    stream->lastFailedAt = 0;
+    streamReset(stream);
+}
 
-    // Step 1: Remove leading/trailing whitespace
-    trimStr(trimmed, input, sizeof(trimmed));
+CommandStatus commandStreamFeed(CommandStream *s, char c) {
+    if (c == '\n' || c == '\r') {
+        streamEndCommand(s);
 
-    // Step 2: Convert to lowercase for case-insensitive matching
-    toLowerStr(lower, trimmed, sizeof(lower));
+        CommandStatus status = s->lineStatus;
+        if (status == COMMAND_OK) {
+            // The whole line matched: run it back to back
+            for (uint8_t k = 0; k < s->pendingCount; k++) {
+                const CommandStreamPending &p = s->pending[k];
+                CommandArg args[COMMAND_MAX_ARGS];
+                streamParseArgs(s, p.entry, p.argOffset, p.argc, args);
+                CommandHandler handler;
+                memcpy_P(&handler, &s->table[p.entry].handler, sizeof(handler));
+                if (handler != NULL) {
+                    handler(args, p.argc, s->context);
+                }
+            }
+        }
 
-    // Step 3: Match against known commands
-    if (strcmp(lower, "led on") == 0) {
-        return CMD_LED_ON;
-    } else if (strcmp(lower, "led off") == 0) {
-        return CMD_LED_OFF;
+        s->lastCommands = s->commandCount;
+        streamReset(s);
+        return status;
     }
 
-    return CMD_UNKNOWN;
+    if (c == '\b' || c == 127) {
+        // Editing is limited to the token in progress
+        if (s->inToken && !s->overflow) {
+            if (--s->len == s->tokenOffset[s->tokenCount]) {
+                s->inToken = false;
+            }
+        }
+        return COMMAND_PENDING;
+    }
+
+    if (s->raw) {
+        if (!s->inToken && isspace((unsigned char)c)) {
+            return COMMAND_PENDING;  // Leading blanks of an 'r' argument
+        }
+    } else if (c == ';') {
+        streamEndCommand(s);
+        return COMMAND_PENDING;
+    } else if (isspace((unsigned char)c)) {
+        if (s->inToken) {
+            streamEndToken(s);
+        }
+        return COMMAND_PENDING;
+    }
+
+    if (s->overflow) {
+        return COMMAND_PENDING;
+    }
+    if (!s->inToken) {
+        if (s->tokenCount >= COMMAND_VERB_WORDS_MAX + COMMAND_MAX_ARGS) {
+            s->overflow = true;
+            return COMMAND_PENDING;
+        }
+        s->tokenOffset[s->tokenCount] = s->len;
+        s->inToken = true;
+    }
+    // Leave room for the token terminator
+    if (s->len >= COMMAND_STREAM_LINE_MAX - 1) {
+        s->overflow = true;
+        return COMMAND_PENDING;
+    }
+    s->line[s->len++] = c;
+    return COMMAND_PENDING;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Legacy enum API
+// ──────────────────────────────────────────────────────────────────────────
+
+/// Lookup-only table; row order matches the CommandType values after CMD_UNKNOWN.
+static const CommandEntry LEGACY_COMMANDS[] PROGMEM = {
+    COMMAND_ENTRY("led on",  NULL, ""),
+    COMMAND_ENTRY("led off", NULL, ""),
+};
+
+CommandType parseCommand(const char *input) {
+    CommandArg args[COMMAND_MAX_ARGS];
+    uint8_t index = 0;
+    uint8_t argc = 0;
+
+    if (commandLookup(LEGACY_COMMANDS, sizeof(LEGACY_COMMANDS) / sizeof(LEGACY_COMMANDS[0]),
+                      input, &index, args, &argc) != COMMAND_OK) {
+        return CMD_UNKNOWN;
+    }
+    return (CommandType)(CMD_LED_ON + index);
 }
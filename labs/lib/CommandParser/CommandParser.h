@@ -2,19 +2,284 @@
  * @file CommandParser.h
  * @brief Serial Command Parser Interface
  *
- * Provides a reusable command parsing module that interprets
- * text commands received from the serial terminal. Supports
- * extensible command types and case-insensitive matching.
+ * Provides a reusable, table-driven command parser for text commands
+ * received from the serial terminal. Each lab describes its commands in
+ * a PROGMEM table of {verb, handler, argument spec}; the parser matches
+ * the input in place (no copies), case-insensitively and with any amount
+ * of whitespace between words, then tokenizes the arguments.
+ *
+ * Dispatch uses a hash of the normalized verb that is computed at compile
+ * time for each table entry, so a lookup is one pass over the input plus
+ * 16-bit compares; only a hash hit is confirmed with a string compare.
+ *
+ * Argument spec characters (one per argument, all required):
+ *   'i' — integer (decimal, optional sign)  -> CommandArg::i
+ *   'f' — floating point                    -> CommandArg::f
+ *   'w' — any word                          -> CommandArg::text / len
+ *   'r' — the rest of the input, raw        -> CommandArg::text / len
+ *         (spaces and ';' kept, trailing blanks trimmed; last in a spec)
  *
  * Usage:
- *   CommandType cmd = parseCommand("led on");
- *   if (cmd == CMD_LED_ON) { ... }
+ *   static void onPwm(const CommandArg *args, uint8_t argc, void *ctx);
+ *
+ *   static const CommandEntry COMMANDS[] PROGMEM = {
+ *       COMMAND_ENTRY("led on",  onLedOn,  ""),
+ *       COMMAND_ENTRY("pwm set", onPwm,    "i"),
+ *   };
+ *
+ *   commandDispatch(COMMANDS, 2, line, NULL);   // "PWM  Set 40" -> onPwm(40)
+ *
+ * Streaming input:
+ *   CommandStream consumes one character at a time (e.g. straight from
+ *   stdioSerialPollChar()) and resolves the verb at each word boundary
+ *   while the line is still arriving; the handler runs on the newline.
+ *
+ *     static CommandStream s_cli;
+ *     commandStreamInit(&s_cli, COMMANDS, 2, NULL);
+ *     int c;
+ *     while ((c = stdioSerialPollChar()) >= 0) {
+ *         commandStreamFeed(&s_cli, (char)c);
+ *     }
+ *
+ * Batches:
+ *   Commands on one line separated by ';' form a batch, e.g.
+ *   "pid gains 2 0.5 0; sp 24; sub temp 1000". Each command is matched
+ *   and its arguments checked as its ';' arrives, but nothing runs until
+ *   the line ends: then either every handler runs, in order and back to
+ *   back in the same call, or (one command failed) none does.
+ *   commandBatchDispatch() does the same for a batch held in a string,
+ *   e.g. a stored macro (CommandMacros).
+ *
+ * The legacy parseCommand() API is kept and is implemented on top of
+ * the same table machinery.
  */
 
 #ifndef COMMAND_PARSER_H
 #define COMMAND_PARSER_H
 
 #include <stdint.h>
+#include <stddef.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#elif !defined(PROGMEM)
+#define PROGMEM
+#endif
+
+/** @brief Longest verb (including spaces) a table entry can hold. */
+#define COMMAND_VERB_MAX 16
+
+/** @brief Most arguments a command can take. */
+#define COMMAND_MAX_ARGS 4
+
+/** @brief Most words a verb may span (e.g. "led on" is 2). */
+#define COMMAND_VERB_WORDS_MAX 3
+
+/**
+ * @struct CommandArg
+ * @brief One tokenized argument.
+ *
+ * text/len reference the caller's input (commandLookup) or the stream's
+ * token buffer (CommandStream); they are valid during the handler call.
+ */
+struct CommandArg {
+    union {
+        int32_t i;         ///< Value for an 'i' argument.
+        float   f;         ///< Value for an 'f' argument.
+    };
+    const char *text;      ///< Start of the token (not necessarily terminated).
+    uint8_t     len;       ///< Token length in characters.
+};
+
+/**
+ * @brief Command handler.
+ *
+ * @param args    Tokenized arguments, as described by the entry's spec.
+ * @param argc    Number of arguments (equals the spec length).
+ * @param context Caller-supplied pointer passed to commandDispatch().
+ */
+typedef void (*CommandHandler)(const CommandArg *args, uint8_t argc, void *context);
+
+/**
+ * @struct CommandEntry
+ * @brief One row of a command table. Build with COMMAND_ENTRY().
+ */
+struct CommandEntry {
+    uint16_t       hash;                          ///< commandHash(verb).
+    char           verb[COMMAND_VERB_MAX];        ///< Lowercase, single-spaced.
+    CommandHandler handler;                       ///< May be NULL for lookup-only tables.
+    char           argSpec[COMMAND_MAX_ARGS + 1]; ///< See file header.
+};
+
+/**
+ * @enum CommandStatus
+ * @brief Result of commandLookup() / commandDispatch().
+ */
+enum CommandStatus {
+    COMMAND_OK,         ///< Matched and arguments parsed.
+    COMMAND_EMPTY,      ///< Input was blank.
+    COMMAND_NOT_FOUND,  ///< No verb in the table matches.
+    COMMAND_BAD_ARGS,   ///< Verb matched but the arguments did not fit its spec.
+    COMMAND_PENDING     ///< CommandStream: line not finished yet.
+};
+
+/// FNV-1a style 16-bit hash step over a case-folded character.
+constexpr uint16_t commandHashStep(uint16_t h, char c) {
+    return (uint16_t)((h ^ (uint8_t)((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c)) * 0x0193U);
+}
+
+/// Seed of the verb hash.
+static const uint16_t COMMAND_HASH_SEED = 0x811CU;
+
+/**
+ * @brief Compile-time hash of a normalized (single-spaced) verb.
+ */
+constexpr uint16_t commandHash(const char *verb, uint16_t h = COMMAND_HASH_SEED) {
+    return *verb == '\0' ? h : commandHash(verb + 1, commandHashStep(h, *verb));
+}
+
+/** @brief Initializer for a CommandEntry with its hash computed at compile time. */
+#define COMMAND_ENTRY(verb, handler, spec) { commandHash(verb), verb, handler, spec }
+
+/**
+ * @brief Match input against a PROGMEM command table.
+ *
+ * The longest matching verb wins, so "led" and "led on" can coexist.
+ *
+ * @param table  PROGMEM array of entries.
+ * @param count  Number of entries.
+ * @param input  Null-terminated user input (not modified).
+ * @param index  Receives the matching entry index (COMMAND_OK / COMMAND_BAD_ARGS).
+ * @param args   Receives up to COMMAND_MAX_ARGS parsed arguments.
+ * @param argc   Receives the number of arguments parsed.
+ * @return Lookup status.
+ */
+CommandStatus commandLookup(const CommandEntry *table, uint8_t count, const char *input,
+                            uint8_t *index, CommandArg *args, uint8_t *argc);
+
+/**
+ * @brief Match input and invoke the entry's handler.
+ *
+ * @param table   PROGMEM array of entries.
+ * @param count   Number of entries.
+ * @param input   Null-terminated user input (not modified).
+ * @param context Passed through to the handler.
+ * @return Lookup status; the handler only runs on COMMAND_OK.
+ */
+CommandStatus commandDispatch(const CommandEntry *table, uint8_t count,
+                              const char *input, void *context);
+
+/**
+ * @brief Match a ';'-separated batch and run it only if every command fits.
+ *
+ * Empty commands (";;", a trailing ';') are skipped. A command with an
+ * 'r' argument takes the rest of the input, ';' included, and ends the
+ * batch. Handlers run in order once all commands are matched.
+ *
+ * @param table    PROGMEM array of entries.
+ * @param count    Number of entries.
+ * @param input    Null-terminated batch (not modified).
+ * @param context  Passed through to the handlers.
+ * @param failedAt Receives the failing command (0 = first) unless
+ *                 COMMAND_OK or COMMAND_EMPTY; may be NULL.
+ * @return COMMAND_OK if all ran, COMMAND_EMPTY if there was no command,
+ *         else the first failure (nothing ran).
+ */
+CommandStatus commandBatchDispatch(const CommandEntry *table, uint8_t count,
+                                   const char *input, void *context, uint8_t *failedAt);
+
+/** @brief As commandBatchDispatch(), but only match: no handler runs. */
+CommandStatus commandBatchCheck(const CommandEntry *table, uint8_t count,
+                                const char *input, uint8_t *failedAt);
+
+/** @brief Characters a CommandStream can hold for one line (tokens of all batch commands). */
+#ifndef COMMAND_STREAM_LINE_MAX
+#define COMMAND_STREAM_LINE_MAX 64
+#endif
+
+/** @brief Most commands a CommandStream line (batch) can hold. */
+#ifndef COMMAND_BATCH_MAX
+#define COMMAND_BATCH_MAX 4
+#endif
+
+/**
+ * @struct CommandStreamPending
+ * @brief A matched batch command waiting for the end of its line.
+ */
+struct CommandStreamPending {
+    uint8_t entry;       ///< Table index.
+    uint8_t argOffset;   ///< Offset of its first argument token in line.
+    uint8_t argc;        ///< Argument tokens (NUL-separated from argOffset on).
+};
+
+/**
+ * @struct CommandStream
+ * @brief State of the incremental, character-fed command parser.
+ *
+ * Only token characters are stored (whitespace is dropped and each token
+ * is NUL-terminated), so argument CommandArg::text points into this
+ * buffer and stays valid for the duration of the handler call. The
+ * commands of a batch share the buffer; each is recorded in pending
+ * once it has been matched.
+ */
+struct CommandStream {
+    const CommandEntry *table;    ///< PROGMEM command table.
+    uint8_t  count;               ///< Entries in table.
+    void    *context;             ///< Passed through to handlers.
+
+    char     line[COMMAND_STREAM_LINE_MAX];                       ///< NUL-separated tokens.
+    uint8_t  tokenOffset[COMMAND_VERB_WORDS_MAX + COMMAND_MAX_ARGS]; ///< Token start offsets.
+    uint8_t  len;                 ///< Bytes used in line.
+    uint8_t  tokenCount;          ///< Completed tokens.
+    bool     inToken;             ///< A token is being received.
+    bool     verbOpen;            ///< Further tokens may still extend the verb.
+    bool     overflow;            ///< Line or token limit exceeded; line is rejected.
+    uint16_t verbHash;            ///< Hash of the tokens resolved as verb candidate.
+    int16_t  best;                ///< Longest matching entry so far, or -1.
+    uint8_t  bestTokens;          ///< Tokens that make up best's verb.
+    bool     raw;                 ///< Receiving an 'r' argument: blanks and ';' are kept.
+
+    CommandStreamPending pending[COMMAND_BATCH_MAX]; ///< Matched commands of the line.
+    uint8_t  pendingCount;        ///< Entries used in pending.
+    uint8_t  commandCount;        ///< Commands ended so far in the line.
+    CommandStatus lineStatus;     ///< COMMAND_EMPTY, COMMAND_OK or the line's first failure.
+
+    uint8_t  lastCommands;        ///< Commands in the last finished line.
+    uint8_t  lastFailedAt;        ///< Its failing command (0 = first), if it failed.
+};
+
+/**
+ * @brief Bind a CommandStream to a table and clear its state.
+ *
+ * @param stream  Stream state to initialize.
+ * @param table   PROGMEM array of entries.
+ * @param count   Number of entries.
+ * @param context Passed through to handlers.
+ */
+void commandStreamInit(CommandStream *stream, const CommandEntry *table,
+                       uint8_t count, void *context);
+
+/**
+ * @brief Feed one input character.
+ *
+ * Whitespace ends a token; at that point the verb is extended and
+ * matched against the table. ';' ends a command: its arguments are
+ * checked and it joins the line's batch. '\n' or '\r' ends the line:
+ * when every command of it matched, the handlers run in order, and the
+ * stream resets. '\b' and DEL erase within the current token only.
+ *
+ * An 'r' argument starts once the verb and the arguments before it are
+ * complete (its verb must not begin a longer one in the table) and
+ * takes the rest of the line, ';' included.
+ *
+ * @param stream Stream state.
+ * @param c      Received character.
+ * @return COMMAND_PENDING until a line ends, then that line's status:
+ *         COMMAND_OK, COMMAND_EMPTY, or the first failure in the line
+ *         (lastFailedAt says which command; nothing ran). More than
+ *         COMMAND_BATCH_MAX commands is COMMAND_BAD_ARGS.
+ */
+CommandStatus commandStreamFeed(CommandStream *stream, char c);
 
 /**
  * @enum CommandType
@@ -29,7 +294,7 @@ enum CommandType {
 /**
  * @brief Parse a text string into a CommandType.
  *
- * Trims leading/trailing whitespace and performs
+ * Ignores leading/trailing whitespace and performs
  * case-insensitive matching against known commands.
  *
  * @param input Null-terminated input string from the user.
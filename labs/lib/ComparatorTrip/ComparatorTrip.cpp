@@ -0,0 +1,186 @@
+/**
+ * @file ComparatorTrip.cpp
+ * @brief Analog-Comparator Hard-Limit Trip Implementation
+ *
+ * Register setup (ATmega2560):
+ *   ADCSRB.ACME = 0    negative input = AIN1 (not the ADC multiplexer)
+ *   DIDR1.AIN1D = 1    AIN1 digital input buffer off (and AIN0D for AIN0)
+ *   ACSR = ACBG? | ACIS1 | ACIS0?   bandgap or AIN0, ACO rising / falling edge
+ *
+ * Arming clears ACI before it samples ACO and only then sets ACIE: a
+ * crossing between the two leaves ACI set, and the ISR runs as soon as
+ * the interrupt is enabled, so no edge is lost to the re-arm.
+ */
+
+#include "ComparatorTrip.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Trip state
+// ──────────────────────────────────────────────────────────────────────────
+
+static volatile uint8_t *s_port[COMPARATOR_TRIP_MAX_OUTPUTS];  ///< PORTx of each output.
+static uint8_t s_mask[COMPARATOR_TRIP_MAX_OUTPUTS];            ///< Bit in PORTx.
+static uint8_t s_safeHigh = 0;                                 ///< Bit i: output i safe HIGH.
+static uint8_t s_count = 0;                                    ///< Outputs in use.
+static ComparatorTripSense s_sense = COMPARATOR_TRIP_BELOW;
+
+static ComparatorTripCallback s_callback = NULL;
+static void *s_callbackArg = NULL;
+
+static volatile bool     s_tripped = false;
+static volatile uint16_t s_trips = 0;
+static volatile uint32_t s_tripMs = 0;
+
+/** @brief Drive every output to its safe level. Interrupts masked. */
+static inline void cutOutputs() {
+    for (uint8_t i = 0; i < s_count; i++) {
+        if (s_safeHigh & (1U << i)) {
+            *s_port[i] |= s_mask[i];
+        } else {
+            *s_port[i] &= (uint8_t)~s_mask[i];
+        }
+    }
+}
+
+/** @brief Cut, latch and notify. Interrupts masked. */
+static void trip() {
+    cutOutputs();
+    if (!s_tripped) {
+        s_tripped = true;
+        s_trips++;
+        s_tripMs = millis();
+    }
+    if (s_callback != NULL) {
+        s_callback(s_callbackArg);
+    }
+}
+
+#if defined(__AVR__)
+static inline bool levelBeyond() {
+    bool aco = (ACSR & _BV(ACO)) != 0;   // Reference above AIN1
+    return (s_sense == COMPARATOR_TRIP_BELOW) ? aco : !aco;
+}
+
+ISR(ANALOG_COMP_vect) {
+    // An edge the wrong way round (noise on the crossing) is not a trip.
+    if (!levelBeyond()) {
+        return;
+    }
+    ACSR &= (uint8_t)~_BV(ACIE);         // One shot until comparatorTripArm()
+    trip();
+}
+#else
+static inline bool levelBeyond() {
+    return false;
+}
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool comparatorTripInit(const ComparatorTripOutput *outputs, uint8_t count,
+                        ComparatorTripReference ref, ComparatorTripSense sense) {
+    if (outputs == NULL || count == 0 || count > COMPARATOR_TRIP_MAX_OUTPUTS) {
+        return false;
+    }
+
+    uint8_t safeHigh = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t port = digitalPinToPort(outputs[i].pin);
+        if (port == NOT_A_PIN) {
+            return false;
+        }
+        s_port[i] = portOutputRegister(port);
+        s_mask[i] = digitalPinToBitMask(outputs[i].pin);
+        if (outputs[i].safeLevel != LOW) {
+            safeHigh |= (uint8_t)(1U << i);
+        }
+        pinMode(outputs[i].pin, OUTPUT);
+    }
+    s_count = count;
+    s_safeHigh = safeHigh;
+    s_sense = sense;
+
+#if defined(__AVR__)
+    // ACIE off first: changing ACIS or the inputs may raise ACI.
+    ACSR &= (uint8_t)~_BV(ACIE);
+    ADCSRB &= (uint8_t)~_BV(ACME);
+    DIDR1 |= _BV(AIN1D);
+    if (ref == COMPARATOR_TRIP_REF_AIN0) {
+        DIDR1 |= _BV(AIN0D);
+    }
+    uint8_t acsr = _BV(ACIS1);
+    if (sense == COMPARATOR_TRIP_BELOW) {
+        acsr |= _BV(ACIS0);              // ACO rising edge
+    }
+    if (ref == COMPARATOR_TRIP_REF_BANDGAP) {
+        acsr |= _BV(ACBG);
+    }
+    ACSR = acsr;
+    delayMicroseconds(100);              // Bandgap start-up (70 µs max)
+#else
+    (void)ref;
+#endif
+
+    comparatorTripArm();
+    return true;
+}
+
+void comparatorTripSetCallback(ComparatorTripCallback cb, void *arg) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_callback = cb;
+        s_callbackArg = arg;
+    }
+}
+
+bool comparatorTripArm() {
+    bool armed = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+#if defined(__AVR__)
+        ACSR = (uint8_t)((ACSR & ~_BV(ACIE)) | _BV(ACI));   // Clear a stale edge
+#endif
+        if (levelBeyond()) {
+            trip();
+        } else {
+            s_tripped = false;
+#if defined(__AVR__)
+            ACSR |= _BV(ACIE);
+#endif
+            armed = true;
+        }
+    }
+    return armed;
+}
+
+bool comparatorTripped() {
+    return s_tripped;
+}
+
+bool comparatorTripBeyond() {
+    return levelBeyond();
+}
+
+uint16_t comparatorTripCount() {
+    uint16_t n;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        n = s_trips;
+    }
+    return n;
+}
+
+uint32_t comparatorTripTimeMs() {
+    uint32_t t;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t = s_tripMs;
+    }
+    return t;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file ComparatorTrip.h
+ * @brief Analog-Comparator Hard-Limit Trip (outputs cut in the ISR)
+ *
+ * The software alert path (ADC → conditioning → ThresholdAlert debounce →
+ * LED) confirms a threshold over seconds, on purpose. A hard limit must
+ * not wait for it, nor for the scheduler. ComparatorTrip watches the
+ * sensor voltage with the AVR analog comparator: when it crosses the
+ * reference, the comparator ISR drives the configured outputs (load
+ * switch, heater relay) to their safe level within a few microseconds,
+ * whatever the tasks are doing, and latches the trip. The application
+ * then hands the event to its normal alert handling and decides when to
+ * re-arm.
+ *
+ * Comparator inputs (ATmega2560):
+ *   negative  AIN1 = PE3 = D5, the sensed voltage (digital input buffer
+ *             disabled by comparatorTripInit())
+ *   positive  the internal 1.1 V bandgap (COMPARATOR_TRIP_REF_BANDGAP),
+ *             or AIN0 = PE2 (COMPARATOR_TRIP_REF_AIN0), which the Mega
+ *             board does not route to a header
+ * The trip voltage follows from the sensor divider: for an NTC to GND
+ * under a series resistor Rs, the divider reaches the bandgap at
+ * R_ntc = Rs · Vref / (Vcc − Vref), 0.282 · Rs at 1.1 V and 5 V. The
+ * bandgap is only specified to 1.0..1.2 V, so the trip point carries
+ * that tolerance; keep the soft thresholds well below it.
+ *
+ * ACO is 1 while the positive input is above AIN1, so a "below" sense
+ * (NTC to GND: hotter → lower voltage) trips on its rising edge and an
+ * "above" sense on its falling edge. The comparator has no hysteresis:
+ * the ISR trips once and disables itself until comparatorTripArm().
+ *
+ * Outputs are written with precomputed port/mask stores (one ISR never
+ * nests another, so the read-modify-write is safe); they must be plain
+ * digital outputs: PWM pins should be cut from the callback. Code that
+ * drives a cut output must check comparatorTripped() so it does not undo
+ * the trip.
+ *
+ * The comparator must stay powered (no IDLE_SLEEP_GATE_ANALOG_COMP, ACD
+ * clear). In ADC noise-reduction sleep the I/O clock is stopped, so the
+ * ISR may run up to one conversion (~0.1 ms) late.
+ *
+ * Usage:
+ *   static const ComparatorTripOutput CUT[] = { { 11, LOW }, { 9, HIGH } };
+ *   comparatorTripInit(CUT, 2, COMPARATOR_TRIP_REF_BANDGAP, COMPARATOR_TRIP_BELOW);
+ *   ...
+ *   if (comparatorTripped()) { ... }        // task: report, hand off
+ *   if (cooledDown && comparatorTripArm()) { ... }  // re-armed, restore the load
+ */
+
+#ifndef COMPARATOR_TRIP_H
+#define COMPARATOR_TRIP_H
+
+#include <Arduino.h>
+
+/** @brief Most outputs cut by one trip. */
+#define COMPARATOR_TRIP_MAX_OUTPUTS 4
+
+/** @brief Nominal bandgap reference (V); 1.0..1.2 V per datasheet. */
+#define COMPARATOR_TRIP_BANDGAP_V 1.1f
+
+/**
+ * @enum ComparatorTripReference
+ * @brief Positive comparator input.
+ */
+enum ComparatorTripReference {
+    COMPARATOR_TRIP_REF_BANDGAP,  /**< Internal 1.1 V bandgap (ACBG). */
+    COMPARATOR_TRIP_REF_AIN0      /**< External reference on AIN0.    */
+};
+
+/**
+ * @enum ComparatorTripSense
+ * @brief Direction of the hard limit on AIN1.
+ */
+enum ComparatorTripSense {
+    COMPARATOR_TRIP_BELOW,  /**< Trip when AIN1 falls below the reference. */
+    COMPARATOR_TRIP_ABOVE   /**< Trip when AIN1 rises above the reference. */
+};
+
+/** @brief An output forced by the trip. */
+struct ComparatorTripOutput {
+    uint8_t pin;        /**< Arduino pin (configured as output by init). */
+    uint8_t safeLevel;  /**< LOW or HIGH written on a trip.              */
+};
+
+/** @brief Called from the comparator ISR after the outputs are cut. */
+typedef void (*ComparatorTripCallback)(void *arg);
+
+/**
+ * @brief Configure the comparator and the outputs, then arm.
+ *
+ * The outputs are made outputs but not written: the application drives
+ * them (for instance switches the load on) after a successful init. If
+ * the input is already beyond the limit, the trip happens at once.
+ *
+ * @param outputs Outputs to cut (copied).
+ * @param count   1..COMPARATOR_TRIP_MAX_OUTPUTS.
+ * @param ref     Positive input.
+ * @param sense   Trip direction.
+ * @return false on invalid arguments.
+ */
+bool comparatorTripInit(const ComparatorTripOutput *outputs, uint8_t count,
+                        ComparatorTripReference ref, ComparatorTripSense sense);
+
+/** @brief Also call cb(arg) from the ISR on a trip (NULL: none). */
+void comparatorTripSetCallback(ComparatorTripCallback cb, void *arg);
+
+/**
+ * @brief Clear the latch and re-enable the trip.
+ *
+ * @return false if the input is still beyond the limit: the outputs are
+ *         cut again and the trip stays latched.
+ */
+bool comparatorTripArm();
+
+/** @brief True from a trip until the next successful comparatorTripArm(). */
+bool comparatorTripped();
+
+/** @brief True while the comparator sees the input beyond the limit now. */
+bool comparatorTripBeyond();
+
+/** @brief Trips since boot. */
+uint16_t comparatorTripCount();
+
+/** @brief millis() of the last trip. */
+uint32_t comparatorTripTimeMs();
+
+#endif // COMPARATOR_TRIP_H
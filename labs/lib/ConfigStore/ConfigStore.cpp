@@ -0,0 +1,323 @@
+/**
+ * @file ConfigStore.cpp
+ * @brief Config store implementation.
+ *
+ * Page slot layout (CONFIG_STORE_PAGE_BYTES each):
+ *
+ *   header (4) │ CONFIG_STORE_MAX_ENTRIES entry slots │ crc (2, last bytes)
+ *
+ * Only the header, the used entries and the CRC are written (unused slots
+ * keep whatever they held, outside the CRC). The CRC goes last, so a page
+ * cut short by a reset never validates.
+ */
+
+#include "ConfigStore.h"
+#include "TelemetryFrame.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#endif
+
+/** @brief EEPROM image of a page header. */
+struct __attribute__((packed)) ConfigPageHeader {
+    uint16_t sequence;
+    uint8_t  version;
+    uint8_t  count;             ///< Entries that follow
+};
+
+/** Byte offset of the CRC inside a page slot. */
+static const uint16_t CRC_OFFSET = CONFIG_STORE_PAGE_BYTES - sizeof(uint16_t);
+
+static uint16_t pageCrc(const ConfigPageHeader &header, const ConfigEntry *entries) {
+    uint16_t crc = crc16Ccitt(0xFFFF, (const uint8_t *)&header, sizeof(header));
+    for (uint8_t i = 0; i < header.count; i++) {
+        crc = crc16Ccitt(crc, (const uint8_t *)&entries[i], sizeof(ConfigEntry));
+    }
+    return crc;
+}
+
+ConfigStore::ConfigStore(uint16_t eepromAddress, uint8_t pages, uint8_t version)
+    : _address(eepromAddress),
+      _pages(pages >= 2 ? pages : 0),
+      _version(version),
+      _nextPage(0),
+      _nextSequence(0),
+      _storedPages(0),
+      _writes(0),
+      _count(0),
+      _dirty(false),
+      _firstChangeMs(0),
+      _lastChangeMs(0) {
+}
+
+bool ConfigStore::begin() {
+    _count = 0;
+    _dirty = false;
+    _writes = 0;
+
+    // The newest valid page is the one no other valid page follows.
+    _storedPages = 0;
+    bool found = false;
+    uint8_t newest = 0;
+    uint16_t newestSequence = 0;
+    for (uint8_t i = 0; i < _pages; i++) {
+        uint16_t sequence;
+        if (!readPage(i, &sequence, false)) {
+            continue;
+        }
+        _storedPages++;
+        if (!found || (int16_t)(sequence - newestSequence) > 0) {
+            found = true;
+            newest = i;
+            newestSequence = sequence;
+        }
+    }
+    _nextPage = found ? (uint8_t)((newest + 1) % _pages) : 0;
+    _nextSequence = found ? (uint16_t)(newestSequence + 1) : 0;
+
+    uint16_t sequence;
+    return found && readPage(newest, &sequence, true);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Typed access
+// ──────────────────────────────────────────────────────────────────────────
+
+const ConfigEntry *ConfigStore::find(uint8_t key, uint8_t type) const {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_entries[i].key == key) {
+            return (_entries[i].type == type) ? &_entries[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+bool ConfigStore::getU8(uint8_t key, uint8_t *value) const {
+    const ConfigEntry *e = find(key, CONFIG_TYPE_U8);
+    if (e == NULL) {
+        return false;
+    }
+    *value = e->value[0];
+    return true;
+}
+
+bool ConfigStore::getI32(uint8_t key, int32_t *value) const {
+    const ConfigEntry *e = find(key, CONFIG_TYPE_I32);
+    if (e == NULL) {
+        return false;
+    }
+    memcpy(value, e->value, sizeof(*value));
+    return true;
+}
+
+bool ConfigStore::getFloat(uint8_t key, float *value) const {
+    const ConfigEntry *e = find(key, CONFIG_TYPE_FLOAT);
+    if (e == NULL) {
+        return false;
+    }
+    memcpy(value, e->value, sizeof(*value));
+    return true;
+}
+
+bool ConfigStore::getString(uint8_t key, char *out, uint8_t size) const {
+    const ConfigEntry *e = find(key, CONFIG_TYPE_STRING);
+    if (e == NULL || size == 0) {
+        return false;
+    }
+    size_t len = strnlen((const char *)e->value, CONFIG_STORE_VALUE_BYTES - 1);
+    if (len >= size) {
+        return false;
+    }
+    memcpy(out, e->value, len);
+    out[len] = '\0';
+    return true;
+}
+
+bool ConfigStore::setU8(uint8_t key, uint8_t value) {
+    return set(key, CONFIG_TYPE_U8, &value, sizeof(value));
+}
+
+bool ConfigStore::setI32(uint8_t key, int32_t value) {
+    return set(key, CONFIG_TYPE_I32, &value, sizeof(value));
+}
+
+bool ConfigStore::setFloat(uint8_t key, float value) {
+    return set(key, CONFIG_TYPE_FLOAT, &value, sizeof(value));
+}
+
+bool ConfigStore::setString(uint8_t key, const char *value) {
+    size_t len = strlen(value);
+    if (len >= CONFIG_STORE_VALUE_BYTES) {
+        return false;
+    }
+    return set(key, CONFIG_TYPE_STRING, value, (uint8_t)(len + 1));
+}
+
+bool ConfigStore::set(uint8_t key, uint8_t type, const void *value, uint8_t size) {
+    if (key == CONFIG_STORE_KEY_NONE) {
+        return false;
+    }
+    ConfigEntry entry;
+    entry.key = key;
+    entry.type = type;
+    memset(entry.value, 0, sizeof(entry.value));
+    memcpy(entry.value, value, size);
+
+    uint8_t i = 0;
+    while (i < _count && _entries[i].key != key) {
+        i++;
+    }
+    if (i == _count) {
+        if (_count == CONFIG_STORE_MAX_ENTRIES) {
+            return false;
+        }
+        _count++;
+    } else if (memcmp(&_entries[i], &entry, sizeof(entry)) == 0) {
+        return true;    // Unchanged: nothing to write
+    }
+    _entries[i] = entry;
+
+    uint32_t now = millis();
+    if (!_dirty) {
+        _dirty = true;
+        _firstChangeMs = now;
+    }
+    _lastChangeMs = now;
+    return true;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Writing
+// ──────────────────────────────────────────────────────────────────────────
+
+uint8_t ConfigStore::service() {
+    if (!_dirty) {
+        return 0;
+    }
+    uint32_t now = millis();
+    if (now - _lastChangeMs < CONFIG_STORE_COALESCE_MS &&
+        now - _firstChangeMs < CONFIG_STORE_MAX_HOLD_MS) {
+        return 0;   // Still changing: wait for it to settle
+    }
+    _dirty = false;
+    if (_pages == 0) {
+        return 0;   // RAM only
+    }
+    writePage();
+    return 1;
+}
+
+void ConfigStore::flush() {
+    if (_dirty) {
+        _dirty = false;
+        if (_pages != 0) {
+            writePage();
+        }
+    }
+}
+
+void ConfigStore::clear() {
+#if defined(__AVR__)
+    // Another version byte invalidates a page: one byte write each.
+    for (uint8_t i = 0; i < _pages; i++) {
+        uint16_t at = (uint16_t)(_address + (uint16_t)i * CONFIG_STORE_PAGE_BYTES +
+                                 offsetof(ConfigPageHeader, version));
+        eeprom_update_byte((uint8_t *)(uintptr_t)at, (uint8_t)~_version);
+    }
+#endif
+    _count = 0;
+    _dirty = false;
+    _nextPage = 0;
+    _nextSequence = 0;
+    _storedPages = 0;
+}
+
+void ConfigStore::writePage() {
+    uint16_t previous;
+    if (!readPage(_nextPage, &previous, false) && _storedPages < _pages) {
+        _storedPages++;     // Replaces an invalid page, not a stored one
+    }
+
+    ConfigPageHeader header;
+    header.sequence = _nextSequence;
+    header.version = _version;
+    header.count = _count;
+    uint16_t crc = pageCrc(header, _entries);
+#if defined(__AVR__)
+    uint16_t base = (uint16_t)(_address + (uint16_t)_nextPage * CONFIG_STORE_PAGE_BYTES);
+    eeprom_update_block(&header, (void *)(uintptr_t)base, sizeof(header));
+    eeprom_update_block(_entries, (void *)(uintptr_t)(base + sizeof(header)),
+                        (size_t)_count * sizeof(ConfigEntry));
+    eeprom_update_block(&crc, (void *)(uintptr_t)(base + CRC_OFFSET), sizeof(crc));
+#else
+    (void)crc;
+#endif
+    _nextSequence++;
+    _nextPage = (uint8_t)((_nextPage + 1) % _pages);
+    if (_writes != 0xFFFF) {
+        _writes++;
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Reading
+// ──────────────────────────────────────────────────────────────────────────
+
+bool ConfigStore::readPage(uint8_t index, uint16_t *sequence, bool load) {
+#if defined(__AVR__)
+    uint16_t base = (uint16_t)(_address + (uint16_t)index * CONFIG_STORE_PAGE_BYTES);
+    ConfigPageHeader header;
+    eeprom_read_block(&header, (const void *)(uintptr_t)base, sizeof(header));
+    if (header.version != _version || header.count > CONFIG_STORE_MAX_ENTRIES) {
+        return false;   // Erased, cleared or another schema
+    }
+
+    // One entry at a time, so validating needs no page buffer.
+    uint16_t crc = crc16Ccitt(0xFFFF, (const uint8_t *)&header, sizeof(header));
+    uint16_t at = (uint16_t)(base + sizeof(header));
+    for (uint8_t i = 0; i < header.count; i++, at += sizeof(ConfigEntry)) {
+        ConfigEntry entry;
+        eeprom_read_block(&entry, (const void *)(uintptr_t)at, sizeof(entry));
+        crc = crc16Ccitt(crc, (const uint8_t *)&entry, sizeof(entry));
+        if (load) {
+            _entries[i] = entry;
+        }
+    }
+    uint16_t stored;
+    eeprom_read_block(&stored, (const void *)(uintptr_t)(base + CRC_OFFSET), sizeof(stored));
+    if (stored != crc) {
+        if (load) {
+            _count = 0;
+        }
+        return false;   // Corrupt or cut short
+    }
+    if (load) {
+        _count = header.count;
+    }
+    *sequence = header.sequence;
+    return true;
+#else
+    (void)index;
+    (void)sequence;
+    (void)load;
+    return false;
+#endif
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Accessors
+// ──────────────────────────────────────────────────────────────────────────
+
+bool ConfigStore::isDirty() const {
+    return _dirty;
+}
+
+uint8_t ConfigStore::getStoredPages() const {
+    return _storedPages;
+}
+
+uint16_t ConfigStore::getWriteCount() const {
+    return _writes;
+}
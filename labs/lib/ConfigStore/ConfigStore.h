@@ -0,0 +1,174 @@
+/**
+ * @file ConfigStore.h
+ * @brief Typed Key/Value Settings in EEPROM: Versioned, Wear-Levelled, Coalesced
+ *
+ * Keeps the values a user tunes at run time (setpoints, hysteresis band,
+ * preset, password) across a reset without reflashing. Each entry is a
+ * one-byte key with a type (u8, i32, float or short string); the whole
+ * table lives in RAM, so get() and set() are plain copies and never touch
+ * the EEPROM:
+ *
+ *   set() ──► RAM table ──service() (quiet CONFIG_STORE_COALESCE_MS)──► EEPROM page
+ *   get() ◄──     ▲
+ *                 └── begin(): newest valid page, once at startup
+ *
+ * A page is the complete table with a sequence number, the schema
+ * version given to the constructor and a CRC-16:
+ *
+ *   sequence (2) │ version (1) │ count (1) │ count × entry (11) │ crc (2)
+ *
+ * Pages are written round-robin over the region, each exactly once per
+ * lap, and the newest valid page is never overwritten: a reset during a
+ * write leaves a bad CRC on the page being written, and begin() falls
+ * back to the one before it. Pages of another version are ignored, so
+ * bumping the version when keys change meaning restores the defaults.
+ *
+ * Writes are coalesced: set() with a new value only marks the table
+ * dirty; service(), called from a low-priority task, writes one page once
+ * no value has changed for CONFIG_STORE_COALESCE_MS (or at the latest
+ * CONFIG_STORE_MAX_HOLD_MS after the first change). Ten key presses in a
+ * row cost one page write, and setting an unchanged value costs nothing.
+ * An EEPROM page write busy-waits about 3.4 ms per byte that changes,
+ * which is why it is left to service().
+ *
+ * Not locked: call set(), get() and service() from one task (or from
+ * setup() before the scheduler starts).
+ *
+ * Without an EEPROM (host builds) the table is kept in RAM only; service()
+ * still coalesces and counts the pages it would write.
+ *
+ * Usage:
+ *   static ConfigStore s_config(CONFIG_EEPROM_ADDR, CONFIG_EEPROM_PAGES, CONFIG_VERSION);
+ *   s_config.begin();                              // setup(): load once
+ *   float band = HYSTERESIS_DEFAULT_C;
+ *   s_config.getFloat(CONFIG_KEY_BAND, &band);      // keeps the default if absent
+ *   s_config.setFloat(CONFIG_KEY_BAND, band);       // owning task, any rate
+ *   s_config.service();                             // same task, every cycle
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+/** @brief Entries the table holds. */
+#ifndef CONFIG_STORE_MAX_ENTRIES
+#define CONFIG_STORE_MAX_ENTRIES 6
+#endif
+
+/** @brief Value bytes per entry: a float, an i32 or a string of up to 8 characters. */
+#ifndef CONFIG_STORE_VALUE_BYTES
+#define CONFIG_STORE_VALUE_BYTES 9
+#endif
+
+/** @brief Quiet time after the last change before service() writes. */
+#ifndef CONFIG_STORE_COALESCE_MS
+#define CONFIG_STORE_COALESCE_MS 5000UL
+#endif
+
+/** @brief Longest a change waits for its write while values keep changing. */
+#ifndef CONFIG_STORE_MAX_HOLD_MS
+#define CONFIG_STORE_MAX_HOLD_MS 60000UL
+#endif
+
+#if CONFIG_STORE_VALUE_BYTES < 4
+#error "CONFIG_STORE_VALUE_BYTES must hold at least a float"
+#endif
+
+/** @brief Key of an unused slot (erased EEPROM reads 0xFF); not usable. */
+#define CONFIG_STORE_KEY_NONE 0xFF
+
+/** @brief Byte size of one EEPROM page. */
+#define CONFIG_STORE_PAGE_BYTES (CONFIG_STORE_MAX_ENTRIES * (CONFIG_STORE_VALUE_BYTES + 2) + 6)
+
+/** @brief Type of an entry; a get() of another type fails. */
+enum ConfigType {
+    CONFIG_TYPE_NONE = 0,
+    CONFIG_TYPE_U8 = 1,
+    CONFIG_TYPE_I32 = 2,
+    CONFIG_TYPE_FLOAT = 3,
+    CONFIG_TYPE_STRING = 4
+};
+
+/** @brief One table entry, as stored. */
+struct __attribute__((packed)) ConfigEntry {
+    uint8_t key;                                ///< Caller-defined, not CONFIG_STORE_KEY_NONE
+    uint8_t type;                               ///< ConfigType
+    uint8_t value[CONFIG_STORE_VALUE_BYTES];    ///< Little-endian value or NUL-terminated string
+};
+
+class ConfigStore {
+public:
+    /**
+     * @param eepromAddress First EEPROM byte of the store region.
+     * @param pages         Pages in the region (at least 2, so a write never
+     *                      replaces the only copy); the region takes
+     *                      pages × CONFIG_STORE_PAGE_BYTES bytes.
+     * @param version       Schema version; pages of any other version are ignored.
+     */
+    ConfigStore(uint16_t eepromAddress, uint8_t pages, uint8_t version);
+
+    /**
+     * @brief Load the newest valid page into the table (call once, at startup).
+     * @return True if a page was found; false leaves the table empty.
+     */
+    bool begin();
+
+    /** @name Typed access (false: key absent, of another type, or table full) */
+    ///@{
+    bool getU8(uint8_t key, uint8_t *value) const;
+    bool getI32(uint8_t key, int32_t *value) const;
+    bool getFloat(uint8_t key, float *value) const;
+    /** @param size Bytes at @p out, terminator included. */
+    bool getString(uint8_t key, char *out, uint8_t size) const;
+
+    bool setU8(uint8_t key, uint8_t value);
+    bool setI32(uint8_t key, int32_t value);
+    bool setFloat(uint8_t key, float value);
+    /** @brief Fails for strings longer than CONFIG_STORE_VALUE_BYTES - 1. */
+    bool setString(uint8_t key, const char *value);
+    ///@}
+
+    /**
+     * @brief Write the table if it changed and has been quiet long enough.
+     * @return Pages written (0 or 1).
+     */
+    uint8_t service();
+
+    /** @brief Write a pending change now. */
+    void flush();
+
+    /** @brief Empty the table and invalidate every stored page (defaults on the next boot). */
+    void clear();
+
+    /** @brief True while a change waits for service(). */
+    bool isDirty() const;
+
+    /** @brief Valid pages of this version found by begin() or written since. */
+    uint8_t getStoredPages() const;
+
+    /** @brief Pages written since begin() (saturates). */
+    uint16_t getWriteCount() const;
+
+private:
+    bool set(uint8_t key, uint8_t type, const void *value, uint8_t size);
+    const ConfigEntry *find(uint8_t key, uint8_t type) const;
+    void writePage();
+    bool readPage(uint8_t index, uint16_t *sequence, bool load);
+
+    uint16_t _address;
+    uint8_t  _pages;
+    uint8_t  _version;
+    uint8_t  _nextPage;         // Page the next write goes to
+    uint16_t _nextSequence;
+    uint8_t  _storedPages;
+    uint16_t _writes;
+
+    ConfigEntry _entries[CONFIG_STORE_MAX_ENTRIES];
+    uint8_t  _count;
+    bool     _dirty;
+    uint32_t _firstChangeMs;    // Oldest unwritten change
+    uint32_t _lastChangeMs;
+};
+
+#endif // CONFIG_STORE_H
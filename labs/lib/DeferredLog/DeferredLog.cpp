@@ -0,0 +1,259 @@
+/**
+ * @file DeferredLog.cpp
+ * @brief Deferred printf Logging Implementation
+ *
+ * A record holds the format pointer, up to DEFERRED_LOG_MAX_ARGS integer
+ * arguments and a small text area for copied %s arguments. The same
+ * conversion scanner is used on both sides: deferredLogPrintf() walks the
+ * format to pull each argument off the va_list with the right type, and
+ * the logger task walks it again to hand each conversion to printf()
+ * with the stored value. Output goes to the log route of StdioSerial
+ * (the console unless -DSTDIO_LOG_PORT=<n> moves it).
+ *
+ * A flash format (deferredLogPrintf_P) is flagged in the record and read
+ * through pgm_read_byte() on both walks; only the conversion specs are
+ * copied to RAM, one at a time, for fprintf().
+ */
+
+#include "DeferredLog.h"
+#include "StaticRtos.h"
+#include "StdioSerial.h"
+
+#include <queue.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Record layout and module state
+// ──────────────────────────────────────────────────────────────────────────
+
+typedef struct {
+    const char *fmt;                             ///< Static format string.
+    int32_t     args[DEFERRED_LOG_MAX_ARGS];     ///< Integer value or text offset.
+    uint8_t     argc;                            ///< Number of valid args.
+    bool        flash;                           ///< fmt is in program memory.
+    char        text[DEFERRED_LOG_TEXT_MAX + 1]; ///< Copied %s arguments.
+} DeferredLogRecord_t;
+
+/// Longest single conversion spec handed to printf(), e.g. "%-10lu".
+static const uint8_t SPEC_MAX = 12;
+
+static StaticQueue<DeferredLogRecord_t, DEFERRED_LOG_QUEUE_MAX> s_logQueueStorage;
+static QueueHandle_t s_logQueue = NULL;
+static uint32_t      s_dropped  = 0;
+static void        (*s_preamble)() = NULL;
+static volatile bool s_preambleDone = true;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Format scanning
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Format character at p, from flash or RAM. */
+static inline char fmtChar(const char *p, bool flash) {
+    return flash ? (char)pgm_read_byte(p) : *p;
+}
+
+/**
+ * @brief Skip one conversion spec.
+ *
+ * @param p      Pointer just past the '%'.
+ * @param flash  The format is in program memory.
+ * @param conv   Receives the conversion character ('\0' at end of string).
+ * @param isLong Receives true if an 'l' length modifier was present.
+ * @return Pointer just past the conversion character.
+ */
+static const char *scanSpec(const char *p, bool flash, char *conv, bool *isLong) {
+    char c = fmtChar(p, flash);
+    while (c != '\0' && strchr("-+ #0123456789.", c) != NULL) {
+        c = fmtChar(++p, flash);
+    }
+    *isLong = false;
+    while (c == 'l' || c == 'h') {
+        if (c == 'l') {
+            *isLong = true;
+        }
+        c = fmtChar(++p, flash);
+    }
+    *conv = c;
+    return (c != '\0') ? p + 1 : p;
+}
+
+/** @brief Format one record to the log stream. Runs only in the logger task. */
+static void formatRecord(const DeferredLogRecord_t *rec) {
+    FILE *out = stdioSerialStream(STDIO_ROUTE_LOG);
+    char spec[SPEC_MAX];
+    uint8_t argIndex = 0;
+    const char *p = rec->fmt;
+    char c;
+
+    while ((c = fmtChar(p, rec->flash)) != '\0') {
+        if (c != '%') {
+            fputc(c, out);
+            p++;
+            continue;
+        }
+
+        const char *start = p;
+        char conv;
+        bool isLong;
+        p = scanSpec(p + 1, rec->flash, &conv, &isLong);
+
+        if (conv == '%') {
+            fputc('%', out);
+            continue;
+        }
+        if (conv == '\0') {
+            break;
+        }
+
+        size_t specLen = (size_t)(p - start);
+        if (specLen >= sizeof(spec) || argIndex >= rec->argc) {
+            // An oversized spec still has its stored argument: skip it so
+            // the later conversions stay paired with their own values.
+            if (argIndex < rec->argc) {
+                argIndex++;
+            }
+            fputc('?', out);
+            continue;
+        }
+        if (rec->flash) {
+            memcpy_P(spec, start, specLen);
+        } else {
+            memcpy(spec, start, specLen);
+        }
+        spec[specLen] = '\0';
+
+        int32_t value = rec->args[argIndex++];
+        if (conv == 's') {
+            fprintf(out, spec, &rec->text[value]);
+        } else if (isLong) {
+            fprintf(out, spec, (long)value);
+        } else {
+            fprintf(out, spec, (int)value);
+        }
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool deferredLogInit(UBaseType_t queueDepth) {
+    s_logQueue = s_logQueueStorage.create(queueDepth);
+    return s_logQueue != NULL;
+}
+
+/** @brief Copy the arguments of fmt into a record and queue it. */
+static void postRecord(const char *fmt, bool flash, va_list ap) {
+    if (s_logQueue == NULL) {
+        if (flash) {
+            vfprintf_P(stdioSerialStream(STDIO_ROUTE_LOG), fmt, ap);
+        } else {
+            vfprintf(stdioSerialStream(STDIO_ROUTE_LOG), fmt, ap);
+        }
+        return;
+    }
+
+    DeferredLogRecord_t rec;
+    rec.fmt   = fmt;
+    rec.argc  = 0;
+    rec.flash = flash;
+    rec.text[DEFERRED_LOG_TEXT_MAX] = '\0';
+    uint8_t textUsed = 0;
+
+    const char *p = fmt;
+    char c;
+    while ((c = fmtChar(p, flash)) != '\0' && rec.argc < DEFERRED_LOG_MAX_ARGS) {
+        p++;
+        if (c != '%') {
+            continue;
+        }
+        char conv;
+        bool isLong;
+        p = scanSpec(p, flash, &conv, &isLong);
+        if (conv == '%' || conv == '\0') {
+            continue;
+        }
+
+        if (conv == 's') {
+            const char *s = va_arg(ap, const char *);
+            size_t room = DEFERRED_LOG_TEXT_MAX - textUsed;
+            if (room == 0) {
+                // Out of text space: point at the permanent terminator
+                rec.args[rec.argc++] = DEFERRED_LOG_TEXT_MAX;
+                continue;
+            }
+            size_t len = strlen(s);
+            if (len > room - 1) {
+                len = room - 1;
+            }
+            memcpy(&rec.text[textUsed], s, len);
+            rec.text[textUsed + len] = '\0';
+            rec.args[rec.argc++] = textUsed;
+            textUsed += (uint8_t)(len + 1);
+        } else if (isLong) {
+            rec.args[rec.argc++] = va_arg(ap, long);
+        } else {
+            rec.args[rec.argc++] = va_arg(ap, int);
+        }
+    }
+
+    if (xQueueSend(s_logQueue, &rec, 0) != pdTRUE) {
+        taskENTER_CRITICAL();
+        s_dropped++;
+        taskEXIT_CRITICAL();
+    }
+}
+
+void deferredLogPrintf(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    postRecord(fmt, false, ap);
+    va_end(ap);
+}
+
+void deferredLogPrintf_P(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    postRecord(fmt, true, ap);
+    va_end(ap);
+}
+
+uint32_t deferredLogGetDropped() {
+    taskENTER_CRITICAL();
+    uint32_t dropped = s_dropped;
+    taskEXIT_CRITICAL();
+    return dropped;
+}
+
+void deferredLogSetPreamble(void (*print)()) {
+    s_preamble = print;
+    s_preambleDone = (print == NULL);
+}
+
+bool deferredLogPreambleDone() {
+    return s_preambleDone;
+}
+
+void vTaskDeferredLog(void *pvParameters) {
+    (void)pvParameters;
+
+    if (s_preamble != NULL) {
+        s_preamble();
+        s_preambleDone = true;
+    }
+
+    // deferredLogInit() failed or was not called: deferredLogPrintf()
+    // prints directly then, and there is nothing to receive from.
+    if (s_logQueue == NULL) {
+        vTaskDelete(NULL);
+    }
+
+    DeferredLogRecord_t rec;
+    for (;;) {
+        if (xQueueReceive(s_logQueue, &rec, portMAX_DELAY) == pdTRUE) {
+            formatRecord(&rec);
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * @file DeferredLog.h
+ * @brief Deferred printf Logging for FreeRTOS Tasks
+ *
+ * printf() formats and transmits on the calling task. At 9600 baud a
+ * single status line costs tens of milliseconds, which is charged to
+ * whatever mutex the caller happens to hold. deferredLogPrintf() instead
+ * copies the format pointer and its arguments into a small fixed-size
+ * record, posts it to a FreeRTOS queue without waiting, and returns. A
+ * low-priority logger task (vTaskDeferredLog) formats the record and
+ * writes it later, to stdout or to the USART of StdioSerial's log route
+ * (-DSTDIO_LOG_PORT=<n>).
+ *
+ * Rules for callers:
+ *   - The format string must have static storage (a string literal), in
+ *     RAM or, with deferredLogPrintf_P() / DEFERRED_LOG_PRINTF(), in flash.
+ *   - Supported conversions: d i u x X o c s and %%, with the usual flags,
+ *     width, precision and h/l length modifiers. Floats are not supported
+ *     (AVR printf does not format them either; use dtostrf + %s).
+ *   - %s arguments are copied into the record, so mutable buffers may be
+ *     logged; they share DEFERRED_LOG_TEXT_MAX bytes and are truncated.
+ *   - At most DEFERRED_LOG_MAX_ARGS arguments; extra ones print as '?'.
+ *   - If the queue is full the record is dropped and counted, never waited on.
+ *
+ * Usage:
+ *   static StaticTask<320> s_logTask;                // StaticRtos.h
+ *   deferredLogInit(8);                              // Before the scheduler
+ *   s_logTask.create(vTaskDeferredLog, "Log", NULL, 1);
+ *   deferredLogPrintf("[INPUT] PWM set to %d%%\r\n", val);
+ *   DEFERRED_LOG_PRINTF("[INPUT] PWM set to %d%%\r\n", val);   // Format in flash
+ *
+ *   deferredLogSetPreamble(printBanner);             // Optional, before the scheduler
+ */
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <Arduino.h>
+#include <Arduino_FreeRTOS.h>
+
+#include "FlashString.h"
+
+/** @brief Maximum number of arguments stored per record. */
+#ifndef DEFERRED_LOG_MAX_ARGS
+#define DEFERRED_LOG_MAX_ARGS 4
+#endif
+
+/** @brief Bytes reserved per record for copies of %s arguments. */
+#ifndef DEFERRED_LOG_TEXT_MAX
+#define DEFERRED_LOG_TEXT_MAX 12
+#endif
+
+/** @brief Records reserved for the queue (statically, see StaticRtos.h). */
+#ifndef DEFERRED_LOG_QUEUE_MAX
+#define DEFERRED_LOG_QUEUE_MAX 8
+#endif
+
+/**
+ * @brief Create the log queue.
+ *
+ * Call once from setup() before the scheduler starts, then create
+ * vTaskDeferredLog. Until the queue exists deferredLogPrintf() falls back
+ * to a direct printf().
+ *
+ * @param queueDepth Number of records that can be pending at once
+ *                   (at most DEFERRED_LOG_QUEUE_MAX).
+ * @return true if the queue was allocated.
+ */
+bool deferredLogInit(UBaseType_t queueDepth);
+
+/**
+ * @brief Queue a printf-style message for the logger task.
+ *
+ * Never blocks: returns as soon as the record is copied into the queue
+ * or dropped because the queue is full. Must not be called from an ISR.
+ *
+ * @param fmt printf format string with static storage.
+ */
+void deferredLogPrintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief deferredLogPrintf() with the format in program memory (PSTR()).
+ *
+ * The record keeps the flash pointer; the logger reads the format from
+ * flash when it prints it.
+ *
+ * @param fmt printf format string in flash.
+ */
+void deferredLogPrintf_P(const char *fmt, ...);
+
+/** @brief deferredLogPrintf_P() of a literal format (FlashString.h). */
+#define DEFERRED_LOG_PRINTF(fmt, ...) deferredLogPrintf_P(PSTR(fmt), ##__VA_ARGS__)
+
+/**
+ * @brief Number of records dropped because the queue was full.
+ */
+uint32_t deferredLogGetDropped();
+
+/**
+ * @brief Have the logger task print a block of output before any record.
+ *
+ * For the startup banner: printed from setup() it stalls the boot for
+ * about a second at 9600 baud before any task runs; as the preamble it
+ * drains at the logger's priority while the control tasks already run,
+ * and records queued meanwhile follow it. @p print may call printf()
+ * (and switch the STDIO TX policy) freely. Call before the scheduler
+ * starts.
+ *
+ * @param print Called once by vTaskDeferredLog (NULL: none).
+ */
+void deferredLogSetPreamble(void (*print)());
+
+/**
+ * @brief True once the preamble has been printed (or none was set).
+ *
+ * Tasks that print directly (e.g. a plotter line) can hold off until
+ * then, so their output does not interleave with the banner.
+ */
+bool deferredLogPreambleDone();
+
+/**
+ * @brief Logger task: formats queued records and writes them to the log stream.
+ *
+ * Create with a priority below every task that logs, so console output
+ * only consumes otherwise idle CPU time. Without a queue (deferredLogInit()
+ * failed or was not called) it prints the preamble and deletes itself.
+ *
+ * @param pvParameters Unused.
+ */
+void vTaskDeferredLog(void *pvParameters);
+
+#endif // DEFERRED_LOG_H
@@ -0,0 +1,86 @@
+/**
+ * @file DeltaSeries.cpp
+ * @brief Delta / Zig-Zag Varint Codec Implementation
+ *
+ * Deltas are taken and applied modulo 2^32 (unsigned arithmetic), so the
+ * round trip is exact for every pair of values, wraps included.
+ */
+
+#include "DeltaSeries.h"
+
+#include <math.h>
+
+uint8_t varintEncode(uint32_t value, uint8_t *out) {
+    uint8_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+uint8_t varintDecode(const uint8_t *in, uint16_t len, uint32_t *value) {
+    uint32_t result = 0;
+    for (uint8_t n = 0; n < DELTA_SERIES_VARINT_MAX && n < len; n++) {
+        result |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+        if ((in[n] & 0x80) == 0) {
+            *value = result;
+            return (uint8_t)(n + 1);
+        }
+    }
+    return 0;
+}
+
+int32_t deltaSeriesQuantize(float value, int32_t scale) {
+    if (isnan(value)) {
+        return DELTA_SERIES_NONE;
+    }
+    float scaled = value * (float)scale;
+    // INT32_MAX is not exact in a float; 2^31 is the first value out of range
+    if (scaled >= 2147483648.0f) {
+        return INT32_MAX;
+    }
+    if (scaled <= -2147483648.0f) {
+        return INT32_MIN + 1;  // Not DELTA_SERIES_NONE
+    }
+    int32_t q = (int32_t)lroundf(scaled);
+    return q == DELTA_SERIES_NONE ? INT32_MIN + 1 : q;
+}
+
+float deltaSeriesValue(int32_t quantized, int32_t scale) {
+    if (quantized == DELTA_SERIES_NONE) {
+        return NAN;
+    }
+    return (float)quantized / (float)scale;
+}
+
+uint8_t deltaSeriesEncode(const int32_t *values, int32_t *previous, uint8_t channels,
+                          uint8_t *out) {
+    uint8_t n = 0;
+    for (uint8_t c = 0; c < channels; c++) {
+        int32_t delta = (int32_t)((uint32_t)values[c] - (uint32_t)previous[c]);
+        n = (uint8_t)(n + varintEncode(zigzagEncode(delta), &out[n]));
+        previous[c] = values[c];
+    }
+    return n;
+}
+
+uint8_t deltaSeriesDecode(const uint8_t *in, uint16_t len, int32_t *values, uint8_t channels) {
+    // Check that the whole sample is there before changing values
+    uint32_t delta;
+    uint16_t n = 0;
+    for (uint8_t c = 0; c < channels; c++) {
+        uint8_t used = varintDecode(&in[n], (uint16_t)(len - n), &delta);
+        if (used == 0) {
+            return 0;
+        }
+        n = (uint16_t)(n + used);
+    }
+    n = 0;
+    for (uint8_t c = 0; c < channels; c++) {
+        n = (uint16_t)(n + varintDecode(&in[n], (uint16_t)(len - n), &delta));
+        values[c] = (int32_t)((uint32_t)values[c] + (uint32_t)zigzagDecode(delta));
+    }
+    return (uint8_t)n;
+}
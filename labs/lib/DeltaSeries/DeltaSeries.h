@@ -0,0 +1,242 @@
+/**
+ * @file DeltaSeries.h
+ * @brief Compressed Time-Series History: Fixed Point, Delta, Zig-Zag Varint
+ *
+ * Slowly changing readings stored as floats spend 4 bytes on a value
+ * that moved by a few hundredths. A DeltaSeries stores each sample of
+ * Channels values as
+ *
+ *   value  ──quantize──►  q = round(value × scale)           (int32, fixed point)
+ *   q      ──delta─────►  d = q − previous q                 (mod 2^32, exact)
+ *   d      ──zig-zag───►  z = (d << 1) ^ (d >> 31)           (small |d| → small z)
+ *   z      ──varint────►  7 bits per byte, high bit = more   (1 byte for |d| < 64)
+ *
+ * so a temperature in hundredths that moves by less than 0.64 C per
+ * sample costs one byte instead of four, and a timestamp quantized to
+ * the sampling interval one byte instead of four: 4–8× more history in
+ * the same RAM, and as much less to send on a dump.
+ *
+ * The samples live in a byte ring of Bytes bytes. When a new sample does
+ * not fit, the oldest ones are decoded and folded into a base sample (the
+ * values just before the oldest kept sample), so the stream never needs
+ * a keyframe and every kept sample decodes exactly. Any value survives
+ * the round trip, including INT32 extremes and wraps (a delta of up to
+ * 5 bytes); DELTA_SERIES_NONE marks a missing (NaN) reading.
+ *
+ * Raw dumps: a reader that has getBase() and the bytes from copyBytes()
+ * rebuilds every sample with deltaSeriesDecode(), on the board or on the
+ * host (the same few lines in any language).
+ *
+ * Not locked: append and read from one task, or guard the series.
+ *
+ * Usage:
+ *   static DeltaSeries<3, 512> s_history;        // time + 2 temperatures
+ *   int32_t q[3] = { (int32_t)(millis() / 100),
+ *                    deltaSeriesQuantize(tempA, 100), deltaSeriesQuantize(tempB, 100) };
+ *   s_history.append(q);
+ *   s_history.forEach(printSample, NULL);        // oldest first
+ */
+
+#ifndef DELTA_SERIES_H
+#define DELTA_SERIES_H
+
+#include <stdint.h>
+#include <string.h>
+
+/** @brief Quantized value of a missing (NaN) reading. */
+#define DELTA_SERIES_NONE INT32_MIN
+
+/** @brief Longest varint of a 32-bit value. */
+#define DELTA_SERIES_VARINT_MAX 5
+
+// ──────────────────────────────────────────────────────────────────────────
+// Codec
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Map signed to unsigned so that small magnitudes stay small (0, -1, 1, -2 → 0, 1, 2, 3). */
+inline uint32_t zigzagEncode(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/** @brief Inverse of zigzagEncode(). */
+inline int32_t zigzagDecode(uint32_t value) {
+    return (int32_t)((value >> 1) ^ (0u - (value & 1u)));
+}
+
+/**
+ * @brief Write a varint (LEB128: 7 bits per byte, least significant first).
+ *
+ * @param out At least DELTA_SERIES_VARINT_MAX bytes.
+ * @return Bytes written (1..5).
+ */
+uint8_t varintEncode(uint32_t value, uint8_t *out);
+
+/**
+ * @brief Read a varint.
+ *
+ * @param in  Encoded bytes.
+ * @param len Bytes available.
+ * @return Bytes read, or 0 if the varint is truncated or longer than 5 bytes.
+ */
+uint8_t varintDecode(const uint8_t *in, uint16_t len, uint32_t *value);
+
+/**
+ * @brief Fixed-point value of a reading.
+ *
+ * @return round(value × scale), saturated to the int32 range, or
+ *         DELTA_SERIES_NONE for NaN.
+ */
+int32_t deltaSeriesQuantize(float value, int32_t scale);
+
+/** @brief Reading of a fixed-point value (NaN for DELTA_SERIES_NONE). */
+float deltaSeriesValue(int32_t quantized, int32_t scale);
+
+/**
+ * @brief Encode one sample as deltas from the previous one.
+ *
+ * @param values   The sample's channels values.
+ * @param previous The previous sample (all zero before the first); set to values.
+ * @param out      At least channels × DELTA_SERIES_VARINT_MAX bytes.
+ * @return Bytes written.
+ */
+uint8_t deltaSeriesEncode(const int32_t *values, int32_t *previous, uint8_t channels,
+                          uint8_t *out);
+
+/**
+ * @brief Decode one sample, adding its deltas to values.
+ *
+ * @param values In: the previous sample. Out: this sample. Unchanged on failure.
+ * @return Bytes read, or 0 if the sample is truncated.
+ */
+uint8_t deltaSeriesDecode(const uint8_t *in, uint16_t len, int32_t *values, uint8_t channels);
+
+// ──────────────────────────────────────────────────────────────────────────
+// History ring
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @class DeltaSeries
+ * @brief Byte ring of delta-encoded samples that drops the oldest to fit.
+ *
+ * @tparam Channels Values per sample (1..16).
+ * @tparam Bytes    Ring size; at least Channels × DELTA_SERIES_VARINT_MAX.
+ */
+template <uint8_t Channels, uint16_t Bytes>
+class DeltaSeries {
+    static_assert(Channels >= 1 && Channels <= 16, "DeltaSeries holds 1..16 channels");
+    static_assert(Bytes >= Channels * DELTA_SERIES_VARINT_MAX,
+                  "DeltaSeries must hold the largest sample");
+
+public:
+    DeltaSeries() { clear(); }
+
+    /** @brief Forget every sample (the dropped count too). */
+    void clear() {
+        _tail = 0;
+        _used = 0;
+        _count = 0;
+        _dropped = 0;
+        memset(_base, 0, sizeof(_base));
+        memset(_last, 0, sizeof(_last));
+    }
+
+    /**
+     * @brief Add a sample, dropping the oldest ones if it does not fit.
+     *
+     * @param values Channels quantized values (deltaSeriesQuantize()).
+     */
+    void append(const int32_t *values) {
+        uint8_t encoded[Channels * DELTA_SERIES_VARINT_MAX];
+        uint8_t len = deltaSeriesEncode(values, _last, Channels, encoded);
+        while (Bytes - _used < len) {
+            dropOldest();
+        }
+        uint16_t at = index(_used);
+        for (uint8_t i = 0; i < len; i++) {
+            _data[at] = encoded[i];
+            at = (uint16_t)(at + 1 == Bytes ? 0 : at + 1);
+        }
+        _used = (uint16_t)(_used + len);
+        _count++;
+    }
+
+    /**
+     * @brief Visit every sample, oldest first.
+     *
+     * @param visit Called with the decoded Channels values.
+     * @return Samples visited.
+     */
+    uint16_t forEach(void (*visit)(const int32_t *values, void *context), void *context) const {
+        int32_t values[Channels];
+        memcpy(values, _base, sizeof(values));
+        uint16_t offset = 0;
+        for (uint16_t n = 0; n < _count; n++) {
+            offset = (uint16_t)(offset + readSample(offset, values));
+            visit(values, context);
+        }
+        return _count;
+    }
+
+    /** @brief The newest sample (the base sample if empty). */
+    void getLast(int32_t *values) const { memcpy(values, _count > 0 ? _last : _base, sizeof(_last)); }
+
+    /** @brief The values the oldest kept sample is a delta from. */
+    void getBase(int32_t *values) const { memcpy(values, _base, sizeof(_base)); }
+
+    /**
+     * @brief Copy encoded bytes, oldest first, for a raw dump.
+     *
+     * @param offset First byte (0 = the oldest sample's first byte).
+     * @return Bytes copied (fewer than len at the end of the stream).
+     */
+    uint16_t copyBytes(uint16_t offset, uint8_t *out, uint16_t len) const {
+        uint16_t n = 0;
+        for (; n < len && offset + n < _used; n++) {
+            out[n] = _data[index((uint16_t)(offset + n))];
+        }
+        return n;
+    }
+
+    /** @brief Samples held. */
+    uint16_t count() const { return _count; }
+
+    /** @brief Bytes the samples take. */
+    uint16_t bytesUsed() const { return _used; }
+
+    /** @brief Samples dropped to make room since clear(). */
+    uint32_t getDropped() const { return _dropped; }
+
+    /** @brief Ring size. */
+    static uint16_t capacity() { return Bytes; }
+
+private:
+    uint16_t index(uint16_t offset) const {
+        uint16_t at = (uint16_t)(_tail + offset);
+        return at >= Bytes ? (uint16_t)(at - Bytes) : at;
+    }
+
+    /** @return Bytes of the sample at offset, whose deltas are added to values. */
+    uint8_t readSample(uint16_t offset, int32_t *values) const {
+        uint8_t encoded[Channels * DELTA_SERIES_VARINT_MAX];
+        uint8_t len = (uint8_t)copyBytes(offset, encoded, sizeof(encoded));
+        return deltaSeriesDecode(encoded, len, values, Channels);
+    }
+
+    void dropOldest() {
+        uint8_t len = readSample(0, _base);
+        _tail = index(len);
+        _used = (uint16_t)(_used - len);
+        _count--;
+        _dropped++;
+    }
+
+    uint8_t  _data[Bytes];
+    int32_t  _base[Channels];   ///< Values before the oldest kept sample
+    int32_t  _last[Channels];   ///< Newest sample (the next delta's reference)
+    uint16_t _tail;             ///< Ring index of the oldest byte
+    uint16_t _used;
+    uint16_t _count;
+    uint32_t _dropped;
+};
+
+#endif // DELTA_SERIES_H
@@ -1,39 +1,222 @@
 /**
  * @file DhtSensor.cpp
- * @brief DHT temperature and humidity sensor wrapper implementation.
+ * @brief DHT temperature and humidity sensor driver implementation.
+ *
+ * The ISR only stores the low 16 bits of micros() per falling edge (a
+ * response spans ~5 ms, far inside the 65 ms wrap), so it is a few
+ * microseconds long; other interrupts delaying it by up to ~20 µs still
+ * leave the 0/1 bit periods (~76 / ~120 µs) apart.
  */
 
 #include "DhtSensor.h"
 #include <math.h>
 
+/** Bit period (µs) above which a bit reads as 1. */
+static const uint16_t BIT_ONE_THRESHOLD_US = 98;
+
+/** Bit periods outside this range mean a missed or spurious edge. */
+static const uint16_t BIT_MIN_US = 50;
+static const uint16_t BIT_MAX_US = 160;
+
+/** Start pulse: DHT11 needs ≥ 18 ms, DHT21/22 about 1 ms. */
+static const uint16_t START_LOW_DHT11_US = 20000;
+static const uint16_t START_LOW_DHT22_US = 1100;
+
+DhtSensor *volatile DhtSensor::s_active = NULL;
+
 DhtSensor::DhtSensor(uint8_t dataPin, uint8_t sensorType)
-    : _dht(dataPin, sensorType),
+    : _pin(dataPin),
+      _type(sensorType),
       _temperatureC(NAN),
       _humidityPercent(NAN),
-      _valid(false) {}
+      _valid(false),
+      _hasRead(false),
+      _retryPending(false),
+      _lastReadMs(0),
+      _sampleMs(0),
+      _startUs(0),
+      _sampleUs(0),
+      _errors(0),
+      _edgeCount(0),
+      _onComplete(NULL),
+      _onCompleteArg(NULL) {}
 
 void DhtSensor::init() {
-    _dht.begin();
+    pinMode(_pin, INPUT_PULLUP);
     _temperatureC = NAN;
     _humidityPercent = NAN;
     _valid = false;
+    _hasRead = false;
+    _retryPending = false;
+    _errors = 0;
 }
 
+// ──────────────────────────────────────────────────────────────────────────
+// Blocking read
+// ──────────────────────────────────────────────────────────────────────────
+
 bool DhtSensor::read() {
-    float humidity = _dht.readHumidity();
-    float temperature = _dht.readTemperature();
+    if (!isReadDue()) {
+        return _valid;  // Cached sample, no bus transaction
+    }
+
+    uint16_t lowUs = beginStartSignal();
+    delay((lowUs + 999) / 1000);
+
+    if (beginCapture()) {
+        uint32_t start = millis();
+        while (!isCaptureComplete() &&
+               (uint32_t)(millis() - start) < DHT_CAPTURE_TIMEOUT_MS) {
+        }
+    }
+    finishRead();
+    return _valid;
+}
+
+bool DhtSensor::isReadDue() const {
+    if (!_hasRead) {
+        return true;
+    }
+    uint32_t wait = _retryPending ? DHT_RETRY_DELAY_MS : minIntervalMs();
+    return (uint32_t)(millis() - _lastReadMs) >= wait;
+}
 
-    if (isnan(humidity) || isnan(temperature)) {
-        _valid = false;
+uint16_t DhtSensor::minIntervalMs() const {
+    return (_type == DHT11) ? DHT_MIN_INTERVAL_DHT11_MS : DHT_MIN_INTERVAL_DHT22_MS;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Split read: start pulse → edge capture → decode
+// ──────────────────────────────────────────────────────────────────────────
+
+uint16_t DhtSensor::beginStartSignal() {
+    _startUs = micros();    // The sensor samples on this request
+    digitalWrite(_pin, LOW);
+    pinMode(_pin, OUTPUT);
+    return (_type == DHT11) ? START_LOW_DHT11_US : START_LOW_DHT22_US;
+}
+
+bool DhtSensor::beginCapture(CaptureCallback onComplete, void *arg) {
+    int irq = digitalPinToInterrupt(_pin);
+    if (irq == NOT_AN_INTERRUPT) {
+        pinMode(_pin, INPUT_PULLUP);
         return false;
     }
 
+    // Attach while the line is still held low: a flag latched by our own
+    // falling edge fires now, with s_active NULL, and is ignored.
+    s_active = NULL;
+    attachInterrupt(irq, onEdge, FALLING);
+
+    noInterrupts();
+    _edgeCount = 0;
+    _onComplete = onComplete;
+    _onCompleteArg = arg;
+    s_active = this;
+    interrupts();
+
+    pinMode(_pin, INPUT_PULLUP);  // Release: the sensor answers ~20–40 µs later
+    return true;
+}
+
+bool DhtSensor::isCaptureComplete() const {
+    return _edgeCount >= DHT_EDGE_COUNT;
+}
+
+void DhtSensor::onEdge() {
+    DhtSensor *self = s_active;
+    if (self == NULL) {
+        return;
+    }
+    uint8_t n = self->_edgeCount;
+    self->_edges[n] = (uint16_t)micros();
+    self->_edgeCount = ++n;
+    if (n >= DHT_EDGE_COUNT) {
+        s_active = NULL;
+        detachInterrupt(digitalPinToInterrupt(self->_pin));
+        if (self->_onComplete != NULL) {
+            self->_onComplete(self->_onCompleteArg);
+        }
+    }
+}
+
+bool DhtSensor::finishRead() {
+    int irq = digitalPinToInterrupt(_pin);
+    noInterrupts();
+    bool wasActive = (s_active == this);
+    if (wasActive) {
+        s_active = NULL;
+    }
+    interrupts();
+    if (wasActive && irq != NOT_AN_INTERRUPT) {
+        detachInterrupt(irq);  // Timed out before the last edge
+    }
+
+    _hasRead = true;
+    _lastReadMs = millis();
+
+    uint8_t data[5];
+    if (!isCaptureComplete() || !decode(data)) {
+        if (_errors < 0xFFFF) {
+            _errors++;
+        }
+        if (_retryPending) {
+            _valid = false;  // Retry failed as well
+            _retryPending = false;
+        } else {
+            _retryPending = true;  // Keep serving the cache until the retry
+        }
+        return false;
+    }
+
+    float humidity;
+    float temperature;
+    if (_type == DHT11) {
+        humidity = data[0] + data[1] * 0.1f;
+        temperature = data[2];
+        if (data[3] & 0x80) {
+            temperature = -1.0f - temperature;
+        }
+        temperature += (data[3] & 0x0F) * 0.1f;
+    } else {
+        humidity = (((uint16_t)data[0] << 8) | data[1]) * 0.1f;
+        temperature = (((uint16_t)(data[2] & 0x7F) << 8) | data[3]) * 0.1f;
+        if (data[2] & 0x80) {
+            temperature = -temperature;
+        }
+    }
+
     _humidityPercent = humidity;
     _temperatureC = temperature;
     _valid = true;
+    _retryPending = false;
+    _sampleMs = _lastReadMs;
+    _sampleUs = _startUs;
     return true;
 }
 
+bool DhtSensor::decode(uint8_t *data) const {
+    for (uint8_t i = 0; i < 5; i++) {
+        data[i] = 0;
+    }
+    for (uint8_t bit = 0; bit < 40; bit++) {
+        uint16_t period = (uint16_t)(_edges[bit + 2] - _edges[bit + 1]);
+        if (period < BIT_MIN_US || period > BIT_MAX_US) {
+            return false;
+        }
+        data[bit >> 3] <<= 1;
+        if (period > BIT_ONE_THRESHOLD_US) {
+            data[bit >> 3] |= 1;
+        }
+    }
+    uint8_t sum = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+    return sum == data[4];
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Accessors
+// ──────────────────────────────────────────────────────────────────────────
+
 float DhtSensor::getTemperatureC() const {
     return _temperatureC;
 }
@@ -45,3 +228,22 @@ float DhtSensor::getHumidityPercent() const {
 bool DhtSensor::isValid() const {
     return _valid;
 }
+
+uint32_t DhtSensor::getSampleTimeMs() const {
+    return _sampleMs;
+}
+
+uint32_t DhtSensor::getSampleTimeUs() const {
+    return _sampleUs;
+}
+
+uint32_t DhtSensor::getSampleAgeMs() const {
+    if (isnan(_temperatureC)) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)(millis() - _sampleMs);
+}
+
+uint16_t DhtSensor::getErrorCount() const {
+    return _errors;
+}
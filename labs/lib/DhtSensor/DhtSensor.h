@@ -1,50 +1,193 @@
 /**
  * @file DhtSensor.h
- * @brief DHT temperature and humidity sensor wrapper.
+ * @brief DHT temperature and humidity sensor driver (interrupt-timed).
  *
- * Provides a small reusable interface around the Arduino DHT library.
- * The wrapper keeps the last valid temperature and humidity values so
- * application code can distinguish sensor failures from valid samples.
+ * Decodes the DHT11/DHT21/DHT22 single-wire protocol without disabling
+ * interrupts. The usual bit-banged read spins with interrupts off for the
+ * whole ~4–5 ms response, which stalls the FreeRTOS tick and the UART;
+ * here an external interrupt on the data pin only timestamps falling
+ * edges, and the bits are decoded afterwards in task context.
+ *
+ * Protocol (after the host's start pulse, line released):
+ *
+ *   ──┐ 80 µs ┌─ 80 µs ──┐ 50 µs ┌─ 26/70 µs ─┐ 50 µs ┌── ... ──┐ 50 µs ┌──
+ *     └───────┘          └───────┘            └───────┘         └───────┘
+ *     F0                 F1                   F2                F41
+ *
+ *   42 falling edges; bit i = F(i+2) - F(i+1): ~76 µs → 0, ~120 µs → 1.
+ *   40 bits = humidity (2 B), temperature (2 B), checksum (1 B).
+ *
+ * The data pin must support an external interrupt (Mega: 2, 3, 18–21).
+ *
+ * Rate limiting and caching:
+ *   The sensor cannot be read faster than once per DHT11 1 s / DHT22 2 s.
+ *   read() (and dhtSensorReadRtos()) only touch the bus when isReadDue();
+ *   otherwise they return the cached sample, whose capture time and age
+ *   are available for prediction. A failed read is retried once after
+ *   DHT_RETRY_DELAY_MS; only if the retry fails too is the sensor
+ *   reported invalid. Callers can therefore poll as often as they like.
+ *
+ * Usage (blocking, interrupts stay enabled):
+ *   DhtSensor dht(2, DHT11);
+ *   dht.init();
+ *   if (dht.read()) { float t = dht.getTemperatureC(); }
+ *
+ * Usage (split, e.g. from a task; see DhtSensorRtos.h):
+ *   uint16_t lowUs = dht.beginStartSignal();   // line low
+ *   ... wait lowUs ...
+ *   dht.beginCapture(onDone, arg);             // onDone() runs in the ISR
+ *   ... wait for onDone / DHT_CAPTURE_TIMEOUT_MS ...
+ *   bool ok = dht.finishRead();
  */
 
 #ifndef DHT_SENSOR_H
 #define DHT_SENSOR_H
 
 #include <Arduino.h>
-#include <DHT.h>
+
+// Sensor type constants, compatible with the Adafruit DHT library's.
+#ifndef DHT11
+#define DHT11 11
+#endif
+#ifndef DHT21
+#define DHT21 21
+#endif
+#ifndef DHT22
+#define DHT22 22
+#endif
+
+/** Falling edges in a complete response (see the diagram above). */
+#define DHT_EDGE_COUNT 42
+
+/** Longest response after the line is released (~5.3 ms + margin). */
+#define DHT_CAPTURE_TIMEOUT_MS 10
+
+/** Minimum time between bus reads (datasheet sampling period). */
+#define DHT_MIN_INTERVAL_DHT11_MS 1000
+#define DHT_MIN_INTERVAL_DHT22_MS 2000
+
+/** Delay before the single retry of a failed read. */
+#define DHT_RETRY_DELAY_MS 250
 
 class DhtSensor {
 public:
+    /** @brief Called from the edge ISR once a full response was captured. */
+    typedef void (*CaptureCallback)(void *arg);
+
     /**
-     * @brief Construct a DHT sensor wrapper.
-     * @param dataPin GPIO pin connected to the DHT data line.
-     * @param sensorType DHT11, DHT21, or DHT22 constant from DHT.h.
+     * @brief Construct a DHT sensor driver.
+     * @param dataPin GPIO pin connected to the DHT data line (with an
+     *                external interrupt).
+     * @param sensorType DHT11, DHT21, or DHT22.
      */
     DhtSensor(uint8_t dataPin, uint8_t sensorType);
 
-    /** @brief Initialize the DHT driver. */
+    /** @brief Initialize the data line (idle high). */
     void init();
 
     /**
-     * @brief Read both temperature and humidity.
-     * @return true when both values are valid; false on checksum/timeout error.
+     * @brief Read both temperature and humidity (rate limited).
+     *
+     * When isReadDue(), runs the whole start → capture → decode sequence,
+     * waiting with delay() and interrupts enabled (~25 ms for DHT11, ~7 ms
+     * for DHT22); otherwise returns at once with the cached sample.
+     *
+     * @return true while the cached sample is valid (see isValid()).
      */
     bool read();
 
+    /**
+     * @brief True if the minimum interval (or the retry delay after a
+     *        failure) has elapsed, so the next read goes to the bus.
+     */
+    bool isReadDue() const;
+
+    /**
+     * @brief Drive the start pulse (data line low).
+     * @return uint16_t Minimum time (µs) to hold it before beginCapture().
+     */
+    uint16_t beginStartSignal();
+
+    /**
+     * @brief Release the line and start timestamping the response.
+     *
+     * @param onComplete Optional callback, run in interrupt context after
+     *                   the last edge (e.g. to notify a task).
+     * @param arg        Passed to onComplete.
+     * @return false if the pin has no external interrupt.
+     */
+    bool beginCapture(CaptureCallback onComplete = NULL, void *arg = NULL);
+
+    /** @brief True once all DHT_EDGE_COUNT edges were captured. */
+    bool isCaptureComplete() const;
+
+    /**
+     * @brief Stop capturing, decode the response and update the cache.
+     *
+     * A first failure keeps the cached sample valid and schedules a retry;
+     * a second consecutive one marks it invalid.
+     *
+     * @return true when this response decoded; false on an incomplete
+     *         capture, a bit-timing error or a checksum mismatch.
+     */
+    bool finishRead();
+
     /** @brief Get the last valid temperature in degrees Celsius. */
     float getTemperatureC() const;
 
     /** @brief Get the last valid relative humidity percentage. */
     float getHumidityPercent() const;
 
-    /** @brief True if the last read produced valid values. */
+    /** @brief True if the cached sample is valid (at most one failed retry pending). */
     bool isValid() const;
 
+    /** @brief millis() at the capture of the cached sample. */
+    uint32_t getSampleTimeMs() const;
+
+    /**
+     * @brief micros() at the start signal of the cached sample's read.
+     *
+     * For sample-to-sample intervals (integration dt) finer than
+     * millis() and independent of when the reader got to run; wraps
+     * after ~71 min, so only differences are meaningful.
+     */
+    uint32_t getSampleTimeUs() const;
+
+    /** @brief Age of the cached sample (ms); UINT32_MAX if none yet. */
+    uint32_t getSampleAgeMs() const;
+
+    /** @brief Total failed bus reads since init() (saturates). */
+    uint16_t getErrorCount() const;
+
 private:
-    DHT _dht;
+    /** @brief External interrupt handler: forwards to the active sensor. */
+    static void onEdge();
+
+    /** @brief Decode the captured edges into 5 bytes. */
+    bool decode(uint8_t *data) const;
+
+    /** @brief Minimum bus read interval of this sensor type (ms). */
+    uint16_t minIntervalMs() const;
+
+    static DhtSensor *volatile s_active;   /**< Sensor being captured. */
+
+    uint8_t _pin;
+    uint8_t _type;
     float _temperatureC;
     float _humidityPercent;
     bool _valid;
+    bool _hasRead;                         /**< A bus read was attempted. */
+    bool _retryPending;                    /**< Last read failed once.    */
+    uint32_t _lastReadMs;                  /**< millis() of the last read. */
+    uint32_t _sampleMs;                    /**< millis() of the cached sample. */
+    uint32_t _startUs;                     /**< micros() of the last start signal. */
+    uint32_t _sampleUs;                    /**< micros() of the cached sample. */
+    uint16_t _errors;                      /**< Failed reads.              */
+
+    volatile uint8_t _edgeCount;           /**< Edges captured so far. */
+    uint16_t _edges[DHT_EDGE_COUNT];       /**< micros() of each edge.  */
+    CaptureCallback _onComplete;
+    void *_onCompleteArg;
 };
 
 #endif // DHT_SENSOR_H
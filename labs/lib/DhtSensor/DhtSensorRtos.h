@@ -0,0 +1,68 @@
+/**
+ * @file DhtSensorRtos.h
+ * @brief DHT Read for FreeRTOS Tasks
+ *
+ * FreeRTOS counterpart of DhtSensor::read(), with the same rate limit:
+ * unless isReadDue() it returns the cached sample at once. Otherwise the
+ * calling task sleeps through the start pulse (DHT11: ≥ 18 ms, i.e. a
+ * few ticks) and then blocks on its task notification, which the edge
+ * ISR gives after the last bit, so neither phase burns CPU time.
+ * Interrupts stay enabled.
+ *
+ * The notification makes the task ready; it runs at the next scheduling
+ * point (at the latest the next tick), well within the DHT's 1–2 s
+ * sampling period.
+ *
+ * Header-only so that labs without FreeRTOS never see the dependency.
+ *
+ * Usage:
+ *   if (dhtSensorReadRtos(s_dht)) {
+ *       float t = s_dht.getTemperatureC();
+ *   }
+ */
+
+#ifndef DHT_SENSOR_RTOS_H
+#define DHT_SENSOR_RTOS_H
+
+#include "RtosTick.h"
+#include "DhtSensor.h"
+
+/** @brief Capture callback: wake the task passed as arg (ISR context). */
+inline void dhtSensorNotifyFromIsr(void *arg) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)arg, &woken);
+    (void)woken;
+}
+
+/**
+ * @brief Read a DHT sensor, blocking only the calling task.
+ *
+ * Uses the calling task's notification value as its wake-up signal; do
+ * not combine with other notification-based protocols on the same task.
+ *
+ * @param dht Initialized sensor.
+ * @return true while the cached sample is valid (see DhtSensor::isValid()).
+ */
+inline bool dhtSensorReadRtos(DhtSensor &dht) {
+    if (!dht.isReadDue()) {
+        return dht.isValid();
+    }
+
+    uint16_t lowUs = dht.beginStartSignal();
+    if (lowUs < 2000) {
+        delayMicroseconds(lowUs);  // DHT22: shorter than one tick
+    } else {
+        // Round up and add one tick: the first tick may be partial.
+        uint32_t lowMs = (lowUs + 999U) / 1000U;
+        vTaskDelay((TickType_t)((lowMs + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS + 1));
+    }
+
+    ulTaskNotifyTake(pdTRUE, 0);  // Drop a stale notification
+    if (dht.beginCapture(dhtSensorNotifyFromIsr, xTaskGetCurrentTaskHandle())) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DHT_CAPTURE_TIMEOUT_MS) + 1);
+    }
+    dht.finishRead();
+    return dht.isValid();
+}
+
+#endif // DHT_SENSOR_RTOS_H
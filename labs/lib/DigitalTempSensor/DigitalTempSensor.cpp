@@ -5,54 +5,142 @@
  * Implements OneWire-based temperature reading from the DS18B20 sensor.
  * Uses the DallasTemperature library for protocol handling and provides
  * both blocking and non-blocking read modes.
+ *
+ * Bus cost per sample (standard speed, one device):
+ *   getTempCByIndex()  search ROM (~14 ms) + match ROM + scratchpad (~11 ms)
+ *   readDevice()       match ROM + scratchpad (~11 ms); CRC-8 checked here,
+ *                      raw counts converted locally
+ *   readTemperatureFast()  skip ROM + 2 bytes + reset (~3.5 ms), single
+ *                      drop only, with a full readDevice() every
+ *                      DIGITAL_TEMP_FULL_READ_EVERY reads
+ * and the conversion wait is a millis() deadline, not a bus poll.
+ *
+ * With DIGITAL_TEMP_UART_ONEWIRE the bus* helpers send each sequence as
+ * one UartOneWire transaction instead (DallasTemperature is not used):
+ * a slot takes ~92 µs instead of ~70 µs, so the addressed read is ~14 ms,
+ * but interrupts stay enabled throughout.
  */
 
 #include "DigitalTempSensor.h"
+#include <string.h>
+
+/** DS18B20 returns +85.0°C (raw 0x0550) on power-on reset. */
+static const int16_t POWER_ON_RESET_RAW = 0x0550;
+
+/** Scratchpad bytes: temperature LSB/MSB, TH, TL, config ... CRC at 8. */
+static const uint8_t SCRATCHPAD_TH  = 2;
+static const uint8_t SCRATCHPAD_TL  = 3;
+static const uint8_t SCRATCHPAD_CRC = 8;
+
+/** DS18B20 Write Scratchpad command (TH, TL, config; no EEPROM copy). */
+static const uint8_t CMD_WRITE_SCRATCHPAD = 0x4E;
+
+/** DS18B20 Read Scratchpad command; reading may stop after any byte. */
+static const uint8_t CMD_READ_SCRATCHPAD = 0xBE;
 
-/** DS18B20 returns -127.0°C when disconnected. */
-static const float DISCONNECTED_TEMP = -127.0f;
+/** Scratchpad length, CRC included. */
+static const uint8_t SCRATCHPAD_LEN = 9;
 
-/** DS18B20 returns +85.0°C on power-on reset (no conversion started). */
-static const float POWER_ON_RESET_TEMP = 85.0f;
+/** DS18B20 measuring range, -55..+125 °C in 1/16 °C. */
+static const int16_t RAW_MIN = -55 * 16;
+static const int16_t RAW_MAX = 125 * 16;
+
+/** Power-on alarm register contents (from the factory EEPROM). */
+static const uint8_t DEFAULT_TH = 0x4B;
+static const uint8_t DEFAULT_TL = 0x46;
+
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+/** 1-Wire ROM / function commands sent directly in this backend. */
+static const uint8_t CMD_MATCH_ROM = 0x55;
+static const uint8_t CMD_SKIP_ROM  = 0xCC;
+static const uint8_t CMD_CONVERT_T = 0x44;
+
+/** DS18B20 family code (first ROM byte). */
+static const uint8_t FAMILY_DS18B20 = 0x28;
+
+/** Conversion time per resolution, 9..12 bits (ms, datasheet maximum). */
+static const uint16_t CONVERSION_MS[4] = { 94, 188, 375, 750 };
+
+static uint8_t scratchpadCrc(const uint8_t *sp) {
+    return uartOneWireCrc8(sp, SCRATCHPAD_CRC);
+}
+#else
+static uint8_t scratchpadCrc(const uint8_t *sp) {
+    return OneWire::crc8(sp, SCRATCHPAD_CRC);
+}
+#endif
 
 // ──────────────────────────────────────────────────────────────────────────
 // Constructor
 // ──────────────────────────────────────────────────────────────────────────
 
 DigitalTempSensor::DigitalTempSensor(uint8_t dataPin, uint8_t resolution)
-    : _oneWire(dataPin),
+    :
+#if !defined(DIGITAL_TEMP_UART_ONEWIRE)
+      _oneWire(dataPin),
       _sensors(&_oneWire),
+#endif
       _resolution(resolution),
       _lastTempC(NAN),
       _connected(false),
       _valid(false),
-      _deviceCount(0) {}
+      _deviceCount(0),
+      _converting(false),
+      _requestMs(0),
+      _conversionMs(0),
+      _validMask(0),
+      _fastRate(0.0f),
+      _nearBand(0.0f),
+      _policyBits(resolution),
+      _singleDrop(false),
+      _fastReads(0) {
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+    (void)dataPin;
+#endif
+    for (uint8_t i = 0; i < DIGITAL_TEMP_MAX_DEVICES; i++) {
+        _tempC[i] = NAN;
+        _resolutions[i] = resolution;
+        _crcErrors[i] = 0;
+        _alarms[i][0] = DEFAULT_TH;
+        _alarms[i][1] = DEFAULT_TL;
+    }
+}
 
 // ──────────────────────────────────────────────────────────────────────────
 // Initialization
 // ──────────────────────────────────────────────────────────────────────────
 
 bool DigitalTempSensor::init() {
-    _sensors.begin();
-    _deviceCount = _sensors.getDeviceCount();
+    // Search the bus once and keep the ROM codes for addressed reads.
+    uint8_t found = busSearch();
+    for (uint8_t i = 0; i < _deviceCount; i++) {
+        _tempC[i] = NAN;
+        _resolutions[i] = _resolution;
+        _crcErrors[i] = 0;
+    }
 
     if (_deviceCount == 0) {
         _connected = false;
         return false;
     }
 
+    // Skip ROM addresses every device: only safe with the bus to itself.
+    _singleDrop = (found == 1) && (DIGITAL_TEMP_FULL_READ_EVERY != 0);
+    _fastReads = 0;
+
     _connected = true;
 
-    // Set the measurement resolution for all devices on the bus.
+    // Set the measurement resolution of each cached device.
     // Resolution affects both accuracy and conversion time:
     //   9-bit:  0.5°C   precision, ~94 ms conversion
     //   10-bit: 0.25°C  precision, ~188 ms conversion
     //   11-bit: 0.125°C precision, ~375 ms conversion
     //   12-bit: 0.0625°C precision, ~750 ms conversion
-    _sensors.setResolution(_resolution);
-
-    // Use non-blocking mode so we can check conversion status.
-    _sensors.setWaitForConversion(false);
+    for (uint8_t i = 0; i < _deviceCount; i++) {
+        busSetResolution(i, _resolutions[i]);
+    }
+    updateConversionTime();
+    _converting = false;
 
     return true;
 }
@@ -63,13 +151,45 @@ bool DigitalTempSensor::init() {
 
 void DigitalTempSensor::requestConversion() {
     if (_connected) {
-        _sensors.requestTemperatures();
+        // Skip ROM + Convert T: every device on the bus converts at once.
+        busConvertAll();
+        _requestMs = millis();
+        _converting = true;
     }
 }
 
 bool DigitalTempSensor::isConversionComplete() {
     if (!_connected) return false;
-    return _sensors.isConversionComplete();
+    if (!_converting) return true;
+    return (uint32_t)(millis() - _requestMs) >= _conversionMs;
+}
+
+bool DigitalTempSensor::poll() {
+    if (!_connected) {
+        return false;
+    }
+    if (!_converting) {
+        requestConversion();
+        return false;
+    }
+    if (!readConversion()) {
+        return false;
+    }
+    requestConversion();
+    return true;
+}
+
+bool DigitalTempSensor::readConversion() {
+    if (!_connected || !_converting || !isConversionComplete()) {
+        return false;
+    }
+
+    readAllDevices();
+    // Between conversions: the only safe point to change the window.
+    if (_fastRate > 0.0f) {
+        applyPolicyResolution();
+    }
+    return true;
 }
 
 // ──────────────────────────────────────────────────────────────────────────
@@ -83,61 +203,266 @@ float DigitalTempSensor::readTemperatureC() {
         return NAN;
     }
 
-    // Request conversion and wait for completion.
-    _sensors.setWaitForConversion(true);
-    _sensors.requestTemperatures();
-    _sensors.setWaitForConversion(false);
+    // Request conversion and wait out the current window.
+    requestConversion();
+    delay(_conversionMs);
+
+    readAllDevices();
+    return _lastTempC;
+}
 
-    float tempC = _sensors.getTempCByIndex(0);
+// ──────────────────────────────────────────────────────────────────────────
+// Non-blocking result read
+// ──────────────────────────────────────────────────────────────────────────
 
-    // Validate the reading — DS18B20 returns specific values on error.
-    if (tempC == DEVICE_DISCONNECTED_C || tempC <= DISCONNECTED_TEMP) {
+float DigitalTempSensor::readLastConversionC() {
+    if (!_connected) {
         _valid = false;
         _lastTempC = NAN;
         return NAN;
     }
 
-    // Ignore power-on reset value (85.0°C) — indicates no valid conversion.
-    if (tempC == POWER_ON_RESET_TEMP) {
-        _valid = false;
-        return _lastTempC;  // Return last known-good value.
+    readAllDevices();
+    return _lastTempC;
+}
+
+bool DigitalTempSensor::readDevice(uint8_t index) {
+    uint8_t sp[SCRATCHPAD_LEN];
+    bool good = false;
+
+    for (uint8_t attempt = 0; attempt <= DIGITAL_TEMP_READ_RETRIES; attempt++) {
+        // false = no presence pulse: the device is gone, retrying won't help.
+        if (!busReadScratchPad(index, sp)) {
+            break;
+        }
+        // An all-zero scratchpad has a valid CRC but means a shorted bus.
+        uint8_t any = 0;
+        for (uint8_t i = 0; i < sizeof(sp); i++) {
+            any |= sp[i];
+        }
+        if (any != 0 && scratchpadCrc(sp) == sp[SCRATCHPAD_CRC]) {
+            good = true;
+            break;
+        }
+        if (_crcErrors[index] < 0xFFFF) {
+            _crcErrors[index]++;
+        }
     }
 
-    _valid = true;
-    _lastTempC = tempC;
-    return _lastTempC;
+    if (!good) {
+        _tempC[index] = NAN;
+        return false;
+    }
+
+    _alarms[index][0] = sp[SCRATCHPAD_TH];
+    _alarms[index][1] = sp[SCRATCHPAD_TL];
+
+    return storeRaw(index, (int16_t)(((uint16_t)sp[1] << 8) | sp[0]));
+}
+
+bool DigitalTempSensor::readTemperatureFast(int16_t *raw) {
+    uint8_t lsb;
+    uint8_t msb;
+    if (!busReadTemperature(&lsb, &msb)) {
+        return false;
+    }
+
+    // No CRC covers two bytes. A lost device reads 0xFFFF (-0.0625 °C,
+    // in range), so the periodic full read is what catches that.
+    int16_t value = (int16_t)(((uint16_t)msb << 8) | lsb);
+    if (value < RAW_MIN || value > RAW_MAX) {
+        return false;
+    }
+    *raw = value;
+    return true;
+}
+
+bool DigitalTempSensor::storeRaw(uint8_t index, int16_t raw) {
+    // 1/16 °C steps; the low bits are undefined below 12-bit resolution.
+    if (raw == POWER_ON_RESET_RAW) {
+        return false;  // Keep last known-good value.
+    }
+    raw &= (int16_t)~((1 << (12 - _resolutions[index])) - 1);
+
+    _tempC[index] = (float)raw * 0.0625f;
+    return true;
+}
+
+void DigitalTempSensor::readAllDevices() {
+    _converting = false;
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < _deviceCount; i++) {
+        bool ok;
+        int16_t raw;
+        if (_singleDrop && _fastReads < DIGITAL_TEMP_FULL_READ_EVERY - 1 &&
+            readTemperatureFast(&raw)) {
+            _fastReads++;
+            ok = storeRaw(i, raw);
+        } else {
+            _fastReads = 0;
+            ok = readDevice(i);
+        }
+        if (ok) {
+            mask |= (uint8_t)(1U << i);
+        }
+        if (i == 0) {
+            _valid = ok;
+            _lastTempC = _tempC[0];
+        }
+    }
+    _validMask = mask;
+}
+
+void DigitalTempSensor::updateConversionTime() {
+    uint8_t bits = 9;
+    for (uint8_t i = 0; i < _deviceCount; i++) {
+        if (_resolutions[i] > bits) {
+            bits = _resolutions[i];
+        }
+    }
+    _conversionMs = busConversionMs(bits);
 }
 
 // ──────────────────────────────────────────────────────────────────────────
-// Non-blocking result read
+// Bus access
 // ──────────────────────────────────────────────────────────────────────────
 
-float DigitalTempSensor::readLastConversionC() {
-    if (!_connected) {
-        _valid = false;
-        _lastTempC = NAN;
-        return NAN;
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+
+uint8_t DigitalTempSensor::busSearch() {
+    _deviceCount = 0;
+    if (!uartOneWireBegin()) {
+        return 0;
+    }
+    UartOneWireSearch search;
+    uartOneWireSearchReset(&search);
+    uint8_t found = 0;
+    uint8_t rom[8];
+    while (found < 0xFF && uartOneWireSearchNext(&search, rom)) {
+        found++;  // Any family counts: Skip ROM needs the bus to itself
+        if (rom[0] == FAMILY_DS18B20 && _deviceCount < DIGITAL_TEMP_MAX_DEVICES) {
+            memcpy(_addresses[_deviceCount], rom, sizeof(rom));
+            _deviceCount++;
+        }
     }
+    return found;
+}
 
-    float tempC = _sensors.getTempCByIndex(0);
+bool DigitalTempSensor::busSetResolution(uint8_t index, uint8_t bits) {
+    // Keep the alarm bytes the device holds, as DallasTemperature does.
+    uint8_t sp[SCRATCHPAD_LEN];
+    if (!busReadScratchPad(index, sp) || scratchpadCrc(sp) != sp[SCRATCHPAD_CRC]) {
+        return false;
+    }
+    _alarms[index][0] = sp[SCRATCHPAD_TH];
+    _alarms[index][1] = sp[SCRATCHPAD_TL];
+    return busWriteScratchPad(index, (uint8_t)(((bits - 9) << 5) | 0x1F));
+}
 
-    // Validate: disconnected or power-on-reset sentinel values.
-    if (tempC == DEVICE_DISCONNECTED_C || tempC <= DISCONNECTED_TEMP) {
-        _valid = false;
-        _lastTempC = NAN;
-        return NAN;
+void DigitalTempSensor::busConvertAll() {
+    uint8_t buf[] = { CMD_SKIP_ROM, CMD_CONVERT_T };
+    uartOneWireTransfer(buf, sizeof(buf), true);
+}
+
+bool DigitalTempSensor::busReadScratchPad(uint8_t index, uint8_t *scratchpad) {
+    uint8_t buf[1 + 8 + 1 + SCRATCHPAD_LEN];
+    buf[0] = CMD_MATCH_ROM;
+    memcpy(&buf[1], _addresses[index], 8);
+    buf[9] = CMD_READ_SCRATCHPAD;
+    memset(&buf[10], 0xFF, SCRATCHPAD_LEN);
+    if (!uartOneWireTransfer(buf, sizeof(buf), true)) {
+        return false;
     }
+    memcpy(scratchpad, &buf[10], SCRATCHPAD_LEN);
+    return true;
+}
 
-    if (tempC == POWER_ON_RESET_TEMP) {
-        _valid = false;
-        return _lastTempC;  // Keep last known-good value.
+bool DigitalTempSensor::busReadTemperature(uint8_t *lsb, uint8_t *msb) {
+    uint8_t buf[] = { CMD_SKIP_ROM, CMD_READ_SCRATCHPAD, 0xFF, 0xFF };
+    if (!uartOneWireTransfer(buf, sizeof(buf), true)) {
+        return false;
     }
+    uartOneWireReset();  // End the read: the rest of the scratchpad is skipped
+    *lsb = buf[2];
+    *msb = buf[3];
+    return true;
+}
 
-    _valid = true;
-    _lastTempC = tempC;
-    return _lastTempC;
+bool DigitalTempSensor::busWriteScratchPad(uint8_t index, uint8_t config) {
+    uint8_t buf[1 + 8 + 4];
+    buf[0] = CMD_MATCH_ROM;
+    memcpy(&buf[1], _addresses[index], 8);
+    buf[9] = CMD_WRITE_SCRATCHPAD;
+    buf[10] = _alarms[index][0];
+    buf[11] = _alarms[index][1];
+    buf[12] = config;
+    return uartOneWireTransfer(buf, sizeof(buf), true);
+}
+
+uint16_t DigitalTempSensor::busConversionMs(uint8_t bits) {
+    if (bits < 9) bits = 9;
+    if (bits > 12) bits = 12;
+    return CONVERSION_MS[bits - 9];
+}
+
+#else
+
+uint8_t DigitalTempSensor::busSearch() {
+    _sensors.begin();
+    uint8_t found = _sensors.getDeviceCount();
+    _deviceCount = 0;
+    for (uint8_t i = 0; i < found && _deviceCount < DIGITAL_TEMP_MAX_DEVICES; i++) {
+        if (_sensors.getAddress(_addresses[_deviceCount], i)) {
+            _deviceCount++;
+        }
+    }
+    // Use non-blocking mode; completion is tracked by deadline.
+    _sensors.setWaitForConversion(false);
+    return found;
+}
+
+bool DigitalTempSensor::busSetResolution(uint8_t index, uint8_t bits) {
+    return _sensors.setResolution(_addresses[index], bits);
+}
+
+void DigitalTempSensor::busConvertAll() {
+    _sensors.requestTemperatures();
+}
+
+bool DigitalTempSensor::busReadScratchPad(uint8_t index, uint8_t *scratchpad) {
+    return _sensors.readScratchPad(_addresses[index], scratchpad);
+}
+
+bool DigitalTempSensor::busReadTemperature(uint8_t *lsb, uint8_t *msb) {
+    if (!_oneWire.reset()) {
+        return false;
+    }
+    _oneWire.skip();
+    _oneWire.write(CMD_READ_SCRATCHPAD);
+    *lsb = _oneWire.read();
+    *msb = _oneWire.read();
+    _oneWire.reset();  // End the read: the rest of the scratchpad is skipped
+    return true;
+}
+
+bool DigitalTempSensor::busWriteScratchPad(uint8_t index, uint8_t config) {
+    if (!_oneWire.reset()) {
+        return false;
+    }
+    _oneWire.select(_addresses[index]);
+    _oneWire.write(CMD_WRITE_SCRATCHPAD);
+    _oneWire.write(_alarms[index][0]);
+    _oneWire.write(_alarms[index][1]);
+    _oneWire.write(config);
+    return true;
 }
 
+uint16_t DigitalTempSensor::busConversionMs(uint8_t bits) {
+    return _sensors.millisToWaitForConversion(bits);
+}
+
+#endif // DIGITAL_TEMP_UART_ONEWIRE
+
 // ──────────────────────────────────────────────────────────────────────────
 // Accessors
 // ──────────────────────────────────────────────────────────────────────────
@@ -146,6 +471,98 @@ float DigitalTempSensor::getLastTemperatureC() const {
     return _lastTempC;
 }
 
+float DigitalTempSensor::getTemperatureC(uint8_t index) const {
+    if (index >= _deviceCount) return NAN;
+    return _tempC[index];
+}
+
+const float *DigitalTempSensor::getTemperatures() const {
+    return _tempC;
+}
+
+uint8_t DigitalTempSensor::getValidMask() const {
+    return _validMask;
+}
+
+bool DigitalTempSensor::setDeviceResolution(uint8_t index, uint8_t bits) {
+    if (index >= _deviceCount || bits < 9 || bits > 12) {
+        return false;
+    }
+    if (!busSetResolution(index, bits)) {
+        return false;
+    }
+    _resolutions[index] = bits;
+    updateConversionTime();
+    return true;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Adaptive resolution policy
+// ──────────────────────────────────────────────────────────────────────────
+
+void DigitalTempSensor::setAdaptiveResolution(float fastRateCPerS, float nearBandC) {
+    _fastRate = fastRateCPerS;
+    _nearBand = nearBandC;
+    _policyBits = _resolution;
+}
+
+void DigitalTempSensor::updateResolutionPolicy(float rateCPerS,
+                                               float thresholdDistanceC,
+                                               bool alertPending) {
+    if (_fastRate <= 0.0f) {
+        return;
+    }
+    float rate = fabsf(rateCPerS);
+    if (isnan(rate)) {
+        rate = 0.0f;
+    }
+
+    // Hysteresis on the fast mode so rate noise near the limit does not
+    // toggle the window every conversion.
+    float fastLimit = (_policyBits == 9) ? _fastRate * 0.5f : _fastRate;
+
+    if (alertPending || rate >= fastLimit) {
+        _policyBits = 9;
+    } else if (fabsf(thresholdDistanceC) <= _nearBand && rate < _fastRate * 0.5f) {
+        _policyBits = 12;
+    } else {
+        _policyBits = _resolution;
+    }
+}
+
+void DigitalTempSensor::applyPolicyResolution() {
+    uint8_t config = (uint8_t)(((_policyBits - 9) << 5) | 0x1F);
+    for (uint8_t i = 0; i < _deviceCount; i++) {
+        if (_resolutions[i] == _policyBits) {
+            continue;
+        }
+        if (!busWriteScratchPad(i, config)) {
+            continue;  // No presence pulse: keep the old window for it
+        }
+        _resolutions[i] = _policyBits;
+    }
+    updateConversionTime();
+}
+
+uint16_t DigitalTempSensor::getConversionTimeMs() const {
+    return _conversionMs;
+}
+
+uint8_t DigitalTempSensor::getDeviceResolution(uint8_t index) const {
+    if (index >= _deviceCount) return 0;
+    return _resolutions[index];
+}
+
+uint16_t DigitalTempSensor::getCrcErrorCount(uint8_t index) const {
+    if (index >= _deviceCount) return 0;
+    return _crcErrors[index];
+}
+
+const uint8_t *DigitalTempSensor::getAddress(uint8_t index) const {
+    if (index >= _deviceCount) return NULL;
+    return _addresses[index];
+}
+
 float DigitalTempSensor::readTemperatureF() {
     float tempC = readTemperatureC();
     if (isnan(tempC)) return NAN;
@@ -163,3 +580,7 @@ bool DigitalTempSensor::isValid() const {
 uint8_t DigitalTempSensor::getDeviceCount() const {
     return _deviceCount;
 }
+
+bool DigitalTempSensor::isFastPath() const {
+    return _singleDrop;
+}
@@ -16,32 +16,127 @@
  *              │
  *   GND ───────┴── DS18B20 GND
  *
- * Usage:
+ * Bus usage:
+ *   init() searches the bus once and caches every device's 64-bit ROM
+ *   address; afterwards each read is a Match ROM + Read Scratchpad on the
+ *   cached address instead of a full search per call. Conversions are
+ *   started with one broadcast Convert T (Skip ROM) for all devices, and
+ *   completion is judged by a deadline (the datasheet conversion time for
+ *   the highest resolution in use), so no bus traffic is spent polling.
+ *
+ * Single-drop fast path:
+ *   When the search finds exactly one device, reads skip the ROM match and
+ *   stop after the two temperature bytes: Skip ROM + Read Scratchpad + 2
+ *   bytes + reset, about a third of the bus time (and of the time OneWire
+ *   spends with interrupts masked bit by bit) of the 9-byte addressed read.
+ *   The short read carries no CRC, so it is range-checked, and every
+ *   DIGITAL_TEMP_FULL_READ_EVERY-th read (and any implausible short read)
+ *   is the full CRC-checked scratchpad read instead.
+ *
+ * Multiple devices (zones) on one pin:
+ *   Each cached device has its own result slot, resolution and CRC error
+ *   counter. The 9-byte scratchpad is CRC-8 checked and re-read up to
+ *   DIGITAL_TEMP_READ_RETRIES times. getTemperatures() returns the slots
+ *   as a float array (NAN = invalid) that ConditionerBank::processAll()
+ *   takes directly, with getValidMask() as its inputValid mask.
+ *
+ * Bus backend (compile time):
+ *   default                     OneWire / DallasTemperature on dataPin;
+ *                               OneWire masks interrupts for each bit slot
+ *   -DDIGITAL_TEMP_UART_ONEWIRE UartOneWire on USART UART_ONEWIRE_USART
+ *                               (dataPin unused; TX through a diode and RX
+ *                               on DQ, see UartOneWire.h): the USART times
+ *                               the slots with interrupts enabled, and each
+ *                               command sequence is one transaction
+ *
+ * Usage (blocking):
  *   DigitalTempSensor ds(2);  // OneWire data on pin 2
  *   ds.init();
  *   float tempC = ds.readTemperatureC();
+ *
+ * Usage (non-blocking, from a periodic task):
+ *   if (ds.poll()) {          // request → wait for deadline → read
+ *       float t0 = ds.getTemperatureC(0);
+ *   }
+ *
+ * Adaptive resolution (optional):
+ *   The application reports the signal dynamics after each reading with
+ *   updateResolutionPolicy(); the next conversion then runs at
+ *     9 bit  (94 ms)  while |rate| ≥ the fast rate or an alert is
+ *                     debouncing — faster updates when they matter,
+ *     12 bit (750 ms) while the signal is stable within the near band
+ *                     of a threshold — precision when it matters,
+ *     the constructor resolution otherwise.
+ *   The switch is a scratchpad write between conversions (not copied to
+ *   EEPROM, so it costs no endurance), and poll()'s deadline follows it;
+ *   getConversionTimeMs() tells the application the current window.
+ *
+ * Usage (requests timed by the caller, see AcquisitionScheduler):
+ *   ds.requestConversion();   // when the schedule says
+ *   if (ds.readConversion()) { // at the release it is due
+ *       float t0 = ds.getTemperatureC(0);
+ *   }
+ *
+ * Usage (zones sharing the bus):
+ *   ds.setDeviceResolution(1, 12);   // precise zone; the window grows
+ *   if (ds.poll()) {
+ *       bank.processAll(ds.getTemperatures(), out, ds.getValidMask());
+ *   }
  */
 
 #ifndef DIGITAL_TEMP_SENSOR_H
 #define DIGITAL_TEMP_SENSOR_H
 
 #include <Arduino.h>
+#if defined(DIGITAL_TEMP_UART_ONEWIRE)
+#include "UartOneWire.h"
+
+/** @brief 64-bit ROM code, as DallasTemperature's DeviceAddress. */
+typedef uint8_t DeviceAddress[8];
+#else
 #include <OneWire.h>
 #include <DallasTemperature.h>
+#endif
+
+/**
+ * @brief Maximum DS18B20 devices whose ROM addresses are cached.
+ * Override with -DDIGITAL_TEMP_MAX_DEVICES=<n>.
+ */
+#ifndef DIGITAL_TEMP_MAX_DEVICES
+#define DIGITAL_TEMP_MAX_DEVICES 4
+#endif
+
+/**
+ * @brief Scratchpad re-reads after a CRC mismatch (per device per read).
+ * Override with -DDIGITAL_TEMP_READ_RETRIES=<n>.
+ */
+#ifndef DIGITAL_TEMP_READ_RETRIES
+#define DIGITAL_TEMP_READ_RETRIES 2
+#endif
+
+/**
+ * @brief Single-drop fast path: one full CRC-checked read per this many.
+ * 0 disables the fast path (every read is the full addressed read).
+ * Override with -DDIGITAL_TEMP_FULL_READ_EVERY=<n>.
+ */
+#ifndef DIGITAL_TEMP_FULL_READ_EVERY
+#define DIGITAL_TEMP_FULL_READ_EVERY 8
+#endif
 
 /**
  * @class DigitalTempSensor
  * @brief Reads temperature from a DS18B20 sensor via OneWire protocol.
  *
- * Wraps the OneWire and DallasTemperature libraries behind a clean
- * interface consistent with the AnalogTempSensor API.
+ * Wraps the OneWire and DallasTemperature libraries (or UartOneWire)
+ * behind a clean interface consistent with the AnalogTempSensor API.
  */
 class DigitalTempSensor {
 public:
     /**
      * @brief Construct a new DigitalTempSensor object.
      *
-     * @param dataPin Digital pin connected to the DS18B20 DQ line.
+     * @param dataPin Digital pin connected to the DS18B20 DQ line (unused
+     *                with DIGITAL_TEMP_UART_ONEWIRE: the USART's pins).
      * @param resolution Sensor resolution in bits (9–12, default: 10).
      *                   Higher resolution = more accurate but slower conversion.
      *                   9-bit: 93.75 ms, 10-bit: 187.5 ms,
@@ -52,28 +147,52 @@ public:
     /**
      * @brief Initialize the sensor and OneWire bus.
      *
-     * Scans the bus, sets the resolution, and optionally waits for
-     * the first conversion to complete.
+     * Scans the bus, caches the ROM address of up to
+     * DIGITAL_TEMP_MAX_DEVICES devices and sets the resolution.
      *
      * @return true if at least one DS18B20 device was found on the bus.
      */
     bool init();
 
     /**
-     * @brief Request a new temperature conversion from the sensor.
+     * @brief Start a conversion on every device (broadcast Convert T).
      *
-     * This is a non-blocking call that starts the conversion process.
-     * Use isConversionComplete() to check when the reading is ready,
-     * then call readTemperatureC() to retrieve the result.
+     * Non-blocking: records the completion deadline. Use
+     * isConversionComplete() to check when the readings are ready, then
+     * readLastConversionC() to retrieve them.
      */
     void requestConversion();
 
     /**
-     * @brief Check if the temperature conversion is complete.
-     * @return true if the conversion is done and a reading is available.
+     * @brief Check if the pending conversion's deadline has passed.
+     * @return true if the conversion is done (or none is pending).
      */
     bool isConversionComplete();
 
+    /**
+     * @brief Step the non-blocking request → wait → read cycle.
+     *
+     * Call periodically. Starts a conversion when none is pending; once
+     * its deadline has passed, reads every cached device by address and
+     * immediately starts the next conversion.
+     *
+     * @return true if a new set of readings was read by this call.
+     */
+    bool poll();
+
+    /**
+     * @brief Read the pending conversion once its deadline has passed.
+     *
+     * poll() without the restart: the caller starts the next conversion
+     * with requestConversion() when it chooses (AcquisitionScheduler). A
+     * resolution policy switch is applied here, so getConversionTimeMs()
+     * afterwards is the window of the next conversion.
+     *
+     * @return true if a new set of readings was read; false if no
+     *         conversion is pending or its deadline has not passed.
+     */
+    bool readConversion();
+
     /**
      * @brief Read temperature in degrees Celsius (blocking).
      *
@@ -89,9 +208,11 @@ public:
      * @brief Read the result of the last completed non-blocking conversion.
      *
      * Call this after isConversionComplete() returns true. Does NOT trigger
-     * a new conversion. Validates the result and updates _valid / _lastTempC.
+     * a new conversion. Reads every cached device by address; device 0
+     * updates _valid / _lastTempC.
      *
-     * @return float Temperature in °C. Returns NAN if reading is invalid.
+     * @return float Device 0 temperature in °C. Returns NAN if the reading
+     *               is invalid.
      */
     float readLastConversionC();
 
@@ -101,6 +222,93 @@ public:
      */
     float getLastTemperatureC() const;
 
+    /**
+     * @brief Get the last reading of one cached device.
+     * @param index Device index (0..getDeviceCount()-1).
+     * @return float Temperature in °C (NAN if invalid or out of range).
+     */
+    float getTemperatureC(uint8_t index) const;
+
+    /**
+     * @brief Get the result slots of all cached devices.
+     *
+     * Slot i belongs to device i; invalid or disconnected devices read
+     * NAN. The array stays valid for the lifetime of the object.
+     *
+     * @return const float* getDeviceCount() temperatures in °C.
+     */
+    const float *getTemperatures() const;
+
+    /**
+     * @brief Bit i set if device i's last reading was valid.
+     * @return uint8_t Validity mask (ConditionerBank inputValid).
+     */
+    uint8_t getValidMask() const;
+
+    /**
+     * @brief Set the resolution of one device.
+     *
+     * All devices convert in the same window, so the conversion deadline
+     * follows the highest resolution in use. Takes effect with the next
+     * conversion.
+     *
+     * @param index Device index (0..getDeviceCount()-1).
+     * @param bits  Resolution (9–12 bits).
+     * @return true on success; false for an invalid argument or if the
+     *         device did not accept it.
+     */
+    bool setDeviceResolution(uint8_t index, uint8_t bits);
+
+    /**
+     * @brief Get the resolution of one device.
+     * @param index Device index (0..getDeviceCount()-1).
+     * @return uint8_t Resolution in bits (0 if out of range).
+     */
+    uint8_t getDeviceResolution(uint8_t index) const;
+
+    /**
+     * @brief Enable the adaptive resolution policy.
+     *
+     * @param fastRateCPerS Rate (°C/s) at or above which 9-bit is used;
+     *                      the fast mode is left below half of it.
+     *                      0 disables the policy.
+     * @param nearBandC     Distance from a threshold (°C) within which a
+     *                      stable signal is converted at 12 bits.
+     */
+    void setAdaptiveResolution(float fastRateCPerS, float nearBandC);
+
+    /**
+     * @brief Feed the policy with the current signal dynamics.
+     *
+     * Call after each reading (e.g. when poll() returns true). The choice
+     * applies to every device from the next conversion on.
+     *
+     * @param rateCPerS          Smoothed rate of change (°C/s).
+     * @param thresholdDistanceC Distance to the nearest alert threshold (°C).
+     * @param alertPending       true while an alert transition is debouncing.
+     */
+    void updateResolutionPolicy(float rateCPerS, float thresholdDistanceC,
+                                bool alertPending);
+
+    /**
+     * @brief Conversion window of the pending / next conversion (ms).
+     */
+    uint16_t getConversionTimeMs() const;
+
+    /**
+     * @brief Number of scratchpad reads of one device that failed the CRC.
+     * @param index Device index (0..getDeviceCount()-1).
+     * @return uint16_t CRC error count (saturates).
+     */
+    uint16_t getCrcErrorCount(uint8_t index) const;
+
+    /**
+     * @brief Get the cached ROM address of one device.
+     * @param index Device index (0..getDeviceCount()-1).
+     * @return const uint8_t* 8-byte ROM code, or NULL if out of range.
+     */
+    const uint8_t *getAddress(uint8_t index) const;
+
     /**
      * @brief Read temperature in degrees Fahrenheit (blocking).
      * @return float Temperature in °F.
@@ -124,19 +332,100 @@ public:
     bool isValid() const;
 
     /**
-     * @brief Get the number of DS18B20 devices found on the bus.
-     * @return uint8_t Number of devices.
+     * @brief Get the number of DS18B20 devices with a cached address.
+     * @return uint8_t Number of devices (at most DIGITAL_TEMP_MAX_DEVICES).
      */
     uint8_t getDeviceCount() const;
 
+    /**
+     * @brief Check if reads take the single-drop fast path.
+     * @return true if init() found exactly one device on the bus and
+     *         DIGITAL_TEMP_FULL_READ_EVERY is not 0.
+     */
+    bool isFastPath() const;
+
 private:
+    /**
+     * @brief Read one cached device by address into _tempC[index].
+     *
+     * The scratchpad is re-read on a CRC mismatch. A device that never
+     * returns a good scratchpad reads NAN; the +85 °C power-on value keeps
+     * the previous reading.
+     *
+     * @return true if the reading was valid.
+     */
+    bool readDevice(uint8_t index);
+
+    /**
+     * @brief Skip ROM + 2-byte temperature read of the only device.
+     *
+     * @param raw Receives the temperature register (1/16 °C).
+     * @return false if no presence pulse or the value is out of the
+     *         DS18B20 range; the caller then does the full read.
+     */
+    bool readTemperatureFast(int16_t *raw);
+
+    /**
+     * @brief Store a raw reading of one device (power-on value ignored).
+     * @return true if the reading was valid.
+     */
+    bool storeRaw(uint8_t index, int16_t raw);
+
+    /**
+     * @brief Read every cached device; device 0 updates _valid / _lastTempC.
+     */
+    void readAllDevices();
+
+    /**
+     * @brief Recompute _conversionMs from the highest device resolution.
+     */
+    void updateConversionTime();
+
+    /**
+     * @brief Switch every device to _policyBits (write scratchpad only).
+     */
+    void applyPolicyResolution();
+
+    // Bus access, one implementation per backend.
+
+    /** @brief Search the bus into _addresses / _deviceCount; devices found. */
+    uint8_t busSearch();
+    /** @brief Resolution of one device (its alarm bytes kept); false if refused. */
+    bool busSetResolution(uint8_t index, uint8_t bits);
+    /** @brief Skip ROM + Convert T. */
+    void busConvertAll();
+    /** @brief Match ROM + the 9-byte scratchpad; false without presence. */
+    bool busReadScratchPad(uint8_t index, uint8_t *scratchpad);
+    /** @brief Skip ROM + the two temperature bytes, then a reset. */
+    bool busReadTemperature(uint8_t *lsb, uint8_t *msb);
+    /** @brief Match ROM + Write Scratchpad (TH, TL, config); false without presence. */
+    bool busWriteScratchPad(uint8_t index, uint8_t config);
+    /** @brief Conversion time at @p bits (ms). */
+    uint16_t busConversionMs(uint8_t bits);
+
+#if !defined(DIGITAL_TEMP_UART_ONEWIRE)
     OneWire           _oneWire;       /**< OneWire bus instance.           */
     DallasTemperature _sensors;       /**< DallasTemperature library instance. */
+#endif
     uint8_t           _resolution;    /**< Configured resolution (9–12 bits). */
     float             _lastTempC;     /**< Last valid temperature reading.    */
     bool              _connected;     /**< True if sensor found on bus.       */
     bool              _valid;         /**< True if last reading was valid.     */
-    uint8_t           _deviceCount;   /**< Number of devices on the bus.      */
+    uint8_t           _deviceCount;   /**< Devices with a cached address.     */
+    DeviceAddress     _addresses[DIGITAL_TEMP_MAX_DEVICES]; /**< ROM codes.   */
+    float             _tempC[DIGITAL_TEMP_MAX_DEVICES];     /**< Last reads.  */
+    uint8_t           _resolutions[DIGITAL_TEMP_MAX_DEVICES]; /**< Bits.      */
+    uint16_t          _crcErrors[DIGITAL_TEMP_MAX_DEVICES]; /**< CRC fails.   */
+    bool              _converting;    /**< A conversion is pending.           */
+    uint32_t          _requestMs;     /**< millis() at the last Convert T.     */
+    uint16_t          _conversionMs;  /**< Time at the highest resolution.   */
+    uint8_t           _validMask;     /**< Bit per device: last read valid.   */
+    uint8_t           _alarms[DIGITAL_TEMP_MAX_DEVICES][2]; /**< TH, TL.      */
+    float             _fastRate;      /**< Policy: 9-bit rate (0 = off).      */
+    float             _nearBand;      /**< Policy: 12-bit band (°C).          */
+    uint8_t           _policyBits;    /**< Policy choice for the next window.  */
+    bool              _singleDrop;    /**< Exactly one device on the bus.      */
+    uint8_t           _fastReads;     /**< Fast reads since the last full one. */
 };
 
 #endif // DIGITAL_TEMP_SENSOR_H
@@ -0,0 +1,178 @@
+/**
+ * @file DisplayRefresh.h
+ * @brief Event-Driven Display Refresh: Dirty Bits, Rate Cap and Heartbeat
+ *
+ * A display task that redraws every 500 ms wakes, copies the state,
+ * formats two lines and talks to the LCD whether or not anything it
+ * shows has changed, and a key press still waits up to a whole period
+ * before it appears. DisplayRefresh lets the task sleep until a writer
+ * reports a change the user can see instead:
+ *
+ *   writer:  mark(bits)  →  dirty |= bits, wake the display task
+ *   display: wait()      →  the dirty bits (cleared), as soon as
+ *                            - minIntervalMs have passed since the last
+ *                              return (rate cap: a burst of changes is
+ *                              drawn once), and
+ *                            - a bit is set, or the heartbeat is due
+ *
+ * The bits are the caller's (0x01..0x40, e.g. "LCD", "report"); wait()
+ * adds DISPLAY_REFRESH_HEARTBEAT every heartbeatMs, on a fixed cadence,
+ * for what must run on a clock anyway (a plotter line, a sparkline step,
+ * a page flip) and as a slow full redraw. The first wait() after bind()
+ * returns the heartbeat at once, for the first draw.
+ *
+ * Writers decide what is a visible change. A writer that already holds
+ * the state compares the values at the resolution shown (0.1 °C, whole
+ * percent; see displayRefreshQuantize()) and marks only when one moved,
+ * so a 10 Hz control loop whose output sits still costs nothing.
+ *
+ * The wake-up is the display task's notification (TaskSignal), with the
+ * same rules: bind() once in the display task, and no other
+ * notification-based protocol in that task. mark() is for task context
+ * (it may run under a writer's lock, e.g. a SharedState release hook),
+ * and may run before bind(); the change is then drawn by the first wait().
+ *
+ * Header-only, like TaskSignal.
+ *
+ * Usage:
+ *   static DisplayRefresh s_refresh(DISPLAY_REFRESH_MIN_MS, DISPLAY_HEARTBEAT_MS);
+ *   s_refresh.mark(DISPLAY_DIRTY_LCD);             // writer, on a visible change
+ *   s_refresh.bind();                              // display task, once
+ *   for (;;) {
+ *       uint8_t why = s_refresh.wait();
+ *       ...redraw...
+ *       if (why & DISPLAY_REFRESH_HEARTBEAT) { ...periodic line... }
+ *   }
+ */
+
+#ifndef DISPLAY_REFRESH_H
+#define DISPLAY_REFRESH_H
+
+#include <Arduino.h>
+#include <Arduino_FreeRTOS.h>
+#include <math.h>
+
+#include "RtosTime.h"
+#include "TaskSignal.h"
+
+/** @brief Bit wait() adds when the heartbeat is due; the others belong to the caller. */
+#define DISPLAY_REFRESH_HEARTBEAT 0x80
+
+/**
+ * @brief @p value in whole @p step units, for "did the shown value change".
+ *
+ * NaN (shown as "--.-") maps to INT16_MIN, so going invalid is a change.
+ */
+static inline int16_t displayRefreshQuantize(float value, float step) {
+    if (isnan(value)) {
+        return INT16_MIN;
+    }
+    float units = value / step;
+    if (units > 32767.0f) {
+        return INT16_MAX;
+    }
+    if (units < -32767.0f) {
+        return -INT16_MAX;
+    }
+    return (int16_t)lroundf(units);
+}
+
+/**
+ * @class DisplayRefresh
+ * @brief Dirty bits from writers to one display task, rate-capped, with a heartbeat.
+ */
+class DisplayRefresh {
+public:
+    /**
+     * @param minIntervalMs Least time between two returns of wait().
+     * @param heartbeatMs   Heartbeat cadence (0 = none: wait only for marks).
+     */
+    DisplayRefresh(uint16_t minIntervalMs, uint16_t heartbeatMs)
+        : _dirty(0),
+          _minIntervalMs(minIntervalMs),
+          _heartbeatMs(heartbeatMs),
+          _lastMs(0),
+          _beatMs(0),
+          _lateMs(0) {}
+
+    /** @brief Bind the display task (call from it, once, before wait()). */
+    void bind() {
+        uint32_t now = millis();
+        _lastMs = now - _minIntervalMs;
+        _beatMs = now;
+        _signal.bind();
+    }
+
+    /**
+     * @brief Report a visible change (task context).
+     *
+     * Only bits not already pending wake the task: marking the same change
+     * again before it is drawn costs a critical section and nothing else.
+     */
+    void mark(uint8_t bits) {
+        bits &= (uint8_t)~DISPLAY_REFRESH_HEARTBEAT;
+        taskENTER_CRITICAL();
+        uint8_t added = (uint8_t)(bits & ~_dirty);
+        _dirty |= bits;
+        taskEXIT_CRITICAL();
+        if (added != 0) {
+            _signal.give();
+        }
+    }
+
+    /**
+     * @brief Sleep until there is something to draw (bound task only).
+     * @return The bits marked since the last return, plus
+     *         DISPLAY_REFRESH_HEARTBEAT if the heartbeat is due; never 0.
+     */
+    uint8_t wait() {
+        // Rate cap: what is marked meanwhile is drawn together after it.
+        for (;;) {
+            uint32_t since = millis() - _lastMs;
+            if (since >= _minIntervalMs) {
+                break;
+            }
+            vTaskDelay(rtosMsToTicks(_minIntervalMs - since));
+        }
+
+        for (;;) {
+            taskENTER_CRITICAL();
+            uint8_t bits = _dirty;
+            _dirty = 0;
+            taskEXIT_CRITICAL();
+
+            uint32_t now = millis();
+            int32_t untilBeat = (int32_t)(_beatMs - now);
+            if (_heartbeatMs != 0 && untilBeat <= 0) {
+                bits |= DISPLAY_REFRESH_HEARTBEAT;
+                _lateMs = (uint32_t)(-untilBeat);
+                _beatMs += _heartbeatMs;
+                if ((int32_t)(_beatMs - now) <= 0) {
+                    _beatMs = now + _heartbeatMs;   // Fell behind: no burst of beats
+                }
+                untilBeat = (int32_t)(_beatMs - now);
+            }
+            if (bits != 0) {
+                _lastMs = now;
+                return bits;
+            }
+            // A stale give (already drawn) only costs another pass here.
+            _signal.take(_heartbeatMs != 0 ? rtosMsToTicks((uint32_t)untilBeat)
+                                           : portMAX_DELAY);
+        }
+    }
+
+    /** @brief How late the last heartbeat was returned (ms): a display falling behind. */
+    uint32_t getLateMs() const { return _lateMs; }
+
+private:
+    TaskSignal _signal;
+    volatile uint8_t _dirty;
+    uint16_t _minIntervalMs;
+    uint16_t _heartbeatMs;
+    uint32_t _lastMs;           // Last return of wait()
+    uint32_t _beatMs;           // Next heartbeat
+    uint32_t _lateMs;
+};
+
+#endif // DISPLAY_REFRESH_H
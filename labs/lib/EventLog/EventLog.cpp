@@ -0,0 +1,298 @@
+/**
+ * @file EventLog.cpp
+ * @brief Event log implementation.
+ *
+ * Ring protocol: _head and _tail count records modulo 256 (the ring size
+ * divides 256, so index & MASK is the slot). The producer fills slot
+ * _head and then publishes it by incrementing _head; the consumer copies
+ * slot i and then re-reads _head: if the producer has come within a ring
+ * length of i meanwhile, the slot may have been overwritten during the
+ * copy and the record is dropped as lost (so the ring holds one record
+ * less than it has slots). Both indices are single bytes,
+ * read and written atomically on the AVR. More than 256 records between
+ * two service() calls alias the counters and are not detected.
+ */
+
+#include "EventLog.h"
+#include "TelemetryFrame.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#endif
+
+/** Slot mask of the ring. */
+static const uint8_t RING_MASK = EVENT_LOG_RAM_RECORDS - 1;
+
+/** Records the ring holds: the slot at _head may be being rewritten. */
+static const uint8_t RING_CAPACITY = EVENT_LOG_RAM_RECORDS - 1;
+
+/** Keep the compiler from moving ring accesses across index updates. */
+#define EVENT_LOG_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/** @brief EEPROM image of one page. */
+struct __attribute__((packed)) EventLogPage {
+    uint16_t sequence;
+    EventRecord records[EVENT_LOG_PAGE_RECORDS];
+    uint16_t crc;                   ///< CRC-16/CCITT of the fields above
+};
+
+static uint16_t pageCrc(const EventLogPage &p) {
+    return crc16Ccitt(0xFFFF, (const uint8_t *)&p, (uint8_t)offsetof(EventLogPage, crc));
+}
+
+EventLog::EventLog(uint16_t eepromAddress, uint8_t pages)
+    : _address(eepromAddress),
+#if defined(__AVR__)
+      _pages(pages),
+#else
+      _pages(0),
+#endif
+      _nextPage(0),
+      _nextSequence(0),
+      _storedPages(0),
+      _head(0),
+      _tail(0),
+      _spillRequested(false),
+      _lost(0) {
+    (void)pages;
+}
+
+void EventLog::begin() {
+    _head = 0;
+    _tail = 0;
+    _spillRequested = false;
+    _lost = 0;
+
+    // The newest valid page is the one no other valid page follows.
+    _storedPages = 0;
+    bool found = false;
+    uint8_t newest = 0;
+    uint16_t newestSequence = 0;
+    EventRecord records[EVENT_LOG_PAGE_RECORDS];
+    for (uint8_t i = 0; i < _pages; i++) {
+        uint16_t sequence;
+        if (!readPage(i, &sequence, records)) {
+            continue;
+        }
+        _storedPages++;
+        if (!found || (int16_t)(sequence - newestSequence) > 0) {
+            found = true;
+            newest = i;
+            newestSequence = sequence;
+        }
+    }
+    _nextPage = found ? (uint8_t)((newest + 1) % _pages) : 0;
+    _nextSequence = found ? (uint16_t)(newestSequence + 1) : 0;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Producer
+// ──────────────────────────────────────────────────────────────────────────
+
+void EventLog::record(uint32_t timeMs, uint8_t channel, uint8_t code, float value,
+                      bool significant) {
+    uint8_t head = _head;
+    EventRecord &r = _ring[head & RING_MASK];
+    r.timeMs = timeMs;
+    r.channel = channel;
+    r.code = code;
+    if (isnan(value)) {
+        r.value = EVENT_LOG_VALUE_NONE;
+    } else {
+        float scaled = value * (float)EVENT_LOG_VALUE_SCALE;
+        if (scaled > 32767.0f) {
+            r.value = INT16_MAX;
+        } else if (scaled < -32767.0f) {
+            r.value = -INT16_MAX;
+        } else {
+            r.value = (int16_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+        }
+    }
+    EVENT_LOG_BARRIER();
+    _head = (uint8_t)(head + 1);
+    if (significant) {
+        _spillRequested = true;
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Consumer
+// ──────────────────────────────────────────────────────────────────────────
+
+void EventLog::dropLapped() {
+    uint8_t pending = (uint8_t)(_head - _tail);
+    if (pending > RING_CAPACITY) {
+        uint8_t lapped = (uint8_t)(pending - RING_CAPACITY);
+        _lost = (_lost > 0xFFFF - lapped) ? 0xFFFF : (uint16_t)(_lost + lapped);
+        _tail = (uint8_t)(_tail + lapped);
+    }
+}
+
+uint8_t EventLog::takePending(EventRecord *out, uint8_t max) {
+    uint8_t n = 0;
+    while (n < max && _tail != _head) {
+        EVENT_LOG_BARRIER();
+        out[n] = _ring[_tail & RING_MASK];
+        EVENT_LOG_BARRIER();
+        if ((uint8_t)(_head - _tail) >= EVENT_LOG_RAM_RECORDS) {
+            dropLapped();   // Overwritten while copying: skip to the live part
+            continue;
+        }
+        n++;
+        _tail++;
+    }
+    return n;
+}
+
+uint8_t EventLog::service() {
+    if (_pages == 0) {
+        return 0;   // RAM only: records stay in the ring
+    }
+    dropLapped();
+    bool force = _spillRequested;
+    _spillRequested = false;
+
+    uint8_t written = 0;
+    EventRecord buffer[EVENT_LOG_PAGE_RECORDS];
+    for (;;) {
+        uint8_t pending = getPendingCount();
+        if (pending == 0 || (pending < EVENT_LOG_PAGE_RECORDS && !force)) {
+            break;
+        }
+        uint8_t n = takePending(buffer, EVENT_LOG_PAGE_RECORDS);
+        if (n > 0) {
+            writePage(buffer, n);
+        }
+        written++;
+    }
+    return written;
+}
+
+void EventLog::flush() {
+    _spillRequested = true;
+    service();
+}
+
+void EventLog::clear() {
+#if defined(__AVR__)
+    // Marking slot 0 empty invalidates a page: one or two byte writes each.
+    for (uint8_t i = 0; i < _pages; i++) {
+        uint16_t base = (uint16_t)(_address + (uint16_t)i * EVENT_LOG_PAGE_BYTES);
+        uint16_t channelAt = (uint16_t)(base + offsetof(EventLogPage, records) +
+                                        offsetof(EventRecord, channel));
+        eeprom_update_byte((uint8_t *)(uintptr_t)channelAt, EVENT_LOG_CHANNEL_NONE);
+    }
+#endif
+    _nextPage = 0;
+    _nextSequence = 0;
+    _storedPages = 0;
+    _tail = _head;
+    _lost = 0;
+    _spillRequested = false;
+}
+
+uint16_t EventLog::forEach(EventLogVisitor visitor, void *context) {
+    uint16_t visited = 0;
+    EventRecord records[EVENT_LOG_PAGE_RECORDS];
+    for (uint8_t k = 0; k < _pages; k++) {
+        uint8_t index = (uint8_t)((_nextPage + k) % _pages);   // Oldest first
+        uint16_t sequence;
+        if (!readPage(index, &sequence, records)) {
+            continue;
+        }
+        for (uint8_t r = 0; r < EVENT_LOG_PAGE_RECORDS; r++) {
+            if (records[r].channel == EVENT_LOG_CHANNEL_NONE) {
+                break;
+            }
+            visitor(records[r], true, context);
+            visited++;
+        }
+    }
+
+    // Pending records, one slot at a time so none is consumed.
+    dropLapped();
+    uint8_t end = _head;
+    for (uint8_t i = _tail; i != end; i++) {
+        EventRecord r = _ring[i & RING_MASK];
+        EVENT_LOG_BARRIER();
+        if ((uint8_t)(_head - i) >= EVENT_LOG_RAM_RECORDS) {
+            continue;   // Overwritten meanwhile
+        }
+        visitor(r, false, context);
+        visited++;
+    }
+    return visited;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// EEPROM pages
+// ──────────────────────────────────────────────────────────────────────────
+
+void EventLog::writePage(const EventRecord *records, uint8_t count) {
+#if defined(__AVR__)
+    EventLogPage page;
+    page.sequence = _nextSequence;
+    memset(page.records, 0xFF, sizeof(page.records));
+    memcpy(page.records, records, (size_t)count * sizeof(EventRecord));
+    page.crc = pageCrc(page);
+
+    uint16_t previous;
+    EventRecord scratch[EVENT_LOG_PAGE_RECORDS];
+    if (!readPage(_nextPage, &previous, scratch) && _storedPages < _pages) {
+        _storedPages++;
+    }
+    uint16_t base = (uint16_t)(_address + (uint16_t)_nextPage * EVENT_LOG_PAGE_BYTES);
+    eeprom_update_block(&page, (void *)(uintptr_t)base, sizeof(page));
+    _nextSequence++;
+    _nextPage = (uint8_t)((_nextPage + 1) % _pages);
+#else
+    (void)records;
+    (void)count;
+#endif
+}
+
+bool EventLog::readPage(uint8_t index, uint16_t *sequence, EventRecord *records) const {
+#if defined(__AVR__)
+    EventLogPage page;
+    uint16_t base = (uint16_t)(_address + (uint16_t)index * EVENT_LOG_PAGE_BYTES);
+    eeprom_read_block(&page, (const void *)(uintptr_t)base, sizeof(page));
+    if (page.records[0].channel == EVENT_LOG_CHANNEL_NONE || page.crc != pageCrc(page)) {
+        return false;   // Erased, cleared or corrupt
+    }
+    *sequence = page.sequence;
+    memcpy(records, page.records, sizeof(page.records));
+    return true;
+#else
+    (void)index;
+    (void)sequence;
+    (void)records;
+    return false;
+#endif
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Accessors
+// ──────────────────────────────────────────────────────────────────────────
+
+uint8_t EventLog::getPendingCount() const {
+    uint8_t pending = (uint8_t)(_head - _tail);
+    return pending > RING_CAPACITY ? RING_CAPACITY : pending;
+}
+
+uint8_t EventLog::getStoredPages() const {
+    return _storedPages;
+}
+
+uint16_t EventLog::getLostCount() const {
+    return _lost;
+}
+
+float EventLog::valueOf(const EventRecord &record) {
+    if (record.value == EVENT_LOG_VALUE_NONE) {
+        return NAN;
+    }
+    return (float)record.value / (float)EVENT_LOG_VALUE_SCALE;
+}
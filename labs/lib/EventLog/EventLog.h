@@ -0,0 +1,163 @@
+/**
+ * @file EventLog.h
+ * @brief Timestamped Event Log: RAM Ring with EEPROM Spill
+ *
+ * Keeps the recent history of discrete events (alert transitions, faults)
+ * for post-mortem analysis. Each event is an 8-byte EventRecord:
+ *
+ *   timeMs (4) │ channel (1) │ code (1) │ value × 100 (2, saturated)
+ *
+ * record() only copies the record into a RAM ring and advances an 8-bit
+ * head index — a few microseconds, no lock, never blocks — so it can sit
+ * on the alert path. The ring overwrites its oldest entries; service(),
+ * called from a low-priority task, moves the unsaved entries to EEPROM:
+ *
+ *   record() ──► RAM ring (EVENT_LOG_RAM_RECORDS) ──service()──► EEPROM pages
+ *                 single producer                 single consumer
+ *
+ * A page (EVENT_LOG_PAGE_RECORDS records, a sequence number and a CRC-16)
+ * is written whenever a page worth of records is pending, or at once,
+ * partly filled, after a significant event. Pages are written round-robin
+ * over the whole region, each exactly once per lap, which levels the wear
+ * (100 000 cycles per cell: a 64-page region absorbs 6.4 million pages);
+ * on begin() the newest valid page is found by its sequence number. An
+ * EEPROM page write busy-waits about 3.4 ms per byte that changes, which
+ * is why it is left to service().
+ *
+ * forEach() visits the stored pages oldest first and then the records
+ * still in RAM, so every event is reported once; records overwritten in
+ * RAM before a spill are counted in getLostCount().
+ *
+ * Without an EEPROM (host builds) only the RAM ring is kept.
+ *
+ * Usage:
+ *   static EventLog s_log(EVENT_LOG_EEPROM_ADDR, EVENT_LOG_EEPROM_PAGES);
+ *   s_log.begin();                                        // scan EEPROM
+ *   s_log.record(millis(), channel, code, value, true);   // alert task
+ *   s_log.service();                                      // low-priority task
+ *   s_log.forEach(printRecord, NULL);                     // "log dump"
+ */
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+
+/** @brief RAM ring slots (power of two, at most 128; holds one record less). */
+#ifndef EVENT_LOG_RAM_RECORDS
+#define EVENT_LOG_RAM_RECORDS 32
+#endif
+
+/** @brief Records per EEPROM page. */
+#ifndef EVENT_LOG_PAGE_RECORDS
+#define EVENT_LOG_PAGE_RECORDS 4
+#endif
+
+#if (EVENT_LOG_RAM_RECORDS & (EVENT_LOG_RAM_RECORDS - 1)) != 0 || EVENT_LOG_RAM_RECORDS > 128
+#error "EVENT_LOG_RAM_RECORDS must be a power of two, at most 128"
+#endif
+
+#if EVENT_LOG_PAGE_RECORDS > EVENT_LOG_RAM_RECORDS
+#error "EVENT_LOG_PAGE_RECORDS must not exceed EVENT_LOG_RAM_RECORDS"
+#endif
+
+/** @brief Fixed-point scale of EventRecord::value. */
+#define EVENT_LOG_VALUE_SCALE 100
+
+/** @brief EventRecord::value of a NaN reading. */
+#define EVENT_LOG_VALUE_NONE INT16_MIN
+
+/** @brief Channel of an unused page slot (erased EEPROM reads 0xFF). */
+#define EVENT_LOG_CHANNEL_NONE 0xFF
+
+/** @brief One logged event. */
+struct __attribute__((packed)) EventRecord {
+    uint32_t timeMs;    ///< Timestamp (ms since boot, wraps)
+    uint8_t  channel;   ///< Source channel (caller-defined, not 0xFF)
+    uint8_t  code;      ///< Event/transition code (caller-defined)
+    int16_t  value;     ///< Reading × EVENT_LOG_VALUE_SCALE, or EVENT_LOG_VALUE_NONE
+};
+
+/** @brief Byte size of one EEPROM page (records + sequence + CRC). */
+#define EVENT_LOG_PAGE_BYTES (EVENT_LOG_PAGE_RECORDS * sizeof(EventRecord) + 4)
+
+/** @brief Callback of EventLog::forEach(). */
+typedef void (*EventLogVisitor)(const EventRecord &record, bool stored, void *context);
+
+class EventLog {
+public:
+    /**
+     * @param eepromAddress First EEPROM byte of the log region.
+     * @param pages         Pages in the region (0 = RAM only); the region
+     *                      takes pages × EVENT_LOG_PAGE_BYTES bytes.
+     */
+    EventLog(uint16_t eepromAddress, uint8_t pages);
+
+    /** @brief Empty the RAM ring and locate the newest EEPROM page. */
+    void begin();
+
+    /**
+     * @brief Append an event (single producer; not from an ISR).
+     *
+     * @param timeMs      Timestamp.
+     * @param channel     Source channel (0..254).
+     * @param code        Event code.
+     * @param value       Reading (stored × EVENT_LOG_VALUE_SCALE; NaN allowed).
+     * @param significant Spill to EEPROM at the next service() even if
+     *                    less than a page is pending.
+     */
+    void record(uint32_t timeMs, uint8_t channel, uint8_t code, float value,
+                bool significant = false);
+
+    /**
+     * @brief Move pending records to EEPROM (single consumer).
+     * @return Pages written.
+     */
+    uint8_t service();
+
+    /** @brief Write every pending record now (partial page if needed). */
+    void flush();
+
+    /** @brief Erase the stored pages and the RAM ring (slow: one write per page). */
+    void clear();
+
+    /**
+     * @brief Visit stored events oldest first, then pending RAM ones.
+     * Call from the consumer's task.
+     * @return Records visited.
+     */
+    uint16_t forEach(EventLogVisitor visitor, void *context);
+
+    /** @brief Records in RAM not yet written to EEPROM. */
+    uint8_t getPendingCount() const;
+
+    /** @brief Valid pages in EEPROM. */
+    uint8_t getStoredPages() const;
+
+    /** @brief Records overwritten in RAM before they reached EEPROM (saturates). */
+    uint16_t getLostCount() const;
+
+    /** @brief Decode EventRecord::value (NaN for EVENT_LOG_VALUE_NONE). */
+    static float valueOf(const EventRecord &record);
+
+private:
+    /** @brief Consume up to @p max pending records (skipping lapped ones). */
+    uint8_t takePending(EventRecord *out, uint8_t max);
+    void writePage(const EventRecord *records, uint8_t count);
+    bool readPage(uint8_t index, uint16_t *sequence, EventRecord *records) const;
+    void dropLapped();
+
+    uint16_t _address;
+    uint8_t  _pages;
+    uint8_t  _nextPage;         // Page the next spill writes
+    uint16_t _nextSequence;
+    uint8_t  _storedPages;
+
+    EventRecord _ring[EVENT_LOG_RAM_RECORDS];
+    volatile uint8_t _head;     // Records produced (mod 256), written by record()
+    uint8_t  _tail;             // Records consumed (mod 256), written by service()
+    volatile bool _spillRequested;
+    uint16_t _lost;
+};
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,287 @@
+/**
+ * @file FanCurve.cpp
+ * @brief Fan duty/speed curve and calibration sweep implementation.
+ */
+
+#include "FanCurve.h"
+#include "TelemetryFrame.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#endif
+
+/** @brief CRC over everything that precedes the crc field. */
+static uint16_t tableCrc(const FanCurveTable &t) {
+    return crc16Ccitt(0xFFFF, (const uint8_t *)&t, (uint8_t)offsetof(FanCurveTable, crc));
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// FanCurve
+// ──────────────────────────────────────────────────────────────────────────
+
+FanCurve::FanCurve() : _valid(false) {
+    memset(&_table, 0, sizeof(_table));
+}
+
+bool FanCurve::set(const FanCurveTable &table) {
+    FanCurveTable t = table;
+
+    // A speed that drops with more duty is measurement noise: flatten it.
+    uint16_t highest = 0;
+    for (uint8_t i = 0; i < FAN_CURVE_POINTS; i++) {
+        if (t.rpm[i] < highest) {
+            t.rpm[i] = highest;
+        }
+        highest = t.rpm[i];
+    }
+    if (highest == 0) {
+        return false;  // Never turned: no usable curve
+    }
+    if (t.startDuty > 100) {
+        t.startDuty = 100;
+    }
+    if (t.stallDuty > t.startDuty) {
+        t.stallDuty = t.startDuty;
+    }
+
+    t.magic = FAN_CURVE_MAGIC;
+    t.crc = tableCrc(t);
+    _table = t;
+    _valid = true;
+    return true;
+}
+
+bool FanCurve::loadProgmem(const FanCurveTable *table) {
+    FanCurveTable t;
+#if defined(__AVR__)
+    memcpy_P(&t, table, sizeof(t));
+#else
+    memcpy(&t, table, sizeof(t));
+#endif
+    return set(t);
+}
+
+bool FanCurve::loadEeprom(uint16_t address) {
+#if defined(__AVR__)
+    FanCurveTable t;
+    eeprom_read_block(&t, (const void *)(uintptr_t)address, sizeof(t));
+    if (t.magic != FAN_CURVE_MAGIC || t.crc != tableCrc(t)) {
+        return false;  // Erased (0xFF), older layout or corrupt
+    }
+    return set(t);
+#else
+    (void)address;
+    return false;
+#endif
+}
+
+bool FanCurve::saveEeprom(uint16_t address) const {
+    if (!_valid) {
+        return false;
+    }
+#if defined(__AVR__)
+    eeprom_update_block(&_table, (void *)(uintptr_t)address, sizeof(_table));
+    return true;
+#else
+    (void)address;
+    return false;
+#endif
+}
+
+bool FanCurve::isValid() const {
+    return _valid;
+}
+
+const FanCurveTable &FanCurve::table() const {
+    return _table;
+}
+
+float FanCurve::rpmForDuty(float dutyPercent) const {
+    if (dutyPercent <= 0.0f) {
+        return (float)_table.rpm[0];
+    }
+    if (dutyPercent >= 100.0f) {
+        return (float)_table.rpm[FAN_CURVE_POINTS - 1];
+    }
+    float pos = dutyPercent / (float)FAN_CURVE_STEP_PERCENT;
+    uint8_t i = (uint8_t)pos;
+    float frac = pos - (float)i;
+    float lo = (float)_table.rpm[i];
+    float hi = (float)_table.rpm[i + 1];
+    return lo + (hi - lo) * frac;
+}
+
+float FanCurve::dutyForDemand(float demandPercent) const {
+    if (!_valid) {
+        return 0.0f;
+    }
+    if (demandPercent < 0.0f) {
+        demandPercent = 0.0f;
+    } else if (demandPercent > 100.0f) {
+        demandPercent = 100.0f;
+    }
+
+    float lowDuty = (float)_table.startDuty;
+    float lowRpm = rpmForDuty(lowDuty);
+    float highRpm = (float)_table.rpm[FAN_CURVE_POINTS - 1];
+    float target = lowRpm + (highRpm - lowRpm) * demandPercent / 100.0f;
+
+    // Walk the points above startDuty to the segment that reaches target.
+    for (uint8_t i = 0; i < FAN_CURVE_POINTS; i++) {
+        float duty = (float)(i * FAN_CURVE_STEP_PERCENT);
+        if (duty <= lowDuty) {
+            continue;
+        }
+        float rpm = (float)_table.rpm[i];
+        if (rpm >= target) {
+            if (rpm <= lowRpm) {
+                return lowDuty;
+            }
+            return lowDuty + (duty - lowDuty) * (target - lowRpm) / (rpm - lowRpm);
+        }
+        lowDuty = duty;
+        lowRpm = rpm;
+    }
+    return 100.0f;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// FanCurveCalibrator
+// ──────────────────────────────────────────────────────────────────────────
+
+FanCurveCalibrator::FanCurveCalibrator()
+    : _phase(PHASE_IDLE), _ok(false), _duty(0), _point(0), _phaseMs(0) {
+    memset(&_result, 0, sizeof(_result));
+}
+
+void FanCurveCalibrator::begin(uint32_t nowMs) {
+    memset(&_result, 0, sizeof(_result));
+    _phase = PHASE_COAST;
+    _ok = false;
+    _duty = 0;
+    _point = FAN_CURVE_POINTS - 1;
+    _phaseMs = nowMs;
+}
+
+void FanCurveCalibrator::cancel() {
+    if (_phase != PHASE_IDLE) {
+        finish(false);
+    }
+}
+
+float FanCurveCalibrator::finish(bool ok) {
+    _phase = PHASE_DONE;
+    _ok = ok;
+    _duty = 0;
+    if (ok) {
+        _result.magic = FAN_CURVE_MAGIC;
+        _result.crc = tableCrc(_result);
+    }
+    return 0.0f;
+}
+
+float FanCurveCalibrator::update(uint32_t nowMs, float rpm, bool stalled) {
+    uint32_t elapsed = nowMs - _phaseMs;
+    bool turning = !stalled && rpm > 0.0f;
+
+    switch (_phase) {
+        case PHASE_COAST:
+            if (!turning) {
+                _phase = PHASE_START_SEARCH;
+                _duty = FAN_CURVE_START_STEP_PERCENT;
+                _phaseMs = nowMs;
+            } else if (elapsed >= FAN_CURVE_COAST_TIMEOUT_MS) {
+                return finish(false);  // Tach never went quiet
+            }
+            break;
+
+        case PHASE_START_SEARCH:
+            if (turning) {
+                _result.startDuty = _duty;
+                _phase = PHASE_SPINUP;
+                _duty = 100;
+                _phaseMs = nowMs;
+            } else if (elapsed >= FAN_CURVE_START_DWELL_MS) {
+                if (_duty >= 100) {
+                    return finish(false);  // No tach edges even at full duty
+                }
+                _duty = (uint8_t)(_duty + FAN_CURVE_START_STEP_PERCENT);
+                if (_duty > 100) {
+                    _duty = 100;
+                }
+                _phaseMs = nowMs;
+            }
+            break;
+
+        case PHASE_SPINUP:
+            if (elapsed >= FAN_CURVE_SPINUP_MS) {
+                _phase = PHASE_SWEEP;
+                _point = FAN_CURVE_POINTS - 1;
+                _duty = 100;
+                _phaseMs = nowMs;
+            }
+            break;
+
+        case PHASE_SWEEP:
+            if (elapsed < FAN_CURVE_SETTLE_MS) {
+                break;
+            }
+            // Still coasting down after a stall reads as a trickle of edges.
+            if (!turning ||
+                rpm * 100.0f < (float)_result.rpm[FAN_CURVE_POINTS - 1] * FAN_CURVE_STALL_RPM_PERCENT) {
+                if (_point == FAN_CURVE_POINTS - 1) {
+                    return finish(false);  // Stalled at full duty
+                }
+                _result.stallDuty = (uint8_t)((_point + 1) * FAN_CURVE_STEP_PERCENT);
+                return finish(true);       // Lower points stay 0
+            }
+            _result.rpm[_point] = (uint16_t)(rpm + 0.5f);
+            if (_point == 1) {
+                _result.stallDuty = FAN_CURVE_STEP_PERCENT;
+                return finish(true);       // Ran down to the lowest point
+            }
+            _point--;
+            _duty = (uint8_t)(_point * FAN_CURVE_STEP_PERCENT);
+            _phaseMs = nowMs;
+            break;
+
+        case PHASE_IDLE:
+        case PHASE_DONE:
+        default:
+            return 0.0f;
+    }
+    return (float)_duty;
+}
+
+bool FanCurveCalibrator::isRunning() const {
+    return _phase != PHASE_IDLE && _phase != PHASE_DONE;
+}
+
+bool FanCurveCalibrator::succeeded() const {
+    return _phase == PHASE_DONE && _ok;
+}
+
+uint8_t FanCurveCalibrator::progressPercent() const {
+    switch (_phase) {
+        case PHASE_COAST:
+            return 0;
+        case PHASE_START_SEARCH:
+            return (uint8_t)(_duty * 30U / 100U);
+        case PHASE_SPINUP:
+            return 30;
+        case PHASE_SWEEP:
+            return (uint8_t)(30U + (FAN_CURVE_POINTS - 1U - _point) * 70U / (FAN_CURVE_POINTS - 1U));
+        case PHASE_DONE:
+            return 100;
+        case PHASE_IDLE:
+        default:
+            return 0;
+    }
+}
+
+const FanCurveTable &FanCurveCalibrator::result() const {
+    return _result;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file FanCurve.h
+ * @brief Measured fan duty/speed curve and its self-calibration sweep.
+ *
+ * A fan's speed is not proportional to duty: nothing happens below its
+ * start threshold, and the curve flattens near 100 %. FanCurve keeps the
+ * speed measured at 0, 10, …, 100 % duty plus the start and stall
+ * thresholds, and maps a demand (0..100 % of the usable speed range) to
+ * the duty that produces it, by inverse interpolation:
+ *
+ *   demand  0 % → startDuty (lowest duty that starts a stopped fan)
+ *   demand x %  → duty where rpm = rpm(startDuty) + x % · (rpmMax − rpm(startDuty))
+ *
+ * so the loop sees speed, roughly airflow, linear in its output.
+ *
+ * FanCurveCalibrator is a non-blocking sweep fed with the tach reading:
+ *   0. wait (duty 0) until the tach reports the fan stopped;
+ *   1. start search: duty up in FAN_CURVE_START_STEP_PERCENT steps until
+ *      the tach sees the fan turn → startDuty;
+ *   2. spin at 100 % for FAN_CURVE_SPINUP_MS;
+ *   3. 100, 90, … % down, FAN_CURVE_SETTLE_MS each, recording the speed,
+ *      until the fan stalls (no edges, or below FAN_CURVE_STALL_RPM_PERCENT
+ *      of full speed) → stallDuty (last duty that still ran); the
+ *      0 % point is 0 by definition.
+ * About 30–40 s in total. The result is kept monotonic and can be saved
+ * to EEPROM (magic + CRC-16, checked on load).
+ *
+ * Usage:
+ *   FanCurve curve;
+ *   if (!curve.loadEeprom(FAN_CURVE_EEPROM_ADDR)) curve.loadProgmem(&DEFAULT);
+ *   float duty = curve.dutyForDemand(output);      // replaces a linear map
+ *
+ *   FanCurveCalibrator cal;
+ *   cal.begin(millis());
+ *   while (cal.isRunning()) {
+ *       motor.setForward(cal.update(millis(), tach.update(), tach.isStalled()));
+ *       ...
+ *   }
+ *   if (cal.succeeded()) { curve.set(cal.result()); curve.saveEeprom(addr); }
+ */
+
+#ifndef FAN_CURVE_H
+#define FAN_CURVE_H
+
+#include <Arduino.h>
+
+/** Curve points: duty 0, FAN_CURVE_STEP_PERCENT, …, 100 %. */
+#define FAN_CURVE_STEP_PERCENT 10
+#define FAN_CURVE_POINTS (100 / FAN_CURVE_STEP_PERCENT + 1)
+
+/** Table tag; bump when the layout changes so stale EEPROM is ignored. */
+#define FAN_CURVE_MAGIC 0xFC01
+
+/** Calibration timing. */
+#define FAN_CURVE_COAST_TIMEOUT_MS 15000
+#define FAN_CURVE_START_STEP_PERCENT 5
+#define FAN_CURVE_START_DWELL_MS 1500
+#define FAN_CURVE_SPINUP_MS 3000
+#define FAN_CURVE_SETTLE_MS 2500
+
+/** Below this share of the full-duty speed a sweep point counts as stalled. */
+#define FAN_CURVE_STALL_RPM_PERCENT 10
+
+/** @brief Stored curve (PROGMEM default or EEPROM calibration). */
+struct FanCurveTable {
+    uint16_t magic;                  ///< FAN_CURVE_MAGIC
+    uint8_t  startDuty;              ///< Lowest duty that starts a stopped fan (%)
+    uint8_t  stallDuty;              ///< Lowest duty that keeps it running (%)
+    uint16_t rpm[FAN_CURVE_POINTS];  ///< Speed at each duty point
+    uint16_t crc;                    ///< CRC-16/CCITT of the fields above
+};
+
+class FanCurve {
+public:
+    FanCurve();
+
+    /** @brief Use @p table (sanitized: monotonic, thresholds clamped). */
+    bool set(const FanCurveTable &table);
+
+    /** @brief Copy a PROGMEM table. */
+    bool loadProgmem(const FanCurveTable *table);
+
+    /** @brief Read a table from EEPROM. @return false if missing or corrupt. */
+    bool loadEeprom(uint16_t address);
+
+    /** @brief Write the current table to EEPROM (only changed bytes). */
+    bool saveEeprom(uint16_t address) const;
+
+    /** @brief True once a table was accepted. */
+    bool isValid() const;
+
+    /**
+     * @brief Duty that gives @p demandPercent of the usable speed range.
+     * @return Duty (%), between startDuty and 100; 0 without a curve.
+     */
+    float dutyForDemand(float demandPercent) const;
+
+    /** @brief Speed expected at @p dutyPercent (linear between points). */
+    float rpmForDuty(float dutyPercent) const;
+
+    const FanCurveTable &table() const;
+
+private:
+    FanCurveTable _table;
+    bool _valid;
+};
+
+class FanCurveCalibrator {
+public:
+    FanCurveCalibrator();
+
+    /** @brief Start a sweep (the fan should be stopped). */
+    void begin(uint32_t nowMs);
+
+    /** @brief Abort; succeeded() stays false. */
+    void cancel();
+
+    /**
+     * @brief Advance the sweep with the latest tach reading.
+     * @return Duty (%) to apply until the next call.
+     */
+    float update(uint32_t nowMs, float rpm, bool stalled);
+
+    bool isRunning() const;
+    bool succeeded() const;
+
+    /** @brief Sweep progress, 0..100 %. */
+    uint8_t progressPercent() const;
+
+    /** @brief Measured table (valid when succeeded()). */
+    const FanCurveTable &result() const;
+
+private:
+    enum Phase {
+        PHASE_IDLE,
+        PHASE_COAST,
+        PHASE_START_SEARCH,
+        PHASE_SPINUP,
+        PHASE_SWEEP,
+        PHASE_DONE
+    };
+
+    float finish(bool ok);
+
+    Phase _phase;
+    bool _ok;
+    uint8_t _duty;          ///< Duty being applied (%)
+    uint8_t _point;         ///< Sweep point index (descending)
+    uint32_t _phaseMs;      ///< Start of the current dwell
+    FanCurveTable _result;
+};
+
+#endif // FAN_CURVE_H
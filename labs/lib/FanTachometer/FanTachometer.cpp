@@ -0,0 +1,180 @@
+/**
+ * @file FanTachometer.cpp
+ * @brief Fan tachometer driver implementation.
+ *
+ * The ISR stores a 32-bit micros() timestamp and adds one period to the
+ * running sum: a few microseconds per edge, ~100 edges/s for a 3000 RPM
+ * two-pole fan. The period sum cannot overflow between updates (255
+ * periods of at most the stall timeout fit 32 bits many times over);
+ * _periodCount saturates, and a very fast fan polled rarely just averages
+ * fewer of its latest periods.
+ */
+
+#include "FanTachometer.h"
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+FanTachometer *FanTachometer::s_instances[FAN_TACH_MAX_INSTANCES] = {NULL, NULL};
+
+FanTachometer::FanTachometer(uint8_t pin, uint8_t pulsesPerRev)
+    : _pin(pin),
+      _pulsesPerRev(pulsesPerRev == 0 ? 1 : pulsesPerRev),
+      _minPeriodUs(0),
+      _maxPeriodUs((uint32_t)FAN_TACH_DEFAULT_STALL_MS * 1000UL),
+      _hasEdge(false),
+      _lastEdgeUs(0),
+      _periodSumUs(0),
+      _periodCount(0),
+      _pulses(0),
+      _glitches(0),
+      _rpm(0.0f),
+      _stalled(true) {}
+
+bool FanTachometer::init() {
+    int irq = digitalPinToInterrupt(_pin);
+    if (irq == NOT_AN_INTERRUPT) {
+        return false;
+    }
+
+    uint8_t slot = FAN_TACH_MAX_INSTANCES;
+    for (uint8_t i = 0; i < FAN_TACH_MAX_INSTANCES; i++) {
+        if (s_instances[i] == this) {
+            slot = i;
+            break;
+        }
+        if (s_instances[i] == NULL && slot == FAN_TACH_MAX_INSTANCES) {
+            slot = i;
+        }
+    }
+    if (slot == FAN_TACH_MAX_INSTANCES) {
+        return false;
+    }
+
+    _minPeriodUs = 60000000UL / (FAN_TACH_MAX_RPM * _pulsesPerRev);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _hasEdge = false;
+        _periodSumUs = 0;
+        _periodCount = 0;
+        _pulses = 0;
+        _glitches = 0;
+    }
+    _rpm = 0.0f;
+    _stalled = true;
+
+    pinMode(_pin, INPUT_PULLUP);
+    s_instances[slot] = this;
+    attachInterrupt(irq, slot == 0 ? onEdge0 : onEdge1, FALLING);
+    return true;
+}
+
+void FanTachometer::setStallTimeoutMs(uint16_t ms) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _maxPeriodUs = (uint32_t)ms * 1000UL;
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Edge ISR
+// ──────────────────────────────────────────────────────────────────────────
+
+void FanTachometer::onEdge0() {
+    s_instances[0]->onEdge();
+}
+
+void FanTachometer::onEdge1() {
+    s_instances[1]->onEdge();
+}
+
+void FanTachometer::onEdge() {
+    uint32_t now = micros();
+    if (_hasEdge) {
+        uint32_t period = now - _lastEdgeUs;
+        if (period < _minPeriodUs) {
+            if (_glitches < 0xFFFF) {
+                _glitches++;
+            }
+            return;  // Ringing: keep the previous timestamp
+        }
+        // After a stall the first edge only restarts the timing.
+        if (period <= _maxPeriodUs && _periodCount < 0xFF) {
+            _periodSumUs += period;
+            _periodCount++;
+        }
+    }
+    _lastEdgeUs = now;
+    _hasEdge = true;
+    _pulses++;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Speed computation
+// ──────────────────────────────────────────────────────────────────────────
+
+float FanTachometer::update() {
+    bool hasEdge;
+    uint32_t lastEdgeUs;
+    uint32_t sumUs;
+    uint8_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        hasEdge = _hasEdge;
+        lastEdgeUs = _lastEdgeUs;
+        sumUs = _periodSumUs;
+        count = _periodCount;
+        _periodSumUs = 0;
+        _periodCount = 0;
+    }
+
+    uint32_t ageUs = (uint32_t)(micros() - lastEdgeUs);
+    if (!hasEdge || ageUs >= _maxPeriodUs) {
+        _rpm = 0.0f;
+        _stalled = true;
+        return _rpm;
+    }
+    _stalled = false;
+
+    const float perRev = 60.0e6f / (float)_pulsesPerRev;
+    if (count != 0) {
+        _rpm = perRev * (float)count / (float)sumUs;
+    }
+    // No edge for longer than the last period: the fan is slowing down.
+    if (ageUs > 0) {
+        float bound = perRev / (float)ageUs;
+        if (bound < _rpm) {
+            _rpm = bound;
+        }
+    }
+    return _rpm;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Accessors
+// ──────────────────────────────────────────────────────────────────────────
+
+float FanTachometer::getRpm() const {
+    return _rpm;
+}
+
+bool FanTachometer::isStalled() const {
+    return _stalled;
+}
+
+uint32_t FanTachometer::getPulseCount() const {
+    uint32_t pulses;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        pulses = _pulses;
+    }
+    return pulses;
+}
+
+uint16_t FanTachometer::getGlitchCount() const {
+    uint16_t glitches;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        glitches = _glitches;
+    }
+    return glitches;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file FanTachometer.h
+ * @brief Fan tachometer (open-collector speed output) RPM and stall driver.
+ *
+ * A PC-style fan pulls its tach line low FAN_TACH_DEFAULT_PPR times per
+ * revolution. An external interrupt on the line timestamps every falling
+ * edge with micros() and accumulates the periods; update() averages the
+ * periods seen since the previous call, so the reading is as fine as one
+ * period at low speed and is not quantized by the update interval:
+ *
+ *   RPM = 60e6 / (mean period µs × pulses per revolution)
+ *
+ * Edges closer than the period of FAN_TACH_MAX_RPM are rejected as
+ * ringing (tach lines pick up the PWM edges of the motor drive). When no
+ * edge arrives the reading decays as 60e6 / (age × ppr), so a stopping
+ * fan reads falling at once, and after the stall timeout it reads 0 and
+ * isStalled() reports true.
+ *
+ * The tach pin must support an external interrupt (Mega: 2, 3, 18–21);
+ * the internal pull-up is enabled, an external 4.7–10 kΩ to 5 V is more
+ * robust with long leads. Up to FAN_TACH_MAX_INSTANCES tachometers.
+ *
+ * Usage:
+ *   FanTachometer tach(18);          // 2 pulses per revolution
+ *   tach.init();
+ *   ...
+ *   float rpm = tach.update();       // every 100 ms or so
+ *   if (tach.isStalled()) { ... }
+ */
+
+#ifndef FAN_TACHOMETER_H
+#define FAN_TACHOMETER_H
+
+#include <Arduino.h>
+
+/** Pulses per revolution of a standard PC fan. */
+#define FAN_TACH_DEFAULT_PPR 2
+
+/** Speeds above this are treated as noise (sets the glitch filter). */
+#ifndef FAN_TACH_MAX_RPM
+#define FAN_TACH_MAX_RPM 20000UL
+#endif
+
+/** No edge for this long means the fan is stopped. */
+#define FAN_TACH_DEFAULT_STALL_MS 1000
+
+/** Tachometers with an ISR trampoline. */
+#define FAN_TACH_MAX_INSTANCES 2
+
+class FanTachometer {
+public:
+    /**
+     * @brief Construct a tachometer.
+     * @param pin              Tach input (with an external interrupt).
+     * @param pulsesPerRev     Falling edges per revolution.
+     */
+    explicit FanTachometer(uint8_t pin, uint8_t pulsesPerRev = FAN_TACH_DEFAULT_PPR);
+
+    /**
+     * @brief Configure the pin and attach the edge interrupt.
+     * @return false if the pin has no external interrupt or all
+     *         FAN_TACH_MAX_INSTANCES slots are used.
+     */
+    bool init();
+
+    /** @brief No-edge time after which the fan reads stalled (0 RPM). */
+    void setStallTimeoutMs(uint16_t ms);
+
+    /**
+     * @brief Fold in the edges since the last call and recompute the speed.
+     * @return Speed in RPM (0 when stalled).
+     */
+    float update();
+
+    /** @brief Speed computed by the last update(). */
+    float getRpm() const;
+
+    /** @brief True when no edge arrived within the stall timeout. */
+    bool isStalled() const;
+
+    /** @brief Accepted edges since init() (wraps). */
+    uint32_t getPulseCount() const;
+
+    /** @brief Edges rejected by the glitch filter (saturates). */
+    uint16_t getGlitchCount() const;
+
+private:
+    /** @brief Edge ISR body (called by the slot trampolines). */
+    void onEdge();
+
+    static void onEdge0();
+    static void onEdge1();
+
+    static FanTachometer *s_instances[FAN_TACH_MAX_INSTANCES];
+
+    uint8_t  _pin;
+    uint8_t  _pulsesPerRev;
+    uint32_t _minPeriodUs;         ///< Glitch filter threshold
+    uint32_t _maxPeriodUs;         ///< Stall timeout in µs
+
+    // ISR-owned; read and cleared with interrupts off.
+    volatile bool     _hasEdge;    ///< _lastEdgeUs is valid
+    volatile uint32_t _lastEdgeUs;
+    volatile uint32_t _periodSumUs;
+    volatile uint8_t  _periodCount;
+    volatile uint32_t _pulses;
+    volatile uint16_t _glitches;
+
+    float _rpm;
+    bool  _stalled;
+};
+
+#endif // FAN_TACHOMETER_H
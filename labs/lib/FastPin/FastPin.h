@@ -0,0 +1,190 @@
+/**
+ * @file FastPin.h
+ * @brief Compile-Time GPIO Access (single-instruction pin I/O)
+ *
+ * digitalWrite()/digitalRead() translate the pin number through three
+ * PROGMEM tables, check for a PWM timer on the pin and save/restore
+ * SREG on every call: ~50–70 cycles each. FastPin<PIN> resolves the
+ * PINx/DDRx/PORTx registers and the bit mask at compile time, so with
+ * optimization each operation is one instruction:
+ *
+ *   Ports A–G (I/O space):   high()/low() → SBI/CBI, read() → SBIS/SBIC
+ *   Ports H–L (memory space): LDS/ORI/STS, wrapped in ATOMIC_BLOCK so an
+ *                             ISR writing another bit of the port is safe
+ *   toggle()                 writes the mask to PINx (hardware toggle)
+ *
+ * The pin table covers the ATmega2560 (Arduino Mega) only; an unknown
+ * pin number fails to compile (incomplete FastPinMap<PIN>). Other
+ * targets, including host builds, fall back to pinMode/digitalWrite/
+ * digitalRead with the same API.
+ *
+ * Unlike digitalWrite(), FastPin does not disconnect a PWM timer from
+ * the pin: do not mix it with analogWrite() on the same pin.
+ *
+ * Usage:
+ *   typedef FastPin<13> Led13;
+ *   Led13::output();
+ *   Led13::high();
+ *   Led13::toggle();
+ *   bool b = FastPin<2>::read();
+ */
+
+#ifndef FAST_PIN_H
+#define FAST_PIN_H
+
+#include <Arduino.h>
+
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+#define FAST_PIN_MAPPED 1
+#include <util/atomic.h>
+#else
+#define FAST_PIN_MAPPED 0
+#endif
+
+#if FAST_PIN_MAPPED
+
+// ──────────────────────────────────────────────────────────────────────────
+// Arduino Mega pin map (variants/mega/pins_arduino.h)
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Register/bit of a digital pin. Only the pins below exist. */
+template <uint8_t PIN> struct FastPinMap;
+
+// Ports reachable by SBI/CBI/SBIS (I/O address below 0x20).
+#define FAST_PIN_IO_A true
+#define FAST_PIN_IO_B true
+#define FAST_PIN_IO_C true
+#define FAST_PIN_IO_D true
+#define FAST_PIN_IO_E true
+#define FAST_PIN_IO_F true
+#define FAST_PIN_IO_G true
+#define FAST_PIN_IO_H false
+#define FAST_PIN_IO_J false
+#define FAST_PIN_IO_K false
+#define FAST_PIN_IO_L false
+
+#define FAST_PIN_MAP(pin, port, bit)                                   \
+    template <> struct FastPinMap<pin> {                               \
+        static volatile uint8_t &in()  { return PIN##port; }           \
+        static volatile uint8_t &ddr() { return DDR##port; }           \
+        static volatile uint8_t &out() { return PORT##port; }          \
+        static const uint8_t MASK = (uint8_t)(1U << (bit));            \
+        static const bool IO = FAST_PIN_IO_##port;                     \
+    }
+
+FAST_PIN_MAP( 0, E, 0); FAST_PIN_MAP( 1, E, 1); FAST_PIN_MAP( 2, E, 4);
+FAST_PIN_MAP( 3, E, 5); FAST_PIN_MAP( 4, G, 5); FAST_PIN_MAP( 5, E, 3);
+FAST_PIN_MAP( 6, H, 3); FAST_PIN_MAP( 7, H, 4); FAST_PIN_MAP( 8, H, 5);
+FAST_PIN_MAP( 9, H, 6); FAST_PIN_MAP(10, B, 4); FAST_PIN_MAP(11, B, 5);
+FAST_PIN_MAP(12, B, 6); FAST_PIN_MAP(13, B, 7); FAST_PIN_MAP(14, J, 1);
+FAST_PIN_MAP(15, J, 0); FAST_PIN_MAP(16, H, 1); FAST_PIN_MAP(17, H, 0);
+FAST_PIN_MAP(18, D, 3); FAST_PIN_MAP(19, D, 2); FAST_PIN_MAP(20, D, 1);
+FAST_PIN_MAP(21, D, 0); FAST_PIN_MAP(22, A, 0); FAST_PIN_MAP(23, A, 1);
+FAST_PIN_MAP(24, A, 2); FAST_PIN_MAP(25, A, 3); FAST_PIN_MAP(26, A, 4);
+FAST_PIN_MAP(27, A, 5); FAST_PIN_MAP(28, A, 6); FAST_PIN_MAP(29, A, 7);
+FAST_PIN_MAP(30, C, 7); FAST_PIN_MAP(31, C, 6); FAST_PIN_MAP(32, C, 5);
+FAST_PIN_MAP(33, C, 4); FAST_PIN_MAP(34, C, 3); FAST_PIN_MAP(35, C, 2);
+FAST_PIN_MAP(36, C, 1); FAST_PIN_MAP(37, C, 0); FAST_PIN_MAP(38, D, 7);
+FAST_PIN_MAP(39, G, 2); FAST_PIN_MAP(40, G, 1); FAST_PIN_MAP(41, G, 0);
+FAST_PIN_MAP(42, L, 7); FAST_PIN_MAP(43, L, 6); FAST_PIN_MAP(44, L, 5);
+FAST_PIN_MAP(45, L, 4); FAST_PIN_MAP(46, L, 3); FAST_PIN_MAP(47, L, 2);
+FAST_PIN_MAP(48, L, 1); FAST_PIN_MAP(49, L, 0); FAST_PIN_MAP(50, B, 3);
+FAST_PIN_MAP(51, B, 2); FAST_PIN_MAP(52, B, 1); FAST_PIN_MAP(53, B, 0);
+FAST_PIN_MAP(54, F, 0); FAST_PIN_MAP(55, F, 1); FAST_PIN_MAP(56, F, 2);
+FAST_PIN_MAP(57, F, 3); FAST_PIN_MAP(58, F, 4); FAST_PIN_MAP(59, F, 5);
+FAST_PIN_MAP(60, F, 6); FAST_PIN_MAP(61, F, 7); FAST_PIN_MAP(62, K, 0);
+FAST_PIN_MAP(63, K, 1); FAST_PIN_MAP(64, K, 2); FAST_PIN_MAP(65, K, 3);
+FAST_PIN_MAP(66, K, 4); FAST_PIN_MAP(67, K, 5); FAST_PIN_MAP(68, K, 6);
+FAST_PIN_MAP(69, K, 7);
+
+#undef FAST_PIN_MAP
+
+// ──────────────────────────────────────────────────────────────────────────
+// Register access
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @brief Compile-time pin: every member is a static inline function on
+ *        constant registers.
+ * @tparam PIN Arduino digital pin number (A0 = 54 … A15 = 69).
+ */
+template <uint8_t PIN>
+struct FastPin {
+    typedef FastPinMap<PIN> Map;
+
+    /** @brief Configure as push-pull output (level unchanged). */
+    static void output() { setBits(Map::ddr()); }
+
+    /** @brief Configure as input, with or without the internal pull-up. */
+    static void input(bool pullup = false) {
+        clearBits(Map::ddr());
+        if (pullup) {
+            setBits(Map::out());
+        } else {
+            clearBits(Map::out());
+        }
+    }
+
+    /** @brief Drive HIGH (output) / enable the pull-up (input). */
+    static void high() { setBits(Map::out()); }
+
+    /** @brief Drive LOW (output) / disable the pull-up (input). */
+    static void low() { clearBits(Map::out()); }
+
+    /** @brief Drive a logic level. */
+    static void write(bool level) {
+        if (level) {
+            high();
+        } else {
+            low();
+        }
+    }
+
+    /** @brief Invert the output: writing 1 to PINx toggles PORTx (atomic). */
+    static void toggle() { Map::in() = Map::MASK; }
+
+    /** @brief Sample the pin level. */
+    static bool read() { return (Map::in() & Map::MASK) != 0; }
+
+private:
+    static void setBits(volatile uint8_t &reg) {
+        if (Map::IO) {
+            reg |= Map::MASK;              // SBI
+        } else {
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                reg |= Map::MASK;          // LDS/ORI/STS
+            }
+        }
+    }
+
+    static void clearBits(volatile uint8_t &reg) {
+        if (Map::IO) {
+            reg &= (uint8_t)~Map::MASK;    // CBI
+        } else {
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                reg &= (uint8_t)~Map::MASK;
+            }
+        }
+    }
+};
+
+#else  // !FAST_PIN_MAPPED
+
+// ──────────────────────────────────────────────────────────────────────────
+// Portable fallback (same API, Arduino core calls)
+// ──────────────────────────────────────────────────────────────────────────
+
+template <uint8_t PIN>
+struct FastPin {
+    static void output() { pinMode(PIN, OUTPUT); }
+    static void input(bool pullup = false) { pinMode(PIN, pullup ? INPUT_PULLUP : INPUT); }
+    static void high() { digitalWrite(PIN, HIGH); }
+    static void low() { digitalWrite(PIN, LOW); }
+    static void write(bool level) { digitalWrite(PIN, level ? HIGH : LOW); }
+    static void toggle() { digitalWrite(PIN, digitalRead(PIN) == HIGH ? LOW : HIGH); }
+    static bool read() { return digitalRead(PIN) == HIGH; }
+};
+
+#endif // FAST_PIN_MAPPED
+
+#endif // FAST_PIN_H
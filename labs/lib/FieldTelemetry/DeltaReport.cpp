@@ -0,0 +1,112 @@
+/**
+ * @file DeltaReport.cpp
+ * @brief Compact "key=value" Report Implementation
+ *
+ * Implements:
+ * - The change test per field type against the last printed value
+ * - One key=value line of the changed fields (FieldTelemetry formatting)
+ */
+
+#include "DeltaReport.h"
+#include "FixedFormat.h"
+#include "FlashString.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief The stored value as 32 bits: float bits, or the zero-extended integer. */
+static uint32_t loadValue(const DeltaField *field, const uint8_t *p) {
+    switch (field->type) {
+        case FIELD_FLOAT:
+        case FIELD_U32: {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        case FIELD_U16: {
+            uint16_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        case FIELD_BOOL:
+            return *p ? 1U : 0U;
+        default:
+            return *p;
+    }
+}
+
+static float asFloat(uint32_t bits) {
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+/** @brief True if now differs from last by more than the field's epsilon. */
+static bool hasChanged(const DeltaField *field, uint32_t last, uint32_t now) {
+    if (field->type == FIELD_FLOAT) {
+        float a = asFloat(last);
+        float b = asFloat(now);
+        if (isnan(a) || isnan(b)) {
+            return isnan(a) != isnan(b);
+        }
+        return fabsf(b - a) > field->epsilon;
+    }
+    uint32_t diff = now > last ? now - last : last - now;
+    return (float)diff > field->epsilon;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool deltaReportInit(DeltaReport *r, const DeltaField *fields, uint8_t count) {
+    r->fields = fields;
+    r->primed = false;
+    if (count > DELTA_REPORT_MAX_FIELDS) {
+        r->count = 0;
+        return false;
+    }
+    r->count = count;
+    return true;
+}
+
+void deltaReportForce(DeltaReport *r) {
+    r->primed = false;
+}
+
+uint8_t deltaReportPoll(DeltaReport *r, const void *snapshot) {
+    uint8_t printed = 0;
+    DeltaField field;
+    char value[FMT_FIXED_BUF_SIZE];
+
+    for (uint8_t i = 0; i < r->count; i++) {
+        memcpy_P(&field, &r->fields[i], sizeof(DeltaField));
+        const uint8_t *stored = (const uint8_t *)snapshot + field.offset;
+        uint32_t now = loadValue(&field, stored);
+        if (r->primed && !hasChanged(&field, r->last[i], now)) {
+            continue;
+        }
+        r->last[i] = now;
+        FLASH_PRINTF("%s%s=%s", printed > 0 ? " " : "", field.name,
+                     fieldFormatValue(field.type, field.decimals, stored, value, sizeof(value)));
+        printed++;
+    }
+    r->primed = true;
+
+    if (printed > 0) {
+        FLASH_PRINTF("\r\n");
+    }
+    return printed;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file DeltaReport.h
+ * @brief Compact "key=value" Report of the Fields that Changed
+ *
+ * The periodic STDIO reports repeat every value every time, although
+ * most of them (configuration, idle counters, a steady temperature) do
+ * not move between two reports. A DeltaReport describes the report's
+ * fields in a PROGMEM table of {name, type, decimals, offset, epsilon}
+ * over a snapshot struct, like the FieldTelemetry registry, and prints
+ * only the fields that moved by more than their epsilon since they were
+ * last printed, as one line:
+ *
+ *   aewma=25.31 ftemp=25.28 readings=1240 ccycles=1240
+ *
+ * The comparison is against the last printed value, not the previous
+ * snapshot, so a slow drift below epsilon per report is still printed
+ * once it adds up. Epsilon 0 prints every change; a NaN float counts as
+ * changed when it appears or goes away. Static configuration is not a
+ * delta field: the owner prints it once and on request, and calls
+ * deltaReportForce() so the next line restates every field.
+ *
+ * Usage:
+ *   static const DeltaField REPORT[] PROGMEM = {
+ *       DELTA_FIELD("temp", Lab5PidState, measuredTempC, FIELD_FLOAT, 2, 0.05f),
+ *       DELTA_FIELD("cyc",  Lab5PidState, controlCycles, FIELD_U32,   0, 0.0f),
+ *   };
+ *   static DeltaReport s_report;
+ *
+ *   deltaReportInit(&s_report, REPORT, 2);   // the first poll prints all
+ *   ...
+ *   deltaReportPoll(&s_report, &snapshot);   // every report period
+ */
+
+#ifndef DELTA_REPORT_H
+#define DELTA_REPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FieldTelemetry.h"
+
+/** @brief Most fields in one report table. */
+#ifndef DELTA_REPORT_MAX_FIELDS
+#define DELTA_REPORT_MAX_FIELDS 32
+#endif
+
+/**
+ * @struct DeltaField
+ * @brief One report row (PROGMEM). Build with DELTA_FIELD().
+ */
+struct DeltaField {
+    char     name[FIELD_NAME_MAX];  ///< Key printed before '='.
+    uint8_t  type;                  ///< FieldType.
+    uint8_t  decimals;              ///< Fractional digits for FIELD_FLOAT.
+    uint16_t offset;                ///< Byte offset inside the snapshot.
+    float    epsilon;               ///< Change that is printed (> epsilon).
+};
+
+/** @brief Report row for member of Struct, printed as name=value. */
+#define DELTA_FIELD(name, Struct, member, type, decimals, epsilon) \
+    { name, type, decimals, (uint16_t)offsetof(Struct, member), epsilon }
+
+/**
+ * @struct DeltaReport
+ * @brief Table binding and the values as last printed.
+ *
+ * Owned by the reporting task.
+ */
+struct DeltaReport {
+    const DeltaField *fields;                         ///< PROGMEM table.
+    uint8_t           count;                          ///< Table rows.
+    uint32_t          last[DELTA_REPORT_MAX_FIELDS];  ///< Printed values (float bits or integer).
+    bool              primed;                         ///< last[] holds printed values.
+};
+
+/**
+ * @brief Bind a table; the first poll prints every field.
+ *
+ * @return false (and an empty table) if count > DELTA_REPORT_MAX_FIELDS.
+ */
+bool deltaReportInit(DeltaReport *r, const DeltaField *fields, uint8_t count);
+
+/** @brief Print every field on the next poll (after a full report). */
+void deltaReportForce(DeltaReport *r);
+
+/**
+ * @brief Print the fields that changed beyond their epsilon.
+ *
+ * The fields are printed in table order, space separated, on one line
+ * ended by "\r\n". Nothing is printed if none changed.
+ *
+ * @param r        Report state.
+ * @param snapshot Copy of the struct the table offsets refer to.
+ * @return Number of fields printed.
+ */
+uint8_t deltaReportPoll(DeltaReport *r, const void *snapshot);
+
+#endif // DELTA_REPORT_H
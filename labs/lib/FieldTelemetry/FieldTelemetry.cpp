@@ -0,0 +1,267 @@
+/**
+ * @file FieldTelemetry.cpp
+ * @brief Per-field Telemetry Subscriptions Implementation
+ *
+ * Implements:
+ * - Registry lookup by name (PROGMEM descriptors)
+ * - A small fixed subscription table with per-field next-due times
+ * - Serial Plotter formatted output of the fields that are due, on the
+ *   telemetry route of StdioSerial
+ * - The sub / unsub / subs / fields command handlers
+ */
+
+#include "FieldTelemetry.h"
+#include "FixedFormat.h"
+#include "StdioSerial.h"
+#include "FlashString.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+static void readDesc(const FieldTelemetry *t, uint8_t index, FieldDesc *desc) {
+    memcpy_P(desc, &t->fields[index], sizeof(FieldDesc));
+}
+
+static int8_t findSub(const FieldTelemetry *t, uint8_t field) {
+    for (uint8_t i = 0; i < t->active; i++) {
+        if (t->subs[i].field == field) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+/** @brief Format one field of the snapshot into buf. */
+static const char *formatValue(const FieldDesc *desc, const uint8_t *snapshot,
+                               char *buf, size_t len) {
+    return fieldFormatValue(desc->type, desc->decimals, snapshot + desc->offset, buf, len);
+}
+
+/** @brief Copy a command token into a terminated buffer for printing. */
+static const char *tokenText(const CommandArg *arg, char *buf) {
+    uint8_t n = arg->len < FIELD_NAME_MAX - 1 ? arg->len : FIELD_NAME_MAX - 1;
+    memcpy(buf, arg->text, n);
+    buf[n] = '\0';
+    return buf;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+const char *fieldFormatValue(uint8_t type, uint8_t decimals, const void *value,
+                             char *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *)value;
+    switch (type) {
+        case FIELD_FLOAT: {
+            float v;
+            memcpy(&v, p, sizeof(v));
+            return fmtFixed(buf, v, 0, decimals);
+        }
+        case FIELD_BOOL:
+            FLASH_SNPRINTF(buf, len, "%u", *p ? 1U : 0U);
+            return buf;
+        case FIELD_U8:
+            FLASH_SNPRINTF(buf, len, "%u", (unsigned)*p);
+            return buf;
+        case FIELD_U16: {
+            uint16_t v;
+            memcpy(&v, p, sizeof(v));
+            FLASH_SNPRINTF(buf, len, "%u", (unsigned)v);
+            return buf;
+        }
+        case FIELD_U32: {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            FLASH_SNPRINTF(buf, len, "%lu", (unsigned long)v);
+            return buf;
+        }
+        default:
+            buf[0] = '?';
+            buf[1] = '\0';
+            return buf;
+    }
+}
+
+void fieldTelemetryInit(FieldTelemetry *t, const FieldDesc *fields, uint8_t count) {
+    t->fields = fields;
+    t->count  = count;
+    t->active = 0;
+}
+
+int16_t fieldTelemetryFind(const FieldTelemetry *t, const char *name, uint8_t len) {
+    if (len == 0 || len >= FIELD_NAME_MAX) {
+        return -1;
+    }
+    FieldDesc desc;
+    for (uint8_t i = 0; i < t->count; i++) {
+        readDesc(t, i, &desc);
+        uint8_t c = 0;
+        while (c < len && desc.name[c] == (char)tolower((unsigned char)name[c])) {
+            c++;
+        }
+        if (c == len && desc.name[c] == '\0') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool fieldTelemetrySubscribe(FieldTelemetry *t, uint8_t field, uint32_t periodMs) {
+    if (field >= t->count) {
+        return false;
+    }
+    int8_t slot = findSub(t, field);
+    if (slot < 0) {
+        if (t->active >= FIELD_TELEMETRY_MAX_SUBS) {
+            return false;
+        }
+        slot = (int8_t)t->active;
+        t->subs[slot].field = field;
+        t->active++;
+    }
+    t->subs[slot].periodMs = periodMs;
+    t->subs[slot].pending  = true;
+    return true;
+}
+
+bool fieldTelemetryUnsubscribe(FieldTelemetry *t, uint8_t field) {
+    int8_t slot = findSub(t, field);
+    if (slot < 0) {
+        return false;
+    }
+    // Keep subscription order stable for the output line
+    for (uint8_t i = (uint8_t)slot; i + 1 < t->active; i++) {
+        t->subs[i] = t->subs[i + 1];
+    }
+    t->active--;
+    return true;
+}
+
+void fieldTelemetryClear(FieldTelemetry *t) {
+    t->active = 0;
+}
+
+uint8_t fieldTelemetryActive(const FieldTelemetry *t) {
+    return t->active;
+}
+
+uint8_t fieldTelemetryPoll(FieldTelemetry *t, const void *snapshot, uint32_t nowMs) {
+    FILE *out = stdioSerialStream(STDIO_ROUTE_TELEMETRY);
+    uint8_t printed = 0;
+    FieldDesc desc;
+    char value[FMT_FIXED_BUF_SIZE];
+
+    for (uint8_t i = 0; i < t->active; i++) {
+        FieldSubscription *sub = &t->subs[i];
+        if (sub->pending) {
+            sub->pending = false;
+            sub->nextMs  = nowMs + sub->periodMs;
+        } else if ((int32_t)(nowMs - sub->nextMs) >= 0) {
+            // Advance on the period grid; resynchronize after a long stall
+            sub->nextMs += sub->periodMs;
+            if ((int32_t)(nowMs - sub->nextMs) >= 0) {
+                sub->nextMs = nowMs + sub->periodMs;
+            }
+        } else {
+            continue;
+        }
+
+        readDesc(t, sub->field, &desc);
+        FLASH_FPRINTF(out, "%s%s:%s", printed > 0 ? " " : "", desc.name,
+                      formatValue(&desc, (const uint8_t *)snapshot, value, sizeof(value)));
+        printed++;
+    }
+
+    if (printed > 0) {
+        fputs("\r\n", out);
+    }
+    return printed;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Command handlers
+// ──────────────────────────────────────────────────────────────────────────
+
+void fieldTelemetryPrintHelp() {
+    FLASH_PRINTF("Commands: sub <field> <ms> | unsub <field|all> | subs | fields\r\n");
+}
+
+void fieldTelemetryOnSub(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    FieldTelemetry *t = (FieldTelemetry *)context;
+    char name[FIELD_NAME_MAX];
+
+    int16_t field = fieldTelemetryFind(t, args[0].text, args[0].len);
+    if (field < 0) {
+        FLASH_PRINTF("[ERROR] Unknown field: %s (try 'fields')\r\n", tokenText(&args[0], name));
+        return;
+    }
+    if (args[1].i < 0) {
+        FLASH_PRINTF("[ERROR] Period must be >= 0 ms\r\n");
+        return;
+    }
+    if (!fieldTelemetrySubscribe(t, (uint8_t)field, (uint32_t)args[1].i)) {
+        FLASH_PRINTF("[ERROR] Subscription table full (%u)\r\n",
+                     (unsigned)FIELD_TELEMETRY_MAX_SUBS);
+        return;
+    }
+    FLASH_PRINTF("[SUB] %s every %ld ms\r\n", tokenText(&args[0], name), (long)args[1].i);
+}
+
+void fieldTelemetryOnUnsub(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    FieldTelemetry *t = (FieldTelemetry *)context;
+    char name[FIELD_NAME_MAX];
+
+    if (args[0].len == 3 && strncasecmp(args[0].text, "all", 3) == 0) {
+        fieldTelemetryClear(t);
+        FLASH_PRINTF("[SUB] all fields stopped\r\n");
+        return;
+    }
+    int16_t field = fieldTelemetryFind(t, args[0].text, args[0].len);
+    if (field < 0 || !fieldTelemetryUnsubscribe(t, (uint8_t)field)) {
+        FLASH_PRINTF("[ERROR] Not subscribed: %s\r\n", tokenText(&args[0], name));
+        return;
+    }
+    FLASH_PRINTF("[SUB] %s stopped\r\n", tokenText(&args[0], name));
+}
+
+void fieldTelemetryOnList(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    FieldTelemetry *t = (FieldTelemetry *)context;
+    FieldDesc desc;
+
+    FLASH_PRINTF("[SUB] %u active\r\n", (unsigned)t->active);
+    for (uint8_t i = 0; i < t->active; i++) {
+        readDesc(t, t->subs[i].field, &desc);
+        FLASH_PRINTF("  %-9s %lu ms\r\n", desc.name, (unsigned long)t->subs[i].periodMs);
+    }
+}
+
+void fieldTelemetryOnFields(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    FieldTelemetry *t = (FieldTelemetry *)context;
+    FieldDesc desc;
+
+    FLASH_PRINTF("[SUB] fields:");
+    for (uint8_t i = 0; i < t->count; i++) {
+        readDesc(t, i, &desc);
+        FLASH_PRINTF(" %s", desc.name);
+    }
+    FLASH_PRINTF("\r\n");
+}
@@ -0,0 +1,192 @@
+/**
+ * @file FieldTelemetry.h
+ * @brief Per-field Telemetry Subscriptions
+ *
+ * Lets an operator choose, at runtime, which fields of a lab's shared
+ * state are streamed over the serial link and how often. Each lab
+ * describes the fields it can publish in a PROGMEM registry of
+ * {name, type, decimals, offset}; the offsets index a snapshot of its
+ * shared-state struct, so no per-field getter code is needed.
+ *
+ * A telemetry task takes the snapshot once per cycle and calls
+ * fieldTelemetryPoll(), which prints only the subscribed fields whose
+ * period has elapsed, as one Serial Plotter line ("name:value ...").
+ *
+ * Serial commands (add FIELD_TELEMETRY_COMMANDS to a CommandParser table
+ * and pass the FieldTelemetry as the handler context):
+ *   sub <field> <period_ms>   Stream a field (0 = every telemetry cycle)
+ *   unsub <field|all>         Stop one or all fields
+ *   subs                      List active subscriptions
+ *   fields                    List the registry
+ *
+ * Usage:
+ *   static const FieldDesc FIELDS[] PROGMEM = {
+ *       FIELD_DESC("err", Lab5PidState, errorC, FIELD_FLOAT, 2),
+ *       FIELD_DESC("hum", Lab5PidState, measuredHumidityPercent, FIELD_FLOAT, 1),
+ *   };
+ *   static FieldTelemetry s_telemetry;
+ *   static const CommandEntry COMMANDS[] PROGMEM = { FIELD_TELEMETRY_COMMANDS };
+ *
+ *   fieldTelemetryInit(&s_telemetry, FIELDS, 2);
+ *   commandStreamInit(&s_cli, COMMANDS, FIELD_TELEMETRY_COMMAND_COUNT, &s_telemetry);
+ *   ...
+ *   fieldTelemetryPoll(&s_telemetry, &snapshot, millis());
+ */
+
+#ifndef FIELD_TELEMETRY_H
+#define FIELD_TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "CommandParser.h"
+
+/** @brief Longest field name, including the terminator. */
+#define FIELD_NAME_MAX 10
+
+/** @brief Most fields that can be subscribed at the same time. */
+#ifndef FIELD_TELEMETRY_MAX_SUBS
+#define FIELD_TELEMETRY_MAX_SUBS 8
+#endif
+
+/**
+ * @enum FieldType
+ * @brief Storage type of a registered field.
+ */
+enum FieldType {
+    FIELD_FLOAT,  ///< float, printed with the entry's decimals
+    FIELD_BOOL,   ///< bool, printed as 0/1
+    FIELD_U8,     ///< uint8_t (also enums stored in a byte)
+    FIELD_U16,    ///< uint16_t
+    FIELD_U32     ///< uint32_t (counters, tick counts)
+};
+
+/**
+ * @struct FieldDesc
+ * @brief One registry row (PROGMEM). Build with FIELD_DESC().
+ */
+struct FieldDesc {
+    char     name[FIELD_NAME_MAX];  ///< Lowercase name used by the commands.
+    uint8_t  type;                  ///< FieldType.
+    uint8_t  decimals;              ///< Fractional digits for FIELD_FLOAT.
+    uint16_t offset;                ///< Byte offset inside the snapshot.
+};
+
+/** @brief Registry row for member of Struct, published as name. */
+#define FIELD_DESC(name, Struct, member, type, decimals) \
+    { name, type, decimals, (uint16_t)offsetof(Struct, member) }
+
+/**
+ * @struct FieldSubscription
+ * @brief One active subscription.
+ */
+struct FieldSubscription {
+    uint8_t  field;     ///< Registry index.
+    uint32_t periodMs;  ///< Requested decimation period.
+    uint32_t nextMs;    ///< millis() at which the field is next due.
+    bool     pending;   ///< Newly (re)subscribed: send on the next poll.
+};
+
+/**
+ * @struct FieldTelemetry
+ * @brief Registry binding and subscription table.
+ *
+ * Owned by a single task: commands and fieldTelemetryPoll() must run in
+ * the same task. Other tasks may read fieldTelemetryActive().
+ */
+struct FieldTelemetry {
+    const FieldDesc  *fields;                          ///< PROGMEM registry.
+    uint8_t           count;                           ///< Registry entries.
+    FieldSubscription subs[FIELD_TELEMETRY_MAX_SUBS];  ///< Active subscriptions.
+    uint8_t           active;                          ///< Used entries in subs.
+};
+
+/**
+ * @brief Bind a registry and clear all subscriptions.
+ *
+ * @param t      Telemetry state.
+ * @param fields PROGMEM array of field descriptors.
+ * @param count  Number of descriptors.
+ */
+void fieldTelemetryInit(FieldTelemetry *t, const FieldDesc *fields, uint8_t count);
+
+/**
+ * @brief Find a field by name (case-insensitive).
+ *
+ * @param name Name characters (need not be terminated).
+ * @param len  Name length.
+ * @return Registry index, or -1 if unknown.
+ */
+int16_t fieldTelemetryFind(const FieldTelemetry *t, const char *name, uint8_t len);
+
+/**
+ * @brief Subscribe to a field, or change the period of an existing one.
+ *
+ * The field is first sent on the next poll.
+ *
+ * @return false if the subscription table is full or field is invalid.
+ */
+bool fieldTelemetrySubscribe(FieldTelemetry *t, uint8_t field, uint32_t periodMs);
+
+/**
+ * @brief Remove a subscription.
+ *
+ * @return false if the field was not subscribed.
+ */
+bool fieldTelemetryUnsubscribe(FieldTelemetry *t, uint8_t field);
+
+/** @brief Remove all subscriptions. */
+void fieldTelemetryClear(FieldTelemetry *t);
+
+/** @brief Number of active subscriptions (safe to read from any task). */
+uint8_t fieldTelemetryActive(const FieldTelemetry *t);
+
+/**
+ * @brief Print the subscribed fields that are due.
+ *
+ * Fields due in the same call are printed on one line in the order they
+ * were subscribed. Nothing is printed if no field is due.
+ *
+ * @param t        Telemetry state.
+ * @param snapshot Copy of the struct the registry offsets refer to.
+ * @param nowMs    Current millis().
+ * @return Number of fields printed.
+ */
+uint8_t fieldTelemetryPoll(FieldTelemetry *t, const void *snapshot, uint32_t nowMs);
+
+/**
+ * @brief Format one stored value of a registry type as text.
+ *
+ * Shared with DeltaReport, so both print a field the same way.
+ *
+ * @param type     FieldType.
+ * @param decimals Fractional digits for FIELD_FLOAT.
+ * @param value    Start of the stored value (need not be aligned).
+ * @param buf      Destination, at least FMT_FIXED_BUF_SIZE bytes.
+ * @param len      Size of buf.
+ * @return buf.
+ */
+const char *fieldFormatValue(uint8_t type, uint8_t decimals, const void *value,
+                             char *buf, size_t len);
+
+/** @brief Print the subscription command summary (for unknown input). */
+void fieldTelemetryPrintHelp();
+
+/** @name Command handlers (context = FieldTelemetry*) */
+///@{
+void fieldTelemetryOnSub(const CommandArg *args, uint8_t argc, void *context);
+void fieldTelemetryOnUnsub(const CommandArg *args, uint8_t argc, void *context);
+void fieldTelemetryOnList(const CommandArg *args, uint8_t argc, void *context);
+void fieldTelemetryOnFields(const CommandArg *args, uint8_t argc, void *context);
+///@}
+
+/** @brief CommandParser table rows for the subscription commands. */
+#define FIELD_TELEMETRY_COMMANDS                                \
+    COMMAND_ENTRY("sub",    fieldTelemetryOnSub,    "wi"),      \
+    COMMAND_ENTRY("unsub",  fieldTelemetryOnUnsub,  "w"),       \
+    COMMAND_ENTRY("subs",   fieldTelemetryOnList,   ""),        \
+    COMMAND_ENTRY("fields", fieldTelemetryOnFields, "")
+
+/** @brief Number of rows in FIELD_TELEMETRY_COMMANDS. */
+#define FIELD_TELEMETRY_COMMAND_COUNT 4
+
+#endif // FIELD_TELEMETRY_H
@@ -0,0 +1,102 @@
+/**
+ * @file FixedFormat.cpp
+ * @brief Fixed-Decimal Number Formatting Implementation
+ *
+ * Digits are produced least-significant first into a scratch buffer and
+ * copied out in reverse with the requested padding. The 32-bit division
+ * loop only runs while the magnitude exceeds 16 bits; the remaining
+ * digits use the much cheaper 16-bit divide on AVR.
+ */
+
+#include "FixedFormat.h"
+#include <math.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @brief Copy len characters into buf, padded to |width| with spaces.
+ *
+ * @param reversed True if text holds the characters last-to-first.
+ */
+static char *writePadded(char *buf, const char *text, uint8_t len,
+                         int8_t width, bool reversed) {
+    uint8_t field = (uint8_t)(width < 0 ? -width : width);
+    uint8_t pad = field > len ? (uint8_t)(field - len) : 0;
+    char *out = buf;
+
+    if (width > 0) {
+        while (pad > 0) { *out++ = ' '; pad--; }
+    }
+    for (uint8_t i = 0; i < len; i++) {
+        *out++ = reversed ? text[len - 1 - i] : text[i];
+    }
+    while (pad > 0) { *out++ = ' '; pad--; }
+
+    *out = '\0';
+    return buf;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+char *fmtFixedScaled(char *buf, int32_t scaled, int8_t width, uint8_t decimals) {
+    char tmp[FMT_FIXED_BUF_SIZE];
+    uint8_t n = 0;
+    uint8_t digits = 0;
+
+    if (decimals > FMT_FIXED_MAX_DECIMALS) {
+        decimals = FMT_FIXED_MAX_DECIMALS;
+    }
+
+    bool negative = scaled < 0;
+    uint32_t mag = negative ? (uint32_t)0 - (uint32_t)scaled : (uint32_t)scaled;
+
+    while (mag > 0xFFFFUL) {
+        tmp[n++] = (char)('0' + (uint8_t)(mag % 10));
+        mag /= 10;
+        if (++digits == decimals) tmp[n++] = '.';
+    }
+
+    uint16_t mag16 = (uint16_t)mag;
+    do {
+        tmp[n++] = (char)('0' + (uint8_t)(mag16 % 10));
+        mag16 /= 10;
+        if (++digits == decimals) tmp[n++] = '.';
+    } while (mag16 != 0 || digits <= decimals);  // Keep the leading "0."
+
+    if (negative) {
+        tmp[n++] = '-';
+    }
+
+    return writePadded(buf, tmp, n, width, true);
+}
+
+char *fmtFixed(char *buf, float value, int8_t width, uint8_t decimals) {
+    if (isnan(value)) {
+        return writePadded(buf, "nan", 3, width, false);
+    }
+    if (isinf(value)) {
+        return value < 0 ? writePadded(buf, "-inf", 4, width, false)
+                         : writePadded(buf, "inf", 3, width, false);
+    }
+
+    if (decimals > FMT_FIXED_MAX_DECIMALS) {
+        decimals = FMT_FIXED_MAX_DECIMALS;
+    }
+
+    // Powers of ten up to 1e6 are exact in single precision
+    float scale = 1.0f;
+    for (uint8_t i = 0; i < decimals; i++) {
+        scale *= 10.0f;
+    }
+
+    float scaled = value * scale + (value < 0 ? -0.5f : 0.5f);
+    if (scaled >= 2147483520.0f || scaled <= -2147483520.0f) {
+        return writePadded(buf, "ovf", 3, width, false);
+    }
+
+    return fmtFixedScaled(buf, (int32_t)scaled, width, decimals);
+}
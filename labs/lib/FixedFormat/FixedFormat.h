@@ -0,0 +1,64 @@
+/**
+ * @file FixedFormat.h
+ * @brief Fixed-Decimal Number Formatting Without Float printf
+ *
+ * Drop-in replacement for the dtostrf() calls used by the LCD and serial
+ * report code. The value is scaled and rounded once, then converted with
+ * integer arithmetic only (16-bit divisions once the magnitude fits), so
+ * a call costs a fraction of dtostrf() time and stack. All output is
+ * plain text, which lets a lab link the minimal vfprintf if it wants to.
+ *
+ * Width follows dtostrf(): a positive width right-justifies, a negative
+ * width left-justifies, and the field grows if the number needs more room.
+ *
+ * Usage:
+ *   char buf[FMT_FIXED_BUF_SIZE];
+ *   fmtFixed(buf, 23.46f, 5, 1);          // " 23.5"
+ *   fmtFixed(buf, -0.5f, -6, 2);          // "-0.50 "
+ *   fmtFixedScaled(buf, 1234, 1, 2);      // "12.34" (value in hundredths)
+ */
+
+#ifndef FIXED_FORMAT_H
+#define FIXED_FORMAT_H
+
+#include <Arduino.h>
+
+/** @brief Largest number of decimals honoured; larger requests are clamped. */
+#define FMT_FIXED_MAX_DECIMALS 6
+
+/**
+ * @brief Buffer size that holds any result for |width| <= 12.
+ *
+ * Sign + 10 digits + point + terminator. Wider fields need |width| + 1.
+ */
+#define FMT_FIXED_BUF_SIZE 13
+
+/**
+ * @brief Format a float with a fixed number of decimals.
+ *
+ * Rounds half away from zero. NaN and infinity print as "nan", "inf" and
+ * "-inf"; values whose scaled magnitude exceeds 32 bits print as "ovf".
+ *
+ * @param buf      Destination buffer (see FMT_FIXED_BUF_SIZE).
+ * @param value    Value to format.
+ * @param width    Minimum field width; negative to left-justify.
+ * @param decimals Digits after the decimal point (0 = no point).
+ * @return buf, for use directly as a printf() %s argument.
+ */
+char *fmtFixed(char *buf, float value, int8_t width, uint8_t decimals);
+
+/**
+ * @brief Format an integer that already carries the decimal scale.
+ *
+ * For values kept in fixed point, e.g. tenths of a degree: the last
+ * `decimals` digits are printed after the decimal point.
+ *
+ * @param buf      Destination buffer (see FMT_FIXED_BUF_SIZE).
+ * @param scaled   Value multiplied by 10^decimals.
+ * @param width    Minimum field width; negative to left-justify.
+ * @param decimals Number of fractional digits contained in scaled.
+ * @return buf.
+ */
+char *fmtFixedScaled(char *buf, int32_t scaled, int8_t width, uint8_t decimals);
+
+#endif // FIXED_FORMAT_H
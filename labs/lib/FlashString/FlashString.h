@@ -0,0 +1,77 @@
+/**
+ * @file FlashString.h
+ * @brief printf-Style Logging With the Format Strings Kept in Flash
+ *
+ * On the AVR every string literal is a copy in SRAM: the startup code
+ * copies .data from flash at boot, and the banners, help lines, report
+ * headers and log messages of a lab add up to one or two of the 8 KB.
+ * These macros wrap each format in PSTR(), so it stays in flash and the
+ * avr-libc *_P() functions read it from there:
+ *
+ *   FLASH_PRINTF("[ERROR] %s\r\n", name)    printf_P(PSTR(...), name)
+ *   FLASH_SNPRINTF(buf, size, "T:%s", t)    snprintf_P(...)
+ *   FLASH_FPRINTF(stream, "%u", n)          fprintf_P(...)
+ *
+ * Only the format moves: %s arguments are still RAM strings (avr-libc's
+ * %S reads a flash string, but it is not portable). The format must be
+ * a literal (or literals concatenated), and the macros can only be used
+ * inside functions (PSTR() defines a static array).
+ *
+ * Off the AVR (env:native) the macros fall back to the plain functions;
+ * the test shim and this header both map PSTR() and the *_P() names.
+ *
+ * Usage:
+ *   FLASH_PRINTF("Lab 1.1 ready, %u baud\r\n", (unsigned)baud);
+ *   lcd.showTwoLines_P(PSTR("Lab 5.2 PID"), PSTR("DHT11 + Fan"));
+ *   DEFERRED_LOG_PRINTF("[INPUT] PWM set to %d%%\r\n", val);  // DeferredLog.h
+ */
+
+#ifndef FLASH_STRING_H
+#define FLASH_STRING_H
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+#include <string.h>
+#ifndef PSTR
+#define PSTR(s) (s)
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#endif
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+#ifndef strlen_P
+#define strlen_P strlen
+#endif
+#ifndef strncpy_P
+#define strncpy_P strncpy
+#endif
+#ifndef printf_P
+#define printf_P printf
+#endif
+#ifndef snprintf_P
+#define snprintf_P snprintf
+#endif
+#ifndef fprintf_P
+#define fprintf_P fprintf
+#endif
+#ifndef vfprintf_P
+#define vfprintf_P vfprintf
+#endif
+#endif
+
+/** @brief printf() with the format in flash. */
+#define FLASH_PRINTF(fmt, ...) printf_P(PSTR(fmt), ##__VA_ARGS__)
+
+/** @brief snprintf() with the format in flash. */
+#define FLASH_SNPRINTF(buf, size, fmt, ...) snprintf_P((buf), (size), PSTR(fmt), ##__VA_ARGS__)
+
+/** @brief fprintf() with the format in flash. */
+#define FLASH_FPRINTF(stream, fmt, ...) fprintf_P((stream), PSTR(fmt), ##__VA_ARGS__)
+
+#endif // FLASH_STRING_H
@@ -0,0 +1,166 @@
+/**
+ * @file FsmTrace.cpp
+ * @brief FSM Transition Trace Implementation
+ *
+ * The ring is indexed by a free-running 32-bit sequence number: record n
+ * lives in slot n % FSM_TRACE_RECORDS and is valid while n is within the
+ * last FSM_TRACE_RECORDS recorded. Counters use open addressing on a hash
+ * of (fsm, from, to); when the table is full further new transitions are
+ * only counted as untracked.
+ */
+
+#include "FsmTrace.h"
+#include "FlashString.h"
+#include <Arduino.h>
+#include <stdio.h>
+
+#if defined(FSM_TRACE_ENABLED)
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#define FSM_TRACE_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#define FSM_TRACE_ATOMIC
+#endif
+
+static_assert((FSM_TRACE_RECORDS & (FSM_TRACE_RECORDS - 1)) == 0,
+              "FSM_TRACE_RECORDS must be a power of two");
+static_assert((FSM_TRACE_COUNTERS & (FSM_TRACE_COUNTERS - 1)) == 0,
+              "FSM_TRACE_COUNTERS must be a power of two");
+
+/** @brief Transition counter slot (fsm == FSM_TRACE_ID_NONE: free). */
+struct FsmTraceCounter {
+    uint8_t  fsm;
+    uint8_t  from;
+    uint8_t  to;
+    uint16_t count;
+};
+
+static FsmTraceRecord  s_ring[FSM_TRACE_RECORDS];
+static FsmTraceCounter s_counters[FSM_TRACE_COUNTERS];
+static uint32_t        s_total;      ///< Records written (sequence number)
+static uint16_t        s_untracked;  ///< Transitions without a counter slot
+
+static uint8_t counterHash(uint8_t fsm, uint8_t from, uint8_t to) {
+    return (uint8_t)((fsm * 37U + from * 11U + to) & (FSM_TRACE_COUNTERS - 1));
+}
+
+/** @brief Slot of (fsm, from, to), claimed if absent; NULL when full. Call atomically. */
+static FsmTraceCounter *findCounter(uint8_t fsm, uint8_t from, uint8_t to, bool claim) {
+    uint8_t slot = counterHash(fsm, from, to);
+    for (uint8_t probe = 0; probe < FSM_TRACE_COUNTERS; probe++) {
+        FsmTraceCounter *c = &s_counters[slot];
+        if (c->fsm == fsm && c->from == from && c->to == to) {
+            return c;
+        }
+        if (c->fsm == FSM_TRACE_ID_NONE) {
+            if (!claim) {
+                return NULL;
+            }
+            c->fsm = fsm;
+            c->from = from;
+            c->to = to;
+            c->count = 0;
+            return c;
+        }
+        slot = (uint8_t)((slot + 1) & (FSM_TRACE_COUNTERS - 1));
+    }
+    return NULL;
+}
+
+void fsmTraceRecord(uint8_t fsm, uint8_t from, uint8_t to, uint8_t event) {
+    if (fsm == FSM_TRACE_ID_NONE) {
+        return;
+    }
+    uint32_t now = millis();
+    FSM_TRACE_ATOMIC {
+        FsmTraceRecord *r = &s_ring[s_total & (FSM_TRACE_RECORDS - 1)];
+        r->timeMs = now;
+        r->fsm = fsm;
+        r->from = from;
+        r->to = to;
+        r->event = event;
+        s_total++;
+
+        FsmTraceCounter *c = findCounter(fsm, from, to, true);
+        if (c == NULL) {
+            if (s_untracked < 0xFFFF) {
+                s_untracked++;
+            }
+        } else if (c->count < 0xFFFF) {
+            c->count++;
+        }
+    }
+}
+
+uint16_t fsmTraceCount(uint8_t fsm, uint8_t from, uint8_t to) {
+    uint16_t n = 0;
+    FSM_TRACE_ATOMIC {
+        FsmTraceCounter *c = findCounter(fsm, from, to, false);
+        n = (c != NULL) ? c->count : 0;
+    }
+    return n;
+}
+
+uint32_t fsmTraceTotal() {
+    uint32_t n;
+    FSM_TRACE_ATOMIC {
+        n = s_total;
+    }
+    return n;
+}
+
+void fsmTraceClear() {
+    FSM_TRACE_ATOMIC {
+        for (uint8_t i = 0; i < FSM_TRACE_COUNTERS; i++) {
+            s_counters[i].fsm = FSM_TRACE_ID_NONE;
+        }
+        s_total = 0;
+        s_untracked = 0;
+    }
+}
+
+void fsmTraceDump() {
+    uint32_t end = fsmTraceTotal();
+    uint32_t start = (end > FSM_TRACE_RECORDS) ? end - FSM_TRACE_RECORDS : 0;
+    uint16_t skipped = 0;
+
+    FLASH_PRINTF("[TRACE] time_ms fsm from>to event\r\n");
+    for (uint32_t seq = start; seq < end; seq++) {
+        FsmTraceRecord r;
+        bool valid;
+        FSM_TRACE_ATOMIC {
+            r = s_ring[seq & (FSM_TRACE_RECORDS - 1)];
+            valid = (s_total - seq) <= FSM_TRACE_RECORDS;  // Not yet reused
+        }
+        if (!valid) {
+            skipped++;
+            continue;
+        }
+        FLASH_PRINTF("[TRACE] %10lu %3u %u>%u %u\r\n", (unsigned long)r.timeMs,
+                     (unsigned)r.fsm, (unsigned)r.from, (unsigned)r.to, (unsigned)r.event);
+    }
+
+    FLASH_PRINTF("[TRACE] counts: fsm from>to n\r\n");
+    for (uint8_t i = 0; i < FSM_TRACE_COUNTERS; i++) {
+        FsmTraceCounter c;
+        FSM_TRACE_ATOMIC {
+            c = s_counters[i];
+        }
+        if (c.fsm != FSM_TRACE_ID_NONE) {
+            FLASH_PRINTF("[TRACE] %3u %u>%u %u\r\n", (unsigned)c.fsm, (unsigned)c.from,
+                         (unsigned)c.to, (unsigned)c.count);
+        }
+    }
+    FLASH_PRINTF("[TRACE] %lu transitions, %lu shown, %u untracked\r\n",
+                 (unsigned long)end, (unsigned long)(end - start - skipped),
+                 (unsigned)s_untracked);
+}
+
+#else  // !FSM_TRACE_ENABLED
+
+void fsmTraceDump() {
+    FLASH_PRINTF("[TRACE] Disabled (build with -DFSM_TRACE_ENABLED)\r\n");
+}
+
+#endif // FSM_TRACE_ENABLED
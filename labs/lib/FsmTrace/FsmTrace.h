@@ -0,0 +1,98 @@
+/**
+ * @file FsmTrace.h
+ * @brief FSM Transition Trace (ring of recent transitions + counters)
+ *
+ * Field diagnostics for the project's state machines (TableFsm users
+ * such as ButtonLedFsm and LockFSM, ThresholdAlert, ThresholdAlertBank).
+ * Each state change is recorded as an 8-byte record
+ *
+ *   { timeMs, fsm id, from, to, event }
+ *
+ * into a fixed ring of the last FSM_TRACE_RECORDS transitions, and counted
+ * per (fsm id, from, to) in a small hash table, so rare transitions stay
+ * visible after they have scrolled out of the ring.
+ *
+ * Recording is a millis() read, one record store and one hash probe with
+ * interrupts masked (a few µs on the Mega), callable from tasks and ISRs:
+ * cheap enough to leave on. Build with -DFSM_TRACE_ENABLED to enable it;
+ * without the flag FSM_TRACE() expands to nothing, the FSMs carry no
+ * trace id and fsmTraceDump() only reports that tracing is off.
+ *
+ * FSM ids are chosen by the application (1..255; 0 = not traced). The
+ * event byte is FSM-specific: the table column for TableFsm, an
+ * AlertTraceEvent for the threshold alerts.
+ *
+ * Usage:
+ *   fsm.setTraceId(1);              // FSM side, see TableFsm::setTraceId()
+ *   FSM_TRACE(2, from, to, event);  // hand-written FSMs
+ *   fsmTraceDump();                 // serial command handler
+ */
+
+#ifndef FSM_TRACE_H
+#define FSM_TRACE_H
+
+#include <stdint.h>
+
+/** @brief Records kept in the ring (power of two). */
+#ifndef FSM_TRACE_RECORDS
+#define FSM_TRACE_RECORDS 32
+#endif
+
+/** @brief Distinct (fsm, from, to) transitions counted (power of two). */
+#ifndef FSM_TRACE_COUNTERS
+#define FSM_TRACE_COUNTERS 32
+#endif
+
+/** @brief Trace id meaning "do not trace this FSM". */
+#define FSM_TRACE_ID_NONE 0
+
+/** @brief One recorded transition. */
+struct FsmTraceRecord {
+    uint32_t timeMs;  /**< millis() at the transition. */
+    uint8_t  fsm;     /**< FSM id.                     */
+    uint8_t  from;    /**< Previous state.             */
+    uint8_t  to;      /**< New state.                  */
+    uint8_t  event;   /**< FSM-specific cause.         */
+};
+
+#if defined(FSM_TRACE_ENABLED)
+
+/**
+ * @brief Record a transition (ignored for FSM_TRACE_ID_NONE).
+ *
+ * Interrupt-safe; normally called through FSM_TRACE().
+ */
+void fsmTraceRecord(uint8_t fsm, uint8_t from, uint8_t to, uint8_t event);
+
+/** @brief Transitions fsm: from → to since boot or fsmTraceClear() (saturates). */
+uint16_t fsmTraceCount(uint8_t fsm, uint8_t from, uint8_t to);
+
+/** @brief Transitions recorded since boot or fsmTraceClear(). */
+uint32_t fsmTraceTotal();
+
+/** @brief Forget all records and counters. */
+void fsmTraceClear();
+
+/**
+ * @brief Print the ring (oldest first) and the counters with printf().
+ *
+ * Records are copied one at a time: tracing stays live while the dump
+ * runs, and records overwritten meanwhile are skipped.
+ */
+void fsmTraceDump();
+
+#define FSM_TRACE(fsm, from, to, event) \
+    fsmTraceRecord((uint8_t)(fsm), (uint8_t)(from), (uint8_t)(to), (uint8_t)(event))
+
+#else  // !FSM_TRACE_ENABLED
+
+inline uint16_t fsmTraceCount(uint8_t, uint8_t, uint8_t) { return 0; }
+inline uint32_t fsmTraceTotal() { return 0; }
+inline void fsmTraceClear() {}
+void fsmTraceDump();
+
+#define FSM_TRACE(fsm, from, to, event) ((void)0)
+
+#endif // FSM_TRACE_ENABLED
+
+#endif // FSM_TRACE_H
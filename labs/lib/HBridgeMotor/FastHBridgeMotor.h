@@ -0,0 +1,92 @@
+/**
+ * @file FastHBridgeMotor.h
+ * @brief H-bridge DC motor driver with compile-time direction pins.
+ *
+ * Same interface as HBridgeMotor, without its motion profile (ramp, dead
+ * time, brake): direction and duty apply at once. The IN1/IN2 direction pins are
+ * template parameters driven through FastPin, so a direction change is
+ * two register writes instead of two digitalWrite() calls; the enable
+ * pin stays a run-time PwmActuator.
+ *
+ * Usage:
+ *   FastHBridgeMotor<22, 23> motor(9);   // IN1 = D22, IN2 = D23, EN = D9
+ *   motor.init();
+ *   motor.setForward(60.0f);
+ */
+
+#ifndef FAST_HBRIDGE_MOTOR_H
+#define FAST_HBRIDGE_MOTOR_H
+
+#include <Arduino.h>
+#include "FastPin.h"
+#include "HBridgeMotor.h"
+#include "PwmActuator.h"
+
+template <uint8_t INPUT1_PIN, uint8_t INPUT2_PIN>
+class FastHBridgeMotor {
+public:
+    explicit FastHBridgeMotor(uint8_t enablePwmPin)
+        : _enable(enablePwmPin), _direction(HBRIDGE_STOPPED) {}
+
+    void init() {
+        In1::low();
+        In2::low();
+        In1::output();
+        In2::output();
+        _enable.init();
+        stop();
+    }
+
+    bool enableTimerPwm(uint32_t frequencyHz) {
+        return _enable.enableTimerPwm(frequencyHz);
+    }
+
+    void setForward(float dutyPercent) {
+        setDirectionPins(HBRIDGE_FORWARD);
+        _enable.setDuty(dutyPercent);
+    }
+
+    void setReverse(float dutyPercent) {
+        setDirectionPins(HBRIDGE_REVERSE);
+        _enable.setDuty(dutyPercent);
+    }
+
+    void stop() {
+        setDirectionPins(HBRIDGE_STOPPED);
+        _enable.setDuty(0.0f);
+    }
+
+    float getDuty() const { return _enable.getDuty(); }
+    uint8_t getRawPwm() const { return _enable.getRawPwm(); }
+    HBridgeDirection getDirection() const { return _direction; }
+
+private:
+    typedef FastPin<INPUT1_PIN> In1;
+    typedef FastPin<INPUT2_PIN> In2;
+
+    void setDirectionPins(HBridgeDirection direction) {
+        _direction = direction;
+
+        // Release the active side first so IN1 and IN2 are never both HIGH.
+        switch (direction) {
+            case HBRIDGE_FORWARD:
+                In2::low();
+                In1::high();
+                break;
+            case HBRIDGE_REVERSE:
+                In1::low();
+                In2::high();
+                break;
+            case HBRIDGE_STOPPED:
+            default:
+                In1::low();
+                In2::low();
+                break;
+        }
+    }
+
+    PwmActuator _enable;
+    HBridgeDirection _direction;
+};
+
+#endif // FAST_HBRIDGE_MOTOR_H
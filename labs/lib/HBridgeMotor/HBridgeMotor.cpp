@@ -1,63 +1,291 @@
 /**
  * @file HBridgeMotor.cpp
  * @brief H-bridge DC motor driver implementation.
+ *
+ * Profile ISR: Timer0 runs at 976.5625 Hz for millis(); its compare-A
+ * match fires once per period whatever OCR0A holds (the Led pattern
+ * engine uses compare-B the same way). Dead time counts these 1.024 ms
+ * ticks; the ramp takes a step every HBRIDGE_RAMP_TICKS ticks so the
+ * float duty update (~30 µs) costs well under 1 % CPU while ramping.
  */
 
 #include "HBridgeMotor.h"
 
+#if defined(__AVR__)
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+#if defined(__AVR__) && defined(OCIE0A) && !defined(HBRIDGE_NO_PROFILE_ISR)
+#define HBRIDGE_HAS_PROFILE_ISR 1
+#endif
+
+/** Ticks (1.024 ms) between ramp steps. */
+static const uint8_t HBRIDGE_RAMP_TICKS = 10;
+
+/** Seconds per ramp step. */
+static const float HBRIDGE_RAMP_STEP_S = HBRIDGE_RAMP_TICKS * 0.001024f;
+
+#if defined(HBRIDGE_HAS_PROFILE_ISR)
+
+static HBridgeMotor *volatile s_profiled[HBRIDGE_MAX_PROFILED];
+
+ISR(TIMER0_COMPA_vect) {
+    for (uint8_t i = 0; i < HBRIDGE_MAX_PROFILED; i++) {
+        HBridgeMotor *m = s_profiled[i];
+        if (m != NULL) {
+            m->profileTick();
+        }
+    }
+}
+
+#endif
+
 HBridgeMotor::HBridgeMotor(uint8_t enablePwmPin, uint8_t input1Pin, uint8_t input2Pin)
     : _enable(enablePwmPin),
       _input1Pin(input1Pin),
       _input2Pin(input2Pin),
-      _direction(HBRIDGE_STOPPED) {}
+      _profiled(false),
+      _stopMode(HBRIDGE_COAST),
+      _rampStep(0.0f),
+      _deadTicks(0),
+      _targetDirection(HBRIDGE_STOPPED),
+      _targetDuty(0.0f),
+      _pins(PINS_COAST),
+      _duty(0.0f),
+      _deadLeft(0),
+      _rampDivider(0) {}
 
 void HBridgeMotor::init() {
     pinMode(_input1Pin, OUTPUT);
     pinMode(_input2Pin, OUTPUT);
     _enable.init();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _targetDirection = HBRIDGE_STOPPED;
+        _targetDuty = 0.0f;
+        _duty = 0.0f;
+        _deadLeft = 0;
+        setDirectionPins(PINS_COAST);   // Known state, no dead time owed
+    }
     stop();
 }
 
+bool HBridgeMotor::enableTimerPwm(uint32_t frequencyHz) {
+    return _enable.enableTimerPwm(frequencyHz);
+}
+
 void HBridgeMotor::setForward(float dutyPercent) {
-    setDirectionPins(HBRIDGE_FORWARD);
-    _enable.setDuty(dutyPercent);
+    command(HBRIDGE_FORWARD, dutyPercent);
 }
 
 void HBridgeMotor::setReverse(float dutyPercent) {
-    setDirectionPins(HBRIDGE_REVERSE);
-    _enable.setDuty(dutyPercent);
+    command(HBRIDGE_REVERSE, dutyPercent);
 }
 
 void HBridgeMotor::stop() {
-    setDirectionPins(HBRIDGE_STOPPED);
-    _enable.setDuty(0.0f);
+    command(HBRIDGE_STOPPED, 0.0f);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Motion profile
+// ──────────────────────────────────────────────────────────────────────────
+
+bool HBridgeMotor::setRampRate(float percentPerSecond) {
+    if (!(percentPerSecond >= 0.0f)) {
+        return false;
+    }
+    if (!enableProfile()) {
+        return false;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _rampStep = percentPerSecond * HBRIDGE_RAMP_STEP_S;
+    }
+    return true;
+}
+
+bool HBridgeMotor::setDeadTimeMs(uint16_t ms) {
+    if (!enableProfile()) {
+        return false;
+    }
+    // Round up to whole 1.024 ms ticks, plus one: the first may be partial.
+    uint16_t ticks = (ms == 0) ? 0 : (uint16_t)(((uint32_t)ms * 1000UL + 1023UL) / 1024UL + 1UL);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _deadTicks = ticks;
+    }
+    return true;
+}
+
+bool HBridgeMotor::setStopMode(HBridgeStopMode mode) {
+    if (!enableProfile()) {
+        return false;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _stopMode = mode;
+    }
+    return true;
+}
+
+bool HBridgeMotor::enableProfile() {
+#if defined(HBRIDGE_HAS_PROFILE_ISR)
+    if (_profiled) {
+        return true;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < HBRIDGE_MAX_PROFILED; i++) {
+            if (s_profiled[i] == NULL) {
+                s_profiled[i] = this;
+                _profiled = true;
+                break;
+            }
+        }
+        if (_profiled) {
+            TIMSK0 |= _BV(OCIE0A);
+        }
+    }
+    return _profiled;
+#else
+    return false;
+#endif
+}
+
+bool HBridgeMotor::isSettled() const {
+    bool settled;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        settled = (_pins == targetPins());
+        if (settled && (_pins == PINS_FORWARD || _pins == PINS_REVERSE)) {
+            settled = (_duty == _targetDuty);
+        }
+    }
+    return settled;
 }
 
+void HBridgeMotor::command(HBridgeDirection direction, float dutyPercent) {
+    if (dutyPercent < 0.0f) {
+        dutyPercent = 0.0f;
+    } else if (dutyPercent > 100.0f) {
+        dutyPercent = 100.0f;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _targetDirection = direction;
+        _targetDuty = dutyPercent;
+    }
+
+    if (!_profiled) {
+        setDirectionPins(targetPins());   // Immediate, as without a profile
+        _duty = dutyPercent;
+        _enable.setDuty(dutyPercent);
+    }
+}
+
+void HBridgeMotor::profileTick() {
+    if (_deadLeft != 0) {
+        _deadLeft--;
+    }
+
+    PinState want = targetPins();
+    if (_pins != want) {
+        if (_pins != PINS_COAST) {
+            // Leave the driven state through coast and start the dead time.
+            _enable.setDuty(0.0f);
+            _duty = 0.0f;
+            setDirectionPins(PINS_COAST);
+            _deadLeft = _deadTicks;
+        }
+        if (want == PINS_COAST || _deadLeft != 0) {
+            return;
+        }
+        setDirectionPins(want);
+        if (want == PINS_BRAKE) {
+            _enable.setDuty(100.0f);      // Bridge enabled: motor shorted
+        }
+        _rampDivider = 0;
+    }
+
+    if (want != PINS_FORWARD && want != PINS_REVERSE) {
+        return;
+    }
+
+    float target = _targetDuty;
+    if (_duty == target) {
+        return;
+    }
+    if (_duty > target || _rampStep <= 0.0f) {
+        _duty = target;                   // Decreases are never slewed
+    } else {
+        if (++_rampDivider < HBRIDGE_RAMP_TICKS && _duty != 0.0f) {
+            return;
+        }
+        _rampDivider = 0;
+        _duty += _rampStep;
+        if (_duty > target) {
+            _duty = target;
+        }
+    }
+    _enable.setDuty(_duty);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Accessors
+// ──────────────────────────────────────────────────────────────────────────
+
 float HBridgeMotor::getDuty() const {
+    PinState pins = _pins;
+    if (pins != PINS_FORWARD && pins != PINS_REVERSE) {
+        return 0.0f;
+    }
     return _enable.getDuty();
 }
 
 uint8_t HBridgeMotor::getRawPwm() const {
+    PinState pins = _pins;
+    if (pins != PINS_FORWARD && pins != PINS_REVERSE) {
+        return 0;
+    }
     return _enable.getRawPwm();
 }
 
 HBridgeDirection HBridgeMotor::getDirection() const {
-    return _direction;
+    switch (_pins) {
+        case PINS_FORWARD:
+            return HBRIDGE_FORWARD;
+        case PINS_REVERSE:
+            return HBRIDGE_REVERSE;
+        default:
+            return HBRIDGE_STOPPED;
+    }
 }
 
-void HBridgeMotor::setDirectionPins(HBridgeDirection direction) {
-    _direction = direction;
-
-    switch (direction) {
+HBridgeMotor::PinState HBridgeMotor::targetPins() const {
+    switch (_targetDirection) {
         case HBRIDGE_FORWARD:
+            return PINS_FORWARD;
+        case HBRIDGE_REVERSE:
+            return PINS_REVERSE;
+        default:
+            return (_stopMode == HBRIDGE_BRAKE) ? PINS_BRAKE : PINS_COAST;
+    }
+}
+
+void HBridgeMotor::setDirectionPins(PinState pins) {
+    _pins = pins;
+
+    switch (pins) {
+        case PINS_FORWARD:
             digitalWrite(_input1Pin, HIGH);
             digitalWrite(_input2Pin, LOW);
             break;
-        case HBRIDGE_REVERSE:
+        case PINS_REVERSE:
             digitalWrite(_input1Pin, LOW);
             digitalWrite(_input2Pin, HIGH);
             break;
-        case HBRIDGE_STOPPED:
+        case PINS_BRAKE:
+            digitalWrite(_input1Pin, HIGH);
+            digitalWrite(_input2Pin, HIGH);
+            break;
+        case PINS_COAST:
         default:
             digitalWrite(_input1Pin, LOW);
             digitalWrite(_input2Pin, LOW);
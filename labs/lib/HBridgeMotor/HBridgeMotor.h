@@ -1,6 +1,32 @@
 /**
  * @file HBridgeMotor.h
  * @brief Unidirectional/bidirectional DC motor driver for an H-bridge.
+ *
+ * Motion profile (optional, all off by default):
+ *   - setRampRate(): duty increases are slewed (soft start, no inrush
+ *     spike); decreases apply at once.
+ *   - setDeadTimeMs(): after leaving a driven state (forward, reverse,
+ *     brake) the bridge coasts (IN1 = IN2 = LOW, enable 0 %) at least this
+ *     long before the next one, so one leg is never switched against the
+ *     other and the back-EMF has decayed before a reversal.
+ *   - setStopMode(HBRIDGE_BRAKE): stop() shorts the motor (IN1 = IN2 =
+ *     HIGH, enable 100 %, L293D/L298 "fast motor stop") instead of
+ *     letting it coast.
+ *
+ *   Once any of them is set, setForward()/setReverse()/stop() only record
+ *   the target: the profile is stepped from the Timer0 compare-A
+ *   interrupt (once per Timer0 period, 1.024 ms, next to the millis()
+ *   overflow, so no timer is taken), callers keep their call pattern and
+ *   getDuty()/getDirection() report what is applied. Up to
+ *   HBRIDGE_MAX_PROFILED motors; -DHBRIDGE_NO_PROFILE_ISR keeps
+ *   TIMER0_COMPA_vect free (targets then apply at once, no ramp/dead time).
+ *
+ * Usage:
+ *   HBridgeMotor fan(3, 16, 17);
+ *   fan.init();
+ *   fan.setRampRate(50.0f);     // %/s: 0 → 100 % in 2 s
+ *   fan.setDeadTimeMs(200);
+ *   fan.setForward(80.0f);     // returns at once, ramps in the ISR
  */
 
 #ifndef HBRIDGE_MOTOR_H
@@ -9,32 +35,98 @@
 #include <Arduino.h>
 #include "PwmActuator.h"
 
+/** @brief Motors whose profile the Timer0 compare ISR can step. */
+#ifndef HBRIDGE_MAX_PROFILED
+#define HBRIDGE_MAX_PROFILED 2
+#endif
+
 enum HBridgeDirection {
     HBRIDGE_STOPPED = 0,
     HBRIDGE_FORWARD = 1,
     HBRIDGE_REVERSE = 2
 };
 
+enum HBridgeStopMode {
+    HBRIDGE_COAST = 0,   ///< Both inputs LOW, enable 0 %: free-wheel
+    HBRIDGE_BRAKE = 1    ///< Both inputs HIGH, enable 100 %: short the motor
+};
+
 class HBridgeMotor {
 public:
     HBridgeMotor(uint8_t enablePwmPin, uint8_t input1Pin, uint8_t input2Pin);
 
     void init();
+
+    /** @brief Drive the enable pin from its 16-bit timer (see PwmActuator). */
+    bool enableTimerPwm(uint32_t frequencyHz);
+
     void setForward(float dutyPercent);
     void setReverse(float dutyPercent);
     void stop();
 
+    /**
+     * @brief Slew duty increases at @p percentPerSecond (0 = immediate).
+     * @return false if the profile ISR is unavailable or all slots are used.
+     */
+    bool setRampRate(float percentPerSecond);
+
+    /** @brief Coast time between driven states (0 = none). @return see setRampRate(). */
+    bool setDeadTimeMs(uint16_t ms);
+
+    /** @brief What stop() does. @return see setRampRate(). */
+    bool setStopMode(HBridgeStopMode mode);
+
+    /** @brief True when the applied state matches the last command. */
+    bool isSettled() const;
+
+    /** @brief Applied duty (%); 0 while coasting or braking. */
     float getDuty() const;
     uint8_t getRawPwm() const;
+    /** @brief Applied direction; HBRIDGE_STOPPED while coasting or braking. */
     HBridgeDirection getDirection() const;
 
+    /**
+     * @brief Profile interrupt body: advance dead time and ramp by one tick.
+     *
+     * Called by the driver's Timer0 compare ISR; not for application use.
+     */
+    void profileTick();
+
 private:
-    void setDirectionPins(HBridgeDirection direction);
+    /** Input pin states of the bridge. */
+    enum PinState {
+        PINS_COAST = 0,
+        PINS_FORWARD = 1,
+        PINS_REVERSE = 2,
+        PINS_BRAKE = 3
+    };
+
+    /** @brief Record a new target and apply it (at once or via the ISR). */
+    void command(HBridgeDirection direction, float dutyPercent);
+
+    /** @brief Register with the profile ISR (idempotent). */
+    bool enableProfile();
+
+    void setDirectionPins(PinState pins);
+
+    /** @brief Pin state that realizes the target direction. */
+    PinState targetPins() const;
 
     PwmActuator _enable;
     uint8_t _input1Pin;
     uint8_t _input2Pin;
-    HBridgeDirection _direction;
+
+    // ── Motion profile ──────────────────────────────────────────────
+    bool     _profiled;               ///< Targets are applied by the ISR
+    HBridgeStopMode _stopMode;
+    float    _rampStep;               ///< Duty step per ramp interval (0 = none)
+    uint16_t _deadTicks;              ///< Dead time in ISR ticks
+    volatile HBridgeDirection _targetDirection;
+    volatile float _targetDuty;       ///< Duty for forward/reverse
+    volatile PinState _pins;          ///< Applied input state
+    float    _duty;                   ///< Applied duty (forward/reverse)
+    uint16_t _deadLeft;               ///< Ticks of coast left
+    uint8_t  _rampDivider;            ///< Ticks since the last ramp step
 };
 
 #endif // HBRIDGE_MOTOR_H
@@ -0,0 +1,57 @@
+/**
+ * @file IdleSleep.cpp
+ * @brief Low-Power Idle Implementation
+ *
+ * Gating uses avr-libc's power_*_disable() (PRR0/PRR1 bits). The sleep is
+ * TaskScheduler's lost-wake-up-safe sequence; here there is no condition
+ * to re-check under cli(), since any interrupt is a reason to return.
+ */
+
+#include "IdleSleep.h"
+#include "StdioSerial.h"
+
+#if defined(__AVR__)
+#include <avr/power.h>
+#include <avr/sleep.h>
+#endif
+
+void idleSleepInit(uint16_t gate) {
+#if defined(__AVR__)
+    // A USART StdioSerial routes a stream to is in use (same bit layout).
+    gate &= (uint16_t)~STDIO_SERIAL_USARTS;
+#if defined(RTOS_TICK_TIMER)
+    // Nor is the timer the kernel tick runs on (RtosTick.h).
+    gate &= (uint16_t)~((RTOS_TICK_TIMER == 1)   ? IDLE_SLEEP_GATE_TIMER1
+                        : (RTOS_TICK_TIMER == 3) ? IDLE_SLEEP_GATE_TIMER3
+                        : (RTOS_TICK_TIMER == 4) ? IDLE_SLEEP_GATE_TIMER4
+                                                 : IDLE_SLEEP_GATE_TIMER5);
+#endif
+#if defined(PRR1)
+    if (gate & IDLE_SLEEP_GATE_USART1) { power_usart1_disable(); }
+    if (gate & IDLE_SLEEP_GATE_USART2) { power_usart2_disable(); }
+    if (gate & IDLE_SLEEP_GATE_USART3) { power_usart3_disable(); }
+    if (gate & IDLE_SLEEP_GATE_TIMER3) { power_timer3_disable(); }
+    if (gate & IDLE_SLEEP_GATE_TIMER4) { power_timer4_disable(); }
+    if (gate & IDLE_SLEEP_GATE_TIMER5) { power_timer5_disable(); }
+#endif
+    if (gate & IDLE_SLEEP_GATE_SPI)    { power_spi_disable(); }
+    if (gate & IDLE_SLEEP_GATE_TIMER1) { power_timer1_disable(); }
+    if (gate & IDLE_SLEEP_GATE_TIMER2) { power_timer2_disable(); }
+    if (gate & IDLE_SLEEP_GATE_ANALOG_COMP) {
+        ACSR = _BV(ACD);   // ACIE cleared in the same write (datasheet order)
+    }
+#else
+    (void)gate;
+#endif
+}
+
+void idleSleep() {
+#if defined(__AVR__)
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+#endif
+}
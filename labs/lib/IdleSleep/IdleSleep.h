@@ -0,0 +1,93 @@
+/**
+ * @file IdleSleep.h
+ * @brief Low-Power Idle for FreeRTOS Labs (MCU Sleep in the Idle Hook)
+ *
+ * feilipu/FreeRTOS runs the Arduino loop() from vApplicationIdleHook(),
+ * so with every task blocked the CPU spins there at full current until
+ * the next interrupt. idleSleep() stops the CPU clock instead: called
+ * from loop(), it sleeps until any interrupt and returns, and the idle
+ * task loops back into it.
+ *
+ * The sleep mode is SLEEP_MODE_IDLE, the deepest one whose wake sources
+ * cover what the labs run on:
+ *
+ *   - the scheduler tick is the watchdog (or, with -DRTOS_TICK_TIMER, a
+ *     16-bit timer compare), and millis()/micros() (RtosPeriod deadlines,
+ *     dt, the Led and HBridgeMotor compare ISRs) are Timer0;
+ *   - USART0 RX (console) and TWI (LCD) must keep receiving;
+ *   - the 16-bit PWM timers (Timer3 fan/actuator) must keep their output.
+ *
+ * ADC noise reduction, power-save and power-down all stop clkI/O, which
+ * stops Timer0, the USART and the PWM outputs. The kernel tick is never
+ * suppressed either: the port has no portSUPPRESS_TICKS_AND_SLEEP(), so
+ * there is no tick count to correct on wake-up and task timing is exactly
+ * what it was without sleeping. What is saved is the CPU and flash current
+ * between interrupts: the idle supply current is about a quarter of the
+ * active one at the same clock. A 1 ms timer tick wakes the CPU 16× as
+ * often as the WDT one, which is why the WDT stays the default.
+ *
+ * idleSleepInit() additionally clock-gates, through PRR0/PRR1, modules a
+ * lab never uses, so they stop drawing current awake and asleep. Gate
+ * only what is truly unused: a gated timer stops analogWrite() on its
+ * pins and any ISR on it (Timer2: analogWrite on D9/D10, tone(),
+ * TaskMonitor; Timer3: D2/D3/D5 PWM, PwmActuator/HBridgeMotor on D3).
+ * Timer0, USART0, TWI and the ADC are never gated, nor is a USART that
+ * StdioSerial routes telemetry or the log to, nor the RTOS_TICK_TIMER. Pins of a gated module
+ * remain usable as plain GPIO.
+ *
+ * Another library that sleeps in the idle hook (adcEngineIdle()) takes
+ * precedence: call idleSleep() only when it did not.
+ *
+ * Usage:
+ *   idleSleepInit(IDLE_SLEEP_GATE_SPI | IDLE_SLEEP_GATE_USART1);  // setup()
+ *   void labLoop() { idleSleep(); }                               // idle hook
+ */
+
+#ifndef IDLE_SLEEP_H
+#define IDLE_SLEEP_H
+
+#include <Arduino.h>
+
+/**
+ * @enum IdleSleepGate
+ * @brief Modules idleSleepInit() may switch off (combine with |).
+ */
+enum IdleSleepGate {
+    IDLE_SLEEP_GATE_NONE        = 0,
+    IDLE_SLEEP_GATE_SPI         = 1 << 0,
+    IDLE_SLEEP_GATE_USART1      = 1 << 1,
+    IDLE_SLEEP_GATE_USART2      = 1 << 2,
+    IDLE_SLEEP_GATE_USART3      = 1 << 3,
+    IDLE_SLEEP_GATE_TIMER1      = 1 << 4,
+    IDLE_SLEEP_GATE_TIMER2      = 1 << 5,
+    IDLE_SLEEP_GATE_TIMER3      = 1 << 6,
+    IDLE_SLEEP_GATE_TIMER4      = 1 << 7,
+    IDLE_SLEEP_GATE_TIMER5      = 1 << 8,
+    IDLE_SLEEP_GATE_ANALOG_COMP = 1 << 9   /**< Analog comparator (ACSR.ACD). */
+};
+
+/** @brief The three spare USARTs (Serial1..3); a routed one stays on (StdioSerial). */
+static const uint16_t IDLE_SLEEP_GATE_SPARE_USARTS =
+    IDLE_SLEEP_GATE_USART1 | IDLE_SLEEP_GATE_USART2 | IDLE_SLEEP_GATE_USART3;
+
+/**
+ * @brief Switch off unused modules; call once from setup().
+ *
+ * Run it after all drivers are initialised, so none of them
+ * reconfigures a module after it has been gated.
+ *
+ * @param gate IdleSleepGate bits; IDLE_SLEEP_GATE_NONE only enables sleep.
+ */
+void idleSleepInit(uint16_t gate);
+
+/**
+ * @brief Sleep in SLEEP_MODE_IDLE until the next interrupt.
+ *
+ * Call from loop() (the FreeRTOS idle hook) only; a task must block
+ * through the kernel instead. Any interrupt (the 1.024 ms Timer0
+ * overflow, at the latest) resumes the idle task, and a task made ready
+ * runs exactly as it would have after an idle spin.
+ */
+void idleSleep();
+
+#endif // IDLE_SLEEP_H
@@ -0,0 +1,141 @@
+/**
+ * @file KalmanFusion.cpp
+ * @brief Two-State Kalman Filter Implementation
+ *
+ * The 2×2 matrices are expanded by hand: the covariance is symmetric, so
+ * only p00, p01 and p11 are stored, and each measurement is scalar, so
+ * the update needs a single division (1 / S) and no matrix inverse.
+ */
+
+#include "KalmanFusion.h"
+#include <math.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Constructor / reset
+// ──────────────────────────────────────────────────────────────────────────
+
+KalmanFusion::KalmanFusion(float processNoise, float initRateVariance)
+    : _q(processNoise),
+      _initRateVar(initRateVariance),
+      _gate2(0.0f) {
+    reset();
+}
+
+void KalmanFusion::reset() {
+    _x0 = 0.0f;
+    _x1 = 0.0f;
+    _p00 = 0.0f;
+    _p01 = 0.0f;
+    _p11 = 0.0f;
+    _lastInnovation = 0.0f;
+    _rejects = 0;
+    _initialized = false;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Predict — constant-rate model
+// ──────────────────────────────────────────────────────────────────────────
+
+void KalmanFusion::predict(float dtS) {
+    if (!_initialized || dtS <= 0.0f) {
+        return;
+    }
+
+    // x = F x
+    _x0 += dtS * _x1;
+
+    // P = F P F' + Q
+    float dt2 = dtS * dtS;
+    float p00 = _p00 + dtS * (2.0f * _p01 + dtS * _p11);
+    float p01 = _p01 + dtS * _p11;
+    _p00 = p00 + _q * dt2 * dtS / 3.0f;
+    _p01 = p01 + _q * dt2 / 2.0f;
+    _p11 = _p11 + _q * dtS;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Update — scalar reading of the value `ageS` seconds ago
+// ──────────────────────────────────────────────────────────────────────────
+
+bool KalmanFusion::update(float value, float variance, float ageS) {
+    if (isnan(value) || isinf(value)) {
+        return false;
+    }
+
+    if (!_initialized) {
+        // Seed from the first reading; the rate is unknown.
+        _x0 = value;
+        _x1 = 0.0f;
+        _p00 = variance;
+        _p01 = 0.0f;
+        _p11 = _initRateVar;
+        _lastInnovation = 0.0f;
+        _initialized = true;
+        return true;
+    }
+
+    // H = [1, -age]  →  P H' and S = H P H' + R
+    float ph0 = _p00 - ageS * _p01;
+    float ph1 = _p01 - ageS * _p11;
+    float s   = ph0 - ageS * ph1 + variance;
+    if (s <= 0.0f) {
+        return false;
+    }
+
+    float innovation = value - (_x0 - ageS * _x1);
+    _lastInnovation = innovation;
+
+    if (_gate2 > 0.0f && innovation * innovation > _gate2 * s) {
+        if (_rejects < 0xFFFF) {
+            _rejects++;
+        }
+        return false;
+    }
+
+    // K = P H' / S;  x += K * innovation;  P -= K (H P)
+    float invS = 1.0f / s;
+    float k0 = ph0 * invS;
+    float k1 = ph1 * invS;
+    _x0 += k0 * innovation;
+    _x1 += k1 * innovation;
+    _p00 -= k0 * ph0;
+    _p01 -= k0 * ph1;
+    _p11 -= k1 * ph1;
+    return true;
+}
+
+void KalmanFusion::setGate(float sigmas) {
+    _gate2 = sigmas * sigmas;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Getters
+// ──────────────────────────────────────────────────────────────────────────
+
+float KalmanFusion::getEstimate() const {
+    return _initialized ? _x0 : NAN;
+}
+
+float KalmanFusion::getRate() const {
+    return _x1;
+}
+
+float KalmanFusion::getVariance() const {
+    return _p00;
+}
+
+float KalmanFusion::getRateVariance() const {
+    return _p11;
+}
+
+float KalmanFusion::getLastInnovation() const {
+    return _lastInnovation;
+}
+
+bool KalmanFusion::isInitialized() const {
+    return _initialized;
+}
+
+uint16_t KalmanFusion::getRejectCount() const {
+    return _rejects;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file KalmanFusion.h
+ * @brief Two-State Kalman Filter for Fusing Redundant Scalar Sensors
+ *
+ * Combines readings of one physical quantity from several sensors with
+ * different noise levels and latencies (e.g. a fast, noisy NTC and a slow
+ * DS18B20) into a single best estimate with a covariance.
+ *
+ * State: x = [ value, rate ]  (rate in units per second)
+ *
+ *   Predict (dt):   x = F x,  P = F P F' + Q
+ *                   F = [1 dt; 0 1]
+ *                   Q = q * [dt³/3 dt²/2; dt²/2 dt]   (random-walk rate)
+ *
+ *   Update (z, R, age):
+ *                   H = [1, -age]   the reading describes the value age
+ *                                   seconds ago: z ≈ value - age * rate
+ *                   S = H P H' + R,  K = P H' / S
+ *                   x += K (z - H x),  P -= K H P
+ *
+ * The age term is the staleness model: a reading that left the sensor a
+ * while ago (still in conversion, or held between conversions) is
+ * projected forward along the estimated rate instead of being taken as
+ * current, and its effective variance grows with the rate uncertainty.
+ *
+ * Optionally, readings whose innovation exceeds a gate (in standard
+ * deviations of S) are rejected, so a glitch on one sensor does not pull
+ * the fused estimate.
+ *
+ * Usage:
+ *   KalmanFusion fusion(0.01f, 1.0f);      // q, initial rate variance
+ *   fusion.predict(0.05f);                 // 50 ms since last cycle
+ *   fusion.update(ntcTemp, 0.04f);         // NTC: σ = 0.2 °C, current
+ *   if (ds18b20Fresh) fusion.update(dsTemp, 0.02f, 0.12f);  // 120 ms old
+ *   float t = fusion.getEstimate();
+ *   float var = fusion.getVariance();
+ */
+
+#ifndef KALMAN_FUSION_H
+#define KALMAN_FUSION_H
+
+#include <Arduino.h>
+
+/**
+ * @class KalmanFusion
+ * @brief Value + rate Kalman filter with scalar, aged measurement updates.
+ *
+ * The filter is uninitialized until the first accepted update, which
+ * seeds the value from that reading. All arithmetic is scalar (the 2×2
+ * covariance is stored as three floats); no dynamic memory is used.
+ */
+class KalmanFusion {
+public:
+    /**
+     * @brief Construct a new KalmanFusion object.
+     *
+     * @param processNoise     Rate random-walk intensity q (units²/s³).
+     *                         Larger values track changes faster.
+     * @param initRateVariance Rate variance assumed at initialization.
+     */
+    KalmanFusion(float processNoise, float initRateVariance);
+
+    /**
+     * @brief Reset to the uninitialized state.
+     */
+    void reset();
+
+    /**
+     * @brief Propagate the state and covariance forward in time.
+     *
+     * Call once per cycle before the updates. Ignored until initialized.
+     *
+     * @param dtS Time since the previous predict() (seconds).
+     */
+    void predict(float dtS);
+
+    /**
+     * @brief Fuse one sensor reading.
+     *
+     * @param value    The reading.
+     * @param variance Reading variance (units²), e.g. the sensor's σ².
+     * @param ageS     How old the reading is (seconds, default 0).
+     * @return true if the reading was used; false if rejected by the
+     *         gate or not finite.
+     */
+    bool update(float value, float variance, float ageS = 0.0f);
+
+    /**
+     * @brief Set the innovation gate.
+     * @param sigmas Rejection threshold in standard deviations (0 = off).
+     */
+    void setGate(float sigmas);
+
+    /**
+     * @brief Get the fused estimate.
+     * @return float Best estimate of the value (NAN until initialized).
+     */
+    float getEstimate() const;
+
+    /**
+     * @brief Get the estimated rate of change.
+     * @return float Rate (units per second).
+     */
+    float getRate() const;
+
+    /**
+     * @brief Get the variance of the estimate (P[0][0]).
+     * @return float Variance (units²).
+     */
+    float getVariance() const;
+
+    /**
+     * @brief Get the variance of the rate estimate (P[1][1]).
+     * @return float Variance ((units/s)²).
+     */
+    float getRateVariance() const;
+
+    /**
+     * @brief Get the innovation (z - H x) of the last update() call.
+     * @return float Innovation (units).
+     */
+    float getLastInnovation() const;
+
+    /**
+     * @brief Check whether the filter has been seeded.
+     * @return true after the first accepted update.
+     */
+    bool isInitialized() const;
+
+    /**
+     * @brief Number of readings rejected by the gate since reset().
+     * @return uint16_t Rejection count (saturates).
+     */
+    uint16_t getRejectCount() const;
+
+private:
+    float _q;                 /**< Process noise intensity.            */
+    float _initRateVar;       /**< Rate variance after seeding.        */
+    float _gate2;             /**< Gate² (0 = disabled).               */
+
+    float _x0;                /**< Value estimate.                     */
+    float _x1;                /**< Rate estimate (units/s).            */
+    float _p00;               /**< Covariance [0][0].                  */
+    float _p01;               /**< Covariance [0][1] = [1][0].         */
+    float _p11;               /**< Covariance [1][1].                  */
+
+    float    _lastInnovation; /**< z - H x of the last update.         */
+    uint16_t _rejects;        /**< Gate rejections since reset.        */
+    bool     _initialized;    /**< True after the first update.        */
+};
+
+#endif // KALMAN_FUSION_H
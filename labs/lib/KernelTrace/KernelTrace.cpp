@@ -0,0 +1,162 @@
+/**
+ * @file KernelTrace.cpp
+ * @brief FreeRTOS Kernel Event Trace Implementation
+ *
+ * The ring is indexed by a free-running 32-bit event count: event n lives
+ * in slot n % KERNEL_TRACE_RECORDS. The kernel calls the hooks with
+ * interrupts enabled or disabled depending on the hook, so recording
+ * saves and restores SREG around the store instead of enabling them.
+ *
+ * The timestamp extends TCNT0 with the core's timer0_overflow_count like
+ * micros() does, counting a pending overflow that its ISR has not taken
+ * yet, but stays in Timer0 ticks (no multiply in the hook).
+ */
+
+#include "KernelTrace.h"
+#include "FlashString.h"
+#include <Arduino.h>
+#include <stdio.h>
+
+#if defined(KERNEL_TRACE_ENABLED)
+
+#include <Arduino_FreeRTOS.h>
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#define KERNEL_TRACE_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+
+extern "C" volatile unsigned long timer0_overflow_count;  // wiring.c
+#else
+#define KERNEL_TRACE_ATOMIC
+#endif
+
+static_assert((KERNEL_TRACE_RECORDS & (KERNEL_TRACE_RECORDS - 1)) == 0,
+              "KERNEL_TRACE_RECORDS must be a power of two");
+static_assert(sizeof(KernelTraceRecord) == 8, "KernelTraceRecord must stay 8 bytes");
+
+static KernelTraceRecord s_ring[KERNEL_TRACE_RECORDS];
+static uint32_t          s_total;   ///< Events recorded (sequence number)
+static uint16_t          s_lost;    ///< Events dropped while frozen (saturates)
+static volatile bool     s_frozen;
+
+/** @brief Timer0 ticks since boot. Call with interrupts masked. */
+static inline uint32_t traceTime() {
+#if defined(__AVR__)
+    uint32_t overflows = timer0_overflow_count;
+    uint8_t count = TCNT0;
+    if ((TIFR0 & _BV(TOV0)) && count < 255) {
+        overflows++;
+    }
+    return (overflows << 8) | count;
+#else
+    return (uint32_t)(micros() / KERNEL_TRACE_TICK_US);
+#endif
+}
+
+extern "C" void kernelTraceRecord(uint8_t event, uint16_t object) {
+    KERNEL_TRACE_ATOMIC {
+        if (s_frozen) {
+            if (s_lost < 0xFFFF) {
+                s_lost++;
+            }
+        } else {
+            KernelTraceRecord *r = &s_ring[s_total & (KERNEL_TRACE_RECORDS - 1)];
+            r->time = traceTime();
+            r->event = event;
+            r->spare = 0;
+            r->object = object;
+            s_total++;
+        }
+    }
+}
+
+extern "C" void kernelTraceFreeze(void) {
+    s_frozen = true;
+}
+
+extern "C" void kernelTraceClear(void) {
+    KERNEL_TRACE_ATOMIC {
+        s_total = 0;
+        s_lost = 0;
+        s_frozen = false;
+    }
+}
+
+extern "C" uint32_t kernelTraceTotal(void) {
+    uint32_t n;
+    KERNEL_TRACE_ATOMIC {
+        n = s_total;
+    }
+    return n;
+}
+
+/** @brief Event name without the ISR flag. */
+static const char *eventName(uint8_t event) {
+    switch (event & (uint8_t)~KERNEL_TRACE_FROM_ISR) {
+        case KERNEL_TRACE_SWITCH_IN:  return "IN";
+        case KERNEL_TRACE_SWITCH_OUT: return "OUT";
+        case KERNEL_TRACE_GIVE:       return "GIVE";
+        case KERNEL_TRACE_TAKE:       return "TAKE";
+        case KERNEL_TRACE_BLOCK:      return "BLOCK";
+        case KERNEL_TRACE_NOTIFY:     return "NOTIFY";
+        case KERNEL_TRACE_WAIT:       return "WAIT";
+        case KERNEL_TRACE_DELAY:      return "DELAY";
+        case KERNEL_TRACE_ISR_ENTRY:  return "ISR";
+        default:                      return "?";
+    }
+}
+
+#if defined(__AVR__)
+/** @brief True if the record's object is a task (TCB address). */
+static bool isTaskEvent(uint8_t event) {
+    switch (event & (uint8_t)~KERNEL_TRACE_FROM_ISR) {
+        case KERNEL_TRACE_SWITCH_IN:
+        case KERNEL_TRACE_SWITCH_OUT:
+        case KERNEL_TRACE_NOTIFY:
+        case KERNEL_TRACE_WAIT:
+        case KERNEL_TRACE_DELAY:
+            return true;
+        default:
+            return false;
+    }
+}
+#endif
+
+extern "C" void kernelTraceDump(void) {
+    bool wasFrozen;
+    uint32_t end;
+    KERNEL_TRACE_ATOMIC {
+        wasFrozen = s_frozen;
+        s_frozen = true;
+        end = s_total;
+    }
+    uint32_t start = (end > KERNEL_TRACE_RECORDS) ? end - KERNEL_TRACE_RECORDS : 0;
+
+    FLASH_PRINTF("KTRACE,%u,%lu,%u,%lu\r\n", (unsigned)(end - start), (unsigned long)end,
+                 (unsigned)s_lost, (unsigned long)KERNEL_TRACE_TICK_US);
+    for (uint32_t seq = start; seq < end; seq++) {
+        // Frozen: the kernel no longer writes the ring, no copy needed.
+        const KernelTraceRecord *r = &s_ring[seq & (KERNEL_TRACE_RECORDS - 1)];
+        FLASH_PRINTF("KT,%lu,%s%s,%04X", (unsigned long)r->time, eventName(r->event),
+                     (r->event & KERNEL_TRACE_FROM_ISR) ? "_ISR" : "", (unsigned)r->object);
+#if defined(__AVR__)
+        // The labs' tasks are static and never deleted, so the TCB is still valid.
+        if (isTaskEvent(r->event) && r->object != 0) {
+            FLASH_PRINTF(",%s", pcTaskGetName((TaskHandle_t)(uintptr_t)r->object));
+        }
+#endif
+        FLASH_PRINTF("\r\n");
+    }
+    FLASH_PRINTF("KTEND\r\n");
+
+    s_frozen = wasFrozen;
+}
+
+#else  // !KERNEL_TRACE_ENABLED
+
+extern "C" void kernelTraceDump(void) {
+    FLASH_PRINTF("[KTRACE] Disabled (build with -DKERNEL_TRACE_ENABLED and "
+                 "-include lib/KernelTrace/KernelTrace.h)\r\n");
+}
+
+#endif // KERNEL_TRACE_ENABLED
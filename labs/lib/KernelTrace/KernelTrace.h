@@ -0,0 +1,187 @@
+/**
+ * @file KernelTrace.h
+ * @brief FreeRTOS Task-Switch / Give / Take Trace (RAM ring, CSV dump)
+ *
+ * TaskMonitor tells how much CPU each task used; it does not tell in
+ * which order the tasks ran, who woke whom, or how long a task waited
+ * between a give and the matching take. KernelTrace hooks the FreeRTOS
+ * trace macros and records each kernel event as an 8-byte record
+ *
+ *   { time, event, 0, object }
+ *
+ * into a fixed ring of the last KERNEL_TRACE_RECORDS events. The time is
+ * the Timer0 count the Arduino core already keeps running for millis(),
+ * extended by its overflow counter: 4 µs per tick at 16 MHz, wrapping
+ * after ~4.7 h. The object is the 16-bit address of the task (TCB), queue
+ * or semaphore involved, or an application id for ISR records.
+ *
+ * Recorded events:
+ *   IN / OUT     traceTASK_SWITCHED_IN / _OUT      object = task
+ *   GIVE / TAKE  traceQUEUE_SEND / _RECEIVE        object = queue, semaphore, mutex
+ *   BLOCK        traceBLOCKING_ON_QUEUE_*          object = queue the task waits on
+ *   NOTIFY       traceTASK_NOTIFY*                 object = task notified
+ *   WAIT         traceTASK_NOTIFY_TAKE             object = task that waits
+ *   DELAY        traceTASK_DELAY / _DELAY_UNTIL    object = task
+ *   ISR          KERNEL_TRACE_ISR(id)              object = id (KernelTraceIsrId)
+ * GIVE, TAKE and NOTIFY from an ISR are flagged KERNEL_TRACE_FROM_ISR and
+ * printed with an "_ISR" suffix. FreeRTOS has no ISR entry hook, so ISR
+ * records come from application ISRs that call KERNEL_TRACE_ISR(); only
+ * low-rate ones are instrumented (a per-sample ADC or UART ISR would fill
+ * the ring on its own).
+ *
+ * Recording is a Timer0 read and one record store with interrupts masked
+ * (~3 µs). The kernel hooks are only compiled in when this header is
+ * force-included into every translation unit, FreeRTOS's own included:
+ *
+ *   build_flags = ... -DKERNEL_TRACE_ENABLED -include lib/KernelTrace/KernelTrace.h
+ *
+ * Without KERNEL_TRACE_ENABLED the hooks and KERNEL_TRACE_ISR() expand to
+ * nothing and kernelTraceDump() only reports that tracing is off. The
+ * header is C and assembler safe for the forced include.
+ *
+ * Dump format (one CSV record per line, oldest first):
+ *
+ *   KTRACE,<records>,<total>,<lost>,<tick_us>
+ *   KT,<ticks>,<event>,<object hex>[,<task name>]
+ *   KTEND
+ *
+ * Task records carry the task name; queue and semaphore handles are
+ * static objects and resolve with avr-nm on the firmware ELF.
+ *
+ * Usage:
+ *   KERNEL_TRACE_ISR(KERNEL_TRACE_ISR_KEYPAD);  // first line of an ISR
+ *   kernelTraceFreeze();                         // stop at a trigger, keep the window
+ *   kernelTraceDump();                           // serial command handler
+ */
+
+#ifndef KERNEL_TRACE_H
+#define KERNEL_TRACE_H
+
+#if !defined(__ASSEMBLER__)
+
+#include <stdint.h>
+
+/** @brief Records kept in the ring (power of two, 8 bytes each). */
+#ifndef KERNEL_TRACE_RECORDS
+#define KERNEL_TRACE_RECORDS 32
+#endif
+
+/** @brief Microseconds per time tick (Timer0, prescaler 64). */
+#define KERNEL_TRACE_TICK_US (64000000UL / F_CPU)
+
+/** @name Event codes (KernelTraceRecord::event) */
+///@{
+#define KERNEL_TRACE_SWITCH_IN   1
+#define KERNEL_TRACE_SWITCH_OUT  2
+#define KERNEL_TRACE_GIVE        3
+#define KERNEL_TRACE_TAKE        4
+#define KERNEL_TRACE_BLOCK       5
+#define KERNEL_TRACE_NOTIFY      6
+#define KERNEL_TRACE_WAIT        7
+#define KERNEL_TRACE_DELAY       8
+#define KERNEL_TRACE_ISR_ENTRY   9
+#define KERNEL_TRACE_FROM_ISR    0x80  /**< Flag: event raised inside an ISR. */
+///@}
+
+/** @brief Ids of the instrumented application ISRs (ISR record object). */
+enum KernelTraceIsrId {
+    KERNEL_TRACE_ISR_KEYPAD = 1   /**< KeypadInput pin-change wake. */
+};
+
+/** @brief One recorded kernel event. */
+struct KernelTraceRecord {
+    uint32_t time;    /**< Timer0 ticks (KERNEL_TRACE_TICK_US each). */
+    uint8_t  event;   /**< Event code, maybe | KERNEL_TRACE_FROM_ISR. */
+    uint8_t  spare;   /**< Zero; keeps the record 8 bytes.            */
+    uint16_t object;  /**< Task, queue or ISR id.                     */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(KERNEL_TRACE_ENABLED)
+
+/**
+ * @brief Record an event (dropped and counted as lost while frozen).
+ *
+ * Interrupt-safe; normally called through the hook macros.
+ */
+void kernelTraceRecord(uint8_t event, uint16_t object);
+
+/** @brief Stop recording; the ring keeps the events up to this point. */
+void kernelTraceFreeze(void);
+
+/** @brief Forget all records and resume recording. */
+void kernelTraceClear(void);
+
+/** @brief Events recorded since boot or kernelTraceClear(). */
+uint32_t kernelTraceTotal(void);
+
+/** @brief Record an application ISR entry. */
+#define KERNEL_TRACE_ISR(id) kernelTraceRecord(KERNEL_TRACE_ISR_ENTRY, (uint16_t)(id))
+
+/** @brief Object id of a kernel handle (16-bit address on the AVR). */
+#define KERNEL_TRACE_OBJ(p) ((uint16_t)(uintptr_t)(p))
+
+// ── FreeRTOS hooks (tasks.c / queue.c see them through the forced include) ──
+
+#define traceTASK_SWITCHED_IN() \
+    kernelTraceRecord(KERNEL_TRACE_SWITCH_IN, KERNEL_TRACE_OBJ(pxCurrentTCB))
+#define traceTASK_SWITCHED_OUT() \
+    kernelTraceRecord(KERNEL_TRACE_SWITCH_OUT, KERNEL_TRACE_OBJ(pxCurrentTCB))
+
+#define traceQUEUE_SEND(pxQueue) \
+    kernelTraceRecord(KERNEL_TRACE_GIVE, KERNEL_TRACE_OBJ(pxQueue))
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) \
+    kernelTraceRecord(KERNEL_TRACE_GIVE | KERNEL_TRACE_FROM_ISR, KERNEL_TRACE_OBJ(pxQueue))
+#define traceQUEUE_RECEIVE(pxQueue) \
+    kernelTraceRecord(KERNEL_TRACE_TAKE, KERNEL_TRACE_OBJ(pxQueue))
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) \
+    kernelTraceRecord(KERNEL_TRACE_TAKE | KERNEL_TRACE_FROM_ISR, KERNEL_TRACE_OBJ(pxQueue))
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) \
+    kernelTraceRecord(KERNEL_TRACE_BLOCK, KERNEL_TRACE_OBJ(pxQueue))
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) \
+    kernelTraceRecord(KERNEL_TRACE_BLOCK, KERNEL_TRACE_OBJ(pxQueue))
+
+// The notify hooks gained an index argument in FreeRTOS 10.4; accept both.
+#define traceTASK_NOTIFY(...) \
+    kernelTraceRecord(KERNEL_TRACE_NOTIFY, KERNEL_TRACE_OBJ(xTaskToNotify))
+#define traceTASK_NOTIFY_FROM_ISR(...) \
+    kernelTraceRecord(KERNEL_TRACE_NOTIFY | KERNEL_TRACE_FROM_ISR, KERNEL_TRACE_OBJ(xTaskToNotify))
+#define traceTASK_NOTIFY_GIVE_FROM_ISR(...) \
+    kernelTraceRecord(KERNEL_TRACE_NOTIFY | KERNEL_TRACE_FROM_ISR, KERNEL_TRACE_OBJ(xTaskToNotify))
+#define traceTASK_NOTIFY_TAKE(...) \
+    kernelTraceRecord(KERNEL_TRACE_WAIT, KERNEL_TRACE_OBJ(pxCurrentTCB))
+
+#define traceTASK_DELAY() \
+    kernelTraceRecord(KERNEL_TRACE_DELAY, KERNEL_TRACE_OBJ(pxCurrentTCB))
+#define traceTASK_DELAY_UNTIL(...) \
+    kernelTraceRecord(KERNEL_TRACE_DELAY, KERNEL_TRACE_OBJ(pxCurrentTCB))
+
+#else  // !KERNEL_TRACE_ENABLED
+
+#define KERNEL_TRACE_ISR(id) ((void)0)
+
+static inline void kernelTraceFreeze(void) {}
+static inline void kernelTraceClear(void) {}
+static inline uint32_t kernelTraceTotal(void) { return 0; }
+
+#endif // KERNEL_TRACE_ENABLED
+
+/**
+ * @brief Print the ring as CSV (see the file comment) with printf().
+ *
+ * Recording is frozen while the records are printed, so the dump is one
+ * consistent window; events during the dump count as lost. Recording
+ * resumes afterwards unless kernelTraceFreeze() had stopped it before.
+ */
+void kernelTraceDump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !__ASSEMBLER__
+
+#endif // KERNEL_TRACE_H
@@ -2,12 +2,29 @@
  * @file KeypadInput.cpp
  * @brief 4x4 Matrix Keypad Driver Implementation
  *
- * Implements the KeypadInput class using the Keypad library for
- * matrix scanning and debouncing. The key map is defined as a
+ * Implements the KeypadInput class. The key map is defined as a
  * standard 4x4 layout with digits 0-9, *, #, and A-D.
+ *
+ * Default backend: the Keypad library does the matrix scanning and
+ * debouncing; scan() moves its key into the FIFO.
+ *
+ * Direct backend (KEYPAD_INPUT_DIRECT): during a scan the rows not being
+ * driven are high-impedance inputs and the driven row is an output LOW;
+ * the columns are inputs with pull-ups. A raw bitmap change restarts the
+ * debounce timer, and once the bitmap has held for KEYPAD_DEBOUNCE_MS it
+ * becomes the state; its new bits are the pressed keys.
  */
 
 #include "KeypadInput.h"
+#include "KernelTrace.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
 
 /// Standard 4x4 membrane keypad layout
 static char keymap[KEYPAD_ROWS][KEYPAD_COLS] = {
@@ -17,6 +34,34 @@ static char keymap[KEYPAD_ROWS][KEYPAD_COLS] = {
     {'*', '0', '#', 'D'}
 };
 
+// ──────────────────────────────────────────────────────────────────────────
+// FIFO (both backends)
+// ──────────────────────────────────────────────────────────────────────────
+
+void KeypadInput::push(char key) {
+    _fifo.push(key);   // Counted as dropped when full
+}
+
+bool KeypadInput::readKey(char *key) {
+    return _fifo.pop(key);
+}
+
+char KeypadInput::getKey() {
+    char key = 0;
+    scan();
+    readKey(&key);
+    return key;
+}
+
+uint16_t KeypadInput::getDroppedKeys() const {
+    return _fifo.dropped();
+}
+
+#if !defined(KEYPAD_INPUT_DIRECT)
+// ──────────────────────────────────────────────────────────────────────────
+// Keypad library backend
+// ──────────────────────────────────────────────────────────────────────────
+
 KeypadInput::KeypadInput(byte *rowPins, byte *colPins)
     : _keypad(makeKeymap(keymap), rowPins, colPins,
               KEYPAD_ROWS, KEYPAD_COLS) {}
@@ -25,9 +70,235 @@ void KeypadInput::init() {
     // Set debounce time to 20ms for reliable membrane keypad operation.
     // The Keypad library uses an internal state machine that tracks
     // press/release transitions, ensuring clean key detection.
-    _keypad.setDebounceTime(20);
+    _keypad.setDebounceTime(KEYPAD_DEBOUNCE_MS);
 }
 
-char KeypadInput::getKey() {
-    return _keypad.getKey();
+bool KeypadInput::scan() {
+    char key = _keypad.getKey();
+    if (key != 0) {
+        push(key);
+    }
+    return false;  // The library keeps its own timing; poll as before
+}
+
+bool KeypadInput::armWake(WakeCallback onWake, void *arg) {
+    (void)onWake;
+    (void)arg;
+    return false;
+}
+
+void KeypadInput::disarmWake() {}
+
+#else
+// ──────────────────────────────────────────────────────────────────────────
+// Direct port backend
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(__AVR__) && defined(PCICR) && !defined(KEYPAD_INPUT_NO_PCINT_ISR)
+#define KEYPAD_HAS_PCINT 1
+
+static KeypadInput::WakeCallback s_onWake = NULL;
+static void *s_onWakeArg = NULL;
+static volatile uint8_t *s_wakeMask[KEYPAD_COLS];   ///< PCMSKn of each column
+static uint8_t s_wakeBit[KEYPAD_COLS];              ///< Column bit in PCMSKn
+
+/** @brief Mask every column's pin-change interrupt. */
+static void maskWake() {
+    for (uint8_t c = 0; c < KEYPAD_COLS; c++) {
+        if (s_wakeMask[c] != NULL) {
+            *s_wakeMask[c] &= (uint8_t)~s_wakeBit[c];
+        }
+    }
+}
+
+ISR(PCINT0_vect) {
+    KERNEL_TRACE_ISR(KERNEL_TRACE_ISR_KEYPAD);
+    maskWake();                      // One shot: scanning toggles the lines
+    if (s_onWake != NULL) {
+        WakeCallback cb = s_onWake;
+        s_onWake = NULL;
+        cb(s_onWakeArg);
+    }
+}
+#if defined(PCINT1_vect)
+ISR(PCINT1_vect, ISR_ALIASOF(PCINT0_vect));
+#endif
+#if defined(PCINT2_vect)
+ISR(PCINT2_vect, ISR_ALIASOF(PCINT0_vect));
+#endif
+#endif
+
+KeypadInput::KeypadInput(byte *rowPins, byte *colPins)
+    : _rowPins(rowPins),
+      _colPins(colPins),
+      _state(0),
+      _raw(0),
+      _rawChangeMs(0),
+      _wakeArmed(false) {}
+
+/** @brief Resolve the port registers of an Arduino pin. */
+static void resolvePin(uint8_t pin, volatile uint8_t **in, volatile uint8_t **out,
+                       volatile uint8_t **ddr, uint8_t *mask) {
+#if defined(__AVR__)
+    uint8_t port = digitalPinToPort(pin);
+    *in   = portInputRegister(port);
+    *out  = portOutputRegister(port);
+    *ddr  = portModeRegister(port);
+    *mask = digitalPinToBitMask(pin);
+#else
+    (void)pin;
+    *in = NULL;
+    *out = NULL;
+    *ddr = NULL;
+    *mask = 0;
+#endif
+}
+
+void KeypadInput::init() {
+    for (uint8_t r = 0; r < KEYPAD_ROWS; r++) {
+        resolvePin(_rowPins[r], &_rows[r].in, &_rows[r].out, &_rows[r].ddr, &_rows[r].mask);
+        digitalWrite(_rowPins[r], LOW);  // Also detaches a PWM timer output
+    }
+    for (uint8_t c = 0; c < KEYPAD_COLS; c++) {
+        resolvePin(_colPins[c], &_cols[c].in, &_cols[c].out, &_cols[c].ddr, &_cols[c].mask);
+        pinMode(_colPins[c], INPUT_PULLUP);
+    }
+    _state = 0;
+    _raw = 0;
+    _rawChangeMs = millis();
+    _fifo.clear();
+    driveAllRows();
+}
+
+void KeypadInput::driveAllRows() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t r = 0; r < KEYPAD_ROWS; r++) {
+            *_rows[r].out &= (uint8_t)~_rows[r].mask;
+            *_rows[r].ddr |= _rows[r].mask;
+        }
+    }
+}
+
+uint16_t KeypadInput::readMatrix() {
+    uint16_t bits = 0;
+
+    // Release every row (input, no pull-up), then drive one at a time.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t r = 0; r < KEYPAD_ROWS; r++) {
+            *_rows[r].ddr &= (uint8_t)~_rows[r].mask;
+            *_rows[r].out &= (uint8_t)~_rows[r].mask;
+        }
+    }
+    for (uint8_t r = 0; r < KEYPAD_ROWS; r++) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            *_rows[r].ddr |= _rows[r].mask;
+        }
+        delayMicroseconds(5);            // Let the pulled-up columns settle
+
+        for (uint8_t c = 0; c < KEYPAD_COLS; c++) {
+            if ((*_cols[c].in & _cols[c].mask) == 0) {
+                bits |= (uint16_t)(1U << (r * KEYPAD_COLS + c));
+            }
+        }
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            *_rows[r].ddr &= (uint8_t)~_rows[r].mask;
+        }
+    }
+
+    driveAllRows();
+    return bits;
+}
+
+/** @brief True if two rows share two columns (possible ghost key). */
+static bool hasRectangle(uint16_t bits) {
+    for (uint8_t a = 0; a < KEYPAD_ROWS; a++) {
+        uint8_t rowA = (uint8_t)((bits >> (a * KEYPAD_COLS)) & 0x0F);
+        for (uint8_t b = a + 1; b < KEYPAD_ROWS; b++) {
+            uint8_t common = (uint8_t)(rowA & (bits >> (b * KEYPAD_COLS)) & 0x0F);
+            if (common & (uint8_t)(common - 1)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool KeypadInput::scan() {
+    disarmWake();
+
+    uint32_t now = millis();
+    uint16_t raw = readMatrix();
+    if (raw != _raw) {
+        _raw = raw;
+        _rawChangeMs = now;
+    }
+
+    if (_raw != _state && (uint32_t)(now - _rawChangeMs) >= KEYPAD_DEBOUNCE_MS &&
+        !hasRectangle(_raw)) {
+        uint16_t pressed = (uint16_t)(_raw & ~_state);
+        _state = _raw;
+        for (uint8_t i = 0; i < KEYPAD_ROWS * KEYPAD_COLS; i++) {
+            if (pressed & (uint16_t)(1U << i)) {
+                push(keymap[i / KEYPAD_COLS][i % KEYPAD_COLS]);
+            }
+        }
+    }
+
+    return _raw != 0 || _state != 0;
+}
+
+bool KeypadInput::armWake(WakeCallback onWake, void *arg) {
+#if defined(KEYPAD_HAS_PCINT)
+    if (_raw != 0 || _state != 0) {
+        return false;
+    }
+    for (uint8_t c = 0; c < KEYPAD_COLS; c++) {
+        if (digitalPinToPCICR(_colPins[c]) == NULL) {
+            return false;
+        }
+    }
+
+    driveAllRows();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_onWake = onWake;
+        s_onWakeArg = arg;
+        for (uint8_t c = 0; c < KEYPAD_COLS; c++) {
+            uint8_t pin = _colPins[c];
+            s_wakeMask[c] = digitalPinToPCMSK(pin);
+            s_wakeBit[c]  = (uint8_t)_BV(digitalPinToPCMSKbit(pin));
+            PCIFR = (uint8_t)_BV(digitalPinToPCICRbit(pin));   // Drop stale flags
+            *s_wakeMask[c] |= s_wakeBit[c];
+            *digitalPinToPCICR(pin) |= (uint8_t)_BV(digitalPinToPCICRbit(pin));
+        }
+        _wakeArmed = true;
+    }
+
+    // A press between the last scan and arming raised no edge: check now.
+    for (uint8_t c = 0; c < KEYPAD_COLS; c++) {
+        if ((*_cols[c].in & _cols[c].mask) == 0) {
+            disarmWake();
+            return false;
+        }
+    }
+    return true;
+#else
+    (void)onWake;
+    (void)arg;
+    return false;
+#endif
+}
+
+void KeypadInput::disarmWake() {
+#if defined(KEYPAD_HAS_PCINT)
+    if (!_wakeArmed) {
+        return;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        maskWake();
+        s_onWake = NULL;
+        _wakeArmed = false;
+    }
+#endif
 }
+#endif
@@ -2,8 +2,8 @@
  * @file KeypadInput.h
  * @brief 4x4 Matrix Keypad Driver Interface
  *
- * Provides a reusable abstraction for a 4x4 membrane matrix keypad.
- * Wraps the Keypad library and includes built-in debouncing.
+ * Provides a reusable abstraction for a 4x4 membrane matrix keypad with
+ * built-in debouncing and a small FIFO of pressed keys.
  *
  * The standard 4x4 layout is:
  *   1 2 3 A
@@ -11,19 +11,45 @@
  *   7 8 9 C
  *   * 0 # D
  *
+ * Backends:
+ *   - Default: wraps the Keypad library (pinMode/digitalRead scanning).
+ *   - -DKEYPAD_INPUT_DIRECT: scans through the port registers directly.
+ *     Rows are driven one at a time, all columns are read with one load
+ *     per port, keys are debounced independently (n-key rollover; a
+ *     rectangle of four keys, which a diode-less matrix cannot tell from
+ *     three, freezes the state until it resolves) and new presses are
+ *     queued in row-major order. While no key is down all rows are held
+ *     LOW, so any press pulls a column LOW: when every column pin has a
+ *     pin-change interrupt (Mega: D10–13, D50–53, A8–A15), armWake()
+ *     enables it and a press wakes the application instead of a polling
+ *     loop. The PCINT vectors are defined by this driver unless built
+ *     with -DKEYPAD_INPUT_NO_PCINT_ISR (they are shared with Button's
+ *     PCINT mode: use one or the other per build).
+ *
+ * Both backends offer the same API; see KeypadInputRtos.h for a FreeRTOS
+ * wait that sleeps until a key is available.
+ *
  * Usage:
  *   byte rows[] = {22, 23, 24, 25};
  *   byte cols[] = {26, 27, 28, 29};
  *   KeypadInput kp(rows, cols);
  *   kp.init();
  *   char key = kp.getKey(); // 0 if no key pressed
+ *
+ *   // FIFO style: scan every KEYPAD_SCAN_PERIOD_MS while scan() is true.
+ *   kp.scan();
+ *   while (kp.readKey(&key)) { ... }
  */
 
 #ifndef KEYPAD_INPUT_H
 #define KEYPAD_INPUT_H
 
 #include <Arduino.h>
+#if !defined(KEYPAD_INPUT_DIRECT)
 #include <Keypad.h>
+#endif
+
+#include "SpscRing.h"
 
 /// Number of rows in the 4x4 matrix keypad
 static const byte KEYPAD_ROWS = 4;
@@ -31,16 +57,33 @@ static const byte KEYPAD_ROWS = 4;
 /// Number of columns in the 4x4 matrix keypad
 static const byte KEYPAD_COLS = 4;
 
+/** @brief Debounce time (ms): a key state must hold this long. */
+#define KEYPAD_DEBOUNCE_MS 20
+
+/** @brief Scan period (ms) while a key is down or being debounced. */
+#define KEYPAD_SCAN_PERIOD_MS 10
+
+/**
+ * @brief Pressed keys buffered until read (power of two, 2..128).
+ * Override with -DKEYPAD_FIFO_SIZE=<n>.
+ */
+#ifndef KEYPAD_FIFO_SIZE
+#define KEYPAD_FIFO_SIZE 8
+#endif
+
 /**
  * @class KeypadInput
  * @brief Controls a 4x4 matrix keypad with debouncing.
  *
- * Encapsulates a standard 4x4 membrane keypad using the Keypad library.
- * The key layout is fixed to the standard telephone/security keypad layout.
- * Pin assignments are configurable via the constructor.
+ * Encapsulates a standard 4x4 membrane keypad. The key layout is fixed to
+ * the standard telephone/security keypad layout. Pin assignments are
+ * configurable via the constructor.
  */
 class KeypadInput {
 public:
+    /** @brief Wake callback, run in interrupt context (see armWake()). */
+    typedef void (*WakeCallback)(void *arg);
+
     /**
      * @brief Construct a new KeypadInput object.
      * @param rowPins Array of 4 GPIO pin numbers for keypad rows.
@@ -53,22 +96,85 @@ public:
     /**
      * @brief Initialize the keypad with debounce settings.
      *
-     * Sets the debounce time to 20ms for reliable membrane keypad operation.
+     * Sets the debounce time to KEYPAD_DEBOUNCE_MS (20 ms) for reliable
+     * membrane keypad operation.
      */
     void init();
 
     /**
      * @brief Read a key press from the keypad (non-blocking).
      *
-     * Scans the key matrix and returns the pressed key character.
-     * Returns 0 (null character) if no key is currently pressed.
+     * Scans the key matrix and returns the oldest newly pressed key.
+     * Returns 0 (null character) if there is none.
      *
      * @return The character of the pressed key, or 0 if none.
      */
     char getKey();
 
+    /**
+     * @brief Scan the matrix once; queue newly pressed keys.
+     * @return true while a key is down or a change is being debounced,
+     *         i.e. scan() should be called again after
+     *         KEYPAD_SCAN_PERIOD_MS; false when the keypad is idle.
+     */
+    bool scan();
+
+    /**
+     * @brief Pop the oldest queued key.
+     * @param key Receives the key character.
+     * @return true if a key was returned.
+     */
+    bool readKey(char *key);
+
+    /**
+     * @brief Arm the column pin-change interrupt (keypad idle).
+     *
+     * On the next press the interrupt disarms itself and runs onWake.
+     * Scan again after waking (disarmWake() is implied by scan()).
+     *
+     * @return false if the backend or the column pins do not support it,
+     *         or a key is still down; the caller then keeps polling.
+     */
+    bool armWake(WakeCallback onWake, void *arg);
+
+    /** @brief Disable the wake interrupt. */
+    void disarmWake();
+
+    /** @brief Keys lost to a full FIFO (saturates). */
+    uint16_t getDroppedKeys() const;
+
 private:
+    /** @brief Queue a key (drops it if the FIFO is full). */
+    void push(char key);
+
+    SpscRing<char, KEYPAD_FIFO_SIZE> _fifo;  ///< Pressed keys, scan() → readKey()
+
+#if defined(KEYPAD_INPUT_DIRECT)
+    /** @brief Port registers and bit of one matrix pin. */
+    typedef struct {
+        volatile uint8_t *in;
+        volatile uint8_t *out;
+        volatile uint8_t *ddr;
+        uint8_t mask;
+    } PinIo_t;
+
+    /** @brief Drive every row LOW (idle / wake state). */
+    void driveAllRows();
+
+    /** @brief Raw 16-bit key bitmap (bit = row * 4 + col). */
+    uint16_t readMatrix();
+
+    byte    *_rowPins;
+    byte    *_colPins;
+    PinIo_t  _rows[KEYPAD_ROWS];
+    PinIo_t  _cols[KEYPAD_COLS];
+    uint16_t _state;                   ///< Debounced key bitmap
+    uint16_t _raw;                     ///< Last raw bitmap
+    uint32_t _rawChangeMs;             ///< millis() of the last raw change
+    bool     _wakeArmed;
+#else
     Keypad _keypad;  ///< Underlying Keypad library instance
+#endif
 };
 
 #endif // KEYPAD_INPUT_H
@@ -0,0 +1,115 @@
+/**
+ * @file KeypadInputRtos.h
+ * @brief Blocking Keypad Read for FreeRTOS Tasks
+ *
+ * keypadInputWaitKey() returns the next key from the KeypadInput FIFO,
+ * sleeping the calling task in between:
+ *   - while a key is down (or being debounced) it scans every
+ *     KEYPAD_SCAN_PERIOD_MS (at least one tick);
+ *   - when the keypad is idle and the column pins support it (direct
+ *     backend), it arms the pin-change wake and blocks on its task
+ *     notification: no CPU time is spent until a key is pressed;
+ *   - otherwise it checks the idle keypad every KEYPAD_IDLE_POLL_MS.
+ *
+ * Header-only so that labs without FreeRTOS never see the dependency.
+ *
+ * Usage:
+ *   char key;
+ *   if (keypadInputWaitKey(s_keypad, &key, portMAX_DELAY)) { ... }
+ *
+ *   char key = keypadInputGetKey(s_keypad, pdMS_TO_TICKS(5000));  // 0 on timeout
+ */
+
+#ifndef KEYPAD_INPUT_RTOS_H
+#define KEYPAD_INPUT_RTOS_H
+
+#include "RtosTick.h"
+#include "KeypadInput.h"
+
+/** @brief Idle re-check period (ms) when no wake interrupt is available. */
+#ifndef KEYPAD_IDLE_POLL_MS
+#define KEYPAD_IDLE_POLL_MS 50
+#endif
+
+/** @brief Wake callback: notify the task passed as arg (ISR context). */
+inline void keypadInputNotifyFromIsr(void *arg) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)arg, &woken);
+    (void)woken;
+}
+
+/** @brief At least one tick. */
+inline TickType_t keypadInputTicks(uint16_t ms) {
+    TickType_t ticks = pdMS_TO_TICKS(ms);
+    return ticks > 0 ? ticks : 1;
+}
+
+/**
+ * @brief Wait for the next pressed key.
+ *
+ * Uses the calling task's notification value as its wake-up signal; do
+ * not combine with other notification-based protocols on the same task.
+ *
+ * @param keypad  Initialized keypad.
+ * @param key     Receives the key.
+ * @param timeout Maximum wait in ticks (portMAX_DELAY = forever).
+ * @return true if a key was returned; false on timeout.
+ */
+inline bool keypadInputWaitKey(KeypadInput &keypad, char *key, TickType_t timeout) {
+    TickType_t start = xTaskGetTickCount();
+
+    for (;;) {
+        bool active = keypad.scan();
+        if (keypad.readKey(key)) {
+            return true;
+        }
+
+        TickType_t wait;
+        if (active) {
+            wait = keypadInputTicks(KEYPAD_SCAN_PERIOD_MS);
+        } else {
+            ulTaskNotifyTake(pdTRUE, 0);  // Drop a stale notification
+            if (keypad.armWake(keypadInputNotifyFromIsr, xTaskGetCurrentTaskHandle())) {
+                wait = portMAX_DELAY;
+            } else {
+                wait = keypadInputTicks(KEYPAD_IDLE_POLL_MS);
+            }
+        }
+
+        if (timeout != portMAX_DELAY) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= timeout) {
+                keypad.disarmWake();
+                return false;
+            }
+            if (wait == portMAX_DELAY || wait > timeout - elapsed) {
+                wait = timeout - elapsed;
+            }
+        }
+
+        if (active) {
+            vTaskDelay(wait);
+        } else {
+            ulTaskNotifyTake(pdTRUE, wait);   // Woken early by a press
+        }
+    }
+}
+
+/**
+ * @brief Blocking counterpart of KeypadInput::getKey().
+ *
+ * Same wait as keypadInputWaitKey(), with getKey()'s return convention.
+ *
+ * @param keypad  Initialized keypad.
+ * @param timeout Maximum wait in ticks (portMAX_DELAY = forever).
+ * @return char The key, or 0 on timeout.
+ */
+inline char keypadInputGetKey(KeypadInput &keypad, TickType_t timeout) {
+    char key = 0;
+    if (!keypadInputWaitKey(keypad, &key, timeout)) {
+        return 0;
+    }
+    return key;
+}
+
+#endif // KEYPAD_INPUT_RTOS_H
@@ -0,0 +1,350 @@
+/**
+ * @file LatencyLoopback.cpp
+ * @brief Output-Compare / Input-Capture Latency Loopback Implementation
+ *
+ * Timer setup (n = LATENCY_LOOPBACK_TIMER):
+ *   TCCRnA = COMnA1 (+ COMnA0)   normal mode; OCnA cleared (set) at the match
+ *   TCCRnB = ICNCn | CSn1        noise canceler, ÷8 (+ ICESn: rising)
+ *   TIMSKn = TOIEn (+ OCIEnA while a stimulus edge is armed,
+ *                   + ICIEn while its response is awaited)
+ *
+ * The overflow ISR counts timer periods and steps the cycle: it arms the
+ * next stimulus edge at a random count of the coming period. The compare
+ * ISR takes the stimulus time, the capture ISR the response time. The
+ * capture vector has priority over the compare vector, so a response
+ * faster than the compare ISR finds OCFnA still set and takes the
+ * stimulus time itself. A count latched just after a wrap whose overflow
+ * interrupt has not run yet is recognized by TOVn still set and a small
+ * count (as in PressCapture).
+ */
+
+#include "LatencyLoopback.h"
+
+#if defined(LATENCY_PROBE_ENABLED) && defined(__AVR__)
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Timer register selection
+// ──────────────────────────────────────────────────────────────────────────
+
+#if LATENCY_LOOPBACK_TIMER == 4
+#define LL_TCCRA   TCCR4A
+#define LL_TCCRB   TCCR4B
+#define LL_TCCRC   TCCR4C
+#define LL_TCNT    TCNT4
+#define LL_ICR     ICR4
+#define LL_OCRA    OCR4A
+#define LL_TIMSK   TIMSK4
+#define LL_TIFR    TIFR4
+#define LL_COM1    COM4A1
+#define LL_COM0    COM4A0
+#define LL_FOCA    FOC4A
+#define LL_ICNC    ICNC4
+#define LL_ICES    ICES4
+#define LL_CS1     CS41
+#define LL_ICIE    ICIE4
+#define LL_OCIEA   OCIE4A
+#define LL_TOIE    TOIE4
+#define LL_ICF     ICF4
+#define LL_OCFA    OCF4A
+#define LL_TOV     TOV4
+#define LL_PRTIM   PRTIM4
+#define LL_CAPT_vect  TIMER4_CAPT_vect
+#define LL_COMPA_vect TIMER4_COMPA_vect
+#define LL_OVF_vect   TIMER4_OVF_vect
+#define LL_STIM_DDR   DDRH
+#define LL_STIM_MASK  _BV(PH3)
+#define LL_RESP_PIN   PINL
+#define LL_RESP_MASK  _BV(PL0)
+#else
+#define LL_TCCRA   TCCR5A
+#define LL_TCCRB   TCCR5B
+#define LL_TCCRC   TCCR5C
+#define LL_TCNT    TCNT5
+#define LL_ICR     ICR5
+#define LL_OCRA    OCR5A
+#define LL_TIMSK   TIMSK5
+#define LL_TIFR    TIFR5
+#define LL_COM1    COM5A1
+#define LL_COM0    COM5A0
+#define LL_FOCA    FOC5A
+#define LL_ICNC    ICNC5
+#define LL_ICES    ICES5
+#define LL_CS1     CS51
+#define LL_ICIE    ICIE5
+#define LL_OCIEA   OCIE5A
+#define LL_TOIE    TOIE5
+#define LL_ICF     ICF5
+#define LL_OCFA    OCF5A
+#define LL_TOV     TOV5
+#define LL_PRTIM   PRTIM5
+#define LL_CAPT_vect  TIMER5_CAPT_vect
+#define LL_COMPA_vect TIMER5_COMPA_vect
+#define LL_OVF_vect   TIMER5_OVF_vect
+#define LL_STIM_DDR   DDRL
+#define LL_STIM_MASK  _BV(PL3)
+#define LL_RESP_PIN   PINL
+#define LL_RESP_MASK  _BV(PL1)
+#endif
+
+/** Earliest and latest stimulus count in a period (ISR latency margins). */
+static const uint16_t ARM_FIRST = 0x0800;
+static const uint16_t ARM_SPAN  = 0xF000;
+
+// ──────────────────────────────────────────────────────────────────────────
+// State
+// ──────────────────────────────────────────────────────────────────────────
+
+enum LoopbackState {
+    LB_OFF,        ///< Timer released.
+    LB_IDLE,       ///< Released, counting down the period.
+    LB_ARMED,      ///< Stimulus edge armed on the compare unit.
+    LB_RESPONSE,   ///< Stimulus out, waiting for the capture (or the timeout).
+    LB_HOLD,       ///< Responded, counting down the hold time.
+    LB_RELEASING   ///< Release edge armed on the compare unit.
+};
+
+static volatile uint8_t  s_state = LB_OFF;
+static volatile uint16_t s_overflows = 0;   ///< High half of the 32-bit count.
+static uint16_t s_countdown = 0;            ///< Timer periods to the next step (ISRs).
+static uint16_t s_periodOvf = 1;
+static uint16_t s_holdOvf = 1;
+static uint16_t s_timeoutOvf = 1;
+static bool     s_activeLow = true;
+static uint32_t s_stimulus = 0;             ///< 32-bit count of the stimulus edge.
+static uint16_t s_random = 0xACE1;
+
+static LatencyLoopbackStats s_stats;
+
+/** @brief ms → timer periods (4096 / 125 ms each), rounded up, at least 1. */
+static uint16_t msToPeriods(uint16_t ms) {
+    uint32_t periods = ((uint32_t)ms * 125UL + 4095UL) / 4096UL;
+    return periods > 0 ? (uint16_t)periods : 1;
+}
+
+/** @brief xorshift16: phase of the next stimulus inside its period. */
+static uint16_t nextRandom() {
+    s_random ^= (uint16_t)(s_random << 7);
+    s_random ^= (uint16_t)(s_random >> 9);
+    s_random ^= (uint16_t)(s_random << 8);
+    return s_random;
+}
+
+/** @brief Count → 32 bits with the overflows (TOVn pending: wrap not yet counted). */
+static inline uint32_t extend(uint16_t count) {
+    uint16_t high = s_overflows;
+    if ((LL_TIFR & _BV(LL_TOV)) && count < 0x8000) {
+        high++;
+    }
+    return ((uint32_t)high << 16) | count;
+}
+
+/** @brief What the next compare match does to OCnA: the active or the idle level. */
+static inline void stimulusMode(bool active) {
+    bool low = (active == s_activeLow);
+    uint8_t a = LL_TCCRA & (uint8_t)~(_BV(LL_COM1) | _BV(LL_COM0));
+    LL_TCCRA = low ? (uint8_t)(a | _BV(LL_COM1)) : (uint8_t)(a | _BV(LL_COM1) | _BV(LL_COM0));
+}
+
+/** @brief Capture the edge leaving the response pin's current level; clear a stale flag. */
+static inline void selectResponseEdge() {
+    if (LL_RESP_PIN & LL_RESP_MASK) {
+        LL_TCCRB &= (uint8_t)~_BV(LL_ICES);       // High now: wait for the falling edge
+    } else {
+        LL_TCCRB |= _BV(LL_ICES);
+    }
+    LL_TIFR = _BV(LL_ICF);                        // Required after changing ICES
+}
+
+/** @brief Arm the stimulus (or its release) at a random count of this period. */
+static void arm(bool active) {
+    stimulusMode(active);
+    LL_OCRA = (uint16_t)(ARM_FIRST + nextRandom() % ARM_SPAN);
+    LL_TIFR = _BV(LL_OCFA);
+    if (active) {
+        selectResponseEdge();
+        LL_TIMSK |= _BV(LL_ICIE);
+    }
+    LL_TIMSK |= _BV(LL_OCIEA);
+    s_state = active ? LB_ARMED : LB_RELEASING;
+}
+
+/** @brief The stimulus edge is out: start the timeout. */
+static inline void stimulusSent() {
+    LL_TIMSK &= (uint8_t)~_BV(LL_OCIEA);
+    s_stimulus = extend(LL_OCRA);
+    s_state = LB_RESPONSE;
+    s_countdown = s_timeoutOvf;
+}
+
+static void clearStats() {
+    s_stats.count = 0;
+    s_stats.lost = 0;
+    s_stats.minTicks = UINT32_MAX;
+    s_stats.maxTicks = 0;
+    s_stats.sumTicks = 0;
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BINS; i++) {
+        s_stats.us.bins[i] = 0;
+    }
+    s_stats.us.max = 0;
+}
+
+static void record(uint32_t ticks) {
+    s_stats.count++;
+    if (ticks < s_stats.minTicks) {
+        s_stats.minTicks = ticks;
+    }
+    if (ticks > s_stats.maxTicks) {
+        s_stats.maxTicks = ticks;
+    }
+    s_stats.sumTicks += ticks;
+    perfRecord(&s_stats.us, ticks / LATENCY_LOOPBACK_TICKS_PER_US);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Interrupts
+// ──────────────────────────────────────────────────────────────────────────
+
+ISR(LL_CAPT_vect) {
+    uint32_t at = extend(LL_ICR);
+    if (s_state == LB_ARMED) {
+        if (!(LL_TIFR & _BV(LL_OCFA))) {
+            selectResponseEdge();                 // Before the stimulus: not a response
+            return;
+        }
+        LL_TIFR = _BV(LL_OCFA);                   // Compare ISR not run yet: do its part
+        stimulusSent();
+    }
+    if (s_state != LB_RESPONSE) {
+        return;
+    }
+    uint32_t ticks = at - s_stimulus;
+    if (ticks & 0x80000000UL) {
+        selectResponseEdge();                     // Latched before the stimulus edge
+        return;
+    }
+    LL_TIMSK &= (uint8_t)~_BV(LL_ICIE);
+    record(ticks);
+    s_state = LB_HOLD;
+    s_countdown = s_holdOvf;
+}
+
+ISR(LL_COMPA_vect) {
+    if (s_state == LB_ARMED) {
+        stimulusSent();
+    } else if (s_state == LB_RELEASING) {
+        LL_TIMSK &= (uint8_t)~_BV(LL_OCIEA);
+        s_state = LB_IDLE;
+        s_countdown = s_periodOvf;
+    }
+}
+
+ISR(LL_OVF_vect) {
+    s_overflows++;
+    if (s_countdown == 0 || --s_countdown != 0) {
+        return;
+    }
+    switch (s_state) {
+        case LB_IDLE:
+            arm(true);
+            break;
+        case LB_RESPONSE:
+            LL_TIMSK &= (uint8_t)~_BV(LL_ICIE);
+            if (s_stats.lost < 0xFFFF) {
+                s_stats.lost++;
+            }
+            arm(false);
+            break;
+        case LB_HOLD:
+            arm(false);
+            break;
+        default:
+            break;
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool latencyLoopbackBegin(uint16_t periodMs, uint16_t holdMs, bool activeLow) {
+    if (periodMs == 0 || holdMs == 0) {
+        return false;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        PRR1 &= (uint8_t)~_BV(LL_PRTIM);          // IdleSleep may have gated it
+        LL_TIMSK = 0;
+        LL_TCCRB = 0;
+        s_activeLow = activeLow;
+        s_periodOvf = msToPeriods(periodMs);
+        s_holdOvf = msToPeriods(holdMs);
+        s_timeoutOvf = (uint16_t)(msToPeriods(LATENCY_LOOPBACK_TIMEOUT_MS) + 1);
+
+        stimulusMode(false);
+        LL_TCCRC = _BV(LL_FOCA);                  // OCnA takes the idle level now
+        LL_STIM_DDR |= LL_STIM_MASK;
+
+        LL_TCNT = 0;
+        s_overflows = 0;
+        clearStats();
+        s_state = LB_IDLE;
+        s_countdown = s_periodOvf;
+        LL_TIFR = _BV(LL_TOV) | _BV(LL_OCFA) | _BV(LL_ICF);
+        LL_TIMSK = _BV(LL_TOIE);
+        LL_TCCRB = _BV(LL_ICNC) | _BV(LL_CS1);
+    }
+    return true;
+}
+
+void latencyLoopbackStop() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (s_state == LB_OFF) {
+            return;
+        }
+        LL_TIMSK = 0;
+        stimulusMode(false);
+        LL_TCCRC = _BV(LL_FOCA);                  // Released; OCnA keeps driving it
+        LL_TCCRB = 0;
+        s_state = LB_OFF;
+    }
+}
+
+bool latencyLoopbackRunning() {
+    return s_state != LB_OFF;
+}
+
+void latencyLoopbackClear() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        clearStats();
+    }
+}
+
+void latencyLoopbackSnapshot(LatencyLoopbackStats *out) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        *out = s_stats;
+    }
+}
+
+#else  // !(LATENCY_PROBE_ENABLED && __AVR__)
+
+bool latencyLoopbackBegin(uint16_t, uint16_t, bool) { return false; }
+void latencyLoopbackStop() {}
+bool latencyLoopbackRunning() { return false; }
+void latencyLoopbackClear() {}
+
+void latencyLoopbackSnapshot(LatencyLoopbackStats *out) {
+    out->count = 0;
+    out->lost = 0;
+    out->minTicks = UINT32_MAX;
+    out->maxTicks = 0;
+    out->sumTicks = 0;
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BINS; i++) {
+        out->us.bins[i] = 0;
+    }
+    out->us.max = 0;
+}
+
+#endif // LATENCY_PROBE_ENABLED && __AVR__
@@ -0,0 +1,114 @@
+/**
+ * @file LatencyLoopback.h
+ * @brief Stimulus-to-Response Latency by Timer Output Compare and Input Capture
+ *
+ * The markers of LatencyProbe.h start at the first instruction that sees
+ * the event; the debounce, the scan period and the pin-change wake come
+ * before it. The loopback measures the whole path from outside, with one
+ * 16-bit timer and two jumper wires:
+ *
+ *   OCnA (stimulus) ──► lab input (button pin, keypad key via a transistor)
+ *   lab output (LED, LATENCY_PROBE_RESPONSE_PIN) ──► ICPn (response)
+ *
+ * The output-compare unit drives the stimulus edge in hardware at a known
+ * count; the input-capture unit latches the count of the first response
+ * edge. Their difference is the latency at 0.5 µs resolution (÷8, 32-bit
+ * with the overflow count), unaffected by interrupt latency or by the
+ * code under test; the ~0.3 µs of the capture noise canceler is included.
+ *
+ * One cycle: stimulus (active) → response edge or timeout → hold →
+ * stimulus released → period → next stimulus. The response edge is the
+ * one opposite to the response pin's level when the stimulus is armed,
+ * so a toggling output (lab 6.1's LED) works as well as a momentary one.
+ * Each stimulus lands at a pseudo-random phase inside a timer period, so
+ * the samples spread over the task periods instead of locking to them.
+ * Scheduling is in timer periods (32.768 ms): period and hold are rounded
+ * up to whole periods.
+ *
+ * Timer and pins (Arduino Mega 2560), select with -DLATENCY_LOOPBACK_TIMER:
+ *   5 (default) → stimulus OC5A = D46, response ICP5 = D48
+ *   4           → stimulus OC4A = D6,  response ICP4 = D49
+ * The timer is taken over while the loopback runs (its PWM pins and any
+ * other user of its vectors, e.g. PressCapture or PcProfiler on the same
+ * timer, must stay off) and released by latencyLoopbackStop().
+ *
+ * Built only with -DLATENCY_PROBE_ENABLED on the AVR; otherwise begin()
+ * returns false.
+ *
+ * Usage:
+ *   latencyLoopbackBegin(250, 100);          // press every ~0.35 s, hold 0.1 s
+ *   ...
+ *   LatencyLoopbackStats stats;
+ *   latencyLoopbackSnapshot(&stats);
+ *   printf("%lu us\r\n", stats.maxTicks / LATENCY_LOOPBACK_TICKS_PER_US);
+ */
+
+#ifndef LATENCY_LOOPBACK_H
+#define LATENCY_LOOPBACK_H
+
+#include <stdint.h>
+
+#include "PerfCounter.h"
+
+/** @brief Timer used for the stimulus and the capture (4 or 5). */
+#ifndef LATENCY_LOOPBACK_TIMER
+#define LATENCY_LOOPBACK_TIMER 5
+#endif
+
+#if LATENCY_LOOPBACK_TIMER == 4
+#define LATENCY_LOOPBACK_STIMULUS_PIN 6    /**< OC4A (PH3). */
+#define LATENCY_LOOPBACK_RESPONSE_PIN 49   /**< ICP4 (PL0). */
+#elif LATENCY_LOOPBACK_TIMER == 5
+#define LATENCY_LOOPBACK_STIMULUS_PIN 46   /**< OC5A (PL3). */
+#define LATENCY_LOOPBACK_RESPONSE_PIN 48   /**< ICP5 (PL1). */
+#else
+#error "LATENCY_LOOPBACK_TIMER must be 4 or 5"
+#endif
+
+/** @brief Timer counts per microsecond (16 MHz / 8). */
+#define LATENCY_LOOPBACK_TICKS_PER_US 2
+
+/** @brief A stimulus without a response edge within this time counts as lost (ms). */
+#ifndef LATENCY_LOOPBACK_TIMEOUT_MS
+#define LATENCY_LOOPBACK_TIMEOUT_MS 1000
+#endif
+
+/**
+ * @struct LatencyLoopbackStats
+ * @brief Responses measured since the last clear.
+ */
+struct LatencyLoopbackStats {
+    uint32_t      count;     ///< Responses measured.
+    uint16_t      lost;      ///< Stimuli that timed out (saturates).
+    uint32_t      minTicks;  ///< Shortest latency (timer counts; UINT32_MAX if none).
+    uint32_t      maxTicks;  ///< Longest latency.
+    uint64_t      sumTicks;  ///< For the mean.
+    PerfHistogram us;        ///< log2 histogram of the latencies in µs.
+};
+
+/**
+ * @brief Take over the timer and start the stimulus cycle.
+ *
+ * Clears the statistics. The stimulus pin idles at the inactive level.
+ *
+ * @param periodMs  Released time before the next stimulus (≥ 1).
+ * @param holdMs    Active time left after the response (≥ 1), e.g. longer
+ *                  than a button debounce window.
+ * @param activeLow The stimulus pulls the input low (a button to GND).
+ * @return false for a zero time or without the loopback in the build.
+ */
+bool latencyLoopbackBegin(uint16_t periodMs, uint16_t holdMs, bool activeLow = true);
+
+/** @brief Release the stimulus and stop the timer; the statistics are kept. */
+void latencyLoopbackStop();
+
+/** @brief The stimulus cycle is running. */
+bool latencyLoopbackRunning();
+
+/** @brief Zero the statistics (the cycle keeps running). */
+void latencyLoopbackClear();
+
+/** @brief Consistent copy of the statistics. */
+void latencyLoopbackSnapshot(LatencyLoopbackStats *out);
+
+#endif // LATENCY_LOOPBACK_H
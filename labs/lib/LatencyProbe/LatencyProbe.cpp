@@ -0,0 +1,171 @@
+/**
+ * @file LatencyProbe.cpp
+ * @brief End-to-End Latency Markers Implementation
+ *
+ * Implements:
+ * - The path markers: the stimulus time is read and written with
+ *   interrupts masked (32 bits), the elapsed time goes to perfRecord()
+ * - The stage registry report and clear, with the loopback statistics
+ * - The "lat" command handlers
+ */
+
+#include "LatencyProbe.h"
+#include "LatencyLoopback.h"
+#include "FlashString.h"
+#include <Arduino.h>
+#include <stdio.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Markers
+// ──────────────────────────────────────────────────────────────────────────
+
+static const PerfDesc *s_table = NULL;
+static uint8_t s_count = 0;
+
+void latencyStartAt(LatencyPath *path, uint32_t us) {
+    PERF_ATOMIC {
+        path->startUs = us;
+        path->open = true;
+    }
+}
+
+void latencyStart(LatencyPath *path) {
+    latencyStartAt(path, micros());
+}
+
+/** @brief Time since the stimulus; false if the path is not open. */
+static bool elapsedUs(LatencyPath *path, bool close, uint32_t *us) {
+    uint32_t now = micros();
+    bool open;
+    uint32_t start;
+    PERF_ATOMIC {
+        open = path->open;
+        start = path->startUs;
+        if (close) {
+            path->open = false;
+        }
+    }
+    *us = now - start;
+    return open;
+}
+
+void latencyStage(LatencyPath *path, PerfHistogram *hist) {
+    uint32_t us;
+    if (elapsedUs(path, false, &us)) {
+        perfRecord(hist, us);
+    }
+}
+
+void latencyEnd(LatencyPath *path, PerfHistogram *hist) {
+    uint32_t us;
+    if (elapsedUs(path, true, &us)) {
+#if defined(LATENCY_PROBE_ENABLED) && defined(LATENCY_PROBE_RESPONSE_PIN)
+        FastPin<LATENCY_PROBE_RESPONSE_PIN>::toggle();
+#endif
+        perfRecord(hist, us);
+    }
+}
+
+void latencyProbeInit(const PerfDesc *table, uint8_t count) {
+    s_table = table;
+    s_count = count;
+#if defined(LATENCY_PROBE_ENABLED) && defined(LATENCY_PROBE_RESPONSE_PIN)
+    FastPin<LATENCY_PROBE_RESPONSE_PIN>::low();
+    FastPin<LATENCY_PROBE_RESPONSE_PIN>::output();
+#endif
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Report
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Timer counts as "<µs>.<tenths>". */
+static void printTicks(const char *label, uint32_t ticks) {
+    FLASH_PRINTF(" %s=%lu.%u", label, (unsigned long)(ticks / LATENCY_LOOPBACK_TICKS_PER_US),
+                 (unsigned)(ticks % LATENCY_LOOPBACK_TICKS_PER_US * 10 /
+                            LATENCY_LOOPBACK_TICKS_PER_US));
+}
+
+static void reportLoopback() {
+    LatencyLoopbackStats stats;
+    latencyLoopbackSnapshot(&stats);
+    if (!latencyLoopbackRunning() && stats.count == 0 && stats.lost == 0) {
+        return;
+    }
+    FLASH_PRINTF("[LAT] %-10s n=%lu lost=%u", "loop", (unsigned long)stats.count,
+                 (unsigned)stats.lost);
+    if (stats.count > 0) {
+        printTicks("min", stats.minTicks);
+        printTicks("mean", (uint32_t)(stats.sumTicks / stats.count));
+        printTicks("max", stats.maxTicks);
+        FLASH_PRINTF(" us");
+    }
+    FLASH_PRINTF("\r\n[LAT] %-10s ", "loop_us");
+    perfPrintHistogram(&stats.us);
+    FLASH_PRINTF("\r\n");
+}
+
+void latencyProbeReport() {
+    if (s_count == 0) {
+        FLASH_PRINTF("[LAT] No latency paths (build with -DLATENCY_PROBE_ENABLED)\r\n");
+    }
+    PerfDesc desc;
+    for (uint8_t i = 0; i < s_count; i++) {
+        memcpy_P(&desc, &s_table[i], sizeof(PerfDesc));
+        if (desc.type != PERF_HIST) {
+            continue;
+        }
+        FLASH_PRINTF("[LAT] %-10s ", desc.name);
+        perfPrintHistogram((const PerfHistogram *)desc.object);
+        FLASH_PRINTF("\r\n");
+    }
+    reportLoopback();
+}
+
+void latencyProbeClear() {
+    if (s_count > 0) {
+        perfClear(s_table, s_count);
+    }
+    latencyLoopbackClear();
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Serial commands
+// ──────────────────────────────────────────────────────────────────────────
+
+void latencyProbeOnReport(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    latencyProbeReport();
+}
+
+void latencyProbeOnClear(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    latencyProbeClear();
+    FLASH_PRINTF("[LAT] Cleared\r\n");
+}
+
+void latencyProbeOnLoop(const CommandArg *args, uint8_t argc, void *context) {
+    (void)argc;
+    (void)context;
+    int32_t periodMs = args[0].i;
+    int32_t holdMs = args[1].i;
+    if (periodMs < 1 || periodMs > 0xFFFF || holdMs < 1 || holdMs > 0xFFFF ||
+        !latencyLoopbackBegin((uint16_t)periodMs, (uint16_t)holdMs)) {
+        FLASH_PRINTF("[ERROR] Loopback: 1..65535 ms, needs -DLATENCY_PROBE_ENABLED on the AVR\r\n");
+        return;
+    }
+    FLASH_PRINTF("[LAT] Loopback: stimulus D%u (active LOW) -> input, output -> D%u\r\n",
+                 (unsigned)LATENCY_LOOPBACK_STIMULUS_PIN, (unsigned)LATENCY_LOOPBACK_RESPONSE_PIN);
+}
+
+void latencyProbeOnStop(const CommandArg *args, uint8_t argc, void *context) {
+    (void)args;
+    (void)argc;
+    (void)context;
+    latencyLoopbackStop();
+    FLASH_PRINTF("[LAT] Loopback stopped\r\n");
+}
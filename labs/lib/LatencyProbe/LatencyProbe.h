@@ -0,0 +1,148 @@
+/**
+ * @file LatencyProbe.h
+ * @brief End-to-End Latency Markers (stimulus → pipeline stages → response)
+ *
+ * PerfCounter times one function at a time; what an operator notices is
+ * the sum along a path: button edge → FSM → LED (lab 6.1), keypad 'C' →
+ * PWM at zero (lab 4), sensor capture → fan duty (lab 5.2). A
+ * LatencyPath holds the stimulus time of the event in flight; each
+ * marker further down the pipeline records the time elapsed since then
+ * into that stage's PerfHistogram:
+ *
+ *   LATENCY_START(path)            stimulus, now (or LATENCY_START_AT(path, us))
+ *   LATENCY_STAGE(path, hist)      hist += now − stimulus
+ *   LATENCY_END(path, hist)        same, closes the path, toggles the response pin
+ *
+ * Stages record only while the path is open, so a stage reached without
+ * a stimulus (a control cycle with no new sample) is not counted. A new
+ * start replaces an unanswered one. Times are micros() (4 µs steps on
+ * the AVR); the markers are ISR and task safe and never block.
+ *
+ * Compile-time removable: the markers expand to nothing unless the build
+ * has -DLATENCY_PROBE_ENABLED, so a lab guards its paths and histograms
+ * with the same #if. The "lat" commands stay and say how to enable them.
+ *
+ * Pin markers, for a scope or logic analyser and for LatencyLoopback:
+ *   -DLATENCY_PROBE_RESPONSE_PIN=<pin>   LATENCY_END() toggles it (FastPin)
+ *   LATENCY_PIN_TOGGLE(pin), LATENCY_PIN_HIGH(pin), LATENCY_PIN_LOW(pin)
+ *                                         ad hoc markers, also removed
+ *
+ * Serial commands (add LATENCY_PROBE_COMMANDS to a CommandParser table):
+ *   lat                        Stage histograms (µs) and the loopback result
+ *   lat clear                  Zero them
+ *   lat loop <period> <hold>   Start the input-capture loopback (ms, LatencyLoopback.h)
+ *   lat stop                   Stop it
+ *
+ * Usage:
+ *   #if defined(LATENCY_PROBE_ENABLED)
+ *   static LatencyPath   s_keyPath;
+ *   static PerfHistogram s_keyPwmUs;
+ *   static const PerfDesc LATENCY[] PROGMEM = { PERF_HISTOGRAM("key_pwm", s_keyPwmUs) };
+ *   #endif
+ *
+ *   latencyProbeInit(LATENCY, 1);            // setup(), inside the #if
+ *   LATENCY_START(s_keyPath);                // key read
+ *   ...
+ *   LATENCY_END(s_keyPath, s_keyPwmUs);      // PWM written
+ */
+
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <stdint.h>
+
+#include "CommandParser.h"
+#include "PerfCounter.h"
+
+#if defined(LATENCY_PROBE_ENABLED)
+#include "FastPin.h"
+#endif
+
+/**
+ * @struct LatencyPath
+ * @brief Stimulus time of the event travelling along one path.
+ */
+struct LatencyPath {
+    volatile uint32_t startUs;  ///< micros() at the stimulus.
+    volatile bool     open;     ///< Started and not yet ended.
+};
+
+/** @brief Open the path at us (micros() of a stimulus seen earlier, e.g. an edge ISR). */
+void latencyStartAt(LatencyPath *path, uint32_t us);
+
+/** @brief Open the path now. */
+void latencyStart(LatencyPath *path);
+
+/** @brief Record the time since the stimulus into hist, if the path is open. */
+void latencyStage(LatencyPath *path, PerfHistogram *hist);
+
+/** @brief latencyStage(), close the path and toggle the response pin (if any). */
+void latencyEnd(LatencyPath *path, PerfHistogram *hist);
+
+/**
+ * @brief Register the stage histograms the "lat" commands print and clear.
+ *
+ * Also drives LATENCY_PROBE_RESPONSE_PIN low as an output.
+ *
+ * @param table PROGMEM registry (PERF_HISTOGRAM rows; other rows are skipped).
+ * @param count Registry rows.
+ */
+void latencyProbeInit(const PerfDesc *table, uint8_t count);
+
+/**
+ * @brief Print the stage histograms and the loopback statistics:
+ *
+ *   [LAT] key_pwm    n=42 p50<2048 p99<4096 max=2632 | 1024:12 2048:30
+ *   [LAT] loop       n=40 lost=0 min=9210.5 mean=11802.0 max=26031.5 us
+ *   [LAT] loop_us    n=40 p50<16384 p99<32768 max=26031 | 8192:31 16384:9
+ */
+void latencyProbeReport();
+
+/** @brief Zero the stage histograms and the loopback statistics. */
+void latencyProbeClear();
+
+// ──────────────────────────────────────────────────────────────────────────
+// Markers
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(LATENCY_PROBE_ENABLED)
+#define LATENCY_START(path)         latencyStart(&(path))
+#define LATENCY_START_AT(path, us)  latencyStartAt(&(path), (us))
+#define LATENCY_STAGE(path, hist)   latencyStage(&(path), &(hist))
+#define LATENCY_END(path, hist)     latencyEnd(&(path), &(hist))
+#define LATENCY_PIN_TOGGLE(pin)     FastPin<pin>::toggle()
+#define LATENCY_PIN_HIGH(pin)       FastPin<pin>::high()
+#define LATENCY_PIN_LOW(pin)        FastPin<pin>::low()
+#else
+#define LATENCY_START(path)         ((void)0)
+#define LATENCY_START_AT(path, us)  ((void)0)
+#define LATENCY_STAGE(path, hist)   ((void)0)
+#define LATENCY_END(path, hist)     ((void)0)
+#define LATENCY_PIN_TOGGLE(pin)     ((void)0)
+#define LATENCY_PIN_HIGH(pin)       ((void)0)
+#define LATENCY_PIN_LOW(pin)        ((void)0)
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Serial commands
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @name Command handlers (context unused) */
+///@{
+void latencyProbeOnReport(const CommandArg *args, uint8_t argc, void *context);
+void latencyProbeOnClear(const CommandArg *args, uint8_t argc, void *context);
+void latencyProbeOnLoop(const CommandArg *args, uint8_t argc, void *context);
+void latencyProbeOnStop(const CommandArg *args, uint8_t argc, void *context);
+///@}
+
+/** @brief CommandParser table rows for the latency commands. */
+#define LATENCY_PROBE_COMMANDS                                  \
+    COMMAND_ENTRY("lat clear", latencyProbeOnClear,  ""),       \
+    COMMAND_ENTRY("lat loop",  latencyProbeOnLoop,   "ii"),     \
+    COMMAND_ENTRY("lat stop",  latencyProbeOnStop,   ""),       \
+    COMMAND_ENTRY("lat",       latencyProbeOnReport, "")
+
+/** @brief Number of rows in LATENCY_PROBE_COMMANDS. */
+#define LATENCY_PROBE_COMMAND_COUNT 4
+
+#endif // LATENCY_PROBE_H
@@ -5,48 +5,242 @@
  * Implements the LcdDisplay class methods using the LiquidCrystal_I2C
  * library for I2C-based 16x2 LCD communication. Provides line-level
  * text operations with automatic space padding to prevent display artifacts.
+ *
+ * Default backend: LiquidCrystal_I2C runs the init sequence, clear and
+ * backlight; text and cursor moves bypass it. Its write() sends every
+ * nibble step as its own Wire transmission followed by a 50 µs delay
+ * (~1.3 ms per character at 100 kHz); here the expander bytes of a run
+ * are packed into Wire transmissions of up to 32 bytes.
+ *
+ * Framebuffer: _shadow mirrors the DDRAM contents of the visible cells,
+ * '\0' marking a cell whose contents are unknown. The LCD's address
+ * counter auto-increments after each data byte, so a run of changed
+ * cells needs one setCursor() followed by its characters; the cursor is
+ * tracked so that a run continuing where the last write stopped needs
+ * none. A single unchanged cell between two runs is rewritten rather
+ * than skipped: one data byte costs the same as one cursor command.
  */
 
 #include "LcdDisplay.h"
+#include "FlashString.h"
+#include <math.h>
+#include <stdio.h>
 #include <string.h>
 
+#if !defined(LCD_DISPLAY_ASYNC)
+#include <Wire.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Wire backend (LiquidCrystal_I2C for init, clear and backlight)
+// ──────────────────────────────────────────────────────────────────────────
+
+/** Cursor row value meaning "position unknown". */
+static const uint8_t CURSOR_UNKNOWN = 0xFF;
+static const uint8_t RS_UNKNOWN = 0xFF;
+
+/** PCF8574 backpack bits (LiquidCrystal_I2C wiring). */
+static const uint8_t PIN_RS = 0x01;
+static const uint8_t PIN_E = 0x04;
+static const uint8_t PIN_BACKLIGHT = 0x08;
+
+static const uint8_t CMD_SET_CGRAM = 0x40;
+static const uint8_t CMD_SET_DDRAM = 0x80;
+
+/** DDRAM address of each row's first cell (as LiquidCrystal_I2C). */
+static const uint8_t ROW_OFFSET[4] = {0x00, 0x40, 0x14, 0x54};
+
+/** Expander bytes per Wire transmission (Wire's buffer size). */
+#if defined(BUFFER_LENGTH)
+static const uint8_t BATCH_MAX = BUFFER_LENGTH;
+#else
+static const uint8_t BATCH_MAX = 32;
+#endif
+
 LcdDisplay::LcdDisplay(uint8_t i2cAddress, uint8_t cols, uint8_t rows)
-    : _lcd(i2cAddress, cols, rows), _cols(cols), _rows(rows) {}
+    : _lcd(i2cAddress, cols, rows),
+      _address(i2cAddress),
+      _cols(cols > LCD_DISPLAY_MAX_COLS ? LCD_DISPLAY_MAX_COLS : cols),
+      _rows(rows > LCD_DISPLAY_MAX_ROWS ? LCD_DISPLAY_MAX_ROWS : rows),
+      _cursorCol(0),
+      _cursorRow(CURSOR_UNKNOWN),
+      _backlight(PIN_BACKLIGHT),
+      _lastRs(RS_UNKNOWN),
+      _batchLen(0),
+      _cellWrites(0) {
+    invalidate();
+}
 
 void LcdDisplay::init() {
-    _lcd.init();
+    _lcd.init();  // Calls Wire.begin(), which resets the clock
+    Wire.setClock(LCD_DISPLAY_WIRE_CLOCK_HZ);
     _lcd.backlight();
-    _lcd.clear();
+    _backlight = PIN_BACKLIGHT;
+    _cellWrites = 0;
+    memset(_glyphs, 0xFF, sizeof(_glyphs));  // CGRAM is random at power-up
+    clear();
 }
 
 void LcdDisplay::clear() {
     _lcd.clear();
+    memset(_shadow, ' ', sizeof(_shadow));
+    _cursorCol = 0;
+    _cursorRow = 0;
+    _lastRs = RS_UNKNOWN;
 }
 
 void LcdDisplay::setCursor(uint8_t col, uint8_t row) {
-    _lcd.setCursor(col, row);
+    if (row >= _rows || col >= _cols) {
+        _lcd.setCursor(col, row);
+        _cursorRow = CURSOR_UNKNOWN;
+        _lastRs = RS_UNKNOWN;
+        return;
+    }
+    batchByte((uint8_t)(CMD_SET_DDRAM | (ROW_OFFSET[row] + col)), 0);
+    flushBatch();
+    _cursorCol = col;
+    _cursorRow = row;
 }
 
 void LcdDisplay::print(const char *text) {
-    _lcd.print(text);
+    while (*text != '\0') {
+        put(*text++);
+    }
+    flushBatch();
 }
 
-void LcdDisplay::printLine(uint8_t row, const char *text) {
-    _lcd.setCursor(0, row);
+// ──────────────────────────────────────────────────────────────────────────
+// Batched expander writes
+// ──────────────────────────────────────────────────────────────────────────
+
+void LcdDisplay::batchByte(uint8_t value, uint8_t rs) {
+    if (_batchLen + 5 > BATCH_MAX) {
+        flushBatch();
+    }
+    if (_batchLen == 0) {
+        Wire.beginTransmission(_address);
+    }
+
+    // Same nibble/E sequence as LiquidCrystal_I2C, minus its separate
+    // transmission and 50 µs delay per step: the next E fall is always
+    // at least two expander bytes (≥ 45 µs at 400 kHz) away.
+    uint8_t flags = (uint8_t)(_backlight | rs);
+    uint8_t hi = (uint8_t)((value & 0xF0) | flags);
+    uint8_t lo = (uint8_t)((uint8_t)(value << 4) | flags);
+    if (rs != _lastRs) {
+        Wire.write(hi);  // RS settles before E rises
+        _batchLen++;
+        _lastRs = rs;
+    }
+    Wire.write((uint8_t)(hi | PIN_E));
+    Wire.write(hi);
+    Wire.write((uint8_t)(lo | PIN_E));
+    Wire.write(lo);
+    _batchLen += 4;
+}
+
+void LcdDisplay::flushBatch() {
+    if (_batchLen > 0) {
+        Wire.endTransmission();
+        _batchLen = 0;
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Framebuffer
+// ──────────────────────────────────────────────────────────────────────────
+
+void LcdDisplay::seek(uint8_t col, uint8_t row) {
+    if (row != _cursorRow || col != _cursorCol) {
+        batchByte((uint8_t)(CMD_SET_DDRAM | (ROW_OFFSET[row] + col)), 0);
+        _cursorCol = col;
+        _cursorRow = row;
+    }
+}
 
-    // Write text characters up to column limit
-    uint8_t len = strlen(text);
-    if (len > _cols) {
-        len = _cols;
+void LcdDisplay::put(char c) {
+    batchByte((uint8_t)c, PIN_RS);
+    _cellWrites++;
+    if (_cursorRow == CURSOR_UNKNOWN) {
+        return;
+    }
+    if (_cursorCol < _cols) {
+        _shadow[_cursorRow][_cursorCol] = c;
+        _cursorCol++;
+    } else {
+        // Past the visible row: where the address counter lands depends
+        // on the controller's DDRAM layout, so stop tracking.
+        _cursorRow = CURSOR_UNKNOWN;
+    }
+}
+
+void LcdDisplay::setGlyph(uint8_t slot, const uint8_t *rows) {
+    if (slot >= 8) {
+        return;
+    }
+    uint8_t *cached = _glyphs[slot];
+    bool changed = false;
+    for (uint8_t i = 0; i < LCD_CELL_HEIGHT; i++) {
+        if ((uint8_t)(rows[i] & 0x1F) != cached[i]) {
+            changed = true;
+            break;
+        }
     }
-    for (uint8_t i = 0; i < len; i++) {
-        _lcd.write(text[i]);
+    if (!changed) {
+        return;
+    }
+
+    batchByte((uint8_t)(CMD_SET_CGRAM | (slot * LCD_CELL_HEIGHT)), 0);
+    for (uint8_t i = 0; i < LCD_CELL_HEIGHT; i++) {
+        cached[i] = (uint8_t)(rows[i] & 0x1F);
+        batchByte(cached[i], PIN_RS);
+    }
+    flushBatch();
+    _cursorRow = CURSOR_UNKNOWN;  // Address counter now points into CGRAM
+}
+
+void LcdDisplay::invalidate() {
+    memset(_shadow, '\0', sizeof(_shadow));
+    memset(_glyphs, 0xFF, sizeof(_glyphs));
+}
+
+uint16_t LcdDisplay::getCellWrites() const {
+    return _cellWrites;
+}
+
+void LcdDisplay::printLine(uint8_t row, const char *text) {
+    if (row >= _rows) {
+        return;
     }
 
-    // Pad remaining columns with spaces to clear old content
-    for (uint8_t i = len; i < _cols; i++) {
-        _lcd.write(' ');
+    // Text up to the column limit, padded with spaces to clear old content
+    char line[LCD_DISPLAY_MAX_COLS];
+    size_t textLen = strlen(text);
+    uint8_t len = (textLen > _cols) ? _cols : (uint8_t)textLen;
+    memcpy(line, text, len);
+    memset(line + len, ' ', _cols - len);
+
+    const char *shown = _shadow[row];
+    uint8_t col = 0;
+    while (col < _cols) {
+        if (line[col] == shown[col]) {
+            col++;
+            continue;
+        }
+
+        // Changed run; absorb single unchanged cells between changes.
+        uint8_t end = col + 1;
+        while (end < _cols &&
+               (line[end] != shown[end] ||
+                (end + 1 < _cols && line[end + 1] != shown[end + 1]))) {
+            end++;
+        }
+
+        seek(col, row);
+        for (; col < end; col++) {
+            put(line[col]);
+        }
     }
+    flushBatch();
 }
 
 void LcdDisplay::showTwoLines(const char *line1, const char *line2) {
@@ -60,4 +254,171 @@ void LcdDisplay::backlight(bool on) {
     } else {
         _lcd.noBacklight();
     }
+    _backlight = on ? PIN_BACKLIGHT : 0;
+}
+
+#else
+// ──────────────────────────────────────────────────────────────────────────
+// Asynchronous backend (LcdTwi)
+// ──────────────────────────────────────────────────────────────────────────
+
+LcdDisplay::LcdDisplay(uint8_t i2cAddress, uint8_t cols, uint8_t rows)
+    : _address(i2cAddress),
+      _cols(cols > LCD_DISPLAY_MAX_COLS ? LCD_DISPLAY_MAX_COLS : cols),
+      _rows(rows > LCD_DISPLAY_MAX_ROWS ? LCD_DISPLAY_MAX_ROWS : rows),
+      _cursorCol(0),
+      _cursorRow(0) {}
+
+void LcdDisplay::init() {
+    if (!lcdTwiBegin(_address, _cols, _rows)) {
+        FLASH_PRINTF("[ERROR] LCD at 0x%02X not responding\r\n", _address);
+    }
+    _cursorCol = 0;
+    _cursorRow = 0;
+}
+
+void LcdDisplay::clear() {
+    // Spaces instead of the 1.5 ms clear command, which the engine cannot
+    // wait for; only cells that are not blank yet are sent.
+    for (uint8_t row = 0; row < _rows; row++) {
+        printLine(row, "");
+    }
+    _cursorCol = 0;
+    _cursorRow = 0;
+}
+
+void LcdDisplay::setCursor(uint8_t col, uint8_t row) {
+    _cursorCol = col;
+    _cursorRow = row;
+}
+
+void LcdDisplay::print(const char *text) {
+    size_t textLen = strlen(text);
+    uint8_t len = (textLen > 0xFF) ? 0xFF : (uint8_t)textLen;
+    lcdTwiWrite(_cursorRow, _cursorCol, text, len);  // Clipped to the row
+    _cursorCol = (len > _cols - _cursorCol) ? _cols : (uint8_t)(_cursorCol + len);
+}
+
+void LcdDisplay::printLine(uint8_t row, const char *text) {
+    char line[LCD_DISPLAY_MAX_COLS];
+    size_t textLen = strlen(text);
+    uint8_t len = (textLen > _cols) ? _cols : (uint8_t)textLen;
+    memcpy(line, text, len);
+    memset(line + len, ' ', _cols - len);
+    lcdTwiWrite(row, 0, line, _cols);
+}
+
+void LcdDisplay::showTwoLines(const char *line1, const char *line2) {
+    printLine(0, line1);
+    printLine(1, line2);
+}
+
+void LcdDisplay::backlight(bool on) {
+    lcdTwiSetBacklight(on);
+}
+
+void LcdDisplay::setGlyph(uint8_t slot, const uint8_t *rows) {
+    lcdTwiSetGlyph(slot, rows);  // The engine diffs against CGRAM
+}
+
+void LcdDisplay::invalidate() {
+    lcdTwiInvalidate();
+}
+
+uint16_t LcdDisplay::getCellWrites() const {
+    return lcdTwiCellWrites();
+}
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Flash strings (both backends)
+// ──────────────────────────────────────────────────────────────────────────
+
+void LcdDisplay::printLine_P(uint8_t row, const char *text) {
+    // Only the visible part is copied out of flash
+    char line[LCD_DISPLAY_MAX_COLS + 1];
+    strncpy_P(line, text, _cols);
+    line[_cols] = '\0';
+    printLine(row, line);
+}
+
+void LcdDisplay::showTwoLines_P(const char *line1, const char *line2) {
+    printLine_P(0, line1);
+    printLine_P(1, line2);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Bar glyphs (both backends)
+// ──────────────────────────────────────────────────────────────────────────
+
+void LcdDisplay::loadVBarGlyphs() {
+    uint8_t rows[LCD_CELL_HEIGHT];
+    for (uint8_t height = 1; height < LCD_CELL_HEIGHT; height++) {
+        for (uint8_t i = 0; i < LCD_CELL_HEIGHT; i++) {
+            rows[i] = (i >= LCD_CELL_HEIGHT - height) ? 0x1F : 0x00;
+        }
+        setGlyph((uint8_t)(height - 1), rows);
+    }
+}
+
+void LcdDisplay::loadHBarGlyphs() {
+    uint8_t rows[LCD_CELL_HEIGHT];
+    for (uint8_t width = 1; width < LCD_CELL_WIDTH; width++) {
+        uint8_t bits = (uint8_t)(0x1F & ~(0x1F >> width));  // Filled from the left
+        memset(rows, bits, sizeof(rows));
+        setGlyph((uint8_t)(width - 1), rows);
+    }
+}
+
+char LcdDisplay::vbarChar(uint8_t height) {
+    if (height == 0) {
+        return ' ';
+    }
+    if (height >= LCD_CELL_HEIGHT) {
+        return LCD_FULL_BLOCK;
+    }
+    return LCD_GLYPH(height - 1);
+}
+
+void LcdDisplay::formatSparkline(char *out, const float *values, uint8_t count,
+                                 float lo, float hi) {
+    float span = hi - lo;
+    for (uint8_t i = 0; i < count; i++) {
+        float v = values[i];
+        if (isnan(v) || !(span > 0.0f)) {
+            out[i] = ' ';
+            continue;
+        }
+        float scaled = (v - lo) * LCD_CELL_HEIGHT / span + 0.5f;
+        uint8_t height = 0;
+        if (scaled >= LCD_CELL_HEIGHT) {
+            height = LCD_CELL_HEIGHT;
+        } else if (scaled > 0.0f) {
+            height = (uint8_t)scaled;
+        }
+        // Keep a one-pixel baseline so in-range samples never vanish.
+        out[i] = vbarChar(height > 0 ? height : 1);
+    }
+    out[count] = '\0';
+}
+
+void LcdDisplay::formatHBar(char *out, uint8_t width, uint16_t value, uint16_t max) {
+    uint16_t steps = (uint16_t)(width * LCD_CELL_WIDTH);
+    uint16_t filled = 0;
+    if (max > 0) {
+        uint32_t v = (value > max) ? max : value;
+        filled = (uint16_t)((v * steps + max / 2) / max);
+    }
+    for (uint8_t i = 0; i < width; i++) {
+        if (filled >= LCD_CELL_WIDTH) {
+            out[i] = LCD_FULL_BLOCK;
+            filled -= LCD_CELL_WIDTH;
+        } else if (filled > 0) {
+            out[i] = LCD_GLYPH(filled - 1);
+            filled = 0;
+        } else {
+            out[i] = ' ';
+        }
+    }
+    out[width] = '\0';
 }
@@ -6,17 +6,82 @@
  * via the I2C bus. Wraps the LiquidCrystal_I2C library behind a
  * clean interface for line-based text display operations.
  *
+ * A shadow framebuffer holds what is on the glass. printLine() and
+ * showTwoLines() compare the new text against it and send only the
+ * changed cells, moving the cursor only across unchanged gaps, so
+ * redrawing an unchanged screen costs no I2C traffic at all. Each LCD
+ * byte is four PCF8574 expander writes (two nibbles, E high/low), 360 µs
+ * of bus time at 100 kHz, so a full 2×16 redraw still takes ~12 ms
+ * (~3 ms in 400 kHz fast mode).
+ *
+ * Backends:
+ *   - Default: Wire, with LiquidCrystal_I2C for init/clear/backlight.
+ *     The changed cells are packed into as few Wire transmissions as
+ *     possible; the caller blocks until they are on the bus.
+ *   - -DLCD_DISPLAY_ASYNC: LcdTwi's interrupt-driven engine (see
+ *     LcdTwi.h). Every call only updates a target framebuffer and
+ *     returns; the TWI interrupt sends the changed cells in the
+ *     background. init() still blocks (~60 ms). Replaces Wire: other
+ *     I2C devices share the bus through TwiBus transactions, which
+ *     preempt the LCD stream at a higher priority.
+ *
+ * Custom characters: the eight CGRAM slots appear in strings as
+ * LCD_GLYPH(0..7) (codes 8..15; code 0 would end the string).
+ * setGlyph() caches every slot's bitmap and only writes CGRAM when it
+ * changes, so pages can (re)load their glyph sets every refresh. Two
+ * ready-made sets share the low slots: vertical bars (sparklines, slots
+ * 0..6) and horizontal bars (gauges, slots 0..3); the full block is the
+ * ROM character LCD_FULL_BLOCK.
+ *
  * Usage:
  *   LcdDisplay lcd(0x27, 16, 2);
  *   lcd.init();
  *   lcd.showTwoLines("Hello", "World");
+ *   lcd.showTwoLines_P(PSTR("Hello"), PSTR("World"));  // Text stays in flash
+ *
+ *   lcd.loadHBarGlyphs();
+ *   char gauge[9];
+ *   LcdDisplay::formatHBar(gauge, 8, duty, 100);   // 40-step bar
  */
 
 #ifndef LCD_DISPLAY_H
 #define LCD_DISPLAY_H
 
 #include <Arduino.h>
+#if defined(LCD_DISPLAY_ASYNC)
+#include "LcdTwi.h"
+#else
 #include <LiquidCrystal_I2C.h>
+#endif
+
+/**
+ * @brief I2C clock of the default backend (PCF8574 datasheet: 100 kHz).
+ * Override with -DLCD_DISPLAY_WIRE_CLOCK_HZ=400000UL for fast mode; the
+ * asynchronous backend uses LCD_TWI_CLOCK_HZ.
+ */
+#ifndef LCD_DISPLAY_WIRE_CLOCK_HZ
+#define LCD_DISPLAY_WIRE_CLOCK_HZ 100000UL
+#endif
+
+/** @brief Largest supported geometry (framebuffer size). */
+#ifndef LCD_DISPLAY_MAX_COLS
+#define LCD_DISPLAY_MAX_COLS 20
+#endif
+#ifndef LCD_DISPLAY_MAX_ROWS
+#define LCD_DISPLAY_MAX_ROWS 4
+#endif
+
+/** @brief Character code of CGRAM slot n (0..7) inside text. */
+#define LCD_GLYPH(slot) ((char)(8 + (slot)))
+
+/** @brief Solid 5×8 block from the HD44780 A00 character ROM. */
+#define LCD_FULL_BLOCK ((char)0xFF)
+
+/** @brief Pixel columns per character cell. */
+#define LCD_CELL_WIDTH 5
+
+/** @brief Pixel rows per character cell. */
+#define LCD_CELL_HEIGHT 8
 
 /**
  * @class LcdDisplay
@@ -54,6 +119,10 @@ public:
 
     /**
      * @brief Print a text string at the current cursor position.
+     *
+     * Always written (no diffing); the framebuffer is updated so later
+     * printLine() calls stay consistent.
+     *
      * @param text Null-terminated string to display.
      */
     void print(const char *text);
@@ -63,7 +132,8 @@ public:
      *
      * Clears the entire row by padding the text to the full
      * column width, eliminating leftover characters from
-     * previous content.
+     * previous content. Only cells that differ from the framebuffer
+     * are sent.
      *
      * @param row Row number (0 or 1).
      * @param text Null-terminated string to display.
@@ -77,16 +147,110 @@ public:
      */
     void showTwoLines(const char *line1, const char *line2);
 
+    /**
+     * @brief printLine() of a string in flash, e.g. PSTR("Initializing...").
+     * @param row Row number (0 or 1).
+     * @param text Null-terminated string in program memory.
+     */
+    void printLine_P(uint8_t row, const char *text);
+
+    /**
+     * @brief showTwoLines() of two strings in flash (fixed screens, banners).
+     * @param line1 Text for the first row, in program memory.
+     * @param line2 Text for the second row, in program memory.
+     */
+    void showTwoLines_P(const char *line1, const char *line2);
+
     /**
      * @brief Enable or disable the LCD backlight.
      * @param on True to enable, false to disable.
      */
     void backlight(bool on);
 
+    /**
+     * @brief Define a custom character; CGRAM is written only if the
+     *        bitmap differs from the cached one.
+     * @param slot CGRAM slot (0..7), shown as LCD_GLYPH(slot).
+     * @param rows Eight rows, bits 4..0 = pixels left to right.
+     */
+    void setGlyph(uint8_t slot, const uint8_t *rows);
+
+    /** @brief Load bars of height 1..7 px into slots 0..6 (see vbarChar()). */
+    void loadVBarGlyphs();
+
+    /** @brief Load bars of width 1..4 px into slots 0..3 (see formatHBar()). */
+    void loadHBarGlyphs();
+
+    /**
+     * @brief Character for a vertical bar (needs loadVBarGlyphs()).
+     * @param height Filled pixel rows from the bottom, 0..8.
+     */
+    static char vbarChar(uint8_t height);
+
+    /**
+     * @brief Render a sparkline (needs loadVBarGlyphs()).
+     *
+     * @param out    Receives count characters and a terminating NUL.
+     * @param values Samples, oldest first; NAN renders as a blank.
+     * @param count  Number of samples (= cells).
+     * @param lo     Bottom of the scale (drawn as a one-pixel baseline).
+     * @param hi     Top of the scale (full cell; values are clamped).
+     */
+    static void formatSparkline(char *out, const float *values, uint8_t count,
+                                float lo, float hi);
+
+    /**
+     * @brief Render a horizontal gauge (needs loadHBarGlyphs()).
+     *
+     * @param out   Receives width characters and a terminating NUL.
+     * @param width Cells; resolution is width × 5 steps.
+     * @param value Filled amount (clamped to max).
+     * @param max   Value of a full gauge.
+     */
+    static void formatHBar(char *out, uint8_t width, uint16_t value, uint16_t max);
+
+    /**
+     * @brief Forget the framebuffer: the next printLine() of every row
+     *        rewrites all of its cells (e.g. after the LCD lost power).
+     */
+    void invalidate();
+
+    /** @brief Data bytes sent to the LCD since init() (wraps). */
+    uint16_t getCellWrites() const;
+
 private:
-    LiquidCrystal_I2C _lcd;  ///< Underlying I2C LCD driver
+#if defined(LCD_DISPLAY_ASYNC)
+    uint8_t _address;         ///< I2C address of the backpack
+    uint8_t _cols;            ///< Number of display columns
+    uint8_t _rows;            ///< Number of display rows
+    uint8_t _cursorCol;       ///< Column of the next print()
+    uint8_t _cursorRow;       ///< Row of the next print()
+#else
+    /** @brief Move the LCD cursor unless it is already at (col, row). */
+    void seek(uint8_t col, uint8_t row);
+
+    /** @brief Write one cell at the cursor and track it in the framebuffer. */
+    void put(char c);
+
+    /** @brief Append one LCD byte to the open Wire transmission. */
+    void batchByte(uint8_t value, uint8_t rs);
+
+    /** @brief End the open Wire transmission, if any. */
+    void flushBatch();
+
+    LiquidCrystal_I2C _lcd;  ///< Init, clear and backlight
+    uint8_t _address;         ///< I2C address of the backpack
     uint8_t _cols;            ///< Number of display columns
     uint8_t _rows;            ///< Number of display rows
+    char _shadow[LCD_DISPLAY_MAX_ROWS][LCD_DISPLAY_MAX_COLS];  ///< On-screen text
+    uint8_t _cursorCol;       ///< LCD cursor column (_cols once past the end)
+    uint8_t _cursorRow;       ///< LCD cursor row
+    uint8_t _backlight;       ///< Backlight bit of every expander byte
+    uint8_t _lastRs;          ///< RS level last sent
+    uint8_t _batchLen;        ///< Bytes in the open Wire transmission
+    uint16_t _cellWrites;     ///< Data bytes sent
+    uint8_t _glyphs[8][LCD_CELL_HEIGHT];  ///< CGRAM contents (0xFF = unknown)
+#endif
 };
 
 #endif // LCD_DISPLAY_H
@@ -0,0 +1,452 @@
+/**
+ * @file LcdTwi.cpp
+ * @brief Interrupt-Driven HD44780 Transfer Engine Implementation
+ *
+ * PCF8574 backpack wiring (LiquidCrystal_I2C compatible):
+ *   P0 = RS, P1 = R/W (always 0), P2 = E, P3 = backlight, P4..P7 = D4..D7
+ *
+ * Two framebuffers: s_target is written by the tasks, s_shown is what the
+ * ISR has sent. Whenever a byte has been acknowledged the ISR queues the
+ * next cell where they differ, searching from the LCD cursor so that a
+ * run of changed cells needs a single cursor command. Rows with pending
+ * changes are flagged in s_dirtyRows; the writer sets its bit after the
+ * copy, so a row that the ISR finds clean and un-flags while the copy is
+ * in progress is flagged again and rescanned.
+ *
+ * Custom characters work the same way: s_glyphTarget/s_glyphShown hold
+ * the CGRAM bitmaps (0xFF = row unknown), s_dirtyGlyphs the slots to
+ * rescan. They are sent before text, and writing CGRAM moves the LCD
+ * address counter away from DDRAM, so the next cell needs a cursor
+ * command.
+ *
+ * The cells go out as one streaming TwiBus transaction whose refill hook
+ * is produceNext(); when a more urgent transaction preempts it, the
+ * paused bytes stay in s_tx and the stream resumes from the next one
+ * (the expander just holds its outputs meanwhile).
+ *
+ * A failed transfer (NACK, arbitration loss) stops; the next write or
+ * lcdTwiInvalidate() restarts it. It may have ended between the two
+ * nibbles of a byte, so the restart first replays the 8-bit/4-bit switch
+ * of the init sequence (which works from either nibble phase) and then
+ * redraws every cell.
+ */
+
+#include "LcdTwi.h"
+
+#if defined(LCD_DISPLAY_ASYNC)
+
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Constants
+// ──────────────────────────────────────────────────────────────────────────
+
+static const uint8_t PIN_RS = 0x01;
+static const uint8_t PIN_E  = 0x04;
+static const uint8_t PIN_BACKLIGHT = 0x08;
+
+static const uint8_t CMD_CLEAR        = 0x01;
+static const uint8_t CMD_ENTRY_LTR    = 0x06;  ///< Increment, no shift
+static const uint8_t CMD_DISPLAY_ON   = 0x0C;  ///< Display on, cursor off
+static const uint8_t CMD_FUNCTION_4BIT = 0x20;
+static const uint8_t CMD_FUNCTION_2LINE = 0x08;
+static const uint8_t CMD_SET_CGRAM    = 0x40;
+static const uint8_t CMD_SET_DDRAM    = 0x80;
+
+/** DDRAM address of each row's first cell (as LiquidCrystal_I2C). */
+static const uint8_t ROW_OFFSET[LCD_TWI_MAX_ROWS] = {0x00, 0x40, 0x14, 0x54};
+
+static const uint8_t RS_UNKNOWN = 0xFF;
+static const uint8_t GLYPH_ROW_UNKNOWN = 0xFF;
+static const uint8_t GLYPH_SLOTS = 8;
+static const uint8_t GLYPH_ROWS = 8;
+
+/** Largest expander sequence: cursor command + character, each with setup. */
+static const uint8_t TX_MAX = 10;
+
+/**
+ * Nibble resynchronization, E (0x04) pulsed with RS low. A first 0x3
+ * nibble completes a half-received byte, which is at worst Return Home
+ * (1.52 ms, covered by RESYNC_IDLE_BYTES idle bytes); 0x3, 0x3 then
+ * select 8-bit mode from either phase and 0x2 returns to 4-bit mode.
+ */
+static const uint8_t RESYNC_HEAD[] = {0x30, 0x34, 0x30};
+static const uint8_t RESYNC_TAIL[] = {0x34, 0x30, 0x34, 0x30, 0x24, 0x20};
+static const uint8_t RESYNC_IDLE = 0x30;
+static const uint8_t RESYNC_IDLE_BYTES =
+    (uint8_t)(1600UL * (TWI_BUS_CLOCK_HZ / 1000UL) / 9000UL + 1);
+static const uint8_t RESYNC_LENGTH =
+    (uint8_t)(sizeof(RESYNC_HEAD) + RESYNC_IDLE_BYTES + sizeof(RESYNC_TAIL));
+
+// ──────────────────────────────────────────────────────────────────────────
+// Engine state
+// ──────────────────────────────────────────────────────────────────────────
+
+static uint8_t s_address = 0x27;
+static uint8_t s_cols = 16;
+static uint8_t s_rows = 2;
+
+static char s_target[LCD_TWI_MAX_ROWS][LCD_TWI_MAX_COLS];  ///< Requested text.
+static char s_shown[LCD_TWI_MAX_ROWS][LCD_TWI_MAX_COLS];   ///< Sent text ('\0' = unknown).
+static volatile uint8_t s_dirtyRows = 0;                    ///< Rows to rescan.
+
+static uint8_t s_glyphTarget[GLYPH_SLOTS][GLYPH_ROWS];      ///< Requested bitmaps.
+static uint8_t s_glyphShown[GLYPH_SLOTS][GLYPH_ROWS];       ///< Sent bitmaps.
+static volatile uint8_t s_dirtyGlyphs = 0;                  ///< Slots to rescan.
+
+// ISR-owned transfer state.
+static TwiTransaction s_xfer;        ///< The stream (or an init write).
+static uint8_t s_tx[TX_MAX];         ///< Expander bytes of the current cell.
+static uint8_t s_txLen = 0;
+static uint8_t s_cursorRow = 0;      ///< LCD address counter, if known.
+static uint8_t s_cursorCol = 0;
+static bool    s_cursorKnown = false;
+static uint8_t s_cgAddress = 0;      ///< CGRAM address counter, if known.
+static bool    s_cgKnown = false;
+static uint8_t s_lastRs = RS_UNKNOWN;
+static uint8_t s_resyncPos = 0;      ///< Next resync byte while resyncing.
+static volatile bool s_resync = false;  ///< Resync before more cells.
+
+static uint8_t          s_backlight = PIN_BACKLIGHT;
+static volatile bool    s_backlightPending = false;
+static volatile uint16_t s_cellWrites = 0;
+static volatile uint16_t s_errors = 0;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Expander byte encoding
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Append one LCD byte: two nibbles, each latched by E falling. */
+static void queueByte(uint8_t value, uint8_t rs) {
+    uint8_t flags = (uint8_t)(s_backlight | rs);
+    uint8_t hi = (uint8_t)((value & 0xF0) | flags);
+    uint8_t lo = (uint8_t)((uint8_t)(value << 4) | flags);
+    if (rs != s_lastRs) {
+        s_tx[s_txLen++] = hi;  // RS settles before E rises
+        s_lastRs = rs;
+    }
+    s_tx[s_txLen++] = (uint8_t)(hi | PIN_E);
+    s_tx[s_txLen++] = hi;
+    s_tx[s_txLen++] = (uint8_t)(lo | PIN_E);
+    s_tx[s_txLen++] = lo;
+}
+
+/** @brief Function set for the configured row count. */
+static uint8_t functionSet() {
+    return (uint8_t)(CMD_FUNCTION_4BIT | (s_rows > 1 ? CMD_FUNCTION_2LINE : 0));
+}
+
+/** @brief Queue the next chunk of the resynchronization sequence. */
+static void produceResync() {
+    while (s_resyncPos < RESYNC_LENGTH && s_txLen < TX_MAX) {
+        uint8_t pos = s_resyncPos++;
+        uint8_t value = RESYNC_IDLE;
+        if (pos < sizeof(RESYNC_HEAD)) {
+            value = RESYNC_HEAD[pos];
+        } else if (pos >= sizeof(RESYNC_HEAD) + RESYNC_IDLE_BYTES) {
+            value = RESYNC_TAIL[pos - sizeof(RESYNC_HEAD) - RESYNC_IDLE_BYTES];
+        }
+        s_tx[s_txLen++] = (uint8_t)(value | s_backlight);
+    }
+    if (s_resyncPos < RESYNC_LENGTH || s_txLen > TX_MAX - 8) {
+        return;
+    }
+    s_lastRs = 0;
+    queueByte(functionSet(), 0);
+    queueByte(CMD_DISPLAY_ON, 0);
+    s_resync = false;
+    s_resyncPos = 0;
+    s_cursorKnown = false;
+    s_cgKnown = false;
+    memset(s_shown, '\0', sizeof(s_shown));
+    memset(s_glyphShown, GLYPH_ROW_UNKNOWN, sizeof(s_glyphShown));
+    s_dirtyRows = (uint8_t)((1U << s_rows) - 1);
+    s_dirtyGlyphs = 0xFF;
+}
+
+/** @brief Queue the next changed CGRAM row. @return false if none. */
+static bool produceGlyph() {
+    for (uint8_t slot = 0; slot < GLYPH_SLOTS; slot++) {
+        uint8_t bit = (uint8_t)(1U << slot);
+        if (!(s_dirtyGlyphs & bit)) {
+            continue;
+        }
+        for (uint8_t row = 0; row < GLYPH_ROWS; row++) {
+            uint8_t bits = s_glyphTarget[slot][row];
+            if (bits == s_glyphShown[slot][row]) {
+                continue;
+            }
+            uint8_t address = (uint8_t)(slot * GLYPH_ROWS + row);
+            if (!s_cgKnown || s_cgAddress != address) {
+                queueByte((uint8_t)(CMD_SET_CGRAM | address), 0);
+            }
+            queueByte(bits, PIN_RS);
+            s_glyphShown[slot][row] = bits;
+            s_cgAddress = (uint8_t)(address + 1);
+            s_cgKnown = true;
+            s_cursorKnown = false;  // Address counter now points into CGRAM
+            return true;
+        }
+        s_dirtyGlyphs &= (uint8_t)~bit;
+    }
+    return false;
+}
+
+/**
+ * @brief Queue the next changed cell, or a pending backlight update.
+ * @return false when the glass matches the target.
+ */
+static bool produceNext() {
+    s_txLen = 0;
+
+    if (s_resync) {
+        produceResync();
+        return true;
+    }
+
+    if (s_backlightPending) {
+        s_backlightPending = false;
+        s_tx[s_txLen++] = s_backlight;
+        return true;
+    }
+
+    if (s_dirtyGlyphs != 0 && produceGlyph()) {
+        return true;
+    }
+
+    uint8_t startRow = s_cursorKnown ? s_cursorRow : 0;
+    uint8_t startCol = s_cursorKnown ? s_cursorCol : 0;
+
+    // The cursor row is visited twice: from the cursor to the end first,
+    // then from column 0 up to the cursor after all other rows.
+    for (uint8_t n = 0; n <= s_rows; n++) {
+        uint8_t row = (uint8_t)((startRow + n) % s_rows);
+        uint8_t bit = (uint8_t)(1U << row);
+        if (!(s_dirtyRows & bit)) {
+            continue;
+        }
+        uint8_t from = (n == 0) ? startCol : 0;
+        uint8_t to = (n == s_rows) ? startCol : s_cols;
+
+        for (uint8_t col = from; col < to; col++) {
+            char c = s_target[row][col];
+            if (c == s_shown[row][col]) {
+                continue;
+            }
+            if (!s_cursorKnown || row != s_cursorRow || col != s_cursorCol) {
+                queueByte((uint8_t)(CMD_SET_DDRAM | (ROW_OFFSET[row] + col)), 0);
+            }
+            queueByte((uint8_t)c, PIN_RS);
+            s_shown[row][col] = c;
+            s_cursorRow = row;
+            s_cursorCol = (uint8_t)(col + 1);
+            s_cursorKnown = true;
+            s_cgKnown = false;
+            s_cellWrites++;
+            return true;
+        }
+
+        if (n == 0 && from > 0) {
+            continue;  // Columns before the cursor are checked last
+        }
+        s_dirtyRows &= (uint8_t)~bit;
+    }
+    return false;
+}
+
+/** @brief Forget the state a failed transaction may have corrupted. */
+static void transferFailed() {
+    s_resync = true;  // Also redraws every cell
+    s_resyncPos = 0;
+    if (s_errors < 0xFFFF) {
+        s_errors++;
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Bus client (TwiBus)
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Stream refill (TWI ISR): the expander bytes of the next change. */
+static uint8_t refillStream(TwiTransaction *t) {
+    (void)t;
+    return produceNext() ? s_txLen : 0;
+}
+
+/** @brief Completion (TWI ISR, or the canceller on a timeout). */
+static void transferDone(TwiTransaction *t) {
+    if (t->status != TWI_BUS_DONE) {
+        transferFailed();
+    }
+}
+
+/** @brief Start streaming dirty cells unless the stream is queued. */
+static void kick() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!twiBusPending(&s_xfer)) {
+            s_xfer.txLen = 0;
+            s_xfer.refill = refillStream;
+            twiBusSubmit(&s_xfer);
+        }
+    }
+}
+
+/** @brief Send the prepared s_tx bytes and wait (initialization only). */
+static bool transferBlocking() {
+    s_xfer.txLen = s_txLen;
+    s_xfer.refill = NULL;
+    return twiBusTransferBlocking(&s_xfer, LCD_TWI_TIMEOUT_MS);
+}
+
+/** @brief Blocking write of one 4-bit init nibble (high nibble of value). */
+static bool sendNibbleBlocking(uint8_t value) {
+    uint8_t data = (uint8_t)((value & 0xF0) | s_backlight);
+    s_txLen = 0;
+    s_tx[s_txLen++] = (uint8_t)(data | PIN_E);
+    s_tx[s_txLen++] = data;
+    return transferBlocking();
+}
+
+/** @brief Blocking write of one command byte. */
+static bool sendCommandBlocking(uint8_t command) {
+    s_txLen = 0;
+    queueByte(command, 0);
+    return transferBlocking();
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool lcdTwiBegin(uint8_t address, uint8_t cols, uint8_t rows) {
+    s_address = address;
+    s_cols = (cols == 0 || cols > LCD_TWI_MAX_COLS) ? LCD_TWI_MAX_COLS : cols;
+    s_rows = (rows == 0 || rows > LCD_TWI_MAX_ROWS) ? LCD_TWI_MAX_ROWS : rows;
+    s_dirtyRows = 0;
+    s_dirtyGlyphs = 0;
+    s_cgKnown = false;
+    s_resync = false;
+    s_resyncPos = 0;
+    s_backlightPending = false;
+    s_backlight = PIN_BACKLIGHT;
+    s_cursorKnown = false;
+    s_lastRs = RS_UNKNOWN;
+    s_cellWrites = 0;
+
+    twiBusBegin();
+    twiBusSetup(&s_xfer, address, s_tx, 0, NULL, 0, LCD_TWI_PRIORITY);
+    s_xfer.flags = TWI_BUS_PREEMPTIBLE;
+    s_xfer.done = transferDone;
+
+    // HD44780 power-on: > 40 ms after VCC rises, then 8-bit function set
+    // three times and the switch to 4-bit mode (datasheet figure 24).
+    delay(50);
+    s_txLen = 0;
+    s_tx[s_txLen++] = s_backlight;
+    if (!transferBlocking()) {
+        return false;
+    }
+    sendNibbleBlocking(0x30);
+    delayMicroseconds(4500);
+    sendNibbleBlocking(0x30);
+    delayMicroseconds(4500);
+    sendNibbleBlocking(0x30);
+    delayMicroseconds(150);
+    sendNibbleBlocking(0x20);
+
+    s_lastRs = RS_UNKNOWN;
+    sendCommandBlocking(functionSet());
+    sendCommandBlocking(CMD_DISPLAY_ON);
+    sendCommandBlocking(CMD_CLEAR);
+    delay(2);  // Clear takes 1.52 ms
+    bool ok = sendCommandBlocking(CMD_ENTRY_LTR);
+
+    memset(s_target, ' ', sizeof(s_target));
+    memset(s_shown, ' ', sizeof(s_shown));
+    memset(s_glyphTarget, 0, sizeof(s_glyphTarget));
+    memset(s_glyphShown, GLYPH_ROW_UNKNOWN, sizeof(s_glyphShown));  // Random at power-up
+    s_cursorRow = 0;
+    s_cursorCol = 0;
+    s_cursorKnown = ok;
+    return ok;
+}
+
+void lcdTwiWrite(uint8_t row, uint8_t col, const char *text, uint8_t len) {
+    if (row >= s_rows || col >= s_cols) {
+        return;
+    }
+    if (len > s_cols - col) {
+        len = (uint8_t)(s_cols - col);
+    }
+    memcpy(&s_target[row][col], text, len);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_dirtyRows |= (uint8_t)(1U << row);
+    }
+    kick();
+}
+
+void lcdTwiSetGlyph(uint8_t slot, const uint8_t *rows) {
+    if (slot >= GLYPH_SLOTS) {
+        return;
+    }
+    for (uint8_t row = 0; row < GLYPH_ROWS; row++) {
+        s_glyphTarget[slot][row] = (uint8_t)(rows[row] & 0x1F);
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_dirtyGlyphs |= (uint8_t)(1U << slot);
+    }
+    kick();
+}
+
+void lcdTwiSetBacklight(bool on) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_backlight = on ? PIN_BACKLIGHT : 0;
+        s_backlightPending = true;
+    }
+    kick();
+}
+
+void lcdTwiInvalidate() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memset(s_shown, '\0', sizeof(s_shown));
+        memset(s_glyphShown, GLYPH_ROW_UNKNOWN, sizeof(s_glyphShown));
+        s_dirtyRows = (uint8_t)((1U << s_rows) - 1);
+        s_dirtyGlyphs = 0xFF;
+    }
+    kick();
+}
+
+bool lcdTwiIsIdle() {
+    bool idle = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        idle = !twiBusPending(&s_xfer) && s_dirtyRows == 0 && s_dirtyGlyphs == 0 &&
+               !s_backlightPending && !s_resync;
+    }
+    return idle;
+}
+
+uint16_t lcdTwiCellWrites() {
+    uint16_t n = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        n = s_cellWrites;
+    }
+    return n;
+}
+
+uint16_t lcdTwiErrorCount() {
+    uint16_t n = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        n = s_errors;
+    }
+    return n;
+}
+
+#endif // LCD_DISPLAY_ASYNC
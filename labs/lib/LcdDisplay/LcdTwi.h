@@ -0,0 +1,121 @@
+/**
+ * @file LcdTwi.h
+ * @brief Interrupt-Driven HD44780 Transfer Engine for a PCF8574 Backpack
+ *
+ * Asynchronous backend of LcdDisplay (-DLCD_DISPLAY_ASYNC). Callers copy
+ * text into a target framebuffer and return; the TWI interrupt streams
+ * the cells that differ from what is on the glass in the background.
+ *
+ *   LcdDisplay::printLine() ─ memcpy ─► target ─┐
+ *                                               ├─ diff ─► TWI ISR ─► PCF8574
+ *                                      shown ◄──┘   (one cell at a time)
+ *
+ * Every LCD byte is four expander bytes (4-bit mode: high nibble with E
+ * high, E low, then the low nibble), sent back to back in one I2C write
+ * transaction that lasts while cells stay dirty. One expander byte takes
+ * 9 SCL periods, 90 µs at 100 kHz or 22.5 µs at 400 kHz. Between the
+ * latch of one LCD byte (its second E fall) and the next one there are
+ * always at least two expander bytes, ≥ 45 µs, which covers the
+ * HD44780's 37 µs execution time: no delays are needed between
+ * characters or cursor commands at either clock.
+ *
+ * Full 16×2 redraw (32 cells + 2 cursor commands): LiquidCrystal_I2C
+ * ≈ 40 ms (three Wire transmissions and a 50 µs delay per nibble);
+ * LcdTwi ≈ 12 ms at 100 kHz, ≈ 3 ms at 400 kHz. The PCF8574 is rated
+ * for 100 kHz; most backpacks work at 400 kHz, but verify on hardware.
+ *
+ * The engine is a TwiBus client: the cells stream as one preemptible
+ * transaction at LCD_TWI_PRIORITY, refilled cell by cell in the TWI ISR,
+ * so an I2C sensor read submitted at a higher priority pauses the redraw
+ * after the current expander byte instead of waiting for its end. TwiBus
+ * owns the TWI vector, so the build cannot also link Wire
+ * (LiquidCrystal_I2C). Only one display is supported.
+ *
+ * Usage (through LcdDisplay):
+ *   lcdTwiBegin(0x27, 16, 2);             // blocking HD44780 init
+ *   lcdTwiWrite(0, 0, "Hello", 5);        // returns at once
+ */
+
+#ifndef LCD_TWI_H
+#define LCD_TWI_H
+
+#include <Arduino.h>
+#include "TwiBus.h"
+
+/**
+ * @brief I2C clock (PCF8574 datasheet: 100 kHz). The bus clock is
+ * TWI_BUS_CLOCK_HZ, which -DLCD_TWI_CLOCK_HZ=400000UL still sets for
+ * fast mode.
+ */
+#ifndef LCD_TWI_CLOCK_HZ
+#define LCD_TWI_CLOCK_HZ TWI_BUS_CLOCK_HZ
+#endif
+
+/**
+ * @brief TwiBus priority of the LCD traffic (lowest: sensors preempt it).
+ * Override with -DLCD_TWI_PRIORITY=<n>.
+ */
+#ifndef LCD_TWI_PRIORITY
+#define LCD_TWI_PRIORITY 0
+#endif
+
+/** @brief Bound on a blocking transfer during lcdTwiBegin(). */
+#define LCD_TWI_TIMEOUT_MS 10
+
+/** @brief Largest supported geometry. */
+#define LCD_TWI_MAX_COLS 20
+#define LCD_TWI_MAX_ROWS 4
+
+/**
+ * @brief Set up the bus (twiBusBegin()) and initialize the LCD (blocking).
+ *
+ * Runs the HD44780 4-bit power-on sequence (~60 ms, with delay()),
+ * clears the display and turns the backlight on.
+ *
+ * @param address 7-bit I2C address of the backpack (typically 0x27).
+ * @param cols    Columns (1..LCD_TWI_MAX_COLS).
+ * @param rows    Rows (1..LCD_TWI_MAX_ROWS).
+ * @return false if the backpack did not acknowledge.
+ */
+bool lcdTwiBegin(uint8_t address, uint8_t cols, uint8_t rows);
+
+/**
+ * @brief Copy text into the target framebuffer and start the transfer.
+ *
+ * Never blocks. Text is clipped to the row; a row rewritten before the
+ * previous content reached the glass simply shows the newer text.
+ *
+ * @param row  Row (0-based).
+ * @param col  First column.
+ * @param text Characters (not necessarily terminated).
+ * @param len  Number of characters.
+ */
+void lcdTwiWrite(uint8_t row, uint8_t col, const char *text, uint8_t len);
+
+/**
+ * @brief Define a custom character (sent asynchronously).
+ *
+ * Only rows that differ from the CGRAM contents are sent; redefining a
+ * slot with the same bitmap costs nothing.
+ *
+ * @param slot CGRAM slot (0..7).
+ * @param rows Eight rows, bits 4..0 = pixels left to right.
+ */
+void lcdTwiSetGlyph(uint8_t slot, const uint8_t *rows);
+
+/** @brief Switch the backlight (sent asynchronously). */
+void lcdTwiSetBacklight(bool on);
+
+/** @brief Mark every cell unknown so the whole screen is rewritten. */
+void lcdTwiInvalidate();
+
+/** @brief True when the glass matches the target framebuffer. */
+bool lcdTwiIsIdle();
+
+/** @brief Data bytes sent to the LCD since lcdTwiBegin() (wraps). */
+uint16_t lcdTwiCellWrites();
+
+/** @brief Failed transfers (NACK, arbitration loss, timeout; saturates). */
+uint16_t lcdTwiErrorCount();
+
+#endif // LCD_TWI_H
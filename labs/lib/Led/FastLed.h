@@ -0,0 +1,76 @@
+/**
+ * @file FastLed.h
+ * @brief Compile-Time-Pin LED Driver
+ *
+ * Same interface as Led, with the pin as a template parameter: every
+ * method inlines to a FastPin<PIN> register access (SBI/CBI on ports
+ * A–G) instead of a digitalWrite() call. Use it where the LED is driven
+ * from a hot path (FSM output, blink sequencers); Led remains the
+ * choice when the pin is only known at run time.
+ *
+ * Usage:
+ *   FastLed<13> myLed;
+ *   myLed.init();
+ *   myLed.turnOn();
+ */
+
+#ifndef FAST_LED_H
+#define FAST_LED_H
+
+#include <Arduino.h>
+#include "FastPin.h"
+
+/**
+ * @class FastLed
+ * @brief Controls a single LED on a compile-time GPIO pin.
+ * @tparam PIN The GPIO pin number where the LED is connected.
+ */
+template <uint8_t PIN>
+class FastLed {
+public:
+    FastLed() : state(false) {}
+
+    /** @brief Initialize the LED pin as OUTPUT and set it to OFF. */
+    void init() {
+        Pin::low();
+        Pin::output();
+        state = false;
+    }
+
+    /** @brief Turn the LED ON (set pin HIGH). */
+    void turnOn() {
+        Pin::high();
+        state = true;
+    }
+
+    /** @brief Turn the LED OFF (set pin LOW). */
+    void turnOff() {
+        Pin::low();
+        state = false;
+    }
+
+    /** @brief Toggle the LED state (ON becomes OFF, OFF becomes ON). */
+    void toggle() {
+        Pin::toggle();
+        state = !state;
+    }
+
+    /**
+     * @brief Drive the LED to a specific logical state.
+     * @param on true to turn the LED ON, false to turn it OFF.
+     */
+    void set(bool on) {
+        Pin::write(on);
+        state = on;
+    }
+
+    /** @brief Check whether the LED is currently ON. */
+    bool isOn() const { return state; }
+
+private:
+    typedef FastPin<PIN> Pin;
+
+    bool state;  ///< Current LED state (true = ON, false = OFF)
+};
+
+#endif // FAST_LED_H
@@ -4,30 +4,105 @@
  *
  * Implements the Led class methods for controlling an LED
  * via digital GPIO. Uses Arduino's digitalWrite for hardware control.
+ *
+ * Pattern engine: Timer0 runs at 16 MHz / 64 / 256 = 976.5625 Hz for
+ * millis(); its compare-B match fires once per period whatever OCR0B
+ * holds. Each interrupt counts 1 ms plus 24 µs of drift, carried like
+ * millis() does, so step durations match millis() to ±1 ms.
  */
 
 #include "Led.h"
 
+#if defined(__AVR__) && defined(OCIE0B) && !defined(LED_NO_PATTERN_ISR)
+#define LED_HAS_PATTERN_ISR 1
+#include <util/atomic.h>
+#endif
+
+#if defined(LED_HAS_PATTERN_ISR)
+
+/** One LED playing a pattern. Fields are written with interrupts off. */
+typedef struct {
+    const Led *volatile owner;     ///< NULL = free
+    volatile uint8_t *port;        ///< PORTx of the pin
+    uint8_t           mask;        ///< Pin bit
+    const uint16_t   *steps;       ///< Durations, alternating ON/OFF
+    uint8_t           count;       ///< Number of durations
+    uint8_t           step;        ///< Current duration index
+    uint8_t           repeatLeft;  ///< Plays left (0 = forever)
+    uint16_t          remainingMs; ///< Time left in the current step
+} PatternSlot_t;
+
+static PatternSlot_t s_slots[LED_PATTERN_SLOTS];
+static uint16_t s_driftUs = 0;
+
+ISR(TIMER0_COMPB_vect) {
+    uint8_t elapsed = 1;
+    s_driftUs += 24;                     // 1024 µs per Timer0 period
+    if (s_driftUs >= 1000) {
+        s_driftUs -= 1000;
+        elapsed = 2;
+    }
+
+    bool busy = false;
+    for (uint8_t i = 0; i < LED_PATTERN_SLOTS; i++) {
+        PatternSlot_t *s = &s_slots[i];
+        if (s->owner == NULL) {
+            continue;
+        }
+        busy = true;
+        if (s->remainingMs > elapsed) {
+            s->remainingMs -= elapsed;
+            continue;
+        }
+
+        uint8_t step = s->step + 1;
+        if (step >= s->count) {
+            step = 0;
+            if (s->repeatLeft != 0 && --s->repeatLeft == 0) {
+                *s->port &= (uint8_t)~s->mask;   // Done: LED OFF
+                s->owner = NULL;
+                continue;
+            }
+        }
+        s->step = step;
+        s->remainingMs = s->steps[step];
+        if ((step & 1) == 0) {
+            *s->port |= s->mask;                 // Even steps: ON
+        } else {
+            *s->port &= (uint8_t)~s->mask;
+        }
+    }
+
+    if (!busy) {
+        TIMSK0 &= (uint8_t)~_BV(OCIE0B);         // Nothing to play
+    }
+}
+
+#endif // LED_HAS_PATTERN_ISR
+
 Led::Led(uint8_t pin) : ledPin(pin), state(false) {}
 
 void Led::init() {
+    cancelPattern();
     pinMode(ledPin, OUTPUT);
     digitalWrite(ledPin, LOW);
     state = false;
 }
 
 void Led::turnOn() {
+    cancelPattern();
     digitalWrite(ledPin, HIGH);
     state = true;
 }
 
 void Led::turnOff() {
+    cancelPattern();
     digitalWrite(ledPin, LOW);
     state = false;
 }
 
 void Led::toggle() {
-    if (state) {
+    if (isOn()) {
         turnOff();
     } else {
         turnOn();
@@ -43,5 +118,88 @@ void Led::set(bool on) {
 }
 
 bool Led::isOn() const {
+    if (isPatternActive()) {
+        return digitalRead(ledPin) == HIGH;
+    }
     return state;
 }
+
+// ──────────────────────────────────────────────────────────────────────────
+// Pattern engine
+// ──────────────────────────────────────────────────────────────────────────
+
+bool Led::startPattern(const uint16_t *stepsMs, uint8_t stepCount, uint8_t repeat) {
+#if defined(LED_HAS_PATTERN_ISR)
+    if (stepsMs == NULL || stepCount == 0) {
+        return false;
+    }
+    volatile uint8_t *port = portOutputRegister(digitalPinToPort(ledPin));
+    uint8_t mask = digitalPinToBitMask(ledPin);
+
+    bool started = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Reuse this LED's slot, else take a free one.
+        PatternSlot_t *slot = NULL;
+        for (uint8_t i = 0; i < LED_PATTERN_SLOTS; i++) {
+            if (s_slots[i].owner == this) {
+                slot = &s_slots[i];
+                break;
+            }
+            if (slot == NULL && s_slots[i].owner == NULL) {
+                slot = &s_slots[i];
+            }
+        }
+        if (slot != NULL) {
+            slot->owner = this;
+            slot->port = port;
+            slot->mask = mask;
+            slot->steps = stepsMs;
+            slot->count = stepCount;
+            slot->step = 0;
+            slot->repeatLeft = repeat;
+            slot->remainingMs = stepsMs[0];
+            *port |= mask;                        // First step: ON
+            if ((TIMSK0 & _BV(OCIE0B)) == 0) {
+                TIFR0 = _BV(OCF0B);               // Drop a stale match
+                TIMSK0 |= _BV(OCIE0B);
+            }
+            started = true;
+        }
+    }
+    state = false;  // Level is owned by the ISR until the pattern ends
+    return started;
+#else
+    (void)stepsMs;
+    (void)stepCount;
+    (void)repeat;
+    return false;
+#endif
+}
+
+void Led::stopPattern() {
+    turnOff();
+}
+
+bool Led::isPatternActive() const {
+#if defined(LED_HAS_PATTERN_ISR)
+    for (uint8_t i = 0; i < LED_PATTERN_SLOTS; i++) {
+        // The ISR only ever clears owner: a torn read cannot equal this.
+        if (s_slots[i].owner == this) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+void Led::cancelPattern() {
+#if defined(LED_HAS_PATTERN_ISR)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < LED_PATTERN_SLOTS; i++) {
+            if (s_slots[i].owner == this) {
+                s_slots[i].owner = NULL;
+            }
+        }
+    }
+#endif
+}
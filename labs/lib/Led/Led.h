@@ -6,10 +6,25 @@
  * connected to a digital GPIO pin. Supports initialization,
  * turning ON/OFF, toggling, and querying the current state.
  *
+ * Pattern engine (startPattern()):
+ *   Blink sequences run from the Timer0 compare-B interrupt, which fires
+ *   once per Timer0 period (1.024 ms) next to the millis() overflow: no
+ *   extra timer is used and no task has to stay scheduled to blink. A
+ *   pattern is a series of durations (ms) alternating ON, OFF, ON, …,
+ *   played @p repeat times (0 = until stopped); the LED is OFF when it
+ *   ends. Up to LED_PATTERN_SLOTS LEDs can blink at once. The interrupt
+ *   is only enabled while a pattern runs. turnOn()/turnOff()/toggle()/
+ *   set() cancel a running pattern. analogWrite() on D4 (OC0B) only
+ *   shifts the interrupt's phase. Build with -DLED_NO_PATTERN_ISR to
+ *   keep TIMER0_COMPB_vect free (startPattern() then returns false).
+ *
  * Usage:
  *   Led myLed(pinNumber);
  *   myLed.init();
  *   myLed.turnOn();
+ *
+ *   static const uint16_t BLINK[] = {100, 100};  // ON 100 ms, OFF 100 ms
+ *   myLed.startPattern(BLINK, 2, 5);             // 5 blinks, returns at once
  */
 
 #ifndef LED_H
@@ -17,6 +32,14 @@
 
 #include <Arduino.h>
 
+/**
+ * @brief LEDs that can run a pattern at the same time.
+ * Override with -DLED_PATTERN_SLOTS=<n>.
+ */
+#ifndef LED_PATTERN_SLOTS
+#define LED_PATTERN_SLOTS 4
+#endif
+
 /**
  * @class Led
  * @brief Controls a single LED on a specified GPIO pin.
@@ -66,7 +89,30 @@ public:
      */
     bool isOn() const;
 
+    /**
+     * @brief Play a blink pattern in the background (Timer0 compare ISR).
+     *
+     * Replaces any pattern this LED was running and starts with the first
+     * ON step at once.
+     *
+     * @param stepsMs   Durations (1..65535 ms), alternating ON, OFF, …;
+     *                  must stay valid while the pattern runs (static const).
+     * @param stepCount Number of durations (1..255).
+     * @param repeat    Times to play the series; 0 = until stopPattern().
+     * @return false if all LED_PATTERN_SLOTS are in use or without the ISR.
+     */
+    bool startPattern(const uint16_t *stepsMs, uint8_t stepCount, uint8_t repeat);
+
+    /** @brief Stop the pattern (if any) and turn the LED OFF. */
+    void stopPattern();
+
+    /** @brief True while a pattern is playing. */
+    bool isPatternActive() const;
+
 private:
+    /** @brief Release this LED's pattern slot without touching the pin. */
+    void cancelPattern();
+
     uint8_t ledPin;  ///< GPIO pin number
     bool state;      ///< Current LED state (true = ON, false = OFF)
 };
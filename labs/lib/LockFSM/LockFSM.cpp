@@ -3,9 +3,9 @@
  * @brief Lock System Finite State Machine Implementation
  *
  * Implements the LockFSM class that manages an electronic lock
- * through a finite state machine. Each keypad press drives
- * state transitions, with the LCD display content updated
- * automatically at each transition.
+ * through a finite state machine. Each keypad press is classified
+ * and looked up in a state × key-class table (LOCK_TABLE, in flash);
+ * the cell gives the next state and the action to run.
  *
  * State transitions:
  *   IDLE --[*]--> MENU
@@ -14,42 +14,191 @@
  *   MENU --[2]--> CHANGE_WAIT_STAR --[*]--> CHANGE_OLD_PWD --[*]--> CHANGE_NEW_PWD --[#]--> RESULT
  *   MENU --[3]--> STATUS_CONFIRM --[#]--> RESULT
  *   RESULT --[timeout]--> IDLE
+ *
+ * Display texts are PROGMEM tables (STATE_TEXT per state, RESULT_TEXT
+ * per result message) copied out only by renderDisplay().
  */
 
 #include "LockFSM.h"
+#include "FlashString.h"
 #include <string.h>
 #include <stdio.h>
 
 /// Default password set at initialization
 static const char DEFAULT_PASSWORD[] = "1234";
 
+// ============================================================
+// Actions and Result Messages
+// ============================================================
+
+/// Actions attached to transitions (Mealy outputs of the table).
+enum LockAction {
+    ACT_NONE = TABLE_FSM_NONE,  ///< Only change state
+    ACT_REDRAW,                 ///< Redraw the current state
+    ACT_START_ENTRY,            ///< Clear the digit buffer for a new entry
+    ACT_DIGIT,                  ///< Append the key to the digit buffer
+    ACT_CLEAR_ENTRY,            ///< Restart the current entry
+    ACT_SAVE_OLD,               ///< Old password done, start the new one
+    ACT_LOCK,                   ///< Cmd 0 executed
+    ACT_UNLOCK,                 ///< Cmd 1 executed (verify password)
+    ACT_CHANGE,                 ///< Cmd 2 executed (verify old, store new)
+    ACT_STATUS,                 ///< Cmd 3 executed
+    ACT_INVALID_OPTION,         ///< Menu key other than 0..3 and *
+    ACT_UNLOCK_NEED_PWD,        ///< *1# without a password
+    ACT_CHANGE_NEED_PWD,        ///< *2# without passwords
+    ACT_CHANGE_NEED_NEW         ///< *2*old# without a new password
+};
+
+/// Messages of STATE_SHOW_RESULT, indexes into RESULT_TEXT.
+enum LockResult {
+    RESULT_LOCKED,
+    RESULT_UNLOCKED,
+    RESULT_WRONG_PWD,
+    RESULT_PWD_CHANGED,
+    RESULT_EMPTY_PWD,
+    RESULT_WRONG_OLD_PWD,
+    RESULT_STATUS_LOCKED,
+    RESULT_STATUS_UNLOCKED,
+    RESULT_INVALID_OPTION,
+    RESULT_UNLOCK_NEED_PWD,
+    RESULT_CHANGE_NEED_PWD,
+    RESULT_CHANGE_NEED_NEW,
+
+    RESULT_COUNT
+};
+
+// ============================================================
+// PROGMEM Tables
+// ============================================================
+
+/// Two display lines; an empty line2 is replaced by the password mask.
+typedef char LockText[2][17];
+
+static const LockText STATE_TEXT[LOCK_STATE_COUNT] PROGMEM = {
+    /* IDLE             */ { "  Smart Lock    ", "Press * to start" },
+    /* MENU             */ { "0:Lock 1:Unlock ", "2:ChPwd 3:Status" },
+    /* LOCK_CONFIRM     */ { "CMD: Lock       ", "Press # to exec " },
+    /* UNLOCK_WAIT_STAR */ { "CMD: Unlock     ", "Press * for pwd " },
+    /* UNLOCK_PWD       */ { "Enter password: ", "" },
+    /* CHANGE_WAIT_STAR */ { "CMD: Change Pwd ", "Press * for pwd " },
+    /* CHANGE_OLD_PWD   */ { "Old password:   ", "" },
+    /* CHANGE_NEW_PWD   */ { "New password:   ", "" },
+    /* STATUS_CONFIRM   */ { "CMD: Status     ", "Press # to exec " },
+    /* SHOW_RESULT      */ { "", "" }   // RESULT_TEXT instead
+};
+
+static const LockText RESULT_TEXT[RESULT_COUNT] PROGMEM = {
+    /* LOCKED           */ { "Lock Activated",  "Door is LOCKED" },
+    /* UNLOCKED         */ { "Access Granted!", "Door is OPEN" },
+    /* WRONG_PWD        */ { "Wrong Password!", "Access Denied" },
+    /* PWD_CHANGED      */ { "Pwd Changed!",    "Successfully" },
+    /* EMPTY_PWD        */ { "Error: empty pw", "Try again" },
+    /* WRONG_OLD_PWD    */ { "Wrong Old Pwd!",  "Change Denied" },
+    /* STATUS_LOCKED    */ { "Lock Status:",    "** LOCKED **" },
+    /* STATUS_UNLOCKED  */ { "Lock Status:",    "** UNLOCKED **" },
+    /* INVALID_OPTION   */ { "Invalid option!", "Press * to start" },
+    /* UNLOCK_NEED_PWD  */ { "Error: need pwd", "Use *1*pwd#" },
+    /* CHANGE_NEED_PWD  */ { "Error: need pwd", "Use *2*old*new#" },
+    /* CHANGE_NEED_NEW  */ { "Error: need new", "Use *2*old*new#" }
+};
+
+// Cell shorthands: GO = state change only, DO = state change + action.
+#define GO(state)         { state, ACT_NONE, TABLE_FSM_NONE }
+#define DO(state, action) { state, action, TABLE_FSM_NONE }
+
+// Shorter state names for the table below.
+#define S_IDLE   STATE_IDLE
+#define S_MENU   STATE_MENU
+#define S_LOCK   STATE_LOCK_CONFIRM
+#define S_UWAIT  STATE_UNLOCK_WAIT_STAR
+#define S_UPWD   STATE_UNLOCK_PWD
+#define S_CWAIT  STATE_CHANGE_WAIT_STAR
+#define S_COLD   STATE_CHANGE_OLD_PWD
+#define S_CNEW   STATE_CHANGE_NEW_PWD
+#define S_STAT   STATE_STATUS_CONFIRM
+#define S_RES    STATE_SHOW_RESULT
+
+/// Digit in a password entry state (0..9 all append).
+#define DIGIT(state) DO(state, ACT_DIGIT)
+
+static constexpr TableFsmTable<LOCK_STATE_COUNT, LOCK_KEY_CLASS_COUNT> LOCK_TABLE PROGMEM = {
+    { 0 },  // No Moore outputs: the display is rendered from STATE_TEXT
+    {
+        //           *                           #                                0                 1                 2                 3                 4..9                         A..D / other                 timeout
+        /* IDLE  */ { GO(S_MENU),                 GO(S_IDLE),                       GO(S_IDLE),       GO(S_IDLE),       GO(S_IDLE),       GO(S_IDLE),       GO(S_IDLE),                  GO(S_IDLE),                  GO(S_IDLE) },
+        /* MENU  */ { DO(S_MENU, ACT_REDRAW),     DO(S_RES, ACT_INVALID_OPTION),    GO(S_LOCK),       GO(S_UWAIT),      GO(S_CWAIT),      GO(S_STAT),       DO(S_RES, ACT_INVALID_OPTION), DO(S_RES, ACT_INVALID_OPTION), GO(S_MENU) },
+        /* LOCK  */ { GO(S_MENU),                 DO(S_RES, ACT_LOCK),              GO(S_LOCK),       GO(S_LOCK),       GO(S_LOCK),       GO(S_LOCK),       GO(S_LOCK),                  GO(S_LOCK),                  GO(S_LOCK) },
+        /* UWAIT */ { DO(S_UPWD, ACT_START_ENTRY), DO(S_RES, ACT_UNLOCK_NEED_PWD),  GO(S_UWAIT),      GO(S_UWAIT),      GO(S_UWAIT),      GO(S_UWAIT),      GO(S_UWAIT),                 GO(S_UWAIT),                 GO(S_UWAIT) },
+        /* UPWD  */ { DO(S_UPWD, ACT_CLEAR_ENTRY), DO(S_RES, ACT_UNLOCK),           DIGIT(S_UPWD),    DIGIT(S_UPWD),    DIGIT(S_UPWD),    DIGIT(S_UPWD),    DIGIT(S_UPWD),               GO(S_UPWD),                  GO(S_UPWD) },
+        /* CWAIT */ { DO(S_COLD, ACT_START_ENTRY), DO(S_RES, ACT_CHANGE_NEED_PWD),  GO(S_CWAIT),      GO(S_CWAIT),      GO(S_CWAIT),      GO(S_CWAIT),      GO(S_CWAIT),                 GO(S_CWAIT),                 GO(S_CWAIT) },
+        /* COLD  */ { DO(S_CNEW, ACT_SAVE_OLD),    DO(S_RES, ACT_CHANGE_NEED_NEW),  DIGIT(S_COLD),    DIGIT(S_COLD),    DIGIT(S_COLD),    DIGIT(S_COLD),    DIGIT(S_COLD),               GO(S_COLD),                  GO(S_COLD) },
+        /* CNEW  */ { DO(S_CNEW, ACT_CLEAR_ENTRY), DO(S_RES, ACT_CHANGE),           DIGIT(S_CNEW),    DIGIT(S_CNEW),    DIGIT(S_CNEW),    DIGIT(S_CNEW),    DIGIT(S_CNEW),               GO(S_CNEW),                  GO(S_CNEW) },
+        /* STAT  */ { GO(S_MENU),                 DO(S_RES, ACT_STATUS),            GO(S_STAT),       GO(S_STAT),       GO(S_STAT),       GO(S_STAT),       GO(S_STAT),                  GO(S_STAT),                  GO(S_STAT) },
+        /* RES   */ { GO(S_MENU),                 GO(S_IDLE),                       GO(S_IDLE),       GO(S_IDLE),       GO(S_IDLE),       GO(S_IDLE),       GO(S_IDLE),                  GO(S_IDLE),                  GO(S_IDLE) }
+    }
+};
+static_assert(tableFsmIsValid(LOCK_TABLE, 0), "LockFSM table out of range");
+
+#undef GO
+#undef DO
+#undef DIGIT
+#undef S_IDLE
+#undef S_MENU
+#undef S_LOCK
+#undef S_UWAIT
+#undef S_UPWD
+#undef S_CWAIT
+#undef S_COLD
+#undef S_CNEW
+#undef S_STAT
+#undef S_RES
+
+/// Copy one PROGMEM text line (17 bytes, terminated).
+static void copyTextLine(char *out, const char *text) {
+#if defined(__AVR__)
+    memcpy_P(out, text, 17);
+#else
+    memcpy(out, text, 17);
+#endif
+}
+
+/// Table column of a key character.
+static uint8_t classifyKey(char key) {
+    if (key == '*') return KEY_CLASS_STAR;
+    if (key == '#') return KEY_CLASS_HASH;
+    if (key >= '0' && key <= '3') return (uint8_t)(KEY_CLASS_0 + (key - '0'));
+    if (key >= '4' && key <= '9') return KEY_CLASS_DIGIT;
+    return KEY_CLASS_OTHER;
+}
+
 // ============================================================
 // Constructor and Initialization
 // ============================================================
 
 LockFSM::LockFSM()
-    : _state(STATE_IDLE)
+    : _fsm(&LOCK_TABLE, STATE_IDLE)
     , _locked(true)
     , _inputLen(0)
+    , _result(RESULT_LOCKED)
     , _displayChanged(true)
-    , _resultStartTime(0)
+    , _resultTimeout(onResultTimeout, this)
 {
     strncpy(_password, DEFAULT_PASSWORD, MAX_PWD_LEN);
     _password[MAX_PWD_LEN] = '\0';
     _inputBuffer[0] = '\0';
     _oldPwdBuffer[0] = '\0';
-    memset(&_display, 0, sizeof(_display));
 }
 
 void LockFSM::init() {
-    _state = STATE_IDLE;
+    _fsm.init();
+    _resultTimeout.stop();
     _locked = true;
     strncpy(_password, DEFAULT_PASSWORD, MAX_PWD_LEN);
     _password[MAX_PWD_LEN] = '\0';
     clearInput();
     _oldPwdBuffer[0] = '\0';
-    updateDisplay();
-    printf("[FSM] Initialized. Default password: %s\r\n", DEFAULT_PASSWORD);
+    _displayChanged = true;
+    FLASH_PRINTF("[FSM] Initialized. Default password: %s\r\n", DEFAULT_PASSWORD);
 }
 
 // ============================================================
@@ -59,171 +208,19 @@ void LockFSM::init() {
 void LockFSM::processKey(char key) {
     if (key == 0) return;
 
-    printf("[KEY] '%c' in state %d\r\n", key, (int)_state);
-
-    switch (_state) {
-
-        // --- IDLE: waiting for * to begin ---
-        case STATE_IDLE:
-            if (key == '*') {
-                setState(STATE_MENU);
-            }
-            // All other keys ignored in IDLE
-            break;
-
-        // --- MENU: show options, wait for command digit 0-3 ---
-        case STATE_MENU:
-            if (key == '0') {
-                setState(STATE_LOCK_CONFIRM);
-            } else if (key == '1') {
-                setState(STATE_UNLOCK_WAIT_STAR);
-            } else if (key == '2') {
-                setState(STATE_CHANGE_WAIT_STAR);
-            } else if (key == '3') {
-                setState(STATE_STATUS_CONFIRM);
-            } else if (key == '*') {
-                // Refresh menu display
-                updateDisplay();
-            } else {
-                setResult("Invalid option!", "Press * to start");
-            }
-            break;
-
-        // --- CMD 0: Lock --- waiting for # to confirm ---
-        case STATE_LOCK_CONFIRM:
-            if (key == '#') {
-                _locked = true;
-                printf("[LOCK] Locked unconditionally\r\n");
-                setResult("Lock Activated", "Door is LOCKED");
-            } else if (key == '*') {
-                setState(STATE_MENU);
-            }
-            break;
-
-        // --- CMD 1: Unlock --- waiting for * to begin password ---
-        case STATE_UNLOCK_WAIT_STAR:
-            if (key == '*') {
-                clearInput();
-                setState(STATE_UNLOCK_PWD);
-            } else if (key == '#') {
-                setResult("Error: need pwd", "Use *1*pwd#");
-            }
-            break;
-
-        // --- CMD 1: Unlock --- entering password digits ---
-        case STATE_UNLOCK_PWD:
-            if (key >= '0' && key <= '9') {
-                appendDigit(key);
-                updateDisplay();
-            } else if (key == '#') {
-                // Execute unlock attempt
-                if (strcmp(_inputBuffer, _password) == 0) {
-                    _locked = false;
-                    printf("[LOCK] Unlocked successfully\r\n");
-                    setResult("Access Granted!", "Door is OPEN");
-                } else {
-                    printf("[LOCK] Wrong password entered\r\n");
-                    setResult("Wrong Password!", "Access Denied");
-                }
-                clearInput();
-            } else if (key == '*') {
-                // Clear and restart password entry
-                clearInput();
-                updateDisplay();
-            }
-            break;
-
-        // --- CMD 2: Change --- waiting for * to begin old password ---
-        case STATE_CHANGE_WAIT_STAR:
-            if (key == '*') {
-                clearInput();
-                setState(STATE_CHANGE_OLD_PWD);
-            } else if (key == '#') {
-                setResult("Error: need pwd", "Use *2*old*new#");
-            }
-            break;
-
-        // --- CMD 2: Change --- entering old password digits ---
-        case STATE_CHANGE_OLD_PWD:
-            if (key >= '0' && key <= '9') {
-                appendDigit(key);
-                updateDisplay();
-            } else if (key == '*') {
-                // Save old password buffer and move to new password
-                strncpy(_oldPwdBuffer, _inputBuffer, MAX_PWD_LEN);
-                _oldPwdBuffer[MAX_PWD_LEN] = '\0';
-                clearInput();
-                setState(STATE_CHANGE_NEW_PWD);
-            } else if (key == '#') {
-                setResult("Error: need new", "Use *2*old*new#");
-            }
-            break;
-
-        // --- CMD 2: Change --- entering new password digits ---
-        case STATE_CHANGE_NEW_PWD:
-            if (key >= '0' && key <= '9') {
-                appendDigit(key);
-                updateDisplay();
-            } else if (key == '#') {
-                // Verify old password and apply change
-                if (strcmp(_oldPwdBuffer, _password) == 0) {
-                    if (_inputLen > 0) {
-                        strncpy(_password, _inputBuffer, MAX_PWD_LEN);
-                        _password[MAX_PWD_LEN] = '\0';
-                        printf("[LOCK] Password changed to: %s\r\n",
-                               _password);
-                        setResult("Pwd Changed!", "Successfully");
-                    } else {
-                        setResult("Error: empty pw", "Try again");
-                    }
-                } else {
-                    printf("[LOCK] Wrong old password\r\n");
-                    setResult("Wrong Old Pwd!", "Change Denied");
-                }
-                clearInput();
-                _oldPwdBuffer[0] = '\0';
-            } else if (key == '*') {
-                // Clear and restart new password entry
-                clearInput();
-                updateDisplay();
-            }
-            break;
-
-        // --- CMD 3: Status --- waiting for # to display ---
-        case STATE_STATUS_CONFIRM:
-            if (key == '#') {
-                if (_locked) {
-                    printf("[LOCK] Status: LOCKED\r\n");
-                    setResult("Lock Status:", "** LOCKED **");
-                } else {
-                    printf("[LOCK] Status: UNLOCKED\r\n");
-                    setResult("Lock Status:", "** UNLOCKED **");
-                }
-            } else if (key == '*') {
-                setState(STATE_MENU);
-            }
-            break;
+    FLASH_PRINTF("[KEY] '%c' in state %d\r\n", key, (int)_fsm.getState());
 
-        // --- RESULT: showing message, any key returns ---
-        case STATE_SHOW_RESULT:
-            if (key == '*') {
-                setState(STATE_MENU);
-            } else {
-                setState(STATE_IDLE);
-            }
-            break;
-    }
+    dispatch(classifyKey(key), key);
 }
 
 // ============================================================
-// Periodic Update (Timed Transitions)
+// Timed Transitions
 // ============================================================
 
-void LockFSM::update() {
-    if (_state == STATE_SHOW_RESULT) {
-        if (millis() - _resultStartTime >= RESULT_DISPLAY_MS) {
-            setState(STATE_IDLE);
-        }
+void LockFSM::onResultTimeout(void *context) {
+    LockFSM *fsm = (LockFSM *)context;
+    if (fsm->_fsm.getState() == STATE_SHOW_RESULT) {
+        fsm->dispatch(KEY_CLASS_TIMEOUT, 0);
     }
 }
 
@@ -232,15 +229,49 @@ void LockFSM::update() {
 // ============================================================
 
 LockFSMState LockFSM::getState() const {
-    return _state;
+    return (LockFSMState)_fsm.getState();
 }
 
 bool LockFSM::isLocked() const {
     return _locked;
 }
 
-const LockDisplay& LockFSM::getDisplay() const {
-    return _display;
+const char *LockFSM::getPassword() const {
+    return _password;
+}
+
+bool LockFSM::setPassword(const char *password) {
+    size_t len = strlen(password);
+    if (len == 0 || len > MAX_PWD_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (password[i] < '0' || password[i] > '9') {
+            return false;
+        }
+    }
+    memcpy(_password, password, len + 1);
+    return true;
+}
+
+void LockFSM::renderDisplay(LockDisplay &out) const {
+    uint8_t state = _fsm.getState();
+    const LockText *text = (state == STATE_SHOW_RESULT) ? &RESULT_TEXT[_result]
+                                                        : &STATE_TEXT[state];
+    copyTextLine(out.line1, (*text)[0]);
+    copyTextLine(out.line2, (*text)[1]);
+
+    if (state != STATE_SHOW_RESULT && out.line2[0] == '\0') {
+        // Password entry: one '*' per digit, padded with spaces
+        uint8_t i;
+        for (i = 0; i < _inputLen && i < 16; i++) {
+            out.line2[i] = '*';
+        }
+        for (; i < 16; i++) {
+            out.line2[i] = ' ';
+        }
+        out.line2[16] = '\0';
+    }
 }
 
 bool LockFSM::displayChanged() const {
@@ -255,108 +286,116 @@ void LockFSM::clearDisplayChanged() {
 // Private Helpers
 // ============================================================
 
-void LockFSM::setState(LockFSMState newState) {
-    _state = newState;
-    printf("[FSM] -> state %d\r\n", (int)_state);
-    updateDisplay();
+void LockFSM::dispatch(uint8_t keyClass, char key) {
+    if (!_fsm.dispatch(keyClass)) {
+        return;  // Key ignored in this state
+    }
+    if (_fsm.changed()) {
+        _fsm.clearChanged();
+        _displayChanged = true;
+        FLASH_PRINTF("[FSM] -> state %d\r\n", (int)_fsm.getState());
+    }
+    runAction(_fsm.getMealyOutput(), key);
 }
 
-void LockFSM::updateDisplay() {
-    _displayChanged = true;
+void LockFSM::runAction(uint8_t action, char key) {
+    switch (action) {
+        case ACT_NONE:
+            break;
 
-    switch (_state) {
-        case STATE_IDLE:
-            strncpy(_display.line1, "  Smart Lock    ", 17);
-            strncpy(_display.line2, "Press * to start", 17);
+        case ACT_REDRAW:
+            _displayChanged = true;
             break;
 
-        case STATE_MENU:
-            strncpy(_display.line1, "0:Lock 1:Unlock ", 17);
-            strncpy(_display.line2, "2:ChPwd 3:Status", 17);
+        case ACT_START_ENTRY:
+            clearInput();
             break;
 
-        case STATE_LOCK_CONFIRM:
-            strncpy(_display.line1, "CMD: Lock       ", 17);
-            strncpy(_display.line2, "Press # to exec ", 17);
+        case ACT_DIGIT:
+            appendDigit(key);
+            _displayChanged = true;
             break;
 
-        case STATE_UNLOCK_WAIT_STAR:
-            strncpy(_display.line1, "CMD: Unlock     ", 17);
-            strncpy(_display.line2, "Press * for pwd ", 17);
+        case ACT_CLEAR_ENTRY:
+            clearInput();
+            _displayChanged = true;
             break;
 
-        case STATE_UNLOCK_PWD: {
-            strncpy(_display.line1, "Enter password: ", 17);
-            // Build masked password display
-            char mask[17];
-            uint8_t i;
-            for (i = 0; i < _inputLen && i < 16; i++) {
-                mask[i] = '*';
-            }
-            // Pad with spaces
-            for (; i < 16; i++) {
-                mask[i] = ' ';
-            }
-            mask[16] = '\0';
-            strncpy(_display.line2, mask, 17);
+        case ACT_SAVE_OLD:
+            // Save old password buffer and move to new password
+            strncpy(_oldPwdBuffer, _inputBuffer, MAX_PWD_LEN);
+            _oldPwdBuffer[MAX_PWD_LEN] = '\0';
+            clearInput();
             break;
-        }
 
-        case STATE_CHANGE_WAIT_STAR:
-            strncpy(_display.line1, "CMD: Change Pwd ", 17);
-            strncpy(_display.line2, "Press * for pwd ", 17);
+        case ACT_LOCK:
+            _locked = true;
+            FLASH_PRINTF("[LOCK] Locked unconditionally\r\n");
+            setResult(RESULT_LOCKED);
             break;
 
-        case STATE_CHANGE_OLD_PWD: {
-            strncpy(_display.line1, "Old password:   ", 17);
-            char mask[17];
-            uint8_t i;
-            for (i = 0; i < _inputLen && i < 16; i++) {
-                mask[i] = '*';
-            }
-            for (; i < 16; i++) {
-                mask[i] = ' ';
+        case ACT_UNLOCK:
+            if (strcmp(_inputBuffer, _password) == 0) {
+                _locked = false;
+                FLASH_PRINTF("[LOCK] Unlocked successfully\r\n");
+                setResult(RESULT_UNLOCKED);
+            } else {
+                FLASH_PRINTF("[LOCK] Wrong password entered\r\n");
+                setResult(RESULT_WRONG_PWD);
             }
-            mask[16] = '\0';
-            strncpy(_display.line2, mask, 17);
+            clearInput();
             break;
-        }
 
-        case STATE_CHANGE_NEW_PWD: {
-            strncpy(_display.line1, "New password:   ", 17);
-            char mask[17];
-            uint8_t i;
-            for (i = 0; i < _inputLen && i < 16; i++) {
-                mask[i] = '*';
-            }
-            for (; i < 16; i++) {
-                mask[i] = ' ';
+        case ACT_CHANGE:
+            // Verify old password and apply change
+            if (strcmp(_oldPwdBuffer, _password) == 0) {
+                if (_inputLen > 0) {
+                    strncpy(_password, _inputBuffer, MAX_PWD_LEN);
+                    _password[MAX_PWD_LEN] = '\0';
+                    FLASH_PRINTF("[LOCK] Password changed to: %s\r\n", _password);
+                    setResult(RESULT_PWD_CHANGED);
+                } else {
+                    setResult(RESULT_EMPTY_PWD);
+                }
+            } else {
+                FLASH_PRINTF("[LOCK] Wrong old password\r\n");
+                setResult(RESULT_WRONG_OLD_PWD);
             }
-            mask[16] = '\0';
-            strncpy(_display.line2, mask, 17);
+            clearInput();
+            _oldPwdBuffer[0] = '\0';
+            break;
+
+        case ACT_STATUS:
+            FLASH_PRINTF("[LOCK] Status: %s\r\n", _locked ? "LOCKED" : "UNLOCKED");
+            setResult(_locked ? RESULT_STATUS_LOCKED : RESULT_STATUS_UNLOCKED);
             break;
-        }
 
-        case STATE_STATUS_CONFIRM:
-            strncpy(_display.line1, "CMD: Status     ", 17);
-            strncpy(_display.line2, "Press # to exec ", 17);
+        case ACT_INVALID_OPTION:
+            setResult(RESULT_INVALID_OPTION);
             break;
 
-        case STATE_SHOW_RESULT:
-            // Display content is already set by setResult()
+        case ACT_UNLOCK_NEED_PWD:
+            setResult(RESULT_UNLOCK_NEED_PWD);
+            break;
+
+        case ACT_CHANGE_NEED_PWD:
+            setResult(RESULT_CHANGE_NEED_PWD);
+            break;
+
+        case ACT_CHANGE_NEED_NEW:
+            setResult(RESULT_CHANGE_NEED_NEW);
             break;
     }
 }
 
-void LockFSM::setResult(const char *line1, const char *line2) {
-    _state = STATE_SHOW_RESULT;
-    _resultStartTime = millis();
-    strncpy(_display.line1, line1, 16);
-    _display.line1[16] = '\0';
-    strncpy(_display.line2, line2, 16);
-    _display.line2[16] = '\0';
+void LockFSM::setResult(uint8_t result) {
+    _result = result;
+    _resultTimeout.start(RESULT_DISPLAY_MS);
     _displayChanged = true;
-    printf("[FSM] Result: %s | %s\r\n", _display.line1, _display.line2);
+
+    LockDisplay text;
+    renderDisplay(text);
+    FLASH_PRINTF("[FSM] Result: %s | %s\r\n", text.line1, text.line2);
 }
 
 void LockFSM::clearInput() {
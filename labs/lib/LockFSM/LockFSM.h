@@ -17,12 +17,22 @@
  * and outputs display data (two 16-character lines) for the LCD.
  * LED control and LCD updates are handled by the application layer.
  *
+ * Behaviour is a state × key-class table run by TableFsm (see
+ * LockFSM.cpp): a key is classified (*, #, 0..3, other digit, letter,
+ * plus a timeout pseudo-key), one cell gives the next state and the
+ * action, so every key costs one lookup. Menu and result texts live in
+ * PROGMEM; the two display lines are only built when the application
+ * asks for them with renderDisplay().
+ *
  * Usage:
  *   LockFSM fsm;
  *   fsm.init();
  *   fsm.processKey('*');
+ *   Timeout::poll();                  // in loop(): result display timeout
  *   if (fsm.displayChanged()) {
- *       lcd.showTwoLines(fsm.getDisplay().line1, fsm.getDisplay().line2);
+ *       LockDisplay d;
+ *       fsm.renderDisplay(d);
+ *       lcd.showTwoLines(d.line1, d.line2);
  *       fsm.clearDisplayChanged();
  *   }
  */
@@ -31,6 +41,8 @@
 #define LOCK_FSM_H
 
 #include <Arduino.h>
+#include "TableFsm.h"
+#include "Timeout.h"
 
 /// Maximum password length (digits)
 static const uint8_t MAX_PWD_LEN = 8;
@@ -52,12 +64,33 @@ enum LockFSMState {
     STATE_CHANGE_OLD_PWD,    ///< Cmd 2: entering old password digits, * to continue
     STATE_CHANGE_NEW_PWD,    ///< Cmd 2: entering new password digits, # to execute
     STATE_STATUS_CONFIRM,    ///< Cmd 3: waiting for # to show status
-    STATE_SHOW_RESULT        ///< Displaying result message (auto-timeout)
+    STATE_SHOW_RESULT,       ///< Displaying result message (auto-timeout)
+
+    LOCK_STATE_COUNT
+};
+
+/**
+ * @enum LockKeyClass
+ * @brief Columns of the transition table: keys grouped by meaning.
+ */
+enum LockKeyClass {
+    KEY_CLASS_STAR,          ///< '*'
+    KEY_CLASS_HASH,          ///< '#'
+    KEY_CLASS_0,             ///< '0' (menu: lock)
+    KEY_CLASS_1,             ///< '1' (menu: unlock)
+    KEY_CLASS_2,             ///< '2' (menu: change password)
+    KEY_CLASS_3,             ///< '3' (menu: status)
+    KEY_CLASS_DIGIT,         ///< '4'..'9'
+    KEY_CLASS_OTHER,         ///< 'A'..'D' and anything else
+    KEY_CLASS_TIMEOUT,       ///< Result display timed out (from _resultTimeout)
+
+    LOCK_KEY_CLASS_COUNT
 };
 
 /**
  * @struct LockDisplay
- * @brief Holds the two display lines for the LCD (16 chars each).
+ * @brief Two display lines for the LCD (16 chars each), filled by
+ *        LockFSM::renderDisplay().
  */
 struct LockDisplay {
     char line1[17];  ///< First LCD row (16 chars + null terminator)
@@ -98,15 +131,6 @@ public:
      */
     void processKey(char key);
 
-    /**
-     * @brief Periodic update for timed state transitions.
-     *
-     * Must be called every loop iteration. Handles the automatic
-     * transition from STATE_SHOW_RESULT back to STATE_IDLE after
-     * the result display timeout elapses.
-     */
-    void update();
-
     /**
      * @brief Get the current FSM state.
      * @return The current LockFSMState.
@@ -120,10 +144,23 @@ public:
     bool isLocked() const;
 
     /**
-     * @brief Get the current display content.
-     * @return Reference to the LockDisplay struct with line1 and line2.
+     * @brief Get the current password.
+     * @return Null-terminated digit string (valid until the next change).
      */
-    const LockDisplay& getDisplay() const;
+    const char *getPassword() const;
+
+    /**
+     * @brief Replace the password, e.g. with one restored from EEPROM.
+     * @param password 1..MAX_PWD_LEN digits.
+     * @return True if accepted; false leaves the password unchanged.
+     */
+    bool setPassword(const char *password);
+
+    /**
+     * @brief Build the current display content (texts read from PROGMEM).
+     * @param out Receives line1 and line2, each null-terminated.
+     */
+    void renderDisplay(LockDisplay &out) const;
 
     /**
      * @brief Check if the display content was updated since last clear.
@@ -136,34 +173,43 @@ public:
      */
     void clearDisplayChanged();
 
+    /** @brief Record transitions in FsmTrace under id (-DFSM_TRACE_ENABLED). */
+    void setTraceId(uint8_t id) { _fsm.setTraceId(id); }
+
 private:
-    LockFSMState _state;                   ///< Current FSM state
+    TableFsm<LOCK_STATE_COUNT, LOCK_KEY_CLASS_COUNT> _fsm;  ///< State + table
     bool _locked;                          ///< True if lock is engaged
     char _password[MAX_PWD_LEN + 1];       ///< Current valid password
     char _inputBuffer[MAX_PWD_LEN + 1];    ///< Buffer for password digit entry
     char _oldPwdBuffer[MAX_PWD_LEN + 1];   ///< Buffer for old password (during change)
     uint8_t _inputLen;                     ///< Number of digits in input buffer
-    LockDisplay _display;                  ///< Current display content
+    uint8_t _result;                       ///< Message shown in STATE_SHOW_RESULT
     bool _displayChanged;                  ///< Flag: display needs LCD update
-    unsigned long _resultStartTime;        ///< Timestamp when result was shown
+    Timeout _resultTimeout;                ///< Returns from STATE_SHOW_RESULT to idle
+
+    /** @brief _resultTimeout callback: feeds KEY_CLASS_TIMEOUT to the FSM. */
+    static void onResultTimeout(void *context);
 
     /**
-     * @brief Transition to a new state and update the display.
-     * @param newState The target FSM state.
+     * @brief Look up and take the transition for a key class, then run
+     *        its action.
+     * @param keyClass Table column (LockKeyClass).
+     * @param key      Key character (0 for KEY_CLASS_TIMEOUT).
      */
-    void setState(LockFSMState newState);
+    void dispatch(uint8_t keyClass, char key);
 
     /**
-     * @brief Update the display content based on the current state.
+     * @brief Run the action of the transition just taken.
+     * @param action Action code from the table's Mealy output.
+     * @param key    Key that triggered it (digit for ACT_DIGIT).
      */
-    void updateDisplay();
+    void runAction(uint8_t action, char key);
 
     /**
-     * @brief Set a result message and transition to STATE_SHOW_RESULT.
-     * @param line1 First line of the result message (max 16 chars).
-     * @param line2 Second line of the result message (max 16 chars).
+     * @brief Select the message of STATE_SHOW_RESULT and start its timeout.
+     * @param result Index into the PROGMEM result texts.
      */
-    void setResult(const char *line1, const char *line2);
+    void setResult(uint8_t result);
 
     /**
      * @brief Clear the input buffer and reset the digit counter.
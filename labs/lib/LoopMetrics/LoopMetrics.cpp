@@ -0,0 +1,140 @@
+/**
+ * @file LoopMetrics.cpp
+ * @brief Online Control-Loop Performance Figures Implementation
+ */
+
+#include "LoopMetrics.h"
+#include <math.h>
+
+LoopMetrics::LoopMetrics(uint32_t windowMs, float stepThreshold)
+    : _bucketMs(windowMs / LOOP_METRICS_BUCKETS),
+      _stepThreshold(stepThreshold),
+      _band(0.5f) {
+    if (_bucketMs == 0) {
+        _bucketMs = 1;
+    }
+    reset();
+}
+
+void LoopMetrics::reset() {
+    for (uint8_t i = 0; i < LOOP_METRICS_BUCKETS; i++) {
+        clearBucket(_buckets[i]);
+    }
+    _head = 0;
+    _step = StepMetrics();
+    _steps = 0;
+    _lastOvershoot = NAN;
+    _lastSettleS = NAN;
+    _lastIae = NAN;
+    _lastError = 0.0f;
+    _lastOutput = 0.0f;
+    _lastSwitches = 0;
+    _lastMs = 0;
+    _haveError = false;
+    _started = false;
+}
+
+void LoopMetrics::setSettleBand(float band) {
+    _band = (band > 0.0f) ? band : 0.0f;
+}
+
+void LoopMetrics::clearBucket(Bucket &bucket) {
+    bucket.iae = 0.0f;
+    bucket.ise = 0.0f;
+    bucket.travel = 0.0f;
+    bucket.switches = 0;
+    bucket.ms = 0;
+}
+
+/** @brief Credit dtMs to the head bucket; start the next one once it is full. */
+void LoopMetrics::advance(uint32_t dtMs) {
+    Bucket &bucket = _buckets[_head];
+    bucket.ms += dtMs;
+    if (bucket.ms >= _bucketMs) {
+        _head = (uint8_t)((_head + 1) % LOOP_METRICS_BUCKETS);
+        clearBucket(_buckets[_head]);
+    }
+}
+
+/** @brief Keep the figures of the step that just ended. */
+void LoopMetrics::finishStep() {
+    _lastOvershoot = _step.getOvershoot();
+    _lastSettleS = _step.isSettled() ? _step.getSettlingTimeMs() / 1000.0f : NAN;
+    _lastIae = _step.getIae();
+}
+
+void LoopMetrics::update(float setpoint, float measured, float outputPercent,
+                         uint32_t switches, uint32_t nowMs) {
+    if (!_started) {
+        _lastOutput = outputPercent;
+        _lastSwitches = switches;
+        _lastMs = nowMs;
+        _started = true;
+    }
+
+    // The interval since the last cycle, scored with the error held over it.
+    uint32_t dtMs = (uint32_t)(nowMs - _lastMs);
+    Bucket &bucket = _buckets[_head];
+    if (_haveError) {
+        float dtS = (float)dtMs / 1000.0f;
+        bucket.iae += fabsf(_lastError) * dtS;
+        bucket.ise += _lastError * _lastError * dtS;
+    }
+    bucket.travel += fabsf(outputPercent - _lastOutput);
+    uint32_t switched = (uint32_t)(switches - _lastSwitches);
+    bucket.switches = (bucket.switches + switched > 0xFFFFUL)
+                          ? 0xFFFF
+                          : (uint16_t)(bucket.switches + switched);
+    advance(dtMs);
+    _lastOutput = outputPercent;
+    _lastSwitches = switches;
+    _lastMs = nowMs;
+
+    if (isnan(measured)) {
+        _haveError = false;
+        return;
+    }
+    if (!_step.isActive()) {
+        _step.begin(setpoint, measured, nowMs, _band);
+    } else if (fabsf(setpoint - _step.getSetpoint()) >= _stepThreshold) {
+        finishStep();
+        _steps++;
+        _step.begin(setpoint, measured, nowMs, _band);
+    } else {
+        _step.update(measured, nowMs);
+    }
+    _lastError = setpoint - measured;
+    _haveError = true;
+}
+
+void LoopMetrics::getReport(LoopMetricsReport *out) const {
+    uint32_t spanMs = 0;
+    uint32_t switches = 0;
+    out->iae = 0.0f;
+    out->ise = 0.0f;
+    out->travel = 0.0f;
+    for (uint8_t i = 0; i < LOOP_METRICS_BUCKETS; i++) {
+        const Bucket &bucket = _buckets[i];
+        spanMs += bucket.ms;
+        switches += bucket.switches;
+        out->iae += bucket.iae;
+        out->ise += bucket.ise;
+        out->travel += bucket.travel;
+    }
+    out->windowS = spanMs / 1000.0f;
+    out->switches = (switches > 0xFFFFUL) ? 0xFFFF : (uint16_t)switches;
+    out->switchesPerHour = (spanMs > 0) ? (float)switches * 3600000.0f / (float)spanMs : 0.0f;
+    out->steps = _steps;
+
+    out->stepOvershoot = _step.getOvershoot();
+    out->stepSettleS = _step.isSettled() ? _step.getSettlingTimeMs() / 1000.0f : NAN;
+    out->stepIae = _step.getIae();
+    out->stepElapsedS = _step.getElapsedMs() / 1000.0f;
+    out->lastOvershoot = _lastOvershoot;
+    out->lastSettleS = _lastSettleS;
+    out->lastIae = _lastIae;
+}
+
+const StepMetrics &LoopMetrics::getStep() const {
+    return _step;
+}
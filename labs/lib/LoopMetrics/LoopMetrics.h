@@ -0,0 +1,139 @@
+/**
+ * @file LoopMetrics.h
+ * @brief Online Control-Loop Performance Figures over a Rolling Window
+ *
+ * StepMetrics scores one setpoint step; a running loop also needs to
+ * show how well it holds the setpoint between steps and what that costs
+ * the actuator, so a tuning change can be judged on the live process and
+ * not only in the simulator. Fed once per control cycle, LoopMetrics
+ * keeps
+ *
+ *   rolling window  over the last windowMs, in LOOP_METRICS_BUCKETS
+ *                   buckets (the oldest is dropped whole, so the window
+ *                   covers between (B−1)/B and all of windowMs):
+ *     IAE     ∫|e| dt              (°C·s)
+ *     ISE     ∫e² dt               (°C²·s; weighs large errors)
+ *     travel  Σ|Δu| of the output  (% — actuator wear, PID noise)
+ *     switches of the relay or fan, also as a rate per hour
+ *   per step        a StepMetrics for the present setpoint step and
+ *                   the figures of the last finished one: overshoot,
+ *                   settling time (±band), IAE
+ *
+ * A new step starts when the setpoint moves by stepThreshold or more
+ * from the step's own. Errors are held over each interval as in
+ * StepMetrics (the value the controller acted on); an invalid reading
+ * (NAN) adds no error and the next valid one starts a fresh interval.
+ * The switch count is the caller's running counter (the actuation
+ * task's), so switches between two control cycles are not missed.
+ *
+ * Times are those passed in, so the figures hold in real time on the
+ * target and in simulated time natively. Portable C++, no allocation.
+ *
+ * Usage:
+ *   static LoopMetrics s_metrics(600000UL, 0.25f);   // 10 min, 0.25 °C steps
+ *   s_metrics.setSettleBand(0.5f);                    // applies from the next step
+ *   s_metrics.update(setpoint, temperature, outputPercent,
+ *                    state->actuatorSwitches, millis());   // every cycle
+ *   s_metrics.getReport(&state->loop);
+ */
+
+#ifndef LOOP_METRICS_H
+#define LOOP_METRICS_H
+
+#include <Arduino.h>
+#include "StepMetrics.h"
+
+/** @brief Buckets of the rolling window (the resolution it slides by). */
+#ifndef LOOP_METRICS_BUCKETS
+#define LOOP_METRICS_BUCKETS 4
+#endif
+
+/**
+ * @struct LoopMetricsReport
+ * @brief The figures at a glance, for the shared state and telemetry.
+ */
+struct LoopMetricsReport {
+    float    windowS;          ///< Time the window covers now (s).
+    float    iae;              ///< ∫|e| dt over the window (units·s).
+    float    ise;              ///< ∫e² dt over the window (units²·s).
+    float    travel;           ///< Σ|Δu| over the window (% of the range).
+    float    switchesPerHour;  ///< Switches in the window, per hour.
+    uint16_t switches;         ///< Actuator switches in the window.
+    uint16_t steps;            ///< Setpoint steps since reset() (wraps).
+    float    stepOvershoot;    ///< Present step: overshoot (units, ≥ 0).
+    float    stepSettleS;      ///< Present step: settling time (s), NAN outside the band.
+    float    stepIae;          ///< Present step: IAE (units·s).
+    float    stepElapsedS;     ///< Present step: time since it began (s).
+    float    lastOvershoot;    ///< Last finished step (NAN before the first).
+    float    lastSettleS;      ///< NAN if it ended outside the band.
+    float    lastIae;
+};
+
+/**
+ * @class LoopMetrics
+ * @brief Rolling IAE / ISE / travel / switch rate plus per-step figures.
+ */
+class LoopMetrics {
+public:
+    /**
+     * @param windowMs      Rolling window length (≥ LOOP_METRICS_BUCKETS ms).
+     * @param stepThreshold Setpoint change that starts a new step (> 0).
+     */
+    LoopMetrics(uint32_t windowMs, float stepThreshold);
+
+    /** @brief Forget everything; the next valid update starts a step. */
+    void reset();
+
+    /** @brief Settling band half-width of the steps to come (> 0). */
+    void setSettleBand(float band);
+
+    /**
+     * @brief Add one control cycle.
+     *
+     * @param setpoint      Setpoint the cycle controlled to.
+     * @param measured      Process value (NAN: invalid, scores no error).
+     * @param outputPercent Controller output (travel).
+     * @param switches      Running count of actuator switches.
+     * @param nowMs         Time of the cycle.
+     */
+    void update(float setpoint, float measured, float outputPercent,
+                uint32_t switches, uint32_t nowMs);
+
+    /** @brief Copy the window and step figures. */
+    void getReport(LoopMetricsReport *out) const;
+
+    /** @brief The present step (inactive before the first valid update). */
+    const StepMetrics &getStep() const;
+
+private:
+    struct Bucket {
+        float    iae;
+        float    ise;
+        float    travel;
+        uint16_t switches;
+        uint32_t ms;
+    };
+
+    void clearBucket(Bucket &bucket);
+    void advance(uint32_t dtMs);
+    void finishStep();
+
+    uint32_t    _bucketMs;
+    float       _stepThreshold;
+    float       _band;
+    Bucket      _buckets[LOOP_METRICS_BUCKETS];
+    uint8_t     _head;               ///< Bucket being filled
+    StepMetrics _step;
+    uint16_t    _steps;
+    float       _lastOvershoot;
+    float       _lastSettleS;
+    float       _lastIae;
+    float       _lastError;          ///< e of the previous valid update
+    float       _lastOutput;
+    uint32_t    _lastSwitches;
+    uint32_t    _lastMs;
+    bool        _haveError;          ///< _lastError is usable
+    bool        _started;            ///< _lastOutput / _lastSwitches / _lastMs set
+};
+
+#endif // LOOP_METRICS_H
@@ -0,0 +1,159 @@
+/**
+ * @file MemoryMonitor.cpp
+ * @brief SRAM Usage Monitor Implementation
+ *
+ * Reads the avr-libc allocator's own variables: __heap_start (end of
+ * .bss), __brkval (top of the heap, NULL before the first malloc()) and
+ * __flp (free list of {size, next} blocks, size excluding its 2-byte
+ * header). The stack pointer is considered the main stack's only while
+ * it lies above the heap: task stacks are in .bss (StaticRtos) or in the
+ * heap, both below it. The main stack only runs before the scheduler,
+ * when nothing can allocate concurrently.
+ */
+
+#include "MemoryMonitor.h"
+#include "FlashString.h"
+
+#include <Arduino_FreeRTOS.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/io.h>
+
+extern char __data_start;
+extern char __heap_start;
+extern char *__brkval;
+
+/** avr-libc free-list block (malloc.c). */
+struct __freelist {
+    size_t sz;
+    struct __freelist *nx;
+};
+extern struct __freelist *__flp;
+
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Main stack tracking
+// ──────────────────────────────────────────────────────────────────────────
+
+/// Gap filler; the value FreeRTOS paints task stacks with, too.
+static const uint8_t PAINT_BYTE = 0xA5;
+
+/// Bytes left unpainted under the stack pointer for memoryMonitorInit()'s own frame.
+static const uint8_t PAINT_GUARD = 16;
+
+static uintptr_t s_stackPointer = 0;  ///< Last main stack pointer seen.
+static uintptr_t s_paintMark = 0;     ///< Deepest overwritten painted byte found.
+static uint16_t  s_gapMin = UINT16_MAX;
+
+#if defined(__AVR__)
+
+static uintptr_t heapEnd() {
+    return (uintptr_t)((__brkval != NULL) ? __brkval : &__heap_start);
+}
+
+/** @brief The current stack pointer if it is the main stack's, else 0. */
+static uintptr_t mainStackPointer() {
+    uintptr_t sp = (uintptr_t)SP;
+    return (sp > heapEnd()) ? sp : 0;
+}
+
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+void memoryMonitorInit() {
+#if defined(__AVR__)
+    s_stackPointer = mainStackPointer();
+#if defined(MEMORY_MONITOR_PAINT)
+    if (s_stackPointer > heapEnd() + PAINT_GUARD) {
+        uint8_t *top = (uint8_t *)(s_stackPointer - PAINT_GUARD);
+        for (uint8_t *p = (uint8_t *)heapEnd(); p < top; p++) {
+            *p = PAINT_BYTE;
+        }
+        s_paintMark = (uintptr_t)top;  // Overwritten bytes are found below here
+    }
+#endif
+#endif
+}
+
+void memoryMonitorRead(MemoryStats *out) {
+    memset(out, 0, sizeof(*out));
+
+#if defined(__AVR__)
+    uintptr_t sp = mainStackPointer();
+    bool inTask = (sp == 0);
+    if (inTask) {
+        vTaskSuspendAll();
+    }
+
+    out->staticBytes = (uint16_t)((uintptr_t)&__heap_start - (uintptr_t)&__data_start);
+    out->heapBytes = (uint16_t)(heapEnd() - (uintptr_t)&__heap_start);
+    for (struct __freelist *block = __flp; block != NULL; block = block->nx) {
+        out->heapFreeBytes = (uint16_t)(out->heapFreeBytes + block->sz);
+        if (block->sz > out->heapLargestFree) {
+            out->heapLargestFree = (uint16_t)block->sz;
+        }
+        if (out->heapFreeBlocks < UINT8_MAX) {
+            out->heapFreeBlocks++;
+        }
+    }
+
+    uintptr_t end = heapEnd();
+    if (sp != 0) {
+        s_stackPointer = sp;
+    }
+    out->gapBytes = (s_stackPointer > end) ? (uint16_t)(s_stackPointer - end) : 0;
+    if (out->gapBytes < s_gapMin) {
+        s_gapMin = out->gapBytes;
+    }
+    out->gapMinBytes = s_gapMin;
+
+#if defined(MEMORY_MONITOR_PAINT)
+    // Everything from the previous mark down to the first intact byte
+    // has been used since.
+    if (s_paintMark != 0) {
+        const uint8_t *p = (const uint8_t *)s_paintMark;
+        while ((uintptr_t)p > end && *(p - 1) != PAINT_BYTE) {
+            p--;
+        }
+        s_paintMark = (uintptr_t)p;
+        out->gapMinBytes = (s_paintMark > end) ? (uint16_t)(s_paintMark - end) : 0;
+    }
+#endif
+
+    if (inTask) {
+        xTaskResumeAll();
+    }
+#endif
+
+#if defined(MEMORY_MONITOR_RTOS_HEAP)
+    out->rtosFreeBytes = xPortGetFreeHeapSize();
+    out->rtosMinFreeBytes = xPortGetMinimumEverFreeHeapSize();
+#endif
+}
+
+void memoryMonitorReport() {
+    MemoryStats stats;
+    memoryMonitorRead(&stats);
+
+    FLASH_PRINTF("[MEM] static %u B, heap %u B (free list %u B in %u block%s, largest %u B)\r\n",
+                 (unsigned)stats.staticBytes, (unsigned)stats.heapBytes,
+                 (unsigned)stats.heapFreeBytes, (unsigned)stats.heapFreeBlocks,
+                 (stats.heapFreeBlocks == 1) ? "" : "s", (unsigned)stats.heapLargestFree);
+#if defined(MEMORY_MONITOR_PAINT)
+    const char *how = "painted";
+#else
+    const char *how = "sampled";
+#endif
+    FLASH_PRINTF("[MEM] gap %u B now, %u B least (%s)\r\n",
+                 (unsigned)stats.gapBytes, (unsigned)stats.gapMinBytes, how);
+#if defined(MEMORY_MONITOR_RTOS_HEAP)
+    FLASH_PRINTF("[MEM] kernel heap %lu B free, %lu B least\r\n",
+                 (unsigned long)stats.rtosFreeBytes, (unsigned long)stats.rtosMinFreeBytes);
+#endif
+}
@@ -0,0 +1,92 @@
+/**
+ * @file MemoryMonitor.h
+ * @brief SRAM Usage Monitor: Static Data, malloc Heap, Free Gap, Kernel Heap
+ *
+ * Shows where the ATmega2560's 8 KB go, so buffers and stacks can be
+ * resized from numbers rather than guesses:
+ *
+ *   [MEM] static 6012 B, heap 64 B (free list 16 B in 1 block, largest 16 B)
+ *   [MEM] gap 1843 B now, 1790 B least (painted)
+ *   [MEM] kernel heap 0 B free, 0 B least
+ *
+ *   0x0200 ┌ .data + .bss ─ every static buffer; with StaticRtos also all
+ *          │                task stacks, TCBs and queue storage
+ *          ├ malloc heap  ─ grows up from __heap_start to __brkval; freed
+ *          │                blocks below __brkval stay on the free list
+ *          ├ gap          ─ unused: heap growth or new buffers come from here
+ *          └ main stack   ─ setup() and everything before the scheduler;
+ *   0x21FF                  grows down from RAMEND
+ *
+ * "gap now" is measured from the main stack pointer last seen: the one
+ * at memoryMonitorInit(), or at a memoryMonitorRead() made from setup().
+ * Task stacks are not in the gap (their high-water marks are reported
+ * by TaskMonitor), and an interrupt runs on the stack of the task it
+ * interrupted.
+ *
+ * With -DMEMORY_MONITOR_PAINT, memoryMonitorInit() fills the gap with a
+ * known byte, and "least" is the gap left below the deepest main-stack
+ * byte ever overwritten, found by scanning down from the previous mark
+ * (cheap: it only walks the newly overwritten bytes). Without painting
+ * "least" is the smallest "now" seen.
+ *
+ * Fragmentation: a free list holding many bytes whose largest block is
+ * small cannot serve a large malloc() even though "free" looks ample.
+ *
+ * The kernel heap line needs -DMEMORY_MONITOR_RTOS_HEAP and a FreeRTOS
+ * heap that keeps counters (heap_4 / heap_5: xPortGetFreeHeapSize(),
+ * xPortGetMinimumEverFreeHeapSize()). heap_3 wraps malloc(): its
+ * allocations are already in the heap figures above.
+ *
+ * Usage:
+ *   memoryMonitorInit();       // first thing in setup()
+ *   MemoryStats stats;
+ *   memoryMonitorRead(&stats); // any task
+ *   memoryMonitorReport();     // a task that may stall on the serial port
+ */
+
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <Arduino.h>
+
+/**
+ * @struct MemoryStats
+ * @brief One reading, in bytes (0 where the build cannot measure it).
+ */
+struct MemoryStats {
+    uint16_t staticBytes;      ///< .data + .bss.
+    uint16_t heapBytes;        ///< __heap_start to __brkval, free list included.
+    uint16_t heapFreeBytes;    ///< Bytes on the free list.
+    uint16_t heapLargestFree;  ///< Largest free-list block.
+    uint8_t  heapFreeBlocks;   ///< Free-list blocks (saturates at 255).
+    uint16_t gapBytes;         ///< Heap end to the last main stack pointer seen.
+    uint16_t gapMinBytes;      ///< Least gap (painted: from the deepest stack byte).
+    uint32_t rtosFreeBytes;    ///< xPortGetFreeHeapSize() (MEMORY_MONITOR_RTOS_HEAP).
+    uint32_t rtosMinFreeBytes; ///< xPortGetMinimumEverFreeHeapSize().
+};
+
+/**
+ * @brief Note the main stack pointer and, with MEMORY_MONITOR_PAINT,
+ *        paint the gap.
+ *
+ * Call once, first thing in setup(), before any task is created.
+ */
+void memoryMonitorInit();
+
+/**
+ * @brief Take a reading.
+ *
+ * Walks the free list with the scheduler suspended (malloc() is not
+ * interrupted halfway), so it is safe from any task. Not from an ISR.
+ */
+void memoryMonitorRead(MemoryStats *out);
+
+/**
+ * @brief Print the [MEM] lines to stdout.
+ *
+ * Prints directly with printf(), so call it from a task that is allowed
+ * to stall on the serial port.
+ */
+void memoryMonitorReport();
+
+#endif // MEMORY_MONITOR_H
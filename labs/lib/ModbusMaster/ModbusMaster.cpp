@@ -0,0 +1,324 @@
+/**
+ * @file ModbusMaster.cpp
+ * @brief Interrupt-Driven Modbus RTU Master Link Implementation
+ *
+ * USART setup (n = MODBUS_MASTER_USART), as ModbusSlave.cpp:
+ *   UCSRnA = U2Xn                          double speed (finer UBRR steps)
+ *   UCSRnB = RXENn | TXENn | RXCIEn        (+ UDRIEn / TXCIEn while sending)
+ *   UCSRnC = UCSZn1 | UCSZn0 | parity      8 data bits; 2 stop bits if none
+ *
+ * Link states:
+ *   IDLE   no request outstanding; stray bytes only delay the next one
+ *   TX     UDRE feeds the request, TXC drops DE and enters AWAIT
+ *          (IDLE for a broadcast, held MODBUS_BROADCAST_DELAY_US)
+ *   AWAIT  bytes go into the receive bank; the reply ends on its known
+ *          length (ISR), on t3.5 silence, or times out (service)
+ */
+
+#include "ModbusMaster.h"
+#include "StdioSerial.h"
+
+#if STDIO_SERIAL_PORT_ROUTED(MODBUS_MASTER_USART)
+#error "MODBUS_MASTER_USART is routed to by StdioSerial (STDIO_TELEMETRY_PORT / STDIO_LOG_PORT)"
+#endif
+
+#if defined(__AVR__)
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// USART register selection
+// ──────────────────────────────────────────────────────────────────────────
+
+#define MM_CAT2(a, b)     a##b
+#define MM_CAT3(a, b, c)  a##b##c
+#define MM_XCAT2(a, b)    MM_CAT2(a, b)
+#define MM_XCAT3(a, b, c) MM_CAT3(a, b, c)
+
+#define MM_UCSRA     MM_XCAT3(UCSR, MODBUS_MASTER_USART, A)
+#define MM_UCSRB     MM_XCAT3(UCSR, MODBUS_MASTER_USART, B)
+#define MM_UCSRC     MM_XCAT3(UCSR, MODBUS_MASTER_USART, C)
+#define MM_UBRR      MM_XCAT2(UBRR, MODBUS_MASTER_USART)
+#define MM_UDR       MM_XCAT2(UDR, MODBUS_MASTER_USART)
+#define MM_U2X       MM_XCAT2(U2X, MODBUS_MASTER_USART)
+#define MM_FE        MM_XCAT2(FE, MODBUS_MASTER_USART)
+#define MM_DOR       MM_XCAT2(DOR, MODBUS_MASTER_USART)
+#define MM_UPE       MM_XCAT2(UPE, MODBUS_MASTER_USART)
+#define MM_TXC       MM_XCAT2(TXC, MODBUS_MASTER_USART)
+#define MM_RXEN      MM_XCAT2(RXEN, MODBUS_MASTER_USART)
+#define MM_TXEN      MM_XCAT2(TXEN, MODBUS_MASTER_USART)
+#define MM_RXCIE     MM_XCAT2(RXCIE, MODBUS_MASTER_USART)
+#define MM_TXCIE     MM_XCAT2(TXCIE, MODBUS_MASTER_USART)
+#define MM_UDRIE     MM_XCAT2(UDRIE, MODBUS_MASTER_USART)
+#define MM_UPM1      MM_XCAT2(UPM, MM_XCAT2(MODBUS_MASTER_USART, 1))
+#define MM_UPM0      MM_XCAT2(UPM, MM_XCAT2(MODBUS_MASTER_USART, 0))
+#define MM_USBS      MM_XCAT2(USBS, MODBUS_MASTER_USART)
+#define MM_UCSZ1     MM_XCAT2(UCSZ, MM_XCAT2(MODBUS_MASTER_USART, 1))
+#define MM_UCSZ0     MM_XCAT2(UCSZ, MM_XCAT2(MODBUS_MASTER_USART, 0))
+#define MM_RX_vect   MM_XCAT3(USART, MODBUS_MASTER_USART, _RX_vect)
+#define MM_UDRE_vect MM_XCAT3(USART, MODBUS_MASTER_USART, _UDRE_vect)
+#define MM_TX_vect   MM_XCAT3(USART, MODBUS_MASTER_USART, _TX_vect)
+
+// ──────────────────────────────────────────────────────────────────────────
+// State
+// ──────────────────────────────────────────────────────────────────────────
+
+enum LinkState { LINK_IDLE, LINK_TX, LINK_AWAIT };
+
+static uint8_t  s_tx[MODBUS_ADU_MAX];
+static uint8_t  s_txLen = 0;
+static uint8_t  s_txIndex = 0;
+static bool     s_txQueued = false;              ///< s_tx holds a request not sent yet.
+
+static uint8_t  s_rx[2][MODBUS_ADU_MAX];         ///< Receive banks, alternating per reply.
+static uint8_t  s_bank = 0;                      ///< Bank being received into.
+static volatile uint8_t s_rxLen = 0;
+static uint8_t  s_expected = 0;                  ///< Reply length from its header, 0 = unknown.
+static bool     s_bad = false;                   ///< Reply corrupt: reported when it ends.
+
+static volatile uint8_t  s_state = LINK_IDLE;
+static volatile uint32_t s_lastUs = 0;           ///< micros() of the last bus activity.
+static volatile uint8_t  s_event = MODBUS_MASTER_NONE;   ///< Outcome not yet reported.
+static volatile uint32_t s_broadcastUs = 0;      ///< TXC of the last broadcast.
+static volatile bool     s_broadcastDone = false; ///< s_broadcastUs not yet reported.
+static uint32_t s_gapUs = 1750;                  ///< Silence before the next request.
+static uint8_t  s_eventBank = 0;
+static uint8_t  s_eventLen = 0;
+
+static int8_t   s_dePin = -1;
+static uint16_t s_t15Us = 750;
+static uint16_t s_t35Us = 1750;
+static uint16_t s_timeoutMs = 50;
+static uint32_t s_timeoutUs = 50000UL;
+static ModbusMasterStats s_stats;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Framing (interrupts disabled)
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief End the outstanding request with @p event; the bus is free again. */
+static void resolve(uint8_t event) {
+    s_event = event;
+    s_eventBank = s_bank;
+    s_eventLen = s_rxLen;
+    s_bank ^= 1;
+    s_rxLen = 0;
+    s_expected = 0;
+    s_bad = false;
+    s_state = LINK_IDLE;
+    if (event != MODBUS_MASTER_TIMEOUT) {
+        s_stats.replies++;
+    }
+}
+
+static void startRequest() {
+    s_gapUs = s_t35Us;
+    s_txIndex = 0;
+    s_txQueued = false;
+    s_state = LINK_TX;
+    s_stats.requests++;
+    MM_UCSRB &= (uint8_t)~(_BV(MM_RXEN) | _BV(MM_RXCIE));
+    if (s_dePin >= 0) {
+        digitalWrite(s_dePin, HIGH);
+    }
+    MM_UCSRA |= _BV(MM_TXC);              // Clear a stale completion
+    MM_UCSRB |= _BV(MM_UDRIE);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Interrupts
+// ──────────────────────────────────────────────────────────────────────────
+
+ISR(MM_RX_vect) {
+    uint8_t status = MM_UCSRA;
+    uint8_t c = MM_UDR;
+    uint32_t now = micros();
+    uint32_t gap = now - s_lastUs;
+    s_lastUs = now;
+
+    if (s_state != LINK_AWAIT) {
+        s_stats.stray++;            // Late or unsolicited: delays the next request
+        return;
+    }
+    if (s_rxLen > 0 && gap > s_t15Us) {
+        s_bad = true;
+    }
+    if ((status & (_BV(MM_FE) | _BV(MM_DOR) | _BV(MM_UPE))) != 0) {
+        s_bad = true;
+    }
+    if (s_rxLen >= MODBUS_ADU_MAX) {
+        s_bad = true;               // Too long: held open until the silence
+        return;
+    }
+    uint8_t *rx = s_rx[s_bank];
+    rx[s_rxLen] = c;
+    s_rxLen++;
+    if (s_expected == 0) {
+        s_expected = modbusReplyLength(rx, s_rxLen);
+        if (s_expected > MODBUS_ADU_MAX) {
+            s_bad = true;           // Longer than the buffer: ends on the silence
+        }
+    }
+    if (s_expected != 0 && s_rxLen == s_expected) {
+        resolve(s_bad ? MODBUS_MASTER_CORRUPT : MODBUS_MASTER_REPLY);
+    }
+}
+
+ISR(MM_UDRE_vect) {
+    MM_UDR = s_tx[s_txIndex++];
+    if (s_txIndex >= s_txLen) {
+        MM_UCSRB = (uint8_t)((MM_UCSRB & ~_BV(MM_UDRIE)) | _BV(MM_TXCIE));
+    }
+}
+
+ISR(MM_TX_vect) {
+    MM_UCSRB &= (uint8_t)~_BV(MM_TXCIE);
+    if (s_dePin >= 0) {
+        digitalWrite(s_dePin, LOW);
+    }
+    s_rxLen = 0;
+    s_expected = 0;
+    s_bad = false;
+    s_lastUs = micros();
+    if (s_tx[0] == 0) {
+        // Broadcast: nobody answers; give the nodes time to act on it
+        s_broadcastUs = s_lastUs;
+        s_broadcastDone = true;
+        s_stats.broadcasts++;
+        s_gapUs = MODBUS_BROADCAST_DELAY_US;
+        s_state = LINK_IDLE;
+    } else {
+        s_state = LINK_AWAIT;
+    }
+    MM_UCSRB |= _BV(MM_RXEN) | _BV(MM_RXCIE);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool modbusMasterBegin(uint32_t baud, ModbusParity parity, int8_t dePin, uint16_t timeoutMs) {
+    if (baud == 0) {
+        return false;
+    }
+    uint32_t ubrr = ((F_CPU / 4UL / baud) - 1UL) / 2UL;   // U2X, rounded
+    if (ubrr == 0 || ubrr > 4095) {
+        return false;
+    }
+    s_dePin = dePin;
+    s_t15Us = (baud > 19200UL) ? 750 : (uint16_t)((16500000UL + baud - 1) / baud);
+    s_t35Us = (baud > 19200UL) ? 1750 : (uint16_t)((38500000UL + baud - 1) / baud);
+    s_gapUs = s_t35Us;
+    modbusMasterSetTimeout(timeoutMs);
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    if (dePin >= 0) {
+        pinMode(dePin, OUTPUT);
+        digitalWrite(dePin, LOW);
+    }
+
+    uint8_t format = _BV(MM_UCSZ1) | _BV(MM_UCSZ0);
+    if (parity == MODBUS_PARITY_EVEN) {
+        format |= _BV(MM_UPM1);
+    } else if (parity == MODBUS_PARITY_ODD) {
+        format |= _BV(MM_UPM1) | _BV(MM_UPM0);
+    } else {
+        format |= _BV(MM_USBS);
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        MM_UCSRB = 0;
+        MM_UBRR = (uint16_t)ubrr;
+        MM_UCSRA = _BV(MM_U2X);
+        MM_UCSRC = format;
+        s_state = LINK_IDLE;
+        s_event = MODBUS_MASTER_NONE;
+        s_txQueued = false;
+        s_broadcastDone = false;
+        s_rxLen = 0;
+        s_lastUs = micros();
+        MM_UCSRB = _BV(MM_TXEN) | _BV(MM_RXEN) | _BV(MM_RXCIE);
+    }
+    return true;
+}
+
+void modbusMasterSetTimeout(uint16_t timeoutMs) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_timeoutMs = timeoutMs;
+        s_timeoutUs = (uint32_t)timeoutMs * 1000UL;
+    }
+}
+
+uint16_t modbusMasterGetTimeout() {
+    return s_timeoutMs;
+}
+
+bool modbusMasterCanQueue() {
+    bool free;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        free = (!s_txQueued && s_state != LINK_TX);
+    }
+    return free;
+}
+
+bool modbusMasterQueue(const uint8_t *adu, uint8_t len) {
+    if (len == 0 || len > MODBUS_ADU_MAX || !modbusMasterCanQueue()) {
+        return false;
+    }
+    memcpy(s_tx, adu, len);             // The ISRs only read s_tx while in TX
+    s_txLen = len;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_txQueued = true;
+    }
+    return true;
+}
+
+ModbusMasterEvent modbusMasterService(const uint8_t **reply, uint8_t *len) {
+    ModbusMasterEvent event;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint32_t idleUs = micros() - s_lastUs;
+        if (s_state == LINK_AWAIT && s_event == MODBUS_MASTER_NONE) {
+            if (s_rxLen == 0 && idleUs >= s_timeoutUs) {
+                s_stats.timeouts++;
+                resolve(MODBUS_MASTER_TIMEOUT);
+                s_lastUs = micros();
+            } else if (s_rxLen > 0 && idleUs >= s_t35Us) {
+                // Cut short (or a length the header could not tell).
+                resolve((s_bad || s_expected != 0) ? MODBUS_MASTER_CORRUPT
+                                                   : MODBUS_MASTER_REPLY);
+            }
+        }
+
+        event = (ModbusMasterEvent)s_event;
+        s_event = MODBUS_MASTER_NONE;
+        *reply = s_rx[s_eventBank];
+        *len = (event == MODBUS_MASTER_REPLY) ? s_eventLen : 0;
+
+        if (s_state == LINK_IDLE && s_txQueued && idleUs >= s_gapUs) {
+            startRequest();
+        }
+    }
+    return event;
+}
+
+bool modbusMasterBroadcastDone(uint32_t *endUs) {
+    bool done;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        done = s_broadcastDone;
+        *endUs = s_broadcastUs;
+        s_broadcastDone = false;
+    }
+    return done;
+}
+
+ModbusMasterStats modbusMasterStats() {
+    ModbusMasterStats copy;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        copy = s_stats;
+    }
+    return copy;
+}
+
+#endif // __AVR__
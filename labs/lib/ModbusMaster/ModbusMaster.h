@@ -0,0 +1,154 @@
+/**
+ * @file ModbusMaster.h
+ * @brief Interrupt-Driven Modbus RTU Master Link on a Spare USART (RS-485)
+ *
+ * Sends requests and collects replies on USART1..3 of the Mega 2560 for
+ * the poller (ModbusPoller.h), the master-side counterpart of
+ * ModbusSlave.h and, like it, without a timer:
+ *
+ *   - One request is on the bus at a time, plus one queued behind it
+ *     (modbusMasterQueue()). modbusMasterService() starts the queued
+ *     request as soon as the bus has been silent for t3.5 after the
+ *     previous reply, timeout or stray byte.
+ *   - The UDRE interrupt sends the request with the optional RS-485
+ *     driver enable pin (DE, tie /RE to it) high; TXC drops DE, enables
+ *     the receiver and starts the response timeout.
+ *   - The RX ISR completes a reply on its last byte, its length known
+ *     from the header (modbusReplyLength()), and switches to the other of
+ *     two receive buffers, so the caller decodes one reply while the next
+ *     is arriving. A gap over t1.5 or a framing/parity/overrun error marks
+ *     the reply corrupt; a reply cut short is closed after t3.5 silence.
+ *   - A broadcast (address 0) waits for no reply: TXC frees the bus,
+ *     stamps its end for modbusMasterBroadcastDone() (TimeSync.h) and
+ *     holds the next request MODBUS_BROADCAST_DELAY_US, so every node
+ *     has acted on it. It reports no event to the poller.
+ *
+ * t1.5 / t3.5 are 16.5 / 38.5 bit times, fixed at 750 / 1750 µs above
+ * 19200 baud as the specification recommends.
+ *
+ * USART (select with -DMODBUS_MASTER_USART=<n>):
+ *   3 (default) → TX3 D14 / RX3 D15   2 → TX2 D16 / RX2 D17
+ *   1 → TX1 D18 / RX1 D19
+ * The USART is taken over: do not use the matching SerialN. The link
+ * is polled: call modbusMasterService() from loop() on every pass, since
+ * it times the turnaround and the timeouts with micros(). Not built for
+ * the native tests.
+ *
+ * Usage:
+ *   modbusMasterBegin(19200, MODBUS_PARITY_EVEN, 26, 50);   // setup()
+ *
+ *   const uint8_t *reply;                                   // loop()
+ *   uint8_t len;
+ *   switch (modbusMasterService(&reply, &len)) {
+ *   case MODBUS_MASTER_REPLY:   modbusPollerReply(&poller, reply, len, millis()); break;
+ *   case MODBUS_MASTER_CORRUPT: modbusPollerReply(&poller, NULL, 0, millis()); break;
+ *   case MODBUS_MASTER_TIMEOUT: modbusPollerTimeout(&poller); break;
+ *   default: break;
+ *   }
+ *   if (modbusMasterCanQueue()) {
+ *       uint8_t n = modbusPollerNext(&poller, micros(), request);
+ *       if (n > 0) modbusMasterQueue(request, n);
+ *   }
+ */
+
+#ifndef MODBUS_MASTER_H
+#define MODBUS_MASTER_H
+
+#include <Arduino.h>
+#include "ModbusRtu.h"
+#include "ModbusPoller.h"
+
+/** @brief USART used for the bus (1..3). */
+#ifndef MODBUS_MASTER_USART
+#define MODBUS_MASTER_USART 3
+#endif
+
+#if MODBUS_MASTER_USART < 1 || MODBUS_MASTER_USART > 3
+#error "MODBUS_MASTER_USART must be 1, 2 or 3"
+#endif
+
+/**
+ * @brief Bus silence after a broadcast before the next request (µs).
+ *
+ * The nodes answer nothing, but a node holds one frame at a time
+ * (ModbusSlave.h): its task must release the broadcast before the next
+ * request arrives, or that request is dropped.
+ */
+#ifndef MODBUS_BROADCAST_DELAY_US
+#define MODBUS_BROADCAST_DELAY_US 5000UL
+#endif
+
+/** @brief Outcome of the request on the bus, from modbusMasterService(). */
+enum ModbusMasterEvent {
+    MODBUS_MASTER_NONE,      ///< Nothing resolved since the last call.
+    MODBUS_MASTER_REPLY,     ///< A reply is complete (CRC not checked yet).
+    MODBUS_MASTER_CORRUPT,   ///< The reply had a character error or a gap.
+    MODBUS_MASTER_TIMEOUT    ///< No reply within the response timeout.
+};
+
+/**
+ * @struct ModbusMasterStats
+ * @brief Link counters (wrap at 2^16).
+ */
+struct ModbusMasterStats {
+    uint16_t requests;   ///< Requests sent.
+    uint16_t replies;    ///< Replies completed (corrupt ones included).
+    uint16_t timeouts;   ///< Requests without a reply.
+    uint16_t stray;      ///< Bytes received with no request outstanding.
+    uint16_t broadcasts; ///< Requests to address 0 sent (no reply awaited).
+};
+
+/**
+ * @brief Configure the USART and the DE pin.
+ *
+ * @param baud      Bit rate (9600, 19200, …).
+ * @param parity    Character framing (as the slaves).
+ * @param dePin     RS-485 driver enable pin, or -1 (RS-232 / auto-direction).
+ * @param timeoutMs Response timeout from the end of a request.
+ * @return false if the bit rate cannot be set.
+ */
+bool modbusMasterBegin(uint32_t baud, ModbusParity parity, int8_t dePin, uint16_t timeoutMs);
+
+/** @brief Change the response timeout (takes effect with the next request). */
+void modbusMasterSetTimeout(uint16_t timeoutMs);
+
+/** @brief The response timeout in ms. */
+uint16_t modbusMasterGetTimeout();
+
+/** @brief True if modbusMasterQueue() would accept a request now. */
+bool modbusMasterCanQueue();
+
+/**
+ * @brief Queue @p len bytes as the next request.
+ *
+ * The frame is copied; it goes out once the request on the bus (if any)
+ * is resolved and the bus has been silent for t3.5.
+ *
+ * @return false if a request already waits, one is being sent, or
+ *         @p len exceeds MODBUS_ADU_MAX.
+ */
+bool modbusMasterQueue(const uint8_t *adu, uint8_t len);
+
+/**
+ * @brief Resolve timeouts, start the queued request, report the outcome.
+ *
+ * @param reply Receives the reply bytes for MODBUS_MASTER_REPLY, valid
+ *              until the next reply completes (at least one request and
+ *              its turnaround later).
+ * @param len   Receives the reply length.
+ * @return The outcome of the oldest request, once.
+ */
+ModbusMasterEvent modbusMasterService(const uint8_t **reply, uint8_t *len);
+
+/**
+ * @brief The end of the last broadcast sent, once per broadcast.
+ *
+ * @param endUs Receives micros() of its transmit-complete interrupt.
+ * @return true once after each broadcast has left the line.
+ */
+bool modbusMasterBroadcastDone(uint32_t *endUs);
+
+/** @brief Link counters. */
+ModbusMasterStats modbusMasterStats();
+
+#endif // MODBUS_MASTER_H
@@ -0,0 +1,196 @@
+/**
+ * @file ModbusPoller.cpp
+ * @brief Pipelined Round-Robin Modbus RTU Polling Implementation
+ *
+ * pending[] mirrors the link's FIFO: a reply or timeout always belongs
+ * to pending[0], since the link has one request on the bus at a time and
+ * sends the queued one only after that request is resolved.
+ */
+
+#include "ModbusPoller.h"
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+
+static inline uint16_t getBe16(const uint8_t *p) {
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static inline void putBe16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+ModbusPoll modbusPollerRow(const ModbusPoller *p, uint8_t row) {
+    ModbusPoll poll;
+    memcpy_P(&poll, &p->table[row], sizeof(poll));
+    return poll;
+}
+
+void modbusPollerInit(ModbusPoller *p, const ModbusPoll *table, ModbusPollCache *cache,
+                      uint8_t count, uint8_t missLimit, uint8_t holdoffCycles) {
+    memset(p, 0, sizeof(*p));
+    p->table = table;
+    p->cache = cache;
+    p->count = count;
+    p->missLimit = (missLimit > 0) ? missLimit : 1;
+    p->holdoffCycles = holdoffCycles;
+    memset(cache, 0, sizeof(ModbusPollCache) * count);
+}
+
+/** @brief Step the cursor; closes the cycle when it wraps. */
+static void advance(ModbusPoller *p, uint32_t nowUs) {
+    p->cursor++;
+    if (p->cursor < p->count) {
+        return;
+    }
+    p->cursor = 0;
+    if (p->started) {
+        uint32_t cycleUs = nowUs - p->cycleStartUs;
+        p->stats.lastCycleUs = cycleUs;
+        if (cycleUs > p->stats.worstCycleUs) {
+            p->stats.worstCycleUs = cycleUs;
+        }
+        p->stats.cycles++;
+    }
+    p->cycleStartUs = nowUs;
+    p->started = true;
+}
+
+uint8_t modbusPollerNext(ModbusPoller *p, uint32_t nowUs, uint8_t *adu) {
+    if (p->inFlight >= MODBUS_POLL_PIPELINE || p->count == 0) {
+        return 0;
+    }
+    if (!p->started) {
+        p->cycleStartUs = nowUs;
+        p->started = true;
+    }
+
+    // Skip held-off rows; after a whole pass of them the cursor is back
+    // where it started and that row is probed anyway.
+    for (uint8_t tries = 0; tries < p->count; tries++) {
+        ModbusPollCache &c = p->cache[p->cursor];
+        if (c.status != MODBUS_POLL_OFFLINE || c.holdoff == 0) {
+            break;
+        }
+        c.holdoff--;
+        advance(p, nowUs);
+    }
+    uint8_t row = p->cursor;
+
+    ModbusPoll poll = modbusPollerRow(p, row);
+    adu[0] = poll.node;
+    adu[1] = poll.function;
+    putBe16(&adu[2], poll.start);
+    putBe16(&adu[4], poll.count);
+    uint16_t crc = modbusCrc16(adu, 6);
+    adu[6] = (uint8_t)crc;
+    adu[7] = (uint8_t)(crc >> 8);
+
+    p->pending[p->inFlight++] = row;
+    advance(p, nowUs);
+    return 8;
+}
+
+/** @brief Take the oldest request in flight; false if none. */
+static bool popPending(ModbusPoller *p, uint8_t *row) {
+    if (p->inFlight == 0) {
+        return false;
+    }
+    *row = p->pending[0];
+    for (uint8_t i = 1; i < p->inFlight; i++) {
+        p->pending[i - 1] = p->pending[i];
+    }
+    p->inFlight--;
+    return true;
+}
+
+void modbusPollerReply(ModbusPoller *p, const uint8_t *adu, uint8_t len, uint32_t nowMs) {
+    uint8_t row;
+    if (!popPending(p, &row)) {
+        return;
+    }
+    ModbusPoll poll = modbusPollerRow(p, row);
+    ModbusPollCache &c = p->cache[row];
+    c.misses = 0;
+    c.holdoff = 0;
+
+    bool framed = (adu != NULL && len >= 5 && adu[0] == poll.node &&
+                   modbusCrc16(adu, (uint16_t)(len - 2)) ==
+                       (uint16_t)(adu[len - 2] | (adu[len - 1] << 8)));
+    if (framed && len == 5 && adu[1] == (poll.function | 0x80)) {
+        c.status = MODBUS_POLL_EXCEPTION;
+        c.exception = adu[2];
+        c.errors++;
+        return;
+    }
+    if (!framed || adu[1] != poll.function || adu[2] != 2 * poll.count ||
+        len != 5 + 2 * poll.count) {
+        c.status = MODBUS_POLL_BAD_FRAME;
+        c.errors++;
+        return;
+    }
+    for (uint8_t i = 0; i < poll.count; i++) {
+        c.regs[i] = getBe16(&adu[3 + 2 * i]);
+    }
+    c.updatedMs = nowMs;
+    c.valid = true;
+    c.status = MODBUS_POLL_OK;
+    c.replies++;
+}
+
+void modbusPollerTimeout(ModbusPoller *p) {
+    uint8_t row;
+    if (!popPending(p, &row)) {
+        return;
+    }
+    ModbusPollCache &c = p->cache[row];
+    c.timeouts++;
+    if (c.misses < 0xFF) {
+        c.misses++;
+    }
+    if (c.misses >= p->missLimit) {
+        c.status = MODBUS_POLL_OFFLINE;
+        c.holdoff = p->holdoffCycles;
+    } else {
+        c.status = MODBUS_POLL_TIMEOUT;
+    }
+}
+
+void modbusPollerFlush(ModbusPoller *p) {
+    p->inFlight = 0;
+}
+
+uint32_t modbusPollerAgeMs(const ModbusPoller *p, uint8_t row, uint32_t nowMs) {
+    const ModbusPollCache &c = p->cache[row];
+    return c.valid ? (uint32_t)(nowMs - c.updatedMs) : UINT32_MAX;
+}
+
+uint8_t modbusReplyLength(const uint8_t *adu, uint8_t len) {
+    if (len < 2) {
+        return 0;
+    }
+    uint8_t function = adu[1];
+    if ((function & 0x80) != 0) {
+        return 5;
+    }
+    switch (function) {
+    case MODBUS_FC_READ_HOLDING:
+    case MODBUS_FC_READ_INPUT:
+        if (len < 3) {
+            return 0;
+        }
+        return (adu[2] > 250) ? 0xFF : (uint8_t)(5 + adu[2]);
+    case MODBUS_FC_WRITE_SINGLE:
+    case MODBUS_FC_DIAGNOSTICS:
+    case MODBUS_FC_WRITE_MULTIPLE:
+        return 8;
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,183 @@
+/**
+ * @file ModbusPoller.h
+ * @brief Pipelined Round-Robin Modbus RTU Polling with a Value Cache
+ *
+ * The master side of ModbusRtu.h: walks a PROGMEM poll table of register
+ * blocks (node, function 0x03/0x04, start, count) in round-robin order,
+ * builds each read request and keeps the registers of every valid reply
+ * in a per-row cache with its arrival time, so a reader gets the latest
+ * value of each node together with its age.
+ *
+ * Pipelining: up to two requests are outstanding in the link —
+ * the one on the bus and the next one, already built and queued — so the
+ * link starts the next request t3.5 after a reply ends (or a timeout
+ * fires) without waiting for the caller, and the previous reply is
+ * decoded while the next one is on the wire. A poll cycle therefore costs
+ * the sum of the transactions plus one t3.5 each, linear in the rows.
+ *
+ * Timeouts: a row missing missLimit replies in a row goes offline and is
+ * then only probed every (holdoffCycles + 1)-th cycle, so a dead node
+ * costs one response timeout per holdoff period instead of one per
+ * cycle; its first answer brings it back at once.
+ *
+ * Replies are checked for CRC, node, function, byte count; an exception
+ * reply is recorded per row with its code. Portable C++ (native tests);
+ * the AVR USART link is ModbusMaster.h.
+ *
+ * Usage:
+ *   static const ModbusPoll POLLS[] PROGMEM = {
+ *       { 3, MODBUS_FC_READ_INPUT, 0, 12 },
+ *       { 5, MODBUS_FC_READ_INPUT, 0, 14 },
+ *   };
+ *   static ModbusPollCache s_cache[2];
+ *   static ModbusPoller s_poller;
+ *
+ *   modbusPollerInit(&s_poller, POLLS, s_cache, 2, 3, 10);
+ *   // Per loop(): feed the link's events, then top up its queue.
+ *   modbusPollerReply(&s_poller, reply, len, millis());   // or ...Timeout()
+ *   uint8_t n = modbusPollerNext(&s_poller, micros(), request);
+ *   if (n > 0) modbusMasterQueue(request, n);
+ */
+
+#ifndef MODBUS_POLLER_H
+#define MODBUS_POLLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ModbusRtu.h"
+
+/** @brief Most registers one poll row reads (and caches). */
+#ifndef MODBUS_POLL_MAX_REGS
+#define MODBUS_POLL_MAX_REGS 24
+#endif
+
+/** @brief Requests in flight: the one on the bus and the queued next one. */
+static const uint8_t MODBUS_POLL_PIPELINE = 2;
+
+/** @brief State of a poll row, from its last transaction. */
+enum ModbusPollStatus {
+    MODBUS_POLL_NEVER,       ///< Not answered since start-up.
+    MODBUS_POLL_OK,          ///< Last reply valid, registers cached.
+    MODBUS_POLL_TIMEOUT,     ///< Last request unanswered.
+    MODBUS_POLL_BAD_FRAME,   ///< Last reply corrupt (CRC, length, wrong node).
+    MODBUS_POLL_EXCEPTION,   ///< Last reply an exception (see exception).
+    MODBUS_POLL_OFFLINE      ///< missLimit timeouts in a row: held off.
+};
+
+/**
+ * @struct ModbusPoll
+ * @brief One poll table row (PROGMEM): a block of registers of one node.
+ */
+struct ModbusPoll {
+    uint8_t  node;       ///< Slave address, 1..247.
+    uint8_t  function;   ///< MODBUS_FC_READ_HOLDING or MODBUS_FC_READ_INPUT.
+    uint16_t start;      ///< First register address.
+    uint8_t  count;      ///< Registers, 1..MODBUS_POLL_MAX_REGS.
+};
+
+/**
+ * @struct ModbusPollCache
+ * @brief Latest values and link counters of one row (counters wrap at 2^16).
+ */
+struct ModbusPollCache {
+    uint16_t regs[MODBUS_POLL_MAX_REGS];   ///< Words of the last valid reply.
+    uint32_t updatedMs;                    ///< Time of the last valid reply.
+    uint16_t replies;                      ///< Valid replies.
+    uint16_t timeouts;                     ///< Requests unanswered.
+    uint16_t errors;                       ///< Corrupt or exception replies.
+    uint8_t  status;                       ///< ModbusPollStatus.
+    uint8_t  exception;                    ///< Code of the last exception reply.
+    uint8_t  misses;                       ///< Timeouts in a row.
+    uint8_t  holdoff;                      ///< Cycles left to skip while offline.
+    bool     valid;                        ///< regs hold a reply (updatedMs is set).
+};
+
+/**
+ * @struct ModbusPollerStats
+ * @brief Cycle timing (a cycle = one pass over the table).
+ */
+struct ModbusPollerStats {
+    uint16_t cycles;         ///< Completed cycles.
+    uint32_t lastCycleUs;    ///< Duration of the last cycle.
+    uint32_t worstCycleUs;   ///< Longest cycle since modbusPollerInit().
+};
+
+/**
+ * @struct ModbusPoller
+ * @brief Poll table binding and pipeline state.
+ */
+struct ModbusPoller {
+    const ModbusPoll *table;                   ///< PROGMEM rows.
+    ModbusPollCache  *cache;                   ///< One per row.
+    uint8_t           count;                   ///< Rows.
+    uint8_t           missLimit;               ///< Timeouts before a row goes offline.
+    uint8_t           holdoffCycles;           ///< Cycles an offline row is skipped.
+    uint8_t           cursor;                  ///< Next row to request.
+    uint8_t           pending[MODBUS_POLL_PIPELINE];   ///< Rows in flight, oldest first.
+    uint8_t           inFlight;                ///< Entries used in pending[].
+    uint32_t          cycleStartUs;            ///< micros() the cycle began.
+    bool              started;                 ///< cycleStartUs is set.
+    ModbusPollerStats stats;
+};
+
+/**
+ * @brief Bind a poll table and clear the caches.
+ *
+ * @param p             Poller.
+ * @param table         PROGMEM rows.
+ * @param cache         One cache entry per row.
+ * @param count         Rows (at least 1).
+ * @param missLimit     Timeouts in a row before a row goes offline (>= 1).
+ * @param holdoffCycles Cycles an offline row is skipped between probes.
+ */
+void modbusPollerInit(ModbusPoller *p, const ModbusPoll *table, ModbusPollCache *cache,
+                      uint8_t count, uint8_t missLimit, uint8_t holdoffCycles);
+
+/**
+ * @brief Build the next request if the pipeline has room.
+ *
+ * @param p     Poller.
+ * @param nowUs micros(), for the cycle time.
+ * @param adu   Receives the request (8 bytes).
+ * @return Request length, or 0 while MODBUS_POLL_PIPELINE requests are
+ *         unanswered. The caller must queue it on the link.
+ */
+uint8_t modbusPollerNext(ModbusPoller *p, uint32_t nowUs, uint8_t *adu);
+
+/**
+ * @brief Account a reply to the oldest request in flight.
+ *
+ * @param p     Poller.
+ * @param adu   Reply frame, or NULL for a frame the link found corrupt.
+ * @param len   Reply length (0 with NULL).
+ * @param nowMs millis(), stored as the row's update time.
+ */
+void modbusPollerReply(ModbusPoller *p, const uint8_t *adu, uint8_t len, uint32_t nowMs);
+
+/** @brief Account a response timeout of the oldest request in flight. */
+void modbusPollerTimeout(ModbusPoller *p);
+
+/** @brief Forget the requests in flight (the link dropped its queue). */
+void modbusPollerFlush(ModbusPoller *p);
+
+/**
+ * @brief Age of @p row's cached registers.
+ * @return ms since its last valid reply, or UINT32_MAX if never answered.
+ */
+uint32_t modbusPollerAgeMs(const ModbusPoller *p, uint8_t row, uint32_t nowMs);
+
+/** @brief A copy of row @p row of the poll table. */
+ModbusPoll modbusPollerRow(const ModbusPoller *p, uint8_t row);
+
+/**
+ * @brief Length of the reply starting with @p len bytes of @p adu.
+ *
+ * Known from the function code (0x06/0x08/0x10: 8, exception: 5) or the
+ * byte count of a read (5 + n), so the link completes a reply on its
+ * last byte instead of waiting for the t3.5 silence.
+ *
+ * @return The full length, or 0 while @p len bytes do not tell yet.
+ */
+uint8_t modbusReplyLength(const uint8_t *adu, uint8_t len);
+
+#endif // MODBUS_POLLER_H
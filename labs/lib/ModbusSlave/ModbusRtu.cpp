@@ -0,0 +1,325 @@
+/**
+ * @file ModbusRtu.cpp
+ * @brief Modbus RTU Slave Protocol Core Implementation
+ *
+ * Requests are parsed into locals before the reply overwrites the buffer;
+ * a read validates each address as it formats the word, and any failure
+ * replaces the partial reply with the exception.
+ */
+
+#include "ModbusRtu.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+static inline uint16_t getBe16(const uint8_t *p) {
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static inline void putBe16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+/**
+ * @brief Row holding @p address in @p space (copied to RAM).
+ * @param word Set to the word of the member: 0, or 1 for a U32 low word.
+ */
+static bool findRegister(const ModbusRtu *m, uint8_t space, uint16_t address,
+                         ModbusRegister *row, uint8_t *word) {
+    for (uint8_t i = 0; i < m->count; i++) {
+        memcpy_P(row, &m->regs[i], sizeof(ModbusRegister));
+        if (row->space != space) {
+            continue;
+        }
+        if (row->address == address) {
+            *word = 0;
+            return true;
+        }
+        if (row->type == MODBUS_U32 && (uint16_t)(row->address + 1) == address) {
+            *word = 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Word @p word of @p reg's member in @p image. */
+static uint16_t readWord(const void *image, const ModbusRegister &reg, uint8_t word) {
+    const uint8_t *p = (const uint8_t *)image + reg.offset;
+    switch (reg.type) {
+    case MODBUS_FLOAT: {
+        float v;
+        memcpy(&v, p, sizeof(v));
+        if (isnan(v)) {
+            return (uint16_t)MODBUS_INVALID_I16;
+        }
+        float scaled = v * (float)reg.scale;
+        if (scaled >= 32767.0f) return 32767;
+        if (scaled <= -32767.0f) return (uint16_t)-32767;
+        return (uint16_t)(int16_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+    }
+    case MODBUS_BOOL: {
+        bool v;
+        memcpy(&v, p, sizeof(v));
+        return v ? 1 : 0;
+    }
+    case MODBUS_U8:
+        return *p;
+    case MODBUS_U16:
+    case MODBUS_I16: {
+        uint16_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    case MODBUS_ENUM: {
+        int v;
+        memcpy(&v, p, sizeof(v));
+        return (uint16_t)v;
+    }
+    case MODBUS_U32: {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return word == 0 ? (uint16_t)(v >> 16) : (uint16_t)v;
+    }
+    default:
+        return 0;
+    }
+}
+
+/** @brief Word → value for @p reg; false if the type cannot hold it. */
+static bool decodeWord(const ModbusRegister &reg, uint16_t w, float *value) {
+    switch (reg.type) {
+    case MODBUS_FLOAT:
+        if ((int16_t)w == MODBUS_INVALID_I16 || reg.scale == 0) {
+            return false;
+        }
+        *value = (float)(int16_t)w / (float)reg.scale;
+        return true;
+    case MODBUS_BOOL:
+        *value = (float)w;
+        return w <= 1;
+    case MODBUS_U8:
+        *value = (float)w;
+        return w <= 0xFF;
+    case MODBUS_U16:
+        *value = (float)w;
+        return true;
+    case MODBUS_I16:
+        *value = (float)(int16_t)w;
+        return true;
+    case MODBUS_ENUM:
+        *value = (float)w;
+        return w <= 0x7FFF;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Check, then apply, @p qty holding registers from @p data.
+ * @return 0, or the exception code (nothing stored unless 04).
+ */
+static uint8_t writeRegisters(ModbusRtu *m, void *image, uint16_t start, uint16_t qty,
+                              const uint8_t *data) {
+    if ((uint32_t)start + qty > 0x10000UL) {
+        return MODBUS_EX_ILLEGAL_ADDRESS;
+    }
+    ModbusRegister row;
+    uint8_t word;
+    float value;
+    for (uint16_t i = 0; i < qty; i++) {
+        if (!findRegister(m, MODBUS_SPACE_HOLDING, (uint16_t)(start + i), &row, &word) ||
+            row.type == MODBUS_U32) {
+            return MODBUS_EX_ILLEGAL_ADDRESS;
+        }
+        if (!decodeWord(row, getBe16(data + 2 * i), &value) ||
+            (m->onWrite != NULL && !m->onWrite(image, row, value, false, m->context))) {
+            return MODBUS_EX_ILLEGAL_VALUE;
+        }
+    }
+    for (uint16_t i = 0; i < qty; i++) {
+        findRegister(m, MODBUS_SPACE_HOLDING, (uint16_t)(start + i), &row, &word);
+        decodeWord(row, getBe16(data + 2 * i), &value);
+        if (m->onWrite != NULL) {
+            if (!m->onWrite(image, row, value, true, m->context)) {
+                return MODBUS_EX_DEVICE_FAILURE;
+            }
+        } else {
+            modbusRtuStore(image, row, value);
+        }
+        m->stats.writes++;
+    }
+    return 0;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+uint16_t modbusCrc16(const uint8_t *data, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+void modbusRtuInit(ModbusRtu *m, const ModbusRegister *regs, uint8_t count,
+                   uint8_t address, ModbusWriteFn onWrite, void *context) {
+    m->regs = regs;
+    m->count = count;
+    m->address = address;
+    m->onWrite = onWrite;
+    m->context = context;
+    memset(&m->stats, 0, sizeof(m->stats));
+}
+
+void modbusRtuStore(void *image, const ModbusRegister &reg, float value) {
+    uint8_t *p = (uint8_t *)image + reg.offset;
+    switch (reg.type) {
+    case MODBUS_FLOAT:
+        memcpy(p, &value, sizeof(value));
+        break;
+    case MODBUS_BOOL: {
+        bool v = value != 0.0f;
+        memcpy(p, &v, sizeof(v));
+        break;
+    }
+    case MODBUS_U8:
+        *p = (uint8_t)value;
+        break;
+    case MODBUS_U16: {
+        uint16_t v = (uint16_t)value;
+        memcpy(p, &v, sizeof(v));
+        break;
+    }
+    case MODBUS_I16: {
+        int16_t v = (int16_t)value;
+        memcpy(p, &v, sizeof(v));
+        break;
+    }
+    case MODBUS_ENUM: {
+        int v = (int)value;
+        memcpy(p, &v, sizeof(v));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+uint8_t modbusRtuHandle(ModbusRtu *m, uint8_t *adu, uint8_t len, void *image) {
+    if (len < 4) {
+        m->stats.crcErrors++;
+        return 0;
+    }
+    uint16_t crc = modbusCrc16(adu, (uint16_t)(len - 2));
+    if (adu[len - 2] != (uint8_t)crc || adu[len - 1] != (uint8_t)(crc >> 8)) {
+        m->stats.crcErrors++;
+        return 0;
+    }
+    bool broadcast = (adu[0] == 0);
+    if (!broadcast && adu[0] != m->address) {
+        return 0;
+    }
+    m->stats.requests++;
+    if (broadcast) {
+        m->stats.broadcasts++;
+    }
+
+    uint8_t function = adu[1];
+    uint8_t exception = 0;
+    uint8_t reply = 0;
+    switch (function) {
+    case MODBUS_FC_READ_HOLDING:
+    case MODBUS_FC_READ_INPUT: {
+        if (broadcast) {
+            return 0;   // Reads are never broadcast
+        }
+        uint16_t start = getBe16(adu + 2);
+        uint16_t qty = getBe16(adu + 4);
+        if (len != 8 || qty < 1 || qty > MODBUS_MAX_REGS) {
+            exception = MODBUS_EX_ILLEGAL_VALUE;
+            break;
+        }
+        if ((uint32_t)start + qty > 0x10000UL) {
+            exception = MODBUS_EX_ILLEGAL_ADDRESS;
+            break;
+        }
+        uint8_t space = (function == MODBUS_FC_READ_INPUT) ? MODBUS_SPACE_INPUT
+                                                           : MODBUS_SPACE_HOLDING;
+        ModbusRegister row;
+        uint8_t word;
+        for (uint16_t i = 0; i < qty; i++) {
+            if (!findRegister(m, space, (uint16_t)(start + i), &row, &word)) {
+                exception = MODBUS_EX_ILLEGAL_ADDRESS;
+                break;
+            }
+            putBe16(adu + 3 + 2 * i, readWord(image, row, word));
+        }
+        adu[2] = (uint8_t)(2 * qty);
+        reply = (uint8_t)(3 + 2 * qty);
+        break;
+    }
+    case MODBUS_FC_WRITE_SINGLE:
+        if (len != 8) {
+            exception = MODBUS_EX_ILLEGAL_VALUE;
+            break;
+        }
+        exception = writeRegisters(m, image, getBe16(adu + 2), 1, adu + 4);
+        reply = 6;   // Echo of address and value
+        break;
+    case MODBUS_FC_WRITE_MULTIPLE: {
+        uint16_t qty = (len >= 9) ? getBe16(adu + 4) : 0;
+        if (len < 9 || qty < 1 || qty > MODBUS_MAX_REGS ||
+            adu[6] != 2 * qty || len != 9 + adu[6]) {
+            exception = MODBUS_EX_ILLEGAL_VALUE;
+            break;
+        }
+        exception = writeRegisters(m, image, getBe16(adu + 2), qty, adu + 7);
+        reply = 6;   // Address and quantity
+        break;
+    }
+    case MODBUS_FC_DIAGNOSTICS:
+        if (broadcast) {
+            return 0;
+        }
+        if (len < 6 || getBe16(adu + 2) != 0x0000) {
+            exception = MODBUS_EX_ILLEGAL_FUNCTION;   // Only "return query data"
+            break;
+        }
+        reply = (uint8_t)(len - 2);
+        break;
+    default:
+        exception = MODBUS_EX_ILLEGAL_FUNCTION;
+        break;
+    }
+
+    if (exception != 0) {
+        m->stats.exceptions++;
+        adu[1] = (uint8_t)(function | 0x80);
+        adu[2] = exception;
+        reply = 3;
+    }
+    if (broadcast) {
+        return 0;
+    }
+    crc = modbusCrc16(adu, reply);
+    adu[reply] = (uint8_t)crc;
+    adu[reply + 1] = (uint8_t)(crc >> 8);
+    return (uint8_t)(reply + 2);
+}
@@ -0,0 +1,203 @@
+/**
+ * @file ModbusRtu.h
+ * @brief Modbus RTU Slave Protocol Core over a Register Descriptor Table
+ *
+ * Answers Modbus RTU requests straight from an application struct: a
+ * PROGMEM table maps each register address to a member (offset and
+ * type), so reads format the live fields into the reply and writes store
+ * into them, with no register array kept in between.
+ *
+ *   0x03  Read Holding Registers      0x06  Write Single Register
+ *   0x04  Read Input Registers        0x10  Write Multiple Registers
+ *   0x08  Diagnostics, sub-function 0000 (return query data: loopback)
+ *
+ * Register encoding (one 16-bit word unless noted):
+ *
+ *   MODBUS_FLOAT  value · scale as int16, saturated; NaN = 0x8000
+ *   MODBUS_BOOL   0/1
+ *   MODBUS_U8 / MODBUS_U16 / MODBUS_I16   the integer itself
+ *   MODBUS_ENUM   an enum without a fixed underlying type (int-sized)
+ *   MODBUS_U32    two words, high word first (input registers only)
+ *
+ * Input registers are read-only. Holding registers are read/write; a
+ * write goes through the optional ModbusWriteFn in two phases, every
+ * register checked before any is applied, so a 0x10 request is all or
+ * nothing: a rejected value answers exception 03 with nothing changed.
+ * Without a handler the decoded value is stored as it is.
+ *
+ * Exceptions: 01 unknown function, 02 an address in the range has no
+ * register (gaps included) or is read-only, 03 bad quantity, byte count
+ * or value, 04 the handler failed while applying. Frames with a bad CRC
+ * or for another node get no reply; broadcasts (address 0) are applied
+ * but never answered.
+ *
+ * The caller owns the framing (ModbusSlave.h on the AVR USARTs) and the
+ * locking: the image must stay consistent for one modbusRtuHandle() call
+ * (e.g. hold the shared-state lock around it). The reply is built in
+ * place in the request buffer, which needs MODBUS_ADU_MAX bytes.
+ *
+ * Usage:
+ *   static const ModbusRegister REGS[] PROGMEM = {
+ *       MODBUS_INPUT(0, State, temperatureC, MODBUS_FLOAT, 100),
+ *       MODBUS_HOLDING(0, State, setpointC, MODBUS_FLOAT, 100),
+ *   };
+ *   static ModbusRtu s_modbus;
+ *   modbusRtuInit(&s_modbus, REGS, 2, 17, onWrite, NULL);
+ *   uint8_t n = modbusRtuHandle(&s_modbus, adu, len, &state);   // 0: no reply
+ */
+
+#ifndef MODBUS_RTU_H
+#define MODBUS_RTU_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Most registers one request may read or write.
+ * Override with -DMODBUS_MAX_REGS=<n> (1..123); larger ones answer 03.
+ */
+#ifndef MODBUS_MAX_REGS
+#define MODBUS_MAX_REGS 32
+#endif
+
+/** @brief Longest request or reply handled: a 0x10 write of MODBUS_MAX_REGS. */
+#define MODBUS_ADU_MAX (9 + 2 * MODBUS_MAX_REGS)
+
+/** @brief MODBUS_FLOAT word of a NaN (also the low saturation value). */
+static const int16_t MODBUS_INVALID_I16 = -32768;
+
+/** @brief Function codes served (and polled by ModbusMaster). */
+enum ModbusFunction {
+    MODBUS_FC_READ_HOLDING   = 0x03,
+    MODBUS_FC_READ_INPUT     = 0x04,
+    MODBUS_FC_WRITE_SINGLE   = 0x06,
+    MODBUS_FC_DIAGNOSTICS    = 0x08,
+    MODBUS_FC_WRITE_MULTIPLE = 0x10
+};
+
+/** @brief Exception codes answered (function code | 0x80). */
+enum ModbusException {
+    MODBUS_EX_ILLEGAL_FUNCTION = 0x01,
+    MODBUS_EX_ILLEGAL_ADDRESS  = 0x02,
+    MODBUS_EX_ILLEGAL_VALUE    = 0x03,
+    MODBUS_EX_DEVICE_FAILURE   = 0x04
+};
+
+/** @brief Member type behind a register. */
+enum ModbusRegType {
+    MODBUS_FLOAT,   ///< float, scaled into an int16
+    MODBUS_BOOL,    ///< bool, 0/1
+    MODBUS_U8,      ///< uint8_t
+    MODBUS_U16,     ///< uint16_t
+    MODBUS_I16,     ///< int16_t
+    MODBUS_ENUM,    ///< plain enum (int)
+    MODBUS_U32      ///< uint32_t, two registers, high word first
+};
+
+/** @brief Character framing (8 data bits; no parity uses 2 stop bits). */
+enum ModbusParity {
+    MODBUS_PARITY_EVEN,   ///< 8E1, the Modbus default
+    MODBUS_PARITY_ODD,    ///< 8O1
+    MODBUS_PARITY_NONE    ///< 8N2
+};
+
+/** @brief Register address space. */
+enum ModbusSpace {
+    MODBUS_SPACE_INPUT   = 0,   ///< 0x04, read-only
+    MODBUS_SPACE_HOLDING = 1    ///< 0x03 / 0x06 / 0x10
+};
+
+/**
+ * @struct ModbusRegister
+ * @brief One table row (PROGMEM). Build with MODBUS_INPUT() / MODBUS_HOLDING().
+ */
+struct ModbusRegister {
+    uint16_t address;   ///< Register address (protocol, 0-based).
+    uint8_t  space;     ///< ModbusSpace.
+    uint8_t  type;      ///< ModbusRegType.
+    int16_t  scale;     ///< MODBUS_FLOAT: word = value · scale (else 1).
+    uint16_t offset;    ///< Byte offset of the member in the image.
+};
+
+/** @brief Read-only register for member of Struct. */
+#define MODBUS_INPUT(address, Struct, member, type, scale) \
+    { address, MODBUS_SPACE_INPUT, type, scale, (uint16_t)offsetof(Struct, member) }
+
+/** @brief Read/write register for member of Struct (no MODBUS_U32). */
+#define MODBUS_HOLDING(address, Struct, member, type, scale) \
+    { address, MODBUS_SPACE_HOLDING, type, scale, (uint16_t)offsetof(Struct, member) }
+
+/**
+ * @brief Holding register write hook.
+ *
+ * Called for every register of a write request with apply false (check:
+ * return false to reject the value, exception 03), then, when all passed,
+ * again with apply true (store: modbusRtuStore() for the plain store plus
+ * any side effect; false answers exception 04).
+ *
+ * @param image   The image given to modbusRtuHandle().
+ * @param reg     Row written (a RAM copy).
+ * @param value   Decoded value (MODBUS_FLOAT: word / scale).
+ * @param apply   false: check only; true: store.
+ * @param context As given to modbusRtuInit().
+ */
+typedef bool (*ModbusWriteFn)(void *image, const ModbusRegister &reg, float value,
+                              bool apply, void *context);
+
+/**
+ * @struct ModbusRtuStats
+ * @brief Request counters (wrap at 2^16).
+ */
+struct ModbusRtuStats {
+    uint16_t requests;     ///< Valid frames for this node (broadcasts included).
+    uint16_t crcErrors;    ///< Frames dropped for a short length or bad CRC.
+    uint16_t exceptions;   ///< Exception replies (or broadcasts that would be).
+    uint16_t broadcasts;   ///< Requests for address 0.
+    uint16_t writes;       ///< Holding registers stored.
+};
+
+/**
+ * @struct ModbusRtu
+ * @brief Register table binding and node state.
+ */
+struct ModbusRtu {
+    const ModbusRegister *regs;      ///< PROGMEM table, each space by ascending address.
+    uint8_t               count;     ///< Rows.
+    uint8_t               address;   ///< Node address, 1..247.
+    ModbusWriteFn         onWrite;   ///< NULL: store the decoded values.
+    void                 *context;   ///< For onWrite.
+    ModbusRtuStats        stats;
+};
+
+/** @brief CRC-16/MODBUS (poly 0xA001 reflected, init 0xFFFF); sent low byte first. */
+uint16_t modbusCrc16(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Bind a register table and clear the counters.
+ *
+ * @param m       Node state.
+ * @param regs    PROGMEM table.
+ * @param count   Rows.
+ * @param address Node address (1..247).
+ * @param onWrite Write hook, or NULL.
+ * @param context For onWrite.
+ */
+void modbusRtuInit(ModbusRtu *m, const ModbusRegister *regs, uint8_t count,
+                   uint8_t address, ModbusWriteFn onWrite, void *context);
+
+/**
+ * @brief Serve one complete frame.
+ *
+ * @param m     Node state.
+ * @param adu   Frame (address … CRC); the reply is written over it.
+ * @param len   Frame length in bytes.
+ * @param image Struct the table describes.
+ * @return Reply length in adu, 0 for no reply (bad CRC, other node,
+ *         broadcast).
+ */
+uint8_t modbusRtuHandle(ModbusRtu *m, uint8_t *adu, uint8_t len, void *image);
+
+/** @brief Store @p value into @p reg's member of @p image (the default write). */
+void modbusRtuStore(void *image, const ModbusRegister &reg, float value);
+
+#endif // MODBUS_RTU_H
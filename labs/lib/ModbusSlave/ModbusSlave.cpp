@@ -0,0 +1,325 @@
+/**
+ * @file ModbusSlave.cpp
+ * @brief Interrupt-Driven Modbus RTU Framing Implementation
+ *
+ * USART setup (n = MODBUS_SLAVE_USART):
+ *   UCSRnA = U2Xn                          double speed (finer UBRR steps)
+ *   UCSRnB = RXENn | TXENn | RXCIEn        (+ UDRIEn / TXCIEn while sending)
+ *   UCSRnC = UCSZn1 | UCSZn0 | parity      8 data bits; 2 stop bits if none
+ *
+ * Link states:
+ *   RX     bytes go into the buffer; a frame ends on its known length
+ *          (ISR) or on t3.5 silence (the next byte, or modbusSlaveFrame())
+ *   READY  one frame waits for the task; bytes are dropped
+ *   TX     UDRE feeds the reply, TXC drops DE and re-enters RX
+ */
+
+#include "ModbusSlave.h"
+#include "StdioSerial.h"
+
+#if STDIO_SERIAL_PORT_ROUTED(MODBUS_SLAVE_USART)
+#error "MODBUS_SLAVE_USART is routed to by StdioSerial (STDIO_TELEMETRY_PORT / STDIO_LOG_PORT)"
+#endif
+
+#if defined(__AVR__)
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// USART register selection
+// ──────────────────────────────────────────────────────────────────────────
+
+#define MB_CAT2(a, b)     a##b
+#define MB_CAT3(a, b, c)  a##b##c
+#define MB_XCAT2(a, b)    MB_CAT2(a, b)
+#define MB_XCAT3(a, b, c) MB_CAT3(a, b, c)
+
+#define MB_UCSRA     MB_XCAT3(UCSR, MODBUS_SLAVE_USART, A)
+#define MB_UCSRB     MB_XCAT3(UCSR, MODBUS_SLAVE_USART, B)
+#define MB_UCSRC     MB_XCAT3(UCSR, MODBUS_SLAVE_USART, C)
+#define MB_UBRR      MB_XCAT2(UBRR, MODBUS_SLAVE_USART)
+#define MB_UDR       MB_XCAT2(UDR, MODBUS_SLAVE_USART)
+#define MB_U2X       MB_XCAT2(U2X, MODBUS_SLAVE_USART)
+#define MB_FE        MB_XCAT2(FE, MODBUS_SLAVE_USART)
+#define MB_DOR       MB_XCAT2(DOR, MODBUS_SLAVE_USART)
+#define MB_UPE       MB_XCAT2(UPE, MODBUS_SLAVE_USART)
+#define MB_TXC       MB_XCAT2(TXC, MODBUS_SLAVE_USART)
+#define MB_RXEN      MB_XCAT2(RXEN, MODBUS_SLAVE_USART)
+#define MB_TXEN      MB_XCAT2(TXEN, MODBUS_SLAVE_USART)
+#define MB_RXCIE     MB_XCAT2(RXCIE, MODBUS_SLAVE_USART)
+#define MB_TXCIE     MB_XCAT2(TXCIE, MODBUS_SLAVE_USART)
+#define MB_UDRIE     MB_XCAT2(UDRIE, MODBUS_SLAVE_USART)
+#define MB_UPM1      MB_XCAT2(UPM, MB_XCAT2(MODBUS_SLAVE_USART, 1))
+#define MB_UPM0      MB_XCAT2(UPM, MB_XCAT2(MODBUS_SLAVE_USART, 0))
+#define MB_USBS      MB_XCAT2(USBS, MODBUS_SLAVE_USART)
+#define MB_UCSZ1     MB_XCAT2(UCSZ, MB_XCAT2(MODBUS_SLAVE_USART, 1))
+#define MB_UCSZ0     MB_XCAT2(UCSZ, MB_XCAT2(MODBUS_SLAVE_USART, 0))
+#define MB_RX_vect   MB_XCAT3(USART, MODBUS_SLAVE_USART, _RX_vect)
+#define MB_UDRE_vect MB_XCAT3(USART, MODBUS_SLAVE_USART, _UDRE_vect)
+#define MB_TX_vect   MB_XCAT3(USART, MODBUS_SLAVE_USART, _TX_vect)
+
+// ──────────────────────────────────────────────────────────────────────────
+// State
+// ──────────────────────────────────────────────────────────────────────────
+
+enum LinkState { LINK_RX, LINK_READY, LINK_TX };
+
+static uint8_t  s_buf[MODBUS_ADU_MAX];
+static volatile uint8_t s_state = LINK_RX;
+static volatile uint8_t s_len = 0;           ///< Bytes of the open (or waiting) frame.
+static uint8_t  s_expected = 0;              ///< Frame length from its header, 0 = unknown.
+static bool     s_bad = false;               ///< Open frame corrupt: dropped when it ends.
+static bool     s_skip = false;              ///< Open frame for another node.
+static volatile uint32_t s_lastUs = 0;       ///< micros() of the last byte received.
+static uint8_t  s_txLen = 0;
+static uint8_t  s_txIndex = 0;
+
+static uint8_t  s_address = 1;
+static int8_t   s_dePin = -1;
+static uint16_t s_t15Us = 750;
+static uint16_t s_t35Us = 1750;
+static void   (*s_onFrame)() = NULL;
+static ModbusSlaveStats s_stats;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Framing (interrupts disabled)
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Request length known from the function code, 0 = not yet / never. */
+static uint8_t expectedLength(uint8_t function) {
+    switch (function) {
+    case MODBUS_FC_READ_HOLDING:
+    case MODBUS_FC_READ_INPUT:
+    case MODBUS_FC_WRITE_SINGLE:
+    case MODBUS_FC_DIAGNOSTICS:   // Sub-function 0000 with one data word
+        return 8;
+    default:
+        return 0;                 // 0x10: from the byte count; others: t3.5
+    }
+}
+
+static void openFrame() {
+    s_len = 0;
+    s_expected = 0;
+    s_bad = false;
+    s_skip = false;
+}
+
+/** @brief Close the open frame; true if it now waits for the task. */
+static bool closeFrame() {
+    if (s_skip) {
+        s_stats.skipped++;
+    } else if (s_bad) {
+        s_stats.rxErrors++;
+    } else {
+        s_state = LINK_READY;
+        s_stats.frames++;
+        return true;
+    }
+    openFrame();
+    return false;
+}
+
+static void restartReceiver() {
+    openFrame();
+    s_lastUs = micros();
+    s_state = LINK_RX;
+    MB_UCSRB |= _BV(MB_RXEN) | _BV(MB_RXCIE);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Interrupts
+// ──────────────────────────────────────────────────────────────────────────
+
+ISR(MB_RX_vect) {
+    uint8_t status = MB_UCSRA;
+    uint8_t c = MB_UDR;
+    if (s_state != LINK_RX) {
+        s_stats.overruns++;
+        return;
+    }
+    uint32_t now = micros();
+    uint32_t gap = now - s_lastUs;
+    s_lastUs = now;
+
+    if (s_len > 0) {
+        if (gap >= s_t35Us) {
+            // The open frame ended in silence nobody polled: it is
+            // complete, and this byte (the next frame) has no room.
+            if (closeFrame()) {
+                s_stats.overruns++;
+                if (s_onFrame != NULL) {
+                    s_onFrame();
+                }
+                return;
+            }
+        } else if (gap > s_t15Us) {
+            s_bad = true;
+        }
+    }
+    if ((status & (_BV(MB_FE) | _BV(MB_DOR) | _BV(MB_UPE))) != 0) {
+        s_bad = true;
+    }
+    if (s_len == 0) {
+        s_skip = (c != 0 && c != s_address);
+    }
+    if (s_len < MODBUS_ADU_MAX) {
+        s_buf[s_len] = c;
+        s_len++;
+    } else {
+        s_bad = true;   // Too long: held open until the silence
+        return;
+    }
+    if (s_skip) {
+        return;         // Another node's request or reply: ends on t3.5 only
+    }
+    if (s_len == 2) {
+        s_expected = expectedLength(c);
+        if (s_expected == 0 && c != MODBUS_FC_WRITE_MULTIPLE && s_onFrame != NULL) {
+            s_onFrame();    // Ends on the silence: the task polls for it
+        }
+    } else if (s_len == 7 && s_buf[1] == MODBUS_FC_WRITE_MULTIPLE) {
+        if (9 + c <= MODBUS_ADU_MAX) {
+            s_expected = (uint8_t)(9 + c);
+        } else {
+            s_bad = true;   // Longer than the buffer: held open until the silence
+        }
+    }
+    if (s_expected != 0 && s_len == s_expected && closeFrame() && s_onFrame != NULL) {
+        s_onFrame();
+    }
+}
+
+ISR(MB_UDRE_vect) {
+    MB_UDR = s_buf[s_txIndex++];
+    if (s_txIndex >= s_txLen) {
+        MB_UCSRB = (uint8_t)((MB_UCSRB & ~_BV(MB_UDRIE)) | _BV(MB_TXCIE));
+    }
+}
+
+ISR(MB_TX_vect) {
+    MB_UCSRB &= (uint8_t)~_BV(MB_TXCIE);
+    if (s_dePin >= 0) {
+        digitalWrite(s_dePin, LOW);
+    }
+    restartReceiver();
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool modbusSlaveBegin(uint32_t baud, ModbusParity parity, uint8_t address,
+                      int8_t dePin, void (*onFrame)()) {
+    if (baud == 0) {
+        return false;
+    }
+    uint32_t ubrr = ((F_CPU / 4UL / baud) - 1UL) / 2UL;   // U2X, rounded
+    if (ubrr == 0 || ubrr > 4095) {
+        return false;
+    }
+    s_address = address;
+    s_dePin = dePin;
+    s_onFrame = onFrame;
+    s_t15Us = (baud > 19200UL) ? 750 : (uint16_t)((16500000UL + baud - 1) / baud);
+    s_t35Us = (baud > 19200UL) ? 1750 : (uint16_t)((38500000UL + baud - 1) / baud);
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    if (dePin >= 0) {
+        pinMode(dePin, OUTPUT);
+        digitalWrite(dePin, LOW);
+    }
+
+    uint8_t format = _BV(MB_UCSZ1) | _BV(MB_UCSZ0);
+    if (parity == MODBUS_PARITY_EVEN) {
+        format |= _BV(MB_UPM1);
+    } else if (parity == MODBUS_PARITY_ODD) {
+        format |= _BV(MB_UPM1) | _BV(MB_UPM0);
+    } else {
+        format |= _BV(MB_USBS);
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        MB_UCSRB = 0;
+        MB_UBRR = (uint16_t)ubrr;
+        MB_UCSRA = _BV(MB_U2X);
+        MB_UCSRC = format;
+        MB_UCSRB = _BV(MB_TXEN);
+        restartReceiver();
+    }
+    return true;
+}
+
+uint8_t modbusSlaveFrame() {
+    uint8_t len = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (s_state == LINK_RX && s_len > 0 && (uint32_t)(micros() - s_lastUs) >= s_t35Us) {
+            closeFrame();
+        }
+        if (s_state == LINK_READY) {
+            len = s_len;
+        }
+    }
+    return len;
+}
+
+uint32_t modbusSlaveFrameUs() {
+    uint32_t us;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        us = s_lastUs;    // Not moved while a frame waits (bytes are dropped)
+    }
+    return us;
+}
+
+bool modbusSlaveReceiving() {
+    bool open;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        open = (s_state == LINK_RX && s_len > 0 && !s_skip);
+    }
+    return open;
+}
+
+uint8_t *modbusSlaveBuffer() {
+    return s_buf;
+}
+
+void modbusSlaveSend(uint8_t len) {
+    if (s_state != LINK_READY || len == 0 || len > MODBUS_ADU_MAX) {
+        modbusSlaveRelease();
+        return;
+    }
+    while ((uint32_t)(micros() - s_lastUs) < s_t35Us) {
+        // Inter-frame silence before the reply
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_txLen = len;
+        s_txIndex = 0;
+        s_state = LINK_TX;
+        MB_UCSRB &= (uint8_t)~(_BV(MB_RXEN) | _BV(MB_RXCIE));
+        if (s_dePin >= 0) {
+            digitalWrite(s_dePin, HIGH);
+        }
+        MB_UCSRA |= _BV(MB_TXC);          // Clear a stale completion
+        MB_UCSRB |= _BV(MB_UDRIE);
+    }
+}
+
+void modbusSlaveRelease() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (s_state == LINK_READY) {
+            restartReceiver();
+        }
+    }
+}
+
+ModbusSlaveStats modbusSlaveStats() {
+    ModbusSlaveStats copy;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        copy = s_stats;
+    }
+    return copy;
+}
+
+#endif // __AVR__
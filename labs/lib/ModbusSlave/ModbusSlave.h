@@ -0,0 +1,127 @@
+/**
+ * @file ModbusSlave.h
+ * @brief Interrupt-Driven Modbus RTU Framing on a Spare USART (RS-485)
+ *
+ * Receives and sends RTU frames on USART1..3 of the Mega 2560 for the
+ * protocol core (ModbusRtu.h), without a timer:
+ *
+ *   - The RX ISR stamps each byte with micros(). A gap over t1.5 inside
+ *     a frame marks it corrupt; one of t3.5 or more starts a new frame.
+ *     t1.5 / t3.5 are 16.5 / 38.5 bit times, fixed at 750 / 1750 µs above
+ *     19200 baud as the specification recommends.
+ *   - A frame ends when its length is known from the header (8 bytes for
+ *     0x03/0x04/0x06/0x08, 9 + byte count for 0x10): the ISR completes it
+ *     on the last byte and calls the frame callback (e.g. a TaskSignal
+ *     give). Other functions end on the t3.5 silence: the callback runs
+ *     on their function code instead, and the task polls
+ *     modbusSlaveFrame() while modbusSlaveReceiving() (a 1-tick take).
+ *   - Frames for another node are skipped in the ISR without a wake-up.
+ *   - The reply is sent from the same buffer by the UDRE interrupt, no
+ *     earlier than t3.5 after the request; the optional RS-485 driver
+ *     enable pin (DE, tie /RE to it) is high from the first byte until
+ *     the TXC interrupt, and the receiver is off meanwhile.
+ *
+ * USART (select with -DMODBUS_SLAVE_USART=<n>):
+ *   3 (default) → TX3 D14 / RX3 D15   2 → TX2 D16 / RX2 D17
+ *   1 → TX1 D18 / RX1 D19
+ * (USART3 by default: lab 5.2 has its fan driver and tach on D16..D18.)
+ * The USART is taken over: do not use the matching SerialN, and keep it
+ * out of idleSleepInit()'s gates.
+ *
+ * One frame at a time: while a request waits for its reply the receiver
+ * drops bytes (counted as overruns). Not built for the native tests.
+ *
+ * Usage:
+ *   static TaskSignal s_frame;
+ *   static void onFrame() { s_frame.giveFromIsr(); }
+ *
+ *   modbusSlaveBegin(19200, MODBUS_PARITY_EVEN, 17, 26, onFrame);   // setup()
+ *   s_frame.bind();                                                 // task
+ *   for (;;) {
+ *       s_frame.take(modbusSlaveReceiving() ? 1 : portMAX_DELAY);
+ *       uint8_t len = modbusSlaveFrame();
+ *       if (len == 0) continue;
+ *       uint8_t n = modbusRtuHandle(&s_modbus, modbusSlaveBuffer(), len, &state);
+ *       if (n > 0) modbusSlaveSend(n); else modbusSlaveRelease();
+ *   }
+ */
+
+#ifndef MODBUS_SLAVE_H
+#define MODBUS_SLAVE_H
+
+#include <Arduino.h>
+#include "ModbusRtu.h"
+
+/** @brief USART used for the bus (1..3). */
+#ifndef MODBUS_SLAVE_USART
+#define MODBUS_SLAVE_USART 3
+#endif
+
+#if MODBUS_SLAVE_USART < 1 || MODBUS_SLAVE_USART > 3
+#error "MODBUS_SLAVE_USART must be 1, 2 or 3"
+#endif
+
+/**
+ * @struct ModbusSlaveStats
+ * @brief Link counters (wrap at 2^16).
+ */
+struct ModbusSlaveStats {
+    uint16_t frames;      ///< Frames handed to modbusSlaveFrame() callers.
+    uint16_t rxErrors;    ///< Frames dropped: framing/parity error or t1.5 gap.
+    uint16_t overruns;    ///< Bytes dropped: too long, or a reply pending.
+    uint16_t skipped;     ///< Frames for another node.
+};
+
+/**
+ * @brief Configure the USART and start receiving.
+ *
+ * @param baud    Bit rate (9600, 19200, …).
+ * @param parity  Character framing.
+ * @param address Node address (1..247): frames for others are skipped.
+ * @param dePin   RS-485 driver enable pin, or -1 (RS-232 / auto-direction).
+ * @param onFrame Called from the RX ISR when a frame for this node (or a
+ *                broadcast) is complete, or has a length only the t3.5
+ *                silence will tell; may be NULL.
+ * @return false if the bit rate cannot be set.
+ */
+bool modbusSlaveBegin(uint32_t baud, ModbusParity parity, uint8_t address,
+                      int8_t dePin, void (*onFrame)());
+
+/**
+ * @brief The complete frame waiting for a reply, closing one on t3.5.
+ *
+ * @return Its length (the bytes are in modbusSlaveBuffer()), or 0.
+ */
+uint8_t modbusSlaveFrame();
+
+/**
+ * @brief micros() of the last byte of the waiting frame.
+ *
+ * Exact for a frame completed on its last byte (length known from the
+ * header); for one closed on the t3.5 silence by the next frame's first
+ * byte, the time of that byte. The receive stamp of a sync broadcast
+ * (TimeSync.h).
+ */
+uint32_t modbusSlaveFrameUs();
+
+/** @brief True while a frame for this node is open (poll modbusSlaveFrame()). */
+bool modbusSlaveReceiving();
+
+/** @brief The frame / reply buffer (MODBUS_ADU_MAX bytes). */
+uint8_t *modbusSlaveBuffer();
+
+/**
+ * @brief Send @p len bytes of modbusSlaveBuffer() as the reply.
+ *
+ * Spins out the rest of the t3.5 gap after the request first (at most
+ * 4 ms at 9600 baud); the receiver restarts when the last bit is out.
+ */
+void modbusSlaveSend(uint8_t len);
+
+/** @brief Drop the waiting frame without a reply (receive the next one). */
+void modbusSlaveRelease();
+
+/** @brief Link counters. */
+ModbusSlaveStats modbusSlaveStats();
+
+#endif // MODBUS_SLAVE_H
@@ -0,0 +1,184 @@
+/**
+ * @file NtcCalibrator.cpp
+ * @brief Online NTC Beta / R0 Estimation Implementation
+ *
+ * Per accepted pair, with x = [1, u] and P the 2×2 covariance:
+ *
+ *   s = r + xᵀ P x            innovation variance
+ *   K = P x / s               gain
+ *   e = y − (a + b u)         innovation, rejected if e² > 25 s
+ *   [a b] += K e,  P −= K xᵀ P,  P_aa += q
+ *
+ * then P_aa and P_bb are clamped to their priors.
+ */
+
+#include "NtcCalibrator.h"
+#include <math.h>
+
+/** Scale of y = S · (1/T − 1/T0). */
+static const float Y_SCALE = 1.0e4f;
+
+/** Random walk of the reading at T0 per accepted pair (°C, σ). */
+static const float OFFSET_DRIFT_C = 0.005f;
+
+/** Reading uncertainty at which the fit counts as converged (°C, σ). */
+static const float CONVERGED_SIGMA_C = 0.1f;
+
+/** Innovation gate (sigmas, squared). */
+static const float GATE_SIGMA2 = 25.0f;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Setup
+// ──────────────────────────────────────────────────────────────────────────
+
+NtcCalibrator::NtcCalibrator(float nominalTempC, float steadyBandC, float steadyTauS,
+                             float noiseC)
+    : _t0K(nominalTempC + 273.15f),
+      _band(steadyBandC),
+      _tauMs(steadyTauS * 1000.0f),
+      _r(0.0f),
+      _rref(1.0f),
+      _a(0.0f),
+      _b(0.0f),
+      _paa(0.0f),
+      _pab(0.0f),
+      _pbb(0.0f),
+      _paaMax(0.0f),
+      _pbbMax(0.0f),
+      _refAvg(0.0f),
+      _lastMs(0),
+      _steadyMs(0),
+      _started(false),
+      _lastU(0.0f),
+      _residualC(0.0f),
+      _samples(0),
+      _rejects(0) {
+    // y per °C near T0.
+    float k = Y_SCALE / (_t0K * _t0K);
+    _r = (noiseC * k) * (noiseC * k);
+}
+
+void NtcCalibrator::reset(float beta, float nominalR, float betaSigma, float offsetSigmaC) {
+    float k = Y_SCALE / (_t0K * _t0K);
+    _rref = nominalR;
+    _a = 0.0f;
+    _b = Y_SCALE / beta;
+    float sa = offsetSigmaC * k;
+    float sb = Y_SCALE * betaSigma / (beta * beta);
+    _paa = _paaMax = sa * sa;
+    _pbb = _pbbMax = sb * sb;
+    _pab = 0.0f;
+    _started = false;
+    _lastU = 0.0f;
+    _residualC = 0.0f;
+    _samples = 0;
+    _rejects = 0;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Update
+// ──────────────────────────────────────────────────────────────────────────
+
+bool NtcCalibrator::addSample(float resistance, float referenceC, uint32_t timeMs) {
+    if (!(resistance > 0.0f) || isnan(referenceC) || referenceC < -55.0f ||
+        referenceC > 125.0f) {
+        return false;
+    }
+
+    // ── Steady gate: the reference near its own average for a while ─────
+    if (!_started) {
+        _started = true;
+        _refAvg = referenceC;
+        _steadyMs = timeMs;
+    } else {
+        float dt = (float)(uint32_t)(timeMs - _lastMs);
+        _refAvg += dt / (_tauMs + dt) * (referenceC - _refAvg);
+        if (fabsf(referenceC - _refAvg) > _band) {
+            _steadyMs = timeMs;
+        }
+    }
+    _lastMs = timeMs;
+    if ((float)(uint32_t)(timeMs - _steadyMs) < _tauMs) {
+        return false;
+    }
+
+    // ── One RLS / Kalman step ───────────────────────────────────────────
+    float tK = referenceC + 273.15f;
+    float y = Y_SCALE * (_t0K - tK) / (tK * _t0K);   // S · (1/T − 1/T0)
+    float u = logf(resistance / _rref);
+
+    float px0 = _paa + _pab * u;
+    float px1 = _pab + _pbb * u;
+    float s = _r + px0 + px1 * u;
+    float e = y - predictY(u);
+    if (e * e > GATE_SIGMA2 * s) {
+        if (_rejects < 0xFFFF) {
+            _rejects++;
+        }
+        return false;
+    }
+
+    // Model reading minus reference, before the update.
+    _residualC = 1.0f / (predictY(u) / Y_SCALE + 1.0f / _t0K) - tK;
+
+    float k0 = px0 / s;
+    float k1 = px1 / s;
+    _a += k0 * e;
+    _b += k1 * e;
+    _paa -= k0 * px0;
+    _pab -= k0 * px1;
+    _pbb -= k1 * px1;
+
+    float kC = Y_SCALE / (_t0K * _t0K);
+    _paa += (OFFSET_DRIFT_C * kC) * (OFFSET_DRIFT_C * kC);
+    if (_paa > _paaMax) _paa = _paaMax;
+    if (_pbb > _pbbMax) _pbb = _pbbMax;
+    if (_paa < 1.0e-12f) _paa = 1.0e-12f;
+    if (_pbb < 1.0e-12f) _pbb = 1.0e-12f;
+
+    _lastU = u;
+    if (_samples < 0xFFFF) {
+        _samples++;
+    }
+    return true;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Results
+// ──────────────────────────────────────────────────────────────────────────
+
+float NtcCalibrator::getBeta() const {
+    return Y_SCALE / _b;
+}
+
+float NtcCalibrator::getNominalResistance() const {
+    return _rref * expf(-_a / _b);
+}
+
+float NtcCalibrator::getSigmaC() const {
+    // Var(a + b u) at the last pair, converted with dy/dT there.
+    float var = _paa + 2.0f * _pab * _lastU + _pbb * _lastU * _lastU;
+    float invT = predictY(_lastU) / Y_SCALE + 1.0f / _t0K;
+    return sqrtf(var) / (Y_SCALE * invT * invT);
+}
+
+float NtcCalibrator::getBetaSigma() const {
+    float beta = getBeta();
+    return sqrtf(_pbb) * beta * beta / Y_SCALE;
+}
+
+float NtcCalibrator::getLastResidualC() const {
+    return _residualC;
+}
+
+uint16_t NtcCalibrator::getSampleCount() const {
+    return _samples;
+}
+
+uint16_t NtcCalibrator::getRejectCount() const {
+    return _rejects;
+}
+
+bool NtcCalibrator::isConverged() const {
+    return _samples >= NTC_CALIBRATOR_MIN_SAMPLES && getSigmaC() <= CONVERGED_SIGMA_C;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file NtcCalibrator.h
+ * @brief Online NTC Beta / R0 Estimation Against a Reference Thermometer
+ *
+ * The Beta equation ties the NTC resistance to temperature through two
+ * part constants, the Beta value and the resistance R0 at T0, that the
+ * datasheet only gives within a few percent. With β 3950 / 10 kΩ taken
+ * as exact, a real part reads a degree or so off, by an amount that
+ * changes with temperature. A DS18B20 on the same board is accurate
+ * (±0.5 °C) but slow; this class fits the NTC constants to it while the
+ * two run side by side, so the fast sensor inherits the slow one's
+ * accuracy.
+ *
+ * The Beta equation is linear in ln R:
+ *
+ *   1/T = 1/T0 + (1/β) · ln(R / R0)
+ *   y = a + b · u,   u = ln(R / Rref),   y = S · (1/T − 1/T0)
+ *
+ * with b = S / β, a = −b · ln(R0 / Rref), Rref the starting R0 and
+ * S = 10^4 to keep the float arithmetic well scaled. Each accepted pair
+ * (R from the NTC, T from the reference) is one recursive least-squares
+ * step on [a, b], written as a Kalman update with measurement noise and
+ * a prior: the datasheet constants with their tolerance. At a single
+ * temperature only the offset (R0) is observable; β moves only as the
+ * data spans a range, otherwise the prior holds it. A small random walk
+ * on the offset lets R0 follow slow drift, and no variance ever rises
+ * above its prior (no windup while the temperature does not move).
+ *
+ * Pairs are only used while the temperature is steady: the probes have
+ * different thermal lags, so during a change they disagree for reasons
+ * the model does not describe. A pair counts when the reference has
+ * stayed within the steady band of its average (time constant
+ * steadyTauS) for steadyTauS. Pairs whose innovation exceeds five sigma
+ * are rejected as outliers (a loose probe, a reference read error).
+ *
+ * Portable (no hardware): runs natively in tests.
+ *
+ * Usage:
+ *   NtcCalibrator cal(25.0f, 0.15f, 30.0f);
+ *   cal.reset(3950.0f, 10000.0f, 150.0f, 3.0f);   // prior ±150 K, ±3 °C
+ *   ...
+ *   if (dsFresh && bothValid) {
+ *       cal.addSample(ntc.getLastResistance(), dsTempC, millis());
+ *   }
+ *   if (cal.isConverged()) {
+ *       ntc.setCalibration(cal.getBeta(), cal.getNominalResistance());
+ *   }
+ */
+
+#ifndef NTC_CALIBRATOR_H
+#define NTC_CALIBRATOR_H
+
+#include <stdint.h>
+
+/** @brief Accepted pairs before isConverged() can become true. */
+#ifndef NTC_CALIBRATOR_MIN_SAMPLES
+#define NTC_CALIBRATOR_MIN_SAMPLES 20
+#endif
+
+/**
+ * @class NtcCalibrator
+ * @brief Two-parameter RLS (Kalman) fit of the NTC Beta equation.
+ */
+class NtcCalibrator {
+public:
+    /**
+     * @param nominalTempC T0 of the Beta equation (°C, usually 25).
+     * @param steadyBandC  Reference within this of its average = steady.
+     * @param steadyTauS   Averaging time constant and steady hold time (s).
+     * @param noiseC       Pair disagreement treated as noise (σ, °C).
+     */
+    NtcCalibrator(float nominalTempC, float steadyBandC, float steadyTauS,
+                  float noiseC = 0.15f);
+
+    /**
+     * @brief Start over from a prior.
+     *
+     * @param beta        Starting Beta (K).
+     * @param nominalR    Starting R0 (Ω at T0); also the fixed Rref.
+     * @param betaSigma   Prior uncertainty of Beta (K, σ).
+     * @param offsetSigmaC Prior uncertainty of the reading at T0 (°C, σ).
+     */
+    void reset(float beta, float nominalR, float betaSigma, float offsetSigmaC);
+
+    /**
+     * @brief Offer one paired reading.
+     *
+     * @param resistance NTC resistance (Ω, > 0).
+     * @param referenceC Reference temperature (°C).
+     * @param timeMs     Time of the pair (any monotonic ms clock).
+     * @return true if the pair updated the fit.
+     */
+    bool addSample(float resistance, float referenceC, uint32_t timeMs);
+
+    /** @brief Current Beta estimate (K). */
+    float getBeta() const;
+
+    /** @brief Current R0 estimate (Ω at T0). */
+    float getNominalResistance() const;
+
+    /**
+     * @brief Uncertainty of the reading at the temperature of the last
+     *        accepted pair (°C, σ); at T0 before the first one.
+     */
+    float getSigmaC() const;
+
+    /** @brief Uncertainty of Beta (K, σ). */
+    float getBetaSigma() const;
+
+    /** @brief Fit error of the last accepted pair before its update (°C). */
+    float getLastResidualC() const;
+
+    /** @brief Pairs that updated the fit since reset(). */
+    uint16_t getSampleCount() const;
+
+    /** @brief Pairs rejected as outliers since reset(). */
+    uint16_t getRejectCount() const;
+
+    /**
+     * @brief True once NTC_CALIBRATOR_MIN_SAMPLES pairs were accepted and
+     *        getSigmaC() is within a tenth of a degree.
+     */
+    bool isConverged() const;
+
+private:
+    float predictY(float u) const { return _a + _b * u; }
+
+    float    _t0K;           ///< T0 (K).
+    float    _band;          ///< Steady band (°C).
+    float    _tauMs;         ///< Steady time constant (ms).
+    float    _r;             ///< Measurement variance (y units).
+    float    _rref;          ///< Fixed Rref (Ω).
+    float    _a, _b;         ///< Parameters.
+    float    _paa, _pab, _pbb;   ///< Covariance.
+    float    _paaMax, _pbbMax;   ///< Prior variances (caps).
+    float    _refAvg;        ///< Reference average (°C).
+    uint32_t _lastMs;        ///< Time of the previous pair.
+    uint32_t _steadyMs;      ///< Start of the current steady stretch.
+    bool     _started;       ///< _refAvg / _lastMs hold a pair.
+    float    _lastU;         ///< u of the last accepted pair.
+    float    _residualC;
+    uint16_t _samples;
+    uint16_t _rejects;
+};
+
+#endif // NTC_CALIBRATOR_H
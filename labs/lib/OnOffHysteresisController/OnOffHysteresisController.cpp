@@ -9,31 +9,144 @@ OnOffHysteresisController::OnOffHysteresisController(float setpoint,
                                                      float hysteresisBand)
     : _setpoint(setpoint),
       _hysteresisBand(hysteresisBand),
-      _state(HYSTERESIS_OUTPUT_OFF) {}
+      _state(HYSTERESIS_OUTPUT_OFF),
+      _onCounts(0),
+      _offCounts(0),
+      _anticipate(false),
+      _maxLead(0.0f),
+      _tracking(0),
+      _switchValue(0.0f),
+      _extreme(0.0f),
+      _samplesSinceSwitch(0),
+      _samplesToExtreme(0) {
+    resetLearning();
+}
 
 void OnOffHysteresisController::init() {
     _state = HYSTERESIS_OUTPUT_OFF;
+    _tracking = 0;
 }
 
 void OnOffHysteresisController::setConfig(float setpoint, float hysteresisBand) {
+    if (setpoint != _setpoint) {
+        _tracking = 0;   // The running cycle no longer says anything about the plant
+    }
     _setpoint = setpoint;
     _hysteresisBand = hysteresisBand;
 }
 
+void OnOffHysteresisController::setAnticipation(bool enabled, float maxLead) {
+    _anticipate = enabled;
+    _maxLead = (maxLead > 0.0f) ? maxLead : 0.0f;
+}
+
+void OnOffHysteresisController::resetLearning() {
+    _overshootHigh = 0.0f;
+    _overshootLow = 0.0f;
+    _deadTimeHigh = 0.0f;
+    _deadTimeLow = 0.0f;
+    _learnedCycles = 0;
+    _tracking = 0;
+}
+
 bool OnOffHysteresisController::update(float measuredValue) {
+    learn(measuredValue);
+
     if (_state == HYSTERESIS_OUTPUT_OFF &&
-        measuredValue <= getLowerThreshold()) {
+        measuredValue <= getSwitchOnThreshold()) {
         _state = HYSTERESIS_OUTPUT_ON;
+        beginTracking(-1, measuredValue);
     } else if (_state == HYSTERESIS_OUTPUT_ON &&
-               measuredValue >= getUpperThreshold()) {
+               measuredValue >= getSwitchOffThreshold()) {
         _state = HYSTERESIS_OUTPUT_OFF;
+        beginTracking(1, measuredValue);
     }
 
     return isOutputOn();
 }
 
+void OnOffHysteresisController::setCountLimits(int32_t switchOnCounts,
+                                               int32_t switchOffCounts) {
+    _onCounts = switchOnCounts;
+    _offCounts = switchOffCounts;
+}
+
+bool OnOffHysteresisController::updateCounts(int32_t counts) {
+    // ON count above the OFF count: counts fall as the value rises.
+    bool falling = _onCounts > _offCounts;
+    if (_state == HYSTERESIS_OUTPUT_OFF &&
+        (falling ? counts >= _onCounts : counts <= _onCounts)) {
+        _state = HYSTERESIS_OUTPUT_ON;
+    } else if (_state == HYSTERESIS_OUTPUT_ON &&
+               (falling ? counts <= _offCounts : counts >= _offCounts)) {
+        _state = HYSTERESIS_OUTPUT_OFF;
+    }
+    return isOutputOn();
+}
+
 void OnOffHysteresisController::forceOutput(bool outputOn) {
     _state = outputOn ? HYSTERESIS_OUTPUT_ON : HYSTERESIS_OUTPUT_OFF;
+    _tracking = 0;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Anticipator
+// ──────────────────────────────────────────────────────────────────────────
+
+void OnOffHysteresisController::beginTracking(int8_t direction, float switchValue) {
+    if (_tracking != 0) {
+        finishTracking();   // Switched again before the turn-around
+    }
+    _tracking = direction;
+    _switchValue = switchValue;
+    _extreme = switchValue;
+    _samplesSinceSwitch = 0;
+    _samplesToExtreme = 0;
+}
+
+void OnOffHysteresisController::learn(float measuredValue) {
+    if (_tracking == 0) {
+        return;
+    }
+    if (_samplesSinceSwitch < 0xFFFF) {
+        _samplesSinceSwitch++;
+    }
+    bool further = (_tracking > 0) ? measuredValue > _extreme : measuredValue < _extreme;
+    bool turned = (_tracking > 0) ? measuredValue < _extreme : measuredValue > _extreme;
+    if (further) {
+        _extreme = measuredValue;
+        _samplesToExtreme = _samplesSinceSwitch;
+    } else if (turned) {
+        finishTracking();
+    }
+}
+
+void OnOffHysteresisController::finishTracking() {
+    float overshoot = (_tracking > 0) ? _extreme - _switchValue : _switchValue - _extreme;
+    float deadTime = (float)_samplesToExtreme;
+    float w = (_learnedCycles == 0) ? 1.0f : HYSTERESIS_LEARN_WEIGHT;
+    if (_tracking > 0) {
+        _overshootHigh += w * (overshoot - _overshootHigh);
+        _deadTimeHigh += w * (deadTime - _deadTimeHigh);
+    } else {
+        _overshootLow += w * (overshoot - _overshootLow);
+        _deadTimeLow += w * (deadTime - _deadTimeLow);
+    }
+    if (_learnedCycles < 0xFF) {
+        _learnedCycles++;
+    }
+    _tracking = 0;
+}
+
+float OnOffHysteresisController::appliedLead(float learned) const {
+    if (!_anticipate) {
+        return 0.0f;
+    }
+    float limit = _hysteresisBand * 0.4f;
+    if (_maxLead < limit) {
+        limit = _maxLead;
+    }
+    return (learned < limit) ? learned : limit;
 }
 
 bool OnOffHysteresisController::isOutputOn() const {
@@ -59,3 +172,35 @@ float OnOffHysteresisController::getSetpoint() const {
 float OnOffHysteresisController::getHysteresisBand() const {
     return _hysteresisBand;
 }
+
+float OnOffHysteresisController::getSwitchOnThreshold() const {
+    return getLowerThreshold() + appliedLead(_overshootLow);
+}
+
+float OnOffHysteresisController::getSwitchOffThreshold() const {
+    return getUpperThreshold() - appliedLead(_overshootHigh);
+}
+
+bool OnOffHysteresisController::isAnticipating() const {
+    return _anticipate;
+}
+
+float OnOffHysteresisController::getOvershootHigh() const {
+    return _overshootHigh;
+}
+
+float OnOffHysteresisController::getOvershootLow() const {
+    return _overshootLow;
+}
+
+float OnOffHysteresisController::getDeadTimeHighSamples() const {
+    return _deadTimeHigh;
+}
+
+float OnOffHysteresisController::getDeadTimeLowSamples() const {
+    return _deadTimeLow;
+}
+
+uint8_t OnOffHysteresisController::getLearnedCycles() const {
+    return _learnedCycles;
+}
@@ -6,6 +6,26 @@
  * the lower threshold and turns it OFF when the measured value rises above
  * the upper threshold. Values inside the hysteresis band preserve the last
  * output, preventing relay chatter around the setpoint.
+ *
+ * Anticipator (setAnticipation()): with thermal lag the value keeps
+ * moving after each switch and overshoots the band. The controller
+ * watches every switch until the value turns around, learns the
+ * overshoot beyond the switch point and the samples it took (dead time),
+ * and switches that much earlier next time:
+ *
+ *   OFF at  upper − leadHigh        ON at  lower + leadLow
+ *
+ * Leads are averaged over cycles (weight HYSTERESIS_LEARN_WEIGHT) and
+ * capped at maxLead and at 40 % of the band, so at least a fifth of the
+ * band always remains as hysteresis.
+ *
+ * ADC domain (setCountLimits(), updateCounts()): with a monotonic sensor
+ * the switch points can be mapped to raw counts once (e.g. through
+ * AnalogTempSensor::rawAtTemperatureC()), and each sample then costs two
+ * integer compares. For counts that fall as the value rises (NTC on the
+ * ground side) the ON count is above the OFF count. The anticipator
+ * learns from values only, so map the switch points again after it moved
+ * them or after setConfig().
  */
 
 #ifndef ON_OFF_HYSTERESIS_CONTROLLER_H
@@ -13,6 +33,9 @@
 
 #include <Arduino.h>
 
+/** @brief Weight of the newest cycle in the learned overshoot averages. */
+#define HYSTERESIS_LEARN_WEIGHT 0.3f
+
 enum HysteresisOutputState {
     HYSTERESIS_OUTPUT_OFF = 0,
     HYSTERESIS_OUTPUT_ON = 1
@@ -39,6 +62,29 @@ public:
      */
     bool update(float measuredValue);
 
+    /**
+     * @brief Switch points of updateCounts(), in the sensor's raw counts.
+     * @param switchOnCounts  getSwitchOnThreshold() mapped to counts.
+     * @param switchOffCounts getSwitchOffThreshold() mapped to counts.
+     */
+    void setCountLimits(int32_t switchOnCounts, int32_t switchOffCounts);
+
+    /**
+     * @brief Process one sample given in raw counts (see setCountLimits()).
+     * @return true when actuator command is ON.
+     */
+    bool updateCounts(int32_t counts);
+
+    /**
+     * @brief Enable or disable overshoot anticipation.
+     * @param enabled Switch early by the learned overshoot.
+     * @param maxLead Largest early-switch distance (measured-value units).
+     */
+    void setAnticipation(bool enabled, float maxLead);
+
+    /** @brief Forget the learned overshoot and dead time. */
+    void resetLearning();
+
     /** @brief Force the output to a known state. */
     void forceOutput(bool outputOn);
 
@@ -60,10 +106,56 @@ public:
     /** @brief Configured full hysteresis band. */
     float getHysteresisBand() const;
 
+    /** @brief Value at which the output actually turns ON (lower + lead). */
+    float getSwitchOnThreshold() const;
+
+    /** @brief Value at which the output actually turns OFF (upper − lead). */
+    float getSwitchOffThreshold() const;
+
+    bool isAnticipating() const;
+
+    /** @brief Learned rise beyond the OFF switch point. */
+    float getOvershootHigh() const;
+
+    /** @brief Learned fall beyond the ON switch point. */
+    float getOvershootLow() const;
+
+    /** @brief Learned samples from the OFF switch to the peak. */
+    float getDeadTimeHighSamples() const;
+
+    /** @brief Learned samples from the ON switch to the trough. */
+    float getDeadTimeLowSamples() const;
+
+    /** @brief Overshoots measured since resetLearning() (saturates). */
+    uint8_t getLearnedCycles() const;
+
 private:
     float _setpoint;
     float _hysteresisBand;
     HysteresisOutputState _state;
+    int32_t _onCounts;
+    int32_t _offCounts;
+
+    /** @brief Lead actually applied: learned value within the limits. */
+    float appliedLead(float learned) const;
+    /** @brief Follow the value after a switch until it turns around. */
+    void learn(float measuredValue);
+    void beginTracking(int8_t direction, float switchValue);
+    void finishTracking();
+
+    bool _anticipate;
+    float _maxLead;
+    float _overshootHigh;
+    float _overshootLow;
+    float _deadTimeHigh;
+    float _deadTimeLow;
+    uint8_t _learnedCycles;
+
+    int8_t _tracking;         ///< +1 after OFF (peak), −1 after ON (trough), 0 idle
+    float _switchValue;
+    float _extreme;
+    uint16_t _samplesSinceSwitch;
+    uint16_t _samplesToExtreme;
 };
 
 #endif // ON_OFF_HYSTERESIS_CONTROLLER_H
@@ -0,0 +1,212 @@
+/**
+ * @file StagedHysteresisController.cpp
+ * @brief Multi-stage ON-OFF controller implementation.
+ */
+
+#include "StagedHysteresisController.h"
+
+StagedHysteresisController::StagedHysteresisController(uint8_t stages, float setpoint,
+                                                       StagedAction action)
+    : _stages(stages == 0 ? 1 : (stages > STAGED_MAX_STAGES ? STAGED_MAX_STAGES : stages)),
+      _setpoint(setpoint),
+      _action(action),
+      _minOnMs(0),
+      _minOffMs(0),
+      _interStageMs(0),
+      _rotate(true) {
+    for (uint8_t i = 0; i < STAGED_MAX_STAGES; i++) {
+        _offset[i] = (float)i;      // 1-unit spacing until configured
+        _band[i] = 1.0f;
+    }
+    init();
+}
+
+void StagedHysteresisController::init() {
+    _demand = 0;
+    _mask = 0;
+    for (uint8_t i = 0; i < STAGED_MAX_STAGES; i++) {
+        _changedMs[i] = 0;
+        _runMs[i] = 0;
+        _starts[i] = 0;
+    }
+    _lastStageChangeMs = 0;
+    _lastUpdateMs = 0;
+    _started = false;
+}
+
+void StagedHysteresisController::setSetpoint(float setpoint) {
+    _setpoint = setpoint;
+}
+
+bool StagedHysteresisController::setStage(uint8_t index, float offset, float band) {
+    if (index >= _stages) {
+        return false;
+    }
+    _offset[index] = offset;
+    _band[index] = (band > 0.0f) ? band : 0.0f;
+    return true;
+}
+
+void StagedHysteresisController::setTimers(uint32_t minOnMs, uint32_t minOffMs,
+                                           uint32_t interStageMs) {
+    _minOnMs = minOnMs;
+    _minOffMs = minOffMs;
+    _interStageMs = interStageMs;
+}
+
+void StagedHysteresisController::setRotation(bool enabled) {
+    _rotate = enabled;
+}
+
+float StagedHysteresisController::error(float measuredValue) const {
+    return (_action == STAGED_HEATING) ? _setpoint - measuredValue : measuredValue - _setpoint;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Control step
+// ──────────────────────────────────────────────────────────────────────────
+
+uint8_t StagedHysteresisController::update(float measuredValue, uint32_t nowMs) {
+    if (!_started) {
+        // Nothing has switched yet: no minimum time or stage delay applies.
+        _started = true;
+        for (uint8_t i = 0; i < _stages; i++) {
+            _changedMs[i] = nowMs - (_minOnMs > _minOffMs ? _minOnMs : _minOffMs);
+        }
+        _lastStageChangeMs = nowMs - _interStageMs;
+        _lastUpdateMs = nowMs;
+    }
+    accumulate(nowMs);
+
+    // Demand with per-stage hysteresis: step up past a stage's upper edge,
+    // down below the lower edge of the highest stage held.
+    float e = error(measuredValue);
+    while (_demand < _stages &&
+           e >= _offset[_demand] + 0.5f * _band[_demand]) {
+        _demand++;
+    }
+    while (_demand > 0 &&
+           e <= _offset[_demand - 1] - 0.5f * _band[_demand - 1]) {
+        _demand--;
+    }
+
+    // One output per interStageMs towards the demand.
+    uint8_t active = getActiveStages();
+    if (active != _demand &&
+        (uint32_t)(nowMs - _lastStageChangeMs) >= _interStageMs) {
+        int8_t output = (active < _demand) ? pickStart(nowMs) : pickStop(nowMs);
+        if (output >= 0) {
+            setOutput((uint8_t)output, active < _demand, nowMs);
+            _lastStageChangeMs = nowMs;
+        }
+    }
+    return _mask;
+}
+
+void StagedHysteresisController::forceAllOff(uint32_t nowMs) {
+    accumulate(nowMs);
+    for (uint8_t i = 0; i < _stages; i++) {
+        if (_mask & (1U << i)) {
+            setOutput(i, false, nowMs);
+        }
+    }
+    _demand = 0;
+}
+
+void StagedHysteresisController::accumulate(uint32_t nowMs) {
+    uint32_t elapsed = nowMs - _lastUpdateMs;
+    _lastUpdateMs = nowMs;
+    for (uint8_t i = 0; i < _stages; i++) {
+        if ((_mask & (1U << i)) != 0) {
+            _runMs[i] = (_runMs[i] > UINT32_MAX - elapsed) ? UINT32_MAX : _runMs[i] + elapsed;
+        }
+    }
+}
+
+int8_t StagedHysteresisController::pickStart(uint32_t nowMs) const {
+    int8_t best = -1;
+    for (uint8_t i = 0; i < _stages; i++) {
+        bool idle = (_mask & (1U << i)) == 0;
+        if (!idle || (uint32_t)(nowMs - _changedMs[i]) < _minOffMs) {
+            continue;
+        }
+        if (!_rotate) {
+            return (int8_t)i;              // Fixed order: lowest idle output
+        }
+        if (best < 0 || _runMs[i] < _runMs[best]) {
+            best = (int8_t)i;
+        }
+    }
+    return best;
+}
+
+int8_t StagedHysteresisController::pickStop(uint32_t nowMs) const {
+    int8_t best = -1;
+    for (int8_t i = (int8_t)_stages - 1; i >= 0; i--) {
+        bool running = (_mask & (1U << i)) != 0;
+        if (!running || (uint32_t)(nowMs - _changedMs[i]) < _minOnMs) {
+            continue;
+        }
+        if (!_rotate) {
+            return i;                      // Fixed order: highest running output
+        }
+        if (best < 0 || _runMs[i] > _runMs[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void StagedHysteresisController::setOutput(uint8_t output, bool on, uint32_t nowMs) {
+    if (on) {
+        _mask |= (uint8_t)(1U << output);
+        if (_starts[output] < 0xFFFF) {
+            _starts[output]++;
+        }
+    } else {
+        _mask &= (uint8_t)~(1U << output);
+    }
+    _changedMs[output] = nowMs;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Accessors
+// ──────────────────────────────────────────────────────────────────────────
+
+uint8_t StagedHysteresisController::getOutputMask() const {
+    return _mask;
+}
+
+bool StagedHysteresisController::isOutputOn(uint8_t output) const {
+    return output < _stages && (_mask & (1U << output)) != 0;
+}
+
+uint8_t StagedHysteresisController::getDemandedStages() const {
+    return _demand;
+}
+
+uint8_t StagedHysteresisController::getActiveStages() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < _stages; i++) {
+        if (_mask & (1U << i)) {
+            n++;
+        }
+    }
+    return n;
+}
+
+uint8_t StagedHysteresisController::getStageCount() const {
+    return _stages;
+}
+
+uint32_t StagedHysteresisController::getRunTimeMs(uint8_t output) const {
+    return (output < _stages) ? _runMs[output] : 0;
+}
+
+uint16_t StagedHysteresisController::getStartCount(uint8_t output) const {
+    return (output < _stages) ? _starts[output] : 0;
+}
+
+float StagedHysteresisController::getSetpoint() const {
+    return _setpoint;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file StagedHysteresisController.h
+ * @brief Multi-stage ON-OFF controller (staged heaters or fans).
+ *
+ * Drives up to STAGED_MAX_STAGES outputs from one measurement. Stage k is
+ * called for when the error (heating: setpoint − value, cooling:
+ * value − setpoint) reaches its offset + band/2 and released when it
+ * falls to offset − band/2, so each stage has its own hysteresis:
+ *
+ *   error ─►  0      offset₁     offset₂
+ *   stage 1  ├─band─┤
+ *   stage 2          ├──band──┤
+ *   stage 3                     ├──band──┤
+ *
+ * Demand changes are applied one stage at a time, at most every
+ * interStageMs, and an output never switches before its minimum ON/OFF
+ * time, so a brief excursion does not cycle the whole bank. With
+ * rotation on, demands are served by physical outputs in turn: the idle
+ * output with the least accumulated run time starts, the running output
+ * with the most stops, which evens out contactor and element wear.
+ *
+ * Usage:
+ *   StagedHysteresisController heat(2, 22.0f, STAGED_HEATING);
+ *   heat.setStage(0, 0.0f, 1.0f);      // at setpoint ±0.5
+ *   heat.setStage(1, 1.5f, 1.0f);      // 1–2 °C below the setpoint
+ *   heat.setTimers(60000, 60000, 30000);
+ *   uint8_t mask = heat.update(temperature, millis());
+ *   relayA.setState(mask & 0x01);
+ *   relayB.setState(mask & 0x02);
+ */
+
+#ifndef STAGED_HYSTERESIS_CONTROLLER_H
+#define STAGED_HYSTERESIS_CONTROLLER_H
+
+#include <Arduino.h>
+
+/** @brief Largest number of stages / outputs (bits of the output mask). */
+#define STAGED_MAX_STAGES 4
+
+enum StagedAction {
+    STAGED_HEATING = 0,   ///< Outputs raise the value (heater stages)
+    STAGED_COOLING = 1    ///< Outputs lower the value (fan / compressor stages)
+};
+
+class StagedHysteresisController {
+public:
+    /**
+     * @param stages   Number of stages and outputs (1..STAGED_MAX_STAGES).
+     * @param setpoint Desired value.
+     * @param action   Heating or cooling.
+     */
+    StagedHysteresisController(uint8_t stages, float setpoint, StagedAction action);
+
+    /** @brief All outputs OFF, run times and counters cleared. */
+    void init();
+
+    void setSetpoint(float setpoint);
+
+    /**
+     * @brief Configure stage @p index (thresholds should increase with it).
+     * @param offset Error at the centre of the stage's band.
+     * @param band   Full hysteresis band of the stage.
+     * @return false if the index is out of range.
+     */
+    bool setStage(uint8_t index, float offset, float band);
+
+    /** @brief Minimum ON/OFF time of an output and delay between stage changes. */
+    void setTimers(uint32_t minOnMs, uint32_t minOffMs, uint32_t interStageMs);
+
+    /** @brief Equal run-time rotation (default on); off = fixed stage order. */
+    void setRotation(bool enabled);
+
+    /**
+     * @brief Process one sample.
+     * @return Output bit mask (bit i = output i ON).
+     */
+    uint8_t update(float measuredValue, uint32_t nowMs);
+
+    /** @brief Fail safe: every output OFF at once (ignores minimum ON times). */
+    void forceAllOff(uint32_t nowMs);
+
+    uint8_t getOutputMask() const;
+    bool isOutputOn(uint8_t output) const;
+    /** @brief Stages the error calls for. */
+    uint8_t getDemandedStages() const;
+    /** @brief Outputs currently ON. */
+    uint8_t getActiveStages() const;
+    uint8_t getStageCount() const;
+    /** @brief Accumulated ON time of an output (ms, saturates). */
+    uint32_t getRunTimeMs(uint8_t output) const;
+    /** @brief OFF → ON transitions of an output (saturates). */
+    uint16_t getStartCount(uint8_t output) const;
+    float getSetpoint() const;
+
+private:
+    float error(float measuredValue) const;
+    void accumulate(uint32_t nowMs);
+    /** @brief Output to start (−1 if none may start yet). */
+    int8_t pickStart(uint32_t nowMs) const;
+    /** @brief Output to stop (−1 if none may stop yet). */
+    int8_t pickStop(uint32_t nowMs) const;
+    void setOutput(uint8_t output, bool on, uint32_t nowMs);
+
+    uint8_t _stages;
+    float _setpoint;
+    StagedAction _action;
+    float _offset[STAGED_MAX_STAGES];
+    float _band[STAGED_MAX_STAGES];
+    uint32_t _minOnMs;
+    uint32_t _minOffMs;
+    uint32_t _interStageMs;
+    bool _rotate;
+
+    uint8_t _demand;
+    uint8_t _mask;
+    uint32_t _changedMs[STAGED_MAX_STAGES];   // Last switch of each output
+    uint32_t _runMs[STAGED_MAX_STAGES];
+    uint16_t _starts[STAGED_MAX_STAGES];
+    uint32_t _lastStageChangeMs;
+    uint32_t _lastUpdateMs;
+    bool _started;                            // First update() seen
+};
+
+#endif // STAGED_HYSTERESIS_CONTROLLER_H
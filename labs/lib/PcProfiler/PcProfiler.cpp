@@ -0,0 +1,267 @@
+/**
+ * @file PcProfiler.cpp
+ * @brief Statistical PC-Sampling Profiler Implementation
+ *
+ * The AVR pushes the return address most significant byte last, so on
+ * entry to the vector it sits at SP+1 (bits 16–21), SP+2, SP+3 (bits
+ * 0–7), as a word address. The naked vector saves r30/r31, copies SP to
+ * Z, saves r0 and copies the three bytes (ldd/sts/push/pop leave SREG
+ * alone, so it needs no SREG save), restores the registers and jumps to
+ * the binning handler. That one has the signal attribute: its prologue
+ * saves what it uses and its reti returns to the interrupted code.
+ *
+ * Samples are counted in byte addresses (word address × 2), the unit of
+ * avr-nm and avr-objdump.
+ */
+
+#include "PcProfiler.h"
+#include "FlashString.h"
+#include <Arduino.h>
+#include <stdio.h>
+
+#if defined(PC_PROFILER_ENABLED) && defined(__AVR__)
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+static_assert((PC_PROFILER_BINS & (PC_PROFILER_BINS - 1)) == 0,
+              "PC_PROFILER_BINS must be a power of two");
+
+// ──────────────────────────────────────────────────────────────────────────
+// Timer register selection
+// ──────────────────────────────────────────────────────────────────────────
+
+#define PP_REG2(prefix, n, suffix) prefix##n##suffix
+#define PP_REG(prefix, n, suffix)  PP_REG2(prefix, n, suffix)
+
+#define PP_TCCRA      PP_REG(TCCR, PC_PROFILER_TIMER, A)
+#define PP_TCCRB      PP_REG(TCCR, PC_PROFILER_TIMER, B)
+#define PP_TCNT       PP_REG(TCNT, PC_PROFILER_TIMER, )
+#define PP_OCRA       PP_REG(OCR, PC_PROFILER_TIMER, A)
+#define PP_TIMSK      PP_REG(TIMSK, PC_PROFILER_TIMER, )
+#define PP_TIFR       PP_REG(TIFR, PC_PROFILER_TIMER, )
+#define PP_COMPA_vect PP_REG(TIMER, PC_PROFILER_TIMER, _COMPA_vect)
+
+// Bit positions are the same in every 16-bit timer.
+#define PP_WGM2  WGM12   /**< CTC, TOP = OCRnA (WGMn3:0 = 0100). */
+#define PP_CS1   CS11    /**< Prescaler 8. */
+#define PP_OCIEA OCIE1A
+#define PP_OCFA  OCF1A
+
+/** @brief Compare value for PC_PROFILER_HZ at prescaler 8. */
+static const uint32_t PP_TOP = F_CPU / 8UL / PC_PROFILER_HZ - 1;
+static_assert(PP_TOP >= 1 && PP_TOP <= 0xFFFF, "PC_PROFILER_HZ out of range at prescaler 8");
+
+// ──────────────────────────────────────────────────────────────────────────
+// State
+// ──────────────────────────────────────────────────────────────────────────
+
+/** Last return address, LSB first (written by the naked vector only). */
+extern "C" volatile uint8_t pcProfilerPc[3];
+volatile uint8_t pcProfilerPc[3];
+
+static uint16_t s_bins[PC_PROFILER_BINS];
+static uint32_t s_base;            ///< First byte address of the range.
+static uint32_t s_end;             ///< One past the last.
+static uint8_t  s_shift;           ///< log2 of the bin width in bytes.
+static uint32_t s_samples;
+static uint16_t s_outside;         ///< Samples outside [s_base, s_end) (saturates).
+static volatile bool s_saturated;  ///< A bin reached 65535; sampling stopped.
+
+/** @brief End of the program text (byte address; the text may pass 64 KB). */
+static uint32_t textEnd() {
+    extern const char _etext[] PROGMEM;  // Linker script
+    return pgm_get_far_address(_etext);
+}
+
+static inline void timerEnable(bool on) {
+    if (on) {
+        PP_TIFR = _BV(PP_OCFA);
+        PP_TIMSK |= _BV(PP_OCIEA);
+    } else {
+        PP_TIMSK &= (uint8_t)~_BV(PP_OCIEA);
+    }
+}
+
+static void clearHistogram() {
+    for (uint16_t i = 0; i < PC_PROFILER_BINS; i++) {
+        s_bins[i] = 0;
+    }
+    s_samples = 0;
+    s_outside = 0;
+    s_saturated = false;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Sampling
+// ──────────────────────────────────────────────────────────────────────────
+
+/** Bins pcProfilerPc; entered by a jump from the vector, returns with reti. */
+extern "C" void __vector_pc_profiler_bin(void) __attribute__((signal, used));
+
+void __vector_pc_profiler_bin(void) {
+    uint32_t pc = (((uint32_t)pcProfilerPc[2] << 16) | ((uint16_t)pcProfilerPc[1] << 8) |
+                   pcProfilerPc[0]) << 1;
+    s_samples++;
+    if (pc < s_base || pc >= s_end) {
+        if (s_outside < 0xFFFF) {
+            s_outside++;
+        }
+        return;
+    }
+    uint16_t *bin = &s_bins[(uint16_t)((pc - s_base) >> s_shift)];
+    if (++*bin == 0xFFFF) {
+        s_saturated = true;
+        timerEnable(false);
+    }
+}
+
+ISR(PP_COMPA_vect, ISR_NAKED) {
+    asm volatile(
+        "push r30                    \n\t"
+        "push r31                    \n\t"
+        "in   r30, __SP_L__          \n\t"
+        "in   r31, __SP_H__          \n\t"
+        "push r0                     \n\t"
+#if defined(__AVR_3_BYTE_PC__)
+        "ldd  r0, Z+3                \n\t"
+        "sts  pcProfilerPc+2, r0     \n\t"
+        "ldd  r0, Z+4                \n\t"
+        "sts  pcProfilerPc+1, r0     \n\t"
+        "ldd  r0, Z+5                \n\t"
+        "sts  pcProfilerPc, r0       \n\t"
+#else
+        "sts  pcProfilerPc+2, __zero_reg__ \n\t"
+        "ldd  r0, Z+3                \n\t"
+        "sts  pcProfilerPc+1, r0     \n\t"
+        "ldd  r0, Z+4                \n\t"
+        "sts  pcProfilerPc, r0       \n\t"
+#endif
+        "pop  r0                     \n\t"
+        "pop  r31                    \n\t"
+        "pop  r30                    \n\t"
+        "jmp  __vector_pc_profiler_bin \n\t");
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Set the range and the smallest bin width covering it; clears. */
+static void setRange(uint32_t lo, uint32_t hi) {
+    uint8_t shift = 1;  // Instructions are words: 2-byte bins at best
+    while (((hi - lo + ((uint32_t)1 << shift) - 1) >> shift) > PC_PROFILER_BINS) {
+        shift++;
+    }
+    s_base = lo;
+    s_end = hi;
+    s_shift = shift;
+    clearHistogram();
+}
+
+bool pcProfilerBegin() {
+#if PC_PROFILER_TIMER == 1
+    PRR0 &= (uint8_t)~_BV(PRTIM1);
+#else
+    PRR1 &= (uint8_t)~_BV(PP_REG(PRTIM, PC_PROFILER_TIMER, ));
+#endif
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        timerEnable(false);
+        PP_TCCRB = 0;
+        PP_TCCRA = 0;  // Outputs disconnected
+        PP_TCNT = 0;
+        PP_OCRA = (uint16_t)PP_TOP;
+        PP_TCCRB = _BV(PP_WGM2) | _BV(PP_CS1);
+        setRange(0, textEnd());
+        timerEnable(true);
+    }
+    return true;
+}
+
+void pcProfilerStart() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (s_saturated) {
+            clearHistogram();
+        }
+        timerEnable(true);
+    }
+}
+
+void pcProfilerStop() {
+    timerEnable(false);
+}
+
+bool pcProfilerRunning() {
+    return (PP_TIMSK & _BV(PP_OCIEA)) != 0;
+}
+
+void pcProfilerClear() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        bool wasRunning = pcProfilerRunning() || s_saturated;
+        clearHistogram();
+        timerEnable(wasRunning);
+    }
+}
+
+bool pcProfilerZoom(uint32_t lo, uint32_t hi) {
+    if (lo == 0 && hi == 0) {
+        hi = textEnd();
+    }
+    if (hi <= lo) {
+        FLASH_PRINTF("[ERROR] Profile range 0x%lX..0x%lX is empty\r\n", (unsigned long)lo,
+                     (unsigned long)hi);
+        return false;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        bool wasRunning = pcProfilerRunning() || s_saturated;
+        setRange(lo & ~(uint32_t)1, hi);
+        timerEnable(wasRunning);
+    }
+    return true;
+}
+
+uint32_t pcProfilerSamples() {
+    uint32_t n;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        n = s_samples;
+    }
+    return n;
+}
+
+void pcProfilerDump() {
+    bool wasRunning = pcProfilerRunning();
+    timerEnable(false);  // The histogram holds still while it is printed
+
+    FLASH_PRINTF("PROF,%u,%lu,%lX,%lX,%lu,%u,%lu,%u\r\n", (unsigned)PC_PROFILER_BINS,
+                 (unsigned long)((uint32_t)1 << s_shift), (unsigned long)s_base,
+                 (unsigned long)s_end, (unsigned long)s_samples, (unsigned)s_outside,
+                 (unsigned long)PC_PROFILER_HZ, (unsigned)s_saturated);
+    for (uint16_t i = 0; i < PC_PROFILER_BINS; i++) {
+        if (s_bins[i] != 0) {
+            FLASH_PRINTF("PB,%lX,%u\r\n", (unsigned long)(s_base + ((uint32_t)i << s_shift)),
+                         (unsigned)s_bins[i]);
+        }
+    }
+    FLASH_PRINTF("PROFEND\r\n");
+
+    if (wasRunning) {
+        timerEnable(true);
+    }
+}
+
+#else  // !PC_PROFILER_ENABLED
+
+bool pcProfilerBegin() { return false; }
+void pcProfilerStart() {}
+void pcProfilerStop() {}
+bool pcProfilerRunning() { return false; }
+void pcProfilerClear() {}
+bool pcProfilerZoom(uint32_t, uint32_t) { return false; }
+uint32_t pcProfilerSamples() { return 0; }
+
+void pcProfilerDump() {
+    FLASH_PRINTF("[PROF] Disabled (build with -DPC_PROFILER_ENABLED)\r\n");
+}
+
+#endif // PC_PROFILER_ENABLED
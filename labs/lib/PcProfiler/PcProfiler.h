@@ -0,0 +1,121 @@
+/**
+ * @file PcProfiler.h
+ * @brief Statistical PC-Sampling Profiler (timer ISR, flash-address histogram)
+ *
+ * TaskMonitor tells which task used the CPU; PerfCounter times the paths
+ * someone instrumented. Neither tells which function is hot inside a
+ * task — dtostrf(), log(), the Wire driver or the median sort. PcProfiler
+ * needs no source changes for that: a compare-match interrupt on a spare
+ * 16-bit timer fires PC_PROFILER_HZ times a second, reads the address it
+ * interrupted from the stack and counts it in a histogram of the program
+ * text:
+ *
+ *   bin = (pc − base) >> shift        PC_PROFILER_BINS × uint16_t in RAM
+ *
+ * The range starts as the whole program, [0, _etext), with the smallest
+ * power-of-two bin width that covers it (~128–256 bytes: a few functions
+ * per bin). pcProfilerZoom() narrows it to one hot function for bin
+ * widths down to one instruction. The histogram maps back to symbols on
+ * the PC with tools/pc_profile.py and the firmware ELF.
+ *
+ * The vector is naked: it copies the return address (3 bytes on the
+ * ATmega2560) with only r0/r30/r31 saved, then jumps to an ordinary
+ * signal handler that bins it, so the code the sample sees is the code
+ * that was running. ~7 µs per sample, ~1.5 % CPU at 2 kHz. What the
+ * profile cannot see: other ISRs and interrupts-masked sections (the
+ * sample is taken at the first instruction after them, so their cost
+ * lands after a sei or reti), and time asleep, which counts on the
+ * instruction after the idle sleep. A bin that reaches 65535 stops the
+ * sampling, so the shares stay exact (the dump flags it).
+ *
+ * The timer is taken over in CTC mode with its outputs disconnected: no
+ * PWM on its pins (they stay usable as GPIO), no other user of its
+ * vectors, and keep it out of idleSleepInit()'s gates.
+ *   -DPC_PROFILER_TIMER=<1|3|4|5>   (default 4, which lab5_2 leaves idle)
+ *
+ * Opt-in: only with -DPC_PROFILER_ENABLED is the vector compiled in; the
+ * functions then do nothing and pcProfilerDump() says how to enable it.
+ *
+ * Dump format (non-empty bins only, byte addresses in hex):
+ *
+ *   PROF,<bins>,<bin bytes>,<base>,<end>,<samples>,<outside>,<hz>,<saturated>
+ *   PB,<bin start>,<count>
+ *   PROFEND
+ *
+ * "outside" counts samples outside a zoomed range.
+ *
+ * Usage:
+ *   pcProfilerBegin();                  // setup(): starts sampling
+ *   pcProfilerDump();                   // command: PROF block for pc_profile.py
+ *   pcProfilerZoom(0x1A40, 0x1C00);     // command: one function, fine bins
+ *   pcProfilerClear();                  // command: new measurement window
+ *
+ *   host$ python3 tools/pc_profile.py .pio/build/lab5_2/firmware.elf dump.txt
+ */
+
+#ifndef PC_PROFILER_H
+#define PC_PROFILER_H
+
+#include <stdint.h>
+
+/** @brief 16-bit timer used for the samples (1, 3, 4 or 5). */
+#ifndef PC_PROFILER_TIMER
+#define PC_PROFILER_TIMER 4
+#endif
+
+/** @brief Sample rate; keep it off the multiples of the periodic tasks' rates. */
+#ifndef PC_PROFILER_HZ
+#define PC_PROFILER_HZ 2003UL
+#endif
+
+/** @brief Histogram bins (power of two, 2 bytes of RAM each). */
+#ifndef PC_PROFILER_BINS
+#define PC_PROFILER_BINS 256
+#endif
+
+#if PC_PROFILER_TIMER != 1 && PC_PROFILER_TIMER != 3 && PC_PROFILER_TIMER != 4 && \
+    PC_PROFILER_TIMER != 5
+#error "PC_PROFILER_TIMER must be 1, 3, 4 or 5"
+#endif
+
+/**
+ * @brief Program the timer, profile the whole program and start sampling.
+ * @return false without -DPC_PROFILER_ENABLED or off the AVR.
+ */
+bool pcProfilerBegin();
+
+/** @brief Resume sampling (a saturated histogram is cleared first). */
+void pcProfilerStart();
+
+/** @brief Stop sampling; the histogram is kept. */
+void pcProfilerStop();
+
+/** @brief Sampling is running. */
+bool pcProfilerRunning();
+
+/** @brief Zero the histogram and the counters; the range is kept. */
+void pcProfilerClear();
+
+/**
+ * @brief Profile only the byte addresses [lo, hi) and clear.
+ *
+ * The bin width becomes the smallest power of two that covers the range
+ * (2 bytes, one instruction word, at best). lo = hi = 0 restores the
+ * whole program.
+ *
+ * @return false if hi ≤ lo (the range is left as it was).
+ */
+bool pcProfilerZoom(uint32_t lo, uint32_t hi);
+
+/** @brief Samples taken since the last clear. */
+uint32_t pcProfilerSamples();
+
+/**
+ * @brief Print the histogram (format above); sampling pauses meanwhile.
+ *
+ * Prints directly with printf(), so call it from a task that is allowed
+ * to stall on the serial port.
+ */
+void pcProfilerDump();
+
+#endif // PC_PROFILER_H
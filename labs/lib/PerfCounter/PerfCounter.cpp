@@ -0,0 +1,174 @@
+/**
+ * @file PerfCounter.cpp
+ * @brief Named Counters and log2 Histograms Implementation
+ *
+ * Implements:
+ * - Histogram binning and recording (interrupts masked for the update)
+ * - Consistent reads: a histogram is copied bin by bin under one mask
+ *   (~40 bytes, a few µs), then summarised from the copy
+ * - The registry report and clear
+ */
+
+#include "PerfCounter.h"
+#include "FlashString.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Histograms
+// ──────────────────────────────────────────────────────────────────────────
+
+uint8_t perfHistogramBin(uint32_t value) {
+    uint8_t bin = 0;
+    while (value != 0 && bin < PERF_HISTOGRAM_BINS - 1) {
+        value >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+void perfRecord(PerfHistogram *h, uint32_t value) {
+    uint8_t bin = perfHistogramBin(value);
+    PERF_ATOMIC {
+        if (h->bins[bin] < 0xFFFF) {
+            h->bins[bin]++;
+        }
+        if (value > h->max) {
+            h->max = value;
+        }
+    }
+}
+
+/** @brief Smallest value counted in a bin. */
+static uint32_t binLower(uint8_t bin) {
+    return (bin == 0) ? 0 : (1UL << (bin - 1));
+}
+
+uint32_t perfHistogramTotal(const PerfHistogram *h) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BINS; i++) {
+        total += h->bins[i];
+    }
+    return total;
+}
+
+uint32_t perfHistogramPercentile(const PerfHistogram *h, uint8_t percent) {
+    uint32_t total = perfHistogramTotal(h);
+    if (total == 0) {
+        return 0;
+    }
+    // Rank of the percentile value, rounded up: p100 is the last value.
+    uint32_t rank = (total * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BINS - 1; i++) {
+        seen += h->bins[i];
+        if (seen >= rank) {
+            return 1UL << i;
+        }
+    }
+    return h->max;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Reading
+// ──────────────────────────────────────────────────────────────────────────
+
+uint16_t perfRead(const PerfCounter16 *c) {
+    uint16_t v;
+    PERF_ATOMIC {
+        v = c->value;
+    }
+    return v;
+}
+
+uint32_t perfRead(const PerfCounter32 *c) {
+    uint32_t v;
+    PERF_ATOMIC {
+        v = c->value;
+    }
+    return v;
+}
+
+void perfSnapshot(const PerfHistogram *h, PerfHistogram *out) {
+    PERF_ATOMIC {
+        for (uint8_t i = 0; i < PERF_HISTOGRAM_BINS; i++) {
+            out->bins[i] = h->bins[i];
+        }
+        out->max = h->max;
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Registry
+// ──────────────────────────────────────────────────────────────────────────
+
+void perfPrintHistogram(const PerfHistogram *h) {
+    PerfHistogram copy;
+    perfSnapshot(h, &copy);
+    FLASH_PRINTF("n=%lu p50<%lu p99<%lu max=%lu |", (unsigned long)perfHistogramTotal(&copy),
+                 (unsigned long)perfHistogramPercentile(&copy, 50),
+                 (unsigned long)perfHistogramPercentile(&copy, 99), (unsigned long)copy.max);
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BINS; i++) {
+        if (copy.bins[i] != 0) {
+            FLASH_PRINTF(" %lu:%u", (unsigned long)binLower(i), (unsigned)copy.bins[i]);
+        }
+    }
+}
+
+void perfReport(const PerfDesc *table, uint8_t count) {
+    PerfDesc desc;
+    for (uint8_t i = 0; i < count; i++) {
+        memcpy_P(&desc, &table[i], sizeof(PerfDesc));
+        FLASH_PRINTF("[PERF] %-10s ", desc.name);
+        switch (desc.type) {
+            case PERF_U16:
+                FLASH_PRINTF("%u", (unsigned)perfRead((const PerfCounter16 *)desc.object));
+                break;
+            case PERF_U32:
+                FLASH_PRINTF("%lu", (unsigned long)perfRead((const PerfCounter32 *)desc.object));
+                break;
+            case PERF_HIST:
+                perfPrintHistogram((const PerfHistogram *)desc.object);
+                break;
+            default:
+                FLASH_PRINTF("?");
+                break;
+        }
+        FLASH_PRINTF("\r\n");
+    }
+}
+
+void perfClear(const PerfDesc *table, uint8_t count) {
+    PerfDesc desc;
+    for (uint8_t i = 0; i < count; i++) {
+        memcpy_P(&desc, &table[i], sizeof(PerfDesc));
+        PERF_ATOMIC {
+            switch (desc.type) {
+                case PERF_U16:
+                    ((PerfCounter16 *)desc.object)->value = 0;
+                    break;
+                case PERF_U32:
+                    ((PerfCounter32 *)desc.object)->value = 0;
+                    break;
+                case PERF_HIST: {
+                    PerfHistogram *h = (PerfHistogram *)desc.object;
+                    for (uint8_t b = 0; b < PERF_HISTOGRAM_BINS; b++) {
+                        h->bins[b] = 0;
+                    }
+                    h->max = 0;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+}
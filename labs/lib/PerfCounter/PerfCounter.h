@@ -0,0 +1,189 @@
+/**
+ * @file PerfCounter.h
+ * @brief Named Event Counters and log2 Latency Histograms (ISR / task safe)
+ *
+ * The labs count their work ad hoc: sampleCount, controlCycles and the
+ * like are fields of mutex-protected shared-state structs, bumped under
+ * the state lock, and there is no common way to time a hot path. This
+ * library gives every lab the same three instruments:
+ *
+ *   PerfCounter16 / PerfCounter32   event counters (wrap around)
+ *   PerfHistogram                   log2 histogram of a duration or value
+ *
+ * A bump masks interrupts for the few cycles of the read-modify-write
+ * (the AVR has no atomic 16/32-bit increment), so instruments can be
+ * bumped from ISRs and from any task without a mutex, and never block.
+ *
+ * Histogram bin 0 counts the value 0; bin k (k >= 1) counts values in
+ * [2^(k-1), 2^k), and the last bin everything from 2^(PERF_HISTOGRAM_BINS-2)
+ * up. With the default 16 bins and micros() durations that is 1 µs
+ * resolution at the bottom and ">= 16.4 ms" at the top. Bins saturate at
+ * 65535; the largest value seen is kept as well.
+ *
+ * Registration is static: the lab lists its instruments in one PROGMEM
+ * table of {name, type, object}, and perfReport() / perfClear() cover
+ * all of them, so a single "perf" command exports every instrument.
+ *
+ * Usage:
+ *   static PerfCounter32 s_cycles;
+ *   static PerfHistogram s_stepUs;
+ *   static const PerfDesc PERF[] PROGMEM = {
+ *       PERF_COUNTER32("cycles", s_cycles),
+ *       PERF_HISTOGRAM("step_us", s_stepUs),
+ *   };
+ *
+ *   perfCount(&s_cycles);                          // task or ISR
+ *   uint32_t t0 = micros();
+ *   ...
+ *   perfRecord(&s_stepUs, micros() - t0);
+ *
+ *   perfReport(PERF, 2);                           // serial command handler
+ */
+
+#ifndef PERF_COUNTER_H
+#define PERF_COUNTER_H
+
+#include <stdint.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#define PERF_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#define PERF_ATOMIC
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#endif
+
+/** @brief Histogram bins (2..32); the last one is open-ended. */
+#ifndef PERF_HISTOGRAM_BINS
+#define PERF_HISTOGRAM_BINS 16
+#endif
+
+/** @brief Longest instrument name, including the terminator. */
+#define PERF_NAME_MAX 10
+
+static_assert(PERF_HISTOGRAM_BINS >= 2 && PERF_HISTOGRAM_BINS <= 32,
+              "PERF_HISTOGRAM_BINS must be in 2..32");
+
+/** @brief 16-bit event counter. */
+struct PerfCounter16 {
+    volatile uint16_t value;
+};
+
+/** @brief 32-bit event counter. */
+struct PerfCounter32 {
+    volatile uint32_t value;
+};
+
+/** @brief log2 histogram of recorded values. */
+struct PerfHistogram {
+    volatile uint16_t bins[PERF_HISTOGRAM_BINS];  ///< Counts per bin (saturating).
+    volatile uint32_t max;                        ///< Largest value recorded.
+};
+
+/**
+ * @enum PerfType
+ * @brief Kind of a registered instrument.
+ */
+enum PerfType {
+    PERF_U16,   ///< PerfCounter16
+    PERF_U32,   ///< PerfCounter32
+    PERF_HIST   ///< PerfHistogram
+};
+
+/**
+ * @struct PerfDesc
+ * @brief One registry row (PROGMEM). Build with the PERF_* macros.
+ */
+struct PerfDesc {
+    char  name[PERF_NAME_MAX];  ///< Name printed by perfReport().
+    uint8_t type;               ///< PerfType.
+    void *object;               ///< The instrument.
+};
+
+/** @brief Registry rows for each instrument type. */
+#define PERF_COUNTER16(name, counter) { name, PERF_U16, &(counter) }
+#define PERF_COUNTER32(name, counter) { name, PERF_U32, &(counter) }
+#define PERF_HISTOGRAM(name, hist)    { name, PERF_HIST, &(hist) }
+
+// ──────────────────────────────────────────────────────────────────────────
+// Bumping (tasks and ISRs)
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Add one. */
+static inline void perfCount(PerfCounter16 *c) {
+    PERF_ATOMIC {
+        c->value++;
+    }
+}
+
+/** @brief Add one. */
+static inline void perfCount(PerfCounter32 *c) {
+    PERF_ATOMIC {
+        c->value++;
+    }
+}
+
+/** @brief Add n. */
+static inline void perfAdd(PerfCounter32 *c, uint32_t n) {
+    PERF_ATOMIC {
+        c->value += n;
+    }
+}
+
+/** @brief Histogram bin of a value. */
+uint8_t perfHistogramBin(uint32_t value);
+
+/** @brief Count value in its bin and track the maximum. */
+void perfRecord(PerfHistogram *h, uint32_t value);
+
+// ──────────────────────────────────────────────────────────────────────────
+// Reading and export
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Consistent read of a counter. */
+uint16_t perfRead(const PerfCounter16 *c);
+uint32_t perfRead(const PerfCounter32 *c);
+
+/** @brief Consistent copy of a histogram. */
+void perfSnapshot(const PerfHistogram *h, PerfHistogram *out);
+
+/** @brief Values recorded in a histogram copy (sum of the bins). */
+uint32_t perfHistogramTotal(const PerfHistogram *h);
+
+/**
+ * @brief Upper bound of the bin holding the given percentile.
+ *
+ * @param h       Histogram copy.
+ * @param percent 1..100.
+ * @return Exclusive upper bound 2^k of that bin (the maximum for the last
+ *         bin), or 0 if the histogram is empty.
+ */
+uint32_t perfHistogramPercentile(const PerfHistogram *h, uint8_t percent);
+
+/**
+ * @brief Print one histogram's summary and bins, without a line end:
+ *
+ *   n=1203 p50<64 p99<256 max=180 | 32:410 64:790 128:3
+ */
+void perfPrintHistogram(const PerfHistogram *h);
+
+/**
+ * @brief Print every registered instrument with printf().
+ *
+ *   [PERF] cycles     12034
+ *   [PERF] step_us    n=1203 p50<64 p99<256 max=180 | 32:410 64:790 128:3
+ *
+ * Histogram bins are printed as <lower bound>:<count>, empty ones skipped.
+ *
+ * @param table PROGMEM registry.
+ * @param count Registry rows.
+ */
+void perfReport(const PerfDesc *table, uint8_t count);
+
+/** @brief Zero every registered instrument. */
+void perfClear(const PerfDesc *table, uint8_t count);
+
+#endif // PERF_COUNTER_H
@@ -0,0 +1,207 @@
+/**
+ * @file FixedPidController.cpp
+ * @brief Integer-only PID controller implementation.
+ *
+ * update() compiles to a handful of 16×16 multiplies (__umulhisi3 on AVR,
+ * ~20 cycles each) plus 32-bit adds and compares.
+ */
+
+#include "FixedPidController.h"
+
+static const int32_t Q_ONE = (int32_t)1 << FIXED_PID_FRAC_BITS;
+
+/** Largest coefficient representable in Q16.16. */
+static const float Q_MAX = 32767.0f;
+
+static int32_t toQ(float value) {
+    if (value < 0.0f) {
+        value = 0.0f;
+    } else if (value > Q_MAX) {
+        value = Q_MAX;
+    }
+    return (int32_t)(value * (float)Q_ONE + 0.5f);
+}
+
+static int16_t saturate16(int32_t value) {
+    if (value > INT16_MAX) return INT16_MAX;
+    if (value < INT16_MIN) return INT16_MIN;
+    return (int16_t)value;
+}
+
+static int32_t addSat(int32_t a, int32_t b) {
+    int32_t sum = (int32_t)((uint32_t)a + (uint32_t)b);
+    if (a >= 0 && b >= 0 && sum < 0) return INT32_MAX;
+    if (a < 0 && b < 0 && sum >= 0) return INT32_MIN;
+    return sum;
+}
+
+/** @brief coeff (≥ 0, Q16.16) × e, saturated to int32, from 16×16 pieces. */
+static int32_t mulSat(int32_t coeff, int16_t e) {
+    bool negative = e < 0;
+    uint16_t ue = negative ? (uint16_t)(-(int32_t)e) : (uint16_t)e;
+    uint16_t hi = (uint16_t)((uint32_t)coeff >> 16);
+    uint16_t lo = (uint16_t)coeff;
+
+    uint32_t high = (uint32_t)hi * ue;           // Contributes high << 16
+    if (high >= 0x8000UL) {
+        return negative ? INT32_MIN : INT32_MAX;
+    }
+    uint32_t low = (uint32_t)lo * ue;
+    uint32_t magnitude = (high << 16) + low;
+    if (magnitude < low || magnitude > (uint32_t)INT32_MAX) {
+        return negative ? INT32_MIN : INT32_MAX;
+    }
+    return negative ? -(int32_t)magnitude : (int32_t)magnitude;
+}
+
+FixedPidController::FixedPidController(float kp, float ki, float kd,
+                                       float sampleTimeSeconds,
+                                       int16_t outputMin, int16_t outputMax,
+                                       PidDirection direction)
+    : _kp(0.0f),
+      _ki(0.0f),
+      _kd(0.0f),
+      _sampleTime(0.001f),
+      _outputMin(outputMin),
+      _outputMax(outputMax),
+      _direction(direction),
+      _kpQ(0),
+      _kiDtQ(0),
+      _kdDtQ(0),
+      _hasPreviousError(false),
+      _previousError(0),
+      _integral(0),
+      _lastOutput(0) {
+    if (_outputMax < _outputMin) {
+        int16_t tmp = _outputMax;
+        _outputMax = _outputMin;
+        _outputMin = tmp;
+    }
+    if (sampleTimeSeconds > 0.0f) {
+        _sampleTime = sampleTimeSeconds;
+    }
+    setTunings(kp, ki, kd);
+}
+
+void FixedPidController::init() {
+    reset();
+}
+
+void FixedPidController::setTunings(float kp, float ki, float kd) {
+    if (kp < 0.0f) kp = 0.0f;
+    if (ki < 0.0f) ki = 0.0f;
+    if (kd < 0.0f) kd = 0.0f;
+    _kp = kp;
+    _ki = ki;
+    _kd = kd;
+    updateCoefficients();
+}
+
+void FixedPidController::setSampleTime(float sampleTimeSeconds) {
+    if (sampleTimeSeconds <= 0.0f) {
+        return;
+    }
+    _sampleTime = sampleTimeSeconds;
+    updateCoefficients();
+}
+
+void FixedPidController::updateCoefficients() {
+    _kpQ = toQ(_kp);
+    _kiDtQ = toQ(_ki * _sampleTime);
+    _kdDtQ = toQ(_kd / _sampleTime);
+}
+
+void FixedPidController::setOutputLimits(int16_t outputMin, int16_t outputMax) {
+    if (outputMax < outputMin) {
+        int16_t tmp = outputMax;
+        outputMax = outputMin;
+        outputMin = tmp;
+    }
+
+    _outputMin = outputMin;
+    _outputMax = outputMax;
+    int32_t lo = (int32_t)_outputMin * Q_ONE;
+    int32_t hi = (int32_t)_outputMax * Q_ONE;
+    if (_integral < lo) _integral = lo;
+    if (_integral > hi) _integral = hi;
+    if (_lastOutput < _outputMin) _lastOutput = _outputMin;
+    if (_lastOutput > _outputMax) _lastOutput = _outputMax;
+}
+
+void FixedPidController::setDirection(PidDirection direction) {
+    _direction = direction;
+}
+
+void FixedPidController::reset() {
+    _hasPreviousError = false;
+    _previousError = 0;
+    _integral = 0;
+    _lastOutput = 0;
+}
+
+int16_t FixedPidController::update(int16_t setpoint, int16_t measuredValue) {
+    int16_t error = (_direction == PID_REVERSE)
+        ? saturate16((int32_t)measuredValue - setpoint)
+        : saturate16((int32_t)setpoint - measuredValue);
+
+    int32_t lo = (int32_t)_outputMin * Q_ONE;
+    int32_t hi = (int32_t)_outputMax * Q_ONE;
+    _integral = addSat(_integral, mulSat(_kiDtQ, error));
+    if (_integral < lo) _integral = lo;
+    if (_integral > hi) _integral = hi;
+
+    int32_t sum = addSat(mulSat(_kpQ, error), _integral);
+    if (_hasPreviousError) {
+        int16_t delta = saturate16((int32_t)error - _previousError);
+        sum = addSat(sum, mulSat(_kdDtQ, delta));
+    }
+    _hasPreviousError = true;
+    _previousError = error;
+
+    // Round to nearest, then clamp (sum >> 16 always fits int16).
+    int32_t output = addSat(sum, Q_ONE / 2) >> FIXED_PID_FRAC_BITS;
+    if (output < _outputMin) output = _outputMin;
+    if (output > _outputMax) output = _outputMax;
+    _lastOutput = (int16_t)output;
+    return _lastOutput;
+}
+
+float FixedPidController::getKp() const {
+    return _kp;
+}
+
+float FixedPidController::getKi() const {
+    return _ki;
+}
+
+float FixedPidController::getKd() const {
+    return _kd;
+}
+
+float FixedPidController::getSampleTime() const {
+    return _sampleTime;
+}
+
+int16_t FixedPidController::getError() const {
+    return _previousError;
+}
+
+float FixedPidController::getIntegral() const {
+    return (float)_integral / (float)Q_ONE;
+}
+
+int16_t FixedPidController::getOutput() const {
+    return _lastOutput;
+}
+
+int32_t FixedPidController::getKpRaw() const {
+    return _kpQ;
+}
+
+int32_t FixedPidController::getKiDtRaw() const {
+    return _kiDtQ;
+}
+
+int32_t FixedPidController::getKdDtRaw() const {
+    return _kdDtQ;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file FixedPidController.h
+ * @brief Integer-only PID controller for fast fixed-rate loops.
+ *
+ * PidController::update() costs several float multiplies, a division by
+ * dt and three clamps (~1 ms of AVR time at worst), fine at 0.5 Hz but
+ * not for a 1 kHz motor speed or current loop. FixedPidController fixes
+ * the sample time and folds it into the gains when they are set:
+ *
+ *   P = Kp · e      I += Ki·dt · e      D = Kd/dt · (e − e₋₁)
+ *
+ * Coefficients are Q16.16 (FIXED_PID_FRAC_BITS), inputs and output are
+ * int16 in the caller's units (ADC counts, RPM, PWM compare steps…).
+ * Multiplies are 16×16 → 32-bit pieces, every sum saturates at the int32
+ * range instead of wrapping, and the integral is clamped to the output
+ * limits (anti-windup, as in PidController). No division, no float.
+ *
+ * Resolution: one unit of Ki·dt is 1/65536 output unit per input unit
+ * per sample. Pick the input/output scaling so Ki·dt is at least ~0.001
+ * (getKiDtRaw() ≥ 65) or the integral rounds coarsely.
+ *
+ * Same tuning/reset API as PidController; setTunings() and
+ * setSampleTime() do float math and belong outside the fast loop.
+ *
+ * Usage:
+ *   FixedPidController speedPid(0.8f, 4.0f, 0.0f, 0.001f, 0, 320);
+ *   speedPid.init();
+ *   // 1 kHz:
+ *   int16_t compare = speedPid.update(targetRpm, measuredRpm);
+ */
+
+#ifndef FIXED_PID_CONTROLLER_H
+#define FIXED_PID_CONTROLLER_H
+
+#include <stdint.h>
+#include "PidController.h"
+
+/** Fractional bits of the coefficients and the integral. */
+#define FIXED_PID_FRAC_BITS 16
+
+class FixedPidController {
+public:
+    FixedPidController(float kp, float ki, float kd, float sampleTimeSeconds,
+                       int16_t outputMin, int16_t outputMax,
+                       PidDirection direction = PID_DIRECT);
+
+    void init();
+    void setTunings(float kp, float ki, float kd);
+    void setSampleTime(float sampleTimeSeconds);
+    void setOutputLimits(int16_t outputMin, int16_t outputMax);
+    void setDirection(PidDirection direction);
+    void reset();
+
+    /** @brief One control step; call exactly once per sample time. */
+    int16_t update(int16_t setpoint, int16_t measuredValue);
+
+    float getKp() const;
+    float getKi() const;
+    float getKd() const;
+    float getSampleTime() const;
+    int16_t getError() const;
+    /** @brief Integral term in output units. */
+    float getIntegral() const;
+    int16_t getOutput() const;
+
+    /** @name Precomputed Q16.16 coefficients */
+    ///@{
+    int32_t getKpRaw() const;
+    int32_t getKiDtRaw() const;
+    int32_t getKdDtRaw() const;
+    ///@}
+
+private:
+    /** @brief Recompute the Q16.16 coefficients from the float tunings. */
+    void updateCoefficients();
+
+    float _kp;
+    float _ki;
+    float _kd;
+    float _sampleTime;
+    int16_t _outputMin;
+    int16_t _outputMax;
+    PidDirection _direction;
+
+    int32_t _kpQ;        ///< Kp
+    int32_t _kiDtQ;      ///< Ki·dt
+    int32_t _kdDtQ;      ///< Kd/dt
+
+    bool _hasPreviousError;
+    int16_t _previousError;
+    int32_t _integral;   ///< Q16.16 output units
+    int16_t _lastOutput;
+};
+
+#endif // FIXED_PID_CONTROLLER_H
@@ -0,0 +1,224 @@
+/**
+ * @file PidAutotuner.cpp
+ * @brief Relay-feedback PID autotuner implementation.
+ */
+
+#include "PidAutotuner.h"
+#include "TelemetryFrame.h"
+#include <math.h>
+#include <stddef.h>
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Persistence
+// ──────────────────────────────────────────────────────────────────────────
+
+static uint16_t recordCrc(const PidTuningRecord &r) {
+    return crc16Ccitt(0xFFFF, (const uint8_t *)&r, (uint8_t)offsetof(PidTuningRecord, crc));
+}
+
+bool pidTuningSave(uint16_t address, PidTuningRecord record) {
+    record.magic = PID_TUNING_MAGIC;
+    record.crc = recordCrc(record);
+#if defined(__AVR__)
+    eeprom_update_block(&record, (void *)(uintptr_t)address, sizeof(record));
+    return true;
+#else
+    (void)address;
+    return false;
+#endif
+}
+
+bool pidTuningLoad(uint16_t address, PidTuningRecord *record) {
+#if defined(__AVR__)
+    PidTuningRecord r;
+    eeprom_read_block(&r, (const void *)(uintptr_t)address, sizeof(r));
+    if (r.magic != PID_TUNING_MAGIC || r.crc != recordCrc(r) ||
+        !(r.kp >= 0.0f) || !(r.ki >= 0.0f) || !(r.kd >= 0.0f)) {
+        return false;  // Erased, corrupt or NaN gains
+    }
+    *record = r;
+    return true;
+#else
+    (void)address;
+    (void)record;
+    return false;
+#endif
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Relay experiment
+// ──────────────────────────────────────────────────────────────────────────
+
+PidAutotuner::PidAutotuner()
+    : _running(false),
+      _ok(false),
+      _setpoint(0.0f),
+      _low(0.0f),
+      _high(0.0f),
+      _hysteresis(0.0f),
+      _direction(PID_DIRECT),
+      _startMs(0),
+      _timeoutMs(0),
+      _outputHighNow(false),
+      _seenSwitch(false),
+      _cycleStartMs(0),
+      _peakMax(0.0f),
+      _peakMin(0.0f),
+      _cycles(0),
+      _ku(0.0f),
+      _pu(0.0f) {
+    _periods[0] = _periods[1] = 0.0f;
+    _amplitudes[0] = _amplitudes[1] = 0.0f;
+}
+
+void PidAutotuner::begin(float setpoint, float outputLow, float outputHigh,
+                         float hysteresis, PidDirection direction,
+                         uint32_t nowMs, uint32_t timeoutMs) {
+    _setpoint = setpoint;
+    _low = outputLow;
+    _high = outputHigh;
+    _hysteresis = (hysteresis > 0.0f) ? hysteresis : 0.0f;
+    _direction = direction;
+    _startMs = nowMs;
+    _timeoutMs = timeoutMs;
+    _outputHighNow = true;    // Start by pushing; the first switch sets the phase
+    _seenSwitch = false;
+    _cycleStartMs = nowMs;
+    _peakMax = -INFINITY;
+    _peakMin = INFINITY;
+    _cycles = 0;
+    _periods[0] = _periods[1] = 0.0f;
+    _amplitudes[0] = _amplitudes[1] = 0.0f;
+    _ku = 0.0f;
+    _pu = 0.0f;
+    _ok = false;
+    _running = true;
+}
+
+void PidAutotuner::cancel() {
+    _running = false;
+    _ok = false;
+}
+
+float PidAutotuner::update(float measurement, uint32_t nowMs) {
+    if (!_running) {
+        return _low;
+    }
+    if (_timeoutMs != 0 && (uint32_t)(nowMs - _startMs) >= _timeoutMs) {
+        cancel();
+        return _low;
+    }
+    if (isnan(measurement)) {
+        return _outputHighNow ? _high : _low;
+    }
+
+    if (measurement > _peakMax) _peakMax = measurement;
+    if (measurement < _peakMin) _peakMin = measurement;
+
+    // Deviation in the direction outputHigh pushes the measurement.
+    float deviation = (_direction == PID_REVERSE)
+        ? _setpoint - measurement
+        : measurement - _setpoint;
+
+    if (_outputHighNow && deviation > _hysteresis) {
+        _outputHighNow = false;               // Overshot: release
+    } else if (!_outputHighNow && deviation < -_hysteresis) {
+        _outputHighNow = true;                // A full cycle ends here
+        completeCycle(nowMs);
+    }
+    return _running && _outputHighNow ? _high : _low;
+}
+
+void PidAutotuner::completeCycle(uint32_t nowMs) {
+    if (!_seenSwitch) {
+        _seenSwitch = true;                   // First boundary: start timing
+    } else {
+        _periods[0] = _periods[1];
+        _amplitudes[0] = _amplitudes[1];
+        _periods[1] = (float)(uint32_t)(nowMs - _cycleStartMs) / 1000.0f;
+        _amplitudes[1] = (_peakMax - _peakMin) * 0.5f;
+        _cycles++;
+    }
+    _cycleStartMs = nowMs;
+    _peakMax = -INFINITY;
+    _peakMin = INFINITY;
+
+    if (_cycles >= PID_AUTOTUNE_MIN_CYCLES) {
+        float pu = 0.5f * (_periods[0] + _periods[1]);
+        float a = 0.5f * (_amplitudes[0] + _amplitudes[1]);
+        bool consistent =
+            fabsf(_periods[1] - _periods[0]) <= PID_AUTOTUNE_TOLERANCE * pu &&
+            fabsf(_amplitudes[1] - _amplitudes[0]) <= PID_AUTOTUNE_TOLERANCE * a;
+        if (consistent && a > _hysteresis) {
+            float d = 0.5f * fabsf(_high - _low);
+            _ku = 4.0f * d / ((float)M_PI * sqrtf(a * a - _hysteresis * _hysteresis));
+            _pu = pu;
+            _ok = true;
+            _running = false;
+            return;
+        }
+    }
+    if (_cycles >= PID_AUTOTUNE_MAX_CYCLES) {
+        cancel();                             // Never settled
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Results
+// ──────────────────────────────────────────────────────────────────────────
+
+bool PidAutotuner::isRunning() const {
+    return _running;
+}
+
+bool PidAutotuner::succeeded() const {
+    return _ok;
+}
+
+uint8_t PidAutotuner::getCycles() const {
+    return _cycles;
+}
+
+float PidAutotuner::getUltimateGain() const {
+    return _ku;
+}
+
+float PidAutotuner::getUltimatePeriodS() const {
+    return _pu;
+}
+
+void PidAutotuner::computeTunings(PidTuningRule rule, float *kp, float *ki, float *kd) const {
+    float p = 0.0f;
+    float ti = 0.0f;
+    float td = 0.0f;
+    if (_ok) {
+        if (rule == PID_TUNE_TYREUS_LUYBEN) {
+            p = _ku / 2.2f;
+            ti = 2.2f * _pu;
+            td = _pu / 6.3f;
+        } else {
+            p = 0.6f * _ku;
+            ti = 0.5f * _pu;
+            td = 0.125f * _pu;
+        }
+    }
+    *kp = p;
+    *ki = (ti > 0.0f) ? p / ti : 0.0f;
+    *kd = p * td;
+}
+
+bool PidAutotuner::applyTo(PidController &pid, PidTuningRule rule) const {
+    if (!_ok) {
+        return false;
+    }
+    float kp;
+    float ki;
+    float kd;
+    computeTunings(rule, &kp, &ki, &kd);
+    pid.setTunings(kp, ki, kd);
+    return true;
+}
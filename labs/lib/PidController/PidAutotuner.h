@@ -0,0 +1,139 @@
+/**
+ * @file PidAutotuner.h
+ * @brief Relay-feedback (Åström–Hägglund) PID autotuner.
+ *
+ * Replaces the controller with a relay around the setpoint: the output
+ * switches between outputLow and outputHigh whenever the measurement
+ * leaves the ±hysteresis band, which drives the loop into a limit cycle
+ * at its ultimate (phase −180°) frequency:
+ *
+ *        PV  ╭╮    ╭╮    ╭╮         d  = (high − low) / 2
+ *   sp+ε ───┼┼────┼┼────┼┼───      a  = (PVmax − PVmin) / 2
+ *   sp−ε ──╯  ╰──╯  ╰──╯  ╰──      Ku = 4d / (π·√(a² − ε²))
+ *        out ▔▔▁▁▁▔▔▁▁▁▔▔▁▁         Pu = time between alike switches
+ *
+ * After at least PID_AUTOTUNE_MIN_CYCLES cycles whose last two periods
+ * and amplitudes agree within PID_AUTOTUNE_TOLERANCE, Ku and Pu are the
+ * mean of those two. computeTunings() maps them to gains:
+ *
+ *   Ziegler–Nichols:  Kp = 0.6 Ku,   Ti = Pu / 2,   Td = Pu / 8
+ *   Tyreus–Luyben:    Kp = Ku / 2.2, Ti = 2.2 Pu,   Td = Pu / 6.3
+ *
+ * (Tyreus–Luyben: less overshoot, the usual choice for thermal plants.)
+ * The tuner is non-blocking: feed it every sample and apply its output.
+ * PidTuningRecord stores a result in EEPROM (magic + CRC-16).
+ *
+ * Usage:
+ *   PidAutotuner tuner;
+ *   tuner.begin(25.0f, 20.0f, 80.0f, 0.3f, PID_REVERSE, millis());
+ *   // each sample:
+ *   float out = tuner.update(temperature, millis());
+ *   if (tuner.succeeded()) tuner.applyTo(pid, PID_TUNE_TYREUS_LUYBEN);
+ */
+
+#ifndef PID_AUTOTUNER_H
+#define PID_AUTOTUNER_H
+
+#include <Arduino.h>
+#include "PidController.h"
+
+/** Cycles before the result may be accepted (the first is a transient). */
+#define PID_AUTOTUNE_MIN_CYCLES 3
+
+/** Give up after this many cycles without two consistent ones. */
+#define PID_AUTOTUNE_MAX_CYCLES 10
+
+/** Relative agreement of the last two periods and amplitudes. */
+#define PID_AUTOTUNE_TOLERANCE 0.2f
+
+/** Tag of a stored PidTuningRecord. */
+#define PID_TUNING_MAGIC 0xA7C1
+
+enum PidTuningRule {
+    PID_TUNE_ZIEGLER_NICHOLS = 0,
+    PID_TUNE_TYREUS_LUYBEN = 1
+};
+
+/** @brief Autotune result as stored in EEPROM. */
+struct PidTuningRecord {
+    uint16_t magic;     ///< PID_TUNING_MAGIC
+    float kp;
+    float ki;
+    float kd;
+    float ultimateGain;
+    float ultimatePeriodS;
+    uint16_t crc;       ///< CRC-16/CCITT of the fields above
+};
+
+/** @brief Write a record (magic and CRC filled in). @return false off-target. */
+bool pidTuningSave(uint16_t address, PidTuningRecord record);
+
+/** @brief Read and check a record. @return false if missing or corrupt. */
+bool pidTuningLoad(uint16_t address, PidTuningRecord *record);
+
+class PidAutotuner {
+public:
+    PidAutotuner();
+
+    /**
+     * @brief Start the relay experiment.
+     * @param setpoint   Centre of the oscillation.
+     * @param outputLow  Relay output below/above the band (see direction).
+     * @param outputHigh Relay output that pushes the process the other way.
+     * @param hysteresis Half-width ε of the switching band (≥ sensor noise).
+     * @param direction  PID_DIRECT: outputHigh raises the measurement.
+     * @param nowMs      Current millis().
+     * @param timeoutMs  Abort after this long (0 = no limit).
+     */
+    void begin(float setpoint, float outputLow, float outputHigh, float hysteresis,
+               PidDirection direction, uint32_t nowMs, uint32_t timeoutMs = 0);
+
+    /** @brief Abort; succeeded() stays false. */
+    void cancel();
+
+    /** @brief Feed one measurement. @return Relay output to apply. */
+    float update(float measurement, uint32_t nowMs);
+
+    bool isRunning() const;
+    bool succeeded() const;
+
+    /** @brief Completed oscillation cycles so far. */
+    uint8_t getCycles() const;
+
+    float getUltimateGain() const;
+    float getUltimatePeriodS() const;
+
+    /** @brief Gains for @p rule from Ku and Pu (all 0 unless succeeded()). */
+    void computeTunings(PidTuningRule rule, float *kp, float *ki, float *kd) const;
+
+    /** @brief computeTunings() then pid.setTunings(). @return succeeded(). */
+    bool applyTo(PidController &pid, PidTuningRule rule) const;
+
+private:
+    /** @brief Close a cycle at a rising switch and test convergence. */
+    void completeCycle(uint32_t nowMs);
+
+    bool _running;
+    bool _ok;
+    float _setpoint;
+    float _low;
+    float _high;
+    float _hysteresis;
+    PidDirection _direction;
+    uint32_t _startMs;
+    uint32_t _timeoutMs;
+
+    bool _outputHighNow;         ///< Relay state
+    bool _seenSwitch;            ///< A cycle boundary was recorded
+    uint32_t _cycleStartMs;      ///< Time of the last low → high switch
+    float _peakMax;              ///< PV extremes in the current cycle
+    float _peakMin;
+    uint8_t _cycles;
+    float _periods[2];           ///< Last two cycle periods (s)
+    float _amplitudes[2];        ///< Last two half peak-to-peak values
+
+    float _ku;
+    float _pu;
+};
+
+#endif // PID_AUTOTUNER_H
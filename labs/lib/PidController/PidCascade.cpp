@@ -0,0 +1,140 @@
+/**
+ * @file PidCascade.cpp
+ * @brief Cascade PID implementation.
+ */
+
+#include "PidCascade.h"
+
+PidCascade::PidCascade(float innerSetpointMin, float innerSetpointMax,
+                       PidDirection outerDirection,
+                       float innerOutputMin, float innerOutputMax,
+                       PidDirection innerDirection)
+    : _outer(0.0f, 0.0f, 0.0f, innerSetpointMin, innerSetpointMax, outerDirection),
+      _inner(0.0f, 0.0f, 0.0f, innerOutputMin, innerOutputMax, innerDirection),
+      _setpointMin(innerSetpointMin),
+      _setpointMax(innerSetpointMax),
+      _innerSetpoint(innerSetpointMin),
+      _innerSaturation(0),
+      _outerLimited(false),
+      _decimation(1),
+      _decimationCount(0) {
+    if (_setpointMax < _setpointMin) {
+        float tmp = _setpointMax;
+        _setpointMax = _setpointMin;
+        _setpointMin = tmp;
+        _innerSetpoint = _setpointMin;
+    }
+}
+
+void PidCascade::init() {
+    _outer.init();
+    _inner.init();
+    reset();
+}
+
+void PidCascade::reset() {
+    _outer.reset();
+    _outer.setOutputLimits(_setpointMin, _setpointMax);
+    _outerLimited = false;
+    _innerSetpoint = _setpointMin;
+    _decimationCount = 0;
+    resetInner();
+}
+
+void PidCascade::resetInner() {
+    _inner.reset();
+    _innerSaturation = 0;
+}
+
+PidController &PidCascade::outer() {
+    return _outer;
+}
+
+PidController &PidCascade::inner() {
+    return _inner;
+}
+
+const PidController &PidCascade::outer() const {
+    return _outer;
+}
+
+const PidController &PidCascade::inner() const {
+    return _inner;
+}
+
+void PidCascade::propagateSaturation() {
+    float lo = _setpointMin;
+    float hi = _setpointMax;
+    if (_innerSaturation != 0) {
+        // A DIRECT inner loop pinned at its max cannot follow a higher
+        // setpoint; a REVERSE one pinned at its max cannot follow a lower one.
+        bool pinnedHigh = _innerSaturation > 0;
+        bool cannotRise = (_inner.getDirection() == PID_DIRECT) ? pinnedHigh : !pinnedHigh;
+        if (cannotRise) {
+            hi = _innerSetpoint;
+        } else {
+            lo = _innerSetpoint;
+        }
+    }
+    _outerLimited = (lo != _setpointMin) || (hi != _setpointMax);
+    _outer.setOutputLimits(lo, hi);
+}
+
+float PidCascade::updateOuter(float setpoint, float measuredValue, float dtSeconds) {
+    propagateSaturation();
+    _innerSetpoint = _outer.update(setpoint, measuredValue, dtSeconds);
+    return _innerSetpoint;
+}
+
+float PidCascade::updateInner(float measuredValue, float dtSeconds) {
+    float output = _inner.update(_innerSetpoint, measuredValue, dtSeconds);
+    if (output >= _inner.getOutputMax()) {
+        _innerSaturation = 1;
+    } else if (output <= _inner.getOutputMin()) {
+        _innerSaturation = -1;
+    } else {
+        _innerSaturation = 0;
+    }
+    return output;
+}
+
+void PidCascade::setInnerSetpoint(float innerSetpoint) {
+    if (innerSetpoint < _setpointMin) {
+        innerSetpoint = _setpointMin;
+    } else if (innerSetpoint > _setpointMax) {
+        innerSetpoint = _setpointMax;
+    }
+    _innerSetpoint = innerSetpoint;
+}
+
+void PidCascade::setOuterDecimation(uint8_t ratio) {
+    _decimation = (ratio > 0) ? ratio : 1;
+    _decimationCount = 0;
+}
+
+float PidCascade::update(float setpoint, float outerMeasured, float innerMeasured,
+                         float innerDtSeconds) {
+    if (_decimationCount == 0) {
+        updateOuter(setpoint, outerMeasured, innerDtSeconds * (float)_decimation);
+    }
+    if (++_decimationCount >= _decimation) {
+        _decimationCount = 0;
+    }
+    return updateInner(innerMeasured, innerDtSeconds);
+}
+
+float PidCascade::getInnerSetpoint() const {
+    return _innerSetpoint;
+}
+
+float PidCascade::getOutput() const {
+    return _inner.getOutput();
+}
+
+int8_t PidCascade::getInnerSaturation() const {
+    return _innerSaturation;
+}
+
+bool PidCascade::isOuterLimited() const {
+    return _outerLimited;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file PidCascade.h
+ * @brief Two PidControllers in cascade (outer loop → inner setpoint).
+ *
+ *   SP ─► outer PID ─► inner SP ─► inner PID ─► actuator
+ *              ▲  (limits narrowed while    │
+ *              │   the inner loop saturates) ▼
+ *         outer PV ◄─────── plant ◄──── inner PV
+ *
+ * The outer output range is the inner setpoint range. The loops run at
+ * their own rates (the inner one typically 5–20× faster): call
+ * updateOuter() at the slow rate and updateInner() at the fast one, from
+ * different tasks if needed as long as the caller serializes them, or
+ * use update() with setOuterDecimation() from a single loop.
+ *
+ * Saturation propagates outwards: while the inner output sits at a limit,
+ * the outer output is capped at the current inner setpoint in the
+ * direction the inner loop cannot follow, so the outer integral (use
+ * back-calculation or conditional anti-windup on it) stops winding up
+ * against a fan that is already at full speed.
+ *
+ * Usage:
+ *   PidCascade cascade(0.0f, 100.0f, PID_REVERSE, 0.0f, 100.0f, PID_DIRECT);
+ *   cascade.outer().setTunings(12.0f, 0.18f, 2.0f);
+ *   cascade.inner().setTunings(0.3f, 0.6f, 0.0f);
+ *   cascade.init();
+ *   cascade.updateOuter(setpointC, temperatureC, 2.0f);   // every 2 s
+ *   float duty = cascade.updateInner(speedPercent, 0.1f); // every 100 ms
+ */
+
+#ifndef PID_CASCADE_H
+#define PID_CASCADE_H
+
+#include <stdint.h>
+#include "PidController.h"
+
+class PidCascade {
+public:
+    /**
+     * @param innerSetpointMin Outer output / inner setpoint range.
+     * @param innerSetpointMax
+     * @param outerDirection   Action of the outer loop.
+     * @param innerOutputMin   Actuator range.
+     * @param innerOutputMax
+     * @param innerDirection   Action of the inner loop.
+     */
+    PidCascade(float innerSetpointMin, float innerSetpointMax, PidDirection outerDirection,
+               float innerOutputMin, float innerOutputMax, PidDirection innerDirection);
+
+    /** @brief Reset both loops; the inner setpoint returns to its minimum. */
+    void init();
+    void reset();
+    /** @brief Reset the inner loop only (e.g. actuator switched off). */
+    void resetInner();
+
+    PidController &outer();
+    PidController &inner();
+    const PidController &outer() const;
+    const PidController &inner() const;
+
+    /** @brief Outer step: new inner setpoint, within the saturation-narrowed range. */
+    float updateOuter(float setpoint, float measuredValue, float dtSeconds);
+
+    /** @brief Inner step towards the current inner setpoint; returns the actuator value. */
+    float updateInner(float measuredValue, float dtSeconds);
+
+    /**
+     * @brief Set the inner setpoint directly (outer loop in manual, e.g.
+     *        during an autotune); clamped to the inner setpoint range.
+     */
+    void setInnerSetpoint(float innerSetpoint);
+
+    /** @brief Run the outer loop every @p ratio update() calls (≥ 1). */
+    void setOuterDecimation(uint8_t ratio);
+
+    /** @brief Single-loop form: outer every N calls, inner every call. */
+    float update(float setpoint, float outerMeasured, float innerMeasured, float innerDtSeconds);
+
+    float getInnerSetpoint() const;
+    float getOutput() const;
+    /** @brief −1 / +1 while the inner output sits at its min / max, else 0. */
+    int8_t getInnerSaturation() const;
+    /** @brief True while the outer output range is narrowed by inner saturation. */
+    bool isOuterLimited() const;
+
+private:
+    void propagateSaturation();
+
+    PidController _outer;
+    PidController _inner;
+    float _setpointMin;
+    float _setpointMax;
+    float _innerSetpoint;
+    int8_t _innerSaturation;
+    bool _outerLimited;
+    uint8_t _decimation;
+    uint8_t _decimationCount;
+};
+
+#endif // PID_CASCADE_H
@@ -4,6 +4,7 @@
  */
 
 #include "PidController.h"
+#include <math.h>
 
 PidController::PidController(float kp, float ki, float kd,
                              float outputMin, float outputMax,
@@ -14,8 +15,19 @@ PidController::PidController(float kp, float ki, float kd,
       _outputMin(outputMin),
       _outputMax(outputMax),
       _direction(direction),
+      _derivativeMode(PID_DERIVATIVE_ON_ERROR),
+      _derivativeFilterN(0.0f),
+      _antiWindup(PID_ANTIWINDUP_CLAMP),
+      _form(PID_FORM_POSITIONAL),
+      _trackingTime(0.0f),
+      _setpointWeightP(1.0f),
+      _setpointWeightD(1.0f),
+      _feedForward(0.0f),
+      _appliedFeedForward(0.0f),
       _hasPreviousError(false),
       _previousError(0.0f),
+      _previousProportionalError(0.0f),
+      _previousMeasurement(0.0f),
       _integral(0.0f),
       _derivative(0.0f),
       _lastError(0.0f),
@@ -34,6 +46,16 @@ void PidController::setTunings(float kp, float ki, float kd) {
     _kd = kd;
 }
 
+void PidController::setTuningsBumpless(float kp, float ki, float kd) {
+    float oldKp = _kp;
+    float oldKd = _kd;
+    setTunings(kp, ki, kd);
+    if (_hasPreviousError && _form == PID_FORM_POSITIONAL) {
+        _integral -= (_kp - oldKp) * _previousProportionalError + (_kd - oldKd) * _derivative;
+        clampIntegral();
+    }
+}
+
 void PidController::setOutputLimits(float outputMin, float outputMax) {
     if (outputMax < outputMin) {
         float tmp = outputMax;
@@ -43,7 +65,7 @@ void PidController::setOutputLimits(float outputMin, float outputMax) {
 
     _outputMin = outputMin;
     _outputMax = outputMax;
-    _integral = clamp(_integral, _outputMin, _outputMax);
+    clampIntegral();
     _lastOutput = clamp(_lastOutput, _outputMin, _outputMax);
 }
 
@@ -51,13 +73,67 @@ void PidController::setDirection(PidDirection direction) {
     _direction = direction;
 }
 
+void PidController::setDerivativeMode(PidDerivativeMode mode) {
+    _derivativeMode = mode;
+    _hasPreviousError = false;  // Next step starts a fresh difference
+    _derivative = 0.0f;
+}
+
+void PidController::setDerivativeFilter(float n) {
+    _derivativeFilterN = (n > 0.0f) ? n : 0.0f;
+}
+
+void PidController::setAntiWindup(PidAntiWindup mode, float trackingTimeS) {
+    _antiWindup = mode;
+    _trackingTime = (trackingTimeS > 0.0f) ? trackingTimeS : 0.0f;
+}
+
+void PidController::setSetpointWeights(float b, float c) {
+    _setpointWeightP = (b > 0.0f) ? b : 0.0f;
+    _setpointWeightD = (c > 0.0f) ? c : 0.0f;
+    _hasPreviousError = false;  // D difference restarts on the new weighting
+    _derivative = 0.0f;
+}
+
+void PidController::setFeedForward(float feedForward) {
+    _feedForward = feedForward;
+}
+
+void PidController::setForm(PidForm form) {
+    if (form == _form) {
+        return;
+    }
+    _form = form;
+    // Both forms keep _lastOutput and an equivalent _integral up to date,
+    // so switching needs no reset.
+    _appliedFeedForward = _feedForward;
+}
+
+void PidController::setOutput(float output) {
+    output = clamp(output, _outputMin, _outputMax);
+    _lastOutput = output;
+    _appliedFeedForward = _feedForward;
+    _integral = output - _kp * _previousProportionalError - _kd * _derivative - _feedForward;
+    if (_form == PID_FORM_POSITIONAL) {
+        clampIntegral();
+    }
+}
+
+void PidController::restart() {
+    _hasPreviousError = false;
+    _derivative = 0.0f;
+}
+
 void PidController::reset() {
     _hasPreviousError = false;
     _previousError = 0.0f;
+    _previousProportionalError = 0.0f;
+    _previousMeasurement = 0.0f;
     _integral = 0.0f;
     _derivative = 0.0f;
     _lastError = 0.0f;
     _lastOutput = 0.0f;
+    _appliedFeedForward = 0.0f;
 }
 
 float PidController::update(float setpoint, float measuredValue, float dtSeconds) {
@@ -66,28 +142,121 @@ float PidController::update(float setpoint, float measuredValue, float dtSeconds
     }
 
     float error = calculateError(setpoint, measuredValue);
-    float proportional = _kp * error;
-
-    _integral += _ki * error * dtSeconds;
-    _integral = clamp(_integral, _outputMin, _outputMax);
+    float proportionalError = weightedError(_setpointWeightP, setpoint, measuredValue);
+    float derivativeError = weightedError(_setpointWeightD, setpoint, measuredValue);
+    float proportional = _kp * proportionalError;
+    bool hadHistory = _hasPreviousError;
+    float previousProportionalError = _previousProportionalError;
+    float previousDerivative = _derivative;
+    if (!_hasPreviousError && _form == PID_FORM_POSITIONAL) {
+        // Fresh start or new weights: move the Kp·(1 − b)·SP offset into the
+        // integral so the first output matches the plain (b = 1) law.
+        _integral -= _kp * ((proportionalError - error) -
+                            (_previousProportionalError - _lastError));
+    }
 
+    // Derivative: rate of the (c-weighted) error, or of the error without
+    // the setpoint term (−dPV/dt for DIRECT, +dPV/dt for REVERSE),
+    // optionally filtered.
+    float rate = 0.0f;
     if (_hasPreviousError) {
-        _derivative = (error - _previousError) / dtSeconds;
+        if (_derivativeMode == PID_DERIVATIVE_ON_MEASUREMENT) {
+            float change = (measuredValue - _previousMeasurement) / dtSeconds;
+            rate = (_direction == PID_REVERSE) ? change : -change;
+        } else {
+            rate = (derivativeError - _previousError) / dtSeconds;
+        }
+    }
+    if (_hasPreviousError && _derivativeFilterN > 0.0f && _kp > 0.0f && _kd > 0.0f) {
+        float tf = _kd / (_kp * _derivativeFilterN);
+        _derivative += (rate - _derivative) * (dtSeconds / (tf + dtSeconds));
     } else {
-        _derivative = 0.0f;
-        _hasPreviousError = true;
+        _derivative = rate;
     }
-
+    _hasPreviousError = true;
     float derivativeTerm = _kd * _derivative;
-    float output = proportional + _integral + derivativeTerm;
-    output = clamp(output, _outputMin, _outputMax);
+    float direct = derivativeTerm + _feedForward;   // Terms outside the integral
+
+    if (_form == PID_FORM_VELOCITY) {
+        // Increments of each term; saturating the accumulated output is the
+        // whole anti-windup.
+        float delta = _ki * error * dtSeconds + (_feedForward - _appliedFeedForward);
+        if (hadHistory) {
+            delta += _kp * (proportionalError - previousProportionalError) +
+                     _kd * (_derivative - previousDerivative);
+        }
+        float output = clamp(_lastOutput + delta, _outputMin, _outputMax);
+        _appliedFeedForward = _feedForward;
+        _integral = output - proportional - direct;   // Equivalent positional integral
+
+        _previousProportionalError = proportionalError;
+        _lastError = error;
+        _previousError = derivativeError;
+        _previousMeasurement = measuredValue;
+        _lastOutput = output;
+        return output;
+    }
 
-    _previousError = error;
+    float step = _ki * error * dtSeconds;
+    switch (_antiWindup) {
+        case PID_ANTIWINDUP_CONDITIONAL: {
+            float unsaturated = proportional + _integral + step + direct;
+            bool windingUp = (unsaturated > _outputMax && step > 0.0f) ||
+                             (unsaturated < _outputMin && step < 0.0f);
+            if (!windingUp) {
+                _integral += step;
+            }
+            break;
+        }
+        case PID_ANTIWINDUP_BACK_CALCULATION: {
+            float unsaturated = proportional + _integral + direct;
+            float excess = clamp(unsaturated, _outputMin, _outputMax) - unsaturated;
+            _integral += step + trackingGain(dtSeconds) * excess * dtSeconds;
+            break;
+        }
+        case PID_ANTIWINDUP_CLAMP:
+        default:
+            _integral += step;
+            break;
+    }
+    _previousProportionalError = proportionalError;
     _lastError = error;
+    clampIntegral();
+
+    float output = proportional + _integral + direct;
+    output = clamp(output, _outputMin, _outputMax);
+
+    _previousError = derivativeError;
+    _previousMeasurement = measuredValue;
     _lastOutput = output;
     return output;
 }
 
+void PidController::clampIntegral() {
+    // With b < 1 the P term carries Kp·(1 − b)·SP even at zero error, which
+    // the integral has to cancel: bound the integral's share of the output
+    // at zero error, not the integral itself.
+    float weightOffset = _kp * (_previousProportionalError - _lastError);
+    _integral = clamp(_integral, _outputMin - weightOffset, _outputMax - weightOffset);
+}
+
+float PidController::trackingGain(float dtSeconds) const {
+    float tt = _trackingTime;
+    if (tt <= 0.0f) {
+        if (_ki <= 0.0f || _kp <= 0.0f) {
+            return 1.0f / dtSeconds;   // No integral time: drop the excess at once
+        }
+        float ti = _kp / _ki;
+        float td = _kd / _kp;
+        tt = (td > 0.0f) ? sqrtf(ti * td) : ti;
+    }
+    // More than the whole excess per step would overshoot the other way.
+    if (tt < dtSeconds) {
+        tt = dtSeconds;
+    }
+    return 1.0f / tt;
+}
+
 float PidController::getKp() const {
     return _kp;
 }
@@ -116,6 +285,46 @@ float PidController::getOutput() const {
     return _lastOutput;
 }
 
+float PidController::getOutputMin() const {
+    return _outputMin;
+}
+
+float PidController::getOutputMax() const {
+    return _outputMax;
+}
+
+PidDirection PidController::getDirection() const {
+    return _direction;
+}
+
+PidForm PidController::getForm() const {
+    return _form;
+}
+
+PidDerivativeMode PidController::getDerivativeMode() const {
+    return _derivativeMode;
+}
+
+float PidController::getDerivativeFilter() const {
+    return _derivativeFilterN;
+}
+
+PidAntiWindup PidController::getAntiWindup() const {
+    return _antiWindup;
+}
+
+float PidController::getSetpointWeightP() const {
+    return _setpointWeightP;
+}
+
+float PidController::getSetpointWeightD() const {
+    return _setpointWeightD;
+}
+
+float PidController::getFeedForward() const {
+    return _feedForward;
+}
+
 float PidController::calculateError(float setpoint, float measuredValue) const {
     if (_direction == PID_REVERSE) {
         return measuredValue - setpoint;
@@ -123,6 +332,13 @@ float PidController::calculateError(float setpoint, float measuredValue) const {
     return setpoint - measuredValue;
 }
 
+float PidController::weightedError(float weight, float setpoint, float measuredValue) const {
+    if (_direction == PID_REVERSE) {
+        return measuredValue - weight * setpoint;
+    }
+    return weight * setpoint - measuredValue;
+}
+
 float PidController::clamp(float value, float minValue, float maxValue) const {
     if (value < minValue) return minValue;
     if (value > maxValue) return maxValue;
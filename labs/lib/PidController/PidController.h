@@ -1,6 +1,35 @@
 /**
  * @file PidController.h
  * @brief Reusable discrete PID controller.
+ *
+ * Optional refinements (defaults keep the plain textbook form):
+ *   - setDerivativeMode(PID_DERIVATIVE_ON_MEASUREMENT): differentiate the
+ *     measurement instead of the error, so setpoint steps cause no
+ *     derivative kick.
+ *   - setDerivativeFilter(N): first-order low-pass on the derivative with
+ *     time constant Td/N (Td = Kd/Kp); N = 8..20 is usual, 0 = off.
+ *   - setAntiWindup(): PID_ANTIWINDUP_CLAMP bounds the integral to the
+ *     output limits; PID_ANTIWINDUP_CONDITIONAL stops integrating while
+ *     the output is saturated in the error's direction;
+ *     PID_ANTIWINDUP_BACK_CALCULATION bleeds the integral by
+ *     (saturated − unsaturated output) / Tt, Tt = √(Ti·Td) (or Ti) unless
+ *     given.
+ *   - setSetpointWeights(b, c): two-degree-of-freedom form. P acts on
+ *     b·SP − PV and D on c·SP − PV (D on error only; on-measurement is
+ *     c = 0), the integral always on SP − PV. b < 1 softens the response
+ *     to setpoint steps without detuning disturbance rejection.
+ *   - setFeedForward(u): term added to the output before saturation and
+ *     anti-windup, e.g. a model of the steady-state demand.
+ *   - setForm(PID_FORM_VELOCITY): incremental form. Each update() adds
+ *       Δu = Kp·Δe_P + Ki·dt·e + Kd·ΔD + ΔFF
+ *     to the previous (saturated) output, which for plain on-error gains is
+ *     the classic q0·e[k] + q1·e[k−1] + q2·e[k−2]. The output never leaves
+ *     its limits, so there is no windup; gain changes, setOutput() and
+ *     restart() after a sensor dropout continue from the present output.
+ *
+ * getDerivative() returns the filtered rate actually used, getIntegral()
+ * the integral after anti-windup (with b < 1 it includes the offset that
+ * cancels Kp·(1 − b)·SP).
  */
 
 #ifndef PID_CONTROLLER_H
@@ -11,6 +40,22 @@ enum PidDirection {
     PID_REVERSE = 1
 };
 
+enum PidDerivativeMode {
+    PID_DERIVATIVE_ON_ERROR = 0,
+    PID_DERIVATIVE_ON_MEASUREMENT = 1
+};
+
+enum PidForm {
+    PID_FORM_POSITIONAL = 0,
+    PID_FORM_VELOCITY = 1
+};
+
+enum PidAntiWindup {
+    PID_ANTIWINDUP_CLAMP = 0,
+    PID_ANTIWINDUP_CONDITIONAL = 1,
+    PID_ANTIWINDUP_BACK_CALCULATION = 2
+};
+
 class PidController {
 public:
     PidController(float kp, float ki, float kd,
@@ -19,8 +64,34 @@ public:
 
     void init();
     void setTunings(float kp, float ki, float kd);
+    /**
+     * @brief setTunings() that keeps the output continuous: the integral
+     *        absorbs the P and D change at the last error and rate.
+     */
+    void setTuningsBumpless(float kp, float ki, float kd);
     void setOutputLimits(float outputMin, float outputMax);
     void setDirection(PidDirection direction);
+    void setDerivativeMode(PidDerivativeMode mode);
+    /** @brief Derivative filter coefficient N (0 = unfiltered). */
+    void setDerivativeFilter(float n);
+    /** @brief Anti-windup scheme; @p trackingTimeS only for back-calculation (0 = auto). */
+    void setAntiWindup(PidAntiWindup mode, float trackingTimeS = 0.0f);
+    /** @brief Setpoint weights for P (b) and D (c); 1, 1 = plain PID. */
+    void setSetpointWeights(float b, float c);
+    /** @brief Additive feed-forward, in output units, used from the next update(). */
+    void setFeedForward(float feedForward);
+    /** @brief Positional (default) or velocity (incremental) algorithm. */
+    void setForm(PidForm form);
+    /**
+     * @brief Bumpless manual → auto: the next update() continues from
+     *        @p output (positional form: the integral is set to match).
+     */
+    void setOutput(float output);
+    /**
+     * @brief Forget the error history but keep the output and integral,
+     *        e.g. after invalid samples; the next step has no P/D increment.
+     */
+    void restart();
     void reset();
 
     float update(float setpoint, float measuredValue, float dtSeconds);
@@ -32,10 +103,26 @@ public:
     float getIntegral() const;
     float getDerivative() const;
     float getOutput() const;
+    float getOutputMin() const;
+    float getOutputMax() const;
+    PidDirection getDirection() const;
+    PidForm getForm() const;
+    PidDerivativeMode getDerivativeMode() const;
+    float getDerivativeFilter() const;
+    PidAntiWindup getAntiWindup() const;
+    float getSetpointWeightP() const;
+    float getSetpointWeightD() const;
+    float getFeedForward() const;
 
 private:
     float calculateError(float setpoint, float measuredValue) const;
+    /** @brief Error with the setpoint scaled by @p weight, in the controller's direction. */
+    float weightedError(float weight, float setpoint, float measuredValue) const;
     float clamp(float value, float minValue, float maxValue) const;
+    /** @brief Back-calculation gain 1/Tt for this step. */
+    float trackingGain(float dtSeconds) const;
+    /** @brief Bound the integral so P at zero error plus I stays within the limits. */
+    void clampIntegral();
 
     float _kp;
     float _ki;
@@ -43,9 +130,20 @@ private:
     float _outputMin;
     float _outputMax;
     PidDirection _direction;
+    PidDerivativeMode _derivativeMode;
+    float _derivativeFilterN;
+    PidAntiWindup _antiWindup;
+    PidForm _form;
+    float _trackingTime;
+    float _setpointWeightP;
+    float _setpointWeightD;
+    float _feedForward;
+    float _appliedFeedForward;   // Feed-forward contained in _lastOutput (velocity)
 
     bool _hasPreviousError;
     float _previousError;
+    float _previousProportionalError;
+    float _previousMeasurement;
     float _integral;
     float _derivative;
     float _lastError;
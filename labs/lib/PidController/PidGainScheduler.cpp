@@ -0,0 +1,81 @@
+/**
+ * @file PidGainScheduler.cpp
+ * @brief Gain scheduling implementation.
+ */
+
+#include "PidGainScheduler.h"
+#include <math.h>
+#include <string.h>
+
+PidGainScheduler::PidGainScheduler(const PidGainPoint *points, uint8_t count,
+                                   PidScheduleKey key)
+    : _points(points), _count(count), _key(key) {}
+
+PidGainPoint PidGainScheduler::point(uint8_t index) const {
+    PidGainPoint p;
+#if defined(__AVR__)
+    memcpy_P(&p, &_points[index], sizeof(p));
+#else
+    memcpy(&p, &_points[index], sizeof(p));
+#endif
+    return p;
+}
+
+float PidGainScheduler::keyFor(float setpoint, float measuredValue) const {
+    switch (_key) {
+        case PID_SCHEDULE_MEASUREMENT:
+            return measuredValue;
+        case PID_SCHEDULE_ERROR_MAGNITUDE:
+            return fabsf(setpoint - measuredValue);
+        case PID_SCHEDULE_SETPOINT:
+        default:
+            return setpoint;
+    }
+}
+
+void PidGainScheduler::lookup(float key, float *kp, float *ki, float *kd) const {
+    if (_count == 0) {
+        *kp = *ki = *kd = 0.0f;
+        return;
+    }
+
+    PidGainPoint lo = point(0);
+    if (_count == 1 || !(key > lo.key)) {
+        *kp = lo.kp;                      // Below the table (or NaN): first row
+        *ki = lo.ki;
+        *kd = lo.kd;
+        return;
+    }
+    for (uint8_t i = 1; i < _count; i++) {
+        PidGainPoint hi = point(i);
+        if (key <= hi.key) {
+            float span = hi.key - lo.key;
+            float t = (span > 0.0f) ? (key - lo.key) / span : 1.0f;
+            *kp = lo.kp + (hi.kp - lo.kp) * t;
+            *ki = lo.ki + (hi.ki - lo.ki) * t;
+            *kd = lo.kd + (hi.kd - lo.kd) * t;
+            return;
+        }
+        lo = hi;
+    }
+    *kp = lo.kp;                          // Above the table: last row
+    *ki = lo.ki;
+    *kd = lo.kd;
+}
+
+void PidGainScheduler::apply(PidController &pid, float setpoint, float measuredValue) const {
+    float kp;
+    float ki;
+    float kd;
+    lookup(keyFor(setpoint, measuredValue), &kp, &ki, &kd);
+    pid.setTuningsBumpless(kp, ki, kd);
+}
+
+void PidGainScheduler::applyScaled(PidController &pid, float setpoint, float measuredValue,
+                                   float baseKp, float baseKi, float baseKd) const {
+    float kp;
+    float ki;
+    float kd;
+    lookup(keyFor(setpoint, measuredValue), &kp, &ki, &kd);
+    pid.setTuningsBumpless(baseKp * kp, baseKi * ki, baseKd * kd);
+}
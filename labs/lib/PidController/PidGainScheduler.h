@@ -0,0 +1,82 @@
+/**
+ * @file PidGainScheduler.h
+ * @brief Gain scheduling for PidController from a breakpoint table.
+ *
+ * One set of gains rarely fits a plant whose gain drifts with the
+ * operating point (a fan-cooled plant near ambient vs. under full load).
+ * PidGainScheduler interpolates (kp, ki, kd) linearly between PROGMEM
+ * breakpoints keyed on the setpoint, the measurement or |error|, holding
+ * the end values outside the table, and hands them to
+ * PidController::setTuningsBumpless() so a gain change never steps the
+ * output.
+ *
+ * applyScaled() treats the table values as multipliers of base gains
+ * (e.g. the selected preset), so one schedule shapes every preset.
+ *
+ * Usage:
+ *   static const PidGainPoint SCHEDULE[] PROGMEM = {
+ *       {24.0f, 1.0f, 1.0f, 1.0f},
+ *       {32.0f, 0.6f, 0.5f, 0.8f},
+ *   };
+ *   PidGainScheduler sched(SCHEDULE, 2, PID_SCHEDULE_MEASUREMENT);
+ *   sched.applyScaled(pid, setpoint, temperature, kp, ki, kd);
+ *   pid.update(setpoint, temperature, dt);
+ */
+
+#ifndef PID_GAIN_SCHEDULER_H
+#define PID_GAIN_SCHEDULER_H
+
+#include <stdint.h>
+#include "PidController.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#elif !defined(PROGMEM)
+#define PROGMEM
+#endif
+
+/** @brief One breakpoint; keys must be ascending. */
+struct PidGainPoint {
+    float key;
+    float kp;
+    float ki;
+    float kd;
+};
+
+enum PidScheduleKey {
+    PID_SCHEDULE_SETPOINT = 0,
+    PID_SCHEDULE_MEASUREMENT = 1,
+    PID_SCHEDULE_ERROR_MAGNITUDE = 2
+};
+
+class PidGainScheduler {
+public:
+    /**
+     * @param points PROGMEM breakpoints, ascending keys (at least one).
+     * @param count  Number of breakpoints.
+     * @param key    What the breakpoints are keyed on.
+     */
+    PidGainScheduler(const PidGainPoint *points, uint8_t count, PidScheduleKey key);
+
+    /** @brief Scheduling variable for this operating point. */
+    float keyFor(float setpoint, float measuredValue) const;
+
+    /** @brief Interpolated table values at @p key (ends held). */
+    void lookup(float key, float *kp, float *ki, float *kd) const;
+
+    /** @brief Set the interpolated gains on @p pid (bumpless). */
+    void apply(PidController &pid, float setpoint, float measuredValue) const;
+
+    /** @brief Set base gains × interpolated factors on @p pid (bumpless). */
+    void applyScaled(PidController &pid, float setpoint, float measuredValue,
+                     float baseKp, float baseKi, float baseKd) const;
+
+private:
+    PidGainPoint point(uint8_t index) const;
+
+    const PidGainPoint *_points;
+    uint8_t _count;
+    PidScheduleKey _key;
+};
+
+#endif // PID_GAIN_SCHEDULER_H
@@ -0,0 +1,115 @@
+/**
+ * @file SmithPredictor.cpp
+ * @brief Smith predictor implementation.
+ *
+ * The model is in deviation form starting at 0: only the difference
+ * between its undelayed and delayed outputs reaches the controller, so
+ * the operating point needs no initialization.
+ */
+
+#include "SmithPredictor.h"
+#include <math.h>
+
+SmithPredictor::SmithPredictor()
+    : _configured(false),
+      _gain(0.0f),
+      _timeConstant(0.0f),
+      _sample(0.0f),
+      _delaySteps(0),
+      _model(0.0f),
+      _head(0) {
+    reset();
+}
+
+bool SmithPredictor::setModel(float gain, float timeConstantS, float deadTimeS,
+                              float sampleS) {
+    if (!(timeConstantS > 0.0f) || !(sampleS > 0.0f) || !(deadTimeS >= 0.0f) ||
+        isnan(gain)) {
+        return false;
+    }
+    float steps = floorf(deadTimeS / sampleS + 0.5f);
+    if (steps > (float)SMITH_MAX_DELAY_STEPS) {
+        return false;
+    }
+    _gain = gain;
+    _timeConstant = timeConstantS;
+    _sample = sampleS;
+    _delaySteps = (uint8_t)steps;
+    _configured = true;
+    reset();
+    return true;
+}
+
+bool SmithPredictor::setModelFromRelay(float ultimateGain, float ultimatePeriodS,
+                                       float gain, float sampleS) {
+    float loopGain = fabsf(gain) * ultimateGain;
+    if (!(loopGain > 1.0f) || !(ultimatePeriodS > 0.0f)) {
+        return false;
+    }
+    float omega = 2.0f * (float)M_PI / ultimatePeriodS;
+    float tau = sqrtf(loopGain * loopGain - 1.0f) / omega;
+    float theta = ((float)M_PI - atanf(omega * tau)) / omega;
+    return setModel(gain, tau, theta, sampleS);
+}
+
+void SmithPredictor::reset() {
+    _model = 0.0f;
+    for (uint8_t i = 0; i < SMITH_MAX_DELAY_STEPS; i++) {
+        _ring[i] = 0.0f;
+    }
+    _head = 0;
+}
+
+bool SmithPredictor::isConfigured() const {
+    return _configured;
+}
+
+float SmithPredictor::delayedModel() const {
+    return (_delaySteps == 0) ? _model : _ring[_head];
+}
+
+float SmithPredictor::feedback(float measuredValue) const {
+    return measuredValue + getCorrection();
+}
+
+void SmithPredictor::advance(float output, float dtSeconds) {
+    if (!_configured) {
+        return;
+    }
+    if (dtSeconds <= 0.0f) {
+        dtSeconds = _sample;
+    }
+    // Backward Euler: stable for any dt.
+    _model += (_gain * output - _model) * (dtSeconds / (_timeConstant + dtSeconds));
+    if (_delaySteps > 0) {
+        _ring[_head] = _model;
+        _head = (uint8_t)((_head + 1) % _delaySteps);
+    }
+}
+
+float SmithPredictor::update(PidController &pid, float setpoint, float measuredValue,
+                             float dtSeconds) {
+    float output = pid.update(setpoint, feedback(measuredValue), dtSeconds);
+    advance(output, dtSeconds);
+    return output;
+}
+
+float SmithPredictor::getCorrection() const {
+    return _configured ? _model - delayedModel() : 0.0f;
+}
+
+float SmithPredictor::getGain() const {
+    return _gain;
+}
+
+float SmithPredictor::getTimeConstantS() const {
+    return _timeConstant;
+}
+
+float SmithPredictor::getDeadTimeS() const {
+    return _delaySteps * _sample;
+}
+
+uint8_t SmithPredictor::getDelaySteps() const {
+    return _delaySteps;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file SmithPredictor.h
+ * @brief Dead-time compensation for PidController (Smith predictor).
+ *
+ * A first-order-plus-dead-time (FOPDT) model of the plant,
+ *
+ *   G(s) = K · e^(−θs) / (τs + 1),
+ *
+ * runs next to the loop. The PID sees the measurement corrected by the
+ * difference between the model without and with the delay,
+ *
+ *   PV' = PV + ŷ(t) − ŷ(t − θ),
+ *
+ * so it is tuned for the delay-free part τ alone and tolerates higher
+ * gains. With an exact model PV' is the undelayed response; in steady
+ * state both model outputs agree and PV' = PV (no offset is introduced).
+ *
+ * The delay is a ring of up to SMITH_MAX_DELAY_STEPS model samples at the
+ * nominal sample time, so θ is rounded to whole samples. K is in PV units
+ * per output unit and carries the sign (negative for a cooling fan).
+ *
+ * setModelFromRelay() derives τ and θ from an autotune's Ku/Pu plus the
+ * static gain K, which a relay experiment alone cannot provide.
+ *
+ * Usage:
+ *   SmithPredictor smith;
+ *   smith.setModel(-0.2f, 60.0f, 8.0f, 2.0f);   // K, τ, θ, sample (s)
+ *   float out = smith.update(pid, setpoint, temperature, 2.0f);
+ *   // or, around another controller:
+ *   out = cascade.updateOuter(setpoint, smith.feedback(temperature), dt);
+ *   smith.advance(out, dt);
+ */
+
+#ifndef SMITH_PREDICTOR_H
+#define SMITH_PREDICTOR_H
+
+#include <stdint.h>
+#include "PidController.h"
+
+/** @brief Longest dead time in samples (4 bytes of RAM each). */
+#ifndef SMITH_MAX_DELAY_STEPS
+#define SMITH_MAX_DELAY_STEPS 32
+#endif
+
+class SmithPredictor {
+public:
+    SmithPredictor();
+
+    /**
+     * @brief Set the FOPDT model and clear its state.
+     * @param gain          Static gain K (PV units per output unit, signed).
+     * @param timeConstantS τ in seconds (> 0).
+     * @param deadTimeS     θ in seconds (≥ 0).
+     * @param sampleS       Nominal update period in seconds (> 0).
+     * @return false (model unchanged) if a value is out of range or θ
+     *         exceeds SMITH_MAX_DELAY_STEPS samples.
+     */
+    bool setModel(float gain, float timeConstantS, float deadTimeS, float sampleS);
+
+    /**
+     * @brief Model from a relay autotune and a measured static gain.
+     *
+     * At the ultimate frequency ω = 2π/Pu the FOPDT gain is 1/Ku and its
+     * phase −π: τ = √((|K|·Ku)² − 1) / ω, θ = (π − atan(ωτ)) / ω.
+     *
+     * @return false if |K|·Ku ≤ 1 (inconsistent) or setModel() fails.
+     */
+    bool setModelFromRelay(float ultimateGain, float ultimatePeriodS, float gain,
+                           float sampleS);
+
+    /** @brief Forget the model history (PV' = PV until it builds up again). */
+    void reset();
+
+    bool isConfigured() const;
+
+    /** @brief Corrected measurement PV' to feed the controller. */
+    float feedback(float measuredValue) const;
+
+    /** @brief Step the model with the output that was applied. */
+    void advance(float output, float dtSeconds);
+
+    /** @brief feedback() → pid.update() → advance(). */
+    float update(PidController &pid, float setpoint, float measuredValue, float dtSeconds);
+
+    /** @brief Current correction ŷ(t) − ŷ(t − θ). */
+    float getCorrection() const;
+    float getGain() const;
+    float getTimeConstantS() const;
+    float getDeadTimeS() const;
+    uint8_t getDelaySteps() const;
+
+private:
+    float delayedModel() const;
+
+    bool _configured;
+    float _gain;
+    float _timeConstant;
+    float _sample;
+    uint8_t _delaySteps;
+
+    float _model;                          // Undelayed model output ŷ(t)
+    float _ring[SMITH_MAX_DELAY_STEPS];    // ŷ of the last _delaySteps samples
+    uint8_t _head;                         // Oldest entry
+};
+
+#endif // SMITH_PREDICTOR_H
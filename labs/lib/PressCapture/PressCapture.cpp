@@ -0,0 +1,276 @@
+/**
+ * @file PressCapture.cpp
+ * @brief Hardware Input-Capture Press-Duration Measurement Implementation
+ *
+ * Timer setup (n = PRESS_CAPTURE_TIMER):
+ *   TCCRnA = 0                     normal mode, no output compare pins
+ *   TCCRnB = ICNCn | CSn1 | CSn0   noise canceler, ÷64 (+ ICESn: rising)
+ *   TIMSKn = ICIEn | TOIEn (+ OCIEnA while a burst is being timed)
+ *
+ * 32-bit time: the overflow ISR counts wraps of TCNTn. A capture taken
+ * just after a wrap whose overflow interrupt has not run yet (the capture
+ * ISR has priority) is recognized by TOVn still set and a small ICRn.
+ *
+ * Edge select is flipped after every capture. Bounces faster than the ISR
+ * can leave it pointing the wrong way; the compare ISR therefore resyncs
+ * it from the actual pin level when a burst ends.
+ */
+
+#include "PressCapture.h"
+#include "SpscRing.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// State
+// ──────────────────────────────────────────────────────────────────────────
+
+static void   (*s_onEvent)() = NULL;
+static uint16_t s_glitchTicks = 0;           ///< Quiet window in timer ticks.
+static volatile uint16_t s_overflows = 0;    ///< High half of the 32-bit tick count.
+
+// Burst / press tracking (ISR-owned).
+static bool     s_inBurst = false;           ///< Edges seen, window not yet quiet.
+static uint32_t s_burstStartUs = 0;          ///< First edge of the current burst.
+static volatile bool s_pressed = false;      ///< Debounced state.
+static uint32_t s_pressStartUs = 0;          ///< Accepted press edge.
+
+static volatile uint16_t s_glitches = 0;
+
+// Completed presses: the ISR pushes, pressCaptureRead() pops.
+static SpscRing<PressCaptureEvent_t, PRESS_CAPTURE_QUEUE_SIZE> s_queue;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Timer register selection
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(__AVR__)
+#if PRESS_CAPTURE_TIMER == 4
+#define PC_TCCRA   TCCR4A
+#define PC_TCCRB   TCCR4B
+#define PC_TCNT    TCNT4
+#define PC_ICR     ICR4
+#define PC_OCRA    OCR4A
+#define PC_TIMSK   TIMSK4
+#define PC_TIFR    TIFR4
+#define PC_ICNC    ICNC4
+#define PC_ICES    ICES4
+#define PC_CS1     CS41
+#define PC_CS0     CS40
+#define PC_ICIE    ICIE4
+#define PC_OCIEA   OCIE4A
+#define PC_TOIE    TOIE4
+#define PC_ICF     ICF4
+#define PC_OCFA    OCF4A
+#define PC_TOV     TOV4
+#define PC_CAPT_vect  TIMER4_CAPT_vect
+#define PC_COMPA_vect TIMER4_COMPA_vect
+#define PC_OVF_vect   TIMER4_OVF_vect
+#define PC_PIN_MASK   _BV(PL0)
+#else
+#define PC_TCCRA   TCCR5A
+#define PC_TCCRB   TCCR5B
+#define PC_TCNT    TCNT5
+#define PC_ICR     ICR5
+#define PC_OCRA    OCR5A
+#define PC_TIMSK   TIMSK5
+#define PC_TIFR    TIFR5
+#define PC_ICNC    ICNC5
+#define PC_ICES    ICES5
+#define PC_CS1     CS51
+#define PC_CS0     CS50
+#define PC_ICIE    ICIE5
+#define PC_OCIEA   OCIE5A
+#define PC_TOIE    TOIE5
+#define PC_ICF     ICF5
+#define PC_OCFA    OCF5A
+#define PC_TOV     TOV5
+#define PC_CAPT_vect  TIMER5_CAPT_vect
+#define PC_COMPA_vect TIMER5_COMPA_vect
+#define PC_OVF_vect   TIMER5_OVF_vect
+#define PC_PIN_MASK   _BV(PL1)
+#endif
+
+/** @brief Ticks → µs (÷64 at 16 MHz = 4 µs per tick), wrapping at 2^32 µs. */
+static inline uint32_t ticksToUs(uint16_t high, uint16_t low) {
+    return ((((uint32_t)high) << 16) | low) << 2;
+}
+
+/** @brief True while the (active-LOW) button pin reads pressed. */
+static inline bool pinPressed() {
+    return (PINL & PC_PIN_MASK) == 0;
+}
+
+/** @brief Capture the opposite of the current level; clear a stale flag. */
+static inline void selectEdgeFor(bool pressed) {
+    if (pressed) {
+        PC_TCCRB |= _BV(PC_ICES);                 // Wait for the release (rising)
+    } else {
+        PC_TCCRB &= (uint8_t)~_BV(PC_ICES);       // Wait for a press (falling)
+    }
+    PC_TIFR = _BV(PC_ICF);                        // Required after changing ICES
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Interrupts
+// ──────────────────────────────────────────────────────────────────────────
+
+ISR(PC_OVF_vect) {
+    s_overflows++;
+}
+
+ISR(PC_CAPT_vect) {
+    uint16_t icr  = PC_ICR;
+    uint16_t high = s_overflows;
+    if ((PC_TIFR & _BV(PC_TOV)) && icr < 0x8000) {
+        high++;                                   // Wrap not yet counted
+    }
+
+    PC_TCCRB ^= _BV(PC_ICES);                     // Next: the opposite edge
+    PC_TIFR = _BV(PC_ICF);
+
+    if (!s_inBurst) {
+        s_inBurst = true;
+        s_burstStartUs = ticksToUs(high, icr);
+    }
+
+    // (Re)start the quiet window from this edge.
+    PC_OCRA = (uint16_t)(icr + s_glitchTicks);
+    PC_TIFR = _BV(PC_OCFA);
+    PC_TIMSK |= _BV(PC_OCIEA);
+}
+
+ISR(PC_COMPA_vect) {
+    PC_TIMSK &= (uint8_t)~_BV(PC_OCIEA);
+    s_inBurst = false;
+
+    bool pressed = pinPressed();
+    selectEdgeFor(pressed);
+    if (pinPressed() != pressed && !(PC_TIFR & _BV(PC_ICF))) {
+        // Edge lost while re-arming the edge select: start its burst here
+        // (a captured one is still pending and handled by the capture ISR).
+        PC_TCCRB ^= _BV(PC_ICES);
+        PC_TIFR = _BV(PC_ICF);
+        s_inBurst = true;
+        s_burstStartUs = pressCaptureMicros();
+        PC_OCRA = (uint16_t)(PC_TCNT + s_glitchTicks);
+        PC_TIFR = _BV(PC_OCFA);
+        PC_TIMSK |= _BV(PC_OCIEA);
+        return;
+    }
+
+    if (pressed == s_pressed) {
+        if (s_glitches < 0xFFFF) {
+            s_glitches++;                         // Burst ended where it started
+        }
+        return;
+    }
+
+    s_pressed = pressed;
+    if (pressed) {
+        s_pressStartUs = s_burstStartUs;
+        return;
+    }
+
+    PressCaptureEvent_t event;
+    event.pressUs    = s_pressStartUs;
+    event.durationUs = s_burstStartUs - s_pressStartUs;
+    if (!s_queue.push(event)) {
+        return;                                   // Full: counted as dropped
+    }
+
+    if (s_onEvent != NULL) {
+        s_onEvent();
+    }
+}
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool pressCaptureInit(uint16_t glitchMs, void (*onEvent)()) {
+#if defined(__AVR__)
+    if (glitchMs == 0 || glitchMs > PRESS_CAPTURE_MAX_GLITCH_MS) {
+        return false;
+    }
+
+    pinMode(PRESS_CAPTURE_PIN, INPUT_PULLUP);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_onEvent     = onEvent;
+        s_glitchTicks = (uint16_t)(((uint32_t)glitchMs * 1000UL) / PRESS_CAPTURE_RESOLUTION_US);
+        s_overflows   = 0;
+        s_inBurst     = false;
+        s_pressed     = pinPressed();
+        s_pressStartUs = 0;
+        s_glitches    = 0;
+        s_queue.clear();
+
+        PC_TIMSK = 0;
+        PC_TCCRA = 0;
+        PC_TCCRB = (uint8_t)(_BV(PC_ICNC) | _BV(PC_CS1) | _BV(PC_CS0));
+        PC_TCNT  = 0;
+        selectEdgeFor(s_pressed);
+        PC_TIFR  = (uint8_t)(_BV(PC_TOV) | _BV(PC_OCFA));
+        PC_TIMSK = (uint8_t)(_BV(PC_ICIE) | _BV(PC_TOIE));
+    }
+    return true;
+#else
+    (void)glitchMs;
+    (void)onEvent;
+    return false;
+#endif
+}
+
+void pressCaptureStop() {
+#if defined(__AVR__)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        PC_TIMSK = 0;
+        s_inBurst = false;
+    }
+#endif
+}
+
+bool pressCaptureRead(PressCaptureEvent_t *event) {
+    return s_queue.pop(event);
+}
+
+bool pressCaptureIsPressed() {
+    return s_pressed;
+}
+
+uint32_t pressCaptureMicros() {
+#if defined(__AVR__)
+    uint16_t high = 0;
+    uint16_t low = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        low  = PC_TCNT;
+        high = s_overflows;
+        if ((PC_TIFR & _BV(PC_TOV)) && low < 0x8000) {
+            high++;
+        }
+    }
+    return ticksToUs(high, low);
+#else
+    return micros();
+#endif
+}
+
+uint16_t pressCaptureGlitchCount() {
+    uint16_t count = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = s_glitches;
+    }
+    return count;
+}
+
+uint16_t pressCaptureDroppedCount() {
+    return s_queue.dropped();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file PressCapture.h
+ * @brief Hardware Input-Capture Press-Duration Measurement
+ *
+ * Measures push-button presses with a 16-bit timer's input-capture unit
+ * instead of polling the pin from a task:
+ *
+ *   - Every edge on the ICPn pin latches the timer count into ICRn in
+ *     hardware (4 µs resolution, independent of interrupt latency or the
+ *     RTOS tick). The capture ISR extends it to 32 bits with the overflow
+ *     count and flips the edge select for the opposite edge.
+ *   - Glitch rejection: the first edge of a burst is remembered and the
+ *     output-compare unit is armed glitchMs after each edge. When it fires
+ *     the line has been quiet for the whole window; only then is the new
+ *     level accepted, timestamped with the burst's first edge (the true
+ *     contact time). A burst returning to the previous level is counted
+ *     as a glitch. The hardware noise canceler additionally removes
+ *     spikes shorter than 4 CPU cycles.
+ *   - A completed press (press + release) is pushed into a small event
+ *     queue, and the optional callback runs in interrupt context (e.g. to
+ *     give a semaphore or set a flag).
+ *
+ * Timer and pin (Arduino Mega 2560), select with -DPRESS_CAPTURE_TIMER:
+ *   5 (default) → ICP5 = PL1 = D48     4 → ICP4 = PL0 = D49
+ * The timer is taken over entirely (normal mode, ÷64), so analogWrite()
+ * on its PWM pins (Timer5: D44–46, Timer4: D6–8) is no longer available.
+ *
+ * The button is active-LOW: the pin is configured as INPUT_PULLUP and the
+ * button shorts it to GND.
+ *
+ * Usage:
+ *   static void onPress() { ... }            // ISR context
+ *   pressCaptureInit(50, onPress);           // 50 ms glitch window
+ *   ...
+ *   PressCaptureEvent_t ev;
+ *   while (pressCaptureRead(&ev)) {
+ *       printf("%lu us\r\n", ev.durationUs);
+ *   }
+ */
+
+#ifndef PRESS_CAPTURE_H
+#define PRESS_CAPTURE_H
+
+#include <Arduino.h>
+
+/** @brief Timer used for input capture (4 or 5). */
+#ifndef PRESS_CAPTURE_TIMER
+#define PRESS_CAPTURE_TIMER 5
+#endif
+
+#if PRESS_CAPTURE_TIMER == 4
+#define PRESS_CAPTURE_PIN 49   /**< ICP4 (PL0). */
+#elif PRESS_CAPTURE_TIMER == 5
+#define PRESS_CAPTURE_PIN 48   /**< ICP5 (PL1). */
+#else
+#error "PRESS_CAPTURE_TIMER must be 4 or 5"
+#endif
+
+/**
+ * @brief Completed presses buffered until read (power of two, 2..128).
+ * Override with -DPRESS_CAPTURE_QUEUE_SIZE=<n>.
+ */
+#ifndef PRESS_CAPTURE_QUEUE_SIZE
+#define PRESS_CAPTURE_QUEUE_SIZE 8
+#endif
+
+/** @brief Timer resolution in microseconds (16 MHz / 64). */
+#define PRESS_CAPTURE_RESOLUTION_US 4
+
+/** @brief Longest glitch window: one 16-bit compare period (262 ms). */
+#define PRESS_CAPTURE_MAX_GLITCH_MS 262
+
+/**
+ * @brief One completed press, in the capture time base.
+ */
+typedef struct {
+    uint32_t pressUs;     /**< Press edge time (pressCaptureMicros() base). */
+    uint32_t durationUs;  /**< Press edge to release edge.                  */
+} PressCaptureEvent_t;
+
+/**
+ * @brief Take over the capture timer and start measuring.
+ *
+ * @param glitchMs Quiet time (ms) a new level must hold to be accepted
+ *                 (1..PRESS_CAPTURE_MAX_GLITCH_MS).
+ * @param onEvent  Optional callback after each completed press; runs in
+ *                 interrupt context, keep it short.
+ * @return true on success; false for an invalid window or a non-AVR build.
+ */
+bool pressCaptureInit(uint16_t glitchMs, void (*onEvent)() = NULL);
+
+/** @brief Stop the timer interrupts (queued events are kept). */
+void pressCaptureStop();
+
+/**
+ * @brief Pop the oldest completed press.
+ * @param event Receives the event.
+ * @return true if an event was returned; false if the queue is empty.
+ */
+bool pressCaptureRead(PressCaptureEvent_t *event);
+
+/** @brief Debounced button state: true while a press is in progress. */
+bool pressCaptureIsPressed();
+
+/** @brief Current time in the capture time base (µs, wraps like micros()). */
+uint32_t pressCaptureMicros();
+
+/** @brief Bursts rejected as glitches since init (saturates). */
+uint16_t pressCaptureGlitchCount();
+
+/** @brief Presses lost to a full queue since init (saturates). */
+uint16_t pressCaptureDroppedCount();
+
+#endif // PRESS_CAPTURE_H
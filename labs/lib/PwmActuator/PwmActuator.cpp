@@ -1,17 +1,226 @@
 /**
  * @file PwmActuator.cpp
  * @brief PWM-Based Analog Actuator Driver Implementation
+ *
+ * Timer PWM register setup (mode 10, phase-correct, TOP = ICRn):
+ *
+ *   TCCRnA = COMnx1 (non-inverting, per channel) | WGMn1
+ *   TCCRnB = WGMn3 | CSn2..0 (prescaler)
+ *   ICRn   = TOP
+ *   OCRnx  = duty · TOP / 100   (0 → constant LOW, TOP → constant HIGH)
+ *
+ * Dither: TOVn is set at BOTTOM, half a period after OCRnx was latched at
+ * TOP, so the value written by the ISR is the one used for the next full
+ * period. Base and fraction are updated together under ATOMIC_BLOCK.
  */
 
 #include "PwmActuator.h"
 
+#if defined(__AVR__)
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+#define PWM_ACTUATOR_HAS_TIMERS 1
+#endif
+
+#if defined(PWM_ACTUATOR_HAS_TIMERS)
+
+/** One output compare channel of a 16-bit timer. */
+typedef struct {
+    volatile uint8_t  *tccra;
+    volatile uint8_t  *tccrb;
+    volatile uint16_t *icr;
+    volatile uint16_t *tcnt;
+    volatile uint16_t *ocr;
+    volatile uint8_t  *timsk;
+    uint8_t            com;     ///< COMnx1 bit in TCCRnA
+    uint8_t            timer;   ///< Index into s_timerTop / s_timerCs
+    uint8_t            index;   ///< Channel A/B/C = 0/1/2
+} TimerChannel_t;
+
+/** Prescaler options of Timer1/3/4/5 and their CSn2..0 codes. */
+static const uint16_t PRESCALERS[]    = {1, 8, 64, 256, 1024};
+static const uint8_t  PRESCALER_CS[]  = {1, 2, 3, 4, 5};
+
+/** TOP / clock select each timer was configured with (0 = untouched). */
+static uint16_t s_timerTop[4] = {0, 0, 0, 0};
+static uint8_t  s_timerCs[4]  = {0, 0, 0, 0};
+
+static bool lookupChannel(uint8_t pin, TimerChannel_t *ch) {
+    switch (pin) {
+#define PWM_CHANNEL(p, n, idx, x, chan, comBit)                            \
+        case p:                                                            \
+            ch->tccra = &TCCR##n##A; ch->tccrb = &TCCR##n##B;              \
+            ch->icr = &ICR##n; ch->tcnt = &TCNT##n;                        \
+            ch->ocr = &OCR##n##x; ch->timsk = &TIMSK##n;                   \
+            ch->com = _BV(comBit); ch->timer = idx; ch->index = chan;      \
+            return true;
+        PWM_CHANNEL(11, 1, 0, A, 0, COM1A1)
+        PWM_CHANNEL(12, 1, 0, B, 1, COM1B1)
+        PWM_CHANNEL(13, 1, 0, C, 2, COM1C1)
+        PWM_CHANNEL( 5, 3, 1, A, 0, COM3A1)
+        PWM_CHANNEL( 2, 3, 1, B, 1, COM3B1)
+        PWM_CHANNEL( 3, 3, 1, C, 2, COM3C1)
+        PWM_CHANNEL( 6, 4, 2, A, 0, COM4A1)
+        PWM_CHANNEL( 7, 4, 2, B, 1, COM4B1)
+        PWM_CHANNEL( 8, 4, 2, C, 2, COM4C1)
+        PWM_CHANNEL(46, 5, 3, A, 0, COM5A1)
+        PWM_CHANNEL(45, 5, 3, B, 1, COM5B1)
+        PWM_CHANNEL(44, 5, 3, C, 2, COM5C1)
+#undef PWM_CHANNEL
+        default:
+            return false;
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Dither interrupts
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(PWM_ACTUATOR_DITHER)
+
+/** Dithered actuator per timer channel (written with interrupts off). */
+static PwmActuator *volatile s_dithered[4][3];
+
+static inline void ditherTimer(uint8_t t) {
+    for (uint8_t c = 0; c < 3; c++) {
+        PwmActuator *a = s_dithered[t][c];
+        if (a != NULL) {
+            a->ditherStep();
+        }
+    }
+}
+
+ISR(TIMER1_OVF_vect) { ditherTimer(0); }
+ISR(TIMER3_OVF_vect) { ditherTimer(1); }
+ISR(TIMER4_OVF_vect) { ditherTimer(2); }
+ISR(TIMER5_OVF_vect) { ditherTimer(3); }
+
+#endif // PWM_ACTUATOR_DITHER
+
+#endif // PWM_ACTUATOR_HAS_TIMERS
+
+/** Accumulator value of one whole compare step. */
+static const uint8_t DITHER_ONE = 1U << PWM_ACTUATOR_DITHER_BITS;
+
 PwmActuator::PwmActuator(uint8_t pin)
-    : _pin(pin), _duty(0.0f) {}
+    : _pin(pin), _duty(0.0f), _ocr(NULL), _top(255), _compare(0),
+      _dither(false), _ditherBase(0), _ditherFrac(0), _ditherAcc(0) {}
 
 void PwmActuator::init() {
     pinMode(_pin, OUTPUT);
-    analogWrite(_pin, 0);
     _duty = 0.0f;
+    _compare = 0;
+    if (_ocr != NULL) {
+        setDuty(0.0f);  // analogWrite(0) would disconnect the timer output
+    } else {
+        analogWrite(_pin, 0);
+    }
+}
+
+bool PwmActuator::enableTimerPwm(uint32_t frequencyHz) {
+#if defined(PWM_ACTUATOR_HAS_TIMERS)
+    TimerChannel_t ch;
+    if (frequencyHz == 0 || frequencyHz > F_CPU / 4UL || !lookupChannel(_pin, &ch)) {
+        return false;
+    }
+
+    // Smallest prescaler whose TOP fits 16 bits: finest resolution.
+    uint32_t top = 0;
+    uint8_t cs = 0;
+    for (uint8_t i = 0; i < sizeof(PRESCALERS) / sizeof(PRESCALERS[0]); i++) {
+        top = (F_CPU / 2UL / PRESCALERS[i] + frequencyHz / 2) / frequencyHz;
+        if (top <= 0xFFFFUL) {
+            cs = PRESCALER_CS[i];
+            break;
+        }
+    }
+    if (cs == 0 || top < 2) {
+        return false;
+    }
+
+    uint8_t t = ch.timer;
+    if (s_timerTop[t] != 0 && (s_timerTop[t] != top || s_timerCs[t] != cs)) {
+        return false;  // Shared with an actuator at another frequency
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (s_timerTop[t] == 0) {
+            // Stop, switch to mode 10 and restart from BOTTOM.
+            *ch.tccrb = 0;
+            *ch.tccra = (uint8_t)(*ch.tccra & ~(_BV(WGM10) | _BV(WGM11))) | _BV(WGM11);
+            *ch.icr = (uint16_t)top;
+            *ch.ocr = 0;
+            *ch.tcnt = 0;
+            *ch.tccrb = (uint8_t)(_BV(WGM13) | cs);
+            s_timerTop[t] = (uint16_t)top;
+            s_timerCs[t] = cs;
+        }
+        *ch.tccra |= ch.com;  // Connect OCnx (non-inverting)
+    }
+
+    _ocr = ch.ocr;
+    _top = (uint16_t)top;
+    setDuty(_duty);
+    return true;
+#else
+    (void)frequencyHz;
+    return false;
+#endif
+}
+
+bool PwmActuator::isTimerPwm() const {
+    return _ocr != NULL;
+}
+
+bool PwmActuator::enableDither() {
+#if defined(PWM_ACTUATOR_HAS_TIMERS) && defined(PWM_ACTUATOR_DITHER)
+    TimerChannel_t ch;
+    if (!lookupChannel(_pin, &ch)) {
+        return false;
+    }
+    if (_dither) {
+        return true;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (_ocr == NULL) {
+            // Keep the core's 8-bit phase-correct mode (TOP = 255) but
+            // drive OCRnx directly: analogWrite(0/255) would disconnect it.
+            *ch.ocr = 0;
+            *ch.tccra |= ch.com;
+            _ocr = ch.ocr;
+            _top = 255;
+        }
+        _ditherAcc = 0;
+        _dither = true;
+        s_dithered[ch.timer][ch.index] = this;
+        *ch.timsk |= _BV(TOIE1);  // TOIEn is bit 0 on every 16-bit timer
+    }
+    setDuty(_duty);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool PwmActuator::isDithered() const {
+    return _dither;
+}
+
+void PwmActuator::ditherStep() {
+    uint16_t ocr = _ditherBase;
+    uint8_t acc = (uint8_t)(_ditherAcc + _ditherFrac);
+    if (acc >= DITHER_ONE) {
+        acc -= DITHER_ONE;
+        ocr++;
+    }
+    _ditherAcc = acc;
+    *_ocr = ocr;
 }
 
 void PwmActuator::setDuty(float duty) {
@@ -19,7 +228,22 @@ void PwmActuator::setDuty(float duty) {
     if (duty < 0.0f) duty = 0.0f;
     if (duty > 100.0f) duty = 100.0f;
     _duty = duty;
+    if (_dither) {
+        uint32_t level = (uint32_t)(_duty * _top * DITHER_ONE / 100.0f + 0.5f);
+        _compare = (uint16_t)(level >> PWM_ACTUATOR_DITHER_BITS);
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            _ditherBase = _compare;
+            _ditherFrac = (uint8_t)(level & (DITHER_ONE - 1));
+        }
+        return;  // Written to OCRnx by the next overflow interrupt
+    }
+    if (_ocr != NULL) {
+        _compare = (uint16_t)(_duty * _top / 100.0f + 0.5f);
+        *_ocr = _compare;  // No ISR touches this timer's TEMP register
+        return;
+    }
     uint8_t pwmVal = (uint8_t)(_duty * 255.0f / 100.0f);
+    _compare = pwmVal;
     analogWrite(_pin, pwmVal);
 }
 
@@ -30,3 +254,11 @@ float PwmActuator::getDuty() const {
 uint8_t PwmActuator::getRawPwm() const {
     return (uint8_t)(_duty * 255.0f / 100.0f);
 }
+
+uint16_t PwmActuator::getRawCompare() const {
+    return _compare;
+}
+
+uint16_t PwmActuator::getTop() const {
+    return _top;
+}
@@ -6,10 +6,50 @@
  * via PWM output. Accepts a duty cycle percentage (0-100%) and maps
  * it to 0-255 for analogWrite().
  *
+ * Timer PWM (optional, enableTimerPwm()):
+ *   On a 16-bit timer output pin (Mega: Timer1 D11–13, Timer3 D5/D2/D3,
+ *   Timer4 D6–8, Timer5 D46–44) the timer is switched to phase-correct
+ *   PWM with ICRn as TOP (mode 10), so the frequency is selectable and
+ *   the resolution is TOP steps instead of 256:
+ *
+ *     f = F_CPU / (2 · N · TOP),  N = smallest prescaler with TOP ≤ 65535
+ *
+ *     25 kHz → TOP 320   (≈ 8.3 bit, inaudible, 4-wire fan spec)
+ *      1 kHz → TOP 8000  (≈ 13 bit)
+ *     50 Hz  → TOP 20000 (N = 8, servo frame)
+ *
+ *   The OCRn register is cached, so setDuty() is a single 16-bit store;
+ *   in this mode OCRn is double-buffered (latched at TOP), so an update
+ *   never produces a runt pulse.
+ *
+ *   The frequency is per timer: the three channels of one timer share
+ *   TOP, and analogWrite() on the other channels no longer works (its
+ *   8-bit values become fractions of TOP). A second actuator on the same
+ *   timer must request the same frequency.
+ *
+ * Sigma-delta dither (optional, -DPWM_ACTUATOR_DITHER, enableDither()):
+ *   The duty is kept with PWM_ACTUATOR_DITHER_BITS extra fractional bits.
+ *   The timer's overflow interrupt (once per PWM period) adds the
+ *   fraction to an accumulator and writes OCRn = base + carry, so the
+ *   average over 2^bits periods is exact (first-order sigma-delta):
+ *
+ *     analogWrite() pins on Timer1/3/4/5: 256 · 16 = 4096 levels (12 bit)
+ *     at 490 Hz; the dither ripple lies at ≥ 30 Hz, far above the
+ *     thermal or mechanical bandwidth of a heater or fan.
+ *
+ *   The ISR costs ~2–3 µs per period: fine at 490 Hz–2 kHz, 5–8 % of the
+ *   CPU at 25 kHz. The flag defines TIMER1/3/4/5_OVF_vect (PressCapture
+ *   also uses the Timer4/5 vector: do not combine them on one timer
+ *   build). Call enableTimerPwm() before enableDither().
+ *
  * Usage:
  *   PwmActuator motor(6);  // PWM pin 6
  *   motor.init();
  *   motor.setDuty(75.0);   // 75% duty cycle
+ *
+ *   PwmActuator fan(3);    // OC3C
+ *   fan.init();
+ *   fan.enableTimerPwm(25000UL);   // Timer3, 25 kHz, 320 steps
  */
 
 #ifndef PWM_ACTUATOR_H
@@ -17,6 +57,18 @@
 
 #include <Arduino.h>
 
+/**
+ * @brief Fractional duty bits added by the dither (1..7).
+ * Override with -DPWM_ACTUATOR_DITHER_BITS=<n>.
+ */
+#ifndef PWM_ACTUATOR_DITHER_BITS
+#define PWM_ACTUATOR_DITHER_BITS 4
+#endif
+
+#if PWM_ACTUATOR_DITHER_BITS < 1 || PWM_ACTUATOR_DITHER_BITS > 7
+#error "PWM_ACTUATOR_DITHER_BITS must be 1..7"
+#endif
+
 /**
  * @class PwmActuator
  * @brief Controls an analog actuator via PWM duty cycle.
@@ -32,6 +84,44 @@ public:
     /** @brief Initialize the PWM pin as OUTPUT, set duty to 0. */
     void init();
 
+    /**
+     * @brief Drive the pin from its 16-bit timer at @p frequencyHz
+     *        (phase-correct PWM, call after init()).
+     *
+     * The current duty cycle is re-applied at the new resolution.
+     *
+     * @param frequencyHz PWM frequency, 1 Hz .. F_CPU / 4.
+     * @return true on success; false if the pin is not a Timer1/3/4/5
+     *         output, the frequency is out of range, or the timer already
+     *         runs at another frequency (analogWrite() stays in use).
+     */
+    bool enableTimerPwm(uint32_t frequencyHz);
+
+    /** @brief True when the pin is driven through its OCRn register. */
+    bool isTimerPwm() const;
+
+    /**
+     * @brief Dither the compare value from the timer overflow interrupt
+     *        (call after init() and any enableTimerPwm()).
+     *
+     * On an analogWrite() pin of Timer1/3/4/5 the core's 490 Hz 8-bit
+     * PWM is kept and OCRn is written directly from then on.
+     *
+     * @return false without -DPWM_ACTUATOR_DITHER or if the pin is not a
+     *         Timer1/3/4/5 output.
+     */
+    bool enableDither();
+
+    /** @brief True after a successful enableDither(). */
+    bool isDithered() const;
+
+    /**
+     * @brief Dither interrupt body: accumulate and write one period's OCRn.
+     *
+     * Called by the driver's overflow ISRs; not for application use.
+     */
+    void ditherStep();
+
     /**
      * @brief Set the duty cycle (0.0 to 100.0%).
      * @param duty Duty cycle percentage. Clamped to [0, 100].
@@ -44,9 +134,25 @@ public:
     /** @brief Get the current raw PWM value (0-255). */
     uint8_t getRawPwm() const;
 
+    /** @brief Timer PWM: compare value (0..getTop(), integer part when
+     *         dithered); else getRawPwm(). */
+    uint16_t getRawCompare() const;
+
+    /** @brief Counts per PWM half-period (255 with analogWrite()). */
+    uint16_t getTop() const;
+
 private:
     uint8_t _pin;
     float   _duty;
+    volatile uint16_t *_ocr;   ///< OCRnx of the pin (timer PWM), else NULL
+    uint16_t _top;             ///< ICRn (timer PWM) or 255
+    uint16_t _compare;         ///< Last value written to *_ocr
+
+    // ── Dither ──────────────────────────────────────────────────────
+    bool     _dither;                 ///< true after enableDither()
+    volatile uint16_t _ditherBase;    ///< Integer part of the compare value
+    volatile uint8_t  _ditherFrac;    ///< Fraction, 0 .. 2^bits - 1
+    uint8_t  _ditherAcc;              ///< Sigma-delta accumulator (ISR only)
 };
 
 #endif // PWM_ACTUATOR_H
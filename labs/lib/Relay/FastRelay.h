@@ -0,0 +1,67 @@
+/**
+ * @file FastRelay.h
+ * @brief Compile-Time-Pin Relay Driver
+ *
+ * Same interface as Relay, with the pin and the active level as
+ * template parameters, so each switch inlines to one FastPin<PIN>
+ * register access instead of a digitalWrite() call.
+ *
+ * Usage:
+ *   FastRelay<7> relay;          // pin 7, active-HIGH
+ *   FastRelay<7, false> relayLo; // active-LOW module
+ *   relay.init();
+ *   relay.turnOn();
+ */
+
+#ifndef FAST_RELAY_H
+#define FAST_RELAY_H
+
+#include <Arduino.h>
+#include "FastPin.h"
+
+/**
+ * @class FastRelay
+ * @brief Controls a relay module on a compile-time GPIO pin.
+ * @tparam PIN         GPIO pin connected to the relay control input.
+ * @tparam ACTIVE_HIGH True if relay activates on HIGH.
+ */
+template <uint8_t PIN, bool ACTIVE_HIGH = true>
+class FastRelay {
+public:
+    FastRelay() : _state(false) {}
+
+    /** @brief Initialize the relay pin as OUTPUT, set to OFF. */
+    void init() {
+        Pin::write(!ACTIVE_HIGH);  // Inactive level before enabling the driver
+        Pin::output();
+        _state = false;
+    }
+
+    /** @brief Activate the relay (close the circuit). */
+    void turnOn() { setState(true); }
+
+    /** @brief Deactivate the relay (open the circuit). */
+    void turnOff() { setState(false); }
+
+    /** @brief Toggle the relay state. */
+    void toggle() { setState(!_state); }
+
+    /**
+     * @brief Set relay state directly.
+     * @param on True to activate, false to deactivate.
+     */
+    void setState(bool on) {
+        _state = on;
+        Pin::write(on == ACTIVE_HIGH);
+    }
+
+    /** @brief Check if relay is currently activated. */
+    bool isOn() const { return _state; }
+
+private:
+    typedef FastPin<PIN> Pin;
+
+    bool _state;
+};
+
+#endif // FAST_RELAY_H
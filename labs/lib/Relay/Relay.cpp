@@ -6,7 +6,9 @@
 #include "Relay.h"
 
 Relay::Relay(uint8_t pin, bool activeHigh)
-    : _pin(pin), _activeHigh(activeHigh), _state(false) {}
+    : _pin(pin), _activeHigh(activeHigh), _state(false),
+      _proportional(false), _windowMs(0), _minOnMs(0), _minOffMs(0),
+      _demand(0.0f), _windowStartMs(0), _onMs(0), _carryMs(0) {}
 
 void Relay::init() {
     pinMode(_pin, OUTPUT);
@@ -14,13 +16,11 @@ void Relay::init() {
 }
 
 void Relay::turnOn() {
-    _state = true;
-    digitalWrite(_pin, _activeHigh ? HIGH : LOW);
+    setState(true);
 }
 
 void Relay::turnOff() {
-    _state = false;
-    digitalWrite(_pin, _activeHigh ? LOW : HIGH);
+    setState(false);
 }
 
 void Relay::toggle() {
@@ -29,10 +29,89 @@ void Relay::toggle() {
 }
 
 void Relay::setState(bool on) {
-    if (on) turnOn();
-    else turnOff();
+    _proportional = false;
+    drive(on);
 }
 
 bool Relay::isOn() const {
     return _state;
 }
+
+void Relay::drive(bool on) {
+    _state = on;
+    digitalWrite(_pin, (on == _activeHigh) ? HIGH : LOW);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Time-proportional mode
+// ──────────────────────────────────────────────────────────────────────────
+
+bool Relay::setTimeProportional(uint32_t windowMs, uint32_t minOnMs, uint32_t minOffMs) {
+    if (windowMs == 0 || minOnMs + minOffMs > windowMs) {
+        return false;
+    }
+    _windowMs = windowMs;
+    _minOnMs = minOnMs;
+    _minOffMs = minOffMs;
+    _demand = 0.0f;
+    _carryMs = 0;
+    _proportional = true;
+    startWindow(millis());
+    drive(false);
+    return true;
+}
+
+bool Relay::isTimeProportional() const {
+    return _proportional;
+}
+
+void Relay::setDemand(float percent) {
+    if (percent < 0.0f) percent = 0.0f;
+    if (percent > 100.0f) percent = 100.0f;
+    _demand = percent;
+}
+
+float Relay::getDemand() const {
+    return _demand;
+}
+
+uint32_t Relay::getWindowOnMs() const {
+    return _onMs;
+}
+
+void Relay::startWindow(uint32_t nowMs) {
+    _windowStartMs = nowMs;
+
+    int32_t window = (int32_t)_windowMs;
+    int32_t wanted = (int32_t)(_demand * (float)_windowMs / 100.0f + 0.5f) + _carryMs;
+    int32_t applied = wanted;
+    if (applied < (int32_t)_minOnMs) {
+        applied = 0;                      // Too short a pulse: owe it
+    } else if (applied > window - (int32_t)_minOffMs) {
+        applied = window;                 // Too short a gap: stay on
+    }
+
+    // The carry settles by itself at a steady demand; bounding it keeps a
+    // demand step from being followed by a long catch-up.
+    int32_t carry = wanted - applied;
+    if (carry > window) carry = window;
+    if (carry < -window) carry = -window;
+    _carryMs = carry;
+    _onMs = (uint32_t)applied;
+}
+
+bool Relay::update() {
+    if (!_proportional) {
+        return false;
+    }
+    uint32_t now = millis();
+    if ((uint32_t)(now - _windowStartMs) >= _windowMs) {
+        startWindow(now);
+    }
+    bool on = (uint32_t)(now - _windowStartMs) < _onMs;
+    if (on == _state) {
+        return false;
+    }
+    drive(on);
+    return true;
+}
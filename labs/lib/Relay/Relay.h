@@ -6,10 +6,30 @@
  * connected to a digital GPIO pin. Supports ON/OFF control with
  * state tracking and configurable active level (HIGH or LOW).
  *
+ * Time-proportional mode (optional, setTimeProportional()):
+ *   The relay becomes a slow-PWM actuator for a continuous 0–100 %
+ *   demand (e.g. PidController output). Each window of windowMs starts
+ *   ON for demand · windowMs / 100, then OFF:
+ *
+ *     demand 30 %, window 10 s:  ON 3 s ─┐             ┌─ ON 3 s ─┐
+ *                                        └── OFF 7 s ──┘          └──
+ *
+ *   Pulses shorter than minOnMs are skipped and gaps shorter than
+ *   minOffMs are filled (the relay stays on), protecting the contacts;
+ *   the on-time lost or gained is carried into the next windows, so the
+ *   average still follows the demand (5 % of a 10 s window with a 1 s
+ *   minimum: one 1 s pulse every second window). A new demand takes
+ *   effect at the next window. update() must be called at a rate that
+ *   matches the wanted timing resolution (e.g. every 100 ms).
+ *
  * Usage:
  *   Relay relay(7, true);  // pin 7, active-HIGH
  *   relay.init();
  *   relay.turnOn();
+ *
+ *   relay.setTimeProportional(10000, 1000, 1000);  // 10 s window, 1 s min
+ *   relay.setDemand(pidOutputPercent);
+ *   relay.update();        // periodically
  */
 
 #ifndef RELAY_H
@@ -43,7 +63,7 @@ public:
     void toggle();
 
     /**
-     * @brief Set relay state directly.
+     * @brief Set relay state directly (leaves time-proportional mode).
      * @param on True to activate, false to deactivate.
      */
     void setState(bool on);
@@ -51,10 +71,57 @@ public:
     /** @brief Check if relay is currently activated. */
     bool isOn() const;
 
+    /**
+     * @brief Switch to time-proportional output, demand 0 % (relay OFF).
+     * @param windowMs Cycle length (ms), e.g. 5000–20000.
+     * @param minOnMs  Shortest ON pulse (ms).
+     * @param minOffMs Shortest OFF gap (ms).
+     * @return false if the limits leave no room in the window
+     *         (minOnMs + minOffMs > windowMs or windowMs == 0).
+     */
+    bool setTimeProportional(uint32_t windowMs, uint32_t minOnMs, uint32_t minOffMs);
+
+    /** @brief True while in time-proportional mode. */
+    bool isTimeProportional() const;
+
+    /**
+     * @brief Set the time-proportional demand (applied from the next window).
+     * @param percent Demand, clamped to [0, 100].
+     */
+    void setDemand(float percent);
+
+    /** @brief Current time-proportional demand (%). */
+    float getDemand() const;
+
+    /** @brief ON time (ms) of the current window. */
+    uint32_t getWindowOnMs() const;
+
+    /**
+     * @brief Time-proportional mode: start windows and switch the output.
+     * @return true if the relay switched in this call.
+     */
+    bool update();
+
 private:
+    /** @brief Drive the pin without leaving time-proportional mode. */
+    void drive(bool on);
+
+    /** @brief Plan the ON time of a new window from the demand and carry. */
+    void startWindow(uint32_t nowMs);
+
     uint8_t _pin;
     bool    _activeHigh;
     bool    _state;
+
+    // ── Time-proportional mode ──────────────────────────────────────
+    bool     _proportional;   ///< true after setTimeProportional()
+    uint32_t _windowMs;       ///< Cycle length
+    uint32_t _minOnMs;        ///< Shortest ON pulse
+    uint32_t _minOffMs;       ///< Shortest OFF gap
+    float    _demand;         ///< Requested duty (%)
+    uint32_t _windowStartMs;  ///< millis() at the start of the window
+    uint32_t _onMs;           ///< ON time planned for this window
+    int32_t  _carryMs;        ///< Requested minus applied ON time so far
 };
 
 #endif // RELAY_H
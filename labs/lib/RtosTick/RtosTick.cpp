@@ -0,0 +1,100 @@
+/**
+ * @file RtosTick.cpp
+ * @brief FreeRTOS Tick Source Implementation (timer compare vector)
+ *
+ * Timer setup (n = RTOS_TICK_TIMER), as PcProfiler programs its timer:
+ *   TCCRnA = 0                     outputs disconnected
+ *   TCCRnB = WGMn2 | CSn1 | CSn0   CTC, TOP = OCRnA, ÷64 (4 µs)
+ *   OCRnA  = RTOS_TICK_MS × 250 − 1
+ *   TIMSKn = OCIEnA
+ *
+ * The vector is naked, like the port's WDT_vect: on entry the stack holds
+ * only the interrupted task's return address, which is what
+ * vPortYieldFromTick()'s portSAVE_CONTEXT expects. Before the call it
+ * writes 0 to WDTCSR through r16 (push/ldi/sts/pop leave SREG alone), so
+ * the watchdog interrupt the port enabled at scheduler start is switched
+ * off again on the first timer tick; at most one WDT tick (16 ms away)
+ * can precede it.
+ */
+
+#include "RtosTick.h"
+
+#if defined(RTOS_TICK_TIMER) && defined(__AVR__)
+
+#include <avr/interrupt.h>
+#include <avr/power.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Timer register selection
+// ──────────────────────────────────────────────────────────────────────────
+
+#define RT_REG2(prefix, n, suffix) prefix##n##suffix
+#define RT_REG(prefix, n, suffix)  RT_REG2(prefix, n, suffix)
+
+#define RT_TCCRA      RT_REG(TCCR, RTOS_TICK_TIMER, A)
+#define RT_TCCRB      RT_REG(TCCR, RTOS_TICK_TIMER, B)
+#define RT_TCNT       RT_REG(TCNT, RTOS_TICK_TIMER, )
+#define RT_OCRA       RT_REG(OCR, RTOS_TICK_TIMER, A)
+#define RT_TIMSK      RT_REG(TIMSK, RTOS_TICK_TIMER, )
+#define RT_TIFR       RT_REG(TIFR, RTOS_TICK_TIMER, )
+#define RT_COMPA_vect RT_REG(TIMER, RTOS_TICK_TIMER, _COMPA_vect)
+
+// Bit positions are the same in every 16-bit timer.
+#define RT_WGM2  WGM12   /**< CTC, TOP = OCRnA (WGMn3:0 = 0100). */
+#define RT_CS1   CS11    /**< Prescaler 64 = CS1 | CS0. */
+#define RT_CS0   CS10
+#define RT_OCIEA OCIE1A
+#define RT_OCFA  OCF1A
+
+/** @brief Compare value for RTOS_TICK_MS at prescaler 64. */
+static const uint32_t RT_TOP = F_CPU / 64UL / 1000UL * RTOS_TICK_MS - 1;
+static_assert(RT_TOP >= 1 && RT_TOP <= 0xFFFF, "RTOS_TICK_MS out of range at prescaler 64");
+
+/** The port's tick context switch (port.c; naked, returns with ret). */
+extern "C" void vPortYieldFromTick(void);
+
+// ──────────────────────────────────────────────────────────────────────────
+// Tick vector
+// ──────────────────────────────────────────────────────────────────────────
+
+ISR(RT_COMPA_vect, ISR_NAKED) {
+    asm volatile(
+        "push r16                    \n\t"
+        "ldi  r16, 0                 \n\t"
+        "sts  %[wdtcsr], r16         \n\t"
+        "pop  r16                    \n\t"
+        "call vPortYieldFromTick     \n\t"
+        "reti                        \n\t"
+        :
+        : [wdtcsr] "n"(_SFR_MEM_ADDR(WDTCSR)));
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+void rtosTickInit() {
+    cli();  // Until the scheduler restores the first task (its SREG has I set)
+#if RTOS_TICK_TIMER == 1
+    power_timer1_enable();
+#elif RTOS_TICK_TIMER == 3
+    power_timer3_enable();
+#elif RTOS_TICK_TIMER == 4
+    power_timer4_enable();
+#else
+    power_timer5_enable();
+#endif
+    RT_TCCRB = 0;
+    RT_TCCRA = 0;  // Outputs disconnected
+    RT_TCNT = 0;
+    RT_OCRA = (uint16_t)RT_TOP;
+    RT_TIFR = _BV(RT_OCFA);
+    RT_TIMSK = _BV(RT_OCIEA);
+    RT_TCCRB = _BV(RT_WGM2) | _BV(RT_CS1) | _BV(RT_CS0);
+}
+
+#else
+
+void rtosTickInit() {}
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file RtosTick.h
+ * @brief FreeRTOS Tick Source: the Watchdog (default) or a 16-bit Timer Compare
+ *
+ * feilipu/FreeRTOS ticks from the watchdog's interrupt: 62 Hz, 16 ms per
+ * tick on the RC oscillator (±10 %). That is the low-power choice (the CPU
+ * idles asleep for 16 ms between ticks) and stays the default. With
+ * -DRTOS_TICK_TIMER=<1|3|4|5> the tick comes instead from output compare A
+ * of that 16-bit timer in CTC mode, every RTOS_TICK_MS (default 1 ms) of
+ * the crystal:
+ *
+ *                          WDT (default)        -DRTOS_TICK_TIMER=n
+ *   configTICK_RATE_HZ     62                   1000 / RTOS_TICK_MS
+ *   portTICK_PERIOD_MS     16                   RTOS_TICK_MS
+ *   pdMS_TO_TICKS(10)      0                    10 / RTOS_TICK_MS
+ *   accuracy               RC, ±10 %            crystal
+ *   idle wake-ups          62 /s                1000 / RTOS_TICK_MS per s
+ *
+ * so vTaskDelay(), vTaskDelayUntil(), queue/semaphore/notification
+ * timeouts and software timers all resolve RTOS_TICK_MS.
+ *
+ * How it works without patching the library: the port's own tick vector
+ * is a naked WDT_vect that calls vPortYieldFromTick() (save context,
+ * xTaskIncrementTick(), switch, restore) and returns with reti. This
+ * module installs the same two instructions on TIMERn_COMPA_vect. The
+ * port still enables the watchdog interrupt when the scheduler starts, so
+ * the timer vector first clears WDTCSR (WDIE; WDE and the prescaler are
+ * change-protected and unaffected, so the watchdog stays available as a
+ * reset watchdog) and the watchdog never ticks again. The kernel was
+ * compiled without reference to the tick rate; only the application's
+ * conversions are, which is why the rate macros are replaced below, after
+ * the kernel headers.
+ *
+ * Include this header instead of <Arduino_FreeRTOS.h> wherever ticks are
+ * converted to or from milliseconds (pdMS_TO_TICKS, portTICK_PERIOD_MS,
+ * configTICK_RATE_HZ); RtosTime.h includes it.
+ *
+ * The timer is taken over entirely: no PWM on its pins (they stay usable
+ * as GPIO), no other user of it (PwmActuator on Timer3, PressCapture or
+ * LatencyLoopback on Timer4/5, PcProfiler), and idleSleepInit() never
+ * gates it. Every lab leaves at least one free: lab2_2 Timer3 (PressCapture
+ * takes 5), lab3_x any, lab4/5_1/5_2 Timer1 (Timer3 drives D3).
+ *
+ * Usage:
+ *   void labSetup() {
+ *       ...                       // create tasks, queues
+ *       rtosTickInit();           // last: interrupts stay off until the scheduler runs
+ *   }
+ */
+
+#ifndef RTOS_TICK_H
+#define RTOS_TICK_H
+
+#include <Arduino_FreeRTOS.h>
+
+#if defined(RTOS_TICK_TIMER)
+
+#if RTOS_TICK_TIMER != 1 && RTOS_TICK_TIMER != 3 && RTOS_TICK_TIMER != 4 && RTOS_TICK_TIMER != 5
+#error "RTOS_TICK_TIMER must be 1, 3, 4 or 5"
+#endif
+
+/** @brief Tick period in ms (a divisor of 1000, so the rate is exact). */
+#ifndef RTOS_TICK_MS
+#define RTOS_TICK_MS 1
+#endif
+
+#if RTOS_TICK_MS < 1 || RTOS_TICK_MS > 250 || (1000 % RTOS_TICK_MS) != 0
+#error "RTOS_TICK_MS must divide 1000 (1, 2, 4, 5, 8, 10, ... 250)"
+#endif
+
+#undef configTICK_RATE_HZ
+#define configTICK_RATE_HZ ((TickType_t)(1000U / RTOS_TICK_MS))
+
+#undef portTICK_PERIOD_MS
+#define portTICK_PERIOD_MS ((TickType_t)RTOS_TICK_MS)
+
+// Divide in 32 bits: (ms × rate) overflows a 16-bit TickType_t from 66 ms on.
+#undef pdMS_TO_TICKS
+#define pdMS_TO_TICKS(ms) ((TickType_t)((uint32_t)(ms) / RTOS_TICK_MS))
+
+#endif // RTOS_TICK_TIMER
+
+/**
+ * @brief Move the kernel tick to the -DRTOS_TICK_TIMER compare (no-op on the WDT tick).
+ *
+ * Call as the last statement of setup(): it leaves interrupts disabled,
+ * so the first compare is taken only once the scheduler has restored the
+ * first task, never before there is a task context to save.
+ */
+void rtosTickInit();
+
+#endif // RTOS_TICK_H
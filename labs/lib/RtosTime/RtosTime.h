@@ -0,0 +1,235 @@
+/**
+ * @file RtosTime.h
+ * @brief Millisecond Task Periods and Timeouts on Any FreeRTOS Tick
+ *
+ * feilipu/FreeRTOS ticks from the watchdog by default: configTICK_RATE_HZ
+ * = 62, portTICK_PERIOD_MS = 16. -DRTOS_TICK_TIMER moves the tick to a
+ * 1 ms timer compare (RtosTick.h, included here), which removes the
+ * coarseness in the kernel itself; the helpers below keep periods and
+ * timeouts right on either tick, and matter most on the WDT one:
+ *
+ *   - pdMS_TO_TICKS() truncates: pdMS_TO_TICKS(10) is 0, so a "10 ms"
+ *     timeout polls and a "10 ms" delay only yields. rtosMsToTicks()
+ *     rounds up, so any non-zero time actually blocks (to a tick edge).
+ *
+ *   - vTaskDelayUntil() periods are whole ticks, on the WDT of an RC
+ *     oscillator that is only accurate to ~10 %: 250 ms becomes 15 ticks
+ *     ≈ 240 ms, and a 50 ms period 3 ticks ≈ 48 ms. RtosPeriod keeps the
+ *     deadline in millis() (crystal time) and sleeps the ticks up to it,
+ *     again if a tick edge woke it short of the deadline, so each wake is
+ *     at or up to one tick (16 ms, or 1 ms on the timer tick) after the
+ *     deadline and the average rate is exact; the error never accumulates.
+ *
+ * Time differences inside a task (integration dt) should likewise come
+ * from millis()/micros() rather than tick counts.
+ *
+ * RtosPeriod also keeps each task's timing record: release and completion
+ * of every job, worst response time and missed deadlines, with an
+ * optional hook for a job that missed. TaskMonitor prints the records of
+ * the tasks that register theirs.
+ *
+ * Usage:
+ *   RtosPeriod period(TASK_DISPLAY_PERIOD_MS);   // in the task, before the loop
+ *   period.setOverrunHook(onLate, &s_skipPlot);  // optional
+ *   for (;;) {
+ *       period.wait();
+ *       ...
+ *       period.waitOffset(20);                     // optional: 20 ms into the period
+ *   }
+ *   xSemaphoreTake(xMutex, rtosMsToTicks(10));     // 1 tick, not 0
+ */
+
+#ifndef RTOS_TIME_H
+#define RTOS_TIME_H
+
+#include <Arduino.h>
+#include "RtosTick.h"
+#include <string.h>
+
+/**
+ * @brief ms rounded up to whole ticks (0 stays 0).
+ *
+ * The current tick is already partly over, so the block lasts between
+ * (n - 1) and n ticks; add 1 where the full time must pass (the
+ * DhtSensorRtos rule).
+ */
+static inline TickType_t rtosMsToTicks(uint32_t ms) {
+    return (TickType_t)((ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+}
+
+/**
+ * @brief Called by RtosPeriod::wait() when the job just finished missed its deadline.
+ *
+ * Runs in the task, before it sleeps: the place to shed load for the
+ * next job (skip a report, a slow LCD page). Keep it short.
+ *
+ * @param context Pointer given to setOverrunHook().
+ * @param lateMs  How far past the deadline the job completed.
+ */
+typedef void (*RtosOverrunHook)(void *context, uint32_t lateMs);
+
+/**
+ * @struct RtosPeriodStats
+ * @brief Timing record of one periodic task (times in ms, millis() base).
+ */
+typedef struct {
+    uint32_t periodMs;         ///< Period = relative deadline
+    uint32_t releaseMs;        ///< Scheduled release of the current job
+    uint32_t completionMs;     ///< When the previous job completed
+    uint32_t lastResponseMs;   ///< Release to completion, previous job
+    uint32_t worstResponseMs;  ///< Largest response time since start
+    uint32_t jobs;             ///< Jobs completed
+    uint32_t misses;           ///< Jobs that completed after their deadline
+    uint32_t overruns;         ///< Releases dropped (a whole period late)
+} RtosPeriodStats;
+
+/**
+ * @class RtosPeriod
+ * @brief Drift-free periodic wake-up in milliseconds (vTaskDelayUntil() replacement)
+ *        with deadline-miss accounting.
+ *
+ * Each pass of the task loop is one job: it is released at a multiple of
+ * the period and completes when the loop calls wait() again. Its deadline
+ * is the next release. The response time counts from the scheduled
+ * release, so it includes the wake-up latency (up to one tick) and any
+ * preemption, which is what the deadline is about.
+ */
+class RtosPeriod {
+public:
+    /** @param periodMs Period; the first wait() returns one period from now. */
+    explicit RtosPeriod(uint32_t periodMs)
+        : _hook(NULL), _hookContext(NULL), _lastWakeMs(millis()), _started(false) {
+        memset(&_stats, 0, sizeof(_stats));
+        _stats.periodMs = periodMs;
+        _stats.releaseMs = _lastWakeMs;
+        _stats.completionMs = _lastWakeMs;
+    }
+
+    /**
+     * @brief Complete the current job and block until the next release.
+     *
+     * A job that finishes after its deadline is counted as a miss and
+     * reported to the overrun hook (not on the first call, which ends no
+     * job). Returns at once if the release has passed; one a whole
+     * period or more late is dropped instead of running the missed jobs
+     * back to back, and counts an overrun.
+     *
+     * @return Milliseconds since the previous wake-up (for dt).
+     */
+    uint32_t wait() {
+        uint32_t now = complete(millis());
+        uint32_t release = _stats.releaseMs + _stats.periodMs;
+
+        int32_t remaining = (int32_t)(release - now);
+        if (remaining > 0) {
+            // n ticks block between (n - 1) and n ticks: sleep on until the
+            // release has passed, so the job never starts before it.
+            do {
+                vTaskDelay(rtosMsToTicks((uint32_t)remaining));
+                remaining = (int32_t)(release - millis());
+            } while (remaining > 0);
+        } else if ((uint32_t)(-remaining) >= _stats.periodMs) {
+            release = now;
+            _stats.overruns++;
+        }
+        _stats.releaseMs = release;
+
+        now = millis();
+        uint32_t elapsed = now - _lastWakeMs;
+        _lastWakeMs = now;
+        return elapsed;
+    }
+
+    /**
+     * @brief Complete the current job; the next one was released at
+     *        @p releaseMs by an external trigger (a sync pulse) instead
+     *        of the clock.
+     *
+     * Accounts the job as wait() does and moves the release grid to the
+     * trigger, without sleeping; waitOffset() then counts from it.
+     *
+     * @return Milliseconds since the previous wake-up (for dt).
+     */
+    uint32_t trigger(uint32_t releaseMs) {
+        uint32_t now = complete(millis());
+        _stats.releaseMs = releaseMs;
+        uint32_t elapsed = now - _lastWakeMs;
+        _lastWakeMs = now;
+        return elapsed;
+    }
+
+    /**
+     * @brief Block until @p offsetMs after the current release, never later.
+     *
+     * For work placed inside the period (AcquisitionScheduler requests).
+     * Sleeps whole ticks rounded down, so it wakes up to one tick early
+     * but not late; returns at once if that time has passed. Ends no job.
+     */
+    void waitOffset(uint32_t offsetMs) {
+        int32_t remaining = (int32_t)(_stats.releaseMs + offsetMs - millis());
+        if (remaining >= (int32_t)portTICK_PERIOD_MS) {
+            // n ticks block between (n - 1) and n ticks: not past the target.
+            vTaskDelay((TickType_t)((uint32_t)remaining / portTICK_PERIOD_MS));
+        }
+    }
+
+    /**
+     * @brief Call hook(context, lateMs) from wait() after each missed deadline.
+     * @param hook NULL to remove.
+     */
+    void setOverrunHook(RtosOverrunHook hook, void *context = NULL) {
+        _hook = hook;
+        _hookContext = context;
+    }
+
+    /**
+     * @brief Timing record (see RtosPeriodStats).
+     *
+     * Written by the owning task only; another task reading it should
+     * suspend the scheduler around the copy (TaskMonitor does).
+     */
+    const RtosPeriodStats &stats() const { return _stats; }
+
+    /** @brief Jobs that completed after their deadline. */
+    uint32_t misses() const { return _stats.misses; }
+
+    /** @brief Times wait() was called a whole period late. */
+    uint32_t overruns() const { return _stats.overruns; }
+
+    /** @brief Configured period. */
+    uint32_t periodMs() const { return _stats.periodMs; }
+
+private:
+    /** @brief End the current job at @p now (none on the first call); @return now, after the hook. */
+    uint32_t complete(uint32_t now) {
+        if (_started) {
+            // Never negative, even for a release set ahead of now (trigger()).
+            int32_t sinceRelease = (int32_t)(now - _stats.releaseMs);
+            uint32_t response = (sinceRelease > 0) ? (uint32_t)sinceRelease : 0;
+            _stats.completionMs = now;
+            _stats.lastResponseMs = response;
+            if (response > _stats.worstResponseMs) {
+                _stats.worstResponseMs = response;
+            }
+            _stats.jobs++;
+            int32_t late = (int32_t)(now - (_stats.releaseMs + _stats.periodMs));
+            if (late > 0) {
+                _stats.misses++;
+                if (_hook != NULL) {
+                    _hook(_hookContext, (uint32_t)late);
+                    now = millis();
+                }
+            }
+        }
+        _started = true;
+        return now;
+    }
+
+    RtosPeriodStats _stats;
+    RtosOverrunHook _hook;
+    void           *_hookContext;
+    uint32_t        _lastWakeMs;
+    bool            _started;
+};
+
+#endif // RTOS_TIME_H
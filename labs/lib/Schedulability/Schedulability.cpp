@@ -0,0 +1,247 @@
+/**
+ * @file Schedulability.cpp
+ * @brief Worst-Case Response-Time Analysis Implementation
+ *
+ * Implements:
+ * - Preemptive fixed-priority response-time iteration, per task
+ * - The cooperative (earliest release first) bound: longest busy period,
+ *   then the largest backlog over its release instants
+ * - The Liu–Layland bound (table, no floating point) and the report
+ */
+
+#include "Schedulability.h"
+#include "FlashString.h"
+#include <stdio.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Internal helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+/** Iterates stop past this (µs, about 35 min): the set is overloaded. */
+static const uint64_t HORIZON_US = 0x7FFFFFFFUL;
+
+/** n(2^(1/n) − 1) in 0.1 %, n = 1..10; the limit ln 2 beyond. */
+static const uint16_t LIU_LAYLAND_PERMILLE[] = {
+    1000, 828, 780, 757, 743, 735, 729, 724, 721, 718
+};
+
+static inline uint32_t deadlineOf(const SchedTask &task) {
+    return task.deadlineUs != 0 ? task.deadlineUs : task.periodUs;
+}
+
+static inline uint64_t ceilDiv(uint64_t a, uint32_t b) {
+    return (a + b - 1) / b;
+}
+
+/**
+ * Preemptive fixed priority, arbitrary deadlines (Lehoczky): job q of
+ * the level-i busy window ends at w(q) = (q + 1)·C + B + Σ_hp ceil(w / Tj)·Cj
+ * and responds in w(q) − q·T; the window closes once w(q) <= (q + 1)·T.
+ * With D <= T that is the one job q = 0.
+ */
+static uint32_t responsePreemptive(const SchedTask *tasks, uint8_t count, uint8_t i) {
+    const SchedTask &task = tasks[i];
+    uint32_t deadline = deadlineOf(task);
+    if (task.periodUs == 0) {
+        return SCHED_UNBOUNDED;
+    }
+
+    uint64_t worst = 0;
+    uint64_t window = 0;
+    for (uint16_t q = 0; q < SCHED_MAX_STEPS; q++) {
+        uint64_t release = (uint64_t)q * task.periodUs;
+        uint64_t base = (uint64_t)(q + 1) * task.wcetUs + task.blockingUs;
+        uint64_t limit = release + deadline;
+        if (window < base) {
+            window = base;
+        }
+        for (;;) {
+            uint64_t next = base;
+            for (uint8_t j = 0; j < count; j++) {
+                if (j == i || tasks[j].priority < task.priority) {
+                    continue;
+                }
+                if (tasks[j].periodUs == 0) {
+                    return SCHED_UNBOUNDED;
+                }
+                next += ceilDiv(window, tasks[j].periodUs) * tasks[j].wcetUs;
+            }
+            if (next > limit) {
+                return SCHED_UNBOUNDED;
+            }
+            if (next == window) {
+                break;
+            }
+            window = next;
+        }
+        if (window - release > worst) {
+            worst = window - release;
+        }
+        if (window <= release + task.periodUs) {
+            return (uint32_t)worst;
+        }
+    }
+    return SCHED_UNBOUNDED;
+}
+
+/**
+ * Cooperative, earliest release first: the same bound for every task,
+ * the largest backlog Σ_j (floor(Δ / Tj) + 1) · Cj − Δ at a release
+ * instant Δ of the longest busy period.
+ */
+static uint32_t responseCooperative(const SchedTask *tasks, uint8_t count) {
+    uint64_t busy = 0;
+    for (uint8_t j = 0; j < count; j++) {
+        if (tasks[j].periodUs == 0) {
+            return SCHED_UNBOUNDED;
+        }
+        busy += tasks[j].wcetUs;
+    }
+
+    // Longest busy period L = Σ ceil(L / Tj) · Cj (synchronous release).
+    for (;;) {
+        uint64_t next = 0;
+        for (uint8_t j = 0; j < count; j++) {
+            next += ceilDiv(busy, tasks[j].periodUs) * tasks[j].wcetUs;
+        }
+        if (next > HORIZON_US) {
+            return SCHED_UNBOUNDED;
+        }
+        if (next == busy) {
+            break;
+        }
+        busy = next;
+    }
+
+    // Walk the release instants in order; work is the demand released
+    // in [0, delta]. Δ = 0 releases one job of every task.
+    uint64_t work = 0;
+    for (uint8_t j = 0; j < count; j++) {
+        work += tasks[j].wcetUs;
+    }
+    uint64_t worst = work;
+    uint64_t delta = 0;
+    for (uint16_t step = 0; step < SCHED_MAX_STEPS; step++) {
+        uint64_t nextDelta = HORIZON_US + 1;
+        for (uint8_t j = 0; j < count; j++) {
+            uint64_t release = (delta / tasks[j].periodUs + 1) * tasks[j].periodUs;
+            if (release < nextDelta) {
+                nextDelta = release;
+            }
+        }
+        if (nextDelta >= busy) {
+            return (uint32_t)worst;
+        }
+        delta = nextDelta;
+        for (uint8_t j = 0; j < count; j++) {
+            if (delta % tasks[j].periodUs == 0) {
+                work += tasks[j].wcetUs;
+            }
+        }
+        if (work > delta && work - delta > worst) {
+            worst = work - delta;
+        }
+    }
+    // Too many instants to walk: every job still ends within L.
+    return (uint32_t)busy;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Analysis
+// ──────────────────────────────────────────────────────────────────────────
+
+uint16_t schedLiuLaylandPermille(uint8_t n) {
+    if (n == 0) {
+        return 0;
+    }
+    const uint8_t rows = sizeof(LIU_LAYLAND_PERMILLE) / sizeof(LIU_LAYLAND_PERMILLE[0]);
+    return n <= rows ? LIU_LAYLAND_PERMILLE[n - 1] : 693;
+}
+
+bool schedAnalyze(const SchedTask *tasks, uint8_t count, SchedPolicy policy,
+                  SchedResult *results, SchedSummary *summary) {
+    summary->policy = policy;
+    summary->taskCount = count;
+    summary->missCount = 0;
+    summary->boundPermille = 0;
+
+    uint64_t permille = 0;
+    bool implicitDeadlines = true;
+    for (uint8_t i = 0; i < count; i++) {
+        if (tasks[i].periodUs == 0) {
+            permille = 0xFFFF;
+            implicitDeadlines = false;
+            break;
+        }
+        permille += ((uint64_t)tasks[i].wcetUs * 1000 + tasks[i].periodUs / 2) / tasks[i].periodUs;
+        if (deadlineOf(tasks[i]) != tasks[i].periodUs) {
+            implicitDeadlines = false;
+        }
+    }
+    summary->utilizationPermille = permille > 0xFFFF ? 0xFFFF : (uint16_t)permille;
+    if (policy == SCHED_PREEMPTIVE_FP && implicitDeadlines) {
+        summary->boundPermille = schedLiuLaylandPermille(count);
+    }
+
+    uint32_t shared = policy == SCHED_COOPERATIVE_FIFO ? responseCooperative(tasks, count) : 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t response = policy == SCHED_COOPERATIVE_FIFO ? shared
+                                                             : responsePreemptive(tasks, count, i);
+        if (response != SCHED_UNBOUNDED && response > deadlineOf(tasks[i])) {
+            response = SCHED_UNBOUNDED;
+        }
+        results[i].responseUs = response;
+        results[i].schedulable = response != SCHED_UNBOUNDED;
+        if (!results[i].schedulable) {
+            summary->missCount++;
+        }
+    }
+    summary->schedulable = summary->missCount == 0;
+    return summary->schedulable;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Report
+// ──────────────────────────────────────────────────────────────────────────
+
+void schedPrintSummary(const char *title, const SchedSummary *summary) {
+    const char *policy = summary->policy == SCHED_COOPERATIVE_FIFO
+                             ? "cooperative, earliest release first"
+                             : "preemptive, fixed priority";
+    FLASH_PRINTF("[SCHED] %s (%s): U %u.%u %%", title, policy,
+                 (unsigned)(summary->utilizationPermille / 10),
+                 (unsigned)(summary->utilizationPermille % 10));
+    if (summary->boundPermille != 0) {
+        FLASH_PRINTF(", RM bound %u.%u %%", (unsigned)(summary->boundPermille / 10),
+                     (unsigned)(summary->boundPermille % 10));
+    }
+    if (summary->schedulable) {
+        FLASH_PRINTF(", %u tasks schedulable\r\n", (unsigned)summary->taskCount);
+    } else {
+        FLASH_PRINTF(", %u of %u tasks can miss\r\n", (unsigned)summary->missCount,
+                     (unsigned)summary->taskCount);
+    }
+}
+
+void schedPrint(const char *title, const SchedTask *tasks,
+                const SchedResult *results, const SchedSummary *summary) {
+    schedPrintSummary(title, summary);
+    FLASH_PRINTF("[SCHED] task          T ms     D ms     C us      R us\r\n");
+    for (uint8_t i = 0; i < summary->taskCount; i++) {
+        FLASH_PRINTF("[SCHED] %-10.10s %7lu  %7lu  %7lu  ", tasks[i].name,
+                     (unsigned long)(tasks[i].periodUs / 1000),
+                     (unsigned long)(deadlineOf(tasks[i]) / 1000),
+                     (unsigned long)tasks[i].wcetUs);
+        if (results[i].schedulable) {
+            FLASH_PRINTF("%8lu  ok\r\n", (unsigned long)results[i].responseUs);
+        } else {
+            FLASH_PRINTF("     >D   MISS\r\n");
+        }
+    }
+    for (uint8_t i = 0; i < summary->taskCount; i++) {
+        if (!results[i].schedulable) {
+            FLASH_PRINTF("[ERROR] %s can miss its %lu ms deadline\r\n", tasks[i].name,
+                         (unsigned long)(deadlineOf(tasks[i]) / 1000));
+        }
+    }
+}
@@ -0,0 +1,161 @@
+/**
+ * @file Schedulability.h
+ * @brief Worst-Case Response-Time Analysis for a Lab's Task Set
+ *
+ * The labs pick their periods and priorities by hand and find an
+ * overload only when a deadline is missed on the bench. This library
+ * checks a task table against its execution budgets before the first
+ * job runs, and again later with measured execution times, and prints
+ * the utilization and the worst-case response bound of every task:
+ *
+ *   [SCHED] lab 2.1 (cooperative, earliest release first): U 8.6 %, 3 tasks schedulable
+ *   [SCHED] task          T ms     D ms     C us      R us
+ *   [SCHED] Task1           10      800      200    600500  ok
+ *   [SCHED] Task2           50      800      300    600500  ok
+ *   [SCHED] Task3        10000    10000   600000    600500  ok
+ *
+ * Two dispatch policies are covered, the two this repository runs:
+ *
+ *   SCHED_PREEMPTIVE_FP   FreeRTOS: the highest-priority ready task
+ *       runs, preempting lower ones. Response-time analysis (Joseph &
+ *       Pandya; Audsley et al.):
+ *           R = C + B + Σ_{j ≠ i, Pj >= Pi} ceil(R / Tj) · Cj
+ *       iterated to its fixed point. Tasks of equal priority interfere
+ *       with each other both ways (round-robin or FIFO within a level).
+ *       B is the longest time a lower-priority task can hold a resource
+ *       the task needs (one mutex section under priority inheritance).
+ *       A deadline beyond the period is met by every job of the level-i
+ *       busy window (Lehoczky), so queued work can catch up.
+ *       When every deadline equals its period the Liu–Layland bound
+ *       n(2^(1/n) − 1) is printed too, for reference: below it a
+ *       rate-monotonic set is schedulable however the RTA comes out.
+ *
+ *   SCHED_COOPERATIVE_FIFO   TaskScheduler: each job runs to completion
+ *       and the due task with the earliest release goes next. A job
+ *       waits for all work released up to and including its own
+ *       release, so for every task
+ *           R = max_{Δ ∈ [0, L)} ( Σ_j (floor(Δ / Tj) + 1) · Cj − Δ )
+ *       over the release instants Δ of the longest busy period L
+ *       (L = Σ_j ceil(L / Tj) · Cj). One long job delays every task;
+ *       priorities are ignored.
+ *
+ * Periods of sporadic tasks (event- or queue-driven) are their least
+ * inter-arrival times. Interrupts and the kernel tick are not modelled
+ * implicitly: list them as tasks of the highest priority (preemptive)
+ * with their rate and handler time when they matter.
+ *
+ * All times are µs; the analysis uses integers only (64-bit sums) and
+ * runs at boot or from a console command, never in a hot path.
+ *
+ * Usage:
+ *   static const SchedTask SET[] = {
+ *       // name, period, deadline (0 = period), WCET, blocking, priority
+ *       { "Acquire",  50000, 0,  4000, 200, 3 },
+ *       { "Display", 250000, 0, 12000,   0, 1 },
+ *   };
+ *   SchedResult results[2];
+ *   SchedSummary summary;
+ *   if (!schedAnalyze(SET, 2, SCHED_PREEMPTIVE_FP, results, &summary)) {
+ *       schedPrint("lab", SET, results, &summary);   // names the misses
+ *   }
+ */
+
+#ifndef SCHEDULABILITY_H
+#define SCHEDULABILITY_H
+
+#include <stdint.h>
+
+/** @brief Response bound of a task that can miss its deadline. */
+#define SCHED_UNBOUNDED 0xFFFFFFFFUL
+
+/** @brief Release instants (cooperative) or busy-window jobs (preemptive) examined. */
+#ifndef SCHED_MAX_STEPS
+#define SCHED_MAX_STEPS 2048
+#endif
+
+/**
+ * @enum SchedPolicy
+ * @brief How the analysed tasks are dispatched.
+ */
+enum SchedPolicy {
+    SCHED_PREEMPTIVE_FP,     ///< Fixed priorities, preemptive (FreeRTOS)
+    SCHED_COOPERATIVE_FIFO   ///< Run to completion, earliest release first (TaskScheduler)
+};
+
+/**
+ * @struct SchedTask
+ * @brief One task of the analysed set.
+ */
+struct SchedTask {
+    const char *name;     ///< Printed in the table (up to 10 characters shown)
+    uint32_t periodUs;    ///< Period, or least inter-arrival time
+    uint32_t deadlineUs;  ///< Relative deadline, 0 = the period
+    uint32_t wcetUs;      ///< Worst-case execution time per job
+    uint32_t blockingUs;  ///< Longest lower-priority resource hold (preemptive only)
+    uint8_t  priority;    ///< Higher runs first (preemptive only)
+};
+
+/**
+ * @struct SchedResult
+ * @brief Analysis outcome of one task.
+ */
+struct SchedResult {
+    uint32_t responseUs;  ///< Worst-case response bound, SCHED_UNBOUNDED if it exceeds the deadline
+    bool     schedulable; ///< responseUs <= deadline
+};
+
+/**
+ * @struct SchedSummary
+ * @brief Outcome of the whole set.
+ */
+struct SchedSummary {
+    SchedPolicy policy;
+    uint16_t utilizationPermille;  ///< Σ C / T in 0.1 % (saturates at 65535)
+    uint16_t boundPermille;        ///< Liu–Layland bound, 0 unless preemptive with D = T
+    uint8_t  taskCount;
+    uint8_t  missCount;            ///< Tasks whose bound exceeds the deadline
+    bool     schedulable;          ///< missCount == 0
+};
+
+/**
+ * @brief Analyse a task set.
+ *
+ * A task with a zero period or a WCET over its deadline is reported as
+ * a miss. The cooperative analysis gives up after SCHED_MAX_STEPS
+ * release instants and falls back to the busy-period length, which is
+ * still a valid (looser) bound; the preemptive one reports a miss after
+ * SCHED_MAX_STEPS jobs in one busy window.
+ *
+ * @param tasks   Task set (count entries).
+ * @param count   Number of tasks (1..255).
+ * @param policy  Dispatch policy.
+ * @param results count entries, filled in task order.
+ * @param summary Filled with the set's outcome.
+ * @return true if every task meets its deadline.
+ */
+bool schedAnalyze(const SchedTask *tasks, uint8_t count, SchedPolicy policy,
+                  SchedResult *results, SchedSummary *summary);
+
+/**
+ * @brief Liu–Layland utilization bound n(2^(1/n) − 1) in 0.1 %.
+ *
+ * @param n Number of tasks (0 gives 0).
+ */
+uint16_t schedLiuLaylandPermille(uint8_t n);
+
+/**
+ * @brief Print the headline only (policy, utilization, verdict).
+ *
+ * One line when the set is schedulable, e.g. for a quiet boot check.
+ */
+void schedPrintSummary(const char *title, const SchedSummary *summary);
+
+/**
+ * @brief Print the headline, one line per task and the verdict.
+ *
+ * Tasks that can miss their deadline get an [ERROR] line each.
+ */
+void schedPrint(const char *title, const SchedTask *tasks,
+                const SchedResult *results, const SchedSummary *summary);
+
+#endif // SCHEDULABILITY_H
@@ -0,0 +1,443 @@
+/**
+ * @file SdCard.cpp
+ * @brief SD Card SPI-Mode Block Access Implementation
+ *
+ * Implements:
+ * - Polled hardware SPI (SPCR/SPSR/SPDR), 250 kHz for the power-up
+ *   sequence, 8 MHz after it
+ * - The SPI-mode command set the logger needs: CMD0, CMD8, CMD55 /
+ *   ACMD41, CMD58, CMD16, CMD17, ACMD23, CMD25
+ * - A read-only FAT32 walk to a contiguous root-directory file
+ */
+
+#include "SdCard.h"
+
+#include <ctype.h>
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Commands and tokens (SD Physical Layer Simplified Specification, ch. 7)
+// ──────────────────────────────────────────────────────────────────────────
+
+static const uint8_t CMD_GO_IDLE = 0;
+static const uint8_t CMD_SEND_IF_COND = 8;
+static const uint8_t CMD_SET_BLOCKLEN = 16;
+static const uint8_t CMD_READ_SINGLE = 17;
+static const uint8_t CMD_WRITE_MULTIPLE = 25;
+static const uint8_t CMD_APP = 55;
+static const uint8_t CMD_READ_OCR = 58;
+static const uint8_t ACMD_SET_WR_BLK_ERASE = 23;
+static const uint8_t ACMD_SEND_OP_COND = 41;
+
+static const uint8_t R1_IDLE = 0x01;
+static const uint8_t R1_ILLEGAL_COMMAND = 0x04;
+static const uint8_t TOKEN_START_BLOCK = 0xFE;
+static const uint8_t TOKEN_MULTI_WRITE = 0xFC;
+static const uint8_t TOKEN_STOP_TRAN = 0xFD;
+static const uint8_t DATA_ACCEPTED = 0x05;
+
+static const uint16_t INIT_TIMEOUT_MS = 1000;
+static const uint16_t READ_TIMEOUT_MS = 300;
+
+static uint8_t s_csPin = 53;
+static SdCardType s_type = SD_CARD_NONE;
+
+// ──────────────────────────────────────────────────────────────────────────
+// SPI
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(__AVR__)
+
+static inline uint8_t spiTransfer(uint8_t out) {
+    SPDR = out;
+    while (!(SPSR & (1 << SPIF))) {
+    }
+    return SPDR;
+}
+
+static void spiBegin(bool fast) {
+    pinMode(53, OUTPUT);   // SS: an input pulled low would drop the SPI out of master mode
+    pinMode(51, OUTPUT);   // MOSI
+    pinMode(52, OUTPUT);   // SCK
+    pinMode(50, INPUT);    // MISO
+    if (fast) {
+        SPCR = (1 << SPE) | (1 << MSTR);            // F_CPU / 2 with SPI2X
+        SPSR = (1 << SPI2X);
+    } else {
+        SPCR = (1 << SPE) | (1 << MSTR) | (1 << SPR1);  // F_CPU / 64
+        SPSR = 0;
+    }
+}
+
+#else
+
+static inline uint8_t spiTransfer(uint8_t out) {
+    (void)out;
+    return 0xFF;  // No card: MISO idles high
+}
+
+static void spiBegin(bool fast) {
+    (void)fast;
+}
+
+#endif
+
+static void select() {
+    digitalWrite(s_csPin, LOW);
+}
+
+/** @brief Deselect, then one more byte so the card releases MISO. */
+static void deselect() {
+    digitalWrite(s_csPin, HIGH);
+    spiTransfer(0xFF);
+}
+
+/** @brief Wait until the card stops holding MISO low. */
+static bool waitReady(uint16_t timeoutMs) {
+    uint32_t start = millis();
+    while (spiTransfer(0xFF) != 0xFF) {
+        if (millis() - start >= timeoutMs) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Send a command frame and return its R1 response; the card stays selected. */
+static uint8_t command(uint8_t cmd, uint32_t arg) {
+    select();
+    if (cmd != CMD_GO_IDLE) {
+        waitReady(SD_CARD_BUSY_TIMEOUT_MS);
+    }
+    spiTransfer((uint8_t)(0x40 | cmd));
+    for (int8_t shift = 24; shift >= 0; shift -= 8) {
+        spiTransfer((uint8_t)(arg >> shift));
+    }
+    // Only CMD0 and CMD8 are checked before CRC is switched off
+    uint8_t crc = cmd == CMD_GO_IDLE ? 0x95 : (cmd == CMD_SEND_IF_COND ? 0x87 : 0x01);
+    spiTransfer(crc);
+
+    uint8_t r1 = 0xFF;
+    for (uint8_t i = 0; i < 10 && (r1 & 0x80); i++) {
+        r1 = spiTransfer(0xFF);
+    }
+    return r1;
+}
+
+static uint8_t appCommand(uint8_t cmd, uint32_t arg) {
+    command(CMD_APP, 0);
+    return command(cmd, arg);
+}
+
+/** @brief Card address of a block: bytes on SDSC, blocks on SDHC. */
+static uint32_t cardAddress(uint32_t block) {
+    return s_type == SD_CARD_SDHC ? block : block * SD_CARD_BLOCK_BYTES;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Card access
+// ──────────────────────────────────────────────────────────────────────────
+
+bool sdCardBegin(uint8_t csPin) {
+    s_csPin = csPin;
+    s_type = SD_CARD_NONE;
+#if !defined(__AVR__)
+    return false;  // No card, and the host clock may not advance on its own
+#endif
+    pinMode(s_csPin, OUTPUT);
+    digitalWrite(s_csPin, HIGH);
+    spiBegin(false);
+
+    // At least 74 clocks with CS high put the card in SPI mode
+    for (uint8_t i = 0; i < 10; i++) {
+        spiTransfer(0xFF);
+    }
+
+    uint32_t start = millis();
+    while (command(CMD_GO_IDLE, 0) != R1_IDLE) {
+        deselect();
+        if (millis() - start >= INIT_TIMEOUT_MS) {
+            return false;
+        }
+    }
+
+    SdCardType type = SD_CARD_SD1;
+    if (!(command(CMD_SEND_IF_COND, 0x1AA) & R1_ILLEGAL_COMMAND)) {
+        uint8_t echo = 0;
+        for (uint8_t i = 0; i < 4; i++) {
+            echo = spiTransfer(0xFF);
+        }
+        if (echo != 0xAA) {
+            deselect();
+            return false;  // Voltage range not accepted
+        }
+        type = SD_CARD_SD2;
+    }
+    deselect();
+
+    uint32_t hcs = type == SD_CARD_SD2 ? 0x40000000UL : 0;
+    while (appCommand(ACMD_SEND_OP_COND, hcs) != 0) {
+        deselect();
+        if (millis() - start >= INIT_TIMEOUT_MS) {
+            return false;
+        }
+    }
+    deselect();
+
+    if (type == SD_CARD_SD2) {
+        if (command(CMD_READ_OCR, 0) != 0) {
+            deselect();
+            return false;
+        }
+        uint8_t ocr = spiTransfer(0xFF);
+        for (uint8_t i = 0; i < 3; i++) {
+            spiTransfer(0xFF);
+        }
+        if (ocr & 0x40) {
+            type = SD_CARD_SDHC;  // CCS: block addressing
+        }
+        deselect();
+    }
+    if (type != SD_CARD_SDHC) {
+        bool ok = command(CMD_SET_BLOCKLEN, SD_CARD_BLOCK_BYTES) == 0;
+        deselect();
+        if (!ok) {
+            return false;
+        }
+    }
+
+    s_type = type;
+    spiBegin(true);
+    return true;
+}
+
+SdCardType sdCardGetType() {
+    return s_type;
+}
+
+bool sdCardReadBlock(uint32_t block, uint8_t *buf) {
+    if (s_type == SD_CARD_NONE) {
+        return false;
+    }
+    if (command(CMD_READ_SINGLE, cardAddress(block)) != 0) {
+        deselect();
+        return false;
+    }
+    uint32_t start = millis();
+    uint8_t token;
+    while ((token = spiTransfer(0xFF)) == 0xFF) {
+        if (millis() - start >= READ_TIMEOUT_MS) {
+            deselect();
+            return false;
+        }
+    }
+    if (token != TOKEN_START_BLOCK) {
+        deselect();
+        return false;
+    }
+    for (uint16_t i = 0; i < SD_CARD_BLOCK_BYTES; i++) {
+        buf[i] = spiTransfer(0xFF);
+    }
+    spiTransfer(0xFF);  // CRC, unchecked
+    spiTransfer(0xFF);
+    deselect();
+    return true;
+}
+
+bool sdCardWriteStart(uint32_t block, uint32_t eraseCount) {
+    if (s_type == SD_CARD_NONE) {
+        return false;
+    }
+    if (eraseCount != 0) {
+        appCommand(ACMD_SET_WR_BLK_ERASE, eraseCount > 0x7FFFFFUL ? 0x7FFFFFUL : eraseCount);
+        deselect();
+    }
+    bool ok = command(CMD_WRITE_MULTIPLE, cardAddress(block)) == 0;
+    deselect();
+    return ok;
+}
+
+bool sdCardWriteBlock(const uint8_t *buf) {
+    select();
+    if (!waitReady(SD_CARD_BUSY_TIMEOUT_MS)) {
+        deselect();
+        return false;
+    }
+    spiTransfer(TOKEN_MULTI_WRITE);
+    for (uint16_t i = 0; i < SD_CARD_BLOCK_BYTES; i++) {
+        spiTransfer(buf[i]);
+    }
+    spiTransfer(0xFF);  // CRC, unchecked in SPI mode
+    spiTransfer(0xFF);
+    bool ok = (spiTransfer(0xFF) & 0x1F) == DATA_ACCEPTED;
+    deselect();
+    return ok;
+}
+
+bool sdCardBusy() {
+    select();
+    bool busy = spiTransfer(0xFF) != 0xFF;
+    deselect();
+    return busy;
+}
+
+bool sdCardWriteStop() {
+    select();
+    bool ok = waitReady(SD_CARD_BUSY_TIMEOUT_MS);
+    spiTransfer(TOKEN_STOP_TRAN);
+    spiTransfer(0xFF);
+    deselect();
+    return ok;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// FAT32 lookup (read only)
+// ──────────────────────────────────────────────────────────────────────────
+
+static inline uint16_t le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t le32(const uint8_t *p) {
+    return (uint32_t)le16(p) | ((uint32_t)le16(p + 2) << 16);
+}
+
+static const uint32_t FAT32_END = 0x0FFFFFF8UL;
+
+/** @brief "log.bin" → "LOG     BIN"; false if it is not a valid 8.3 name. */
+static bool toShortName(const char *name, char out[11]) {
+    memset(out, ' ', 11);
+    uint8_t i = 0;
+    for (; *name != '\0' && *name != '.'; name++) {
+        if (i >= 8) {
+            return false;
+        }
+        out[i++] = (char)toupper((unsigned char)*name);
+    }
+    if (i == 0) {
+        return false;
+    }
+    if (*name == '.') {
+        name++;
+        for (i = 8; *name != '\0'; name++) {
+            if (i >= 11) {
+                return false;
+            }
+            out[i++] = (char)toupper((unsigned char)*name);
+        }
+    }
+    return true;
+}
+
+/** @brief Layout of the volume, from its boot sector. */
+struct FatVolume {
+    uint32_t fatStart;           ///< First block of the first FAT
+    uint32_t dataStart;          ///< Block of cluster 2
+    uint32_t rootCluster;
+    uint8_t  blocksPerCluster;
+};
+
+static bool readVolume(uint8_t *buf, FatVolume *vol) {
+    if (!sdCardReadBlock(0, buf) || le16(&buf[510]) != 0xAA55) {
+        return false;
+    }
+    uint32_t start = 0;
+    if (memcmp(&buf[82], "FAT32", 5) != 0) {
+        // Partition table: the first entry must be FAT32 (CHS or LBA)
+        uint8_t kind = buf[446 + 4];
+        if (kind != 0x0B && kind != 0x0C) {
+            return false;
+        }
+        start = le32(&buf[446 + 8]);
+        if (!sdCardReadBlock(start, buf) || le16(&buf[510]) != 0xAA55) {
+            return false;
+        }
+    }
+    uint16_t fatBlocks16 = le16(&buf[22]);
+    if (le16(&buf[11]) != SD_CARD_BLOCK_BYTES || buf[13] == 0 || fatBlocks16 != 0) {
+        return false;  // Not 512-byte sectors, or FAT12/16
+    }
+    vol->blocksPerCluster = buf[13];
+    vol->fatStart = start + le16(&buf[14]);
+    vol->dataStart = vol->fatStart + (uint32_t)buf[16] * le32(&buf[36]);
+    vol->rootCluster = le32(&buf[44]);
+    return true;
+}
+
+static uint32_t clusterBlock(const FatVolume &vol, uint32_t cluster) {
+    return vol.dataStart + (cluster - 2) * vol.blocksPerCluster;
+}
+
+/** @brief Next cluster of a chain; buf caches one FAT block (*cached). */
+static bool nextCluster(const FatVolume &vol, uint32_t cluster, uint8_t *buf, uint32_t *cached,
+                        uint32_t *next) {
+    uint32_t block = vol.fatStart + cluster / 128;
+    if (*cached != block) {
+        if (!sdCardReadBlock(block, buf)) {
+            return false;
+        }
+        *cached = block;
+    }
+    *next = le32(&buf[(cluster % 128) * 4]) & 0x0FFFFFFFUL;
+    return true;
+}
+
+bool sdCardFindFile(const char *name, uint8_t *buf, SdCardExtent *extent) {
+    char shortName[11];
+    FatVolume vol;
+    if (!toShortName(name, shortName) || !readVolume(buf, &vol)) {
+        return false;
+    }
+
+    // Root directory: 16 entries per block
+    uint32_t firstCluster = 0;
+    uint32_t size = 0;
+    bool found = false;
+    uint32_t cluster = vol.rootCluster;
+    uint32_t cached = 0xFFFFFFFFUL;
+    while (!found && cluster >= 2 && cluster < FAT32_END) {
+        for (uint8_t b = 0; b < vol.blocksPerCluster && !found; b++) {
+            if (!sdCardReadBlock(clusterBlock(vol, cluster) + b, buf)) {
+                return false;
+            }
+            cached = 0xFFFFFFFFUL;  // buf no longer holds a FAT block
+            for (uint16_t e = 0; e < SD_CARD_BLOCK_BYTES; e += 32) {
+                const uint8_t *entry = &buf[e];
+                if (entry[0] == 0x00) {
+                    return false;  // End of directory
+                }
+                uint8_t attributes = entry[11];
+                if (entry[0] == 0xE5 || (attributes & 0x0F) == 0x0F || (attributes & 0x18) != 0) {
+                    continue;  // Deleted, long-name part, directory or volume label
+                }
+                if (memcmp(entry, shortName, 11) == 0) {
+                    firstCluster = ((uint32_t)le16(&entry[20]) << 16) | le16(&entry[26]);
+                    size = le32(&entry[28]);
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found && !nextCluster(vol, cluster, buf, &cached, &cluster)) {
+            return false;
+        }
+    }
+    if (!found || firstCluster < 2 || size < SD_CARD_BLOCK_BYTES) {
+        return false;
+    }
+
+    // Contiguous: every link of the chain points to the next cluster
+    uint32_t clusterBytes = (uint32_t)vol.blocksPerCluster * SD_CARD_BLOCK_BYTES;
+    uint32_t clusters = (size + clusterBytes - 1) / clusterBytes;
+    cached = 0xFFFFFFFFUL;
+    for (uint32_t c = firstCluster; c < firstCluster + clusters - 1; c++) {
+        uint32_t next;
+        if (!nextCluster(vol, c, buf, &cached, &next) || next != c + 1) {
+            return false;
+        }
+    }
+
+    extent->firstBlock = clusterBlock(vol, firstCluster);
+    extent->blockCount = size / SD_CARD_BLOCK_BYTES;
+    return true;
+}
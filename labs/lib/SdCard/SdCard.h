@@ -0,0 +1,150 @@
+/**
+ * @file SdCard.h
+ * @brief SD Card Block Access over the Hardware SPI (SPI mode, no file system)
+ *
+ * The minimum a data logger needs to write an SD card at full speed:
+ * card initialisation, 512-byte block reads, and open-ended multi-block
+ * writes (CMD25) that return as soon as a block is accepted, so the
+ * caller can do other work (or let other tasks run) while the card
+ * programs it:
+ *
+ *   sdCardWriteStart(block, n) ─► sdCardWriteBlock(buf) ─► sdCardBusy()? ─► … ─► sdCardWriteStop()
+ *                                      ~0.6 ms at 8 MHz      ~1 ms typical, 250 ms worst
+ *
+ * Files are not created or extended. sdCardFindFile() locates an
+ * existing, contiguous file in the root directory of a FAT32 volume and
+ * returns its first block and length, so a logger can write straight
+ * into space the PC pre-allocated (a freshly formatted card and e.g.
+ * "dd if=/dev/zero of=LOG.BIN bs=1M count=256" or "fsutil file createnew
+ * LOG.BIN 268435456"): the directory entry and the FAT are never
+ * written, and a reset can never corrupt the file system.
+ *
+ * Wiring (Arduino Mega hardware SPI): MISO D50, MOSI D51, SCK D52 and a
+ * chip select (D53, the SS pin, unless another one is given). D53 is
+ * made an output either way, as the SPI master mode requires. Use a
+ * module with a 3.3 V regulator and level shifter. The bus runs at
+ * 250 kHz during initialisation and at 8 MHz (F_CPU / 2) after it.
+ *
+ * SDSC (v1 and v2, byte addressed) and SDHC/SDXC (block addressed)
+ * cards are handled; block numbers are always in 512-byte units.
+ *
+ * Not locked: one task owns the card. Calls spin on the SPI for each
+ * byte, with interrupts enabled. Off target there is no card: every
+ * call fails.
+ *
+ * Usage:
+ *   static uint8_t s_block[512];
+ *   SdCardExtent file;
+ *   if (sdCardBegin(53) && sdCardFindFile("LOG.BIN", s_block, &file)) {
+ *       sdCardWriteStart(file.firstBlock, 8);
+ *       sdCardWriteBlock(s_block);
+ *       while (sdCardBusy()) { taskYIELD(); }
+ *       sdCardWriteStop();
+ *   }
+ */
+
+#ifndef SD_CARD_H
+#define SD_CARD_H
+
+#include <Arduino.h>
+
+/** @brief Bytes per block. */
+#define SD_CARD_BLOCK_BYTES 512
+
+/** @brief Longest the card may hold the bus busy (write, erase), in ms. */
+#ifndef SD_CARD_BUSY_TIMEOUT_MS
+#define SD_CARD_BUSY_TIMEOUT_MS 500
+#endif
+
+/**
+ * @enum SdCardType
+ * @brief Card generation found by sdCardBegin().
+ */
+enum SdCardType {
+    SD_CARD_NONE = 0,  ///< Not initialised, or no card answered
+    SD_CARD_SD1,       ///< SDSC, spec version 1
+    SD_CARD_SD2,       ///< SDSC, spec version 2
+    SD_CARD_SDHC       ///< SDHC / SDXC (block addressed)
+};
+
+/**
+ * @struct SdCardExtent
+ * @brief A run of consecutive blocks (a contiguous file).
+ */
+struct SdCardExtent {
+    uint32_t firstBlock;   ///< First block of the file's data
+    uint32_t blockCount;   ///< Whole blocks in the file
+};
+
+/**
+ * @brief Initialise the SPI and the card.
+ *
+ * Sends the power-up clocks, CMD0, CMD8, ACMD41 until the card leaves
+ * idle (1 s at most) and CMD58, then switches to the full clock.
+ *
+ * @param csPin Chip select pin.
+ * @return false if no card answered or it is not usable.
+ */
+bool sdCardBegin(uint8_t csPin);
+
+/** @brief Card found by sdCardBegin(). */
+SdCardType sdCardGetType();
+
+/**
+ * @brief Read one block.
+ *
+ * @param block Block number.
+ * @param buf   Receives SD_CARD_BLOCK_BYTES bytes.
+ * @return false on a card error or timeout.
+ */
+bool sdCardReadBlock(uint32_t block, uint8_t *buf);
+
+/**
+ * @brief Start a multi-block write.
+ *
+ * @param block      First block to write.
+ * @param eraseCount Blocks the card may pre-erase (ACMD23), 0 for none;
+ *                   a hint only, the write may end sooner or later.
+ * @return false if the card refused the command.
+ */
+bool sdCardWriteStart(uint32_t block, uint32_t eraseCount);
+
+/**
+ * @brief Send the next block of a multi-block write.
+ *
+ * Waits until the card is ready for it, then returns once the card has
+ * accepted the data; programming continues in the card (sdCardBusy()).
+ *
+ * @param buf SD_CARD_BLOCK_BYTES bytes.
+ * @return false if the card rejected the block or timed out.
+ */
+bool sdCardWriteBlock(const uint8_t *buf);
+
+/** @brief True while the card is programming (it holds MISO low). */
+bool sdCardBusy();
+
+/**
+ * @brief End a multi-block write (stop token).
+ *
+ * The card programs the last block after this returns; sdCardBusy()
+ * tells when it is done.
+ */
+bool sdCardWriteStop();
+
+/**
+ * @brief Find a contiguous file in the root directory of a FAT32 volume.
+ *
+ * Looks at the first partition (or a volume without a partition table),
+ * matches the 8.3 name case-insensitively and checks that the file's
+ * cluster chain is one run. Reads the boot records, the root directory
+ * and the file's FAT entries (one block per 128 clusters).
+ *
+ * @param name   8.3 name, e.g. "LOG.BIN".
+ * @param buf    SD_CARD_BLOCK_BYTES of scratch space.
+ * @param extent Receives the file's blocks.
+ * @return false if the volume is not FAT32, the file is missing, empty
+ *         or fragmented, or a read failed.
+ */
+bool sdCardFindFile(const char *name, uint8_t *buf, SdCardExtent *extent);
+
+#endif // SD_CARD_H
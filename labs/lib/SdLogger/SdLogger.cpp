@@ -0,0 +1,275 @@
+/**
+ * @file SdLogger.cpp
+ * @brief SD Card Binary Logger Implementation
+ *
+ * The producers and the writer share one SdLogBlocks. Producers only
+ * touch the active block and the writer only the full one; the index
+ * and flags change inside critical sections, so the writer's 512-byte
+ * SPI transfer runs with interrupts and preemption enabled.
+ */
+
+#include "SdLogger.h"
+#include "TelemetryFrame.h"
+#include "FlashString.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Block queue
+// ──────────────────────────────────────────────────────────────────────────
+
+void sdLogBlocksInit(SdLogBlocks *blocks) {
+    memset(blocks, 0, sizeof(*blocks));
+}
+
+SdLogAppend sdLogBlocksAppend(SdLogBlocks *blocks, const uint8_t *frame, uint16_t len) {
+    if (len == 0 || len > SD_CARD_BLOCK_BYTES) {
+        blocks->dropped++;
+        return SD_LOG_DROPPED;
+    }
+    SdLogAppend result = SD_LOG_APPENDED;
+    uint8_t a = blocks->active;
+    if (blocks->fill[a] + len > SD_CARD_BLOCK_BYTES) {
+        uint8_t other = (uint8_t)(a ^ 1);
+        if (blocks->full[other]) {
+            blocks->dropped++;
+            return SD_LOG_DROPPED;
+        }
+        blocks->full[a] = true;  // The tail stays zero
+        blocks->active = other;
+        a = other;
+        result = SD_LOG_SWAPPED;
+    }
+    memcpy(&blocks->data[a][blocks->fill[a]], frame, len);
+    blocks->fill[a] = (uint16_t)(blocks->fill[a] + len);
+    return result;
+}
+
+bool sdLogBlocksSeal(SdLogBlocks *blocks) {
+    uint8_t a = blocks->active;
+    uint8_t other = (uint8_t)(a ^ 1);
+    if (blocks->fill[a] == 0 || blocks->full[other]) {
+        return false;
+    }
+    blocks->full[a] = true;
+    blocks->active = other;
+    return true;
+}
+
+int8_t sdLogBlocksPending(const SdLogBlocks *blocks) {
+    uint8_t other = (uint8_t)(blocks->active ^ 1);
+    return blocks->full[other] ? (int8_t)other : -1;
+}
+
+void sdLogBlocksRelease(SdLogBlocks *blocks, uint8_t index) {
+    memset(blocks->data[index], 0, SD_CARD_BLOCK_BYTES);
+    blocks->fill[index] = 0;
+    __asm__ __volatile__("" ::: "memory");  // Cleared before the producers may see it
+    blocks->full[index] = false;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Logger state
+// ──────────────────────────────────────────────────────────────────────────
+
+/// Writer time spent spinning on a programming card before it sleeps.
+static const uint8_t BUSY_SPIN_MS = 2;
+
+static SdLogBlocks   s_blocks;
+static SdCardExtent  s_file = { 0, 0 };
+static uint32_t      s_next = 0;           ///< Next file block to write
+static bool          s_ready = false;
+static volatile bool s_full = false;
+static volatile bool s_flushRequested = false;
+static bool          s_streaming = false;
+static uint8_t       s_seq = 0;
+static uint32_t      s_records = 0;
+static uint32_t      s_fileFullDrops = 0;
+static uint32_t      s_blocksWritten = 0;
+static uint16_t      s_writeErrors = 0;
+static TaskHandle_t  s_writer = NULL;
+
+/** @brief True if a file block holds data: it starts with a COBS code byte. */
+static bool blockUsed(uint32_t index, uint8_t *buf) {
+    if (!sdCardReadBlock(s_file.firstBlock + index, buf)) {
+        return true;  // Unreadable: never write over it
+    }
+    return buf[0] != 0x00 && buf[0] != 0xFF;
+}
+
+bool sdLogBegin(uint8_t csPin, const char *fileName) {
+    sdLogBlocksInit(&s_blocks);
+    s_ready = false;
+    if (!sdCardBegin(csPin) || !sdCardFindFile(fileName, s_blocks.data[0], &s_file)) {
+        return false;
+    }
+
+    // Blocks are written in order, so the used ones are a prefix
+    uint32_t lo = 0;
+    uint32_t hi = s_file.blockCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (blockUsed(mid, s_blocks.data[0])) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    s_next = lo;
+    s_full = s_next >= s_file.blockCount;
+    sdLogBlocksInit(&s_blocks);
+    s_ready = true;
+    return true;
+}
+
+bool sdLogRecord(uint8_t type, const void *payload, uint8_t len) {
+    if (!s_ready) {
+        return false;
+    }
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    taskENTER_CRITICAL();
+    uint8_t seq = s_seq++;
+    bool full = s_full;
+    if (full) {
+        s_fileFullDrops++;
+    }
+    taskEXIT_CRITICAL();
+    if (full) {
+        return false;
+    }
+
+    // Framing (COBS + CRC) runs preemptible, on the caller's stack
+    uint8_t frameLen = telemetryEncode(type, seq, payload, len, frame);
+    if (frameLen == 0) {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    SdLogAppend result = sdLogBlocksAppend(&s_blocks, frame, frameLen);
+    if (result != SD_LOG_DROPPED) {
+        s_records++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (result == SD_LOG_SWAPPED && s_writer != NULL) {
+        xTaskNotifyGive(s_writer);
+    }
+    return result != SD_LOG_DROPPED;
+}
+
+void sdLogFlush() {
+    s_flushRequested = true;
+    if (s_writer != NULL) {
+        xTaskNotifyGive(s_writer);
+    }
+}
+
+void sdLogGetStats(SdLogStats *stats) {
+    taskENTER_CRITICAL();
+    stats->ready = s_ready;
+    stats->full = s_full;
+    stats->records = s_records;
+    stats->dropped = s_blocks.dropped + s_fileFullDrops;
+    stats->blocksWritten = s_blocksWritten;
+    stats->blocksUsed = s_next;
+    stats->blocksTotal = s_file.blockCount;
+    stats->writeErrors = s_writeErrors;
+    taskEXIT_CRITICAL();
+}
+
+void sdLogReport() {
+    SdLogStats stats;
+    sdLogGetStats(&stats);
+    if (!stats.ready) {
+        FLASH_PRINTF("[SDLOG] off (no card or no contiguous log file)\r\n");
+        return;
+    }
+    FLASH_PRINTF("[SDLOG] %lu records, %lu dropped, %lu blocks written, %lu/%lu used%s, %u errors\r\n",
+                 (unsigned long)stats.records, (unsigned long)stats.dropped,
+                 (unsigned long)stats.blocksWritten, (unsigned long)stats.blocksUsed,
+                 (unsigned long)stats.blocksTotal, stats.full ? " (full)" : "",
+                 (unsigned)stats.writeErrors);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Writer
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Wait for the card to finish programming, giving the CPU away. */
+static bool waitProgrammed() {
+    uint32_t start = millis();
+    while (sdCardBusy()) {
+        uint32_t elapsed = millis() - start;
+        if (elapsed >= SD_CARD_BUSY_TIMEOUT_MS) {
+            return false;
+        }
+        if (elapsed < BUSY_SPIN_MS) {
+            taskYIELD();
+        } else {
+            vTaskDelay(1);
+        }
+    }
+    return true;
+}
+
+static void endStream() {
+    if (s_streaming) {
+        sdCardWriteStop();
+        waitProgrammed();
+        s_streaming = false;
+    }
+}
+
+/** @brief Write one block at s_next; a rejected block is counted and lost. */
+static void writeBlock(const uint8_t *data) {
+    if (!s_streaming) {
+        // Pre-erase the rest of the file; it is only a hint to the card
+        s_streaming = sdCardWriteStart(s_file.firstBlock + s_next, s_file.blockCount - s_next);
+    }
+    if (s_streaming && sdCardWriteBlock(data) && waitProgrammed()) {
+        s_next++;
+        s_blocksWritten++;
+    } else {
+        s_writeErrors++;
+        endStream();
+    }
+    if (s_next >= s_file.blockCount) {
+        endStream();
+        s_full = true;
+    }
+}
+
+void vTaskSdLog(void *pvParameters) {
+    (void)pvParameters;
+    s_writer = xTaskGetCurrentTaskHandle();
+
+    for (;;) {
+        bool woken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SD_LOG_FLUSH_MS)) != 0;
+        bool flush = !woken || s_flushRequested;
+        s_flushRequested = false;
+        if (!s_ready || s_full) {
+            continue;
+        }
+
+        bool seal = flush;
+        for (;;) {
+            taskENTER_CRITICAL();
+            int8_t index = sdLogBlocksPending(&s_blocks);
+            if (index < 0 && seal && sdLogBlocksSeal(&s_blocks)) {
+                index = sdLogBlocksPending(&s_blocks);
+                seal = false;  // Once: records arriving meanwhile wait for the next flush
+            }
+            taskEXIT_CRITICAL();
+            if (index < 0 || s_full) {
+                break;
+            }
+            writeBlock(s_blocks.data[index]);
+            sdLogBlocksRelease(&s_blocks, (uint8_t)index);
+        }
+
+        if (flush) {
+            endStream();  // Idle or asked: commit what was written
+        }
+    }
+}
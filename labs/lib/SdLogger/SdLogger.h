@@ -0,0 +1,183 @@
+/**
+ * @file SdLogger.h
+ * @brief Binary Telemetry Logging to an SD Card from a Low-Priority Task
+ *
+ * Records are framed exactly as telemetrySend() frames them (COBS, CRC,
+ * 0x00 delimiter; TelemetryFrame.h), so one host decoder reads the
+ * serial stream and the card's LOG.BIN alike. Instead of the UART they
+ * go into two 512-byte RAM blocks that act as the logger queue:
+ *
+ *   sdLogRecord() ─► frame ─► [ active block ]   full ─► swap
+ *   (any task, never blocks)  [ writing block ] ─► vTaskSdLog ─► CMD25 ─► card
+ *
+ * A producer frames the record on its own stack, then copies it into the
+ * active block inside a short critical section (about 60 bytes). A frame
+ * never straddles two blocks: when it does not fit, the rest of the block
+ * stays zero (empty frames to the decoder), the block is handed to the
+ * writer and the frame starts the other one. If the writer still holds
+ * the other block the record is dropped and counted; the sequence number
+ * it would have used is skipped, so the host sees the gap too.
+ *
+ * The writer streams blocks into a file the PC pre-allocated (see
+ * SdCard.h; the file system is never written), keeping one open-ended
+ * multi-block write with the rest of the file pre-erased. While the card
+ * programs a block (~1 ms, occasionally 100+ ms) the writer yields to
+ * tasks of its own priority and then sleeps a tick at a time, so it only
+ * ever uses time the control tasks leave. When nothing has been logged
+ * for SD_LOG_FLUSH_MS, or on sdLogFlush(), the partial block is written
+ * and the write ended, so a power cut loses at most that much.
+ *
+ * Throughput: one block every ~2 ms of writer time at 8 MHz SPI, i.e.
+ * records of ~30 bytes at several kHz in bursts; sustained, the card's
+ * programming time sets the limit. The two blocks bridge a stall of one
+ * block's worth of records (512 B at the record rate).
+ *
+ * Restarts resume where the last run stopped: sdLogBegin() finds the
+ * first block that does not start with a COBS code byte (0x00 from the
+ * PC, 0xFF if the card pre-erased it) by binary search. When the file is
+ * full, logging stops and further records count as dropped.
+ *
+ * Off target sdCardBegin() fails, so sdLogBegin() returns false and
+ * sdLogRecord() does nothing; the block queue (SdLogBlocks) is portable
+ * and tested natively.
+ *
+ * Usage:
+ *   static StaticTask<256> s_sdLogTask;                  // StaticRtos.h
+ *   if (sdLogBegin(53, "LOG.BIN")) {                     // setup(), before the scheduler
+ *       s_sdLogTask.create(vTaskSdLog, "SdLog", NULL, 1);
+ *   }
+ *   sdLogRecord(MY_RECORD_TYPE, &rec, sizeof(rec));      // any task
+ *   sdLogReport();                                       // "[SDLOG] ..." status line
+ */
+
+#ifndef SD_LOGGER_H
+#define SD_LOGGER_H
+
+#include <Arduino.h>
+#include "RtosTick.h"
+
+#include "SdCard.h"
+
+/** @brief Idle time after which a partial block is written, in ms. */
+#ifndef SD_LOG_FLUSH_MS
+#define SD_LOG_FLUSH_MS 1000
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Block queue (portable core)
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @struct SdLogBlocks
+ * @brief Two blocks: one filled by producers, one waiting for the writer.
+ *
+ * Not locked: the logger calls these inside critical sections.
+ */
+struct SdLogBlocks {
+    uint8_t  data[2][SD_CARD_BLOCK_BYTES];
+    uint16_t fill[2];     ///< Bytes used in each block
+    bool     full[2];     ///< Handed to the writer
+    uint8_t  active;      ///< Block producers append to
+    uint32_t dropped;     ///< Frames refused because both blocks were taken
+};
+
+/** @brief Result of sdLogBlocksAppend(). */
+enum SdLogAppend {
+    SD_LOG_APPENDED = 0,  ///< Stored in the active block
+    SD_LOG_SWAPPED,       ///< Stored; the previous block is now full (wake the writer)
+    SD_LOG_DROPPED        ///< Not stored (counted in dropped)
+};
+
+/** @brief Empty both blocks (all zero). */
+void sdLogBlocksInit(SdLogBlocks *blocks);
+
+/**
+ * @brief Append one frame, starting a new block if it does not fit.
+ *
+ * @param frame Frame bytes (at most SD_CARD_BLOCK_BYTES).
+ * @param len   Number of bytes.
+ */
+SdLogAppend sdLogBlocksAppend(SdLogBlocks *blocks, const uint8_t *frame, uint16_t len);
+
+/**
+ * @brief Hand a partly filled active block to the writer.
+ *
+ * @return true if a block was sealed, false if the active block is empty
+ *         or the other one is still being written.
+ */
+bool sdLogBlocksSeal(SdLogBlocks *blocks);
+
+/** @return Index of the block waiting for the writer, or -1. */
+int8_t sdLogBlocksPending(const SdLogBlocks *blocks);
+
+/**
+ * @brief Give a written block back to the producers, zeroed.
+ *
+ * Needs no lock, unlike the calls above (the writer's memset would
+ * otherwise run with interrupts off): the block stays the writer's until
+ * its full flag, a single byte, is cleared last.
+ */
+void sdLogBlocksRelease(SdLogBlocks *blocks, uint8_t index);
+
+// ──────────────────────────────────────────────────────────────────────────
+// Logger
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @struct SdLogStats
+ * @brief Counters for the status line.
+ */
+struct SdLogStats {
+    bool     ready;          ///< sdLogBegin() found the card and the file
+    bool     full;           ///< The file is used up
+    uint32_t records;        ///< Records accepted
+    uint32_t dropped;        ///< Records refused (blocks taken, file full)
+    uint32_t blocksWritten;  ///< Blocks written since sdLogBegin()
+    uint32_t blocksUsed;     ///< Blocks of the file holding data
+    uint32_t blocksTotal;    ///< Blocks in the file
+    uint16_t writeErrors;    ///< Blocks the card rejected (lost)
+};
+
+/**
+ * @brief Initialise the card and find the log file.
+ *
+ * Call from setup() before the scheduler starts (it spins on the SPI
+ * for up to a few hundred ms), then create vTaskSdLog.
+ *
+ * @param csPin    Card chip select.
+ * @param fileName 8.3 name of a contiguous file in the root directory.
+ * @return false if there is no card, no such file, or it is fragmented.
+ */
+bool sdLogBegin(uint8_t csPin, const char *fileName);
+
+/**
+ * @brief Frame and queue one record.
+ *
+ * Never blocks. Must not be called from an ISR.
+ *
+ * @param type    Record type id (as for telemetrySend()).
+ * @param payload Record bytes.
+ * @param len     Payload length (at most TELEMETRY_MAX_PAYLOAD).
+ * @return false if the logger is not running or the record was dropped.
+ */
+bool sdLogRecord(uint8_t type, const void *payload, uint8_t len);
+
+/** @brief Have the writer write the partial block and end the write now. */
+void sdLogFlush();
+
+/** @brief Copy the counters. */
+void sdLogGetStats(SdLogStats *stats);
+
+/** @brief Print "[SDLOG] ..." with the counters (or why it is off). */
+void sdLogReport();
+
+/**
+ * @brief Writer task: writes full blocks to the card.
+ *
+ * Create with a priority at or below every control task.
+ *
+ * @param pvParameters Unused.
+ */
+void vTaskSdLog(void *pvParameters);
+
+#endif // SD_LOGGER_H
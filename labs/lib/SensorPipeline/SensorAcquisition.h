@@ -0,0 +1,271 @@
+/**
+ * @file SensorAcquisition.h
+ * @brief Table-driven Temperature Sensor Pipeline — Acquisition Stage
+ *
+ * Reads every row of a SensorChannel table (SensorPipeline.h) at each
+ * release of the acquisition task, into one SensorSample<C>:
+ *
+ *   NTC      readTemperatureC() every release: the latest AdcEngine
+ *            result after useAdcEngine(), else one analogRead()
+ *   DS18B20  read by cached ROM address only on the release its
+ *            conversion is due; the last value is repeated in between
+ *            (fresh false)
+ *
+ * Each DS18B20 channel is one AcquisitionScheduler source: its request
+ * is timed backwards (conversion + busReadMs per device + guard) from the
+ * release that reads it, so readings arrive on fixed releases, the same
+ * age every time. The lab task keeps the period and the hand-off:
+ *
+ *   begin()          init every driver, start the first conversions
+ *                    (from setup(), so they run during the banner)
+ *   start()          register the schedule (task, before the loop)
+ *   acquire()        at each release: the sample, sequence counted
+ *   requestDue()     sleep to each due request's offset and issue it
+ *
+ * Usage:
+ *   static SensorAcquisition<2> acquisition(CHANNELS, 50, portTICK_PERIOD_MS, 12);
+ *
+ *   acquisition.begin();                       // setup()
+ *   acquisition.start();                       // task
+ *   RtosPeriod period(50);
+ *   for (;;) {
+ *       period.wait();
+ *       const SensorSample<2> &s = acquisition.acquire();
+ *       if (xQueueSend(queue, &s, 0) != pdTRUE) acquisition.countOverrun();
+ *       acquisition.requestDue(period);
+ *   }
+ */
+
+#ifndef SENSOR_ACQUISITION_H
+#define SENSOR_ACQUISITION_H
+
+#include "SensorPipeline.h"
+#include "AnalogTempSensor.h"
+#include "DigitalTempSensor.h"
+#include "AcquisitionScheduler.h"
+#include "AdcEngine.h"
+#include "RtosTime.h"
+
+/**
+ * @class SensorAcquisition
+ * @brief Acquisition of a C-row channel table (NTC and DS18B20 drivers).
+ *
+ * @tparam C Sensor channels (rows of the table).
+ */
+template <uint8_t C>
+class SensorAcquisition {
+public:
+    /**
+     * @param channels  C table rows; read in begin(), not here.
+     * @param periodMs  Acquisition task period (ms).
+     * @param guardMs   Release wake-up margin before a due reading (ms).
+     * @param busReadMs DS18B20 bus work per device per reading (ms).
+     */
+    SensorAcquisition(const SensorChannel *channels, uint16_t periodMs,
+                      uint16_t guardMs, uint16_t busReadMs)
+        : _channels(channels), _schedule(periodMs, guardMs), _busReadMs(busReadMs) {
+        memset(&_sample, 0, sizeof(_sample));
+        _found = 0;
+        for (uint8_t c = 0; c < C; c++) {
+            _source[c] = -1;
+            _requestMs[c] = 0;
+            _valueMs[c] = 0;
+        }
+    }
+
+    /**
+     * @brief Move every NTC channel onto the background AdcEngine.
+     *
+     * Slots follow the table order of the NTC rows. Call after begin()
+     * (the NTCs are initialized there). On failure the NTCs keep using
+     * analogRead().
+     *
+     * @param oversampleLog2 2^n conversions per result.
+     * @param trigger        ADC_ENGINE_TRIGGER_TIMER, or _SLEEP with
+     *                       adcEngineIdle() in the idle hook.
+     * @param minIntervalMs  Sleep trigger: minimum time between conversions.
+     * @return true if the engine runs.
+     */
+    bool useAdcEngine(uint8_t oversampleLog2,
+                      AdcEngineTrigger trigger = ADC_ENGINE_TRIGGER_TIMER,
+                      uint8_t minIntervalMs = 0) {
+        uint8_t pins[C];
+        uint8_t count = 0;
+        for (uint8_t c = 0; c < C; c++) {
+            if (_channels[c].ntc != NULL) {
+                pins[count++] = _channels[c].ntc->getPin();
+            }
+        }
+        if (count == 0 || !adcEngineInit(pins, count, oversampleLog2)) {
+            return false;
+        }
+        if (trigger != ADC_ENGINE_TRIGGER_TIMER) {
+            adcEngineSetTrigger(trigger, minIntervalMs);
+        }
+        adcEngineStart();
+        uint8_t slot = 0;
+        for (uint8_t c = 0; c < C; c++) {
+            if (_channels[c].ntc != NULL) {
+                _channels[c].ntc->useAdcEngine((int8_t)slot++);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Initialize every driver and start the first DS18B20 conversions.
+     *
+     * @return ChannelMask Channels whose sensor was found (an NTC always is).
+     */
+    ChannelMask begin() {
+        _found = 0;
+        for (uint8_t c = 0; c < C; c++) {
+            const SensorChannel &ch = _channels[c];
+            ChannelMask bit = (ChannelMask)(1U << c);
+            if (ch.ntc != NULL) {
+                if (ch.ntcLut != NULL) {
+                    ch.ntc->useLookupTable(ch.ntcLut);
+                }
+                ch.ntc->init();
+                _found |= bit;
+            } else if (ch.ds18b20 != NULL && ch.ds18b20->init()) {
+                ch.ds18b20->requestConversion();
+                _requestMs[c] = millis();
+                _valueMs[c] = _requestMs[c];
+                _sample.resolution[c] = ch.ds18b20->getDeviceResolution(0);
+                _found |= bit;
+            }
+            _sample.tempC[c] = NAN;
+            _sample.resistance[c] = -1.0f;
+        }
+        return _found;
+    }
+
+    /**
+     * @brief Register each found DS18B20 with the schedule.
+     *
+     * Call from the task before its first release; the conversions begin()
+     * started count as this period's requests.
+     */
+    void start() {
+        for (uint8_t c = 0; c < C; c++) {
+            if ((_found & (1U << c)) != 0 && _channels[c].ds18b20 != NULL) {
+                _source[c] = _schedule.addSource(latencyMs(c));
+                if (_source[c] >= 0) {
+                    _schedule.markRequested((uint8_t)_source[c]);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Read every channel at this release.
+     *
+     * Call right after the period wait. A DS18B20 resolution policy
+     * (updateResolutionPolicy()) is applied by the caller before this.
+     *
+     * @return The sample, valid until the next acquire().
+     */
+    const SensorSample<C> &acquire() {
+        _schedule.beginCycle();
+        _sample.timestamp = xTaskGetTickCount();
+        _sample.timeUs = micros();
+        uint32_t sampleMs = millis();
+
+        for (uint8_t c = 0; c < C; c++) {
+            const SensorChannel &ch = _channels[c];
+            if (ch.ntc != NULL) {
+                _sample.tempC[c]      = ch.ntc->readTemperatureC();
+                _sample.raw[c]        = ch.ntc->getLastRaw();
+                _sample.resistance[c] = ch.ntc->getLastResistance();
+                _sample.valid[c]      = ch.ntc->isValid();
+                _sample.fresh[c]      = _sample.valid[c];
+                continue;
+            }
+            _sample.fresh[c] = false;
+            if (_source[c] < 0) {
+                _sample.valid[c] = false;   // Not found: no value, ever
+                continue;
+            }
+            DigitalTempSensor *ds = ch.ds18b20;
+            // The window and resolution of the conversion being read are
+            // taken first: the read may switch them for the next one.
+            uint8_t  bits   = ds->getDeviceResolution(0);
+            uint16_t convMs = ds->getConversionTimeMs();
+            if (_schedule.collect((uint8_t)_source[c])) {
+                if (ds->readConversion()) {
+                    _sample.fresh[c]        = true;
+                    _sample.resolution[c]   = bits;
+                    _sample.conversionMs[c] = convMs;
+                    _valueMs[c] = _requestMs[c] + convMs / 2;
+                    _schedule.setLatency((uint8_t)_source[c], latencyMs(c));
+                } else {
+                    _schedule.postpone((uint8_t)_source[c]);   // Woke early: next release
+                }
+            }
+            _sample.tempC[c] = ds->getLastTemperatureC();
+            _sample.valid[c] = ds->isValid();
+            _sample.ageMs[c] = (uint16_t)(sampleMs - _valueMs[c]);
+        }
+        _sample.sequence++;
+        return _sample;
+    }
+
+    /** @brief Count a sample the caller could not hand on (reported with the next). */
+    void countOverrun() { _sample.overruns++; }
+
+    /**
+     * @brief Issue the DS18B20 requests due in this period, each at its offset.
+     *
+     * @param period The task's period; sleeps with waitOffset().
+     */
+    void requestDue(RtosPeriod &period) {
+        uint8_t  source;
+        uint16_t offsetMs;
+        while (_schedule.nextRequest(&source, &offsetMs)) {
+            period.waitOffset(offsetMs);
+            for (uint8_t c = 0; c < C; c++) {
+                if (_source[c] == (int8_t)source) {
+                    _channels[c].ds18b20->requestConversion();
+                    _requestMs[c] = millis();
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Least time between two readings of a DS18B20 channel.
+     *
+     * 0 reads it as fast as its conversion allows (the default).
+     * Call from the task, after start().
+     */
+    void setMinIntervalMs(uint8_t channel, uint16_t minIntervalMs) {
+        if (channel < C && _source[channel] >= 0) {
+            _schedule.setMinInterval((uint8_t)_source[channel], minIntervalMs);
+        }
+    }
+
+    /** @brief Channels found by begin(). */
+    ChannelMask foundMask() const { return _found; }
+
+    /** @brief The request schedule (diagnostics). */
+    const AcquisitionScheduler &schedule() const { return _schedule; }
+
+private:
+    const SensorChannel  *_channels;
+    AcquisitionScheduler  _schedule;
+    uint16_t              _busReadMs;
+    SensorSample<C>       _sample;         /**< Assembled in place, copied by the caller. */
+    ChannelMask           _found;
+    int8_t                _source[C];      /**< Schedule source, -1 if none.   */
+    uint32_t              _requestMs[C];   /**< millis() of the last request.   */
+    uint32_t              _valueMs[C];     /**< Mid-conversion of the value held. */
+
+    /** @brief Request to read-out of one DS18B20 result. */
+    uint16_t latencyMs(uint8_t c) const {
+        const DigitalTempSensor *ds = _channels[c].ds18b20;
+        return (uint16_t)(ds->getConversionTimeMs() + _busReadMs * ds->getDeviceCount());
+    }
+};
+
+#endif // SENSOR_ACQUISITION_H
@@ -0,0 +1,356 @@
+/**
+ * @file SensorPipeline.h
+ * @brief Table-driven Temperature Sensor Pipeline — Channel Table and
+ *        Conditioning Stage
+ *
+ * The monitoring labs describe each sensor channel by one SensorChannel
+ * row (driver, conditioner settings, alert settings, LED) instead of
+ * code. Two stages then serve every row of the table:
+ *
+ *   SensorAcquisition<C>   (SensorAcquisition.h) reads the drivers at
+ *                          each release into one SensorSample<C>
+ *   SensorConditioning<C, N, A>  saturate → median → EWMA of every
+ *                          channel in one ConditionerBank call, then the
+ *                          alert FSMs in one ThresholdAlertBank call, and
+ *                          the alert LEDs
+ *
+ * Records are structure-of-arrays, indexed by channel (the row of the
+ * table), so adding a sensor adds a row and grows every array by one:
+ *
+ *   SensorSample<C>       one acquisition: raw value, validity and, for a
+ *                         DS18B20, resolution, conversion window and age
+ *   SensorConditioned<C>  median, EWMA, alpha and window-full per channel
+ *   SensorAlerts<A>       state, debounce counter, input and raised count
+ *                         per alert channel
+ *
+ * A bank may carry more alert channels than sensors (A > C, e.g. a fused
+ * estimate); the extra ones are configured by the caller through
+ * alerts() and fed by it in alertAll().
+ *
+ * Usage:
+ *   static const SensorChannel CHANNELS[2] = {
+ *       { "NTC",  &ntc, NULL,     { 0.3f, -40.0f, 125.0f, 0.0f, 0.0f, 0.0f },
+ *         { 30.0f, 28.0f, 5, 0, 0, false }, NULL, &redLed },
+ *       { "DS18", NULL, &ds18b20, { 0.3f, -40.0f, 125.0f, 0.0f, 0.0f, 0.0f },
+ *         { 30.0f, 28.0f, 5, 0, 0, false }, NULL, &yellowLed },
+ *   };
+ *   static SensorConditioning<2, 5> conditioning(CHANNELS, &greenLed);
+ *
+ *   conditioning.init(0.05f);                   // task start
+ *   conditioning.condition(sample);             // per dequeued sample
+ *   conditioning.alertAll(conditioning.conditioned(), sampleMs);
+ *   conditioning.updateLeds();
+ */
+
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#include <Arduino.h>
+#include <Arduino_FreeRTOS.h>
+#include <math.h>
+#include "ConditionerBank.h"
+#include "ThresholdAlertBank.h"
+#include "Led.h"
+
+class AnalogTempSensor;
+class DigitalTempSensor;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Channel table
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Conditioner settings of one channel (see ConditionerBank). */
+struct SensorConditionerConfig {
+    float ewmaAlpha;     /**< Fixed EWMA factor (1 = no smoothing).          */
+    float minC;          /**< Saturation lower bound (°C).                   */
+    float maxC;          /**< Saturation upper bound (°C).                   */
+    float minCutoffHz;   /**< > 0: One-Euro alpha at rest (AdaptiveEwma.h).   */
+    float beta;          /**< One-Euro cutoff increase per °C/s.             */
+    float dCutoffHz;     /**< One-Euro slope-estimate cutoff.                */
+};
+
+/** @brief Alert settings of one channel (see ThresholdAlertBank). */
+struct SensorAlertConfig {
+    float    highC;          /**< Alert triggers above this.                     */
+    float    lowC;           /**< Alert clears below this.                       */
+    uint8_t  debounceCount;  /**< Consecutive readings per transition.          */
+    uint32_t raiseDwellMs;   /**< Time debounce up (0 = count readings).        */
+    uint32_t clearDwellMs;   /**< Time debounce down (0 = count readings).      */
+    bool     holdOnInvalid;  /**< Keep the state on an invalid reading (else reset). */
+};
+
+/**
+ * @brief One sensor channel: a row of the lab's channel table.
+ *
+ * Exactly one of ntc / ds18b20 is set. The driver objects, lookup table
+ * and LED belong to the lab; the stages only keep the table pointer.
+ */
+struct SensorChannel {
+    const char              *name;         /**< Short label for reports.          */
+    AnalogTempSensor        *ntc;          /**< NTC driver, or NULL.              */
+    DigitalTempSensor       *ds18b20;      /**< DS18B20 bus, or NULL (device 0 read). */
+    SensorConditionerConfig  conditioner;
+    SensorAlertConfig        alert;
+    int16_t                 *ntcLut;       /**< NTC ADC → °C table storage, or NULL. */
+    Led                     *led;          /**< Alert LED, or NULL.               */
+};
+
+// ──────────────────────────────────────────────────────────────────────────
+// Records (structure-of-arrays, index = channel)
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @brief One acquisition of every channel, stamped with its release.
+ *
+ * resolution / conversionMs are those of the last conversion read
+ * (DS18B20; 0 for an NTC); ageMs runs from the middle of that
+ * conversion to the timestamp. fresh marks a value read in this sample
+ * (always, for a valid NTC).
+ */
+template <uint8_t C>
+struct SensorSample {
+    TickType_t timestamp;          /**< Tick count at acquisition.              */
+    uint32_t   timeUs;             /**< micros() at acquisition (TimeSync.h).   */
+    uint32_t   sequence;           /**< Acquisition cycle number (from 1).      */
+    uint32_t   overruns;           /**< Samples dropped on a full queue so far. */
+    float      tempC[C];           /**< Converted temperature (°C), NAN = none. */
+    float      resistance[C];      /**< NTC resistance (ohms), -1 if invalid.   */
+    uint16_t   raw[C];             /**< NTC ADC counts (0–1023).                */
+    uint16_t   conversionMs[C];    /**< DS18B20 conversion window (ms).         */
+    uint16_t   ageMs[C];           /**< Mid-conversion to timestamp (ms).       */
+    uint8_t    resolution[C];      /**< DS18B20 bits.                           */
+    bool       valid[C];           /**< Driver reports a valid value.           */
+    bool       fresh[C];           /**< A new value in this sample.             */
+};
+
+/** @brief Conditioning results of every channel (NAN / false while invalid). */
+template <uint8_t C>
+struct SensorConditioned {
+    float median[C];               /**< After the median filter (°C).           */
+    float ewma[C];                 /**< After the EWMA — conditioned (°C).      */
+    float alpha[C];                /**< EWMA alpha applied last.                */
+    bool  conditioned[C];          /**< Median window full.                     */
+};
+
+/** @brief Alert FSM status of every alert channel. */
+template <uint8_t A>
+struct SensorAlerts {
+    AlertState state[A];           /**< Current FSM state.                      */
+    uint8_t    debounce[A];        /**< Current debounce counter.               */
+    float      value[A];           /**< Value fed to the FSM last.              */
+    uint32_t   count[A];           /**< Alerts raised since boot.               */
+};
+
+// ──────────────────────────────────────────────────────────────────────────
+// Conditioning stage
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @class SensorConditioning
+ * @brief Conditioner and alert banks of a channel table, plus its LEDs.
+ *
+ * @tparam C Sensor channels (rows of the table).
+ * @tparam N Median window size, shared by every channel (odd).
+ * @tparam A Alert channels: the C sensors, then A - C caller-fed ones.
+ */
+template <uint8_t C, uint8_t N, uint8_t A = C>
+class SensorConditioning {
+    static_assert(A >= C && A <= 16, "alert channels: the sensors, then at most 16 in all");
+
+public:
+    /** @brief Sensor channels (bits 0..C-1 of an alert mask). */
+    static const AlertMask SENSOR_MASK = (AlertMask)((1UL << C) - 1);
+
+    /**
+     * @param channels  C table rows; read in init(), not here.
+     * @param normalLed Lit while every sensor channel is NORMAL, or NULL.
+     */
+    SensorConditioning(const SensorChannel *channels, Led *normalLed)
+        : _channels(channels),
+          _normalLed(normalLed),
+          _bank(1.0f, 0.0f, 0.0f),      // Every channel set from the table in init()
+          _alerts(0.0f, 0.0f, 1) {
+        memset(_out, 0, sizeof(_out));
+        memset(_value, 0, sizeof(_value));
+        memset(_raised, 0, sizeof(_raised));
+        _full = 0;
+        _changed = 0;
+        _masks.active = _masks.debouncing = _masks.raised = _masks.cleared = 0;
+        for (uint8_t c = 0; c < A; c++) {
+            _previous[c] = ALERT_NORMAL;
+        }
+    }
+
+    /**
+     * @brief Configure both banks from the table and light the normal LED.
+     *
+     * Call from the task, before the first sample; extra alert channels
+     * (A > C) are configured through alerts() afterwards.
+     *
+     * @param samplePeriodS Time between samples (s), for the One-Euro alpha.
+     */
+    void init(float samplePeriodS) {
+        for (uint8_t c = 0; c < C; c++) {
+            const SensorConditionerConfig &k = _channels[c].conditioner;
+            _bank.configure(c, k.ewmaAlpha, k.minC, k.maxC);
+            if (k.minCutoffHz > 0.0f) {
+                _bank.configureAdaptive(c, k.minCutoffHz, k.beta, k.dCutoffHz, samplePeriodS);
+            }
+
+            const SensorAlertConfig &a = _channels[c].alert;
+            _alerts.configure(c, a.highC, a.lowC, a.debounceCount);
+            _alerts.configureDwell(c, a.raiseDwellMs, a.clearDwellMs);
+            _alerts.configureHold(c, a.holdOnInvalid);
+
+            if (_channels[c].led != NULL) {
+                _channels[c].led->init();
+                _channels[c].led->turnOff();
+            }
+        }
+        if (_normalLed != NULL) {
+            _normalLed->init();
+            _normalLed->turnOn();   // System normal until an alert says otherwise
+        }
+    }
+
+    /** @brief The alert bank, for the extra channels, rate triggers and trace id. */
+    ThresholdAlertBank<A> &alerts() { return _alerts; }
+
+    /**
+     * @brief Saturate → median → EWMA of every channel of @p sample.
+     *
+     * Invalid (or NaN) channels are reset in the bank and come back as
+     * NaN, flushing their stale window.
+     *
+     * @return ChannelMask Channels with a conditioned value.
+     */
+    ChannelMask condition(const SensorSample<C> &sample) {
+        ChannelMask inputValid = 0;
+        for (uint8_t c = 0; c < C; c++) {
+            if (sample.valid[c]) {
+                inputValid |= (ChannelMask)(1U << c);
+            }
+        }
+        _full = _bank.processAll(sample.tempC, _out, inputValid);
+
+        ChannelMask conditioned = 0;
+        for (uint8_t c = 0; c < C; c++) {
+            if (!isnan(_out[c])) {
+                conditioned |= (ChannelMask)(1U << c);
+            }
+        }
+        return conditioned;
+    }
+
+    /** @brief The C conditioned outputs of the last condition() (NaN = none). */
+    const float *conditioned() const { return _out; }
+
+    /**
+     * @brief Advance every alert FSM by one timestamped value.
+     *
+     * @param values      A values: normally conditioned() for 0..C-1, then
+     *                    the caller's extra channels (NaN resets, or holds).
+     * @param timestampMs Acquisition time of the values (ms, wraps).
+     * @param counts      A raw counts for channels the caller set to
+     *                    alerts().configureCounts(), or NULL.
+     * @return Masks of the state after this call and of its edges.
+     */
+    AlertBankMasks alertAll(const float *values, uint32_t timestampMs,
+                            const int32_t *counts = NULL) {
+        for (uint8_t c = 0; c < A; c++) {
+            _previous[c] = _alerts.getState(c);
+        }
+        _masks = _alerts.updateAllAt(values, timestampMs, ThresholdAlertBank<A>::ALL_CHANNELS,
+                                     counts);
+        _changed = 0;
+        for (uint8_t c = 0; c < A; c++) {
+            AlertMask bit = (AlertMask)(1U << c);
+            _value[c] = values[c];
+            if (_alerts.getState(c) != _previous[c]) {
+                _changed |= bit;
+            }
+            if (_masks.raised & bit) {
+                _raised[c]++;
+            }
+        }
+        return _masks;
+    }
+
+    /** @brief Alert channels whose state the last alertAll() changed. */
+    AlertMask changedMask() const { return _changed; }
+
+    /** @brief A channel's state before the last alertAll(). */
+    AlertState getPreviousState(uint8_t channel) const { return _previous[channel]; }
+
+    /** @brief A channel's current alert state. */
+    AlertState getState(uint8_t channel) const { return _alerts.getState(channel); }
+
+    /**
+     * @brief Drive the LEDs from the last alertAll().
+     *
+     * Normal LED: on while every sensor channel is NORMAL (off as soon as
+     * one starts debouncing). Channel LED: on while ACTIVE, blinking
+     * (toggled per sample) while debouncing, else off.
+     */
+    void updateLeds() {
+        if (_normalLed != NULL) {
+            _normalLed->set(((_masks.active | _masks.debouncing) & SENSOR_MASK) == 0);
+        }
+        for (uint8_t c = 0; c < C; c++) {
+            Led *led = _channels[c].led;
+            if (led == NULL) {
+                continue;
+            }
+            AlertMask bit = (AlertMask)(1U << c);
+            if (_masks.active & bit) {
+                led->turnOn();
+            } else if (_masks.debouncing & bit) {
+                led->toggle();
+            } else {
+                led->turnOff();
+            }
+        }
+    }
+
+    /** @brief Copy the conditioning results (under the caller's lock). */
+    void store(SensorConditioned<C> *out) const {
+        for (uint8_t c = 0; c < C; c++) {
+            if (!isnan(_out[c])) {
+                out->median[c]      = _bank.getLastMedian(c);
+                out->ewma[c]        = _bank.getLastEwma(c);
+                out->alpha[c]       = _bank.getLastAlpha(c);
+                out->conditioned[c] = (_full & (1U << c)) != 0;
+            } else {
+                out->median[c]      = NAN;
+                out->ewma[c]        = NAN;
+                out->alpha[c]       = NAN;
+                out->conditioned[c] = false;
+            }
+        }
+    }
+
+    /** @brief Copy the alert status, counts included (under the caller's lock). */
+    void storeAlerts(SensorAlerts<A> *out) const {
+        for (uint8_t c = 0; c < A; c++) {
+            out->state[c]    = _alerts.getState(c);
+            out->debounce[c] = _alerts.getDebounceCounter(c);
+            out->value[c]    = _value[c];
+            out->count[c]    = _raised[c];
+        }
+    }
+
+private:
+    const SensorChannel    *_channels;
+    Led                    *_normalLed;
+    ConditionerBank<C, N>   _bank;
+    ThresholdAlertBank<A>   _alerts;
+    float                   _out[C];        /**< Last conditioned outputs.          */
+    float                   _value[A];      /**< Last alert inputs.                 */
+    uint32_t                _raised[A];     /**< Alerts raised per channel.         */
+    AlertState              _previous[A];   /**< States before the last alertAll(). */
+    ChannelMask             _full;          /**< Windows full after condition().    */
+    AlertMask               _changed;       /**< State changes of the last alertAll(). */
+    AlertBankMasks          _masks;         /**< Result of the last alertAll().     */
+};
+
+#endif // SENSOR_PIPELINE_H
@@ -0,0 +1,110 @@
+/**
+ * @file SharedSnapshot.h
+ * @brief Lock-Free Single-Writer / Multi-Reader Snapshot (double-buffered seqcount)
+ *
+ * Lets low-priority readers (display, telemetry) take consistent copies of
+ * a shared struct without a mutex, so they can never hold up the tasks that
+ * produce the data. The value is kept twice, selected by an 8-bit sequence
+ * counter:
+ *
+ *   publish(v):  seq++ (odd)  → copy[0] = v     readers use copy[1]
+ *                seq++ (even) → copy[1] = v     readers use copy[0]
+ *
+ *   read(out):   do { s = seq; out = copy[s & 1]; } while (seq != s);
+ *
+ * While the writer fills one copy the readers are pointed at the other, so
+ * a reader always finds a complete value: the writer never waits, and a
+ * reader retries only if a publish() interrupted its own copy. A reader of
+ * higher priority than the writer therefore never spins (the writer cannot
+ * run while it copies), unlike a single-buffer seqlock that would livelock
+ * there. A retried read simply observes the newer value.
+ *
+ * Cost: publish() copies the value twice, read() at least once; at ~0.4 µs
+ * per byte on the Mega a 100-byte struct publishes in about 80 µs, which
+ * is why only shared state read by slow tasks is worth publishing.
+ *
+ * Rules:
+ * - One writer at a time. Several tasks may publish if something else
+ *   already serializes them (e.g. they publish while holding the mutex
+ *   that guards the live struct).
+ * - T must be trivially copyable (plain struct, no pointers into itself).
+ * - Single-core ordering only: the barriers stop compiler reordering,
+ *   which is all an AVR needs. The 8-bit counter is read and written in
+ *   one instruction. A read would only be fooled by exactly 128 publishes
+ *   during one copy.
+ *
+ * Usage:
+ *   static SharedSnapshot<SensorState> s_snap;
+ *   s_snap.publish(live);       // writer, after updating live
+ *   SensorState copy;
+ *   s_snap.read(copy);          // any task, never blocks
+ */
+
+#ifndef SHARED_SNAPSHOT_H
+#define SHARED_SNAPSHOT_H
+
+#include <stdint.h>
+#include <string.h>
+
+/** @brief Compiler barrier: no memory access is moved across it. */
+#define SHARED_SNAPSHOT_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/**
+ * @class SharedSnapshot
+ * @brief Double-buffered snapshot of a T; wait-free publish(), lock-free read().
+ *
+ * @tparam T Trivially copyable value type.
+ */
+template <typename T>
+class SharedSnapshot {
+public:
+    /** @brief Zero-filled until the first publish() (version() == 0). */
+    SharedSnapshot() : _seq(0) {
+        memset(_copy, 0, sizeof(_copy));
+    }
+
+    /** @brief Replace the value; the single writer only. Never blocks. */
+    void publish(const T &value) {
+        uint8_t seq = _seq;
+        _seq = (uint8_t)(seq + 1);  // Odd: readers switch to copy[1]
+        SHARED_SNAPSHOT_BARRIER();
+        memcpy(&_copy[0], &value, sizeof(T));
+        SHARED_SNAPSHOT_BARRIER();
+        _seq = (uint8_t)(seq + 2);  // Even: readers switch back to copy[0]
+        SHARED_SNAPSHOT_BARRIER();
+        memcpy(&_copy[1], &value, sizeof(T));
+        SHARED_SNAPSHOT_BARRIER();
+    }
+
+    /**
+     * @brief Copy the latest complete value into out.
+     *
+     * Retries only while being preempted by publish().
+     *
+     * @return Version of the copy (see version()).
+     */
+    uint8_t read(T &out) const {
+        uint8_t seq;
+        do {
+            seq = _seq;
+            SHARED_SNAPSHOT_BARRIER();
+            memcpy(&out, &_copy[seq & 1], sizeof(T));
+            SHARED_SNAPSHOT_BARRIER();
+        } while (_seq != seq);
+        return (uint8_t)(seq >> 1);
+    }
+
+    /**
+     * @brief Completed publishes, mod 128.
+     *
+     * A reader can compare it with the value returned by its last read()
+     * to skip unchanged data.
+     */
+    uint8_t version() const { return (uint8_t)(_seq >> 1); }
+
+private:
+    volatile uint8_t _seq;
+    T _copy[2];
+};
+
+#endif // SHARED_SNAPSHOT_H
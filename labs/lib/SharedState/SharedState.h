@@ -0,0 +1,176 @@
+/**
+ * @file SharedState.h
+ * @brief Mutex-Guarded Shared Struct with Scoped Locks and Field-Group Sub-Locks
+ *
+ * Replaces the per-lab Lock()/Get()/Unlock() trio around a global struct.
+ * The struct lives inside the object and is reachable only through a lock:
+ *
+ *   SharedState<T>::Lock s(state);   scoped: taken here, released at the }
+ *   s->field = ...;                  (also on early return/continue/break)
+ *
+ *   state.update([](T &s) { s.requested = true; });    one short write
+ *   state.read([&](const T &s) { on = s.relayOn; });   one short read
+ *   state.snapshot(&copy);                             whole-struct copy
+ *
+ * Sub-locks: with Groups > 1 every field group has its own mutex, and a
+ * lock names the groups (bit i = group i) it needs:
+ *
+ *   SharedState<T, 2>::Lock s(state, GROUP_INPUT);     input fields only
+ *
+ * so a task editing one group does not wait for a task busy with another.
+ * Which fields belong to which group is the application's convention
+ * (document it at the struct). The default, SHARED_STATE_ALL, takes every
+ * group. Groups are always taken in ascending order and released in
+ * reverse, which cannot deadlock as long as a task holds one Lock at a
+ * time: ask for every group needed up front instead of nesting.
+ *
+ * An optional release hook sees the struct as each lock holder leaves it,
+ * still under the lock (e.g. to publish a SharedSnapshot for lock-free
+ * readers). It runs only when every group is held, since only then is
+ * the struct consistent as a whole.
+ *
+ * Mutexes come from StaticRtos (no heap with static allocation) and are
+ * taken with portMAX_DELAY; create with init() in setup(), before the
+ * scheduler starts.
+ *
+ * Usage:
+ *   static SharedState<Lab5ControlState> s_state;
+ *   s_state.init(initial);                        // setup()
+ *   {
+ *       SharedState<Lab5ControlState>::Lock state(s_state);
+ *       state->sampleCount++;
+ *   }
+ */
+
+#ifndef SHARED_STATE_LIB_H
+#define SHARED_STATE_LIB_H
+
+#include <Arduino_FreeRTOS.h>
+#include <semphr.h>
+#include <stdint.h>
+
+#include "StaticRtos.h"
+
+/** @brief Group mask selecting every group. */
+#define SHARED_STATE_ALL 0xFF
+
+/**
+ * @class SharedState
+ * @brief A T guarded by one mutex per field group.
+ *
+ * @tparam T      Shared struct (copied by assignment in snapshot()).
+ * @tparam Groups Field groups with their own mutex, 1..8.
+ */
+template <typename T, uint8_t Groups = 1>
+class SharedState {
+    static_assert(Groups >= 1 && Groups <= 8, "SharedState supports 1..8 field groups");
+
+public:
+    /** @brief Called with the state, under the full lock, as it is released. */
+    typedef void (*ReleaseHook)(const T &state, void *context);
+
+    SharedState() : _hook(NULL), _hookContext(NULL) {
+        for (uint8_t g = 0; g < Groups; g++) {
+            _mutex[g] = NULL;
+        }
+    }
+
+    /**
+     * @brief Set the initial value and create the mutexes.
+     * @return false if a mutex could not be created (heap fallback only).
+     */
+    bool init(const T &initial) {
+        _data = initial;
+        bool ok = true;
+        for (uint8_t g = 0; g < Groups; g++) {
+            _mutex[g] = _mutexStorage[g].create();
+            ok = ok && (_mutex[g] != NULL);
+        }
+        return ok;
+    }
+
+    /** @brief Install the release hook (setup(), before the tasks run). */
+    void setReleaseHook(ReleaseHook hook, void *context = NULL) {
+        _hook = hook;
+        _hookContext = context;
+    }
+
+    /**
+     * @class Lock
+     * @brief Scoped lock on some or all field groups; access the struct through it.
+     */
+    class Lock {
+    public:
+        /** @param groups Group mask (bit i = group i); SHARED_STATE_ALL = all. */
+        explicit Lock(SharedState &state, uint8_t groups = SHARED_STATE_ALL)
+            : _state(state), _groups(state.lock(groups)) {}
+
+        ~Lock() { _state.unlock(_groups); }
+
+        T *operator->() { return &_state._data; }
+        T &operator*() { return _state._data; }
+        T *get() { return &_state._data; }
+
+    private:
+        Lock(const Lock &);
+        Lock &operator=(const Lock &);
+
+        SharedState &_state;
+        uint8_t      _groups;
+    };
+
+    /** @brief Run fn(T &) with the groups locked. */
+    template <typename F>
+    void update(F fn, uint8_t groups = SHARED_STATE_ALL) {
+        Lock state(*this, groups);
+        fn(*state);
+    }
+
+    /** @brief Run fn(const T &) with the groups locked. */
+    template <typename F>
+    void read(F fn, uint8_t groups = SHARED_STATE_ALL) {
+        Lock state(*this, groups);
+        fn((const T &)*state);
+    }
+
+    /** @brief Copy the whole struct under the groups' lock (default: a consistent copy). */
+    void snapshot(T *out, uint8_t groups = SHARED_STATE_ALL) {
+        Lock state(*this, groups);
+        *out = *state;
+    }
+
+private:
+    /** @brief Mask of the groups that exist. */
+    static const uint8_t EXISTING = (uint8_t)((1u << Groups) - 1u);
+
+    /** @brief Take the groups in ascending order; returns the mask taken. */
+    uint8_t lock(uint8_t groups) {
+        groups &= EXISTING;
+        for (uint8_t g = 0; g < Groups; g++) {
+            if (groups & (1u << g)) {
+                xSemaphoreTake(_mutex[g], portMAX_DELAY);
+            }
+        }
+        return groups;
+    }
+
+    /** @brief Release the groups in descending order (hook first, if all are held). */
+    void unlock(uint8_t groups) {
+        if (groups == EXISTING && _hook != NULL) {
+            _hook(_data, _hookContext);
+        }
+        for (uint8_t g = Groups; g-- > 0;) {
+            if (groups & (1u << g)) {
+                xSemaphoreGive(_mutex[g]);
+            }
+        }
+    }
+
+    T                 _data;
+    StaticMutex       _mutexStorage[Groups];
+    SemaphoreHandle_t _mutex[Groups];
+    ReleaseHook       _hook;
+    void             *_hookContext;
+};
+
+#endif // SHARED_STATE_LIB_H
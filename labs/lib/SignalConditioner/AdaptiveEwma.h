@@ -0,0 +1,126 @@
+/**
+ * @file AdaptiveEwma.h
+ * @brief Derivative-adaptive EWMA (One-Euro filter)
+ *
+ * A fixed EWMA alpha trades lag against noise. The One-Euro filter
+ * instead moves its cutoff with the estimated signal derivative:
+ *
+ *   dx     = (x - x_prev) / Te            per-sample slope (units/s)
+ *   dx_hat = EWMA(dx, alpha(dCutoff))     smoothed slope
+ *   fc     = minCutoff + beta * |dx_hat|  adaptive cutoff (Hz)
+ *   alpha  = k / (k + 1), k = 2*pi*fc*Te  first-order low-pass factor
+ *   y     += alpha * (x - y)
+ *
+ * At rest fc stays near minCutoff (heavy smoothing); during a fast
+ * transient fc rises and alpha approaches 1 (near pass-through).
+ *
+ * The constants are folded per sample period so one sample costs one
+ * division: kMin = 2*pi*minCutoff*Te and kBeta = 2*pi*beta, applied to
+ * the slope in units per sample.
+ *
+ * AdaptiveEwma satisfies the ConditioningPipeline stage interface, so it
+ * can replace Ewma<> in a Pipeline; ConditionerBank offers the same law
+ * per channel via configureAdaptive().
+ *
+ * Usage:
+ *   AdaptiveEwma smooth(0.5f, 1.0f, 1.0f, 0.05f);  // 20 Hz samples
+ *   float y = smooth.process(median);
+ *   float alpha = smooth.getAlpha();
+ */
+
+#ifndef ADAPTIVE_EWMA_H
+#define ADAPTIVE_EWMA_H
+
+#include <math.h>
+
+/**
+ * @brief EWMA factor of a first-order low-pass at a given cutoff.
+ * @param cutoffHz Cutoff frequency (Hz).
+ * @param periodS  Sample period (s).
+ */
+inline float oneEuroAlpha(float cutoffHz, float periodS) {
+    float k = 2.0f * (float)M_PI * cutoffHz * periodS;
+    return k / (k + 1.0f);
+}
+
+/**
+ * @brief One step of the adaptive law with pre-folded constants.
+ *
+ * @param dxHat   Smoothed slope state (units per sample), updated.
+ * @param delta   This sample's change (x - x_prev).
+ * @param dAlpha  Slope smoothing factor, oneEuroAlpha(dCutoff, Te).
+ * @param kMin    2*pi*minCutoff*Te.
+ * @param kBeta   2*pi*beta (applied to the per-sample slope).
+ * @return float  Alpha to use for this sample.
+ */
+inline float oneEuroStep(float &dxHat, float delta, float dAlpha,
+                         float kMin, float kBeta) {
+    dxHat += dAlpha * (delta - dxHat);
+    float k = kMin + kBeta * fabsf(dxHat);
+    return k / (k + 1.0f);
+}
+
+/**
+ * @class AdaptiveEwma
+ * @brief EWMA whose alpha follows the signal derivative (One-Euro).
+ */
+class AdaptiveEwma {
+public:
+    typedef float value_type;
+
+    /**
+     * @param minCutoffHz Cutoff at rest (Hz); lower = smoother.
+     * @param beta        Cutoff increase per unit/s of slope (Hz·s/unit).
+     * @param dCutoffHz   Cutoff of the slope estimate (Hz).
+     * @param periodS     Sample period (s).
+     */
+    AdaptiveEwma(float minCutoffHz, float beta, float dCutoffHz, float periodS)
+        : _kMin(2.0f * (float)M_PI * minCutoffHz * periodS),
+          _kBeta(2.0f * (float)M_PI * beta),
+          _dAlpha(oneEuroAlpha(dCutoffHz, periodS)) {
+        reset();
+    }
+
+    float process(float x) {
+        if (!_initialized) {
+            _last = x;
+            _prev = x;
+            _dx = 0.0f;
+            _alpha = _kMin / (_kMin + 1.0f);
+            _initialized = true;
+            return _last;
+        }
+        _alpha = oneEuroStep(_dx, x - _prev, _dAlpha, _kMin, _kBeta);
+        _prev = x;
+        _last += _alpha * (x - _last);
+        return _last;
+    }
+
+    float last() const { return _last; }
+
+    void reset() {
+        _last = 0.0f;
+        _prev = 0.0f;
+        _dx = 0.0f;
+        _alpha = _kMin / (_kMin + 1.0f);
+        _initialized = false;
+    }
+
+    /** @brief Alpha applied to the most recent sample. */
+    float getAlpha() const { return _alpha; }
+
+    /** @brief Smoothed slope estimate (units per sample). */
+    float getSlope() const { return _dx; }
+
+private:
+    float _kMin;
+    float _kBeta;
+    float _dAlpha;
+    float _last;
+    float _prev;
+    float _dx;
+    float _alpha;
+    bool  _initialized;
+};
+
+#endif // ADAPTIVE_EWMA_H
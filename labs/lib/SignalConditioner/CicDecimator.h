@@ -0,0 +1,202 @@
+/**
+ * @file CicDecimator.h
+ * @brief Integer Cascaded-Integrator-Comb Decimator for High-Rate ADC Streams
+ *
+ * A stream of kHz samples is too fast for the per-sample conditioning
+ * pipeline. A CIC decimator reduces it by R = 2^ratioLog2 with additions
+ * only, so it fits into the ADC ISR or a fast task:
+ *
+ *   x ─► N integrators (input rate) ─► ↓R ─► N combs (output rate) ─► y
+ *
+ *   H(z) = ((1 − z^-R) / (1 − z^-1))^N    DC gain R^N = 2^(N·ratioLog2)
+ *
+ * Order 1 is the block sum (AdcEngine's oversampling); each further order
+ * sharpens the stopband (|sinc|^N: aliases of noise and mains hum near
+ * multiples of the output rate are cut by ~13 dB more per order) at the
+ * cost of N·4 bytes of state and N additions per input sample. The
+ * integrators wrap freely (uint32_t two's complement): the combs undo the
+ * wrap as long as the output, inputBits + N·ratioLog2 bits, fits 31 bits.
+ *
+ * Droop compensation (optional): the |sinc|^N passband sags toward the
+ * output Nyquist frequency. A 3-tap FIR at the output rate,
+ *
+ *   y[n] = x[n-1] + c · (2·x[n-1] − x[n] − x[n-2]),  c = N / 24
+ *
+ * has unity DC gain and flattens the sag to second order in frequency,
+ * so a step arrives less rounded. It delays the output by one decimated
+ * sample, may overshoot the input range slightly at a step, and needs
+ * 5 bits of headroom (inputBits + N·ratioLog2 ≤ 26).
+ *
+ * The decimated value feeds the saturate → median → EWMA pipeline once
+ * per output sample, at the input scale (read()) or with fraction bits
+ * kept (readScaled(): the averaging gains ~½ bit per doubling of R, given
+ * at least 1 LSB of noise). Portable C++, no allocation.
+ *
+ * Usage (fast task, 1 kHz in, 62.5 Hz out):
+ *   static CicDecimator<3> s_cic(4);                  // R = 16, order 3
+ *   if (s_cic.push(adcSample)) {
+ *       int32_t counts = s_cic.read();                // 10-bit scale
+ *       float t = cond.process(countsToCelsius(counts));
+ *   }
+ *   // Or with 2 fraction bits into the integer pipeline:
+ *   FixedSignalConditioner fixed(5, 2, 0, 1023L << 2);
+ *   if (s_cic.push(adcSample)) fixed.process(s_cic.readScaled(2));
+ *
+ * AdcEngine runs one per channel in its ISR with -DADC_ENGINE_CIC_ORDER.
+ */
+
+#ifndef CIC_DECIMATOR_H
+#define CIC_DECIMATOR_H
+
+#include <stdint.h>
+
+/**
+ * @class CicDecimator
+ * @brief Order-N CIC decimator by 2^ratioLog2 (differential delay 1).
+ *
+ * @tparam Order Integrator / comb pairs (1..4).
+ */
+template <uint8_t Order>
+class CicDecimator {
+    static_assert(Order >= 1 && Order <= 4, "CIC order must be 1..4");
+
+public:
+    /** @brief Bits of the largest output register (sign bit excluded). */
+    static const uint8_t MAX_BITS = 31;
+
+    /** @brief Headroom the droop compensator needs (c = N/24 on 2 differences). */
+    static const uint8_t COMPENSATE_HEADROOM_BITS = 5;
+
+    /**
+     * @param ratioLog2  Decimation ratio R = 2^ratioLog2 (0..15).
+     * @param compensate Apply the droop-compensating FIR to the output.
+     * @param inputBits  Width of the unsigned input samples (ADC: 10).
+     */
+    explicit CicDecimator(uint8_t ratioLog2 = 0, bool compensate = false, uint8_t inputBits = 10) {
+        configure(ratioLog2, compensate, inputBits);
+    }
+
+    /**
+     * @brief Change the ratio or compensation; restarts the filter.
+     * @return false (and R = 1, no compensation) if the output would not
+     *         fit MAX_BITS, less the compensator headroom.
+     */
+    bool configure(uint8_t ratioLog2, bool compensate = false, uint8_t inputBits = 10) {
+        uint8_t bits = (uint8_t)(inputBits + Order * ratioLog2);
+        uint8_t limit = compensate ? (uint8_t)(MAX_BITS - COMPENSATE_HEADROOM_BITS) : MAX_BITS;
+        bool ok = (ratioLog2 <= 15) && (bits <= limit);
+        _ratioLog2 = ok ? ratioLog2 : 0;
+        _ratio = (uint16_t)(1U << _ratioLog2);
+        _compensate = ok && compensate;
+        reset();
+        return ok;
+    }
+
+    /** @brief Clear the integrators, combs and output. */
+    void reset() {
+        for (uint8_t i = 0; i < Order; i++) {
+            _integrator[i] = 0;
+            _comb[i] = 0;
+        }
+        _phase = 0;
+        _outputs = 0;
+        _history[0] = 0;
+        _history[1] = 0;
+        _last = 0;
+    }
+
+    /**
+     * @brief Add one input sample.
+     * @return true if it completed a decimated output (read it now).
+     */
+    bool push(uint16_t sample) {
+        uint32_t acc = sample;
+        for (uint8_t i = 0; i < Order; i++) {
+            _integrator[i] += acc;
+            acc = _integrator[i];
+        }
+        if (++_phase < _ratio) {
+            return false;
+        }
+        _phase = 0;
+        for (uint8_t i = 0; i < Order; i++) {
+            uint32_t delayed = _comb[i];
+            _comb[i] = acc;
+            acc -= delayed;
+        }
+        int32_t y = (int32_t)acc;
+        if (_outputs < 0xFF) {
+            _outputs++;
+        }
+        if (_compensate) {
+            y = droop(y);
+        }
+        _last = y;
+        return true;
+    }
+
+    /**
+     * @brief Last output at full gain, 2^(Order·ratioLog2) × the input.
+     *
+     * The first Order outputs still fill the combs (the integrators
+     * started from zero, so they read low); isSettled() tells when not.
+     */
+    int32_t raw() const { return _last; }
+
+    /** @brief Last output at the input scale, rounded. */
+    int32_t read() const { return readScaled(0); }
+
+    /**
+     * @brief Last output with fracBits fraction bits kept, rounded.
+     * @param fracBits 0..Order·ratioLog2 (larger values are capped).
+     */
+    int32_t readScaled(uint8_t fracBits) const {
+        uint8_t gain = gainBits();
+        uint8_t shift = (fracBits >= gain) ? 0 : (uint8_t)(gain - fracBits);
+        if (shift == 0) {
+            return _last;
+        }
+        return (_last + ((int32_t)1 << (shift - 1))) >> shift;
+    }
+
+    /** @brief log2 of the DC gain, Order · ratioLog2. */
+    uint8_t gainBits() const { return (uint8_t)(Order * _ratioLog2); }
+
+    /** @brief Decimation ratio log2. */
+    uint8_t getRatioLog2() const { return _ratioLog2; }
+
+    /** @brief The droop compensator is on. */
+    bool isCompensated() const { return _compensate; }
+
+    /** @brief The output reflects whole input blocks only (combs and FIR filled). */
+    bool isSettled() const { return _outputs > Order + (_compensate ? 2 : 0); }
+
+    static constexpr uint8_t getOrder() { return Order; }
+
+private:
+    /** @brief 3-tap droop FIR, c = Order / 24, seeded by the first output. */
+    int32_t droop(int32_t x) {
+        if (_outputs == 1) {
+            _history[0] = x;
+            _history[1] = x;
+        }
+        int32_t x1 = _history[0];
+        int32_t x2 = _history[1];
+        _history[1] = x1;
+        _history[0] = x;
+        int32_t bend = (x1 - x) + (x1 - x2);
+        return x1 + (int32_t)Order * bend / 24;
+    }
+
+    uint32_t _integrator[Order];
+    uint32_t _comb[Order];      ///< Comb delays (the previous decimated integrator output).
+    uint16_t _ratio;            ///< R.
+    uint16_t _phase;            ///< Inputs since the last output.
+    int32_t  _history[2];       ///< Compensator: x[n-1], x[n-2].
+    int32_t  _last;
+    uint8_t  _ratioLog2;
+    uint8_t  _outputs;          ///< Outputs since reset() (saturates).
+    bool     _compensate;
+};
+
+#endif // CIC_DECIMATOR_H
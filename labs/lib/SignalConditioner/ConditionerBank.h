@@ -0,0 +1,258 @@
+/**
+ * @file ConditionerBank.h
+ * @brief Multi-channel Signal Conditioning in Structure-of-Arrays Form
+ *
+ * Runs the saturate → median → EWMA pipeline of SignalConditioner for C
+ * channels with one call. State is stored per stage rather than per
+ * channel object:
+ *
+ *   _window[N][C]   ring slot-major, so one slot of every channel is
+ *                   contiguous and is written in a single pass
+ *   _ewma[C], _alpha[C], _min[C], _max[C], _count[C], _median[C],
+ *   plus per-channel bit masks (EWMA seeded, window full)
+ *
+ * All channels share the ring index and advance together. A channel whose
+ * input is flagged invalid (or is NaN) is reset instead of processed, and
+ * its output is NaN; the returned mask tells which channels have a full
+ * window, replacing per-object isValid() calls.
+ *
+ * A channel can switch from a fixed alpha to the derivative-adaptive
+ * (One-Euro) law of AdaptiveEwma.h with configureAdaptive(); the alpha
+ * applied last is available per channel for diagnostics.
+ *
+ * Usage:
+ *   ConditionerBank<2, 5> bank(0.3f, -40.0f, 125.0f);
+ *   float in[2] = { analogTemp, digitalTemp };
+ *   float out[2];
+ *   uint16_t full = bank.processAll(in, out, inputValidMask);
+ *   float median0 = bank.getLastMedian(0);
+ */
+
+#ifndef CONDITIONER_BANK_H
+#define CONDITIONER_BANK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "MedianWindow.h"
+#include "AdaptiveEwma.h"
+
+/** @brief One bit per channel (bit c = channel c). */
+typedef uint16_t ChannelMask;
+
+/**
+ * @class ConditionerBank
+ * @brief C-channel saturate → median → EWMA conditioner.
+ *
+ * @tparam C Number of channels (1..16).
+ * @tparam N Median window size (odd, 1..15).
+ */
+template <uint8_t C, uint8_t N>
+class ConditionerBank {
+    static_assert(C >= 1 && C <= 16, "bank supports 1..16 channels");
+    static_assert(N >= 1 && N <= 15 && N % 2 == 1, "median window must be odd, 1..15");
+
+public:
+    /** @brief Mask with every channel bit set. */
+    static const ChannelMask ALL_CHANNELS = (ChannelMask)((1UL << C) - 1);
+
+    /**
+     * @brief Construct a bank with the same parameters on every channel.
+     *
+     * @param ewmaAlpha EWMA smoothing factor (0.0–1.0).
+     * @param minClamp  Saturation lower bound.
+     * @param maxClamp  Saturation upper bound.
+     */
+    ConditionerBank(float ewmaAlpha, float minClamp, float maxClamp) {
+        for (uint8_t c = 0; c < C; c++) {
+            _alpha[c] = ewmaAlpha;
+            _min[c]   = minClamp;
+            _max[c]   = maxClamp;
+        }
+        _adaptive = 0;
+        resetAll();
+    }
+
+    /** @brief Override the parameters of one channel. */
+    void configure(uint8_t channel, float ewmaAlpha, float minClamp, float maxClamp) {
+        _alpha[channel] = ewmaAlpha;
+        _min[channel]   = minClamp;
+        _max[channel]   = maxClamp;
+        _adaptive &= (ChannelMask)~(1U << channel);
+    }
+
+    /**
+     * @brief Make a channel's EWMA alpha follow its slope (One-Euro).
+     *
+     * @param channel     Channel index.
+     * @param minCutoffHz Cutoff at rest (Hz).
+     * @param beta        Cutoff increase per unit/s of slope.
+     * @param dCutoffHz   Cutoff of the slope estimate (Hz).
+     * @param periodS     Sample period of processAll() calls (s).
+     */
+    void configureAdaptive(uint8_t channel, float minCutoffHz, float beta,
+                           float dCutoffHz, float periodS) {
+        _kMin[channel]   = 2.0f * (float)M_PI * minCutoffHz * periodS;
+        _kBeta[channel]  = 2.0f * (float)M_PI * beta;
+        _dAlpha[channel] = oneEuroAlpha(dCutoffHz, periodS);
+        _alpha[channel]  = _kMin[channel] / (_kMin[channel] + 1.0f);
+        _slope[channel]  = 0.0f;
+        _adaptive |= (ChannelMask)(1U << channel);
+    }
+
+    /**
+     * @brief Condition one sample on every channel.
+     *
+     * @param in         C raw inputs.
+     * @param out        C conditioned (EWMA) outputs; NaN for skipped channels.
+     * @param inputValid Channels whose input is usable. Others (and NaN
+     *                   inputs) are reset so stale samples do not persist.
+     * @return ChannelMask Channels whose median window is full.
+     */
+    ChannelMask processAll(const float *in, float *out,
+                           ChannelMask inputValid = ALL_CHANNELS) {
+        float *slot = _window[_index];
+
+        // Pass 1: saturate into the current ring slot (contiguous writes).
+        ChannelMask active = 0;
+        for (uint8_t c = 0; c < C; c++) {
+            float x = in[c];
+            if (!(inputValid & (1U << c)) || isnan(x)) {
+                resetChannel(c);
+                continue;
+            }
+            if (x < _min[c]) x = _min[c];
+            if (x > _max[c]) x = _max[c];
+            slot[c] = x;
+            if (_count[c] < N) {
+                _count[c]++;
+            }
+            active |= (ChannelMask)(1U << c);
+        }
+        _index = (_index + 1 == N) ? 0 : _index + 1;
+
+        // Pass 2: median + EWMA per active channel.
+        ChannelMask full = 0;
+        for (uint8_t c = 0; c < C; c++) {
+            if (!(active & (1U << c))) {
+                out[c] = NAN;
+                continue;
+            }
+            float m = channelMedian(c);
+            ChannelMask bit = (ChannelMask)(1U << c);
+            if (!(_seeded & bit)) {
+                _ewma[c] = m;  // Seed on the first sample after a reset
+                _slope[c] = 0.0f;
+                _seeded |= bit;
+            } else {
+                if (_adaptive & bit) {
+                    _alpha[c] = oneEuroStep(_slope[c], m - _median[c],
+                                            _dAlpha[c], _kMin[c], _kBeta[c]);
+                }
+                _ewma[c] += _alpha[c] * (m - _ewma[c]);
+            }
+            _median[c] = m;
+            out[c] = _ewma[c];
+            if (_count[c] >= N) {
+                full |= bit;
+            }
+        }
+        _fullMask = full;
+        return full;
+    }
+
+    /** @brief Channels whose median window was full after the last call. */
+    ChannelMask validMask() const { return _fullMask; }
+
+    /** @brief Last median of a channel. */
+    float getLastMedian(uint8_t channel) const { return _median[channel]; }
+
+    /** @brief Last EWMA (final output) of a channel. */
+    float getLastEwma(uint8_t channel) const { return _ewma[channel]; }
+
+    /** @brief EWMA alpha applied to a channel's last sample. */
+    float getLastAlpha(uint8_t channel) const { return _alpha[channel]; }
+
+    /** @brief Samples held for a channel (0..N). */
+    uint8_t getSampleCount(uint8_t channel) const { return _count[channel]; }
+
+    /** @brief Number of channels (the template parameter). */
+    static constexpr uint8_t channels() { return C; }
+
+    /** @brief Median window size (the template parameter). */
+    static constexpr uint8_t getWindowSize() { return N; }
+
+    /** @brief Clear one channel's window and EWMA state. */
+    void resetChannel(uint8_t channel) {
+        _count[channel]  = 0;
+        _median[channel] = 0.0f;
+        _ewma[channel]   = 0.0f;
+        _slope[channel]  = 0.0f;
+        _fullMask &= (ChannelMask)~(1U << channel);
+        _seeded   &= (ChannelMask)~(1U << channel);
+    }
+
+    /** @brief Clear every channel. */
+    void resetAll() {
+        memset(_window, 0, sizeof(_window));
+        memset(_count, 0, sizeof(_count));
+        memset(_median, 0, sizeof(_median));
+        memset(_ewma, 0, sizeof(_ewma));
+        memset(_slope, 0, sizeof(_slope));
+        _index = 0;
+        _fullMask = 0;
+        _seeded = 0;
+    }
+
+private:
+    float   _window[N][C];  /**< Ring, slot-major.                  */
+    float   _ewma[C];       /**< EWMA state (= last output).        */
+    float   _median[C];     /**< Last median (diagnostics).         */
+    float   _alpha[C];      /**< EWMA factor (current, if adaptive). */
+    float   _kMin[C];       /**< Adaptive: 2*pi*minCutoff*Te.       */
+    float   _kBeta[C];      /**< Adaptive: 2*pi*beta.               */
+    float   _dAlpha[C];     /**< Adaptive: slope smoothing factor.  */
+    float   _slope[C];      /**< Adaptive: smoothed slope / sample. */
+    float   _min[C];        /**< Saturation lower bound.            */
+    float   _max[C];        /**< Saturation upper bound.            */
+    uint8_t _count[C];      /**< Samples since reset (0..N).         */
+    uint8_t _index;         /**< Shared next ring slot.             */
+    ChannelMask _fullMask;  /**< Result of the last processAll().   */
+    ChannelMask _seeded;    /**< Channels whose EWMA is initialized. */
+    ChannelMask _adaptive;  /**< Channels using the One-Euro alpha.  */
+
+    /** @brief Median of the newest _count[c] samples of channel c. */
+    float channelMedian(uint8_t c) const {
+        uint8_t n = _count[c];
+        // The newest sample is at _index - 1; walk backwards n slots.
+        uint8_t s = _index;
+        float v[N];
+        for (uint8_t i = 0; i < n; i++) {
+            s = (s == 0) ? N - 1 : s - 1;
+            v[i] = _window[s][c];
+        }
+
+        if (n == N) {
+            // Full window: order does not matter, use a selection network.
+            switch (N) {
+                case 1: return v[0];
+                case 3: return medianOf3(v[0], v[1], v[2]);
+                case 5: return medianOf5(v[0], v[1], v[2], v[3], v[4 % N]);
+                default: break;
+            }
+        }
+
+        for (uint8_t i = 1; i < n; i++) {
+            float key = v[i];
+            int8_t j = (int8_t)i - 1;
+            while (j >= 0 && v[j] > key) {
+                v[j + 1] = v[j];
+                j--;
+            }
+            v[j + 1] = key;
+        }
+        return v[n / 2];
+    }
+};
+
+#endif // CONDITIONER_BANK_H
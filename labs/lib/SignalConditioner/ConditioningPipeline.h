@@ -0,0 +1,300 @@
+/**
+ * @file ConditioningPipeline.h
+ * @brief Compile-time Composable Conditioning Stages
+ *
+ * Header-only framework for building a per-channel conditioning chain
+ * from independent stages:
+ *
+ *   Pipeline<Saturate<>, Median<5>, Ewma<>, RateLimit<> > p(
+ *       Saturate<>(0.0f, 100.0f), Median<5>(), Ewma<>(0.4f), RateLimit<>(5.0f));
+ *   float out = p.process(raw);
+ *   float median = p.stage<1>().last();   // diagnostics, per stage
+ *
+ * The chain is resolved at compile time: Pipeline<Head, Tail...> holds
+ * the head stage and a Pipeline of the rest, and process() calls each
+ * stage's process() directly, so there are no virtual calls and only
+ * the listed stages cost RAM or cycles.
+ *
+ * A stage is any class that provides:
+ *   typedef ... value_type;        sample type
+ *   value_type process(value_type) run one sample, remember the output
+ *   value_type last() const        output of the most recent process()
+ *   void reset()                   return to the power-up state
+ *
+ * Provided stages: Saturate, Median, Ewma, RateLimit, Deadband.
+ */
+
+#ifndef CONDITIONING_PIPELINE_H
+#define CONDITIONING_PIPELINE_H
+
+#include <stdint.h>
+#include "MedianWindow.h"
+
+// ──────────────────────────────────────────────────────────────────────────
+// Stages
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @class Saturate
+ * @brief Clamp to [min, max]; a NaN input becomes the range midpoint.
+ */
+template <typename T = float>
+class Saturate {
+public:
+    typedef T value_type;
+
+    Saturate(T minClamp, T maxClamp) : _min(minClamp), _max(maxClamp), _last(0) {}
+
+    T process(T x) {
+        if (x != x) {  // NaN (float T only)
+            x = (T)((_min + _max) / 2);
+        } else if (x < _min) {
+            x = _min;
+        } else if (x > _max) {
+            x = _max;
+        }
+        _last = x;
+        return x;
+    }
+
+    T last() const { return _last; }
+    void reset() { _last = 0; }
+
+    T getMinClamp() const { return _min; }
+    T getMaxClamp() const { return _max; }
+
+private:
+    T _min;
+    T _max;
+    T _last;
+};
+
+/**
+ * @class Median
+ * @brief Sliding-window median over the last N samples.
+ *
+ * Window selects the implementation: MedianWindow by default, or a
+ * TwoHeapMedian / HistogramMedian (LargeMedian.h) for long windows.
+ */
+template <uint8_t N, typename T = float, typename Window = MedianWindow<N, T> >
+class Median {
+public:
+    typedef T value_type;
+
+    Median() : _last(0) {}
+
+    T process(T x) {
+        _last = _window.push(x);
+        return _last;
+    }
+
+    T last() const { return _last; }
+    void reset() {
+        _window.reset();
+        _last = 0;
+    }
+
+    /** @brief True once the window holds N samples. */
+    bool isValid() const { return _window.isFull(); }
+    uint8_t getSampleCount() const { return _window.count(); }
+    static constexpr uint8_t getWindowSize() { return N; }
+
+private:
+    Window _window;
+    T _last;
+};
+
+/**
+ * @class Ewma
+ * @brief First-order IIR smoothing: y += alpha * (x - y), seeded by the
+ *        first sample.
+ */
+template <typename T = float>
+class Ewma {
+public:
+    typedef T value_type;
+
+    explicit Ewma(float alpha) : _alpha(alpha), _last(0), _initialized(false) {}
+
+    T process(T x) {
+        if (!_initialized) {
+            _last = x;
+            _initialized = true;
+        } else {
+            _last = (T)(_last + (x - _last) * _alpha);
+        }
+        return _last;
+    }
+
+    T last() const { return _last; }
+    void reset() {
+        _last = 0;
+        _initialized = false;
+    }
+
+    float getAlpha() const { return _alpha; }
+
+private:
+    float _alpha;
+    T     _last;
+    bool  _initialized;
+};
+
+/**
+ * @class RateLimit
+ * @brief Move toward the input by at most maxStep per sample (ramping),
+ *        seeded by the first sample.
+ */
+template <typename T = float>
+class RateLimit {
+public:
+    typedef T value_type;
+
+    explicit RateLimit(T maxStep) : _maxStep(maxStep), _last(0), _initialized(false) {}
+
+    T process(T x) {
+        if (!_initialized) {
+            _last = x;
+            _initialized = true;
+        } else if (x > _last + _maxStep) {
+            _last = _last + _maxStep;
+        } else if (x < _last - _maxStep) {
+            _last = _last - _maxStep;
+        } else {
+            _last = x;
+        }
+        return _last;
+    }
+
+    T last() const { return _last; }
+    void reset() {
+        _last = 0;
+        _initialized = false;
+    }
+
+private:
+    T    _maxStep;
+    T    _last;
+    bool _initialized;
+};
+
+/**
+ * @class Deadband
+ * @brief Hold the output until the input moves more than width away
+ *        from it, suppressing small jitter. Seeded by the first sample.
+ */
+template <typename T = float>
+class Deadband {
+public:
+    typedef T value_type;
+
+    explicit Deadband(T width) : _width(width), _last(0), _initialized(false) {}
+
+    T process(T x) {
+        if (!_initialized || x > _last + _width || x < _last - _width) {
+            _last = x;
+            _initialized = true;
+        }
+        return _last;
+    }
+
+    T last() const { return _last; }
+    void reset() {
+        _last = 0;
+        _initialized = false;
+    }
+
+private:
+    T    _width;
+    T    _last;
+    bool _initialized;
+};
+
+// ──────────────────────────────────────────────────────────────────────────
+// Pipeline
+// ──────────────────────────────────────────────────────────────────────────
+
+template <typename... Stages>
+class Pipeline;
+
+/** @brief Index-based stage lookup (implementation detail of stage<I>()). */
+template <uint8_t I, typename P>
+struct PipelineStageAt;
+
+/**
+ * @class Pipeline
+ * @brief Ordered chain of stages; each output feeds the next stage.
+ */
+template <typename Head, typename... Tail>
+class Pipeline<Head, Tail...> {
+public:
+    typedef typename Head::value_type value_type;
+
+    /** @brief Build from configured stage instances, in order. */
+    Pipeline(const Head &head, const Tail &... tail) : _head(head), _tail(tail...) {}
+
+    /** @brief Run one sample through every stage. */
+    value_type process(value_type x) { return _tail.process(_head.process(x)); }
+
+    /** @brief Output of the final stage. */
+    value_type last() const { return _tail.lastOr(_head.last()); }
+
+    /** @brief Reset every stage. */
+    void reset() {
+        _head.reset();
+        _tail.reset();
+    }
+
+    /** @brief Access stage I (0 = first) for diagnostics or tuning. */
+    template <uint8_t I>
+    typename PipelineStageAt<I, Pipeline>::type &stage() {
+        return PipelineStageAt<I, Pipeline>::get(*this);
+    }
+
+    template <uint8_t I>
+    const typename PipelineStageAt<I, Pipeline>::type &stage() const {
+        return PipelineStageAt<I, Pipeline>::get(const_cast<Pipeline &>(*this));
+    }
+
+    /** @brief Number of stages. */
+    static constexpr uint8_t size() { return 1 + sizeof...(Tail); }
+
+    Head &head() { return _head; }
+    Pipeline<Tail...> &tail() { return _tail; }
+
+    /// Used by the enclosing Pipeline::last().
+    value_type lastOr(value_type) const { return last(); }
+
+private:
+    Head _head;
+    Pipeline<Tail...> _tail;
+};
+
+/** @brief Empty tail: identity. */
+template <>
+class Pipeline<> {
+public:
+    template <typename T>
+    T process(T x) { return x; }
+
+    template <typename T>
+    T lastOr(T previous) const { return previous; }
+
+    void reset() {}
+};
+
+template <typename Head, typename... Tail>
+struct PipelineStageAt<0, Pipeline<Head, Tail...> > {
+    typedef Head type;
+    static type &get(Pipeline<Head, Tail...> &p) { return p.head(); }
+};
+
+template <uint8_t I, typename Head, typename... Tail>
+struct PipelineStageAt<I, Pipeline<Head, Tail...> > {
+    typedef typename PipelineStageAt<I - 1, Pipeline<Tail...> >::type type;
+    static type &get(Pipeline<Head, Tail...> &p) {
+        return PipelineStageAt<I - 1, Pipeline<Tail...> >::get(p.tail());
+    }
+};
+
+#endif // CONDITIONING_PIPELINE_H
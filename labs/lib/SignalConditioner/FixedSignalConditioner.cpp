@@ -0,0 +1,171 @@
+/**
+ * @file FixedSignalConditioner.cpp
+ * @brief Integer Signal Conditioning Pipeline Implementation
+ *
+ * Same pipeline as SignalConditioner.cpp, with every stage in integer
+ * arithmetic:
+ * - Saturation: two int32 compares
+ * - Median: binary search + memmove on the incrementally sorted window
+ * - EWMA: acc += x - (acc >> k), output acc >> k (alpha = 1/2^k)
+ */
+
+#include "FixedSignalConditioner.h"
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Constructor
+// ──────────────────────────────────────────────────────────────────────────
+
+FixedSignalConditioner::FixedSignalConditioner(uint8_t medianWindowSize, uint8_t alphaShift,
+                                               int32_t minClamp, int32_t maxClamp)
+    : _windowSize(medianWindowSize == 0 ? 1
+                  : (medianWindowSize > MAX_WINDOW_SIZE ? MAX_WINDOW_SIZE
+                                                        : medianWindowSize)),
+      _count(0),
+      _index(0),
+      _alphaShift(alphaShift > MAX_ALPHA_SHIFT ? MAX_ALPHA_SHIFT : alphaShift),
+      _ewmaAcc(0),
+      _ewmaInitialized(false),
+      _minClamp(minClamp),
+      _maxClamp(maxClamp),
+      _lastRaw(0),
+      _lastSaturated(0),
+      _lastMedian(0),
+      _lastEwma(0) {
+    memset(_window, 0, sizeof(_window));
+    memset(_sorted, 0, sizeof(_sorted));
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Full pipeline — saturate → median → EWMA
+// ──────────────────────────────────────────────────────────────────────────
+
+int32_t FixedSignalConditioner::process(int32_t rawValue) {
+    _lastRaw = rawValue;
+
+    // ── Saturation ──────────────────────────────────────────────────────
+    int32_t saturated = rawValue;
+    if (saturated < _minClamp) saturated = _minClamp;
+    if (saturated > _maxClamp) saturated = _maxClamp;
+    _lastSaturated = saturated;
+
+    // ── Median filter ───────────────────────────────────────────────────
+    bool full = (_count >= _windowSize);
+    updateSorted(_window[_index], saturated, full);
+    _window[_index] = saturated;
+    _index = (_index + 1 == _windowSize) ? 0 : _index + 1;
+    if (!full) {
+        _count++;
+    }
+    _lastMedian = _sorted[_count / 2];
+
+    // ── EWMA (shift/add) ────────────────────────────────────────────────
+    if (!_ewmaInitialized) {
+        _ewmaAcc = _lastMedian << _alphaShift;
+        _ewmaInitialized = true;
+    } else {
+        _ewmaAcc += _lastMedian - (_ewmaAcc >> _alphaShift);
+    }
+    _lastEwma = _ewmaAcc >> _alphaShift;
+
+    return _lastEwma;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Sorted window maintenance
+// ──────────────────────────────────────────────────────────────────────────
+
+uint8_t FixedSignalConditioner::lowerBound(int32_t value, uint8_t n) const {
+    uint8_t lo = 0;
+    uint8_t hi = n;
+    while (lo < hi) {
+        uint8_t mid = (uint8_t)((lo + hi) / 2);
+        if (_sorted[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void FixedSignalConditioner::updateSorted(int32_t evicted, int32_t incoming, bool full) {
+    if (!full) {
+        uint8_t pos = lowerBound(incoming, _count);
+        memmove(&_sorted[pos + 1], &_sorted[pos], (_count - pos) * sizeof(int32_t));
+        _sorted[pos] = incoming;
+        return;
+    }
+
+    uint8_t out = lowerBound(evicted, _count);
+    uint8_t in  = lowerBound(incoming, _count);
+
+    if (in > out) {
+        in--;
+        memmove(&_sorted[out], &_sorted[out + 1], (in - out) * sizeof(int32_t));
+    } else {
+        memmove(&_sorted[in + 1], &_sorted[in], (out - in) * sizeof(int32_t));
+    }
+    _sorted[in] = incoming;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Getters — intermediate values for diagnostic reporting
+// ──────────────────────────────────────────────────────────────────────────
+
+int32_t FixedSignalConditioner::getLastRaw() const {
+    return _lastRaw;
+}
+
+int32_t FixedSignalConditioner::getLastSaturated() const {
+    return _lastSaturated;
+}
+
+int32_t FixedSignalConditioner::getLastMedian() const {
+    return _lastMedian;
+}
+
+int32_t FixedSignalConditioner::getLastEwma() const {
+    return _lastEwma;
+}
+
+uint8_t FixedSignalConditioner::getWindowSize() const {
+    return _windowSize;
+}
+
+uint8_t FixedSignalConditioner::getAlphaShift() const {
+    return _alphaShift;
+}
+
+int32_t FixedSignalConditioner::getMinClamp() const {
+    return _minClamp;
+}
+
+int32_t FixedSignalConditioner::getMaxClamp() const {
+    return _maxClamp;
+}
+
+bool FixedSignalConditioner::isValid() const {
+    return _count >= _windowSize;
+}
+
+uint8_t FixedSignalConditioner::getSampleCount() const {
+    return _count;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Reset
+// ──────────────────────────────────────────────────────────────────────────
+
+void FixedSignalConditioner::reset() {
+    memset(_window, 0, sizeof(_window));
+    memset(_sorted, 0, sizeof(_sorted));
+    _count = 0;
+    _index = 0;
+    _ewmaAcc = 0;
+    _ewmaInitialized = false;
+    _lastRaw = 0;
+    _lastSaturated = 0;
+    _lastMedian = 0;
+    _lastEwma = 0;
+}
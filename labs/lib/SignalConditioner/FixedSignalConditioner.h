@@ -0,0 +1,148 @@
+/**
+ * @file FixedSignalConditioner.h
+ * @brief Integer Signal Conditioning Pipeline Interface
+ *
+ * Fixed-point counterpart of SignalConditioner for MCUs without an FPU.
+ * The same three stages run on int32_t samples, so the pipeline costs a
+ * few integer compares, one small shift of the sorted window and a
+ * shift/add EWMA instead of soft-float calls:
+ *
+ *   raw → saturate → median → EWMA → conditioned output
+ *
+ * Samples may be raw ADC counts or any Q-format (e.g. Q16.16 or Q8.8);
+ * the class never interprets the binary point. The EWMA factor is a
+ * power of two, alpha = 1 / 2^alphaShift (0 → 1.0, 1 → 0.5, 2 → 0.25,
+ * 3 → 0.125 ...), which turns alpha*x + (1-alpha)*y into y += (x-y)>>k.
+ * The EWMA keeps alphaShift extra fractional bits internally, so slow
+ * filters do not stall on truncation.
+ *
+ * Range: |samples| must stay below 2^(31 - alphaShift).
+ *
+ * Usage:
+ *   // NTC channel in Q16.16 degrees C, alpha = 0.25
+ *   FixedSignalConditioner cond(5, 2, q16FromFloat(-40.0f), q16FromFloat(125.0f));
+ *   int32_t conditioned = cond.process(q16FromFloat(rawTemperature));
+ *
+ *   // ADC counts directly, alpha = 0.125
+ *   FixedSignalConditioner adc(9, 3, 0, 1023);
+ *   int32_t counts = adc.process(analogRead(A0));
+ */
+
+#ifndef FIXED_SIGNAL_CONDITIONER_H
+#define FIXED_SIGNAL_CONDITIONER_H
+
+#include <Arduino.h>
+
+/** @brief Convert a float to Q16.16 (for constants and sensor drivers). */
+constexpr int32_t q16FromFloat(float value) {
+    return (int32_t)(value * 65536.0f + (value < 0.0f ? -0.5f : 0.5f));
+}
+
+/** @brief Convert a Q16.16 value to float (for reporting only). */
+inline float q16ToFloat(int32_t value) {
+    return (float)value * (1.0f / 65536.0f);
+}
+
+/**
+ * @class FixedSignalConditioner
+ * @brief Integer conditioning pipeline (saturate → median → EWMA).
+ *
+ * Mirrors the SignalConditioner API with int32_t values. The median
+ * window is a fixed circular buffer with an incrementally sorted copy;
+ * no dynamic memory is allocated.
+ */
+class FixedSignalConditioner {
+public:
+    /** Maximum supported median window size (fixed array, no heap). */
+    static const uint8_t MAX_WINDOW_SIZE = 31;
+
+    /** Largest supported alphaShift (alpha = 1/32768). */
+    static const uint8_t MAX_ALPHA_SHIFT = 15;
+
+    /**
+     * @brief Construct a new FixedSignalConditioner object.
+     *
+     * @param medianWindowSize Number of samples in the median filter window
+     *                         (should be odd, <= MAX_WINDOW_SIZE).
+     * @param alphaShift       EWMA factor as alpha = 1 / 2^alphaShift.
+     * @param minClamp         Minimum valid value (saturation lower bound).
+     * @param maxClamp         Maximum valid value (saturation upper bound).
+     */
+    FixedSignalConditioner(uint8_t medianWindowSize, uint8_t alphaShift,
+                           int32_t minClamp, int32_t maxClamp);
+
+    /**
+     * @brief Process a raw sample through the full pipeline.
+     *
+     * @param rawValue The raw sample (counts or Q-format).
+     * @return int32_t The conditioned output value (after EWMA).
+     */
+    int32_t process(int32_t rawValue);
+
+    /** @brief Last raw input value. */
+    int32_t getLastRaw() const;
+
+    /** @brief Last saturated value (after clamping, before median). */
+    int32_t getLastSaturated() const;
+
+    /** @brief Last median-filtered value (after median, before EWMA). */
+    int32_t getLastMedian() const;
+
+    /** @brief Last EWMA value (final conditioned output). */
+    int32_t getLastEwma() const;
+
+    /** @brief Configured median window size. */
+    uint8_t getWindowSize() const;
+
+    /** @brief Configured EWMA shift (alpha = 1 / 2^shift). */
+    uint8_t getAlphaShift() const;
+
+    /** @brief Configured minimum saturation bound. */
+    int32_t getMinClamp() const;
+
+    /** @brief Configured maximum saturation bound. */
+    int32_t getMaxClamp() const;
+
+    /**
+     * @brief Check if the median window has been completely filled.
+     * @return true if the sample count >= window size.
+     */
+    bool isValid() const;
+
+    /** @brief Samples received so far (saturates at window size). */
+    uint8_t getSampleCount() const;
+
+    /** @brief Clear the window and the EWMA state. */
+    void reset();
+
+private:
+    // ── Median filter state ─────────────────────────────────────────────
+    int32_t _window[MAX_WINDOW_SIZE]; /**< Circular buffer (arrival order). */
+    int32_t _sorted[MAX_WINDOW_SIZE]; /**< Same samples, ascending.       */
+    uint8_t _windowSize;              /**< Configured window size.        */
+    uint8_t _count;                   /**< Samples received (0..windowSz).*/
+    uint8_t _index;                   /**< Next write position in buffer. */
+
+    // ── EWMA state ──────────────────────────────────────────────────────
+    uint8_t _alphaShift;              /**< alpha = 1 / 2^_alphaShift.     */
+    int32_t _ewmaAcc;                 /**< EWMA scaled by 2^_alphaShift.  */
+    bool    _ewmaInitialized;         /**< True after first sample.       */
+
+    // ── Saturation bounds ───────────────────────────────────────────────
+    int32_t _minClamp;                /**< Lower saturation bound.        */
+    int32_t _maxClamp;                /**< Upper saturation bound.        */
+
+    // ── Intermediate values for diagnostic reporting ────────────────────
+    int32_t _lastRaw;                 /**< Last raw input.                */
+    int32_t _lastSaturated;           /**< After saturation.              */
+    int32_t _lastMedian;              /**< After median filter.           */
+    int32_t _lastEwma;                /**< After EWMA (final output).     */
+
+    /** @brief First index in _sorted[0..n) not less than value. */
+    uint8_t lowerBound(int32_t value, uint8_t n) const;
+
+    /** @brief Replace evicted by incoming in the sorted window. */
+    void updateSorted(int32_t evicted, int32_t incoming, bool full);
+};
+
+#endif // FIXED_SIGNAL_CONDITIONER_H
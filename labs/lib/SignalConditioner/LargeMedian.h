@@ -0,0 +1,298 @@
+/**
+ * @file LargeMedian.h
+ * @brief Sliding Median Windows for Large Sample Counts (31–255)
+ *
+ * Drop-in alternatives to MedianWindow for windows that are too long
+ * for a sorted copy (whose per-sample shift grows with N):
+ *
+ *   TwoHeapMedian<N, T>     any ordered sample type; a max-heap of the
+ *                           lower half and a min-heap of the upper half,
+ *                           indexed by ring slot so the evicted sample can
+ *                           be removed in place. O(log N) per sample.
+ *
+ *   HistogramMedian<N, B>   raw integer counts 0..B-1 (e.g. 10-bit ADC,
+ *                           B = 1024); one counter byte per value and a
+ *                           median pointer that walks one bin at a time.
+ *                           Constant work per sample for a signal that
+ *                           moves by a few counts; bounded by B.
+ *
+ * Both expose the MedianWindow interface (push, median, isFull, count,
+ * size, reset), so they plug into StaticSignalConditioner and the Median
+ * pipeline stage through their Window parameter and keep the same
+ * diagnostic getters. For even sample counts during warm-up the
+ * upper-middle element is returned, as everywhere else in this library.
+ *
+ * Usage:
+ *   StaticSignalConditioner<101, float, TwoHeapMedian<101> > cond(0.2f, 0.0f, 50.0f);
+ *   float out = cond.process(current);
+ *
+ *   Pipeline<Saturate<uint16_t>, Median<63, uint16_t, HistogramMedian<63> > > adc(
+ *       Saturate<uint16_t>(0, 1023), Median<63, uint16_t, HistogramMedian<63> >());
+ */
+
+#ifndef LARGE_MEDIAN_H
+#define LARGE_MEDIAN_H
+
+#include <stdint.h>
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Two-heap median (floats and other ordered types)
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @class TwoHeapMedian
+ * @brief Sliding-window median over two slot-indexed binary heaps.
+ *
+ * Invariant: every sample in the lower (max) heap is <= every sample in
+ * the upper (min) heap, and the upper heap holds ceil(count / 2) samples,
+ * so the median is the top of the upper heap.
+ *
+ * RAM: N samples + N position bytes + 2 * (N / 2 + 1) heap bytes.
+ *
+ * @tparam N Window size (odd, 1..255).
+ * @tparam T Sample type (must support <).
+ */
+template <uint8_t N, typename T = float>
+class TwoHeapMedian {
+    static_assert(N >= 1 && N % 2 == 1, "median window must be odd, 1..255");
+
+public:
+    TwoHeapMedian() { reset(); }
+
+    /**
+     * @brief Add a sample (evicting the oldest once full).
+     * @return T Median of the current window.
+     */
+    T push(T sample) {
+        uint8_t slot = _index;
+        if (_count >= N) {
+            removeSlot(slot);
+            rebalance();
+        } else {
+            _count++;
+        }
+        _value[slot] = sample;
+        if (_hiSize == 0 || !(sample < _value[_hi[0]])) {
+            heapPush(true, slot);
+        } else {
+            heapPush(false, slot);
+        }
+        rebalance();
+        _index = (_index + 1 == N) ? 0 : _index + 1;
+        return median();
+    }
+
+    /** @brief Median of the current contents (0 if empty). */
+    T median() const { return (_hiSize == 0) ? (T)0 : _value[_hi[0]]; }
+
+    /** @brief True once N samples have been received. */
+    bool isFull() const { return _count >= N; }
+
+    /** @brief Samples received so far (saturates at N). */
+    uint8_t count() const { return _count; }
+
+    /** @brief Window size (the template parameter). */
+    static constexpr uint8_t size() { return N; }
+
+    /** @brief Clear all samples. */
+    void reset() {
+        memset(_value, 0, sizeof(_value));
+        _count = 0;
+        _index = 0;
+        _loSize = 0;
+        _hiSize = 0;
+    }
+
+private:
+    static const uint8_t HEAP_CAP = N / 2 + 1;
+    static const uint8_t HI_FLAG  = 0x80;   /**< _pos bit: slot is in _hi.   */
+    static const uint8_t POS_MASK = 0x7F;   /**< _pos bits: heap index.      */
+
+    T       _value[N];         /**< Samples by ring slot.                 */
+    uint8_t _pos[N];           /**< Heap membership/index of each slot.   */
+    uint8_t _lo[HEAP_CAP];     /**< Max-heap of slots (lower half).        */
+    uint8_t _hi[HEAP_CAP];     /**< Min-heap of slots (upper half).        */
+    uint8_t _loSize;
+    uint8_t _hiSize;
+    uint8_t _count;            /**< Samples received (0..N).               */
+    uint8_t _index;            /**< Next ring slot (= oldest once full).   */
+
+    uint8_t *heap(bool hi) { return hi ? _hi : _lo; }
+    uint8_t &heapSize(bool hi) { return hi ? _hiSize : _loSize; }
+
+    /** @brief True if slot a belongs nearer the top than slot b. */
+    bool above(bool hi, uint8_t a, uint8_t b) const {
+        return hi ? (_value[a] < _value[b]) : (_value[b] < _value[a]);
+    }
+
+    void place(bool hi, uint8_t i, uint8_t slot) {
+        heap(hi)[i] = slot;
+        _pos[slot] = (uint8_t)(i | (hi ? HI_FLAG : 0));
+    }
+
+    void siftUp(bool hi, uint8_t i) {
+        uint8_t *h = heap(hi);
+        while (i > 0) {
+            uint8_t parent = (uint8_t)((i - 1) / 2);
+            if (!above(hi, h[i], h[parent])) {
+                break;
+            }
+            uint8_t s = h[i];
+            place(hi, i, h[parent]);
+            place(hi, parent, s);
+            i = parent;
+        }
+    }
+
+    void siftDown(bool hi, uint8_t i) {
+        uint8_t *h = heap(hi);
+        uint8_t n = heapSize(hi);
+        for (;;) {
+            uint16_t child = (uint16_t)(2 * i + 1);
+            if (child >= n) {
+                break;
+            }
+            if (child + 1 < n && above(hi, h[child + 1], h[child])) {
+                child++;
+            }
+            if (!above(hi, h[child], h[i])) {
+                break;
+            }
+            uint8_t s = h[i];
+            place(hi, i, h[child]);
+            place(hi, (uint8_t)child, s);
+            i = (uint8_t)child;
+        }
+    }
+
+    void heapPush(bool hi, uint8_t slot) {
+        uint8_t i = heapSize(hi)++;
+        place(hi, i, slot);
+        siftUp(hi, i);
+    }
+
+    uint8_t heapPop(bool hi) {
+        uint8_t top = heap(hi)[0];
+        uint8_t n = --heapSize(hi);
+        if (n > 0) {
+            place(hi, 0, heap(hi)[n]);
+            siftDown(hi, 0);
+        }
+        return top;
+    }
+
+    /** @brief Remove the sample in a ring slot from whichever heap holds it. */
+    void removeSlot(uint8_t slot) {
+        bool hi = (_pos[slot] & HI_FLAG) != 0;
+        uint8_t i = _pos[slot] & POS_MASK;
+        uint8_t n = --heapSize(hi);
+        if (i < n) {
+            uint8_t moved = heap(hi)[n];
+            place(hi, i, moved);
+            siftUp(hi, i);
+            siftDown(hi, _pos[moved] & POS_MASK);
+        }
+    }
+
+    /** @brief Restore hiSize == loSize or loSize + 1. */
+    void rebalance() {
+        if (_hiSize > _loSize + 1) {
+            heapPush(false, heapPop(true));
+        } else if (_loSize > _hiSize) {
+            heapPush(true, heapPop(false));
+        }
+    }
+};
+
+// ──────────────────────────────────────────────────────────────────────────
+// Histogram median (bounded integer counts)
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @class HistogramMedian
+ * @brief Sliding-window median of integer counts via a value histogram.
+ *
+ * Samples at or above BINS are counted in the top bin; saturate upstream
+ * to keep the median exact. RAM: BINS + 2 * N bytes.
+ *
+ * @tparam N    Window size (odd, 1..255).
+ * @tparam BINS Number of distinct values (e.g. 1024 for a 10-bit ADC).
+ */
+template <uint8_t N, uint16_t BINS = 1024>
+class HistogramMedian {
+    static_assert(N >= 1 && N % 2 == 1, "median window must be odd, 1..255");
+    static_assert(BINS >= 2, "histogram needs at least two bins");
+
+public:
+    HistogramMedian() { reset(); }
+
+    /**
+     * @brief Add a sample (evicting the oldest once full).
+     * @return uint16_t Median of the current window.
+     */
+    uint16_t push(uint16_t sample) {
+        if (sample >= BINS) {
+            sample = BINS - 1;
+        }
+        if (_count >= N) {
+            uint16_t old = _window[_index];
+            _hist[old]--;
+            if (old < _median) {
+                _below--;
+            }
+        } else {
+            _count++;
+        }
+        _window[_index] = sample;
+        _index = (_index + 1 == N) ? 0 : _index + 1;
+        _hist[sample]++;
+        if (sample < _median) {
+            _below++;
+        }
+
+        // Walk the pointer until bin _median holds rank _count / 2.
+        uint8_t rank = _count / 2;
+        while (_below > rank) {
+            _median--;
+            _below -= _hist[_median];
+        }
+        while ((uint16_t)_below + _hist[_median] <= rank) {
+            _below += _hist[_median];
+            _median++;
+        }
+        return _median;
+    }
+
+    /** @brief Median of the current contents (0 if empty). */
+    uint16_t median() const { return (_count == 0) ? 0 : _median; }
+
+    /** @brief True once N samples have been received. */
+    bool isFull() const { return _count >= N; }
+
+    /** @brief Samples received so far (saturates at N). */
+    uint8_t count() const { return _count; }
+
+    /** @brief Window size (the template parameter). */
+    static constexpr uint8_t size() { return N; }
+
+    /** @brief Clear all samples. */
+    void reset() {
+        memset(_hist, 0, sizeof(_hist));
+        memset(_window, 0, sizeof(_window));
+        _count = 0;
+        _index = 0;
+        _median = 0;
+        _below = 0;
+    }
+
+private:
+    uint8_t  _hist[BINS];   /**< Samples per value (N <= 255 fits a byte). */
+    uint16_t _window[N];    /**< Ring buffer (arrival order).              */
+    uint8_t  _count;        /**< Samples received (0..N).                  */
+    uint8_t  _index;        /**< Next write position.                      */
+    uint16_t _median;       /**< Bin holding the median rank.              */
+    uint8_t  _below;        /**< Samples in bins below _median.            */
+};
+
+#endif // LARGE_MEDIAN_H
@@ -0,0 +1,190 @@
+/**
+ * @file MedianWindow.h
+ * @brief Compile-time Sized Sliding Median Window
+ *
+ * The median stage shared by StaticSignalConditioner and the Median
+ * pipeline stage (ConditioningPipeline.h).
+ *
+ * Storage:
+ *   N <= 5: the N-sample ring only; the median of a full window comes
+ *           from a fixed compare/swap network (3 or 6 compares).
+ *   N >  5: the ring plus an incrementally sorted copy (binary search
+ *           and one shift per sample).
+ *
+ * For even sample counts during warm-up the upper-middle element is
+ * returned, matching SignalConditioner.
+ *
+ * Usage:
+ *   MedianWindow<5> window;
+ *   float median = window.push(sample);
+ */
+
+#ifndef MEDIAN_WINDOW_H
+#define MEDIAN_WINDOW_H
+
+#include <stdint.h>
+#include <string.h>
+
+/** @brief Order two values in place (compare/swap network element). */
+template <typename T>
+inline void medianSort2(T &a, T &b) {
+    if (b < a) {
+        T t = a;
+        a = b;
+        b = t;
+    }
+}
+
+/** @brief Median of three with three compares. */
+template <typename T>
+inline T medianOf3(T a, T b, T c) {
+    medianSort2(a, b);
+    medianSort2(b, c);
+    medianSort2(a, b);
+    return b;
+}
+
+/** @brief Median of five with six compares (no full sort). */
+template <typename T>
+inline T medianOf5(T a, T b, T c, T d, T e) {
+    medianSort2(a, b);
+    medianSort2(c, d);
+    if (c < a) {  // Drop the smaller of the two pair minimums
+        T t = b; b = d; d = t;
+        c = a;
+    }
+    a = e;
+    medianSort2(a, b);
+    if (a < c) {
+        T t = b; b = d; d = t;
+        a = c;
+    }
+    return (d < a) ? d : a;
+}
+
+/**
+ * @class MedianWindow
+ * @brief Sliding-window median with exact, compile-time storage.
+ *
+ * @tparam N Window size (odd, 1..63).
+ * @tparam T Sample type (must support <).
+ */
+template <uint8_t N, typename T = float>
+class MedianWindow {
+    static_assert(N >= 1 && N <= 63, "median window must be 1..63 samples");
+    static_assert(N % 2 == 1, "median window must be odd");
+
+public:
+    MedianWindow() { reset(); }
+
+    /**
+     * @brief Add a sample (evicting the oldest once full).
+     * @return T Median of the current window.
+     */
+    T push(T sample) {
+        bool full = (_count >= N);
+        if (N > SMALL_N) {
+            updateSorted(_window[_index], sample, full);
+        }
+        _window[_index] = sample;
+        _index = (_index + 1 == N) ? 0 : _index + 1;
+        if (!full) {
+            _count++;
+        }
+        return median();
+    }
+
+    /** @brief Median of the current contents (0 if empty). */
+    T median() const {
+        if (_count == 0) {
+            return _window[0];
+        }
+        if (N > SMALL_N) {
+            return _sorted[_count / 2];
+        }
+        if (_count < N) {
+            return medianOfPrefix(_count);
+        }
+        const T *w = _window;
+        switch (N) {
+            case 1:  return w[0];
+            case 3:  return medianOf3(w[0], w[1], w[2]);
+            default: return medianOf5(w[0], w[1], w[2], w[3], w[4 % N]);
+        }
+    }
+
+    /** @brief True once N samples have been received. */
+    bool isFull() const { return _count >= N; }
+
+    /** @brief Samples received so far (saturates at N). */
+    uint8_t count() const { return _count; }
+
+    /** @brief Window size (the template parameter). */
+    static constexpr uint8_t size() { return N; }
+
+    /** @brief Clear all samples. */
+    void reset() {
+        memset(_window, 0, sizeof(_window));
+        memset(_sorted, 0, sizeof(_sorted));
+        _count = 0;
+        _index = 0;
+    }
+
+private:
+    /** Windows up to this size use a selection network instead of _sorted. */
+    static const uint8_t SMALL_N = 5;
+
+    T       _window[N];                    /**< Ring buffer (arrival order).  */
+    T       _sorted[N > SMALL_N ? N : 1];  /**< Sorted copy (large N only).   */
+    uint8_t _count;                        /**< Samples received (0..N).      */
+    uint8_t _index;                        /**< Next write position.          */
+
+    /** @brief Median of a partially filled small window (warm-up only). */
+    T medianOfPrefix(uint8_t n) const {
+        T tmp[N];
+        for (uint8_t i = 0; i < n; i++) {
+            T key = _window[i];
+            int8_t j = (int8_t)i - 1;
+            while (j >= 0 && tmp[j] > key) {
+                tmp[j + 1] = tmp[j];
+                j--;
+            }
+            tmp[j + 1] = key;
+        }
+        return tmp[n / 2];
+    }
+
+    uint8_t lowerBound(T value, uint8_t n) const {
+        uint8_t lo = 0;
+        uint8_t hi = n;
+        while (lo < hi) {
+            uint8_t mid = (uint8_t)((lo + hi) / 2);
+            if (_sorted[mid] < value) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    void updateSorted(T evicted, T incoming, bool full) {
+        if (!full) {
+            uint8_t pos = lowerBound(incoming, _count);
+            memmove(&_sorted[pos + 1], &_sorted[pos], (_count - pos) * sizeof(T));
+            _sorted[pos] = incoming;
+            return;
+        }
+        uint8_t out = lowerBound(evicted, _count);
+        uint8_t in  = lowerBound(incoming, _count);
+        if (in > out) {
+            in--;
+            memmove(&_sorted[out], &_sorted[out + 1], (in - out) * sizeof(T));
+        } else {
+            memmove(&_sorted[in + 1], &_sorted[in], (out - in) * sizeof(T));
+        }
+        _sorted[in] = incoming;
+    }
+};
+
+#endif // MEDIAN_WINDOW_H
@@ -7,14 +7,20 @@
  * the output of the previous stage, producing a progressively
  * cleaner signal from noisy raw sensor data.
  *
- * The median filter uses insertion sort on a small array (max 9
- * elements), which is efficient for the small window sizes typical
- * in embedded sensor applications. The EWMA uses a single multiply-
+ * The median filter keeps a sorted copy of the window up to date: the
+ * evicted sample and the insertion point of the new sample are found by
+ * binary search (O(log n)) and only the elements between them move, so
+ * larger windows (up to 31) stay cheap. The EWMA uses a single multiply-
  * accumulate operation per sample.
+ *
+ * processBlock() runs a burst of samples through the same stages in one
+ * call; with BLOCK_EWMA_ONCE the median is read and the EWMA advanced
+ * once per block, which makes the block a decimation step.
  */
 
 #include "SignalConditioner.h"
 #include <math.h>
+#include <string.h>
 
 // ──────────────────────────────────────────────────────────────────────────
 // Constructor
@@ -29,15 +35,17 @@ SignalConditioner::SignalConditioner(uint8_t medianWindowSize, float ewmaAlpha,
       _ewmaAlpha(ewmaAlpha),
       _ewmaValue(0.0f),
       _ewmaInitialized(false),
+      _blockMode(BLOCK_EWMA_PER_SAMPLE),
       _minClamp(minClamp),
       _maxClamp(maxClamp),
       _lastRaw(0.0f),
       _lastSaturated(0.0f),
       _lastMedian(0.0f),
       _lastEwma(0.0f) {
-    // Zero-initialize the window buffer.
+    // Zero-initialize the window buffers.
     for (uint8_t i = 0; i < MAX_WINDOW_SIZE; i++) {
         _window[i] = 0.0f;
+        _sorted[i] = 0.0f;
     }
 }
 
@@ -46,6 +54,16 @@ SignalConditioner::SignalConditioner(uint8_t medianWindowSize, float ewmaAlpha,
 // ──────────────────────────────────────────────────────────────────────────
 
 float SignalConditioner::process(float rawValue) {
+    pushSample(rawValue);
+
+    // Median is the middle of the sorted window.
+    _lastMedian = computeMedian();
+
+    updateEwma(_lastMedian);
+    return _lastEwma;
+}
+
+void SignalConditioner::pushSample(float rawValue) {
     // ── Stage 1: Store raw value ────────────────────────────────────────
     _lastRaw = rawValue;
 
@@ -61,30 +79,86 @@ float SignalConditioner::process(float rawValue) {
     _lastSaturated = saturated;
 
     // ── Stage 3: Median filter ──────────────────────────────────────────
-    // Insert the saturated value into the circular buffer.
+    // Insert the saturated value into the circular buffer and keep the
+    // sorted copy in step (the overwritten slot is the evicted sample).
+    bool full = (_count >= _windowSize);
+    updateSorted(_window[_index], saturated, full);
     _window[_index] = saturated;
     _index = (_index + 1) % _windowSize;
-    if (_count < _windowSize) {
+    if (!full) {
         _count++;
     }
+}
 
-    // Compute median over the current buffer contents.
-    _lastMedian = computeMedian();
-
+void SignalConditioner::updateEwma(float median) {
     // ── Stage 4: EWMA ──────────────────────────────────────────────────
     if (!_ewmaInitialized) {
         // Seed the EWMA with the first median value.
-        _ewmaValue = _lastMedian;
+        _ewmaValue = median;
         _ewmaInitialized = true;
     } else {
-        _ewmaValue = _ewmaAlpha * _lastMedian
+        _ewmaValue = _ewmaAlpha * median
                    + (1.0f - _ewmaAlpha) * _ewmaValue;
     }
     _lastEwma = _ewmaValue;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Block processing — oversampling / decimation
+// ──────────────────────────────────────────────────────────────────────────
+
+float SignalConditioner::processBlock(const float *samples, uint8_t n) {
+    if (samples == NULL || n == 0) {
+        return _lastEwma;
+    }
+
+    // In BLOCK_EWMA_ONCE mode every sample enters the window, but the
+    // median is read and the EWMA advanced only after the last one, so
+    // the block acts as one decimated sample.
+    bool once = (_blockMode == BLOCK_EWMA_ONCE);
+    for (uint8_t i = 0; i < n; i++) {
+        pushSample(samples[i]);
+        if (!once) {
+            _lastMedian = computeMedian();
+            updateEwma(_lastMedian);
+        }
+    }
+    if (once) {
+        _lastMedian = computeMedian();
+        updateEwma(_lastMedian);
+    }
+    return _lastEwma;
+}
+
+float SignalConditioner::processBlock(const int16_t *samples, uint8_t n,
+                                      float scale, float offset) {
+    if (samples == NULL || n == 0) {
+        return _lastEwma;
+    }
 
+    bool once = (_blockMode == BLOCK_EWMA_ONCE);
+    for (uint8_t i = 0; i < n; i++) {
+        pushSample((float)samples[i] * scale + offset);
+        if (!once) {
+            _lastMedian = computeMedian();
+            updateEwma(_lastMedian);
+        }
+    }
+    if (once) {
+        _lastMedian = computeMedian();
+        updateEwma(_lastMedian);
+    }
     return _lastEwma;
 }
 
+void SignalConditioner::setBlockMode(BlockMode mode) {
+    _blockMode = mode;
+}
+
+SignalConditioner::BlockMode SignalConditioner::getBlockMode() const {
+    return _blockMode;
+}
+
 // ──────────────────────────────────────────────────────────────────────────
 // Saturation (clamping)
 // ──────────────────────────────────────────────────────────────────────────
@@ -96,30 +170,51 @@ float SignalConditioner::saturate(float value) const {
 }
 
 // ──────────────────────────────────────────────────────────────────────────
-// Median computation — insertion sort on a small local copy
+// Median computation — incrementally maintained sorted window
 // ──────────────────────────────────────────────────────────────────────────
 
-float SignalConditioner::computeMedian() const {
-    // Copy active elements to a local array for sorting.
-    float sorted[MAX_WINDOW_SIZE];
-    uint8_t n = _count;
-    for (uint8_t i = 0; i < n; i++) {
-        sorted[i] = _window[i];
+uint8_t SignalConditioner::lowerBound(float value, uint8_t n) const {
+    uint8_t lo = 0;
+    uint8_t hi = n;
+    while (lo < hi) {
+        uint8_t mid = (uint8_t)((lo + hi) / 2);
+        if (_sorted[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
     }
+    return lo;
+}
 
-    // Insertion sort — O(n^2) but n <= 9, so this is fast.
-    for (uint8_t i = 1; i < n; i++) {
-        float key = sorted[i];
-        int8_t j = i - 1;
-        while (j >= 0 && sorted[j] > key) {
-            sorted[j + 1] = sorted[j];
-            j--;
-        }
-        sorted[j + 1] = key;
+void SignalConditioner::updateSorted(float evicted, float incoming, bool full) {
+    if (!full) {
+        // Window still filling: plain insertion.
+        uint8_t pos = lowerBound(incoming, _count);
+        memmove(&_sorted[pos + 1], &_sorted[pos], (_count - pos) * sizeof(float));
+        _sorted[pos] = incoming;
+        return;
     }
 
-    // Return the middle element (integer division rounds down for even n).
-    return sorted[n / 2];
+    // The evicted value is present (it entered through this function), so
+    // lowerBound lands on one of its copies.
+    uint8_t out = lowerBound(evicted, _count);
+    uint8_t in  = lowerBound(incoming, _count);
+
+    if (in > out) {
+        // New sample sorts above the evicted slot: shift the gap down.
+        in--;
+        memmove(&_sorted[out], &_sorted[out + 1], (in - out) * sizeof(float));
+    } else {
+        // New sample sorts at or below the evicted slot: shift the gap up.
+        memmove(&_sorted[in + 1], &_sorted[in], (out - in) * sizeof(float));
+    }
+    _sorted[in] = incoming;
+}
+
+float SignalConditioner::computeMedian() const {
+    // Integer division picks the upper-middle element for even counts.
+    return _sorted[_count / 2];
 }
 
 // ──────────────────────────────────────────────────────────────────────────
@@ -173,6 +268,7 @@ uint8_t SignalConditioner::getSampleCount() const {
 void SignalConditioner::reset() {
     for (uint8_t i = 0; i < MAX_WINDOW_SIZE; i++) {
         _window[i] = 0.0f;
+        _sorted[i] = 0.0f;
     }
     _count = 0;
     _index = 0;
@@ -29,6 +29,10 @@
  *   SignalConditioner cond(5, 0.3, -40.0, 125.0);
  *   float conditioned = cond.process(rawTemperature);
  *   float median = cond.getLastMedian();
+ *
+ *   // Oversampling: condition 8 ADC reads as one decimated sample
+ *   cond.setBlockMode(SignalConditioner::BLOCK_EWMA_ONCE);
+ *   float out = cond.processBlock(counts, 8, VOLTS_PER_COUNT);
  */
 
 #ifndef SIGNAL_CONDITIONER_H
@@ -41,11 +45,25 @@
  * @brief Multi-stage signal conditioning pipeline (saturate → median → EWMA).
  *
  * Encapsulates a configurable conditioning pipeline for continuous sensor
- * readings. The median filter uses a fixed-size circular buffer (max 9
- * samples) to avoid dynamic memory allocation on resource-constrained MCUs.
+ * readings. The median filter uses a fixed-size circular buffer (max 31
+ * samples) plus an incrementally maintained sorted copy, so each sample
+ * costs two binary searches and one shift instead of a full re-sort, and
+ * no dynamic memory is allocated on resource-constrained MCUs.
  */
 class SignalConditioner {
 public:
+    /**
+     * @brief How processBlock() advances the EWMA.
+     *
+     * BLOCK_EWMA_PER_SAMPLE gives the same result as calling process()
+     * once per sample. BLOCK_EWMA_ONCE reads the median and updates the
+     * EWMA once after the whole block (oversample-and-decimate).
+     */
+    enum BlockMode : uint8_t {
+        BLOCK_EWMA_PER_SAMPLE = 0,
+        BLOCK_EWMA_ONCE       = 1
+    };
+
     /**
      * @brief Construct a new SignalConditioner object.
      *
@@ -70,6 +88,47 @@ public:
      */
     float process(float rawValue);
 
+    /**
+     * @brief Process a burst of raw readings in one call.
+     *
+     * Every sample is saturated and enters the median window; the EWMA
+     * is updated per sample or once per block according to the block
+     * mode (see setBlockMode()). Getters report the state after the
+     * last sample. An empty block leaves the state unchanged.
+     *
+     * @param samples Raw readings, oldest first.
+     * @param n       Number of readings.
+     * @return float  The conditioned output value after the block.
+     */
+    float processBlock(const float *samples, uint8_t n);
+
+    /**
+     * @brief Process a burst of integer readings (e.g. ADC counts).
+     *
+     * Each sample is converted as sample * scale + offset before entering
+     * the pipeline, so the clamp bounds are in the converted units.
+     *
+     * @param samples Raw integer readings, oldest first.
+     * @param n       Number of readings.
+     * @param scale   Conversion gain (default 1).
+     * @param offset  Conversion offset (default 0).
+     * @return float  The conditioned output value after the block.
+     */
+    float processBlock(const int16_t *samples, uint8_t n,
+                       float scale = 1.0f, float offset = 0.0f);
+
+    /**
+     * @brief Select how processBlock() updates the EWMA.
+     * @param mode BLOCK_EWMA_PER_SAMPLE (default) or BLOCK_EWMA_ONCE.
+     */
+    void setBlockMode(BlockMode mode);
+
+    /**
+     * @brief Get the configured block mode.
+     * @return BlockMode Current mode.
+     */
+    BlockMode getBlockMode() const;
+
     /**
      * @brief Get the last raw (unprocessed) input value.
      * @return float Last raw value passed to process().
@@ -145,10 +204,11 @@ public:
 
 private:
     /** Maximum supported median window size (fixed array, no heap). */
-    static const uint8_t MAX_WINDOW_SIZE = 9;
+    static const uint8_t MAX_WINDOW_SIZE = 31;
 
     // ── Median filter state ─────────────────────────────────────────────
-    float   _window[MAX_WINDOW_SIZE]; /**< Circular buffer for median.    */
+    float   _window[MAX_WINDOW_SIZE]; /**< Circular buffer (arrival order). */
+    float   _sorted[MAX_WINDOW_SIZE]; /**< Same samples, ascending.       */
     uint8_t _windowSize;              /**< Configured window size.        */
     uint8_t _count;                   /**< Samples received (0..windowSz).*/
     uint8_t _index;                   /**< Next write position in buffer. */
@@ -157,6 +217,7 @@ private:
     float _ewmaAlpha;                 /**< Smoothing factor (0.0–1.0).    */
     float _ewmaValue;                 /**< Current EWMA accumulator.      */
     bool  _ewmaInitialized;           /**< True after first sample.       */
+    BlockMode _blockMode;             /**< EWMA update rate in blocks.   */
 
     // ── Saturation bounds ───────────────────────────────────────────────
     float _minClamp;                  /**< Lower saturation bound.        */
@@ -175,12 +236,43 @@ private:
      */
     float saturate(float value) const;
 
+    /**
+     * @brief Run stages 1–3 for one sample (store raw, saturate, insert
+     *        into the median window) without reading the median.
+     * @param rawValue The raw sensor reading.
+     */
+    void pushSample(float rawValue);
+
+    /**
+     * @brief Run stage 4: seed or advance the EWMA with a median value.
+     * @param median Median-filtered input.
+     */
+    void updateEwma(float median);
+
+    /**
+     * @brief Binary search: first index in _sorted[0.._count) whose
+     *        value is not less than value.
+     */
+    uint8_t lowerBound(float value, uint8_t n) const;
+
+    /**
+     * @brief Update the sorted window for one new sample.
+     *
+     * When the window is full, the evicted sample is located by binary
+     * search and the elements between its slot and the new sample's slot
+     * are shifted by one; otherwise the sample is inserted.
+     *
+     * @param evicted  Sample leaving the window (ignored if not full).
+     * @param incoming Sample entering the window.
+     * @param full     True if the window was full before this sample.
+     */
+    void updateSorted(float evicted, float incoming, bool full);
+
     /**
      * @brief Compute the median of the current window contents.
      *
-     * Copies the active portion of the circular buffer to a local
-     * array, sorts it with insertion sort, and returns the middle
-     * element. For even-count windows, returns the lower-middle value.
+     * Reads the middle element of the sorted window. For even-count
+     * windows, returns the upper-middle value.
      *
      * @return float Median of the current window.
      */
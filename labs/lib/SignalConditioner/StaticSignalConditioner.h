@@ -0,0 +1,148 @@
+/**
+ * @file StaticSignalConditioner.h
+ * @brief Compile-time Sized Signal Conditioning Pipeline
+ *
+ * Template counterpart of SignalConditioner: the median window size N
+ * and the sample type T are template parameters, so each instance holds
+ * exactly the storage it needs and invalid sizes fail to compile.
+ *
+ *   raw → saturate → median → EWMA → conditioned output
+ *
+ * The median stage is a MedianWindow<N, T>: windows up to 5 samples keep
+ * only the ring and use a compare/swap network, larger ones add an
+ * incrementally sorted copy. Windows beyond that (31–255 samples) can
+ * pass a TwoHeapMedian or HistogramMedian (LargeMedian.h) as the Window
+ * parameter. For other stage combinations see ConditioningPipeline.h.
+ *
+ * T is typically float; integer types (int16_t ADC counts, int32_t Q16.16)
+ * also work, with the EWMA still computed through the float alpha. Use
+ * FixedSignalConditioner for a shift/add EWMA without soft-float.
+ *
+ * Usage:
+ *   StaticSignalConditioner<5> cond(0.3f, -40.0f, 125.0f);
+ *   float conditioned = cond.process(rawTemperature);
+ *   float median = cond.getLastMedian();
+ */
+
+#ifndef STATIC_SIGNAL_CONDITIONER_H
+#define STATIC_SIGNAL_CONDITIONER_H
+
+#include <Arduino.h>
+#include "MedianWindow.h"
+
+/**
+ * @class StaticSignalConditioner
+ * @brief Saturate → median → EWMA pipeline with a compile-time window.
+ *
+ * @tparam N      Median window size (odd; 1..63 for MedianWindow).
+ * @tparam T      Sample type.
+ * @tparam Window Median stage implementation (MedianWindow interface).
+ */
+template <uint8_t N, typename T = float, typename Window = MedianWindow<N, T> >
+class StaticSignalConditioner {
+    static_assert(Window::size() == N, "Window size must match N");
+
+public:
+    /**
+     * @brief Construct a new StaticSignalConditioner object.
+     *
+     * @param ewmaAlpha EWMA smoothing factor (0.0–1.0).
+     * @param minClamp  Minimum valid value (saturation lower bound).
+     * @param maxClamp  Maximum valid value (saturation upper bound).
+     */
+    StaticSignalConditioner(float ewmaAlpha, T minClamp, T maxClamp)
+        : _ewmaAlpha(ewmaAlpha), _minClamp(minClamp), _maxClamp(maxClamp) {
+        reset();
+    }
+
+    /**
+     * @brief Process a raw reading through the full pipeline.
+     *
+     * A NaN float input is replaced by the midpoint of the valid range,
+     * as in SignalConditioner.
+     *
+     * @param rawValue The raw sensor reading.
+     * @return T The conditioned output value (after EWMA).
+     */
+    T process(T rawValue) {
+        _lastRaw = rawValue;
+
+        // ── Saturation ──────────────────────────────────────────────────
+        T saturated = rawValue;
+        if (rawValue != rawValue) {  // NaN (float T only)
+            saturated = (T)((_minClamp + _maxClamp) / 2);
+        } else if (saturated < _minClamp) {
+            saturated = _minClamp;
+        } else if (saturated > _maxClamp) {
+            saturated = _maxClamp;
+        }
+        _lastSaturated = saturated;
+
+        // ── Median filter ───────────────────────────────────────────────
+        _lastMedian = _median.push(saturated);
+
+        // ── EWMA ────────────────────────────────────────────────────────
+        if (!_ewmaInitialized) {
+            _lastEwma = _lastMedian;
+            _ewmaInitialized = true;
+        } else {
+            _lastEwma = (T)(_lastEwma + (_lastMedian - _lastEwma) * _ewmaAlpha);
+        }
+        return _lastEwma;
+    }
+
+    /** @brief Last raw input value. */
+    T getLastRaw() const { return _lastRaw; }
+
+    /** @brief Last saturated value (after clamping, before median). */
+    T getLastSaturated() const { return _lastSaturated; }
+
+    /** @brief Last median-filtered value (after median, before EWMA). */
+    T getLastMedian() const { return _lastMedian; }
+
+    /** @brief Last EWMA value (final conditioned output). */
+    T getLastEwma() const { return _lastEwma; }
+
+    /** @brief Median window size (the template parameter). */
+    static constexpr uint8_t getWindowSize() { return N; }
+
+    /** @brief Configured EWMA alpha parameter. */
+    float getAlpha() const { return _ewmaAlpha; }
+
+    /** @brief Configured minimum saturation bound. */
+    T getMinClamp() const { return _minClamp; }
+
+    /** @brief Configured maximum saturation bound. */
+    T getMaxClamp() const { return _maxClamp; }
+
+    /** @brief True once the median window has been completely filled. */
+    bool isValid() const { return _median.isFull(); }
+
+    /** @brief Samples received so far (saturates at N). */
+    uint8_t getSampleCount() const { return _median.count(); }
+
+    /** @brief Clear the window and the EWMA state. */
+    void reset() {
+        _median.reset();
+        _ewmaInitialized = false;
+        _lastRaw = 0;
+        _lastSaturated = 0;
+        _lastMedian = 0;
+        _lastEwma = 0;
+    }
+
+private:
+    Window _median;                        /**< Median stage state.           */
+
+    float _ewmaAlpha;                      /**< Smoothing factor (0.0–1.0).   */
+    bool  _ewmaInitialized;                /**< True after first sample.      */
+    T     _minClamp;                       /**< Lower saturation bound.       */
+    T     _maxClamp;                       /**< Upper saturation bound.       */
+
+    T _lastRaw;                            /**< Last raw input.               */
+    T _lastSaturated;                      /**< After saturation.             */
+    T _lastMedian;                         /**< After median filter.          */
+    T _lastEwma;                           /**< After EWMA (final output).    */
+};
+
+#endif // STATIC_SIGNAL_CONDITIONER_H
@@ -0,0 +1,173 @@
+/**
+ * @file SpscRing.h
+ * @brief Lock-Free Single-Producer / Single-Consumer Ring Buffer
+ *
+ * The hand-off from an interrupt to the task (or loop()) that processes
+ * its data: the ISR push()es, the consumer pop()s or read()s, and neither
+ * side masks interrupts or takes a mutex.
+ *
+ * It is safe without critical sections because each index has a single
+ * writer and is one byte, which the AVR loads and stores in a single
+ * instruction:
+ *
+ *   head  written by the producer only, after the slot is filled
+ *   tail  written by the consumer only, after the slot is copied out
+ *
+ * Both are free-running counters masked on access, so all Capacity slots
+ * are usable (full is head - tail == Capacity) and the capacity must be a
+ * power of two, at most 128. Compiler barriers keep the slot accesses
+ * between the index load and the index store; items need not be volatile.
+ *
+ * A push() into a full ring drops the new item and counts it; the
+ * consumer reads the count with dropped() (the only interrupt-masked
+ * access, as the counter is 16 bits wide).
+ *
+ * Exactly one context may push and one may pop. With two producers (two
+ * ISRs, or an ISR and a task) use one ring each.
+ *
+ * Usage:
+ *   static SpscRing<Sample_t, 16> s_ring;
+ *   ISR(...)  { s_ring.push(sample); }
+ *   Sample_t batch[8];
+ *   uint8_t n = s_ring.read(batch, 8);             // consumer
+ *   uint16_t lost = s_ring.dropped();
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#endif
+
+/** @brief Compiler barrier: memory accesses are not moved across it. */
+#define SPSC_RING_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/**
+ * @class SpscRing
+ * @brief Ring of Capacity items of T for one producer and one consumer.
+ *
+ * @tparam T        Item type, copied by assignment.
+ * @tparam Capacity Items held; a power of two in 2..128.
+ */
+template <typename T, uint8_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && Capacity <= 128 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two in 2..128");
+
+public:
+    SpscRing() : _head(0), _tail(0), _dropped(0) {}
+
+    // ── Producer ────────────────────────────────────────────────────
+
+    /**
+     * @brief Append an item.
+     * @return false if the ring was full (the item is dropped and counted).
+     */
+    bool push(const T &item) {
+        uint8_t head = _head;
+        if ((uint8_t)(head - _tail) >= Capacity) {
+            if (_dropped < 0xFFFF) {
+                _dropped++;
+            }
+            return false;
+        }
+        _items[head & MASK] = item;
+        SPSC_RING_BARRIER();
+        _head = (uint8_t)(head + 1);   // Publish after the slot is written
+        return true;
+    }
+
+    /** @brief True if a push() would be dropped (producer side). */
+    bool full() const {
+        return (uint8_t)(_head - _tail) >= Capacity;
+    }
+
+    // ── Consumer ────────────────────────────────────────────────────
+
+    /**
+     * @brief Remove the oldest item.
+     * @return false if the ring was empty.
+     */
+    bool pop(T *item) {
+        uint8_t tail = _tail;
+        if (tail == _head) {
+            return false;
+        }
+        SPSC_RING_BARRIER();           // Read the slot after seeing the head
+        *item = _items[tail & MASK];
+        SPSC_RING_BARRIER();
+        _tail = (uint8_t)(tail + 1);   // Free the slot for the producer
+        return true;
+    }
+
+    /**
+     * @brief Remove up to max items, oldest first, in one pass.
+     *
+     * The slots are released together at the end, so the producer sees
+     * the space only once the whole batch has been copied.
+     *
+     * @return Items copied to out.
+     */
+    uint8_t read(T *out, uint8_t max) {
+        uint8_t tail = _tail;
+        uint8_t count = (uint8_t)(_head - tail);
+        if (count > max) {
+            count = max;
+        }
+        SPSC_RING_BARRIER();
+        for (uint8_t i = 0; i < count; i++) {
+            out[i] = _items[(uint8_t)(tail + i) & MASK];
+        }
+        SPSC_RING_BARRIER();
+        _tail = (uint8_t)(tail + count);
+        return count;
+    }
+
+    /** @brief Items waiting (a lower bound while the producer runs). */
+    uint8_t available() const {
+        return (uint8_t)(_head - _tail);
+    }
+
+    /** @brief True if nothing is waiting. */
+    bool empty() const {
+        return _head == _tail;
+    }
+
+    /** @brief Items dropped by push() into a full ring (saturates at 0xFFFF). */
+    uint16_t dropped() const {
+        uint16_t count = 0;
+#if defined(__AVR__)
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            count = _dropped;
+        }
+#else
+        count = _dropped;
+#endif
+        return count;
+    }
+
+    // ── Either side, with the other one stopped ─────────────────────
+
+    /** @brief Empty the ring and zero the drop count. */
+    void clear() {
+        _head = 0;
+        _tail = 0;
+        _dropped = 0;
+    }
+
+    /** @brief Compile-time capacity. */
+    static constexpr uint8_t capacity() { return Capacity; }
+
+private:
+    static const uint8_t MASK = Capacity - 1;
+
+    T                 _items[Capacity];
+    volatile uint8_t  _head;      ///< Written by the producer only
+    volatile uint8_t  _tail;      ///< Written by the consumer only
+    volatile uint16_t _dropped;   ///< Written by the producer only
+};
+
+#endif // SPSC_RING_H
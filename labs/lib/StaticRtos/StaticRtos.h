@@ -0,0 +1,183 @@
+/**
+ * @file StaticRtos.h
+ * @brief Statically Allocated FreeRTOS Tasks, Mutexes, Queues and Timers
+ *
+ * xTaskCreate(), xSemaphoreCreateMutex(), xQueueCreate() and
+ * xTimerCreate() take their TCB, stack, queue and timer storage from the FreeRTOS heap at startup. These
+ * wrappers reserve that memory as ordinary static objects instead, sized
+ * by template parameters, so:
+ *
+ *   - the RAM a lab needs shows up in the link map / avr-size output,
+ *     instead of being found missing at runtime by a failed allocation;
+ *   - creation cannot fail for lack of memory, and does no malloc();
+ *   - nothing is ever freed, so the heap cannot fragment.
+ *
+ * Kernel support is selected by configSUPPORT_STATIC_ALLOCATION (set with
+ * -DconfigSUPPORT_STATIC_ALLOCATION=1 in platformio.ini). Without it the
+ * same calls fall back to the heap-allocating API and no storage is
+ * reserved, so every lab builds against either kernel configuration.
+ * With it the kernel also needs the idle (and, with timers, the timer
+ * task) memory; vApplicationGetIdleTaskMemory() and
+ * vApplicationGetTimerTaskMemory() are provided by the feilipu/FreeRTOS
+ * port hooks.
+ *
+ * The objects must outlive the scheduler: declare them at file scope (or
+ * static), never on setup()'s stack. Each one may be created only once.
+ *
+ * Usage:
+ *   static StaticTask<TASK_STACK> s_task;
+ *   static StaticMutex s_mutex;
+ *   static StaticQueue<Sample_t, SAMPLE_QUEUE_DEPTH> s_queue;
+ *   static StaticTimer s_timer;
+ *
+ *   xMutex = s_mutex.create();                      // setup()
+ *   xQueue = s_queue.create();
+ *   xTimer = s_timer.create("Off", 1, pdFALSE, NULL, onTimer);
+ *   s_task.create(vTaskWorker, "Worker", NULL, TASK_PRIORITY);
+ */
+
+#ifndef STATIC_RTOS_H
+#define STATIC_RTOS_H
+
+#include <Arduino_FreeRTOS.h>
+#include <queue.h>
+#include <semphr.h>
+#include <timers.h>
+
+/** @brief 1 when the kernel provides the *Static() creation API. */
+#if defined(configSUPPORT_STATIC_ALLOCATION) && (configSUPPORT_STATIC_ALLOCATION == 1)
+#define STATIC_RTOS_ENABLED 1
+#else
+#define STATIC_RTOS_ENABLED 0
+#endif
+
+/**
+ * @class StaticTask
+ * @brief TCB and stack of one task.
+ *
+ * @tparam StackDepth Stack size in StackType_t units (bytes on AVR), as
+ *                    passed to xTaskCreate().
+ */
+template <configSTACK_DEPTH_TYPE StackDepth>
+class StaticTask {
+public:
+    StaticTask() : _handle(NULL) {}
+
+    /**
+     * @brief Create the task; same arguments as xTaskCreate() minus the depth.
+     * @return pdPASS, or pdFAIL if the task could not be created.
+     */
+    BaseType_t create(TaskFunction_t code, const char *name, void *param,
+                      UBaseType_t priority, TaskHandle_t *handle = NULL) {
+#if STATIC_RTOS_ENABLED
+        _handle = xTaskCreateStatic(code, name, StackDepth, param,
+                                    priority, _stack, &_tcb);
+#else
+        if (xTaskCreate(code, name, StackDepth, param, priority, &_handle) != pdPASS) {
+            _handle = NULL;
+        }
+#endif
+        if (handle != NULL) {
+            *handle = _handle;
+        }
+        return (_handle != NULL) ? pdPASS : pdFAIL;
+    }
+
+    /** @brief Task handle (NULL before a successful create()). */
+    TaskHandle_t handle() const { return _handle; }
+
+    /** @brief Stack size given to the kernel. */
+    static constexpr configSTACK_DEPTH_TYPE stackDepth() { return StackDepth; }
+
+private:
+    TaskHandle_t _handle;
+#if STATIC_RTOS_ENABLED
+    StackType_t  _stack[StackDepth];
+    StaticTask_t _tcb;
+#endif
+};
+
+/**
+ * @class StaticMutex
+ * @brief Control block of one mutex (priority inheritance, like xSemaphoreCreateMutex()).
+ */
+class StaticMutex {
+public:
+    /** @return Mutex handle, or NULL on failure (heap fallback only). */
+    SemaphoreHandle_t create() {
+#if STATIC_RTOS_ENABLED
+        return xSemaphoreCreateMutexStatic(&_block);
+#else
+        return xSemaphoreCreateMutex();
+#endif
+    }
+
+private:
+#if STATIC_RTOS_ENABLED
+    StaticSemaphore_t _block;
+#endif
+};
+
+/**
+ * @class StaticQueue
+ * @brief Control block and item storage of one queue of T.
+ *
+ * @tparam T      Item type (copied by value, as with xQueueCreate()).
+ * @tparam Length Items reserved.
+ */
+template <typename T, UBaseType_t Length>
+class StaticQueue {
+    static_assert(Length >= 1, "a queue needs at least one slot");
+
+public:
+    /**
+     * @param length Items actually used, clamped to 1..Length (for a
+     *               depth chosen at runtime within a compile-time bound).
+     * @return Queue handle, or NULL on failure (heap fallback only).
+     */
+    QueueHandle_t create(UBaseType_t length = Length) {
+        if (length < 1) {
+            length = 1;
+        } else if (length > Length) {
+            length = Length;
+        }
+#if STATIC_RTOS_ENABLED
+        return xQueueCreateStatic(length, sizeof(T), _storage, &_block);
+#else
+        return xQueueCreate(length, sizeof(T));
+#endif
+    }
+
+private:
+#if STATIC_RTOS_ENABLED
+    uint8_t       _storage[Length * sizeof(T)];
+    StaticQueue_t _block;
+#endif
+};
+
+/**
+ * @class StaticTimer
+ * @brief Control block of one software timer (run by the kernel's timer task).
+ */
+class StaticTimer {
+public:
+    /**
+     * @brief Create the timer, dormant; same arguments as xTimerCreate().
+     * @return Timer handle, or NULL on failure (heap fallback only).
+     */
+    TimerHandle_t create(const char *name, TickType_t period, UBaseType_t autoReload,
+                         void *id, TimerCallbackFunction_t callback) {
+#if STATIC_RTOS_ENABLED
+        return xTimerCreateStatic(name, period, autoReload, id, callback, &_block);
+#else
+        return xTimerCreate(name, period, autoReload, id, callback);
+#endif
+    }
+
+private:
+#if STATIC_RTOS_ENABLED
+    StaticTimer_t _block;
+#endif
+};
+
+#endif // STATIC_RTOS_H
@@ -0,0 +1,220 @@
+/**
+ * @file StaticTaskSet.h
+ * @brief A Lab's FreeRTOS Tasks from One Descriptor Table
+ *
+ * Each lab's setup() used to spell out a StaticTask per task, a create()
+ * call per task and one combined error check. A StaticTaskSet takes the
+ * same facts as a table instead, one row per task:
+ *
+ *   function, name, stack depth, priority, period (0: event-driven),
+ *   and an optional init hook that creates the task's primitives
+ *
+ * and reserves every TCB and stack in two static arrays sized from the
+ * table at compile time. The set's total RAM (stacks + TCBs) is checked
+ * against STATIC_TASK_SET_MAX_BYTES by a static_assert, so an oversized
+ * set fails the build instead of the boot.
+ *
+ * launch() walks the table once: a row's init hook runs first (false
+ * leaves the task out, e.g. an SD log without a card; the hook reports
+ * why), then its task is created. A task that cannot be created gets its
+ * own [ERROR] line naming it; the others are still created. Nothing
+ * runs before the scheduler starts, so the order of the rows is only the
+ * order of the hooks.
+ *
+ * The table must be constexpr (its stack depths size the storage); it is
+ * kept in flash (PROGMEM) and read a row at a time. Names are RAM
+ * strings, copied into the TCB as with xTaskCreate(). Without
+ * configSUPPORT_STATIC_ALLOCATION the set falls back to xTaskCreate(),
+ * reserves nothing and skips the RAM check, as StaticRtos.h does.
+ *
+ * Usage:
+ *   static constexpr StaticTaskDesc TASKS[] PROGMEM = {
+ *       STATIC_TASK(vTaskInput,   "Input",   TASK_INPUT_STACK,   TASK_INPUT_PRIORITY,   0),
+ *       STATIC_TASK(vTaskControl, "Control", TASK_CONTROL_STACK, TASK_CONTROL_PRIORITY, 100),
+ *       STATIC_TASK_INIT(vTaskModbus, "Modbus", TASK_MODBUS_STACK, TASK_MODBUS_PRIORITY,
+ *                        0, modbusStart),          // bool modbusStart(): queues, USART
+ *   };
+ *   static STATIC_TASK_SET(s_tasks, TASKS);
+ *
+ *   s_tasks.launch(TASKS);                         // setup()
+ *   for (uint8_t i = 0; i < s_tasks.count(); i++) {
+ *       taskMonitorAdd(s_tasks.handle(i), s_tasks.stackDepth(TASKS, i));
+ *   }
+ */
+
+#ifndef STATIC_TASK_SET_H
+#define STATIC_TASK_SET_H
+
+#include "StaticRtos.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#elif !defined(PROGMEM)
+#define PROGMEM
+#endif
+
+/** @brief Largest stack + TCB total a set may reserve (ATmega2560: 8 KB SRAM). */
+#ifndef STATIC_TASK_SET_MAX_BYTES
+#define STATIC_TASK_SET_MAX_BYTES 6144UL
+#endif
+
+/**
+ * @struct StaticTaskDesc
+ * @brief One row of a task-set table.
+ */
+struct StaticTaskDesc {
+    TaskFunction_t         code;        ///< Task function.
+    const char            *name;        ///< Task name (RAM string).
+    configSTACK_DEPTH_TYPE stackDepth;  ///< As passed to xTaskCreate().
+    UBaseType_t            priority;
+    uint16_t               periodMs;    ///< Release period, 0 if event-driven (reports).
+    bool                 (*init)();     ///< Creates the task's primitives first, or NULL;
+                                        ///< false leaves the task out.
+};
+
+/** @brief A row without an init hook. */
+#define STATIC_TASK(code, name, stack, priority, periodMs) \
+    { code, name, stack, priority, periodMs, NULL }
+
+/** @brief A row whose init hook runs just before its task is created. */
+#define STATIC_TASK_INIT(code, name, stack, priority, periodMs, init) \
+    { code, name, stack, priority, periodMs, init }
+
+/** @brief Sum of the stack depths of the first @p n rows (compile time). */
+constexpr uint32_t staticTaskStackTotal(const StaticTaskDesc *table, uint8_t n) {
+    return (n == 0) ? 0 : (uint32_t)table[0].stackDepth + staticTaskStackTotal(table + 1, n - 1);
+}
+
+/**
+ * @class StaticTaskSet
+ * @brief TCBs and stacks of a task table; declare with STATIC_TASK_SET().
+ *
+ * @tparam Tasks      Rows of the table.
+ * @tparam StackTotal Sum of their stack depths.
+ */
+template <uint8_t Tasks, uint32_t StackTotal>
+class StaticTaskSet {
+    static_assert(Tasks >= 1, "a task set needs at least one task");
+#if STATIC_RTOS_ENABLED
+    static_assert(StackTotal * sizeof(StackType_t) + Tasks * sizeof(StaticTask_t) <=
+                      STATIC_TASK_SET_MAX_BYTES,
+                  "task stacks and TCBs exceed STATIC_TASK_SET_MAX_BYTES");
+#endif
+
+public:
+    StaticTaskSet() {
+        for (uint8_t i = 0; i < Tasks; i++) {
+            _handles[i] = NULL;
+        }
+        _failures = 0;
+    }
+
+    /**
+     * @brief Run the init hooks and create every task, in table order.
+     *
+     * @param table The table the set was declared with (PROGMEM).
+     * @return true if every task not left out by its hook was created.
+     */
+    bool launch(const StaticTaskDesc *table) {
+        uint32_t offset = 0;
+        _failures = 0;
+        for (uint8_t i = 0; i < Tasks; i++) {
+            StaticTaskDesc row;
+            readRow(table, i, &row);
+            StackType_t *stack = stackAt(offset);
+            offset += row.stackDepth;
+            _handles[i] = NULL;
+            if (row.init != NULL && !row.init()) {
+                continue;
+            }
+#if STATIC_RTOS_ENABLED
+            _handles[i] = xTaskCreateStatic(row.code, row.name, row.stackDepth, NULL,
+                                            row.priority, stack, &_tcb[i]);
+#else
+            (void)stack;
+            if (xTaskCreate(row.code, row.name, row.stackDepth, NULL, row.priority,
+                            &_handles[i]) != pdPASS) {
+                _handles[i] = NULL;
+            }
+#endif
+            if (_handles[i] == NULL) {
+                _failures++;
+                printf("[ERROR] Task %s not created (stack %u, priority %u)\r\n", row.name,
+                       (unsigned)row.stackDepth, (unsigned)row.priority);
+            }
+        }
+        return _failures == 0;
+    }
+
+    /**
+     * @brief One [TASKS] line per row and the reserved total.
+     * @param table The table the set was declared with (PROGMEM).
+     */
+    void report(const StaticTaskDesc *table) const {
+        for (uint8_t i = 0; i < Tasks; i++) {
+            StaticTaskDesc row;
+            readRow(table, i, &row);
+            printf("[TASKS] %-8s prio %u stack %4u period %5u ms%s\r\n", row.name,
+                   (unsigned)row.priority, (unsigned)row.stackDepth, (unsigned)row.periodMs,
+                   _handles[i] != NULL ? "" : " NOT RUNNING");
+        }
+        printf("[TASKS] %u tasks, %lu B stacks + TCBs reserved\r\n", (unsigned)Tasks,
+               (unsigned long)ramBytes());
+    }
+
+    /** @brief Rows in the table. */
+    static constexpr uint8_t count() { return Tasks; }
+
+    /** @brief Handle of row @p i (NULL if left out or not created). */
+    TaskHandle_t handle(uint8_t i) const { return (i < Tasks) ? _handles[i] : NULL; }
+
+    /** @brief Stack depth of row @p i of @p table (PROGMEM). */
+    static configSTACK_DEPTH_TYPE stackDepth(const StaticTaskDesc *table, uint8_t i) {
+        StaticTaskDesc row;
+        readRow(table, i, &row);
+        return row.stackDepth;
+    }
+
+    /** @brief Tasks the last launch() failed to create. */
+    uint8_t failures() const { return _failures; }
+
+    /** @brief Static RAM the set reserves (0 with the heap fallback). */
+    static constexpr uint32_t ramBytes() {
+#if STATIC_RTOS_ENABLED
+        return StackTotal * sizeof(StackType_t) + Tasks * sizeof(StaticTask_t);
+#else
+        return 0;
+#endif
+    }
+
+private:
+    static void readRow(const StaticTaskDesc *table, uint8_t i, StaticTaskDesc *out) {
+#if defined(__AVR__)
+        memcpy_P(out, &table[i], sizeof(*out));
+#else
+        memcpy(out, &table[i], sizeof(*out));
+#endif
+    }
+
+#if STATIC_RTOS_ENABLED
+    StackType_t *stackAt(uint32_t offset) { return &_stack[offset]; }
+
+    StackType_t  _stack[StackTotal];
+    StaticTask_t _tcb[Tasks];
+#else
+    StackType_t *stackAt(uint32_t) { return NULL; }
+#endif
+    TaskHandle_t _handles[Tasks];
+    uint8_t      _failures;
+};
+
+/** @brief Declare the StaticTaskSet @p var sized from the constexpr @p table. */
+#define STATIC_TASK_SET(var, table)                                              \
+    StaticTaskSet<sizeof(table) / sizeof((table)[0]),                            \
+                  staticTaskStackTotal((table), sizeof(table) / sizeof((table)[0]))> var
+
+#endif // STATIC_TASK_SET_H
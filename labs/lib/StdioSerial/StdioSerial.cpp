@@ -5,24 +5,64 @@
  * Uses AVR libc's fdevopen/fdev_setup_stream to create a custom
  * FILE stream backed by the Arduino Serial (UART) port.
  *
- * - serialPutChar: writes a character to Serial (used by printf).
+ * - serialPutChar: queues a character in the Serial TX ring (used by
+ *   printf). The ring is drained by the UDRE interrupt; when it is full
+ *   the character either waits for space or is dropped and counted,
+ *   depending on the selected StdioTxPolicy.
  * - serialGetChar: reads a character from Serial (used by fgets/scanf),
  *   with local echo and carriage-return-to-newline translation.
+ * - stdioSerialPollLine: non-blocking line assembler over the Serial RX
+ *   ring with the same echo and editing behaviour as serialGetChar.
+ * - stdioSerialPollChar: the same terminal handling, one character at a
+ *   time, for streaming consumers.
+ * - Routed ports: an output-only stream per USART a route is bound to,
+ *   with the same overflow policy and its own drop counter. Serial1..3
+ *   are referenced only when routed, so an unrouted USART keeps no
+ *   HardwareSerial ring and its vectors stay free for other drivers.
  */
 
 #include "StdioSerial.h"
+#include <string.h>
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+/// Overflow policy applied by serialPutChar().
+static volatile StdioTxPolicy s_txPolicy = STDIO_TX_BLOCK;
+
+/// Characters discarded because the TX ring was full (STDIO_TX_DROP only).
+static uint32_t s_txDropped = 0;
+
+/// Line assembler state for stdioSerialPollLine().
+static char    s_lineBuf[STDIO_SERIAL_LINE_MAX];
+static uint8_t s_lineLen = 0;
+static bool    s_lineLastCr = false;  ///< Previous char was CR: swallow a following LF (also used by stdioSerialPollChar).
 
 /**
  * @brief Write a single character to the serial port.
  *
  * Called internally by the C standard library whenever printf()
- * or putchar() outputs a character through stdout.
+ * or putchar() outputs a character through stdout. Under
+ * STDIO_TX_DROP the character is discarded when the TX ring has no
+ * free slot, so the caller never waits on the UART.
  *
  * @param c      The character to transmit.
  * @param stream Pointer to the FILE stream (unused).
- * @return 0 on success.
+ * @return 0 on success (a dropped character is not reported as an error,
+ *         so printf() keeps formatting the rest of the message).
  */
 static int serialPutChar(char c, FILE *stream) {
+    (void)stream;
+    if (s_txPolicy == STDIO_TX_DROP && Serial.availableForWrite() <= 0) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            s_txDropped++;
+        }
+        return 0;
+    }
     Serial.write(c);
     return 0;
 }
@@ -40,6 +80,7 @@ static int serialPutChar(char c, FILE *stream) {
  * @return The character read (as unsigned char cast to int).
  */
 static int serialGetChar(FILE *stream) {
+    (void)stream;
     // Block until data is available on the serial port
     while (!Serial.available()) {
         // Idle wait — acceptable for a simple polling-based application
@@ -70,6 +111,106 @@ static int serialGetChar(FILE *stream) {
 /// Custom FILE stream that wraps the serial port for STDIO.
 static FILE serialStream;
 
+// ──────────────────────────────────────────────────────────────────────────
+// Routed ports
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(__AVR__)
+
+/// Output stream of a routed USART and its drop counter.
+struct StdioPort {
+    FILE     stream;
+    uint32_t dropped;
+};
+
+/** @brief serialPutChar() for a routed port. */
+static int portPutChar(HardwareSerial &serial, StdioPort *port, char c) {
+    if (s_txPolicy == STDIO_TX_DROP && serial.availableForWrite() <= 0) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            port->dropped++;
+        }
+        return 0;
+    }
+    serial.write(c);
+    return 0;
+}
+
+#if STDIO_SERIAL_PORT_ROUTED(1)
+static StdioPort s_port1;
+static int port1PutChar(char c, FILE *) { return portPutChar(Serial1, &s_port1, c); }
+#endif
+#if STDIO_SERIAL_PORT_ROUTED(2)
+static StdioPort s_port2;
+static int port2PutChar(char c, FILE *) { return portPutChar(Serial2, &s_port2, c); }
+#endif
+#if STDIO_SERIAL_PORT_ROUTED(3)
+static StdioPort s_port3;
+static int port3PutChar(char c, FILE *) { return portPutChar(Serial3, &s_port3, c); }
+#endif
+
+/** @brief Stream state of USART @p n, or NULL if no route uses it. */
+static StdioPort *routedPort(uint8_t n) {
+    switch (n) {
+#if STDIO_SERIAL_PORT_ROUTED(1)
+        case 1: return &s_port1;
+#endif
+#if STDIO_SERIAL_PORT_ROUTED(2)
+        case 2: return &s_port2;
+#endif
+#if STDIO_SERIAL_PORT_ROUTED(3)
+        case 3: return &s_port3;
+#endif
+        default: return NULL;
+    }
+}
+
+/** @brief Start the routed USARTs and set up their streams. */
+static void routedPortsInit() {
+#if STDIO_SERIAL_PORT_ROUTED(1)
+    Serial1.begin(STDIO_TELEMETRY_PORT == 1 ? STDIO_TELEMETRY_BAUD : STDIO_LOG_BAUD);
+    UCSR1B &= (uint8_t)~(_BV(RXEN1) | _BV(RXCIE1));  // Output only: RX1 stays GPIO
+    fdev_setup_stream(&s_port1.stream, port1PutChar, NULL, _FDEV_SETUP_WRITE);
+#endif
+#if STDIO_SERIAL_PORT_ROUTED(2)
+    Serial2.begin(STDIO_TELEMETRY_PORT == 2 ? STDIO_TELEMETRY_BAUD : STDIO_LOG_BAUD);
+    UCSR2B &= (uint8_t)~(_BV(RXEN2) | _BV(RXCIE2));  // Output only: RX2 stays GPIO
+    fdev_setup_stream(&s_port2.stream, port2PutChar, NULL, _FDEV_SETUP_WRITE);
+#endif
+#if STDIO_SERIAL_PORT_ROUTED(3)
+    Serial3.begin(STDIO_TELEMETRY_PORT == 3 ? STDIO_TELEMETRY_BAUD : STDIO_LOG_BAUD);
+    UCSR3B &= (uint8_t)~(_BV(RXEN3) | _BV(RXCIE3));  // Output only: RX3 stays GPIO
+    fdev_setup_stream(&s_port3.stream, port3PutChar, NULL, _FDEV_SETUP_WRITE);
+#endif
+}
+
+/** @brief TX ring space of routed USART @p n. */
+static int routedTxFree(uint8_t n) {
+    switch (n) {
+#if STDIO_SERIAL_PORT_ROUTED(1)
+        case 1: return Serial1.availableForWrite();
+#endif
+#if STDIO_SERIAL_PORT_ROUTED(2)
+        case 2: return Serial2.availableForWrite();
+#endif
+#if STDIO_SERIAL_PORT_ROUTED(3)
+        case 3: return Serial3.availableForWrite();
+#endif
+        default: return Serial.availableForWrite();
+    }
+}
+
+#else
+
+// Natively every route is the console: the shim has one Serial.
+struct StdioPort {
+    uint32_t dropped;
+};
+static StdioPort *routedPort(uint8_t) { return NULL; }
+static void routedPortsInit() {}
+static int routedTxFree(uint8_t) { return Serial.availableForWrite(); }
+
+#endif
+
 void stdioSerialInit(unsigned long baudRate) {
     Serial.begin(baudRate);
 
@@ -84,4 +225,143 @@ void stdioSerialInit(unsigned long baudRate) {
     // Redirect standard C streams to use the serial port
     stdout = &serialStream;
     stdin  = &serialStream;
+
+    routedPortsInit();
+}
+
+uint8_t stdioSerialRoutePort(StdioRoute route) {
+    switch (route) {
+        case STDIO_ROUTE_TELEMETRY: return STDIO_TELEMETRY_PORT;
+        case STDIO_ROUTE_LOG:       return STDIO_LOG_PORT;
+        default:                    return 0;
+    }
+}
+
+FILE *stdioSerialStream(StdioRoute route) {
+#if defined(__AVR__)
+    StdioPort *port = routedPort(stdioSerialRoutePort(route));
+    if (port != NULL) {
+        return &port->stream;
+    }
+#else
+    (void)route;
+#endif
+    return stdout;
+}
+
+void stdioSerialSetTxPolicy(StdioTxPolicy policy) {
+    s_txPolicy = policy;
+}
+
+uint32_t stdioSerialGetTxDropped() {
+    uint32_t dropped;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        dropped = s_txDropped;
+    }
+    return dropped;
+}
+
+void stdioSerialResetTxDropped() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        s_txDropped = 0;
+        for (uint8_t n = 1; n <= 3; n++) {
+            StdioPort *port = routedPort(n);
+            if (port != NULL) {
+                port->dropped = 0;
+            }
+        }
+    }
+}
+
+int stdioSerialTxFree() {
+    return Serial.availableForWrite();
+}
+
+int stdioSerialRouteTxFree(StdioRoute route) {
+    return routedTxFree(stdioSerialRoutePort(route));
+}
+
+uint32_t stdioSerialRouteTxDropped(StdioRoute route) {
+    StdioPort *port = routedPort(stdioSerialRoutePort(route));
+    if (port == NULL) {
+        return stdioSerialGetTxDropped();
+    }
+    uint32_t dropped;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        dropped = port->dropped;
+    }
+    return dropped;
+}
+
+bool stdioSerialPollLine(char *buf, size_t len) {
+    while (Serial.available() > 0) {
+        char c = (char)Serial.read();
+
+        // CR+LF from the terminal counts as a single line ending
+        if (c == '\n' && s_lineLastCr) {
+            s_lineLastCr = false;
+            continue;
+        }
+        s_lineLastCr = (c == '\r');
+
+        if (c == '\r' || c == '\n') {
+            Serial.write('\r');
+            Serial.write('\n');
+
+            size_t n = s_lineLen;
+            if (n > len - 1) {
+                n = len - 1;
+            }
+            memcpy(buf, s_lineBuf, n);
+            buf[n] = '\0';
+            s_lineLen = 0;
+            return true;  // Remaining input stays queued for the next call
+        }
+
+        if (c == '\b' || c == 127) {
+            if (s_lineLen > 0) {
+                s_lineLen--;
+                Serial.write('\b');
+                Serial.write(' ');
+                Serial.write('\b');
+            }
+            continue;
+        }
+
+        if (s_lineLen < STDIO_SERIAL_LINE_MAX - 1) {
+            s_lineBuf[s_lineLen++] = c;
+            Serial.write(c);  // Echo only what was accepted
+        }
+    }
+    return false;
+}
+
+int stdioSerialPollChar() {
+    while (Serial.available() > 0) {
+        char c = (char)Serial.read();
+
+        // CR+LF from the terminal counts as a single line ending
+        if (c == '\n' && s_lineLastCr) {
+            s_lineLastCr = false;
+            continue;
+        }
+        s_lineLastCr = (c == '\r');
+
+        if (c == '\r' || c == '\n') {
+            Serial.write('\r');
+            Serial.write('\n');
+            return '\n';
+        }
+
+        if (c == '\b' || c == 127) {
+            Serial.write('\b');
+            Serial.write(' ');
+            Serial.write('\b');
+            return '\b';
+        }
+
+        Serial.write(c);
+        return (unsigned char)c;
+    }
+    return -1;
 }
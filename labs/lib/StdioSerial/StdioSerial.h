@@ -11,6 +11,54 @@
  *   stdioSerialInit(9600);
  *   printf("Hello from STDIO!\r\n");
  *   fgets(buffer, sizeof(buffer), stdin);
+ *
+ * Transmit buffering:
+ *   printf() output is queued in the HardwareSerial TX ring and drained
+ *   by the USART0 UDRE interrupt, so a call only waits when the ring is
+ *   full. The core's default ring is 64 bytes; enlarge it per environment
+ *   with a build flag, e.g. in platformio.ini:
+ *
+ *     build_flags = ... -DSERIAL_TX_BUFFER_SIZE=1024
+ *
+ *   With STDIO_TX_DROP selected, characters that do not fit are discarded
+ *   (and counted) instead of stalling the caller:
+ *
+ *     stdioSerialSetTxPolicy(STDIO_TX_DROP);
+ *     printf("overflowed %lu chars\r\n", stdioSerialGetTxDropped());
+ *
+ * Non-blocking line input:
+ *   fgets() on stdin spins until Enter is pressed. Loops that must keep
+ *   running (TaskScheduler, FSMs) poll the line assembler instead, which
+ *   applies the same echo, backspace and CR-to-LF handling:
+ *
+ *     char line[64];
+ *     if (stdioSerialPollLine(line, sizeof(line))) {
+ *         handleCommand(line);
+ *     }
+ *
+ *   FreeRTOS tasks can block on a line with stdioSerialWaitLine() from
+ *   StdioSerialRtos.h.
+ *
+ *   Character-at-a-time consumers (e.g. CommandStream) use
+ *   stdioSerialPollChar() instead and keep no line buffer here.
+ *
+ * Stream routing:
+ *   The console (stdout/stdin, Serial) shares its 9600-baud link with
+ *   whatever else the lab prints. Telemetry (TelemetryFrame records,
+ *   FieldTelemetry subscription lines) and the DeferredLog output can each
+ *   be moved to another of the Mega's USARTs with its own baud rate, e.g.
+ *
+ *     build_flags = ... -DSTDIO_TELEMETRY_PORT=1 -DSTDIO_TELEMETRY_BAUD=1000000UL
+ *
+ *   puts binary telemetry on Serial1 (TX1 D18) at 1 Mbaud, leaving
+ *   Serial to the human console. Every routed port is a HardwareSerial
+ *   with its own SERIAL_TX_BUFFER_SIZE ring drained by its own UDRE
+ *   interrupt, so the links run in parallel. Writers take their stream
+ *   from stdioSerialStream(route); a route left on port 0 gets stdout.
+ *   The stdout TX policy applies to every port; drops are counted per
+ *   port. A routed USART is never gated by idleSleepInit() and cannot be
+ *   the Modbus one. Routed ports are output only: the receiver is left
+ *   off, so their RX pin stays plain GPIO.
  */
 
 #ifndef STDIO_SERIAL_H
@@ -19,15 +67,172 @@
 #include <Arduino.h>
 #include <stdio.h>
 
+/**
+ * @brief Capacity of the line assembler used by stdioSerialPollLine().
+ *
+ * Characters beyond STDIO_SERIAL_LINE_MAX - 1 are discarded (not echoed)
+ * until the line is terminated. Override with -DSTDIO_SERIAL_LINE_MAX=<n>.
+ */
+#ifndef STDIO_SERIAL_LINE_MAX
+#define STDIO_SERIAL_LINE_MAX 64
+#endif
+
+/** @brief USART of the telemetry route (0: the console, 1..3: Serial1..3). */
+#ifndef STDIO_TELEMETRY_PORT
+#define STDIO_TELEMETRY_PORT 0
+#endif
+
+/** @brief Baud rate of the telemetry port (unused on port 0). */
+#ifndef STDIO_TELEMETRY_BAUD
+#define STDIO_TELEMETRY_BAUD 1000000UL
+#endif
+
+/** @brief USART of the log route (0: the console, 1..3: Serial1..3). */
+#ifndef STDIO_LOG_PORT
+#define STDIO_LOG_PORT 0
+#endif
+
+/** @brief Baud rate of the log port (unused on port 0 or the telemetry one). */
+#ifndef STDIO_LOG_BAUD
+#define STDIO_LOG_BAUD 115200UL
+#endif
+
+#if STDIO_TELEMETRY_PORT < 0 || STDIO_TELEMETRY_PORT > 3 || STDIO_LOG_PORT < 0 || STDIO_LOG_PORT > 3
+#error "STDIO_TELEMETRY_PORT and STDIO_LOG_PORT must be 0..3"
+#endif
+
+/** @brief True if a route other than the console uses USART @p n (for #if). */
+#define STDIO_SERIAL_PORT_ROUTED(n) \
+    ((n) != 0 && (STDIO_TELEMETRY_PORT == (n) || STDIO_LOG_PORT == (n)))
+
+/**
+ * @brief USARTs carrying a stream, bit n for USARTn (the IdleSleepGate layout).
+ */
+static const uint16_t STDIO_SERIAL_USARTS =
+    (1U << 0) | (1U << STDIO_TELEMETRY_PORT) | (1U << STDIO_LOG_PORT);
+
+/**
+ * @brief What a stream carries; each is bound to a port at build time.
+ */
+enum StdioRoute {
+    STDIO_ROUTE_CONSOLE,    ///< stdout/stdin, always Serial.
+    STDIO_ROUTE_TELEMETRY,  ///< Binary frames and subscription lines (STDIO_TELEMETRY_PORT).
+    STDIO_ROUTE_LOG         ///< DeferredLog output (STDIO_LOG_PORT).
+};
+
 /**
  * @brief Initialize STDIO redirection over the hardware serial port.
  *
  * Configures the UART at the specified baud rate and redirects
  * stdout and stdin to use the serial port. Characters received
  * via stdin are echoed back to the terminal for user feedback.
+ * Routed ports (STDIO_TELEMETRY_PORT, STDIO_LOG_PORT) are started at
+ * their own baud rates and get their output streams.
  *
  * @param baudRate The serial communication baud rate (e.g., 9600).
  */
 void stdioSerialInit(unsigned long baudRate);
 
+/**
+ * @brief Output stream of a route.
+ *
+ * @param route What is to be written.
+ * @return stdout for a route on port 0, else the routed port's stream.
+ */
+FILE *stdioSerialStream(StdioRoute route);
+
+/**
+ * @brief USART a route writes to.
+ *
+ * @param route The route.
+ * @return 0..3.
+ */
+uint8_t stdioSerialRoutePort(StdioRoute route);
+
+/**
+ * @brief Behaviour of stdout when the TX ring is full.
+ */
+enum StdioTxPolicy {
+    STDIO_TX_BLOCK,  ///< Wait for the UDRE interrupt to free a slot (default).
+    STDIO_TX_DROP    ///< Discard the character and increment the drop counter.
+};
+
+/**
+ * @brief Select what stdout does when the TX ring is full.
+ *
+ * STDIO_TX_BLOCK preserves byte-exact output at the cost of stalling the
+ * calling task for up to one character time per queued byte. STDIO_TX_DROP
+ * keeps printf() bounded for real-time tasks; size the ring so that one
+ * report period's output fits and drops only occur under overload.
+ *
+ * @param policy The overflow policy to apply to subsequent output.
+ */
+void stdioSerialSetTxPolicy(StdioTxPolicy policy);
+
+/**
+ * @brief Number of characters discarded under STDIO_TX_DROP.
+ *
+ * @return Total dropped characters since start-up or the last reset.
+ */
+uint32_t stdioSerialGetTxDropped();
+
+/**
+ * @brief Clear the dropped-character counters (every port).
+ */
+void stdioSerialResetTxDropped();
+
+/**
+ * @brief Free space currently available in the TX ring.
+ *
+ * @return Number of characters that can be queued without waiting.
+ */
+int stdioSerialTxFree();
+
+/**
+ * @brief Free space in the TX ring of a route's port.
+ *
+ * @param route The route.
+ * @return Number of characters that can be queued without waiting.
+ */
+int stdioSerialRouteTxFree(StdioRoute route);
+
+/**
+ * @brief Characters a route's port dropped under STDIO_TX_DROP.
+ *
+ * Routes sharing a port share the counter; the console's is
+ * stdioSerialGetTxDropped().
+ *
+ * @param route The route.
+ * @return Dropped characters since start-up or the last reset.
+ */
+uint32_t stdioSerialRouteTxDropped(StdioRoute route);
+
+/**
+ * @brief Consume pending serial input and return a completed line, if any.
+ *
+ * Drains every character currently held in the Serial RX ring into an
+ * internal line assembler and returns immediately. Characters are echoed,
+ * backspace/DEL erases the last character, and CR, LF or CR+LF ends the
+ * line. The completed line is copied into buf without the terminator,
+ * truncated to len - 1 characters and null-terminated.
+ *
+ * Do not mix with fgets()/scanf() on stdin while a line is being assembled.
+ *
+ * @param buf Destination buffer for the completed line.
+ * @param len Size of buf in bytes (must be at least 1).
+ * @return true if a line was completed and copied into buf, false otherwise.
+ */
+bool stdioSerialPollLine(char *buf, size_t len);
+
+/**
+ * @brief Read one pending input character with echo, without blocking.
+ *
+ * Applies the same terminal handling as serialGetChar(): the character
+ * is echoed, CR (or CR+LF) is returned as a single '\n', and backspace /
+ * DEL erase the previous character on screen and are returned as '\b'.
+ *
+ * @return The character (0..255), or -1 if no input is pending.
+ */
+int stdioSerialPollChar();
+
 #endif // STDIO_SERIAL_H
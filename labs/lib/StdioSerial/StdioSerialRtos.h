@@ -0,0 +1,80 @@
+/**
+ * @file StdioSerialRtos.h
+ * @brief Blocking Line Input for FreeRTOS Tasks
+ *
+ * FreeRTOS counterpart of stdioSerialPollLine(). Instead of spinning on
+ * Serial.available() like fgets() on stdin, the calling task blocks on
+ * its task notification between polls, so lower-priority tasks keep
+ * running while it waits for the user.
+ *
+ * The Arduino core owns the USART0 RX interrupt, so the task re-polls the
+ * RX ring once per tick (~16 ms on the WDT tick, far inside the 64-byte
+ * ring's ~66 ms fill time at 9600 baud). Any ISR or task that knows input
+ * is pending can wake it early with vTaskNotifyGiveFromISR()/xTaskNotifyGive().
+ *
+ * Header-only so that labs without FreeRTOS never see the dependency.
+ *
+ * Usage:
+ *   char line[64];
+ *   if (stdioSerialWaitLine(line, sizeof(line), portMAX_DELAY)) {
+ *       handleCommand(line);
+ *   }
+ */
+
+#ifndef STDIO_SERIAL_RTOS_H
+#define STDIO_SERIAL_RTOS_H
+
+#include <Arduino_FreeRTOS.h>
+#include "StdioSerial.h"
+
+/**
+ * @brief Block the calling task until a full line is received.
+ *
+ * Uses the calling task's notification value as its wake-up signal; do
+ * not combine with other notification-based protocols on the same task.
+ *
+ * @param buf     Destination buffer for the completed line (see
+ *                stdioSerialPollLine() for formatting rules).
+ * @param len     Size of buf in bytes.
+ * @param timeout Maximum time to wait in ticks (portMAX_DELAY = forever).
+ * @return true if a line was received, false on timeout.
+ */
+inline bool stdioSerialWaitLine(char *buf, size_t len, TickType_t timeout) {
+    TickType_t start = xTaskGetTickCount();
+    for (;;) {
+        if (stdioSerialPollLine(buf, len)) {
+            return true;
+        }
+        if (timeout != portMAX_DELAY &&
+            (TickType_t)(xTaskGetTickCount() - start) >= timeout) {
+            return false;
+        }
+        ulTaskNotifyTake(pdTRUE, 1);
+    }
+}
+
+/**
+ * @brief Block the calling task until one input character is available.
+ *
+ * Character-level counterpart of stdioSerialWaitLine() for streaming
+ * parsers; same notification and polling behaviour.
+ *
+ * @param timeout Maximum time to wait in ticks (portMAX_DELAY = forever).
+ * @return The character as returned by stdioSerialPollChar(), or -1 on timeout.
+ */
+inline int stdioSerialWaitChar(TickType_t timeout) {
+    TickType_t start = xTaskGetTickCount();
+    for (;;) {
+        int c = stdioSerialPollChar();
+        if (c >= 0) {
+            return c;
+        }
+        if (timeout != portMAX_DELAY &&
+            (TickType_t)(xTaskGetTickCount() - start) >= timeout) {
+            return -1;
+        }
+        ulTaskNotifyTake(pdTRUE, 1);
+    }
+}
+
+#endif // STDIO_SERIAL_RTOS_H
@@ -0,0 +1,212 @@
+/**
+ * @file StreamStats.cpp
+ * @brief Constant-Memory Streaming Statistics Implementation
+ *
+ * Marker positions are kept 0-based; the desired position of marker i
+ * after N samples is (N - 1) · f_i with f = {0, p/2, p, (1+p)/2, 1}, so
+ * it is computed instead of stored.
+ */
+
+#include "StreamStats.h"
+#include "FlashString.h"
+
+#include <stdio.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// P2Quantile
+// ──────────────────────────────────────────────────────────────────────────
+
+P2Quantile::P2Quantile(float p) : _p(p) {
+    reset();
+}
+
+void P2Quantile::reset() {
+    _count = 0;
+    for (uint8_t i = 0; i < 5; i++) {
+        _height[i] = 0.0f;
+        _position[i] = i;
+    }
+}
+
+void P2Quantile::add(float x) {
+    if (_count < 5) {
+        // Insertion sort of the first five samples; they become the markers.
+        uint8_t i = (uint8_t)_count;
+        while (i > 0 && _height[i - 1] > x) {
+            _height[i] = _height[i - 1];
+            i--;
+        }
+        _height[i] = x;
+        _count++;
+        return;
+    }
+
+    // Cell k holds x; the extreme markers follow new minima and maxima.
+    uint8_t k;
+    if (x < _height[0]) {
+        _height[0] = x;
+        k = 0;
+    } else if (x >= _height[4]) {
+        _height[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= _height[k + 1]) {
+            k++;
+        }
+    }
+    for (uint8_t i = k + 1; i < 5; i++) {
+        _position[i]++;
+    }
+    _count++;
+
+    const float fraction[5] = { 0.0f, _p * 0.5f, _p, (1.0f + _p) * 0.5f, 1.0f };
+    float last = (float)(_count - 1);
+    for (uint8_t i = 1; i < 4; i++) {
+        float d = last * fraction[i] - (float)_position[i];
+        int32_t right = _position[i + 1] - _position[i];
+        int32_t left = _position[i - 1] - _position[i];
+        if ((d >= 1.0f && right > 1) || (d <= -1.0f && left < -1)) {
+            int8_t s = (d > 0.0f) ? 1 : -1;
+            float n0 = (float)_position[i - 1];
+            float n1 = (float)_position[i];
+            float n2 = (float)_position[i + 1];
+            float q0 = _height[i - 1];
+            float q1 = _height[i];
+            float q2 = _height[i + 1];
+
+            // Piecewise-parabolic prediction; linear if it leaves the cell.
+            float q = q1 + (float)s / (n2 - n0) *
+                           ((n1 - n0 + s) * (q2 - q1) / (n2 - n1) +
+                            (n2 - n1 - s) * (q1 - q0) / (n1 - n0));
+            if (q <= q0 || q >= q2) {
+                float qs = _height[i + s];
+                float ns = (float)_position[i + s];
+                q = q1 + (float)s * (qs - q1) / (ns - n1);
+            }
+            _height[i] = q;
+            _position[i] += s;
+        }
+    }
+}
+
+float P2Quantile::value() const {
+    if (_count == 0) {
+        return 0.0f;
+    }
+    if (_count < 5) {
+        // Nearest rank among the sorted samples.
+        uint8_t rank = (uint8_t)(_p * (float)(_count - 1) + 0.5f);
+        return _height[rank];
+    }
+    return _height[2];
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// StreamStats
+// ──────────────────────────────────────────────────────────────────────────
+
+StreamStats::StreamStats() : _p50(0.50f), _p95(0.95f), _p99(0.99f) {
+    reset();
+}
+
+void StreamStats::reset() {
+    _count = 0;
+    _min = UINT32_MAX;
+    _max = 0;
+    _sum = 0;
+    for (uint8_t b = 0; b < STREAM_STATS_BUCKETS; b++) {
+        _buckets[b] = 0;
+    }
+    _p50.reset();
+    _p95.reset();
+    _p99.reset();
+}
+
+void StreamStats::add(uint32_t value) {
+    _count++;
+    if (value < _min) {
+        _min = value;
+    }
+    if (value > _max) {
+        _max = value;
+    }
+    _sum += value;
+
+    uint8_t b = bucketOf(value);
+    if (_buckets[b] < 0xFFFF) {
+        _buckets[b]++;
+    }
+
+    float x = (float)value;
+    _p50.add(x);
+    _p95.add(x);
+    _p99.add(x);
+}
+
+uint32_t StreamStats::mean() const {
+    return (_count > 0) ? (_sum + _count / 2) / _count : 0;
+}
+
+uint16_t StreamStats::bucketCount(uint8_t bucket) const {
+    return (bucket < STREAM_STATS_BUCKETS) ? _buckets[bucket] : 0;
+}
+
+uint32_t StreamStats::bucketLow(uint8_t bucket) {
+    return (bucket == 0) ? 0 : (1UL << (bucket - 1));
+}
+
+uint8_t StreamStats::bucketOf(uint32_t value) {
+    uint8_t b = 0;
+    while (value != 0 && b < STREAM_STATS_BUCKETS - 1) {
+        value >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void StreamStats::print(const char *label, const char *unit) const {
+    FLASH_PRINTF("%s: n=%lu min %lu p50 %lu p95 %lu p99 %lu max %lu mean %lu %s\r\n",
+                 label,
+                 (unsigned long)_count,
+                 (unsigned long)min(),
+                 (unsigned long)p50(),
+                 (unsigned long)p95(),
+                 (unsigned long)p99(),
+                 (unsigned long)_max,
+                 (unsigned long)mean(),
+                 unit);
+}
+
+void StreamStats::printHistogram(const char *unit) const {
+    uint16_t peak = 0;
+    for (uint8_t b = 0; b < STREAM_STATS_BUCKETS; b++) {
+        if (_buckets[b] > peak) {
+            peak = _buckets[b];
+        }
+    }
+    if (peak == 0) {
+        return;
+    }
+
+    static const uint8_t BAR_WIDTH = 20;
+    for (uint8_t b = 0; b < STREAM_STATS_BUCKETS; b++) {
+        if (_buckets[b] == 0) {
+            continue;
+        }
+        char bar[BAR_WIDTH + 1];
+        uint8_t len = (uint8_t)(((uint32_t)_buckets[b] * BAR_WIDTH + peak - 1) / peak);
+        for (uint8_t i = 0; i < len; i++) {
+            bar[i] = '#';
+        }
+        bar[len] = '\0';
+        if (b == STREAM_STATS_BUCKETS - 1) {
+            FLASH_PRINTF("  >= %6lu %s %5u %s\r\n", (unsigned long)bucketLow(b), unit,
+                         (unsigned)_buckets[b], bar);
+        } else {
+            FLASH_PRINTF("  %6lu..%-6lu %s %5u %s\r\n", (unsigned long)bucketLow(b),
+                         (unsigned long)(bucketLow(b + 1) - 1), unit,
+                         (unsigned)_buckets[b], bar);
+        }
+    }
+}
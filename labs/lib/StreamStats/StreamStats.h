@@ -0,0 +1,123 @@
+/**
+ * @file StreamStats.h
+ * @brief Constant-Memory Streaming Statistics (Histogram + P² Percentiles)
+ *
+ * Summarises a stream of unsigned samples (press durations in ms, task
+ * execution times or latencies in µs) without storing them:
+ *
+ *   - count, min, max and mean,
+ *   - a log2-bucketed histogram: bucket 0 holds 0, bucket b holds
+ *     [2^(b-1), 2^b), the last one everything from 2^(BUCKETS-2) up,
+ *   - p50, p95 and p99 from P² estimators (Jain & Chlamtac, 1985).
+ *
+ * P² keeps five markers per quantile and moves them with a piecewise-
+ * parabolic fit as samples arrive, so the estimate costs O(1) time and
+ * 48 bytes per quantile whatever the sample count. Until five samples
+ * have arrived the quantile is exact (nearest rank of the few stored).
+ * The estimates follow the distribution well once a few dozen samples
+ * are in; with fewer, read them with the histogram and min/max.
+ *
+ * The whole object is under 200 bytes and is plain data, so it can be
+ * copied as a snapshot under the lock that guards it (into a static,
+ * not onto a small task stack).
+ *
+ * Usage:
+ *   static StreamStats s_durations;
+ *   s_durations.add(durationMs);          // per press
+ *   s_durations.print("Duration", "ms");  // report task
+ *   s_durations.printHistogram("ms");
+ *   s_durations.reset();                  // start the next window
+ */
+
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <Arduino.h>
+
+/** @brief Histogram buckets (bucket STREAM_STATS_BUCKETS-1 is open-ended). */
+#ifndef STREAM_STATS_BUCKETS
+#define STREAM_STATS_BUCKETS 16
+#endif
+
+/**
+ * @class P2Quantile
+ * @brief Streaming estimate of one quantile (P² algorithm).
+ */
+class P2Quantile {
+public:
+    /** @param p Quantile in (0, 1), e.g. 0.95f. */
+    explicit P2Quantile(float p);
+
+    /** @brief Forget all samples. */
+    void reset();
+
+    /** @brief Add one sample. */
+    void add(float x);
+
+    /** @brief Current estimate (0 before the first sample). */
+    float value() const;
+
+private:
+    float    _p;
+    uint32_t _count;
+    float    _height[5];    ///< Marker heights (the first samples, sorted, until 5)
+    int32_t  _position[5];  ///< Marker positions, 0-based
+};
+
+/**
+ * @class StreamStats
+ * @brief Count, min/max/mean, log2 histogram and p50/p95/p99 of a sample stream.
+ */
+class StreamStats {
+public:
+    StreamStats();
+
+    /** @brief Forget all samples (start a new window). */
+    void reset();
+
+    /** @brief Add one sample. */
+    void add(uint32_t value);
+
+    uint32_t count() const { return _count; }
+    uint32_t min() const { return _count > 0 ? _min : 0; }
+    uint32_t max() const { return _max; }
+
+    /** @brief Mean, rounded (0 with no samples; exact up to a sum of 2^32). */
+    uint32_t mean() const;
+
+    uint32_t p50() const { return rounded(_p50.value()); }
+    uint32_t p95() const { return rounded(_p95.value()); }
+    uint32_t p99() const { return rounded(_p99.value()); }
+
+    /** @brief Samples in bucket b (saturates at 0xFFFF). */
+    uint16_t bucketCount(uint8_t bucket) const;
+
+    /** @brief Smallest value that falls into bucket b. */
+    static uint32_t bucketLow(uint8_t bucket);
+
+    /** @brief Bucket a value falls into. */
+    static uint8_t bucketOf(uint32_t value);
+
+    /**
+     * @brief Print one line: "<label>: n min p50 p95 p99 max mean".
+     * Needs stdout redirected (stdioSerialInit()).
+     */
+    void print(const char *label, const char *unit) const;
+
+    /** @brief Print the non-empty buckets, one per line, with a bar. */
+    void printHistogram(const char *unit) const;
+
+private:
+    static uint32_t rounded(float x) { return x <= 0.0f ? 0 : (uint32_t)(x + 0.5f); }
+
+    uint32_t   _count;
+    uint32_t   _min;
+    uint32_t   _max;
+    uint32_t   _sum;
+    uint16_t   _buckets[STREAM_STATS_BUCKETS];
+    P2Quantile _p50;
+    P2Quantile _p95;
+    P2Quantile _p99;
+};
+
+#endif // STREAM_STATS_H
@@ -0,0 +1,92 @@
+/**
+ * @file StressRamp.cpp
+ * @brief Scaling Benchmark Search Implementation
+ *
+ * Implements:
+ * - The phase sequence APPLY → settle → window (× repeats) → next level,
+ *   timed from the poll that entered each phase
+ * - The pass test and the bookkeeping of the best level
+ */
+
+#include "StressRamp.h"
+
+StressRamp::StressRamp(uint32_t settleMs, uint32_t windowMs, uint8_t repeats,
+                       uint16_t maxBusyPermille)
+    : _settleMs(settleMs), _windowMs(windowMs), _repeats(repeats > 0 ? repeats : 1),
+      _maxBusyPermille(maxBusyPermille), _phase(PHASE_IDLE), _phaseStartMs(0), _levels(0),
+      _level(0), _run(0), _best(-1), _exhausted(false) {}
+
+void StressRamp::begin(uint8_t levels, uint32_t nowMs) {
+    _levels = levels;
+    _level = 0;
+    _run = 0;
+    _best = -1;
+    _exhausted = false;
+    _phaseStartMs = nowMs;
+    _phase = (levels > 0) ? PHASE_APPLY : PHASE_DONE;
+}
+
+void StressRamp::stop() {
+    _phase = PHASE_IDLE;
+}
+
+StressStep StressRamp::poll(uint32_t nowMs) {
+    switch (_phase) {
+    case PHASE_APPLY:
+        _phase = PHASE_SETTLE;
+        _phaseStartMs = nowMs;
+        return STRESS_STEP_APPLY;
+    case PHASE_SETTLE:
+        if ((uint32_t)(nowMs - _phaseStartMs) < _settleMs) {
+            return STRESS_STEP_NONE;
+        }
+        _phase = PHASE_WINDOW;
+        _phaseStartMs = nowMs;
+        return STRESS_STEP_BASELINE;
+    case PHASE_WINDOW:
+        if ((uint32_t)(nowMs - _phaseStartMs) < _windowMs) {
+            return STRESS_STEP_NONE;
+        }
+        _phase = PHASE_SCORE;
+        return STRESS_STEP_SCORE;
+    case PHASE_DONE:
+        _phase = PHASE_IDLE;
+        return STRESS_STEP_DONE;
+    case PHASE_SCORE:  // Waiting for score()
+    case PHASE_IDLE:
+    default:
+        return STRESS_STEP_NONE;
+    }
+}
+
+bool StressRamp::passes(const StressWindow &window) const {
+    return window.misses == 0 && window.overruns == 0 && window.queueDrops == 0 &&
+           window.busyPermille <= _maxBusyPermille;
+}
+
+bool StressRamp::score(const StressWindow &window) {
+    if (_phase != PHASE_SCORE) {
+        return false;
+    }
+    if (!passes(window)) {
+        _phase = PHASE_DONE;
+        return false;
+    }
+    _run++;
+    if (_run < _repeats) {
+        // The next window follows at once: settled as of the window's end.
+        _phase = PHASE_SETTLE;
+        _phaseStartMs = _phaseStartMs + _windowMs - _settleMs;
+        return true;
+    }
+    _best = _level;
+    if ((uint8_t)(_level + 1) < _levels) {
+        _level++;
+        _run = 0;
+        _phase = PHASE_APPLY;
+    } else {
+        _exhausted = true;
+        _phase = PHASE_DONE;
+    }
+    return true;
+}
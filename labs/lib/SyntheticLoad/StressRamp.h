@@ -0,0 +1,148 @@
+/**
+ * @file StressRamp.h
+ * @brief Repeatable Scaling Benchmark: Step Through Load Levels until One Fails
+ *
+ * A table of StressLevel rows, lightest first, describes the synthetic
+ * load at each step: how many load tasks, their period and the CPU, lock
+ * and printf cost of each job, and how many synthetic sensor channels at
+ * what sample period. StressRamp walks it on the caller's clock:
+ *
+ *   APPLY     switch to level() (load tasks, channels)
+ *   settle    settleMs for queues and periods to reach their steady state
+ *   BASELINE  take the monitor totals
+ *   window    windowMs under the load
+ *   SCORE     take them again, pass the differences to score()
+ *             → the same level again (repeats windows in a row), the
+ *               next level, or
+ *   DONE      the first level that failed (or the end of the table)
+ *
+ * A window passes with no deadline missed, no release dropped, no
+ * sample lost to a full queue and the busy CPU at or under the limit
+ * (the headroom kept for bursts the window did not see). The maximum
+ * sustainable level is the last one whose every window passed; the same
+ * table, times and limit give the same steps on every run, so ramps of
+ * two builds compare directly.
+ *
+ * Portable C++ on millis() times passed in; no allocation.
+ *
+ * Usage:
+ *   static StressRamp s_ramp(3000, 15000, 2, 900);    // settle, window, repeats, ‰
+ *   s_ramp.begin(LEVEL_COUNT, millis());
+ *   switch (s_ramp.poll(millis())) {                  // every job of the driver task
+ *   case STRESS_STEP_APPLY:    apply(LEVELS[s_ramp.level()]); break;
+ *   case STRESS_STEP_BASELINE: taskMonitorTotals(&start); break;
+ *   case STRESS_STEP_SCORE:    ...; s_ramp.score(window); break;
+ *   case STRESS_STEP_DONE:     apply(off); report(s_ramp.best()); break;
+ *   default: break;
+ *   }
+ */
+
+#ifndef STRESS_RAMP_H
+#define STRESS_RAMP_H
+
+#include <stdint.h>
+
+/**
+ * @struct StressLevel
+ * @brief Synthetic load of one step.
+ */
+struct StressLevel {
+    uint8_t  loadTasks;        ///< Load tasks running (the rest are parked).
+    uint16_t loadPeriodMs;     ///< Period of each load task.
+    uint16_t cpuUs;            ///< Busy time per job, no lock held.
+    uint16_t lockUs;           ///< Busy time per job with the shared lock held.
+    uint8_t  printChars;       ///< Console bytes per job (0: none).
+    uint8_t  channels;         ///< Synthetic sensor channels.
+    uint16_t channelPeriodMs;  ///< Sample period of each channel.
+};
+
+/**
+ * @struct StressWindow
+ * @brief What the monitors saw over one window (differences of totals).
+ */
+struct StressWindow {
+    uint32_t windowMs;
+    uint16_t busyPermille;  ///< CPU in registered tasks (0 without a sampler).
+    uint32_t misses;        ///< Deadlines missed, all periodic tasks.
+    uint32_t overruns;      ///< Releases dropped.
+    uint32_t queueDrops;    ///< Samples lost to a full queue.
+};
+
+/** @brief What the driver does next (StressRamp::poll()). */
+enum StressStep {
+    STRESS_STEP_NONE = 0,   ///< Nothing yet.
+    STRESS_STEP_APPLY,      ///< Switch the load to level().
+    STRESS_STEP_BASELINE,   ///< A window starts: take the totals.
+    STRESS_STEP_SCORE,      ///< It ended: take them again and call score().
+    STRESS_STEP_DONE        ///< The ramp is over: stop the load, report.
+};
+
+/**
+ * @class StressRamp
+ * @brief Level-by-level search for the heaviest load that still meets every deadline.
+ */
+class StressRamp {
+public:
+    /**
+     * @param settleMs        After each APPLY, before the first window.
+     * @param windowMs        Length of a scored window.
+     * @param repeats         Windows in a row each level must pass (≥ 1).
+     * @param maxBusyPermille Busy CPU allowed (‰).
+     */
+    StressRamp(uint32_t settleMs, uint32_t windowMs, uint8_t repeats, uint16_t maxBusyPermille);
+
+    /** @brief Start at level 0 of @p levels (the next poll() applies it). */
+    void begin(uint8_t levels, uint32_t nowMs);
+
+    /** @brief Abandon the ramp (no DONE step; best() keeps what passed). */
+    void stop();
+
+    /** @brief Between begin() and the DONE step. */
+    bool running() const { return _phase != PHASE_IDLE; }
+
+    /** @brief The next step due at @p nowMs (each is returned once). */
+    StressStep poll(uint32_t nowMs);
+
+    /**
+     * @brief Score the window that poll() just ended.
+     * @return Whether it passed.
+     */
+    bool score(const StressWindow &window);
+
+    /** @brief The limits, alone. */
+    bool passes(const StressWindow &window) const;
+
+    /** @brief Level under test (or last tested). */
+    uint8_t level() const { return _level; }
+
+    /** @brief Windows of level() passed so far. */
+    uint8_t run() const { return _run; }
+
+    /** @brief Highest level whose every window passed, −1 if none. */
+    int16_t best() const { return _best; }
+
+    /** @brief Every level of the table passed (the table did not reach the limit). */
+    bool exhausted() const { return _exhausted; }
+
+    uint32_t windowMs() const { return _windowMs; }
+    uint8_t repeats() const { return _repeats; }
+    uint16_t maxBusyPermille() const { return _maxBusyPermille; }
+
+private:
+    enum Phase { PHASE_IDLE, PHASE_APPLY, PHASE_SETTLE, PHASE_WINDOW, PHASE_SCORE, PHASE_DONE };
+
+    uint32_t _settleMs;
+    uint32_t _windowMs;
+    uint8_t  _repeats;
+    uint16_t _maxBusyPermille;
+
+    Phase    _phase;
+    uint32_t _phaseStartMs;
+    uint8_t  _levels;
+    uint8_t  _level;
+    uint8_t  _run;
+    int16_t  _best;
+    bool     _exhausted;
+};
+
+#endif // STRESS_RAMP_H
@@ -0,0 +1,77 @@
+/**
+ * @file SyntheticLoad.cpp
+ * @brief Synthetic Load and Sensor Channels Implementation
+ *
+ * Implements:
+ * - The busy-wait, in micros() differences (wraps safely)
+ * - The console line: a short header, padding written a byte at a time
+ *   (no line buffer on the small load-task stacks), CR LF
+ * - The channel: triangle wave over waveMs plus xorshift32 noise
+ */
+
+#include "SyntheticLoad.h"
+#include "FlashString.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Load
+// ──────────────────────────────────────────────────────────────────────────
+
+void syntheticBusyUs(uint16_t us) {
+    uint32_t startUs = micros();
+    while ((uint32_t)(micros() - startUs) < us) {
+    }
+}
+
+uint16_t syntheticPrint(uint8_t id, uint16_t seq, uint8_t chars) {
+    if (chars == 0) {
+        return 0;
+    }
+    if (chars < SYNTHETIC_PRINT_MIN_CHARS) {
+        chars = SYNTHETIC_PRINT_MIN_CHARS;
+    }
+    int header = FLASH_PRINTF("~%u %05u ", (unsigned)id, (unsigned)seq);
+    uint16_t written = (header > 0) ? (uint16_t)header : 0;
+    while (written + 2 < chars) {
+        putchar('~');
+        written++;
+    }
+    FLASH_PRINTF("\r\n");
+    return (uint16_t)(written + 2);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Channels
+// ──────────────────────────────────────────────────────────────────────────
+
+/** Used in place of a zero seed (xorshift32 stays at 0). */
+static const uint32_t DEFAULT_SEED = 2463534242UL;
+
+void syntheticChannelInit(SyntheticChannel *ch, uint32_t seed, uint32_t phaseMs) {
+    ch->noiseState = (seed != 0) ? seed : DEFAULT_SEED;
+    ch->phaseMs = phaseMs;
+}
+
+/** @brief Next noise value, uniform in [-1, 1]. */
+static float nextNoise(SyntheticChannel *ch) {
+    uint32_t x = ch->noiseState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ch->noiseState = x;
+    return (float)(x >> 8) * (2.0f / 16777215.0f) - 1.0f;
+}
+
+float syntheticChannelRead(SyntheticChannel *ch, float centre, float amplitude, float noise,
+                           uint32_t waveMs, uint32_t nowMs) {
+    float value = centre;
+    if (waveMs > 0) {
+        // 0 → +A at ¼, 0 at ½, −A at ¾ of the wave.
+        float x = (float)((nowMs + ch->phaseMs) % waveMs) / (float)waveMs;
+        float tri = (x < 0.25f) ? 4.0f * x : (x < 0.75f) ? 2.0f - 4.0f * x : 4.0f * x - 4.0f;
+        value += amplitude * tri;
+    }
+    return value + noise * nextNoise(ch);
+}
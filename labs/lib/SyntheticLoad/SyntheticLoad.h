@@ -0,0 +1,86 @@
+/**
+ * @file SyntheticLoad.h
+ * @brief Synthetic CPU, Lock and printf Load, and Repeatable Synthetic Sensor Channels
+ *
+ * A load test runs the real tasks next to made-up ones whose cost is
+ * known exactly, and raises that cost until something gives. The pieces
+ * here are the made-up parts; the task around them, the lock they hold
+ * and the pipeline the channels feed are the lab's own:
+ *
+ *   syntheticBusyUs(us)      spin on micros() (interrupts stay on, so
+ *                            the time is wall time, as a real job's is)
+ *   syntheticPrint(id, seq, chars)
+ *                            one console line of exactly chars bytes
+ *                            through stdio (the formatting and the TX
+ *                            ring cost, and any drop, of a log line)
+ *   SyntheticChannel         a sensor that reads centre ± amplitude
+ *                            (triangle wave) + uniform noise: the same
+ *                            seed and times give the same readings on
+ *                            every run and on the host
+ *
+ * A lock load is the lab's lock held around syntheticBusyUs(), so it
+ * contends with the tasks that really use it.
+ *
+ * Portable C++, no allocation; StressRamp.h scores the levels.
+ *
+ * Usage:
+ *   syntheticBusyUs(spec.cpuUs);
+ *   { Lock hold(g_state); syntheticBusyUs(spec.lockUs); }
+ *   syntheticPrint(index, seq++, spec.printChars);
+ *
+ *   static SyntheticChannel s_ch;
+ *   syntheticChannelInit(&s_ch, 1, 0);
+ *   float t = syntheticChannelRead(&s_ch, 24.0f, 1.0f, 0.1f, 60000UL, millis());
+ */
+
+#ifndef SYNTHETIC_LOAD_H
+#define SYNTHETIC_LOAD_H
+
+#include <stdint.h>
+
+/** @brief Shortest line syntheticPrint() writes ("~<id> <seq>" and CR LF). */
+#define SYNTHETIC_PRINT_MIN_CHARS 8
+
+/** @brief Busy-wait @p us microseconds (0 returns at once). */
+void syntheticBusyUs(uint16_t us);
+
+/**
+ * @brief Print one line of @p chars bytes to stdout: "~<id> <seq> ~~~…\r\n".
+ *
+ * Shorter requests are raised to SYNTHETIC_PRINT_MIN_CHARS; 0 prints
+ * nothing.
+ *
+ * @return Bytes handed to stdio.
+ */
+uint16_t syntheticPrint(uint8_t id, uint16_t seq, uint8_t chars);
+
+/**
+ * @struct SyntheticChannel
+ * @brief Generator state of one synthetic sensor.
+ */
+struct SyntheticChannel {
+    uint32_t noiseState;  ///< xorshift32 state (never 0).
+    uint32_t phaseMs;     ///< Offset into the wave.
+};
+
+/**
+ * @brief Seed a channel.
+ *
+ * @param seed    Noise seed (0 is replaced by a fixed one).
+ * @param phaseMs Where in the wave the channel starts (spreads channels).
+ */
+void syntheticChannelInit(SyntheticChannel *ch, uint32_t seed, uint32_t phaseMs);
+
+/**
+ * @brief Reading at @p nowMs.
+ *
+ * @param centre    Middle of the wave.
+ * @param amplitude Peak deviation of the triangle wave (≥ 0).
+ * @param noise     Peak of the uniform noise added (≥ 0); advances the
+ *                  generator once per call.
+ * @param waveMs    Period of the wave (0: no wave).
+ */
+float syntheticChannelRead(SyntheticChannel *ch, float centre, float amplitude, float noise,
+                           uint32_t waveMs, uint32_t nowMs);
+
+#endif // SYNTHETIC_LOAD_H
@@ -0,0 +1,198 @@
+/**
+ * @file TaskMonitor.cpp
+ * @brief Per-Task CPU Load and Stack Monitor Implementation
+ *
+ * Sampler: Arduino's init() leaves Timer2 in 8-bit phase-correct PWM with
+ * a /64 prescaler, so it overflows every 510 × 4 µs = 2040 µs. The
+ * overflow ISR compares the running task's handle with the registered
+ * ones and counts a sample for the match. A report turns each count into
+ * time (count × 2040 µs) over the millis() length of the window.
+ */
+
+#include "TaskMonitor.h"
+#include "FlashString.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__AVR__) && defined(TOIE2) && !defined(TASK_MONITOR_NO_SAMPLER)
+#define TASK_MONITOR_HAS_SAMPLER 1
+#include <util/atomic.h>
+#endif
+
+/** Time represented by one sample (one Timer2 overflow). */
+static const uint32_t SAMPLE_US = TASK_MONITOR_SAMPLE_US;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Module state
+// ──────────────────────────────────────────────────────────────────────────
+
+/** One registered task. task and stackDepth are set before count grows. */
+typedef struct {
+    TaskHandle_t           task;        ///< Sampled handle
+    configSTACK_DEPTH_TYPE stackDepth;  ///< Size it was created with
+    const RtosPeriod      *period;      ///< Timing record, NULL if not periodic
+    volatile uint32_t      samples;     ///< Overflows it was running on
+} MonitorSlot_t;
+
+static MonitorSlot_t     s_slots[TASK_MONITOR_MAX_TASKS];
+static volatile uint8_t  s_count = 0;
+static uint32_t          s_windowStartMs = 0;
+static volatile uint32_t s_busySamples = 0;   ///< All slots, never cleared (totals)
+
+#if defined(TASK_MONITOR_HAS_SAMPLER)
+
+ISR(TIMER2_OVF_vect) {
+    TaskHandle_t current = xTaskGetCurrentTaskHandle();
+    uint8_t count = s_count;
+    for (uint8_t i = 0; i < count; i++) {
+        if (s_slots[i].task == current) {
+            s_slots[i].samples++;
+            s_busySamples++;
+            break;
+        }
+    }
+}
+
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool taskMonitorInit() {
+    s_windowStartMs = millis();
+#if defined(TASK_MONITOR_HAS_SAMPLER)
+    TIFR2 = _BV(TOV2);     // Drop a stale overflow
+    TIMSK2 |= _BV(TOIE2);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool taskMonitorAdd(TaskHandle_t task, configSTACK_DEPTH_TYPE stackDepth) {
+    if (task == NULL || s_count >= TASK_MONITOR_MAX_TASKS) {
+        return false;
+    }
+    MonitorSlot_t *slot = &s_slots[s_count];
+    slot->task = task;
+    slot->stackDepth = stackDepth;
+    slot->period = NULL;
+    slot->samples = 0;
+    s_count = (uint8_t)(s_count + 1);   // Publish the slot to the ISR
+    return true;
+}
+
+bool taskMonitorWatch(const RtosPeriod *period) {
+    TaskHandle_t current = xTaskGetCurrentTaskHandle();
+    uint8_t count = s_count;
+    for (uint8_t i = 0; i < count; i++) {
+        if (s_slots[i].task == current) {
+            s_slots[i].period = period;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Timing line of every task that attached its RtosPeriod. */
+static void reportPeriods(uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (s_slots[i].period == NULL) {
+            continue;
+        }
+        // Only the owning task writes the record: keep it from running
+        // while the copy is taken, so the fields belong together.
+        vTaskSuspendAll();
+        RtosPeriodStats stats = s_slots[i].period->stats();
+        xTaskResumeAll();
+
+        FLASH_PRINTF("[MON] %-8s %4lu ms  resp %lu / %lu ms  miss %lu / %lu  drop %lu\r\n",
+                     pcTaskGetName(s_slots[i].task), (unsigned long)stats.periodMs,
+                     (unsigned long)stats.lastResponseMs, (unsigned long)stats.worstResponseMs,
+                     (unsigned long)stats.misses, (unsigned long)stats.jobs,
+                     (unsigned long)stats.overruns);
+    }
+}
+
+void taskMonitorReport() {
+    uint32_t samples[TASK_MONITOR_MAX_TASKS];
+    uint8_t count = s_count;
+
+    // Take and clear the window's counts in one step.
+#if defined(TASK_MONITOR_HAS_SAMPLER)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+    {
+        for (uint8_t i = 0; i < count; i++) {
+            samples[i] = s_slots[i].samples;
+            s_slots[i].samples = 0;
+        }
+    }
+    uint32_t now = millis();
+    uint32_t windowMs = now - s_windowStartMs;
+    s_windowStartMs = now;
+    if (windowMs == 0) {
+        windowMs = 1;
+    }
+
+    FLASH_PRINTF("[MON] %lu ms window: CPU, free stack (min) / stack size\r\n",
+                 (unsigned long)windowMs);
+
+    uint16_t busyPermille = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const char *name = pcTaskGetName(s_slots[i].task);
+        unsigned freeStack = (unsigned)uxTaskGetStackHighWaterMark(s_slots[i].task);
+#if defined(TASK_MONITOR_HAS_SAMPLER)
+        // ×2040 stays within 32 bits for windows up to ~70 minutes.
+        uint32_t permille = samples[i] * SAMPLE_US / windowMs;
+        if (permille > 1000) {
+            permille = 1000;
+        }
+        busyPermille = (uint16_t)(busyPermille + permille);
+        FLASH_PRINTF("[MON] %-8s %3u.%u %%  %4u / %u B\r\n", name,
+                     (unsigned)(permille / 10), (unsigned)(permille % 10),
+                     freeStack, (unsigned)s_slots[i].stackDepth);
+#else
+        FLASH_PRINTF("[MON] %-8s   -   %%  %4u / %u B\r\n", name,
+                     freeStack, (unsigned)s_slots[i].stackDepth);
+#endif
+    }
+
+#if defined(TASK_MONITOR_HAS_SAMPLER)
+    uint16_t otherPermille = (busyPermille < 1000) ? (uint16_t)(1000 - busyPermille) : 0;
+    FLASH_PRINTF("[MON] %-8s %3u.%u %%  (idle, loop(), unregistered tasks)\r\n", "other",
+                 (unsigned)(otherPermille / 10), (unsigned)(otherPermille % 10));
+#else
+    (void)samples;
+    (void)busyPermille;
+#endif
+
+    reportPeriods(count);
+}
+
+bool taskMonitorTotals(TaskMonitorTotals *out) {
+    uint8_t count = s_count;
+    memset(out, 0, sizeof(*out));
+#if defined(TASK_MONITOR_HAS_SAMPLER)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        out->busySamples = s_busySamples;
+    }
+#endif
+    vTaskSuspendAll();
+    for (uint8_t i = 0; i < count; i++) {
+        if (s_slots[i].period != NULL) {
+            const RtosPeriodStats &stats = s_slots[i].period->stats();
+            out->jobs += stats.jobs;
+            out->misses += stats.misses;
+            out->overruns += stats.overruns;
+        }
+    }
+    xTaskResumeAll();
+#if defined(TASK_MONITOR_HAS_SAMPLER)
+    return true;
+#else
+    return false;
+#endif
+}
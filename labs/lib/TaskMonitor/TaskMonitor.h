@@ -0,0 +1,125 @@
+/**
+ * @file TaskMonitor.h
+ * @brief Per-Task CPU Load and Stack High-Water-Mark Monitor for FreeRTOS
+ *
+ * Reports, for every registered task, the share of CPU time it used since
+ * the previous report and the least free stack it has ever had:
+ *
+ *   [MON] 10003 ms window: CPU, free stack (min) / stack size
+ *   [MON] Control    3.1 %   212 / 640 B
+ *   [MON] Display   11.8 %   394 / 1024 B
+ *   [MON] other     80.4 %   (idle, loop(), unregistered tasks)
+ *
+ * CPU time is sampled, not traced: the Timer2 overflow interrupt
+ * (Arduino's 490 Hz analogWrite timer on pins 9/10, left unchanged) notes
+ * which task it interrupted, every 2.04 ms. Over a window of seconds this
+ * gives per-task load to a few tenths of a percent. It needs no kernel
+ * configuration (configGENERATE_RUN_TIME_STATS and its counter macros
+ * would have to be compiled into the FreeRTOS library), takes no timer
+ * of its own, and costs ~0.2 % CPU. A task that always runs in step with
+ * Timer2 could be mis-sampled; FreeRTOS ticks on the watchdog, so the
+ * scheduler is not. "other" is the remainder of the window, so time the
+ * CPU spent asleep (e.g. ADC noise reduction) counts there too.
+ *
+ * A periodic task that registers its RtosPeriod gets a timing line too:
+ * period, last / worst response time (release to completion), deadlines
+ * missed out of jobs run, and releases dropped:
+ *
+ *   [MON] Display  250 ms  resp 41 / 96 ms  miss 0 / 1204  drop 0
+ *
+ * Free stack is uxTaskGetStackHighWaterMark(): the minimum ever left, in
+ * bytes on AVR. Size a stack as (size - free) plus a safety margin once
+ * every code path (commands, errors, calibration) has run.
+ *
+ * Keep TIMER2_OVF_vect free (-DTASK_MONITOR_NO_SAMPLER drops the sampler;
+ * the report then shows stacks only), and leave Timer2's Arduino setup
+ * alone (tone() reprograms it).
+ *
+ * Usage:
+ *   taskMonitorInit();                                      // setup()
+ *   s_task.create(vTaskWorker, "Worker", NULL, 1);          // StaticRtos
+ *   taskMonitorAdd(s_task.handle(), s_task.stackDepth());
+ *   taskMonitorWatch(&period);                              // in the task
+ *   taskMonitorReport();                                    // any task
+ *
+ * A load test reads the same figures as running totals instead
+ * (taskMonitorTotals()), which leaves the report window alone.
+ */
+
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <Arduino.h>
+#include <Arduino_FreeRTOS.h>
+
+#include "RtosTime.h"
+
+/** @brief Maximum number of tasks that can be registered. */
+#ifndef TASK_MONITOR_MAX_TASKS
+#define TASK_MONITOR_MAX_TASKS 8
+#endif
+
+/** @brief CPU time one sample stands for (one Timer2 overflow, µs). */
+#define TASK_MONITOR_SAMPLE_US 2040UL
+
+/**
+ * @struct TaskMonitorTotals
+ * @brief Running totals since taskMonitorInit(), for differences over a window.
+ *
+ * Busy CPU over a window is Δbusy × TASK_MONITOR_SAMPLE_US / Δms ‰.
+ * The timing sums cover the tasks that attached an RtosPeriod; one that
+ * is rebuilt (a new period) starts its own counts again.
+ */
+struct TaskMonitorTotals {
+    uint32_t busySamples;  ///< Samples that found a registered task running.
+    uint32_t jobs;         ///< Σ jobs completed.
+    uint32_t misses;       ///< Σ deadlines missed.
+    uint32_t overruns;     ///< Σ releases dropped.
+};
+
+/**
+ * @brief Start sampling; opens the first report window.
+ *
+ * Call once from setup(), before or after creating the tasks.
+ *
+ * @return false if the sampler is not available on this build.
+ */
+bool taskMonitorInit();
+
+/**
+ * @brief Register a task to be reported.
+ *
+ * @param task       Handle of a created task.
+ * @param stackDepth Stack size it was created with (for the report).
+ * @return false if task is NULL or TASK_MONITOR_MAX_TASKS are registered.
+ */
+bool taskMonitorAdd(TaskHandle_t task, configSTACK_DEPTH_TYPE stackDepth);
+
+/**
+ * @brief Attach the calling task's RtosPeriod to its entry.
+ *
+ * Call from the task, once, after creating its RtosPeriod (which must
+ * live as long as the task: declare it before the task loop).
+ *
+ * @return false if the calling task was not registered with taskMonitorAdd().
+ */
+bool taskMonitorWatch(const RtosPeriod *period);
+
+/**
+ * @brief Print the table to stdout and start a new window.
+ *
+ * Prints directly with printf(), so call it from a task that is allowed
+ * to stall on the serial port (a low-priority telemetry or console task).
+ */
+void taskMonitorReport();
+
+/**
+ * @brief Copy the running totals (no printing, the report window is kept).
+ *
+ * Safe from any task; suspends the scheduler for the timing records.
+ *
+ * @return false without the sampler (busySamples stays 0).
+ */
+bool taskMonitorTotals(TaskMonitorTotals *out);
+
+#endif // TASK_MONITOR_H
@@ -0,0 +1,146 @@
+/**
+ * @file Coroutine.h
+ * @brief Stackless Coroutines (Protothreads) for TaskScheduler Tasks
+ *
+ * A TaskScheduler task must return quickly, so a sequence that waits
+ * ("LED on, wait 100 ms, off, wait for the button...") normally becomes
+ * an explicit state machine with step counters. A coroutine keeps the
+ * sequence in its natural order: the task function is written as one
+ * straight-line body, and each AWAIT_*() returns to the scheduler and
+ * continues at the same line on a later call.
+ *
+ * It is the protothread technique: the resume point is a switch on the
+ * source line (__LINE__) of the last wait, so a coroutine costs a 6-byte
+ * Coroutine record and no stack of its own, against the few hundred
+ * bytes of a FreeRTOS task stack. (C++20 coroutines would need a newer
+ * compiler than the avr-gcc 7.3 shipped with PlatformIO's atmelavr.)
+ *
+ * The price of having no stack:
+ *   - locals do not survive a wait; keep state that must in statics or
+ *     in a struct passed to the task,
+ *   - a coroutine body cannot itself contain a switch statement, the
+ *     waits must be in the body, not in a function it calls, and each
+ *     must be on a source line of its own,
+ *   - the body must return void (a TaskContext_t funcPtr does).
+ *
+ * The scheduler decides when a coroutine is resumed: as a periodic task
+ * it is polled every period, which is then the resolution of
+ * AWAIT_MS(); as an event task (schedulerSetEvents()) it is resumed by
+ * each schedulerSignal(). Reaching CORO_END() restarts it from the top on
+ * the next call, so a body is usually one sequence run forever.
+ *
+ * Usage:
+ *   static Coroutine s_blinkCoro;
+ *   static CoroEvent s_pressEvent;            // coroSignal(&s_pressEvent) from Task 1
+ *   static uint8_t s_blink;
+ *
+ *   static void taskBlink() {                 // { taskBlink, 10, 0 } in the task table
+ *       CORO_BEGIN(s_blinkCoro);
+ *       AWAIT_EVENT(s_pressEvent);
+ *       for (s_blink = 0; s_blink < 5; s_blink++) {
+ *           digitalWrite(PIN_LED, HIGH);
+ *           AWAIT_MS(100);
+ *           digitalWrite(PIN_LED, LOW);
+ *           AWAIT_MS(100);
+ *       }
+ *       CORO_END();
+ *   }
+ */
+
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <Arduino.h>
+
+/**
+ * @struct Coroutine
+ * @brief Resume point and wait start of one coroutine; zero = not started.
+ */
+typedef struct {
+    uint16_t line;      /**< Source line to resume at (0 = top). */
+    uint32_t sinceMs;   /**< millis() when the current AWAIT_MS() began. */
+} Coroutine;
+
+/**
+ * @struct CoroEvent
+ * @brief Flag a coroutine waits for with AWAIT_EVENT().
+ *
+ * One byte, so coroSignal() is a single store and safe from an ISR.
+ * Signals before the coroutine takes the event coalesce.
+ */
+typedef struct {
+    volatile uint8_t pending;
+} CoroEvent;
+
+/** @brief Mark an event pending (ISR-safe). */
+static inline void coroSignal(CoroEvent *event) {
+    event->pending = 1;
+}
+
+/** @brief Consume a pending event; used by AWAIT_EVENT(). */
+static inline bool coroTake(CoroEvent *event) {
+    if (!event->pending) {
+        return false;
+    }
+    event->pending = 0;
+    return true;
+}
+
+/** @brief Restart a coroutine from the top on its next call. */
+static inline void coroReset(Coroutine *coro) {
+    coro->line = 0;
+}
+
+/** @brief True between CORO_BEGIN() and CORO_END(), i.e. suspended in a wait. */
+static inline bool coroIsWaiting(const Coroutine *coro) {
+    return coro->line != 0;
+}
+
+// Falling from a wait's setup into its own resume label is intended.
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define CORO_FALLTHROUGH_ __attribute__((fallthrough))
+#else
+#define CORO_FALLTHROUGH_ ((void)0)
+#endif
+
+/** @brief Open the coroutine body; resumes at the last wait. */
+#define CORO_BEGIN(coro)                  \
+    Coroutine &coro_self_ = (coro);       \
+    switch (coro_self_.line) {            \
+    case 0:
+
+/** @brief Close the body; the next call starts again from the top. */
+#define CORO_END()                        \
+    }                                     \
+    coro_self_.line = 0
+
+/** @brief Return to the scheduler; continue here on the next call. */
+#define CORO_YIELD()                      \
+    do {                                  \
+        coro_self_.line = __LINE__;       \
+        return;                           \
+    case __LINE__:;                       \
+    } while (0)
+
+/** @brief Return to the scheduler until cond is true (checked on each call, also the first). */
+#define AWAIT_UNTIL(cond)                 \
+    do {                                  \
+        coro_self_.line = __LINE__;       \
+        CORO_FALLTHROUGH_;                \
+    case __LINE__:                        \
+        if (!(cond)) {                    \
+            return;                       \
+        }                                 \
+    } while (0)
+
+/** @brief Wait at least ms milliseconds (to the next call after they pass). */
+#define AWAIT_MS(ms)                                                        \
+    do {                                                                    \
+        coro_self_.sinceMs = millis();                                      \
+        AWAIT_UNTIL((uint32_t)(millis() - coro_self_.sinceMs) >= (uint32_t)(ms)); \
+    } while (0)
+
+/** @brief Wait for coroSignal() on a CoroEvent, and consume it. */
+#define AWAIT_EVENT(event) AWAIT_UNTIL(coroTake(&(event)))
+
+#endif // COROUTINE_H
@@ -0,0 +1,305 @@
+/**
+ * @file CyclicExecutive.h
+ * @brief Compile-Time Cyclic-Executive Variant of TaskScheduler
+ *
+ * For task sets that are fully known at compile time, the run-time deadline
+ * queue in TaskScheduler is unnecessary work. CyclicExecutive takes a
+ * constexpr task table and, at compile time:
+ *   - computes the minor cycle (GCD of all periods and offsets),
+ *   - computes the hyperperiod / major cycle (LCM of all periods),
+ *   - builds a dispatch table in flash with one task bitmask per minor
+ *     cycle slot, and
+ *   - validates the table with static_assert (non-zero periods, offsets
+ *     smaller than their period, table size and per-slot load limits).
+ *
+ * At run time each minor cycle is a PROGMEM byte lookup followed by calls
+ * to the tasks whose bit is set — no per-task deadline arithmetic. All
+ * tasks released in the same slot run back-to-back in table order.
+ *
+ * Only C++11 constexpr is used, so it builds with the stock avr-gcc
+ * -std=gnu++11 setting and does not depend on the C++ standard library.
+ *
+ * Usage:
+ *   static constexpr CyclicTask s_table[] = {
+ *       { task1Func, 10,    0    },
+ *       { task2Func, 50,    5    },
+ *       { task3Func, 10000, 2000 },
+ *   };
+ *   static CyclicExecutive<s_table, 3> s_exec;
+ *   s_exec.init();                 // Called once in setup()
+ *   s_exec.run();                  // Called every loop() iteration
+ *
+ * With -DTASK_SCHEDULER_STATS=1 each task keeps a TaskStats_t as under
+ * TaskScheduler: execution times, release delay after its slot's start
+ * (ms), and as "skipped" the slots released a whole minor cycle or more
+ * late (run() catches those up back-to-back). dumpStats() prints the
+ * same table as schedulerDumpStats().
+ */
+
+#ifndef CYCLIC_EXECUTIVE_H
+#define CYCLIC_EXECUTIVE_H
+
+#include <Arduino.h>
+#include "TaskScheduler.h"   // TASK_SCHEDULER_STATS, TaskStats_t
+#if TASK_SCHEDULER_STATS
+#include <string.h>
+#endif
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#endif
+#endif
+
+/**
+ * @brief Upper bound on dispatch-table slots (bytes of flash) per executive.
+ *
+ * Guards against a period/offset combination that silently explodes the
+ * table (e.g. co-prime periods). Override with -DCYCLIC_EXECUTIVE_MAX_SLOTS.
+ */
+#ifndef CYCLIC_EXECUTIVE_MAX_SLOTS
+#define CYCLIC_EXECUTIVE_MAX_SLOTS 4096
+#endif
+
+/**
+ * @brief Static task descriptor for CyclicExecutive.
+ *
+ * Same meaning as the caller-filled part of TaskContext_t: the task is
+ * released at offset, offset + period, offset + 2*period, ... (ms).
+ */
+struct CyclicTask {
+    void     (*funcPtr)();  /**< Task function. Must be non-blocking. */
+    uint32_t  period;       /**< Recurrence period in milliseconds. */
+    uint32_t  offset;       /**< Release offset in milliseconds (< period). */
+};
+
+namespace cyclic_detail {
+
+constexpr uint32_t gcd(uint32_t a, uint32_t b) {
+    return b == 0 ? a : gcd(b, a % b);
+}
+
+constexpr uint32_t lcm(uint32_t a, uint32_t b) {
+    return (a == 0 || b == 0) ? 0 : (a / gcd(a, b)) * b;
+}
+
+constexpr uint32_t minorCycle(const CyclicTask *t, uint8_t n) {
+    return n == 0 ? 0 : gcd(gcd(minorCycle(t, n - 1), t[n - 1].period), t[n - 1].offset);
+}
+
+constexpr uint32_t majorCycle(const CyclicTask *t, uint8_t n) {
+    return n == 0 ? 1 : lcm(majorCycle(t, n - 1), t[n - 1].period);
+}
+
+constexpr bool periodsValid(const CyclicTask *t, uint8_t n) {
+    return n == 0 ? true
+                  : (t[n - 1].period > 0 && t[n - 1].offset < t[n - 1].period &&
+                     t[n - 1].funcPtr != nullptr && periodsValid(t, n - 1));
+}
+
+/** Bitmask of tasks released at time (ms) within the hyperperiod. */
+constexpr uint8_t slotMask(const CyclicTask *t, uint8_t n, uint32_t time) {
+    return n == 0 ? 0
+                  : (uint8_t)(slotMask(t, n - 1, time) |
+                              ((time % t[n - 1].period) == t[n - 1].offset
+                                   ? (uint8_t)(1U << (n - 1)) : (uint8_t)0));
+}
+
+constexpr uint8_t popCount(uint8_t m) {
+    return m == 0 ? 0 : (uint8_t)((m & 1U) + popCount((uint8_t)(m >> 1)));
+}
+
+constexpr uint8_t maxU8(uint8_t a, uint8_t b) {
+    return a > b ? a : b;
+}
+
+/** Largest number of tasks released in any single slot in [first, first+count). */
+constexpr uint8_t maxLoad(const CyclicTask *t, uint8_t n, uint32_t minor,
+                          uint32_t first, uint32_t count) {
+    return count == 1
+               ? popCount(slotMask(t, n, first * minor))
+               : maxU8(maxLoad(t, n, minor, first, count / 2),
+                       maxLoad(t, n, minor, first + count / 2, count - count / 2));
+}
+
+// Log-depth index sequence (C++11, no <utility> on AVR).
+template <uint16_t... I> struct IndexSeq {};
+
+template <class A, class B> struct Concat;
+template <uint16_t... A, uint16_t... B>
+struct Concat<IndexSeq<A...>, IndexSeq<B...> > {
+    typedef IndexSeq<A..., (uint16_t)(sizeof...(A) + B)...> type;
+};
+
+template <uint16_t N> struct MakeIndexSeq {
+    typedef typename Concat<typename MakeIndexSeq<N / 2>::type,
+                            typename MakeIndexSeq<N - N / 2>::type>::type type;
+};
+template <> struct MakeIndexSeq<0> { typedef IndexSeq<> type; };
+template <> struct MakeIndexSeq<1> { typedef IndexSeq<0> type; };
+
+/** Flash-resident dispatch table: one task bitmask per minor-cycle slot. */
+template <const CyclicTask *Tasks, uint8_t Count, uint32_t Minor, class Seq>
+struct DispatchTable;
+
+template <const CyclicTask *Tasks, uint8_t Count, uint32_t Minor, uint16_t... I>
+struct DispatchTable<Tasks, Count, Minor, IndexSeq<I...> > {
+    static const uint8_t masks[sizeof...(I)];
+};
+
+template <const CyclicTask *Tasks, uint8_t Count, uint32_t Minor, uint16_t... I>
+const uint8_t DispatchTable<Tasks, Count, Minor, IndexSeq<I...> >::masks[sizeof...(I)] PROGMEM = {
+    slotMask(Tasks, Count, (uint32_t)I * Minor)...
+};
+
+} // namespace cyclic_detail
+
+/**
+ * @class CyclicExecutive
+ * @brief Table-driven cyclic executive generated from a constexpr task table.
+ *
+ * @tparam Tasks       Address of a constexpr CyclicTask array with static storage.
+ * @tparam Count       Number of entries in the array (1..8).
+ * @tparam MaxPerSlot  Maximum tasks allowed to be released in the same minor
+ *                     cycle; a larger overlap fails to compile.
+ */
+template <const CyclicTask *Tasks, uint8_t Count, uint8_t MaxPerSlot = 8>
+class CyclicExecutive {
+public:
+    static_assert(Count > 0 && Count <= 8, "CyclicExecutive supports 1..8 tasks");
+    static_assert(cyclic_detail::periodsValid(Tasks, Count),
+                  "Each task needs a function, a non-zero period and offset < period");
+
+    /** Minor cycle (ms): GCD of every period and offset. */
+    static constexpr uint32_t MINOR_MS = cyclic_detail::minorCycle(Tasks, Count);
+
+    /** Major cycle / hyperperiod (ms): LCM of every period. */
+    static constexpr uint32_t MAJOR_MS = cyclic_detail::majorCycle(Tasks, Count);
+
+    /** Number of minor-cycle slots (dispatch table entries). */
+    static constexpr uint32_t SLOT_COUNT = MAJOR_MS / MINOR_MS;
+
+    static_assert(MAJOR_MS != 0 && SLOT_COUNT <= CYCLIC_EXECUTIVE_MAX_SLOTS,
+                  "Hyperperiod / minor cycle too large; align task periods");
+    static_assert(cyclic_detail::maxLoad(Tasks, Count, MINOR_MS, 0, SLOT_COUNT) <= MaxPerSlot,
+                  "Too many tasks released in the same minor cycle");
+
+    CyclicExecutive() : _slot(0), _slotStart(0), _pending(false), _timed(false) {
+#if TASK_SCHEDULER_STATS
+        resetStats();
+#endif
+    }
+
+    /** @brief Align slot 0 with the current time. Call once from setup(). */
+    void init() {
+        _slot      = 0;
+        _slotStart = millis();
+        _pending   = true;
+    }
+
+    /**
+     * @brief Dispatch the current slot if its minor cycle has started.
+     *
+     * Slot 0 is dispatched immediately after init(); subsequent slots are
+     * released every MINOR_MS. The slot start advances by exactly MINOR_MS
+     * so the table stays phase-locked to the hyperperiod without drift.
+     *
+     * @return true if a slot was dispatched on this call.
+     */
+    bool run() {
+        if (!_pending) {
+            if ((uint32_t)(millis() - _slotStart) < MINOR_MS) {
+                return false;
+            }
+            _slotStart += MINOR_MS;
+        }
+        _pending = false;
+        _timed   = true;
+        dispatchSlot();
+        _timed   = false;
+        return true;
+    }
+
+    /**
+     * @brief Run every task released in the current slot and advance.
+     *
+     * Use directly when the minor cycle is generated by a hardware timer
+     * flag instead of polling millis() through run().
+     */
+    void dispatchSlot() {
+        uint8_t mask = pgm_read_byte(&Table::masks[_slot]);
+        for (uint8_t i = 0; mask != 0; i++, mask >>= 1) {
+            if (mask & 1U) {
+#if TASK_SCHEDULER_STATS
+                // Release delay only on the run() clock; 0 when driven directly.
+                uint32_t jitter = _timed ? (uint32_t)(millis() - _slotStart) : 0;
+                uint32_t start  = micros();
+                Tasks[i].funcPtr();
+                recordRun(&_stats[i], micros() - start, jitter);
+#else
+                Tasks[i].funcPtr();
+#endif
+            }
+        }
+        if (++_slot >= SLOT_COUNT) {
+            _slot = 0;
+        }
+    }
+
+    /** @brief Index of the next slot to be dispatched. */
+    uint16_t getSlot() const { return _slot; }
+
+#if TASK_SCHEDULER_STATS
+    /** @brief Timing of task @p index (table order). */
+    const TaskStats_t &getStats(uint8_t index) const { return _stats[index]; }
+
+    /** @brief Print the per-task table (schedulerDumpStats() layout). */
+    void dumpStats() const {
+        schedulerPrintStatsHeader();
+        for (uint8_t i = 0; i < Count; i++) {
+            schedulerPrintStatsRow(i, Tasks[i].period, &_stats[i]);
+        }
+    }
+
+    /** @brief Clear every task's statistics. */
+    void resetStats() { memset(_stats, 0, sizeof(_stats)); }
+#endif
+
+private:
+#if TASK_SCHEDULER_STATS
+    /** @brief Same bookkeeping as the heap scheduler's dispatch. */
+    static void recordRun(TaskStats_t *stats, uint32_t exec, uint32_t jitter) {
+        stats->lastExecUs = exec;
+        stats->lastJitter = jitter;
+        if (exec > stats->maxExecUs)   stats->maxExecUs = exec;
+        if (jitter > stats->maxJitter) stats->maxJitter = jitter;
+        if (jitter >= MINOR_MS)        stats->skippedPeriods++;
+        if (stats->runCount == 0) {
+            stats->avgExecUs = exec;
+        } else {
+            stats->avgExecUs = (uint32_t)((int32_t)stats->avgExecUs +
+                                          ((int32_t)(exec - stats->avgExecUs) >> 3));
+        }
+        stats->runCount++;
+    }
+#endif
+
+    typedef cyclic_detail::DispatchTable<
+        Tasks, Count, MINOR_MS,
+        typename cyclic_detail::MakeIndexSeq<(uint16_t)SLOT_COUNT>::type> Table;
+
+    uint16_t _slot;       ///< Next slot to dispatch.
+    uint32_t _slotStart;  ///< millis() at which the next slot's minor cycle began.
+    bool     _pending;    ///< True right after init(): slot 0 is due immediately.
+    bool     _timed;      ///< Dispatching from run(): _slotStart is this slot's release.
+#if TASK_SCHEDULER_STATS
+    TaskStats_t _stats[Count];
+#endif
+};
+
+#endif // CYCLIC_EXECUTIVE_H
@@ -4,53 +4,399 @@
  *
  * The scheduler follows a Earliest-Deadline-First (EDF) selection policy
  * within a single loop() tick:
- *   1. Scan all tasks to find which ones are due (nextRun <= millis()).
- *   2. Among due tasks, pick the one with the smallest nextRun value
+ *   1. Peek the heap root — the task with the smallest nextRun value
  *      (the most overdue task, meaning highest urgency).
- *   3. Execute that task's function pointer (must be non-blocking).
- *   4. Advance its nextRun by period; if the new nextRun is still in
+ *   2. If it is due (nextRun <= millis()), execute its function pointer
+ *      (must be non-blocking).
+ *   3. Advance its nextRun by period; if the new nextRun is still in
  *      the past, re-anchor it to now + period to prevent burst catch-up.
+ *   4. Sift the root down to restore heap order.
  *
  * Since loop() runs at hundreds of kHz on an Arduino Mega 2560 when tasks
  * sleep or have no work, a single task per tick effectively runs all tasks
- * at their correct cadence without starving any of them.
+ * at their correct cadence without starving any of them. Keeping the tasks
+ * in a min-heap makes the idle check a single comparison regardless of the
+ * number of tasks.
+ *
+ * schedulerQueueRunFor() repeats steps 1-4 within one call, until nothing
+ * is due or its micros() budget is spent.
  */
 
 #include "TaskScheduler.h"
+#include "FlashString.h"
 
-void schedulerInit(TaskContext_t *tasks, uint8_t count) {
-    uint32_t now = millis();
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+#if TASK_SCHEDULER_STATS
+#include <stdio.h>
+#include <string.h>
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Internal helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+/** Queue used by the schedulerInit()/schedulerRun() compatibility API. */
+static TaskQueue_t s_defaultQueue;
+
+/**
+ * @brief Wrap-safe deadline ordering: true if a is strictly before b.
+ *
+ * Valid as long as the two deadlines are less than 2^31 ms (~24 days)
+ * apart, which holds for any realistic task period.
+ */
+static inline bool deadlineBefore(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+/** Current time in the queue's time unit. */
+static inline uint32_t queueNow(const TaskQueue_t *queue) {
+    return queue->useMicros ? micros() : millis();
+}
+
+static inline bool heapLess(const TaskQueue_t *queue, uint8_t i, uint8_t j) {
+    return deadlineBefore(queue->tasks[queue->heap[i]].nextRun,
+                          queue->tasks[queue->heap[j]].nextRun);
+}
+
+static void heapSiftDown(TaskQueue_t *queue, uint8_t pos) {
+    for (;;) {
+        uint8_t left     = (uint8_t)(2 * pos + 1);
+        uint8_t right    = (uint8_t)(left + 1);
+        uint8_t smallest = pos;
+
+        if (left < queue->count && heapLess(queue, left, smallest)) {
+            smallest = left;
+        }
+        if (right < queue->count && heapLess(queue, right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+
+        uint8_t tmp           = queue->heap[pos];
+        queue->heap[pos]      = queue->heap[smallest];
+        queue->heap[smallest] = tmp;
+        pos = smallest;
+    }
+}
+
+/** Bind the queue to a task array and heapify using the current nextRun values. */
+static void heapBuild(TaskQueue_t *queue, TaskContext_t *tasks, uint8_t count) {
+    if (count > TASK_SCHEDULER_MAX_TASKS) {
+        count = TASK_SCHEDULER_MAX_TASKS;
+    }
+
+    queue->tasks = tasks;
+    queue->count = count;
     for (uint8_t i = 0; i < count; i++) {
-        tasks[i].nextRun = now + tasks[i].offset;
+        queue->heap[i] = i;
+    }
+    for (int8_t i = (int8_t)(count / 2) - 1; i >= 0; i--) {
+        heapSiftDown(queue, (uint8_t)i);
     }
 }
 
-void schedulerRun(TaskContext_t *tasks, uint8_t count) {
-    uint32_t now     = millis();
-    int8_t   chosen  = -1;
-    uint32_t earliest = UINT32_MAX;
+// ──────────────────────────────────────────────────────────────────────────
+// Deadline queue API
+// ──────────────────────────────────────────────────────────────────────────
 
-    // Find the most-overdue task among all tasks that are due this tick.
+/** Shared init path for both timebases. */
+static void queueInit(TaskQueue_t *queue, TaskContext_t *tasks, uint8_t count, bool useMicros) {
+    queue->useMicros = useMicros;
+
+    uint32_t now = queueNow(queue);
     for (uint8_t i = 0; i < count; i++) {
-        if (now >= tasks[i].nextRun) {
-            if (tasks[i].nextRun < earliest) {
-                earliest = tasks[i].nextRun;
-                chosen   = i;
-            }
+        tasks[i].nextRun = now + tasks[i].offset;
+    }
+    heapBuild(queue, tasks, count);
+    schedulerQueueSetEvents(queue, NULL, 0);
+}
+
+void schedulerQueueInit(TaskQueue_t *queue, TaskContext_t *tasks, uint8_t count) {
+    queueInit(queue, tasks, count, false);
+}
+
+void schedulerQueueInitUs(TaskQueue_t *queue, TaskContext_t *tasks, uint8_t count) {
+    queueInit(queue, tasks, count, true);
+}
+
+void schedulerQueueSetEvents(TaskQueue_t *queue, const EventTaskFunc_t *handlers, uint8_t count) {
+    if (count > TASK_SCHEDULER_MAX_EVENTS) {
+        count = TASK_SCHEDULER_MAX_EVENTS;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        queue->events     = handlers;
+        queue->eventCount = (handlers != NULL) ? count : 0;
+        queue->ready      = 0;
+    }
+}
+
+void schedulerQueueSignal(TaskQueue_t *queue, uint8_t eventId) {
+    if (eventId >= queue->eventCount) {
+        return;
+    }
+
+    // The read-modify-write of ready must not be split by another ISR.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        queue->ready |= (uint8_t)(1U << eventId);
+    }
+}
+
+/** Claim and run the lowest-numbered ready event task, if any. */
+static bool runReadyEvent(TaskQueue_t *queue) {
+    if (queue->ready == 0) {
+        return false;
+    }
+
+    uint8_t id = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t pending = queue->ready;
+        while ((pending & 1U) == 0) {
+            pending >>= 1;
+            id++;
+        }
+        queue->ready &= (uint8_t)~(1U << id);
+    }
+
+    // Clear before running: a signal raised while the handler executes
+    // schedules it once more instead of being lost.
+    queue->events[id]();
+    return true;
+}
+
+TaskContext_t *schedulerQueuePeek(const TaskQueue_t *queue) {
+    if (queue->count == 0) {
+        return NULL;
+    }
+    return &queue->tasks[queue->heap[0]];
+}
+
+bool schedulerQueueRun(TaskQueue_t *queue) {
+    // Event tasks readied by ISRs run ahead of periodic work.
+    if (runReadyEvent(queue)) {
+        return true;
+    }
+
+    if (queue->count == 0) {
+        return false;
+    }
+
+    TaskContext_t *task = &queue->tasks[queue->heap[0]];
+    uint32_t now = queueNow(queue);
+
+    // Only the root can be the most-overdue task; nothing else to check.
+    if (deadlineBefore(now, task->nextRun)) {
+        return false;
+    }
+
+#if TASK_SCHEDULER_STATS
+    TaskStats_t *stats  = &task->stats;
+    uint32_t     jitter = now - task->nextRun;
+    uint32_t     start  = micros();
+#endif
+
+    // Execute the selected task.
+    task->funcPtr();
+
+#if TASK_SCHEDULER_STATS
+    uint32_t exec = micros() - start;
+    stats->lastExecUs   = exec;
+    stats->lastJitter   = jitter;
+    if (exec > stats->maxExecUs)     stats->maxExecUs   = exec;
+    if (jitter > stats->maxJitter)   stats->maxJitter   = jitter;
+    if (stats->runCount == 0) {
+        stats->avgExecUs = exec;
+    } else {
+        stats->avgExecUs = (uint32_t)((int32_t)stats->avgExecUs +
+                                      ((int32_t)(exec - stats->avgExecUs) >> 3));
+    }
+    stats->runCount++;
+#endif
+
+    // Advance the deadline by one period.
+    task->nextRun += task->period;
+
+    // Guard against falling far behind: if the new deadline is still
+    // in the past, re-anchor from now to avoid cascading catch-up runs.
+    uint32_t after = queueNow(queue);
+    if (deadlineBefore(task->nextRun, after)) {
+#if TASK_SCHEDULER_STATS
+        // Every period boundary between the stale deadline and now is lost.
+        uint32_t behind = after - task->nextRun;
+        stats->skippedPeriods += (task->period > 0) ? (behind / task->period) + 1 : 1;
+#endif
+        task->nextRun = after + task->period;
+    }
+
+    // The root's deadline only moved forward, so a sift-down restores order.
+    heapSiftDown(queue, 0);
+    return true;
+}
+
+uint8_t schedulerQueueRunFor(TaskQueue_t *queue, uint32_t budgetUs) {
+    uint32_t start = micros();
+    uint8_t  ran   = 0;
+
+    while (ran < UINT8_MAX && schedulerQueueRun(queue)) {
+        ran++;
+        // Tasks are not preempted: the budget only decides whether the
+        // next due one starts in this call or in the next loop() pass.
+        if ((uint32_t)(micros() - start) >= budgetUs) {
+            break;
         }
     }
+    return ran;
+}
+
+uint32_t schedulerQueueTimeToNext(const TaskQueue_t *queue) {
+    if (queue->count == 0) {
+        return UINT32_MAX;
+    }
+
+    uint32_t next = queue->tasks[queue->heap[0]].nextRun;
+    uint32_t now  = queueNow(queue);
+    return deadlineBefore(now, next) ? (next - now) : 0;
+}
 
-    if (chosen >= 0) {
-        // Execute the selected task.
-        tasks[chosen].funcPtr();
+#if defined(__AVR__)
+/** Shortest gap (us) worth sleeping through on a micros queue (> one Timer0 tick). */
+static const uint32_t IDLE_MIN_SLEEP_US = 1100;
 
-        // Advance the deadline by one period.
-        tasks[chosen].nextRun += tasks[chosen].period;
+/**
+ * @brief Sleep in idle mode unless the deadline has already been reached.
+ *
+ * The check and the sleep instruction run with interrupts disabled; sei()
+ * takes effect only after the following instruction, so SLEEP executes
+ * before any pending ISR can run and a wake-up cannot be lost.
+ */
+static void idleUntil(uint32_t deadline, const volatile uint8_t *ready) {
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    if ((ready == NULL || *ready == 0) && deadlineBefore(millis(), deadline)) {
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+    sei();
+}
+#endif
 
-        // Guard against falling far behind: if the new deadline is still
-        // in the past, re-anchor from now to avoid cascading catch-up runs.
-        if (tasks[chosen].nextRun < millis()) {
-            tasks[chosen].nextRun = millis() + tasks[chosen].period;
+void schedulerQueueIdle(const TaskQueue_t *queue) {
+#if defined(__AVR__)
+    if (queue->count == 0) {
+        // Event-only queue: sleep until any interrupt.
+        idleUntil(millis() + 1, &queue->ready);
+        return;
+    }
+
+    if (queue->useMicros) {
+        // A Timer0 overflow arrives every 1024 us; only sleep if the next
+        // release is further away than that, otherwise keep polling.
+        if (schedulerQueueTimeToNext(queue) > IDLE_MIN_SLEEP_US) {
+            idleUntil(millis() + 1, &queue->ready);
         }
+        return;
+    }
+    idleUntil(queue->tasks[queue->heap[0]].nextRun, &queue->ready);
+#else
+    (void)queue;
+#endif
+}
+
+void schedulerSleepUntil(uint32_t wakeAtMs) {
+    while (deadlineBefore(millis(), wakeAtMs)) {
+#if defined(__AVR__)
+        idleUntil(wakeAtMs, NULL);
+#endif
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Compatibility API
+// ──────────────────────────────────────────────────────────────────────────
+
+void schedulerInit(TaskContext_t *tasks, uint8_t count) {
+    schedulerQueueInit(&s_defaultQueue, tasks, count);
+}
+
+bool schedulerRun(TaskContext_t *tasks, uint8_t count) {
+    uint8_t bound = (count > TASK_SCHEDULER_MAX_TASKS) ? TASK_SCHEDULER_MAX_TASKS : count;
+
+    // Rebind if the caller switched task tables without calling schedulerInit().
+    if (s_defaultQueue.tasks != tasks || s_defaultQueue.count != bound) {
+        heapBuild(&s_defaultQueue, tasks, count);
+    }
+    return schedulerQueueRun(&s_defaultQueue);
+}
+
+uint8_t schedulerRunFor(TaskContext_t *tasks, uint8_t count, uint32_t budgetUs) {
+    uint8_t bound = (count > TASK_SCHEDULER_MAX_TASKS) ? TASK_SCHEDULER_MAX_TASKS : count;
+
+    if (s_defaultQueue.tasks != tasks || s_defaultQueue.count != bound) {
+        heapBuild(&s_defaultQueue, tasks, count);
+    }
+    return schedulerQueueRunFor(&s_defaultQueue, budgetUs);
+}
+
+void schedulerSetEvents(const EventTaskFunc_t *handlers, uint8_t count) {
+    schedulerQueueSetEvents(&s_defaultQueue, handlers, count);
+}
+
+void schedulerSignal(uint8_t eventId) {
+    schedulerQueueSignal(&s_defaultQueue, eventId);
+}
+
+void schedulerIdle(TaskContext_t *tasks, uint8_t count) {
+    if (s_defaultQueue.tasks != tasks) {
+        return;  // Not bound yet; the next schedulerRun() rebinds.
+    }
+    (void)count;
+    schedulerQueueIdle(&s_defaultQueue);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Instrumentation
+// ──────────────────────────────────────────────────────────────────────────
+
+#if TASK_SCHEDULER_STATS
+void schedulerPrintStatsHeader() {
+    FLASH_PRINTF("\r\n#  Period   Runs  Last/Avg/Max us      Jitter  Skip\r\n");
+}
+
+void schedulerPrintStatsRow(uint8_t index, uint32_t period, const TaskStats_t *st) {
+    FLASH_PRINTF("%u %6lu %6lu %5lu/%5lu/%5lu %4lu/%4lu %5lu\r\n",
+                 (unsigned)index,
+                 (unsigned long)period,
+                 (unsigned long)st->runCount,
+                 (unsigned long)st->lastExecUs,
+                 (unsigned long)st->avgExecUs,
+                 (unsigned long)st->maxExecUs,
+                 (unsigned long)st->lastJitter,
+                 (unsigned long)st->maxJitter,
+                 (unsigned long)st->skippedPeriods);
+}
+
+void schedulerDumpStats(const TaskContext_t *tasks, uint8_t count) {
+    schedulerPrintStatsHeader();
+    for (uint8_t i = 0; i < count; i++) {
+        schedulerPrintStatsRow(i, tasks[i].period, &tasks[i].stats);
+    }
+}
+
+void schedulerResetStats(TaskContext_t *tasks, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        memset(&tasks[i].stats, 0, sizeof(tasks[i].stats));
     }
 }
+#endif
@@ -9,9 +9,20 @@
  * call to schedulerRun(), executes at most one due task — the one with the
  * earliest scheduled deadline.
  *
+ * Internally the tasks are kept in a binary min-heap (TaskQueue_t) ordered
+ * by nextRun, so the next due task is found in O(1) and a task is
+ * rescheduled in O(log n) instead of scanning the whole array on every
+ * loop() pass.
+ *
  * This design satisfies the requirement of "one task active per tick" while
  * providing deterministic, offset-controlled startup sequencing.
  *
+ * When several tasks fall due together (typically after a long one),
+ * serving them one per loop() pass adds a loop() iteration, and the
+ * core's serialEvent poll, to each of them. schedulerRunFor() instead
+ * runs due tasks in deadline order until a per-call budget is spent:
+ *   schedulerRunFor(tasks, 3, 2000);   // Drain for up to 2 ms per loop()
+ *
  * Usage:
  *   TaskContext_t tasks[] = {
  *       { task1Func, 10,    0  },
@@ -20,6 +31,29 @@
  *   };
  *   schedulerInit(tasks, 3);     // Called once in setup()
  *   schedulerRun(tasks, 3);      // Called every loop() iteration
+ *
+ * Applications that drive more than one task set can own the queue
+ * explicitly:
+ *   static TaskQueue_t queue;
+ *   schedulerQueueInit(&queue, tasks, 3);
+ *   schedulerQueueRun(&queue);
+ *
+ * Aperiodic work can be registered as event tasks and readied from an ISR
+ * instead of being polled:
+ *   static void onEdge() { ... }
+ *   static void (*const events[])() = { onEdge };
+ *   schedulerSetEvents(events, 1);   // After schedulerInit()
+ *   ISR(INT4_vect) { schedulerSignal(0); }
+ *
+ * To stop loop() from busy-polling millis() between deadlines, follow
+ * each run with an idle call; the CPU then sleeps in SLEEP_MODE_IDLE
+ * until the next Timer0 tick or any other interrupt:
+ *   if (!schedulerRun(tasks, 3)) {
+ *       schedulerIdle(tasks, 3);
+ *   }
+ *
+ * A task whose work is a sequence of waits can be written as a
+ * stackless coroutine instead of a state machine (Coroutine.h).
  */
 
 #ifndef TASK_SCHEDULER_H
@@ -27,6 +61,43 @@
 
 #include <Arduino.h>
 
+/**
+ * @brief Maximum number of tasks a single deadline queue can hold.
+ *
+ * Sizes the static heap index array inside TaskQueue_t. Override with
+ * -DTASK_SCHEDULER_MAX_TASKS=<n> in build_flags if a lab needs more.
+ */
+#ifndef TASK_SCHEDULER_MAX_TASKS
+#define TASK_SCHEDULER_MAX_TASKS 8
+#endif
+
+/**
+ * @brief Enable per-task timing instrumentation (0 = off, 1 = on).
+ *
+ * When enabled, every TaskContext_t carries a TaskStats_t block that the
+ * scheduler fills on each execution with micros()-based execution times,
+ * release jitter and skipped-period counters. Costs two micros() calls
+ * and ~28 bytes of SRAM per task. Enable with -DTASK_SCHEDULER_STATS=1.
+ */
+#ifndef TASK_SCHEDULER_STATS
+#define TASK_SCHEDULER_STATS 0
+#endif
+
+#if TASK_SCHEDULER_STATS
+/**
+ * @brief Per-task timing statistics (instrumentation builds only).
+ */
+typedef struct {
+    uint32_t runCount;        /**< Number of completed executions. */
+    uint32_t lastExecUs;      /**< Execution time of the last run (us). */
+    uint32_t maxExecUs;       /**< Worst observed execution time (us). */
+    uint32_t avgExecUs;       /**< Running average execution time (us, EWMA 1/8). */
+    uint32_t lastJitter;      /**< Release delay of the last run vs. nextRun (queue time units). */
+    uint32_t maxJitter;       /**< Worst observed release delay (queue time units). */
+    uint32_t skippedPeriods;  /**< Periods dropped by the re-anchor-from-now path. */
+} TaskStats_t;
+#endif
+
 /**
  * @brief Task context structure.
  *
@@ -35,19 +106,178 @@
  *
  * Members are filled by the caller (funcPtr, period, offset); nextRun is
  * computed internally by schedulerInit().
+ *
+ * Times are in the time unit of the owning queue: milliseconds by default,
+ * microseconds for queues set up with schedulerQueueInitUs().
  */
 typedef struct {
     void     (*funcPtr)();  /**< Pointer to the task function. Must be non-blocking. */
-    uint32_t  period;       /**< Recurrence period in milliseconds. */
-    uint32_t  offset;       /**< Startup offset in milliseconds before first execution. */
-    uint32_t  nextRun;      /**< Absolute time (ms) of the next scheduled execution. Managed by scheduler. */
+    uint32_t  period;       /**< Recurrence period (ms, or us on a micros queue). */
+    uint32_t  offset;       /**< Startup offset before first execution (ms, or us). */
+    uint32_t  nextRun;      /**< Absolute time of the next scheduled execution. Managed by scheduler. */
+#if TASK_SCHEDULER_STATS
+    TaskStats_t stats;      /**< Timing statistics. Managed by scheduler. */
+#endif
 } TaskContext_t;
 
+/** @brief Maximum number of event tasks per queue (width of the ready bitmap). */
+#define TASK_SCHEDULER_MAX_EVENTS 8
+
+/** @brief Event (aperiodic) task handler. Must be non-blocking. */
+typedef void (*EventTaskFunc_t)();
+
+/**
+ * @brief Deadline queue over a task context array.
+ *
+ * heap[] stores indices into tasks[] arranged as a binary min-heap keyed
+ * by nextRun, so heap[0] is always the task with the earliest deadline.
+ *
+ * Deadlines are compared with signed differences, so the queue keeps
+ * working across the millis() (~49.7 days) and micros() (~71.6 min)
+ * rollovers as long as every period is below 2^31 time units.
+ *
+ * Optional event tasks are readied through the ready bitmap (bit n =
+ * events[n]) and are dispatched ahead of periodic tasks, lowest index
+ * first.
+ */
+typedef struct {
+    TaskContext_t         *tasks;                          /**< Task context array being scheduled. */
+    uint8_t                count;                          /**< Number of tasks in the heap. */
+    uint8_t                heap[TASK_SCHEDULER_MAX_TASKS]; /**< Heap of task indices ordered by nextRun. */
+    const EventTaskFunc_t *events;                         /**< Event task handlers, indexed by event id. */
+    uint8_t                eventCount;                     /**< Number of registered event tasks. */
+    volatile uint8_t       ready;                          /**< Ready bitmap, set by schedulerQueueSignal(). */
+    bool                   useMicros;                      /**< True: times are micros(); false: millis(). */
+} TaskQueue_t;
+
+/**
+ * @brief Initialize a deadline queue.
+ *
+ * Computes the initial nextRun time for each task as millis() + offset and
+ * builds the heap. Tasks beyond TASK_SCHEDULER_MAX_TASKS are ignored.
+ * Clears any registered event tasks.
+ *
+ * @param queue  Queue to initialize.
+ * @param tasks  Pointer to the task context array.
+ * @param count  Number of tasks in the array.
+ */
+void schedulerQueueInit(TaskQueue_t *queue, TaskContext_t *tasks, uint8_t count);
+
+/**
+ * @brief Initialize a deadline queue on a microsecond timebase.
+ *
+ * Same as schedulerQueueInit(), but period, offset and nextRun of every
+ * task are interpreted in microseconds and compared against micros()
+ * (4 us resolution at 16 MHz). Use for sub-millisecond sampling loops.
+ *
+ * @param queue  Queue to initialize.
+ * @param tasks  Pointer to the task context array (times in us).
+ * @param count  Number of tasks in the array.
+ */
+void schedulerQueueInitUs(TaskQueue_t *queue, TaskContext_t *tasks, uint8_t count);
+
+/**
+ * @brief Register the event tasks of a queue.
+ *
+ * Clears the ready bitmap. Handlers beyond TASK_SCHEDULER_MAX_EVENTS are
+ * ignored.
+ *
+ * @param queue     Initialized queue.
+ * @param handlers  Array of event handlers; event id = array index.
+ * @param count     Number of handlers.
+ */
+void schedulerQueueSetEvents(TaskQueue_t *queue, const EventTaskFunc_t *handlers, uint8_t count);
+
+/**
+ * @brief Mark an event task ready. Safe to call from an ISR or a task.
+ *
+ * Multiple signals before the task runs coalesce into a single run.
+ *
+ * @param queue    Queue owning the event task.
+ * @param eventId  Index of the handler passed to schedulerQueueSetEvents().
+ */
+void schedulerQueueSignal(TaskQueue_t *queue, uint8_t eventId);
+
+/**
+ * @brief Peek the task with the earliest deadline in O(1).
+ *
+ * @param queue  Initialized queue.
+ * @return TaskContext_t* Earliest task, or NULL if the queue is empty.
+ */
+TaskContext_t *schedulerQueuePeek(const TaskQueue_t *queue);
+
+/**
+ * @brief Run one ready event task, or else the earliest task if it is due.
+ *
+ * A pending event task always wins over periodic tasks. Otherwise
+ * millis() is read once to test the heap root. If the root is due it is
+ * executed, its nextRun advanced by period (re-anchored to now + period
+ * when it has fallen behind) and sifted back into the heap.
+ *
+ * @param queue  Initialized queue.
+ * @return true if a task was executed, false if nothing was due.
+ */
+bool schedulerQueueRun(TaskQueue_t *queue);
+
+/**
+ * @brief Run due tasks in deadline order until the budget is spent.
+ *
+ * Repeats schedulerQueueRun() (event tasks first, then the most overdue
+ * periodic task) while something is due and less than budgetUs has
+ * passed since the call began. The budget is checked before each next
+ * task, not enforced: the last task may overrun it by its own length.
+ * At least one due task runs, so a budget of 0 behaves like
+ * schedulerQueueRun().
+ *
+ * @param queue     Initialized queue.
+ * @param budgetUs  Time (micros(), on either timebase) after which no
+ *                  further task is started.
+ * @return Number of tasks executed (0 if nothing was due, at most 255).
+ */
+uint8_t schedulerQueueRunFor(TaskQueue_t *queue, uint32_t budgetUs);
+
+/**
+ * @brief Time until the earliest task becomes due, in queue time units.
+ *
+ * @param queue  Initialized queue.
+ * @return uint32_t 0 if a task is already due, UINT32_MAX if the queue is empty.
+ */
+uint32_t schedulerQueueTimeToNext(const TaskQueue_t *queue);
+
+/**
+ * @brief Sleep once if no task is due.
+ *
+ * Enters SLEEP_MODE_IDLE with interrupts atomically re-enabled, so the CPU
+ * wakes on the next Timer0 overflow (~1 ms) or any pin/UART interrupt.
+ * Returns immediately if the earliest task is already due or an event
+ * task is ready. Timers, UART
+ * and ADC keep running in idle mode, so millis() and Serial are unaffected.
+ * On a micros queue the CPU only sleeps when the next deadline is more
+ * than one Timer0 tick away, so sub-millisecond releases are not delayed.
+ * On non-AVR targets this is a no-op.
+ *
+ * @param queue  Initialized queue.
+ */
+void schedulerQueueIdle(const TaskQueue_t *queue);
+
+/**
+ * @brief Sleep in SLEEP_MODE_IDLE until millis() reaches wakeAtMs.
+ *
+ * Drop-in replacement for fixed delay() waits in cooperative loops:
+ * the CPU sleeps between Timer0 ticks instead of spinning. Passing an
+ * absolute deadline (previous deadline + period) keeps the loop cadence
+ * free of drift.
+ *
+ * @param wakeAtMs  Absolute millis() value to wake at.
+ */
+void schedulerSleepUntil(uint32_t wakeAtMs);
+
 /**
  * @brief Initialize the scheduler.
  *
  * Computes the initial nextRun time for each task as millis() + offset.
  * Must be called once from setup() before the first schedulerRun() call.
+ * Thin wrapper around schedulerQueueInit() using an internal queue.
  *
  * @param tasks  Pointer to the task context array.
  * @param count  Number of tasks in the array.
@@ -57,18 +287,95 @@ void schedulerInit(TaskContext_t *tasks, uint8_t count);
 /**
  * @brief Run one scheduler tick.
  *
- * Scans the task array for all tasks whose nextRun deadline has passed.
- * Among due tasks, it selects the one with the earliest missed deadline
- * (highest priority) and executes it once. After execution, the task's
- * nextRun is advanced by its period. If execution falls far behind,
- * the scheduler re-anchors nextRun to avoid burst catch-up.
+ * Peeks the task with the earliest deadline. If its nextRun deadline has
+ * passed it is executed once (among due tasks it is the most overdue,
+ * i.e. highest priority). After execution, the task's nextRun is advanced
+ * by its period. If execution falls far behind, the scheduler re-anchors
+ * nextRun to avoid burst catch-up.
  *
  * Exactly one task runs per call; if no task is due, the function returns
  * immediately without executing anything.
  *
  * @param tasks  Pointer to the task context array.
  * @param count  Number of tasks in the array.
+ * @return true if a task was executed, false if nothing was due.
+ */
+bool schedulerRun(TaskContext_t *tasks, uint8_t count);
+
+/**
+ * @brief Run due tasks until the budget is spent (schedulerRun() queue).
+ *
+ * Thin wrapper around schedulerQueueRunFor(). Follow a 0 return with
+ * schedulerIdle() as after schedulerRun().
+ *
+ * @param tasks     Pointer to the task context array.
+ * @param count     Number of tasks in the array.
+ * @param budgetUs  Time after which no further task is started (us).
+ * @return Number of tasks executed.
+ */
+uint8_t schedulerRunFor(TaskContext_t *tasks, uint8_t count, uint32_t budgetUs);
+
+/**
+ * @brief Register event tasks on the schedulerRun() queue.
+ *
+ * Call after schedulerInit().
+ *
+ * @param handlers  Array of event handlers; event id = array index.
+ * @param count     Number of handlers.
+ */
+void schedulerSetEvents(const EventTaskFunc_t *handlers, uint8_t count);
+
+/**
+ * @brief Mark an event task on the schedulerRun() queue ready (ISR-safe).
+ *
+ * @param eventId  Index of the handler passed to schedulerSetEvents().
+ */
+void schedulerSignal(uint8_t eventId);
+
+/**
+ * @brief Idle until the next Timer0 tick if no task is due.
+ *
+ * Thin wrapper around schedulerQueueIdle() for the schedulerRun() API.
+ *
+ * @param tasks  Pointer to the task context array.
+ * @param count  Number of tasks in the array.
+ */
+void schedulerIdle(TaskContext_t *tasks, uint8_t count);
+
+#if TASK_SCHEDULER_STATS
+/**
+ * @brief Print a compact per-task timing table to stdout.
+ *
+ * One row per task: index, period, run count, last/avg/max execution
+ * time in microseconds, last/max release jitter in queue time units and the
+ * number of skipped periods. Requires stdout to be redirected (e.g. by
+ * stdioSerialInit()).
+ *
+ * @param tasks  Pointer to the task context array.
+ * @param count  Number of tasks in the array.
+ */
+void schedulerDumpStats(const TaskContext_t *tasks, uint8_t count);
+
+/** @brief Column header of the schedulerDumpStats() table. */
+void schedulerPrintStatsHeader();
+
+/**
+ * @brief One row of the schedulerDumpStats() table, for schedulers that
+ *        keep their own TaskStats_t (CyclicExecutive::dumpStats()).
+ *
+ * @param index  Task index printed in the first column.
+ * @param period Task period (queue time units).
+ * @param stats  The task's statistics.
+ */
+void schedulerPrintStatsRow(uint8_t index, uint32_t period, const TaskStats_t *stats);
+
+/**
+ * @brief Clear the statistics of every task in the array.
+ *
+ * @param tasks  Pointer to the task context array.
+ * @param count  Number of tasks in the array.
  */
-void schedulerRun(TaskContext_t *tasks, uint8_t count);
+void schedulerResetStats(TaskContext_t *tasks, uint8_t count);
+#endif
 
 #endif // TASK_SCHEDULER_H
@@ -0,0 +1,116 @@
+/**
+ * @file TaskSignal.h
+ * @brief Wake-Up Signal to One Task over its FreeRTOS Notification
+ *
+ * Replaces a binary (or counting) semaphore that only one task ever takes.
+ * The signal is the waiting task's own notification value, so it needs no
+ * heap object (a binary semaphore is a ~80-byte queue on the AVR port) and
+ * a give is a direct write to the task's TCB instead of a queue operation:
+ *
+ *   give() / giveFromIsr()  →  notification value += 1, wake the task
+ *   take(timeout)           →  value returned and cleared (0 = timed out)
+ *
+ * take() therefore also reports how many gives it absorbed, like a
+ * counting semaphore drained in one call.
+ *
+ * The owning task binds itself once at its start. A give before that is
+ * remembered and delivered by bind(), so a producer (e.g. an ISR armed in
+ * setup()) may run first; bind() is not meant for setup() itself, as a
+ * notification cannot be sent before the scheduler runs.
+ *
+ * The task's notification value belongs to this signal: do not combine
+ * it with another notification-based protocol in the same task (e.g.
+ * dhtSensorReadRtos(), keypadInputWaitRtos()).
+ *
+ * Usage:
+ *   static TaskSignal s_wake;
+ *   s_wake.giveFromIsr();                       // ISR
+ *   s_wake.bind();                              // vTaskWorker, once
+ *   if (s_wake.take(pdMS_TO_TICKS(100))) { }    // vTaskWorker, loop
+ */
+
+#ifndef TASK_SIGNAL_H
+#define TASK_SIGNAL_H
+
+#include "RtosTick.h"
+
+/**
+ * @class TaskSignal
+ * @brief Notification-based binary/counting signal to a single task.
+ */
+class TaskSignal {
+public:
+    TaskSignal() : _task(NULL), _pending(false) {}
+
+    /**
+     * @brief Set the task that take()s; delivers a give made before.
+     * @param task Task handle (NULL = the calling task). Call from a task.
+     */
+    void bind(TaskHandle_t task = NULL) {
+        TaskHandle_t self = (task != NULL) ? task : xTaskGetCurrentTaskHandle();
+        // The handle is two bytes on AVR: an ISR between the two stores
+        // would see a half-written, non-NULL handle.
+        taskENTER_CRITICAL();
+        _task = self;
+        bool pending = _pending;
+        _pending = false;
+        taskEXIT_CRITICAL();
+        if (pending) {
+            xTaskNotifyGive(self);
+        }
+    }
+
+    /** @brief Wake the task (task context). */
+    void give() {
+        taskENTER_CRITICAL();
+        TaskHandle_t task = _task;
+        if (task == NULL) {
+            _pending = true;
+        }
+        taskEXIT_CRITICAL();
+        if (task != NULL) {
+            xTaskNotifyGive(task);
+        }
+    }
+
+    /**
+     * @brief Wake the task (interrupt context).
+     *
+     * Like the other ISR callbacks here no yield is forced: the task runs
+     * at the next tick or when the interrupted task blocks. Interrupts are
+     * already off here, so _task is read whole; bind() and give() take a
+     * critical section for the same reason.
+     */
+    void giveFromIsr() {
+        if (_task == NULL) {
+            _pending = true;
+            return;
+        }
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_task, &woken);
+        (void)woken;
+    }
+
+    /**
+     * @brief Wait for a give (bound task only).
+     * @param timeout Ticks to wait (portMAX_DELAY = forever, 0 = poll).
+     * @return Gives absorbed since the last take(); 0 on timeout.
+     */
+    uint32_t take(TickType_t timeout) {
+        return ulTaskNotifyTake(pdTRUE, timeout);
+    }
+
+    /** @brief True once bind() has been called. */
+    bool isBound() const {
+        taskENTER_CRITICAL();
+        bool bound = (_task != NULL);
+        taskEXIT_CRITICAL();
+        return bound;
+    }
+
+private:
+    TaskHandle_t volatile _task;
+    volatile bool _pending;
+};
+
+#endif // TASK_SIGNAL_H
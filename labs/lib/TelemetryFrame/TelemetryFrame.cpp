@@ -0,0 +1,171 @@
+/**
+ * @file TelemetryFrame.cpp
+ * @brief COBS-Framed Binary Telemetry Implementation
+ *
+ * The raw frame is assembled in a static buffer, COBS-encoded into a
+ * second static buffer and written to the telemetry stream in one
+ * fwrite(). Received frames are decoded into a third. Static buffers keep the ~160 bytes of
+ * scratch space off the calling task's stack.
+ */
+
+#include "TelemetryFrame.h"
+#include "StdioSerial.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Frame buffers and counters
+// ──────────────────────────────────────────────────────────────────────────
+
+/// type + seq + payload + crc16
+static const uint8_t RAW_MAX = TELEMETRY_MAX_PAYLOAD + 4;
+
+static uint8_t  s_raw[RAW_MAX];
+static uint8_t  s_frame[RAW_MAX + 2];  ///< COBS overhead byte + delimiter.
+static uint8_t  s_rx[RAW_MAX + 2];     ///< Decoded received frame.
+static uint8_t  s_seq = 0;
+static uint32_t s_dropped = 0;
+
+// ──────────────────────────────────────────────────────────────────────────
+// Encoding helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+uint8_t cobsEncode(const uint8_t *in, uint8_t len, uint8_t *out) {
+    uint8_t codeIndex = 0;  // Position of the pending length code
+    uint8_t outIndex = 1;
+    uint8_t code = 1;
+
+    for (uint8_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[codeIndex] = code;
+            codeIndex = outIndex++;
+            code = 1;
+        } else {
+            out[outIndex++] = in[i];
+            code++;
+            if (code == 0xFF) {
+                out[codeIndex] = code;
+                codeIndex = outIndex++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIndex] = code;
+    return outIndex;
+}
+
+uint8_t cobsDecode(const uint8_t *in, uint8_t len, uint8_t *out) {
+    uint8_t inIndex = 0;
+    uint8_t outIndex = 0;
+
+    while (inIndex < len) {
+        uint8_t code = in[inIndex++];
+        if (code == 0 || inIndex + code - 1 > len) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (in[inIndex] == 0) {
+                return 0;
+            }
+            out[outIndex++] = in[inIndex++];
+        }
+        // A code below 0xFF stands for a zero, except at the very end.
+        if (code != 0xFF && inIndex < len) {
+            out[outIndex++] = 0;
+        }
+    }
+    return outIndex;
+}
+
+uint16_t crc16Ccitt(uint16_t crc, const uint8_t *data, uint8_t len) {
+    for (uint8_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+int16_t telemetryPackFloat(float value, int16_t scale) {
+    if (isnan(value)) {
+        return TELEMETRY_INVALID_I16;
+    }
+    float scaled = value * scale;
+    if (scaled >= 32767.0f) return 32767;
+    if (scaled <= -32767.0f) return -32767;  // INT16_MIN is reserved for NaN
+    return (int16_t)(scaled + (scaled < 0 ? -0.5f : 0.5f));
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Assemble type, seq, payload and CRC in raw and frame it; returns the frame length. */
+static uint8_t buildFrame(uint8_t type, uint8_t seq, const void *payload, uint8_t len,
+                          uint8_t *raw, uint8_t *frame) {
+    raw[0] = type;
+    raw[1] = seq;
+    memcpy(&raw[2], payload, len);
+    uint16_t crc = crc16Ccitt(0xFFFF, raw, (uint8_t)(len + 2));
+    raw[len + 2] = (uint8_t)(crc & 0xFF);
+    raw[len + 3] = (uint8_t)(crc >> 8);
+
+    uint8_t frameLen = cobsEncode(raw, (uint8_t)(len + 4), frame);
+    frame[frameLen++] = 0x00;
+    return frameLen;
+}
+
+uint8_t telemetryEncode(uint8_t type, uint8_t seq, const void *payload, uint8_t len,
+                        uint8_t *frame) {
+    if (len > TELEMETRY_MAX_PAYLOAD) {
+        return 0;
+    }
+    uint8_t raw[RAW_MAX];
+    return buildFrame(type, seq, payload, len, raw, frame);
+}
+
+bool telemetrySend(uint8_t type, const void *payload, uint8_t len) {
+    if (len > TELEMETRY_MAX_PAYLOAD) {
+        return false;
+    }
+
+    uint8_t frameLen = buildFrame(type, s_seq++, payload, len, s_raw, s_frame);
+
+    // A partial frame is useless to the host, so drop it whole up front
+    if (stdioSerialRouteTxFree(STDIO_ROUTE_TELEMETRY) < frameLen) {
+        s_dropped++;
+        return false;
+    }
+
+    fwrite(s_frame, 1, frameLen, stdioSerialStream(STDIO_ROUTE_TELEMETRY));
+    return true;
+}
+
+int telemetryDecode(const uint8_t *frame, uint8_t len, uint8_t *type, uint8_t *seq,
+                    void *payload, uint8_t maxPayload) {
+    // Decoded bytes never outnumber encoded ones; longer frames are not ours.
+    if (len > sizeof(s_frame)) {
+        return -1;
+    }
+    uint8_t rawLen = cobsDecode(frame, len, s_rx);
+    if (rawLen < 4 || rawLen - 4 > maxPayload) {
+        return -1;
+    }
+
+    uint16_t crc = crc16Ccitt(0xFFFF, s_rx, (uint8_t)(rawLen - 2));
+    if (s_rx[rawLen - 2] != (uint8_t)(crc & 0xFF) || s_rx[rawLen - 1] != (uint8_t)(crc >> 8)) {
+        return -1;
+    }
+
+    *type = s_rx[0];
+    *seq  = s_rx[1];
+    memcpy(payload, &s_rx[2], rawLen - 4);
+    return rawLen - 4;
+}
+
+uint32_t telemetryGetDropped() {
+    return s_dropped;
+}
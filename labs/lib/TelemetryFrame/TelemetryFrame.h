@@ -0,0 +1,148 @@
+/**
+ * @file TelemetryFrame.h
+ * @brief COBS-Framed Binary Telemetry over the STDIO UART
+ *
+ * Sends fixed-layout binary records instead of human-readable text so a
+ * 9600-baud link carries many more samples per second. Each record is
+ * wrapped as:
+ *
+ *   raw     = [type:u8][seq:u8][payload:len bytes][crc16:u16 little-endian]
+ *   frame   = COBS(raw) 0x00
+ *
+ * - type identifies the payload layout (one id per lab record struct).
+ * - seq increments per frame sent, so the host can count lost frames.
+ * - crc16 is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over type, seq
+ *   and payload.
+ * - COBS removes every 0x00 from the frame body, so 0x00 is an
+ *   unambiguous delimiter and the host can resynchronise after any loss.
+ *   Stray text printed on the same port shows up as frames that fail the
+ *   CRC and is discarded by the host.
+ *
+ * Payload fields are little-endian (native AVR order). Floats are sent as
+ * scaled int16 values via telemetryPackFloat(); NaN maps to
+ * TELEMETRY_INVALID_I16.
+ *
+ * Frames go to StdioSerial's telemetry route: stdout, or a USART of its
+ * own with -DSTDIO_TELEMETRY_PORT=<n> (e.g. Serial1 at 1 Mbaud, leaving
+ * the console its 9600-baud link). A frame is written only if it fits
+ * whole in that port's TX ring; otherwise it is dropped and counted,
+ * never waited on. Call from a
+ * single task: the frame buffer and sequence counter are not shared-safe.
+ *
+ * Frames sent the other way (host to board) are read back with
+ * telemetryDecode(), one frame at a time as the 0x00 delimiters arrive.
+ *
+ * Usage:
+ *   MyRecord_t rec = { ... };
+ *   telemetrySend(MY_RECORD_TYPE, &rec, sizeof(rec));
+ *
+ *   // Receiving: frame[] holds the bytes up to (not including) a 0x00.
+ *   uint8_t type, seq;
+ *   int n = telemetryDecode(frame, frameLen, &type, &seq, &rec, sizeof(rec));
+ */
+
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <Arduino.h>
+
+/** @brief Largest payload telemetrySend() accepts, in bytes. */
+#ifndef TELEMETRY_MAX_PAYLOAD
+#define TELEMETRY_MAX_PAYLOAD 48
+#endif
+
+/** @brief Sentinel for an invalid (NaN) packed float. */
+#define TELEMETRY_INVALID_I16 INT16_MIN
+
+/**
+ * @brief COBS-encode a buffer.
+ *
+ * @param in  Input bytes (may contain 0x00).
+ * @param len Number of input bytes (at most 253).
+ * @param out Output buffer of at least len + 1 bytes. No delimiter is added.
+ * @return Number of bytes written to out.
+ */
+uint8_t cobsEncode(const uint8_t *in, uint8_t len, uint8_t *out);
+
+/**
+ * @brief COBS-decode a buffer.
+ *
+ * @param in  Encoded bytes, without the 0x00 delimiter.
+ * @param len Number of encoded bytes.
+ * @param out Output buffer of at least len bytes (may not alias in).
+ * @return Number of bytes written to out, or 0 if in is not valid COBS
+ *         (a 0x00 inside, or a length code running past the end).
+ */
+uint8_t cobsDecode(const uint8_t *in, uint8_t len, uint8_t *out);
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE over a buffer.
+ *
+ * @param crc  Running CRC (start with 0xFFFF).
+ * @param data Bytes to add.
+ * @param len  Number of bytes.
+ * @return Updated CRC.
+ */
+uint16_t crc16Ccitt(uint16_t crc, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief Convert a float to a saturated, scaled int16 for a payload.
+ *
+ * @param value Value to pack.
+ * @param scale Multiplier, e.g. 100 for hundredths.
+ * @return round(value * scale) clamped to int16, or TELEMETRY_INVALID_I16 for NaN.
+ */
+int16_t telemetryPackFloat(float value, int16_t scale);
+
+/** @brief Longest frame telemetryEncode() writes, delimiter included. */
+#define TELEMETRY_FRAME_MAX (TELEMETRY_MAX_PAYLOAD + 6)
+
+/**
+ * @brief Frame one record into a buffer instead of the UART.
+ *
+ * The bytes are exactly what telemetrySend() transmits, for a record
+ * stored elsewhere (SdLogger) and read back by the same host decoder.
+ * Uses about TELEMETRY_MAX_PAYLOAD + 4 bytes of stack; safe to call
+ * from several tasks at once.
+ *
+ * @param type    Record type id.
+ * @param seq     Sequence number to put in the frame.
+ * @param payload Record bytes.
+ * @param len     Payload length (at most TELEMETRY_MAX_PAYLOAD).
+ * @param frame   Receives the frame and its 0x00 delimiter;
+ *                TELEMETRY_FRAME_MAX bytes.
+ * @return Frame length including the delimiter, 0 if len is too large.
+ */
+uint8_t telemetryEncode(uint8_t type, uint8_t seq, const void *payload, uint8_t len,
+                        uint8_t *frame);
+
+/**
+ * @brief Frame and transmit one telemetry record.
+ *
+ * @param type    Record type id.
+ * @param payload Record bytes.
+ * @param len     Payload length (at most TELEMETRY_MAX_PAYLOAD).
+ * @return true if the frame was queued for transmission, false if it was
+ *         too large or dropped because the TX ring lacked space.
+ */
+bool telemetrySend(uint8_t type, const void *payload, uint8_t len);
+
+/**
+ * @brief Check and unpack one received frame.
+ *
+ * @param frame      Frame bytes, without the 0x00 delimiter.
+ * @param len        Number of frame bytes.
+ * @param type       Receives the record type id.
+ * @param seq        Receives the frame sequence number.
+ * @param payload    Receives the payload bytes.
+ * @param maxPayload Capacity of payload.
+ * @return Payload length, or -1 if the frame is malformed, fails the CRC
+ *         or carries more than maxPayload bytes.
+ */
+int telemetryDecode(const uint8_t *frame, uint8_t len, uint8_t *type, uint8_t *seq,
+                    void *payload, uint8_t maxPayload);
+
+/** @brief Number of frames dropped because the TX ring was full. */
+uint32_t telemetryGetDropped();
+
+#endif // TELEMETRY_FRAME_H
@@ -0,0 +1,162 @@
+/**
+ * @file ThermalObserver.cpp
+ * @brief Model-Based Thermal Observer Implementation
+ *
+ * Same hand-expanded 2×2 algebra as KalmanFusion: the covariance is
+ * symmetric (p00, p01, p11) and each reading is scalar, so an update
+ * costs one division.
+ */
+
+#include "ThermalObserver.h"
+#include <math.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Constructor / reset
+// ──────────────────────────────────────────────────────────────────────────
+
+ThermalObserver::ThermalObserver(float gain, float timeConstantS, float tempNoise,
+                                 float biasNoise, float initBiasVariance)
+    : _gain(gain),
+      _tau(timeConstantS > 0.0f ? timeConstantS : 1.0f),
+      _qT(tempNoise),
+      _qB(biasNoise),
+      _initBiasVar(initBiasVariance),
+      _gate2(0.0f) {
+    reset();
+}
+
+void ThermalObserver::reset() {
+    _t = 0.0f;
+    _b = 0.0f;
+    _input = 0.0f;
+    _p00 = 0.0f;
+    _p01 = 0.0f;
+    _p11 = 0.0f;
+    _lastInnovation = 0.0f;
+    _rejects = 0;
+    _initialized = false;
+}
+
+bool ThermalObserver::setModel(float gain, float timeConstantS) {
+    if (!(timeConstantS > 0.0f)) {
+        return false;
+    }
+    _gain = gain;
+    _tau = timeConstantS;
+    return true;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Predict — first-order plant driven by the input
+// ──────────────────────────────────────────────────────────────────────────
+
+void ThermalObserver::predict(float input, float dtS) {
+    _input = input;
+    if (!_initialized || dtS <= 0.0f) {
+        return;
+    }
+
+    float a = dtS / (_tau + dtS);
+    float na = 1.0f - a;
+
+    // x = F x + G u
+    _t += a * (_b + _gain * input - _t);
+
+    // P = F P F' + Q
+    float p00 = na * na * _p00 + 2.0f * a * na * _p01 + a * a * _p11;
+    float p01 = na * _p01 + a * _p11;
+    _p00 = p00 + _qT * dtS;
+    _p01 = p01;
+    _p11 = _p11 + _qB * dtS;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Update — scalar reading of the temperature `ageS` seconds ago
+// ──────────────────────────────────────────────────────────────────────────
+
+bool ThermalObserver::update(float value, float variance, float ageS) {
+    if (isnan(value) || isinf(value)) {
+        return false;
+    }
+
+    if (!_initialized) {
+        // Seed: the plant is assumed settled at the current input.
+        _t = value;
+        _b = value - _gain * _input;
+        _p00 = variance;
+        _p01 = 0.0f;
+        _p11 = _initBiasVar;
+        _lastInnovation = 0.0f;
+        _initialized = true;
+        return true;
+    }
+
+    // ẑ = T − age·(b + K u − T)/τ  →  H = [1 + age/τ, −age/τ]
+    float k = ageS / _tau;
+    float h0 = 1.0f + k;
+    float h1 = -k;
+    float predicted = _t - ageS * getRate();
+
+    float ph0 = _p00 * h0 + _p01 * h1;
+    float ph1 = _p01 * h0 + _p11 * h1;
+    float s   = h0 * ph0 + h1 * ph1 + variance;
+    if (s <= 0.0f) {
+        return false;
+    }
+
+    float innovation = value - predicted;
+    _lastInnovation = innovation;
+    if (_gate2 > 0.0f && innovation * innovation > _gate2 * s) {
+        if (_rejects < 0xFFFF) {
+            _rejects++;
+        }
+        return false;
+    }
+
+    float k0 = ph0 / s;
+    float k1 = ph1 / s;
+    _t += k0 * innovation;
+    _b += k1 * innovation;
+
+    // P -= K (H P) ; H P = [ph0 ph1]
+    _p00 -= k0 * ph0;
+    _p01 -= k0 * ph1;
+    _p11 -= k1 * ph1;
+    return true;
+}
+
+void ThermalObserver::setGate(float sigmas) {
+    _gate2 = (sigmas > 0.0f) ? sigmas * sigmas : 0.0f;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Accessors
+// ──────────────────────────────────────────────────────────────────────────
+
+float ThermalObserver::getEstimate() const {
+    return _initialized ? _t : NAN;
+}
+
+float ThermalObserver::getEquilibrium() const {
+    return _b;
+}
+
+float ThermalObserver::getRate() const {
+    return (_b + _gain * _input - _t) / _tau;
+}
+
+float ThermalObserver::getVariance() const {
+    return _p00;
+}
+
+float ThermalObserver::getLastInnovation() const {
+    return _lastInnovation;
+}
+
+bool ThermalObserver::isInitialized() const {
+    return _initialized;
+}
+
+uint16_t ThermalObserver::getRejectCount() const {
+    return _rejects;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file ThermalObserver.h
+ * @brief Model-Based Kalman Observer for a Slowly Sampled Thermal Plant
+ *
+ * Predicts the temperature between sensor samples from a first-order
+ * model driven by the actuator, and corrects the prediction whenever a
+ * sample arrives. A control loop can then run faster than its sensor
+ * (DHT11: one reading per 2 s) and see the effect of its own output
+ * before the next reading.
+ *
+ * State: x = [ T, b ]   T temperature, b no-actuator equilibrium
+ *                       (ambient plus heat load, a random walk)
+ *
+ *   Model:          dT/dt = (b + K·u − T) / τ
+ *
+ *   Predict (u, dt): a = dt / (τ + dt)         (backward Euler)
+ *                   T += a (b + K u − T)
+ *                   F = [1−a a; 0 1],  P = F P F' + diag(qT, qB)·dt
+ *
+ *   Update (z, R, age):
+ *                   H = [1 + age/τ, −age/τ]    z ≈ T − age·dT/dt
+ *                   S = H P H' + R,  K = P H' / S
+ *                   x += K (z − ẑ),  P −= K H P
+ *
+ * b absorbs whatever the model gets wrong in steady state (ambient
+ * drift, the true heat load, an inaccurate K), so only τ and roughly K
+ * need to be known. As in KalmanFusion, a reading that is already age
+ * seconds old is projected along the model rate, and an innovation gate
+ * rejects glitches.
+ *
+ * Usage:
+ *   ThermalObserver obs(-0.1f, 120.0f, 0.001f, 0.0005f, 4.0f);
+ *   obs.predict(fanDemand, 0.5f);              // every control cycle
+ *   if (newSample) obs.update(dhtTemp, 0.25f, ageS);
+ *   float t = obs.getEstimate();
+ */
+
+#ifndef THERMAL_OBSERVER_H
+#define THERMAL_OBSERVER_H
+
+#include <Arduino.h>
+
+/**
+ * @class ThermalObserver
+ * @brief Temperature + equilibrium Kalman observer with an actuator input.
+ *
+ * Uninitialized until the first accepted update, which seeds T from the
+ * reading and b from the steady-state relation b = T − K·u. Scalar
+ * arithmetic on a three-float covariance; no dynamic memory.
+ */
+class ThermalObserver {
+public:
+    /**
+     * @brief Construct a new ThermalObserver object.
+     *
+     * @param gain             K: steady-state change per actuator unit
+     *                         (°C per %, negative for cooling).
+     * @param timeConstantS    τ of the plant (seconds, > 0).
+     * @param tempNoise        qT: temperature process noise (°C²/s).
+     * @param biasNoise        qB: equilibrium random walk (°C²/s).
+     * @param initBiasVariance Equilibrium variance at seeding (°C²).
+     */
+    ThermalObserver(float gain, float timeConstantS, float tempNoise, float biasNoise,
+                    float initBiasVariance);
+
+    /** @brief Reset to the uninitialized state. */
+    void reset();
+
+    /** @brief Change the model (state kept). @return false if τ ≤ 0. */
+    bool setModel(float gain, float timeConstantS);
+
+    /**
+     * @brief Propagate with the actuator value applied over the interval.
+     *
+     * Ignored until initialized.
+     *
+     * @param input Actuator value u (same units as the gain's denominator).
+     * @param dtS   Time since the previous predict() (seconds).
+     */
+    void predict(float input, float dtS);
+
+    /**
+     * @brief Fuse one temperature reading.
+     *
+     * @param value    The reading.
+     * @param variance Reading variance (°C²).
+     * @param ageS     How old the reading is (seconds, default 0).
+     * @return true if used; false if rejected by the gate or not finite.
+     */
+    bool update(float value, float variance, float ageS = 0.0f);
+
+    /** @brief Innovation gate in standard deviations of S (0 = off). */
+    void setGate(float sigmas);
+
+    /** @brief Temperature estimate (NAN until initialized). */
+    float getEstimate() const;
+
+    /** @brief Equilibrium estimate b (°C). */
+    float getEquilibrium() const;
+
+    /** @brief Model rate dT/dt at the last input (°C/s). */
+    float getRate() const;
+
+    /** @brief Variance of the temperature estimate (P[0][0]). */
+    float getVariance() const;
+
+    /** @brief Innovation z − ẑ of the last update() call. */
+    float getLastInnovation() const;
+
+    /** @brief True after the first accepted update. */
+    bool isInitialized() const;
+
+    /** @brief Readings rejected by the gate since reset() (saturates). */
+    uint16_t getRejectCount() const;
+
+private:
+    float _gain;              /**< K (°C per input unit).              */
+    float _tau;               /**< τ (s).                               */
+    float _qT;                /**< Temperature process noise.          */
+    float _qB;                /**< Equilibrium random walk.            */
+    float _initBiasVar;       /**< b variance after seeding.           */
+    float _gate2;             /**< Gate² (0 = disabled).               */
+
+    float _t;                 /**< Temperature estimate.               */
+    float _b;                 /**< Equilibrium estimate.               */
+    float _input;             /**< Last predict() input.               */
+    float _p00;               /**< Covariance [T][T].                  */
+    float _p01;               /**< Covariance [T][b].                  */
+    float _p11;               /**< Covariance [b][b].                  */
+
+    float    _lastInnovation; /**< z − ẑ of the last update.           */
+    uint16_t _rejects;        /**< Gate rejections since reset.        */
+    bool     _initialized;    /**< True after the first update.        */
+};
+
+#endif // THERMAL_OBSERVER_H
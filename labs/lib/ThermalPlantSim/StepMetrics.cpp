@@ -0,0 +1,79 @@
+/**
+ * @file StepMetrics.cpp
+ * @brief Setpoint-Step Response Figures Implementation
+ */
+
+#include "StepMetrics.h"
+#include <math.h>
+
+StepMetrics::StepMetrics()
+    : _setpoint(0.0f), _band(0.0f), _direction(0), _overshoot(0.0f), _iae(0.0f),
+      _lastError(0.0f), _startMs(0), _lastMs(0), _enteredMs(0), _inside(false),
+      _active(false) {}
+
+void StepMetrics::begin(float setpoint, float initial, uint32_t nowMs, float band) {
+    _setpoint = setpoint;
+    _band = (band > 0.0f) ? band : 0.0f;
+    float error = setpoint - initial;
+    _direction = (error > _band) ? 1 : ((error < -_band) ? -1 : 0);
+    _overshoot = 0.0f;
+    _iae = 0.0f;
+    _lastError = fabsf(error);
+    _startMs = nowMs;
+    _lastMs = nowMs;
+    _inside = fabsf(error) <= _band;
+    _enteredMs = nowMs;
+    _active = true;
+}
+
+void StepMetrics::update(float value, uint32_t nowMs) {
+    if (!_active || isnan(value)) {
+        return;
+    }
+
+    _iae += _lastError * (float)(uint32_t)(nowMs - _lastMs) / 1000.0f;
+    _lastMs = nowMs;
+
+    float error = _setpoint - value;
+    _lastError = fabsf(error);
+
+    // Past the setpoint in the step's direction (either way for a hold).
+    float beyond = (_direction > 0) ? -error : ((_direction < 0) ? error : fabsf(error));
+    if (beyond > _overshoot) {
+        _overshoot = beyond;
+    }
+
+    bool inside = _lastError <= _band;
+    if (inside && !_inside) {
+        _enteredMs = nowMs;
+    }
+    _inside = inside;
+}
+
+bool StepMetrics::isSettled() const {
+    return _active && _inside;
+}
+
+uint32_t StepMetrics::getSettlingTimeMs() const {
+    return isSettled() ? (uint32_t)(_enteredMs - _startMs) : UINT32_MAX;
+}
+
+float StepMetrics::getOvershoot() const {
+    return _overshoot;
+}
+
+float StepMetrics::getIae() const {
+    return _iae;
+}
+
+uint32_t StepMetrics::getElapsedMs() const {
+    return (uint32_t)(_lastMs - _startMs);
+}
+
+float StepMetrics::getSetpoint() const {
+    return _setpoint;
+}
+
+bool StepMetrics::isActive() const {
+    return _active;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file StepMetrics.h
+ * @brief Setpoint-Step Response Figures: Settling Time, Overshoot, IAE
+ *
+ * Scores one setpoint step of a closed loop from the measurements that
+ * follow it, so two tunings can be compared by number instead of by eye
+ * on the plotter:
+ *
+ *   settling time  time from the step until the value last entered the
+ *                  ±band around the setpoint (and stayed there so far)
+ *   overshoot      furthest excursion past the setpoint, in the direction
+ *                  of the step (°C, ≥ 0)
+ *   IAE            ∫|setpoint − value| dt since the step (°C·s)
+ *
+ * Each update() adds |e|·Δt with the error of the previous update held
+ * over the interval (the value a sampled controller acted on). Times are
+ * those passed in, so the figures are equally valid in real time on the
+ * target and in simulated time natively.
+ *
+ * Usage:
+ *   StepMetrics m;
+ *   m.begin(setpoint, temperature, nowMs, 0.5f);   // on each setpoint change
+ *   m.update(temperature, nowMs);                  // on each sample
+ *   if (m.isSettled()) ... m.getSettlingTimeMs() ...
+ */
+
+#ifndef STEP_METRICS_H
+#define STEP_METRICS_H
+
+#include <Arduino.h>
+
+/**
+ * @class StepMetrics
+ * @brief Running settling time, overshoot and IAE of one setpoint step.
+ */
+class StepMetrics {
+public:
+    StepMetrics();
+
+    /**
+     * @brief Start scoring a step.
+     *
+     * @param setpoint New setpoint.
+     * @param initial  Value at the step (sets the step direction).
+     * @param nowMs    Time of the step.
+     * @param band     Settling band half-width (> 0).
+     */
+    void begin(float setpoint, float initial, uint32_t nowMs, float band);
+
+    /** @brief Add one measurement taken at @p nowMs (ignored before begin()). */
+    void update(float value, uint32_t nowMs);
+
+    /** @brief True while the latest value is inside the band. */
+    bool isSettled() const;
+
+    /**
+     * @brief Time from the step to the last entry into the band.
+     * @return UINT32_MAX while the value is outside the band.
+     */
+    uint32_t getSettlingTimeMs() const;
+
+    /** @brief Largest excursion past the setpoint in the step's direction (≥ 0). */
+    float getOvershoot() const;
+
+    /** @brief Integral of the absolute error since begin() (units·s). */
+    float getIae() const;
+
+    /** @brief Time since the step at the latest update (ms). */
+    uint32_t getElapsedMs() const;
+
+    float getSetpoint() const;
+
+    /** @brief True after begin(). */
+    bool isActive() const;
+
+private:
+    float    _setpoint;
+    float    _band;
+    int8_t   _direction;        ///< +1 rising step, −1 falling, 0 none
+    float    _overshoot;
+    float    _iae;
+    float    _lastError;        ///< |e| of the previous update
+    uint32_t _startMs;
+    uint32_t _lastMs;
+    uint32_t _enteredMs;        ///< Last entry into the band
+    bool     _inside;
+    bool     _active;
+};
+
+#endif // STEP_METRICS_H
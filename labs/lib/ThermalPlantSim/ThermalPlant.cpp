@@ -0,0 +1,117 @@
+/**
+ * @file ThermalPlant.cpp
+ * @brief FOPDT Room Model Implementation
+ *
+ * The delay line holds the equilibrium computed from the inputs at each
+ * step; the step that is _delaySteps old drives the first-order lag. A
+ * step costs one multiply-add; exp() runs once, in the constructor.
+ */
+
+#include "ThermalPlant.h"
+#include <math.h>
+
+ThermalPlant::ThermalPlant(const ThermalPlantConfig &config, uint32_t seed)
+    : _config(config), _seed(seed != 0 ? seed : 1) {
+    if (!(_config.timeConstantS > 0.0f)) {
+        _config.timeConstantS = 1.0f;
+    }
+    float maxDelay = maxDeadTimeS();
+    if (!(_config.deadTimeS > 0.0f)) {
+        _config.deadTimeS = 0.0f;
+    } else if (_config.deadTimeS > maxDelay) {
+        _config.deadTimeS = maxDelay;
+    }
+    _alpha = 1.0f - expf(-(STEP_MS / 1000.0f) / _config.timeConstantS);
+    _delaySteps = (uint8_t)(_config.deadTimeS * 1000.0f / STEP_MS + 0.5f);
+    init(_config.ambientC);
+}
+
+void ThermalPlant::init(float initialC) {
+    _temperature = initialC;
+    _heater = 0.0f;
+    _fan = 0.0f;
+    _elapsedMs = 0;
+    _pendingMs = 0;
+    _rng = _seed;
+    _head = 0;
+    float equilibrium = getEquilibriumC();
+    for (uint8_t i = 0; i < DELAY_SLOTS; i++) {
+        _history[i] = equilibrium;
+    }
+}
+
+static float clampPercent(float percent) {
+    if (!(percent > 0.0f)) {
+        return 0.0f;
+    }
+    return (percent > 100.0f) ? 100.0f : percent;
+}
+
+void ThermalPlant::setHeater(float percent) {
+    _heater = clampPercent(percent);
+}
+
+void ThermalPlant::setFan(float percent) {
+    _fan = clampPercent(percent);
+}
+
+void ThermalPlant::step() {
+    _head = (uint8_t)((_head + 1) % DELAY_SLOTS);
+    _history[_head] = getEquilibriumC();
+    uint8_t delayed = (uint8_t)((_head + DELAY_SLOTS - _delaySteps) % DELAY_SLOTS);
+    _temperature += _alpha * (_history[delayed] - _temperature);
+}
+
+void ThermalPlant::advance(uint32_t ms) {
+    _elapsedMs += ms;
+    uint32_t total = (uint32_t)_pendingMs + ms;
+    while (total >= STEP_MS) {
+        step();
+        total -= STEP_MS;
+    }
+    _pendingMs = (uint16_t)total;
+}
+
+float ThermalPlant::noise() {
+    // xorshift32, mapped to [-1, 1)
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return (float)(int32_t)_rng / 2147483648.0f;
+}
+
+float ThermalPlant::read() {
+    float value = _temperature;
+    if (_config.sensorNoiseC > 0.0f) {
+        value += _config.sensorNoiseC * noise();
+    }
+    if (_config.sensorStepC > 0.0f) {
+        value = floorf(value / _config.sensorStepC + 0.5f) * _config.sensorStepC;
+    }
+    return value;
+}
+
+float ThermalPlant::getTemperatureC() const {
+    return _temperature;
+}
+
+float ThermalPlant::getEquilibriumC() const {
+    return _config.ambientC + _config.heaterRiseC * _heater / 100.0f -
+           _config.fanDropC * _fan / 100.0f;
+}
+
+float ThermalPlant::getHeater() const {
+    return _heater;
+}
+
+float ThermalPlant::getFan() const {
+    return _fan;
+}
+
+uint32_t ThermalPlant::getElapsedMs() const {
+    return _elapsedMs;
+}
+
+float ThermalPlant::maxDeadTimeS() {
+    return (float)(DELAY_SLOTS - 1) * STEP_MS / 1000.0f;
+}
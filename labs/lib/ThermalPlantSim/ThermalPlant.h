@@ -0,0 +1,121 @@
+/**
+ * @file ThermalPlant.h
+ * @brief First-Order-Plus-Dead-Time Room Model for Control Tuning
+ *
+ * Stands in for the room, the heater/fan and the DHT sensor of labs 5.1
+ * and 5.2, so a controller can be exercised without waiting for a real
+ * room to heat and cool:
+ *
+ *   Equilibrium:   Teq(t) = ambient + heaterRise·h(t) − fanDrop·f(t)
+ *   Dynamics:      τ dT/dt = Teq(t − θ) − T
+ *   Sensor:        reading = quantize(T + noise, sensorStep)
+ *
+ * h and f are the heater and fan inputs in %, θ the transport delay from
+ * actuator to sensor. The model is integrated in exact steps of STEP_MS
+ * (T relaxes by 1 − e^(−step/τ) towards the delayed equilibrium), so the
+ * result does not depend on how advance() is called: one call of an hour
+ * or 14 400 calls of 250 ms give the same trajectory. Noise is a
+ * deterministic xorshift sequence from the seed, so a run is repeatable.
+ *
+ * Time is whatever the caller says it is: on target the labs advance it
+ * by the millis() elapsed (real time); the native tests advance it by
+ * simulated time and run an hour of room in milliseconds.
+ *
+ * Usage:
+ *   static const ThermalPlantConfig ROOM = { 24.0f, 15.0f, 0.0f, 120.0f, 10.0f, 1.0f, 0.2f };
+ *   ThermalPlant plant(ROOM);
+ *   plant.init(22.0f);
+ *   plant.setHeater(relayOn ? 100.0f : 0.0f);
+ *   plant.advance(2000);
+ *   float reading = plant.read();
+ */
+
+#ifndef THERMAL_PLANT_H
+#define THERMAL_PLANT_H
+
+#include <Arduino.h>
+
+/**
+ * @struct ThermalPlantConfig
+ * @brief Plant and sensor parameters (all steady-state figures in °C).
+ */
+struct ThermalPlantConfig {
+    float ambientC;        ///< Equilibrium with heater and fan off
+    float heaterRiseC;     ///< Equilibrium rise at 100 % heater
+    float fanDropC;        ///< Equilibrium drop at 100 % fan
+    float timeConstantS;   ///< τ (s, > 0)
+    float deadTimeS;       ///< θ (s, 0..maxDeadTimeS())
+    float sensorStepC;     ///< Reading resolution (DHT11 1.0, DHT22 0.1; 0 = exact)
+    float sensorNoiseC;    ///< Peak of the uniform noise added before quantizing
+};
+
+/**
+ * @class ThermalPlant
+ * @brief FOPDT thermal model with heater and fan inputs and a DHT-like sensor.
+ *
+ * Fixed-size delay line (DELAY_SLOTS equilibrium values, one per step);
+ * no dynamic memory.
+ */
+class ThermalPlant {
+public:
+    /** @brief Integration step; also the resolution of the dead time. */
+    static const uint16_t STEP_MS = 500;
+
+    /** @brief Delay line length: θ up to DELAY_SLOTS · STEP_MS. */
+    static const uint8_t DELAY_SLOTS = 64;
+
+    /**
+     * @param config Plant parameters (copied; τ ≤ 0 becomes 1 s, θ is clamped).
+     * @param seed   Noise sequence seed (non-zero).
+     */
+    explicit ThermalPlant(const ThermalPlantConfig &config, uint32_t seed = 1);
+
+    /** @brief Start at @p initialC with inputs off and the history at their equilibrium. */
+    void init(float initialC);
+
+    /** @brief Heater input, clamped to 0..100 %. */
+    void setHeater(float percent);
+
+    /** @brief Fan input, clamped to 0..100 %. */
+    void setFan(float percent);
+
+    /** @brief Let @p ms of plant time pass. */
+    void advance(uint32_t ms);
+
+    /** @brief One sensor reading: true temperature plus noise, quantized. */
+    float read();
+
+    /** @brief True (noise-free) temperature. */
+    float getTemperatureC() const;
+
+    /** @brief Equilibrium of the present inputs (reached after θ + a few τ). */
+    float getEquilibriumC() const;
+
+    float getHeater() const;
+    float getFan() const;
+
+    /** @brief Plant time since init() (ms). */
+    uint32_t getElapsedMs() const;
+
+    /** @brief Longest dead time the delay line holds (s). */
+    static float maxDeadTimeS();
+
+private:
+    void step();
+    float noise();
+
+    ThermalPlantConfig _config;
+    float    _alpha;                  ///< 1 − e^(−STEP_MS/τ)
+    uint8_t  _delaySteps;             ///< θ in steps
+    float    _history[DELAY_SLOTS];   ///< Equilibrium of past steps (ring)
+    uint8_t  _head;                   ///< Slot of the newest entry
+    float    _temperature;
+    float    _heater;
+    float    _fan;
+    uint32_t _elapsedMs;
+    uint16_t _pendingMs;              ///< Time not yet integrated (< STEP_MS)
+    uint32_t _seed;
+    uint32_t _rng;
+};
+
+#endif // THERMAL_PLANT_H
@@ -8,8 +8,9 @@
  *   NORMAL ──> DEBOUNCE_HIGH ──> ALERT_ACTIVE ──> DEBOUNCE_LOW ──> NORMAL
  *
  * Each transition requires a configurable number of consecutive readings
- * confirming the new condition, preventing transient spikes from causing
- * false state changes.
+ * confirming the new condition (or, with a dwell time, a condition that
+ * lasted that long), preventing transient spikes from causing false state
+ * changes.
  */
 
 #include "ThresholdAlert.h"
@@ -33,17 +34,37 @@ ThresholdAlert::ThresholdAlert(float highThreshold, float lowThreshold,
                                uint8_t debounceCount)
     : _highThreshold(highThreshold),
       _lowThreshold(lowThreshold),
+      _highCounts(0),
+      _lowCounts(0),
+      _countsFall(false),
       _debounceMax(debounceCount),
       _debounceCounter(0),
-      _state(ALERT_NORMAL) {}
+      _state(ALERT_NORMAL),
+      _raiseDwellMs(0),
+      _clearDwellMs(0),
+      _pendingSinceMs(0),
+      _rateLimit(0.0f),
+      _rateArm(0.0f),
+      _rateWindowMs(0),
+      _rate(0.0f),
+      _anchorValue(0.0f),
+      _anchorMs(0),
+      _hasAnchor(false),
+      _rateTriggered(false) {
+#if defined(FSM_TRACE_ENABLED)
+    _traceId = FSM_TRACE_ID_NONE;
+#endif
+}
 
 // ──────────────────────────────────────────────────────────────────────────
 // Initialization
 // ──────────────────────────────────────────────────────────────────────────
 
 void ThresholdAlert::init() {
-    _state = ALERT_NORMAL;
-    _debounceCounter = 0;
+    resetState();
+    _rate = 0.0f;
+    _hasAnchor = false;
+    _rateTriggered = false;
 }
 
 // ──────────────────────────────────────────────────────────────────────────
@@ -51,22 +72,52 @@ void ThresholdAlert::init() {
 // ──────────────────────────────────────────────────────────────────────────
 
 AlertState ThresholdAlert::update(float value) {
+    return update(value, millis());
+}
+
+AlertState ThresholdAlert::update(float value, uint32_t timestampMs) {
+    updateRate(value, timestampMs);
+    bool rateTrip = (_rateLimit > 0.0f) && (value > _rateArm) && (_rate >= _rateLimit);
+    return step(value > _highThreshold, value < _lowThreshold, rateTrip, timestampMs);
+}
+
+AlertState ThresholdAlert::updateCounts(int32_t counts, uint32_t timestampMs) {
+    // Two integer compares; the order of the limits gives the direction.
+    bool aboveHigh = _countsFall ? counts < _highCounts : counts > _highCounts;
+    bool belowLow  = _countsFall ? counts > _lowCounts : counts < _lowCounts;
+    return step(aboveHigh, belowLow, false, timestampMs);
+}
+
+AlertState ThresholdAlert::step(bool aboveHigh, bool belowLow, bool rateTrip,
+                                uint32_t timestampMs) {
+    bool above = aboveHigh || rateTrip;
+    bool below = belowLow && !rateTrip;
+
+    AlertState previous = _state;
+
     switch (_state) {
 
     // ── NORMAL: waiting for value to exceed high threshold ────────────
     case ALERT_NORMAL:
-        if (value > _highThreshold) {
-            // Value crossed the upper threshold — begin debounce.
+        if (above) {
+            // Value crossed the upper threshold (or rises too fast) — begin debounce.
             _state = ALERT_DEBOUNCE_HIGH;
             _debounceCounter = 1;
+            _pendingSinceMs = timestampMs;
+            _rateTriggered = !aboveHigh;
         }
         break;
 
     // ── DEBOUNCE_HIGH: counting consecutive above-threshold readings ─
     case ALERT_DEBOUNCE_HIGH:
-        if (value > _highThreshold) {
-            _debounceCounter++;
-            if (_debounceCounter >= _debounceMax) {
+        if (above) {
+            if (_debounceCounter < 0xFF) {
+                _debounceCounter++;
+            }
+            bool confirmed = (_raiseDwellMs > 0)
+                ? (uint32_t)(timestampMs - _pendingSinceMs) >= _raiseDwellMs
+                : _debounceCounter >= _debounceMax;
+            if (confirmed) {
                 // Confirmed: alert is stable. Transition to ACTIVE.
                 _state = ALERT_ACTIVE;
                 _debounceCounter = 0;
@@ -80,18 +131,24 @@ AlertState ThresholdAlert::update(float value) {
 
     // ── ALERT_ACTIVE: waiting for value to drop below low threshold ──
     case ALERT_ACTIVE:
-        if (value < _lowThreshold) {
+        if (below) {
             // Value crossed the lower threshold — begin debounce down.
             _state = ALERT_DEBOUNCE_LOW;
             _debounceCounter = 1;
+            _pendingSinceMs = timestampMs;
         }
         break;
 
     // ── DEBOUNCE_LOW: counting consecutive below-threshold readings ──
     case ALERT_DEBOUNCE_LOW:
-        if (value < _lowThreshold) {
-            _debounceCounter++;
-            if (_debounceCounter >= _debounceMax) {
+        if (below) {
+            if (_debounceCounter < 0xFF) {
+                _debounceCounter++;
+            }
+            bool confirmed = (_clearDwellMs > 0)
+                ? (uint32_t)(timestampMs - _pendingSinceMs) >= _clearDwellMs
+                : _debounceCounter >= _debounceMax;
+            if (confirmed) {
                 // Confirmed: value is stable below threshold. Clear alert.
                 _state = ALERT_NORMAL;
                 _debounceCounter = 0;
@@ -104,9 +161,36 @@ AlertState ThresholdAlert::update(float value) {
         break;
     }
 
+    if (_state != previous) {
+        FSM_TRACE(_traceId, previous, _state, rateTrip ? ALERT_TRACE_RATE : ALERT_TRACE_LEVEL);
+    }
     return _state;
 }
 
+/**
+ * Slope over the span since the window's first reading, refreshed once
+ * that span reaches _rateWindowMs: short spans would turn sensor noise
+ * into large slopes.
+ */
+void ThresholdAlert::updateRate(float value, uint32_t timestampMs) {
+    if (_rateLimit <= 0.0f) {
+        return;
+    }
+    if (!_hasAnchor) {
+        _anchorValue = value;
+        _anchorMs = timestampMs;
+        _hasAnchor = true;
+        return;
+    }
+    uint32_t spanMs = timestampMs - _anchorMs;
+    if (spanMs == 0 || spanMs < _rateWindowMs) {
+        return;
+    }
+    _rate = (value - _anchorValue) * 1000.0f / (float)spanMs;
+    _anchorValue = value;
+    _anchorMs = timestampMs;
+}
+
 // ──────────────────────────────────────────────────────────────────────────
 // State queries
 // ──────────────────────────────────────────────────────────────────────────
@@ -139,8 +223,14 @@ void ThresholdAlert::setThresholds(float highThreshold, float lowThreshold) {
     _highThreshold = highThreshold;
     _lowThreshold  = lowThreshold;
     // Reset FSM to avoid inconsistent state with new thresholds.
-    _state = ALERT_NORMAL;
-    _debounceCounter = 0;
+    resetState();
+}
+
+void ThresholdAlert::setCountThresholds(int32_t highCounts, int32_t lowCounts) {
+    _highCounts = highCounts;
+    _lowCounts  = lowCounts;
+    _countsFall = highCounts < lowCounts;
+    resetState();
 }
 
 void ThresholdAlert::setDebounceCount(uint8_t count) {
@@ -148,6 +238,27 @@ void ThresholdAlert::setDebounceCount(uint8_t count) {
     _debounceCounter = 0;
 }
 
+void ThresholdAlert::setDwellTime(uint32_t raiseMs, uint32_t clearMs) {
+    _raiseDwellMs = raiseMs;
+    _clearDwellMs = clearMs;
+}
+
+void ThresholdAlert::setRateTrigger(float risePerS, float armLevel, uint32_t windowMs) {
+    _rateLimit = (risePerS > 0.0f) ? risePerS : 0.0f;
+    _rateArm = armLevel;
+    _rateWindowMs = windowMs;
+    _rate = 0.0f;
+    _hasAnchor = false;
+}
+
+float ThresholdAlert::getRate() const {
+    return _rate;
+}
+
+bool ThresholdAlert::wasRateTriggered() const {
+    return _rateTriggered;
+}
+
 float ThresholdAlert::getHighThreshold() const {
     return _highThreshold;
 }
@@ -155,3 +266,27 @@ float ThresholdAlert::getHighThreshold() const {
 float ThresholdAlert::getLowThreshold() const {
     return _lowThreshold;
 }
+
+int32_t ThresholdAlert::getHighCounts() const {
+    return _highCounts;
+}
+
+int32_t ThresholdAlert::getLowCounts() const {
+    return _lowCounts;
+}
+
+void ThresholdAlert::setTraceId(uint8_t id) {
+#if defined(FSM_TRACE_ENABLED)
+    _traceId = id;
+#else
+    (void)id;
+#endif
+}
+
+void ThresholdAlert::resetState() {
+    if (_state != ALERT_NORMAL) {
+        FSM_TRACE(_traceId, _state, ALERT_NORMAL, ALERT_TRACE_RESET);
+    }
+    _state = ALERT_NORMAL;
+    _debounceCounter = 0;
+}
@@ -23,18 +23,46 @@
  *
  * Debounce: the state transition only completes after N consecutive
  * readings confirm the condition, preventing transient spikes from
- * triggering false alerts.
+ * triggering false alerts. With setDwellTime() the condition must hold
+ * for a time instead (from the timestamp of the first confirming reading
+ * to a later one), so the confirmation delay no longer scales with the
+ * caller's sample period.
+ *
+ * Rate trigger (setRateTrigger()): the slope is measured over windows of
+ * at least windowMs; once the value is above an arming level and rises
+ * faster than the limit, the FSM leaves NORMAL as if the high threshold
+ * had been crossed (it is debounced the same way), and an alert does not
+ * begin to clear while the rise continues.
+ *
+ * ADC domain (setCountThresholds(), updateCounts()): for a sensor with a
+ * monotonic transfer function the thresholds can be mapped to raw counts
+ * once (AnalogTempSensor::rawAtTemperatureC()), and each reading is then
+ * judged with integer compares, with no conversion on the alert path. A
+ * falling transfer function (NTC on the ground side of its divider) maps
+ * high above low the other way round, highCounts < lowCounts; the
+ * comparisons follow that order. The rate trigger needs values and is
+ * not applied to counts.
+ *
+ * With -DFSM_TRACE_ENABLED, setTraceId() records every state change in
+ * FsmTrace (event = AlertTraceEvent).
  *
  * Usage:
  *   ThresholdAlert alert(30.0, 28.0, 5);  // high=30, low=28, 5 confirmations
  *   alert.init();
- *   AlertState state = alert.update(currentTemp);
+ *   alert.setDwellTime(10000, 10000);     // optional: 10 s instead of 5 samples
+ *   alert.setRateTrigger(0.05f, 26.0f, 10000);  // optional: > 0.05 °C/s above 26
+ *   AlertState state = alert.update(currentTemp, millis());
+ *
+ *   // ADC domain: the same limits as NTC counts, mapped once
+ *   alert.setCountThresholds(ntc.rawAtTemperatureC(30.0f), ntc.rawAtTemperatureC(28.0f));
+ *   state = alert.updateCounts(conditionedCounts, millis());
  */
 
 #ifndef THRESHOLD_ALERT_H
 #define THRESHOLD_ALERT_H
 
 #include <Arduino.h>
+#include "FsmTrace.h"
 
 /**
  * @enum AlertState
@@ -47,6 +75,16 @@ enum AlertState {
     ALERT_DEBOUNCE_LOW    /**< Value crossed low threshold — debouncing downward. */
 };
 
+/**
+ * @enum AlertTraceEvent
+ * @brief Event byte of the alert FSMs' FsmTrace records.
+ */
+enum AlertTraceEvent {
+    ALERT_TRACE_LEVEL,    /**< Reading against the thresholds.          */
+    ALERT_TRACE_RATE,     /**< Rate-of-rise trigger.                    */
+    ALERT_TRACE_RESET     /**< init(), new thresholds, invalid reading. */
+};
+
 /**
  * @class ThresholdAlert
  * @brief Hysteresis-based threshold detector with debounce filtering.
@@ -84,6 +122,30 @@ public:
      */
     AlertState update(float value);
 
+    /**
+     * @brief Update the FSM with a timestamped reading.
+     *
+     * Required for dwell-time debouncing and the rate trigger; update(value)
+     * stamps the reading with millis().
+     *
+     * @param value       The current sensor reading.
+     * @param timestampMs Time of the reading (ms, wraps).
+     * @return AlertState The current state of the alert FSM.
+     */
+    AlertState update(float value, uint32_t timestampMs);
+
+    /**
+     * @brief Update the FSM with a raw count (see setCountThresholds()).
+     *
+     * Debounce and dwell times apply as for update(); the rate trigger
+     * does not.
+     *
+     * @param counts      The current reading in counts (e.g. a conditioned ADC value).
+     * @param timestampMs Time of the reading (ms, wraps).
+     * @return AlertState The current state of the alert FSM.
+     */
+    AlertState updateCounts(int32_t counts, uint32_t timestampMs);
+
     /**
      * @brief Get the current alert state without updating.
      * @return AlertState Current FSM state.
@@ -124,6 +186,18 @@ public:
      */
     void setThresholds(float highThreshold, float lowThreshold);
 
+    /**
+     * @brief Thresholds of updateCounts(), in the sensor's raw counts.
+     *
+     * Resets the FSM to NORMAL state. highCounts < lowCounts for a
+     * sensor whose counts fall as the value rises (the alert then raises
+     * below highCounts and clears above lowCounts).
+     *
+     * @param highCounts The high threshold, mapped to counts.
+     * @param lowCounts  The low threshold, mapped to counts.
+     */
+    void setCountThresholds(int32_t highCounts, int32_t lowCounts);
+
     /**
      * @brief Reconfigure the debounce count at runtime.
      *
@@ -133,6 +207,34 @@ public:
      */
     void setDebounceCount(uint8_t count);
 
+    /**
+     * @brief Debounce by time instead of sample count.
+     *
+     * A transition completes once its condition has held from the first
+     * confirming reading to one at least this much later. 0 restores
+     * the sample count for that direction.
+     *
+     * @param raiseMs Dwell before an alert is raised (ms).
+     * @param clearMs Dwell before an alert is cleared (ms).
+     */
+    void setDwellTime(uint32_t raiseMs, uint32_t clearMs);
+
+    /**
+     * @brief Trigger on the rate of rise as well as on the level.
+     *
+     * @param risePerS Slope that triggers (units/s); 0 disables.
+     * @param armLevel The value must also exceed this level (keeps
+     *                 normal warm-ups far below the threshold quiet).
+     * @param windowMs Shortest span the slope is measured over.
+     */
+    void setRateTrigger(float risePerS, float armLevel, uint32_t windowMs);
+
+    /** @brief Last measured slope (units/s; 0 until one window has passed). */
+    float getRate() const;
+
+    /** @brief True if the last raised alert was started by the rate trigger. */
+    bool wasRateTriggered() const;
+
     /**
      * @brief Get the configured high threshold.
      * @return float High threshold value.
@@ -145,12 +247,52 @@ public:
      */
     float getLowThreshold() const;
 
+    /** @brief High threshold of updateCounts(). */
+    int32_t getHighCounts() const;
+
+    /** @brief Low threshold of updateCounts(). */
+    int32_t getLowCounts() const;
+
+    /** @brief Record state changes in FsmTrace under id (-DFSM_TRACE_ENABLED). */
+    void setTraceId(uint8_t id);
+
 private:
     float      _highThreshold;   /**< Upper threshold for alert trigger.   */
     float      _lowThreshold;    /**< Lower threshold for alert clear.     */
+    int32_t    _highCounts;      /**< High threshold in counts.            */
+    int32_t    _lowCounts;       /**< Low threshold in counts.             */
+    bool       _countsFall;      /**< Counts fall as the value rises.      */
     uint8_t    _debounceMax;     /**< Number of confirmations required.     */
     uint8_t    _debounceCounter; /**< Current consecutive confirmation count. */
     AlertState _state;           /**< Current FSM state.                    */
+    uint32_t   _raiseDwellMs;    /**< Time debounce up (0 = sample count).  */
+    uint32_t   _clearDwellMs;    /**< Time debounce down (0 = sample count). */
+    uint32_t   _pendingSinceMs;  /**< First confirming reading of a debounce. */
+    float      _rateLimit;       /**< Rate trigger slope (0 = disabled).    */
+    float      _rateArm;         /**< Level the rate trigger needs.         */
+    uint32_t   _rateWindowMs;    /**< Shortest slope measurement span.      */
+    float      _rate;            /**< Last measured slope.                  */
+    float      _anchorValue;     /**< Start of the current slope window.    */
+    uint32_t   _anchorMs;
+    bool       _hasAnchor;
+    bool       _rateTriggered;   /**< Last raise (or pending one) by rate.  */
+#if defined(FSM_TRACE_ENABLED)
+    uint8_t    _traceId;         /**< FsmTrace id (0 = not traced).        */
+#endif
+
+    void updateRate(float value, uint32_t timestampMs);
+
+    /**
+     * @brief Advance the FSM by one judged reading.
+     *
+     * @param aboveHigh Past the high threshold (the level alone).
+     * @param belowLow  Past the low threshold.
+     * @param rateTrip  The rate trigger fired.
+     */
+    AlertState step(bool aboveHigh, bool belowLow, bool rateTrip, uint32_t timestampMs);
+
+    /** @brief Return to NORMAL, tracing the reset. */
+    void resetState();
 };
 
 #endif // THRESHOLD_ALERT_H
@@ -0,0 +1,369 @@
+/**
+ * @file ThresholdAlertBank.h
+ * @brief Multi-channel Threshold Alerts in Structure-of-Arrays Form
+ *
+ * Runs the ThresholdAlert FSM (NORMAL → DEBOUNCE_HIGH → ACTIVE →
+ * DEBOUNCE_LOW → NORMAL, same thresholds and debounce semantics) for C
+ * channels with one call. State is stored per field rather than per
+ * channel object:
+ *
+ *   _high[C], _low[C], _debounceMax[C], _counter[C], _state[C]
+ *
+ * updateAll() walks the arrays once and returns bit masks instead of
+ * states, so callers no longer keep the previous state of every channel
+ * to find edges:
+ *
+ *   active      channels in ALERT_ACTIVE
+ *   debouncing  channels in DEBOUNCE_HIGH or DEBOUNCE_LOW
+ *   raised      channels that entered ALERT_ACTIVE on this call
+ *   cleared     channels that returned to NORMAL through DEBOUNCE_LOW
+ *
+ * A channel flagged invalid (or given NaN) is reset to NORMAL, like
+ * ThresholdAlert::init(); a reset is not reported as cleared. A channel
+ * set with configureHold() keeps its state through invalid readings
+ * instead (a sensor that drops a sample does not clear its alert).
+ *
+ * Dwell-time debouncing and the rate-of-rise trigger of ThresholdAlert
+ * are available per channel (configureDwell(), configureRate()) and use
+ * the timestamp given to updateAllAt(); updateAll() stamps with millis().
+ *
+ * A channel set with configureCounts() is judged on raw counts instead
+ * (the counts argument of updateAllAt(), integer compares as in
+ * ThresholdAlert::updateCounts()); its float value only marks validity
+ * (NaN) and is not compared, and the rate trigger does not apply to it.
+ *
+ * With -DFSM_TRACE_ENABLED and setTraceId(base), channel c's state
+ * changes are recorded in FsmTrace as FSM id base + c.
+ *
+ * Usage:
+ *   ThresholdAlertBank<3> alerts(30.0f, 28.0f, 5);
+ *   float values[3] = { analog, digital, fused };
+ *   AlertBankMasks m = alerts.updateAll(values, validMask);
+ *   if (m.raised & (1U << 0)) { analogAlertCount++; }
+ *   AlertState s = alerts.getState(0);
+ *
+ *   // Channel 0 on NTC counts (falling with temperature), mapped once
+ *   alerts.configureCounts(0, ntc.rawAtTemperatureC(30.0f), ntc.rawAtTemperatureC(28.0f));
+ *   m = alerts.updateAllAt(values, sampleMs, validMask, counts);
+ */
+
+#ifndef THRESHOLD_ALERT_BANK_H
+#define THRESHOLD_ALERT_BANK_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "ThresholdAlert.h"
+
+/** @brief One bit per channel (bit c = channel c). */
+typedef uint16_t AlertMask;
+
+/** @brief Result of ThresholdAlertBank::updateAll(). */
+struct AlertBankMasks {
+    AlertMask active;       /**< In ALERT_ACTIVE.                       */
+    AlertMask debouncing;   /**< In DEBOUNCE_HIGH or DEBOUNCE_LOW.      */
+    AlertMask raised;       /**< Entered ALERT_ACTIVE on this call.     */
+    AlertMask cleared;      /**< Debounced back to NORMAL on this call. */
+};
+
+/**
+ * @class ThresholdAlertBank
+ * @brief C-channel hysteresis + debounce threshold detector.
+ *
+ * @tparam C Number of channels (1..16).
+ */
+template <uint8_t C>
+class ThresholdAlertBank {
+    static_assert(C >= 1 && C <= 16, "bank supports 1..16 channels");
+
+public:
+    /** @brief Mask with every channel bit set. */
+    static const AlertMask ALL_CHANNELS = (AlertMask)((1UL << C) - 1);
+
+    /**
+     * @brief Construct a bank with the same thresholds on every channel.
+     *
+     * @param highThreshold Value above which an alert begins to trigger.
+     * @param lowThreshold  Value below which an alert begins to clear.
+     * @param debounceCount Consecutive confirmations per transition.
+     */
+    ThresholdAlertBank(float highThreshold, float lowThreshold,
+                       uint8_t debounceCount = 5) {
+        for (uint8_t c = 0; c < C; c++) {
+            _high[c] = highThreshold;
+            _low[c] = lowThreshold;
+            _debounceMax[c] = debounceCount;
+            _raiseDwellMs[c] = 0;
+            _clearDwellMs[c] = 0;
+            _sinceMs[c] = 0;
+            _rateLimit[c] = 0.0f;
+            _rateArm[c] = 0.0f;
+            _rateWindowMs[c] = 0;
+            _anchor[c] = 0.0f;
+            _anchorMs[c] = 0;
+            _highCounts[c] = 0;
+            _lowCounts[c] = 0;
+        }
+        _countMode = 0;
+        _countsFall = 0;
+#if defined(FSM_TRACE_ENABLED)
+        _traceBase = FSM_TRACE_ID_NONE;
+#endif
+        _hold = 0;
+        resetAll();
+    }
+
+    /** @brief Override one channel's thresholds and debounce (resets it). */
+    void configure(uint8_t channel, float highThreshold, float lowThreshold,
+                   uint8_t debounceCount) {
+        _high[channel] = highThreshold;
+        _low[channel] = lowThreshold;
+        _debounceMax[channel] = debounceCount;
+        _countMode &= (AlertMask)~(1U << channel);
+        resetChannel(channel);
+    }
+
+    /**
+     * @brief Judge a channel on raw counts (see ThresholdAlert::setCountThresholds()).
+     *
+     * Keeps the state and debounce (the next reading is judged against
+     * the new limits), so the limits can follow a recalibration.
+     * highCounts < lowCounts for counts that fall as the value rises.
+     */
+    void configureCounts(uint8_t channel, int32_t highCounts, int32_t lowCounts) {
+        AlertMask bit = (AlertMask)(1U << channel);
+        _highCounts[channel] = highCounts;
+        _lowCounts[channel] = lowCounts;
+        _countMode |= bit;
+        _countsFall = (highCounts < lowCounts) ? (AlertMask)(_countsFall | bit)
+                                               : (AlertMask)(_countsFall & ~bit);
+    }
+
+    /** @brief Debounce a channel by time (ms; 0 = sample count), see ThresholdAlert. */
+    void configureDwell(uint8_t channel, uint32_t raiseMs, uint32_t clearMs) {
+        _raiseDwellMs[channel] = raiseMs;
+        _clearDwellMs[channel] = clearMs;
+    }
+
+    /** @brief Rate-of-rise trigger of a channel (0 disables), see ThresholdAlert. */
+    void configureRate(uint8_t channel, float risePerS, float armLevel, uint32_t windowMs) {
+        _rateLimit[channel] = (risePerS > 0.0f) ? risePerS : 0.0f;
+        _rateArm[channel] = armLevel;
+        _rateWindowMs[channel] = windowMs;
+        _rate[channel] = 0.0f;
+        _hasAnchor &= (AlertMask)~(1U << channel);
+    }
+
+    /** @brief Keep (true) or reset (false, default) a channel's state on invalid readings. */
+    void configureHold(uint8_t channel, bool hold) {
+        AlertMask bit = (AlertMask)(1U << channel);
+        _hold = hold ? (AlertMask)(_hold | bit) : (AlertMask)(_hold & ~bit);
+    }
+
+    /** @brief updateAllAt() stamped with millis(). */
+    AlertBankMasks updateAll(const float *values, AlertMask valid = ALL_CHANNELS) {
+        return updateAllAt(values, millis(), valid);
+    }
+
+    /**
+     * @brief Advance every channel's FSM by one timestamped reading.
+     *
+     * @param values      C readings.
+     * @param timestampMs Time of the readings (ms, wraps).
+     * @param valid       Channels whose reading is usable; the others (and
+     *                    NaN readings) are reset to NORMAL, or left as
+     *                    they are if configureHold() was set.
+     * @param counts      C raw counts for the configureCounts() channels,
+     *                    or NULL to judge every channel on its value.
+     * @return Masks of the state after this call and of its edges.
+     */
+    AlertBankMasks updateAllAt(const float *values, uint32_t timestampMs,
+                               AlertMask valid = ALL_CHANNELS,
+                               const int32_t *counts = NULL) {
+        AlertMask byCounts = (counts != NULL) ? _countMode : (AlertMask)0;
+        AlertBankMasks masks = { 0, 0, 0, 0 };
+        for (uint8_t c = 0; c < C; c++) {
+            AlertMask bit = (AlertMask)(1U << c);
+            float v = values[c];
+            uint8_t s = _state[c];
+            uint8_t event = ALERT_TRACE_RESET;
+            if ((!(valid & bit) || isnan(v)) && (_hold & bit)) {
+                // Held: no reading, no step (the slope window restarts).
+                _hasAnchor &= (AlertMask)~bit;
+            } else if (!(valid & bit) || isnan(v)) {
+                s = ALERT_NORMAL;
+                _counter[c] = 0;
+                _rate[c] = 0.0f;
+                _hasAnchor &= (AlertMask)~bit;
+            } else {
+                bool rateTrip = false;
+                if (_rateLimit[c] > 0.0f && !(byCounts & bit)) {
+                    updateRate(c, v, timestampMs);
+                    rateTrip = (v > _rateArm[c]) && (_rate[c] >= _rateLimit[c]);
+                }
+                // Rising states test the high threshold, falling ones the low.
+                bool rising = (s == ALERT_NORMAL || s == ALERT_DEBOUNCE_HIGH);
+                bool beyond;
+                if (byCounts & bit) {
+                    int32_t n = counts[c];
+                    bool fall = (_countsFall & bit) != 0;
+                    beyond = rising ? (fall ? n < _highCounts[c] : n > _highCounts[c])
+                                    : (fall ? n > _lowCounts[c] : n < _lowCounts[c]);
+                } else {
+                    beyond = rising ? (v > _high[c] || rateTrip)
+                                    : (v < _low[c] && !rateTrip);
+                }
+                event = rateTrip ? ALERT_TRACE_RATE : ALERT_TRACE_LEVEL;
+                if (!beyond) {
+                    // Quiet, or a debounce interrupted: back to the stable state.
+                    s = rising ? ALERT_NORMAL : ALERT_ACTIVE;
+                    _counter[c] = 0;
+                } else if (s == ALERT_NORMAL || s == ALERT_ACTIVE) {
+                    // First reading past the threshold starts the debounce.
+                    s = (s == ALERT_NORMAL) ? ALERT_DEBOUNCE_HIGH : ALERT_DEBOUNCE_LOW;
+                    _counter[c] = 1;
+                    _sinceMs[c] = timestampMs;
+                } else {
+                    if (_counter[c] < 0xFF) {
+                        _counter[c]++;
+                    }
+                    uint32_t dwell = (s == ALERT_DEBOUNCE_HIGH) ? _raiseDwellMs[c]
+                                                                : _clearDwellMs[c];
+                    bool confirmed = (dwell > 0)
+                        ? (uint32_t)(timestampMs - _sinceMs[c]) >= dwell
+                        : _counter[c] >= _debounceMax[c];
+                    if (confirmed) {
+                        if (s == ALERT_DEBOUNCE_HIGH) {
+                            s = ALERT_ACTIVE;
+                            masks.raised |= bit;
+                        } else {
+                            s = ALERT_NORMAL;
+                            masks.cleared |= bit;
+                        }
+                        _counter[c] = 0;
+                    }
+                }
+            }
+#if defined(FSM_TRACE_ENABLED)
+            if (s != _state[c] && _traceBase != FSM_TRACE_ID_NONE) {
+                FSM_TRACE(_traceBase + c, _state[c], s, event);
+            }
+#else
+            (void)event;
+#endif
+            _state[c] = s;
+            if (s == ALERT_ACTIVE) {
+                masks.active |= bit;
+            } else if (s != ALERT_NORMAL) {
+                masks.debouncing |= bit;
+            }
+        }
+        return masks;
+    }
+
+    /** @brief FSM state of a channel. */
+    AlertState getState(uint8_t channel) const { return (AlertState)_state[channel]; }
+
+    /** @brief Consecutive confirmations of a channel's pending transition. */
+    uint8_t getDebounceCounter(uint8_t channel) const { return _counter[channel]; }
+
+    float getHighThreshold(uint8_t channel) const { return _high[channel]; }
+    float getLowThreshold(uint8_t channel) const { return _low[channel]; }
+    int32_t getHighCounts(uint8_t channel) const { return _highCounts[channel]; }
+    int32_t getLowCounts(uint8_t channel) const { return _lowCounts[channel]; }
+
+    /** @brief Channels judged on counts (configureCounts()). */
+    AlertMask countMask() const { return _countMode; }
+
+    /** @brief Last measured slope of a channel (units/s). */
+    float getRate(uint8_t channel) const { return _rate[channel]; }
+
+    /** @brief Channels in ALERT_ACTIVE. */
+    AlertMask activeMask() const { return stateMask(ALERT_ACTIVE, ALERT_ACTIVE); }
+
+    /** @brief Channels in DEBOUNCE_HIGH or DEBOUNCE_LOW. */
+    AlertMask debouncingMask() const {
+        return stateMask(ALERT_DEBOUNCE_HIGH, ALERT_DEBOUNCE_LOW);
+    }
+
+    /** @brief Number of channels (the template parameter). */
+    static constexpr uint8_t channels() { return C; }
+
+    /** @brief Trace channel c under FSM id base + c (no-op without -DFSM_TRACE_ENABLED). */
+    void setTraceId(uint8_t base) {
+#if defined(FSM_TRACE_ENABLED)
+        _traceBase = base;
+#else
+        (void)base;
+#endif
+    }
+
+    /** @brief Return one channel to NORMAL. */
+    void resetChannel(uint8_t channel) {
+        _state[channel] = ALERT_NORMAL;
+        _counter[channel] = 0;
+    }
+
+    /** @brief Return every channel to NORMAL. */
+    void resetAll() {
+        for (uint8_t c = 0; c < C; c++) {
+            resetChannel(c);
+            _rate[c] = 0.0f;
+        }
+        _hasAnchor = 0;
+    }
+
+private:
+    float   _high[C];         /**< Alert trigger threshold.          */
+    float   _low[C];          /**< Alert clear threshold.            */
+    uint8_t _debounceMax[C];  /**< Confirmations per transition.     */
+    uint8_t _counter[C];      /**< Current confirmation count.       */
+    uint8_t _state[C];        /**< AlertState, stored as a byte.     */
+    uint32_t _raiseDwellMs[C];  /**< Time debounce up (0 = count).   */
+    uint32_t _clearDwellMs[C];  /**< Time debounce down (0 = count). */
+    uint32_t _sinceMs[C];       /**< First reading of a debounce.     */
+    float    _rateLimit[C];     /**< Rate trigger slope (0 = off).    */
+    float    _rateArm[C];       /**< Level the rate trigger needs.    */
+    uint32_t _rateWindowMs[C];  /**< Shortest slope span.             */
+    float    _rate[C];          /**< Last measured slope.             */
+    float    _anchor[C];        /**< Slope window start value.        */
+    uint32_t _anchorMs[C];      /**< Slope window start time.         */
+    AlertMask _hasAnchor;       /**< Channels with a window started.  */
+    AlertMask _hold;            /**< Channels kept on invalid input.  */
+    int32_t  _highCounts[C];    /**< High threshold in counts.        */
+    int32_t  _lowCounts[C];     /**< Low threshold in counts.         */
+    AlertMask _countMode;       /**< Channels judged on counts.       */
+    AlertMask _countsFall;      /**< Counts fall as the value rises.  */
+#if defined(FSM_TRACE_ENABLED)
+    uint8_t   _traceBase;       /**< FsmTrace id of channel 0.        */
+#endif
+
+    /** @brief Same windowed slope as ThresholdAlert::updateRate(). */
+    void updateRate(uint8_t c, float v, uint32_t timestampMs) {
+        AlertMask bit = (AlertMask)(1U << c);
+        if (!(_hasAnchor & bit)) {
+            _anchor[c] = v;
+            _anchorMs[c] = timestampMs;
+            _hasAnchor |= bit;
+            return;
+        }
+        uint32_t spanMs = timestampMs - _anchorMs[c];
+        if (spanMs == 0 || spanMs < _rateWindowMs[c]) {
+            return;
+        }
+        _rate[c] = (v - _anchor[c]) * 1000.0f / (float)spanMs;
+        _anchor[c] = v;
+        _anchorMs[c] = timestampMs;
+    }
+
+    AlertMask stateMask(uint8_t a, uint8_t b) const {
+        AlertMask mask = 0;
+        for (uint8_t c = 0; c < C; c++) {
+            if (_state[c] == a || _state[c] == b) {
+                mask |= (AlertMask)(1U << c);
+            }
+        }
+        return mask;
+    }
+};
+
+#endif // THRESHOLD_ALERT_BANK_H
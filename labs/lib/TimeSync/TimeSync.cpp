@@ -0,0 +1,174 @@
+/**
+ * @file TimeSync.cpp
+ * @brief Cross-Node Time Synchronization Implementation
+ *
+ * Time differences are taken modulo 2^32 and read as int32, so the
+ * estimate keeps working across the micros() wrap on either board.
+ */
+
+#include "TimeSync.h"
+#include "ModbusRtu.h"
+
+#include <math.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// Frame helpers
+// ──────────────────────────────────────────────────────────────────────────
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Master
+// ──────────────────────────────────────────────────────────────────────────
+
+void timeSyncMasterInit(TimeSyncMaster *m) {
+    m->sequence = 0;
+    m->sentUs = 0;
+    m->sentValid = false;
+    m->broadcasts = 0;
+}
+
+uint8_t timeSyncMasterBuild(TimeSyncMaster *m, uint8_t *adu) {
+    uint32_t previousUs = m->sentUs;
+    bool previousValid = m->sentValid;
+    m->sequence++;
+    m->sentValid = false;
+
+    adu[0] = 0;                                  // Broadcast
+    adu[1] = MODBUS_FC_WRITE_MULTIPLE;
+    put16(&adu[2], TIME_SYNC_REGISTER);
+    put16(&adu[4], TIME_SYNC_REGS);
+    adu[6] = 2 * TIME_SYNC_REGS;
+    put16(&adu[7], m->sequence);
+    put16(&adu[9], (uint16_t)(previousUs >> 16));
+    put16(&adu[11], (uint16_t)previousUs);
+    put16(&adu[13], previousValid ? 1 : 0);
+    uint16_t crc = modbusCrc16(adu, TIME_SYNC_FRAME_LEN - 2);
+    adu[15] = (uint8_t)crc;                      // CRC low byte first
+    adu[16] = (uint8_t)(crc >> 8);
+    return TIME_SYNC_FRAME_LEN;
+}
+
+void timeSyncMasterSent(TimeSyncMaster *m, uint32_t endUs) {
+    m->sentUs = endUs;
+    m->sentValid = true;
+    m->broadcasts++;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Node
+// ──────────────────────────────────────────────────────────────────────────
+
+void timeSyncSlaveInit(TimeSyncSlave *s) {
+    s->refLocalUs = 0;
+    s->refMasterUs = 0;
+    s->drift = 0.0f;
+    s->lastRxUs = 0;
+    s->lastSequence = 0;
+    s->haveRx = false;
+    s->state = TIME_SYNC_NONE;
+    s->lastResidualUs = 0;
+    s->pairs = 0;
+    s->steps = 0;
+}
+
+bool timeSyncSlaveFrame(TimeSyncSlave *s, const uint8_t *adu, uint8_t len, uint32_t rxUs) {
+    if (len != TIME_SYNC_FRAME_LEN || adu[0] != 0 || adu[1] != MODBUS_FC_WRITE_MULTIPLE ||
+        get16(&adu[2]) != TIME_SYNC_REGISTER || get16(&adu[4]) != TIME_SYNC_REGS ||
+        adu[6] != 2 * TIME_SYNC_REGS) {
+        return false;
+    }
+    uint16_t crc = modbusCrc16(adu, TIME_SYNC_FRAME_LEN - 2);
+    if (adu[15] != (uint8_t)crc || adu[16] != (uint8_t)(crc >> 8)) {
+        return true;    // A corrupt sync: nothing to answer, nothing to learn
+    }
+
+    uint16_t sequence = get16(&adu[7]);
+    uint32_t previousUs = ((uint32_t)get16(&adu[9]) << 16) | get16(&adu[11]);
+    bool previousValid = (get16(&adu[13]) & 1) != 0;
+
+    // The follow-up belongs to the broadcast received just before this one
+    if (previousValid && s->haveRx && (uint16_t)(sequence - 1) == s->lastSequence) {
+        timeSyncSlavePair(s, previousUs, s->lastRxUs);
+    }
+    s->lastRxUs = rxUs;
+    s->lastSequence = sequence;
+    s->haveRx = true;
+    return true;
+}
+
+/** @brief Restart the estimate from one pair (the drift is measured again). */
+static void restart(TimeSyncSlave *s, uint32_t masterUs, uint32_t localUs) {
+    s->refLocalUs = localUs;
+    s->refMasterUs = masterUs;
+    s->drift = 0.0f;
+    s->state = TIME_SYNC_OFFSET;
+}
+
+bool timeSyncSlavePair(TimeSyncSlave *s, uint32_t masterUs, uint32_t localUs) {
+    s->pairs++;
+    if (s->state == TIME_SYNC_NONE) {
+        restart(s, masterUs, localUs);
+        s->lastResidualUs = 0;
+        return true;
+    }
+
+    int32_t localDelta = (int32_t)(localUs - s->refLocalUs);
+    int32_t masterDelta = (int32_t)(masterUs - s->refMasterUs);
+    if (localDelta <= 0 || localDelta > TIME_SYNC_MAX_INTERVAL_US) {
+        // Out of order, or too far apart to measure the drift on
+        s->refLocalUs = localUs;
+        s->refMasterUs = masterUs;
+        return true;
+    }
+
+    uint32_t predicted;
+    timeSyncToMaster(s, localUs, &predicted);
+    int32_t residual = (int32_t)(masterUs - predicted);
+    s->lastResidualUs = residual;
+
+    // Before the first drift estimate the oscillators may part by
+    // TIME_SYNC_MAX_DRIFT_PPM over the interval
+    int32_t limit = TIME_SYNC_STEP_US;
+    if (s->state == TIME_SYNC_OFFSET) {
+        limit += localDelta / (1000000L / TIME_SYNC_MAX_DRIFT_PPM);
+    }
+    if (residual > limit || residual < -limit) {
+        s->steps++;
+        restart(s, masterUs, localUs);
+        return false;
+    }
+
+    float measured = (float)(masterDelta - localDelta) / (float)localDelta;
+    if (s->state == TIME_SYNC_OFFSET) {
+        s->drift = measured;
+        s->state = TIME_SYNC_LOCKED;
+    } else {
+        s->drift += (measured - s->drift) * TIME_SYNC_DRIFT_GAIN;
+    }
+    s->refLocalUs = localUs;
+    s->refMasterUs = masterUs;
+    return true;
+}
+
+bool timeSyncToMaster(const TimeSyncSlave *s, uint32_t localUs, uint32_t *masterUs) {
+    if (s->state == TIME_SYNC_NONE) {
+        *masterUs = localUs;
+        return false;
+    }
+    int32_t elapsed = (int32_t)(localUs - s->refLocalUs);
+    int32_t correction = (int32_t)lroundf((float)elapsed * s->drift);
+    *masterUs = s->refMasterUs + (uint32_t)elapsed + (uint32_t)correction;
+    return true;
+}
+
+float timeSyncDriftPpm(const TimeSyncSlave *s) {
+    return s->drift * 1e6f;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file TimeSync.h
+ * @brief Cross-Node Time Synchronization over the Modbus RTU Bus
+ *
+ * Each node stamps its samples with its own clock, and the clocks of two
+ * boards part by their oscillator tolerance: with the Mega's resonator,
+ * up to a few ms per second. A gateway that merges samples from several
+ * nodes then cannot tell which came first. TimeSync gives every node the
+ * master's micros() as a shared timebase:
+ *
+ *   master  ── sync k ──►  all nodes (broadcast, no reply)
+ *           TXC of sync k: master time Mk
+ *                          each node: RX of its last byte, local time Lk
+ *           ── sync k+1 (carries Mk) ──►  node pairs (Mk, Lk)
+ *
+ * The master cannot know when a frame leaves before it has left, so each
+ * broadcast carries the end time of the previous one (a two-step, or
+ * follow-up, scheme as in PTP). The master's transmit-complete and the
+ * nodes' receive-complete interrupts fire within a bit time of each other
+ * on the shared line, so a pair is exact to a few µs, plus a constant
+ * bias of about half a bit common to every node.
+ *
+ * From the pairs each node estimates
+ *
+ *   offset  the master time at its last pair (re-referenced every pair)
+ *   drift   (master rate / local rate) − 1, from successive pairs,
+ *           smoothed by TIME_SYNC_DRIFT_GAIN
+ *
+ * and converts any local micros() — a sample's timestamp — with
+ * timeSyncToMaster(). Between syncs the error grows only with the drift
+ * estimate's error. A pair that disagrees with the estimate by more than
+ * TIME_SYNC_STEP_US (a master reset, a missed follow-up after a long
+ * outage) restarts the estimate from that pair and counts a step.
+ *
+ * Wire format: a Modbus 0x10 write to address 0 of TIME_SYNC_REGS
+ * holding registers at TIME_SYNC_REGISTER (outside every node's register
+ * map, so a node without TimeSync ignores it with a silent exception):
+ *
+ *   reg  field
+ *   0    sequence       of this broadcast (wraps)
+ *   1-2  previousEndUs  master micros() at the end of broadcast
+ *                       sequence − 1, high word first
+ *   3    flags          bit 0: previousEndUs is valid
+ *
+ * All times are micros() values, compared modulo 2^32 (valid for
+ * intervals up to 35 min). Portable C++ (native tests); the links are
+ * ModbusMaster.h (modbusMasterBroadcastDone()) and ModbusSlave.h
+ * (modbusSlaveFrameUs()).
+ *
+ * Usage:
+ *   // Master, every TIME_SYNC_PERIOD when the link can queue:
+ *   uint8_t n = timeSyncMasterBuild(&sync, adu);
+ *   modbusMasterQueue(adu, n);
+ *   uint32_t endUs;
+ *   if (modbusMasterBroadcastDone(&endUs)) timeSyncMasterSent(&sync, endUs);
+ *
+ *   // Node, for each frame received, before modbusRtuHandle():
+ *   if (timeSyncSlaveFrame(&sync, modbusSlaveBuffer(), len, modbusSlaveFrameUs())) {
+ *       modbusSlaveRelease();              // Consumed, never answered
+ *   }
+ *   uint32_t sharedUs;
+ *   if (timeSyncToMaster(&sync, sample.timeUs, &sharedUs)) { ... }
+ */
+
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <stdint.h>
+
+/** @brief First holding register of the sync broadcast. */
+static const uint16_t TIME_SYNC_REGISTER = 0xFF00;
+
+/** @brief Registers of the sync broadcast. */
+static const uint8_t TIME_SYNC_REGS = 4;
+
+/** @brief Length of the sync broadcast frame (0x10 header, data, CRC). */
+static const uint8_t TIME_SYNC_FRAME_LEN = 9 + 2 * TIME_SYNC_REGS;
+
+/** @brief A pair further than this from the estimate restarts it (µs). */
+#ifndef TIME_SYNC_STEP_US
+#define TIME_SYNC_STEP_US 2000L
+#endif
+
+/** @brief Largest drift accepted before the first estimate (ppm). */
+#ifndef TIME_SYNC_MAX_DRIFT_PPM
+#define TIME_SYNC_MAX_DRIFT_PPM 10000L
+#endif
+
+/** @brief Pairs further apart than this only re-reference the offset (µs). */
+#ifndef TIME_SYNC_MAX_INTERVAL_US
+#define TIME_SYNC_MAX_INTERVAL_US 60000000L
+#endif
+
+/** @brief Weight of each new drift measurement (EWMA gain). */
+#ifndef TIME_SYNC_DRIFT_GAIN
+#define TIME_SYNC_DRIFT_GAIN 0.25f
+#endif
+
+/** @brief What a node knows of the master's clock. */
+enum TimeSyncState {
+    TIME_SYNC_NONE,     ///< No pair yet: local time only.
+    TIME_SYNC_OFFSET,   ///< Offset known, drift not yet (one pair).
+    TIME_SYNC_LOCKED    ///< Offset and drift estimated.
+};
+
+// ──────────────────────────────────────────────────────────────────────────
+// Master
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @struct TimeSyncMaster
+ * @brief Sequence and follow-up time of the gateway's broadcasts.
+ */
+struct TimeSyncMaster {
+    uint16_t sequence;     ///< Of the last broadcast built.
+    uint32_t sentUs;       ///< End of broadcast sequence (when sentValid).
+    bool     sentValid;    ///< The last broadcast built has gone out.
+    uint16_t broadcasts;   ///< Broadcasts sent (wraps).
+};
+
+/** @brief Start the sequence; the first broadcast carries no follow-up. */
+void timeSyncMasterInit(TimeSyncMaster *m);
+
+/**
+ * @brief Build the next sync broadcast.
+ *
+ * @param adu Receives TIME_SYNC_FRAME_LEN bytes; queue them on the link
+ *            (the following build assumes this one was sent).
+ * @return TIME_SYNC_FRAME_LEN.
+ */
+uint8_t timeSyncMasterBuild(TimeSyncMaster *m, uint8_t *adu);
+
+/** @brief Record the end of the last broadcast built: micros() of its TXC. */
+void timeSyncMasterSent(TimeSyncMaster *m, uint32_t endUs);
+
+// ──────────────────────────────────────────────────────────────────────────
+// Node
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @struct TimeSyncSlave
+ * @brief Offset / drift estimate of the master's clock on one node.
+ */
+struct TimeSyncSlave {
+    uint32_t refLocalUs;       ///< Local time of the last pair.
+    uint32_t refMasterUs;      ///< Master time of the last pair.
+    float    drift;            ///< (master rate / local rate) − 1.
+    uint32_t lastRxUs;         ///< Local end of the last broadcast received.
+    uint16_t lastSequence;     ///< Its sequence.
+    bool     haveRx;           ///< lastRxUs / lastSequence are set.
+    uint8_t  state;            ///< TimeSyncState.
+    int32_t  lastResidualUs;   ///< Last pair minus the estimate before it.
+    uint16_t pairs;            ///< Pairs accepted (wraps).
+    uint16_t steps;            ///< Estimate restarts (wraps).
+};
+
+/** @brief Forget the estimate (state TIME_SYNC_NONE). */
+void timeSyncSlaveInit(TimeSyncSlave *s);
+
+/**
+ * @brief Take a received frame if it is a sync broadcast.
+ *
+ * @param adu  The frame (address, function, …, CRC).
+ * @param len  Its length.
+ * @param rxUs micros() of its last byte.
+ * @return true if it was a sync broadcast (do not hand it to
+ *         modbusRtuHandle(); it is never answered), false otherwise.
+ */
+bool timeSyncSlaveFrame(TimeSyncSlave *s, const uint8_t *adu, uint8_t len, uint32_t rxUs);
+
+/**
+ * @brief Add one (master, local) pair of the same instant to the estimate.
+ *
+ * Called by timeSyncSlaveFrame() for each follow-up; public for other
+ * sources of pairs (and the tests).
+ *
+ * @return false if the pair restarted the estimate (a step).
+ */
+bool timeSyncSlavePair(TimeSyncSlave *s, uint32_t masterUs, uint32_t localUs);
+
+/**
+ * @brief Local micros() in the master's timebase.
+ *
+ * @param masterUs Receives the master time (the local time while unsynced).
+ * @return true once at least one pair is in (state != TIME_SYNC_NONE).
+ */
+bool timeSyncToMaster(const TimeSyncSlave *s, uint32_t localUs, uint32_t *masterUs);
+
+/** @brief Drift estimate in ppm (positive: the master's clock runs faster). */
+float timeSyncDriftPpm(const TimeSyncSlave *s);
+
+#endif // TIME_SYNC_H
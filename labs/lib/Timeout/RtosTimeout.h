@@ -0,0 +1,102 @@
+/**
+ * @file RtosTimeout.h
+ * @brief One-Shot Timeout Callbacks on FreeRTOS Software Timers
+ *
+ * The FreeRTOS counterpart of Timeout.h: start(ms) arms a one-shot
+ * xTimer and the kernel's timer task calls the callback when it expires.
+ * A task that lit an LED for a while no longer has to wake up again to
+ * turn it off, nor shorten its own blocking timeout to the nearest LED
+ * deadline; it blocks only on the events it actually waits for.
+ *
+ * The callback runs in the timer (daemon) task, at configTIMER_TASK_PRIORITY
+ * and on its small stack: keep it short, never block in it, and treat
+ * what it touches as shared with the task that armed it (an LED pin
+ * written by both is fine, a counter is not).
+ *
+ * start() and stop() send a command to the timer task's queue without
+ * waiting; they return false if that queue is full (the previous state
+ * stays in force). The resolution is one tick (16 ms on the WDT port);
+ * a timeout fires no earlier than ms after start().
+ *
+ * Timer storage comes from StaticRtos; create with init() in setup(),
+ * before the scheduler starts. Header-only, so bare-metal labs that use
+ * Timeout.h do not pull in FreeRTOS.
+ *
+ * Usage:
+ *   static void greenOff(void *) { digitalWrite(PIN_LED_GREEN, LOW); }
+ *   static RtosTimeout s_greenOff(greenOff);
+ *
+ *   s_greenOff.init("GreenOff");                    // setup()
+ *   digitalWrite(PIN_LED_GREEN, HIGH);              // task
+ *   s_greenOff.start(LED_INDICATOR_DURATION_MS);    // re-arms if running
+ */
+
+#ifndef RTOS_TIMEOUT_H
+#define RTOS_TIMEOUT_H
+
+#include "RtosTick.h"
+#include <timers.h>
+
+#include "StaticRtos.h"
+#include "Timeout.h"
+
+/**
+ * @class RtosTimeout
+ * @brief One-shot FreeRTOS software timer with a context-pointer callback.
+ */
+class RtosTimeout {
+public:
+    RtosTimeout(TimeoutCallback callback, void *context = NULL)
+        : _callback(callback), _context(context), _timer(NULL) {}
+
+    /**
+     * @brief Create the (dormant) timer.
+     * @param name Timer name, for kernel-aware debuggers.
+     * @return false if the timer could not be created (heap fallback only).
+     */
+    bool init(const char *name) {
+        _timer = _storage.create(name, 1, pdFALSE, this, dispatch);
+        return _timer != NULL;
+    }
+
+    /** @brief Arm to fire ms from now; re-arms a pending timeout. */
+    bool start(uint32_t ms) {
+        if (_timer == NULL) {
+            return false;
+        }
+        // Round up, plus the partial tick already running.
+        TickType_t ticks = (TickType_t)((ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS) + 1;
+        return xTimerChangePeriod(_timer, ticks, 0) == pdPASS;
+    }
+
+    /** @brief Disarm; the callback will not run. */
+    bool stop() {
+        if (_timer == NULL) {
+            return false;
+        }
+        return xTimerStop(_timer, 0) == pdPASS;
+    }
+
+    /** @brief True while armed (commands already queued are not seen). */
+    bool pending() const {
+        return _timer != NULL && xTimerIsTimerActive(_timer) != pdFALSE;
+    }
+
+private:
+    RtosTimeout(const RtosTimeout &);
+    RtosTimeout &operator=(const RtosTimeout &);
+
+    static void dispatch(TimerHandle_t timer) {
+        RtosTimeout *self = (RtosTimeout *)pvTimerGetTimerID(timer);
+        if (self->_callback != NULL) {
+            self->_callback(self->_context);
+        }
+    }
+
+    TimeoutCallback _callback;
+    void           *_context;
+    TimerHandle_t   _timer;
+    StaticTimer     _storage;
+};
+
+#endif // RTOS_TIMEOUT_H
@@ -0,0 +1,71 @@
+/**
+ * @file Timeout.cpp
+ * @brief One-Shot Timeout Callbacks Implementation
+ *
+ * The list is singly linked and kept sorted on insertion, which walks at
+ * most the handful of timeouts a lab arms; poll() only looks at the head.
+ */
+
+#include "Timeout.h"
+
+Timeout *Timeout::s_head = NULL;
+
+/** True if deadline a is before b (wrap-safe). */
+static inline bool before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+Timeout::Timeout(TimeoutCallback callback, void *context)
+    : _callback(callback)
+    , _context(context)
+    , _deadline(0)
+    , _next(NULL)
+    , _pending(false)
+{
+}
+
+void Timeout::start(uint32_t ms) {
+    unlink();
+    _deadline = millis() + ms;
+    _pending = true;
+
+    // Insert after every timeout due at or before this one.
+    Timeout **link = &s_head;
+    while (*link != NULL && !before(_deadline, (*link)->_deadline)) {
+        link = &(*link)->_next;
+    }
+    _next = *link;
+    *link = this;
+}
+
+void Timeout::stop() {
+    unlink();
+}
+
+void Timeout::unlink() {
+    if (!_pending) {
+        return;
+    }
+    for (Timeout **link = &s_head; *link != NULL; link = &(*link)->_next) {
+        if (*link == this) {
+            *link = _next;
+            break;
+        }
+    }
+    _next = NULL;
+    _pending = false;
+}
+
+void Timeout::poll() {
+    while (s_head != NULL && !before(millis(), s_head->_deadline)) {
+        // Unlink first: the callback may start this timeout again.
+        Timeout *due = s_head;
+        s_head = due->_next;
+        due->_next = NULL;
+        due->_pending = false;
+        if (due->_callback != NULL) {
+            due->_callback(due->_context);
+        }
+    }
+}
+
@@ -0,0 +1,80 @@
+/**
+ * @file Timeout.h
+ * @brief One-Shot Timeout Callbacks for Bare-Metal (loop() / TaskScheduler) Builds
+ *
+ * Replaces the "offAt = now + D; ... if (offAt != 0 && now >= offAt)"
+ * pattern that every task repeats on each run for a deadline it armed
+ * itself. A Timeout is armed with start(ms) and calls its callback once
+ * when the time has passed; the tasks that armed it no longer check it.
+ *
+ * Armed timeouts form one list sorted by deadline, so the single
+ * Timeout::poll() placed in loop() compares only the earliest deadline
+ * with millis() when nothing is due. Callbacks run from poll(), i.e. in
+ * loop() context like the tasks themselves, and may start or stop any
+ * timeout (their own included). Deadlines compare wrap-safely, so a
+ * timeout may be up to 2^31 ms long.
+ *
+ * Not ISR-safe: start(), stop() and poll() belong to loop() context.
+ * FreeRTOS labs use RtosTimeout.h, which runs the same kind of callback
+ * from the kernel's timer task instead.
+ *
+ * Usage:
+ *   static void greenOff(void *) { digitalWrite(PIN_LED_GREEN, LOW); }
+ *   static Timeout s_greenOff(greenOff);
+ *
+ *   digitalWrite(PIN_LED_GREEN, HIGH);
+ *   s_greenOff.start(LED_INDICATOR_DURATION_MS);   // re-arms if running
+ *
+ *   void loop() { Timeout::poll(); ... }
+ */
+
+#ifndef TIMEOUT_H
+#define TIMEOUT_H
+
+#include <Arduino.h>
+
+/** @brief Timeout callback; context is the pointer given to the constructor. */
+typedef void (*TimeoutCallback)(void *context);
+
+/**
+ * @class Timeout
+ * @brief One-shot timer in the bare-metal timeout list.
+ *
+ * Declare at file scope (or as a member of such an object): an armed
+ * Timeout is linked into the list and must not go out of scope.
+ */
+class Timeout {
+public:
+    Timeout(TimeoutCallback callback, void *context = NULL);
+
+    /** @brief Arm to fire ms from now; re-arms a pending timeout. */
+    void start(uint32_t ms);
+
+    /** @brief Disarm; the callback will not run. No-op if not pending. */
+    void stop();
+
+    /** @brief True between start() and the callback (or stop()). */
+    bool pending() const { return _pending; }
+
+    /**
+     * @brief Run the callbacks of every expired timeout, earliest first.
+     * Call from loop() on each iteration.
+     */
+    static void poll();
+
+private:
+    Timeout(const Timeout &);
+    Timeout &operator=(const Timeout &);
+
+    void unlink();
+
+    TimeoutCallback _callback;
+    void           *_context;
+    uint32_t        _deadline;   ///< millis() at which it fires
+    Timeout        *_next;       ///< Next later deadline in the list
+    bool            _pending;
+
+    static Timeout *s_head;      ///< Earliest armed timeout
+};
+
+#endif // TIMEOUT_H
@@ -0,0 +1,321 @@
+/**
+ * @file TwiBus.cpp
+ * @brief Shared I2C Bus Manager Implementation
+ *
+ * The queue holds every submitted transaction in submission order, the
+ * running one included; selectNext() takes the highest priority, the
+ * oldest among equals. The ISR works on s_active:
+ *
+ *   START / REP_START   SLA+W, or SLA+R in the read phase
+ *   MT_SLA/DATA_ACK     preempt?  → REP_START for the more urgent one
+ *                       next tx byte (refilled when used up), else
+ *                       REP_START for the read phase, else finish
+ *   MR_SLA/DATA_ACK     store, ACK all but the last byte
+ *   MR_DATA_NACK        last byte stored → finish
+ *   NACK / error        finish with that status
+ *
+ * finish() calls the callback while s_active still points at the
+ * transaction, so a submit from the callback only queues; then the next
+ * transaction follows with a repeated START, or the bus is released with
+ * a STOP. Only after a bus error / lost arbitration does a STOP separate
+ * two transactions.
+ */
+
+#include "TwiBus.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/twi.h>
+#else
+#define ATOMIC_BLOCK(type)
+#define ATOMIC_RESTORESTATE
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Bus state
+// ──────────────────────────────────────────────────────────────────────────
+
+static TwiTransaction *s_queue[TWI_BUS_QUEUE_DEPTH];  ///< Submission order.
+static uint8_t s_queued = 0;
+static TwiTransaction *s_active = NULL;   ///< On the bus, or NULL if idle.
+static bool s_reading = false;            ///< s_active is in its read phase.
+static bool s_begun = false;
+
+static volatile uint16_t s_errors = 0;
+static volatile uint16_t s_preempts = 0;
+
+#if defined(__AVR__)
+static const uint8_t TWCR_START = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE);
+static const uint8_t TWCR_SEND  = _BV(TWINT) | _BV(TWEN) | _BV(TWIE);
+static const uint8_t TWCR_ACK   = _BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE);
+static const uint8_t TWCR_STOP  = _BV(TWINT) | _BV(TWSTO) | _BV(TWEN);
+#endif
+
+static void finish(TwiTransaction *t, uint8_t status);
+
+// ──────────────────────────────────────────────────────────────────────────
+// Queue (interrupts masked)
+// ──────────────────────────────────────────────────────────────────────────
+
+static void removeQueued(TwiTransaction *t) {
+    for (uint8_t i = 0; i < s_queued; i++) {
+        if (s_queue[i] == t) {
+            for (uint8_t j = i; j + 1 < s_queued; j++) {
+                s_queue[j] = s_queue[j + 1];
+            }
+            s_queued--;
+            return;
+        }
+    }
+}
+
+/** @brief Highest priority queued, oldest among equals; NULL if empty. */
+static TwiTransaction *selectNext() {
+    TwiTransaction *best = NULL;
+    for (uint8_t i = 0; i < s_queued; i++) {
+        if (best == NULL || s_queue[i]->priority > best->priority) {
+            best = s_queue[i];
+        }
+    }
+    return best;
+}
+
+/** @brief Wait for a STOP to leave the bus (at most one bit time). */
+static void waitStop() {
+#if defined(__AVR__)
+    while (TWCR & _BV(TWSTO)) {
+    }
+#endif
+}
+
+/** @brief Put t on the bus with a (repeated) START. */
+static void startOn(TwiTransaction *t) {
+    s_active = t;
+    t->status = TWI_BUS_ACTIVE;
+    // A resumed write continues at pos; with nothing left to write the
+    // read phase (or, without one, the bare address) follows.
+    bool writing = t->pos < t->txLen || t->refill != NULL;
+    s_reading = !writing && t->rxLen > 0;
+#if defined(__AVR__)
+    TWCR = TWCR_START;
+#else
+    finish(t, TWI_BUS_NACK);  // No bus off target
+#endif
+}
+
+static void finish(TwiTransaction *t, uint8_t status) {
+    removeQueued(t);
+    t->status = status;
+    if (status == TWI_BUS_NACK || status == TWI_BUS_ERROR) {
+        if (s_errors < 0xFFFF) {
+            s_errors++;
+        }
+    }
+    if (t->done != NULL) {
+        t->done(t);
+    }
+
+    TwiTransaction *next = selectNext();
+    if (next != NULL && status != TWI_BUS_ERROR) {
+        startOn(next);  // Repeated START: the bus stays ours
+        return;
+    }
+    s_active = NULL;
+#if defined(__AVR__)
+    TWCR = TWCR_STOP;
+#endif
+    if (next != NULL) {
+        waitStop();
+        startOn(next);
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// TWI master (interrupt-driven)
+// ──────────────────────────────────────────────────────────────────────────
+
+#if defined(__AVR__)
+/** @brief Write phase: preempt, send the next byte or move on. */
+static void writeNext(TwiTransaction *t) {
+    if (t->flags & TWI_BUS_PREEMPTIBLE) {
+        TwiTransaction *next = selectNext();
+        if (next->priority > t->priority) {
+            t->status = TWI_BUS_PENDING;  // Stays queued, resumes at pos
+            s_preempts++;
+            startOn(next);
+            return;
+        }
+    }
+    if (t->pos >= t->txLen && t->refill != NULL) {
+        t->txLen = t->refill(t);
+        t->pos = 0;
+    }
+    if (t->pos < t->txLen) {
+        TWDR = t->tx[t->pos++];
+        TWCR = TWCR_SEND;
+        return;
+    }
+    if (t->rxLen > 0) {
+        t->pos = 0;
+        s_reading = true;
+        TWCR = TWCR_START;
+        return;
+    }
+    finish(t, TWI_BUS_DONE);
+}
+
+ISR(TWI_vect) {
+    TwiTransaction *t = s_active;
+    if (t == NULL) {
+        TWCR = TWCR_STOP;
+        return;
+    }
+    switch (TW_STATUS) {
+        case TW_START:
+        case TW_REP_START:
+            TWDR = (uint8_t)((t->address << 1) | (s_reading ? TW_READ : TW_WRITE));
+            TWCR = TWCR_SEND;
+            return;
+
+        case TW_MT_SLA_ACK:
+        case TW_MT_DATA_ACK:
+            writeNext(t);
+            return;
+
+        case TW_MR_SLA_ACK:
+            TWCR = (t->rxLen > 1) ? TWCR_ACK : TWCR_SEND;  // NACK ends the read
+            return;
+
+        case TW_MR_DATA_ACK:
+            t->rx[t->pos++] = TWDR;
+            TWCR = (uint8_t)(t->pos + 1 < t->rxLen ? TWCR_ACK : TWCR_SEND);
+            return;
+
+        case TW_MR_DATA_NACK:
+            t->rx[t->pos++] = TWDR;
+            finish(t, TWI_BUS_DONE);
+            return;
+
+        case TW_MT_SLA_NACK:
+        case TW_MT_DATA_NACK:
+        case TW_MR_SLA_NACK:
+            finish(t, TWI_BUS_NACK);
+            return;
+
+        default:  // Arbitration lost, bus error
+            finish(t, TWI_BUS_ERROR);
+            return;
+    }
+}
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+void twiBusBegin() {
+    if (s_begun) {
+        return;
+    }
+    s_begun = true;
+#if defined(__AVR__)
+    pinMode(SDA, INPUT_PULLUP);
+    pinMode(SCL, INPUT_PULLUP);
+    TWSR = 0;  // Prescaler 1
+    TWBR = (uint8_t)(((F_CPU / TWI_BUS_CLOCK_HZ) - 16) / 2);
+    TWCR = _BV(TWEN);
+#endif
+}
+
+void twiBusSetup(TwiTransaction *t, uint8_t address, const uint8_t *tx, uint8_t txLen,
+                 uint8_t *rx, uint8_t rxLen, uint8_t priority) {
+    t->address = address;
+    t->priority = priority;
+    t->flags = 0;
+    t->tx = tx;
+    t->txLen = txLen;
+    t->rx = rx;
+    t->rxLen = rxLen;
+    t->refill = NULL;
+    t->done = NULL;
+    t->arg = NULL;
+    t->status = TWI_BUS_IDLE;
+    t->pos = 0;
+}
+
+bool twiBusSubmit(TwiTransaction *t) {
+    bool queued = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!twiBusPending(t) && s_queued < TWI_BUS_QUEUE_DEPTH) {
+            t->pos = 0;
+            t->status = TWI_BUS_PENDING;
+            s_queue[s_queued++] = t;
+            queued = true;
+            if (s_active == NULL) {
+                waitStop();
+                startOn(selectNext());
+            }
+        }
+    }
+    return queued;
+}
+
+void twiBusCancel(TwiTransaction *t) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (twiBusPending(t)) {
+            bool wasActive = (t == s_active);
+            if (wasActive) {
+#if defined(__AVR__)
+                TWCR = 0;  // Abort and release the bus
+                TWCR = _BV(TWEN);
+#endif
+                s_active = NULL;
+            }
+            removeQueued(t);
+            t->status = TWI_BUS_CANCELLED;
+            if (t->done != NULL) {
+                t->done(t);
+            }
+            TwiTransaction *next = selectNext();
+            if (wasActive && s_active == NULL && next != NULL) {
+                startOn(next);
+            }
+        }
+    }
+}
+
+bool twiBusPending(const TwiTransaction *t) {
+    uint8_t status = t->status;
+    return status == TWI_BUS_PENDING || status == TWI_BUS_ACTIVE;
+}
+
+bool twiBusTransferBlocking(TwiTransaction *t, uint16_t timeoutMs) {
+    if (!twiBusSubmit(t)) {
+        return false;
+    }
+    uint32_t start = millis();
+    while (twiBusPending(t)) {
+        if ((uint32_t)(millis() - start) >= timeoutMs) {
+            twiBusCancel(t);
+            break;
+        }
+    }
+    return t->status == TWI_BUS_DONE;
+}
+
+uint16_t twiBusErrorCount() {
+    uint16_t n = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        n = s_errors;
+    }
+    return n;
+}
+
+uint16_t twiBusPreemptCount() {
+    uint16_t n = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        n = s_preempts;
+    }
+    return n;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file TwiBus.h
+ * @brief Shared Interrupt-Driven I2C (TWI) Bus Manager with Priorities
+ *
+ * One owner for the TWI peripheral and its vector, so the LCD and I2C
+ * sensors can share the bus without blocking each other. Clients submit
+ * transactions; the TWI interrupt runs them one after another, highest
+ * priority first (FIFO among equals), chained with repeated STARTs, and
+ * reports each one through its status and an optional completion
+ * callback called from the ISR.
+ *
+ *   task / ISR ─ twiBusSubmit() ─► queue ─► TWI ISR ─► bus
+ *                                    ▲          │
+ *                     callback(t) ◄──┴──────────┘  (status DONE / NACK / ...)
+ *
+ * A transaction writes t->tx, then reads t->rx after a repeated START
+ * (either part may be empty): a register read is one transaction with
+ * the register address as tx. A streaming transaction also has a refill
+ * hook that the ISR calls whenever tx is used up, to produce the next
+ * bytes of an open-ended write; 0 ends it. LcdTwi streams the changed
+ * LCD cells this way.
+ *
+ * Preemption: a transaction flagged TWI_BUS_PREEMPTIBLE is paused at the
+ * next byte boundary when one of higher priority is queued: the bus
+ * switches to it with a repeated START, and resumes the paused write
+ * (re-addressed, from the next byte) when nothing more urgent is left.
+ * Only devices that tolerate a write split in two may be flagged (the
+ * PCF8574 LCD backpack just holds its outputs); reads and register
+ * writes are never split. A sensor read queued behind LCD traffic waits
+ * at most one byte (22.5 µs at 400 kHz, 90 µs at 100 kHz) plus its own
+ * transfer, instead of a full-screen redraw.
+ *
+ * Transactions are caller-owned (static) and must stay untouched while
+ * twiBusPending(). Callbacks run in the ISR with interrupts masked: keep
+ * them short; they may submit, also the transaction just finished. To
+ * wake a task, give a notification from the callback.
+ *
+ * Tasks waiting for their own transaction use the status, a callback
+ * notification or twiBusTransferBlocking() (spins; init code only).
+ *
+ * Owns the TWI vector: cannot be linked together with Wire. Off target
+ * there is no bus: every transaction completes at once with TWI_BUS_NACK.
+ *
+ * Usage:
+ *   static uint8_t s_reg = 0x00, s_raw[2];
+ *   static TwiTransaction s_read;
+ *
+ *   twiBusBegin();
+ *   twiBusSetup(&s_read, 0x48, &s_reg, 1, s_raw, 2, 2);   // priority 2
+ *   s_read.done = onReadDone;                                // optional
+ *   twiBusSubmit(&s_read);                                   // returns at once
+ *   ...
+ *   if (s_read.status == TWI_BUS_DONE) { ... s_raw ... }
+ */
+
+#ifndef TWI_BUS_H
+#define TWI_BUS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief I2C clock. Defaults to LCD_TWI_CLOCK_HZ when that is given, so
+ * the existing LCD fast-mode flag keeps working; else 100 kHz.
+ * Override with -DTWI_BUS_CLOCK_HZ=<hz>.
+ */
+#ifndef TWI_BUS_CLOCK_HZ
+#if defined(LCD_TWI_CLOCK_HZ)
+#define TWI_BUS_CLOCK_HZ LCD_TWI_CLOCK_HZ
+#else
+#define TWI_BUS_CLOCK_HZ 100000UL
+#endif
+#endif
+
+#if TWI_BUS_CLOCK_HZ > 400000UL
+#error "TWI_BUS_CLOCK_HZ: the TWI runs at most at 400 kHz"
+#endif
+
+/**
+ * @brief Transactions queued at once (including the running one).
+ * Override with -DTWI_BUS_QUEUE_DEPTH=<n>.
+ */
+#ifndef TWI_BUS_QUEUE_DEPTH
+#define TWI_BUS_QUEUE_DEPTH 4
+#endif
+
+/** @brief Flag: may be paused between bytes for a higher priority. */
+#define TWI_BUS_PREEMPTIBLE 0x01
+
+/**
+ * @enum TwiBusStatus
+ * @brief State of a transaction.
+ */
+enum TwiBusStatus {
+    TWI_BUS_IDLE,       /**< Never submitted.                          */
+    TWI_BUS_PENDING,    /**< Queued (or paused by preemption).         */
+    TWI_BUS_ACTIVE,     /**< On the bus.                               */
+    TWI_BUS_DONE,       /**< Every byte sent / received.               */
+    TWI_BUS_NACK,       /**< Address or data byte not acknowledged.    */
+    TWI_BUS_ERROR,      /**< Arbitration lost or bus error.            */
+    TWI_BUS_CANCELLED   /**< Removed by twiBusCancel() (or timed out). */
+};
+
+struct TwiTransaction;
+
+/** @brief Completion callback (ISR context). */
+typedef void (*TwiBusCallback)(TwiTransaction *t);
+
+/**
+ * @brief Streaming refill (ISR context): put the next bytes where t->tx
+ * points and return their count; 0 ends the write.
+ */
+typedef uint8_t (*TwiBusRefill)(TwiTransaction *t);
+
+/**
+ * @struct TwiTransaction
+ * @brief One I2C write / write-read / read. Set up with twiBusSetup().
+ */
+struct TwiTransaction {
+    uint8_t         address;   /**< 7-bit slave address.                  */
+    uint8_t         priority;  /**< Higher runs first.                    */
+    uint8_t         flags;     /**< TWI_BUS_PREEMPTIBLE.                  */
+    const uint8_t  *tx;        /**< Bytes to write (may be NULL).         */
+    uint8_t         txLen;     /**< Bytes in tx.                          */
+    uint8_t        *rx;        /**< Read buffer (may be NULL).            */
+    uint8_t         rxLen;     /**< Bytes to read after the write.        */
+    TwiBusRefill    refill;    /**< Streaming refill, or NULL.            */
+    TwiBusCallback  done;      /**< Completion callback, or NULL.         */
+    void           *arg;       /**< For the callback.                     */
+    volatile uint8_t status;   /**< TwiBusStatus (bus-owned).             */
+    uint8_t         pos;       /**< Bytes of the current phase (bus-owned). */
+};
+
+/**
+ * @brief Set up the TWI peripheral (pull-ups, clock). Idempotent.
+ */
+void twiBusBegin();
+
+/**
+ * @brief Fill a transaction: no flags, refill or callback.
+ */
+void twiBusSetup(TwiTransaction *t, uint8_t address, const uint8_t *tx, uint8_t txLen,
+                 uint8_t *rx, uint8_t rxLen, uint8_t priority);
+
+/**
+ * @brief Queue a transaction; starts the bus if it is idle. Never blocks.
+ *
+ * Task or ISR context (also from a completion callback).
+ *
+ * @return false if t is already pending or the queue is full.
+ */
+bool twiBusSubmit(TwiTransaction *t);
+
+/**
+ * @brief Remove a transaction; aborts it if it is on the bus.
+ *
+ * Sets TWI_BUS_CANCELLED and calls the callback. An aborted transfer is
+ * cut short (the TWI is reset), so the device may have seen part of it.
+ */
+void twiBusCancel(TwiTransaction *t);
+
+/** @brief True while t is queued or on the bus. */
+bool twiBusPending(const TwiTransaction *t);
+
+/**
+ * @brief Submit and spin until done (initialization code).
+ *
+ * @param timeoutMs Bound on queueing plus transfer; the transaction is
+ *                  cancelled when it passes.
+ * @return true if it completed with TWI_BUS_DONE.
+ */
+bool twiBusTransferBlocking(TwiTransaction *t, uint16_t timeoutMs);
+
+/** @brief Transactions that ended with NACK or error (saturates). */
+uint16_t twiBusErrorCount();
+
+/** @brief Times a preemptible transaction was paused (wraps). */
+uint16_t twiBusPreemptCount();
+
+#endif // TWI_BUS_H
@@ -0,0 +1,345 @@
+/**
+ * @file UartOneWire.cpp
+ * @brief Interrupt-Driven 1-Wire Master Implementation
+ *
+ * USART setup (n = UART_ONEWIRE_USART):
+ *   UCSRnA = U2Xn                          double speed (finer UBRR steps)
+ *   UCSRnB = RXENn | TXENn | RXCIEn        8N1; no UDRE / TXC interrupts
+ *   UBRRn  = 207 (9600) for the reset character, 16 (115200) for slots
+ *
+ * Transaction phases:
+ *   IDLE   echoes are dropped (a late one after a timeout)
+ *   RESET  the 0xF0 echo decides presence; the ISR switches to slot baud
+ *   SLOTS  each echo stores one bit in place and sends the next slot
+ * Only one character is ever in flight, so the next one can be written
+ * to UDR from the RX interrupt: the transmitter buffers it behind the
+ * stop bit, which is the slot's recovery time.
+ */
+
+#include "UartOneWire.h"
+#include "StdioSerial.h"
+#include "FlashString.h"
+
+#if STDIO_SERIAL_PORT_ROUTED(UART_ONEWIRE_USART)
+#error "UART_ONEWIRE_USART is routed to by StdioSerial (STDIO_TELEMETRY_PORT / STDIO_LOG_PORT)"
+#endif
+
+/** 1-Wire commands used here. */
+static const uint8_t CMD_SEARCH_ROM = 0xF0;
+
+uint8_t uartOneWireCrc8(const uint8_t *data, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        uint8_t in = *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            uint8_t mix = (uint8_t)((crc ^ in) & 0x01);
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            in >>= 1;
+        }
+    }
+    return crc;
+}
+
+#if defined(__AVR__)
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <stdio.h>
+#include <string.h>
+
+// ──────────────────────────────────────────────────────────────────────────
+// USART register selection
+// ──────────────────────────────────────────────────────────────────────────
+
+#define OW_CAT2(a, b)     a##b
+#define OW_CAT3(a, b, c)  a##b##c
+#define OW_XCAT2(a, b)    OW_CAT2(a, b)
+#define OW_XCAT3(a, b, c) OW_CAT3(a, b, c)
+
+#define OW_UCSRA     OW_XCAT3(UCSR, UART_ONEWIRE_USART, A)
+#define OW_UCSRB     OW_XCAT3(UCSR, UART_ONEWIRE_USART, B)
+#define OW_UCSRC     OW_XCAT3(UCSR, UART_ONEWIRE_USART, C)
+#define OW_UBRR      OW_XCAT2(UBRR, UART_ONEWIRE_USART)
+#define OW_UDR       OW_XCAT2(UDR, UART_ONEWIRE_USART)
+#define OW_U2X       OW_XCAT2(U2X, UART_ONEWIRE_USART)
+#define OW_FE        OW_XCAT2(FE, UART_ONEWIRE_USART)
+#define OW_RXC       OW_XCAT2(RXC, UART_ONEWIRE_USART)
+#define OW_RXEN      OW_XCAT2(RXEN, UART_ONEWIRE_USART)
+#define OW_TXEN      OW_XCAT2(TXEN, UART_ONEWIRE_USART)
+#define OW_RXCIE     OW_XCAT2(RXCIE, UART_ONEWIRE_USART)
+#define OW_UCSZ1     OW_XCAT2(UCSZ, OW_XCAT2(UART_ONEWIRE_USART, 1))
+#define OW_UCSZ0     OW_XCAT2(UCSZ, OW_XCAT2(UART_ONEWIRE_USART, 0))
+#define OW_RX_vect   OW_XCAT3(USART, UART_ONEWIRE_USART, _RX_vect)
+
+#if UART_ONEWIRE_USART == 1
+static const uint8_t OW_RX_PIN = 19;
+#elif UART_ONEWIRE_USART == 2
+static const uint8_t OW_RX_PIN = 17;
+#else
+static const uint8_t OW_RX_PIN = 15;
+#endif
+
+// ──────────────────────────────────────────────────────────────────────────
+// Timing
+// ──────────────────────────────────────────────────────────────────────────
+
+/** UBRR values with U2X, rounded as in modbusSlaveBegin(). */
+static const uint16_t RESET_UBRR = (uint16_t)(((F_CPU / 4UL / 9600UL) - 1UL) / 2UL);
+static const uint16_t SLOT_UBRR  = (uint16_t)(((F_CPU / 4UL / 115200UL) - 1UL) / 2UL);
+
+/** Reset character: start + 4 low bits (≥ 480 µs), then the presence window. */
+static const uint8_t RESET_CHAR = 0xF0;
+static const uint8_t SLOT_ONE   = 0xFF;
+static const uint8_t SLOT_ZERO  = 0x00;
+
+/** One reset / slot character on the line, plus the ISR hand-over (µs). */
+static const uint16_t RESET_US = 1050;
+static const uint16_t SLOT_US  = 92;
+
+/** Slack on top of twice the expected time before a transfer gives up (µs). */
+static const uint16_t TIMEOUT_SLACK_US = 2000;
+
+// ──────────────────────────────────────────────────────────────────────────
+// State
+// ──────────────────────────────────────────────────────────────────────────
+
+enum Phase { PHASE_IDLE, PHASE_RESET, PHASE_SLOTS };
+
+static volatile uint8_t s_phase = PHASE_IDLE;
+static volatile bool    s_presence = false;
+static uint8_t         *s_buf = NULL;
+static uint16_t         s_slots = 0;     ///< Slots of the transaction (8 per byte).
+static uint16_t         s_slot = 0;      ///< Slot whose echo is awaited.
+static void           (*s_onDone)() = NULL;
+static void           (*s_wait)(uint16_t) = NULL;
+
+/** @brief Character for slot @p i: its bit of the buffer. */
+static inline uint8_t slotChar(uint16_t i) {
+    return (s_buf[i >> 3] & (uint8_t)(1U << (i & 7))) ? SLOT_ONE : SLOT_ZERO;
+}
+
+static void finish() {
+    s_phase = PHASE_IDLE;
+    if (s_onDone != NULL) {
+        s_onDone();
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Interrupt
+// ──────────────────────────────────────────────────────────────────────────
+
+ISR(OW_RX_vect) {
+    uint8_t status = OW_UCSRA;
+    uint8_t echo = OW_UDR;
+
+    if (s_phase == PHASE_RESET) {
+        // A shorted bus echoes 0x00 with a framing error: no presence.
+        s_presence = !(status & _BV(OW_FE)) && echo != RESET_CHAR;
+        OW_UBRR = SLOT_UBRR;
+        if (!s_presence || s_slots == 0) {
+            finish();
+            return;
+        }
+        s_phase = PHASE_SLOTS;
+        OW_UDR = slotChar(0);
+        return;
+    }
+    if (s_phase != PHASE_SLOTS) {
+        return;
+    }
+
+    uint8_t mask = (uint8_t)(1U << (s_slot & 7));
+    uint8_t *byte = &s_buf[s_slot >> 3];
+    if (echo == SLOT_ONE) {
+        *byte |= mask;
+    } else {
+        *byte &= (uint8_t)~mask;
+    }
+    if (++s_slot == s_slots) {
+        finish();
+        return;
+    }
+    OW_UDR = slotChar(s_slot);
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Transactions
+// ──────────────────────────────────────────────────────────────────────────
+
+static bool startSlots(uint8_t *buf, uint16_t slots, bool reset, void (*onDone)()) {
+    if (!reset && slots == 0) {
+        return false;
+    }
+    if (slots > 0 && buf == NULL) {
+        return false;
+    }
+    bool started = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (s_phase == PHASE_IDLE) {
+            while (OW_UCSRA & _BV(OW_RXC)) {
+                (void)OW_UDR;                 // A late echo of an aborted transfer
+            }
+            s_buf = buf;
+            s_slots = slots;
+            s_slot = 0;
+            s_onDone = onDone;
+            if (reset) {
+                s_presence = false;
+                s_phase = PHASE_RESET;
+                OW_UBRR = RESET_UBRR;
+                OW_UDR = RESET_CHAR;
+            } else {
+                s_phase = PHASE_SLOTS;
+                OW_UBRR = SLOT_UBRR;
+                OW_UDR = slotChar(0);
+            }
+            started = true;
+        }
+    }
+    return started;
+}
+
+/** @brief Start, wait (hook, then spin) and give up after twice the expected time. */
+static bool runSlots(uint8_t *buf, uint16_t slots, bool reset) {
+    uint32_t startUs = micros();
+    if (!startSlots(buf, slots, reset, NULL)) {
+        return false;
+    }
+    uint32_t expectedUs = (reset ? RESET_US : 0) + (uint32_t)slots * SLOT_US;
+    if (s_wait != NULL) {
+        s_wait(expectedUs > 0xFFFFUL ? 0xFFFF : (uint16_t)expectedUs);
+    }
+    uint32_t timeoutUs = 2 * expectedUs + TIMEOUT_SLACK_US;
+    while (s_phase != PHASE_IDLE) {
+        if ((uint32_t)(micros() - startUs) > timeoutUs) {
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                s_phase = PHASE_IDLE;         // No echo: TX / RX not wired
+            }
+            return false;
+        }
+    }
+    return !reset || s_presence;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Public API
+// ──────────────────────────────────────────────────────────────────────────
+
+bool uartOneWireBegin() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        OW_UCSRB = 0;
+        s_phase = PHASE_IDLE;
+        OW_UBRR = SLOT_UBRR;
+        OW_UCSRA = _BV(OW_U2X);
+        OW_UCSRC = _BV(OW_UCSZ1) | _BV(OW_UCSZ0);
+        OW_UCSRB = _BV(OW_TXEN) | _BV(OW_RXEN) | _BV(OW_RXCIE);
+    }
+    delayMicroseconds(SLOT_US);               // TX idles high through the pull-up
+    if (digitalRead(OW_RX_PIN) == LOW) {
+        FLASH_PRINTF("[ERROR] 1-Wire bus on USART%u held low\r\n", (unsigned)UART_ONEWIRE_USART);
+        return false;
+    }
+    return true;
+}
+
+bool uartOneWireStart(uint8_t *buf, uint8_t len, bool reset, void (*onDone)()) {
+    return startSlots(buf, (uint16_t)len * 8, reset, onDone);
+}
+
+bool uartOneWireBusy() {
+    return s_phase != PHASE_IDLE;
+}
+
+bool uartOneWirePresence() {
+    return s_presence;
+}
+
+bool uartOneWireTransfer(uint8_t *buf, uint8_t len, bool reset) {
+    return runSlots(buf, (uint16_t)len * 8, reset);
+}
+
+bool uartOneWireReset() {
+    return runSlots(NULL, 0, true);
+}
+
+uint8_t uartOneWireTouchBits(uint8_t bits, uint8_t count) {
+    if (count == 0 || count > 8) {
+        return 0xFF;
+    }
+    uint8_t buf = bits;
+    if (!runSlots(&buf, count, false)) {
+        return 0xFF;
+    }
+    return buf;
+}
+
+void uartOneWireSetWait(void (*wait)(uint16_t expectedUs)) {
+    s_wait = wait;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Search ROM
+// ──────────────────────────────────────────────────────────────────────────
+
+void uartOneWireSearchReset(UartOneWireSearch *search) {
+    memset(search->rom, 0, sizeof(search->rom));
+    search->lastDiscrepancy = -1;
+    search->done = false;
+}
+
+bool uartOneWireSearchNext(UartOneWireSearch *search, uint8_t rom[8]) {
+    if (search->done) {
+        return false;
+    }
+    uint8_t cmd = CMD_SEARCH_ROM;
+    if (!uartOneWireTransfer(&cmd, 1, true)) {
+        search->done = true;                  // No device on the bus
+        return false;
+    }
+
+    // Each bit: the devices send it and its complement, the master picks
+    // a branch; devices whose bit differs drop out until the next reset.
+    int8_t lastZero = -1;
+    for (int8_t bit = 0; bit < 64; bit++) {
+        uint8_t pair = uartOneWireTouchBits(0x03, 2);
+        uint8_t idBit = pair & 0x01;
+        uint8_t cmpBit = (pair >> 1) & 0x01;
+        if (idBit && cmpBit) {
+            search->done = true;              // No device left answering
+            return false;
+        }
+        uint8_t dir;
+        uint8_t mask = (uint8_t)(1U << (bit & 7));
+        if (idBit != cmpBit) {
+            dir = idBit;
+        } else if (bit < search->lastDiscrepancy) {
+            dir = (search->rom[bit >> 3] & mask) ? 1 : 0;   // The previous path
+        } else {
+            dir = (bit == search->lastDiscrepancy) ? 1 : 0; // Now the 1 branch
+        }
+        if (idBit == cmpBit && dir == 0) {
+            lastZero = bit;
+        }
+        if (dir) {
+            search->rom[bit >> 3] |= mask;
+        } else {
+            search->rom[bit >> 3] &= (uint8_t)~mask;
+        }
+        uartOneWireTouchBits(dir, 1);
+    }
+
+    search->lastDiscrepancy = lastZero;
+    search->done = (lastZero < 0);
+    if (search->rom[0] == 0 || uartOneWireCrc8(search->rom, 7) != search->rom[7]) {
+        search->done = true;
+        return false;
+    }
+    memcpy(rom, search->rom, sizeof(search->rom));
+    return true;
+}
+
+#endif // __AVR__
@@ -0,0 +1,144 @@
+/**
+ * @file UartOneWire.h
+ * @brief Interrupt-Driven 1-Wire Master on a Spare USART
+ *
+ * The OneWire library bit-bangs every time slot with interrupts masked
+ * for up to ~70 µs per bit, tens of times per byte. Here a USART times
+ * the slots and the RX interrupt does the bookkeeping, so interrupts stay
+ * enabled and the CPU only runs one short ISR per slot:
+ *
+ *   reset    9600 baud, send 0xF0: the start bit and four low data bits
+ *            are the ≥ 480 µs reset pulse. A presence pulse pulls some of
+ *            the high bits low, so an echo other than 0xF0 means presence
+ *            (a framing error means a shorted bus, no presence).
+ *   slots    115200 baud, one character per bit, LSB first:
+ *              write 1 → 0xFF   (only the 8.7 µs start bit is low)
+ *              write 0 → 0x00   (low for 9 bit times, ~78 µs)
+ *              read    → 0xFF; an echo of 0xFF reads 1, anything else 0
+ *            The echo of each slot is received when its stop bit is on
+ *            the line; the RX ISR samples the bit and loads the next slot,
+ *            so consecutive slots need no other timer.
+ *
+ * A transaction is an optional reset followed by len bytes exchanged in
+ * place: bytes to write are sent as they are, bytes to read are sent as
+ * 0xFF and come back holding the slave's bits. A whole sequence (reset,
+ * Match ROM, command, 9 read bytes) is one transaction and one start.
+ *
+ * Circuit (TX drives the line high when idle, so it must not reach DQ
+ * directly):
+ *   VCC ──[4.7K]──┬── DQ (DS18B20)
+ *   RXn ──────────┤
+ *   TXn ──|<──────┘   Schottky diode (BAT54 / 1N5817), cathode at TXn;
+ *                     or a 74LVC1G07 open-drain buffer
+ *
+ * USART (select with -DUART_ONEWIRE_USART=<n>):
+ *   2 (default) → TX2 D16 / RX2 D17   1 → TX1 D18 / RX1 D19
+ *   3 → TX3 D14 / RX3 D15 (the Modbus default)
+ * The USART is taken over: do not use the matching SerialN, do not route
+ * a StdioSerial stream to it, and keep it out of idleSleepInit()'s gates.
+ *
+ * Blocking transfers start the transaction and call the wait hook, if
+ * one is set, with the expected duration (e.g. a FreeRTOS task sleeps it
+ * off), then spin with interrupts enabled until the ISR has finished or
+ * the timeout passed. Not built for the native tests.
+ *
+ * Usage:
+ *   uartOneWireBegin();
+ *   uint8_t cmd[] = { 0xCC, 0x44 };                      // Skip ROM, Convert T
+ *   if (uartOneWireTransfer(cmd, sizeof(cmd), true)) { } // true: presence
+ *
+ *   uint8_t rom[8];
+ *   UartOneWireSearch search;
+ *   uartOneWireSearchReset(&search);
+ *   while (uartOneWireSearchNext(&search, rom)) { }
+ */
+
+#ifndef UART_ONE_WIRE_H
+#define UART_ONE_WIRE_H
+
+#include <Arduino.h>
+
+/** @brief USART used for the bus (1..3). */
+#ifndef UART_ONEWIRE_USART
+#define UART_ONEWIRE_USART 2
+#endif
+
+#if UART_ONEWIRE_USART < 1 || UART_ONEWIRE_USART > 3
+#error "UART_ONEWIRE_USART must be 1, 2 or 3"
+#endif
+
+/**
+ * @struct UartOneWireSearch
+ * @brief Search ROM state between uartOneWireSearchNext() calls.
+ */
+struct UartOneWireSearch {
+    uint8_t rom[8];          ///< Last ROM code found.
+    int8_t  lastDiscrepancy; ///< Bit where the last pass took the 0 branch, -1 = none.
+    bool    done;            ///< The last device has been found.
+};
+
+/**
+ * @brief Configure the USART for 1-Wire slots (TX, RX and RX interrupt).
+ * @return false if the bus is held low (DQ shorted, or TX wired without
+ *         the diode).
+ */
+bool uartOneWireBegin();
+
+/**
+ * @brief Start a transaction; the RX ISR runs it to the end.
+ *
+ * @param buf    Bytes to exchange in place (0xFF for bytes to read), or
+ *               NULL with len 0 for a reset only. Must stay valid until
+ *               uartOneWireBusy() is false.
+ * @param len    Bytes after the reset.
+ * @param reset  Send a reset pulse first (the bytes follow only on presence).
+ * @param onDone Optional callback, run in interrupt context at the end.
+ * @return false if a transaction is running or the arguments are invalid.
+ */
+bool uartOneWireStart(uint8_t *buf, uint8_t len, bool reset, void (*onDone)() = NULL);
+
+/** @brief A started transaction has not ended yet. */
+bool uartOneWireBusy();
+
+/** @brief The last reset saw a presence pulse. */
+bool uartOneWirePresence();
+
+/**
+ * @brief Run one transaction to the end.
+ *
+ * @return false on a timeout, or (with reset) if no device answered.
+ */
+bool uartOneWireTransfer(uint8_t *buf, uint8_t len, bool reset);
+
+/** @brief A reset pulse alone; true on presence. */
+bool uartOneWireReset();
+
+/**
+ * @brief Exchange 1..8 single slots, LSB first (search triplets).
+ * @return The bits read back, or 0xFF on a timeout.
+ */
+uint8_t uartOneWireTouchBits(uint8_t bits, uint8_t count);
+
+/**
+ * @brief Hook run by blocking transfers right after the start.
+ *
+ * @param wait Called with the expected duration (µs) from task context,
+ *             e.g. to sleep it off; NULL spins (the default).
+ */
+void uartOneWireSetWait(void (*wait)(uint16_t expectedUs));
+
+/** @brief Start a new search from the lowest ROM code. */
+void uartOneWireSearchReset(UartOneWireSearch *search);
+
+/**
+ * @brief Find the next device on the bus (Search ROM, 0xF0).
+ *
+ * @param rom Receives the device's 64-bit ROM code (CRC checked).
+ * @return false once every device has been found, or on a bus error.
+ */
+bool uartOneWireSearchNext(UartOneWireSearch *search, uint8_t rom[8]);
+
+/** @brief Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1) of ROM codes and scratchpads. */
+uint8_t uartOneWireCrc8(const uint8_t *data, uint8_t len);
+
+#endif // UART_ONE_WIRE_H
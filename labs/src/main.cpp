@@ -7,7 +7,8 @@
  *
  * The active lab is selected automatically via preprocessor defines
  * set in platformio.ini (e.g., -DLAB1_1, -DLAB1_2). Each PlatformIO
- * environment builds and runs exactly one lab without code changes.
+ * environment builds and runs exactly one lab without code changes;
+ * env:bench (-DBENCH) builds the library benchmark runner instead.
  */
 
 #include <Arduino.h>
@@ -33,6 +34,10 @@
     #include "lab5_2_main.h"
 #elif defined(LAB6_1)
     #include "lab6_1_main.h"
+#elif defined(LAB7_1)
+    #include "lab7_1_main.h"
+#elif defined(BENCH)
+    #include "bench_main.h"
 #else
     #error "No lab selected! Add -DLABx_x to build_flags in platformio.ini"
 #endif
@@ -58,6 +63,10 @@ void setup() {
     lab5_2Setup();
 #elif defined(LAB6_1)
     lab6_1Setup();
+#elif defined(LAB7_1)
+    lab7_1Setup();
+#elif defined(BENCH)
+    benchSetup();
 #endif
 }
 
@@ -82,5 +91,9 @@ void loop() {
     lab5_2Loop();
 #elif defined(LAB6_1)
     lab6_1Loop();
+#elif defined(LAB7_1)
+    lab7_1Loop();
+#elif defined(BENCH)
+    benchLoop();
 #endif
 }
@@ -0,0 +1,282 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino Core Shim for the Host-Native Build (env:native)
+ *
+ * Lets the hardware-independent libraries compile and run on a PC under
+ * the PlatformIO test runner. Only what those libraries use is provided:
+ *
+ *   - a simulated clock: millis()/micros() read it, delay() and
+ *     delayMicroseconds() advance it, and tests move it explicitly with
+ *     nativeAdvanceMs() / nativeSetMillis(), so time-based logic is
+ *     deterministic and a "10 s" test takes no time at all;
+ *   - pins as plain arrays: digitalWrite()/analogWrite() record the
+ *     value (read back with nativePinLevel()), digitalRead()/analogRead()
+ *     return what a test set with nativeSetDigital()/nativeSetAnalog();
+ *   - a Serial object whose output goes to the host's stdout and whose
+ *     input is queued by nativeSerialFeed();
+ *   - PROGMEM and the pgm_read_*() / *_P() helpers as plain RAM access.
+ *
+ * printf() already writes to the host's stdout: do not call
+ * stdioSerialInit() natively (its stdout redirection is AVR-only).
+ *
+ * Header-only; the shim state lives in function-local statics, so every
+ * translation unit of a test sees the same clock, pins and Serial.
+ *
+ * Usage (in a test):
+ *   nativeReset();
+ *   fsm.processKey('#');
+ *   nativeAdvanceMs(RESULT_DISPLAY_MS);
+ *   Timeout::poll();
+ */
+
+#ifndef NATIVE_ARDUINO_SHIM_H
+#define NATIVE_ARDUINO_SHIM_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+// Mega 2560 numbering: A0..A15 follow the 54 digital pins.
+#define A0  54
+#define A1  55
+#define A2  56
+#define A3  57
+#define A4  58
+#define A5  59
+#define A6  60
+#define A7  61
+#define A8  62
+#define A9  63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+/** @brief Pins simulated (digital 0..53 and A0..A15). */
+#define NATIVE_PIN_COUNT 70
+
+// ──────────────────────────────────────────────────────────────────────────
+// Simulated clock
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief The simulated time in µs since nativeReset() (64-bit: never wraps). */
+inline uint64_t &nativeClockUs() {
+    static uint64_t us = 0;
+    return us;
+}
+
+inline unsigned long millis() { return (unsigned long)(uint32_t)(nativeClockUs() / 1000u); }
+inline unsigned long micros() { return (unsigned long)(uint32_t)nativeClockUs(); }
+
+inline void delay(unsigned long ms) { nativeClockUs() += (uint64_t)ms * 1000u; }
+inline void delayMicroseconds(unsigned int us) { nativeClockUs() += us; }
+
+/** @brief Move the clock forward. */
+inline void nativeAdvanceMs(uint32_t ms) { nativeClockUs() += (uint64_t)ms * 1000u; }
+inline void nativeAdvanceUs(uint32_t us) { nativeClockUs() += us; }
+
+/** @brief Set the clock, e.g. just before a millis() wrap. */
+inline void nativeSetMillis(uint32_t ms) { nativeClockUs() = (uint64_t)ms * 1000u; }
+
+// ──────────────────────────────────────────────────────────────────────────
+// Simulated pins
+// ──────────────────────────────────────────────────────────────────────────
+
+struct NativePins {
+    uint8_t  mode[NATIVE_PIN_COUNT];
+    uint8_t  level[NATIVE_PIN_COUNT];    ///< Written by digitalWrite(), read by digitalRead()
+    int      analogOut[NATIVE_PIN_COUNT];
+    uint16_t analogIn[NATIVE_PIN_COUNT];
+};
+
+inline NativePins &nativePins() {
+    static NativePins pins;
+    return pins;
+}
+
+inline bool nativePinValid(uint8_t pin) { return pin < NATIVE_PIN_COUNT; }
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    if (nativePinValid(pin)) {
+        nativePins().mode[pin] = mode;
+        if (mode == INPUT_PULLUP) {
+            nativePins().level[pin] = HIGH;
+        }
+    }
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t value) {
+    if (nativePinValid(pin)) {
+        nativePins().level[pin] = value ? HIGH : LOW;
+    }
+}
+
+inline int digitalRead(uint8_t pin) {
+    return nativePinValid(pin) ? nativePins().level[pin] : LOW;
+}
+
+inline void analogWrite(uint8_t pin, int value) {
+    if (nativePinValid(pin)) {
+        nativePins().analogOut[pin] = value;
+    }
+}
+
+/** @brief Accepts a channel (0..15) or a pin number (A0..A15), as the core does. */
+inline int analogRead(uint8_t pin) {
+    if (pin < 16) {
+        pin = (uint8_t)(pin + A0);
+    }
+    return nativePinValid(pin) ? nativePins().analogIn[pin] : 0;
+}
+
+/** @brief Drive an input pin as the outside world would. */
+inline void nativeSetDigital(uint8_t pin, uint8_t level) { digitalWrite(pin, level); }
+inline void nativeSetAnalog(uint8_t pin, uint16_t counts) {
+    if (nativePinValid(pin)) {
+        nativePins().analogIn[pin] = counts;
+    }
+}
+
+/** @brief Last level written to a pin. */
+inline uint8_t nativePinLevel(uint8_t pin) { return (uint8_t)digitalRead(pin); }
+inline int nativeAnalogOut(uint8_t pin) {
+    return nativePinValid(pin) ? nativePins().analogOut[pin] : 0;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Interrupts (there are none natively)
+// ──────────────────────────────────────────────────────────────────────────
+
+#define noInterrupts()
+#define interrupts()
+#define cli()
+#define sei()
+
+// ──────────────────────────────────────────────────────────────────────────
+// Serial
+// ──────────────────────────────────────────────────────────────────────────
+
+/**
+ * @class NativeSerial
+ * @brief HardwareSerial stand-in: TX to stdout, RX from nativeSerialFeed().
+ */
+class NativeSerial {
+public:
+    NativeSerial() : _head(0), _tail(0) {}
+
+    void begin(unsigned long) {}
+    void end() {}
+    void flush() { fflush(stdout); }
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c) {
+        putchar(c);
+        return 1;
+    }
+    size_t write(const char *s) {
+        fputs(s, stdout);
+        return strlen(s);
+    }
+    int availableForWrite() { return 63; }
+
+    int available() { return (int)(_head - _tail); }
+    int peek() { return (_head == _tail) ? -1 : (uint8_t)_rx[_tail % RX_SIZE]; }
+    int read() {
+        if (_head == _tail) {
+            return -1;
+        }
+        return (uint8_t)_rx[_tail++ % RX_SIZE];
+    }
+
+    /** @brief Queue received characters (dropped beyond RX_SIZE pending). */
+    void feed(const char *s) {
+        for (; *s != '\0' && (_head - _tail) < RX_SIZE; s++) {
+            _rx[_head++ % RX_SIZE] = *s;
+        }
+    }
+    void clear() { _head = _tail = 0; }
+
+private:
+    static const unsigned RX_SIZE = 256;
+    char     _rx[RX_SIZE];
+    unsigned _head;
+    unsigned _tail;
+};
+
+inline NativeSerial &nativeSerial() {
+    static NativeSerial serial;
+    return serial;
+}
+
+#define Serial nativeSerial()
+
+inline void nativeSerialFeed(const char *s) { nativeSerial().feed(s); }
+
+// avr-libc stream setup used by StdioSerial (stdioSerialInit() is AVR-only).
+#define _FDEV_SETUP_RW 0
+#define fdev_setup_stream(stream, put, get, rwflag) ((void)(stream), (void)(put), (void)(get))
+
+// ──────────────────────────────────────────────────────────────────────────
+// PROGMEM (flash is ordinary memory here)
+// ──────────────────────────────────────────────────────────────────────────
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#define PSTR(s) (s)
+#define F(s)    (s)
+
+#define pgm_read_byte(addr)  (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_float(addr) (*(const float *)(addr))
+#define pgm_read_ptr(addr)   (*(void *const *)(addr))
+
+#define memcpy_P  memcpy
+#define strcpy_P  strcpy
+#define strncpy_P strncpy
+#define strlen_P  strlen
+#define strcmp_P  strcmp
+#define strncmp_P strncmp
+#define printf_P  printf
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+
+/** @brief avr-libc dtostrf(): fixed-point float to text. */
+inline char *dtostrf(double value, signed char width, unsigned char prec, char *out) {
+    sprintf(out, "%*.*f", (int)width, (int)prec, value);
+    return out;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Test support
+// ──────────────────────────────────────────────────────────────────────────
+
+/** @brief Clock to 0, pins low, Serial input empty (call from setUp()). */
+inline void nativeReset() {
+    nativeClockUs() = 0;
+    memset(&nativePins(), 0, sizeof(NativePins));
+    nativeSerial().clear();
+}
+
+#endif // NATIVE_ARDUINO_SHIM_H
@@ -0,0 +1,166 @@
+/**
+ * @file Arduino_FreeRTOS.h
+ * @brief Single-Threaded FreeRTOS Shim for the Host-Native Build (env:native)
+ *
+ * Enough of the kernel API for the libraries built on it (StaticRtos,
+ * SharedState, TaskSignal, RtosTimeout) to compile and be exercised on a
+ * PC. Nothing is scheduled: the test is the only task, and every call
+ * completes at once.
+ *
+ *   - Ticks follow the simulated Arduino clock (16 ms, as on the WDT
+ *     port), and vTaskDelay()/vTaskDelayUntil() advance that clock.
+ *   - A blocking call that cannot succeed (a taken mutex, an empty
+ *     queue, no notification) lets its timeout elapse on the clock and
+ *     fails, instead of deadlocking; portMAX_DELAY fails at once.
+ *   - xTaskCreate*() records nothing and returns a handle; task bodies
+ *     are infinite loops, so tests drive the functions they call.
+ *   - Notifications work on handles from xTaskGetCurrentTaskHandle() or
+ *     xTaskCreate*().
+ *
+ * Static allocation is on (configSUPPORT_STATIC_ALLOCATION 1), so the
+ * StaticRtos storage classes are exercised as on target.
+ */
+
+#ifndef NATIVE_ARDUINO_FREERTOS_SHIM_H
+#define NATIVE_ARDUINO_FREERTOS_SHIM_H
+
+#include <Arduino.h>
+
+typedef int           BaseType_t;
+typedef unsigned int  UBaseType_t;
+typedef uint32_t      TickType_t;
+typedef uint16_t      configSTACK_DEPTH_TYPE;
+typedef uint8_t       StackType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+#define errQUEUE_FULL  pdFALSE
+#define errQUEUE_EMPTY pdFALSE
+
+#ifndef configSUPPORT_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION 1
+#endif
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configUSE_TIMERS                 1
+#define configTICK_RATE_HZ               62
+#define configMAX_PRIORITIES             4
+#define configMINIMAL_STACK_SIZE         192
+#define configTIMER_TASK_PRIORITY        (configMAX_PRIORITIES - 1)
+
+#define portMAX_DELAY      ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS ((TickType_t)16)
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define taskENTER_CRITICAL_FROM_ISR() 0
+#define taskEXIT_CRITICAL_FROM_ISR(x) ((void)(x))
+#define taskDISABLE_INTERRUPTS()
+#define taskENABLE_INTERRUPTS()
+#define taskYIELD()
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+// ──────────────────────────────────────────────────────────────────────────
+// Time
+// ──────────────────────────────────────────────────────────────────────────
+
+inline TickType_t xTaskGetTickCount() {
+    return (TickType_t)(nativeClockUs() / (1000u * portTICK_PERIOD_MS));
+}
+inline TickType_t xTaskGetTickCountFromISR() { return xTaskGetTickCount(); }
+
+/** @brief Let a blocking call's timeout pass on the clock (none for portMAX_DELAY). */
+inline void nativeRtosElapse(TickType_t ticks) {
+    if (ticks != portMAX_DELAY) {
+        nativeClockUs() += (uint64_t)ticks * portTICK_PERIOD_MS * 1000u;
+    }
+}
+
+inline void vTaskDelay(TickType_t ticks) { nativeRtosElapse(ticks); }
+
+inline void vTaskDelayUntil(TickType_t *previousWake, TickType_t increment) {
+    TickType_t wake = *previousWake + increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(wake - now) > 0) {
+        nativeRtosElapse(wake - now);
+    }
+    *previousWake = wake;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Tasks and notifications
+// ──────────────────────────────────────────────────────────────────────────
+
+typedef void (*TaskFunction_t)(void *);
+
+/** @brief What the shim keeps of a task: its name and notification value. */
+struct NativeTask {
+    const char *name;
+    uint32_t    notifyValue;
+};
+typedef NativeTask *TaskHandle_t;
+
+struct StaticTask_t {
+    NativeTask task;
+};
+
+/** @brief The task the test runs in. */
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+    static NativeTask current = { "native", 0 };
+    return &current;
+}
+
+inline TaskHandle_t xTaskCreateStatic(TaskFunction_t, const char *name, uint32_t,
+                                      void *, UBaseType_t, StackType_t *,
+                                      StaticTask_t *tcb) {
+    tcb->task.name = name;
+    tcb->task.notifyValue = 0;
+    return &tcb->task;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t, const char *name, configSTACK_DEPTH_TYPE,
+                              void *, UBaseType_t, TaskHandle_t *handle) {
+    TaskHandle_t task = new NativeTask();
+    task->name = name;
+    task->notifyValue = 0;
+    if (handle != NULL) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+inline char *pcTaskGetName(TaskHandle_t task) {
+    return (char *)((task != NULL) ? task->name : xTaskGetCurrentTaskHandle()->name);
+}
+
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
+
+inline void vTaskSuspendAll() {}
+inline BaseType_t xTaskResumeAll() { return pdFALSE; }
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    task->notifyValue++;
+    return pdPASS;
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    task->notifyValue++;
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t timeout) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (self->notifyValue == 0) {
+        nativeRtosElapse(timeout);
+        return 0;
+    }
+    uint32_t value = self->notifyValue;
+    self->notifyValue = clearOnExit ? 0 : value - 1;
+    return value;
+}
+
+#endif // NATIVE_ARDUINO_FREERTOS_SHIM_H
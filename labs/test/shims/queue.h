@@ -0,0 +1,119 @@
+/**
+ * @file queue.h
+ * @brief FreeRTOS Queue Shim for the Host-Native Build (env:native)
+ *
+ * A queue is a ring of fixed-size items; semaphores (semphr.h) are
+ * queues of zero-size items, as in the kernel. With a single thread a
+ * send to a full queue or a receive from an empty one lets its timeout
+ * pass on the clock and fails (see Arduino_FreeRTOS.h).
+ */
+
+#ifndef NATIVE_QUEUE_SHIM_H
+#define NATIVE_QUEUE_SHIM_H
+
+#include <Arduino_FreeRTOS.h>
+
+/** @brief Queue (or semaphore) state; storage is caller- or heap-owned. */
+struct NativeQueue {
+    uint8_t    *storage;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;       ///< Oldest item
+    UBaseType_t count;
+};
+typedef NativeQueue *QueueHandle_t;
+
+struct StaticQueue_t {
+    NativeQueue queue;
+};
+
+inline QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize,
+                                        uint8_t *storage, StaticQueue_t *block) {
+    NativeQueue *q = &block->queue;
+    q->storage = storage;
+    q->length = length;
+    q->itemSize = itemSize;
+    q->head = 0;
+    q->count = 0;
+    return q;
+}
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    NativeQueue *q = new NativeQueue();
+    q->storage = (itemSize > 0) ? new uint8_t[length * itemSize] : NULL;
+    q->length = length;
+    q->itemSize = itemSize;
+    q->head = 0;
+    q->count = 0;
+    return q;
+}
+
+inline BaseType_t xQueueSendToBack(QueueHandle_t q, const void *item, TickType_t timeout) {
+    if (q->count >= q->length) {
+        nativeRtosElapse(timeout);
+        return errQUEUE_FULL;
+    }
+    if (q->itemSize > 0) {
+        UBaseType_t slot = (q->head + q->count) % q->length;
+        memcpy(q->storage + slot * q->itemSize, item, q->itemSize);
+    }
+    q->count++;
+    return pdPASS;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t timeout) {
+    return xQueueSendToBack(q, item, timeout);
+}
+
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return xQueueSendToBack(q, item, 0);
+}
+
+/** @brief Length-1 mailbox write: replaces the item if full. */
+inline BaseType_t xQueueOverwrite(QueueHandle_t q, const void *item) {
+    if (q->count >= q->length) {
+        q->count = 0;
+    }
+    return xQueueSendToBack(q, item, 0);
+}
+
+inline BaseType_t xQueuePeek(QueueHandle_t q, void *out, TickType_t timeout) {
+    if (q->count == 0) {
+        nativeRtosElapse(timeout);
+        return errQUEUE_EMPTY;
+    }
+    if (q->itemSize > 0) {
+        memcpy(out, q->storage + q->head * q->itemSize, q->itemSize);
+    }
+    return pdPASS;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t q, void *out, TickType_t timeout) {
+    if (xQueuePeek(q, out, timeout) != pdPASS) {
+        return errQUEUE_EMPTY;
+    }
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    return pdPASS;
+}
+
+inline BaseType_t xQueueReceiveFromISR(QueueHandle_t q, void *out, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return xQueueReceive(q, out, 0);
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) { return q->count; }
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) { return q->length - q->count; }
+
+inline BaseType_t xQueueReset(QueueHandle_t q) {
+    q->head = 0;
+    q->count = 0;
+    return pdPASS;
+}
+
+#endif // NATIVE_QUEUE_SHIM_H
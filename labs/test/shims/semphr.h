@@ -0,0 +1,64 @@
+/**
+ * @file semphr.h
+ * @brief FreeRTOS Semaphore Shim for the Host-Native Build (env:native)
+ *
+ * Semaphores are queues of zero-size items (queue.h): the count is the
+ * number of gives outstanding. A mutex starts given and, with a single
+ * thread, a take while it is held means a missing give in the code under
+ * test: the take fails after its timeout instead of deadlocking.
+ */
+
+#ifndef NATIVE_SEMPHR_SHIM_H
+#define NATIVE_SEMPHR_SHIM_H
+
+#include <Arduino_FreeRTOS.h>
+#include <queue.h>
+
+typedef QueueHandle_t SemaphoreHandle_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+inline SemaphoreHandle_t nativeSemaphoreInit(SemaphoreHandle_t s, UBaseType_t max,
+                                             UBaseType_t initial) {
+    s->storage = NULL;
+    s->length = max;
+    s->itemSize = 0;
+    s->head = 0;
+    s->count = initial;
+    return s;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *block) {
+    return nativeSemaphoreInit(&block->queue, 1, 1);
+}
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return nativeSemaphoreInit(new NativeQueue(), 1, 1);
+}
+inline SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *block) {
+    return nativeSemaphoreInit(&block->queue, 1, 0);
+}
+inline SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return nativeSemaphoreInit(new NativeQueue(), 1, 0);
+}
+inline SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max, UBaseType_t initial,
+                                                        StaticSemaphore_t *block) {
+    return nativeSemaphoreInit(&block->queue, max, initial);
+}
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    return nativeSemaphoreInit(new NativeQueue(), max, initial);
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t timeout) {
+    return xQueueReceive(s, NULL, timeout);
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    return xQueueSendToBack(s, NULL, 0);
+}
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t *woken) {
+    return xQueueSendFromISR(s, NULL, woken);
+}
+inline BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t s, BaseType_t *woken) {
+    return xQueueReceiveFromISR(s, NULL, woken);
+}
+inline UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t s) { return s->count; }
+
+#endif // NATIVE_SEMPHR_SHIM_H
@@ -0,0 +1,109 @@
+/**
+ * @file timers.h
+ * @brief FreeRTOS Software Timer Shim for the Host-Native Build (env:native)
+ *
+ * There is no timer task: a test advances the clock and then calls
+ * nativeTimersRun(), which runs the callbacks of the expired timers in
+ * expiry order, as the timer task would. Commands take effect at once.
+ */
+
+#ifndef NATIVE_TIMERS_SHIM_H
+#define NATIVE_TIMERS_SHIM_H
+
+#include <Arduino_FreeRTOS.h>
+
+struct NativeTimer;
+typedef NativeTimer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+struct NativeTimer {
+    const char             *name;
+    TickType_t              period;
+    UBaseType_t             autoReload;
+    void                   *id;
+    TimerCallbackFunction_t callback;
+    TickType_t              expiry;
+    bool                    active;
+    NativeTimer            *next;     ///< Every timer ever created
+};
+
+struct StaticTimer_t {
+    NativeTimer timer;
+};
+
+inline NativeTimer *&nativeTimerList() {
+    static NativeTimer *head = NULL;
+    return head;
+}
+
+inline TimerHandle_t nativeTimerInit(NativeTimer *t, const char *name, TickType_t period,
+                                     UBaseType_t autoReload, void *id,
+                                     TimerCallbackFunction_t callback) {
+    t->name = name;
+    t->period = (period > 0) ? period : 1;
+    t->autoReload = autoReload;
+    t->id = id;
+    t->callback = callback;
+    t->expiry = 0;
+    t->active = false;
+    t->next = nativeTimerList();
+    nativeTimerList() = t;
+    return t;
+}
+
+inline TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t autoReload,
+                                        void *id, TimerCallbackFunction_t callback,
+                                        StaticTimer_t *block) {
+    return nativeTimerInit(&block->timer, name, period, autoReload, id, callback);
+}
+
+inline TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload,
+                                  void *id, TimerCallbackFunction_t callback) {
+    return nativeTimerInit(new NativeTimer(), name, period, autoReload, id, callback);
+}
+
+inline BaseType_t xTimerStart(TimerHandle_t t, TickType_t) {
+    t->expiry = xTaskGetTickCount() + t->period;
+    t->active = true;
+    return pdPASS;
+}
+inline BaseType_t xTimerReset(TimerHandle_t t, TickType_t wait) { return xTimerStart(t, wait); }
+
+inline BaseType_t xTimerChangePeriod(TimerHandle_t t, TickType_t period, TickType_t wait) {
+    t->period = (period > 0) ? period : 1;
+    return xTimerStart(t, wait);
+}
+
+inline BaseType_t xTimerStop(TimerHandle_t t, TickType_t) {
+    t->active = false;
+    return pdPASS;
+}
+
+inline BaseType_t xTimerIsTimerActive(TimerHandle_t t) { return t->active ? pdTRUE : pdFALSE; }
+inline void *pvTimerGetTimerID(TimerHandle_t t) { return t->id; }
+inline const char *pcTimerGetName(TimerHandle_t t) { return t->name; }
+
+/** @brief Run every expired timer's callback, earliest expiry first. */
+inline void nativeTimersRun() {
+    for (;;) {
+        TickType_t now = xTaskGetTickCount();
+        NativeTimer *due = NULL;
+        for (NativeTimer *t = nativeTimerList(); t != NULL; t = t->next) {
+            if (t->active && (int32_t)(now - t->expiry) >= 0 &&
+                (due == NULL || (int32_t)(t->expiry - due->expiry) < 0)) {
+                due = t;
+            }
+        }
+        if (due == NULL) {
+            return;
+        }
+        if (due->autoReload) {
+            due->expiry += due->period;
+        } else {
+            due->active = false;
+        }
+        due->callback(due);
+    }
+}
+
+#endif // NATIVE_TIMERS_SHIM_H
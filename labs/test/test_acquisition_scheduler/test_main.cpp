@@ -0,0 +1,167 @@
+/**
+ * @file test_main.cpp
+ * @brief AcquisitionScheduler — request placement and collect timing (env:native)
+ *
+ * The scheduler counts periods only, so the tests drive beginCycle()
+ * and check which cycle, and at which offset, each request and result
+ * falls.
+ */
+
+#include <unity.h>
+
+#include "AcquisitionScheduler.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+/** Run cycles until @p source is collected; returns that cycle (0: never). */
+static uint32_t cyclesUntilCollect(AcquisitionScheduler &sched, uint8_t source, uint32_t limit) {
+    for (uint32_t i = 0; i < limit; i++) {
+        sched.beginCycle();
+        bool collected = sched.collect(source);
+        uint8_t s;
+        uint16_t offset;
+        while (sched.nextRequest(&s, &offset)) {}      // As the task: after the read
+        if (collected) {
+            return sched.getCycle();
+        }
+    }
+    return 0;
+}
+
+static void test_plan_follows_latency_and_guard() {
+    AcquisitionScheduler sched(50, 16);
+    int8_t ds = sched.addSource(188 + 12);      // DS18B20 10 bit + read
+    TEST_ASSERT_EQUAL_INT8(0, ds);
+    TEST_ASSERT_EQUAL_UINT16(5, sched.getLeadPeriods(0));
+    TEST_ASSERT_EQUAL_UINT16(34, sched.getOffsetMs(0));     // 250 - 216
+    TEST_ASSERT_EQUAL_UINT16(5, sched.getEveryPeriods(0));
+
+    sched.setLatency(0, 94 + 12);                           // 9 bit
+    TEST_ASSERT_EQUAL_UINT16(3, sched.getLeadPeriods(0));
+    TEST_ASSERT_EQUAL_UINT16(28, sched.getOffsetMs(0));
+}
+
+static void test_min_interval_spaces_requests() {
+    AcquisitionScheduler sched(250, 0);
+    sched.addSource(5, 1000);                   // DHT: fast read, 1 s apart
+    TEST_ASSERT_EQUAL_UINT16(1, sched.getLeadPeriods(0));
+    TEST_ASSERT_EQUAL_UINT16(245, sched.getOffsetMs(0));
+    TEST_ASSERT_EQUAL_UINT16(4, sched.getEveryPeriods(0));
+
+    uint8_t requests = 0;
+    for (uint8_t i = 0; i < 12; i++) {
+        sched.beginCycle();
+        sched.collect(0);
+        uint8_t s;
+        uint16_t offset;
+        while (sched.nextRequest(&s, &offset)) {
+            requests++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT8(3, requests);       // Cycles 1, 5, 9
+}
+
+static void test_min_interval_change_moves_the_next_request() {
+    AcquisitionScheduler sched(50, 0);
+    sched.addSource(100);                       // Every 2 cycles
+    uint8_t s;
+    uint16_t offset;
+
+    sched.beginCycle();                         // Cycle 1: request
+    TEST_ASSERT_TRUE(sched.nextRequest(&s, &offset));
+    sched.setMinInterval(0, 500);               // Relaxed: every 10
+    TEST_ASSERT_EQUAL_UINT16(10, sched.getEveryPeriods(0));
+    for (uint8_t c = 2; c <= 10; c++) {
+        sched.beginCycle();
+        sched.collect(0);
+        TEST_ASSERT_FALSE(sched.nextRequest(&s, &offset));
+    }
+    sched.beginCycle();                         // Cycle 11
+    TEST_ASSERT_TRUE(sched.nextRequest(&s, &offset));
+
+    for (uint8_t c = 12; c <= 15; c++) {
+        sched.beginCycle();
+        sched.collect(0);
+        TEST_ASSERT_FALSE(sched.nextRequest(&s, &offset));
+    }
+    sched.setMinInterval(0, 0);                 // Back to fast: overdue now
+    TEST_ASSERT_TRUE(sched.nextRequest(&s, &offset));
+}
+
+static void test_result_due_lead_cycles_after_request() {
+    AcquisitionScheduler sched(50, 16);
+    sched.addSource(200);
+
+    sched.beginCycle();
+    uint8_t s;
+    uint16_t offset;
+    TEST_ASSERT_TRUE(sched.nextRequest(&s, &offset));
+    TEST_ASSERT_FALSE(sched.nextRequest(&s, &offset));    // One per source
+    TEST_ASSERT_EQUAL_UINT32(1 + sched.getLeadPeriods(0),
+                             cyclesUntilCollect(sched, 0, 20));
+
+    // Steady state: one result every `every` cycles.
+    uint32_t first = cyclesUntilCollect(sched, 0, 20);
+    uint32_t second = cyclesUntilCollect(sched, 0, 20);
+    TEST_ASSERT_EQUAL_UINT32(sched.getEveryPeriods(0), second - first);
+}
+
+static void test_requests_in_offset_order() {
+    AcquisitionScheduler sched(100, 0);
+    sched.addSource(60);                        // Offset 40
+    sched.addSource(90);                        // Offset 10
+    sched.beginCycle();
+
+    uint8_t s;
+    uint16_t offset;
+    TEST_ASSERT_TRUE(sched.nextRequest(&s, &offset));
+    TEST_ASSERT_EQUAL_UINT8(1, s);
+    TEST_ASSERT_EQUAL_UINT16(10, offset);
+    TEST_ASSERT_TRUE(sched.nextRequest(&s, &offset));
+    TEST_ASSERT_EQUAL_UINT8(0, s);
+    TEST_ASSERT_EQUAL_UINT16(40, offset);
+    TEST_ASSERT_FALSE(sched.nextRequest(&s, &offset));
+}
+
+static void test_postpone_and_request_before_start() {
+    AcquisitionScheduler sched(50, 0);
+    sched.addSource(100);                       // Lead 2
+    sched.markRequested(0);                     // Started from setup()
+
+    uint8_t s;
+    uint16_t offset;
+    sched.beginCycle();
+    TEST_ASSERT_FALSE(sched.collect(0));
+    TEST_ASSERT_FALSE(sched.nextRequest(&s, &offset));    // Still outstanding
+    sched.beginCycle();
+    TEST_ASSERT_TRUE(sched.collect(0));
+
+    sched.postpone(0);                          // Sensor said not ready
+    TEST_ASSERT_FALSE(sched.nextRequest(&s, &offset));
+    sched.beginCycle();
+    TEST_ASSERT_TRUE(sched.collect(0));
+    TEST_ASSERT_TRUE(sched.nextRequest(&s, &offset));
+}
+
+static void test_rejects_sources_beyond_capacity() {
+    AcquisitionScheduler sched(50);
+    for (uint8_t i = 0; i < ACQ_SCHEDULER_MAX_SOURCES; i++) {
+        TEST_ASSERT_EQUAL_INT8(i, sched.addSource(10));
+    }
+    TEST_ASSERT_EQUAL_INT8(-1, sched.addSource(10));
+    TEST_ASSERT_EQUAL_UINT8(ACQ_SCHEDULER_MAX_SOURCES, sched.getSourceCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_plan_follows_latency_and_guard);
+    RUN_TEST(test_min_interval_spaces_requests);
+    RUN_TEST(test_min_interval_change_moves_the_next_request);
+    RUN_TEST(test_result_due_lead_cycles_after_request);
+    RUN_TEST(test_requests_in_offset_order);
+    RUN_TEST(test_postpone_and_request_before_start);
+    RUN_TEST(test_rejects_sources_beyond_capacity);
+    return UNITY_END();
+}
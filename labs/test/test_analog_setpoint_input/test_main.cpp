@@ -0,0 +1,89 @@
+/**
+ * @file test_main.cpp
+ * @brief AnalogSetpointInput — linear map, step snapping and hysteresis (env:native)
+ *
+ * The pot spans 15..35 °C in 0.5 °C steps: 40 steps of 25.575 counts,
+ * step k centered at 25.575 k, with a 25 % (6.4 count) dead band past
+ * each half-step boundary.
+ */
+
+#include <unity.h>
+
+#include "AnalogSetpointInput.h"
+
+static const uint8_t POT_PIN = A0;
+
+void setUp() {
+    nativeReset();
+}
+
+void tearDown() {}
+
+static float readAt(AnalogSetpointInput &pot, uint16_t counts) {
+    nativeSetAnalog(POT_PIN, counts);
+    return pot.readValue();
+}
+
+static void test_continuous_map_by_default() {
+    AnalogSetpointInput pot(POT_PIN, 15.0f, 35.0f);
+    pot.init();
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, readAt(pot, 0));
+    TEST_ASSERT_EQUAL_FLOAT(35.0f, readAt(pot, 1023));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 25.01f, readAt(pot, 512));
+    TEST_ASSERT_EQUAL_UINT16(512, pot.getLastRaw());
+}
+
+static void test_snaps_to_steps() {
+    AnalogSetpointInput pot(POT_PIN, 15.0f, 35.0f);
+    pot.init();
+    pot.setQuantization(0.5f, 3, 25);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, readAt(pot, 512));
+    TEST_ASSERT_EQUAL_UINT16(512, pot.getLastRaw());     // Average of the 8 reads
+
+    pot.init();
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, readAt(pot, 3));
+    pot.init();
+    TEST_ASSERT_EQUAL_FLOAT(35.0f, readAt(pot, 1023));
+}
+
+static void test_dead_band_holds_the_step() {
+    AnalogSetpointInput pot(POT_PIN, 15.0f, 35.0f);
+    pot.init();
+    pot.setQuantization(0.5f, 3, 25);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, readAt(pot, 512));
+
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, readAt(pot, 526));     // Past 524.3, inside the band
+    TEST_ASSERT_EQUAL_FLOAT(25.5f, readAt(pot, 531));     // Past 530.7
+    TEST_ASSERT_EQUAL_FLOAT(25.5f, readAt(pot, 520));     // Back inside the band
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, readAt(pot, 517));     // Past 517.9 downwards
+}
+
+static void test_noise_at_a_boundary_does_not_toggle() {
+    AnalogSetpointInput pot(POT_PIN, 15.0f, 35.0f);
+    pot.init();
+    pot.setQuantization(0.5f, 3, 25);
+    float first = readAt(pot, 524);
+    for (uint8_t i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(first, readAt(pot, (i & 1) ? 522 : 527));
+    }
+}
+
+static void test_set_range_replans_steps() {
+    AnalogSetpointInput pot(POT_PIN, 15.0f, 35.0f);
+    pot.init();
+    pot.setQuantization(0.5f, 0, 25);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, readAt(pot, 512));
+
+    pot.setRange(18.0f, 35.0f);                 // 34 steps
+    TEST_ASSERT_EQUAL_FLOAT(26.5f, readAt(pot, 512));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_continuous_map_by_default);
+    RUN_TEST(test_snaps_to_steps);
+    RUN_TEST(test_dead_band_holds_the_step);
+    RUN_TEST(test_noise_at_a_boundary_does_not_toggle);
+    RUN_TEST(test_set_range_replans_steps);
+    return UNITY_END();
+}
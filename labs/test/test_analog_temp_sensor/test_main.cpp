@@ -0,0 +1,136 @@
+/**
+ * @file test_main.cpp
+ * @brief AnalogTempSensor — single-ended and bridge conversions, lookup tables (env:native)
+ *
+ * Off target a bridge reading is analogRead() of the pin taken as the
+ * offset-binary count, so nativeSetAnalog() feeds both modes.
+ */
+
+#include <unity.h>
+#include <math.h>
+
+#include "AnalogTempSensor.h"
+
+static const float REF_RATIO = 0.5f;
+
+static int16_t s_lut[AnalogTempSensor::LUT_ENTRIES];
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_bridge_round_trip_and_resolution() {
+    AnalogTempSensor single(A1, 10000, 10000, 3950);
+    AnalogTempSensor bridge(A1, 10000, 10000, 3950);
+    TEST_ASSERT_TRUE(bridge.useBridge(A0, 10, REF_RATIO, 2));
+    TEST_ASSERT_TRUE(bridge.usesBridge());
+    bridge.init();
+
+    // R = R_series at 25 °C: the bridge is balanced, mid scale of 12 bits
+    TEST_ASSERT_EQUAL_UINT16(2048, bridge.rawAtTemperatureC(25.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 25.0f, bridge.convertRawC(2048));
+    for (float t = 18.0f; t <= 32.0f; t += 2.0f) {
+        uint16_t raw = bridge.rawAtTemperatureC(t);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, t, bridge.convertRawC(raw));
+    }
+    // Counts still fall as it warms, and 20× as many per °C at 10× and 4 sums
+    uint16_t b28 = bridge.rawAtTemperatureC(28.0f);
+    uint16_t b30 = bridge.rawAtTemperatureC(30.0f);
+    uint16_t s28 = single.rawAtTemperatureC(28.0f);
+    uint16_t s30 = single.rawAtTemperatureC(30.0f);
+    TEST_ASSERT_TRUE(b30 < b28);
+    TEST_ASSERT_TRUE((b28 - b30) >= 18 * (s28 - s30));
+}
+
+static void test_bridge_span_and_rails() {
+    AnalogTempSensor bridge(A1, 10000, 10000, 3950);
+    TEST_ASSERT_TRUE(bridge.useBridge(A0, 10, REF_RATIO, 0));
+    bridge.init();
+
+    // x in [0.4, 0.6): R 6.67k .. 15k, about 34 .. 16 °C
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 34.0f, bridge.convertRawC(1));
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 16.0f, bridge.convertRawC(1022));
+    TEST_ASSERT_TRUE(isnan(bridge.convertRawC(0)));
+    TEST_ASSERT_TRUE(isnan(bridge.convertRawC(1023)));
+    TEST_ASSERT_EQUAL_UINT16(1, bridge.rawAtTemperatureC(60.0f));     // Beyond the span
+    TEST_ASSERT_EQUAL_UINT16(1022, bridge.rawAtTemperatureC(0.0f));
+
+    nativeSetAnalog(A1, 512);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 25.0f, bridge.readTemperatureC());
+    TEST_ASSERT_TRUE(bridge.isValid());
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 10000.0f, bridge.getLastResistance());
+    nativeSetAnalog(A1, 1023);                                          // Clipped
+    TEST_ASSERT_TRUE(isnan(bridge.readTemperatureC()));
+    TEST_ASSERT_FALSE(bridge.isValid());
+    TEST_ASSERT_TRUE(bridge.calibrateBridgeOffset());
+    TEST_ASSERT_EQUAL_INT16(0, bridge.getBridgeOffset());
+}
+
+static void test_bridge_lookup_table_keeps_resolution() {
+    AnalogTempSensor equation(A3, 10000, 10000, 3950);
+    AnalogTempSensor table(A3, 10000, 10000, 3950);
+    TEST_ASSERT_TRUE(equation.useBridge(A2, 10, REF_RATIO, 4));
+    TEST_ASSERT_TRUE(table.useBridge(A2, 10, REF_RATIO, 4));
+    table.useLookupTable(s_lut);
+    equation.init();
+    table.init();
+    TEST_ASSERT_TRUE(table.usesLookupTable());
+
+    // 14-bit counts, ≈ 0.001 °C each: the table must not round to 0.01 °C
+    float worst = 0.0f;
+    for (uint32_t raw = 16; raw < 16383; raw += 23) {
+        float err = fabsf(table.convertRawC((uint16_t)raw) - equation.convertRawC((uint16_t)raw));
+        if (err > worst) worst = err;
+    }
+    TEST_ASSERT_TRUE(worst < 0.002f);
+    float step = table.convertRawC(8193) - table.convertRawC(8192);
+    TEST_ASSERT_TRUE(step < 0.0f && step > -0.005f);
+
+    // 200×: a ±0.5 °C window
+    AnalogTempSensor fine(A9, 10000, 10000, 3950);
+    TEST_ASSERT_TRUE(fine.useBridge(A8, 200, REF_RATIO, 0));
+    fine.useLookupTable(s_lut);
+    fine.init();
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 25.0f, fine.convertRawC(512));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 24.5f, fine.convertRawC(1022));
+}
+
+static void test_bridge_rejects_unsupported_setups() {
+    AnalogTempSensor ntc(A1, 10000, 10000, 3950);
+    uint16_t singleEnded = ntc.rawAtTemperatureC(30.0f);
+    TEST_ASSERT_FALSE(ntc.useBridge(A2, 10, REF_RATIO, 0));     // Not A1's pair
+    TEST_ASSERT_FALSE(ntc.useBridge(A0, 1, REF_RATIO, 0));      // No gain stage at 1×
+    TEST_ASSERT_FALSE(ntc.useBridge(A0, 10, 0.95f, 0));         // Span leaves the divider
+    TEST_ASSERT_FALSE(ntc.useBridge(A0, 10, REF_RATIO, 7));     // Beyond 16 bits
+    TEST_ASSERT_FALSE(ntc.usesBridge());
+    TEST_ASSERT_EQUAL_UINT16(singleEnded, ntc.rawAtTemperatureC(30.0f));
+
+    AnalogTempSensor swapped(A0, 10000, 10000, 3950);            // NTC must be positive
+    TEST_ASSERT_FALSE(swapped.useBridge(A1, 10, REF_RATIO, 0));
+    AnalogTempSensor upper(A11, 10000, 10000, 3950);
+    TEST_ASSERT_TRUE(upper.useBridge(A10, 200, REF_RATIO, 0));
+}
+
+static void test_single_ended_table_unchanged() {
+    AnalogTempSensor equation(A0, 10000, 10000, 3950);
+    AnalogTempSensor table(A0, 10000, 10000, 3950);
+    table.useLookupTable(s_lut);
+    equation.init();
+    table.init();
+    TEST_ASSERT_EQUAL_INT16((int16_t)lroundf(equation.convertRawC(512) * 100.0f), s_lut[32]);
+    for (uint16_t raw = 100; raw < 1000; raw += 50) {
+        TEST_ASSERT_FLOAT_WITHIN(0.1f, equation.convertRawC(raw), table.convertRawC(raw));
+    }
+    AnalogTempSensor wide(A0, 10000, 10000, 3950, 25.0f, 16);   // 16 bits no longer overflows
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 25.0f, wide.convertRawC(32768));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_bridge_round_trip_and_resolution);
+    RUN_TEST(test_bridge_span_and_rails);
+    RUN_TEST(test_bridge_lookup_table_keeps_resolution);
+    RUN_TEST(test_bridge_rejects_unsupported_setups);
+    RUN_TEST(test_single_ended_table_unchanged);
+    return UNITY_END();
+}
@@ -0,0 +1,153 @@
+/**
+ * @file test_main.cpp
+ * @brief Host Micro-Benchmarks of the Library Hot Paths (env:native)
+ *
+ * Times the same calls as env:bench, on the PC: nanoseconds per call,
+ * best of BENCH_ROUNDS rounds of BENCH_CALLS calls. Host numbers say
+ * nothing absolute about the ATmega2560 (use env:bench for cycle
+ * counts), but they are stable enough to compare two versions of an
+ * algorithm in seconds, without flashing a board.
+ *
+ * Each case prints a NATIVE_BENCH,<name>,<ns_per_call> line. The ceilings
+ * are deliberately generous (orders of magnitude above a normal run) so
+ * the suite only fails for a real algorithmic regression — a hot path
+ * that suddenly loops or allocates — and not on a slow CI machine.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <chrono>
+
+#include "CommandParser.h"
+#include "LockFSM.h"
+#include "OnOffHysteresisController.h"
+#include "PidController.h"
+#include "SignalConditioner.h"
+#include "ThresholdAlert.h"
+
+static const uint32_t BENCH_CALLS  = 20000;
+static const uint8_t  BENCH_ROUNDS = 5;
+
+/** Result sink: keeps every call's value observable. */
+static volatile float s_sink;
+
+typedef void (*BenchFunction)(uint32_t step);
+
+/** Best-of-rounds time per call, in ns; prints the NATIVE_BENCH line. */
+static double benchNsPerCall(const char *name, BenchFunction fn) {
+    double best = 1e30;
+    for (uint8_t round = 0; round < BENCH_ROUNDS; round++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+            fn(i);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        double perCall = elapsed.count() / BENCH_CALLS;
+        if (perCall < best) {
+            best = perCall;
+        }
+    }
+    printf("NATIVE_BENCH,%s,%.1f\n", name, best);
+    return best;
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Cases (inputs vary per call, as in env:bench)
+// ──────────────────────────────────────────────────────────────────────────
+
+static SignalConditioner          s_conditioner(5, 0.2f, -40.0f, 125.0f);
+static PidController              s_pid(2.0f, 0.5f, 0.1f, 0.0f, 255.0f);
+static ThresholdAlert             s_alert(30.0f, 25.0f, 3);
+static OnOffHysteresisController  s_onOff(50.0f, 4.0f);
+static LockFSM                    s_lock;
+
+static void signalProcess(uint32_t step) {
+    float raw = 20.0f + (float)(step & 0x3F) * 0.1f;
+    if ((step & 0x07) == 0) {
+        raw += 30.0f;
+    }
+    s_sink = s_conditioner.process(raw);
+}
+
+static void pidUpdate(uint32_t step) {
+    s_sink = s_pid.update(25.0f, 20.0f + (float)(step & 0x1F) * 0.25f, 0.1f);
+}
+
+static void alertUpdate(uint32_t step) {
+    s_sink = (float)s_alert.update(20.0f + (float)(step & 0x1F) * 0.5f, step * 100u);
+}
+
+static void hysteresisUpdate(uint32_t step) {
+    s_sink = s_onOff.update(40.0f + (float)(step & 0x1F) * 0.6f) ? 1.0f : 0.0f;
+}
+
+static void parse(uint32_t step) {
+    static const char *const INPUTS[] = { "led on", "LED OFF", "  led   on ", "blink" };
+    s_sink = (float)parseCommand(INPUTS[step & 0x03]);
+}
+
+static void lockKey(uint32_t step) {
+    static const char KEYS[] = "*3#";
+    s_lock.processKey(KEYS[step % 3]);
+    s_sink = (float)s_lock.getState();
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Tests
+// ──────────────────────────────────────────────────────────────────────────
+
+void setUp() { nativeReset(); }
+void tearDown() {}
+
+static void test_bench_signal_process() {
+    s_conditioner.reset();
+    TEST_ASSERT_LESS_THAN(5000.0, benchNsPerCall("signal_process", signalProcess));
+}
+
+static void test_bench_pid_update() {
+    s_pid.init();
+    TEST_ASSERT_LESS_THAN(5000.0, benchNsPerCall("pid_update", pidUpdate));
+}
+
+static void test_bench_alert_update() {
+    s_alert.init();
+    TEST_ASSERT_LESS_THAN(5000.0, benchNsPerCall("alert_update", alertUpdate));
+}
+
+static void test_bench_hysteresis_update() {
+    s_onOff.init();
+    TEST_ASSERT_LESS_THAN(5000.0, benchNsPerCall("hysteresis_update", hysteresisUpdate));
+}
+
+static void test_bench_parse_command() {
+    TEST_ASSERT_LESS_THAN(5000.0, benchNsPerCall("parse_command", parse));
+}
+
+static void test_bench_lock_key() {
+    s_lock.init();
+    // processKey() logs every key; keep that I/O out of the timing.
+    FILE *saved = stdout;
+    FILE *null = fopen("/dev/null", "w");
+    if (null != NULL) {
+        stdout = null;
+    }
+    double ns = benchNsPerCall("lock_key", lockKey);
+    if (null != NULL) {
+        stdout = saved;
+        fclose(null);
+    }
+    printf("NATIVE_BENCH,lock_key,%.1f\n", ns);
+    TEST_ASSERT_LESS_THAN(50000.0, ns);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_signal_process);
+    RUN_TEST(test_bench_pid_update);
+    RUN_TEST(test_bench_alert_update);
+    RUN_TEST(test_bench_hysteresis_update);
+    RUN_TEST(test_bench_parse_command);
+    RUN_TEST(test_bench_lock_key);
+    return UNITY_END();
+}
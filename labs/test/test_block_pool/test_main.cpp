@@ -0,0 +1,113 @@
+/**
+ * @file test_main.cpp
+ * @brief BlockPool — O(1) free list, guarded release, high-water mark and
+ *        pointer hand-off through a queue (env:native)
+ */
+
+#include <unity.h>
+
+#include <Arduino_FreeRTOS.h>
+#include <queue.h>
+
+#include "BlockPool.h"
+
+struct Record {
+    uint32_t sequence;
+    float    value[3];
+};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_allocates_every_block_then_fails() {
+    BlockPool<Record, 3> pool;
+    Record *a = pool.allocate();
+    Record *b = pool.allocate();
+    Record *c = pool.allocate();
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_TRUE(a != b && b != c && a != c);
+    TEST_ASSERT_EQUAL_UINT8(3, pool.inUse());
+    TEST_ASSERT_EQUAL_UINT8(0, pool.available());
+
+    TEST_ASSERT_NULL(pool.allocate());
+    TEST_ASSERT_EQUAL_UINT16(1, pool.failures());
+
+    // The last block released is the next one handed out
+    TEST_ASSERT_TRUE(pool.release(b));
+    TEST_ASSERT_EQUAL_PTR(b, pool.allocate());
+}
+
+static void test_release_refuses_foreign_and_free_blocks() {
+    BlockPool<Record, 2> pool;
+    Record outside;
+    Record *a = pool.allocate();
+    TEST_ASSERT_FALSE(pool.release(NULL));
+    TEST_ASSERT_FALSE(pool.release(&outside));
+    TEST_ASSERT_FALSE(pool.release((Record *)((uint8_t *)a + 1)));   // Not a block start
+    TEST_ASSERT_FALSE(pool.owns(&outside));
+    TEST_ASSERT_TRUE(pool.owns(a));
+
+    TEST_ASSERT_TRUE(pool.release(a));
+    TEST_ASSERT_FALSE(pool.release(a));                             // Double release
+    TEST_ASSERT_EQUAL_UINT8(0, pool.inUse());
+
+    // The list survived: both blocks still come out, once each
+    Record *x = pool.allocate();
+    Record *y = pool.allocate();
+    TEST_ASSERT_NOT_NULL(x);
+    TEST_ASSERT_NOT_NULL(y);
+    TEST_ASSERT_TRUE(x != y);
+    TEST_ASSERT_NULL(pool.allocate());
+}
+
+static void test_high_water_mark() {
+    BlockPool<Record, 4> pool;
+    Record *r[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        r[i] = pool.allocate();
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        pool.release(r[i]);
+    }
+    pool.release(pool.allocate());
+    TEST_ASSERT_EQUAL_UINT8(3, pool.highWater());
+    TEST_ASSERT_EQUAL_UINT8(0, pool.inUse());
+
+    Record *held = pool.allocate();
+    pool.resetHighWater();
+    TEST_ASSERT_EQUAL_UINT8(1, pool.highWater());
+    pool.release(held);
+    TEST_ASSERT_EQUAL_UINT8(1, pool.highWater());
+}
+
+static void test_blocks_move_through_a_queue_by_pointer() {
+    BlockPool<Record, 4> pool;
+    QueueHandle_t queue = xQueueCreate(4, sizeof(Record *));
+    TEST_ASSERT_NOT_NULL(queue);
+
+    for (uint32_t seq = 1; seq <= 10; seq++) {
+        Record *out = pool.allocate();
+        TEST_ASSERT_NOT_NULL(out);
+        out->sequence = seq;
+        out->value[0] = (float)seq * 0.5f;
+        TEST_ASSERT_EQUAL(pdTRUE, xQueueSend(queue, &out, 0));
+
+        Record *in = NULL;
+        TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(queue, &in, 0));
+        TEST_ASSERT_EQUAL_PTR(out, in);                             // The same block, not a copy
+        TEST_ASSERT_EQUAL_UINT32(seq, in->sequence);
+        TEST_ASSERT_TRUE(pool.release(in));
+    }
+    TEST_ASSERT_EQUAL_UINT8(1, pool.highWater());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_allocates_every_block_then_fails);
+    RUN_TEST(test_release_refuses_foreign_and_free_blocks);
+    RUN_TEST(test_high_water_mark);
+    RUN_TEST(test_blocks_move_through_a_queue_by_pointer);
+    return UNITY_END();
+}
@@ -0,0 +1,50 @@
+/**
+ * @file test_main.cpp
+ * @brief ButtonLedFsm — press toggles the LED state (env:native)
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "ButtonLedFsm.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_starts_off() {
+    ButtonLedFsm fsm;
+    fsm.init();
+    TEST_ASSERT_EQUAL(LED_OFF_STATE, fsm.getState());
+    TEST_ASSERT_EQUAL_UINT8(LOW, fsm.getOutput());
+    TEST_ASSERT_EQUAL_STRING("OFF", fsm.getStateName());
+}
+
+static void test_press_toggles() {
+    ButtonLedFsm fsm;
+    fsm.init();
+    fsm.processEvent();
+    TEST_ASSERT_EQUAL(LED_ON_STATE, fsm.getState());
+    TEST_ASSERT_EQUAL_UINT8(HIGH, fsm.getOutput());
+    TEST_ASSERT_EQUAL_STRING("ON", fsm.getStateName());
+    fsm.processEvent();
+    TEST_ASSERT_EQUAL(LED_OFF_STATE, fsm.getState());
+}
+
+static void test_changed_flag() {
+    ButtonLedFsm fsm;
+    fsm.init();
+    fsm.clearChanged();
+    TEST_ASSERT_FALSE(fsm.changed());
+    fsm.processEvent();
+    TEST_ASSERT_TRUE(fsm.changed());
+    fsm.clearChanged();
+    TEST_ASSERT_FALSE(fsm.changed());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_off);
+    RUN_TEST(test_press_toggles);
+    RUN_TEST(test_changed_flag);
+    return UNITY_END();
+}
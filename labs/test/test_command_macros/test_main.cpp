@@ -0,0 +1,125 @@
+/**
+ * @file test_main.cpp
+ * @brief CommandMacros — define, replace, run and persist (env:native)
+ */
+
+#include <unity.h>
+
+#include "CommandMacros.h"
+
+#include <string.h>
+
+static int32_t s_setpoint;
+static uint8_t s_subscribed;
+
+static const uint16_t MACRO_ADDR = 1024;
+static const uint8_t MACRO_SLOTS = 3;
+
+static CommandMacros *s_active;
+
+static void onSetpoint(const CommandArg *args, uint8_t, void *) {
+    s_setpoint = args[0].i;
+}
+
+static void onSub(const CommandArg *, uint8_t, void *) {
+    s_subscribed++;
+}
+
+static void onRun(const CommandArg *args, uint8_t, void *);
+
+static const CommandEntry COMMANDS[] PROGMEM = {
+    COMMAND_ENTRY("sp",  onSetpoint, "i"),
+    COMMAND_ENTRY("sub", onSub,      "wi"),
+    COMMAND_ENTRY("run", onRun,      "w"),
+};
+
+static const uint8_t COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+static CommandStatus s_innerStatus;
+
+static void onRun(const CommandArg *args, uint8_t, void *) {
+    s_innerStatus = s_active->run(args[0].text, args[0].len, COMMANDS, COMMAND_COUNT, NULL, NULL);
+}
+
+static bool define(CommandMacros &macros, const char *name, const char *text) {
+    return macros.define(name, (uint8_t)strlen(name), text, (uint8_t)strlen(text));
+}
+
+void setUp() {
+    s_setpoint = 0;
+    s_subscribed = 0;
+    s_innerStatus = COMMAND_EMPTY;
+    CommandMacros macros(MACRO_ADDR, MACRO_SLOTS);
+    const char *names[] = { "warm", "cool", "watch", "a", "b", "c" };
+    for (uint8_t i = 0; i < 6; i++) {
+        macros.remove(names[i], (uint8_t)strlen(names[i]));
+    }
+}
+
+void tearDown() {}
+
+static void test_define_and_run() {
+    CommandMacros macros(MACRO_ADDR, MACRO_SLOTS);
+    TEST_ASSERT_TRUE(define(macros, "warm", "sp 26; sub temp 500; sub duty 500"));
+    TEST_ASSERT_EQUAL(COMMAND_OK, macros.run("WARM", 4, COMMANDS, COMMAND_COUNT, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT32(26, s_setpoint);
+    TEST_ASSERT_EQUAL_UINT8(2, s_subscribed);
+    TEST_ASSERT_EQUAL(COMMAND_NOT_FOUND, macros.run("cold", 4, COMMANDS, COMMAND_COUNT, NULL, NULL));
+}
+
+static void test_redefine_replaces_and_survives_reset() {
+    {
+        CommandMacros macros(MACRO_ADDR, MACRO_SLOTS);
+        TEST_ASSERT_TRUE(define(macros, "cool", "sp 20"));
+        TEST_ASSERT_TRUE(define(macros, "Cool", "sp 19"));
+        TEST_ASSERT_EQUAL_UINT8(1, macros.getCount());
+    }
+    CommandMacros afterReset(MACRO_ADDR, MACRO_SLOTS);
+    char text[COMMAND_MACRO_TEXT_MAX + 1];
+    TEST_ASSERT_TRUE(afterReset.load("cool", 4, text));
+    TEST_ASSERT_EQUAL_STRING("sp 19", text);
+}
+
+static void test_limits_and_full_store() {
+    CommandMacros macros(MACRO_ADDR, MACRO_SLOTS);
+    char longText[COMMAND_MACRO_TEXT_MAX + 2];
+    memset(longText, 'x', sizeof(longText) - 1);
+    longText[sizeof(longText) - 1] = '\0';
+    TEST_ASSERT_FALSE(define(macros, "toolongname", "sp 1"));
+    TEST_ASSERT_FALSE(define(macros, "a", longText));
+    TEST_ASSERT_FALSE(define(macros, "a", ""));
+
+    TEST_ASSERT_TRUE(define(macros, "a", "sp 1"));
+    TEST_ASSERT_TRUE(define(macros, "b", "sp 2"));
+    TEST_ASSERT_TRUE(define(macros, "c", "sp 3"));
+    TEST_ASSERT_FALSE(define(macros, "watch", "sp 4"));
+    TEST_ASSERT_TRUE(macros.remove("b", 1));
+    TEST_ASSERT_FALSE(macros.remove("b", 1));
+    TEST_ASSERT_TRUE(define(macros, "watch", "sp 4"));
+    TEST_ASSERT_EQUAL_UINT8(3, macros.getCount());
+}
+
+static void test_failing_batch_and_nesting_run_nothing() {
+    CommandMacros macros(MACRO_ADDR, MACRO_SLOTS);
+    s_active = &macros;
+    TEST_ASSERT_TRUE(define(macros, "a", "sp 30; sub temp"));
+    uint8_t failedAt = 0;
+    TEST_ASSERT_EQUAL(COMMAND_BAD_ARGS, macros.run("a", 1, COMMANDS, COMMAND_COUNT, NULL, &failedAt));
+    TEST_ASSERT_EQUAL_UINT8(1, failedAt);
+    TEST_ASSERT_EQUAL_INT32(0, s_setpoint);
+
+    TEST_ASSERT_TRUE(define(macros, "b", "sp 31; run b"));
+    TEST_ASSERT_EQUAL(COMMAND_OK, macros.run("b", 1, COMMANDS, COMMAND_COUNT, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT32(31, s_setpoint);
+    TEST_ASSERT_EQUAL(COMMAND_BAD_ARGS, s_innerStatus);
+    TEST_ASSERT_FALSE(macros.isRunning());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_define_and_run);
+    RUN_TEST(test_redefine_replaces_and_survives_reset);
+    RUN_TEST(test_limits_and_full_store);
+    RUN_TEST(test_failing_batch_and_nesting_run_nothing);
+    return UNITY_END();
+}
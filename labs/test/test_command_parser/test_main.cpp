@@ -0,0 +1,167 @@
+/**
+ * @file test_main.cpp
+ * @brief CommandParser — table lookup, arguments, streaming and batches (env:native)
+ */
+
+#include <unity.h>
+
+#include "CommandParser.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int32_t s_lastPwm;
+static uint8_t s_ledOnCalls;
+static char s_order[8];
+static char s_saved[40];
+
+static void onLedOn(const CommandArg *, uint8_t, void *) {
+    s_ledOnCalls++;
+    strcat(s_order, "L");
+}
+
+static void onPwm(const CommandArg *args, uint8_t, void *) {
+    s_lastPwm = args[0].i;
+    strcat(s_order, "P");
+}
+
+static void onSave(const CommandArg *args, uint8_t, void *) {
+    snprintf(s_saved, sizeof(s_saved), "%.*s=%.*s", (int)args[0].len, args[0].text,
+             (int)args[1].len, args[1].text);
+}
+
+static const CommandEntry COMMANDS[] PROGMEM = {
+    COMMAND_ENTRY("led on",  onLedOn, ""),
+    COMMAND_ENTRY("pwm set", onPwm,   "i"),
+    COMMAND_ENTRY("save",    onSave,  "wr"),
+};
+
+static const uint8_t COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+void setUp() {
+    s_lastPwm = -1;
+    s_ledOnCalls = 0;
+    s_order[0] = '\0';
+    s_saved[0] = '\0';
+}
+
+static CommandStatus feedLine(CommandStream *stream, const char *line) {
+    CommandStatus status = COMMAND_PENDING;
+    for (; *line != '\0'; line++) {
+        status = commandStreamFeed(stream, *line);
+    }
+    return status;
+}
+
+void tearDown() {}
+
+static void test_legacy_parse_command() {
+    TEST_ASSERT_EQUAL(CMD_LED_ON, parseCommand("led on"));
+    TEST_ASSERT_EQUAL(CMD_LED_OFF, parseCommand("led off"));
+    TEST_ASSERT_EQUAL(CMD_UNKNOWN, parseCommand("blink"));
+}
+
+static void test_case_and_whitespace_insensitive() {
+    TEST_ASSERT_EQUAL(CMD_LED_ON, parseCommand("  LED   On "));
+    TEST_ASSERT_EQUAL(CMD_LED_OFF, parseCommand("Led\toff"));
+}
+
+static void test_dispatch_parses_integer_argument() {
+    TEST_ASSERT_EQUAL(COMMAND_OK, commandDispatch(COMMANDS, COMMAND_COUNT, "PWM  Set -40", NULL));
+    TEST_ASSERT_EQUAL_INT32(-40, s_lastPwm);
+}
+
+static void test_dispatch_statuses() {
+    TEST_ASSERT_EQUAL(COMMAND_EMPTY, commandDispatch(COMMANDS, COMMAND_COUNT, "   ", NULL));
+    TEST_ASSERT_EQUAL(COMMAND_NOT_FOUND, commandDispatch(COMMANDS, COMMAND_COUNT, "fan on", NULL));
+    TEST_ASSERT_EQUAL(COMMAND_BAD_ARGS, commandDispatch(COMMANDS, COMMAND_COUNT, "pwm set x", NULL));
+    TEST_ASSERT_EQUAL_INT32(-1, s_lastPwm);
+}
+
+static void test_stream_runs_handler_on_newline() {
+    CommandStream stream;
+    commandStreamInit(&stream, COMMANDS, COMMAND_COUNT, NULL);
+    const char *line = "pwm set 128";
+    for (; *line != '\0'; line++) {
+        TEST_ASSERT_EQUAL(COMMAND_PENDING, commandStreamFeed(&stream, *line));
+    }
+    TEST_ASSERT_EQUAL(COMMAND_OK, commandStreamFeed(&stream, '\n'));
+    TEST_ASSERT_EQUAL_INT32(128, s_lastPwm);
+
+    const char *next = "led on\r";
+    CommandStatus status = COMMAND_PENDING;
+    for (; *next != '\0'; next++) {
+        status = commandStreamFeed(&stream, *next);
+    }
+    TEST_ASSERT_EQUAL(COMMAND_OK, status);
+    TEST_ASSERT_EQUAL_UINT8(1, s_ledOnCalls);
+}
+
+static void test_stream_batch_runs_in_order_at_line_end() {
+    CommandStream stream;
+    commandStreamInit(&stream, COMMANDS, COMMAND_COUNT, NULL);
+    TEST_ASSERT_EQUAL(COMMAND_PENDING, feedLine(&stream, "pwm set 7; led on ;;"));
+    TEST_ASSERT_EQUAL_STRING("", s_order);  // Nothing before the newline
+    TEST_ASSERT_EQUAL(COMMAND_OK, feedLine(&stream, " pwm set 9\n"));
+    TEST_ASSERT_EQUAL_STRING("PLP", s_order);
+    TEST_ASSERT_EQUAL_INT32(9, s_lastPwm);
+    TEST_ASSERT_EQUAL_UINT8(3, stream.lastCommands);
+}
+
+static void test_stream_batch_is_all_or_nothing() {
+    CommandStream stream;
+    commandStreamInit(&stream, COMMANDS, COMMAND_COUNT, NULL);
+    TEST_ASSERT_EQUAL(COMMAND_BAD_ARGS, feedLine(&stream, "led on; pwm set x; led on\n"));
+    TEST_ASSERT_EQUAL_UINT8(1, stream.lastFailedAt);
+    TEST_ASSERT_EQUAL(COMMAND_NOT_FOUND, feedLine(&stream, "led on; fan\n"));
+    TEST_ASSERT_EQUAL_UINT8(1, stream.lastFailedAt);
+    TEST_ASSERT_EQUAL_STRING("", s_order);
+
+    // One command more than COMMAND_BATCH_MAX
+    TEST_ASSERT_EQUAL(COMMAND_BAD_ARGS, feedLine(&stream, "led on;led on;led on;led on;led on\n"));
+    TEST_ASSERT_EQUAL_UINT8(COMMAND_BATCH_MAX, stream.lastFailedAt);
+    TEST_ASSERT_EQUAL_UINT8(0, s_ledOnCalls);
+
+    TEST_ASSERT_EQUAL(COMMAND_OK, feedLine(&stream, "led on\n"));
+    TEST_ASSERT_EQUAL_UINT8(1, s_ledOnCalls);
+}
+
+static void test_stream_rest_argument_keeps_separators() {
+    CommandStream stream;
+    commandStreamInit(&stream, COMMANDS, COMMAND_COUNT, NULL);
+    TEST_ASSERT_EQUAL(COMMAND_OK, feedLine(&stream, "SAVE warm   pwm set 5;  led on  \r"));
+    TEST_ASSERT_EQUAL_STRING("warm=pwm set 5;  led on", s_saved);
+    TEST_ASSERT_EQUAL_STRING("", s_order);
+}
+
+static void test_batch_dispatch_checks_before_running() {
+    uint8_t failedAt = 0xFF;
+    TEST_ASSERT_EQUAL(COMMAND_BAD_ARGS,
+                      commandBatchDispatch(COMMANDS, COMMAND_COUNT, "led on; pwm set", NULL, &failedAt));
+    TEST_ASSERT_EQUAL_UINT8(1, failedAt);
+    TEST_ASSERT_EQUAL_STRING("", s_order);
+
+    TEST_ASSERT_EQUAL(COMMAND_OK,
+                      commandBatchDispatch(COMMANDS, COMMAND_COUNT, " pwm set 3 ;; led on;", NULL, NULL));
+    TEST_ASSERT_EQUAL_STRING("PL", s_order);
+    TEST_ASSERT_EQUAL(COMMAND_EMPTY, commandBatchCheck(COMMANDS, COMMAND_COUNT, " ; ", NULL));
+
+    TEST_ASSERT_EQUAL(COMMAND_OK,
+                      commandBatchDispatch(COMMANDS, COMMAND_COUNT, "save a led on; pwm set 1 ", NULL, NULL));
+    TEST_ASSERT_EQUAL_STRING("a=led on; pwm set 1", s_saved);
+    TEST_ASSERT_EQUAL_STRING("PL", s_order);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_legacy_parse_command);
+    RUN_TEST(test_case_and_whitespace_insensitive);
+    RUN_TEST(test_dispatch_parses_integer_argument);
+    RUN_TEST(test_dispatch_statuses);
+    RUN_TEST(test_stream_runs_handler_on_newline);
+    RUN_TEST(test_stream_batch_runs_in_order_at_line_end);
+    RUN_TEST(test_stream_batch_is_all_or_nothing);
+    RUN_TEST(test_stream_rest_argument_keeps_separators);
+    RUN_TEST(test_batch_dispatch_checks_before_running);
+    return UNITY_END();
+}
@@ -0,0 +1,124 @@
+/**
+ * @file test_main.cpp
+ * @brief ConfigStore — typed entries and write coalescing (env:native)
+ *
+ * Natively the table is RAM only; service() still decides when a page
+ * would be written and counts it, which is what these tests check.
+ */
+
+#include <unity.h>
+
+#include "ConfigStore.h"
+
+static const uint8_t KEY_SETPOINT = 1;
+static const uint8_t KEY_SOURCE = 2;
+static const uint8_t KEY_PASSWORD = 3;
+
+void setUp() {
+    nativeReset();
+}
+
+void tearDown() {}
+
+static void test_typed_round_trip() {
+    ConfigStore store(0, 4, 1);
+    TEST_ASSERT_FALSE(store.begin());       // Nothing stored natively
+
+    TEST_ASSERT_TRUE(store.setFloat(KEY_SETPOINT, 24.5f));
+    TEST_ASSERT_TRUE(store.setU8(KEY_SOURCE, 1));
+    TEST_ASSERT_TRUE(store.setString(KEY_PASSWORD, "87654321"));
+
+    float setpoint = 0.0f;
+    uint8_t source = 0;
+    char password[9];
+    TEST_ASSERT_TRUE(store.getFloat(KEY_SETPOINT, &setpoint));
+    TEST_ASSERT_EQUAL_FLOAT(24.5f, setpoint);
+    TEST_ASSERT_TRUE(store.getU8(KEY_SOURCE, &source));
+    TEST_ASSERT_EQUAL_UINT8(1, source);
+    TEST_ASSERT_TRUE(store.getString(KEY_PASSWORD, password, sizeof(password)));
+    TEST_ASSERT_EQUAL_STRING("87654321", password);
+}
+
+static void test_absent_or_mistyped_keeps_default() {
+    ConfigStore store(0, 4, 1);
+    store.begin();
+    store.setU8(KEY_SOURCE, 1);
+
+    float value = 7.0f;
+    TEST_ASSERT_FALSE(store.getFloat(KEY_SETPOINT, &value));   // Absent
+    TEST_ASSERT_FALSE(store.getFloat(KEY_SOURCE, &value));     // Stored as u8
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, value);
+
+    char shortBuffer[4];
+    store.setString(KEY_PASSWORD, "1234");
+    TEST_ASSERT_FALSE(store.getString(KEY_PASSWORD, shortBuffer, sizeof(shortBuffer)));
+}
+
+static void test_rejects_long_string_and_full_table() {
+    ConfigStore store(0, 4, 1);
+    store.begin();
+    TEST_ASSERT_FALSE(store.setString(KEY_PASSWORD, "123456789"));
+    TEST_ASSERT_FALSE(store.setU8(CONFIG_STORE_KEY_NONE, 0));
+
+    for (uint8_t key = 0; key < CONFIG_STORE_MAX_ENTRIES; key++) {
+        TEST_ASSERT_TRUE(store.setI32(key, key));
+    }
+    TEST_ASSERT_FALSE(store.setI32(CONFIG_STORE_MAX_ENTRIES, 0));
+    TEST_ASSERT_TRUE(store.setI32(0, -5));                       // Existing key still updates
+}
+
+static void test_coalesces_changes_into_one_write() {
+    ConfigStore store(0, 4, 1);
+    store.begin();
+
+    for (int i = 0; i < 10; i++) {                               // Ten key presses, 1 s apart
+        store.setFloat(KEY_SETPOINT, 20.0f + 0.5f * i);
+        TEST_ASSERT_EQUAL_UINT8(0, store.service());
+        nativeAdvanceMs(1000);
+    }
+    TEST_ASSERT_TRUE(store.isDirty());
+    nativeAdvanceMs(CONFIG_STORE_COALESCE_MS);
+    TEST_ASSERT_EQUAL_UINT8(1, store.service());
+    TEST_ASSERT_FALSE(store.isDirty());
+    TEST_ASSERT_EQUAL_UINT16(1, store.getWriteCount());
+}
+
+static void test_unchanged_value_writes_nothing() {
+    ConfigStore store(0, 4, 1);
+    store.begin();
+    store.setU8(KEY_SOURCE, 1);
+    store.flush();
+    TEST_ASSERT_EQUAL_UINT16(1, store.getWriteCount());
+
+    store.setU8(KEY_SOURCE, 1);
+    TEST_ASSERT_FALSE(store.isDirty());
+    nativeAdvanceMs(CONFIG_STORE_MAX_HOLD_MS);
+    TEST_ASSERT_EQUAL_UINT8(0, store.service());
+    TEST_ASSERT_EQUAL_UINT16(1, store.getWriteCount());
+}
+
+static void test_steady_changes_written_within_max_hold() {
+    ConfigStore store(0, 4, 1);
+    store.begin();
+    uint32_t writtenAtMs = 0;
+    for (uint32_t t = 0; t <= CONFIG_STORE_MAX_HOLD_MS; t += 1000) {
+        store.setI32(KEY_SETPOINT, (int32_t)t);                  // Never quiet
+        if (store.service() != 0) {
+            writtenAtMs = millis();
+            break;
+        }
+        nativeAdvanceMs(1000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(CONFIG_STORE_MAX_HOLD_MS, writtenAtMs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_typed_round_trip);
+    RUN_TEST(test_absent_or_mistyped_keeps_default);
+    RUN_TEST(test_rejects_long_string_and_full_table);
+    RUN_TEST(test_coalesces_changes_into_one_write);
+    RUN_TEST(test_unchanged_value_writes_nothing);
+    RUN_TEST(test_steady_changes_written_within_max_hold);
+    return UNITY_END();
+}
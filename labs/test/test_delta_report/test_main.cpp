@@ -0,0 +1,105 @@
+/**
+ * @file test_main.cpp
+ * @brief DeltaReport — change detection against the last printed values (env:native)
+ */
+
+#include <unity.h>
+#include <math.h>
+
+#include "DeltaReport.h"
+
+struct Image {
+    float    temp;
+    uint16_t raw;
+    bool     valid;
+    uint32_t count;
+};
+
+static const DeltaField FIELDS[] PROGMEM = {
+    DELTA_FIELD("temp",  Image, temp,  FIELD_FLOAT, 2, 0.05f),
+    DELTA_FIELD("raw",   Image, raw,   FIELD_U16,   0, 2.0f),
+    DELTA_FIELD("valid", Image, valid, FIELD_BOOL,  0, 0.0f),
+    DELTA_FIELD("count", Image, count, FIELD_U32,   0, 0.0f),
+};
+
+static const uint8_t FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+static DeltaReport s_report;
+static Image s_image;
+
+void setUp() {
+    s_image.temp  = 25.0f;
+    s_image.raw   = 512;
+    s_image.valid = true;
+    s_image.count = 100;
+    TEST_ASSERT_TRUE(deltaReportInit(&s_report, FIELDS, FIELD_COUNT));
+}
+
+void tearDown() {}
+
+static void test_first_poll_prints_every_field_then_nothing() {
+    TEST_ASSERT_EQUAL_UINT8(FIELD_COUNT, deltaReportPoll(&s_report, &s_image));
+    TEST_ASSERT_EQUAL_UINT8(0, deltaReportPoll(&s_report, &s_image));
+}
+
+static void test_changes_within_epsilon_are_not_printed() {
+    deltaReportPoll(&s_report, &s_image);
+    s_image.temp = 25.04f;
+    s_image.raw  = 514;
+    TEST_ASSERT_EQUAL_UINT8(0, deltaReportPoll(&s_report, &s_image));
+    s_image.raw = 515;
+    TEST_ASSERT_EQUAL_UINT8(1, deltaReportPoll(&s_report, &s_image));
+}
+
+static void test_slow_drift_is_printed_once_it_adds_up() {
+    deltaReportPoll(&s_report, &s_image);
+    s_image.temp = 25.03f;
+    TEST_ASSERT_EQUAL_UINT8(0, deltaReportPoll(&s_report, &s_image));
+    s_image.temp = 25.06f;
+    TEST_ASSERT_EQUAL_UINT8(1, deltaReportPoll(&s_report, &s_image));
+    s_image.temp = 25.09f;
+    TEST_ASSERT_EQUAL_UINT8(0, deltaReportPoll(&s_report, &s_image));
+}
+
+static void test_nan_appearing_and_clearing_is_a_change() {
+    deltaReportPoll(&s_report, &s_image);
+    s_image.temp = NAN;
+    TEST_ASSERT_EQUAL_UINT8(1, deltaReportPoll(&s_report, &s_image));
+    TEST_ASSERT_EQUAL_UINT8(0, deltaReportPoll(&s_report, &s_image));
+    s_image.temp = 25.0f;
+    TEST_ASSERT_EQUAL_UINT8(1, deltaReportPoll(&s_report, &s_image));
+}
+
+static void test_zero_epsilon_prints_every_change() {
+    deltaReportPoll(&s_report, &s_image);
+    s_image.valid = false;
+    s_image.count = 101;
+    TEST_ASSERT_EQUAL_UINT8(2, deltaReportPoll(&s_report, &s_image));
+    s_image.count = 100;
+    TEST_ASSERT_EQUAL_UINT8(1, deltaReportPoll(&s_report, &s_image));
+}
+
+static void test_force_restates_every_field() {
+    deltaReportPoll(&s_report, &s_image);
+    deltaReportForce(&s_report);
+    TEST_ASSERT_EQUAL_UINT8(FIELD_COUNT, deltaReportPoll(&s_report, &s_image));
+    TEST_ASSERT_EQUAL_UINT8(0, deltaReportPoll(&s_report, &s_image));
+}
+
+static void test_init_rejects_an_oversized_table() {
+    DeltaReport report;
+    TEST_ASSERT_FALSE(deltaReportInit(&report, FIELDS, DELTA_REPORT_MAX_FIELDS + 1));
+    TEST_ASSERT_EQUAL_UINT8(0, deltaReportPoll(&report, &s_image));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_poll_prints_every_field_then_nothing);
+    RUN_TEST(test_changes_within_epsilon_are_not_printed);
+    RUN_TEST(test_slow_drift_is_printed_once_it_adds_up);
+    RUN_TEST(test_nan_appearing_and_clearing_is_a_change);
+    RUN_TEST(test_zero_epsilon_prints_every_change);
+    RUN_TEST(test_force_restates_every_field);
+    RUN_TEST(test_init_rejects_an_oversized_table);
+    return UNITY_END();
+}
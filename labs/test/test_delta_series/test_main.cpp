@@ -0,0 +1,134 @@
+/**
+ * @file test_main.cpp
+ * @brief DeltaSeries — zig-zag varints, exact round trips and the history ring (env:native)
+ */
+
+#include <unity.h>
+
+#include "DeltaSeries.h"
+
+#include <math.h>
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_zigzag_and_varint_boundaries() {
+    TEST_ASSERT_EQUAL_UINT32(0, zigzagEncode(0));
+    TEST_ASSERT_EQUAL_UINT32(1, zigzagEncode(-1));
+    TEST_ASSERT_EQUAL_UINT32(2, zigzagEncode(1));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, zigzagEncode(INT32_MIN));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, zigzagDecode(0xFFFFFFFFu));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, zigzagDecode(zigzagEncode(INT32_MAX)));
+
+    const uint32_t values[] = { 0, 127, 128, 16383, 16384, 0x0FFFFFFFu, 0xFFFFFFFFu };
+    const uint8_t lengths[] = { 1, 1, 2, 2, 3, 4, 5 };
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        uint8_t buf[DELTA_SERIES_VARINT_MAX];
+        uint8_t n = varintEncode(values[i], buf);
+        TEST_ASSERT_EQUAL_UINT8(lengths[i], n);
+        uint32_t back = 0;
+        TEST_ASSERT_EQUAL_UINT8(n, varintDecode(buf, n, &back));
+        TEST_ASSERT_EQUAL_UINT32(values[i], back);
+        TEST_ASSERT_EQUAL_UINT8(0, varintDecode(buf, (uint16_t)(n - 1), &back));  // Truncated
+    }
+}
+
+static void test_samples_round_trip_exactly() {
+    const int32_t samples[][3] = {
+        { 0, 2345, DELTA_SERIES_NONE },
+        { 1, 2346, -2000 },
+        { 2, INT32_MAX, INT32_MIN + 1 },
+        { 3, INT32_MIN + 1, INT32_MAX },
+        { (int32_t)0xFFFFFFFFu, DELTA_SERIES_NONE, 0 },
+    };
+    int32_t previous[3] = { 0, 0, 0 };
+    int32_t decoded[3] = { 0, 0, 0 };
+    uint8_t buf[3 * DELTA_SERIES_VARINT_MAX];
+    for (uint8_t s = 0; s < 5; s++) {
+        uint8_t n = deltaSeriesEncode(samples[s], previous, 3, buf);
+        TEST_ASSERT_EQUAL_UINT8(n, deltaSeriesDecode(buf, n, decoded, 3));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(samples[s], decoded, sizeof(decoded));
+    }
+
+    TEST_ASSERT_EQUAL_INT32(2346, deltaSeriesQuantize(23.456f, 100));
+    TEST_ASSERT_EQUAL_INT32(-1235, deltaSeriesQuantize(-12.345f, 100));
+    TEST_ASSERT_EQUAL_INT32(DELTA_SERIES_NONE, deltaSeriesQuantize(NAN, 100));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, deltaSeriesQuantize(1e12f, 100));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN + 1, deltaSeriesQuantize(-1e12f, 100));
+    TEST_ASSERT_TRUE(isnan(deltaSeriesValue(DELTA_SERIES_NONE, 100)));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 23.46f, deltaSeriesValue(2346, 100));
+}
+
+struct Collected {
+    int32_t  samples[64][2];
+    uint16_t n;
+};
+
+static void collect(const int32_t *values, void *context) {
+    Collected *c = (Collected *)context;
+    c->samples[c->n][0] = values[0];
+    c->samples[c->n][1] = values[1];
+    c->n++;
+}
+
+static void test_ring_drops_the_oldest_and_keeps_decoding() {
+    DeltaSeries<2, 40> series;
+    for (int32_t i = 0; i < 30; i++) {
+        int32_t q[2] = { i, 2000 + (i % 3) * ((i & 1) ? 100 : -100) };  // 2 or 3 bytes per sample
+        series.append(q);
+    }
+    TEST_ASSERT_TRUE(series.bytesUsed() <= 40);
+    TEST_ASSERT_EQUAL_UINT32(30, series.count() + series.getDropped());
+
+    Collected c;
+    c.n = 0;
+    TEST_ASSERT_EQUAL_UINT16(series.count(), series.forEach(collect, &c));
+    int32_t first = 30 - (int32_t)c.n;
+    for (uint16_t k = 0; k < c.n; k++) {
+        int32_t i = first + (int32_t)k;
+        TEST_ASSERT_EQUAL_INT32(i, c.samples[k][0]);
+        TEST_ASSERT_EQUAL_INT32(2000 + (i % 3) * ((i & 1) ? 100 : -100), c.samples[k][1]);
+    }
+
+    // A raw dump: base + bytes decodes to the same samples
+    int32_t values[2];
+    series.getBase(values);
+    uint8_t raw[40];
+    uint16_t len = series.copyBytes(0, raw, sizeof(raw));
+    TEST_ASSERT_EQUAL_UINT16(series.bytesUsed(), len);
+    uint16_t offset = 0;
+    for (uint16_t k = 0; k < c.n; k++) {
+        offset = (uint16_t)(offset + deltaSeriesDecode(&raw[offset], (uint16_t)(len - offset), values, 2));
+        TEST_ASSERT_EQUAL_INT32(c.samples[k][1], values[1]);
+    }
+    TEST_ASSERT_EQUAL_UINT16(len, offset);
+    series.getLast(values);
+    TEST_ASSERT_EQUAL_INT32(29, values[0]);
+}
+
+static void test_slow_signal_takes_a_byte_per_value() {
+    // Time in 100 ms steps of one interval, a temperature drifting by
+    // hundredths with noise: raw as u32 + 2 floats = 12 bytes per sample
+    static DeltaSeries<3, 1024> series;
+    for (int32_t i = 0; i < 200; i++) {
+        float tempA = 22.0f + 0.01f * (float)i + 0.05f * sinf((float)i);
+        float tempB = 22.5f + 0.02f * cosf(0.3f * (float)i);
+        int32_t q[3] = { 1000 + i * 10, deltaSeriesQuantize(tempA, 100),
+                         deltaSeriesQuantize(tempB, 100) };
+        series.append(q);
+    }
+    TEST_ASSERT_EQUAL_UINT16(200, series.count());
+    TEST_ASSERT_EQUAL_UINT32(0, series.getDropped());
+    // 3 bytes per sample after the first: 4× smaller than raw
+    TEST_ASSERT_TRUE(series.bytesUsed() <= 3 * 200 + 8);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_zigzag_and_varint_boundaries);
+    RUN_TEST(test_samples_round_trip_exactly);
+    RUN_TEST(test_ring_drops_the_oldest_and_keeps_decoding);
+    RUN_TEST(test_slow_signal_takes_a_byte_per_value);
+    return UNITY_END();
+}
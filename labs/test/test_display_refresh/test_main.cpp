@@ -0,0 +1,111 @@
+/**
+ * @file test_main.cpp
+ * @brief DisplayRefresh — dirty bits, rate cap and heartbeat (env:native)
+ *
+ * The shim lets a blocking take() with nothing given elapse its timeout
+ * on the simulated clock, so millis() after wait() tells when the
+ * display task would have woken.
+ */
+
+#include <unity.h>
+
+#include "DisplayRefresh.h"
+
+static const uint8_t DIRTY_LCD = 0x01;
+static const uint8_t DIRTY_REPORT = 0x02;
+
+void setUp() {
+    nativeReset();
+}
+
+void tearDown() {}
+
+static void test_first_wait_draws_at_once() {
+    DisplayRefresh refresh(100, 2000);
+    refresh.bind();
+    TEST_ASSERT_EQUAL_UINT8(DISPLAY_REFRESH_HEARTBEAT, refresh.wait());
+    TEST_ASSERT_EQUAL_UINT32(0, millis());
+}
+
+static void test_idle_display_wakes_on_heartbeat_only() {
+    DisplayRefresh refresh(100, 2000);
+    refresh.bind();
+    refresh.wait();
+
+    for (uint32_t beat = 1; beat <= 3; beat++) {
+        TEST_ASSERT_EQUAL_UINT8(DISPLAY_REFRESH_HEARTBEAT, refresh.wait());
+        TEST_ASSERT_EQUAL_UINT32(beat * 2000, millis());
+    }
+}
+
+static void test_marks_coalesce_under_rate_cap() {
+    DisplayRefresh refresh(100, 2000);
+    refresh.bind();
+    refresh.wait();                             // t = 0
+
+    refresh.mark(DIRTY_LCD);
+    refresh.mark(DIRTY_LCD);
+    refresh.mark(DIRTY_REPORT);
+    TEST_ASSERT_EQUAL_UINT8(DIRTY_LCD | DIRTY_REPORT, refresh.wait());
+    TEST_ASSERT_TRUE(millis() >= 100);          // Not before the cap
+    TEST_ASSERT_TRUE(millis() < 100 + portTICK_PERIOD_MS);
+
+    nativeAdvanceMs(500);                       // Quiet for longer than the cap
+    refresh.mark(DIRTY_LCD);
+    uint32_t before = millis();
+    TEST_ASSERT_EQUAL_UINT8(DIRTY_LCD, refresh.wait());
+    TEST_ASSERT_EQUAL_UINT32(before, millis()); // Drawn at once
+}
+
+static void test_heartbeat_keeps_its_cadence() {
+    DisplayRefresh refresh(100, 2000);
+    refresh.bind();
+    refresh.wait();
+
+    nativeAdvanceMs(1500);
+    refresh.mark(DIRTY_LCD);
+    TEST_ASSERT_EQUAL_UINT8(DIRTY_LCD, refresh.wait());     // t = 1500
+    TEST_ASSERT_EQUAL_UINT8(DISPLAY_REFRESH_HEARTBEAT, refresh.wait());
+    TEST_ASSERT_TRUE(millis() >= 2000);                     // Not pushed back
+    TEST_ASSERT_TRUE(millis() < 2000 + portTICK_PERIOD_MS); // Tick edge
+    TEST_ASSERT_EQUAL_UINT32(millis() - 2000, refresh.getLateMs());
+}
+
+static void test_stalled_display_does_not_burst() {
+    DisplayRefresh refresh(100, 500);
+    refresh.bind();
+    refresh.wait();
+
+    nativeAdvanceMs(1800);                      // Beats at 500, 1000, 1500 missed
+    TEST_ASSERT_EQUAL_UINT8(DISPLAY_REFRESH_HEARTBEAT, refresh.wait());
+    TEST_ASSERT_EQUAL_UINT32(1300, refresh.getLateMs());
+    uint32_t late = millis();
+    refresh.wait();
+    TEST_ASSERT_TRUE(millis() - late >= 500);   // One beat later, not at once
+}
+
+static void test_mark_before_bind_is_kept() {
+    DisplayRefresh refresh(100, 0);
+    refresh.mark(DIRTY_REPORT);
+    refresh.bind();
+    TEST_ASSERT_EQUAL_UINT8(DIRTY_REPORT, refresh.wait());
+}
+
+static void test_quantize_follows_shown_resolution() {
+    TEST_ASSERT_EQUAL_INT16(250, displayRefreshQuantize(24.96f, 0.1f));
+    TEST_ASSERT_EQUAL_INT16(249, displayRefreshQuantize(24.94f, 0.1f));
+    TEST_ASSERT_EQUAL_INT16(-12, displayRefreshQuantize(-1.2f, 0.1f));
+    TEST_ASSERT_EQUAL_INT16(INT16_MIN, displayRefreshQuantize(NAN, 0.1f));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_wait_draws_at_once);
+    RUN_TEST(test_idle_display_wakes_on_heartbeat_only);
+    RUN_TEST(test_marks_coalesce_under_rate_cap);
+    RUN_TEST(test_heartbeat_keeps_its_cadence);
+    RUN_TEST(test_stalled_display_does_not_burst);
+    RUN_TEST(test_mark_before_bind_is_kept);
+    RUN_TEST(test_quantize_follows_shown_resolution);
+    return UNITY_END();
+}
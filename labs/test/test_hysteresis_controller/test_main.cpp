@@ -0,0 +1,70 @@
+/**
+ * @file test_main.cpp
+ * @brief OnOffHysteresisController — switching band, forcing and count limits (env:native)
+ */
+
+#include <unity.h>
+
+#include "OnOffHysteresisController.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_band_is_around_setpoint() {
+    OnOffHysteresisController ctrl(50.0f, 4.0f);
+    ctrl.init();
+    TEST_ASSERT_LESS_THAN(50.0f, ctrl.getLowerThreshold());
+    TEST_ASSERT_GREATER_THAN(50.0f, ctrl.getUpperThreshold());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 50.0f, ctrl.getSetpoint());
+}
+
+static void test_switches_on_below_and_off_above() {
+    OnOffHysteresisController ctrl(50.0f, 4.0f);
+    ctrl.init();
+    TEST_ASSERT_TRUE(ctrl.update(ctrl.getSwitchOnThreshold() - 1.0f));
+    TEST_ASSERT_TRUE(ctrl.isOutputOn());
+    TEST_ASSERT_FALSE(ctrl.update(ctrl.getSwitchOffThreshold() + 1.0f));
+}
+
+static void test_holds_state_inside_band() {
+    OnOffHysteresisController ctrl(50.0f, 4.0f);
+    ctrl.init();
+    ctrl.update(40.0f);
+    TEST_ASSERT_TRUE(ctrl.update(50.0f));           // Rising through the band
+    ctrl.update(60.0f);
+    TEST_ASSERT_FALSE(ctrl.update(50.0f));          // Falling through the band
+}
+
+static void test_force_output() {
+    OnOffHysteresisController ctrl(50.0f, 4.0f);
+    ctrl.init();
+    ctrl.forceOutput(true);
+    TEST_ASSERT_TRUE(ctrl.isOutputOn());
+    ctrl.forceOutput(false);
+    TEST_ASSERT_FALSE(ctrl.isOutputOn());
+}
+
+static void test_count_limits_in_either_direction() {
+    OnOffHysteresisController ctrl(50.0f, 4.0f);
+    ctrl.init();
+    ctrl.setCountLimits(500, 450);                  // Counts fall as the value rises
+    TEST_ASSERT_TRUE(ctrl.updateCounts(510));
+    TEST_ASSERT_TRUE(ctrl.updateCounts(470));
+    TEST_ASSERT_FALSE(ctrl.updateCounts(440));
+    TEST_ASSERT_FALSE(ctrl.updateCounts(470));
+
+    ctrl.setCountLimits(100, 200);                  // Counts rise with the value
+    TEST_ASSERT_TRUE(ctrl.updateCounts(90));
+    TEST_ASSERT_TRUE(ctrl.updateCounts(150));
+    TEST_ASSERT_FALSE(ctrl.updateCounts(210));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_band_is_around_setpoint);
+    RUN_TEST(test_switches_on_below_and_off_above);
+    RUN_TEST(test_holds_state_inside_band);
+    RUN_TEST(test_force_output);
+    RUN_TEST(test_count_limits_in_either_direction);
+    return UNITY_END();
+}
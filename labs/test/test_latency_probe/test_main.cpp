@@ -0,0 +1,97 @@
+/**
+ * @file test_main.cpp
+ * @brief LatencyProbe — path markers into stage histograms (env:native)
+ */
+
+#include <unity.h>
+
+#include <Arduino.h>
+#include "LatencyProbe.h"
+
+static LatencyPath   s_path;
+static PerfHistogram s_firstUs;
+static PerfHistogram s_lastUs;
+
+static const PerfDesc LATENCY[] PROGMEM = {
+    PERF_HISTOGRAM("first", s_firstUs),
+    PERF_HISTOGRAM("last",  s_lastUs),
+};
+
+void setUp() {
+    latencyProbeInit(LATENCY, 2);
+    latencyProbeClear();
+    s_path.open = false;
+}
+
+void tearDown() {}
+
+static void test_stages_record_time_since_stimulus() {
+    latencyStart(&s_path);
+    nativeAdvanceUs(100);
+    latencyStage(&s_path, &s_firstUs);
+    nativeAdvanceUs(400);
+    latencyEnd(&s_path, &s_lastUs);
+
+    TEST_ASSERT_EQUAL_UINT32(1, perfHistogramTotal(&s_firstUs));
+    TEST_ASSERT_EQUAL_UINT32(100, s_firstUs.max);
+    TEST_ASSERT_EQUAL_UINT32(500, s_lastUs.max);   // Cumulative from the stimulus
+    TEST_ASSERT_FALSE(s_path.open);
+}
+
+static void test_stage_without_stimulus_is_not_counted() {
+    latencyStage(&s_path, &s_firstUs);
+    latencyEnd(&s_path, &s_lastUs);
+    TEST_ASSERT_EQUAL_UINT32(0, perfHistogramTotal(&s_firstUs));
+    TEST_ASSERT_EQUAL_UINT32(0, perfHistogramTotal(&s_lastUs));
+
+    latencyStart(&s_path);
+    latencyEnd(&s_path, &s_lastUs);
+    latencyEnd(&s_path, &s_lastUs);                // Closed by the first end
+    TEST_ASSERT_EQUAL_UINT32(1, perfHistogramTotal(&s_lastUs));
+}
+
+static void test_start_at_uses_an_earlier_timestamp() {
+    uint32_t edgeUs = micros();
+    nativeAdvanceUs(250);
+    latencyStartAt(&s_path, edgeUs);
+    latencyEnd(&s_path, &s_lastUs);
+    TEST_ASSERT_EQUAL_UINT32(250, s_lastUs.max);
+}
+
+static void test_new_start_replaces_an_unanswered_one() {
+    latencyStart(&s_path);
+    nativeAdvanceUs(10000);
+    latencyStart(&s_path);
+    nativeAdvanceUs(30);
+    latencyEnd(&s_path, &s_lastUs);
+    TEST_ASSERT_EQUAL_UINT32(1, perfHistogramTotal(&s_lastUs));
+    TEST_ASSERT_EQUAL_UINT32(30, s_lastUs.max);
+}
+
+static void test_markers_compile_out_without_the_flag() {
+#if !defined(LATENCY_PROBE_ENABLED)
+    LATENCY_START(s_path);
+    LATENCY_END(s_path, s_lastUs);
+    LATENCY_PIN_TOGGLE(13);
+    TEST_ASSERT_FALSE(s_path.open);
+    TEST_ASSERT_EQUAL_UINT32(0, perfHistogramTotal(&s_lastUs));
+#endif
+}
+
+static void test_clear_zeroes_the_stage_histograms() {
+    latencyStart(&s_path);
+    latencyEnd(&s_path, &s_lastUs);
+    latencyProbeClear();
+    TEST_ASSERT_EQUAL_UINT32(0, perfHistogramTotal(&s_lastUs));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_stages_record_time_since_stimulus);
+    RUN_TEST(test_stage_without_stimulus_is_not_counted);
+    RUN_TEST(test_start_at_uses_an_earlier_timestamp);
+    RUN_TEST(test_new_start_replaces_an_unanswered_one);
+    RUN_TEST(test_markers_compile_out_without_the_flag);
+    RUN_TEST(test_clear_zeroes_the_stage_histograms);
+    return UNITY_END();
+}
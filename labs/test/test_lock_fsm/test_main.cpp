@@ -0,0 +1,111 @@
+/**
+ * @file test_main.cpp
+ * @brief LockFSM — keypad command sequences and result timeout (env:native)
+ */
+
+#include <unity.h>
+
+#include "LockFSM.h"
+#include "Timeout.h"
+
+static LockFSM s_fsm;
+
+void setUp() {
+    nativeReset();
+    s_fsm.init();
+}
+
+void tearDown() {}
+
+static void keys(const char *sequence) {
+    for (; *sequence != '\0'; sequence++) {
+        s_fsm.processKey(*sequence);
+    }
+}
+
+static void test_starts_locked_and_idle() {
+    TEST_ASSERT_TRUE(s_fsm.isLocked());
+    TEST_ASSERT_EQUAL(STATE_IDLE, s_fsm.getState());
+}
+
+static void test_unlock_with_default_password() {
+    keys("*1*1234#");
+    TEST_ASSERT_FALSE(s_fsm.isLocked());
+    TEST_ASSERT_EQUAL(STATE_SHOW_RESULT, s_fsm.getState());
+
+    LockDisplay display;
+    s_fsm.renderDisplay(display);
+    TEST_ASSERT_EQUAL_STRING("Access Granted!", display.line1);
+}
+
+static void test_wrong_password_stays_locked() {
+    keys("*1*9999#");
+    TEST_ASSERT_TRUE(s_fsm.isLocked());
+
+    LockDisplay display;
+    s_fsm.renderDisplay(display);
+    TEST_ASSERT_EQUAL_STRING("Wrong Password!", display.line1);
+}
+
+static void test_lock_command() {
+    keys("*1*1234#");
+    nativeAdvanceMs(RESULT_DISPLAY_MS);
+    Timeout::poll();
+    keys("*0#");
+    TEST_ASSERT_TRUE(s_fsm.isLocked());
+}
+
+static void test_change_password() {
+    keys("*2*1234*42#");
+    nativeAdvanceMs(RESULT_DISPLAY_MS);
+    Timeout::poll();
+    keys("*1*1234#");
+    TEST_ASSERT_TRUE(s_fsm.isLocked());
+    nativeAdvanceMs(RESULT_DISPLAY_MS);
+    Timeout::poll();
+    keys("*1*42#");
+    TEST_ASSERT_FALSE(s_fsm.isLocked());
+}
+
+static void test_restored_password() {
+    TEST_ASSERT_FALSE(s_fsm.setPassword(""));
+    TEST_ASSERT_FALSE(s_fsm.setPassword("12a4"));
+    TEST_ASSERT_FALSE(s_fsm.setPassword("123456789"));
+    TEST_ASSERT_EQUAL_STRING("1234", s_fsm.getPassword());
+
+    TEST_ASSERT_TRUE(s_fsm.setPassword("987"));
+    keys("*1*987#");
+    TEST_ASSERT_FALSE(s_fsm.isLocked());
+}
+
+static void test_result_times_out_to_idle() {
+    keys("*3#");
+    TEST_ASSERT_EQUAL(STATE_SHOW_RESULT, s_fsm.getState());
+    nativeAdvanceMs(RESULT_DISPLAY_MS - 1);
+    Timeout::poll();
+    TEST_ASSERT_EQUAL(STATE_SHOW_RESULT, s_fsm.getState());
+    nativeAdvanceMs(1);
+    Timeout::poll();
+    TEST_ASSERT_EQUAL(STATE_IDLE, s_fsm.getState());
+}
+
+static void test_invalid_menu_option() {
+    keys("*9");
+    LockDisplay display;
+    s_fsm.renderDisplay(display);
+    TEST_ASSERT_EQUAL_STRING("Invalid option!", display.line1);
+    TEST_ASSERT_TRUE(s_fsm.isLocked());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_locked_and_idle);
+    RUN_TEST(test_unlock_with_default_password);
+    RUN_TEST(test_wrong_password_stays_locked);
+    RUN_TEST(test_lock_command);
+    RUN_TEST(test_change_password);
+    RUN_TEST(test_restored_password);
+    RUN_TEST(test_result_times_out_to_idle);
+    RUN_TEST(test_invalid_menu_option);
+    return UNITY_END();
+}
@@ -0,0 +1,107 @@
+/**
+ * @file test_main.cpp
+ * @brief LoopMetrics — rolling IAE / ISE / travel / switch rate, step
+ *        detection and the last step's figures (env:native)
+ */
+
+#include <unity.h>
+
+#include "LoopMetrics.h"
+
+#include <math.h>
+
+void setUp() {}
+void tearDown() {}
+
+static void test_window_integrates_held_error_and_travel() {
+    LoopMetrics m(40000UL, 0.25f);     // 4 buckets of 10 s
+    uint32_t switches = 0;
+    // Constant error of 2 °C, output alternating 0 / 50 %, a switch each cycle
+    for (uint32_t t = 0; t <= 20000; t += 1000) {
+        float out = ((t / 1000) % 2 == 0) ? 0.0f : 50.0f;
+        m.update(25.0f, 23.0f, out, switches, t);
+        switches++;
+    }
+    LoopMetricsReport r;
+    m.getReport(&r);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, r.windowS);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, r.iae);        // 2 °C · 20 s
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 80.0f, r.ise);        // 4 °C² · 20 s
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1000.0f, r.travel);   // 20 moves of 50 %
+    TEST_ASSERT_EQUAL_UINT16(20, r.switches);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 3600.0f, r.switchesPerHour);
+    TEST_ASSERT_EQUAL_UINT16(0, r.steps);
+    TEST_ASSERT_TRUE(isnan(r.lastOvershoot));                // No finished step yet
+}
+
+static void test_old_buckets_leave_the_window() {
+    LoopMetrics m(40000UL, 0.25f);
+    for (uint32_t t = 0; t <= 20000; t += 1000) {
+        m.update(25.0f, 24.0f, 10.0f, 0, t);              // 1 °C for 20 s
+    }
+    for (uint32_t t = 21000; t <= 100000; t += 1000) {
+        m.update(25.0f, 25.0f, 10.0f, 0, t);              // On the setpoint
+    }
+    LoopMetricsReport r;
+    m.getReport(&r);
+    TEST_ASSERT_TRUE(r.windowS >= 30.0f && r.windowS <= 40.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, r.iae);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, r.travel);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, r.switchesPerHour);
+}
+
+static void test_invalid_readings_score_no_error() {
+    LoopMetrics m(60000UL, 0.25f);
+    m.update(25.0f, 24.0f, 0.0f, 0, 0);
+    m.update(25.0f, NAN, 0.0f, 0, 1000);                  // 1 s scored
+    m.update(25.0f, NAN, 0.0f, 0, 5000);                  // Gap: nothing
+    m.update(25.0f, 24.0f, 0.0f, 0, 6000);                // Fresh interval
+    m.update(25.0f, 24.0f, 0.0f, 0, 7000);                // 1 s scored
+    LoopMetricsReport r;
+    m.getReport(&r);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.0f, r.iae);
+}
+
+static void test_setpoint_step_is_scored_and_kept() {
+    LoopMetrics m(600000UL, 0.25f);
+    m.setSettleBand(0.5f);
+    // Hold 20 °C, then step to 22 °C: rise 0.1 °C/s to 22.4, back to 22.0
+    uint32_t t = 0;
+    for (; t < 10000; t += 1000) {
+        m.update(20.0f, 20.0f, 0.0f, 0, t);
+    }
+    float value = 20.0f;
+    for (; value < 22.45f; t += 1000) {
+        m.update(22.0f, value, 100.0f, 1, t);
+        value += 0.1f;
+    }
+    for (; t < 60000; t += 1000) {
+        m.update(22.1f, 22.0f, 0.0f, 2, t);                // Pot jitter under the threshold
+    }
+    LoopMetricsReport r;
+    m.getReport(&r);
+    TEST_ASSERT_EQUAL_UINT16(1, r.steps);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.4f, r.stepOvershoot);
+    TEST_ASSERT_FALSE(isnan(r.stepSettleS));
+    TEST_ASSERT_FLOAT_WITHIN(0.6f, 15.5f, r.stepSettleS);    // 21.5 °C reached
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, r.lastOvershoot); // The hold before it
+
+    // The next step keeps this one's figures
+    m.update(24.0f, 22.0f, 100.0f, 3, t);
+    m.getReport(&r);
+    TEST_ASSERT_EQUAL_UINT16(2, r.steps);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.4f, r.lastOvershoot);
+    TEST_ASSERT_FLOAT_WITHIN(0.6f, 15.5f, r.lastSettleS);
+    TEST_ASSERT_TRUE(r.lastIae > 10.0f);
+    TEST_ASSERT_TRUE(isnan(r.stepSettleS));                  // 2 °C below the new one
+    TEST_ASSERT_EQUAL_UINT16(3, r.switches);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_window_integrates_held_error_and_travel);
+    RUN_TEST(test_old_buckets_leave_the_window);
+    RUN_TEST(test_invalid_readings_score_no_error);
+    RUN_TEST(test_setpoint_step_is_scored_and_kept);
+    return UNITY_END();
+}
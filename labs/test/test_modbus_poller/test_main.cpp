@@ -0,0 +1,225 @@
+/**
+ * @file test_main.cpp
+ * @brief ModbusPoller — round-robin pipeline, reply checks, timeouts, cycle time (env:native)
+ *
+ * Replies come from ModbusRtu slaves served in memory, so the requests
+ * the poller builds are checked against the slave core; ModbusMaster.cpp
+ * (the AVR USART link) is not part of the native build.
+ */
+
+#include <unity.h>
+
+#include "ModbusPoller.h"
+#include "ModbusRtu.h"
+#include <string.h>
+
+struct NodeImage {
+    float    temperatureC;
+    uint16_t raw;
+    bool     valid;
+};
+
+static const ModbusRegister NODE_REGS[] = {
+    MODBUS_INPUT(0, NodeImage, temperatureC, MODBUS_FLOAT, 100),
+    MODBUS_INPUT(1, NodeImage, raw, MODBUS_U16, 1),
+    MODBUS_INPUT(2, NodeImage, valid, MODBUS_BOOL, 1),
+};
+
+static const ModbusPoll POLLS[] = {
+    { 3, MODBUS_FC_READ_INPUT, 0, 3 },
+    { 4, MODBUS_FC_READ_INPUT, 0, 2 },
+    { 5, MODBUS_FC_READ_INPUT, 1, 2 },
+    { 6, MODBUS_FC_READ_INPUT, 0, 1 },
+};
+static const uint8_t POLL_COUNT = sizeof(POLLS) / sizeof(POLLS[0]);
+
+static ModbusPoller    s_poller;
+static ModbusPollCache s_cache[POLL_COUNT];
+static ModbusRtu       s_slaves[POLL_COUNT];
+static NodeImage       s_images[POLL_COUNT];
+static uint8_t         s_adu[MODBUS_ADU_MAX];
+
+void setUp() {
+    modbusPollerInit(&s_poller, POLLS, s_cache, POLL_COUNT, 2, 3);
+    for (uint8_t i = 0; i < POLL_COUNT; i++) {
+        modbusRtuInit(&s_slaves[i], NODE_REGS, 3, POLLS[i].node, NULL, NULL);
+        s_images[i].temperatureC = 20.0f + i;
+        s_images[i].raw = (uint16_t)(100 * i);
+        s_images[i].valid = true;
+    }
+}
+
+void tearDown() {}
+
+/** Build the next request and have the addressed slave answer it; returns the row. */
+static uint8_t transact(uint32_t nowUs, uint32_t nowMs) {
+    uint8_t len = modbusPollerNext(&s_poller, nowUs, s_adu);
+    TEST_ASSERT_EQUAL_UINT8(8, len);
+    uint8_t row = s_poller.pending[s_poller.inFlight - 1];
+    uint8_t reply = modbusRtuHandle(&s_slaves[row], s_adu, len, &s_images[row]);
+    modbusPollerReply(&s_poller, s_adu, reply, nowMs);
+    return row;
+}
+
+static void test_reply_length_from_header() {
+    const uint8_t read[] = { 3, 0x04, 6 };
+    TEST_ASSERT_EQUAL_UINT8(0, modbusReplyLength(read, 1));
+    TEST_ASSERT_EQUAL_UINT8(0, modbusReplyLength(read, 2));
+    TEST_ASSERT_EQUAL_UINT8(11, modbusReplyLength(read, 3));
+    const uint8_t exception[] = { 3, 0x84 };
+    TEST_ASSERT_EQUAL_UINT8(5, modbusReplyLength(exception, 2));
+    const uint8_t write[] = { 3, 0x10 };
+    TEST_ASSERT_EQUAL_UINT8(8, modbusReplyLength(write, 2));
+    const uint8_t unknown[] = { 3, 0x2B };
+    TEST_ASSERT_EQUAL_UINT8(0, modbusReplyLength(unknown, 2));
+}
+
+static void test_round_robin_two_requests_in_flight() {
+    uint8_t first[8];
+    TEST_ASSERT_EQUAL_UINT8(8, modbusPollerNext(&s_poller, 0, first));
+    const uint8_t expected[] = { 3, 0x04, 0x00, 0x00, 0x00, 0x03 };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, first, 6);
+    TEST_ASSERT_EQUAL_HEX16(modbusCrc16(first, 6), (uint16_t)(first[6] | (first[7] << 8)));
+
+    TEST_ASSERT_EQUAL_UINT8(8, modbusPollerNext(&s_poller, 0, s_adu));
+    TEST_ASSERT_EQUAL_UINT8(4, s_adu[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, modbusPollerNext(&s_poller, 0, s_adu));   // Pipeline full
+
+    // The reply belongs to the oldest request (node 3).
+    uint8_t reply = modbusRtuHandle(&s_slaves[0], first, 8, &s_images[0]);
+    modbusPollerReply(&s_poller, first, reply, 1000);
+    TEST_ASSERT_EQUAL_UINT8(MODBUS_POLL_OK, s_cache[0].status);
+    TEST_ASSERT_EQUAL_UINT8(MODBUS_POLL_NEVER, s_cache[1].status);
+    TEST_ASSERT_EQUAL_UINT8(8, modbusPollerNext(&s_poller, 0, s_adu));
+    TEST_ASSERT_EQUAL_UINT8(5, s_adu[0]);
+}
+
+static void test_reply_caches_values_with_age() {
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, modbusPollerAgeMs(&s_poller, 0, 0));
+    transact(0, 1000);
+    TEST_ASSERT_EQUAL_UINT16(2000, s_cache[0].regs[0]);
+    TEST_ASSERT_EQUAL_UINT16(0, s_cache[0].regs[1]);
+    TEST_ASSERT_EQUAL_UINT16(1, s_cache[0].regs[2]);
+    TEST_ASSERT_EQUAL_UINT32(250, modbusPollerAgeMs(&s_poller, 0, 1250));
+
+    transact(0, 1000);
+    transact(0, 1000);
+    TEST_ASSERT_EQUAL_UINT16(200, s_cache[2].regs[0]);   // Row 2 starts at register 1
+    TEST_ASSERT_EQUAL_UINT16(1, s_cache[2].regs[1]);
+    TEST_ASSERT_EQUAL_UINT16(1, s_cache[2].replies);
+}
+
+static void test_bad_replies_keep_old_values() {
+    modbusPollerInit(&s_poller, POLLS, s_cache, 1, 2, 3);   // Node 3 only
+    transact(0, 1000);
+    s_images[0].temperatureC = 30.0f;
+
+    // Corrupted CRC.
+    uint8_t len = modbusPollerNext(&s_poller, 0, s_adu);
+    uint8_t reply = modbusRtuHandle(&s_slaves[0], s_adu, len, &s_images[0]);
+    s_adu[3] ^= 0xFF;
+    modbusPollerReply(&s_poller, s_adu, reply, 2000);
+    TEST_ASSERT_EQUAL_UINT8(MODBUS_POLL_BAD_FRAME, s_cache[0].status);
+    TEST_ASSERT_EQUAL_UINT16(2000, s_cache[0].regs[0]);
+    TEST_ASSERT_EQUAL_UINT32(1000, modbusPollerAgeMs(&s_poller, 0, 2000));
+
+    // The link's character error.
+    modbusPollerNext(&s_poller, 0, s_adu);
+    modbusPollerReply(&s_poller, NULL, 0, 2000);
+    TEST_ASSERT_EQUAL_UINT16(2, s_cache[0].errors);
+    TEST_ASSERT_EQUAL_UINT16(1, s_cache[0].replies);
+
+    // An exception: node 5 has no register 3 for a 2-word read from 2.
+    static const ModbusPoll GAP[] = { { 5, MODBUS_FC_READ_INPUT, 2, 2 } };
+    modbusPollerInit(&s_poller, GAP, s_cache, 1, 2, 3);
+    len = modbusPollerNext(&s_poller, 0, s_adu);
+    reply = modbusRtuHandle(&s_slaves[2], s_adu, len, &s_images[2]);
+    modbusPollerReply(&s_poller, s_adu, reply, 3000);
+    TEST_ASSERT_EQUAL_UINT8(MODBUS_POLL_EXCEPTION, s_cache[0].status);
+    TEST_ASSERT_EQUAL_HEX8(MODBUS_EX_ILLEGAL_ADDRESS, s_cache[0].exception);
+    TEST_ASSERT_EQUAL_UINT16(1, s_cache[0].errors);
+}
+
+static void test_dead_node_is_held_off() {
+    // Node 4 (row 1) never answers; missLimit 2, holdoff 3 cycles.
+    uint8_t requested[POLL_COUNT] = { 0 };
+    for (uint8_t cycle = 0; cycle < 8; cycle++) {
+        for (uint8_t i = 0; i < POLL_COUNT; i++) {
+            if (modbusPollerNext(&s_poller, 0, s_adu) == 0) {
+                break;
+            }
+            uint8_t row = s_poller.pending[s_poller.inFlight - 1];
+            if (row == 1) {
+                requested[1]++;
+                modbusPollerTimeout(&s_poller);
+            } else {
+                uint8_t reply = modbusRtuHandle(&s_slaves[row], s_adu, 8, &s_images[row]);
+                modbusPollerReply(&s_poller, s_adu, reply, 0);
+            }
+            if (s_poller.cursor == 0) {
+                break;
+            }
+        }
+    }
+    // Cycles 0, 1 time out (offline), 2..4 skipped, 5 probed, 6..7 skipped.
+    TEST_ASSERT_EQUAL_UINT8(3, requested[1]);
+    TEST_ASSERT_EQUAL_UINT8(MODBUS_POLL_OFFLINE, s_cache[1].status);
+    TEST_ASSERT_EQUAL_UINT16(3, s_cache[1].timeouts);
+    TEST_ASSERT_EQUAL_UINT16(8, s_cache[0].replies);
+
+    // An answer brings it back at once.
+    while (s_poller.cursor != 1 || s_cache[1].holdoff > 0) {
+        transact(0, 0);
+    }
+    TEST_ASSERT_EQUAL_UINT8(1, transact(0, 0));
+    TEST_ASSERT_EQUAL_UINT8(MODBUS_POLL_OK, s_cache[1].status);
+    TEST_ASSERT_EQUAL_UINT8(0, s_cache[1].misses);
+}
+
+static void test_all_nodes_offline_still_probes() {
+    modbusPollerInit(&s_poller, POLLS, s_cache, 2, 1, 5);
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT8(8, modbusPollerNext(&s_poller, 0, s_adu));
+        modbusPollerTimeout(&s_poller);
+    }
+    TEST_ASSERT_EQUAL_UINT8(MODBUS_POLL_OFFLINE, s_cache[0].status);
+    TEST_ASSERT_EQUAL_UINT8(MODBUS_POLL_OFFLINE, s_cache[1].status);
+}
+
+/** Cycle time over @p rows rows, each transaction taking @p stepUs. */
+static uint32_t cycleUs(uint8_t rows, uint32_t stepUs) {
+    modbusPollerInit(&s_poller, POLLS, s_cache, rows, 2, 3);
+    uint8_t frames[MODBUS_POLL_PIPELINE][MODBUS_ADU_MAX];   // The link's FIFO
+    uint8_t oldest = 0;
+    uint32_t nowUs = 0;
+    // One request stays queued behind the one on the bus throughout.
+    modbusPollerNext(&s_poller, nowUs, frames[0]);
+    while (s_poller.stats.cycles < 2) {
+        TEST_ASSERT_EQUAL_UINT8(8, modbusPollerNext(&s_poller, nowUs, frames[oldest ^ 1]));
+        nowUs += stepUs;
+        uint8_t row = s_poller.pending[0];
+        uint8_t reply = modbusRtuHandle(&s_slaves[row], frames[oldest], 8, &s_images[row]);
+        modbusPollerReply(&s_poller, frames[oldest], reply, nowUs / 1000);
+        TEST_ASSERT_EQUAL_UINT8(MODBUS_POLL_OK, s_cache[row].status);
+        oldest ^= 1;
+    }
+    return s_poller.stats.lastCycleUs;
+}
+
+static void test_cycle_time_is_linear_in_rows() {
+    TEST_ASSERT_EQUAL_UINT32(2 * 9000UL, cycleUs(2, 9000));
+    TEST_ASSERT_EQUAL_UINT32(4 * 9000UL, cycleUs(4, 9000));
+    TEST_ASSERT_EQUAL_UINT32(4 * 9000UL, s_poller.stats.worstCycleUs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reply_length_from_header);
+    RUN_TEST(test_round_robin_two_requests_in_flight);
+    RUN_TEST(test_reply_caches_values_with_age);
+    RUN_TEST(test_bad_replies_keep_old_values);
+    RUN_TEST(test_dead_node_is_held_off);
+    RUN_TEST(test_all_nodes_offline_still_probes);
+    RUN_TEST(test_cycle_time_is_linear_in_rows);
+    return UNITY_END();
+}
@@ -0,0 +1,215 @@
+/**
+ * @file test_main.cpp
+ * @brief ModbusRtu — register table reads, two-phase writes, exceptions (env:native)
+ *
+ * Requests are built here with their CRC and served from a test struct,
+ * as the lab task does from its shared state; ModbusSlave.cpp (the AVR
+ * USART framing) is not part of the native build.
+ */
+
+#include <unity.h>
+
+#include "ModbusRtu.h"
+#include <math.h>
+#include <string.h>
+
+struct TestImage {
+    float    temperatureC;
+    bool     valid;
+    uint32_t samples;
+    float    setpointC;
+    uint8_t  preset;
+    int16_t  offset;
+};
+
+static const ModbusRegister REGS[] = {
+    MODBUS_INPUT(0, TestImage, temperatureC, MODBUS_FLOAT, 100),
+    MODBUS_INPUT(1, TestImage, valid, MODBUS_BOOL, 1),
+    MODBUS_INPUT(2, TestImage, samples, MODBUS_U32, 1),
+    MODBUS_INPUT(5, TestImage, preset, MODBUS_U8, 1),
+    MODBUS_HOLDING(0, TestImage, setpointC, MODBUS_FLOAT, 100),
+    MODBUS_HOLDING(1, TestImage, preset, MODBUS_U8, 1),
+    MODBUS_HOLDING(2, TestImage, offset, MODBUS_I16, 1),
+};
+static const uint8_t REG_COUNT = sizeof(REGS) / sizeof(REGS[0]);
+static const uint8_t NODE = 17;
+
+static ModbusRtu s_modbus;
+static TestImage s_image;
+static uint8_t s_adu[MODBUS_ADU_MAX];
+static uint8_t s_applied;
+
+/** Presets 0..2 only; counts the stores. */
+static bool onWrite(void *image, const ModbusRegister &reg, float value, bool apply,
+                    void *context) {
+    (void)context;
+    if (reg.offset == offsetof(TestImage, preset) && value > 2.0f) {
+        return false;
+    }
+    if (apply) {
+        modbusRtuStore(image, reg, value);
+        s_applied++;
+    }
+    return true;
+}
+
+void setUp() {
+    modbusRtuInit(&s_modbus, REGS, REG_COUNT, NODE, onWrite, NULL);
+    s_image.temperatureC = 23.456f;
+    s_image.valid = true;
+    s_image.samples = 0x00012345UL;
+    s_image.setpointC = 25.0f;
+    s_image.preset = 1;
+    s_image.offset = 0;
+    s_applied = 0;
+}
+
+void tearDown() {}
+
+/** Copy a request into the buffer and append its CRC; returns the frame length. */
+static uint8_t request(const uint8_t *pdu, uint8_t len) {
+    memcpy(s_adu, pdu, len);
+    uint16_t crc = modbusCrc16(s_adu, len);
+    s_adu[len] = (uint8_t)crc;
+    s_adu[len + 1] = (uint8_t)(crc >> 8);
+    return (uint8_t)(len + 2);
+}
+
+static uint16_t word(uint8_t index) {
+    return (uint16_t)((s_adu[3 + 2 * index] << 8) | s_adu[4 + 2 * index]);
+}
+
+static void assertException(uint8_t reply, uint8_t function, uint8_t code) {
+    TEST_ASSERT_EQUAL_UINT8(5, reply);
+    TEST_ASSERT_EQUAL_HEX8(function | 0x80, s_adu[1]);
+    TEST_ASSERT_EQUAL_HEX8(code, s_adu[2]);
+}
+
+static void test_crc_check_value() {
+    // CRC-16/MODBUS of "123456789".
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    TEST_ASSERT_EQUAL_HEX16(0x4B37, modbusCrc16(check, sizeof(check)));
+}
+
+static void test_read_input_registers() {
+    const uint8_t pdu[] = { NODE, 0x04, 0x00, 0x00, 0x00, 0x04 };
+    uint8_t n = modbusRtuHandle(&s_modbus, s_adu, request(pdu, sizeof(pdu)), &s_image);
+    TEST_ASSERT_EQUAL_UINT8(3 + 8 + 2, n);
+    TEST_ASSERT_EQUAL_UINT8(8, s_adu[2]);
+    TEST_ASSERT_EQUAL_UINT16(2346, word(0));
+    TEST_ASSERT_EQUAL_UINT16(1, word(1));
+    TEST_ASSERT_EQUAL_HEX16(0x0001, word(2));   // U32 high word first
+    TEST_ASSERT_EQUAL_HEX16(0x2345, word(3));
+    TEST_ASSERT_EQUAL_HEX16(modbusCrc16(s_adu, 11), (uint16_t)(s_adu[11] | (s_adu[12] << 8)));
+
+    s_image.temperatureC = NAN;
+    n = modbusRtuHandle(&s_modbus, s_adu, request(pdu, sizeof(pdu)), &s_image);
+    TEST_ASSERT_EQUAL_HEX16((uint16_t)MODBUS_INVALID_I16, word(0));
+}
+
+static void test_read_exceptions() {
+    const uint8_t gap[] = { NODE, 0x04, 0x00, 0x04, 0x00, 0x02 };       // 4 is unmapped
+    assertException(modbusRtuHandle(&s_modbus, s_adu, request(gap, sizeof(gap)), &s_image),
+                    0x04, MODBUS_EX_ILLEGAL_ADDRESS);
+    const uint8_t none[] = { NODE, 0x03, 0x00, 0x00, 0x00, 0x00 };
+    assertException(modbusRtuHandle(&s_modbus, s_adu, request(none, sizeof(none)), &s_image),
+                    0x03, MODBUS_EX_ILLEGAL_VALUE);
+    const uint8_t coils[] = { NODE, 0x01, 0x00, 0x00, 0x00, 0x01 };
+    assertException(modbusRtuHandle(&s_modbus, s_adu, request(coils, sizeof(coils)), &s_image),
+                    0x01, MODBUS_EX_ILLEGAL_FUNCTION);
+    TEST_ASSERT_EQUAL_UINT16(3, s_modbus.stats.exceptions);
+}
+
+static void test_frames_without_reply() {
+    const uint8_t other[] = { NODE + 1, 0x04, 0x00, 0x00, 0x00, 0x01 };
+    TEST_ASSERT_EQUAL_UINT8(0, modbusRtuHandle(&s_modbus, s_adu,
+                                               request(other, sizeof(other)), &s_image));
+    const uint8_t mine[] = { NODE, 0x04, 0x00, 0x00, 0x00, 0x01 };
+    uint8_t len = request(mine, sizeof(mine));
+    s_adu[3] ^= 0x01;
+    TEST_ASSERT_EQUAL_UINT8(0, modbusRtuHandle(&s_modbus, s_adu, len, &s_image));
+    TEST_ASSERT_EQUAL_UINT8(0, modbusRtuHandle(&s_modbus, s_adu, 3, &s_image));
+    TEST_ASSERT_EQUAL_UINT16(2, s_modbus.stats.crcErrors);
+    TEST_ASSERT_EQUAL_UINT16(0, s_modbus.stats.requests);
+}
+
+static void test_write_single_register() {
+    const uint8_t pdu[] = { NODE, 0x06, 0x00, 0x00, 0x09, 0x6A };    // 24.10 C
+    uint8_t len = request(pdu, sizeof(pdu));
+    uint8_t n = modbusRtuHandle(&s_modbus, s_adu, len, &s_image);
+    TEST_ASSERT_EQUAL_UINT8(8, n);                                     // Echo
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(pdu, s_adu, sizeof(pdu));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 24.10f, s_image.setpointC);
+
+    const uint8_t negative[] = { NODE, 0x06, 0x00, 0x02, 0xFF, 0xFB };
+    modbusRtuHandle(&s_modbus, s_adu, request(negative, sizeof(negative)), &s_image);
+    TEST_ASSERT_EQUAL_INT16(-5, s_image.offset);
+
+    const uint8_t readOnly[] = { NODE, 0x06, 0x00, 0x05, 0x00, 0x01 };  // Input only
+    assertException(modbusRtuHandle(&s_modbus, s_adu, request(readOnly, sizeof(readOnly)),
+                                    &s_image),
+                    0x06, MODBUS_EX_ILLEGAL_ADDRESS);
+    TEST_ASSERT_EQUAL_UINT16(2, s_modbus.stats.writes);
+}
+
+static void test_write_multiple_is_all_or_nothing() {
+    // Setpoint 30.00 C and preset 7: the preset is rejected, so neither is stored.
+    const uint8_t bad[] = { NODE, 0x10, 0x00, 0x00, 0x00, 0x02, 0x04,
+                            0x0B, 0xB8, 0x00, 0x07 };
+    assertException(modbusRtuHandle(&s_modbus, s_adu, request(bad, sizeof(bad)), &s_image),
+                    0x10, MODBUS_EX_ILLEGAL_VALUE);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, s_image.setpointC);
+    TEST_ASSERT_EQUAL_UINT8(1, s_image.preset);
+    TEST_ASSERT_EQUAL_UINT8(0, s_applied);
+
+    const uint8_t good[] = { NODE, 0x10, 0x00, 0x00, 0x00, 0x02, 0x04,
+                             0x0B, 0xB8, 0x00, 0x02 };
+    uint8_t n = modbusRtuHandle(&s_modbus, s_adu, request(good, sizeof(good)), &s_image);
+    TEST_ASSERT_EQUAL_UINT8(8, n);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(good, s_adu, 6);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, s_image.setpointC);
+    TEST_ASSERT_EQUAL_UINT8(2, s_image.preset);
+    TEST_ASSERT_EQUAL_UINT8(2, s_applied);
+
+    const uint8_t count[] = { NODE, 0x10, 0x00, 0x00, 0x00, 0x02, 0x02, 0x0B, 0xB8 };
+    assertException(modbusRtuHandle(&s_modbus, s_adu, request(count, sizeof(count)), &s_image),
+                    0x10, MODBUS_EX_ILLEGAL_VALUE);
+}
+
+static void test_broadcast_applies_silently() {
+    const uint8_t pdu[] = { 0x00, 0x06, 0x00, 0x01, 0x00, 0x00 };
+    TEST_ASSERT_EQUAL_UINT8(0, modbusRtuHandle(&s_modbus, s_adu,
+                                               request(pdu, sizeof(pdu)), &s_image));
+    TEST_ASSERT_EQUAL_UINT8(0, s_image.preset);
+    const uint8_t read[] = { 0x00, 0x04, 0x00, 0x00, 0x00, 0x01 };
+    TEST_ASSERT_EQUAL_UINT8(0, modbusRtuHandle(&s_modbus, s_adu,
+                                               request(read, sizeof(read)), &s_image));
+    TEST_ASSERT_EQUAL_UINT16(2, s_modbus.stats.broadcasts);
+}
+
+static void test_diagnostics_loopback() {
+    const uint8_t pdu[] = { NODE, 0x08, 0x00, 0x00, 0xA5, 0x37 };
+    uint8_t len = request(pdu, sizeof(pdu));
+    uint8_t frame[8];
+    memcpy(frame, s_adu, len);
+    TEST_ASSERT_EQUAL_UINT8(len, modbusRtuHandle(&s_modbus, s_adu, len, &s_image));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, s_adu, len);
+
+    const uint8_t counters[] = { NODE, 0x08, 0x00, 0x0B, 0x00, 0x00 };
+    assertException(modbusRtuHandle(&s_modbus, s_adu, request(counters, sizeof(counters)),
+                                    &s_image),
+                    0x08, MODBUS_EX_ILLEGAL_FUNCTION);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_check_value);
+    RUN_TEST(test_read_input_registers);
+    RUN_TEST(test_read_exceptions);
+    RUN_TEST(test_frames_without_reply);
+    RUN_TEST(test_write_single_register);
+    RUN_TEST(test_write_multiple_is_all_or_nothing);
+    RUN_TEST(test_broadcast_applies_silently);
+    RUN_TEST(test_diagnostics_loopback);
+    return UNITY_END();
+}
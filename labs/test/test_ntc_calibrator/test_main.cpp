@@ -0,0 +1,140 @@
+/**
+ * @file test_main.cpp
+ * @brief NtcCalibrator — steady gate, offset and Beta fit, outliers (env:native)
+ *
+ * The "true" NTC is an exact Beta model with other constants than the
+ * datasheet prior; the reference is quantised to the DS18B20's 1/16 °C.
+ */
+
+#include <unity.h>
+#include <math.h>
+
+#include "NtcCalibrator.h"
+
+static const float T0_C = 25.0f;
+static const float PRIOR_BETA = 3950.0f;
+static const float PRIOR_R0 = 10000.0f;
+static const uint32_t PAIR_MS = 1000;
+
+static NtcCalibrator s_cal(T0_C, 0.15f, 30.0f);
+
+/** Resistance of an exact Beta-model NTC at tempC. */
+static float ntcResistance(float beta, float r0, float tempC) {
+    float tK = tempC + 273.15f;
+    float t0K = T0_C + 273.15f;
+    return r0 * expf(beta * (1.0f / tK - 1.0f / t0K));
+}
+
+/** Temperature the fitted model reads for a resistance. */
+static float modelC(float resistance) {
+    float t0K = T0_C + 273.15f;
+    float invT = 1.0f / t0K + logf(resistance / s_cal.getNominalResistance()) / s_cal.getBeta();
+    return 1.0f / invT - 273.15f;
+}
+
+static float quantise(float tempC) {
+    return floorf(tempC * 16.0f + 0.5f) / 16.0f;
+}
+
+/** Feed a plateau; returns the pairs accepted. */
+static uint16_t hold(float beta, float r0, float tempC, uint16_t pairs, uint32_t *timeMs) {
+    uint16_t accepted = 0;
+    for (uint16_t i = 0; i < pairs; i++) {
+        if (s_cal.addSample(ntcResistance(beta, r0, tempC), quantise(tempC), *timeMs)) {
+            accepted++;
+        }
+        *timeMs += PAIR_MS;
+    }
+    return accepted;
+}
+
+void setUp() {
+    s_cal.reset(PRIOR_BETA, PRIOR_R0, 150.0f, 3.0f);
+}
+
+void tearDown() {}
+
+static void test_pairs_wait_for_a_steady_reference() {
+    uint32_t t = 0;
+    // The first 30 s of a plateau fill the average: nothing is used.
+    TEST_ASSERT_EQUAL_UINT16(0, hold(PRIOR_BETA, PRIOR_R0, 30.0f, 30, &t));
+    TEST_ASSERT_TRUE(hold(PRIOR_BETA, PRIOR_R0, 30.0f, 10, &t) > 0);
+}
+
+static void test_a_ramp_is_never_used() {
+    uint32_t t = 0;
+    uint16_t accepted = 0;
+    for (uint16_t i = 0; i < 600; i++) {
+        float tempC = 20.0f + 0.05f * (float)i;   // 0.05 °C/s
+        if (s_cal.addSample(ntcResistance(PRIOR_BETA, PRIOR_R0, tempC), quantise(tempC), t)) {
+            accepted++;
+        }
+        t += PAIR_MS;
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, accepted);
+}
+
+static void test_one_temperature_fixes_the_offset_not_beta() {
+    uint32_t t = 0;
+    hold(PRIOR_BETA, 10500.0f, 30.0f, 300, &t);
+    float r = ntcResistance(PRIOR_BETA, 10500.0f, 30.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 30.0f, modelC(r));
+    TEST_ASSERT_FLOAT_WITHIN(60.0f, PRIOR_BETA, s_cal.getBeta());
+    TEST_ASSERT_TRUE(s_cal.isConverged());
+}
+
+static void test_a_temperature_range_fits_beta_and_r0() {
+    const float beta = 3880.0f, r0 = 10300.0f;
+    uint32_t t = 0;
+    const float plateaus[] = { 15.0f, 25.0f, 35.0f, 45.0f, 20.0f, 40.0f };
+    for (uint8_t i = 0; i < sizeof(plateaus) / sizeof(plateaus[0]); i++) {
+        hold(beta, r0, plateaus[i], 300, &t);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(25.0f, beta, s_cal.getBeta());
+    TEST_ASSERT_FLOAT_WITHIN(r0 * 0.005f, r0, s_cal.getNominalResistance());
+    for (float c = 10.0f; c <= 50.0f; c += 10.0f) {
+        TEST_ASSERT_FLOAT_WITHIN(0.1f, c, modelC(ntcResistance(beta, r0, c)));
+    }
+}
+
+static void test_outliers_are_rejected() {
+    uint32_t t = 0;
+    hold(PRIOR_BETA, 10500.0f, 30.0f, 200, &t);
+    float beta = s_cal.getBeta();
+    float r0 = s_cal.getNominalResistance();
+    // The reference stays steady; the NTC reads 8 °C higher (loose probe).
+    float r = ntcResistance(PRIOR_BETA, 10500.0f, 38.0f);
+    TEST_ASSERT_FALSE(s_cal.addSample(r, 30.0f, t));
+    TEST_ASSERT_EQUAL_UINT16(1, s_cal.getRejectCount());
+    TEST_ASSERT_EQUAL_FLOAT(beta, s_cal.getBeta());
+    TEST_ASSERT_EQUAL_FLOAT(r0, s_cal.getNominalResistance());
+}
+
+static void test_converges_only_after_enough_pairs() {
+    uint32_t t = 0;
+    hold(PRIOR_BETA, PRIOR_R0, 25.0f, 30, &t);   // Gate only
+    hold(PRIOR_BETA, PRIOR_R0, 25.0f, NTC_CALIBRATOR_MIN_SAMPLES - 1, &t);
+    TEST_ASSERT_FALSE(s_cal.isConverged());
+    hold(PRIOR_BETA, PRIOR_R0, 25.0f, 1, &t);
+    TEST_ASSERT_TRUE(s_cal.isConverged());
+    TEST_ASSERT_TRUE(s_cal.getSigmaC() < 0.1f);
+}
+
+static void test_invalid_pairs_are_ignored() {
+    TEST_ASSERT_FALSE(s_cal.addSample(-1.0f, 25.0f, 0));
+    TEST_ASSERT_FALSE(s_cal.addSample(10000.0f, NAN, 0));
+    TEST_ASSERT_FALSE(s_cal.addSample(10000.0f, 200.0f, 0));
+    TEST_ASSERT_EQUAL_UINT16(0, s_cal.getSampleCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_pairs_wait_for_a_steady_reference);
+    RUN_TEST(test_a_ramp_is_never_used);
+    RUN_TEST(test_one_temperature_fixes_the_offset_not_beta);
+    RUN_TEST(test_a_temperature_range_fits_beta_and_r0);
+    RUN_TEST(test_outliers_are_rejected);
+    RUN_TEST(test_converges_only_after_enough_pairs);
+    RUN_TEST(test_invalid_pairs_are_ignored);
+    return UNITY_END();
+}
@@ -0,0 +1,105 @@
+/**
+ * @file test_main.cpp
+ * @brief PerfCounter — counters, log2 binning and percentiles (env:native)
+ */
+
+#include <unity.h>
+
+#include "PerfCounter.h"
+
+static PerfCounter16 s_count16;
+static PerfCounter32 s_count32;
+static PerfHistogram s_hist;
+
+static const PerfDesc PERF[] PROGMEM = {
+    PERF_COUNTER16("c16", s_count16),
+    PERF_COUNTER32("c32", s_count32),
+    PERF_HISTOGRAM("hist", s_hist),
+};
+
+static const uint8_t PERF_COUNT = sizeof(PERF) / sizeof(PERF[0]);
+
+void setUp() {
+    perfClear(PERF, PERF_COUNT);
+}
+
+void tearDown() {}
+
+static void test_counters_count_and_wrap() {
+    perfCount(&s_count16);
+    perfCount(&s_count32);
+    perfAdd(&s_count32, 41);
+    TEST_ASSERT_EQUAL_UINT16(1, perfRead(&s_count16));
+    TEST_ASSERT_EQUAL_UINT32(42, perfRead(&s_count32));
+
+    s_count16.value = 0xFFFF;
+    perfCount(&s_count16);
+    TEST_ASSERT_EQUAL_UINT16(0, perfRead(&s_count16));
+}
+
+static void test_bins_are_powers_of_two() {
+    TEST_ASSERT_EQUAL_UINT8(0, perfHistogramBin(0));
+    TEST_ASSERT_EQUAL_UINT8(1, perfHistogramBin(1));
+    TEST_ASSERT_EQUAL_UINT8(2, perfHistogramBin(2));
+    TEST_ASSERT_EQUAL_UINT8(2, perfHistogramBin(3));
+    TEST_ASSERT_EQUAL_UINT8(7, perfHistogramBin(64));
+    TEST_ASSERT_EQUAL_UINT8(7, perfHistogramBin(127));
+    TEST_ASSERT_EQUAL_UINT8(PERF_HISTOGRAM_BINS - 1, perfHistogramBin(0xFFFFFFFFUL));
+}
+
+static void test_record_tracks_bins_and_max() {
+    perfRecord(&s_hist, 100);
+    perfRecord(&s_hist, 120);
+    perfRecord(&s_hist, 5);
+    TEST_ASSERT_EQUAL_UINT16(2, s_hist.bins[7]);
+    TEST_ASSERT_EQUAL_UINT16(1, s_hist.bins[3]);
+    TEST_ASSERT_EQUAL_UINT32(120, s_hist.max);
+    TEST_ASSERT_EQUAL_UINT32(3, perfHistogramTotal(&s_hist));
+}
+
+static void test_bins_saturate() {
+    s_hist.bins[4] = 0xFFFF;
+    perfRecord(&s_hist, 10);
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, s_hist.bins[4]);
+}
+
+static void test_percentile_is_the_bin_upper_bound() {
+    for (uint8_t i = 0; i < 98; i++) {
+        perfRecord(&s_hist, 40);    // [32, 64)
+    }
+    perfRecord(&s_hist, 200);       // [128, 256)
+    perfRecord(&s_hist, 300);       // [256, 512)
+    TEST_ASSERT_EQUAL_UINT32(64, perfHistogramPercentile(&s_hist, 50));
+    TEST_ASSERT_EQUAL_UINT32(256, perfHistogramPercentile(&s_hist, 99));
+    TEST_ASSERT_EQUAL_UINT32(512, perfHistogramPercentile(&s_hist, 100));
+}
+
+static void test_percentile_of_the_open_bin_is_the_max() {
+    perfRecord(&s_hist, 1000000UL);
+    TEST_ASSERT_EQUAL_UINT32(1000000UL, perfHistogramPercentile(&s_hist, 50));
+    perfClear(PERF, PERF_COUNT);
+    TEST_ASSERT_EQUAL_UINT32(0, perfHistogramPercentile(&s_hist, 50));
+}
+
+static void test_clear_zeroes_every_registered_instrument() {
+    perfCount(&s_count16);
+    perfCount(&s_count32);
+    perfRecord(&s_hist, 7);
+    perfClear(PERF, PERF_COUNT);
+    TEST_ASSERT_EQUAL_UINT16(0, perfRead(&s_count16));
+    TEST_ASSERT_EQUAL_UINT32(0, perfRead(&s_count32));
+    TEST_ASSERT_EQUAL_UINT32(0, perfHistogramTotal(&s_hist));
+    TEST_ASSERT_EQUAL_UINT32(0, s_hist.max);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_counters_count_and_wrap);
+    RUN_TEST(test_bins_are_powers_of_two);
+    RUN_TEST(test_record_tracks_bins_and_max);
+    RUN_TEST(test_bins_saturate);
+    RUN_TEST(test_percentile_is_the_bin_upper_bound);
+    RUN_TEST(test_percentile_of_the_open_bin_is_the_max);
+    RUN_TEST(test_clear_zeroes_every_registered_instrument);
+    return UNITY_END();
+}
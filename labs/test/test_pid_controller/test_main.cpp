@@ -0,0 +1,96 @@
+/**
+ * @file test_main.cpp
+ * @brief PidController — P/I/D terms, limits and anti-windup (env:native)
+ */
+
+#include <unity.h>
+
+#include "PidController.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_proportional_only() {
+    PidController pid(2.0f, 0.0f, 0.0f, -100.0f, 100.0f);
+    pid.init();
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 10.0f, pid.update(25.0f, 20.0f, 0.1f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -4.0f, pid.update(25.0f, 27.0f, 0.1f));
+}
+
+static void test_integral_accumulates_error_times_dt() {
+    PidController pid(0.0f, 1.0f, 0.0f, -100.0f, 100.0f);
+    pid.init();
+    pid.update(10.0f, 8.0f, 0.5f);                   // +1.0
+    pid.update(10.0f, 8.0f, 0.5f);                   // +1.0
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 3.0f, pid.update(10.0f, 8.0f, 0.5f));
+}
+
+static void test_output_is_clamped_to_limits() {
+    PidController pid(100.0f, 0.0f, 0.0f, 0.0f, 255.0f);
+    pid.init();
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 255.0f, pid.update(50.0f, 20.0f, 0.1f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, pid.update(20.0f, 50.0f, 0.1f));
+}
+
+static void test_reverse_direction_inverts_output() {
+    PidController pid(2.0f, 0.0f, 0.0f, -100.0f, 100.0f, PID_REVERSE);
+    pid.init();
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -10.0f, pid.update(25.0f, 20.0f, 0.1f));
+}
+
+static void test_clamp_anti_windup_recovers_quickly() {
+    PidController pid(1.0f, 1.0f, 0.0f, 0.0f, 10.0f);
+    pid.setAntiWindup(PID_ANTIWINDUP_CLAMP);
+    pid.init();
+    // Saturate for a long time: the integral may not grow past the limits.
+    for (int i = 0; i < 1000; i++) {
+        pid.update(100.0f, 0.0f, 0.1f);
+    }
+    // Overshoot by 5: output leaves saturation within a few steps.
+    float out = 10.0f;
+    int steps = 0;
+    while (out >= 10.0f && steps < 100) {
+        out = pid.update(100.0f, 105.0f, 0.1f);
+        steps++;
+    }
+    TEST_ASSERT_LESS_THAN(10.0f, out);
+    TEST_ASSERT_LESS_OR_EQUAL(20, steps);
+}
+
+static void test_derivative_on_measurement_has_no_setpoint_kick() {
+    PidController pid(0.0f, 0.0f, 1.0f, -1000.0f, 1000.0f);
+    pid.setDerivativeMode(PID_DERIVATIVE_ON_MEASUREMENT);
+    pid.init();
+    pid.update(20.0f, 20.0f, 0.1f);
+    // Setpoint step with a constant measurement: no derivative response.
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, pid.update(40.0f, 20.0f, 0.1f));
+}
+
+static void test_derivative_on_error_reacts_to_measurement_change() {
+    PidController pid(0.0f, 0.0f, 1.0f, -1000.0f, 1000.0f);
+    pid.init();
+    pid.update(20.0f, 20.0f, 0.1f);
+    // Measurement rises by 1 in 0.1 s: error falls at 10/s.
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -10.0f, pid.update(20.0f, 21.0f, 0.1f));
+}
+
+static void test_reset_clears_integral() {
+    PidController pid(0.0f, 1.0f, 0.0f, -100.0f, 100.0f);
+    pid.init();
+    pid.update(10.0f, 0.0f, 1.0f);
+    pid.reset();
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, pid.update(10.0f, 10.0f, 1.0f));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_proportional_only);
+    RUN_TEST(test_integral_accumulates_error_times_dt);
+    RUN_TEST(test_output_is_clamped_to_limits);
+    RUN_TEST(test_reverse_direction_inverts_output);
+    RUN_TEST(test_clamp_anti_windup_recovers_quickly);
+    RUN_TEST(test_derivative_on_measurement_has_no_setpoint_kick);
+    RUN_TEST(test_derivative_on_error_reacts_to_measurement_change);
+    RUN_TEST(test_reset_clears_integral);
+    return UNITY_END();
+}
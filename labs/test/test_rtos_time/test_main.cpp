@@ -0,0 +1,71 @@
+/**
+ * @file test_main.cpp
+ * @brief RtosTime — RtosPeriod releases, response times and misses (env:native)
+ *
+ * The shim's vTaskDelay() advances the clock by whole 16 ms ticks from
+ * the current time, like a block that starts on a tick edge.
+ */
+
+#include <unity.h>
+
+#include "RtosTime.h"
+
+void setUp() {
+    nativeReset();
+}
+
+void tearDown() {}
+
+static void test_ms_to_ticks_rounds_up() {
+    TEST_ASSERT_EQUAL_UINT32(0, rtosMsToTicks(0));
+    TEST_ASSERT_EQUAL_UINT32(1, rtosMsToTicks(1));
+    TEST_ASSERT_EQUAL_UINT32(1, rtosMsToTicks(16));
+    TEST_ASSERT_EQUAL_UINT32(2, rtosMsToTicks(17));
+}
+
+static void test_wait_never_returns_before_the_release() {
+    RtosPeriod period(50);
+    uint32_t start = millis();
+    for (uint32_t job = 1; job <= 20; job++) {
+        period.wait();
+        uint32_t release = start + job * 50;
+        TEST_ASSERT_TRUE((int32_t)(millis() - release) >= 0);
+        TEST_ASSERT_TRUE(millis() - release < 16);                   // Within a tick after
+        TEST_ASSERT_EQUAL_UINT32(release, period.stats().releaseMs);
+        nativeAdvanceMs(3);                                          // The job
+    }
+    TEST_ASSERT_EQUAL_UINT32(19, period.stats().jobs);
+    TEST_ASSERT_EQUAL_UINT32(0, period.misses());
+    TEST_ASSERT_TRUE(period.stats().worstResponseMs < 50);
+}
+
+static void test_response_never_wraps() {
+    RtosPeriod period(100);
+    period.wait();
+    // An external release ahead of the clock, then a job that ends before it
+    period.trigger(millis() + 10);
+    nativeAdvanceMs(2);
+    period.trigger(millis());
+    TEST_ASSERT_EQUAL_UINT32(0, period.stats().lastResponseMs);
+    TEST_ASSERT_TRUE(period.stats().worstResponseMs < 100);
+    TEST_ASSERT_EQUAL_UINT32(0, period.misses());
+}
+
+static void test_late_job_counts_a_miss_and_an_overrun() {
+    RtosPeriod period(50);
+    period.wait();
+    nativeAdvanceMs(120);                                            // Over two periods
+    period.wait();
+    TEST_ASSERT_EQUAL_UINT32(1, period.misses());
+    TEST_ASSERT_EQUAL_UINT32(1, period.overruns());
+    TEST_ASSERT_TRUE(period.stats().lastResponseMs >= 120);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ms_to_ticks_rounds_up);
+    RUN_TEST(test_wait_never_returns_before_the_release);
+    RUN_TEST(test_response_never_wraps);
+    RUN_TEST(test_late_job_counts_a_miss_and_an_overrun);
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test_main.cpp
+ * @brief Schedulability — fixed-priority and cooperative response bounds (env:native)
+ */
+
+#include <unity.h>
+
+#include "Schedulability.h"
+
+static SchedResult  s_results[4];
+static SchedSummary s_summary;
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_liu_layland_table() {
+    TEST_ASSERT_EQUAL_UINT16(0, schedLiuLaylandPermille(0));
+    TEST_ASSERT_EQUAL_UINT16(1000, schedLiuLaylandPermille(1));
+    TEST_ASSERT_EQUAL_UINT16(780, schedLiuLaylandPermille(3));
+    TEST_ASSERT_EQUAL_UINT16(693, schedLiuLaylandPermille(20));
+}
+
+static void test_preemptive_textbook_set() {
+    // C = 3, 3, 5 and T = 7, 12, 20 (ms): the lowest task ends exactly at 20.
+    static const SchedTask SET[] = {
+        { "t1",  7000, 0, 3000, 0, 3 },
+        { "t2", 12000, 0, 3000, 0, 2 },
+        { "t3", 20000, 0, 5000, 0, 1 },
+    };
+    TEST_ASSERT_TRUE(schedAnalyze(SET, 3, SCHED_PREEMPTIVE_FP, s_results, &s_summary));
+    TEST_ASSERT_EQUAL_UINT32(3000, s_results[0].responseUs);
+    TEST_ASSERT_EQUAL_UINT32(6000, s_results[1].responseUs);
+    TEST_ASSERT_EQUAL_UINT32(20000, s_results[2].responseUs);
+    TEST_ASSERT_EQUAL_UINT16(929, s_summary.utilizationPermille);
+    TEST_ASSERT_EQUAL_UINT16(780, s_summary.boundPermille);
+    TEST_ASSERT_EQUAL_UINT8(0, s_summary.missCount);
+}
+
+static void test_preemptive_miss_and_blocking() {
+    static const SchedTask SET[] = {
+        { "t1",  7000,    0, 3000, 1000, 3 },
+        { "t2", 12000,    0, 3000,    0, 2 },
+        { "t3", 20000, 19000, 5000,    0, 1 },
+    };
+    TEST_ASSERT_FALSE(schedAnalyze(SET, 3, SCHED_PREEMPTIVE_FP, s_results, &s_summary));
+    TEST_ASSERT_EQUAL_UINT32(4000, s_results[0].responseUs);
+    TEST_ASSERT_TRUE(s_results[1].schedulable);
+    TEST_ASSERT_FALSE(s_results[2].schedulable);
+    TEST_ASSERT_EQUAL_UINT32(SCHED_UNBOUNDED, s_results[2].responseUs);
+    TEST_ASSERT_EQUAL_UINT8(1, s_summary.missCount);
+    TEST_ASSERT_EQUAL_UINT16(0, s_summary.boundPermille);  // D != T
+}
+
+static void test_preemptive_equal_priorities_interfere() {
+    static const SchedTask SET[] = {
+        { "a", 10000, 0, 2000, 0, 1 },
+        { "b", 10000, 0, 2000, 0, 1 },
+    };
+    TEST_ASSERT_TRUE(schedAnalyze(SET, 2, SCHED_PREEMPTIVE_FP, s_results, &s_summary));
+    TEST_ASSERT_EQUAL_UINT32(4000, s_results[0].responseUs);
+    TEST_ASSERT_EQUAL_UINT32(4000, s_results[1].responseUs);
+}
+
+static void test_preemptive_deadline_beyond_period() {
+    // Job 0 of t2 ends at 156 (past its period), job 1 at 260 − 140.
+    SchedTask set[] = {
+        { "t1", 100000,      0, 52000, 0, 2 },
+        { "t2", 140000, 200000, 52000, 0, 1 },
+    };
+    TEST_ASSERT_TRUE(schedAnalyze(set, 2, SCHED_PREEMPTIVE_FP, s_results, &s_summary));
+    TEST_ASSERT_EQUAL_UINT32(52000, s_results[0].responseUs);
+    TEST_ASSERT_EQUAL_UINT32(156000, s_results[1].responseUs);
+
+    set[1].deadlineUs = 150000;
+    TEST_ASSERT_FALSE(schedAnalyze(set, 2, SCHED_PREEMPTIVE_FP, s_results, &s_summary));
+    TEST_ASSERT_FALSE(s_results[1].schedulable);
+}
+
+static void test_cooperative_long_job_delays_all() {
+    // The lab 2.1 table: the 10 s report holds up the 10 ms task.
+    static const SchedTask SET[] = {
+        { "Task1",    10000,   800000,    200, 0, 0 },
+        { "Task2",    50000,   800000,    300, 0, 0 },
+        { "Task3", 10000000,        0, 600000, 0, 0 },
+    };
+    TEST_ASSERT_TRUE(schedAnalyze(SET, 3, SCHED_COOPERATIVE_FIFO, s_results, &s_summary));
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT32(600500, s_results[i].responseUs);
+    }
+    TEST_ASSERT_EQUAL_UINT16(86, s_summary.utilizationPermille);
+    TEST_ASSERT_EQUAL_UINT16(0, s_summary.boundPermille);
+}
+
+static void test_cooperative_per_task_deadlines() {
+    // Busy period 28: backlog 11 at 0, 7 at 10 and 15, 8 at 20.
+    static const SchedTask SET[] = {
+        { "a", 10000, 0, 6000, 0, 0 },
+        { "b", 15000, 0, 5000, 0, 0 },
+    };
+    TEST_ASSERT_FALSE(schedAnalyze(SET, 2, SCHED_COOPERATIVE_FIFO, s_results, &s_summary));
+    TEST_ASSERT_FALSE(s_results[0].schedulable);
+    TEST_ASSERT_TRUE(s_results[1].schedulable);
+    TEST_ASSERT_EQUAL_UINT32(11000, s_results[1].responseUs);
+}
+
+static void test_overload_and_zero_period_miss() {
+    static const SchedTask OVERLOAD[] = {
+        { "a", 10000, 0, 6000, 0, 0 },
+        { "b", 10000, 0, 6000, 0, 0 },
+    };
+    TEST_ASSERT_FALSE(schedAnalyze(OVERLOAD, 2, SCHED_COOPERATIVE_FIFO, s_results, &s_summary));
+    TEST_ASSERT_EQUAL_UINT8(2, s_summary.missCount);
+    TEST_ASSERT_EQUAL_UINT16(1200, s_summary.utilizationPermille);
+
+    static const SchedTask ZERO[] = {
+        { "a", 10000, 0, 1000, 0, 1 },
+        { "b",     0, 0, 1000, 0, 2 },
+    };
+    TEST_ASSERT_FALSE(schedAnalyze(ZERO, 2, SCHED_PREEMPTIVE_FP, s_results, &s_summary));
+    TEST_ASSERT_EQUAL_UINT8(2, s_summary.missCount);
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, s_summary.utilizationPermille);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_liu_layland_table);
+    RUN_TEST(test_preemptive_textbook_set);
+    RUN_TEST(test_preemptive_miss_and_blocking);
+    RUN_TEST(test_preemptive_equal_priorities_interfere);
+    RUN_TEST(test_preemptive_deadline_beyond_period);
+    RUN_TEST(test_cooperative_long_job_delays_all);
+    RUN_TEST(test_cooperative_per_task_deadlines);
+    RUN_TEST(test_overload_and_zero_period_miss);
+    return UNITY_END();
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_main.cpp
+ * @brief SdLogger — double-buffered block queue and framing (env:native)
+ *
+ * There is no card on the host, so the writer side is played by the
+ * test: it takes the pending block, decodes it as the host tool would
+ * and releases it.
+ */
+
+#include <unity.h>
+
+#include "SdLogger.h"
+#include "TelemetryFrame.h"
+
+#include <string.h>
+
+static SdLogBlocks s_blocks;
+
+void setUp() {
+    sdLogBlocksInit(&s_blocks);
+}
+
+void tearDown() {}
+
+/** Append a 30-byte frame whose bytes are all tag (non-zero, like COBS output). */
+static SdLogAppend appendTagged(uint8_t tag) {
+    uint8_t frame[30];
+    memset(frame, tag, sizeof(frame));
+    return sdLogBlocksAppend(&s_blocks, frame, sizeof(frame));
+}
+
+static void test_frames_fill_a_block_then_swap() {
+    // 17 × 30 = 510 bytes fit; the 18th starts the other block
+    for (uint8_t i = 1; i <= 17; i++) {
+        TEST_ASSERT_EQUAL(SD_LOG_APPENDED, appendTagged(i));
+    }
+    TEST_ASSERT_EQUAL_INT8(-1, sdLogBlocksPending(&s_blocks));
+    TEST_ASSERT_EQUAL(SD_LOG_SWAPPED, appendTagged(18));
+
+    int8_t pending = sdLogBlocksPending(&s_blocks);
+    TEST_ASSERT_EQUAL_INT8(0, pending);
+    const uint8_t *block = s_blocks.data[pending];
+    TEST_ASSERT_EQUAL_HEX8(17, block[509]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, block[510]);  // Tail padding, not a split frame
+    TEST_ASSERT_EQUAL_HEX8(0x00, block[511]);
+    TEST_ASSERT_EQUAL_HEX8(18, s_blocks.data[1][0]);
+    TEST_ASSERT_EQUAL_UINT16(30, s_blocks.fill[1]);
+}
+
+static void test_drops_while_the_writer_holds_the_other_block() {
+    for (uint8_t i = 0; i < 18; i++) {
+        appendTagged(1);
+    }
+    // Block 0 waits for the writer; block 1 fills up behind it
+    for (uint8_t i = 0; i < 16; i++) {
+        TEST_ASSERT_EQUAL(SD_LOG_APPENDED, appendTagged(2));
+    }
+    TEST_ASSERT_EQUAL(SD_LOG_DROPPED, appendTagged(3));
+    TEST_ASSERT_EQUAL_UINT32(1, s_blocks.dropped);
+    TEST_ASSERT_FALSE(sdLogBlocksSeal(&s_blocks));
+
+    sdLogBlocksRelease(&s_blocks, 0);
+    for (uint16_t i = 0; i < SD_CARD_BLOCK_BYTES; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0, s_blocks.data[0][i]);
+    }
+    TEST_ASSERT_EQUAL(SD_LOG_SWAPPED, appendTagged(4));
+    TEST_ASSERT_EQUAL_INT8(1, sdLogBlocksPending(&s_blocks));
+    TEST_ASSERT_EQUAL_HEX8(4, s_blocks.data[0][0]);
+}
+
+static void test_seal_hands_over_a_partial_block() {
+    TEST_ASSERT_FALSE(sdLogBlocksSeal(&s_blocks));  // Nothing to write
+
+    appendTagged(7);
+    TEST_ASSERT_TRUE(sdLogBlocksSeal(&s_blocks));
+    TEST_ASSERT_EQUAL_INT8(0, sdLogBlocksPending(&s_blocks));
+    TEST_ASSERT_EQUAL_HEX8(0x00, s_blocks.data[0][30]);
+
+    // New frames go to the other block meanwhile
+    TEST_ASSERT_EQUAL(SD_LOG_APPENDED, appendTagged(8));
+    TEST_ASSERT_EQUAL_HEX8(8, s_blocks.data[1][0]);
+    sdLogBlocksRelease(&s_blocks, 0);
+    TEST_ASSERT_EQUAL_INT8(-1, sdLogBlocksPending(&s_blocks));
+}
+
+static void test_block_decodes_as_telemetry_frames() {
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    for (uint8_t seq = 0; seq < 3; seq++) {
+        uint16_t payload[4] = { seq, 0, 0x1234, 0 };  // Zeros must be COBS-encoded away
+        uint8_t len = telemetryEncode(0x52, seq, payload, sizeof(payload), frame);
+        TEST_ASSERT_EQUAL_UINT8(sizeof(payload) + 6, len);
+        TEST_ASSERT_EQUAL_HEX8(0x00, frame[len - 1]);
+        TEST_ASSERT_EQUAL(SD_LOG_APPENDED, sdLogBlocksAppend(&s_blocks, frame, len));
+    }
+    TEST_ASSERT_TRUE(sdLogBlocksSeal(&s_blocks));
+
+    // Split at the delimiters as the host does; the zero tail is empty frames
+    const uint8_t *block = s_blocks.data[0];
+    uint16_t start = 0;
+    uint8_t decoded = 0;
+    for (uint16_t i = 0; i < SD_CARD_BLOCK_BYTES; i++) {
+        if (block[i] != 0x00) {
+            continue;
+        }
+        if (i > start) {
+            uint8_t type, seq;
+            uint16_t payload[4];
+            int n = telemetryDecode(&block[start], (uint8_t)(i - start), &type, &seq, payload,
+                                    sizeof(payload));
+            TEST_ASSERT_EQUAL_INT(sizeof(payload), n);
+            TEST_ASSERT_EQUAL_HEX8(0x52, type);
+            TEST_ASSERT_EQUAL_UINT8(decoded, seq);
+            TEST_ASSERT_EQUAL_UINT16(decoded, payload[0]);
+            TEST_ASSERT_EQUAL_HEX16(0x1234, payload[2]);
+            decoded++;
+        }
+        start = (uint16_t)(i + 1);
+    }
+    TEST_ASSERT_EQUAL_UINT8(3, decoded);
+}
+
+static void test_logger_is_off_without_a_card() {
+    uint8_t payload[4] = { 1, 2, 3, 4 };
+    TEST_ASSERT_FALSE(sdLogBegin(53, "LOG.BIN"));
+    TEST_ASSERT_FALSE(sdLogRecord(0x52, payload, sizeof(payload)));
+
+    SdLogStats stats;
+    sdLogGetStats(&stats);
+    TEST_ASSERT_FALSE(stats.ready);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.records);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_fill_a_block_then_swap);
+    RUN_TEST(test_drops_while_the_writer_holds_the_other_block);
+    RUN_TEST(test_seal_hands_over_a_partial_block);
+    RUN_TEST(test_block_decodes_as_telemetry_frames);
+    RUN_TEST(test_logger_is_off_without_a_card);
+    return UNITY_END();
+}
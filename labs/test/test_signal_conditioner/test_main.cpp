@@ -0,0 +1,182 @@
+/**
+ * @file test_main.cpp
+ * @brief SignalConditioner — saturate → median → EWMA pipeline, and the
+ *        CIC decimator in front of it (env:native)
+ */
+
+#include <unity.h>
+
+#include "SignalConditioner.h"
+#include "CicDecimator.h"
+
+#include <math.h>
+
+void setUp() {}
+void tearDown() {}
+
+static void test_first_sample_passes_through() {
+    SignalConditioner cond(5, 0.3f, -40.0f, 125.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 21.5f, cond.process(21.5f));
+    TEST_ASSERT_EQUAL_UINT8(1, cond.getSampleCount());
+    TEST_ASSERT_FALSE(cond.isValid());
+}
+
+static void test_saturation_clamps_and_replaces_nan() {
+    SignalConditioner cond(1, 1.0f, -40.0f, 125.0f);
+    cond.process(500.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 125.0f, cond.getLastSaturated());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 500.0f, cond.getLastRaw());
+    cond.process(-90.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, -40.0f, cond.getLastSaturated());
+    cond.process(NAN);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 42.5f, cond.getLastSaturated());
+}
+
+static void test_median_rejects_single_spike() {
+    SignalConditioner cond(5, 1.0f, -40.0f, 125.0f);
+    const float samples[] = { 20.0f, 20.1f, 80.0f, 20.2f, 20.3f };
+    for (uint8_t i = 0; i < 5; i++) {
+        cond.process(samples[i]);
+    }
+    TEST_ASSERT_TRUE(cond.isValid());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 20.2f, cond.getLastMedian());
+}
+
+static void test_window_slides_out_old_samples() {
+    SignalConditioner cond(3, 1.0f, -40.0f, 125.0f);
+    cond.process(10.0f);
+    cond.process(10.0f);
+    cond.process(10.0f);
+    cond.process(30.0f);
+    cond.process(30.0f);   // Window {10, 30, 30}
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 30.0f, cond.getLastMedian());
+}
+
+static void test_ewma_converges_geometrically() {
+    SignalConditioner cond(1, 0.5f, -40.0f, 125.0f);
+    cond.process(0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 50.0f, cond.process(100.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 75.0f, cond.process(100.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 87.5f, cond.process(100.0f));
+}
+
+static void test_block_per_sample_matches_process() {
+    const float samples[] = { 21.0f, 21.4f, 35.0f, 21.2f, 20.9f, 21.1f, 21.3f, 21.0f };
+    SignalConditioner single(5, 0.2f, -40.0f, 125.0f);
+    SignalConditioner block(5, 0.2f, -40.0f, 125.0f);
+    float expected = 0.0f;
+    for (uint8_t i = 0; i < 8; i++) {
+        expected = single.process(samples[i]);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, expected, block.processBlock(samples, 8));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, single.getLastMedian(), block.getLastMedian());
+}
+
+static void test_reset_forgets_history() {
+    SignalConditioner cond(3, 0.5f, -40.0f, 125.0f);
+    cond.process(100.0f);
+    cond.process(100.0f);
+    cond.reset();
+    TEST_ASSERT_EQUAL_UINT8(0, cond.getSampleCount());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 5.0f, cond.process(5.0f));
+}
+
+/** Peak-to-peak of the settled outputs of a tone around 512 counts. */
+template <uint8_t Order>
+static int32_t cicTonePeakToPeak(CicDecimator<Order> &cic, float cyclesPerSample,
+                                 float amplitude, uint16_t outputs) {
+    int32_t lo = 0x7FFFFFFL;
+    int32_t hi = -0x7FFFFFFL;
+    uint32_t n = 0;
+    uint16_t seen = 0;
+    while (seen < outputs) {
+        float x = 512.0f + amplitude * sinf(2.0f * (float)M_PI * cyclesPerSample * (float)n++);
+        if (cic.push((uint16_t)lroundf(x)) && cic.isSettled()) {
+            int32_t y = cic.readScaled(4);            // 1/16 count
+            lo = (y < lo) ? y : lo;
+            hi = (y > hi) ? y : hi;
+            seen++;
+        }
+    }
+    return hi - lo;
+}
+
+static void test_cic_decimates_with_unity_dc_gain() {
+    CicDecimator<3> cic(4);                           // R = 16
+    uint16_t outputs = 0;
+    for (uint16_t n = 1; n <= 160; n++) {
+        bool ready = cic.push(700);
+        TEST_ASSERT_EQUAL(n % 16 == 0, ready);
+        outputs += ready ? 1 : 0;
+    }
+    TEST_ASSERT_EQUAL_UINT16(10, outputs);
+    TEST_ASSERT_TRUE(cic.isSettled());
+    TEST_ASSERT_EQUAL_INT32(700L << 12, cic.raw());
+    TEST_ASSERT_EQUAL_INT32(700, cic.read());
+    TEST_ASSERT_EQUAL_INT32(700L << 2, cic.readScaled(2));
+    TEST_ASSERT_EQUAL_UINT8(12, cic.gainBits());
+}
+
+static void test_cic_integrators_wrap_harmlessly() {
+    CicDecimator<3> cic(6);                           // 28-bit output
+    for (uint32_t n = 0; n < 200000UL; n++) {
+        cic.push(1023);                               // The integrators wrap many times
+    }
+    TEST_ASSERT_EQUAL_INT32(1023, cic.read());
+    TEST_ASSERT_EQUAL_INT32(1023L << 18, cic.raw());
+}
+
+static void test_cic_order_rejects_aliases_harder() {
+    // A tone at 0.9 × the output rate aliases to a slow beat
+    CicDecimator<1> sum(4);
+    CicDecimator<3> cic(4);
+    int32_t ppSum = cicTonePeakToPeak(sum, 0.9f / 16.0f, 100.0f, 50);
+    int32_t ppCic = cicTonePeakToPeak(cic, 0.9f / 16.0f, 100.0f, 50);
+    TEST_ASSERT_TRUE(ppSum > 15 * 16);                // |sinc| ≈ 0.11: ~22 counts p-p
+    TEST_ASSERT_TRUE(ppCic < 1 * 16);                 // |sinc|^3 ≈ 0.0013
+}
+
+static void test_cic_droop_compensation() {
+    // A passband tone at 1/4 of the output rate: order 3 sags to ~0.73,
+    // the FIR lifts it by 1 + 2c = 1.25 (both sampled at the same phases)
+    CicDecimator<3> plain(4);
+    CicDecimator<3> flat(4, true);
+    TEST_ASSERT_TRUE(flat.isCompensated());
+    float ppPlain = (float)cicTonePeakToPeak(plain, 0.25f / 16.0f, 100.0f, 40);
+    float ppFlat = (float)cicTonePeakToPeak(flat, 0.25f / 16.0f, 100.0f, 40);
+    TEST_ASSERT_FLOAT_WITHIN(0.03f, 1.25f, ppFlat / ppPlain);
+
+    // Unity DC gain, one output of delay
+    flat.reset();
+    for (uint16_t n = 0; n < 16 * 8; n++) {
+        flat.push(300);
+    }
+    TEST_ASSERT_EQUAL_INT32(300, flat.read());
+}
+
+static void test_cic_refuses_ratios_that_overflow() {
+    CicDecimator<4> cic;
+    TEST_ASSERT_FALSE(cic.configure(6));              // 10 + 24 bits
+    TEST_ASSERT_EQUAL_UINT8(0, cic.getRatioLog2());
+    TEST_ASSERT_TRUE(cic.push(5));                    // Falls back to R = 1
+    TEST_ASSERT_FALSE(cic.configure(5, true));        // 30 bits > 26 with the FIR
+    TEST_ASSERT_TRUE(cic.configure(4, true));
+    TEST_ASSERT_TRUE(cic.configure(5));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sample_passes_through);
+    RUN_TEST(test_saturation_clamps_and_replaces_nan);
+    RUN_TEST(test_median_rejects_single_spike);
+    RUN_TEST(test_window_slides_out_old_samples);
+    RUN_TEST(test_ewma_converges_geometrically);
+    RUN_TEST(test_block_per_sample_matches_process);
+    RUN_TEST(test_reset_forgets_history);
+    RUN_TEST(test_cic_decimates_with_unity_dc_gain);
+    RUN_TEST(test_cic_integrators_wrap_harmlessly);
+    RUN_TEST(test_cic_order_rejects_aliases_harder);
+    RUN_TEST(test_cic_droop_compensation);
+    RUN_TEST(test_cic_refuses_ratios_that_overflow);
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_main.cpp
+ * @brief SpscRing — index wrap, drops, batch reads and capacity limits (env:native)
+ *
+ * Producer and consumer run in turn on one thread; the orderings they
+ * would see from an ISR are the same calls interleaved.
+ */
+
+#include <unity.h>
+
+#include "SpscRing.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_indices_wrap_past_255() {
+    SpscRing<uint16_t, 8> ring;
+    uint16_t next = 0;
+    uint16_t expected = 0;
+    // 1000 items through the 8-bit counters, 3 in flight at a time
+    for (uint16_t round = 0; round < 1000; round++) {
+        TEST_ASSERT_TRUE(ring.push(next++));
+        if (ring.available() == 3) {
+            uint16_t item = 0;
+            TEST_ASSERT_TRUE(ring.pop(&item));
+            TEST_ASSERT_EQUAL_UINT16(expected++, item);
+        }
+    }
+    uint16_t item = 0;
+    while (ring.pop(&item)) {
+        TEST_ASSERT_EQUAL_UINT16(expected++, item);
+    }
+    TEST_ASSERT_EQUAL_UINT16(next, expected);
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_FALSE(ring.pop(&item));
+    TEST_ASSERT_EQUAL_UINT16(0, ring.dropped());
+}
+
+static void test_full_ring_drops_and_counts() {
+    SpscRing<uint8_t, 4> ring;
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+    }
+    TEST_ASSERT_TRUE(ring.full());
+    TEST_ASSERT_FALSE(ring.push(99));
+    TEST_ASSERT_FALSE(ring.push(98));
+    TEST_ASSERT_EQUAL_UINT16(2, ring.dropped());
+    TEST_ASSERT_EQUAL_UINT8(4, ring.available());
+
+    // The kept items are the oldest ones, untouched by the drops
+    uint8_t item = 0;
+    TEST_ASSERT_TRUE(ring.pop(&item));
+    TEST_ASSERT_EQUAL_UINT8(0, item);
+    TEST_ASSERT_FALSE(ring.full());
+    TEST_ASSERT_TRUE(ring.push(4));
+
+    // Saturates instead of wrapping back to a small count
+    for (uint32_t i = 0; i < 70000UL; i++) {
+        ring.push(0);
+    }
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, ring.dropped());
+    ring.clear();
+    TEST_ASSERT_EQUAL_UINT16(0, ring.dropped());
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+static void test_batch_read_across_the_wrap_point() {
+    SpscRing<uint8_t, 8> ring;
+    uint8_t out[8];
+    // Move the tail to slot 6 (and the counters near their own wrap)
+    for (uint16_t i = 0; i < 254; i++) {
+        ring.push(0);
+        ring.pop(out);
+    }
+    for (uint8_t i = 0; i < 6; i++) {
+        TEST_ASSERT_TRUE(ring.push((uint8_t)(10 + i)));   // Slots 6, 7, 0, 1, 2, 3
+    }
+    TEST_ASSERT_EQUAL_UINT8(4, ring.read(out, 4));          // Limited by max
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT8(10 + i, out[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT8(2, ring.available());
+    TEST_ASSERT_EQUAL_UINT8(2, ring.read(out, 8));          // Limited by what waits
+    TEST_ASSERT_EQUAL_UINT8(14, out[0]);
+    TEST_ASSERT_EQUAL_UINT8(15, out[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, ring.read(out, 8));
+}
+
+static void test_capacity_boundaries() {
+    // 128: "full" is head - tail == 128, still distinct from empty in 8 bits
+    static SpscRing<uint8_t, 128> large;
+    TEST_ASSERT_EQUAL_UINT8(128, (SpscRing<uint8_t, 128>::capacity()));
+    for (uint16_t lap = 0; lap < 3; lap++) {                 // Counters pass 255
+        for (uint16_t i = 0; i < 128; i++) {
+            TEST_ASSERT_TRUE(large.push((uint8_t)i));
+        }
+        TEST_ASSERT_TRUE(large.full());
+        TEST_ASSERT_FALSE(large.empty());
+        TEST_ASSERT_EQUAL_UINT8(128, large.available());
+        TEST_ASSERT_FALSE(large.push(0));
+        uint8_t out[128];
+        TEST_ASSERT_EQUAL_UINT8(128, large.read(out, 128));
+        for (uint16_t i = 0; i < 128; i++) {
+            TEST_ASSERT_EQUAL_UINT8((uint8_t)i, out[i]);
+        }
+        TEST_ASSERT_TRUE(large.empty());
+    }
+    TEST_ASSERT_EQUAL_UINT16(3, large.dropped());
+
+    // 2: the smallest ring, every slot usable
+    SpscRing<uint32_t, 2> small;
+    TEST_ASSERT_TRUE(small.push(7));
+    TEST_ASSERT_TRUE(small.push(8));
+    TEST_ASSERT_FALSE(small.push(9));
+    uint32_t item = 0;
+    TEST_ASSERT_TRUE(small.pop(&item));
+    TEST_ASSERT_EQUAL_UINT32(7, item);
+    TEST_ASSERT_TRUE(small.push(10));                        // Into the freed slot 0
+    TEST_ASSERT_TRUE(small.pop(&item));
+    TEST_ASSERT_EQUAL_UINT32(8, item);
+    TEST_ASSERT_TRUE(small.pop(&item));
+    TEST_ASSERT_EQUAL_UINT32(10, item);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_indices_wrap_past_255);
+    RUN_TEST(test_full_ring_drops_and_counts);
+    RUN_TEST(test_batch_read_across_the_wrap_point);
+    RUN_TEST(test_capacity_boundaries);
+    return UNITY_END();
+}
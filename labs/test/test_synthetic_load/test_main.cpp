@@ -0,0 +1,144 @@
+/**
+ * @file test_main.cpp
+ * @brief SyntheticLoad — synthetic channels and the StressRamp level search (env:native)
+ */
+
+#include <unity.h>
+
+#include "StressRamp.h"
+#include "SyntheticLoad.h"
+
+static const uint32_t SETTLE_MS = 1000;
+static const uint32_t WINDOW_MS = 5000;
+
+static StressWindow window(uint16_t busyPermille, uint32_t misses) {
+    StressWindow w = { WINDOW_MS, busyPermille, misses, 0, 0 };
+    return w;
+}
+
+/** @brief Poll from @p *now in 100 ms steps until a step other than NONE comes up. */
+static StressStep nextStep(StressRamp *ramp, uint32_t *now) {
+    for (uint16_t i = 0; i < 1000; i++) {
+        StressStep step = ramp->poll(*now);
+        if (step != STRESS_STEP_NONE) {
+            return step;
+        }
+        *now += 100;
+    }
+    return STRESS_STEP_NONE;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_channel_repeats_for_the_same_seed() {
+    SyntheticChannel a;
+    SyntheticChannel b;
+    syntheticChannelInit(&a, 7, 0);
+    syntheticChannelInit(&b, 7, 0);
+    for (uint32_t t = 0; t < 5000; t += 250) {
+        float va = syntheticChannelRead(&a, 24.0f, 1.0f, 0.1f, 4000, t);
+        float vb = syntheticChannelRead(&b, 24.0f, 1.0f, 0.1f, 4000, t);
+        TEST_ASSERT_EQUAL_FLOAT(va, vb);
+        TEST_ASSERT_FLOAT_WITHIN(1.1f, 24.0f, va);
+    }
+}
+
+static void test_channel_wave_without_noise() {
+    SyntheticChannel ch;
+    syntheticChannelInit(&ch, 0, 0);   // Zero seed: still a working generator
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 20.0f, syntheticChannelRead(&ch, 20.0f, 2.0f, 0.0f, 4000, 0));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 22.0f, syntheticChannelRead(&ch, 20.0f, 2.0f, 0.0f, 4000, 1000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 18.0f, syntheticChannelRead(&ch, 20.0f, 2.0f, 0.0f, 4000, 3000));
+
+    SyntheticChannel shifted;
+    syntheticChannelInit(&shifted, 1, 1000);   // A quarter wave ahead
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 22.0f, syntheticChannelRead(&shifted, 20.0f, 2.0f, 0.0f, 4000, 0));
+}
+
+static void test_ramp_steps_to_the_first_failing_level() {
+    StressRamp ramp(SETTLE_MS, WINDOW_MS, 1, 900);
+    uint32_t now = 0;
+    ramp.begin(4, now);
+
+    TEST_ASSERT_EQUAL(STRESS_STEP_APPLY, nextStep(&ramp, &now));
+    TEST_ASSERT_EQUAL_UINT8(0, ramp.level());
+    TEST_ASSERT_EQUAL(STRESS_STEP_BASELINE, nextStep(&ramp, &now));
+    TEST_ASSERT_EQUAL_UINT32(SETTLE_MS, now);
+    TEST_ASSERT_EQUAL(STRESS_STEP_SCORE, nextStep(&ramp, &now));
+    TEST_ASSERT_EQUAL_UINT32(SETTLE_MS + WINDOW_MS, now);
+    TEST_ASSERT_EQUAL(STRESS_STEP_NONE, ramp.poll(now + 60000));   // Waits for score()
+    TEST_ASSERT_TRUE(ramp.score(window(400, 0)));
+
+    TEST_ASSERT_EQUAL(STRESS_STEP_APPLY, nextStep(&ramp, &now));
+    TEST_ASSERT_EQUAL_UINT8(1, ramp.level());
+    TEST_ASSERT_EQUAL(STRESS_STEP_BASELINE, nextStep(&ramp, &now));
+    TEST_ASSERT_EQUAL(STRESS_STEP_SCORE, nextStep(&ramp, &now));
+    TEST_ASSERT_FALSE(ramp.score(window(600, 2)));                  // Missed deadlines
+
+    TEST_ASSERT_EQUAL(STRESS_STEP_DONE, nextStep(&ramp, &now));
+    TEST_ASSERT_FALSE(ramp.running());
+    TEST_ASSERT_EQUAL_INT16(0, ramp.best());
+    TEST_ASSERT_EQUAL_UINT8(1, ramp.level());
+    TEST_ASSERT_FALSE(ramp.exhausted());
+}
+
+static void test_ramp_repeats_windows_back_to_back() {
+    StressRamp ramp(SETTLE_MS, WINDOW_MS, 2, 900);
+    uint32_t now = 0;
+    ramp.begin(1, now);
+    nextStep(&ramp, &now);                                              // APPLY
+    nextStep(&ramp, &now);                                              // BASELINE
+    TEST_ASSERT_EQUAL(STRESS_STEP_SCORE, nextStep(&ramp, &now));
+    TEST_ASSERT_TRUE(ramp.score(window(100, 0)));
+    TEST_ASSERT_EQUAL_INT16(-1, ramp.best());                           // One of two
+
+    uint32_t end = now;
+    TEST_ASSERT_EQUAL(STRESS_STEP_BASELINE, nextStep(&ramp, &now));
+    TEST_ASSERT_EQUAL_UINT32(end, now);                                 // No second settle
+    TEST_ASSERT_EQUAL(STRESS_STEP_SCORE, nextStep(&ramp, &now));
+    TEST_ASSERT_TRUE(ramp.score(window(100, 0)));
+
+    TEST_ASSERT_EQUAL(STRESS_STEP_DONE, nextStep(&ramp, &now));
+    TEST_ASSERT_EQUAL_INT16(0, ramp.best());
+    TEST_ASSERT_TRUE(ramp.exhausted());
+}
+
+static void test_pass_needs_every_limit() {
+    StressRamp ramp(SETTLE_MS, WINDOW_MS, 1, 900);
+    TEST_ASSERT_TRUE(ramp.passes(window(900, 0)));
+    TEST_ASSERT_FALSE(ramp.passes(window(901, 0)));                     // No headroom left
+    StressWindow dropped = window(100, 0);
+    dropped.overruns = 1;
+    TEST_ASSERT_FALSE(ramp.passes(dropped));
+    StressWindow lost = window(100, 0);
+    lost.queueDrops = 1;
+    TEST_ASSERT_FALSE(ramp.passes(lost));
+}
+
+static void test_stop_and_empty_table() {
+    StressRamp ramp(SETTLE_MS, WINDOW_MS, 1, 900);
+    uint32_t now = 0;
+    ramp.begin(3, now);
+    nextStep(&ramp, &now);
+    ramp.stop();
+    TEST_ASSERT_FALSE(ramp.running());
+    TEST_ASSERT_EQUAL(STRESS_STEP_NONE, ramp.poll(now + 60000));
+    TEST_ASSERT_FALSE(ramp.score(window(0, 0)));                        // Nothing to score
+
+    ramp.begin(0, now);
+    TEST_ASSERT_EQUAL(STRESS_STEP_DONE, ramp.poll(now));
+    TEST_ASSERT_EQUAL_INT16(-1, ramp.best());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_channel_repeats_for_the_same_seed);
+    RUN_TEST(test_channel_wave_without_noise);
+    RUN_TEST(test_ramp_steps_to_the_first_failing_level);
+    RUN_TEST(test_ramp_repeats_windows_back_to_back);
+    RUN_TEST(test_pass_needs_every_limit);
+    RUN_TEST(test_stop_and_empty_table);
+    return UNITY_END();
+}
@@ -0,0 +1,105 @@
+/**
+ * @file test_main.cpp
+ * @brief TaskScheduler — deadline order, one task per run, budgeted drain (env:native)
+ */
+
+#include <unity.h>
+
+#include "TaskScheduler.h"
+
+static char     s_order[8];
+static uint8_t  s_runs = 0;
+static uint32_t s_costUs = 0;   // Simulated execution time of every task
+
+static void record(char id) {
+    if (s_runs < sizeof(s_order) - 1) {
+        s_order[s_runs] = id;
+    }
+    s_runs++;
+    nativeAdvanceUs(s_costUs);
+}
+
+static void taskA() { record('A'); }
+static void taskB() { record('B'); }
+static void taskC() { record('C'); }
+static void eventE() { record('E'); }
+
+static const EventTaskFunc_t EVENTS[] = { eventE };
+
+static TaskContext_t s_tasks[3];
+static TaskQueue_t   s_queue;
+
+void setUp() {
+    nativeSetMillis(1000);
+    s_runs = 0;
+    s_costUs = 0;
+    for (uint8_t i = 0; i < sizeof(s_order); i++) {
+        s_order[i] = 0;
+    }
+    // Offsets order the deadlines C, A, B.
+    s_tasks[0] = (TaskContext_t){ taskA, 10, 2, 0 };
+    s_tasks[1] = (TaskContext_t){ taskB, 10, 3, 0 };
+    s_tasks[2] = (TaskContext_t){ taskC, 10, 1, 0 };
+    schedulerQueueInit(&s_queue, s_tasks, 3);
+}
+
+void tearDown() {}
+
+static void test_run_executes_one_due_task_per_call() {
+    TEST_ASSERT_FALSE(schedulerQueueRun(&s_queue));
+    nativeAdvanceMs(5);
+    TEST_ASSERT_TRUE(schedulerQueueRun(&s_queue));
+    TEST_ASSERT_EQUAL_STRING("C", s_order);
+}
+
+static void test_run_for_drains_due_set_in_deadline_order() {
+    nativeAdvanceMs(5);
+    TEST_ASSERT_EQUAL_UINT8(3, schedulerQueueRunFor(&s_queue, 2000));
+    TEST_ASSERT_EQUAL_STRING("CAB", s_order);
+    // Nothing is due again until the next period.
+    TEST_ASSERT_EQUAL_UINT8(0, schedulerQueueRunFor(&s_queue, 2000));
+}
+
+static void test_run_for_stops_once_budget_is_spent() {
+    s_costUs = 300;
+    nativeAdvanceMs(5);
+    // 300 us < 500 us: a second task starts; 600 us: no third.
+    TEST_ASSERT_EQUAL_UINT8(2, schedulerQueueRunFor(&s_queue, 500));
+    TEST_ASSERT_EQUAL_UINT8(1, schedulerQueueRunFor(&s_queue, 500));
+    TEST_ASSERT_EQUAL_STRING("CAB", s_order);
+}
+
+static void test_run_for_zero_budget_runs_one_task() {
+    nativeAdvanceMs(5);
+    TEST_ASSERT_EQUAL_UINT8(1, schedulerQueueRunFor(&s_queue, 0));
+    TEST_ASSERT_EQUAL_UINT8(1, s_runs);
+}
+
+static void test_run_for_serves_events_first() {
+    schedulerQueueSetEvents(&s_queue, EVENTS, 1);
+    schedulerQueueSignal(&s_queue, 0);
+    nativeAdvanceMs(5);
+    TEST_ASSERT_EQUAL_UINT8(4, schedulerQueueRunFor(&s_queue, 2000));
+    TEST_ASSERT_EQUAL_STRING("ECAB", s_order);
+}
+
+static void test_compat_run_for_binds_the_table() {
+    static TaskContext_t tasks[] = {
+        { taskA, 10, 0, 0 },
+        { taskB, 10, 0, 0 },
+    };
+    schedulerInit(tasks, 2);
+    TEST_ASSERT_EQUAL_UINT8(2, schedulerRunFor(tasks, 2, 1000));
+    TEST_ASSERT_FALSE(schedulerRun(tasks, 2));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_run_executes_one_due_task_per_call);
+    RUN_TEST(test_run_for_drains_due_set_in_deadline_order);
+    RUN_TEST(test_run_for_stops_once_budget_is_spent);
+    RUN_TEST(test_run_for_zero_budget_runs_one_task);
+    RUN_TEST(test_run_for_serves_events_first);
+    RUN_TEST(test_compat_run_for_binds_the_table);
+    return UNITY_END();
+}
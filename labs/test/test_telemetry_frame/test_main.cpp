@@ -0,0 +1,126 @@
+/**
+ * @file test_main.cpp
+ * @brief TelemetryFrame — COBS, CRC and frame decoding (env:native)
+ *
+ * Frames are built here the way telemetrySend() builds them, so nothing
+ * is written to the (host) serial port.
+ */
+
+#include <unity.h>
+
+#include "TelemetryFrame.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+/** Frame a payload as telemetrySend() does; returns the length without delimiter. */
+static uint8_t buildFrame(uint8_t type, uint8_t seq, const uint8_t *payload, uint8_t len,
+                          uint8_t *frame) {
+    uint8_t raw[TELEMETRY_MAX_PAYLOAD + 4];
+    raw[0] = type;
+    raw[1] = seq;
+    memcpy(&raw[2], payload, len);
+    uint16_t crc = crc16Ccitt(0xFFFF, raw, (uint8_t)(len + 2));
+    raw[len + 2] = (uint8_t)(crc & 0xFF);
+    raw[len + 3] = (uint8_t)(crc >> 8);
+    return cobsEncode(raw, (uint8_t)(len + 4), frame);
+}
+
+static void test_crc_check_value() {
+    // CRC-16/CCITT-FALSE of "123456789".
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16Ccitt(0xFFFF, check, sizeof(check)));
+}
+
+static void test_cobs_round_trip() {
+    const uint8_t cases[][6] = {
+        { 0, 0, 0, 0, 0, 0 },
+        { 1, 2, 3, 4, 5, 6 },
+        { 0, 1, 0, 2, 0, 0 },
+        { 9, 0, 0, 7, 8, 0 },
+    };
+    for (uint8_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        uint8_t encoded[8];
+        uint8_t decoded[8];
+        uint8_t n = cobsEncode(cases[c], 6, encoded);
+        TEST_ASSERT_EQUAL_UINT8(7, n);
+        TEST_ASSERT_NULL(memchr(encoded, 0, n));
+        TEST_ASSERT_EQUAL_UINT8(6, cobsDecode(encoded, n, decoded));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(cases[c], decoded, 6);
+    }
+}
+
+static void test_cobs_long_run() {
+    // 254 non-zero bytes need a 0xFF code and a follow-up group.
+    uint8_t in[253];
+    for (uint16_t i = 0; i < sizeof(in); i++) {
+        in[i] = (uint8_t)(i % 255 + 1);
+    }
+    uint8_t encoded[256];
+    uint8_t decoded[256];
+    uint8_t n = cobsEncode(in, sizeof(in), encoded);
+    TEST_ASSERT_EQUAL_UINT8(sizeof(in), cobsDecode(encoded, n, decoded));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(in, decoded, sizeof(in));
+}
+
+static void test_cobs_rejects_malformed() {
+    uint8_t out[8];
+    const uint8_t overrun[] = { 5, 1, 2 };       // Code runs past the end
+    const uint8_t zero[]    = { 3, 1, 0, 1 };    // Delimiter inside a frame
+    TEST_ASSERT_EQUAL_UINT8(0, cobsDecode(overrun, sizeof(overrun), out));
+    TEST_ASSERT_EQUAL_UINT8(0, cobsDecode(zero, sizeof(zero), out));
+}
+
+static void test_decode_frame() {
+    const uint8_t payload[] = { 0x10, 0x00, 0x20, 0x00, 0x00, 0x30 };
+    uint8_t frame[TELEMETRY_MAX_PAYLOAD + 6];
+    uint8_t n = buildFrame(0x33, 200, payload, sizeof(payload), frame);
+
+    uint8_t type = 0, seq = 0;
+    uint8_t out[sizeof(payload)];
+    TEST_ASSERT_EQUAL_INT(sizeof(payload),
+                          telemetryDecode(frame, n, &type, &seq, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_HEX8(0x33, type);
+    TEST_ASSERT_EQUAL_UINT8(200, seq);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, out, sizeof(payload));
+}
+
+static void test_decode_rejects_bad_frames() {
+    const uint8_t payload[] = { 1, 2, 3, 4 };
+    uint8_t frame[TELEMETRY_MAX_PAYLOAD + 6];
+    uint8_t n = buildFrame(0x32, 1, payload, sizeof(payload), frame);
+    uint8_t type, seq;
+    uint8_t out[sizeof(payload)];
+
+    // Too small a buffer, a flipped bit, and trailing text merged into a frame.
+    TEST_ASSERT_EQUAL_INT(-1, telemetryDecode(frame, n, &type, &seq, out, 3));
+    frame[3] ^= 0x01;
+    TEST_ASSERT_EQUAL_INT(-1, telemetryDecode(frame, n, &type, &seq, out, sizeof(out)));
+    frame[3] ^= 0x01;
+    uint8_t merged[TELEMETRY_MAX_PAYLOAD + 8] = { 'o', 'k' };
+    memcpy(&merged[2], frame, n);
+    TEST_ASSERT_EQUAL_INT(-1, telemetryDecode(merged, (uint8_t)(n + 2), &type, &seq, out,
+                                              sizeof(out)));
+    TEST_ASSERT_EQUAL_INT(sizeof(payload),
+                          telemetryDecode(frame, n, &type, &seq, out, sizeof(out)));
+}
+
+static void test_pack_float() {
+    TEST_ASSERT_EQUAL_INT16(2350, telemetryPackFloat(23.5f, 100));
+    TEST_ASSERT_EQUAL_INT16(-5, telemetryPackFloat(-0.3125f, 16));
+    TEST_ASSERT_EQUAL_INT16(32767, telemetryPackFloat(1000.0f, 100));
+    TEST_ASSERT_EQUAL_INT16(TELEMETRY_INVALID_I16, telemetryPackFloat(NAN, 100));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_check_value);
+    RUN_TEST(test_cobs_round_trip);
+    RUN_TEST(test_cobs_long_run);
+    RUN_TEST(test_cobs_rejects_malformed);
+    RUN_TEST(test_decode_frame);
+    RUN_TEST(test_decode_rejects_bad_frames);
+    RUN_TEST(test_pack_float);
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_main.cpp
+ * @brief ThermalPlant / StepMetrics — model, sensor and closed loops (env:native)
+ *
+ * The closed-loop cases run the lab 5.1 hysteresis controller and a lab
+ * 5.2-style fan PID against the simulated room for an hour of plant time
+ * each, in milliseconds, and print one
+ * SIM_TUNE,<loop>,settle=<s>,over=<C>,iae=<C*s> line per loop: edit the
+ * gains or band below and re-run "pio test -e native -f test_thermal_plant -v"
+ * to compare tunings without waiting for a real room.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "OnOffHysteresisController.h"
+#include "PidController.h"
+#include "StepMetrics.h"
+#include "ThermalPlant.h"
+
+// Heater room (lab 5.1 SIM_PLANT) and fan room (lab 5.2 SIM_PLANT).
+static const ThermalPlantConfig HEATER_ROOM = { 22.0f, 14.0f, 0.0f, 300.0f, 20.0f, 0.1f, 0.1f };
+static const ThermalPlantConfig FAN_ROOM = { 32.0f, 0.0f, 10.0f, 120.0f, 10.0f, 0.1f, 0.1f };
+static const ThermalPlantConfig EXACT_ROOM = { 20.0f, 10.0f, 5.0f, 100.0f, 10.0f, 0.0f, 0.0f };
+
+static const uint32_t SAMPLE_MS = 2000;            // DHT / control period
+static const uint32_t RUN_MS = 60UL * 60UL * 1000UL;
+
+void setUp() { nativeReset(); }
+void tearDown() {}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Model
+// ──────────────────────────────────────────────────────────────────────────
+
+static void test_dead_time_then_first_order_rise() {
+    ThermalPlant plant(EXACT_ROOM);
+    plant.init(20.0f);
+    plant.setHeater(100.0f);
+    plant.advance(10000);                            // θ: nothing reached the sensor yet
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 20.0f, plant.getTemperatureC());
+    plant.advance(100000);                           // θ + τ: 63 % of the 10 °C rise
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 26.32f, plant.getTemperatureC());
+    plant.advance(900000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 30.0f, plant.getTemperatureC());
+}
+
+static void test_fan_cools_towards_lower_equilibrium() {
+    ThermalPlant plant(EXACT_ROOM);
+    plant.init(20.0f);
+    plant.setFan(100.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 15.0f, plant.getEquilibriumC());
+    plant.advance(1000000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 15.0f, plant.getTemperatureC());
+    plant.setFan(250.0f);                            // Clamped
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 100.0f, plant.getFan());
+}
+
+static void test_result_independent_of_call_granularity() {
+    ThermalPlant coarse(EXACT_ROOM);
+    ThermalPlant fine(EXACT_ROOM);
+    coarse.init(20.0f);
+    fine.init(20.0f);
+    coarse.setHeater(60.0f);
+    fine.setHeater(60.0f);
+    coarse.advance(300000);
+    for (uint16_t i = 0; i < 3000; i++) {
+        fine.advance(100);
+    }
+    TEST_ASSERT_EQUAL_UINT32(coarse.getElapsedMs(), fine.getElapsedMs());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, coarse.getTemperatureC(), fine.getTemperatureC());
+}
+
+static void test_sensor_is_quantized_and_bounded() {
+    ThermalPlant plant(HEATER_ROOM, 42);
+    plant.init(22.04f);
+    for (uint16_t i = 0; i < 200; i++) {
+        float r = plant.read();
+        float steps = r / 0.1f;
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, floorf(steps + 0.5f), steps);
+        TEST_ASSERT_FLOAT_WITHIN(0.2f, 22.04f, r);   // Noise peak + half a step
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Metrics
+// ──────────────────────────────────────────────────────────────────────────
+
+static void test_metrics_on_known_trajectory() {
+    StepMetrics m;
+    m.begin(25.0f, 20.0f, 0, 0.5f);
+    TEST_ASSERT_FALSE(m.isSettled());
+    m.update(24.0f, 1000);      // |e| 5 held for 1 s
+    m.update(25.8f, 2000);      // |e| 1, overshoot 0.8
+    m.update(25.2f, 3000);      // enters the band at 3 s
+    m.update(25.1f, 4000);
+    TEST_ASSERT_TRUE(m.isSettled());
+    TEST_ASSERT_EQUAL_UINT32(3000, m.getSettlingTimeMs());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.8f, m.getOvershoot());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 5.0f + 1.0f + 0.8f + 0.2f, m.getIae());
+
+    m.update(26.0f, 5000);      // leaves the band again
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, m.getSettlingTimeMs());
+}
+
+static void test_metrics_falling_step_overshoot_is_below_setpoint() {
+    StepMetrics m;
+    m.begin(20.0f, 30.0f, 0, 0.5f);
+    m.update(19.0f, 1000);
+    m.update(20.9f, 2000);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, m.getOvershoot());
+}
+
+// ──────────────────────────────────────────────────────────────────────────
+// Closed loops in simulated time
+// ──────────────────────────────────────────────────────────────────────────
+
+static void printTune(const char *loop, const StepMetrics &m) {
+    printf("SIM_TUNE,%s,settle=%.0f,over=%.2f,iae=%.1f\n", loop,
+           m.isSettled() ? m.getSettlingTimeMs() / 1000.0 : -1.0,
+           (double)m.getOvershoot(), (double)m.getIae());
+}
+
+static void test_hysteresis_heater_loop() {
+    const float setpoint = 25.0f;
+    const float band = 2.0f;
+    ThermalPlant plant(HEATER_ROOM);
+    plant.init(22.0f);
+    OnOffHysteresisController ctrl(setpoint, band);
+    ctrl.init();
+    ctrl.setAnticipation(true, 1.5f);
+
+    StepMetrics m;
+    m.begin(setpoint, plant.getTemperatureC(), 0, 0.5f * band + 0.5f);
+    for (uint32_t t = SAMPLE_MS; t <= RUN_MS; t += SAMPLE_MS) {
+        plant.setHeater(ctrl.update(plant.read()) ? 100.0f : 0.0f);
+        plant.advance(SAMPLE_MS);
+        m.update(plant.getTemperatureC(), t);
+    }
+    printTune("hysteresis", m);
+    TEST_ASSERT_TRUE(m.isSettled());
+    TEST_ASSERT_LESS_THAN(0.5f * band + 1.0f, m.getOvershoot());
+}
+
+static void test_pid_fan_loop() {
+    const float setpoint = 26.0f;
+    ThermalPlant plant(FAN_ROOM);
+    plant.init(30.0f);
+    PidController pid(12.0f, 0.18f, 2.0f, 0.0f, 100.0f, PID_REVERSE);
+    pid.setDerivativeMode(PID_DERIVATIVE_ON_MEASUREMENT);
+    pid.setDerivativeFilter(10.0f);
+    pid.setAntiWindup(PID_ANTIWINDUP_BACK_CALCULATION);
+    pid.init();
+
+    StepMetrics m;
+    m.begin(setpoint, plant.getTemperatureC(), 0, 0.5f);
+    for (uint32_t t = SAMPLE_MS; t <= RUN_MS; t += SAMPLE_MS) {
+        plant.setFan(pid.update(setpoint, plant.read(), SAMPLE_MS / 1000.0f));
+        plant.advance(SAMPLE_MS);
+        m.update(plant.getTemperatureC(), t);
+    }
+    printTune("pid_fan", m);
+    TEST_ASSERT_TRUE(m.isSettled());
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, setpoint, plant.getTemperatureC());
+    TEST_ASSERT_FLOAT_WITHIN(5.0f, 60.0f, plant.getFan());   // (32 − 26) / 0.1 °C per %
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_dead_time_then_first_order_rise);
+    RUN_TEST(test_fan_cools_towards_lower_equilibrium);
+    RUN_TEST(test_result_independent_of_call_granularity);
+    RUN_TEST(test_sensor_is_quantized_and_bounded);
+    RUN_TEST(test_metrics_on_known_trajectory);
+    RUN_TEST(test_metrics_falling_step_overshoot_is_below_setpoint);
+    RUN_TEST(test_hysteresis_heater_loop);
+    RUN_TEST(test_pid_fan_loop);
+    return UNITY_END();
+}
@@ -0,0 +1,154 @@
+/**
+ * @file test_main.cpp
+ * @brief ThresholdAlert — hysteresis, debounce and dwell; the bank's
+ *        invalid-reading policy; limits in NTC counts (env:native)
+ */
+
+#include <unity.h>
+
+#include "ThresholdAlert.h"
+#include "ThresholdAlertBank.h"
+#include "AnalogTempSensor.h"
+
+void setUp() { nativeReset(); }
+void tearDown() {}
+
+static void test_starts_normal() {
+    ThresholdAlert alert(30.0f, 25.0f, 3);
+    alert.init();
+    TEST_ASSERT_EQUAL(ALERT_NORMAL, alert.getState());
+    TEST_ASSERT_FALSE(alert.isAlertActive());
+}
+
+static void test_raises_after_debounce_count() {
+    ThresholdAlert alert(30.0f, 25.0f, 3);
+    alert.init();
+    TEST_ASSERT_EQUAL(ALERT_DEBOUNCE_HIGH, alert.update(31.0f, 0));
+    TEST_ASSERT_EQUAL(ALERT_DEBOUNCE_HIGH, alert.update(31.0f, 100));
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, alert.update(31.0f, 200));
+    TEST_ASSERT_TRUE(alert.isAlertActive());
+}
+
+static void test_glitch_is_rejected() {
+    ThresholdAlert alert(30.0f, 25.0f, 3);
+    alert.init();
+    alert.update(31.0f, 0);
+    alert.update(31.0f, 100);
+    TEST_ASSERT_EQUAL(ALERT_NORMAL, alert.update(29.0f, 200));
+}
+
+static void test_hysteresis_band_holds_alert() {
+    ThresholdAlert alert(30.0f, 25.0f, 1);
+    alert.init();
+    alert.update(31.0f, 0);
+    alert.update(31.0f, 100);
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, alert.update(27.0f, 200));   // Between the thresholds
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, alert.update(29.9f, 300));
+}
+
+static void test_clears_after_debounce_below_low() {
+    ThresholdAlert alert(30.0f, 25.0f, 2);
+    alert.init();
+    alert.update(31.0f, 0);
+    alert.update(31.0f, 100);
+    TEST_ASSERT_EQUAL(ALERT_DEBOUNCE_LOW, alert.update(24.0f, 200));
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, alert.update(26.0f, 300));       // Rose back
+    alert.update(24.0f, 400);
+    TEST_ASSERT_EQUAL(ALERT_NORMAL, alert.update(24.0f, 500));
+}
+
+static void test_dwell_time_replaces_count() {
+    ThresholdAlert alert(30.0f, 25.0f, 1);
+    alert.setDwellTime(1000, 0);
+    alert.init();
+    alert.update(31.0f, 0);
+    for (uint32_t t = 100; t < 1000; t += 100) {
+        TEST_ASSERT_EQUAL(ALERT_DEBOUNCE_HIGH, alert.update(31.0f, t));
+    }
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, alert.update(31.0f, 1000));
+}
+
+static void test_update_without_timestamp_uses_millis() {
+    ThresholdAlert alert(30.0f, 25.0f, 1);
+    alert.setDwellTime(500, 0);
+    alert.init();
+    nativeSetMillis(10000);
+    alert.update(31.0f);
+    nativeAdvanceMs(499);
+    TEST_ASSERT_EQUAL(ALERT_DEBOUNCE_HIGH, alert.update(31.0f));
+    nativeAdvanceMs(1);
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, alert.update(31.0f));
+}
+
+static void test_bank_hold_keeps_state_on_invalid() {
+    ThresholdAlertBank<2> bank(30.0f, 25.0f, 1);
+    bank.configureHold(1, true);
+    float hot[2] = { 31.0f, 31.0f };
+    bank.updateAllAt(hot, 0);
+    AlertBankMasks m = bank.updateAllAt(hot, 100);
+    TEST_ASSERT_EQUAL_UINT16(0x03, m.active);
+
+    float gone[2] = { NAN, NAN };                   // Channel 0 resets, 1 holds
+    m = bank.updateAllAt(gone, 200);
+    TEST_ASSERT_EQUAL(ALERT_NORMAL, bank.getState(0));
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, bank.getState(1));
+    TEST_ASSERT_EQUAL_UINT16(0x02, m.active);
+    TEST_ASSERT_EQUAL_UINT16(0x00, m.cleared);
+}
+
+static void test_counts_follow_a_falling_transfer_function() {
+    AnalogTempSensor ntc(A0, 10000, 10000, 3950);
+    int32_t high = ntc.rawAtTemperatureC(30.0f);
+    int32_t low = ntc.rawAtTemperatureC(28.0f);
+    TEST_ASSERT_TRUE(high < low);                   // Warmer NTC, lower count
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 30.0f, ntc.convertRawC((uint16_t)high));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 28.0f, ntc.convertRawC((uint16_t)low));
+    TEST_ASSERT_EQUAL_UINT16(1022, ntc.rawAtTemperatureC(-150.0f));
+    TEST_ASSERT_EQUAL_UINT16(1, ntc.rawAtTemperatureC(1000.0f));
+
+    ThresholdAlert alert(30.0f, 28.0f, 1);
+    alert.setCountThresholds(high, low);
+    TEST_ASSERT_EQUAL(ALERT_DEBOUNCE_HIGH, alert.updateCounts(high - 1, 0));
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, alert.updateCounts(high - 1, 100));
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, alert.updateCounts((high + low) / 2, 200));
+    TEST_ASSERT_EQUAL(ALERT_DEBOUNCE_LOW, alert.updateCounts(low + 1, 300));
+    TEST_ASSERT_EQUAL(ALERT_NORMAL, alert.updateCounts(low + 1, 400));
+}
+
+static void test_bank_judges_count_channels_on_counts() {
+    ThresholdAlertBank<2> bank(30.0f, 28.0f, 1);
+    bank.configureCounts(0, 450, 480);
+    TEST_ASSERT_EQUAL_UINT16(0x01, bank.countMask());
+    float values[2] = { 20.0f, 31.0f };             // Channel 0's value is not compared
+    int32_t counts[2] = { 440, 0 };
+    bank.updateAllAt(values, 0, ThresholdAlertBank<2>::ALL_CHANNELS, counts);
+    AlertBankMasks m = bank.updateAllAt(values, 100, ThresholdAlertBank<2>::ALL_CHANNELS, counts);
+    TEST_ASSERT_EQUAL_UINT16(0x03, m.active);
+
+    bank.configureCounts(0, 430, 460);              // Re-mapped: the state is kept
+    TEST_ASSERT_EQUAL(ALERT_ACTIVE, bank.getState(0));
+    counts[0] = 470;
+    bank.updateAllAt(values, 200, ThresholdAlertBank<2>::ALL_CHANNELS, counts);
+    m = bank.updateAllAt(values, 300, ThresholdAlertBank<2>::ALL_CHANNELS, counts);
+    TEST_ASSERT_EQUAL_UINT16(0x01, m.cleared);
+
+    float gone[2] = { NAN, 31.0f };                 // NaN still marks an invalid reading
+    counts[0] = 440;
+    bank.updateAllAt(gone, 400, ThresholdAlertBank<2>::ALL_CHANNELS, counts);
+    TEST_ASSERT_EQUAL(ALERT_NORMAL, bank.getState(0));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_normal);
+    RUN_TEST(test_raises_after_debounce_count);
+    RUN_TEST(test_glitch_is_rejected);
+    RUN_TEST(test_hysteresis_band_holds_alert);
+    RUN_TEST(test_clears_after_debounce_below_low);
+    RUN_TEST(test_dwell_time_replaces_count);
+    RUN_TEST(test_update_without_timestamp_uses_millis);
+    RUN_TEST(test_bank_hold_keeps_state_on_invalid);
+    RUN_TEST(test_counts_follow_a_falling_transfer_function);
+    RUN_TEST(test_bank_judges_count_channels_on_counts);
+    return UNITY_END();
+}
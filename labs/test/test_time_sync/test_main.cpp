@@ -0,0 +1,157 @@
+/**
+ * @file test_main.cpp
+ * @brief TimeSync — broadcast frames, follow-up pairing, drift lock across
+ *        the micros() wrap and restarts on a master reset (env:native)
+ */
+
+#include <unity.h>
+
+#include "TimeSync.h"
+#include "ModbusRtu.h"
+
+#include <math.h>
+
+void setUp() {}
+void tearDown() {}
+
+/** Two boards: master time t, local time = localStart + t · (1 + drift). */
+struct Bus {
+    TimeSyncMaster master;
+    TimeSyncSlave  node;
+    uint32_t       localStart;
+    double         drift;
+    uint32_t       masterUs;
+};
+
+static uint32_t localAt(const Bus &b, uint32_t masterUs) {
+    return b.localStart + (uint32_t)llround((double)masterUs * (1.0 + b.drift));
+}
+
+static void busInit(Bus &b, uint32_t localStart, double driftPpm) {
+    timeSyncMasterInit(&b.master);
+    timeSyncSlaveInit(&b.node);
+    b.localStart = localStart;
+    b.drift = driftPpm * 1e-6;
+    b.masterUs = 1000;
+}
+
+/** One sync period: broadcast sent at masterUs, received (jitter µs later). */
+static bool busSync(Bus &b, uint32_t periodUs, int32_t jitterUs, bool delivered = true) {
+    uint8_t adu[TIME_SYNC_FRAME_LEN];
+    uint8_t len = timeSyncMasterBuild(&b.master, adu);
+    timeSyncMasterSent(&b.master, b.masterUs);
+    bool consumed = true;
+    if (delivered) {
+        uint32_t rx = localAt(b, b.masterUs) + (uint32_t)jitterUs;
+        consumed = timeSyncSlaveFrame(&b.node, adu, len, rx);
+    }
+    b.masterUs += periodUs;
+    return consumed;
+}
+
+static void test_broadcast_frame_is_a_valid_write_to_address_zero() {
+    TimeSyncMaster master;
+    timeSyncMasterInit(&master);
+    uint8_t adu[TIME_SYNC_FRAME_LEN];
+    TEST_ASSERT_EQUAL_UINT8(17, timeSyncMasterBuild(&master, adu));
+    TEST_ASSERT_EQUAL_UINT8(0, adu[0]);
+    TEST_ASSERT_EQUAL_UINT8(MODBUS_FC_WRITE_MULTIPLE, adu[1]);
+    TEST_ASSERT_EQUAL_UINT8(0xFF, adu[2]);
+    TEST_ASSERT_EQUAL_UINT8(8, adu[6]);
+    TEST_ASSERT_EQUAL_UINT8(0, adu[14]);    // No follow-up in the first one
+    uint16_t crc = modbusCrc16(adu, 15);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)crc, adu[15]);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)(crc >> 8), adu[16]);
+
+    timeSyncMasterSent(&master, 0x12345678UL);
+    timeSyncMasterBuild(&master, adu);
+    TEST_ASSERT_EQUAL_UINT8(2, adu[8]);     // Sequence 2
+    TEST_ASSERT_EQUAL_UINT8(0x12, adu[9]);
+    TEST_ASSERT_EQUAL_UINT8(0x78, adu[12]);
+    TEST_ASSERT_EQUAL_UINT8(1, adu[14]);
+
+    // Other frames are left to the register table; a corrupt sync is dropped
+    TimeSyncSlave node;
+    timeSyncSlaveInit(&node);
+    uint8_t read[8] = { 3, MODBUS_FC_READ_INPUT, 0, 0, 0, 12, 0, 0 };
+    TEST_ASSERT_FALSE(timeSyncSlaveFrame(&node, read, sizeof(read), 0));
+    adu[8] ^= 1;
+    TEST_ASSERT_TRUE(timeSyncSlaveFrame(&node, adu, sizeof(adu), 0));
+    TEST_ASSERT_FALSE(node.haveRx);
+}
+
+static void test_locks_offset_and_drift_across_the_wrap() {
+    Bus b;
+    busInit(b, 0xFFF00000UL, -3000.0);      // Local clock wraps after ~1 s
+    const int32_t jitter[] = { 0, 4, -4, 8, 0, -8, 4, 0 };
+    for (uint8_t k = 0; k < 30; k++) {
+        TEST_ASSERT_TRUE(busSync(b, 1000000UL, jitter[k % 8]));
+    }
+    TEST_ASSERT_EQUAL_UINT8(TIME_SYNC_LOCKED, b.node.state);
+    TEST_ASSERT_EQUAL_UINT16(29, b.node.pairs);   // The first broadcast has no follow-up
+    TEST_ASSERT_EQUAL_UINT16(0, b.node.steps);
+    // Local runs 3000 ppm slow: the master's clock is ~3009 ppm faster
+    TEST_ASSERT_FLOAT_WITHIN(20.0f, 3009.0f, timeSyncDriftPpm(&b.node));
+
+    // A sample taken 700 ms after the last sync, in the master's timebase
+    uint32_t sampleMaster = b.masterUs - 300000UL;
+    uint32_t shared;
+    TEST_ASSERT_TRUE(timeSyncToMaster(&b.node, localAt(b, sampleMaster), &shared));
+    TEST_ASSERT_INT32_WITHIN(30, 0, (int32_t)(shared - sampleMaster));
+}
+
+static void test_missed_follow_up_only_skips_a_pair() {
+    Bus b;
+    busInit(b, 5000000UL, 1500.0);
+    for (uint8_t k = 0; k < 5; k++) {
+        busSync(b, 500000UL, 0);
+    }
+    uint16_t pairs = b.node.pairs;
+    busSync(b, 500000UL, 0, false);       // Lost on the line
+    busSync(b, 500000UL, 0);              // Its follow-up cannot be paired
+    TEST_ASSERT_EQUAL_UINT16(pairs, b.node.pairs);
+    busSync(b, 500000UL, 0);
+    TEST_ASSERT_EQUAL_UINT16(pairs + 1, b.node.pairs);
+    TEST_ASSERT_EQUAL_UINT16(0, b.node.steps);
+
+    uint32_t shared;
+    timeSyncToMaster(&b.node, localAt(b, b.masterUs), &shared);
+    TEST_ASSERT_INT32_WITHIN(10, 0, (int32_t)(shared - b.masterUs));
+}
+
+static void test_master_reset_restarts_the_estimate() {
+    Bus b;
+    busInit(b, 0, 200.0);
+    for (uint8_t k = 0; k < 5; k++) {
+        busSync(b, 1000000UL, 0);
+    }
+    TEST_ASSERT_EQUAL_UINT8(TIME_SYNC_LOCKED, b.node.state);
+
+    // The gateway restarts: its clock and sequence begin again
+    timeSyncMasterInit(&b.master);
+    b.localStart = localAt(b, b.masterUs);
+    b.masterUs = 0;
+    for (uint8_t k = 0; k < 4; k++) {
+        busSync(b, 1000000UL, 0);
+    }
+    TEST_ASSERT_EQUAL_UINT16(1, b.node.steps);
+    TEST_ASSERT_EQUAL_UINT8(TIME_SYNC_LOCKED, b.node.state);
+    uint32_t shared;
+    timeSyncToMaster(&b.node, localAt(b, b.masterUs), &shared);
+    TEST_ASSERT_INT32_WITHIN(10, 0, (int32_t)(shared - b.masterUs));
+
+    // No pair yet: local time is passed through
+    TimeSyncSlave fresh;
+    timeSyncSlaveInit(&fresh);
+    TEST_ASSERT_FALSE(timeSyncToMaster(&fresh, 1234, &shared));
+    TEST_ASSERT_EQUAL_UINT32(1234, shared);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_broadcast_frame_is_a_valid_write_to_address_zero);
+    RUN_TEST(test_locks_offset_and_drift_across_the_wrap);
+    RUN_TEST(test_missed_follow_up_only_skips_a_pair);
+    RUN_TEST(test_master_reset_restarts_the_estimate);
+    return UNITY_END();
+}
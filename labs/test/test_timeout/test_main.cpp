@@ -0,0 +1,141 @@
+/**
+ * @file test_main.cpp
+ * @brief Timeout / RtosTimeout — one-shot callbacks on both clocks (env:native)
+ *
+ * RtosTimeout runs on the FreeRTOS shim: the test advances the clock and
+ * plays the timer task with nativeTimersRun().
+ */
+
+#include <unity.h>
+
+#include "RtosTimeout.h"
+#include "StaticRtos.h"
+#include "Timeout.h"
+
+static uint8_t s_fired[4];
+static uint8_t s_order[4];
+static uint8_t s_orderLen;
+
+static void onFire(void *context) {
+    uint8_t index = (uint8_t)(uintptr_t)context;
+    s_fired[index]++;
+    s_order[s_orderLen++] = index;
+}
+
+void setUp() {
+    nativeReset();
+    memset(s_fired, 0, sizeof(s_fired));
+    s_orderLen = 0;
+}
+
+void tearDown() {}
+
+static void test_fires_once_at_deadline() {
+    Timeout t(onFire, (void *)0);
+    t.start(100);
+    nativeAdvanceMs(99);
+    Timeout::poll();
+    TEST_ASSERT_EQUAL_UINT8(0, s_fired[0]);
+    TEST_ASSERT_TRUE(t.pending());
+    nativeAdvanceMs(1);
+    Timeout::poll();
+    Timeout::poll();
+    TEST_ASSERT_EQUAL_UINT8(1, s_fired[0]);
+    TEST_ASSERT_FALSE(t.pending());
+}
+
+static void test_fires_in_deadline_order() {
+    Timeout a(onFire, (void *)0);
+    Timeout b(onFire, (void *)1);
+    Timeout c(onFire, (void *)2);
+    a.start(300);
+    b.start(100);
+    c.start(200);
+    nativeAdvanceMs(300);
+    Timeout::poll();
+    TEST_ASSERT_EQUAL_UINT8(3, s_orderLen);
+    TEST_ASSERT_EQUAL_UINT8(1, s_order[0]);
+    TEST_ASSERT_EQUAL_UINT8(2, s_order[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, s_order[2]);
+}
+
+static void test_stop_and_restart() {
+    Timeout t(onFire, (void *)0);
+    t.start(100);
+    t.stop();
+    nativeAdvanceMs(200);
+    Timeout::poll();
+    TEST_ASSERT_EQUAL_UINT8(0, s_fired[0]);
+
+    t.start(100);
+    nativeAdvanceMs(50);
+    t.start(100);                                    // Re-arm pushes the deadline out
+    nativeAdvanceMs(60);
+    Timeout::poll();
+    TEST_ASSERT_EQUAL_UINT8(0, s_fired[0]);
+    nativeAdvanceMs(40);
+    Timeout::poll();
+    TEST_ASSERT_EQUAL_UINT8(1, s_fired[0]);
+}
+
+static void test_survives_millis_wrap() {
+    Timeout t(onFire, (void *)0);
+    nativeSetMillis(0xFFFFFFF0u);
+    t.start(32);
+    nativeAdvanceMs(31);
+    Timeout::poll();
+    TEST_ASSERT_EQUAL_UINT8(0, s_fired[0]);
+    nativeAdvanceMs(1);
+    Timeout::poll();
+    TEST_ASSERT_EQUAL_UINT8(1, s_fired[0]);
+}
+
+static void test_rtos_timeout_fires_after_ms() {
+    static RtosTimeout t(onFire, (void *)3);
+    TEST_ASSERT_TRUE(t.init("Test"));
+    TEST_ASSERT_TRUE(t.start(100));
+    TEST_ASSERT_TRUE(t.pending());
+    nativeAdvanceMs(96);
+    nativeTimersRun();
+    TEST_ASSERT_EQUAL_UINT8(0, s_fired[3]);
+    nativeAdvanceMs(100);
+    nativeTimersRun();
+    TEST_ASSERT_EQUAL_UINT8(1, s_fired[3]);
+    TEST_ASSERT_FALSE(t.pending());
+
+    t.start(100);
+    TEST_ASSERT_TRUE(t.stop());
+    nativeAdvanceMs(500);
+    nativeTimersRun();
+    TEST_ASSERT_EQUAL_UINT8(1, s_fired[3]);
+}
+
+static void test_static_queue_on_shim() {
+    static StaticQueue<uint16_t, 2> storage;
+    QueueHandle_t queue = storage.create();
+    TEST_ASSERT_NOT_NULL(queue);
+    uint16_t value = 7;
+    TEST_ASSERT_EQUAL(pdPASS, xQueueSend(queue, &value, 0));
+    value = 9;
+    TEST_ASSERT_EQUAL(pdPASS, xQueueSend(queue, &value, 0));
+    TEST_ASSERT_EQUAL(errQUEUE_FULL, xQueueSend(queue, &value, pdMS_TO_TICKS(100)));
+    TEST_ASSERT_GREATER_THAN(0, millis());          // The block timed out on the clock
+
+    uint16_t out = 0;
+    TEST_ASSERT_EQUAL(pdPASS, xQueueReceive(queue, &out, 0));
+    TEST_ASSERT_EQUAL_UINT16(7, out);
+    TEST_ASSERT_EQUAL(pdPASS, xQueueReceive(queue, &out, 0));
+    TEST_ASSERT_EQUAL_UINT16(9, out);
+    TEST_ASSERT_EQUAL(pdFALSE, xQueueReceive(queue, &out, 0));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fires_once_at_deadline);
+    RUN_TEST(test_fires_in_deadline_order);
+    RUN_TEST(test_stop_and_restart);
+    RUN_TEST(test_survives_millis_wrap);
+    RUN_TEST(test_rtos_timeout_fires_after_ms);
+    RUN_TEST(test_static_queue_on_shim);
+    return UNITY_END();
+}
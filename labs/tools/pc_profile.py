@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Map a PcProfiler histogram to the functions of the firmware ELF.
+
+The "prof" command prints a PROF ... PROFEND block (PcProfiler.h). Save
+the serial log (or paste the block) into a file and run:
+
+    python3 tools/pc_profile.py .pio/build/lab5_2/firmware.elf dump.txt
+    python3 tools/pc_profile.py firmware.elf dump.txt --top 30 --nm avr-nm
+
+Each bin's samples are shared among the text symbols it overlaps, in
+proportion to the overlap, so a coarse whole-program bin that holds a
+hot function and its neighbours is split between them. The output lists
+the functions by samples and, for the hottest one, the "prof zoom"
+command that profiles it alone with fine bins. Uses avr-nm from the
+PlatformIO toolchain (~/.platformio/packages/toolchain-atmelavr/bin) or
+the PATH.
+"""
+
+import argparse
+import bisect
+import collections
+import os
+import shutil
+import subprocess
+import sys
+
+
+def find_nm(preferred):
+    if preferred:
+        return preferred
+    found = shutil.which("avr-nm")
+    if found:
+        return found
+    candidate = os.path.expanduser(
+        "~/.platformio/packages/toolchain-atmelavr/bin/avr-nm")
+    if os.path.exists(candidate):
+        return candidate
+    sys.exit("avr-nm not found; pass --nm <path>")
+
+
+def read_symbols(nm, elf):
+    """Text symbols as sorted (start, end, name) byte ranges."""
+    out = subprocess.run([nm, "-n", "-S", "-C", "--defined-only", elf],
+                         check=True, capture_output=True, text=True).stdout
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) == 4 and parts[2] in "tTwW":
+            start, size, name = int(parts[0], 16), int(parts[1], 16), parts[3]
+            symbols.append([start, start + size, name])
+        elif len(parts) == 3 and parts[1] in "tTwW":
+            symbols.append([int(parts[0], 16), None, parts[2]])  # No size
+    symbols.sort()
+    # Symbols without a size (assembler labels) run to the next symbol.
+    for i, sym in enumerate(symbols):
+        if sym[1] is None:
+            sym[1] = symbols[i + 1][0] if i + 1 < len(symbols) else sym[0] + 2
+    return [tuple(s) for s in symbols if s[1] > s[0]]
+
+
+def read_dump(path):
+    """Last PROF block of the log: (header dict, [(bin start, count)])."""
+    header, bins, block = None, [], None
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("PROF,"):
+                fields = line.split(",")
+                block = ({"bins": int(fields[1]), "width": int(fields[2]),
+                          "base": int(fields[3], 16), "end": int(fields[4], 16),
+                          "samples": int(fields[5]), "outside": int(fields[6]),
+                          "hz": int(fields[7]), "saturated": fields[8] != "0"}, [])
+            elif line.startswith("PB,") and block is not None:
+                _, start, count = line.split(",")
+                block[1].append((int(start, 16), int(count)))
+            elif line == "PROFEND" and block is not None:
+                header, bins = block
+                block = None
+    if header is None:
+        sys.exit("no complete PROF ... PROFEND block in " + path)
+    return header, bins
+
+
+def attribute(symbols, bins, width, end):
+    """Samples per symbol, each bin split by byte overlap."""
+    totals = collections.Counter()
+    starts = [s[0] for s in symbols]
+    for start, count in bins:
+        stop = min(start + width, end)
+        i = max(bisect.bisect_right(starts, start) - 1, 0)
+        overlaps = []
+        while i < len(symbols) and symbols[i][0] < stop:
+            lo, hi = max(start, symbols[i][0]), min(stop, symbols[i][1])
+            if hi > lo:
+                overlaps.append((hi - lo, symbols[i]))
+            i += 1
+        covered = sum(n for n, _ in overlaps)
+        if covered == 0:
+            totals[("?", start, stop)] += count
+            continue
+        for n, sym in overlaps:
+            totals[(sym[2], sym[0], sym[1])] += count * n / covered
+    return totals
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="firmware ELF the dump was taken from")
+    parser.add_argument("dump", help="serial log holding a PROF block")
+    parser.add_argument("--top", type=int, default=20, help="functions listed")
+    parser.add_argument("--nm", help="avr-nm to use")
+    args = parser.parse_args()
+
+    header, bins = read_dump(args.dump)
+    symbols = read_symbols(find_nm(args.nm), args.elf)
+    totals = attribute(symbols, bins, header["width"], header["end"])
+
+    samples = header["samples"]
+    print("%d samples at %d Hz (%.1f s), range %05X..%05X, %d-byte bins%s"
+          % (samples, header["hz"], samples / float(header["hz"]),
+             header["base"], header["end"], header["width"],
+             ", SATURATED" if header["saturated"] else ""))
+    if header["outside"]:
+        print("%d samples outside the range (%.1f %%)"
+              % (header["outside"], 100.0 * header["outside"] / max(samples, 1)))
+    print("%8s %6s  %-11s  %s" % ("samples", "%", "address", "function"))
+    ranked = totals.most_common(args.top)
+    for (name, lo, hi), count in ranked:
+        print("%8.0f %6.1f  %05X+%-5d  %s"
+              % (count, 100.0 * count / max(samples, 1), lo, hi - lo, name))
+
+    if ranked and header["width"] > 2 and ranked[0][0][0] != "?":
+        name, lo, hi = ranked[0][0]
+        print("\nZoom into %s: prof zoom %d %d" % (name, lo, hi))
+
+
+if __name__ == "__main__":
+    main()